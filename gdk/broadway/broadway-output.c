@@ -19,11 +19,14 @@ struct BroadwayOutput {
   GString *buf;
   int error;
   guint32 serial;
+  GConverter *deflate; /* permessage-deflate, if negotiated */
+  GByteArray *deflate_buf;
 };
 
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
-                          gboolean fin, BroadwayWSOpCode code,
+                          gboolean fin, gboolean compressed,
+                          BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
@@ -34,7 +37,7 @@ broadway_output_send_cmd (BroadwayOutput *output,
   gboolean long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -56,7 +59,69 @@ broadway_output_send_cmd (BroadwayOutput *output,
 
 void broadway_output_pong (BroadwayOutput *output)
 {
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
+  broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_CNX_PONG, NULL, 0);
+}
+
+/* Compresses @buf into output->deflate_buf as described in RFC 7692:
+ * a sync flush, with the trailing empty block removed. The compressor
+ * state is kept between messages, which the client expects unless
+ * we negotiate otherwise.
+ */
+static gboolean
+broadway_output_deflate (BroadwayOutput *output,
+                         const void     *buf,
+                         gsize           count)
+{
+  GByteArray *out = output->deflate_buf;
+  gsize in_pos, out_pos;
+  GError *error = NULL;
+
+  /* Deflate can grow incompressible data a bit, leave room for that */
+  g_byte_array_set_size (out, count + count / 8 + 64);
+
+  in_pos = out_pos = 0;
+  while (TRUE)
+    {
+      GConverterResult res;
+      gsize bytes_read, bytes_written;
+
+      res = g_converter_convert (output->deflate,
+                                 (const guint8 *) buf + in_pos, count - in_pos,
+                                 out->data + out_pos, out->len - out_pos,
+                                 G_CONVERTER_FLUSH,
+                                 &bytes_read, &bytes_written,
+                                 &error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+            {
+              g_warning ("Failed to compress output: %s", error->message);
+              g_error_free (error);
+              return FALSE;
+            }
+
+          g_clear_error (&error);
+          g_byte_array_set_size (out, out->len * 2);
+          continue;
+        }
+
+      in_pos += bytes_read;
+      out_pos += bytes_written;
+
+      if (res == G_CONVERTER_FLUSHED && out_pos < out->len)
+        break;
+
+      if (out_pos == out->len)
+        g_byte_array_set_size (out, out->len * 2);
+    }
+
+  if (out_pos >= 4 &&
+      memcmp (out->data + out_pos - 4, "\x00\x00\xff\xff", 4) == 0)
+    out_pos -= 4;
+
+  g_byte_array_set_size (out, out_pos);
+
+  return TRUE;
 }
 
 int
@@ -65,8 +130,28 @@ broadway_output_flush (BroadwayOutput *output)
   if (output->buf->len == 0)
     return TRUE;
 
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
-                            output->buf->str, output->buf->len);
+  if (output->deflate)
+    {
+      if (!broadway_output_deflate (output, output->buf->str, output->buf->len))
+        {
+          output->error = TRUE;
+          g_string_set_size (output->buf, 0);
+          return FALSE;
+        }
+
+      g_debug ("Sending %u bytes (%" G_GSIZE_FORMAT " uncompressed)",
+               output->deflate_buf->len, output->buf->len);
+
+      broadway_output_send_cmd (output, TRUE, TRUE, BROADWAY_WS_BINARY,
+                                output->deflate_buf->data, output->deflate_buf->len);
+    }
+  else
+    {
+      g_debug ("Sending %" G_GSIZE_FORMAT " bytes", output->buf->len);
+
+      broadway_output_send_cmd (output, TRUE, FALSE, BROADWAY_WS_BINARY,
+                                output->buf->str, output->buf->len);
+    }
 
   g_string_set_size (output->buf, 0);
 
@@ -74,6 +159,16 @@ broadway_output_flush (BroadwayOutput *output)
 
 }
 
+void
+broadway_output_enable_deflate (BroadwayOutput *output)
+{
+  if (output->deflate)
+    return;
+
+  output->deflate = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1));
+  output->deflate_buf = g_byte_array_new ();
+}
+
 BroadwayOutput *
 broadway_output_new (GOutputStream *out, guint32 serial)
 {
@@ -92,6 +187,8 @@ void
 broadway_output_free (BroadwayOutput *output)
 {
   g_object_unref (output->out);
+  g_clear_object (&output->deflate);
+  g_clear_pointer (&output->deflate_buf, g_byte_array_unref);
   free (output);
 }
 
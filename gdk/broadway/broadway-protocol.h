@@ -23,6 +23,11 @@ typedef enum { /* Sync changes with broadway.js and node_type_is_container() */
   BROADWAY_NODE_TRANSFORM = 11,
   BROADWAY_NODE_DEBUG = 12,
   BROADWAY_NODE_REUSE = 13,
+  BROADWAY_NODE_REPEATING_LINEAR_GRADIENT = 14,
+  BROADWAY_NODE_RADIAL_GRADIENT = 15,
+  BROADWAY_NODE_REPEATING_RADIAL_GRADIENT = 16,
+  BROADWAY_NODE_CONIC_GRADIENT = 17,
+  BROADWAY_NODE_BLUR = 18,
 } BroadwayNodeType;
 
 typedef enum { /* Sync changes with broadway.js */
@@ -48,6 +53,11 @@ static const char *broadway_node_type_names[] G_GNUC_UNUSED =  {
   "TRANSFORM",
   "DEBUG",
   "REUSE",
+  "REPEATING_LINEAR_GRADIENT",
+  "RADIAL_GRADIENT",
+  "REPEATING_RADIAL_GRADIENT",
+  "CONIC_GRADIENT",
+  "BLUR",
 };
 
 typedef enum {
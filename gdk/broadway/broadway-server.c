@@ -112,6 +112,7 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  GConverter *inflate; /* permessage-deflate, if negotiated */
 };
 
 struct BroadwaySurface {
@@ -335,6 +336,7 @@ broadway_input_free (BroadwayInput *input)
 {
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
+  g_clear_object (&input->inflate);
   g_source_destroy (input->source);
   g_free (input);
 }
@@ -763,6 +765,67 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
+/* Undoes the permessage-deflate compression of a client message,
+ * see RFC 7692.
+ */
+static GByteArray *
+inflate_input_message (BroadwayInput *input,
+                       const guchar  *data,
+                       gsize          len)
+{
+  static const guchar tail[] = { 0x00, 0x00, 0xff, 0xff };
+  GByteArray *in, *out;
+  gsize in_pos, out_pos;
+  GError *error = NULL;
+
+  in = g_byte_array_sized_new (len + sizeof (tail));
+  g_byte_array_append (in, data, len);
+  g_byte_array_append (in, tail, sizeof (tail));
+
+  out = g_byte_array_sized_new (MAX (len * 4, 256));
+  g_byte_array_set_size (out, MAX (len * 4, 256));
+
+  in_pos = out_pos = 0;
+  while (in_pos < in->len || out_pos == out->len)
+    {
+      GConverterResult res;
+      gsize bytes_read, bytes_written;
+
+      if (out_pos == out->len)
+        g_byte_array_set_size (out, out->len * 2);
+
+      res = g_converter_convert (input->inflate,
+                                 in->data + in_pos, in->len - in_pos,
+                                 out->data + out_pos, out->len - out_pos,
+                                 G_CONVERTER_FLUSH,
+                                 &bytes_read, &bytes_written,
+                                 &error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+            {
+              g_clear_error (&error);
+              g_byte_array_set_size (out, out->len * 2);
+              continue;
+            }
+
+          g_warning ("Failed to decompress input: %s", error->message);
+          g_error_free (error);
+          g_byte_array_unref (in);
+          g_byte_array_unref (out);
+          return NULL;
+        }
+
+      in_pos += bytes_read;
+      out_pos += bytes_written;
+    }
+
+  g_byte_array_unref (in);
+  g_byte_array_set_size (out, out_pos);
+
+  return out;
+}
+
 static void
 parse_input (BroadwayInput *input)
 {
@@ -775,7 +838,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -786,6 +849,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -835,6 +899,16 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed && input->inflate)
+          {
+            GByteArray *message = inflate_input_message (input, data, payload_len);
+
+            if (message)
+              {
+                parse_input_message (input, message->data);
+                g_byte_array_unref (message);
+              }
+          }
         else
           {
             parse_input_message (input, data);
@@ -1090,6 +1164,7 @@ start_input (HttpRequest *request)
   int i;
   char *res;
   const char *origin, *host;
+  gboolean deflate;
   BroadwayInput *input;
   const void *data_buffer;
   gsize data_buffer_size;
@@ -1106,6 +1181,7 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  deflate = FALSE;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
@@ -1116,6 +1192,9 @@ start_input (HttpRequest *request)
         host = p;
       else if ((p = parse_line (lines[i], "Sec-WebSocket-Origin")))
         origin = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        deflate = strstr (p, "permessage-deflate") != NULL &&
+                  g_getenv ("BROADWAY_DISABLE_COMPRESSION") == NULL;
     }
 
   if (host == NULL)
@@ -1133,10 +1212,12 @@ start_input (HttpRequest *request)
                              "Connection: Upgrade\r\n"
                              "Sec-WebSocket-Accept: %s\r\n"
                              "%s%s%s"
+                             "%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
+                             deflate?"Sec-WebSocket-Extensions: permessage-deflate\r\n":"",
                              host);
       g_free (accept);
 
@@ -1170,6 +1251,12 @@ start_input (HttpRequest *request)
   input->output =
     broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
 
+  if (deflate)
+    {
+      input->inflate = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+      broadway_output_enable_deflate (input->output);
+    }
+
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
 
@@ -1803,10 +1890,22 @@ decode_nodes (BroadwayServer *server,
     n_children = 1;
     break;
   case BROADWAY_NODE_LINEAR_GRADIENT:
+  case BROADWAY_NODE_REPEATING_LINEAR_GRADIENT:
     size = NODE_SIZE_RECT + 2 * NODE_SIZE_POINT;
     n_stops = data[*pos + size++];
     size += n_stops * NODE_SIZE_COLOR_STOP;
     break;
+  case BROADWAY_NODE_RADIAL_GRADIENT:
+  case BROADWAY_NODE_REPEATING_RADIAL_GRADIENT:
+    size = NODE_SIZE_RECT + NODE_SIZE_POINT + 4 * NODE_SIZE_FLOAT;
+    n_stops = data[*pos + size++];
+    size += n_stops * NODE_SIZE_COLOR_STOP;
+    break;
+  case BROADWAY_NODE_CONIC_GRADIENT:
+    size = NODE_SIZE_RECT + NODE_SIZE_POINT + NODE_SIZE_FLOAT;
+    n_stops = data[*pos + size++];
+    size += n_stops * NODE_SIZE_COLOR_STOP;
+    break;
   case BROADWAY_NODE_SHADOW:
     size = 1;
     n_shadows = data[*pos];
@@ -1814,6 +1913,7 @@ decode_nodes (BroadwayServer *server,
     n_children = 1;
     break;
   case BROADWAY_NODE_OPACITY:
+  case BROADWAY_NODE_BLUR:
     size = NODE_SIZE_FLOAT;
     n_children = 1;
     break;
@@ -14,6 +14,11 @@ const BROADWAY_NODE_CLIP = 10;
 const BROADWAY_NODE_TRANSFORM = 11;
 const BROADWAY_NODE_DEBUG = 12;
 const BROADWAY_NODE_REUSE = 13;
+const BROADWAY_NODE_REPEATING_LINEAR_GRADIENT = 14;
+const BROADWAY_NODE_RADIAL_GRADIENT = 15;
+const BROADWAY_NODE_REPEATING_RADIAL_GRADIENT = 16;
+const BROADWAY_NODE_CONIC_GRADIENT = 17;
+const BROADWAY_NODE_BLUR = 18;
 
 const BROADWAY_NODE_OP_INSERT_NODE = 0;
 const BROADWAY_NODE_OP_REMOVE_NODE = 1;
@@ -689,6 +694,7 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
 
 
     case BROADWAY_NODE_LINEAR_GRADIENT:
+    case BROADWAY_NODE_REPEATING_LINEAR_GRADIENT:
         {
             var rect = this.decode_rect();
             var start = this.decode_point ();
@@ -721,7 +727,7 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
             var l = Math.sqrt(l2);
             var offset = ((start_corner_x - start.x) * dx  + (start_corner_y - start.y) * dy) / l2;
 
-            var gradient = "linear-gradient(" + angle + "deg";
+            var gradient = (type == BROADWAY_NODE_LINEAR_GRADIENT ? "linear-gradient(" : "repeating-linear-gradient(") + angle + "deg";
             for (var i = 0; i < stops.length; i++) {
                 var stop = stops[i];
                 gradient = gradient + ", " + stop.color + " " + px(stop.offset * l - offset);
@@ -733,6 +739,56 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
         }
         break;
 
+    case BROADWAY_NODE_RADIAL_GRADIENT:
+    case BROADWAY_NODE_REPEATING_RADIAL_GRADIENT:
+        {
+            var rect = this.decode_rect();
+            var center = this.decode_point ();
+            var hradius = this.decode_float ();
+            var vradius = this.decode_float ();
+            var start = this.decode_float ();
+            var end = this.decode_float ();
+            var stops = this.decode_color_stops ();
+            var div = this.createDiv(id);
+            div.style["position"] = "absolute";
+            set_rect_style(div, rect);
+
+            // Stop positions are relative to the radius, with offsets 0 and 1 at start and end
+            var gradient = (type == BROADWAY_NODE_RADIAL_GRADIENT ? "radial-gradient(" : "repeating-radial-gradient(") +
+                args("ellipse", px(hradius), px(vradius), "at", px(center.x - rect.x), px(center.y - rect.y));
+            for (var i = 0; i < stops.length; i++) {
+                var stop = stops[i];
+                gradient = gradient + ", " + stop.color + " " + ((start + stop.offset * (end - start)) * 100) + "%";
+            }
+            gradient = gradient + ")";
+
+            div.style["background-image"] = gradient;
+            newNode = div;
+        }
+        break;
+
+    case BROADWAY_NODE_CONIC_GRADIENT:
+        {
+            var rect = this.decode_rect();
+            var center = this.decode_point ();
+            var rotation = this.decode_float ();
+            var stops = this.decode_color_stops ();
+            var div = this.createDiv(id);
+            div.style["position"] = "absolute";
+            set_rect_style(div, rect);
+
+            var gradient = "conic-gradient(" + args("from", rotation + "deg", "at", px(center.x - rect.x), px(center.y - rect.y));
+            for (var i = 0; i < stops.length; i++) {
+                var stop = stops[i];
+                gradient = gradient + ", " + stop.color + " " + (stop.offset * 100) + "%";
+            }
+            gradient = gradient + ")";
+
+            div.style["background-image"] = gradient;
+            newNode = div;
+        }
+        break;
+
 
     /* Bin nodes */
 
@@ -787,6 +843,20 @@ TransformNodes.prototype.insertNode = function(parent, previousSibling, is_tople
         }
         break;
 
+    case BROADWAY_NODE_BLUR:
+        {
+            var radius = this.decode_float();
+            var div = this.createDiv(id);
+            div.style["position"] = "absolute";
+            div.style["left"] = px(0);
+            div.style["top"] = px(0);
+            div.style["filter"] = "blur(" + px(radius) + ")";
+
+            this.insertNode(div, null, false);
+            newNode = div;
+        }
+        break;
+
     case BROADWAY_NODE_SHADOW:
         {
             var len = this.decode_uint32();
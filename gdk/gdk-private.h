@@ -45,6 +45,11 @@ typedef struct
   gboolean always_enabled;
 } GdkDebugKey;
 
+void     gdk_frame_clock_set_late_latching        (GdkFrameClock *clock,
+                                                   gboolean       late_latching);
+gboolean gdk_frame_clock_get_late_latching        (GdkFrameClock *clock);
+gint64   gdk_frame_clock_get_predicted_paint_cost (GdkFrameClock *clock);
+
 guint gdk_parse_debug_var (const char        *variable,
                            const GdkDebugKey *keys,
                            guint              nkeys);
@@ -70,6 +70,12 @@ struct _GdkClipboardPrivate
   GdkContentFormats *formats;
   GdkContentProvider *content;
 
+  /* The last value read from a remote clipboard, so that pasting
+   * the same contents again does not need another transfer. */
+  GValue cached_value;
+  /* increased whenever the contents change */
+  guint generation;
+
   guint local : 1;
 };
 
@@ -154,6 +160,8 @@ gdk_clipboard_finalize (GObject *object)
   GdkClipboardPrivate *priv = gdk_clipboard_get_instance_private (clipboard);
 
   g_clear_pointer (&priv->formats, gdk_content_formats_unref);
+  if (G_IS_VALUE (&priv->cached_value))
+    g_value_unset (&priv->cached_value);
 
   G_OBJECT_CLASS (gdk_clipboard_parent_class)->finalize (object);
 }
@@ -172,6 +180,10 @@ gdk_clipboard_real_claim (GdkClipboard       *clipboard,
 
   g_object_freeze_notify (G_OBJECT (clipboard));
 
+  priv->generation++;
+  if (G_IS_VALUE (&priv->cached_value))
+    g_value_unset (&priv->cached_value);
+
   gdk_content_formats_unref (priv->formats);
   gdk_content_formats_ref (formats);
   formats = gdk_content_formats_union_deserialize_gtypes (formats);
@@ -704,21 +716,41 @@ gdk_clipboard_read_finish (GdkClipboard  *clipboard,
     }
 }
 
+typedef struct {
+  GValue value; /* must be first, the finish functions return it */
+  guint generation;
+} ReadValueData;
+
 static void
 gdk_clipboard_read_value_done (GObject      *source,
                                GAsyncResult *result,
                                gpointer      data)
 {
   GTask *task = data;
+  GdkClipboard *clipboard = g_task_get_source_object (task);
+  GdkClipboardPrivate *priv = gdk_clipboard_get_instance_private (clipboard);
+  ReadValueData *read_data;
   GError *error = NULL;
-  GValue *value;
 
-  value = g_task_get_task_data (task);
+  read_data = g_task_get_task_data (task);
 
-  if (!gdk_content_deserialize_finish (result, value, &error))
-    g_task_return_error (task, error);
+  if (!gdk_content_deserialize_finish (result, &read_data->value, &error))
+    {
+      g_task_return_error (task, error);
+    }
   else
-    g_task_return_pointer (task, value, NULL);
+    {
+      /* Don't cache values of contents that changed during the read */
+      if (!priv->local && read_data->generation == priv->generation)
+        {
+          if (G_IS_VALUE (&priv->cached_value))
+            g_value_unset (&priv->cached_value);
+          g_value_init (&priv->cached_value, G_VALUE_TYPE (&read_data->value));
+          g_value_copy (&read_data->value, &priv->cached_value);
+        }
+
+      g_task_return_pointer (task, &read_data->value, NULL);
+    }
 
   g_object_unref (task);
 }
@@ -731,6 +763,7 @@ gdk_clipboard_read_value_got_stream (GObject      *source,
   GInputStream *stream;
   GError *error = NULL;
   GTask *task = data;
+  ReadValueData *read_data = g_task_get_task_data (task);
   const char *mime_type;
 
   stream = gdk_clipboard_read_finish (GDK_CLIPBOARD (source), result, &mime_type, &error);
@@ -742,7 +775,7 @@ gdk_clipboard_read_value_got_stream (GObject      *source,
 
   gdk_content_deserialize_async (stream,
                                  mime_type,
-                                 G_VALUE_TYPE (g_task_get_task_data (task)),
+                                 G_VALUE_TYPE (&read_data->value),
                                  g_task_get_priority (task),
                                  g_task_get_cancellable (task),
                                  gdk_clipboard_read_value_done,
@@ -751,10 +784,12 @@ gdk_clipboard_read_value_got_stream (GObject      *source,
 }
 
 static void
-free_value (gpointer value)
+read_value_data_free (gpointer data)
 {
-  g_value_unset (value);
-  g_slice_free (GValue, value);
+  ReadValueData *read_data = data;
+
+  g_value_unset (&read_data->value);
+  g_slice_free (ReadValueData, read_data);
 }
 
 static void
@@ -769,15 +804,18 @@ gdk_clipboard_read_value_internal (GdkClipboard        *clipboard,
   GdkClipboardPrivate *priv = gdk_clipboard_get_instance_private (clipboard);
   GdkContentFormatsBuilder *builder;
   GdkContentFormats *formats;
+  ReadValueData *read_data;
   GValue *value;
   GTask *task;
  
   task = g_task_new (clipboard, cancellable, callback, user_data);
   g_task_set_priority (task, io_priority);
   g_task_set_source_tag (task, source_tag);
-  value = g_slice_new0 (GValue);
+  read_data = g_slice_new0 (ReadValueData);
+  read_data->generation = priv->generation;
+  value = &read_data->value;
   g_value_init (value, type);
-  g_task_set_task_data (task, value, free_value);
+  g_task_set_task_data (task, read_data, read_value_data_free);
 
   if (priv->local)
     {
@@ -809,6 +847,13 @@ gdk_clipboard_read_value_internal (GdkClipboard        *clipboard,
           g_clear_error (&error);
         }
     }
+  else if (G_VALUE_HOLDS (&priv->cached_value, type))
+    {
+      g_value_copy (&priv->cached_value, value);
+      g_task_return_pointer (task, value, NULL);
+      g_object_unref (task);
+      return;
+    }
 
   builder = gdk_content_formats_builder_new ();
   gdk_content_formats_builder_add_gtype (builder, type);
@@ -843,6 +888,10 @@ gdk_clipboard_read_value_internal (GdkClipboard        *clipboard,
  * For local clipboard contents that are available in the given #GType, the
  * value will be copied directly. Otherwise, GDK will try to use
  * gdk_content_deserialize_async() to convert the clipboard's data.
+ *
+ * The last value read from another application is kept until the
+ * clipboard changes, so reading it again does not transfer the data
+ * again.
  **/
 void
 gdk_clipboard_read_value_async (GdkClipboard        *clipboard,
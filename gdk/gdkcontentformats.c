@@ -65,6 +65,11 @@
 
 #include <string.h>
 
+/* Formats and builders with more types than this use hash tables
+ * to look them up, so that matching large offers is not quadratic.
+ */
+#define HASH_THRESHOLD 8
+
 struct _GdkContentFormats
 {
   /*< private >*/
@@ -74,6 +79,9 @@ struct _GdkContentFormats
   gsize n_mime_types;
   GType *gtypes;
   gsize n_gtypes;
+
+  GHashTable *mime_type_set; /* (nullable) */
+  GHashTable *gtype_set; /* (nullable) */
 };
 
 G_DEFINE_BOXED_TYPE (GdkContentFormats, gdk_content_formats,
@@ -126,6 +134,24 @@ gdk_content_formats_new_take (GType *      gtypes,
   result->mime_types = mime_types;
   result->n_mime_types = n_mime_types;
 
+  if (n_gtypes > HASH_THRESHOLD)
+    {
+      gsize i;
+
+      result->gtype_set = g_hash_table_new (NULL, NULL);
+      for (i = 0; i < n_gtypes; i++)
+        g_hash_table_add (result->gtype_set, GSIZE_TO_POINTER (gtypes[i]));
+    }
+
+  if (n_mime_types > HASH_THRESHOLD)
+    {
+      gsize i;
+
+      result->mime_type_set = g_hash_table_new (NULL, NULL);
+      for (i = 0; i < n_mime_types; i++)
+        g_hash_table_add (result->mime_type_set, (gpointer) mime_types[i]);
+    }
+
   return result;
 }
 
@@ -222,6 +248,8 @@ gdk_content_formats_unref (GdkContentFormats *formats)
 
   g_free (formats->gtypes);
   g_free (formats->mime_types);
+  g_clear_pointer (&formats->gtype_set, g_hash_table_unref);
+  g_clear_pointer (&formats->mime_type_set, g_hash_table_unref);
   g_slice_free (GdkContentFormats, formats);
 }
 
@@ -318,6 +346,9 @@ gdk_content_formats_contain_interned_mime_type (const GdkContentFormats *formats
 {
   gsize i;
 
+  if (formats->mime_type_set)
+    return g_hash_table_contains (formats->mime_type_set, mime_type);
+
   for (i = 0; i < formats->n_mime_types; i++)
     {
       if (mime_type == formats->mime_types[i])
@@ -422,6 +453,9 @@ gdk_content_formats_contain_gtype (const GdkContentFormats *formats,
 
   gsize i;
 
+  if (formats->gtype_set)
+    return g_hash_table_contains (formats->gtype_set, GSIZE_TO_POINTER (type));
+
   for (i = 0; i < formats->n_gtypes; i++)
     {
       if (type == formats->gtypes[i])
@@ -522,6 +556,10 @@ struct _GdkContentFormatsBuilder
   /* (element-type utf8) (interned) */
   GSList *mime_types;
   gsize n_mime_types;
+
+  /* (nullable), the same as the lists once they get long */
+  GHashTable *gtype_set;
+  GHashTable *mime_type_set;
 };
 
 G_DEFINE_BOXED_TYPE (GdkContentFormatsBuilder,
@@ -577,6 +615,8 @@ gdk_content_formats_builder_clear (GdkContentFormatsBuilder *builder)
 {
   g_clear_pointer (&builder->gtypes, g_slist_free);
   g_clear_pointer (&builder->mime_types, g_slist_free);
+  g_clear_pointer (&builder->gtype_set, g_hash_table_unref);
+  g_clear_pointer (&builder->mime_type_set, g_hash_table_unref);
 }
 
 /**
@@ -710,11 +750,28 @@ gdk_content_formats_builder_add_gtype (GdkContentFormatsBuilder *builder,
   g_return_if_fail (builder != NULL);
   g_return_if_fail (type != G_TYPE_INVALID);
 
-  if (g_slist_find (builder->gtypes, GSIZE_TO_POINTER (type)))
-    return;
+  if (builder->gtype_set)
+    {
+      if (!g_hash_table_add (builder->gtype_set, GSIZE_TO_POINTER (type)))
+        return;
+    }
+  else
+    {
+      if (g_slist_find (builder->gtypes, GSIZE_TO_POINTER (type)))
+        return;
+    }
 
   builder->gtypes = g_slist_prepend (builder->gtypes, GSIZE_TO_POINTER (type));
   builder->n_gtypes++;
+
+  if (builder->gtype_set == NULL && builder->n_gtypes > HASH_THRESHOLD)
+    {
+      GSList *l;
+
+      builder->gtype_set = g_hash_table_new (NULL, NULL);
+      for (l = builder->gtypes; l; l = l->next)
+        g_hash_table_add (builder->gtype_set, l->data);
+    }
 }
 
 /**
@@ -733,11 +790,28 @@ gdk_content_formats_builder_add_mime_type (GdkContentFormatsBuilder *builder,
 
   mime_type = g_intern_string (mime_type);
 
-  if (g_slist_find (builder->mime_types, mime_type))
-    return;
+  if (builder->mime_type_set)
+    {
+      if (!g_hash_table_add (builder->mime_type_set, (gpointer) mime_type))
+        return;
+    }
+  else
+    {
+      if (g_slist_find (builder->mime_types, mime_type))
+        return;
+    }
 
   builder->mime_types = g_slist_prepend (builder->mime_types, (gpointer) mime_type);
   builder->n_mime_types++;
+
+  if (builder->mime_type_set == NULL && builder->n_mime_types > HASH_THRESHOLD)
+    {
+      GSList *l;
+
+      builder->mime_type_set = g_hash_table_new (NULL, NULL);
+      for (l = builder->mime_types; l; l = l->next)
+        g_hash_table_add (builder->mime_type_set, l->data);
+    }
 }
 
 /* G_DEFINE_BOXED wants this */
@@ -25,6 +25,7 @@
 #include "gdkpixbuf.h"
 #include "filetransferportalprivate.h"
 #include "gdktextureprivate.h"
+#include "gdkmemorytextureprivate.h"
 #include "gdkrgba.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -600,6 +601,99 @@ pixbuf_serializer_finish (GObject      *source,
     gdk_content_serializer_return_success (serializer);
 }
 
+static void
+unpremultiply_argb32 (guchar *data,
+                      gsize   stride,
+                      int     width,
+                      int     height)
+{
+  int x, y;
+
+  /* Converts native endian premultiplied ARGB32 to
+   * non-premultiplied RGBA bytes in place
+   */
+  for (y = 0; y < height; y++)
+    {
+      guint32 *src = (guint32 *) (data + y * stride);
+      guchar *dest = data + y * stride;
+
+      for (x = 0; x < width; x++)
+        {
+          guint32 pixel = src[x];
+          guint alpha = pixel >> 24;
+
+          if (alpha == 0)
+            {
+              dest[x * 4 + 0] = 0;
+              dest[x * 4 + 1] = 0;
+              dest[x * 4 + 2] = 0;
+            }
+          else
+            {
+              dest[x * 4 + 0] = (((pixel & 0xff0000) >> 16) * 255 + alpha / 2) / alpha;
+              dest[x * 4 + 1] = (((pixel & 0x00ff00) >>  8) * 255 + alpha / 2) / alpha;
+              dest[x * 4 + 2] = (((pixel & 0x0000ff) >>  0) * 255 + alpha / 2) / alpha;
+            }
+          dest[x * 4 + 3] = alpha;
+        }
+    }
+}
+
+static void
+release_texture (guchar   *pixels,
+                 gpointer  texture)
+{
+  g_object_unref (texture);
+}
+
+/* Creates a pixbuf for @texture with as few copies of
+ * the image data as possible. Textures made from pixbufs
+ * are wrapped directly, everything else is downloaded
+ * once and converted in place.
+ */
+static GdkPixbuf *
+pixbuf_for_texture (GdkTexture *texture)
+{
+  int width = gdk_texture_get_width (texture);
+  int height = gdk_texture_get_height (texture);
+  guchar *data;
+  gsize stride;
+
+  if (GDK_IS_MEMORY_TEXTURE (texture))
+    {
+      GdkMemoryTexture *memtex = GDK_MEMORY_TEXTURE (texture);
+      GdkMemoryFormat format = gdk_memory_texture_get_format (memtex);
+
+      if (format == GDK_MEMORY_GDK_PIXBUF_ALPHA ||
+          format == GDK_MEMORY_GDK_PIXBUF_OPAQUE)
+        return gdk_pixbuf_new_from_data (gdk_memory_texture_get_data (memtex),
+                                         GDK_COLORSPACE_RGB,
+                                         format == GDK_MEMORY_GDK_PIXBUF_ALPHA,
+                                         8,
+                                         width, height,
+                                         gdk_memory_texture_get_stride (memtex),
+                                         release_texture,
+                                         g_object_ref (texture));
+    }
+
+  stride = (gsize) width * 4;
+  data = g_try_malloc_n (height, stride);
+  if (data == NULL)
+    return NULL;
+
+  gdk_texture_download (texture, data, stride);
+  unpremultiply_argb32 (data, stride, width, height);
+
+  return gdk_pixbuf_new_from_data (data,
+                                   GDK_COLORSPACE_RGB,
+                                   TRUE,
+                                   8,
+                                   width, height,
+                                   stride,
+                                   (GdkPixbufDestroyNotify) g_free,
+                                   NULL);
+}
+
 static void
 pixbuf_serializer (GdkContentSerializer *serializer)
 {
@@ -616,12 +710,14 @@ pixbuf_serializer (GdkContentSerializer *serializer)
     }
   else if (G_VALUE_HOLDS (value, GDK_TYPE_TEXTURE))
     {
-      GdkTexture *texture = g_value_get_object (value);
-      cairo_surface_t *surface = gdk_texture_download_surface (texture);
-      pixbuf = gdk_pixbuf_get_from_surface (surface,
-                                            0, 0,
-                                            gdk_texture_get_width (texture), gdk_texture_get_height (texture));
-      cairo_surface_destroy (surface);
+      pixbuf = pixbuf_for_texture (g_value_get_object (value));
+      if (pixbuf == NULL)
+        {
+          gdk_content_serializer_return_error (serializer,
+                                               g_error_new (G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                                                            "Not enough memory to serialize the texture"));
+          return;
+        }
     }
   else
     {
@@ -660,8 +756,30 @@ string_serializer (GdkContentSerializer *serializer)
   GCharsetConverter *converter;
   GError *error = NULL;
   const char *text;
+  const char *charset;
+
+  text = g_value_get_string (gdk_content_serializer_get_value (serializer));
+  if (text == NULL)
+    text = "";
 
-  converter = g_charset_converter_new (gdk_content_serializer_get_user_data (serializer),
+  charset = gdk_content_serializer_get_user_data (serializer);
+
+  /* Our strings are already UTF-8, so skip converting them,
+   * which would hold a second copy of the text in the filter
+   */
+  if (g_ascii_strcasecmp (charset, "utf-8") == 0)
+    {
+      g_output_stream_write_all_async (gdk_content_serializer_get_output_stream (serializer),
+                                       text,
+                                       strlen (text),
+                                       gdk_content_serializer_get_priority (serializer),
+                                       gdk_content_serializer_get_cancellable (serializer),
+                                       string_serializer_finish,
+                                       serializer);
+      return;
+    }
+
+  converter = g_charset_converter_new (charset,
                                        "utf-8",
                                        &error);
   if (converter == NULL)
@@ -675,10 +793,6 @@ string_serializer (GdkContentSerializer *serializer)
                                           G_CONVERTER (converter));
   g_object_unref (converter);
 
-  text = g_value_get_string (gdk_content_serializer_get_value (serializer));
-  if (text == NULL)
-    text = "";
-
   g_output_stream_write_all_async (filter,
                                    text,
                                    strlen (text),
@@ -0,0 +1,408 @@
+/* gdkdmabuftexture.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkdmabuftextureprivate.h"
+
+#include "gdkglcontext.h"
+#include "gdkintl.h"
+#include "gdkmemorytextureprivate.h"
+
+#include <gio/gio.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifdef HAVE_LINUX_DMA_BUF_H
+#include <sys/ioctl.h>
+#include <linux/dma-buf.h>
+#endif
+
+#ifdef GDK_WINDOWING_WAYLAND
+#include "wayland/gdkwayland.h"
+#include <epoxy/egl.h>
+#endif
+
+#include <epoxy/gl.h>
+
+/* We don't want to depend on libdrm just for these */
+#define fourcc_code(a, b, c, d) ((guint32) (a) | ((guint32) (b) << 8) | \
+                                 ((guint32) (c) << 16) | ((guint32) (d) << 24))
+
+#define DRM_FORMAT_RGB888       fourcc_code ('R', 'G', '2', '4')
+#define DRM_FORMAT_BGR888       fourcc_code ('B', 'G', '2', '4')
+#define DRM_FORMAT_XRGB8888     fourcc_code ('X', 'R', '2', '4')
+#define DRM_FORMAT_XBGR8888     fourcc_code ('X', 'B', '2', '4')
+#define DRM_FORMAT_ARGB8888     fourcc_code ('A', 'R', '2', '4')
+#define DRM_FORMAT_ABGR8888     fourcc_code ('A', 'B', '2', '4')
+
+#define DRM_FORMAT_MOD_LINEAR   0
+#define DRM_FORMAT_MOD_INVALID  ((G_GUINT64_CONSTANT (1) << 56) - 1)
+
+/* DRM formats are little-endian, so the memory formats
+ * list the components in the reverse order of the fourcc */
+static const struct {
+  guint32 fourcc;
+  GdkMemoryFormat format;
+  gboolean opaque;
+} supported_formats[] = {
+  { DRM_FORMAT_ARGB8888, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED, FALSE },
+  { DRM_FORMAT_ABGR8888, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, FALSE },
+  { DRM_FORMAT_XRGB8888, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED, TRUE },
+  { DRM_FORMAT_XBGR8888, GDK_MEMORY_R8G8B8A8_PREMULTIPLIED, TRUE },
+  { DRM_FORMAT_RGB888, GDK_MEMORY_B8G8R8, FALSE },
+  { DRM_FORMAT_BGR888, GDK_MEMORY_R8G8B8, FALSE },
+};
+
+struct _GdkDmabufTexture {
+  GdkTexture parent_instance;
+
+  guint32 fourcc;
+  guint64 modifier;
+  GdkMemoryFormat format;
+  gboolean opaque;
+
+  guint n_planes;
+  int fds[GDK_DMABUF_MAX_PLANES];
+  guint strides[GDK_DMABUF_MAX_PLANES];
+  guint offsets[GDK_DMABUF_MAX_PLANES];
+
+  GDestroyNotify destroy;
+  gpointer data;
+};
+
+struct _GdkDmabufTextureClass {
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkDmabufTexture, gdk_dmabuf_texture, GDK_TYPE_TEXTURE)
+
+static void
+gdk_dmabuf_texture_dispose (GObject *object)
+{
+  GdkDmabufTexture *self = GDK_DMABUF_TEXTURE (object);
+
+  if (self->destroy)
+    {
+      self->destroy (self->data);
+      self->destroy = NULL;
+      self->data = NULL;
+    }
+
+  self->n_planes = 0;
+
+  G_OBJECT_CLASS (gdk_dmabuf_texture_parent_class)->dispose (object);
+}
+
+static void
+clear_area (const GdkRectangle *area,
+            guchar             *data,
+            gsize               stride)
+{
+  int y;
+
+  for (y = 0; y < area->height; y++)
+    memset (data + y * stride, 0, area->width * 4);
+}
+
+static void
+gdk_dmabuf_texture_download (GdkTexture         *texture,
+                             const GdkRectangle *area,
+                             guchar             *data,
+                             gsize               stride)
+{
+  GdkDmabufTexture *self = GDK_DMABUF_TEXTURE (texture);
+#ifdef HAVE_SYS_MMAN_H
+  gsize size, bpp;
+  guchar *map;
+  int x, y;
+
+  if (self->n_planes == 0 ||
+      (self->modifier != DRM_FORMAT_MOD_LINEAR &&
+       self->modifier != DRM_FORMAT_MOD_INVALID))
+    {
+      /* Tiled layouts can only be read by the GPU */
+      clear_area (area, data, stride);
+      return;
+    }
+
+  size = self->offsets[0] + (gsize) self->strides[0] * texture->height;
+  map = mmap (NULL, size, PROT_READ, MAP_SHARED, self->fds[0], 0);
+  if (map == MAP_FAILED)
+    {
+      g_warning ("Failed to map dmabuf: %s", g_strerror (errno));
+      clear_area (area, data, stride);
+      return;
+    }
+
+#ifdef HAVE_LINUX_DMA_BUF_H
+  {
+    struct dma_buf_sync sync = { DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ };
+    ioctl (self->fds[0], DMA_BUF_IOCTL_SYNC, &sync);
+  }
+#endif
+
+  bpp = gdk_memory_format_bytes_per_pixel (self->format);
+  gdk_memory_convert (data, stride,
+                      GDK_MEMORY_CAIRO_FORMAT_ARGB32,
+                      map + self->offsets[0]
+                        + area->x * bpp
+                        + area->y * self->strides[0],
+                      self->strides[0],
+                      self->format,
+                      area->width, area->height);
+
+#ifdef HAVE_LINUX_DMA_BUF_H
+  {
+    struct dma_buf_sync sync = { DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ };
+    ioctl (self->fds[0], DMA_BUF_IOCTL_SYNC, &sync);
+  }
+#endif
+
+  munmap (map, size);
+
+  if (self->opaque)
+    {
+      for (y = 0; y < area->height; y++)
+        {
+          guint32 *row = (guint32 *) (data + y * stride);
+
+          for (x = 0; x < area->width; x++)
+            row[x] |= 0xff000000;
+        }
+    }
+#else
+  clear_area (area, data, stride);
+#endif
+}
+
+static void
+gdk_dmabuf_texture_class_init (GdkDmabufTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_dmabuf_texture_download;
+  gobject_class->dispose = gdk_dmabuf_texture_dispose;
+}
+
+static void
+gdk_dmabuf_texture_init (GdkDmabufTexture *self)
+{
+}
+
+guint32
+gdk_dmabuf_texture_get_fourcc (GdkDmabufTexture *self)
+{
+  return self->fourcc;
+}
+
+guint64
+gdk_dmabuf_texture_get_modifier (GdkDmabufTexture *self)
+{
+  return self->modifier;
+}
+
+/*<private>
+ * gdk_dmabuf_texture_import_gl:
+ * @self: a #GdkDmabufTexture
+ * @target: the GL texture target
+ *
+ * Makes the dmabuf the storage of the GL texture that is currently
+ * bound to @target in the current GL context, without copying.
+ *
+ * This only works with EGL, when the dma-buf import extensions are
+ * available. Otherwise the contents have to be uploaded from
+ * gdk_texture_download().
+ *
+ * Returns: %TRUE if the dmabuf was imported
+ */
+gboolean
+gdk_dmabuf_texture_import_gl (GdkDmabufTexture *self,
+                              guint             target)
+{
+#ifdef GDK_WINDOWING_WAYLAND
+  static const EGLint plane_attribs[GDK_DMABUF_MAX_PLANES][5] = {
+    { EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE3_FD_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT, EGL_DMA_BUF_PLANE3_PITCH_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT },
+  };
+  GdkTexture *texture = GDK_TEXTURE (self);
+  GdkGLContext *context;
+  EGLDisplay egl_display;
+  EGLImageKHR image;
+  EGLint attribs[6 + GDK_DMABUF_MAX_PLANES * 10 + 1];
+  guint i, n = 0;
+
+  g_return_val_if_fail (GDK_IS_DMABUF_TEXTURE (self), FALSE);
+
+  context = gdk_gl_context_get_current ();
+  if (context == NULL || !GDK_WAYLAND_IS_GL_CONTEXT (context) || self->n_planes == 0)
+    return FALSE;
+
+  egl_display = eglGetCurrentDisplay ();
+  if (egl_display == EGL_NO_DISPLAY ||
+      !epoxy_has_egl_extension (egl_display, "EGL_EXT_image_dma_buf_import") ||
+      (self->modifier != DRM_FORMAT_MOD_INVALID &&
+       !epoxy_has_egl_extension (egl_display, "EGL_EXT_image_dma_buf_import_modifiers")) ||
+      !epoxy_has_gl_extension ("GL_OES_EGL_image"))
+    return FALSE;
+
+  attribs[n++] = EGL_WIDTH;
+  attribs[n++] = texture->width;
+  attribs[n++] = EGL_HEIGHT;
+  attribs[n++] = texture->height;
+  attribs[n++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attribs[n++] = self->fourcc;
+
+  for (i = 0; i < self->n_planes; i++)
+    {
+      attribs[n++] = plane_attribs[i][0];
+      attribs[n++] = self->fds[i];
+      attribs[n++] = plane_attribs[i][1];
+      attribs[n++] = self->offsets[i];
+      attribs[n++] = plane_attribs[i][2];
+      attribs[n++] = self->strides[i];
+      if (self->modifier != DRM_FORMAT_MOD_INVALID)
+        {
+          attribs[n++] = plane_attribs[i][3];
+          attribs[n++] = self->modifier & 0xFFFFFFFF;
+          attribs[n++] = plane_attribs[i][4];
+          attribs[n++] = self->modifier >> 32;
+        }
+    }
+
+  attribs[n++] = EGL_NONE;
+
+  image = eglCreateImageKHR (egl_display,
+                             EGL_NO_CONTEXT,
+                             EGL_LINUX_DMA_BUF_EXT,
+                             (EGLClientBuffer) NULL,
+                             attribs);
+  if (image == EGL_NO_IMAGE_KHR)
+    return FALSE;
+
+  glEGLImageTargetTexture2DOES (target, image);
+
+  /* The texture keeps the buffer alive */
+  eglDestroyImageKHR (egl_display, image);
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * gdk_dmabuf_texture_new:
+ * @width: the width of the texture
+ * @height: the height of the texture
+ * @fourcc: the DRM fourcc of the buffer's format
+ * @modifier: the DRM format modifier of the buffer's layout, or
+ *     `DRM_FORMAT_MOD_INVALID` for an implicit layout
+ * @n_planes: the number of planes
+ * @fds: (array length=n_planes): the dmabuf file descriptors of the planes
+ * @strides: (array length=n_planes): the strides of the planes, in bytes
+ * @offsets: (array length=n_planes): the offsets of the planes, in bytes
+ * @destroy: a destroy notify that will be called when the texture
+ *     no longer needs the buffer
+ * @data: data that gets passed to @destroy
+ *
+ * Creates a new texture for a DMA buffer.
+ *
+ * The renderers import the buffer directly when they can, so that the
+ * contents don't need to be copied. Otherwise the contents are read
+ * from a mapping of the buffer, which only works for linear layouts.
+ *
+ * The file descriptors are not closed by the texture. They must stay
+ * valid and the buffer contents must not be changed until @destroy is
+ * called, which will happen when the texture is finalized.
+ *
+ * Currently only single-plane 8-bit RGB formats are supported.
+ *
+ * Returns: (transfer full) (nullable): A newly-created #GdkTexture,
+ *     or %NULL if the format is not supported
+ *
+ * Since: 4.2
+ */
+GdkTexture *
+gdk_dmabuf_texture_new (int              width,
+                        int              height,
+                        guint32          fourcc,
+                        guint64          modifier,
+                        guint            n_planes,
+                        const int       *fds,
+                        const guint     *strides,
+                        const guint     *offsets,
+                        GDestroyNotify   destroy,
+                        gpointer         data,
+                        GError         **error)
+{
+  GdkDmabufTexture *self;
+  guint i;
+
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+  g_return_val_if_fail (n_planes > 0 && n_planes <= GDK_DMABUF_MAX_PLANES, NULL);
+  g_return_val_if_fail (fds != NULL, NULL);
+  g_return_val_if_fail (strides != NULL, NULL);
+  g_return_val_if_fail (offsets != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (supported_formats); i++)
+    {
+      if (supported_formats[i].fourcc == fourcc)
+        break;
+    }
+
+  if (i == G_N_ELEMENTS (supported_formats) || n_planes != 1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   _("Unsupported dmabuf format %.4s with %u planes"),
+                   (const char *) &fourcc, n_planes);
+      return NULL;
+    }
+
+  self = g_object_new (GDK_TYPE_DMABUF_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       NULL);
+
+  self->fourcc = fourcc;
+  self->modifier = modifier;
+  self->format = supported_formats[i].format;
+  self->opaque = supported_formats[i].opaque;
+  self->n_planes = n_planes;
+  for (i = 0; i < n_planes; i++)
+    {
+      self->fds[i] = fds[i];
+      self->strides[i] = strides[i];
+      self->offsets[i] = offsets[i];
+    }
+  self->destroy = destroy;
+  self->data = data;
+
+  return GDK_TEXTURE (self);
+}
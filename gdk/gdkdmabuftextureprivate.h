@@ -0,0 +1,18 @@
+#ifndef __GDK_DMABUF_TEXTURE_PRIVATE_H__
+#define __GDK_DMABUF_TEXTURE_PRIVATE_H__
+
+#include "gdkdmabuftexture.h"
+
+#include "gdktextureprivate.h"
+
+G_BEGIN_DECLS
+
+guint32                 gdk_dmabuf_texture_get_fourcc      (GdkDmabufTexture       *self);
+guint64                 gdk_dmabuf_texture_get_modifier    (GdkDmabufTexture       *self);
+
+gboolean                gdk_dmabuf_texture_import_gl       (GdkDmabufTexture       *self,
+                                                            guint                   target);
+
+G_END_DECLS
+
+#endif /* __GDK_DMABUF_TEXTURE_PRIVATE_H__ */
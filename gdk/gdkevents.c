@@ -426,6 +426,21 @@ gdk_event_alloc (GdkEventType event_type,
   return event;
 }
 
+/* Pointer events keep their axes inline, so creating one
+ * doesn't need a separate allocation
+ */
+static double *
+gdk_event_copy_axes (double        storage[GDK_AXIS_LAST],
+                     const double *axes)
+{
+  if (axes == NULL)
+    return NULL;
+
+  memcpy (storage, axes, sizeof (double) * GDK_AXIS_LAST);
+
+  return storage;
+}
+
 static void
 gdk_event_init_types_once (void)
 {
@@ -601,6 +616,43 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+/* Event compression hands out a history array with almost every
+ * motion event that gets delivered while the pointer is moving, so
+ * keep the arrays of freed events around instead of reallocating
+ * them. Events are only ever created and freed on the main thread.
+ */
+#define MAX_CACHED_HISTORIES 16
+#define MAX_CACHED_HISTORY_LENGTH 128
+
+static GArray *cached_histories[MAX_CACHED_HISTORIES];
+static guint n_cached_histories;
+
+static GArray *
+gdk_event_history_new (void)
+{
+  if (n_cached_histories > 0)
+    return cached_histories[--n_cached_histories];
+
+  return g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+}
+
+static void
+gdk_event_history_free (GArray *history)
+{
+  if (history == NULL)
+    return;
+
+  if (n_cached_histories == MAX_CACHED_HISTORIES ||
+      history->len > MAX_CACHED_HISTORY_LENGTH)
+    {
+      g_array_free (history, TRUE);
+      return;
+    }
+
+  g_array_set_size (history, 0);
+  cached_histories[n_cached_histories++] = history;
+}
+
 /*
  * If the last N events in the event queue are smooth scroll events
  * for the same surface and device, combine them into one.
@@ -657,7 +709,7 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
       double dx, dy;
 
       if (!history)
-        history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+        history = gdk_event_history_new ();
 
       gdk_scroll_event_get_deltas (event, &dx, &dy);
       delta_x += dx;
@@ -710,34 +762,49 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
     }
 }
 
+/*
+ * Appends the position and axes of @history_event to the history
+ * of @event. Both need to be motion events, or both touch updates.
+ */
 static void
-gdk_motion_event_push_history (GdkEvent *event,
-                               GdkEvent *history_event)
+gdk_event_push_history (GdkEvent *event,
+                        GdkEvent *history_event)
 {
-  GdkMotionEvent *self = (GdkMotionEvent *) event;
+  GArray **history;
   GdkDeviceTool *tool;
   GdkTimeCoord hist;
+  double *axes;
+  guint n_axes;
   int i;
 
-  g_assert (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY));
-  g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_MOTION_NOTIFY));
+  g_assert (event->event_type == history_event->event_type);
 
-  if (!self->tool)
-    return;
-
-  tool = gdk_event_get_device_tool (history_event);
+  if (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
+    history = &((GdkMotionEvent *) event)->history;
+  else
+    history = &((GdkTouchEvent *) event)->history;
 
   memset (&hist, 0, sizeof (GdkTimeCoord));
   hist.time = gdk_event_get_time (history_event);
-  hist.flags = gdk_device_tool_get_axes (tool);
+
+  /* Devices without a tool, like mice, only report a position */
+  tool = gdk_event_get_device_tool (history_event);
+  if (tool)
+    hist.flags = gdk_device_tool_get_axes (tool);
+  if (!gdk_event_get_axes (history_event, &axes, &n_axes) || axes == NULL)
+    hist.flags = 0;
+  hist.flags |= GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
 
   for (i = GDK_AXIS_X; i < GDK_AXIS_LAST; i++)
-    gdk_event_get_axis (history_event, i, &hist.axes[i]);
+    {
+      if (hist.flags & (1 << i))
+        gdk_event_get_axis (history_event, i, &hist.axes[i]);
+    }
 
-  if (G_UNLIKELY (!self->history))
-    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+  if (G_UNLIKELY (!*history))
+    *history = gdk_event_history_new ();
 
-  g_array_append_val (self->history, hist);
+  g_array_append_val (*history, hist);
 }
 
 void
@@ -793,7 +860,7 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
           if (state &
               (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
                GDK_BUTTON4_MASK | GDK_BUTTON5_MASK))
-           gdk_motion_event_push_history (last_motion, pending_motions->data);
+           gdk_event_push_history (last_motion, pending_motions->data);
         }
 
       gdk_event_unref (pending_motions->data);
@@ -810,6 +877,70 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
     }
 }
 
+/*
+ * If the last N events in the event queue are touch updates for
+ * the same touch sequence, drop all but the last and keep their
+ * positions in its history.
+ */
+void
+gdk_event_queue_handle_touch_compression (GdkDisplay *display)
+{
+  GList *l;
+  GdkSurface *surface = NULL;
+  GdkDevice *device = NULL;
+  GdkEventSequence *sequence = NULL;
+  GdkEvent *last_event = NULL;
+  GList *updates = NULL;
+
+  l = g_queue_peek_tail_link (&display->queued_events);
+
+  while (l)
+    {
+      GdkEvent *event = l->data;
+
+      if (event->flags & GDK_EVENT_PENDING)
+        break;
+
+      if (event->event_type != GDK_TOUCH_UPDATE)
+        break;
+
+      if (last_event != NULL &&
+          (surface != event->surface ||
+           device != event->device ||
+           sequence != gdk_event_get_event_sequence (event)))
+        break;
+
+      if (!last_event)
+        last_event = event;
+
+      surface = event->surface;
+      device = event->device;
+      sequence = gdk_event_get_event_sequence (event);
+      updates = l;
+
+      l = l->prev;
+    }
+
+  while (updates && updates->next != NULL)
+    {
+      GList *next = updates->next;
+
+      gdk_event_push_history (last_event, updates->data);
+
+      gdk_event_unref (updates->data);
+      g_queue_delete_link (&display->queued_events, updates);
+      updates = next;
+    }
+
+  if (g_queue_get_length (&display->queued_events) == 1 &&
+      g_queue_peek_head_link (&display->queued_events) == updates)
+    {
+      GdkFrameClock *clock = gdk_surface_get_frame_clock (surface);
+      if (clock) /* might be NULL if surface was destroyed */
+        gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS);
+    }
+}
+
 void
 _gdk_event_queue_flush (GdkDisplay *display)
 {
@@ -1138,22 +1269,6 @@ gdk_event_get_axes (GdkEvent  *event,
   return GDK_EVENT_GET_CLASS (event)->get_axes (event, axes, n_axes);
 }
 
-double *
-gdk_event_dup_axes (GdkEvent *event)
-{
-  double *axes;
-  guint n_axes;
-
-  if (gdk_event_get_axes (event, &axes, &n_axes))
-    {
-      double *axes_copy = g_memdup (axes, n_axes * sizeof (double));
-
-      return axes_copy;
-    }
-
-  return NULL;
-}
-
 /**
  * gdk_event_get_event_type:
  * @event: a #GdkEvent
@@ -1342,7 +1457,6 @@ gdk_button_event_finalize (GdkEvent *event)
   GdkButtonEvent *self = (GdkButtonEvent *) event;
 
   g_clear_object (&self->tool);
-  g_clear_pointer (&self->axes, g_free);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -1419,7 +1533,7 @@ gdk_button_event_new (GdkEventType     type,
                       guint            button,
                       double           x,
                       double           y,
-                      double          *axes)
+                      const double    *axes)
 {
   g_return_val_if_fail (type == GDK_BUTTON_PRESS ||
                         type == GDK_BUTTON_RELEASE, NULL);
@@ -1427,7 +1541,7 @@ gdk_button_event_new (GdkEventType     type,
   GdkButtonEvent *self = gdk_event_alloc (type, surface, device, time);
 
   self->tool = tool != NULL ? g_object_ref (tool) : NULL;
-  self->axes = axes;
+  self->axes = gdk_event_copy_axes (self->axes_storage, axes);
   self->state = state;
   self->button = button;
   self->x = x;
@@ -1858,7 +1972,7 @@ gdk_touch_event_finalize (GdkEvent *event)
 {
   GdkTouchEvent *self = (GdkTouchEvent *) event;
 
-  g_clear_pointer (&self->axes, g_free);
+  gdk_event_history_free (self->history);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -1936,7 +2050,7 @@ gdk_touch_event_new (GdkEventType      type,
                      GdkModifierType   state,
                      double            x,
                      double            y,
-                     double           *axes,
+                     const double     *axes,
                      gboolean          emulating)
 {
   GdkTouchEvent *self;
@@ -1951,7 +2065,7 @@ gdk_touch_event_new (GdkEventType      type,
   self->state = state;
   self->x = x;
   self->y = y;
-  self->axes = axes;
+  self->axes = gdk_event_copy_axes (self->axes_storage, axes);
   self->touch_emulating = emulating;
   self->pointer_emulated = emulating;
 
@@ -2228,8 +2342,7 @@ gdk_scroll_event_finalize (GdkEvent *event)
   GdkScrollEvent *self = (GdkScrollEvent *) event;
 
   g_clear_object (&self->tool);
-  if (self->history)
-    g_array_free (self->history, TRUE);
+  gdk_event_history_free (self->history);
 
   GDK_EVENT_SUPER (self)->finalize (event);
 }
@@ -2767,9 +2880,7 @@ gdk_motion_event_finalize (GdkEvent *event)
   GdkMotionEvent *self = (GdkMotionEvent *) event;
 
   g_clear_object (&self->tool);
-  g_clear_pointer (&self->axes, g_free);
-  if (self->history)
-    g_array_free (self->history, TRUE);
+  gdk_event_history_free (self->history);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -2843,7 +2954,7 @@ gdk_motion_event_new (GdkSurface      *surface,
                       GdkModifierType  state,
                       double           x,
                       double           y,
-                      double          *axes)
+                      const double    *axes)
 {
   GdkMotionEvent *self = gdk_event_alloc (GDK_MOTION_NOTIFY, surface, device, time);
 
@@ -2851,7 +2962,7 @@ gdk_motion_event_new (GdkSurface      *surface,
   self->state = state;
   self->x = x;
   self->y = y;
-  self->axes = axes;
+  self->axes = gdk_event_copy_axes (self->axes_storage, axes);
   self->state = state;
 
   return (GdkEvent *) self;
@@ -2859,7 +2970,7 @@ gdk_motion_event_new (GdkSurface      *surface,
 
 /**
  * gdk_event_get_history:
- * @event: a motion or scroll #GdkEvent
+ * @event: a motion, touch update or scroll #GdkEvent
  * @out_n_coords: (out): Return location for the length of the returned array
  *
  * Retrieves the history of the @event, as a list of time and coordinates.
@@ -2867,8 +2978,8 @@ gdk_motion_event_new (GdkSurface      *surface,
  * The history includes events that are not delivered to the application
  * because they occurred in the same frame as @event.
  *
- * Note that only motion and scroll events record history, and motion
- * events only if one of the mouse buttons is down.
+ * Note that only motion, touch update and scroll events record history,
+ * and motion events only if one of the mouse buttons is down.
  *
  * Returns: (transfer container) (array length=out_n_coords) (nullable): an
  *   array of time and coordinates
@@ -2881,6 +2992,7 @@ gdk_event_get_history (GdkEvent *event,
 
   g_return_val_if_fail (GDK_IS_EVENT (event), NULL);
   g_return_val_if_fail (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE) ||
                         GDK_IS_EVENT_TYPE (event, GDK_SCROLL), NULL);
   g_return_val_if_fail (out_n_coords != NULL, NULL);
 
@@ -2889,6 +3001,11 @@ gdk_event_get_history (GdkEvent *event,
       GdkMotionEvent *self = (GdkMotionEvent *) event;
       history = self->history;
     }
+  else if (GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE))
+    {
+      GdkTouchEvent *self = (GdkTouchEvent *) event;
+      history = self->history;
+    }
   else
     {
       GdkScrollEvent *self = (GdkScrollEvent *) event;
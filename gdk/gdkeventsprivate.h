@@ -110,6 +110,7 @@ struct _GdkDeleteEvent
  * @y: the y coordinate of the pointer relative to the surface.
  * @axes: @x, @y translated to the axes of @device, or %NULL if @device is
  *   the mouse.
+ * @axes_storage: the storage that @axes points to, if it is set.
  * @history: (element-type GdkTimeCoord): a list of time and coordinates
  *   for other motion events that were compressed before delivering the
  *   current event
@@ -124,6 +125,7 @@ struct _GdkMotionEvent
   double x;
   double y;
   double *axes;
+  double axes_storage[GDK_AXIS_LAST];
   GdkDeviceTool *tool;
   GArray *history; /* <GdkTimeCoord> */
 };
@@ -141,6 +143,7 @@ struct _GdkMotionEvent
  * @y: the y coordinate of the pointer relative to the surface.
  * @axes: @x, @y translated to the axes of @device, or %NULL if @device is
  *   the mouse.
+ * @axes_storage: the storage that @axes points to, if it is set.
  * @tool: a #GdkDeviceTool
  *
  * Used for button press and button release events. The
@@ -155,6 +158,7 @@ struct _GdkButtonEvent
   double x;
   double y;
   double *axes;
+  double axes_storage[GDK_AXIS_LAST];
   GdkDeviceTool *tool;
 };
 
@@ -167,8 +171,12 @@ struct _GdkButtonEvent
  * @y: the y coordinate of the pointer relative to the surface
  * @axes: @x, @y translated to the axes of the event's device, or %NULL
  *   if @device is the mouse
+ * @axes_storage: the storage that @axes points to, if it is set
  * @sequence: the event sequence that the event belongs to
  * @emulated: whether the event is the result of a pointer emulation
+ * @history: (element-type GdkTimeCoord): a list of time and coordinates
+ *   for other updates of @sequence that were compressed before delivering
+ *   the current event
  *
  * Used for touch events.
  * @type field will be one of %GDK_TOUCH_BEGIN, %GDK_TOUCH_UPDATE,
@@ -189,9 +197,11 @@ struct _GdkTouchEvent
   double x;
   double y;
   double *axes;
+  double axes_storage[GDK_AXIS_LAST];
   GdkEventSequence *sequence;
   gboolean touch_emulating;
   gboolean pointer_emulated;
+  GArray *history; /* <GdkTimeCoord> */
 };
 
 /*
@@ -435,7 +445,7 @@ GdkEvent * gdk_button_event_new         (GdkEventType     type,
                                          guint            button,
                                          double           x,
                                          double           y,
-                                         double          *axes);
+                                         const double    *axes);
 
 GdkEvent * gdk_motion_event_new         (GdkSurface      *surface,
                                          GdkDevice       *device,
@@ -444,7 +454,7 @@ GdkEvent * gdk_motion_event_new         (GdkSurface      *surface,
                                          GdkModifierType  state,
                                          double           x,
                                          double           y,
-                                         double          *axes);
+                                         const double    *axes);
 
 GdkEvent * gdk_crossing_event_new       (GdkEventType     type,
                                          GdkSurface      *surface,
@@ -503,7 +513,7 @@ GdkEvent * gdk_touch_event_new          (GdkEventType      type,
                                          GdkModifierType   state,
                                          double            x,
                                          double            y,
-                                         double           *axes,
+                                         const double     *axes,
                                          gboolean          emulating);
 
 GdkEvent * gdk_touchpad_event_new_swipe (GdkSurface      *surface,
@@ -601,11 +611,9 @@ GList* _gdk_event_queue_append       (GdkDisplay *display,
 
 void    _gdk_event_queue_handle_motion_compression (GdkDisplay *display);
 void    gdk_event_queue_handle_scroll_compression  (GdkDisplay *display);
+void    gdk_event_queue_handle_touch_compression   (GdkDisplay *display);
 void    _gdk_event_queue_flush                     (GdkDisplay       *display);
 
-double * gdk_event_dup_axes (GdkEvent *event);
-
-
 G_END_DECLS
 
 #endif /* __GDK_EVENTS_PRIVATE_H__ */
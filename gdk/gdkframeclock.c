@@ -565,6 +565,10 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
     g_string_append_printf (str, " paint_start=%-4.1f", (timings->paint_start_time - timings->frame_time) / 1000.);
   if (timings->frame_end_time != 0)
     g_string_append_printf (str, " frame_end=%-4.1f", (timings->frame_end_time - timings->frame_time) / 1000.);
+  if (timings->paint_duration != 0)
+    g_string_append_printf (str, " paint=%-4.1f (render=%-4.1f)",
+                            timings->paint_duration / 1000.,
+                            timings->render_duration / 1000.);
   if (timings->drawn_time != 0)
     g_string_append_printf (str, " drawn=%-4.1f", (timings->drawn_time - timings->frame_time) / 1000.);
   if (timings->presentation_time != 0)
@@ -670,15 +674,49 @@ _gdk_frame_clock_emit_before_paint (GdkFrameClock *frame_clock)
   g_signal_emit (frame_clock, signals[BEFORE_PAINT], 0);
 }
 
+static void
+add_phase_duration (GdkFrameClock *frame_clock,
+                    gsize          offset,
+                    gint64         duration)
+{
+  GdkFrameTimings *timings;
+
+  timings = gdk_frame_clock_get_current_timings (frame_clock);
+  if (timings)
+    G_STRUCT_MEMBER (gint64, timings, offset) += duration;
+}
+
+/*< private >
+ * gdk_frame_clock_add_render_duration:
+ * @frame_clock: a #GdkFrameClock
+ * @duration: the time spent rendering, in microseconds
+ *
+ * Records time spent in the GSK renderer for the current frame.
+ */
+void
+gdk_frame_clock_add_render_duration (GdkFrameClock *frame_clock,
+                                     gint64         duration)
+{
+  add_phase_duration (frame_clock,
+                      G_STRUCT_OFFSET (GdkFrameTimings, render_duration),
+                      duration);
+}
+
 void
 _gdk_frame_clock_emit_update (GdkFrameClock *frame_clock)
 {
   gint64 before G_GNUC_UNUSED;
+  gint64 start;
 
   before = GDK_PROFILER_CURRENT_TIME;
+  start = g_get_monotonic_time ();
 
   g_signal_emit (frame_clock, signals[UPDATE], 0);
 
+  add_phase_duration (frame_clock,
+                      G_STRUCT_OFFSET (GdkFrameTimings, update_duration),
+                      g_get_monotonic_time () - start);
+
   gdk_profiler_end_mark (before, "frameclock update", NULL);
 }
 
@@ -686,11 +724,17 @@ void
 _gdk_frame_clock_emit_layout (GdkFrameClock *frame_clock)
 {
   gint64 before G_GNUC_UNUSED;
+  gint64 start;
 
   before = GDK_PROFILER_CURRENT_TIME;
+  start = g_get_monotonic_time ();
 
   g_signal_emit (frame_clock, signals[LAYOUT], 0);
 
+  add_phase_duration (frame_clock,
+                      G_STRUCT_OFFSET (GdkFrameTimings, layout_duration),
+                      g_get_monotonic_time () - start);
+
   gdk_profiler_end_mark (before, "frameclock layout", NULL);
 }
 
@@ -698,11 +742,17 @@ void
 _gdk_frame_clock_emit_paint (GdkFrameClock *frame_clock)
 {
   gint64 before G_GNUC_UNUSED;
+  gint64 start;
 
   before = GDK_PROFILER_CURRENT_TIME;
+  start = g_get_monotonic_time ();
 
   g_signal_emit (frame_clock, signals[PAINT], 0);
 
+  add_phase_duration (frame_clock,
+                      G_STRUCT_OFFSET (GdkFrameTimings, paint_duration),
+                      g_get_monotonic_time () - start);
+
   gdk_profiler_end_mark (before, "frameclock paint", NULL);
 }
 
@@ -26,6 +26,8 @@
 
 #include "gdkframeclockidleprivate.h"
 
+#include "gdk-private.h"
+
 #include "gdkinternals.h"
 #include "gdkframeclockprivate.h"
 #include "gdk.h"
@@ -37,6 +39,11 @@
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+/* Number of recent frames used to predict the cost of painting */
+#define N_PAINT_COSTS 8
+/* Time that is left before the deadline for the compositor */
+#define LATE_LATCH_MARGIN 2000 /* microseconds */
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -67,8 +74,12 @@ struct _GdkFrameClockIdlePrivate
   GdkFrameClockPhase requested;
   GdkFrameClockPhase phase;
 
+  gint64 paint_costs[N_PAINT_COSTS];   /* The time the last cycles took, in microseconds */
+  guint paint_cost_index;
+
   guint in_paint_idle : 1;
   guint paint_is_thaw : 1;
+  guint late_latching : 1;
 #ifdef G_OS_WIN32
   guint begin_period : 1;
 #endif
@@ -288,6 +299,45 @@ gdk_frame_clock_idle_get_frame_time (GdkFrameClock *clock)
    (((priv)->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||   \
     (priv)->updating_count > 0))
 
+static gint64
+predict_paint_cost (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 cost = 0;
+  guint i;
+
+  /* Frames costs are spiky, so be pessimistic */
+  for (i = 0; i < N_PAINT_COSTS; i++)
+    cost = MAX (cost, priv->paint_costs[i]);
+
+  return cost;
+}
+
+/* With late latching, we don't start the frame right when the
+ * backend unthrottles us but as late as we can while still making
+ * the next vblank. Everything that happens in the meantime, like
+ * input events, then makes it into this frame rather than the next.
+ */
+static guint
+get_late_latch_delay (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClock *clock = GDK_FRAME_CLOCK (clock_idle);
+  gint64 now, refresh_interval, presentation_time, start;
+
+  now = g_get_monotonic_time ();
+  gdk_frame_clock_get_refresh_info (clock, now, &refresh_interval, &presentation_time);
+
+  /* Without a known vblank phase we can't tell where the deadline is */
+  if (presentation_time == 0)
+    return 0;
+
+  start = presentation_time - predict_paint_cost (clock_idle) - LATE_LATCH_MARGIN;
+  if (start <= now)
+    return 0;
+
+  return (MIN (start - now, refresh_interval)) / 1000;
+}
+
 static void
 maybe_start_idle (GdkFrameClockIdle *clock_idle,
                   gboolean caused_by_thaw)
@@ -318,9 +368,14 @@ maybe_start_idle (GdkFrameClockIdle *clock_idle,
       if (!priv->in_paint_idle &&
 	  priv->paint_idle_id == 0 && RUN_PAINT_IDLE (priv))
         {
+          guint paint_interval = min_interval;
+
+          if (caused_by_thaw && priv->late_latching)
+            paint_interval = MAX (paint_interval, get_late_latch_delay (clock_idle));
+
           priv->paint_is_thaw = caused_by_thaw;
           priv->paint_idle_id = g_timeout_add_full (GDK_PRIORITY_REDRAW,
-                                                    min_interval,
+                                                    paint_interval,
                                                     gdk_frame_clock_paint_idle,
                                                     g_object_ref (clock_idle),
                                                     (GDestroyNotify) g_object_unref);
@@ -401,8 +456,10 @@ gdk_frame_clock_paint_idle (void *data)
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
   gint64 before G_GNUC_UNUSED;
+  gint64 cycle_start;
 
   before = GDK_PROFILER_CURRENT_TIME;
+  cycle_start = g_get_monotonic_time ();
 
   priv->paint_idle_id = 0;
   priv->in_paint_idle = TRUE;
@@ -428,13 +485,18 @@ gdk_frame_clock_paint_idle (void *data)
           if (priv->freeze_count == 0)
             {
               gint64 frame_interval = FRAME_INTERVAL;
+              gint64 presentation_time;
               GdkFrameTimings *prev_timings = gdk_frame_clock_get_current_timings (clock);
 
-              if (prev_timings && prev_timings->refresh_interval)
-                frame_interval = prev_timings->refresh_interval;
-
               priv->frame_time = g_get_monotonic_time ();
 
+              /* Prefer the refresh interval of the last frame that was
+               * actually presented, the backend may have measured it. */
+              gdk_frame_clock_get_refresh_info (clock, priv->frame_time,
+                                                &frame_interval, &presentation_time);
+              if (presentation_time == 0 && prev_timings && prev_timings->refresh_interval)
+                frame_interval = prev_timings->refresh_interval;
+
               /*
                * The first clock cycle of an animation might have been triggered by some external event. An external
                * event can be an input event, an expired timer, data arriving over the network etc. This can happen at
@@ -636,6 +698,12 @@ gdk_frame_clock_paint_idle (void *data)
 
   priv->in_paint_idle = FALSE;
 
+  if (!skip_to_resume_events)
+    {
+      priv->paint_costs[priv->paint_cost_index] = g_get_monotonic_time () - cycle_start;
+      priv->paint_cost_index = (priv->paint_cost_index + 1) % N_PAINT_COSTS;
+    }
+
   /* If there is throttling in the backend layer, then we'll do another
    * update as soon as the backend unthrottles (if there is work to do),
    * otherwise we need to figure when the next frame should be.
@@ -799,3 +867,58 @@ _gdk_frame_clock_idle_new (void)
 
   return GDK_FRAME_CLOCK (clock);
 }
+
+/*
+ * gdk_frame_clock_set_late_latching:
+ * @clock: a #GdkFrameClock
+ * @late_latching: whether to start frames as late as possible
+ *
+ * Sets whether the clock delays the start of a frame until shortly
+ * before the predicted deadline for the next vblank, instead of
+ * starting it as soon as the previous frame was presented.
+ *
+ * This reduces the latency between input and its result showing up
+ * on screen, at the risk of missing the deadline when a frame takes
+ * longer than the previous ones. It only has an effect when the
+ * backend reports presentation times.
+ */
+void
+gdk_frame_clock_set_late_latching (GdkFrameClock *clock,
+                                   gboolean       late_latching)
+{
+  g_return_if_fail (GDK_IS_FRAME_CLOCK (clock));
+
+  if (!GDK_IS_FRAME_CLOCK_IDLE (clock))
+    return;
+
+  GDK_FRAME_CLOCK_IDLE (clock)->priv->late_latching = late_latching;
+}
+
+gboolean
+gdk_frame_clock_get_late_latching (GdkFrameClock *clock)
+{
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (clock), FALSE);
+
+  if (!GDK_IS_FRAME_CLOCK_IDLE (clock))
+    return FALSE;
+
+  return GDK_FRAME_CLOCK_IDLE (clock)->priv->late_latching;
+}
+
+/*
+ * gdk_frame_clock_get_predicted_paint_cost:
+ * @clock: a #GdkFrameClock
+ *
+ * Returns: the time a frame is expected to take, in microseconds,
+ *     or 0 if unknown
+ */
+gint64
+gdk_frame_clock_get_predicted_paint_cost (GdkFrameClock *clock)
+{
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (clock), 0);
+
+  if (!GDK_IS_FRAME_CLOCK_IDLE (clock))
+    return 0;
+
+  return predict_paint_cost (GDK_FRAME_CLOCK_IDLE (clock));
+}
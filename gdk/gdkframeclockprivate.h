@@ -96,6 +96,16 @@ struct _GdkFrameTimings
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
 
+  /* Time spent in the phases of the frame, in microseconds.
+   * These are always recorded, for the inspector's benefit.
+   * render_duration is the part of paint_duration spent in
+   * the GSK renderer.
+   */
+  gint64 update_duration;
+  gint64 layout_duration;
+  gint64 paint_duration;
+  gint64 render_duration;
+
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
   gint64 paint_start_time;
@@ -127,6 +137,9 @@ void _gdk_frame_clock_emit_paint         (GdkFrameClock *frame_clock);
 void _gdk_frame_clock_emit_after_paint   (GdkFrameClock *frame_clock);
 void _gdk_frame_clock_emit_resume_events (GdkFrameClock *frame_clock);
 
+void gdk_frame_clock_add_render_duration (GdkFrameClock *frame_clock,
+                                          gint64         duration);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_CLOCK_PRIVATE_H__ */
@@ -99,6 +99,8 @@
 
 #include <epoxy/gl.h>
 
+#include <string.h>
+
 typedef struct {
   GdkGLContext *shared_context;
 
@@ -121,6 +123,9 @@ typedef struct {
 
   int max_debug_label_length;
 
+  /* Pixel unpack buffer used to stream texture uploads */
+  guint upload_buffer;
+
   GdkGLContextPaintData *paint_data;
 } GdkGLContextPrivate;
 
@@ -162,7 +167,15 @@ gdk_gl_context_dispose (GObject *gobject)
 
   current = g_private_get (&thread_current_context);
   if (current == context)
-    g_private_replace (&thread_current_context, NULL);
+    {
+      if (priv->upload_buffer != 0)
+        {
+          glDeleteBuffers (1, &priv->upload_buffer);
+          priv->upload_buffer = 0;
+        }
+
+      g_private_replace (&thread_current_context, NULL);
+    }
 
   g_clear_object (&priv->shared_context);
 
@@ -222,6 +235,86 @@ gdk_gl_context_get_property (GObject    *gobject,
     }
 }
 
+/* Uploads smaller than this go straight from client memory */
+#define MIN_STREAMED_UPLOAD_SIZE (64 * 64 * 4)
+
+/* Copies (or converts) the pixel data into a freshly orphaned pixel
+ * unpack buffer and creates the texture from there. Orphaning means we
+ * never wait for the GPU to finish with the previous upload, and the
+ * driver can do the actual transfer asynchronously, overlapping it with
+ * whatever is still being rendered.
+ *
+ * Returns: %FALSE if the buffer could not be used, in which case the
+ *   caller has to upload from client memory.
+ */
+static gboolean
+upload_texture_streamed (GdkGLContext    *context,
+                         const guchar    *data,
+                         int              width,
+                         int              height,
+                         int              stride,
+                         GdkMemoryFormat  data_format,
+                         GdkMemoryFormat  upload_format,
+                         guint            bpp,
+                         guint            gl_internal_format,
+                         guint            gl_format,
+                         guint            gl_type,
+                         guint            texture_target)
+{
+  GdkGLContextPrivate *priv = gdk_gl_context_get_instance_private (context);
+  const gsize upload_stride = width * bpp;
+  const gsize size = upload_stride * height;
+  guchar *mapped;
+  gboolean unmapped;
+
+  if (priv->upload_buffer == 0)
+    glGenBuffers (1, &priv->upload_buffer);
+
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, priv->upload_buffer);
+  glBufferData (GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+  mapped = glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, size,
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (mapped == NULL)
+    {
+      glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+      return FALSE;
+    }
+
+  if (data_format != upload_format)
+    {
+      gdk_memory_convert (mapped, upload_stride, upload_format,
+                          data, stride, data_format,
+                          width, height);
+    }
+  else if (stride == upload_stride)
+    {
+      memcpy (mapped, data, size);
+    }
+  else
+    {
+      int i;
+
+      for (i = 0; i < height; i++)
+        memcpy (mapped + i * upload_stride, data + i * stride, upload_stride);
+    }
+
+  /* The contents of the buffer are undefined if this fails, which can
+   * happen e.g. on mode switches. */
+  unmapped = glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+
+  if (unmapped)
+    {
+      glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+      glTexImage2D (texture_target, 0, gl_internal_format, width, height, 0, gl_format, gl_type, NULL);
+      glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+    }
+
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+
+  return unmapped;
+}
+
 void
 gdk_gl_context_upload_texture (GdkGLContext    *context,
                                const guchar    *data,
@@ -232,58 +325,81 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
                                guint            texture_target)
 {
   GdkGLContextPrivate *priv = gdk_gl_context_get_instance_private (context);
+  GdkMemoryFormat upload_format;
   guchar *copy = NULL;
+  guint gl_internal_format;
   guint gl_format;
   guint gl_type;
   guint bpp;
 
   g_return_if_fail (GDK_IS_GL_CONTEXT (context));
 
-  if (priv->use_es)
+  /* Take the data as it is when GL can read it, which covers the
+   * formats of cairo surfaces and of opaque pixbufs. Everything else
+   * is converted, e.g. pixbufs with alpha, as GL can't premultiply.
+   */
+  if (data_format == GDK_MEMORY_R8G8B8) /* Pixbuf non-alpha data */
+    {
+      upload_format = GDK_MEMORY_R8G8B8;
+      gl_internal_format = priv->use_es ? GL_RGB : GL_RGBA;
+      gl_format = GL_RGB;
+      gl_type = GL_UNSIGNED_BYTE;
+      bpp = 3;
+    }
+  else if (priv->use_es)
     {
       /* GLES only supports rgba, so convert if necessary */
-      if (data_format != GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
-        {
-          copy = g_malloc (width * height * 4);
-          gdk_memory_convert (copy, width * 4,
-                              GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
-                              data, stride, data_format,
-                              width, height);
-          stride = width * 4;
-          data = copy;
-        }
-
+      upload_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      gl_internal_format = GL_RGBA;
+      gl_format = GL_RGBA;
+      gl_type = GL_UNSIGNED_BYTE;
       bpp = 4;
+    }
+  else if (data_format == GDK_MEMORY_R8G8B8A8_PREMULTIPLIED)
+    {
+      upload_format = GDK_MEMORY_R8G8B8A8_PREMULTIPLIED;
+      gl_internal_format = GL_RGBA;
       gl_format = GL_RGBA;
       gl_type = GL_UNSIGNED_BYTE;
+      bpp = 4;
+    }
+  else if (data_format == GDK_MEMORY_B8G8R8)
+    {
+      upload_format = GDK_MEMORY_B8G8R8;
+      gl_internal_format = GL_RGBA;
+      gl_format = GL_BGR;
+      gl_type = GL_UNSIGNED_BYTE;
+      bpp = 3;
     }
-  else
+  else /* Cairo surface format, convert if necessary */
     {
-      if (data_format == GDK_MEMORY_DEFAULT) /* Cairo surface format */
-        {
-          gl_format = GL_BGRA;
-          gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
-          bpp = 4;
-        }
-      else if (data_format == GDK_MEMORY_R8G8B8) /* Pixmap non-alpha data */
-        {
-          gl_format = GL_RGB;
-          gl_type = GL_UNSIGNED_BYTE;
-          bpp = 3;
-        }
-      else /* Fall-back, convert to cairo-surface-format */
-        {
-          copy = g_malloc (width * height * 4);
-          gdk_memory_convert (copy, width * 4,
-                              GDK_MEMORY_DEFAULT,
-                              data, stride, data_format,
-                              width, height);
-          stride = width * 4;
-          bpp = 4;
-          data = copy;
-          gl_format = GL_BGRA;
-          gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
-        }
+      upload_format = GDK_MEMORY_DEFAULT;
+      gl_internal_format = GL_RGBA;
+      gl_format = GL_BGRA;
+      gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
+      bpp = 4;
+    }
+
+  /* Pixel buffer objects are available on desktop GL >= 2.1 and
+   * OpenGL ES >= 3.0; mapping buffer ranges needs GL 3.0 on both.
+   */
+  if (priv->gl_version >= 30 &&
+      (gsize) width * height * bpp >= MIN_STREAMED_UPLOAD_SIZE &&
+      upload_texture_streamed (context, data, width, height, stride,
+                               data_format, upload_format, bpp,
+                               gl_internal_format, gl_format, gl_type,
+                               texture_target))
+    return;
+
+  if (data_format != upload_format)
+    {
+      copy = g_malloc (width * height * bpp);
+      gdk_memory_convert (copy, width * bpp,
+                          upload_format,
+                          data, stride, data_format,
+                          width, height);
+      stride = width * bpp;
+      data = copy;
     }
 
   /* GL_UNPACK_ROW_LENGTH is available on desktop GL, OpenGL ES >= 3.0, or if
@@ -293,7 +409,7 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
     {
       glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
 
-      glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, gl_format, gl_type, data);
+      glTexImage2D (texture_target, 0, gl_internal_format, width, height, 0, gl_format, gl_type, data);
       glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
     }
   else if ((!priv->use_es ||
@@ -301,14 +417,14 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
     {
       glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / bpp);
 
-      glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, gl_format, gl_type, data);
+      glTexImage2D (texture_target, 0, gl_internal_format, width, height, 0, gl_format, gl_type, data);
 
       glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
     }
   else
     {
       int i;
-      glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, gl_format, gl_type, NULL);
+      glTexImage2D (texture_target, 0, gl_internal_format, width, height, 0, gl_format, gl_type, NULL);
       for (i = 0; i < height; i++)
         glTexSubImage2D (texture_target, 0, 0, i, width, 1, gl_format, gl_type, data + (i * stride));
     }
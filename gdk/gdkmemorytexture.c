@@ -173,6 +173,476 @@ convert_memcpy (guchar       *dest_data,
     memcpy (dest_data + y * dest_stride, src_data + y * src_stride, 4 * width);
 }
 
+/* The per-pixel loops below are shared between the scalar converters
+ * and the vectorized ones, which use them for the pixels at the end
+ * of a row that don't fill a whole vector.
+ */
+static inline void
+swizzle_pixels (guchar       *dest_data,
+                const guchar *src_data,
+                gsize         n_pixels,
+                int A, int R, int G, int B)
+{
+  gsize x;
+
+  for (x = 0; x < n_pixels; x++)
+    {
+      dest_data[4 * x + A] = src_data[4 * x + 0];
+      dest_data[4 * x + R] = src_data[4 * x + 1];
+      dest_data[4 * x + G] = src_data[4 * x + 2];
+      dest_data[4 * x + B] = src_data[4 * x + 3];
+    }
+}
+
+static inline void
+swizzle_opaque_pixels (guchar       *dest_data,
+                       const guchar *src_data,
+                       gsize         n_pixels,
+                       int A, int R, int G, int B)
+{
+  gsize x;
+
+  for (x = 0; x < n_pixels; x++)
+    {
+      dest_data[4 * x + A] = 0xFF;
+      dest_data[4 * x + R] = src_data[3 * x + 0];
+      dest_data[4 * x + G] = src_data[3 * x + 1];
+      dest_data[4 * x + B] = src_data[3 * x + 2];
+    }
+}
+
+#define PREMULTIPLY(d,c,a) G_STMT_START { guint t = c * a + 0x80; d = ((t >> 8) + t) >> 8; } G_STMT_END
+
+static inline void
+swizzle_premultiply_pixels (guchar       *dest_data,
+                            const guchar *src_data,
+                            gsize         n_pixels,
+                            int A, int R, int G, int B,
+                            int A2, int R2, int G2, int B2)
+{
+  gsize x;
+
+  for (x = 0; x < n_pixels; x++)
+    {
+      dest_data[4 * x + A] = src_data[4 * x + A2];
+      PREMULTIPLY(dest_data[4 * x + R], src_data[4 * x + R2], src_data[4 * x + A2]);
+      PREMULTIPLY(dest_data[4 * x + G], src_data[4 * x + G2], src_data[4 * x + A2]);
+      PREMULTIPLY(dest_data[4 * x + B], src_data[4 * x + B2], src_data[4 * x + A2]);
+    }
+}
+
+/* Vectorized conversions
+ *
+ * On x86, we pick SSSE3 or AVX2 at runtime, both doing swizzles with
+ * a single byte shuffle and premultiplication in 16 bit lanes, with
+ * the same rounding as PREMULTIPLY(). NEON is part of the baseline
+ * on the ARM targets that have it, so we use it unconditionally.
+ *
+ * Each variant of a converter gets the suffix of its instruction set.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef HAVE_X86_SIMD
+
+/* Builds the byte shuffle moving 4 pixels from @src_index to the
+ * @dest_index positions. Indices of -1 clear the byte. */
+static void
+make_shuffle_mask (guint8    mask[16],
+                   const int dest_index[4],
+                   const int src_index[4],
+                   int       src_bpp)
+{
+  int p, c;
+
+  for (p = 0; p < 4; p++)
+    for (c = 0; c < 4; c++)
+      mask[4 * p + dest_index[c]] = src_index[c] < 0 ? 0x80 : src_bpp * p + src_index[c];
+}
+
+__attribute__((target ("ssse3"))) static void
+swizzle_ssse3 (guchar       *dest_data,
+               gsize         dest_stride,
+               const guchar *src_data,
+               gsize         src_stride,
+               gsize         width,
+               gsize         height,
+               int A, int R, int G, int B)
+{
+  guint8 m[16];
+  __m128i mask;
+  gsize x, y;
+
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { 0, 1, 2, 3 }, 4);
+  mask = _mm_loadu_si128 ((const __m128i *) m);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 4 <= width; x += 4)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) (src_data + 4 * x));
+          _mm_storeu_si128 ((__m128i *) (dest_data + 4 * x), _mm_shuffle_epi8 (v, mask));
+        }
+
+      swizzle_pixels (dest_data + 4 * x, src_data + 4 * x, width - x, A, R, G, B);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+__attribute__((target ("ssse3"))) static void
+swizzle_opaque_ssse3 (guchar       *dest_data,
+                      gsize         dest_stride,
+                      const guchar *src_data,
+                      gsize         src_stride,
+                      gsize         width,
+                      gsize         height,
+                      int A, int R, int G, int B)
+{
+  guint8 m[16];
+  __m128i mask, alpha;
+  gsize x, y;
+
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { -1, 0, 1, 2 }, 3);
+  mask = _mm_loadu_si128 ((const __m128i *) m);
+  alpha = _mm_set1_epi32 (0xFF << (8 * A));
+
+  for (y = 0; y < height; y++)
+    {
+      /* 4 pixels are 12 bytes, but we load 16, so make sure
+       * we don't read past the end of the row */
+      for (x = 0; 3 * x + 16 <= 3 * width; x += 4)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) (src_data + 3 * x));
+          v = _mm_or_si128 (_mm_shuffle_epi8 (v, mask), alpha);
+          _mm_storeu_si128 ((__m128i *) (dest_data + 4 * x), v);
+        }
+
+      swizzle_opaque_pixels (dest_data + 4 * x, src_data + 3 * x, width - x, A, R, G, B);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+/* Multiplies the 8 16-bit color values in @c with the alphas in @a,
+ * rounding exactly like PREMULTIPLY() */
+__attribute__((target ("ssse3"))) static inline __m128i
+premultiply_epu16_ssse3 (__m128i c,
+                         __m128i a)
+{
+  __m128i t = _mm_add_epi16 (_mm_mullo_epi16 (c, a), _mm_set1_epi16 (0x80));
+
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+__attribute__((target ("ssse3"))) static void
+swizzle_premultiply_ssse3 (guchar       *dest_data,
+                           gsize         dest_stride,
+                           const guchar *src_data,
+                           gsize         src_stride,
+                           gsize         width,
+                           gsize         height,
+                           int A, int R, int G, int B,
+                           int A2, int R2, int G2, int B2)
+{
+  guint8 m[16];
+  __m128i mask, alpha_mask, alpha_bytes, zero;
+  gsize x, y;
+
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { A2, R2, G2, B2 }, 4);
+  mask = _mm_loadu_si128 ((const __m128i *) m);
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { A, A, A, A }, 4);
+  alpha_mask = _mm_loadu_si128 ((const __m128i *) m);
+  alpha_bytes = _mm_set1_epi32 (0xFF << (8 * A));
+  zero = _mm_setzero_si128 ();
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 4 <= width; x += 4)
+        {
+          __m128i v, a, lo, hi;
+
+          v = _mm_loadu_si128 ((const __m128i *) (src_data + 4 * x));
+          v = _mm_shuffle_epi8 (v, mask);
+          a = _mm_shuffle_epi8 (v, alpha_mask);
+
+          lo = premultiply_epu16_ssse3 (_mm_unpacklo_epi8 (v, zero), _mm_unpacklo_epi8 (a, zero));
+          hi = premultiply_epu16_ssse3 (_mm_unpackhi_epi8 (v, zero), _mm_unpackhi_epi8 (a, zero));
+
+          /* Keep the original alpha */
+          v = _mm_or_si128 (_mm_and_si128 (v, alpha_bytes),
+                            _mm_andnot_si128 (alpha_bytes, _mm_packus_epi16 (lo, hi)));
+          _mm_storeu_si128 ((__m128i *) (dest_data + 4 * x), v);
+        }
+
+      swizzle_premultiply_pixels (dest_data + 4 * x, src_data + 4 * x, width - x,
+                                  A, R, G, B, A2, R2, G2, B2);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+/* AVX2 shuffles work within 128 bit lanes, which is fine for 4-byte
+ * pixels. Packed 3-byte pixels cross lanes, so the opaque swizzles
+ * stay at SSSE3. */
+__attribute__((target ("avx2"))) static void
+swizzle_avx2 (guchar       *dest_data,
+              gsize         dest_stride,
+              const guchar *src_data,
+              gsize         src_stride,
+              gsize         width,
+              gsize         height,
+              int A, int R, int G, int B)
+{
+  guint8 m[16];
+  __m256i mask;
+  gsize x, y;
+
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { 0, 1, 2, 3 }, 4);
+  mask = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) m));
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 8 <= width; x += 8)
+        {
+          __m256i v = _mm256_loadu_si256 ((const __m256i *) (src_data + 4 * x));
+          _mm256_storeu_si256 ((__m256i *) (dest_data + 4 * x), _mm256_shuffle_epi8 (v, mask));
+        }
+
+      swizzle_pixels (dest_data + 4 * x, src_data + 4 * x, width - x, A, R, G, B);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+#define swizzle_opaque_avx2 swizzle_opaque_ssse3
+
+__attribute__((target ("avx2"))) static inline __m256i
+premultiply_epu16_avx2 (__m256i c,
+                        __m256i a)
+{
+  __m256i t = _mm256_add_epi16 (_mm256_mullo_epi16 (c, a), _mm256_set1_epi16 (0x80));
+
+  return _mm256_srli_epi16 (_mm256_add_epi16 (t, _mm256_srli_epi16 (t, 8)), 8);
+}
+
+__attribute__((target ("avx2"))) static void
+swizzle_premultiply_avx2 (guchar       *dest_data,
+                          gsize         dest_stride,
+                          const guchar *src_data,
+                          gsize         src_stride,
+                          gsize         width,
+                          gsize         height,
+                          int A, int R, int G, int B,
+                          int A2, int R2, int G2, int B2)
+{
+  guint8 m[16];
+  __m256i mask, alpha_mask, alpha_bytes, zero;
+  gsize x, y;
+
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { A2, R2, G2, B2 }, 4);
+  mask = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) m));
+  make_shuffle_mask (m, (int[4]) { A, R, G, B }, (int[4]) { A, A, A, A }, 4);
+  alpha_mask = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) m));
+  alpha_bytes = _mm256_set1_epi32 (0xFF << (8 * A));
+  zero = _mm256_setzero_si256 ();
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 8 <= width; x += 8)
+        {
+          __m256i v, a, lo, hi;
+
+          v = _mm256_loadu_si256 ((const __m256i *) (src_data + 4 * x));
+          v = _mm256_shuffle_epi8 (v, mask);
+          a = _mm256_shuffle_epi8 (v, alpha_mask);
+
+          /* unpack and pack both work per lane, so they undo each other */
+          lo = premultiply_epu16_avx2 (_mm256_unpacklo_epi8 (v, zero), _mm256_unpacklo_epi8 (a, zero));
+          hi = premultiply_epu16_avx2 (_mm256_unpackhi_epi8 (v, zero), _mm256_unpackhi_epi8 (a, zero));
+
+          v = _mm256_or_si256 (_mm256_and_si256 (v, alpha_bytes),
+                               _mm256_andnot_si256 (alpha_bytes, _mm256_packus_epi16 (lo, hi)));
+          _mm256_storeu_si256 ((__m256i *) (dest_data + 4 * x), v);
+        }
+
+      swizzle_premultiply_pixels (dest_data + 4 * x, src_data + 4 * x, width - x,
+                                  A, R, G, B, A2, R2, G2, B2);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+#define X86_VARIANTS(name, impl, ...) \
+static void \
+name ## _ssse3 (guchar       *dest_data, \
+                gsize         dest_stride, \
+                const guchar *src_data, \
+                gsize         src_stride, \
+                gsize         width, \
+                gsize         height) \
+{ \
+  impl ## _ssse3 (dest_data, dest_stride, src_data, src_stride, width, height, __VA_ARGS__); \
+} \
+\
+static void \
+name ## _avx2 (guchar       *dest_data, \
+               gsize         dest_stride, \
+               const guchar *src_data, \
+               gsize         src_stride, \
+               gsize         width, \
+               gsize         height) \
+{ \
+  impl ## _avx2 (dest_data, dest_stride, src_data, src_stride, width, height, __VA_ARGS__); \
+}
+
+#else
+#define X86_VARIANTS(name, impl, ...)
+#endif /* HAVE_X86_SIMD */
+
+#ifdef HAVE_NEON
+
+/* NEON can deinterleave the channels on load and interleave them
+ * again on store, so a swizzle is just a matter of picking the
+ * right registers. */
+static void
+swizzle_neon (guchar       *dest_data,
+              gsize         dest_stride,
+              const guchar *src_data,
+              gsize         src_stride,
+              gsize         width,
+              gsize         height,
+              int A, int R, int G, int B)
+{
+  gsize x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 16 <= width; x += 16)
+        {
+          uint8x16x4_t s = vld4q_u8 (src_data + 4 * x);
+          uint8x16x4_t d;
+
+          d.val[A] = s.val[0];
+          d.val[R] = s.val[1];
+          d.val[G] = s.val[2];
+          d.val[B] = s.val[3];
+          vst4q_u8 (dest_data + 4 * x, d);
+        }
+
+      swizzle_pixels (dest_data + 4 * x, src_data + 4 * x, width - x, A, R, G, B);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+static void
+swizzle_opaque_neon (guchar       *dest_data,
+                     gsize         dest_stride,
+                     const guchar *src_data,
+                     gsize         src_stride,
+                     gsize         width,
+                     gsize         height,
+                     int A, int R, int G, int B)
+{
+  gsize x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 16 <= width; x += 16)
+        {
+          uint8x16x3_t s = vld3q_u8 (src_data + 3 * x);
+          uint8x16x4_t d;
+
+          d.val[A] = vdupq_n_u8 (0xFF);
+          d.val[R] = s.val[0];
+          d.val[G] = s.val[1];
+          d.val[B] = s.val[2];
+          vst4q_u8 (dest_data + 4 * x, d);
+        }
+
+      swizzle_opaque_pixels (dest_data + 4 * x, src_data + 3 * x, width - x, A, R, G, B);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+/* Same rounding as PREMULTIPLY() */
+static inline uint8x16_t
+premultiply_neon (uint8x16_t c,
+                  uint8x16_t a)
+{
+  uint16x8_t lo = vmlal_u8 (vdupq_n_u16 (0x80), vget_low_u8 (c), vget_low_u8 (a));
+  uint16x8_t hi = vmlal_u8 (vdupq_n_u16 (0x80), vget_high_u8 (c), vget_high_u8 (a));
+
+  return vcombine_u8 (vshrn_n_u16 (vsraq_n_u16 (lo, lo, 8), 8),
+                      vshrn_n_u16 (vsraq_n_u16 (hi, hi, 8), 8));
+}
+
+static void
+swizzle_premultiply_neon (guchar       *dest_data,
+                          gsize         dest_stride,
+                          const guchar *src_data,
+                          gsize         src_stride,
+                          gsize         width,
+                          gsize         height,
+                          int A, int R, int G, int B,
+                          int A2, int R2, int G2, int B2)
+{
+  gsize x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 16 <= width; x += 16)
+        {
+          uint8x16x4_t s = vld4q_u8 (src_data + 4 * x);
+          uint8x16x4_t d;
+
+          d.val[A] = s.val[A2];
+          d.val[R] = premultiply_neon (s.val[R2], s.val[A2]);
+          d.val[G] = premultiply_neon (s.val[G2], s.val[A2]);
+          d.val[B] = premultiply_neon (s.val[B2], s.val[A2]);
+          vst4q_u8 (dest_data + 4 * x, d);
+        }
+
+      swizzle_premultiply_pixels (dest_data + 4 * x, src_data + 4 * x, width - x,
+                                  A, R, G, B, A2, R2, G2, B2);
+
+      dest_data += dest_stride;
+      src_data += src_stride;
+    }
+}
+
+#define NEON_VARIANT(name, impl, ...) \
+static void \
+name ## _neon (guchar       *dest_data, \
+               gsize         dest_stride, \
+               const guchar *src_data, \
+               gsize         src_stride, \
+               gsize         width, \
+               gsize         height) \
+{ \
+  impl ## _neon (dest_data, dest_stride, src_data, src_stride, width, height, __VA_ARGS__); \
+}
+
+#else
+#define NEON_VARIANT(name, impl, ...)
+#endif /* HAVE_NEON */
+
 #define SWIZZLE(A,R,G,B) \
 static void \
 convert_swizzle ## A ## R ## G ## B (guchar       *dest_data, \
@@ -182,22 +652,18 @@ convert_swizzle ## A ## R ## G ## B (guchar       *dest_data, \
                                      gsize         width, \
                                      gsize         height) \
 { \
-  gsize x, y; \
+  gsize y; \
 \
   for (y = 0; y < height; y++) \
     { \
-      for (x = 0; x < width; x++) \
-        { \
-          dest_data[4 * x + A] = src_data[4 * x + 0]; \
-          dest_data[4 * x + R] = src_data[4 * x + 1]; \
-          dest_data[4 * x + G] = src_data[4 * x + 2]; \
-          dest_data[4 * x + B] = src_data[4 * x + 3]; \
-        } \
+      swizzle_pixels (dest_data, src_data, width, A, R, G, B); \
 \
       dest_data += dest_stride; \
       src_data += src_stride; \
     } \
-}
+} \
+X86_VARIANTS (convert_swizzle ## A ## R ## G ## B, swizzle, A, R, G, B) \
+NEON_VARIANT (convert_swizzle ## A ## R ## G ## B, swizzle, A, R, G, B)
 
 SWIZZLE(3,2,1,0)
 SWIZZLE(2,1,0,3)
@@ -213,29 +679,24 @@ convert_swizzle_opaque_## A ## R ## G ## B (guchar       *dest_data, \
                                             gsize         width, \
                                             gsize         height) \
 { \
-  gsize x, y; \
+  gsize y; \
 \
   for (y = 0; y < height; y++) \
     { \
-      for (x = 0; x < width; x++) \
-        { \
-          dest_data[4 * x + A] = 0xFF; \
-          dest_data[4 * x + R] = src_data[3 * x + 0]; \
-          dest_data[4 * x + G] = src_data[3 * x + 1]; \
-          dest_data[4 * x + B] = src_data[3 * x + 2]; \
-        } \
+      swizzle_opaque_pixels (dest_data, src_data, width, A, R, G, B); \
 \
       dest_data += dest_stride; \
       src_data += src_stride; \
     } \
-}
+} \
+X86_VARIANTS (convert_swizzle_opaque_ ## A ## R ## G ## B, swizzle_opaque, A, R, G, B) \
+NEON_VARIANT (convert_swizzle_opaque_ ## A ## R ## G ## B, swizzle_opaque, A, R, G, B)
 
 SWIZZLE_OPAQUE(3,2,1,0)
 SWIZZLE_OPAQUE(3,0,1,2)
 SWIZZLE_OPAQUE(0,1,2,3)
 SWIZZLE_OPAQUE(0,3,2,1)
 
-#define PREMULTIPLY(d,c,a) G_STMT_START { guint t = c * a + 0x80; d = ((t >> 8) + t) >> 8; } G_STMT_END
 #define SWIZZLE_PREMULTIPLY(A,R,G,B, A2,R2,G2,B2) \
 static void \
 convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2 \
@@ -246,22 +707,20 @@ convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2 \
                                      gsize         width, \
                                      gsize         height) \
 { \
-  gsize x, y; \
+  gsize y; \
 \
   for (y = 0; y < height; y++) \
     { \
-      for (x = 0; x < width; x++) \
-        { \
-          dest_data[4 * x + A] = src_data[4 * x + A2]; \
-          PREMULTIPLY(dest_data[4 * x + R], src_data[4 * x + R2], src_data[4 * x + A2]); \
-          PREMULTIPLY(dest_data[4 * x + G], src_data[4 * x + G2], src_data[4 * x + A2]); \
-          PREMULTIPLY(dest_data[4 * x + B], src_data[4 * x + B2], src_data[4 * x + A2]); \
-        } \
+      swizzle_premultiply_pixels (dest_data, src_data, width, A, R, G, B, A2, R2, G2, B2); \
 \
       dest_data += dest_stride; \
       src_data += src_stride; \
     } \
-}
+} \
+X86_VARIANTS (convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2, \
+              swizzle_premultiply, A, R, G, B, A2, R2, G2, B2) \
+NEON_VARIANT (convert_swizzle_premultiply_ ## A ## R ## G ## B ## _ ## A2 ## R2 ## G2 ## B2, \
+              swizzle_premultiply, A, R, G, B, A2, R2, G2, B2)
 
 SWIZZLE_PREMULTIPLY (3,2,1,0, 3,2,1,0)
 SWIZZLE_PREMULTIPLY (0,1,2,3, 3,2,1,0)
@@ -283,18 +742,68 @@ typedef void (* ConversionFunc) (guchar       *dest_data,
                                  gsize         width,
                                  gsize         height);
 
-static ConversionFunc converters[GDK_MEMORY_N_FORMATS][3] =
+#define convert_memcpy_ssse3 convert_memcpy
+#define convert_memcpy_avx2 convert_memcpy
+#define convert_memcpy_neon convert_memcpy
+
+#define CONVERTERS(V) \
+{ \
+  { V(convert_memcpy), V(convert_swizzle3210), V(convert_swizzle2103) }, \
+  { V(convert_swizzle3210), V(convert_memcpy), V(convert_swizzle3012) }, \
+  { V(convert_swizzle2103), V(convert_swizzle1230), V(convert_memcpy) }, \
+  { V(convert_swizzle_premultiply_3210_3210), V(convert_swizzle_premultiply_0123_3210), V(convert_swizzle_premultiply_3012_3210),  }, \
+  { V(convert_swizzle_premultiply_3210_0123), V(convert_swizzle_premultiply_0123_0123), V(convert_swizzle_premultiply_3012_0123) }, \
+  { V(convert_swizzle_premultiply_3210_3012), V(convert_swizzle_premultiply_0123_3012), V(convert_swizzle_premultiply_3012_3012) }, \
+  { V(convert_swizzle_premultiply_3210_0321), V(convert_swizzle_premultiply_0123_0321), V(convert_swizzle_premultiply_3012_0321) }, \
+  { V(convert_swizzle_opaque_3210), V(convert_swizzle_opaque_0123), V(convert_swizzle_opaque_3012) }, \
+  { V(convert_swizzle_opaque_3012), V(convert_swizzle_opaque_0321), V(convert_swizzle_opaque_3210) } \
+}
+
+#define SCALAR(f) f
+#define SSSE3(f) f ## _ssse3
+#define AVX2(f) f ## _avx2
+#define NEON(f) f ## _neon
+
+typedef ConversionFunc ConverterTable[GDK_MEMORY_N_FORMATS][3];
+
+static ConverterTable converters = CONVERTERS (SCALAR);
+
+#ifdef HAVE_X86_SIMD
+static ConverterTable converters_ssse3 = CONVERTERS (SSSE3);
+static ConverterTable converters_avx2 = CONVERTERS (AVX2);
+#endif
+#ifdef HAVE_NEON
+static ConverterTable converters_neon = CONVERTERS (NEON);
+#endif
+
+/* Set GDK_MEMORY_CONVERT_SCALAR to compare against the plain C code */
+static const ConverterTable *
+get_converters (void)
 {
-  { convert_memcpy, convert_swizzle3210, convert_swizzle2103 },
-  { convert_swizzle3210, convert_memcpy, convert_swizzle3012 },
-  { convert_swizzle2103, convert_swizzle1230, convert_memcpy },
-  { convert_swizzle_premultiply_3210_3210, convert_swizzle_premultiply_0123_3210, convert_swizzle_premultiply_3012_3210,  },
-  { convert_swizzle_premultiply_3210_0123, convert_swizzle_premultiply_0123_0123, convert_swizzle_premultiply_3012_0123 },
-  { convert_swizzle_premultiply_3210_3012, convert_swizzle_premultiply_0123_3012, convert_swizzle_premultiply_3012_3012 },
-  { convert_swizzle_premultiply_3210_0321, convert_swizzle_premultiply_0123_0321, convert_swizzle_premultiply_3012_0321 },
-  { convert_swizzle_opaque_3210, convert_swizzle_opaque_0123, convert_swizzle_opaque_3012 },
-  { convert_swizzle_opaque_3012, convert_swizzle_opaque_0321, convert_swizzle_opaque_3210 }
-};
+  static const ConverterTable *selected = NULL;
+
+  if (g_once_init_enter (&selected))
+    {
+      const ConverterTable *table = &converters;
+
+      if (g_getenv ("GDK_MEMORY_CONVERT_SCALAR") == NULL)
+        {
+#if defined(HAVE_X86_SIMD)
+          __builtin_cpu_init ();
+          if (__builtin_cpu_supports ("avx2"))
+            table = &converters_avx2;
+          else if (__builtin_cpu_supports ("ssse3"))
+            table = &converters_ssse3;
+#elif defined(HAVE_NEON)
+          table = &converters_neon;
+#endif
+        }
+
+      g_once_init_leave (&selected, table);
+    }
+
+  return selected;
+}
 
 void
 gdk_memory_convert (guchar          *dest_data,
@@ -309,5 +818,5 @@ gdk_memory_convert (guchar          *dest_data,
   g_assert (dest_format < 3);
   g_assert (src_format < GDK_MEMORY_N_FORMATS);
 
-  converters[src_format][dest_format] (dest_data, dest_stride, src_data, src_stride, width, height);
+  (*get_converters ())[src_format][dest_format] (dest_data, dest_stride, src_data, src_stride, width, height);
 }
@@ -386,6 +386,224 @@ gdk_texture_new_from_file (GFile   *file,
   return texture;
 }
 
+typedef struct
+{
+  int width;
+  int height;
+} LoadSize;
+
+static void
+size_prepared_cb (GdkPixbufLoader *loader,
+                  int              width,
+                  int              height,
+                  gpointer         data)
+{
+  LoadSize *size = data;
+  double scale;
+
+  scale = 1.0;
+  if (size->width > 0 && width > size->width)
+    scale = MIN (scale, (double) size->width / width);
+  if (size->height > 0 && height > size->height)
+    scale = MIN (scale, (double) size->height / height);
+
+  /* Never scale up, and let the loader use its scaled decoding
+   * (like JPEG's DCT scaling) when scaling down */
+  if (scale < 1.0)
+    gdk_pixbuf_loader_set_size (loader,
+                                MAX (1, (int) (width * scale + 0.5)),
+                                MAX (1, (int) (height * scale + 0.5)));
+}
+
+static GdkTexture *
+load_texture_at_size (GFile         *file,
+                      int            width,
+                      int            height,
+                      GCancellable  *cancellable,
+                      GError       **error)
+{
+  GdkPixbufLoader *loader;
+  GInputStream *stream;
+  GdkTexture *texture;
+  GdkPixbuf *pixbuf;
+  LoadSize size;
+  guchar buffer[65536];
+  gssize n_read;
+  gboolean res;
+
+  stream = G_INPUT_STREAM (g_file_read (file, cancellable, error));
+  if (stream == NULL)
+    return NULL;
+
+  size.width = width;
+  size.height = height;
+
+  loader = gdk_pixbuf_loader_new ();
+  g_signal_connect (loader, "size-prepared", G_CALLBACK (size_prepared_cb), &size);
+
+  res = TRUE;
+  while (res)
+    {
+      n_read = g_input_stream_read (stream, buffer, sizeof (buffer), cancellable, error);
+      if (n_read < 0)
+        res = FALSE;
+      else if (n_read == 0)
+        break;
+      else
+        res = gdk_pixbuf_loader_write (loader, buffer, n_read, error);
+    }
+
+  if (!gdk_pixbuf_loader_close (loader, res ? error : NULL))
+    res = FALSE;
+
+  g_object_unref (stream);
+
+  if (!res)
+    {
+      g_object_unref (loader);
+      return NULL;
+    }
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (pixbuf == NULL)
+    {
+      g_set_error_literal (error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED,
+                           "Image loader did not produce an image");
+      g_object_unref (loader);
+      return NULL;
+    }
+
+  texture = gdk_texture_new_for_pixbuf (pixbuf);
+  g_object_unref (loader);
+
+  return texture;
+}
+
+/**
+ * gdk_texture_new_from_file_at_size:
+ * @file: #GFile to load
+ * @width: the maximum width of the texture, or -1 to not constrain the width
+ * @height: the maximum height of the texture, or -1 to not constrain the height
+ * @error: Return location for an error
+ *
+ * Creates a new texture by loading an image from a file, like
+ * gdk_texture_new_from_file(), but scales it down to fit into
+ * @width and @height while preserving its aspect ratio.
+ *
+ * Images that are already smaller are not scaled up.
+ *
+ * This is much faster and uses a lot less memory than loading the
+ * full image when only a small version of it is needed, because
+ * image loaders can often decode a large image at a smaller size
+ * directly.
+ *
+ * If %NULL is returned, then @error will be set.
+ *
+ * Return value: A newly-created #GdkTexture or %NULL if an error occurred.
+ *
+ * Since: 4.2
+ **/
+GdkTexture *
+gdk_texture_new_from_file_at_size (GFile   *file,
+                                   int      width,
+                                   int      height,
+                                   GError **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (width == -1 || width > 0, NULL);
+  g_return_val_if_fail (height == -1 || height > 0, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return load_texture_at_size (file, width, height, NULL, error);
+}
+
+static void
+load_texture_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  LoadSize *size = task_data;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = load_texture_at_size (G_FILE (source_object),
+                                  size->width, size->height,
+                                  cancellable,
+                                  &error);
+  if (texture)
+    g_task_return_pointer (task, texture, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+/**
+ * gdk_texture_new_from_file_at_size_async:
+ * @file: #GFile to load
+ * @width: the maximum width of the texture, or -1 to not constrain the width
+ * @height: the maximum height of the texture, or -1 to not constrain the height
+ * @cancellable: (nullable): optional #GCancellable object
+ * @callback: (scope async): callback to call when the texture is loaded
+ * @user_data: the data to pass to @callback
+ *
+ * Asynchronously creates a new texture by loading an image from a file.
+ * The image is loaded in a thread.
+ *
+ * See gdk_texture_new_from_file_at_size() for details.
+ *
+ * Since: 4.2
+ **/
+void
+gdk_texture_new_from_file_at_size_async (GFile               *file,
+                                         int                  width,
+                                         int                  height,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data)
+{
+  LoadSize *size;
+  GTask *task;
+
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (width == -1 || width > 0);
+  g_return_if_fail (height == -1 || height > 0);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  size = g_new (LoadSize, 1);
+  size->width = width;
+  size->height = height;
+
+  task = g_task_new (file, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_texture_new_from_file_at_size_async);
+  g_task_set_task_data (task, size, g_free);
+  g_task_run_in_thread (task, load_texture_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gdk_texture_new_from_file_at_size_finish:
+ * @result: a #GAsyncResult
+ * @error: Return location for an error
+ *
+ * Finishes an asynchronous load started with
+ * gdk_texture_new_from_file_at_size_async().
+ *
+ * Return value: (transfer full): A newly-created #GdkTexture or %NULL
+ *     if an error occurred.
+ *
+ * Since: 4.2
+ **/
+GdkTexture *
+gdk_texture_new_from_file_at_size_finish (GAsyncResult  *result,
+                                          GError       **error)
+{
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_texture_new_from_file_at_size_async, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * gdk_texture_get_width:
  * @texture: a #GdkTexture
@@ -87,6 +87,9 @@ typedef enum
  * @GDK_TOPLEVEL_STATE_BOTTOM_RESIZABLE: whether the bottom edge is resizable
  * @GDK_TOPLEVEL_STATE_LEFT_TILED: whether the left edge is tiled
  * @GDK_TOPLEVEL_STATE_LEFT_RESIZABLE: whether the left edge is resizable
+ * @GDK_TOPLEVEL_STATE_RESIZING: the surface is being resized interactively.
+ *   Applications may want to delay expensive relayouts, like rewrapping
+ *   large amounts of text, until this state is unset again. Since 4.2
  *
  * Specifies the state of a toplevel surface.
  *
@@ -112,7 +115,8 @@ typedef enum
   GDK_TOPLEVEL_STATE_BOTTOM_TILED     = 1 << 12,
   GDK_TOPLEVEL_STATE_BOTTOM_RESIZABLE = 1 << 13,
   GDK_TOPLEVEL_STATE_LEFT_TILED       = 1 << 14,
-  GDK_TOPLEVEL_STATE_LEFT_RESIZABLE   = 1 << 15
+  GDK_TOPLEVEL_STATE_LEFT_RESIZABLE   = 1 << 15,
+  GDK_TOPLEVEL_STATE_RESIZING         = 1 << 16
 } GdkToplevelState;
 
 
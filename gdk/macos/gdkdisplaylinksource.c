@@ -114,6 +114,16 @@ gdk_display_link_source_frame_cb (CVDisplayLinkRef   display_link,
 
   presentation_time = host_to_frame_clock_time (inOutputTime->hostTime);
 
+  /* Displays with a variable refresh rate, like ProMotion displays,
+   * change the period between frames as they go, so use the period
+   * of this frame rather than the nominal one.
+   */
+  if ((inOutputTime->flags & kCVTimeStampVideoRefreshPeriodValid) != 0 &&
+      inOutputTime->videoRefreshPeriod > 0 &&
+      inOutputTime->videoTimeScale > 0)
+    impl->refresh_interval = inOutputTime->videoRefreshPeriod * G_USEC_PER_SEC / inOutputTime->videoTimeScale;
+
+  impl->last_presentation_time = host_to_frame_clock_time (inNow->hostTime);
   impl->presentation_time = presentation_time;
   impl->needs_dispatch = TRUE;
 
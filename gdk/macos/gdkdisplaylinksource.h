@@ -33,9 +33,11 @@ typedef struct
   GSource          source;
 
   CVDisplayLinkRef display_link;
-  gint64           refresh_interval;
+  volatile gint64  refresh_interval;
   guint            refresh_rate;
 
+  /* the vblank that just happened, and the one we draw for */
+  volatile gint64  last_presentation_time;
   volatile gint64  presentation_time;
   volatile guint   needs_dispatch;
 } GdkDisplayLinkSource;
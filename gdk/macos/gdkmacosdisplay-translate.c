@@ -208,7 +208,7 @@ fill_button_event (GdkMacosDisplay *display,
   GdkModifierType state;
   GdkDevice *pointer = NULL;
   GdkDeviceTool *tool = NULL;
-  double *axes = NULL;
+  const double *axes = NULL;
 
   g_assert (GDK_IS_MACOS_DISPLAY (display));
   g_assert (GDK_IS_MACOS_SURFACE (surface));
@@ -569,7 +569,7 @@ fill_motion_event (GdkMacosDisplay *display,
   GdkModifierType state;
   GdkDevice *pointer = NULL;
   GdkDeviceTool *tool = NULL;
-  double *axes = NULL;
+  const double *axes = NULL;
 
   g_assert (GDK_IS_MACOS_SURFACE (surface));
   g_assert (nsevent != NULL);
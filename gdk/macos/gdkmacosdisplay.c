@@ -335,6 +335,7 @@ gdk_macos_display_frame_cb (gpointer data)
 
       _gdk_macos_display_remove_frame_callback (self, surface);
       _gdk_macos_surface_thaw (surface,
+                               source->last_presentation_time,
                                source->presentation_time,
                                source->refresh_interval);
     }
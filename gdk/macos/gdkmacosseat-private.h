@@ -38,8 +38,8 @@ gboolean _gdk_macos_seat_get_tablet (GdkMacosSeat   *seat,
                                      GdkDevice     **device,
                                      GdkDeviceTool **tool);
 
-double *_gdk_macos_seat_get_tablet_axes_from_nsevent (GdkMacosSeat *seat,
-                                                      NSEvent      *nsevent);
+const double *_gdk_macos_seat_get_tablet_axes_from_nsevent (GdkMacosSeat *seat,
+                                                            NSEvent      *nsevent);
 
 G_END_DECLS
 
@@ -583,7 +583,7 @@ _gdk_macos_seat_get_tablet (GdkMacosSeat   *seat,
   return TRUE;
 }
 
-double *
+const double *
 _gdk_macos_seat_get_tablet_axes_from_nsevent (GdkMacosSeat *seat,
                                               NSEvent      *nsevent)
 {
@@ -622,6 +622,5 @@ _gdk_macos_seat_get_tablet_axes_from_nsevent (GdkMacosSeat *seat,
                                   [nsevent rotation], &tablet->axes[GDK_AXIS_ROTATION]);
     }
 
-  return g_memdup (tablet->axes,
-                   sizeof (double) * GDK_AXIS_LAST);
+  return tablet->axes;
 }
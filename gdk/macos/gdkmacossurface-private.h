@@ -105,6 +105,7 @@ void               _gdk_macos_surface_update_fullscreen_state (GdkMacosSurface
 void               _gdk_macos_surface_update_position         (GdkMacosSurface    *self);
 void               _gdk_macos_surface_show                    (GdkMacosSurface    *self);
 void               _gdk_macos_surface_thaw                    (GdkMacosSurface    *self,
+                                                               gint64              last_presentation_time,
                                                                gint64              predicted_presentation_time,
                                                                gint64              refresh_interval);
 CGContextRef       _gdk_macos_surface_acquire_context         (GdkMacosSurface    *self,
@@ -721,6 +721,7 @@ _gdk_macos_surface_update_position (GdkMacosSurface *self)
 
 void
 _gdk_macos_surface_thaw (GdkMacosSurface *self,
+                         gint64           last_presentation_time,
                          gint64           presentation_time,
                          gint64           refresh_interval)
 {
@@ -739,7 +740,8 @@ _gdk_macos_surface_thaw (GdkMacosSurface *self,
 
       if (timings != NULL)
         {
-          timings->presentation_time = presentation_time - refresh_interval;
+          /* The frame was shown at the vblank that woke us up */
+          timings->presentation_time = last_presentation_time;
           timings->complete = TRUE;
         }
 
@@ -137,6 +137,7 @@ struct wl_cursor_theme {
 	struct shm_pool *pool;
 	int size;
         char *path;
+        GHashTable *missing; /* "size/name" of cursors that failed to load */
 };
 
 struct cursor_image {
@@ -320,9 +321,11 @@ wl_cursor_theme_create(const char *path, int size, struct wl_shm *shm)
 	theme->size = size;
 	theme->cursor_count = 0;
 	theme->cursors = NULL;
+        theme->missing = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
 	theme->pool = shm_pool_create(shm, size * size * 4);
 	if (!theme->pool) {
+                g_hash_table_unref (theme->missing);
                 free (theme->path);
                 free (theme);
 		return NULL;
@@ -346,6 +349,7 @@ wl_cursor_theme_destroy(struct wl_cursor_theme *theme)
 	shm_pool_destroy(theme->pool);
 
 	free(theme->cursors);
+        g_hash_table_unref (theme->missing);
         free(theme->path);
 	free(theme);
 }
@@ -364,6 +368,7 @@ wl_cursor_theme_get_cursor(struct wl_cursor_theme *theme,
 {
 	unsigned int i;
         unsigned int size;
+        char *key;
 
         size = theme->size * scale;
 
@@ -373,13 +378,27 @@ wl_cursor_theme_get_cursor(struct wl_cursor_theme *theme,
 		        return theme->cursors[i];
         }
 
+        /* Names that are not in the theme get looked up again and again,
+         * as GDK falls back from CSS names to the traditional ones, so
+         * remember them instead of searching the file system every time.
+         */
+        key = g_strdup_printf ("%u/%s", size, name);
+        if (g_hash_table_contains (theme->missing, key)) {
+                g_free (key);
+                return NULL;
+        }
+
         load_cursor (theme, name, size);
 
         if (i < theme->cursor_count) {
                 if (size == theme->cursors[i]->size &&
-                    strcmp (name, theme->cursors[theme->cursor_count - 1]->name) == 0)
+                    strcmp (name, theme->cursors[theme->cursor_count - 1]->name) == 0) {
+                        g_free (key);
                         return theme->cursors[theme->cursor_count - 1];
+                }
         }
 
+        g_hash_table_add (theme->missing, key);
+
 	return NULL;
 }
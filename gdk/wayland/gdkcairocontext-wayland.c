@@ -96,6 +96,8 @@ gdk_wayland_cairo_context_buffer_release (void             *_data,
   cairo_surface_t *cairo_surface = _data;
   GdkWaylandCairoContext *self = gdk_wayland_cairo_context_get_from_surface (cairo_surface);
 
+  _gdk_wayland_shm_surface_set_busy (cairo_surface, FALSE);
+
   /* context was destroyed before compositor released this buffer */
   if (self == NULL)
     return;
@@ -132,6 +134,7 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
                                                            gdk_surface_get_scale_factor (surface));
   buffer = _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface);
   wl_buffer_add_listener (buffer, &buffer_listener, cairo_surface);
+  _gdk_wayland_shm_surface_set_busy (cairo_surface, FALSE);
   gdk_wayland_cairo_context_add_surface (self, cairo_surface);
 
   region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) { 0, 0, width, height });
@@ -180,6 +183,7 @@ gdk_wayland_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkSurface *surface = gdk_draw_context_get_surface (draw_context);
 
   gdk_wayland_surface_attach_image (surface, self->paint_surface, painted);
+  _gdk_wayland_shm_surface_set_busy (self->paint_surface, TRUE);
   gdk_wayland_surface_sync (surface);
   gdk_wayland_surface_request_frame (surface);
 
@@ -3469,13 +3469,6 @@ tablet_tool_handle_proximity_out (void                      *data,
   g_clear_object (&tablet->pointer_info.cursor);
 }
 
-static double *
-tablet_copy_axes (GdkWaylandTabletData *tablet)
-{
-  return g_memdup (tablet->axes,
-                   sizeof (double) * GDK_AXIS_LAST);
-}
-
 static void
 tablet_create_button_event_frame (GdkWaylandTabletData *tablet,
                                   GdkEventType          evtype,
@@ -3493,7 +3486,7 @@ tablet_create_button_event_frame (GdkWaylandTabletData *tablet,
                                 button,
                                 tablet->pointer_info.surface_x,
                                 tablet->pointer_info.surface_y,
-                                tablet_copy_axes (tablet));
+                                tablet->axes);
   gdk_wayland_tablet_set_frame_event (tablet, event);
 }
 
@@ -3559,7 +3552,7 @@ tablet_tool_handle_motion (void                      *data,
                                 device_get_modifiers (tablet->logical_device),
                                 tablet->pointer_info.surface_x,
                                 tablet->pointer_info.surface_y,
-                                tablet_copy_axes (tablet));
+                                tablet->axes);
 
   gdk_wayland_tablet_set_frame_event (tablet, event);
 }
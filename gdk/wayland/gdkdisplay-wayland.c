@@ -414,6 +414,20 @@ static void gdk_wayland_display_remove_output     (GdkWaylandDisplay *display_wa
 static void gdk_wayland_display_init_xdg_output   (GdkWaylandDisplay *display_wayland);
 static void gdk_wayland_display_get_xdg_output    (GdkWaylandMonitor *monitor);
 
+static void
+presentation_handle_clock_id (void                   *data,
+                              struct wp_presentation *presentation,
+                              uint32_t                clk_id)
+{
+  GdkWaylandDisplay *display_wayland = data;
+
+  display_wayland->presentation_clock_id = clk_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  presentation_handle_clock_id,
+};
+
 static void
 gdk_registry_handle_global (void               *data,
                             struct wl_registry *registry,
@@ -561,6 +575,18 @@ gdk_registry_handle_global (void               *data,
         wl_registry_bind (display_wayland->wl_registry, id,
                           &zwp_idle_inhibit_manager_v1_interface, 1);
     }
+  else if (strcmp (interface, "wp_presentation") == 0)
+    {
+      /* Until the compositor tells us, we can't compare its timestamps
+       * with ours, so start out with a clock that never matches */
+      display_wayland->presentation_clock_id = G_MAXUINT32;
+      display_wayland->presentation =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_presentation_interface, 1);
+      wp_presentation_add_listener (display_wayland->presentation,
+                                    &presentation_listener,
+                                    display_wayland);
+    }
 
   g_hash_table_insert (display_wayland->known_globals,
                        GUINT_TO_POINTER (id), g_strdup (interface));
@@ -747,6 +773,7 @@ gdk_wayland_display_finalize (GObject *object)
   GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (object);
 
   _gdk_wayland_display_finalize_cursors (display_wayland);
+  _gdk_wayland_display_free_shm_pools (display_wayland);
 
   g_free (display_wayland->startup_notification_id);
   g_free (display_wayland->cursor_theme_name);
@@ -1204,13 +1231,26 @@ gdk_wayland_display_get_wl_compositor (GdkDisplay *display)
 
 static const cairo_user_data_key_t gdk_wayland_shm_surface_cairo_key;
 
-typedef struct _GdkWaylandCairoSurfaceData {
+/* Shared memory pools are kept around after their surface is gone, so
+ * that new surfaces - like the buffers of a window that is being
+ * resized - can reuse them instead of mapping new memory. Pool sizes
+ * are rounded up to powers of two so that similar sizes can share.
+ */
+#define MIN_SHM_POOL_SIZE (64 * 1024)
+#define MAX_FREE_SHM_POOLS 4
+
+typedef struct _GdkWaylandShmPool {
+  struct wl_shm_pool *pool;
   gpointer buf;
   size_t buf_length;
-  struct wl_shm_pool *pool;
+} GdkWaylandShmPool;
+
+typedef struct _GdkWaylandCairoSurfaceData {
+  GdkWaylandShmPool *pool;
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   uint32_t scale;
+  guint busy : 1;
 } GdkWaylandCairoSurfaceData;
 
 static int
@@ -1319,6 +1359,71 @@ fail:
   return NULL;
 }
 
+static void
+gdk_wayland_shm_pool_free (GdkWaylandShmPool *pool)
+{
+  wl_shm_pool_destroy (pool->pool);
+  munmap (pool->buf, pool->buf_length);
+  g_free (pool);
+}
+
+static GdkWaylandShmPool *
+gdk_wayland_display_get_shm_pool (GdkWaylandDisplay *display,
+                                  size_t             size)
+{
+  GdkWaylandShmPool *pool;
+  GSList *l;
+
+  size = MAX (size, MIN_SHM_POOL_SIZE);
+  if (size <= G_MAXSIZE / 2)
+    size = (size_t) 1 << g_bit_storage (size - 1);
+
+  for (l = display->free_shm_pools; l; l = l->next)
+    {
+      pool = l->data;
+
+      if (pool->buf_length == size)
+        {
+          display->free_shm_pools = g_slist_delete_link (display->free_shm_pools, l);
+          return pool;
+        }
+    }
+
+  pool = g_new (GdkWaylandShmPool, 1);
+  pool->pool = create_shm_pool (display->shm,
+                                size,
+                                &pool->buf_length,
+                                &pool->buf);
+  if (G_UNLIKELY (pool->pool == NULL))
+    g_error ("Unable to create shared memory pool");
+
+  return pool;
+}
+
+static void
+gdk_wayland_display_put_shm_pool (GdkWaylandDisplay *display,
+                                  GdkWaylandShmPool *pool)
+{
+  GSList *last;
+
+  display->free_shm_pools = g_slist_prepend (display->free_shm_pools, pool);
+
+  /* Drop the least recently used one */
+  if (g_slist_length (display->free_shm_pools) > MAX_FREE_SHM_POOLS)
+    {
+      last = g_slist_last (display->free_shm_pools);
+      gdk_wayland_shm_pool_free (last->data);
+      display->free_shm_pools = g_slist_delete_link (display->free_shm_pools, last);
+    }
+}
+
+void
+_gdk_wayland_display_free_shm_pools (GdkWaylandDisplay *display)
+{
+  g_slist_free_full (display->free_shm_pools, (GDestroyNotify) gdk_wayland_shm_pool_free);
+  display->free_shm_pools = NULL;
+}
+
 static void
 gdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1327,10 +1432,13 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->buffer)
     wl_buffer_destroy (data->buffer);
 
-  if (data->pool)
-    wl_shm_pool_destroy (data->pool);
+  /* The compositor may still read from a buffer it hasn't released,
+   * so we can't give its memory to somebody else */
+  if (data->busy)
+    gdk_wayland_shm_pool_free (data->pool);
+  else
+    gdk_wayland_display_put_shm_pool (data->display, data->pool);
 
-  munmap (data->buf, data->buf_length);
   g_free (data);
 }
 
@@ -1349,23 +1457,20 @@ _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *display,
   data->display = display;
   data->buffer = NULL;
   data->scale = scale;
+  /* Unless told otherwise, assume the compositor may use the buffer */
+  data->busy = TRUE;
 
   stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width * scale);
 
-  data->pool = create_shm_pool (display->shm,
-                                height * scale * stride,
-                                &data->buf_length,
-                                &data->buf);
-  if (G_UNLIKELY (data->pool == NULL))
-    g_error ("Unable to create shared memory pool");
+  data->pool = gdk_wayland_display_get_shm_pool (display, (size_t) height * scale * stride);
 
-  surface = cairo_image_surface_create_for_data (data->buf,
+  surface = cairo_image_surface_create_for_data (data->pool->buf,
                                                  CAIRO_FORMAT_ARGB32,
                                                  width * scale,
                                                  height * scale,
                                                  stride);
 
-  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
+  data->buffer = wl_shm_pool_create_buffer (data->pool->pool, 0,
                                             width * scale, height * scale,
                                             stride, WL_SHM_FORMAT_ARGB8888);
 
@@ -1391,6 +1496,24 @@ _gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface)
   return data->buffer;
 }
 
+/*
+ * _gdk_wayland_shm_surface_set_busy:
+ * @surface: a shm surface
+ * @busy: whether the compositor may be using the buffer
+ *
+ * Tells whether the surface's buffer is attached to a wl_surface and
+ * not released yet. The memory of surfaces that aren't busy when they
+ * are destroyed is reused for new surfaces.
+ */
+void
+_gdk_wayland_shm_surface_set_busy (cairo_surface_t *surface,
+                                   gboolean         busy)
+{
+  GdkWaylandCairoSurfaceData *data = cairo_surface_get_user_data (surface, &gdk_wayland_shm_surface_cairo_key);
+
+  data->busy = busy;
+}
+
 gboolean
 _gdk_wayland_is_shm_surface (cairo_surface_t *surface)
 {
@@ -216,6 +216,45 @@ gdk_wayland_gl_context_get_damage (GdkGLContext *context)
   return GDK_GL_CONTEXT_CLASS (gdk_wayland_gl_context_parent_class)->get_damage (context);
 }
 
+static void
+gdk_wayland_gl_context_begin_frame (GdkDrawContext *draw_context,
+                                    cairo_region_t *region)
+{
+  GdkGLContext *context = GDK_GL_CONTEXT (draw_context);
+  GdkSurface *surface = gdk_gl_context_get_surface (context);
+  GdkDisplay *display = gdk_surface_get_display (surface);
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (display);
+  GdkWaylandGLContext *context_wayland = GDK_WAYLAND_GL_CONTEXT (context);
+  cairo_rectangle_int_t extents;
+  EGLSurface egl_surface;
+  EGLint rect[4];
+  int scale;
+
+  GDK_DRAW_CONTEXT_CLASS (gdk_wayland_gl_context_parent_class)->begin_frame (draw_context, region);
+  if (gdk_gl_context_get_shared_context (context))
+    return;
+
+  if (!display_wayland->have_egl_partial_update)
+    return;
+
+  /* Tell the driver which part of the buffer we are going to touch,
+   * so tiled GPUs don't need to load and store the rest of it.
+   * GSK renders the extents of the repaint region, so that's what
+   * we need to declare.
+   */
+  cairo_region_get_extents (region, &extents);
+  scale = gdk_surface_get_scale_factor (surface);
+
+  rect[0] = extents.x * scale;
+  rect[1] = (gdk_surface_get_height (surface) - extents.height - extents.y) * scale;
+  rect[2] = extents.width * scale;
+  rect[3] = extents.height * scale;
+
+  egl_surface = gdk_wayland_surface_get_egl_surface (surface,
+                                                    context_wayland->egl_config);
+  eglSetDamageRegionKHR (display_wayland->egl_display, egl_surface, rect, 1);
+}
+
 static void
 gdk_wayland_gl_context_end_frame (GdkDrawContext *draw_context,
                                   cairo_region_t *painted)
@@ -282,6 +321,7 @@ gdk_wayland_gl_context_class_init (GdkWaylandGLContextClass *klass)
 
   gobject_class->dispose = gdk_wayland_gl_context_dispose;
 
+  draw_context_class->begin_frame = gdk_wayland_gl_context_begin_frame;
   draw_context_class->end_frame = gdk_wayland_gl_context_end_frame;
 
   context_class->realize = gdk_wayland_gl_context_realize;
@@ -363,6 +403,9 @@ gdk_wayland_display_init_gl (GdkDisplay *display)
   display_wayland->have_egl_swap_buffers_with_damage =
     epoxy_has_egl_extension (dpy, "EGL_EXT_swap_buffers_with_damage");
 
+  display_wayland->have_egl_partial_update =
+    epoxy_has_egl_extension (dpy, "EGL_KHR_partial_update");
+
   display_wayland->have_egl_surfaceless_context =
     epoxy_has_egl_extension (dpy, "EGL_KHR_surfaceless_context");
 
@@ -43,6 +43,25 @@
 
 typedef struct _GdkWaylandKeymap          GdkWaylandKeymap;
 typedef struct _GdkWaylandKeymapClass     GdkWaylandKeymapClass;
+typedef struct _TranslationCacheEntry     TranslationCacheEntry;
+
+/* Shortcut matching and input methods translate the same key events
+ * over and over, often with different modifiers, so we keep the last
+ * translations around instead of setting up an xkb_state for each of
+ * them. The cache is direct mapped, and cleared when the keymap changes.
+ */
+#define TRANSLATION_CACHE_SIZE 64
+
+struct _TranslationCacheEntry
+{
+  xkb_keycode_t keycode;
+  GdkModifierType state;
+  int group;
+  guint keyval;
+  int effective_group;
+  int level;
+  GdkModifierType consumed_modifiers;
+};
 
 struct _GdkWaylandKeymap
 {
@@ -53,6 +72,8 @@ struct _GdkWaylandKeymap
 
   PangoDirection *direction;
   gboolean bidi;
+
+  TranslationCacheEntry translation_cache[TRANSLATION_CACHE_SIZE];
 };
 
 struct _GdkWaylandKeymapClass
@@ -302,6 +323,29 @@ gdk_wayland_keymap_get_gdk_modifiers (GdkKeymap *keymap,
   return get_gdk_modifiers (xkb_keymap, mods);
 }
 
+static void
+clear_translation_cache (GdkWaylandKeymap *keymap)
+{
+  int i;
+
+  for (i = 0; i < TRANSLATION_CACHE_SIZE; i++)
+    keymap->translation_cache[i].keycode = XKB_KEYCODE_INVALID;
+}
+
+static TranslationCacheEntry *
+get_translation_cache_entry (GdkWaylandKeymap *keymap,
+                             guint             hardware_keycode,
+                             GdkModifierType   state,
+                             int               group)
+{
+  guint hash;
+
+  hash = hardware_keycode ^ (state * 31) ^ (group << 5);
+  hash ^= hash >> 8;
+
+  return &keymap->translation_cache[hash % TRANSLATION_CACHE_SIZE];
+}
+
 static gboolean
 gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 					     guint            hardware_keycode,
@@ -314,6 +358,7 @@ gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 {
   struct xkb_keymap *xkb_keymap;
   struct xkb_state *xkb_state;
+  TranslationCacheEntry *entry;
   guint32 modifiers;
   guint32 consumed;
   xkb_layout_index_t layout;
@@ -323,31 +368,45 @@ gdk_wayland_keymap_translate_keyboard_state (GdkKeymap       *keymap,
   g_return_val_if_fail (keymap == NULL || GDK_IS_KEYMAP (keymap), FALSE);
   g_return_val_if_fail (group < 4, FALSE);
 
-  xkb_keymap = GDK_WAYLAND_KEYMAP (keymap)->xkb_keymap;
+  entry = get_translation_cache_entry (GDK_WAYLAND_KEYMAP (keymap), hardware_keycode, state, group);
+  if (entry->keycode != hardware_keycode ||
+      entry->state != state ||
+      entry->group != group)
+    {
+      xkb_keymap = GDK_WAYLAND_KEYMAP (keymap)->xkb_keymap;
 
-  modifiers = get_xkb_modifiers (xkb_keymap, state);
+      modifiers = get_xkb_modifiers (xkb_keymap, state);
 
-  xkb_state = xkb_state_new (xkb_keymap);
+      xkb_state = xkb_state_new (xkb_keymap);
 
-  xkb_state_update_mask (xkb_state, modifiers, 0, 0, group, 0, 0);
+      xkb_state_update_mask (xkb_state, modifiers, 0, 0, group, 0, 0);
 
-  layout = xkb_state_key_get_layout (xkb_state, hardware_keycode);
-  level = xkb_state_key_get_level (xkb_state, hardware_keycode, layout);
-  sym = xkb_state_key_get_one_sym (xkb_state, hardware_keycode);
-  consumed = modifiers & ~xkb_state_mod_mask_remove_consumed (xkb_state, hardware_keycode, modifiers);
+      layout = xkb_state_key_get_layout (xkb_state, hardware_keycode);
+      level = xkb_state_key_get_level (xkb_state, hardware_keycode, layout);
+      sym = xkb_state_key_get_one_sym (xkb_state, hardware_keycode);
+      consumed = modifiers & ~xkb_state_mod_mask_remove_consumed (xkb_state, hardware_keycode, modifiers);
 
-  xkb_state_unref (xkb_state);
+      xkb_state_unref (xkb_state);
+
+      entry->keycode = hardware_keycode;
+      entry->state = state;
+      entry->group = group;
+      entry->keyval = sym;
+      entry->effective_group = layout;
+      entry->level = level;
+      entry->consumed_modifiers = get_gdk_modifiers (xkb_keymap, consumed);
+    }
 
   if (keyval)
-    *keyval = sym;
+    *keyval = entry->keyval;
   if (effective_group)
-    *effective_group = layout;
+    *effective_group = entry->effective_group;
   if (effective_level)
-    *effective_level = level;
+    *effective_level = entry->level;
   if (consumed_modifiers)
-    *consumed_modifiers = get_gdk_modifiers (xkb_keymap, consumed);
+    *consumed_modifiers = entry->consumed_modifiers;
 
-  return (sym != XKB_KEY_NoSymbol);
+  return (entry->keyval != XKB_KEY_NoSymbol);
 }
 
 static guint
@@ -385,6 +444,7 @@ _gdk_wayland_keymap_class_init (GdkWaylandKeymapClass *klass)
 static void
 _gdk_wayland_keymap_init (GdkWaylandKeymap *keymap)
 {
+  clear_translation_cache (keymap);
 }
 
 static void
@@ -572,6 +632,7 @@ _gdk_wayland_keymap_update_from_fd (GdkKeymap *keymap,
 
   xkb_context_unref (context);
 
+  clear_translation_cache (keymap_wayland);
   update_direction (keymap_wayland);
 }
 
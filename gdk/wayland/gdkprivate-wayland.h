@@ -178,6 +178,9 @@ cairo_surface_t * _gdk_wayland_display_create_shm_surface (GdkWaylandDisplay *di
                                                            int                height,
                                                            guint              scale);
 struct wl_buffer *_gdk_wayland_shm_surface_get_wl_buffer (cairo_surface_t *surface);
+void _gdk_wayland_shm_surface_set_busy (cairo_surface_t *surface,
+                                        gboolean         busy);
+void _gdk_wayland_display_free_shm_pools (GdkWaylandDisplay *display);
 gboolean _gdk_wayland_is_shm_surface (cairo_surface_t *surface);
 
 EGLSurface gdk_wayland_surface_get_egl_surface (GdkSurface *surface,
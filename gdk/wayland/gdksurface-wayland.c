@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 #include <netinet/in.h>
 #include <unistd.h>
@@ -513,6 +514,107 @@ finish_pending_relayout (GdkSurface *surface)
   thaw_popup_toplevel_state (surface);
 }
 
+typedef struct {
+  GdkSurface *surface;
+  gint64 frame_counter;
+} PresentationFeedback;
+
+static gboolean
+timings_use_presentation_feedback (GdkWaylandDisplay *display_wayland)
+{
+  /* We can only use the timestamps if they are from our clock */
+  return display_wayland->presentation != NULL &&
+         display_wayland->presentation_clock_id == CLOCK_MONOTONIC;
+}
+
+static void
+presentation_feedback_free (PresentationFeedback *data)
+{
+  g_object_unref (data->surface);
+  g_slice_free (PresentationFeedback, data);
+}
+
+static void
+presentation_feedback_complete (PresentationFeedback *data,
+                                gint64                presentation_time,
+                                gint64                refresh_interval)
+{
+  GdkSurface *surface = data->surface;
+  GdkFrameClock *clock;
+  GdkFrameTimings *timings;
+
+  if (GDK_SURFACE_DESTROYED (surface))
+    return;
+
+  clock = gdk_surface_get_frame_clock (surface);
+  timings = gdk_frame_clock_get_timings (clock, data->frame_counter);
+  if (timings == NULL)
+    return;
+
+  timings->presentation_time = presentation_time;
+  if (refresh_interval != 0)
+    timings->refresh_interval = refresh_interval;
+  else if (timings->refresh_interval == 0)
+    timings->refresh_interval = 16667;
+
+  timings->complete = TRUE;
+
+#ifdef G_ENABLE_DEBUG
+  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
+    _gdk_frame_clock_debug_print_timings (clock, timings);
+#endif
+
+  if (GDK_PROFILER_IS_RUNNING)
+    _gdk_frame_clock_add_timings_to_profiler (clock, timings);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  gint64 presentation_time;
+
+  presentation_time = (((gint64) tv_sec_hi << 32) + tv_sec_lo) * G_USEC_PER_SEC + tv_nsec / 1000;
+
+  /* The refresh is 0 when the output has no constant rate, like with
+   * variable refresh rates. Then we keep the nominal rate of the output.
+   */
+  presentation_feedback_complete (data, presentation_time, refresh / 1000);
+
+  wp_presentation_feedback_destroy (feedback);
+  presentation_feedback_free (data);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  presentation_feedback_complete (data, 0, 0);
+
+  wp_presentation_feedback_destroy (feedback);
+  presentation_feedback_free (data);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded,
+};
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -574,6 +676,11 @@ frame_callback (void               *data,
         timings->refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
     }
 
+  /* With presentation feedback, the timings are completed when
+   * the compositor tells us when the frame reached the screen */
+  if (timings_use_presentation_feedback (display_wayland))
+    return;
+
   fill_presentation_time_from_frame_time (timings, time);
 
   timings->complete = TRUE;
@@ -681,6 +788,8 @@ void
 gdk_wayland_surface_request_frame (GdkSurface *surface)
 {
   GdkWaylandSurface *impl = GDK_WAYLAND_SURFACE (surface);
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_surface_get_display (surface));
   struct wl_callback *callback;
   GdkFrameClock *clock;
 
@@ -694,6 +803,23 @@ gdk_wayland_surface_request_frame (GdkSurface *surface)
   wl_callback_add_listener (callback, &frame_listener, surface);
   impl->pending_frame_counter = gdk_frame_clock_get_frame_counter (clock);
   impl->awaiting_frame = TRUE;
+
+  if (timings_use_presentation_feedback (display_wayland))
+    {
+      struct wp_presentation_feedback *feedback;
+      PresentationFeedback *data;
+
+      data = g_slice_new (PresentationFeedback);
+      data->surface = g_object_ref (surface);
+      data->frame_counter = impl->pending_frame_counter;
+
+      feedback = wp_presentation_feedback (display_wayland->presentation,
+                                           impl->display_server.wl_surface);
+      wl_proxy_set_queue ((struct wl_proxy *) feedback, NULL);
+      wp_presentation_feedback_add_listener (feedback,
+                                             &presentation_feedback_listener,
+                                             data);
+    }
 }
 
 gboolean
@@ -1462,6 +1588,8 @@ gdk_wayland_surface_configure_toplevel (GdkSurface *surface)
 
   is_resizing = impl->pending.toplevel.is_resizing;
   impl->pending.toplevel.is_resizing = FALSE;
+  if (is_resizing)
+    new_state |= GDK_TOPLEVEL_STATE_RESIZING;
 
   fixed_size =
     new_state & (GDK_TOPLEVEL_STATE_MAXIMIZED |
@@ -1521,12 +1649,13 @@ gdk_wayland_surface_configure_toplevel (GdkSurface *surface)
   gdk_surface_request_layout (surface);
 
   GDK_DISPLAY_NOTE (gdk_surface_get_display (surface), EVENTS,
-            g_message ("configure, surface %p %dx%d,%s%s%s%s",
+            g_message ("configure, surface %p %dx%d,%s%s%s%s%s",
                        surface, width, height,
                        (new_state & GDK_TOPLEVEL_STATE_FULLSCREEN) ? " fullscreen" : "",
                        (new_state & GDK_TOPLEVEL_STATE_MAXIMIZED) ? " maximized" : "",
                        (new_state & GDK_TOPLEVEL_STATE_FOCUSED) ? " focused" : "",
-                       (new_state & GDK_TOPLEVEL_STATE_TILED) ? " tiled" : ""));
+                       (new_state & GDK_TOPLEVEL_STATE_TILED) ? " tiled" : "",
+                       (new_state & GDK_TOPLEVEL_STATE_RESIZING) ? " resizing" : ""));
 
   gdk_surface_queue_state_change (surface, ~0 & ~new_state, new_state);
 
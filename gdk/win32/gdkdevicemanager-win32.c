@@ -885,7 +885,7 @@ gdk_input_other_event (GdkDisplay *display,
   int event_button = 0;
   GdkModifierType event_state;
   double event_x, event_y;
-  double *axes;
+  double axes[GDK_AXIS_LAST];
 
   /* Translation from tablet button state to GDK button state for
    * buttons 1-3 - swap button 2 and 3.
@@ -1043,8 +1043,6 @@ gdk_input_other_event (GdkDisplay *display,
       if (event_type == GDK_BUTTON_PRESS ||
           event_type == GDK_BUTTON_RELEASE)
         {
-          axes = g_new (double, GDK_AXIS_LAST);
-
           _gdk_device_wintab_translate_axes (source_device,
                                              window,
                                              axes,
@@ -1078,7 +1076,6 @@ gdk_input_other_event (GdkDisplay *display,
         }
       else
         {
-          axes = g_new (double, GDK_AXIS_LAST);
           _gdk_device_wintab_translate_axes (source_device,
                                              window,
                                              axes,
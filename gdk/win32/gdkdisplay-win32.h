@@ -27,6 +27,11 @@
  
 #ifdef GDK_WIN32_ENABLE_EGL
 # include <epoxy/egl.h>
+
+/* From EGL_ANGLE_direct_composition, which is not in the Khronos registry */
+# ifndef EGL_DIRECT_COMPOSITION_ANGLE
+#  define EGL_DIRECT_COMPOSITION_ANGLE 0x33A5
+# endif
 #endif
 
 /* Define values used to set DPI-awareness */
@@ -142,6 +147,9 @@ struct _GdkWin32Display
 #ifdef GDK_WIN32_ENABLE_EGL
   guint hasEglKHRCreateContext : 1;
   guint hasEglSurfacelessContext : 1;
+  guint hasEglBufferAge : 1;
+  guint hasEglSwapBuffersWithDamage : 1;
+  guint hasEglANGLEDirectComposition : 1;
   EGLint egl_min_swap_interval;
 #endif
 
@@ -250,10 +250,18 @@ gdk_win32_impl_frame_clock_after_paint (GdkFrameClock *clock,
           timing_info.cbSize = sizeof (timing_info);
           hr = DwmGetCompositionTimingInfo (NULL, &timing_info);
 
-          if (SUCCEEDED (hr))
+          if (SUCCEEDED (hr) && timing_info.qpcRefreshPeriod > 0)
             {
+              LARGE_INTEGER now;
+              QPC_TIME next_vblank = timing_info.qpcVBlank;
+
+              /* The DWM composes what we just drew at the next vblank */
+              QueryPerformanceCounter (&now);
+              if ((QPC_TIME) now.QuadPart > next_vblank)
+                next_vblank += (((QPC_TIME) now.QuadPart - next_vblank) / timing_info.qpcRefreshPeriod + 1) * timing_info.qpcRefreshPeriod;
+
               timings->refresh_interval = timing_info.qpcRefreshPeriod * (double)G_USEC_PER_SEC / tick_frequency.QuadPart;
-              timings->presentation_time = timing_info.qpcCompose * (double)G_USEC_PER_SEC / tick_frequency.QuadPart;
+              timings->presentation_time = next_vblank * (double)G_USEC_PER_SEC / tick_frequency.QuadPart;
             }
         }
 
@@ -5056,7 +5064,15 @@ _gdk_win32_surface_get_egl_surface (GdkSurface *surface,
   else
     {
       if (impl->egl_surface == EGL_NO_SURFACE)
-        impl->egl_surface = eglCreateWindowSurface (display->egl_disp, config, display->gl_hwnd, NULL);
+        {
+          /* Let ANGLE present through DirectComposition, which uses a
+           * flip model swapchain instead of blitting to the window
+           */
+          EGLint attribs[] = {EGL_DIRECT_COMPOSITION_ANGLE, EGL_TRUE, EGL_NONE};
+
+          impl->egl_surface = eglCreateWindowSurface (display->egl_disp, config, display->gl_hwnd,
+                                                      display->hasEglANGLEDirectComposition ? attribs : NULL);
+        }
 
       return impl->egl_surface;
     }
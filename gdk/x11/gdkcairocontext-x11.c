@@ -30,6 +30,11 @@
 
 #include <X11/Xlib.h>
 
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 G_DEFINE_TYPE (GdkX11CairoContext, gdk_x11_cairo_context, GDK_TYPE_CAIRO_CONTEXT)
 
 static cairo_surface_t *
@@ -54,6 +59,198 @@ create_cairo_surface_for_surface (GdkSurface *surface)
   return cairo_surface;
 }
 
+#ifdef HAVE_XSHM
+static void
+gdk_x11_cairo_context_free_shm (GdkX11CairoContext *self)
+{
+  Display *xdisplay;
+
+  if (self->shm_image == NULL)
+    return;
+
+  xdisplay = gdk_x11_display_get_xdisplay (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self)));
+
+  XShmDetach (xdisplay, &self->shm_info);
+  XDestroyImage (self->shm_image);
+  shmdt (self->shm_info.shmaddr);
+  self->shm_image = NULL;
+}
+
+/* Makes sure we have a shared memory image of the given size to paint
+ * into. This saves us from pushing all the pixels through the socket
+ * on every frame, as long as the X server is on the same machine.
+ */
+static gboolean
+gdk_x11_cairo_context_ensure_shm (GdkX11CairoContext *self,
+                                  GdkSurface         *surface,
+                                  int                 width,
+                                  int                 height)
+{
+  GdkDisplay *display;
+  Display *xdisplay;
+  Visual *visual;
+  XImage *image;
+  int depth;
+
+  if (self->shm_failed)
+    return FALSE;
+
+  if (self->shm_image &&
+      self->shm_image->width == width &&
+      self->shm_image->height == height)
+    return TRUE;
+
+  gdk_x11_cairo_context_free_shm (self);
+
+  display = gdk_surface_get_display (surface);
+  xdisplay = gdk_x11_display_get_xdisplay (display);
+  visual = gdk_x11_display_get_window_visual (GDK_X11_DISPLAY (display));
+  depth = gdk_x11_display_get_window_depth (GDK_X11_DISPLAY (display));
+
+  /* We hand cairo's pixels to the server as-is, so the layout must match */
+  if (!XShmQueryExtension (xdisplay) ||
+      (depth != 24 && depth != 32) ||
+      visual->red_mask != 0xff0000 ||
+      visual->green_mask != 0xff00 ||
+      visual->blue_mask != 0xff)
+    goto fail;
+
+  image = XShmCreateImage (xdisplay, visual, depth, ZPixmap, NULL, &self->shm_info, width, height);
+  if (image == NULL)
+    goto fail;
+
+  if (image->bits_per_pixel != 32 ||
+      image->bytes_per_line != cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width))
+    goto fail_image;
+
+  self->shm_info.shmid = shmget (IPC_PRIVATE, (size_t) image->bytes_per_line * height, IPC_CREAT | 0600);
+  if (self->shm_info.shmid < 0)
+    goto fail_image;
+
+  self->shm_info.shmaddr = shmat (self->shm_info.shmid, NULL, 0);
+  if (self->shm_info.shmaddr == (char *) -1)
+    goto fail_segment;
+
+  self->shm_info.readOnly = True;
+  image->data = self->shm_info.shmaddr;
+
+  /* This fails if the server can't see our segment, e.g. when remote */
+  gdk_x11_display_error_trap_push (display);
+  XShmAttach (xdisplay, &self->shm_info);
+  XSync (xdisplay, False);
+  if (gdk_x11_display_error_trap_pop (display))
+    {
+      shmdt (self->shm_info.shmaddr);
+      goto fail_segment;
+    }
+
+  /* The segment goes away once both we and the server detached */
+  shmctl (self->shm_info.shmid, IPC_RMID, NULL);
+
+  if (self->shm_gc == NULL)
+    self->shm_gc = XCreateGC (xdisplay, GDK_SURFACE_XID (surface), 0, NULL);
+
+  self->shm_image = image;
+  self->shm_serial = 0;
+
+  return TRUE;
+
+fail_segment:
+  shmctl (self->shm_info.shmid, IPC_RMID, NULL);
+fail_image:
+  XDestroyImage (image);
+fail:
+  GDK_DISPLAY_NOTE (display, MISC, g_message ("Not using MIT-SHM for cairo drawing"));
+  self->shm_failed = TRUE;
+  return FALSE;
+}
+
+static gboolean
+gdk_x11_cairo_context_begin_frame_shm (GdkX11CairoContext *self,
+                                       GdkSurface         *surface,
+                                       cairo_region_t     *region)
+{
+  Display *xdisplay;
+  cairo_t *cr;
+  int scale;
+
+  scale = gdk_surface_get_scale_factor (surface);
+
+  if (!gdk_x11_cairo_context_ensure_shm (self,
+                                         surface,
+                                         gdk_surface_get_width (surface) * scale,
+                                         gdk_surface_get_height (surface) * scale))
+    return FALSE;
+
+  /* The server reads the segment when it processes the XShmPutImage
+   * requests of the last frame, so wait for that before painting over it.
+   */
+  xdisplay = gdk_x11_display_get_xdisplay (gdk_surface_get_display (surface));
+  if ((long) (LastKnownRequestProcessed (xdisplay) - self->shm_serial) < 0)
+    XSync (xdisplay, False);
+
+  self->paint_surface = cairo_image_surface_create_for_data ((guchar *) self->shm_image->data,
+                                                             self->shm_image->depth == 32 ? CAIRO_FORMAT_ARGB32
+                                                                                          : CAIRO_FORMAT_RGB24,
+                                                             self->shm_image->width,
+                                                             self->shm_image->height,
+                                                             self->shm_image->bytes_per_line);
+  cairo_surface_set_device_scale (self->paint_surface, scale, scale);
+
+  /* clear the repaint area */
+  cr = cairo_create (self->paint_surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  gdk_cairo_region (cr, region);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  return TRUE;
+}
+
+static void
+gdk_x11_cairo_context_end_frame_shm (GdkX11CairoContext *self,
+                                     GdkSurface         *surface,
+                                     cairo_region_t     *painted)
+{
+  Display *xdisplay;
+  int i, n, scale;
+
+  xdisplay = gdk_x11_display_get_xdisplay (gdk_surface_get_display (surface));
+  scale = gdk_surface_get_scale_factor (surface);
+
+  cairo_surface_flush (self->paint_surface);
+
+  n = cairo_region_num_rectangles (painted);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x, y, width, height;
+
+      cairo_region_get_rectangle (painted, i, &rect);
+      x = MAX (rect.x * scale, 0);
+      y = MAX (rect.y * scale, 0);
+      width = MIN ((rect.x + rect.width) * scale, self->shm_image->width) - x;
+      height = MIN ((rect.y + rect.height) * scale, self->shm_image->height) - y;
+      if (width <= 0 || height <= 0)
+        continue;
+
+      XShmPutImage (xdisplay,
+                    GDK_SURFACE_XID (surface),
+                    self->shm_gc,
+                    self->shm_image,
+                    x, y,
+                    x, y,
+                    width, height,
+                    False);
+    }
+
+  self->shm_serial = NextRequest (xdisplay) - 1;
+  XFlush (xdisplay);
+
+  g_clear_pointer (&self->paint_surface, cairo_surface_destroy);
+}
+#endif
+
 static void
 gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
                                    cairo_region_t *region)
@@ -64,6 +261,12 @@ gdk_x11_cairo_context_begin_frame (GdkDrawContext *draw_context,
   double sx, sy;
 
   surface = gdk_draw_context_get_surface (draw_context);
+
+#ifdef HAVE_XSHM
+  if (gdk_x11_cairo_context_begin_frame_shm (self, surface, region))
+    return;
+#endif
+
   cairo_region_get_extents (region, &clip_box);
 
   self->window_surface = create_cairo_surface_for_surface (surface);
@@ -84,6 +287,14 @@ gdk_x11_cairo_context_end_frame (GdkDrawContext *draw_context,
   GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (draw_context);
   cairo_t *cr;
 
+#ifdef HAVE_XSHM
+  if (self->shm_image)
+    {
+      gdk_x11_cairo_context_end_frame_shm (self, gdk_draw_context_get_surface (draw_context), painted);
+      return;
+    }
+#endif
+
   cr = cairo_create (self->window_surface);
 
   cairo_set_source_surface (cr, self->paint_surface, 0, 0);
@@ -109,12 +320,34 @@ gdk_x11_cairo_context_cairo_create (GdkCairoContext *context)
   return cairo_create (self->paint_surface);
 }
 
+static void
+gdk_x11_cairo_context_dispose (GObject *object)
+{
+#ifdef HAVE_XSHM
+  GdkX11CairoContext *self = GDK_X11_CAIRO_CONTEXT (object);
+
+  gdk_x11_cairo_context_free_shm (self);
+
+  if (self->shm_gc)
+    {
+      XFreeGC (gdk_x11_display_get_xdisplay (gdk_draw_context_get_display (GDK_DRAW_CONTEXT (self))),
+               self->shm_gc);
+      self->shm_gc = NULL;
+    }
+#endif
+
+  G_OBJECT_CLASS (gdk_x11_cairo_context_parent_class)->dispose (object);
+}
+
 static void
 gdk_x11_cairo_context_class_init (GdkX11CairoContextClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GdkDrawContextClass *draw_context_class = GDK_DRAW_CONTEXT_CLASS (klass);
   GdkCairoContextClass *cairo_context_class = GDK_CAIRO_CONTEXT_CLASS (klass);
 
+  gobject_class->dispose = gdk_x11_cairo_context_dispose;
+
   draw_context_class->begin_frame = gdk_x11_cairo_context_begin_frame;
   draw_context_class->end_frame = gdk_x11_cairo_context_end_frame;
 
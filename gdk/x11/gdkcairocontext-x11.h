@@ -25,6 +25,12 @@
 
 #include "gdkcairocontextprivate.h"
 
+#include <X11/Xlib.h>
+
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 G_BEGIN_DECLS
 
 #define GDK_TYPE_X11_CAIRO_CONTEXT		(gdk_x11_cairo_context_get_type ())
@@ -43,6 +49,15 @@ struct _GdkX11CairoContext
 
   cairo_surface_t *window_surface;
   cairo_surface_t *paint_surface;
+
+#ifdef HAVE_XSHM
+  /* shared memory segment the paint surface lives in, if any */
+  XShmSegmentInfo shm_info;
+  XImage *shm_image;
+  GC shm_gc;
+  unsigned long shm_serial;
+  guint shm_failed : 1;
+#endif
 };
 
 struct _GdkX11CairoContextClass
@@ -27,6 +27,7 @@
 #include "gdkdisplay-x11.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/XInput2.h>
@@ -51,6 +52,7 @@ struct _GdkX11DeviceXI2
   int device_id;
   GArray *scroll_valuators;
   double *last_axes;
+  int n_last_axes;
   GdkX11DeviceType device_type;
 };
 
@@ -757,12 +759,23 @@ gdk_x11_device_xi2_store_axes (GdkX11DeviceXI2 *device,
                                double          *axes,
                                int              n_axes)
 {
-  g_free (device->last_axes);
-
   if (axes && n_axes)
-    device->last_axes = g_memdup (axes, sizeof (double) * n_axes);
+    {
+      /* This runs for every motion event, so reuse the buffer */
+      if (device->n_last_axes != n_axes)
+        {
+          g_free (device->last_axes);
+          device->last_axes = g_new (double, n_axes);
+          device->n_last_axes = n_axes;
+        }
+
+      memcpy (device->last_axes, axes, sizeof (double) * n_axes);
+    }
   else
-    device->last_axes = NULL;
+    {
+      g_clear_pointer (&device->last_axes, g_free);
+      device->n_last_axes = 0;
+    }
 }
 
 GdkX11DeviceType
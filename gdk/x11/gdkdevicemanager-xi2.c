@@ -1178,19 +1178,19 @@ set_user_time (GdkEvent *event)
     gdk_x11_surface_set_user_time (surface, time);
 }
 
-static double *
+static void
 translate_axes (GdkDevice       *device,
                 double           x,
                 double           y,
                 GdkSurface       *surface,
-                XIValuatorState *valuators)
+                XIValuatorState *valuators,
+                double           axes[GDK_AXIS_LAST])
 {
   guint n_axes, i;
-  double *axes;
   double *vals;
 
   n_axes = gdk_device_get_n_axes (device);
-  axes = g_new0 (double, GDK_AXIS_LAST);
+  memset (axes, 0, sizeof (double) * GDK_AXIS_LAST);
   vals = valuators->values;
 
   for (i = 0; i < MIN (valuators->mask_len * 8, n_axes); i++)
@@ -1222,8 +1222,6 @@ translate_axes (GdkDevice       *device,
     }
 
   gdk_x11_device_xi2_store_axes (GDK_X11_DEVICE_XI2 (device), axes, n_axes);
-
-  return axes;
 }
 
 static gboolean
@@ -1650,7 +1648,7 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         else
           {
             double x, y;
-            double *axes;
+            double axes[GDK_AXIS_LAST];
 
             device = g_hash_table_lookup (device_manager->id_table,
                                           GUINT_TO_POINTER (xev->deviceid));
@@ -1658,11 +1656,12 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
             source_device = g_hash_table_lookup (device_manager->id_table,
                                                  GUINT_TO_POINTER (xev->sourceid));
 
-            axes = translate_axes (device,
-                                   (double) xev->event_x / scale,
-                                   (double) xev->event_y / scale,
-                                   surface,
-                                   &xev->valuators);
+            translate_axes (device,
+                            (double) xev->event_x / scale,
+                            (double) xev->event_y / scale,
+                            surface,
+                            &xev->valuators,
+                            axes);
 
              x = (double) xev->event_x / scale;
              y = (double) xev->event_y / scale;
@@ -1692,7 +1691,7 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         double delta_x, delta_y;
 
         double x, y;
-        double *axes;
+        double axes[GDK_AXIS_LAST];
 
 #ifdef XINPUT_2_2
         if (xev->flags & XIPointerEmulated)
@@ -1763,11 +1762,12 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
             break;
           }
 
-        axes = translate_axes (device,
-                               (double) xev->event_x / scale,
-                               (double) xev->event_y / scale,
-                               surface,
-                               &xev->valuators);
+        translate_axes (device,
+                        (double) xev->event_x / scale,
+                        (double) xev->event_y / scale,
+                        surface,
+                        &xev->valuators,
+                        axes);
 
         x = (double) xev->event_x / scale;
         y = (double) xev->event_y / scale;
@@ -1791,7 +1791,7 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         GdkModifierType state;
 
         double x, y;
-        double *axes;
+        double axes[GDK_AXIS_LAST];
 
         GDK_DISPLAY_NOTE (display, EVENTS,
                  g_message ("touch %s:\twindow %ld\n\ttouch id: %u\n\tpointer emulating: %s",
@@ -1810,11 +1810,12 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         if (ev->evtype == XI_TouchBegin)
           state |= GDK_BUTTON1_MASK;
 
-        axes = translate_axes (device,
-                               (double) xev->event_x / scale,
-                               (double) xev->event_y / scale,
-                               surface,
-                               &xev->valuators);
+        translate_axes (device,
+                        (double) xev->event_x / scale,
+                        (double) xev->event_y / scale,
+                        surface,
+                        &xev->valuators,
+                        axes);
 
         x = (double) xev->event_x / scale;
         y = (double) xev->event_y / scale;
@@ -1842,7 +1843,7 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         GdkModifierType state;
 
         double x, y;
-        double *axes;
+        double axes[GDK_AXIS_LAST];
 
         GDK_DISPLAY_NOTE (display, EVENTS,
                  g_message ("touch update:\twindow %ld\n\ttouch id: %u\n\tpointer emulating: %s",
@@ -1859,11 +1860,12 @@ gdk_x11_device_manager_xi2_translate_event (GdkEventTranslator *translator,
         state = _gdk_x11_device_xi2_translate_state (&xev->mods, &xev->buttons, &xev->group);
         state |= GDK_BUTTON1_MASK;
 
-        axes = translate_axes (device,
-                               (double) xev->event_x / scale,
-                               (double) xev->event_y / scale,
-                               surface,
-                               &xev->valuators);
+        translate_axes (device,
+                        (double) xev->event_x / scale,
+                        (double) xev->event_y / scale,
+                        surface,
+                        &xev->valuators,
+                        axes);
 
         x = (double) xev->event_x / scale;
         y = (double) xev->event_y / scale;
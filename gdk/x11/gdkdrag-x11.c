@@ -121,6 +121,8 @@ struct _GdkX11Drag
 
   int hot_x;
   int hot_y;
+  int surface_x;               /* Where drag_surface was last moved to */
+  int surface_y;
 
   Window dest_xid;             /* The last window we looked up */
   Window proxy_xid;            /* The proxy window for dest_xid (or dest_xid if no proxying happens) */
@@ -129,6 +131,7 @@ struct _GdkX11Drag
   guint xdnd_have_actions : 1; /* Whether an XdndActionList was provided */
   guint drag_status       : 4; /* current status of drag */
   guint drop_failed       : 1; /* Whether the drop was unsuccessful */
+  guint surface_moved     : 1; /* Whether surface_x/y are set */
 };
 
 struct _GdkX11DragClass
@@ -1399,10 +1402,25 @@ move_drag_surface (GdkDrag *drag,
                   guint           y_root)
 {
   GdkX11Drag *drag_x11 = GDK_X11_DRAG (drag);
+  int x, y;
 
-  gdk_x11_surface_move (drag_x11->drag_surface,
-                        x_root - drag_x11->hot_x,
-                        y_root - drag_x11->hot_y);
+  x = x_root - drag_x11->hot_x;
+  y = y_root - drag_x11->hot_y;
+
+  /* Moving the surface makes it relayout and makes the X server
+   * restack it, so don't do that for events that don't move it,
+   * like key presses and modifier changes.
+   */
+  if (drag_x11->surface_moved &&
+      drag_x11->surface_x == x &&
+      drag_x11->surface_y == y)
+    return;
+
+  drag_x11->surface_x = x;
+  drag_x11->surface_y = y;
+  drag_x11->surface_moved = TRUE;
+
+  gdk_x11_surface_move (drag_x11->drag_surface, x, y);
   gdk_x11_surface_raise (drag_x11->drag_surface);
 }
 
@@ -59,6 +59,26 @@ struct _DirectionCacheEntry
   Atom group_atom;
 };
 
+/* Shortcut matching and input methods translate the same key events
+ * over and over, often with different modifiers, so we keep the last
+ * translations around. The cache is direct mapped, and cleared when
+ * the keymap serial changes.
+ */
+#define TRANSLATION_CACHE_SIZE 64
+
+typedef struct _TranslationCacheEntry TranslationCacheEntry;
+
+struct _TranslationCacheEntry
+{
+  guint keycode;
+  GdkModifierType state;
+  int group;
+  guint keyval;
+  int effective_group;
+  int level;
+  GdkModifierType consumed_modifiers;
+};
+
 struct _GdkX11Keymap
 {
   GdkKeymap     parent_instance;
@@ -94,6 +114,9 @@ struct _GdkX11Keymap
    */
   DirectionCacheEntry group_direction_cache[4];
 #endif
+
+  guint translation_cache_serial;
+  TranslationCacheEntry translation_cache[TRANSLATION_CACHE_SIZE];
 };
 
 struct _GdkX11KeymapClass
@@ -130,6 +153,10 @@ gdk_x11_keymap_init (GdkX11Keymap *keymap)
   keymap->current_cache_serial = 0;
 #endif
 
+  /* Keycodes below min_keycode never get looked up, so the
+   * zeroed entries of translation_cache can't match
+   */
+  keymap->translation_cache_serial = 0;
 }
 
 static void
@@ -1295,6 +1322,27 @@ translate_keysym (GdkX11Keymap   *keymap_x11,
 #undef SYM
 }
 
+static TranslationCacheEntry *
+get_translation_cache_entry (GdkX11Keymap    *keymap_x11,
+                             guint            hardware_keycode,
+                             GdkModifierType  state,
+                             int              group)
+{
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (GDK_KEYMAP (keymap_x11)->display);
+  guint hash;
+
+  if (keymap_x11->translation_cache_serial != display_x11->keymap_serial)
+    {
+      memset (keymap_x11->translation_cache, 0, sizeof (keymap_x11->translation_cache));
+      keymap_x11->translation_cache_serial = display_x11->keymap_serial;
+    }
+
+  hash = hardware_keycode ^ (state * 31) ^ (group << 5);
+  hash ^= hash >> 8;
+
+  return &keymap_x11->translation_cache[hash % TRANSLATION_CACHE_SIZE];
+}
+
 static gboolean
 gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
                                          guint            hardware_keycode,
@@ -1306,8 +1354,12 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
                                          GdkModifierType *consumed_modifiers)
 {
   GdkX11Keymap *keymap_x11 = GDK_X11_KEYMAP (keymap);
+  TranslationCacheEntry *entry;
+  GdkModifierType orig_state = state;
   KeySym tmp_keyval = NoSymbol;
   guint tmp_modifiers;
+  int tmp_group = 0;
+  int tmp_level = 0;
 
   g_return_val_if_fail (group < 4, FALSE);
 
@@ -1326,6 +1378,18 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
       hardware_keycode > keymap_x11->max_keycode)
     return FALSE;
 
+  entry = get_translation_cache_entry (keymap_x11, hardware_keycode, state, group);
+  if (entry->keycode == hardware_keycode &&
+      entry->state == state &&
+      entry->group == group)
+    {
+      tmp_keyval = entry->keyval;
+      tmp_group = entry->effective_group;
+      tmp_level = entry->level;
+      tmp_modifiers = entry->consumed_modifiers;
+      goto out;
+    }
+
 #ifdef HAVE_XKB
   if (KEYMAP_USE_XKB (keymap))
     {
@@ -1340,8 +1404,8 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
                                      state,
                                      &tmp_modifiers,
                                      &tmp_keyval,
-                                     effective_group,
-                                     level);
+                                     &tmp_group,
+                                     &tmp_level);
 
       if (state & ~tmp_modifiers & LockMask)
         tmp_keyval = gdk_keyval_to_upper (tmp_keyval);
@@ -1383,9 +1447,26 @@ gdk_x11_keymap_translate_keyboard_state (GdkKeymap       *keymap,
 
       tmp_keyval = translate_keysym (keymap_x11, hardware_keycode,
                                      group, state,
-                                     level, effective_group);
+                                     &tmp_level, &tmp_group);
     }
 
+  /* the translation may have updated the keymap */
+  entry = get_translation_cache_entry (keymap_x11, hardware_keycode, orig_state, group);
+  entry->keycode = hardware_keycode;
+  entry->state = orig_state;
+  entry->group = group;
+  entry->keyval = tmp_keyval;
+  entry->effective_group = tmp_group;
+  entry->level = tmp_level;
+  entry->consumed_modifiers = tmp_modifiers;
+
+out:
+  if (effective_group)
+    *effective_group = tmp_group;
+
+  if (level)
+    *level = tmp_level;
+
   if (consumed_modifiers)
     *consumed_modifiers = tmp_modifiers;
 
@@ -31,6 +31,12 @@
 
 typedef struct GdkX11SelectionInputStreamPrivate  GdkX11SelectionInputStreamPrivate;
 
+/* During INCR, the owner only sends the next chunk once we delete
+ * the property. We hold off on that while this many chunks are
+ * waiting to be read, so slow readers don't make data pile up.
+ */
+#define MAX_QUEUED_CHUNKS 4
+
 struct GdkX11SelectionInputStreamPrivate {
   GdkDisplay *display;
   GAsyncQueue *chunks;
@@ -50,6 +56,7 @@ struct GdkX11SelectionInputStreamPrivate {
 
   guint complete : 1;
   guint incr : 1;
+  guint delete_pending : 1;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GdkX11SelectionInputStream, gdk_x11_selection_input_stream, G_TYPE_INPUT_STREAM);
@@ -59,6 +66,24 @@ gdk_x11_selection_input_stream_xevent (GdkDisplay   *display,
                                        const XEvent *xevent,
                                        gpointer      data);
 
+static gboolean
+gdk_x11_selection_input_stream_invoke_delete (gpointer data)
+{
+  GdkX11SelectionInputStream *stream = GDK_X11_SELECTION_INPUT_STREAM (data);
+  GdkX11SelectionInputStreamPrivate *priv = gdk_x11_selection_input_stream_get_instance_private (stream);
+
+  if (priv->complete)
+    return G_SOURCE_REMOVE;
+
+  GDK_NOTE (SELECTION, g_printerr ("%s:%s: reader caught up, requesting next INCR chunk\n",
+                                  priv->selection, priv->target));
+  XDeleteProperty (gdk_x11_display_get_xdisplay (priv->display),
+                   GDK_X11_DISPLAY (priv->display)->leader_window,
+                   priv->xproperty);
+
+  return G_SOURCE_REMOVE;
+}
+
 static gboolean
 gdk_x11_selection_input_stream_has_data (GdkX11SelectionInputStream *stream)
 {
@@ -117,6 +142,18 @@ gdk_x11_selection_input_stream_fill_buffer (GdkX11SelectionInputStream *stream,
   if (bytes)
     g_async_queue_push_front_unlocked (priv->chunks, bytes);
 
+  if (priv->delete_pending &&
+      g_async_queue_length_unlocked (priv->chunks) < MAX_QUEUED_CHUNKS)
+    {
+      priv->delete_pending = FALSE;
+      /* this may be a reading thread, X calls happen in the main thread */
+      g_main_context_invoke_full (NULL,
+                                  G_PRIORITY_DEFAULT,
+                                  gdk_x11_selection_input_stream_invoke_delete,
+                                  g_object_ref (stream),
+                                  g_object_unref);
+    }
+
   g_async_queue_unlock (priv->chunks);
 
   return result;
@@ -424,11 +461,22 @@ gdk_x11_selection_input_stream_xevent (GdkDisplay   *display,
         }
       else
         {
+          gboolean defer_delete;
+
           GDK_DISPLAY_NOTE (display, SELECTION, g_printerr ("%s:%s: got PropertyNotify during INCR with %zu bytes\n",
                                           priv->selection, priv->target,
                                           g_bytes_get_size (bytes)));
-          g_async_queue_push (priv->chunks, bytes);
+          g_async_queue_lock (priv->chunks);
+          g_async_queue_push_unlocked (priv->chunks, bytes);
+          defer_delete = g_async_queue_length_unlocked (priv->chunks) >= MAX_QUEUED_CHUNKS;
+          priv->delete_pending = defer_delete;
+          g_async_queue_unlock (priv->chunks);
+
+          /* Reading here may already delete the property */
           gdk_x11_selection_input_stream_flush (stream);
+
+          if (defer_delete)
+            return FALSE;
         }
 
       XDeleteProperty (xdisplay, xwindow, xevent->xproperty.atom);
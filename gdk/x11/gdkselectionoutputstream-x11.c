@@ -57,6 +57,7 @@ struct _GdkX11SelectionOutputStreamPrivate {
   GTask *pending_task;
 
   guint incr : 1;
+  guint incr_done : 1;
   guint delete_pending : 1;
 };
 
@@ -159,6 +160,12 @@ static gboolean
 gdk_x11_selection_output_stream_xevent (GdkDisplay   *display,
                                         const XEvent *xevent,
                                         gpointer      data);
+static void
+gdk_x11_selection_output_stream_flush_async (GOutputStream       *output_stream,
+                                             int                  io_priority,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             user_data);
 
 static gboolean
 gdk_x11_selection_output_stream_can_flush (GdkX11SelectionOutputStream *stream)
@@ -177,7 +184,11 @@ gdk_x11_selection_output_stream_needs_flush_unlocked (GdkX11SelectionOutputStrea
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
 
   if (priv->data->len == 0 && priv->notify == NULL)
-    return FALSE;
+    {
+      /* INCR transfers end with a zero-length property */
+      return priv->incr && !priv->incr_done &&
+             g_output_stream_is_closing (G_OUTPUT_STREAM (stream));
+    }
 
   if (g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
     return TRUE;
@@ -243,6 +254,11 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
 
   element_size = get_element_size (priv->format);
   n_elements = priv->data->len / element_size;
+  /* Only hand out one chunk at a time during INCR, the rest is
+   * written once the requestor deleted the property.
+   */
+  if (priv->incr)
+    n_elements = MIN (n_elements, gdk_x11_display_get_max_request_size (priv->display) / element_size);
 
   if (priv->notify && !g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
     {
@@ -283,7 +299,14 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
                                       priv->selection, priv->target, n_elements * element_size, priv->data->len));
       g_byte_array_remove_range (priv->data, 0, n_elements * element_size);
       if (priv->data->len < element_size)
-        priv->flush_requested = FALSE;
+        {
+          priv->flush_requested = FALSE;
+          /* a partial element can never be written */
+          if (g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
+            g_byte_array_set_size (priv->data, 0);
+        }
+      if (priv->incr && n_elements == 0)
+        priv->incr_done = TRUE;
     }
 
   if (priv->notify)
@@ -306,9 +329,16 @@ gdk_x11_selection_output_stream_perform_flush (GdkX11SelectionOutputStream *stre
 
   if (priv->pending_task)
     {
-      g_task_return_int (priv->pending_task, GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task)));
-      g_object_unref (priv->pending_task);
-      priv->pending_task = NULL;
+      if (!g_async_result_is_tagged (G_ASYNC_RESULT (priv->pending_task), gdk_x11_selection_output_stream_flush_async))
+        {
+          g_task_return_int (priv->pending_task, GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task)));
+          g_clear_object (&priv->pending_task);
+        }
+      else if (!gdk_x11_selection_output_stream_needs_flush (stream))
+        {
+          g_task_return_boolean (priv->pending_task, TRUE);
+          g_clear_object (&priv->pending_task);
+        }
     }
 }
 
@@ -334,6 +364,11 @@ gdk_x11_selection_output_stream_write (GOutputStream  *output_stream,
   GdkX11SelectionOutputStream *stream = GDK_X11_SELECTION_OUTPUT_STREAM (output_stream);
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
 
+  /* Take at most a chunk per write and wait for the requestor to
+   * catch up, so large transfers don't pile up in memory.
+   */
+  count = MIN (count, gdk_x11_display_get_max_request_size (priv->display));
+
   g_mutex_lock (&priv->mutex);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: wrote %zu bytes, %u total now\n",
@@ -343,7 +378,7 @@ gdk_x11_selection_output_stream_write (GOutputStream  *output_stream,
   g_main_context_invoke (NULL, gdk_x11_selection_output_stream_invoke_flush, stream);
 
   g_mutex_lock (&priv->mutex);
-  if (gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
+  while (gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
     g_cond_wait (&priv->cond, &priv->mutex);
   g_mutex_unlock (&priv->mutex);
 
@@ -367,6 +402,8 @@ gdk_x11_selection_output_stream_write_async (GOutputStream        *output_stream
   g_task_set_source_tag (task, gdk_x11_selection_output_stream_write_async);
   g_task_set_priority (task, io_priority);
 
+  count = MIN (count, gdk_x11_display_get_max_request_size (priv->display));
+
   g_mutex_lock (&priv->mutex);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: async wrote %zu bytes, %u total now\n",
@@ -439,7 +476,7 @@ gdk_x11_selection_output_stream_flush (GOutputStream  *output_stream,
   g_main_context_invoke (NULL, gdk_x11_selection_output_stream_invoke_flush, stream);
 
   g_mutex_lock (&priv->mutex);
-  if (gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
+  while (gdk_x11_selection_output_stream_needs_flush_unlocked (stream))
     g_cond_wait (&priv->cond, &priv->mutex);
   g_mutex_unlock (&priv->mutex);
 
@@ -461,23 +498,31 @@ gdk_x11_selection_output_stream_flush_async (GOutputStream       *output_stream,
   g_task_set_source_tag (task, gdk_x11_selection_output_stream_flush_async);
   g_task_set_priority (task, io_priority);
 
+  /* Writing a property without need would end an INCR transfer */
+  if (!gdk_x11_selection_output_request_flush (stream))
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
   if (!gdk_x11_selection_output_stream_can_flush (stream))
     {
-      if (gdk_x11_selection_output_request_flush (stream))
-        {
-          g_assert (priv->pending_task == NULL);
-          priv->pending_task = task;
-          return;
-        }
-      else
-        {
-          g_task_return_boolean (task, TRUE);
-          g_object_unref (task);
-          return;
-        }
+      g_assert (priv->pending_task == NULL);
+      priv->pending_task = task;
+      return;
     }
 
   gdk_x11_selection_output_stream_perform_flush (stream);
+
+  /* The rest goes out as the requestor deletes the property */
+  if (gdk_x11_selection_output_stream_needs_flush (stream))
+    {
+      g_assert (priv->pending_task == NULL);
+      priv->pending_task = task;
+      return;
+    }
+
   g_task_return_boolean (task, TRUE);
   g_object_unref (task);
   return;
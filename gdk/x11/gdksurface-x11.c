@@ -4147,6 +4147,9 @@ update_pos (MoveResizeData *mv_resize,
 static void
 finish_drag (MoveResizeData *mv_resize)
 {
+  if (mv_resize->is_resize)
+    gdk_synthesize_surface_state (mv_resize->moveresize_surface, GDK_TOPLEVEL_STATE_RESIZING, 0);
+
   gdk_surface_destroy (mv_resize->moveresize_emulation_surface);
   mv_resize->moveresize_emulation_surface = NULL;
   g_clear_object (&mv_resize->moveresize_surface);
@@ -4420,6 +4423,8 @@ emulate_resize_drag (GdkSurface     *surface,
 
   calculate_unmoving_origin (mv_resize);
 
+  gdk_synthesize_surface_state (surface, 0, GDK_TOPLEVEL_STATE_RESIZING);
+
   create_moveresize_surface (mv_resize, timestamp);
 }
 
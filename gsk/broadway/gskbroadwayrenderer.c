@@ -256,19 +256,18 @@ collect_reused_child_nodes (GskRenderer *renderer,
     case GSK_OUTSET_SHADOW_NODE:
     case GSK_INSET_SHADOW_NODE:
     case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
 
       /* Fallbacks (=> leaf for now */
     case GSK_GL_SHADER_NODE:
     case GSK_COLOR_MATRIX_NODE:
     case GSK_TEXT_NODE:
-    case GSK_RADIAL_GRADIENT_NODE:
-    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
-    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
-    case GSK_CONIC_GRADIENT_NODE:
     case GSK_REPEAT_NODE:
     case GSK_BLEND_NODE:
     case GSK_CROSS_FADE_NODE:
-    case GSK_BLUR_NODE:
 
     default:
 
@@ -286,6 +285,11 @@ collect_reused_child_nodes (GskRenderer *renderer,
                            gsk_opacity_node_get_child (node));
       break;
 
+    case GSK_BLUR_NODE:
+      collect_reused_node (renderer,
+                           gsk_blur_node_get_child (node));
+      break;
+
     case GSK_ROUNDED_CLIP_NODE:
       collect_reused_node (renderer,
                            gsk_rounded_clip_node_get_child (node));
@@ -346,6 +350,7 @@ node_type_is_container (BroadwayNodeType type)
   return
     type == BROADWAY_NODE_SHADOW ||
     type == BROADWAY_NODE_OPACITY ||
+    type == BROADWAY_NODE_BLUR ||
     type == BROADWAY_NODE_ROUNDED_CLIP ||
     type == BROADWAY_NODE_CLIP ||
     type == BROADWAY_NODE_TRANSFORM ||
@@ -662,7 +667,12 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
       return;
 
     case GSK_LINEAR_GRADIENT_NODE:
-      if (add_new_node (renderer, node, BROADWAY_NODE_LINEAR_GRADIENT, clip_bounds))
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      if (add_new_node (renderer, node,
+                        gsk_render_node_get_node_type (node) == GSK_LINEAR_GRADIENT_NODE
+                        ? BROADWAY_NODE_LINEAR_GRADIENT
+                        : BROADWAY_NODE_REPEATING_LINEAR_GRADIENT,
+                        clip_bounds))
         {
           guint i, n;
 
@@ -676,6 +686,44 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
         }
       return;
 
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      if (add_new_node (renderer, node,
+                        gsk_render_node_get_node_type (node) == GSK_RADIAL_GRADIENT_NODE
+                        ? BROADWAY_NODE_RADIAL_GRADIENT
+                        : BROADWAY_NODE_REPEATING_RADIAL_GRADIENT,
+                        clip_bounds))
+        {
+          guint i, n;
+
+          add_rect (nodes, &node->bounds, offset_x, offset_y);
+          add_point (nodes, gsk_radial_gradient_node_get_center (node), offset_x, offset_y);
+          add_float (nodes, gsk_radial_gradient_node_get_hradius (node));
+          add_float (nodes, gsk_radial_gradient_node_get_vradius (node));
+          add_float (nodes, gsk_radial_gradient_node_get_start (node));
+          add_float (nodes, gsk_radial_gradient_node_get_end (node));
+          n = gsk_radial_gradient_node_get_n_color_stops (node);
+          add_uint32 (nodes, n);
+          for (i = 0; i < n; i++)
+            add_color_stop (nodes, &gsk_radial_gradient_node_get_color_stops (node, NULL)[i]);
+        }
+      return;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      if (add_new_node (renderer, node, BROADWAY_NODE_CONIC_GRADIENT, clip_bounds))
+        {
+          guint i, n;
+
+          add_rect (nodes, &node->bounds, offset_x, offset_y);
+          add_point (nodes, gsk_conic_gradient_node_get_center (node), offset_x, offset_y);
+          add_float (nodes, gsk_conic_gradient_node_get_rotation (node));
+          n = gsk_conic_gradient_node_get_n_color_stops (node);
+          add_uint32 (nodes, n);
+          for (i = 0; i < n; i++)
+            add_color_stop (nodes, &gsk_conic_gradient_node_get_color_stops (node, NULL)[i]);
+        }
+      return;
+
       /* Bin nodes */
 
     case GSK_SHADOW_NODE:
@@ -708,6 +756,16 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
         }
       return;
 
+    case GSK_BLUR_NODE:
+      if (add_new_node (renderer, node, BROADWAY_NODE_BLUR, clip_bounds))
+        {
+          add_float (nodes, gsk_blur_node_get_radius (node));
+          gsk_broadway_renderer_add_node (renderer,
+                                          gsk_blur_node_get_child (node),
+                                          offset_x, offset_y, clip_bounds);
+        }
+      return;
+
     case GSK_ROUNDED_CLIP_NODE:
       if (add_new_node (renderer, node, BROADWAY_NODE_ROUNDED_CLIP, clip_bounds))
         {
@@ -846,14 +904,9 @@ gsk_broadway_renderer_add_node (GskRenderer *renderer,
       break; /* Fallback */
 
     case GSK_TEXT_NODE:
-    case GSK_RADIAL_GRADIENT_NODE:
-    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
-    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
-    case GSK_CONIC_GRADIENT_NODE:
     case GSK_REPEAT_NODE:
     case GSK_BLEND_NODE:
     case GSK_CROSS_FADE_NODE:
-    case GSK_BLUR_NODE:
     case GSK_GL_SHADER_NODE:
     default:
       break; /* Fallback */
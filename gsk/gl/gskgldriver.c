@@ -6,12 +6,18 @@
 #include "gskprofilerprivate.h"
 #include "gdk/gdkglcontextprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdkdmabuftextureprivate.h"
 #include "gdk/gdkgltextureprivate.h"
 #include "gdkmemorytextureprivate.h"
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
 
+/* The number of frames that unused render targets are kept around
+ * for reuse before they are deleted.
+ */
+#define MAX_RENDER_TARGET_AGE 3
+
  typedef struct {
   GLuint fbo_id;
   GLuint depth_stencil_id;
@@ -27,6 +33,7 @@ typedef struct {
   GdkTexture *user;
   guint in_use : 1;
   guint permanent : 1;
+  guint age : 2; /* frames spent unused in free_render_targets */
 
   /* TODO: Make this optional and not for every texture... */
   TextureSlice *slices;
@@ -38,6 +45,7 @@ struct _GskGLDriver
   GObject parent_instance;
 
   GdkGLContext *gl_context;
+  gpointer texture_key; /* render data key for uploaded GdkTextures */
   GskProfiler *profiler;
   struct {
     GQuark created_textures;
@@ -49,6 +57,7 @@ struct _GskGLDriver
 
   GHashTable *textures;         /* texture_id -> Texture */
   GHashTable *pointer_textures; /* pointer -> texture_id */
+  GPtrArray *free_render_targets; /* (element-type Texture) */
 
   const Texture *bound_source_texture;
 
@@ -149,6 +158,12 @@ texture_free (gpointer data)
   g_slice_free (Texture, t);
 }
 
+static gboolean
+filter_uses_mipmaps (int filter)
+{
+  return filter != GL_NEAREST && filter != GL_LINEAR;
+}
+
 static void
 gsk_gl_driver_set_texture_parameters (GskGLDriver *self,
                                       int          min_filter,
@@ -168,6 +183,7 @@ gsk_gl_driver_finalize (GObject *gobject)
 
   gdk_gl_context_make_current (self->gl_context);
 
+  g_clear_pointer (&self->free_render_targets, g_ptr_array_unref);
   g_clear_pointer (&self->textures, g_hash_table_unref);
   g_clear_pointer (&self->pointer_textures, g_hash_table_unref);
   g_clear_object (&self->profiler);
@@ -190,6 +206,7 @@ static void
 gsk_gl_driver_init (GskGLDriver *self)
 {
   self->textures = g_hash_table_new_full (NULL, NULL, NULL, texture_free);
+  self->free_render_targets = g_ptr_array_new ();
 
   self->max_texture_size = -1;
 
@@ -219,6 +236,16 @@ gsk_gl_driver_new (GdkGLContext *context)
   self = (GskGLDriver *) g_object_new (GSK_TYPE_GL_DRIVER, NULL);
   self->gl_context = context;
 
+  /* The contexts of all surfaces of a display share their textures, so
+   * a GdkTexture only needs to be uploaded once for all of them. It stays
+   * with the driver that uploaded it, and the other drivers just use it.
+   */
+  if (gdk_gl_context_get_shared_context (context) != NULL &&
+      g_getenv ("GSK_NO_SHARED_CACHES") == NULL)
+    self->texture_key = gdk_gl_context_get_shared_context (context);
+  else
+    self->texture_key = self;
+
   return self;
 }
 
@@ -260,6 +287,15 @@ gsk_gl_driver_in_frame (GskGLDriver *self)
   return self->in_frame;
 }
 
+#ifdef G_ENABLE_DEBUG
+/* The number of textures uploaded since the frame began */
+gint64
+gsk_gl_driver_get_n_uploads (GskGLDriver *self)
+{
+  return gsk_profiler_counter_get (self->profiler, self->counters.surface_uploads);
+}
+#endif
+
 void
 gsk_gl_driver_end_frame (GskGLDriver *self)
 {
@@ -299,6 +335,9 @@ gsk_gl_driver_collect_textures (GskGLDriver *self)
 
   old_size = g_hash_table_size (self->textures);
 
+  /* Collected again below, minus the ones that got too old */
+  g_ptr_array_set_size (self->free_render_targets, 0);
+
   g_hash_table_iter_init (&iter, self->textures);
   while (g_hash_table_iter_next (&iter, NULL, &value_p))
     {
@@ -309,13 +348,33 @@ gsk_gl_driver_collect_textures (GskGLDriver *self)
 
       if (t->in_use)
         {
+          /* Render targets keep their framebuffer, so that they can be
+           * reused without creating new GL objects. */
           t->in_use = FALSE;
-
-          if (t->fbo.fbo_id != 0)
+          t->age = 0;
+        }
+      else if (t->fbo.fbo_id != 0 && t->age < MAX_RENDER_TARGET_AGE)
+        {
+          /* Its contents are not going to be used again, so it is free
+           * to be rendered to by create_render_target() */
+          if (t->age == 0 && self->pointer_textures)
             {
-              fbo_clear (&t->fbo);
-              t->fbo.fbo_id = 0;
+              GHashTableIter pointer_iter;
+              gpointer value;
+
+              g_hash_table_iter_init (&pointer_iter, self->pointer_textures);
+              while (g_hash_table_iter_next (&pointer_iter, NULL, &value))
+                {
+                  if (GPOINTER_TO_INT (value) == t->texture_id)
+                    {
+                      g_hash_table_iter_remove (&pointer_iter);
+                      break;
+                    }
+                }
             }
+
+          t->age++;
+          g_ptr_array_add (self->free_render_targets, t);
         }
       else
         {
@@ -445,7 +504,7 @@ gsk_gl_driver_slice_texture (GskGLDriver   *self,
   g_assert (tex_width > max_texture_size || tex_height > max_texture_size);
 
 
-  tex = gdk_texture_get_render_data (texture, self);
+  tex = gdk_texture_get_render_data (texture, self->texture_key);
 
   if (tex != NULL)
     {
@@ -502,7 +561,7 @@ gsk_gl_driver_slice_texture (GskGLDriver   *self,
 
   /* Use texture_free as destroy notify here since we are not inserting this Texture
    * into self->textures! */
-  gdk_texture_set_render_data (texture, self, tex, texture_free);
+  gdk_texture_set_render_data (texture, self->texture_key, tex, texture_free);
 
   *out_slices = slices;
   *out_n_slices = cols * rows;
@@ -549,12 +608,32 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
     }
   else
     {
-      t = gdk_texture_get_render_data (texture, self);
+      t = gdk_texture_get_render_data (texture, self->texture_key);
 
-      if (t)
+      if (t && t->mag_filter == mag_filter)
         {
-          if (t->min_filter == min_filter && t->mag_filter == mag_filter)
+          if (t->min_filter == min_filter)
             return t->texture_id;
+
+          /* A mipmapped texture samples its full resolution level when
+           * it is not drawn smaller, so it can be used for both */
+          if (filter_uses_mipmaps (t->min_filter) && !filter_uses_mipmaps (min_filter))
+            return t->texture_id;
+
+          /* Add the mipmaps to the existing texture instead of uploading
+           * it again, they only get built for textures that need them */
+          if (filter_uses_mipmaps (min_filter) && !filter_uses_mipmaps (t->min_filter))
+            {
+              /* The texture may belong to another driver */
+              glActiveTexture (GL_TEXTURE0);
+              glBindTexture (GL_TEXTURE_2D, t->texture_id);
+              self->bound_source_texture = NULL;
+              gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
+              glGenerateMipmap (GL_TEXTURE_2D);
+              t->min_filter = min_filter;
+
+              return t->texture_id;
+            }
         }
 
       source_texture = texture;
@@ -562,7 +641,7 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *self,
 
   t = create_texture (self, gdk_texture_get_width (texture), gdk_texture_get_height (texture));
 
-  if (gdk_texture_set_render_data (texture, self, t, gsk_gl_driver_release_texture))
+  if (gdk_texture_set_render_data (texture, self->texture_key, t, gsk_gl_driver_release_texture))
     t->user = texture;
 
   gsk_gl_driver_bind_source_texture (self, t->texture_id);
@@ -671,9 +750,42 @@ gsk_gl_driver_create_render_target (GskGLDriver *self,
 {
   GLuint fbo_id;
   Texture *texture;
+  guint i;
 
   g_return_if_fail (self->in_frame);
 
+  for (i = 0; i < self->free_render_targets->len; i++)
+    {
+      texture = g_ptr_array_index (self->free_render_targets, i);
+
+      /* Sizes must match, the texture is always sampled as a whole.
+       * Its contents are undefined, like those of a new one, and
+       * get cleared by the renderer. */
+      if (texture->width != width || texture->height != height)
+        continue;
+
+      g_ptr_array_remove_index_fast (self->free_render_targets, i);
+
+      texture->in_use = TRUE;
+      texture->age = 0;
+
+      gsk_gl_driver_bind_source_texture (self, texture->texture_id);
+      if (texture->min_filter != min_filter || texture->mag_filter != mag_filter)
+        {
+          texture->min_filter = min_filter;
+          texture->mag_filter = mag_filter;
+          gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
+        }
+
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_inc (self->profiler, self->counters.reused_textures);
+#endif
+
+      *out_texture_id = texture->texture_id;
+      *out_render_target_id = texture->fbo.fbo_id;
+      return;
+    }
+
   texture = create_texture (self, width, height);
   gsk_gl_driver_bind_source_texture (self, texture->texture_id);
   gsk_gl_driver_init_texture_empty (self, texture->texture_id, min_filter, mag_filter);
@@ -806,12 +918,6 @@ gsk_gl_driver_init_texture_empty (GskGLDriver *self,
   glBindTexture (GL_TEXTURE_2D, 0);
 }
 
-static gboolean
-filter_uses_mipmaps (int filter)
-{
-  return filter != GL_NEAREST && filter != GL_LINEAR;
-}
-
 void
 gsk_gl_driver_init_texture (GskGLDriver     *self,
                             int              texture_id,
@@ -838,11 +944,16 @@ gsk_gl_driver_init_texture (GskGLDriver     *self,
 
   gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
 
-  upload_gdk_texture (texture, GL_TEXTURE_2D, 0, 0, t->width, t->height);
+  /* Dmabufs can become the texture's storage directly */
+  if (!GDK_IS_DMABUF_TEXTURE (texture) ||
+      !gdk_dmabuf_texture_import_gl (GDK_DMABUF_TEXTURE (texture), GL_TEXTURE_2D))
+    {
+      upload_gdk_texture (texture, GL_TEXTURE_2D, 0, 0, t->width, t->height);
 
 #ifdef G_ENABLE_DEBUG
-  gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
+      gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
 #endif
+    }
 
   t->min_filter = min_filter;
   t->mag_filter = mag_filter;
@@ -7,6 +7,7 @@
 #include "gskgltextureatlasprivate.h"
 
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdksurfaceprivate.h"
 #include "gdk/gdkmemorytextureprivate.h"
 
 #include <graphene.h>
@@ -22,21 +23,63 @@
  *
  * We keep count of the pixels of each atlas that are
  * taken up by old data. When the fraction of old pixels
- * gets too high, we drop the atlas and all the items it
- * contained.
+ * gets too high, we compact the atlas: glyphs that are
+ * still in use get copied to other atlases on the GPU,
+ * the old ones are dropped along with the atlas.
  *
  * Big glyphs are not stored in the atlas, they get their
  * own texture, but they are still cached.
+ *
+ * Glyphs without color are stored in single channel (R8)
+ * atlases when the GL implementation can swizzle them.
+ * Glyphs that get added to an atlas are not uploaded
+ * right away, but collected and uploaded in one go per
+ * atlas by gsk_gl_glyph_cache_upload_pending().
+ *
+ * In async mode, atlas glyphs are instead rasterized by a
+ * thread pool. They are marked as pending until the result
+ * has been uploaded at the next begin_frame, and renderers
+ * skip drawing them meanwhile.
  */
 
 #define MAX_FRAME_AGE (60)
 #define MAX_GLYPH_SIZE 128 /* Will get its own texture if bigger */
 
+#define MAX_RASTERIZE_THREADS 4
+
+typedef struct
+{
+  GlyphCacheKey *key;
+  GskGLCachedGlyph *value;
+  cairo_surface_t *surface; /* rasterized already, or NULL */
+} PendingGlyph;
+
+/* A glyph rasterized on a worker thread. The job only gets
+ * touched by the worker between being pushed to the pool and
+ * being handed back to the main thread, which owns it otherwise.
+ */
+typedef struct
+{
+  GskGLGlyphCache *cache;
+  GlyphCacheKey key;
+  cairo_scaled_font_t *scaled_font;
+  cairo_format_t format;
+
+  int draw_x;
+  int draw_y;
+  int width;
+  int height;
+  float scale;
+
+  cairo_surface_t *surface;
+} RasterizeJob;
+
 static guint    glyph_cache_hash       (gconstpointer v);
 static gboolean glyph_cache_equal      (gconstpointer v1,
                                         gconstpointer v2);
 static void     glyph_cache_key_free   (gpointer      v);
 static void     glyph_cache_value_free (gpointer      v);
+static void     rasterize_job_free     (RasterizeJob *job);
 
 GskGLGlyphCache *
 gsk_gl_glyph_cache_new (GdkDisplay *display,
@@ -51,6 +94,8 @@ gsk_gl_glyph_cache_new (GdkDisplay *display,
                                                    glyph_cache_key_free, glyph_cache_value_free);
 
   glyph_cache->atlases = gsk_gl_texture_atlases_ref (atlases);
+  glyph_cache->pending_glyphs = g_array_new (FALSE, FALSE, sizeof (PendingGlyph));
+  glyph_cache->waiting_surfaces = g_ptr_array_new_with_free_func (g_object_unref);
 
   glyph_cache->ref_count = 1;
 
@@ -72,7 +117,15 @@ gsk_gl_glyph_cache_unref (GskGLGlyphCache *self)
 
   if (self->ref_count == 1)
     {
+      /* Jobs in flight hold a reference, so the pool is idle */
+      g_assert (self->n_running_jobs == 0);
+      if (self->rasterize_pool)
+        g_thread_pool_free (self->rasterize_pool, FALSE, TRUE);
+      g_list_free_full (self->finished_jobs, (GDestroyNotify) rasterize_job_free);
+      g_ptr_array_unref (self->waiting_surfaces);
+
       gsk_gl_texture_atlases_unref (self->atlases);
+      g_array_unref (self->pending_glyphs);
       g_hash_table_unref (self->hash_table);
       g_free (self);
       return;
@@ -110,19 +163,17 @@ glyph_cache_value_free (gpointer v)
   g_free (v);
 }
 
+/* Draws the glyph described by @key and @value with its top left
+ * corner at the origin of @cr, in device pixels.
+ */
 static gboolean
-render_glyph (GlyphCacheKey    *key,
-              GskGLCachedGlyph *value,
-              GskImageRegion   *region)
+draw_glyph (cairo_t          *cr,
+            GlyphCacheKey    *key,
+            GskGLCachedGlyph *value)
 {
-  cairo_surface_t *surface;
-  cairo_t *cr;
   cairo_scaled_font_t *scaled_font;
   PangoGlyphString glyph_string;
   PangoGlyphInfo glyph_info;
-  int surface_width, surface_height;
-  int stride;
-  unsigned char *data;
 
   scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *)key->data.font);
   if (G_UNLIKELY (!scaled_font || cairo_scaled_font_status (scaled_font) != CAIRO_STATUS_SUCCESS))
@@ -131,17 +182,13 @@ render_glyph (GlyphCacheKey    *key,
       return FALSE;
     }
 
-  surface_width = value->draw_width * key->data.scale / 1024;
-  surface_height = value->draw_height * key->data.scale / 1024;
+  cairo_save (cr);
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, surface_width);
-  data = g_malloc0 (stride * surface_height);
-  surface = cairo_image_surface_create_for_data (data, CAIRO_FORMAT_ARGB32,
-                                                 surface_width, surface_height,
-                                                 stride);
-  cairo_surface_set_device_scale (surface, key->data.scale / 1024.0, key->data.scale / 1024.0);
-
-  cr = cairo_create (surface);
+  cairo_rectangle (cr, 0, 0,
+                   value->draw_width * key->data.scale / 1024,
+                   value->draw_height * key->data.scale / 1024);
+  cairo_clip (cr);
+  cairo_scale (cr, key->data.scale / 1024.0, key->data.scale / 1024.0);
 
   cairo_set_scaled_font (cr, scaled_font);
   cairo_set_source_rgba (cr, 1, 1, 1, 1);
@@ -158,81 +205,437 @@ render_glyph (GlyphCacheKey    *key,
   glyph_string.glyphs = &glyph_info;
 
   pango_cairo_show_glyph_string (cr, key->data.font, &glyph_string);
-  cairo_destroy (cr);
 
-  cairo_surface_flush (surface);
-
-  region->width = cairo_image_surface_get_width (surface);
-  region->height = cairo_image_surface_get_height (surface);
-  region->stride = cairo_image_surface_get_stride (surface);
-  region->data = data;
-  if (value->atlas)
-    {
-      region->x = (gsize)(value->tx * value->atlas->width);
-      region->y = (gsize)(value->ty * value->atlas->height);
-    }
-  else
-    {
-      region->x = 0;
-      region->y = 0;
-    }
-
-  cairo_surface_destroy (surface);
+  cairo_restore (cr);
 
   return TRUE;
 }
 
+/* Glyphs that are too big for the atlases get their own texture.
+ * Those are rare enough that we upload them right away.
+ */
 static void
 upload_glyph (GlyphCacheKey    *key,
               GskGLCachedGlyph *value)
 {
-  GskImageRegion r;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  int width, height, stride;
   guchar *pixel_data;
   guchar *free_data = NULL;
   guint gl_format;
   guint gl_type;
+  gboolean drawn;
 
   gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
                                           "Uploading glyph %d",
                                           key->data.glyph);
 
-  if (render_glyph (key, value, &r))
+  width = value->draw_width * key->data.scale / 1024;
+  height = value->draw_height * key->data.scale / 1024;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  drawn = draw_glyph (cr, key, value);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  if (drawn)
     {
-      glPixelStorei (GL_UNPACK_ROW_LENGTH, r.stride / 4);
+      stride = cairo_image_surface_get_stride (surface);
+
+      glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / 4);
       glBindTexture (GL_TEXTURE_2D, value->texture_id);
 
       if (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
         {
-          pixel_data = free_data = g_malloc (r.width * r.height * 4);
-          gdk_memory_convert (pixel_data, r.width * 4,
+          pixel_data = free_data = g_malloc (stride * height);
+          gdk_memory_convert (pixel_data, stride,
                               GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
-                              r.data, r.width * 4,
-                              GDK_MEMORY_DEFAULT, r.width, r.height);
+                              cairo_image_surface_get_data (surface), stride,
+                              GDK_MEMORY_DEFAULT, width, height);
           gl_format = GL_RGBA;
           gl_type = GL_UNSIGNED_BYTE;
         }
       else
         {
-          pixel_data = r.data;
+          pixel_data = cairo_image_surface_get_data (surface);
           gl_format = GL_BGRA;
           gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
         }
 
-      glTexSubImage2D (GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height,
+      glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, width, height,
                        gl_format, gl_type, pixel_data);
       glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
-      g_free (r.data);
       g_free (free_data);
     }
 
+  cairo_surface_destroy (surface);
+
   gdk_gl_context_pop_debug_group (gdk_gl_context_get_current ());
 }
 
+static void
+get_atlas_rect (const GlyphCacheKey    *key,
+                const GskGLCachedGlyph *value,
+                cairo_rectangle_int_t  *rect)
+{
+  rect->x = (int)(value->tx * value->atlas->width);
+  rect->y = (int)(value->ty * value->atlas->height);
+  rect->width = value->draw_width * key->data.scale / 1024;
+  rect->height = value->draw_height * key->data.scale / 1024;
+}
+
+/* Rasterizes @n_glyphs glyphs, all living in @atlas, into a single
+ * staging surface covering their bounding box, and uploads that with
+ * one buffer transfer. The individual glyphs are then copied out of
+ * the pixel buffer, so that we don't clobber glyphs which happen to
+ * lie within the bounding box, but have been uploaded before.
+ */
+static void
+upload_atlas_glyphs (GskGLTextureAtlas  *atlas,
+                     const PendingGlyph *glyphs,
+                     guint               n_glyphs)
+{
+  cairo_rectangle_int_t extents, rect;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guchar *data;
+  guchar *free_data = NULL;
+  int stride, bpp;
+  guint gl_format;
+  guint gl_type;
+  guint pbo;
+  guint i;
+
+  get_atlas_rect (glyphs[0].key, glyphs[0].value, &extents);
+  for (i = 1; i < n_glyphs; i++)
+    {
+      get_atlas_rect (glyphs[i].key, glyphs[i].value, &rect);
+      gdk_rectangle_union (&extents, &rect, &extents);
+    }
+
+  surface = cairo_image_surface_create (atlas->format == GL_R8 ? CAIRO_FORMAT_A8
+                                                               : CAIRO_FORMAT_ARGB32,
+                                        extents.width, extents.height);
+  cr = cairo_create (surface);
+
+  for (i = 0; i < n_glyphs; i++)
+    {
+      get_atlas_rect (glyphs[i].key, glyphs[i].value, &rect);
+
+      cairo_save (cr);
+      cairo_translate (cr, rect.x - extents.x, rect.y - extents.y);
+      if (glyphs[i].surface)
+        {
+          cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+          cairo_set_source_surface (cr, glyphs[i].surface, 0, 0);
+          cairo_rectangle (cr, 0, 0, rect.width, rect.height);
+          cairo_fill (cr);
+        }
+      else
+        draw_glyph (cr, glyphs[i].key, glyphs[i].value);
+      cairo_restore (cr);
+    }
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  if (atlas->format == GL_R8)
+    {
+      bpp = 1;
+      gl_format = GL_RED;
+      gl_type = GL_UNSIGNED_BYTE;
+    }
+  else if (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
+    {
+      bpp = 4;
+      data = free_data = g_malloc (stride * extents.height);
+      gdk_memory_convert (data, stride,
+                          GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+                          cairo_image_surface_get_data (surface), stride,
+                          GDK_MEMORY_DEFAULT, extents.width, extents.height);
+      gl_format = GL_RGBA;
+      gl_type = GL_UNSIGNED_BYTE;
+    }
+  else
+    {
+      bpp = 4;
+      gl_format = GL_BGRA;
+      gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
+    }
+
+  glGenBuffers (1, &pbo);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, pbo);
+  glBufferData (GL_PIXEL_UNPACK_BUFFER, stride * extents.height, data, GL_STREAM_DRAW);
+
+  glBindTexture (GL_TEXTURE_2D, atlas->texture_id);
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / bpp);
+
+  for (i = 0; i < n_glyphs; i++)
+    {
+      gsize offset;
+
+      get_atlas_rect (glyphs[i].key, glyphs[i].value, &rect);
+      offset = (rect.y - extents.y) * stride + (rect.x - extents.x) * bpp;
+
+      glTexSubImage2D (GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height,
+                       gl_format, gl_type, GSIZE_TO_POINTER (offset));
+    }
+
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+  glDeleteBuffers (1, &pbo);
+
+  g_free (free_data);
+  cairo_surface_destroy (surface);
+}
+
+static int
+compare_pending_glyphs (gconstpointer a,
+                        gconstpointer b)
+{
+  const PendingGlyph *pa = a;
+  const PendingGlyph *pb = b;
+
+  if (pa->value->atlas < pb->value->atlas)
+    return -1;
+  else if (pa->value->atlas > pb->value->atlas)
+    return 1;
+
+  return 0;
+}
+
+/**
+ * gsk_gl_glyph_cache_upload_pending:
+ * @self: a #GskGLGlyphCache
+ *
+ * Rasterizes and uploads all glyphs that have been added to the
+ * atlases since the last call. This must be called before any
+ * draw call using the texture ids of those glyphs is executed.
+ */
+void
+gsk_gl_glyph_cache_upload_pending (GskGLGlyphCache *self)
+{
+  const PendingGlyph *glyphs;
+  guint start, i;
+
+  if (self->pending_glyphs->len == 0)
+    return;
+
+  gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
+                                          "Uploading %u glyphs",
+                                          self->pending_glyphs->len);
+
+  g_array_sort (self->pending_glyphs, compare_pending_glyphs);
+  glyphs = (const PendingGlyph *) self->pending_glyphs->data;
+
+  start = 0;
+  for (i = 1; i <= self->pending_glyphs->len; i++)
+    {
+      if (i == self->pending_glyphs->len ||
+          glyphs[i].value->atlas != glyphs[start].value->atlas)
+        {
+          upload_atlas_glyphs (glyphs[start].value->atlas, &glyphs[start], i - start);
+          start = i;
+        }
+    }
+
+  GSK_NOTE(GLYPH_CACHE, g_message ("Uploaded %u glyphs", self->pending_glyphs->len));
+
+  for (i = 0; i < self->pending_glyphs->len; i++)
+    g_clear_pointer (&g_array_index (self->pending_glyphs, PendingGlyph, i).surface,
+                     cairo_surface_destroy);
+  g_array_set_size (self->pending_glyphs, 0);
+
+  gdk_gl_context_pop_debug_group (gdk_gl_context_get_current ());
+}
+
+static void
+rasterize_job_free (RasterizeJob *job)
+{
+  g_object_unref (job->key.data.font);
+  cairo_scaled_font_destroy (job->scaled_font);
+  g_clear_pointer (&job->surface, cairo_surface_destroy);
+  g_free (job);
+}
+
+/* Runs in the main thread, once a worker is done with @data */
+static gboolean
+rasterize_job_done (gpointer data)
+{
+  RasterizeJob *job = data;
+  GskGLGlyphCache *self = job->cache;
+  guint i;
+
+  self->finished_jobs = g_list_prepend (self->finished_jobs, job);
+  self->n_running_jobs--;
+
+  for (i = 0; i < self->waiting_surfaces->len; i++)
+    gdk_surface_invalidate_rect (g_ptr_array_index (self->waiting_surfaces, i), NULL);
+  g_ptr_array_set_size (self->waiting_surfaces, 0);
+
+  gsk_gl_glyph_cache_unref (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs in a worker thread. Only uses cairo, which is
+ * thread-safe, and never touches the Pango font. */
+static void
+rasterize_job_run (gpointer data,
+                   gpointer user_data)
+{
+  RasterizeJob *job = data;
+  cairo_glyph_t glyph;
+  cairo_t *cr;
+
+  job->surface = cairo_image_surface_create (job->format, job->width, job->height);
+  cr = cairo_create (job->surface);
+
+  cairo_scale (cr, job->scale, job->scale);
+  cairo_set_scaled_font (cr, job->scaled_font);
+  cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+  glyph.index = job->key.data.glyph;
+  glyph.x = - job->draw_x;
+  glyph.y = - job->draw_y;
+  cairo_show_glyphs (cr, &glyph, 1);
+
+  cairo_destroy (cr);
+  cairo_surface_flush (job->surface);
+
+  g_idle_add_full (G_PRIORITY_DEFAULT, rasterize_job_done, job, NULL);
+}
+
+static gboolean
+queue_rasterize_job (GskGLGlyphCache  *self,
+                     GlyphCacheKey    *key,
+                     GskGLCachedGlyph *value)
+{
+  cairo_scaled_font_t *scaled_font;
+  RasterizeJob *job;
+
+  /* Pango draws boxes for unknown glyphs itself */
+  if (key->data.glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+    return FALSE;
+
+  scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *)key->data.font);
+  if (G_UNLIKELY (!scaled_font || cairo_scaled_font_status (scaled_font) != CAIRO_STATUS_SUCCESS))
+    return FALSE;
+
+  if (self->rasterize_pool == NULL)
+    self->rasterize_pool = g_thread_pool_new (rasterize_job_run, NULL,
+                                              CLAMP (g_get_num_processors () - 1, 1, MAX_RASTERIZE_THREADS),
+                                              FALSE, NULL);
+
+  job = g_new0 (RasterizeJob, 1);
+  job->cache = gsk_gl_glyph_cache_ref (self);
+  job->key = *key;
+  g_object_ref (job->key.data.font);
+  job->scaled_font = cairo_scaled_font_reference (scaled_font);
+  job->format = value->atlas->format == GL_R8 ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_ARGB32;
+  job->draw_x = value->draw_x;
+  job->draw_y = value->draw_y;
+  job->width = value->draw_width * key->data.scale / 1024;
+  job->height = value->draw_height * key->data.scale / 1024;
+  job->scale = key->data.scale / 1024.0;
+
+  self->n_running_jobs++;
+  g_thread_pool_push (self->rasterize_pool, job, NULL);
+
+  return TRUE;
+}
+
+/* Hands the glyphs rasterized by worker threads to the regular
+ * upload path. Glyphs whose cache entry has been dropped in the
+ * meantime are discarded.
+ */
+static void
+collect_finished_jobs (GskGLGlyphCache *self)
+{
+  GList *l;
+  guint collected = 0;
+
+  for (l = self->finished_jobs; l; l = l->next)
+    {
+      RasterizeJob *job = l->data;
+      GlyphCacheKey *key;
+      GskGLCachedGlyph *value;
+      PendingGlyph pending;
+
+      if (!g_hash_table_lookup_extended (self->hash_table, &job->key,
+                                         (gpointer *)&key, (gpointer *)&value))
+        continue;
+
+      if (!value->pending || value->atlas == NULL)
+        continue;
+
+      pending.key = key;
+      pending.value = value;
+      pending.surface = g_steal_pointer (&job->surface);
+      g_array_append_val (self->pending_glyphs, pending);
+
+      value->pending = FALSE;
+      collected++;
+    }
+
+  g_list_free_full (self->finished_jobs, (GDestroyNotify) rasterize_job_free);
+  self->finished_jobs = NULL;
+
+  GSK_NOTE(GLYPH_CACHE, if (collected > 0) g_message ("%u glyphs rasterized asynchronously", collected));
+}
+
+/**
+ * gsk_gl_glyph_cache_invalidate_when_ready:
+ * @self: a #GskGLGlyphCache
+ * @surface: a #GdkSurface
+ *
+ * Arranges for @surface to be invalidated once the next glyph
+ * that is being rasterized asynchronously is ready. Used by
+ * renderers that had to skip pending glyphs.
+ */
+void
+gsk_gl_glyph_cache_invalidate_when_ready (GskGLGlyphCache *self,
+                                          GdkSurface      *surface)
+{
+  if (self->n_running_jobs == 0)
+    {
+      gdk_surface_invalidate_rect (surface, NULL);
+      return;
+    }
+
+  if (!g_ptr_array_find (self->waiting_surfaces, surface, NULL))
+    g_ptr_array_add (self->waiting_surfaces, g_object_ref (surface));
+}
+
+/* Coverage masks need the texture to replicate its single
+ * channel into alpha, which we do with texture swizzling.
+ */
+static gboolean
+can_use_mask_atlases (GdkGLContext *context)
+{
+  int major, minor;
+
+  gdk_gl_context_get_version (context, &major, &minor);
+
+  if (gdk_gl_context_get_use_es (context))
+    return major >= 3;
+
+  return major > 3 || (major == 3 && minor >= 3) ||
+         epoxy_has_gl_extension ("GL_ARB_texture_swizzle");
+}
+
 static void
 add_to_cache (GskGLGlyphCache  *self,
               GlyphCacheKey    *key,
               GskGLDriver      *driver,
-              GskGLCachedGlyph *value)
+              GskGLCachedGlyph *value,
+              gboolean          color_glyph,
+              gboolean          async)
 {
   const int width = value->draw_width * key->data.scale / 1024;
   const int height = value->draw_height * key->data.scale / 1024;
@@ -240,10 +643,23 @@ add_to_cache (GskGLGlyphCache  *self,
   if (width < MAX_GLYPH_SIZE && height < MAX_GLYPH_SIZE)
     {
       GskGLTextureAtlas *atlas = NULL;
+      PendingGlyph pending;
+      GLenum format;
       int packed_x = 0;
       int packed_y = 0;
 
-      gsk_gl_texture_atlases_pack (self->atlases, width + 2, height + 2, &atlas, &packed_x, &packed_y);
+      if (!self->checked_mask_support)
+        {
+          self->use_mask_atlases = can_use_mask_atlases (gdk_gl_context_get_current ());
+          self->checked_mask_support = TRUE;
+        }
+
+      if (!color_glyph && self->use_mask_atlases)
+        format = GL_R8;
+      else
+        format = GL_RGBA8;
+
+      gsk_gl_texture_atlases_pack (self->atlases, format, width + 2, height + 2, &atlas, &packed_x, &packed_y);
 
       value->tx = (float)(packed_x + 1) / atlas->width;
       value->ty = (float)(packed_y + 1) / atlas->height;
@@ -253,6 +669,18 @@ add_to_cache (GskGLGlyphCache  *self,
 
       value->atlas = atlas;
       value->texture_id = atlas->texture_id;
+
+      if (async && queue_rasterize_job (self, key, value))
+        {
+          value->pending = TRUE;
+        }
+      else
+        {
+          pending.key = key;
+          pending.value = value;
+          pending.surface = NULL;
+          g_array_append_val (self->pending_glyphs, pending);
+        }
     }
   else
     {
@@ -267,22 +695,24 @@ add_to_cache (GskGLGlyphCache  *self,
       value->ty = 0.0f;
       value->tw = 1.0f;
       value->th = 1.0f;
-    }
 
-  upload_glyph (key, value);
+      upload_glyph (key, value);
+    }
 }
 
 void
 gsk_gl_glyph_cache_lookup_or_add (GskGLGlyphCache         *cache,
                                   GlyphCacheKey           *lookup,
                                   GskGLDriver             *driver,
+                                  gboolean                 color_glyph,
+                                  gboolean                 async,
                                   const GskGLCachedGlyph **cached_glyph_out)
 {
+  GlyphCacheKey *key;
   GskGLCachedGlyph *value;
 
-  value = g_hash_table_lookup (cache->hash_table, lookup);
-
-  if (value)
+  if (g_hash_table_lookup_extended (cache->hash_table, lookup,
+                                    (gpointer *)&key, (gpointer *)&value))
     {
       if (value->atlas && !value->used)
         {
@@ -291,12 +721,25 @@ gsk_gl_glyph_cache_lookup_or_add (GskGLGlyphCache         *cache,
         }
       value->accessed = TRUE;
 
+      /* Synchronous callers can't wait for the worker, so rasterize
+       * the glyph right away. The worker's result gets discarded. */
+      if (value->pending && !async)
+        {
+          PendingGlyph pending;
+
+          pending.key = key;
+          pending.value = value;
+          pending.surface = NULL;
+          g_array_append_val (cache->pending_glyphs, pending);
+
+          value->pending = FALSE;
+        }
+
       *cached_glyph_out = value;
       return;
     }
 
   {
-    GlyphCacheKey *key;
     PangoRectangle ink_rect;
 
     pango_font_get_glyph_extents (lookup->data.font, lookup->data.glyph, &ink_rect, NULL);
@@ -327,13 +770,43 @@ gsk_gl_glyph_cache_lookup_or_add (GskGLGlyphCache         *cache,
     if (key->data.scale > 0 &&
         value->draw_width * key->data.scale / 1024 > 0 &&
         value->draw_height * key->data.scale / 1024 > 0)
-      add_to_cache (cache, key, driver, value);
+      add_to_cache (cache, key, driver, value, color_glyph, async);
 
     *cached_glyph_out = value;
     g_hash_table_insert (cache->hash_table, key, value);
   }
 }
 
+/* Moves a glyph that is still in use out of an atlas that is being
+ * compacted. Glyphs that are still being rasterized move as well,
+ * they get uploaded to wherever they live once they are ready.
+ */
+static void
+relocate_glyph (GskGLGlyphCache  *self,
+                GlyphCacheKey    *key,
+                GskGLCachedGlyph *value)
+{
+  cairo_rectangle_int_t rect;
+  GskGLTextureAtlas *atlas;
+  int packed_x, packed_y;
+
+  get_atlas_rect (key, value, &rect);
+
+  /* Include the padding */
+  gsk_gl_texture_atlases_relocate (self->atlases, value->atlas,
+                                   rect.x - 1, rect.y - 1,
+                                   rect.width + 2, rect.height + 2,
+                                   &atlas, &packed_x, &packed_y);
+
+  value->tx = (float)(packed_x + 1) / atlas->width;
+  value->ty = (float)(packed_y + 1) / atlas->height;
+  value->tw = (float)rect.width / atlas->width;
+  value->th = (float)rect.height / atlas->height;
+
+  value->atlas = atlas;
+  value->texture_id = atlas->texture_id;
+}
+
 void
 gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self,
                                 GskGLDriver     *driver,
@@ -344,19 +817,35 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self,
   GskGLCachedGlyph *value;
   guint dropped = 0;
 
+  /* Don't let glyphs that never made it to the GPU
+   * outlive the atlases or cache entries they refer to */
+  gsk_gl_glyph_cache_upload_pending (self);
+
   self->timestamp++;
 
   if (removed_atlases->len > 0)
     {
+      guint relocated = 0;
+
       g_hash_table_iter_init (&iter, self->hash_table);
       while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
         {
           if (g_ptr_array_find (removed_atlases, value->atlas, NULL))
             {
-              g_hash_table_iter_remove (&iter);
-              dropped++;
+              if (value->used)
+                {
+                  relocate_glyph (self, key, value);
+                  relocated++;
+                }
+              else
+                {
+                  g_hash_table_iter_remove (&iter);
+                  dropped++;
+                }
             }
         }
+
+      GSK_NOTE(GLYPH_CACHE, if (relocated > 0) g_message ("Relocated %u glyphs", relocated));
     }
 
   if (self->timestamp % MAX_FRAME_AGE == 30)
@@ -393,5 +882,11 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self,
       GSK_NOTE(GLYPH_CACHE, g_message ("%d glyphs cached", g_hash_table_size (self->hash_table)));
     }
 
+  if (self->finished_jobs)
+    {
+      collect_finished_jobs (self);
+      gsk_gl_glyph_cache_upload_pending (self);
+    }
+
   GSK_NOTE(GLYPH_CACHE, if (dropped > 0) g_message ("Dropped %d glyphs", dropped));
 }
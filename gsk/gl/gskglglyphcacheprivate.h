@@ -15,7 +15,19 @@ typedef struct
   GHashTable *hash_table;
   GskGLTextureAtlases *atlases;
 
+  /* Glyphs added to an atlas, but not uploaded yet */
+  GArray *pending_glyphs;
+
+  /* Asynchronous rasterization, see gsk_gl_glyph_cache_lookup_or_add() */
+  GThreadPool *rasterize_pool;
+  GList *finished_jobs;
+  guint n_running_jobs;
+  GPtrArray *waiting_surfaces;
+
   int timestamp;
+
+  guint checked_mask_support : 1;
+  guint use_mask_atlases     : 1;
 } GskGLGlyphCache;
 
 struct _CacheKeyData
@@ -74,6 +86,7 @@ struct _GskGLCachedGlyph
 
   guint accessed : 1; /* accessed since last check */
   guint used     : 1; /* accounted as used in the atlas */
+  guint pending  : 1; /* still being rasterized, don't draw */
 };
 
 
@@ -87,6 +100,12 @@ void                     gsk_gl_glyph_cache_begin_frame     (GskGLGlyphCache
 void                     gsk_gl_glyph_cache_lookup_or_add   (GskGLGlyphCache        *self,
                                                              GlyphCacheKey          *lookup,
                                                              GskGLDriver            *driver,
+                                                             gboolean                color_glyph,
+                                                             gboolean                async,
                                                              const GskGLCachedGlyph **cached_glyph_out);
+void                     gsk_gl_glyph_cache_upload_pending  (GskGLGlyphCache        *self);
+void                     gsk_gl_glyph_cache_invalidate_when_ready
+                                                            (GskGLGlyphCache        *self,
+                                                             GdkSurface             *surface);
 
 #endif
@@ -55,6 +55,29 @@ gsk_gl_icon_cache_unref (GskGLIconCache *self)
   self->ref_count--;
 }
 
+static void
+relocate_icon (GskGLIconCache *self,
+               IconData       *icon_data)
+{
+  const int width = icon_data->source_texture->width;
+  const int height = icon_data->source_texture->height;
+  GskGLTextureAtlas *atlas;
+  int packed_x, packed_y;
+
+  gsk_gl_texture_atlases_relocate (self->atlases, icon_data->atlas,
+                                   (int)(icon_data->x * icon_data->atlas->width) - 1,
+                                   (int)(icon_data->y * icon_data->atlas->height) - 1,
+                                   width + 2, height + 2,
+                                   &atlas, &packed_x, &packed_y);
+
+  icon_data->atlas = atlas;
+  icon_data->texture_id = atlas->texture_id;
+  icon_data->x = (float)(packed_x + 1) / atlas->width;
+  icon_data->y = (float)(packed_y + 1) / atlas->height;
+  icon_data->x2 = icon_data->x + (float)width / atlas->width;
+  icon_data->y2 = icon_data->y + (float)height / atlas->height;
+}
+
 void
 gsk_gl_icon_cache_begin_frame (GskGLIconCache *self,
                                GPtrArray      *removed_atlases)
@@ -65,22 +88,32 @@ gsk_gl_icon_cache_begin_frame (GskGLIconCache *self,
 
   self->timestamp++;
 
-  /* Drop icons on removed atlases */
+  /* Move icons that are still in use off removed atlases, drop the rest */
   if (removed_atlases->len > 0)
     {
       guint dropped = 0;
+      guint relocated = 0;
 
       g_hash_table_iter_init (&iter, self->icons);
       while (g_hash_table_iter_next (&iter, (gpointer *)&texture, (gpointer *)&icon_data))
         {
           if (g_ptr_array_find (removed_atlases, icon_data->atlas, NULL))
             {
-              g_hash_table_iter_remove (&iter);
-              dropped++;
+              if (icon_data->used)
+                {
+                  relocate_icon (self, icon_data);
+                  relocated++;
+                }
+              else
+                {
+                  g_hash_table_iter_remove (&iter);
+                  dropped++;
+                }
             }
         }
 
       GSK_NOTE(GLYPH_CACHE, if (dropped > 0) g_message ("Dropped %d icons", dropped));
+      GSK_NOTE(GLYPH_CACHE, if (relocated > 0) g_message ("Relocated %d icons", relocated));
     }
 
   if (self->timestamp % MAX_FRAME_AGE == 0)
@@ -106,6 +139,32 @@ gsk_gl_icon_cache_begin_frame (GskGLIconCache *self,
     }
 }
 
+/* Symbolic icons that only use the foreground color are black,
+ * so they can be drawn like glyphs
+ */
+static gboolean
+surface_is_mask (cairo_surface_t *surface)
+{
+  const guchar *data = cairo_image_surface_get_data (surface);
+  int width = cairo_image_surface_get_width (surface);
+  int height = cairo_image_surface_get_height (surface);
+  int stride = cairo_image_surface_get_stride (surface);
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      const guint32 *row = (const guint32 *) (data + y * stride);
+
+      for (x = 0; x < width; x++)
+        {
+          if (row[x] & 0x00ffffff)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 void
 gsk_gl_icon_cache_lookup_or_add (GskGLIconCache  *self,
                                  GdkTexture      *texture,
@@ -140,7 +199,7 @@ gsk_gl_icon_cache_lookup_or_add (GskGLIconCache  *self,
     guint gl_format;
     guint gl_type;
 
-    gsk_gl_texture_atlases_pack (self->atlases, width + 2, height + 2, &atlas, &packed_x, &packed_y);
+    gsk_gl_texture_atlases_pack (self->atlases, GL_RGBA8, width + 2, height + 2, &atlas, &packed_x, &packed_y);
 
     icon_data = g_new0 (IconData, 1);
     icon_data->atlas = atlas;
@@ -158,6 +217,7 @@ gsk_gl_icon_cache_lookup_or_add (GskGLIconCache  *self,
     /* actually upload the texture */
     surface = gdk_texture_download_surface (texture);
     surface_data = cairo_image_surface_get_data (surface);
+    icon_data->is_mask = surface_is_mask (surface);
     gdk_gl_context_push_debug_group_printf (gdk_gl_context_get_current (),
                                             "Uploading texture");
 
@@ -27,6 +27,7 @@ typedef struct
   GskGLTextureAtlas *atlas;
   guint used     : 1;
   guint accessed : 1;
+  guint is_mask  : 1; /* all pixels are black, only alpha varies */
   int texture_id;
   GdkTexture *source_texture;
 } IconData;
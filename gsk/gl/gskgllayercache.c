@@ -0,0 +1,311 @@
+#include "config.h"
+
+#include "gskgllayercacheprivate.h"
+#include "gskdebugprivate.h"
+#include "gskrendernodeprivate.h"
+
+/* Layer cache
+ *
+ * Widgets that don't change keep handing out the same render
+ * node, so node identity is what tells us that a subtree has
+ * not changed since the last frame (and it is what the render
+ * node diffing short-circuits on, too).
+ *
+ * Subtrees that are big and made of many nodes are tracked as
+ * candidates first. Once a candidate has been seen in enough
+ * consecutive frames, the renderer draws it into an offscreen
+ * texture, which is reused for as long as the node is.
+ *
+ * Layers that have not been used for a while are dropped, and
+ * the least recently used ones are dropped whenever the cached
+ * textures exceed the memory budget.
+ */
+
+#define MAX_UNUSED_FRAMES 10
+#define MIN_CANDIDATE_FRAMES 2
+#define MIN_LAYER_AREA (256 * 256)
+#define MIN_LAYER_NODES 32
+#define DEFAULT_MEMORY_BUDGET (64 * 1024 * 1024)
+
+typedef struct
+{
+  GskRenderNode *node; /* owned, so the pointer can't be reused */
+  float scale_x;
+  float scale_y;
+  int width;
+  int height;
+  int texture_id;
+  guint64 last_used;
+} Layer;
+
+typedef struct
+{
+  guint64 last_seen;
+  guint n_frames;
+  guint expensive : 1;
+} Candidate;
+
+static gsize
+layer_size (const Layer *layer)
+{
+  return (gsize) layer->width * layer->height * 4;
+}
+
+static void
+drop_layer (GskGLLayerCache *self,
+            GskGLDriver     *gl_driver,
+            Layer           *layer)
+{
+  self->memory_used -= layer_size (layer);
+  gsk_gl_driver_destroy_texture (gl_driver, layer->texture_id);
+  g_hash_table_remove (self->layers, layer->node);
+}
+
+/* Evicts the least recently used layers until we fit the budget
+ * again. Layers used in the current frame are still referenced by
+ * pending draws, so they stay, even if that means going over budget
+ * until the next frame.
+ */
+static void
+trim_to_budget (GskGLLayerCache *self,
+                GskGLDriver     *gl_driver)
+{
+  while (self->memory_used > self->memory_budget)
+    {
+      GHashTableIter iter;
+      Layer *layer, *oldest = NULL;
+
+      g_hash_table_iter_init (&iter, self->layers);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&layer))
+        {
+          if (layer->last_used < self->timestamp &&
+              (oldest == NULL || layer->last_used < oldest->last_used))
+            oldest = layer;
+        }
+
+      if (oldest == NULL)
+        break;
+
+      drop_layer (self, gl_driver, oldest);
+    }
+}
+
+static void
+layer_free (gpointer data)
+{
+  Layer *layer = data;
+
+  gsk_render_node_unref (layer->node);
+  g_free (layer);
+}
+
+/* Counts the nodes in the subtree of @node, stopping at @limit */
+static guint
+count_nodes (GskRenderNode *node,
+             guint          limit)
+{
+  guint n = 1;
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      for (i = 0; i < gsk_container_node_get_n_children (node) && n < limit; i++)
+        n += count_nodes (gsk_container_node_get_child (node, i), limit - n);
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      n += count_nodes (gsk_transform_node_get_child (node), limit - n);
+      break;
+
+    case GSK_OPACITY_NODE:
+      n += count_nodes (gsk_opacity_node_get_child (node), limit - n);
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      n += count_nodes (gsk_color_matrix_node_get_child (node), limit - n);
+      break;
+
+    case GSK_CLIP_NODE:
+      n += count_nodes (gsk_clip_node_get_child (node), limit - n);
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      n += count_nodes (gsk_rounded_clip_node_get_child (node), limit - n);
+      break;
+
+    case GSK_SHADOW_NODE:
+      n += count_nodes (gsk_shadow_node_get_child (node), limit - n);
+      break;
+
+    case GSK_DEBUG_NODE:
+      n += count_nodes (gsk_debug_node_get_child (node), limit - n);
+      break;
+
+    default:
+      break;
+    }
+
+  return n;
+}
+
+void
+gsk_gl_layer_cache_init (GskGLLayerCache *self)
+{
+  self->layers = g_hash_table_new_full (NULL, NULL, NULL, layer_free);
+  self->candidates = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  self->memory_used = 0;
+  self->memory_budget = DEFAULT_MEMORY_BUDGET;
+  self->timestamp = 0;
+}
+
+void
+gsk_gl_layer_cache_free (GskGLLayerCache *self,
+                         GskGLDriver     *gl_driver)
+{
+  GHashTableIter iter;
+  Layer *layer;
+
+  g_hash_table_iter_init (&iter, self->layers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&layer))
+    gsk_gl_driver_destroy_texture (gl_driver, layer->texture_id);
+
+  g_clear_pointer (&self->layers, g_hash_table_unref);
+  g_clear_pointer (&self->candidates, g_hash_table_unref);
+  self->memory_used = 0;
+}
+
+void
+gsk_gl_layer_cache_begin_frame (GskGLLayerCache *self,
+                                GskGLDriver     *gl_driver)
+{
+  GHashTableIter iter;
+  Layer *layer;
+  Candidate *candidate;
+  guint dropped = 0;
+
+  self->timestamp++;
+
+  g_hash_table_iter_init (&iter, self->layers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&layer))
+    {
+      if (self->timestamp - layer->last_used > MAX_UNUSED_FRAMES)
+        {
+          self->memory_used -= layer_size (layer);
+          gsk_gl_driver_destroy_texture (gl_driver, layer->texture_id);
+          g_hash_table_iter_remove (&iter);
+          dropped++;
+        }
+    }
+
+  trim_to_budget (self, gl_driver);
+
+  /* Candidates need to show up in consecutive frames */
+  g_hash_table_iter_init (&iter, self->candidates);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&candidate))
+    {
+      if (self->timestamp - candidate->last_seen > 1)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  GSK_NOTE (OPENGL, if (dropped > 0) g_message ("Dropped %u layers, %u left (%" G_GSIZE_FORMAT " bytes)",
+                                                dropped, g_hash_table_size (self->layers),
+                                                self->memory_used));
+}
+
+int
+gsk_gl_layer_cache_get_texture_id (GskGLLayerCache *self,
+                                   GskRenderNode   *node,
+                                   float            scale_x,
+                                   float            scale_y)
+{
+  Layer *layer;
+
+  layer = g_hash_table_lookup (self->layers, node);
+  if (layer == NULL ||
+      layer->scale_x != scale_x ||
+      layer->scale_y != scale_y)
+    return 0;
+
+  layer->last_used = self->timestamp;
+
+  return layer->texture_id;
+}
+
+/* Records that @node has been drawn in this frame, and returns
+ * whether it has been around for long enough, and is expensive
+ * enough, to be worth drawing into a layer.
+ */
+gboolean
+gsk_gl_layer_cache_should_cache (GskGLLayerCache *self,
+                                 GskRenderNode   *node,
+                                 int              width,
+                                 int              height)
+{
+  Candidate *candidate;
+
+  if ((gsize) width * height < MIN_LAYER_AREA ||
+      (gsize) width * height * 4 > self->memory_budget)
+    return FALSE;
+
+  candidate = g_hash_table_lookup (self->candidates, node);
+  if (candidate == NULL)
+    {
+      candidate = g_new0 (Candidate, 1);
+      candidate->expensive = count_nodes (node, MIN_LAYER_NODES) >= MIN_LAYER_NODES;
+      candidate->last_seen = self->timestamp;
+      g_hash_table_insert (self->candidates, node, candidate);
+    }
+
+  if (candidate->last_seen != self->timestamp)
+    {
+      candidate->last_seen = self->timestamp;
+      candidate->n_frames++;
+    }
+
+  return candidate->expensive && candidate->n_frames + 1 >= MIN_CANDIDATE_FRAMES;
+}
+
+void
+gsk_gl_layer_cache_commit (GskGLLayerCache *self,
+                           GskGLDriver     *gl_driver,
+                           GskRenderNode   *node,
+                           float            scale_x,
+                           float            scale_y,
+                           int              width,
+                           int              height,
+                           int              texture_id)
+{
+  Layer *layer;
+
+  g_assert (texture_id > 0);
+
+  /* Replaces a layer with a different scale, unless the old one
+   * is in use in this frame. The new texture then just stays a
+   * regular offscreen that the driver collects. */
+  layer = g_hash_table_lookup (self->layers, node);
+  if (layer != NULL)
+    {
+      if (layer->last_used == self->timestamp)
+        return;
+
+      drop_layer (self, gl_driver, layer);
+    }
+
+  g_hash_table_remove (self->candidates, node);
+
+  layer = g_new0 (Layer, 1);
+  layer->node = gsk_render_node_ref (node);
+  layer->scale_x = scale_x;
+  layer->scale_y = scale_y;
+  layer->width = width;
+  layer->height = height;
+  layer->texture_id = texture_id;
+  layer->last_used = self->timestamp;
+
+  gsk_gl_driver_mark_texture_permanent (gl_driver, texture_id);
+  g_hash_table_insert (self->layers, node, layer);
+  self->memory_used += layer_size (layer);
+
+  trim_to_budget (self, gl_driver);
+}
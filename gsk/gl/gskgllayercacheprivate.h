@@ -0,0 +1,43 @@
+#ifndef __GSK_GL_LAYER_CACHE_H__
+#define __GSK_GL_LAYER_CACHE_H__
+
+#include <glib.h>
+#include "gskgldriverprivate.h"
+#include "gskrendernode.h"
+
+typedef struct
+{
+  GHashTable *layers;     /* GskRenderNode -> Layer */
+  GHashTable *candidates; /* GskRenderNode -> Candidate */
+
+  gsize memory_used;
+  gsize memory_budget;
+
+  guint64 timestamp;
+} GskGLLayerCache;
+
+
+void gsk_gl_layer_cache_init           (GskGLLayerCache      *self);
+void gsk_gl_layer_cache_free           (GskGLLayerCache      *self,
+                                        GskGLDriver          *gl_driver);
+void gsk_gl_layer_cache_begin_frame    (GskGLLayerCache      *self,
+                                        GskGLDriver          *gl_driver);
+int  gsk_gl_layer_cache_get_texture_id (GskGLLayerCache      *self,
+                                        GskRenderNode        *node,
+                                        float                 scale_x,
+                                        float                 scale_y);
+gboolean gsk_gl_layer_cache_should_cache (GskGLLayerCache    *self,
+                                          GskRenderNode      *node,
+                                          int                 width,
+                                          int                 height);
+void gsk_gl_layer_cache_commit         (GskGLLayerCache      *self,
+                                        GskGLDriver          *gl_driver,
+                                        GskRenderNode        *node,
+                                        float                 scale_x,
+                                        float                 scale_y,
+                                        int                   width,
+                                        int                   height,
+                                        int                   texture_id);
+
+
+#endif
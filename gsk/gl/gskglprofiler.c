@@ -3,9 +3,21 @@
 #include "gskglprofilerprivate.h"
 
 #include <epoxy/gl.h>
+#include <string.h>
 
 #define N_QUERIES       4
 
+/* Timed regions are read back this many frames after they were
+ * recorded, when the GPU is done with them */
+#define N_REGION_FRAMES 4
+
+typedef struct
+{
+  GLuint start_query;
+  GLuint end_query;
+  int kind;
+} GpuRegion;
+
 struct _GskGLProfiler
 {
   GObject parent_instance;
@@ -18,6 +30,14 @@ struct _GskGLProfiler
   GLuint gl_queries[N_QUERIES];
   GLuint active_query;
 
+  /* Timed regions of the last frames, and the regions that are
+   * currently open in this frame, as indexes into it. Region
+   * queries are recycled via free_queries. */
+  GArray *region_frames[N_REGION_FRAMES];
+  guint region_frame;
+  GArray *open_regions;
+  GArray *free_queries;
+
   gboolean has_queries : 1;
   gboolean has_timer : 1;
   gboolean first_frame : 1;
@@ -37,10 +57,34 @@ static void
 gsk_gl_profiler_finalize (GObject *gobject)
 {
   GskGLProfiler *self = GSK_GL_PROFILER (gobject);
+  guint i, j;
 
   if (self->has_queries)
     glDeleteQueries (N_QUERIES, self->gl_queries);
 
+  for (i = 0; i < N_REGION_FRAMES; i++)
+    {
+      GArray *regions = self->region_frames[i];
+
+      for (j = 0; j < regions->len; j++)
+        {
+          const GpuRegion *region = &g_array_index (regions, GpuRegion, j);
+
+          if (region->start_query)
+            glDeleteQueries (1, &region->start_query);
+          if (region->end_query)
+            glDeleteQueries (1, &region->end_query);
+        }
+
+      g_array_unref (regions);
+    }
+
+  if (self->free_queries->len > 0)
+    glDeleteQueries (self->free_queries->len, (GLuint *) self->free_queries->data);
+
+  g_array_unref (self->free_queries);
+  g_array_unref (self->open_regions);
+
   g_clear_object (&self->gl_context);
 
   G_OBJECT_CLASS (gsk_gl_profiler_parent_class)->finalize (gobject);
@@ -108,6 +152,13 @@ gsk_gl_profiler_class_init (GskGLProfilerClass *klass)
 static void
 gsk_gl_profiler_init (GskGLProfiler *self)
 {
+  guint i;
+
+  for (i = 0; i < N_REGION_FRAMES; i++)
+    self->region_frames[i] = g_array_new (FALSE, FALSE, sizeof (GpuRegion));
+  self->open_regions = g_array_new (FALSE, FALSE, sizeof (int));
+  self->free_queries = g_array_new (FALSE, FALSE, sizeof (GLuint));
+
   self->has_queries = epoxy_is_desktop_gl();
   self->has_timer = epoxy_is_desktop_gl() && (epoxy_gl_version () >= 33 || epoxy_has_gl_extension ("GL_ARB_timer_query"));
 
@@ -179,3 +230,128 @@ gsk_gl_profiler_end_gpu_region (GskGLProfiler *profiler)
 
   return elapsed / 1000; /* Convert to usec to match other profiler APIs */
 }
+
+static GLuint
+gsk_gl_profiler_get_query (GskGLProfiler *profiler)
+{
+  GLuint query;
+
+  if (profiler->free_queries->len > 0)
+    {
+      query = g_array_index (profiler->free_queries, GLuint, profiler->free_queries->len - 1);
+      g_array_set_size (profiler->free_queries, profiler->free_queries->len - 1);
+    }
+  else
+    {
+      glGenQueries (1, &query);
+    }
+
+  glQueryCounter (query, GL_TIMESTAMP);
+
+  return query;
+}
+
+/*< private >
+ * gsk_gl_profiler_begin_region:
+ * @profiler: a #GskGLProfiler
+ * @kind: the kind of the region, or -1 to not time it
+ *
+ * Begins a region of the current frame whose GPU time should be
+ * measured with timestamp queries. Regions can be nested, and
+ * every call must be paired with gsk_gl_profiler_end_region().
+ */
+void
+gsk_gl_profiler_begin_region (GskGLProfiler *profiler,
+                              int            kind)
+{
+  GArray *regions;
+  int index = -1;
+
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+
+  if (kind >= 0 && profiler->has_timer && profiler->has_queries)
+    {
+      GpuRegion region;
+
+      regions = profiler->region_frames[profiler->region_frame];
+      region.start_query = gsk_gl_profiler_get_query (profiler);
+      region.end_query = 0;
+      region.kind = kind;
+
+      index = regions->len;
+      g_array_append_val (regions, region);
+    }
+
+  g_array_append_val (profiler->open_regions, index);
+}
+
+void
+gsk_gl_profiler_end_region (GskGLProfiler *profiler)
+{
+  GArray *regions;
+  int index;
+
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+  g_return_if_fail (profiler->open_regions->len > 0);
+
+  index = g_array_index (profiler->open_regions, int, profiler->open_regions->len - 1);
+  g_array_set_size (profiler->open_regions, profiler->open_regions->len - 1);
+
+  if (index < 0)
+    return;
+
+  regions = profiler->region_frames[profiler->region_frame];
+  g_array_index (regions, GpuRegion, index).end_query = gsk_gl_profiler_get_query (profiler);
+}
+
+/*< private >
+ * gsk_gl_profiler_collect_regions:
+ * @profiler: a #GskGLProfiler
+ * @times: (out caller-allocates): return location for @n_kinds times
+ * @n_kinds: the number of region kinds
+ *
+ * Ends the regions of the current frame and reads back the regions
+ * of the oldest frame, which the GPU is done with by now. The GPU
+ * times of all regions of each kind are summed up in @times, in
+ * microseconds.
+ *
+ * Returns: %TRUE if @times was filled in
+ */
+gboolean
+gsk_gl_profiler_collect_regions (GskGLProfiler *profiler,
+                                 guint64       *times,
+                                 guint          n_kinds)
+{
+  GArray *regions;
+  guint i;
+
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), FALSE);
+  g_warn_if_fail (profiler->open_regions->len == 0);
+
+  profiler->region_frame = (profiler->region_frame + 1) % N_REGION_FRAMES;
+  regions = profiler->region_frames[profiler->region_frame];
+
+  if (regions->len == 0)
+    return FALSE;
+
+  memset (times, 0, sizeof (guint64) * n_kinds);
+
+  for (i = 0; i < regions->len; i++)
+    {
+      const GpuRegion *region = &g_array_index (regions, GpuRegion, i);
+      GLuint64 start, end;
+
+      glGetQueryObjectui64v (region->start_query, GL_QUERY_RESULT, &start);
+      glGetQueryObjectui64v (region->end_query, GL_QUERY_RESULT, &end);
+
+      if ((guint) region->kind < n_kinds && end > start)
+        times[region->kind] += (end - start) / 1000;
+
+      g_array_append_val (profiler->free_queries, region->start_query);
+      g_array_append_val (profiler->free_queries, region->end_query);
+    }
+
+  g_array_set_size (regions, 0);
+
+  return TRUE;
+}
@@ -13,6 +13,13 @@ GskGLProfiler * gsk_gl_profiler_new                     (GdkGLContext  *context)
 void            gsk_gl_profiler_begin_gpu_region        (GskGLProfiler *profiler);
 guint64         gsk_gl_profiler_end_gpu_region          (GskGLProfiler *profiler);
 
+void            gsk_gl_profiler_begin_region            (GskGLProfiler *profiler,
+                                                         int            kind);
+void            gsk_gl_profiler_end_region              (GskGLProfiler *profiler);
+gboolean        gsk_gl_profiler_collect_regions         (GskGLProfiler *profiler,
+                                                         guint64       *times,
+                                                         guint          n_kinds);
+
 G_END_DECLS
 
 #endif /* __GSK_GL_PROFILER_PRIVATE_H__ */
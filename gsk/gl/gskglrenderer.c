@@ -16,6 +16,8 @@
 #include "gskglrenderopsprivate.h"
 #include "gskcairoblurprivate.h"
 #include "gskglshadowcacheprivate.h"
+#include "gskgllayercacheprivate.h"
+#include "gskglshaderchildcacheprivate.h"
 #include "gskglnodesampleprivate.h"
 #include "gsktransform.h"
 #include "glutilsprivate.h"
@@ -42,6 +44,11 @@
 
 #define SHADOW_EXTRA_SIZE  4
 
+/* Blurs with a larger radius than this (in device pixels) are done
+ * at reduced resolution, halving the size once per level */
+#define MAX_DIRECT_BLUR_RADIUS  8
+#define MAX_BLUR_LEVELS         4
+
 #if DEBUG_OPS
 #define OP_PRINT(format, ...) g_print(format, ## __VA_ARGS__)
 #else
@@ -61,6 +68,19 @@
                   } \
               }G_STMT_END
 
+#define INIT_PROGRAM_UNIFORM_BLOCK(program_name, block_name, binding) \
+              G_STMT_START{\
+                GLuint block_index = glGetUniformBlockIndex (programs->program_name ## _program.id, #block_name); \
+                if (block_index == GL_INVALID_INDEX) \
+                  { \
+                    g_set_error (error, GDK_GL_ERROR, GDK_GL_ERROR_LINK_FAILED, \
+                                 "Failed to find uniform block \"%s\" in shader program \"%s\"", #block_name, #program_name); \
+                    g_clear_pointer (&programs, gsk_gl_renderer_programs_unref); \
+                    goto out; \
+                  } \
+                glUniformBlockBinding (programs->program_name ## _program.id, block_index, binding); \
+              }G_STMT_END
+
 #define INIT_COMMON_UNIFORM_LOCATION(program_ptr, uniform_basename) \
               G_STMT_START{\
                 program_ptr->uniform_basename ## _location =  \
@@ -524,6 +544,15 @@ static void gsk_gl_renderer_add_render_ops     (GskGLRenderer   *self,
                                                 GskRenderNode   *node,
                                                 RenderOpBuilder *builder);
 
+/* The kinds of work whose GPU time is measured separately */
+enum {
+  GPU_REGION_OFFSCREEN,
+  GPU_REGION_BLUR,
+  GPU_REGION_SHADOW,
+  GPU_REGION_FALLBACK,
+  N_GPU_REGIONS
+};
+
 struct _GskGLRenderer
 {
   GskRenderer parent_instance;
@@ -537,23 +566,47 @@ struct _GskGLRenderer
   GskGLRendererPrograms *programs;
 
   RenderOpBuilder op_builder;
+  GskGLVertexRing vertex_ring;
+  GLuint uniform_buffer_id;
 
   GskGLTextureAtlases *atlases;
   GskGLGlyphCache *glyph_cache;
   GskGLIconCache *icon_cache;
   GskGLShadowCache shadow_cache;
+  GskGLLayerCache layer_cache;
+  GskGLShaderChildCache shader_child_cache;
 
 #ifdef G_ENABLE_DEBUG
   struct {
     GQuark frames;
+    GQuark draws;
+    GQuark merged_draws;
+    GQuark atlases;
+    GQuark atlas_occupancy;
+    GQuark relocated_atlas_entries;
+    GQuark culled_nodes;
+    GQuark texture_uploads;
   } profile_counters;
   struct {
+    GQuark build_time;
     GQuark cpu_time;
     GQuark gpu_time;
+    GQuark gpu_regions[N_GPU_REGIONS];
   } profile_timers;
 #endif
 
   cairo_region_t *render_region;
+
+  gboolean async_glyphs;     /* the property */
+  gboolean defer_glyphs;     /* async_glyphs, for the current frame */
+  gboolean missing_glyphs;   /* skipped pending glyphs this frame */
+
+  gboolean layers_enabled;   /* GSK_NO_LAYER_CACHE is not set */
+  gboolean use_layers;       /* layers_enabled, for the current frame */
+  int layer_depth;           /* > 0 while drawing into a layer */
+
+  gboolean cull_occluded;    /* GSK_NO_OCCLUSION_CULLING is not set */
+  guint n_culled_nodes;      /* occluded nodes skipped this frame */
 };
 
 struct _GskGLRendererClass
@@ -561,6 +614,15 @@ struct _GskGLRendererClass
   GskRendererClass parent_class;
 };
 
+enum {
+  PROP_0,
+  PROP_ASYNC_GLYPHS,
+
+  N_PROPS
+};
+
+static GParamSpec *gsk_gl_renderer_properties[N_PROPS];
+
 G_DEFINE_TYPE (GskGLRenderer, gsk_gl_renderer, GSK_TYPE_RENDERER)
 
 static void
@@ -652,7 +714,6 @@ render_fallback_node (GskGLRenderer   *self,
   const int surface_height = ceilf (node->bounds.size.height * scale_y);
   GdkTexture *texture;
   cairo_surface_t *surface;
-  cairo_surface_t *rendered_surface;
   cairo_t *cr;
   int cached_id;
   int texture_id;
@@ -674,42 +735,22 @@ render_fallback_node (GskGLRenderer   *self,
     {
       ops_set_program (builder, &self->programs->blit_program);
       ops_set_texture (builder, cached_id);
-      load_offscreen_vertex_data (ops_draw (builder, NULL), node, builder);
+      load_vertex_data (ops_draw (builder, NULL), &node->bounds, builder);
       return;
     }
 
-
-  /* We first draw the recording surface on an image surface,
-   * just because the scaleY(-1) later otherwise screws up the
-   * rendering... */
-  {
-    rendered_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-                                                   surface_width,
-                                                   surface_height);
-
-    cairo_surface_set_device_scale (rendered_surface, scale_x, scale_y);
-    cr = cairo_create (rendered_surface);
-
-    cairo_save (cr);
-    cairo_translate (cr, - floorf (node->bounds.origin.x), - floorf (node->bounds.origin.y));
-    gsk_render_node_draw (node, cr);
-    cairo_restore (cr);
-    cairo_destroy (cr);
-  }
-
+  /* The surface is uploaded the right way up, like the textures
+   * of texture nodes, so we can draw into it directly and it is
+   * not flipped when drawn. */
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                         surface_width,
                                         surface_height);
   cairo_surface_set_device_scale (surface, scale_x, scale_y);
   cr = cairo_create (surface);
 
-  /* We draw upside down here, so it matches what GL does. */
   cairo_save (cr);
-  cairo_scale (cr, 1, -1);
-  cairo_translate (cr, 0, - surface_height / scale_y);
-  cairo_set_source_surface (cr, rendered_surface, 0, 0);
-  cairo_rectangle (cr, 0, 0, surface_width / scale_x, surface_height / scale_y);
-  cairo_fill (cr);
+  cairo_translate (cr, - floorf (node->bounds.origin.x), - floorf (node->bounds.origin.y));
+  gsk_render_node_draw (node, cr);
   cairo_restore (cr);
 
 #ifdef G_ENABLE_DEBUG
@@ -752,13 +793,12 @@ render_fallback_node (GskGLRenderer   *self,
 
   g_object_unref (texture);
   cairo_surface_destroy (surface);
-  cairo_surface_destroy (rendered_surface);
 
   gsk_gl_driver_set_texture_for_key (self->gl_driver, &key, texture_id);
 
   ops_set_program (builder, &self->programs->blit_program);
   ops_set_texture (builder, texture_id);
-  load_offscreen_vertex_data (ops_draw (builder, NULL), node, builder);
+  load_vertex_data (ops_draw (builder, NULL), &node->bounds, builder);
 }
 
 static inline void
@@ -775,12 +815,13 @@ render_text_node (GskGLRenderer   *self,
   const guint num_glyphs = gsk_text_node_get_num_glyphs (node);
   const float x = offset->x + builder->dx;
   const float y = offset->y + builder->dy;
+  const gboolean has_color_glyphs = gsk_text_node_has_color_glyphs (node);
   int i;
   int x_position = 0;
   GlyphCacheKey lookup;
 
   /* If the font has color glyphs, we don't need to recolor anything */
-  if (!force_color && gsk_text_node_has_color_glyphs (node))
+  if (!force_color && has_color_glyphs)
     {
       ops_set_program (builder, &self->programs->blit_program);
     }
@@ -815,11 +856,19 @@ render_text_node (GskGLRenderer   *self,
       gsk_gl_glyph_cache_lookup_or_add (self->glyph_cache,
                                         &lookup,
                                         self->gl_driver,
+                                        has_color_glyphs,
+                                        self->defer_glyphs,
                                         &glyph);
 
       if (glyph->texture_id == 0)
         goto next;
 
+      if (glyph->pending)
+        {
+          self->missing_glyphs = TRUE;
+          goto next;
+        }
+
       ops_set_texture (builder, glyph->texture_id);
 
       tx  = glyph->tx;
@@ -997,9 +1046,23 @@ render_color_node (GskGLRenderer   *self,
   load_vertex_data (ops_draw (builder, NULL), &node->bounds, builder);
 }
 
+static inline gboolean
+supports_npot_mipmaps (GskGLRenderer *self)
+{
+  int maj, min;
+
+  if (!gdk_gl_context_get_use_es (self->gl_context))
+    return TRUE;
+
+  gdk_gl_context_get_version (self->gl_context, &maj, &min);
+
+  return maj >= 3;
+}
+
 static inline void
 upload_texture (GskGLRenderer *self,
                 GdkTexture    *texture,
+                int            min_filter,
                 TextureRegion *out_region)
 {
   if (texture->width <= 128 &&
@@ -1024,7 +1087,7 @@ upload_texture (GskGLRenderer *self,
       out_region->texture_id =
           gsk_gl_driver_get_texture_for_texture (self->gl_driver,
                                                  texture,
-                                                 GL_LINEAR,
+                                                 min_filter,
                                                  GL_LINEAR);
 
       out_region->x  = 0;
@@ -1082,8 +1145,19 @@ render_texture_node (GskGLRenderer       *self,
   else
     {
       TextureRegion r;
+      int min_filter = GL_LINEAR;
+
+      /* Textures drawn at less than half their size alias badly without
+       * mipmaps. We can't add them to GL textures we don't own, and
+       * GLES 2 does not support them for non-power-of-two sizes. */
+      if (node->bounds.size.width * builder->scale_x < texture->width * 0.5f &&
+          node->bounds.size.height * builder->scale_y < texture->height * 0.5f &&
+          !GDK_IS_GL_TEXTURE (texture) &&
+          !GDK_IS_DMABUF_TEXTURE (texture) &&
+          supports_npot_mipmaps (self))
+        min_filter = GL_LINEAR_MIPMAP_LINEAR;
 
-      upload_texture (self, texture, &r);
+      upload_texture (self, texture, min_filter, &r);
 
       ops_set_program (builder, &self->programs->blit_program);
       ops_set_texture (builder, r.texture_id);
@@ -1203,6 +1277,59 @@ gsk_gl_renderer_try_compile_gl_shader (GskGLRenderer  *self,
   return program != NULL;
 }
 
+/* Children of shader nodes are kept across frames for as long
+ * as they draw the same, see gskglshaderchildcache.c
+ */
+static gboolean
+add_shader_child_offscreen_ops (GskGLRenderer   *self,
+                                RenderOpBuilder *builder,
+                                GskRenderNode   *node,
+                                guint            child_index,
+                                TextureRegion   *region,
+                                gboolean        *is_offscreen)
+{
+  const gboolean prev_missing_glyphs = self->missing_glyphs;
+  GskRenderNode *child = gsk_gl_shader_node_get_child (node, child_index);
+  int texture_id;
+
+  texture_id = gsk_gl_shader_child_cache_get_texture_id (&self->shader_child_cache,
+                                                         self->gl_driver,
+                                                         node, child_index,
+                                                         builder->scale_x,
+                                                         builder->scale_y);
+  if (texture_id != 0)
+    {
+      init_full_texture_region (region, texture_id);
+      *is_offscreen = TRUE;
+      return TRUE;
+    }
+
+  self->missing_glyphs = FALSE;
+
+  if (!add_offscreen_ops (self, builder,
+                          &node->bounds,
+                          child,
+                          region, is_offscreen,
+                          FORCE_OFFSCREEN | RESET_CLIP | NO_CACHE_PLZ))
+    {
+      self->missing_glyphs |= prev_missing_glyphs;
+      return FALSE;
+    }
+
+  /* Don't retain a texture with glyphs that are still missing */
+  if (*is_offscreen && !self->missing_glyphs)
+    gsk_gl_shader_child_cache_commit (&self->shader_child_cache,
+                                      self->gl_driver,
+                                      node, child_index,
+                                      builder->scale_x,
+                                      builder->scale_y,
+                                      region->texture_id);
+
+  self->missing_glyphs |= prev_missing_glyphs;
+
+  return TRUE;
+}
+
 static inline void
 render_gl_shader_node (GskGLRenderer       *self,
                        GskRenderNode       *node,
@@ -1235,12 +1362,7 @@ render_gl_shader_node (GskGLRenderer       *self,
       gboolean is_offscreen[4];
       for (guint i = 0; i < n_children; i++)
         {
-          GskRenderNode *child = gsk_gl_shader_node_get_child (node, i);
-          if (!add_offscreen_ops (self, builder,
-                                  &node->bounds,
-                                  child,
-                                  &regions[i], &is_offscreen[i],
-                                  FORCE_OFFSCREEN | RESET_CLIP))
+          if (!add_shader_child_offscreen_ops (self, builder, node, i, &regions[i], &is_offscreen[i]))
             return;
         }
 
@@ -1442,7 +1564,7 @@ render_linear_gradient_node (GskGLRenderer   *self,
 {
   const int n_color_stops = gsk_linear_gradient_node_get_n_color_stops (node);
 
-  if (n_color_stops < GL_MAX_GRADIENT_STOPS)
+  if (n_color_stops < builder->max_gradient_stops)
     {
       const GskColorStop *stops = gsk_linear_gradient_node_get_color_stops (node, NULL);
       const graphene_point_t *start = gsk_linear_gradient_node_get_start (node);
@@ -1472,7 +1594,7 @@ render_radial_gradient_node (GskGLRenderer   *self,
 {
   const int n_color_stops = gsk_radial_gradient_node_get_n_color_stops (node);
 
-  if (n_color_stops < GL_MAX_GRADIENT_STOPS)
+  if (n_color_stops < builder->max_gradient_stops)
     {
       const GskColorStop *stops = gsk_radial_gradient_node_get_color_stops (node, NULL);
       const graphene_point_t *center = gsk_radial_gradient_node_get_center (node);
@@ -1506,7 +1628,7 @@ render_conic_gradient_node (GskGLRenderer   *self,
 {
   const int n_color_stops = gsk_conic_gradient_node_get_n_color_stops (node);
 
-  if (n_color_stops < GL_MAX_GRADIENT_STOPS)
+  if (n_color_stops < builder->max_gradient_stops)
     {
       const GskColorStop *stops = gsk_conic_gradient_node_get_color_stops (node, NULL);
       const graphene_point_t *center = gsk_conic_gradient_node_get_center (node);
@@ -1771,6 +1893,67 @@ render_rounded_clip_node (GskGLRenderer       *self,
     }
 }
 
+/* This is the common case of a symbolic icon that only uses
+ * the foreground color. Black pixels are mapped to a single color
+ * by the matrix, so we can use the same program as for text and
+ * avoid a program change between labels and icons.
+ */
+static inline gboolean
+render_color_matrix_node_as_mask (GskGLRenderer   *self,
+                                  GskRenderNode   *node,
+                                  RenderOpBuilder *builder)
+{
+  GskRenderNode *child = gsk_color_matrix_node_get_child (node);
+  const graphene_vec4_t *offset;
+  const IconData *icon_data;
+  GdkTexture *texture;
+  TextureRegion region;
+  float matrix[16];
+  GdkRGBA color;
+
+  if (gsk_render_node_get_node_type (child) != GSK_TEXTURE_NODE)
+    return FALSE;
+
+  texture = gsk_texture_node_get_texture (child);
+  if (texture->width > 128 || texture->height > 128 ||
+      GDK_IS_GL_TEXTURE (texture))
+    return FALSE;
+
+  /* Black is mapped to (offset.rgb, matrix[15] * alpha) */
+  graphene_matrix_to_float (gsk_color_matrix_node_get_color_matrix (node), matrix);
+  offset = gsk_color_matrix_node_get_color_offset (node);
+  if (matrix[12] != 0 || matrix[13] != 0 || matrix[14] != 0 ||
+      matrix[15] < 0 || matrix[15] > 1 ||
+      graphene_vec4_get_w (offset) != 0)
+    return FALSE;
+
+  gsk_gl_icon_cache_lookup_or_add (self->icon_cache, texture, &icon_data);
+  if (!icon_data->is_mask)
+    return FALSE;
+
+  color.red = CLAMP (graphene_vec4_get_x (offset), 0, 1);
+  color.green = CLAMP (graphene_vec4_get_y (offset), 0, 1);
+  color.blue = CLAMP (graphene_vec4_get_z (offset), 0, 1);
+  color.alpha = matrix[15];
+
+  region.texture_id = icon_data->texture_id;
+  region.x = icon_data->x;
+  region.y = icon_data->y;
+  region.x2 = icon_data->x2;
+  region.y2 = icon_data->y2;
+
+  ops_set_program (builder, &self->programs->coloring_program);
+  ops_set_color (builder, &color);
+  ops_set_texture (builder, region.texture_id);
+
+  load_vertex_data_with_region (ops_draw (builder, NULL),
+                                &child->bounds, builder,
+                                &region,
+                                FALSE);
+
+  return TRUE;
+}
+
 static inline void
 render_color_matrix_node (GskGLRenderer       *self,
                           GskRenderNode       *node,
@@ -1783,6 +1966,9 @@ render_color_matrix_node (GskGLRenderer       *self,
   if (node_is_invisible (child))
     return;
 
+  if (render_color_matrix_node_as_mask (self, node, builder))
+    return;
+
   if (!add_offscreen_ops (self, builder,
                           &node->bounds,
                           child,
@@ -1803,105 +1989,153 @@ render_color_matrix_node (GskGLRenderer       *self,
                                 is_offscreen);
 }
 
-static inline int
-blur_texture (GskGLRenderer       *self,
-              RenderOpBuilder     *builder,
-              const TextureRegion *region,
-              const int            texture_to_blur_width,
-              const int            texture_to_blur_height,
-              float                blur_radius_x,
-              float                blur_radius_y)
+/* Renders @region into a new @width x @height render target, either
+ * blurring it in the direction given by @dir_x, @dir_y or, for a
+ * @blur_radius of 0, just scaling it.
+ */
+static int
+blur_texture_pass (GskGLRenderer       *self,
+                   RenderOpBuilder     *builder,
+                   const TextureRegion *region,
+                   int                  width,
+                   int                  height,
+                   int                  filter,
+                   float                blur_radius,
+                   int                  dir_x,
+                   int                  dir_y)
 {
-  const GskRoundedRect new_clip = GSK_ROUNDED_RECT_INIT (0, 0, texture_to_blur_width, texture_to_blur_height);
-  int pass1_texture_id, pass1_render_target;
-  int pass2_texture_id, pass2_render_target;
+  const graphene_rect_t bounds = GRAPHENE_RECT_INIT (0, 0, width, height);
+  int texture_id, render_target;
   int prev_render_target;
   graphene_matrix_t prev_projection;
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
-  OpBlur *op;
-
-  g_assert (blur_radius_x > 0);
-  g_assert (blur_radius_y > 0);
 
   gsk_gl_driver_create_render_target (self->gl_driver,
-                                      MAX (texture_to_blur_width, 1), MAX (texture_to_blur_height, 1),
-                                      GL_NEAREST, GL_NEAREST,
-                                      &pass1_texture_id, &pass1_render_target);
+                                      width, height,
+                                      filter, filter,
+                                      &texture_id, &render_target);
 
-  if (texture_to_blur_width <= 0 || texture_to_blur_height <= 0)
+  init_projection_matrix (&item_proj, &bounds);
+
+  if (blur_radius > 0)
     {
-      return pass1_texture_id;
-    }
+      OpBlur *op;
 
-  gsk_gl_driver_create_render_target (self->gl_driver,
-                                      texture_to_blur_width, texture_to_blur_height,
-                                      GL_NEAREST, GL_NEAREST,
-                                      &pass2_texture_id, &pass2_render_target);
+      ops_set_program (builder, &self->programs->blur_program);
 
-  init_projection_matrix (&item_proj, &new_clip.bounds);
+      op = ops_begin (builder, OP_CHANGE_BLUR);
+      op->size.width = width;
+      op->size.height = height;
+      op->radius = blur_radius;
+      op->dir[0] = dir_x;
+      op->dir[1] = dir_y;
+    }
+  else
+    {
+      ops_set_program (builder, &self->programs->blit_program);
+    }
 
-  ops_set_program (builder, &self->programs->blur_program);
   prev_projection = ops_set_projection (builder, &item_proj);
   ops_set_modelview (builder, NULL);
-  prev_viewport = ops_set_viewport (builder, &new_clip.bounds);
-  ops_push_clip (builder, &new_clip);
+  prev_viewport = ops_set_viewport (builder, &bounds);
+  ops_push_clip (builder, &GSK_ROUNDED_RECT_INIT (0, 0, width, height));
 
-  prev_render_target = ops_set_render_target (builder, pass1_render_target);
+  prev_render_target = ops_set_render_target (builder, render_target);
   ops_begin (builder, OP_CLEAR);
 
-  op = ops_begin (builder, OP_CHANGE_BLUR);
-  op->size.width = texture_to_blur_width;
-  op->size.height = texture_to_blur_height;
-  op->radius = blur_radius_x;
-  op->dir[0] = 1;
-  op->dir[1] = 0;
   ops_set_texture (builder, region->texture_id);
-
   load_vertex_data_with_region (ops_draw (builder, NULL),
-                                &new_clip.bounds,
-                                builder, region,
-                                FALSE);
-#if 0
-  {
-    static int k;
-    ops_dump_framebuffer (builder,
-                          g_strdup_printf ("pass1_%d.png", k++),
-                          texture_to_blur_width,
-                          texture_to_blur_height);
-  }
-#endif
-  op = ops_begin (builder, OP_CHANGE_BLUR);
-  op->size.width = texture_to_blur_width;
-  op->size.height = texture_to_blur_height;
-  op->radius = blur_radius_y;
-  op->dir[0] = 0;
-  op->dir[1] = 1;
-  ops_set_texture (builder, pass1_texture_id);
-  ops_set_render_target (builder, pass2_render_target);
-  ops_begin (builder, OP_CLEAR);
-  load_vertex_data_with_region (ops_draw (builder, NULL), /* render pass 2 */
-                                &new_clip.bounds,
+                                &bounds,
                                 builder, region,
                                 FALSE);
 
-#if 0
-  {
-    static int k;
-    ops_dump_framebuffer (builder,
-                          g_strdup_printf ("blurred%d.png", k++),
-                          texture_to_blur_width,
-                          texture_to_blur_height);
-  }
-#endif
-
   ops_set_render_target (builder, prev_render_target);
   ops_set_viewport (builder, &prev_viewport);
   ops_set_projection (builder, &prev_projection);
   ops_pop_modelview (builder);
   ops_pop_clip (builder);
 
-  return pass2_texture_id;
+  return texture_id;
+}
+
+static inline int
+blur_texture (GskGLRenderer       *self,
+              RenderOpBuilder     *builder,
+              const TextureRegion *region,
+              const int            texture_to_blur_width,
+              const int            texture_to_blur_height,
+              float                blur_radius_x,
+              float                blur_radius_y)
+{
+  TextureRegion pass_region = *region;
+  int width = texture_to_blur_width;
+  int height = texture_to_blur_height;
+  int filter;
+  guint n_levels = 0;
+  guint i;
+
+  g_assert (blur_radius_x > 0);
+  g_assert (blur_radius_y > 0);
+
+  if (texture_to_blur_width <= 0 || texture_to_blur_height <= 0)
+    {
+      int texture_id, render_target;
+
+      gsk_gl_driver_create_render_target (self->gl_driver,
+                                          1, 1,
+                                          GL_NEAREST, GL_NEAREST,
+                                          &texture_id, &render_target);
+      return texture_id;
+    }
+
+  /* The cost of the blur shader grows linearly with the radius, so for
+   * large radii we downsample first and blur at lower resolution. Each
+   * level halves both the size and the radius; halving with linear
+   * filtering is itself a small box blur, which is what keeps the
+   * result close to the full resolution one. */
+  while (n_levels < MAX_BLUR_LEVELS &&
+         MAX (blur_radius_x, blur_radius_y) / (1 << n_levels) > MAX_DIRECT_BLUR_RADIUS &&
+         (width >> (n_levels + 1)) > 0 &&
+         (height >> (n_levels + 1)) > 0)
+    n_levels++;
+
+  /* Intermediate results are sampled at different sizes, so they
+   * need linear filtering. */
+  filter = n_levels > 0 ? GL_LINEAR : GL_NEAREST;
+
+  for (i = 0; i < n_levels; i++)
+    {
+      width = (width + 1) / 2;
+      height = (height + 1) / 2;
+
+      init_full_texture_region (&pass_region,
+                                blur_texture_pass (self, builder, &pass_region,
+                                                   width, height, GL_LINEAR,
+                                                   0, 0, 0));
+    }
+
+  blur_radius_x /= (1 << n_levels);
+  blur_radius_y /= (1 << n_levels);
+
+  init_full_texture_region (&pass_region,
+                            blur_texture_pass (self, builder, &pass_region,
+                                               width, height, filter,
+                                               blur_radius_x, 1, 0));
+  init_full_texture_region (&pass_region,
+                            blur_texture_pass (self, builder, &pass_region,
+                                               width, height, filter,
+                                               blur_radius_y, 0, 1));
+
+  /* Scale back up to the requested size, so callers don't need to care */
+  if (n_levels > 0)
+    init_full_texture_region (&pass_region,
+                              blur_texture_pass (self, builder, &pass_region,
+                                                 texture_to_blur_width, texture_to_blur_height,
+                                                 GL_NEAREST,
+                                                 0, 0, 0));
+
+  return pass_region.texture_id;
 }
 
 static inline void
@@ -1930,6 +2164,10 @@ blur_node (GskGLRenderer   *self,
   /* Only blur this if the out region has no texture id yet */
   if (out_region->texture_id == 0)
     {
+      /* Large blurs start by downsampling the offscreen */
+      if (blur_radius * MAX (scale_x, scale_y) > MAX_DIRECT_BLUR_RADIUS)
+        extra_flags |= LINEAR_FILTER;
+
       if (!add_offscreen_ops (self, builder,
                               &GRAPHENE_RECT_INIT (node->bounds.origin.x - (blur_extra / 2.0),
                                                    node->bounds.origin.y - (blur_extra / 2.0),
@@ -3030,13 +3268,17 @@ apply_outset_shadow_op (const Program        *program,
 
 static inline void
 apply_linear_gradient_op (const Program          *program,
-                          const OpLinearGradient *op)
+                          const OpLinearGradient *op,
+                          GLuint                  uniform_buffer_id)
 {
   OP_PRINT (" -> Linear gradient");
   if (op->n_color_stops.send)
     glUniform1i (program->linear_gradient.num_color_stops_location, op->n_color_stops.value);
 
-  if (op->color_stops.send)
+  if (op->uniform_offset >= 0)
+    glBindBufferRange (GL_UNIFORM_BUFFER, GL_COLOR_STOPS_BINDING, uniform_buffer_id,
+                       op->uniform_offset, GL_COLOR_STOPS_BLOCK_SIZE);
+  else if (op->color_stops.send)
     glUniform1fv (program->linear_gradient.color_stops_location,
                   op->n_color_stops.value * 5,
                   (float *)op->color_stops.value);
@@ -3047,13 +3289,17 @@ apply_linear_gradient_op (const Program          *program,
 
 static inline void
 apply_radial_gradient_op (const Program          *program,
-                          const OpRadialGradient *op)
+                          const OpRadialGradient *op,
+                          GLuint                  uniform_buffer_id)
 {
   OP_PRINT (" -> Radial gradient");
   if (op->n_color_stops.send)
     glUniform1i (program->radial_gradient.num_color_stops_location, op->n_color_stops.value);
 
-  if (op->color_stops.send)
+  if (op->uniform_offset >= 0)
+    glBindBufferRange (GL_UNIFORM_BUFFER, GL_COLOR_STOPS_BINDING, uniform_buffer_id,
+                       op->uniform_offset, GL_COLOR_STOPS_BLOCK_SIZE);
+  else if (op->color_stops.send)
     glUniform1fv (program->radial_gradient.color_stops_location,
                   op->n_color_stops.value * 5,
                   (float *)op->color_stops.value);
@@ -3066,13 +3312,17 @@ apply_radial_gradient_op (const Program          *program,
 
 static inline void
 apply_conic_gradient_op (const Program         *program,
-                         const OpConicGradient *op)
+                         const OpConicGradient *op,
+                         GLuint                 uniform_buffer_id)
 {
   OP_PRINT (" -> Conic gradient");
   if (op->n_color_stops.send)
     glUniform1i (program->conic_gradient.num_color_stops_location, op->n_color_stops.value);
 
-  if (op->color_stops.send)
+  if (op->uniform_offset >= 0)
+    glBindBufferRange (GL_UNIFORM_BUFFER, GL_COLOR_STOPS_BINDING, uniform_buffer_id,
+                       op->uniform_offset, GL_COLOR_STOPS_BLOCK_SIZE);
+  else if (op->color_stops.send)
     glUniform1fv (program->conic_gradient.color_stops_location,
                   op->n_color_stops.value * 5,
                   (float *)op->color_stops.value);
@@ -3207,6 +3457,50 @@ gsk_gl_renderer_dispose (GObject *gobject)
   G_OBJECT_CLASS (gsk_gl_renderer_parent_class)->dispose (gobject);
 }
 
+static void
+gsk_gl_renderer_set_property (GObject      *gobject,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  GskGLRenderer *self = GSK_GL_RENDERER (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_ASYNC_GLYPHS:
+      if (self->async_glyphs != g_value_get_boolean (value))
+        {
+          self->async_glyphs = g_value_get_boolean (value);
+          g_object_notify_by_pspec (gobject, pspec);
+        }
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gsk_gl_renderer_get_property (GObject    *gobject,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  GskGLRenderer *self = GSK_GL_RENDERER (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_ASYNC_GLYPHS:
+      g_value_set_boolean (value, self->async_glyphs);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 program_init (Program *program)
 {
@@ -3365,14 +3659,26 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
   INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
   INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
 
+  /* Gradient color stops are either in a uniform block or an array */
+  if (shader_builder.gl3)
+    {
+      INIT_PROGRAM_UNIFORM_BLOCK (linear_gradient, GskColorStops, GL_COLOR_STOPS_BINDING);
+      INIT_PROGRAM_UNIFORM_BLOCK (radial_gradient, GskColorStops, GL_COLOR_STOPS_BINDING);
+      INIT_PROGRAM_UNIFORM_BLOCK (conic_gradient, GskColorStops, GL_COLOR_STOPS_BINDING);
+    }
+  else
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (conic_gradient, color_stops);
+    }
+
   /* linear gradient */
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, num_color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, start_point);
   INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, end_point);
 
   /* radial gradient */
-  INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, num_color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, center);
   INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, start);
@@ -3380,7 +3686,6 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
   INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, radius);
 
   /* conic gradient */
-  INIT_PROGRAM_UNIFORM_LOCATION (conic_gradient, color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (conic_gradient, num_color_stops);
   INIT_PROGRAM_UNIFORM_LOCATION (conic_gradient, center);
   INIT_PROGRAM_UNIFORM_LOCATION (conic_gradient, rotation);
@@ -3564,10 +3869,32 @@ gsk_gl_renderer_realize (GskRenderer  *renderer,
     return FALSE;
   self->op_builder.programs = self->programs;
 
+  gsk_gl_vertex_ring_init (&self->vertex_ring, self->gl_context);
+  self->op_builder.vertex_ring = &self->vertex_ring;
+  self->op_builder.merge_draws = g_getenv ("GSK_NO_MERGE_DRAWS") == NULL;
+
+  /* The GL3 shaders read gradient color stops from a uniform buffer */
+  if (!gdk_gl_context_get_use_es (self->gl_context) &&
+      !gdk_gl_context_is_legacy (self->gl_context))
+    {
+      int alignment;
+
+      glGetIntegerv (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+      glGenBuffers (1, &self->uniform_buffer_id);
+
+      self->op_builder.use_uniform_buffers = TRUE;
+      self->op_builder.uniform_buffer_alignment = MAX (alignment, 1);
+      self->op_builder.max_gradient_stops = GL_MAX_UBO_GRADIENT_STOPS;
+    }
+
   self->atlases = get_texture_atlases_for_display (gdk_surface_get_display (surface));
   self->glyph_cache = get_glyph_cache_for_display (gdk_surface_get_display (surface), self->atlases);
   self->icon_cache = get_icon_cache_for_display (gdk_surface_get_display (surface), self->atlases);
   gsk_gl_shadow_cache_init (&self->shadow_cache);
+  gsk_gl_layer_cache_init (&self->layer_cache);
+  gsk_gl_shader_child_cache_init (&self->shader_child_cache);
+  self->layers_enabled = g_getenv ("GSK_NO_LAYER_CACHE") == NULL;
+  self->cull_occluded = g_getenv ("GSK_NO_OCCLUSION_CULLING") == NULL;
 
   gdk_profiler_end_mark (before, "gl renderer realize", NULL);
 
@@ -3589,12 +3916,24 @@ gsk_gl_renderer_unrealize (GskRenderer *renderer)
    */
   ops_reset (&self->op_builder);
   self->op_builder.programs = NULL;
+  self->op_builder.vertex_ring = NULL;
+  gsk_gl_vertex_ring_free (&self->vertex_ring);
+
+  if (self->uniform_buffer_id != 0)
+    {
+      glDeleteBuffers (1, &self->uniform_buffer_id);
+      self->uniform_buffer_id = 0;
+    }
+  self->op_builder.use_uniform_buffers = FALSE;
+  self->op_builder.max_gradient_stops = GL_MAX_GRADIENT_STOPS;
 
   g_clear_pointer (&self->programs, gsk_gl_renderer_programs_unref);
   g_clear_pointer (&self->glyph_cache, gsk_gl_glyph_cache_unref);
   g_clear_pointer (&self->icon_cache, gsk_gl_icon_cache_unref);
   g_clear_pointer (&self->atlases, gsk_gl_texture_atlases_unref);
   gsk_gl_shadow_cache_free (&self->shadow_cache, self->gl_driver);
+  gsk_gl_layer_cache_free (&self->layer_cache, self->gl_driver);
+  gsk_gl_shader_child_cache_free (&self->shader_child_cache, self->gl_driver);
 
   g_clear_object (&self->gl_profiler);
   g_clear_object (&self->gl_driver);
@@ -3657,11 +3996,131 @@ gsk_gl_renderer_setup_render_mode (GskGLRenderer *self)
     }
 }
 
+/* Draws @node from the layer cache, drawing it into a new layer
+ * first if it has been unchanged for long enough. Returns %FALSE
+ * if @node should be drawn normally instead.
+ */
+static gboolean
+render_layer (GskGLRenderer   *self,
+              GskRenderNode   *node,
+              RenderOpBuilder *builder)
+{
+  const int max_texture_size = gsk_gl_driver_get_max_texture_size (self->gl_driver);
+  TextureRegion region;
+  int width, height;
+  int texture_id;
+
+  /* Keep translations and scales pixel exact, we don't want
+   * to reuse a layer under a rotation or perspective. */
+  if (gsk_transform_get_category (builder->current_modelview) < GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    return FALSE;
+
+  width = ceilf (node->bounds.size.width * builder->scale_x);
+  height = ceilf (node->bounds.size.height * builder->scale_y);
+  if (width > max_texture_size || height > max_texture_size)
+    return FALSE;
+
+  texture_id = gsk_gl_layer_cache_get_texture_id (&self->layer_cache, node,
+                                                  builder->scale_x, builder->scale_y);
+  if (texture_id != 0)
+    {
+      init_full_texture_region (&region, texture_id);
+    }
+  else
+    {
+      const gboolean prev_missing_glyphs = self->missing_glyphs;
+      gboolean is_offscreen;
+      gboolean drawn;
+
+      if (!gsk_gl_layer_cache_should_cache (&self->layer_cache, node, width, height))
+        return FALSE;
+
+      self->missing_glyphs = FALSE;
+      self->layer_depth++;
+      drawn = add_offscreen_ops (self, builder, &node->bounds, node,
+                                 &region, &is_offscreen,
+                                 FORCE_OFFSCREEN | RESET_CLIP | NO_CACHE_PLZ);
+      self->layer_depth--;
+
+      if (!drawn)
+        {
+          self->missing_glyphs = prev_missing_glyphs;
+          return TRUE;
+        }
+
+      /* Don't retain a layer with glyphs that are still missing */
+      if (!self->missing_glyphs)
+        gsk_gl_layer_cache_commit (&self->layer_cache, self->gl_driver, node,
+                                   builder->scale_x, builder->scale_y,
+                                   width, height, region.texture_id);
+
+      self->missing_glyphs |= prev_missing_glyphs;
+    }
+
+  ops_set_program (builder, &self->programs->blit_program);
+  ops_set_texture (builder, region.texture_id);
+
+  load_vertex_data_with_region (ops_draw (builder, NULL),
+                                &node->bounds, builder,
+                                &region,
+                                TRUE);
+
+  return TRUE;
+}
+
+#ifdef G_ENABLE_DEBUG
+static int
+get_gpu_region_for_node (GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_BLUR_NODE:
+      return GPU_REGION_BLUR;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_SHADOW_NODE:
+      return GPU_REGION_SHADOW;
+
+    case GSK_NOT_A_RENDER_NODE:
+    case GSK_CONTAINER_NODE:
+    case GSK_DEBUG_NODE:
+    case GSK_COLOR_NODE:
+    case GSK_TEXTURE_NODE:
+    case GSK_TRANSFORM_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_CLIP_NODE:
+    case GSK_ROUNDED_CLIP_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_CROSS_FADE_NODE:
+    case GSK_BLEND_NODE:
+    case GSK_REPEAT_NODE:
+    case GSK_GL_SHADER_NODE:
+      return -1;
+
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CAIRO_NODE:
+    default:
+      return GPU_REGION_FALLBACK;
+    }
+}
+#endif
+
 static void
 gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
                                 GskRenderNode   *node,
                                 RenderOpBuilder *builder)
 {
+#ifdef G_ENABLE_DEBUG
+  int gpu_region;
+#endif
+
   /* This can still happen, even if the render nodes are created using
    * GtkSnapshot, so let's just be safe. */
   if (node_is_invisible (node))
@@ -3681,6 +4140,19 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
       return;
   }
 
+  if (self->use_layers && self->layer_depth == 0 &&
+      gsk_render_node_get_node_type (node) == GSK_CONTAINER_NODE &&
+      render_layer (self, node, builder))
+    return;
+
+#ifdef G_ENABLE_DEBUG
+  gpu_region = get_gpu_region_for_node (node);
+  if (gpu_region >= 0)
+    ops_push_timed_debug_group (builder,
+                                g_type_name_from_instance ((GTypeInstance *) node),
+                                gpu_region);
+#endif
+
   switch (gsk_render_node_get_node_type (node))
     {
     case GSK_NOT_A_RENDER_NODE:
@@ -3694,6 +4166,13 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
           {
             GskRenderNode *child = gsk_container_node_get_child (node, i);
 
+            /* Hidden behind an opaque sibling */
+            if (self->cull_occluded && gsk_container_node_is_child_occluded (node, i))
+              {
+                self->n_culled_nodes++;
+                continue;
+              }
+
             gsk_gl_renderer_add_render_ops (self, child, builder);
           }
       }
@@ -3807,6 +4286,11 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
         render_fallback_node (self, node, builder);
       }
     }
+
+#ifdef G_ENABLE_DEBUG
+  if (gpu_region >= 0)
+    ops_pop_debug_group (builder);
+#endif
 }
 
 static gboolean
@@ -3849,7 +4333,7 @@ add_offscreen_ops (GskGLRenderer         *self,
       (flags & FORCE_OFFSCREEN) == 0)
     {
       GdkTexture *texture = gsk_texture_node_get_texture (child_node);
-      upload_texture (self, texture, texture_region_out);
+      upload_texture (self, texture, GL_LINEAR, texture_region_out);
       *is_offscreen = FALSE;
       return TRUE;
     }
@@ -3938,7 +4422,13 @@ add_offscreen_ops (GskGLRenderer         *self,
 
   prev_opacity = ops_set_opacity (builder, 1.0);
 
+#ifdef G_ENABLE_DEBUG
+  ops_push_timed_debug_group (builder, "Offscreen", GPU_REGION_OFFSCREEN);
+#endif
   gsk_gl_renderer_add_render_ops (self, child_node, builder);
+#ifdef G_ENABLE_DEBUG
+  ops_pop_debug_group (builder);
+#endif
 
 #ifdef G_ENABLE_DEBUG
   if (G_UNLIKELY (flags & DUMP_FRAMEBUFFER))
@@ -3979,35 +4469,25 @@ static void
 gsk_gl_renderer_render_ops (GskGLRenderer *self)
 {
   const Program *program = NULL;
-  const gsize vertex_data_size = self->op_builder.vertices->len * sizeof (GskQuadVertex);
-  const float *vertex_data = (float *)self->op_builder.vertices->data;
   OpBufferIter iter;
   OpKind kind;
   gpointer ptr;
-  GLuint buffer_id, vao_id;
+  guint base_vertex;
 
 #if DEBUG_OPS
   g_print ("============================================\n");
 #endif
 
-  glGenVertexArrays (1, &vao_id);
-  glBindVertexArray (vao_id);
-
-  glGenBuffers (1, &buffer_id);
-  glBindBuffer (GL_ARRAY_BUFFER, buffer_id);
+  base_vertex = ops_upload_vertices (&self->op_builder);
 
-  glBufferData (GL_ARRAY_BUFFER, vertex_data_size, vertex_data, GL_STATIC_DRAW);
-
-  /* 0 = position location */
-  glEnableVertexAttribArray (0);
-  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
-  /* 1 = texture coord location */
-  glEnableVertexAttribArray (1);
-  glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
+  if (self->op_builder.uniform_data->len > 0)
+    {
+      glBindBuffer (GL_UNIFORM_BUFFER, self->uniform_buffer_id);
+      glBufferData (GL_UNIFORM_BUFFER,
+                    self->op_builder.uniform_data->len,
+                    self->op_builder.uniform_data->data,
+                    GL_STREAM_DRAW);
+    }
 
   op_buffer_iter_init (&iter, ops_get_buffer (&self->op_builder));
   while ((ptr = op_buffer_iter_next (&iter, &kind)))
@@ -4098,15 +4578,15 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self)
           break;
 
         case OP_CHANGE_LINEAR_GRADIENT:
-          apply_linear_gradient_op (program, ptr);
+          apply_linear_gradient_op (program, ptr, self->uniform_buffer_id);
           break;
 
         case OP_CHANGE_RADIAL_GRADIENT:
-          apply_radial_gradient_op (program, ptr);
+          apply_radial_gradient_op (program, ptr, self->uniform_buffer_id);
           break;
 
         case OP_CHANGE_CONIC_GRADIENT:
-          apply_conic_gradient_op (program, ptr);
+          apply_conic_gradient_op (program, ptr, self->uniform_buffer_id);
           break;
 
         case OP_CHANGE_BLUR:
@@ -4148,7 +4628,7 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self)
             OP_PRINT (" -> draw %ld, size %ld and program %d: %s",
                       op->vao_offset, op->vao_size, program->index,
                       program->name ?: "");
-            glDrawArrays (GL_TRIANGLES, op->vao_offset, op->vao_size);
+            glDrawArrays (GL_TRIANGLES, base_vertex + op->vao_offset, op->vao_size);
             break;
           }
 
@@ -4164,11 +4644,17 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self)
           {
             const OpDebugGroup *op = ptr;
             gdk_gl_context_push_debug_group (self->gl_context, op->text);
+#ifdef G_ENABLE_DEBUG
+            gsk_gl_profiler_begin_region (self->gl_profiler, op->gpu_region);
+#endif
             OP_PRINT (" Debug: %s", op->text);
             break;
           }
 
         case OP_POP_DEBUG_GROUP:
+#ifdef G_ENABLE_DEBUG
+          gsk_gl_profiler_end_region (self->gl_profiler);
+#endif
           gdk_gl_context_pop_debug_group (self->gl_context);
           break;
 
@@ -4181,8 +4667,8 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self)
       OP_PRINT ("\n");
     }
 
-  glDeleteVertexArrays (1, &vao_id);
-  glDeleteBuffers (1, &buffer_id);
+  gsk_gl_vertex_ring_submit (&self->vertex_ring);
+  glBindVertexArray (0);
 }
 
 static void
@@ -4198,6 +4684,7 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   GskProfiler *profiler;
   gint64 gpu_time, cpu_time;
   gint64 start_time G_GNUC_UNUSED;
+  guint64 gpu_region_times[N_GPU_REGIONS];
 #endif
   GPtrArray *removed;
 
@@ -4218,8 +4705,21 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   gsk_gl_glyph_cache_begin_frame (self->glyph_cache, self->gl_driver, removed);
   gsk_gl_icon_cache_begin_frame (self->icon_cache, removed);
   gsk_gl_shadow_cache_begin_frame (&self->shadow_cache, self->gl_driver);
+  gsk_gl_layer_cache_begin_frame (&self->layer_cache, self->gl_driver);
+  gsk_gl_shader_child_cache_begin_frame (&self->shader_child_cache, self->gl_driver);
   g_ptr_array_unref (removed);
 
+#ifdef G_ENABLE_DEBUG
+  {
+    guint n_atlases, occupancy, n_relocated;
+
+    gsk_gl_texture_atlases_get_stats (self->atlases, &n_atlases, &occupancy, &n_relocated);
+    gsk_profiler_counter_set (profiler, self->profile_counters.atlases, n_atlases);
+    gsk_profiler_counter_set (profiler, self->profile_counters.atlas_occupancy, occupancy);
+    gsk_profiler_counter_set (profiler, self->profile_counters.relocated_atlas_entries, n_relocated);
+  }
+#endif
+
   /* Set up the modelview and projection matrices to fit our viewport */
   init_projection_matrix (&projection, viewport);
   ops_set_projection (&self->op_builder, &projection);
@@ -4258,10 +4758,22 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   if (fbo_id != 0)
     ops_set_render_target (&self->op_builder, fbo_id);
 
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_timer_begin (profiler, self->profile_timers.build_time);
+#endif
+
   gdk_gl_context_push_debug_group (self->gl_context, "Adding render ops");
+  self->n_culled_nodes = 0;
   gsk_gl_renderer_add_render_ops (self, root, &self->op_builder);
   gdk_gl_context_pop_debug_group (self->gl_context);
 
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_set (profiler, self->profile_counters.culled_nodes, self->n_culled_nodes);
+#endif
+  GSK_RENDERER_NOTE (renderer, OPENGL, g_message ("Culled %u occluded nodes", self->n_culled_nodes));
+
+  gsk_gl_glyph_cache_upload_pending (self->glyph_cache);
+
   /* We correctly reset the state everywhere */
   g_assert_cmpint (self->op_builder.current_render_target, ==, fbo_id);
   ops_pop_modelview (&self->op_builder);
@@ -4270,6 +4782,24 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
 
   /*g_message ("Ops: %u", self->render_ops->len);*/
 
+  if (self->op_builder.merge_draws)
+    {
+      guint n_draws, n_merged_draws;
+
+      ops_merge_draws (&self->op_builder, &n_draws, &n_merged_draws);
+
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_set (profiler, self->profile_counters.draws, n_draws);
+      gsk_profiler_counter_set (profiler, self->profile_counters.merged_draws, n_merged_draws);
+#endif
+      GSK_RENDERER_NOTE (renderer, OPENGL, g_message ("Merged %u draws into %u", n_draws, n_merged_draws));
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_timer_set (profiler, self->profile_timers.build_time,
+                          gsk_profiler_timer_end (profiler, self->profile_timers.build_time));
+#endif
+
   /* Now actually draw things... */
 #ifdef G_ENABLE_DEBUG
   gsk_gl_profiler_begin_gpu_region (self->gl_profiler);
@@ -4306,6 +4836,18 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
   gpu_time = gsk_gl_profiler_end_gpu_region (self->gl_profiler);
   gsk_profiler_timer_set (profiler, self->profile_timers.gpu_time, gpu_time);
 
+  gsk_profiler_counter_set (profiler, self->profile_counters.texture_uploads,
+                            gsk_gl_driver_get_n_uploads (self->gl_driver));
+
+  /* The region times are those of a frame a few frames back */
+  if (gsk_gl_profiler_collect_regions (self->gl_profiler, gpu_region_times, N_GPU_REGIONS))
+    {
+      guint i;
+
+      for (i = 0; i < N_GPU_REGIONS; i++)
+        gsk_profiler_timer_set (profiler, self->profile_timers.gpu_regions[i], gpu_region_times[i]);
+    }
+
   gsk_profiler_push_samples (profiler);
 
   gdk_profiler_add_mark (start_time * 1000, cpu_time * 1000, "GL render", "");
@@ -4493,9 +5035,20 @@ gsk_gl_renderer_render (GskRenderer          *renderer,
   viewport.size.height = whole_surface.height;
 
   gsk_gl_driver_begin_frame (self->gl_driver);
+  self->defer_glyphs = self->async_glyphs;
+  self->use_layers = self->layers_enabled;
   gsk_gl_renderer_do_render (renderer, root, &viewport, 0, self->scale_factor);
+  self->defer_glyphs = FALSE;
+  self->use_layers = FALSE;
   gsk_gl_driver_end_frame (self->gl_driver);
 
+  /* Draw the glyphs we had to skip once they are available */
+  if (self->missing_glyphs)
+    {
+      gsk_gl_glyph_cache_invalidate_when_ready (self->glyph_cache, surface);
+      self->missing_glyphs = FALSE;
+    }
+
   gsk_gl_renderer_clear_tree (self);
 
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->gl_context));
@@ -4513,11 +5066,32 @@ gsk_gl_renderer_class_init (GskGLRendererClass *klass)
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
 
   gobject_class->dispose = gsk_gl_renderer_dispose;
+  gobject_class->set_property = gsk_gl_renderer_set_property;
+  gobject_class->get_property = gsk_gl_renderer_get_property;
 
   renderer_class->realize = gsk_gl_renderer_realize;
   renderer_class->unrealize = gsk_gl_renderer_unrealize;
   renderer_class->render = gsk_gl_renderer_render;
   renderer_class->render_texture = gsk_gl_renderer_render_texture;
+
+  /**
+   * GskGLRenderer:async-glyphs:
+   *
+   * Whether glyphs missing from the glyph cache are rasterized in
+   * worker threads instead of while rendering the frame.
+   *
+   * Text using such glyphs is drawn without them until they are
+   * ready, which is usually a frame later. Rendering to a texture
+   * always rasterizes glyphs synchronously.
+   */
+  gsk_gl_renderer_properties[PROP_ASYNC_GLYPHS] =
+    g_param_spec_boolean ("async-glyphs",
+                          "Async glyphs",
+                          "Rasterize missing glyphs in worker threads",
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, gsk_gl_renderer_properties);
 }
 
 static void
@@ -4533,9 +5107,21 @@ gsk_gl_renderer_init (GskGLRenderer *self)
     GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
     self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
-
+    self->profile_counters.draws = gsk_profiler_add_counter (profiler, "draws", "Draw calls before merging", TRUE);
+    self->profile_counters.merged_draws = gsk_profiler_add_counter (profiler, "merged-draws", "Draw calls after merging", TRUE);
+    self->profile_counters.atlases = gsk_profiler_add_counter (profiler, "atlases", "Texture atlases", FALSE);
+    self->profile_counters.atlas_occupancy = gsk_profiler_add_counter (profiler, "atlas-occupancy", "Used atlas space (%)", FALSE);
+    self->profile_counters.relocated_atlas_entries = gsk_profiler_add_counter (profiler, "relocated-atlas-entries", "Atlas entries moved by compaction", TRUE);
+    self->profile_counters.culled_nodes = gsk_profiler_add_counter (profiler, "culled-nodes", "Occluded nodes skipped", TRUE);
+    self->profile_counters.texture_uploads = gsk_profiler_add_counter (profiler, "texture-uploads", "Textures uploaded", TRUE);
+
+    self->profile_timers.build_time = gsk_profiler_add_timer (profiler, "build-time", "Render op building time", FALSE, TRUE);
     self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
     self->profile_timers.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU time", FALSE, TRUE);
+    self->profile_timers.gpu_regions[GPU_REGION_OFFSCREEN] = gsk_profiler_add_timer (profiler, "gpu-offscreen-time", "GPU time for offscreens", FALSE, TRUE);
+    self->profile_timers.gpu_regions[GPU_REGION_BLUR] = gsk_profiler_add_timer (profiler, "gpu-blur-time", "GPU time for blurs", FALSE, TRUE);
+    self->profile_timers.gpu_regions[GPU_REGION_SHADOW] = gsk_profiler_add_timer (profiler, "gpu-shadow-time", "GPU time for shadows", FALSE, TRUE);
+    self->profile_timers.gpu_regions[GPU_REGION_FALLBACK] = gsk_profiler_add_timer (profiler, "gpu-fallback-time", "GPU time for fallbacks", FALSE, TRUE);
   }
 #endif
 }
@@ -113,6 +113,20 @@ ops_push_debug_group (RenderOpBuilder *builder,
   op = ops_begin (builder, OP_PUSH_DEBUG_GROUP);
   strncpy (op->text, text, sizeof(op->text) - 1);
   op->text[sizeof(op->text) - 1] = 0; /* Ensure zero terminated */
+  op->gpu_region = -1;
+}
+
+void
+ops_push_timed_debug_group (RenderOpBuilder *builder,
+                            const char      *text,
+                            int              gpu_region)
+{
+  OpDebugGroup *op;
+
+  op = ops_begin (builder, OP_PUSH_DEBUG_GROUP);
+  strncpy (op->text, text, sizeof(op->text) - 1);
+  op->text[sizeof(op->text) - 1] = 0; /* Ensure zero terminated */
+  op->gpu_region = gpu_region;
 }
 
 void
@@ -198,11 +212,15 @@ ops_init (RenderOpBuilder *builder)
 
   op_buffer_init (&builder->render_ops);
   builder->vertices = g_array_new (FALSE, TRUE, sizeof (GskQuadVertex));
+  builder->uniform_data = g_array_new (FALSE, TRUE, sizeof (guint8));
+  builder->uniform_buffer_alignment = 1;
+  builder->max_gradient_stops = GL_MAX_GRADIENT_STOPS;
 }
 
 void
 ops_free (RenderOpBuilder *builder)
 {
+  g_array_unref (builder->uniform_data);
   g_array_unref (builder->vertices);
   op_buffer_destroy (&builder->render_ops);
 }
@@ -619,11 +637,55 @@ ops_set_border_color (RenderOpBuilder *builder,
   current_program_state->border.color = *color;
 }
 
+static inline guint
+ops_get_n_vertices (const RenderOpBuilder *builder)
+{
+  if (builder->mapped_vertices != NULL)
+    return builder->n_mapped_vertices;
+
+  return builder->vertices->len;
+}
+
+static GskQuadVertex *
+ops_alloc_vertices (RenderOpBuilder *builder)
+{
+  GskQuadVertex *vertices;
+
+  if (builder->mapped_vertices == NULL &&
+      builder->vertex_ring != NULL &&
+      !builder->merge_draws &&
+      !builder->vertices_overflowed &&
+      builder->vertices->len == 0)
+    builder->mapped_vertices = gsk_gl_vertex_ring_map_segment (builder->vertex_ring,
+                                                               &builder->max_mapped_vertices);
+
+  if (builder->mapped_vertices != NULL)
+    {
+      if (builder->n_mapped_vertices + GL_N_VERTICES <= builder->max_mapped_vertices)
+        {
+          vertices = builder->mapped_vertices + builder->n_mapped_vertices;
+          builder->n_mapped_vertices += GL_N_VERTICES;
+          return vertices;
+        }
+
+      /* The mapped segment is full. Continue with the vertices in our
+       * own array, the ring will grow when they get uploaded. */
+      g_array_append_vals (builder->vertices, builder->mapped_vertices, builder->n_mapped_vertices);
+      builder->mapped_vertices = NULL;
+      builder->n_mapped_vertices = 0;
+      builder->vertices_overflowed = TRUE;
+    }
+
+  g_array_set_size (builder->vertices, builder->vertices->len + GL_N_VERTICES);
+  return &g_array_index (builder->vertices, GskQuadVertex, builder->vertices->len - GL_N_VERTICES);
+}
+
 GskQuadVertex *
 ops_draw (RenderOpBuilder     *builder,
           const GskQuadVertex  vertex_data[GL_N_VERTICES])
 {
   ProgramState *program_state = get_current_program_state (builder);
+  GskQuadVertex *vertices;
   OpDraw *op;
 
   if (memcmp (&builder->current_projection, &program_state->projection, sizeof (graphene_matrix_t)) != 0)
@@ -682,23 +744,381 @@ ops_draw (RenderOpBuilder     *builder,
   else
     {
       op = op_buffer_add (&builder->render_ops, OP_DRAW);
-      op->vao_offset = builder->vertices->len;
+      op->vao_offset = ops_get_n_vertices (builder);
       op->vao_size = GL_N_VERTICES;
+
+      op->has_affine_transform =
+        gsk_transform_get_category (builder->current_modelview) >= GSK_TRANSFORM_CATEGORY_2D_AFFINE;
+      if (op->has_affine_transform)
+        gsk_transform_to_affine (builder->current_modelview,
+                                 &op->scale[0], &op->scale[1],
+                                 &op->offset[0], &op->offset[1]);
     }
 
+  vertices = ops_alloc_vertices (builder);
+
   if (vertex_data)
     {
-      g_array_append_vals (builder->vertices, vertex_data, GL_N_VERTICES);
+      memcpy (vertices, vertex_data, sizeof (GskQuadVertex) * GL_N_VERTICES);
       return NULL; /* Better not use this on the caller side */
     }
 
-  g_array_set_size (builder->vertices, builder->vertices->len + GL_N_VERTICES);
-  return &g_array_index (builder->vertices, GskQuadVertex, builder->vertices->len - GL_N_VERTICES);
+  return vertices;
+}
+
+/* Uploads the vertices of all draw ops added since the last reset and
+ * binds the vertex array for rendering them. Returns the index of the
+ * first vertex, which has to be added to the vao_offset of every OP_DRAW.
+ */
+guint
+ops_upload_vertices (RenderOpBuilder *builder)
+{
+  g_assert (builder->vertex_ring != NULL);
+
+  if (builder->mapped_vertices != NULL)
+    return gsk_gl_vertex_ring_upload (builder->vertex_ring, NULL, builder->n_mapped_vertices);
+
+  return gsk_gl_vertex_ring_upload (builder->vertex_ring,
+                                    (const GskQuadVertex *) builder->vertices->data,
+                                    builder->vertices->len);
 }
 
 /* The offset is only valid for the current modelview.
  * Setting a new modelview will add the offset to that matrix
  * and reset the internal offset to 0. */
+/* Draws are only moved across this many chunks of other programs */
+#define MAX_MERGE_LOOKBACK 32
+
+typedef struct
+{
+  guint start; /* Index of the first op */
+  guint end;   /* One past the last op */
+  const Program *program;
+  graphene_rect_t bounds;
+  guint has_program_op : 1;
+  guint has_bounds : 1;
+} DrawChunk;
+
+static inline gboolean
+op_kind_is_barrier (OpKind kind)
+{
+  /* Ops that change global GL state or depend on the order of
+   * everything before them. Draws are never moved across these. */
+  switch (kind)
+    {
+    case OP_CHANGE_RENDER_TARGET:
+    case OP_CHANGE_SOURCE_TEXTURE:
+    case OP_CHANGE_EXTRA_SOURCE_TEXTURE:
+    case OP_CLEAR:
+    case OP_DUMP_FRAMEBUFFER:
+    case OP_PUSH_DEBUG_GROUP:
+    case OP_POP_DEBUG_GROUP:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+draw_get_bounds (const RenderOpBuilder *builder,
+                 const OpDraw          *op,
+                 graphene_rect_t       *bounds)
+{
+  const GskQuadVertex *vertices;
+  float min_x, min_y, max_x, max_y;
+  gsize i;
+
+  if (!op->has_affine_transform)
+    return FALSE;
+
+  vertices = &g_array_index (builder->vertices, GskQuadVertex, op->vao_offset);
+  min_x = max_x = vertices[0].position[0];
+  min_y = max_y = vertices[0].position[1];
+
+  for (i = 1; i < op->vao_size; i++)
+    {
+      min_x = MIN (min_x, vertices[i].position[0]);
+      min_y = MIN (min_y, vertices[i].position[1]);
+      max_x = MAX (max_x, vertices[i].position[0]);
+      max_y = MAX (max_y, vertices[i].position[1]);
+    }
+
+  graphene_rect_init (bounds,
+                      min_x * op->scale[0] + op->offset[0],
+                      min_y * op->scale[1] + op->offset[1],
+                      (max_x - min_x) * op->scale[0],
+                      (max_y - min_y) * op->scale[1]);
+  graphene_rect_normalize (bounds);
+
+  return TRUE;
+}
+
+static inline const OpBufferEntry *
+get_entry (OpBuffer *buffer,
+           guint     idx)
+{
+  return &g_array_index (buffer->index, OpBufferEntry, idx);
+}
+
+static void
+append_chunk (RenderOpBuilder *builder,
+              GArray          *chunks,
+              guint            start,
+              guint            end,
+              const Program   *program)
+{
+  OpBuffer *buffer = &builder->render_ops;
+  gboolean first_draw = TRUE;
+  DrawChunk chunk;
+  guint i;
+
+  if (start == end)
+    return;
+
+  chunk.start = start;
+  chunk.end = end;
+  chunk.program = program;
+  chunk.has_program_op = get_entry (buffer, start)->kind == OP_CHANGE_PROGRAM;
+  chunk.has_bounds = program != NULL;
+  graphene_rect_init (&chunk.bounds, 0, 0, 0, 0);
+
+  for (i = start; i < end && chunk.has_bounds; i++)
+    {
+      const OpBufferEntry *entry = get_entry (buffer, i);
+      graphene_rect_t bounds;
+
+      if (entry->kind != OP_DRAW)
+        continue;
+
+      if (!draw_get_bounds (builder, (const OpDraw *) &buffer->buf[entry->pos], &bounds))
+        {
+          chunk.has_bounds = FALSE;
+        }
+      else if (first_draw)
+        {
+          chunk.bounds = bounds;
+          first_draw = FALSE;
+        }
+      else
+        {
+          graphene_rect_union (&chunk.bounds, &bounds, &chunk.bounds);
+        }
+    }
+
+  g_array_append_val (chunks, chunk);
+}
+
+/* Returns the position in @order to insert @chunk at so that it ends up
+ * right behind the previous chunk using the same program, which is
+ * possible if it does not overlap anything drawn in between.
+ */
+static guint
+find_chunk_position (GArray          *chunks,
+                     GArray          *order,
+                     const DrawChunk *chunk)
+{
+  guint i;
+
+  if (!chunk->has_bounds)
+    return order->len;
+
+  for (i = order->len; i > 0 && order->len - i < MAX_MERGE_LOOKBACK; i--)
+    {
+      const DrawChunk *other = &g_array_index (chunks, DrawChunk,
+                                               g_array_index (order, guint, i - 1));
+
+      if (other->program == chunk->program)
+        return i;
+
+      if (!other->has_bounds ||
+          graphene_rect_intersects (&other->bounds, &chunk->bounds))
+        break;
+    }
+
+  return order->len;
+}
+
+static void
+emit_program_change (OpBuffer      *buffer,
+                     GArray        *index,
+                     const Program *program)
+{
+  OpProgram *op;
+
+  op = op_buffer_add (buffer, OP_CHANGE_PROGRAM);
+  op->program = program;
+  g_array_append_val (index, g_array_index (buffer->index, OpBufferEntry, buffer->index->len - 1));
+}
+
+static void
+emit_chunks (RenderOpBuilder *builder,
+             GArray          *chunks,
+             GArray          *index,
+             const Program  **current_program,
+             const Program   *end_program)
+{
+  OpBuffer *buffer = &builder->render_ops;
+  GArray *order;
+  guint i, j;
+
+  order = g_array_sized_new (FALSE, FALSE, sizeof (guint), chunks->len);
+
+  for (i = 0; i < chunks->len; i++)
+    {
+      const DrawChunk *chunk = &g_array_index (chunks, DrawChunk, i);
+      guint pos = find_chunk_position (chunks, order, chunk);
+
+      g_array_insert_val (order, pos, i);
+    }
+
+  for (i = 0; i < order->len; i++)
+    {
+      const DrawChunk *chunk = &g_array_index (chunks, DrawChunk, g_array_index (order, guint, i));
+      guint start = chunk->start;
+
+      if (chunk->program == *current_program)
+        {
+          if (chunk->has_program_op)
+            start++;
+        }
+      else if (!chunk->has_program_op)
+        {
+          emit_program_change (buffer, index, chunk->program);
+        }
+
+      for (j = start; j < chunk->end; j++)
+        g_array_append_val (index, g_array_index (buffer->index, OpBufferEntry, j));
+
+      *current_program = chunk->program;
+    }
+
+  /* Whatever comes next expects the program it was built with */
+  if (*current_program != end_program && end_program != NULL)
+    {
+      emit_program_change (buffer, index, end_program);
+      *current_program = end_program;
+    }
+
+  g_array_set_size (chunks, 0);
+  g_array_unref (order);
+}
+
+/* Reorders the draws in the op buffer so that draws using the same
+ * program end up next to each other wherever they don't overlap, and
+ * fuses consecutive draws into a single one. The vertices are rewritten
+ * in the new draw order, so this is only possible while they have not
+ * been written to the vertex ring yet.
+ */
+void
+ops_merge_draws (RenderOpBuilder *builder,
+                 guint           *out_n_draws_before,
+                 guint           *out_n_draws_after)
+{
+  OpBuffer *buffer = &builder->render_ops;
+  const Program *program = NULL;
+  const Program *new_program = NULL;
+  const Program *chunk_program = NULL;
+  GArray *chunks;
+  GArray *index;
+  GArray *vertices;
+  guint n_draws_before = 0;
+  guint n_draws_after = 0;
+  guint chunk_start;
+  guint n_ops;
+  guint i;
+
+  g_assert (builder->mapped_vertices == NULL);
+
+  n_ops = buffer->index->len;
+  chunks = g_array_new (FALSE, FALSE, sizeof (DrawChunk));
+  index = g_array_sized_new (FALSE, FALSE, sizeof (OpBufferEntry), n_ops);
+
+  /* Keep the initial OP_NONE */
+  g_array_append_val (index, g_array_index (buffer->index, OpBufferEntry, 0));
+
+  /* First pass: split the ops into chunks of one program change followed
+   * by the uniform changes and draws for that program. Chunks between two
+   * barriers get reordered. */
+  chunk_start = 1;
+  for (i = 1; i < n_ops; i++)
+    {
+      const OpBufferEntry *entry = get_entry (buffer, i);
+
+      if (entry->kind == OP_CHANGE_PROGRAM)
+        {
+          append_chunk (builder, chunks, chunk_start, i, chunk_program);
+          chunk_start = i;
+          program = ((const OpProgram *) &buffer->buf[entry->pos])->program;
+          chunk_program = program;
+        }
+      else if (op_kind_is_barrier (entry->kind))
+        {
+          append_chunk (builder, chunks, chunk_start, i, chunk_program);
+          emit_chunks (builder, chunks, index, &new_program, program);
+          g_array_append_val (index, g_array_index (buffer->index, OpBufferEntry, i));
+          chunk_start = i + 1;
+        }
+      else if (entry->kind == OP_DRAW)
+        {
+          n_draws_before++;
+        }
+    }
+
+  append_chunk (builder, chunks, chunk_start, n_ops, chunk_program);
+  emit_chunks (builder, chunks, index, &new_program, program);
+
+  /* Second pass: write the vertices in the new order and fuse draws
+   * that ended up next to each other. */
+  vertices = g_array_sized_new (FALSE, FALSE, sizeof (GskQuadVertex), builder->vertices->len);
+  n_ops = 1;
+  for (i = 1; i < index->len; i++)
+    {
+      const OpBufferEntry *entry = &g_array_index (index, OpBufferEntry, i);
+
+      if (entry->kind == OP_NONE)
+        continue;
+
+      if (entry->kind == OP_DRAW)
+        {
+          const OpBufferEntry *last = &g_array_index (index, OpBufferEntry, n_ops - 1);
+          OpDraw *op = (OpDraw *) &buffer->buf[entry->pos];
+
+          g_array_append_vals (vertices,
+                               &g_array_index (builder->vertices, GskQuadVertex, op->vao_offset),
+                               op->vao_size);
+
+          if (last->kind == OP_DRAW)
+            {
+              OpDraw *prev = (OpDraw *) &buffer->buf[last->pos];
+
+              prev->vao_size += op->vao_size;
+              continue;
+            }
+
+          op->vao_offset = vertices->len - op->vao_size;
+          n_draws_after++;
+        }
+
+      g_array_index (index, OpBufferEntry, n_ops) = *entry;
+      n_ops++;
+    }
+  g_array_set_size (index, n_ops);
+
+  g_array_unref (builder->vertices);
+  builder->vertices = vertices;
+
+  g_array_unref (buffer->index);
+  buffer->index = index;
+
+  g_array_unref (chunks);
+
+  if (out_n_draws_before)
+    *out_n_draws_before = n_draws_before;
+  if (out_n_draws_after)
+    *out_n_draws_after = n_draws_after;
+}
+
 void
 ops_offset (RenderOpBuilder *builder,
             float            x,
@@ -720,6 +1140,11 @@ ops_reset (RenderOpBuilder *builder)
 {
   op_buffer_clear (&builder->render_ops);
   g_array_set_size (builder->vertices, 0);
+  g_array_set_size (builder->uniform_data, 0);
+  builder->mapped_vertices = NULL;
+  builder->n_mapped_vertices = 0;
+  builder->max_mapped_vertices = 0;
+  builder->vertices_overflowed = FALSE;
 }
 
 OpBuffer *
@@ -855,6 +1280,39 @@ ops_set_unblurred_outset_shadow (RenderOpBuilder      *self,
     op->offset.send = FALSE;
 }
 
+/* Appends a block of color stops to the uniform data of this frame,
+ * in the layout of the GskColorStops uniform block, and returns its
+ * offset. Every block gets the full size of the uniform block so the
+ * bound range is always large enough. */
+static gssize
+ops_add_color_stops (RenderOpBuilder    *builder,
+                     guint               n_color_stops,
+                     const GskColorStop *color_stops)
+{
+  const guint alignment = builder->uniform_buffer_alignment;
+  gsize offset;
+  float *data;
+  guint i;
+
+  g_assert (builder->use_uniform_buffers);
+  g_assert (n_color_stops <= GL_MAX_UBO_GRADIENT_STOPS);
+
+  offset = (builder->uniform_data->len + alignment - 1) / alignment * alignment;
+  g_array_set_size (builder->uniform_data, offset + GL_COLOR_STOPS_BLOCK_SIZE);
+  data = (float *) (builder->uniform_data->data + offset);
+
+  for (i = 0; i < n_color_stops; i++)
+    {
+      data[(i * 8) + 0] = color_stops[i].offset;
+      data[(i * 8) + 4] = color_stops[i].color.red;
+      data[(i * 8) + 5] = color_stops[i].color.green;
+      data[(i * 8) + 6] = color_stops[i].color.blue;
+      data[(i * 8) + 7] = color_stops[i].color.alpha;
+    }
+
+  return offset;
+}
+
 void
 ops_set_linear_gradient (RenderOpBuilder     *self,
                          guint                n_color_stops,
@@ -866,7 +1324,7 @@ ops_set_linear_gradient (RenderOpBuilder     *self,
 {
   ProgramState *current_program_state = get_current_program_state (self);
   OpLinearGradient *op;
-  const guint real_n_color_stops = MIN (GL_MAX_GRADIENT_STOPS, n_color_stops);
+  const guint real_n_color_stops = MIN (self->max_gradient_stops, n_color_stops);
 
   g_assert (current_program_state);
 
@@ -884,7 +1342,12 @@ ops_set_linear_gradient (RenderOpBuilder     *self,
     op->n_color_stops.send = FALSE;
 
   op->color_stops.send = FALSE;
-  if (!op->n_color_stops.send)
+  op->uniform_offset = -1;
+  if (self->use_uniform_buffers)
+    {
+      op->uniform_offset = ops_add_color_stops (self, real_n_color_stops, color_stops);
+    }
+  else if (!op->n_color_stops.send)
     {
       g_assert (current_program_state->linear_gradient.n_color_stops == real_n_color_stops);
 
@@ -929,7 +1392,7 @@ ops_set_radial_gradient (RenderOpBuilder    *self,
                          float               hradius,
                          float               vradius)
 {
-  const guint real_n_color_stops = MIN (GL_MAX_GRADIENT_STOPS, n_color_stops);
+  const guint real_n_color_stops = MIN (self->max_gradient_stops, n_color_stops);
   OpRadialGradient *op;
 
   /* TODO: State tracking? */
@@ -938,7 +1401,10 @@ ops_set_radial_gradient (RenderOpBuilder    *self,
   op->n_color_stops.value = real_n_color_stops;
   op->n_color_stops.send = true;
   op->color_stops.value = color_stops;
-  op->color_stops.send = true;
+  op->color_stops.send = !self->use_uniform_buffers;
+  op->uniform_offset = self->use_uniform_buffers
+                       ? ops_add_color_stops (self, real_n_color_stops, color_stops)
+                       : -1;
   op->center[0] = center_x;
   op->center[1] = center_y;
   op->radius[0] = hradius;
@@ -955,7 +1421,7 @@ ops_set_conic_gradient (RenderOpBuilder    *self,
                         float               center_y,
                         float               rotation)
 {
-  const guint real_n_color_stops = MIN (GL_MAX_GRADIENT_STOPS, n_color_stops);
+  const guint real_n_color_stops = MIN (self->max_gradient_stops, n_color_stops);
   OpConicGradient *op;
 
   /* TODO: State tracking? */
@@ -964,7 +1430,10 @@ ops_set_conic_gradient (RenderOpBuilder    *self,
   op->n_color_stops.value = real_n_color_stops;
   op->n_color_stops.send = true;
   op->color_stops.value = color_stops;
-  op->color_stops.send = true;
+  op->color_stops.send = !self->use_uniform_buffers;
+  op->uniform_offset = self->use_uniform_buffers
+                       ? ops_add_color_stops (self, real_n_color_stops, color_stops)
+                       : -1;
   op->center[0] = center_x;
   op->center[1] = center_y;
   op->rotation = rotation;
@@ -9,6 +9,7 @@
 #include "gskroundedrectprivate.h"
 #include "gskglrenderer.h"
 #include "gskrendernodeprivate.h"
+#include "gskglvertexringprivate.h"
 
 #include "opbuffer.h"
 
@@ -16,6 +17,13 @@
 #define GL_N_PROGRAMS 15
 #define GL_MAX_GRADIENT_STOPS 6
 
+/* Gradients can use a lot more color stops if they are passed in a
+ * uniform buffer. This needs to match GSK_MAX_COLOR_STOPS in
+ * preamble.fs.glsl */
+#define GL_MAX_UBO_GRADIENT_STOPS 64
+#define GL_COLOR_STOPS_BLOCK_SIZE (GL_MAX_UBO_GRADIENT_STOPS * 2 * 4 * sizeof (float))
+#define GL_COLOR_STOPS_BINDING 0
+
 typedef struct
 {
   float scale_x;
@@ -224,6 +232,26 @@ typedef struct
   OpBuffer render_ops;
   GArray *vertices;
 
+  /* If the vertex ring is persistently mapped, vertices are written
+   * straight into its current segment and @vertices is only used once
+   * that segment overflows. */
+  GskGLVertexRing *vertex_ring;
+  GskQuadVertex *mapped_vertices;
+  guint n_mapped_vertices;
+  guint max_mapped_vertices;
+  guint vertices_overflowed : 1;
+
+  /* Whether ops_merge_draws() is going to be used; vertices are then
+   * kept in @vertices so they can be reordered */
+  guint merge_draws : 1;
+
+  /* Per-frame data for the uniform buffer, currently only gradient
+   * color stops. Only used if use_uniform_buffers is set. */
+  GArray *uniform_data;
+  guint uniform_buffer_alignment;
+  guint max_gradient_stops;
+  guint use_uniform_buffers : 1;
+
   GskGLRenderer *renderer;
 
   /* Stack of modelview matrices */
@@ -247,6 +275,9 @@ void              ops_free               (RenderOpBuilder         *builder);
 void              ops_reset              (RenderOpBuilder         *builder);
 void              ops_push_debug_group    (RenderOpBuilder         *builder,
                                            const char              *text);
+void              ops_push_timed_debug_group (RenderOpBuilder      *builder,
+                                              const char           *text,
+                                              int                   gpu_region);
 void              ops_pop_debug_group     (RenderOpBuilder         *builder);
 
 void              ops_finish             (RenderOpBuilder         *builder);
@@ -341,6 +372,10 @@ void              ops_set_conic_gradient  (RenderOpBuilder        *self,
 
 GskQuadVertex *   ops_draw               (RenderOpBuilder        *builder,
                                           const GskQuadVertex     vertex_data[GL_N_VERTICES]);
+guint             ops_upload_vertices    (RenderOpBuilder        *builder);
+void              ops_merge_draws        (RenderOpBuilder        *builder,
+                                          guint                  *out_n_draws_before,
+                                          guint                  *out_n_draws_after);
 
 void              ops_offset             (RenderOpBuilder        *builder,
                                           float                   x,
@@ -3,9 +3,11 @@
 #include "gskglshaderbuilderprivate.h"
 
 #include "gskdebugprivate.h"
+#include "gskprivate.h"
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
+#include <string.h>
 
 void
 gsk_gl_shader_builder_init (GskGLShaderBuilder *self,
@@ -126,6 +128,120 @@ print_shader_info (const char *prefix,
     }
 }
 
+static gboolean
+program_binaries_supported (void)
+{
+  static int supported = -1;
+
+  if (supported < 0)
+    {
+      int n_formats = 0;
+
+      if (epoxy_gl_version () >= (epoxy_is_desktop_gl () ? 41 : 30) ||
+          epoxy_has_gl_extension ("GL_ARB_get_program_binary") ||
+          epoxy_has_gl_extension ("GL_OES_get_program_binary"))
+        glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+
+      supported = n_formats > 0;
+    }
+
+  return supported;
+}
+
+/* The cache key covers everything that goes into the program:
+ * the driver, since binaries are only valid for the driver that
+ * produced them, and all the source strings.
+ */
+static char *
+get_program_cache_path (const char * const *sources,
+                        const int          *lengths,
+                        guint               n_sources)
+{
+  GString *key;
+  char *path;
+  guint i;
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key, "%s\n%s\n%s\n",
+                          (const char *) glGetString (GL_VENDOR),
+                          (const char *) glGetString (GL_RENDERER),
+                          (const char *) glGetString (GL_VERSION));
+
+  for (i = 0; i < n_sources; i++)
+    {
+      gsize length = lengths[i] < 0 ? strlen (sources[i]) : lengths[i];
+
+      g_string_append_printf (key, "%" G_GSIZE_FORMAT ":", length);
+      g_string_append_len (key, sources[i], length);
+    }
+
+  path = gsk_shader_cache_get_path ("gl-programs", key->str);
+  g_string_free (key, TRUE);
+
+  return path;
+}
+
+/* Cache files hold the binary format, followed by the binary */
+static int
+load_cached_program (const char *path)
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+  guint32 format;
+  int program_id;
+  int status;
+
+  bytes = gsk_shader_cache_load (path);
+  if (bytes == NULL)
+    return -1;
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size <= sizeof (format))
+    {
+      g_bytes_unref (bytes);
+      return -1;
+    }
+
+  memcpy (&format, data, sizeof (format));
+
+  program_id = glCreateProgram ();
+  glProgramBinary (program_id, format, data + sizeof (format), size - sizeof (format));
+  g_bytes_unref (bytes);
+
+  /* Fails if the driver changed in a way our key doesn't catch */
+  glGetProgramiv (program_id, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE)
+    {
+      GSK_NOTE (SHADERS, g_message ("Discarding stale program binary %s", path));
+      glDeleteProgram (program_id);
+      return -1;
+    }
+
+  return program_id;
+}
+
+static void
+save_program (const char *path,
+              int         program_id)
+{
+  guint32 format;
+  guchar *data;
+  int length = 0;
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  data = g_malloc (sizeof (format) + length);
+  glGetProgramBinary (program_id, length, &length, (GLenum *) &format, data + sizeof (format));
+  memcpy (data, &format, sizeof (format));
+
+  gsk_shader_cache_save (path, data, sizeof (format) + length);
+
+  g_free (data);
+}
+
 int
 gsk_gl_shader_builder_create_program (GskGLShaderBuilder  *self,
                                       const char          *resource_path,
@@ -139,6 +255,7 @@ gsk_gl_shader_builder_create_program (GskGLShaderBuilder  *self,
   const char *source;
   const char *vertex_shader_start;
   const char *fragment_shader_start;
+  char *cache_path = NULL;
   int vertex_id;
   int fragment_id;
   int program_id = -1;
@@ -160,6 +277,39 @@ gsk_gl_shader_builder_create_program (GskGLShaderBuilder  *self,
   g_snprintf (version_buffer, sizeof (version_buffer),
               "#version %d\n", self->version);
 
+  if (program_binaries_supported ())
+    {
+      cache_path = get_program_cache_path ((const char *[]) {
+                                             version_buffer,
+                                             self->debugging ? "#define GSK_DEBUG 1\n" : "",
+                                             self->legacy ? "#define GSK_LEGACY 1\n" : "",
+                                             self->gl3 ? "#define GSK_GL3 1\n" : "",
+                                             self->gles ? "#define GSK_GLES 1\n" : "",
+                                             g_bytes_get_data (self->preamble, NULL),
+                                             g_bytes_get_data (self->vs_preamble, NULL),
+                                             g_bytes_get_data (self->fs_preamble, NULL),
+                                             vertex_shader_start,
+                                             extra_fragment_snippet ? extra_fragment_snippet : ""
+                                           },
+                                           (int[]) {
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             -1,
+                                             extra_fragment_snippet ? (int) extra_fragment_length : 0,
+                                           },
+                                           10);
+
+      program_id = load_cached_program (cache_path);
+      if (program_id >= 0)
+        goto out;
+    }
+
   vertex_id = glCreateShader (GL_VERTEX_SHADER);
   glShaderSource (vertex_id, 8,
                   (const char *[]) {
@@ -231,6 +381,8 @@ gsk_gl_shader_builder_create_program (GskGLShaderBuilder  *self,
   glAttachShader (program_id, fragment_id);
   glBindAttribLocation (program_id, 0, "aPosition");
   glBindAttribLocation (program_id, 1, "vUv");
+  if (cache_path)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram (program_id);
   glDetachShader (program_id, vertex_id);
   glDetachShader (program_id, fragment_id);
@@ -255,11 +407,16 @@ gsk_gl_shader_builder_create_program (GskGLShaderBuilder  *self,
       glDeleteProgram (program_id);
       program_id = -1;
     }
+  else if (cache_path)
+    {
+      save_program (cache_path, program_id);
+    }
 
   glDeleteShader (vertex_id);
   glDeleteShader (fragment_id);
 
 out:
+  g_free (cache_path);
   g_bytes_unref (source_bytes);
 
   return program_id;
@@ -0,0 +1,246 @@
+#include "config.h"
+
+#include "gskglshaderchildcacheprivate.h"
+#include "gskdebugprivate.h"
+#include "gskrendernodeprivate.h"
+
+/* Shader child cache
+ *
+ * GL shader nodes need their children as textures. Effects like
+ * ripples or page curls animate the shader arguments over children
+ * that don't change, but the snapshot that creates the shader node
+ * usually creates new child nodes every frame, too.
+ *
+ * So we remember the texture of each child of a shader node, keyed
+ * by the shader, the position of the child, the bounds of the node
+ * and the scale. When a new child node shows up for the same key,
+ * the old and new child are diffed, and the texture is reused if
+ * they draw the same.
+ *
+ * Textures that have not been used for a while are dropped.
+ */
+
+#define MAX_UNUSED_FRAMES 10
+
+typedef struct
+{
+  GskGLShader *shader;
+  guint child_index;
+  graphene_rect_t bounds;
+  float scale_x;
+  float scale_y;
+} ShaderChildKey;
+
+typedef struct
+{
+  ShaderChildKey key;
+  GskRenderNode *child; /* owned, so the pointer can't be reused */
+  int texture_id;
+  guint64 last_used;
+} ShaderChild;
+
+static guint
+shader_child_key_hash (gconstpointer data)
+{
+  const ShaderChildKey *key = data;
+
+  return g_direct_hash (key->shader) ^
+         key->child_index ^
+         (guint) (int) (key->bounds.origin.x * 16) ^
+         ((guint) (int) (key->bounds.origin.y * 16) << 8) ^
+         ((guint) (int) (key->bounds.size.width * 16) << 16) ^
+         ((guint) (int) (key->bounds.size.height * 16) << 24) ^
+         (guint) (int) (key->scale_x * 16) ^
+         ((guint) (int) (key->scale_y * 16) << 8);
+}
+
+static gboolean
+shader_child_key_equal (gconstpointer a,
+                        gconstpointer b)
+{
+  const ShaderChildKey *ka = a;
+  const ShaderChildKey *kb = b;
+
+  return ka->shader == kb->shader &&
+         ka->child_index == kb->child_index &&
+         graphene_rect_equal (&ka->bounds, &kb->bounds) &&
+         ka->scale_x == kb->scale_x &&
+         ka->scale_y == kb->scale_y;
+}
+
+static void
+shader_child_free (gpointer data)
+{
+  ShaderChild *child = data;
+
+  g_object_unref (child->key.shader);
+  gsk_render_node_unref (child->child);
+  g_free (child);
+}
+
+static void
+shader_child_key_init (ShaderChildKey *key,
+                       GskRenderNode  *node,
+                       guint           child_index,
+                       float           scale_x,
+                       float           scale_y)
+{
+  key->shader = gsk_gl_shader_node_get_shader (node);
+  key->child_index = child_index;
+  key->bounds = node->bounds;
+  key->scale_x = scale_x;
+  key->scale_y = scale_y;
+}
+
+/* Whether @a and @b produce the same pixels */
+static gboolean
+child_nodes_draw_the_same (GskRenderNode *a,
+                           GskRenderNode *b)
+{
+  cairo_region_t *region;
+  gboolean same;
+
+  if (a == b)
+    return TRUE;
+
+  if (!graphene_rect_equal (&a->bounds, &b->bounds))
+    return FALSE;
+
+  region = cairo_region_create ();
+  gsk_render_node_diff (a, b, region);
+  same = cairo_region_is_empty (region);
+  cairo_region_destroy (region);
+
+  return same;
+}
+
+void
+gsk_gl_shader_child_cache_init (GskGLShaderChildCache *self)
+{
+  self->children = g_hash_table_new_full (shader_child_key_hash,
+                                          shader_child_key_equal,
+                                          NULL,
+                                          shader_child_free);
+  self->timestamp = 0;
+}
+
+void
+gsk_gl_shader_child_cache_free (GskGLShaderChildCache *self,
+                                GskGLDriver           *gl_driver)
+{
+  GHashTableIter iter;
+  ShaderChild *child;
+
+  g_hash_table_iter_init (&iter, self->children);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&child))
+    gsk_gl_driver_destroy_texture (gl_driver, child->texture_id);
+
+  g_clear_pointer (&self->children, g_hash_table_unref);
+}
+
+void
+gsk_gl_shader_child_cache_begin_frame (GskGLShaderChildCache *self,
+                                       GskGLDriver           *gl_driver)
+{
+  GHashTableIter iter;
+  ShaderChild *child;
+  guint dropped = 0;
+
+  self->timestamp++;
+
+  g_hash_table_iter_init (&iter, self->children);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&child))
+    {
+      if (self->timestamp - child->last_used > MAX_UNUSED_FRAMES)
+        {
+          gsk_gl_driver_destroy_texture (gl_driver, child->texture_id);
+          g_hash_table_iter_remove (&iter);
+          dropped++;
+        }
+    }
+
+  GSK_NOTE (OPENGL, if (dropped > 0) g_message ("Dropped %u shader children, %u left",
+                                                dropped, g_hash_table_size (self->children)));
+}
+
+/* Returns the texture for the @child_index'th child of @node, or 0
+ * if it needs to be drawn.
+ */
+int
+gsk_gl_shader_child_cache_get_texture_id (GskGLShaderChildCache *self,
+                                          GskGLDriver           *gl_driver,
+                                          GskRenderNode         *node,
+                                          guint                  child_index,
+                                          float                  scale_x,
+                                          float                  scale_y)
+{
+  GskRenderNode *child_node = gsk_gl_shader_node_get_child (node, child_index);
+  ShaderChildKey key;
+  ShaderChild *child;
+
+  shader_child_key_init (&key, node, child_index, scale_x, scale_y);
+
+  child = g_hash_table_lookup (self->children, &key);
+  if (child == NULL)
+    return 0;
+
+  if (child->child != child_node)
+    {
+      /* Another node with the same key may have used it in this
+       * frame already, and drawn differently */
+      if (child->last_used == self->timestamp)
+        return 0;
+
+      if (!child_nodes_draw_the_same (child->child, child_node))
+        {
+          gsk_gl_driver_destroy_texture (gl_driver, child->texture_id);
+          g_hash_table_remove (self->children, &key);
+          return 0;
+        }
+
+      gsk_render_node_unref (child->child);
+      child->child = gsk_render_node_ref (child_node);
+    }
+
+  child->last_used = self->timestamp;
+
+  return child->texture_id;
+}
+
+void
+gsk_gl_shader_child_cache_commit (GskGLShaderChildCache *self,
+                                  GskGLDriver           *gl_driver,
+                                  GskRenderNode         *node,
+                                  guint                  child_index,
+                                  float                  scale_x,
+                                  float                  scale_y,
+                                  int                    texture_id)
+{
+  ShaderChild *child;
+  ShaderChildKey key;
+
+  g_assert (texture_id > 0);
+
+  /* If the old texture is in use in this frame, the new one just
+   * stays a regular offscreen that the driver collects. */
+  shader_child_key_init (&key, node, child_index, scale_x, scale_y);
+  child = g_hash_table_lookup (self->children, &key);
+  if (child != NULL)
+    {
+      if (child->last_used == self->timestamp)
+        return;
+
+      gsk_gl_driver_destroy_texture (gl_driver, child->texture_id);
+      g_hash_table_remove (self->children, &key);
+    }
+
+  child = g_new0 (ShaderChild, 1);
+  child->key = key;
+  g_object_ref (child->key.shader);
+  child->child = gsk_render_node_ref (gsk_gl_shader_node_get_child (node, child_index));
+  child->texture_id = texture_id;
+  child->last_used = self->timestamp;
+
+  gsk_gl_driver_mark_texture_permanent (gl_driver, texture_id);
+  g_hash_table_insert (self->children, &child->key, child);
+}
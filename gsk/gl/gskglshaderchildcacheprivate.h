@@ -0,0 +1,37 @@
+#ifndef __GSK_GL_SHADER_CHILD_CACHE_H__
+#define __GSK_GL_SHADER_CHILD_CACHE_H__
+
+#include <glib.h>
+#include "gskgldriverprivate.h"
+#include "gskglshader.h"
+#include "gskrendernode.h"
+
+typedef struct
+{
+  GHashTable *children; /* ShaderChildKey -> ShaderChild */
+
+  guint64 timestamp;
+} GskGLShaderChildCache;
+
+
+void gsk_gl_shader_child_cache_init           (GskGLShaderChildCache *self);
+void gsk_gl_shader_child_cache_free           (GskGLShaderChildCache *self,
+                                               GskGLDriver           *gl_driver);
+void gsk_gl_shader_child_cache_begin_frame    (GskGLShaderChildCache *self,
+                                               GskGLDriver           *gl_driver);
+int  gsk_gl_shader_child_cache_get_texture_id (GskGLShaderChildCache *self,
+                                               GskGLDriver           *gl_driver,
+                                               GskRenderNode         *node,
+                                               guint                  child_index,
+                                               float                  scale_x,
+                                               float                  scale_y);
+void gsk_gl_shader_child_cache_commit         (GskGLShaderChildCache *self,
+                                               GskGLDriver           *gl_driver,
+                                               GskRenderNode         *node,
+                                               guint                  child_index,
+                                               float                  scale_x,
+                                               float                  scale_y,
+                                               int                    texture_id);
+
+
+#endif
@@ -25,6 +25,9 @@ gsk_gl_texture_atlases_new (void)
 
   self = g_new (GskGLTextureAtlases, 1);
   self->atlases = g_ptr_array_new_with_free_func (free_atlas);
+  self->retired = g_ptr_array_new_with_free_func (free_atlas);
+  self->copy_framebuffer = 0;
+  self->n_relocated = 0;
 
   self->ref_count = 1;
 
@@ -47,6 +50,9 @@ gsk_gl_texture_atlases_unref (GskGLTextureAtlases *self)
   if (self->ref_count == 1)
     {
       g_ptr_array_unref (self->atlases);
+      g_ptr_array_unref (self->retired);
+      if (self->copy_framebuffer != 0)
+        glDeleteFramebuffers (1, &self->copy_framebuffer);
       g_free (self);
       return;
     }
@@ -73,31 +79,46 @@ write_atlas_to_png (GskGLTextureAtlas *atlas,
 }
 #endif
 
+/* Retires at most one atlas per frame, the most fragmented one, to
+ * spread the cost of moving its entries over several frames. The
+ * retired atlas is added to @removed; caches are expected to move
+ * the entries they still use out of it with
+ * gsk_gl_texture_atlases_relocate() and drop the others.
+ */
 void
 gsk_gl_texture_atlases_begin_frame (GskGLTextureAtlases *self,
                                     GPtrArray           *removed)
 {
+  GskGLTextureAtlas *retire = NULL;
+  guint retire_index = 0;
+  double max_ratio = MAX_OLD_RATIO;
   int i;
 
-  for (i = self->atlases->len - 1; i >= 0; i--)
+  /* Everything that was still needed has been copied out by now */
+  g_ptr_array_set_size (self->retired, 0);
+  self->n_relocated = 0;
+
+  for (i = 0; i < self->atlases->len; i++)
     {
       GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i);
+      double ratio = gsk_gl_texture_atlas_get_unused_ratio (atlas);
 
-      if (gsk_gl_texture_atlas_get_unused_ratio (atlas) > MAX_OLD_RATIO)
+      if (ratio > max_ratio)
         {
-          GSK_NOTE(GLYPH_CACHE,
-                   g_message ("Dropping atlas %d (%g.2%% old)", i,
-                              100.0 * gsk_gl_texture_atlas_get_unused_ratio (atlas)));
+          retire = atlas;
+          retire_index = i;
+          max_ratio = ratio;
+        }
+    }
 
-          if (atlas->texture_id != 0)
-            {
-              glDeleteTextures (1, &atlas->texture_id);
-              atlas->texture_id = 0;
-            }
+  if (retire != NULL)
+    {
+      GSK_NOTE(GLYPH_CACHE,
+               g_message ("Compacting atlas %d (%g.2%% old)", retire_index,
+                          100.0 * max_ratio));
 
-          g_ptr_array_add (removed, atlas);
-          g_ptr_array_remove_index (self->atlases, i);
-       }
+      g_ptr_array_add (removed, retire);
+      g_ptr_array_add (self->retired, g_ptr_array_steal_index (self->atlases, retire_index));
     }
 
   GSK_NOTE(GLYPH_CACHE, {
@@ -132,6 +153,7 @@ gsk_gl_texture_atlases_begin_frame (GskGLTextureAtlases *self,
 
 gboolean
 gsk_gl_texture_atlases_pack (GskGLTextureAtlases *self,
+                             GLenum               format,
                              int                  width,
                              int                  height,
                              GskGLTextureAtlas  **atlas_out,
@@ -151,7 +173,8 @@ gsk_gl_texture_atlases_pack (GskGLTextureAtlases *self,
     {
       atlas = g_ptr_array_index (self->atlases, i);
 
-      if (gsk_gl_texture_atlas_pack (atlas, width, height, &x, &y))
+      if (atlas->format == format &&
+          gsk_gl_texture_atlas_pack (atlas, width, height, &x, &y))
         break;
 
       atlas = NULL;
@@ -161,7 +184,7 @@ gsk_gl_texture_atlases_pack (GskGLTextureAtlases *self,
     {
       /* No atlas has enough space, so create a new one... */
       atlas = g_malloc (sizeof (GskGLTextureAtlas));
-      gsk_gl_texture_atlas_init (atlas, ATLAS_SIZE, ATLAS_SIZE);
+      gsk_gl_texture_atlas_init (atlas, format, ATLAS_SIZE, ATLAS_SIZE);
       gsk_gl_texture_atlas_realize (atlas);
       g_ptr_array_add (self->atlases, atlas);
 
@@ -169,7 +192,8 @@ gsk_gl_texture_atlases_pack (GskGLTextureAtlases *self,
       if (!gsk_gl_texture_atlas_pack (atlas, width, height, &x, &y))
         g_assert_not_reached ();
 
-      GSK_NOTE(GLYPH_CACHE, g_message ("adding new atlas"));
+      GSK_NOTE(GLYPH_CACHE, g_message ("adding new %s atlas",
+                                       format == GL_R8 ? "mask" : "color"));
     }
 
   *atlas_out = atlas;
@@ -179,14 +203,106 @@ gsk_gl_texture_atlases_pack (GskGLTextureAtlases *self,
   return TRUE;
 }
 
+/* Copies a rectangle between atlases of the same format, on the GPU */
+static void
+copy_rect (GskGLTextureAtlases     *self,
+           const GskGLTextureAtlas *from,
+           int                      from_x,
+           int                      from_y,
+           const GskGLTextureAtlas *to,
+           int                      to_x,
+           int                      to_y,
+           int                      width,
+           int                      height)
+{
+  int prev_framebuffer;
+
+  g_assert (from->format == to->format);
+
+  if (epoxy_gl_version () >= (epoxy_is_desktop_gl () ? 43 : 32) ||
+      epoxy_has_gl_extension ("GL_ARB_copy_image"))
+    {
+      glCopyImageSubData (from->texture_id, GL_TEXTURE_2D, 0, from_x, from_y, 0,
+                          to->texture_id, GL_TEXTURE_2D, 0, to_x, to_y, 0,
+                          width, height, 1);
+      return;
+    }
+
+  glGetIntegerv (GL_FRAMEBUFFER_BINDING, &prev_framebuffer);
+
+  if (self->copy_framebuffer == 0)
+    glGenFramebuffers (1, &self->copy_framebuffer);
+
+  glBindFramebuffer (GL_FRAMEBUFFER, self->copy_framebuffer);
+  glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, from->texture_id, 0);
+
+  glBindTexture (GL_TEXTURE_2D, to->texture_id);
+  glCopyTexSubImage2D (GL_TEXTURE_2D, 0, to_x, to_y, from_x, from_y, width, height);
+  glBindTexture (GL_TEXTURE_2D, 0);
+
+  glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+  glBindFramebuffer (GL_FRAMEBUFFER, prev_framebuffer);
+}
+
+/* Moves the @width x @height rectangle at @x, @y in the retired
+ * atlas @from to a live atlas of the same format, without going
+ * through the CPU.
+ */
+void
+gsk_gl_texture_atlases_relocate (GskGLTextureAtlases *self,
+                                 GskGLTextureAtlas   *from,
+                                 int                  x,
+                                 int                  y,
+                                 int                  width,
+                                 int                  height,
+                                 GskGLTextureAtlas  **atlas_out,
+                                 int                 *out_x,
+                                 int                 *out_y)
+{
+  g_assert (g_ptr_array_find (self->retired, from, NULL));
+
+  gsk_gl_texture_atlases_pack (self, from->format, width, height, atlas_out, out_x, out_y);
+  copy_rect (self, from, x, y, *atlas_out, *out_x, *out_y, width, height);
+
+  self->n_relocated++;
+}
+
+/* Returns the number of live atlases, the percentage of their space
+ * holding entries that are still in use, and the number of entries
+ * moved out of retired atlases during this frame.
+ */
+void
+gsk_gl_texture_atlases_get_stats (GskGLTextureAtlases *self,
+                                  guint               *n_atlases,
+                                  guint               *occupancy,
+                                  guint               *n_relocated)
+{
+  gint64 total = 0, used = 0;
+  guint i;
+
+  for (i = 0; i < self->atlases->len; i++)
+    {
+      const GskGLTextureAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+      total += atlas->width * atlas->height;
+      used += atlas->packed_pixels - atlas->unused_pixels;
+    }
+
+  *n_atlases = self->atlases->len;
+  *occupancy = total > 0 ? (guint) (100 * MAX (used, 0) / total) : 0;
+  *n_relocated = self->n_relocated;
+}
+
 void
 gsk_gl_texture_atlas_init (GskGLTextureAtlas *self,
+                           GLenum             format,
                            int                width,
                            int                height)
 {
   memset (self, 0, sizeof (*self));
 
   self->texture_id = 0;
+  self->format = format;
   self->width = width;
   self->height = height;
 
@@ -253,6 +369,7 @@ gsk_gl_texture_atlas_pack (GskGLTextureAtlas *self,
     {
       *out_x = rect.x;
       *out_y = rect.y;
+      self->packed_pixels += width * height;
     }
 
   return rect.was_packed;
@@ -272,8 +389,9 @@ gsk_gl_texture_atlas_get_unused_ratio (const GskGLTextureAtlas *self)
  * the display gets closed.
  */
 static guint
-create_shared_texture (int width,
-                       int height)
+create_shared_texture (GLenum format,
+                       int    width,
+                       int    height)
 {
   guint texture_id;
 
@@ -286,7 +404,19 @@ create_shared_texture (int width,
   glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  if (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
+  if (format == GL_R8)
+    {
+      /* Single channel coverage masks. Swizzle the coverage into all
+       * four channels, so sampling them gives the same premultiplied
+       * white as an RGBA atlas would, and shaders don't have to care.
+       */
+      glTexImage2D (GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_RED);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+    }
+  else if (gdk_gl_context_get_use_es (gdk_gl_context_get_current ()))
     glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
   else
     glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
@@ -302,7 +432,7 @@ gsk_gl_texture_atlas_realize (GskGLTextureAtlas *atlas)
   if (atlas->texture_id)
     return;
 
-  atlas->texture_id = create_shared_texture (atlas->width, atlas->height);
+  atlas->texture_id = create_shared_texture (atlas->format, atlas->width, atlas->height);
   gdk_gl_context_label_object_printf (gdk_gl_context_get_current (),
                                       GL_TEXTURE, atlas->texture_id,
                                       "Texture atlas %d", atlas->texture_id);
@@ -5,6 +5,7 @@
 #include "stb_rect_pack.h"
 #include "gskglimageprivate.h"
 #include "gskgldriverprivate.h"
+#include <epoxy/gl.h>
 
 struct _GskGLTextureAtlas
 {
@@ -15,9 +16,11 @@ struct _GskGLTextureAtlas
   int height;
 
   guint texture_id;
+  GLenum format; /* GL_RGBA8, or GL_R8 for coverage masks */
 
   int unused_pixels; /* Pixels of rects that have been used at some point,
                         But are now unused. */
+  int packed_pixels; /* Pixels of all rects packed so far */
 
   void *user_data;
 };
@@ -28,6 +31,13 @@ struct _GskGLTextureAtlases
   int ref_count;
 
   GPtrArray *atlases;
+
+  /* Atlases whose entries are being moved to other atlases. They
+   * are kept alive until the next frame, so the caches can copy
+   * live entries out of them. */
+  GPtrArray *retired;
+  guint copy_framebuffer;
+  guint n_relocated;
 };
 typedef struct _GskGLTextureAtlases GskGLTextureAtlases;
 
@@ -38,13 +48,28 @@ void                 gsk_gl_texture_atlases_unref       (GskGLTextureAtlases *at
 void                 gsk_gl_texture_atlases_begin_frame (GskGLTextureAtlases *atlases,
                                                          GPtrArray           *removed);
 gboolean             gsk_gl_texture_atlases_pack        (GskGLTextureAtlases *atlases,
+                                                         GLenum               format,
+                                                         int                  width,
+                                                         int                  height,
+                                                         GskGLTextureAtlas  **atlas_out,
+                                                         int                 *out_x,
+                                                         int                 *out_y);
+void                 gsk_gl_texture_atlases_relocate    (GskGLTextureAtlases *atlases,
+                                                         GskGLTextureAtlas   *from,
+                                                         int                  x,
+                                                         int                  y,
                                                          int                  width,
                                                          int                  height,
                                                          GskGLTextureAtlas  **atlas_out,
                                                          int                 *out_x,
                                                          int                 *out_y);
+void                 gsk_gl_texture_atlases_get_stats   (GskGLTextureAtlases *atlases,
+                                                         guint               *n_atlases,
+                                                         guint               *occupancy,
+                                                         guint               *n_relocated);
 
 void        gsk_gl_texture_atlas_init              (GskGLTextureAtlas       *self,
+                                                    GLenum                   format,
                                                     int                      width,
                                                     int                      height);
 
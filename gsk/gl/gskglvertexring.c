@@ -0,0 +1,249 @@
+#include "config.h"
+
+#include "gskglvertexringprivate.h"
+
+#include "gdk/gdkglcontextprivate.h"
+
+#include <string.h>
+
+/* 64k vertices, i.e. 1MB per segment for the initial allocation */
+#define INITIAL_SEGMENT_VERTICES (1 << 16)
+
+#define PERSISTENT_MAP_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+static void
+setup_vertex_attributes (void)
+{
+  /* 0 = position location */
+  glEnableVertexAttribArray (0);
+  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
+                         sizeof (GskQuadVertex),
+                         (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
+  /* 1 = texture coord location */
+  glEnableVertexAttribArray (1);
+  glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
+                         sizeof (GskQuadVertex),
+                         (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
+}
+
+static void
+clear_fences (GskGLVertexRing *self)
+{
+  guint i;
+
+  for (i = 0; i < GSK_GL_VERTEX_RING_N_SEGMENTS; i++)
+    {
+      if (self->fences[i] != NULL)
+        {
+          glDeleteSync (self->fences[i]);
+          self->fences[i] = NULL;
+        }
+    }
+}
+
+/* (Re-)creates the persistently mapped buffer backing all segments.
+ * Buffer storage is immutable, so growing means starting over with
+ * a new buffer. The old one is released by the driver once the GPU
+ * is done with it.
+ */
+static void
+allocate_persistent_buffer (GskGLVertexRing *self,
+                            guint            n_segment_vertices)
+{
+  const gsize size = (gsize) n_segment_vertices * GSK_GL_VERTEX_RING_N_SEGMENTS * sizeof (GskQuadVertex);
+
+  glBindVertexArray (self->vao_id);
+
+  if (self->buffer_id != 0)
+    {
+      glBindBuffer (GL_ARRAY_BUFFER, self->buffer_id);
+      if (self->mapped != NULL)
+        glUnmapBuffer (GL_ARRAY_BUFFER);
+      glDeleteBuffers (1, &self->buffer_id);
+    }
+
+  clear_fences (self);
+
+  glGenBuffers (1, &self->buffer_id);
+  glBindBuffer (GL_ARRAY_BUFFER, self->buffer_id);
+  glBufferStorage (GL_ARRAY_BUFFER, size, NULL, PERSISTENT_MAP_FLAGS);
+  self->mapped = glMapBufferRange (GL_ARRAY_BUFFER, 0, size, PERSISTENT_MAP_FLAGS);
+  setup_vertex_attributes ();
+
+  self->n_segment_vertices = n_segment_vertices;
+  self->current_segment = 0;
+  self->segment_in_use = FALSE;
+}
+
+static void
+wait_for_segment (GskGLVertexRing *self,
+                  guint            segment)
+{
+  GLsync fence = self->fences[segment];
+  GLenum status;
+
+  if (fence == NULL)
+    return;
+
+  do
+    status = glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, G_TIME_SPAN_SECOND * 1000);
+  while (status == GL_TIMEOUT_EXPIRED);
+
+  glDeleteSync (fence);
+  self->fences[segment] = NULL;
+}
+
+void
+gsk_gl_vertex_ring_init (GskGLVertexRing *self,
+                         GdkGLContext    *context)
+{
+  memset (self, 0, sizeof (*self));
+
+  self->persistent = !gdk_gl_context_get_use_es (context) &&
+                     (epoxy_gl_version () >= 44 ||
+                      epoxy_has_gl_extension ("GL_ARB_buffer_storage"));
+
+  glGenVertexArrays (1, &self->vao_id);
+
+  if (self->persistent)
+    {
+      allocate_persistent_buffer (self, INITIAL_SEGMENT_VERTICES);
+
+      /* Mapping can fail on some drivers even when the extension
+       * is advertised. Fall back to orphaning in that case. */
+      if (self->mapped == NULL)
+        {
+          glDeleteBuffers (1, &self->buffer_id);
+          self->buffer_id = 0;
+          self->persistent = FALSE;
+        }
+    }
+
+  if (!self->persistent)
+    {
+      glBindVertexArray (self->vao_id);
+      glGenBuffers (1, &self->buffer_id);
+      glBindBuffer (GL_ARRAY_BUFFER, self->buffer_id);
+      setup_vertex_attributes ();
+      self->n_segment_vertices = 0;
+    }
+
+  glBindVertexArray (0);
+  glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+void
+gsk_gl_vertex_ring_free (GskGLVertexRing *self)
+{
+  if (self->buffer_id != 0)
+    {
+      if (self->mapped != NULL)
+        {
+          glBindBuffer (GL_ARRAY_BUFFER, self->buffer_id);
+          glUnmapBuffer (GL_ARRAY_BUFFER);
+          glBindBuffer (GL_ARRAY_BUFFER, 0);
+        }
+      glDeleteBuffers (1, &self->buffer_id);
+    }
+
+  clear_fences (self);
+
+  if (self->vao_id != 0)
+    glDeleteVertexArrays (1, &self->vao_id);
+
+  memset (self, 0, sizeof (*self));
+}
+
+/* Returns a pointer to the current segment of a persistently mapped
+ * ring, for callers to write vertex data straight into, or %NULL if
+ * the ring is not persistently mapped. Waits for the GPU to be done
+ * with the segment if it was used before.
+ */
+GskQuadVertex *
+gsk_gl_vertex_ring_map_segment (GskGLVertexRing *self,
+                                guint           *n_vertices)
+{
+  if (!self->persistent)
+    {
+      *n_vertices = 0;
+      return NULL;
+    }
+
+  wait_for_segment (self, self->current_segment);
+  self->segment_in_use = TRUE;
+
+  *n_vertices = self->n_segment_vertices;
+  return self->mapped + (gsize) self->current_segment * self->n_segment_vertices;
+}
+
+/* Makes @n_vertices available to subsequent draw calls and binds the
+ * ring's vertex array. Pass %NULL for @vertices if they have already
+ * been written to the segment returned by gsk_gl_vertex_ring_map_segment().
+ *
+ * Returns: the index of the first vertex, to be added to the offsets
+ *   passed to glDrawArrays().
+ */
+guint
+gsk_gl_vertex_ring_upload (GskGLVertexRing     *self,
+                           const GskQuadVertex *vertices,
+                           guint                n_vertices)
+{
+  glBindVertexArray (self->vao_id);
+  glBindBuffer (GL_ARRAY_BUFFER, self->buffer_id);
+
+  if (!self->persistent)
+    {
+      g_assert (vertices != NULL || n_vertices == 0);
+
+      if (n_vertices == 0)
+        return 0;
+
+      /* Orphan the previous storage so the driver does not have to
+       * wait for pending draws before we can write into it. */
+      glBufferData (GL_ARRAY_BUFFER, n_vertices * sizeof (GskQuadVertex), NULL, GL_STREAM_DRAW);
+      glBufferSubData (GL_ARRAY_BUFFER, 0, n_vertices * sizeof (GskQuadVertex), vertices);
+
+      return 0;
+    }
+
+  if (vertices != NULL && n_vertices > 0)
+    {
+      if (n_vertices > self->n_segment_vertices)
+        {
+          guint n_segment_vertices = self->n_segment_vertices;
+
+          while (n_segment_vertices < n_vertices)
+            n_segment_vertices *= 2;
+
+          allocate_persistent_buffer (self, n_segment_vertices);
+        }
+
+      if (!self->segment_in_use)
+        {
+          wait_for_segment (self, self->current_segment);
+          self->segment_in_use = TRUE;
+        }
+
+      memcpy (self->mapped + (gsize) self->current_segment * self->n_segment_vertices,
+              vertices,
+              n_vertices * sizeof (GskQuadVertex));
+    }
+
+  return self->current_segment * self->n_segment_vertices;
+}
+
+/* Marks the end of the draw calls using the current segment and
+ * moves on to the next one.
+ */
+void
+gsk_gl_vertex_ring_submit (GskGLVertexRing *self)
+{
+  if (!self->persistent || !self->segment_in_use)
+    return;
+
+  g_assert (self->fences[self->current_segment] == NULL);
+
+  self->fences[self->current_segment] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  self->current_segment = (self->current_segment + 1) % GSK_GL_VERTEX_RING_N_SEGMENTS;
+  self->segment_in_use = FALSE;
+}
@@ -0,0 +1,42 @@
+#ifndef __GSK_GL_VERTEX_RING_H__
+#define __GSK_GL_VERTEX_RING_H__
+
+#include <glib.h>
+#include <gdk/gdk.h>
+#include <epoxy/gl.h>
+
+#include "gskgldriverprivate.h"
+
+#define GSK_GL_VERTEX_RING_N_SEGMENTS 3
+
+typedef struct
+{
+  GLuint vao_id;
+  GLuint buffer_id;
+
+  /* Size of one segment, in vertices */
+  guint n_segment_vertices;
+  guint current_segment;
+
+  /* Persistent mapping of the whole buffer, or NULL if we have
+   * to fall back to orphaning the buffer on every upload */
+  GskQuadVertex *mapped;
+  GLsync fences[GSK_GL_VERTEX_RING_N_SEGMENTS];
+
+  guint persistent : 1;
+  guint segment_in_use : 1;
+} GskGLVertexRing;
+
+
+void            gsk_gl_vertex_ring_init         (GskGLVertexRing     *self,
+                                                 GdkGLContext        *context);
+void            gsk_gl_vertex_ring_free         (GskGLVertexRing     *self);
+GskQuadVertex * gsk_gl_vertex_ring_map_segment  (GskGLVertexRing     *self,
+                                                 guint               *n_vertices);
+guint           gsk_gl_vertex_ring_upload       (GskGLVertexRing     *self,
+                                                 const GskQuadVertex *vertices,
+                                                 guint                n_vertices);
+void            gsk_gl_vertex_ring_submit       (GskGLVertexRing     *self);
+
+
+#endif
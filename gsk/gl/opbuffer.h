@@ -138,6 +138,11 @@ typedef struct
 {
   gsize vao_offset;
   gsize vao_size;
+  /* The modelview at the time of the draw, if it is a 2D affine
+   * transform. Used to find the bounds of draws when merging. */
+  float scale[2];
+  float offset[2];
+  guint has_affine_transform : 1;
 } OpDraw;
 
 typedef struct
@@ -146,6 +151,7 @@ typedef struct
   IntUniformValue n_color_stops;
   float start_point[2];
   float end_point[2];
+  gssize uniform_offset; /* Of the color stops in the uniform buffer, or -1 */
 } OpLinearGradient;
 
 typedef struct
@@ -156,6 +162,7 @@ typedef struct
   float end;
   float radius[2];
   float center[2];
+  gssize uniform_offset; /* Of the color stops in the uniform buffer, or -1 */
 } OpRadialGradient;
 
 typedef struct
@@ -164,6 +171,7 @@ typedef struct
   IntUniformValue n_color_stops;
   float center[2];
   float rotation;
+  gssize uniform_offset; /* Of the color stops in the uniform buffer, or -1 */
 } OpConicGradient;
 
 typedef struct
@@ -202,6 +210,7 @@ typedef struct
 typedef struct
 {
   char text[64];
+  int gpu_region; /* GPU time is measured for the group if >= 0 */
 } OpDebugGroup;
 
 typedef struct
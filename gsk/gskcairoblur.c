@@ -156,33 +156,415 @@ blur_rows (guchar *dst_buffer,
     }
 }
 
-/* Swaps width and height.
+/* Column blurs
+ *
+ * Instead of transposing the buffer and blurring the columns as rows,
+ * we keep a running sum for every column and walk down the rows,
+ * adding the row that enters the window and removing the one that
+ * leaves it. This produces the same sums as blur_xspan(), but all the
+ * columns are independent, so a row is handled 16 pixels at a time
+ * with SSE2 or NEON and the buffer is only ever read row by row.
+ *
+ * The division is done by multiplying with a rounded up reciprocal,
+ * with a shift that is large enough for the result to be exactly the
+ * same as (sum + d / 2) / d for every sum that can occur.
  */
+#if defined(__GNUC__) && defined(__SSE2__)
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef struct
+{
+  guint32 half;
+  guint32 mul;
+  guint   shift;
+  /* mul and all sums fit into 16 bits */
+  gboolean narrow;
+} Divider;
+
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+divider_init (Divider *div,
+              int      d)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
-   */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  guint64 max_sum = 255 * d + d / 2;
+
+  div->half = d / 2;
+  div->shift = 16;
+  while (((guint64) 1 << div->shift) < max_sum * d)
+    div->shift++;
+  div->mul = (((guint64) 1 << div->shift) + d - 1) / d;
+  div->narrow = max_sum <= G_MAXUINT16 && div->mul <= G_MAXUINT16;
+}
+
+static inline guchar
+divider_apply (const Divider *div,
+               guint32        sum)
+{
+  return ((guint64) (sum + div->half) * div->mul) >> div->shift;
+}
+
+/* Adds @add to the sums, subtracts @sub and stores the result of
+ * the division in @dst */
+typedef void (* BlurColumnRowFunc) (guchar        *dst,
+                                    const guchar  *add,
+                                    const guchar  *sub,
+                                    gpointer       sums,
+                                    int            n,
+                                    const Divider *div);
+
+static void
+blur_column_row (guchar        *dst,
+                 const guchar  *add,
+                 const guchar  *sub,
+                 gpointer       sums_data,
+                 int            n,
+                 const Divider *div)
+{
+  guint32 *sums = sums_data;
+  int x;
+
+  for (x = 0; x < n; x++)
+    {
+      sums[x] += add[x] - sub[x];
+      dst[x] = divider_apply (div, sums[x]);
+    }
+}
+
+#if defined(HAVE_SSE2)
+static void
+blur_column_row_narrow (guchar        *dst,
+                        const guchar  *add,
+                        const guchar  *sub,
+                        gpointer       sums_data,
+                        int            n,
+                        const Divider *div)
+{
+  guint16 *sums = sums_data;
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i half = _mm_set1_epi16 (div->half);
+  const __m128i mul = _mm_set1_epi16 (div->mul);
+  const __m128i shift = _mm_cvtsi32_si128 (div->shift - 16);
+  int x;
+
+  for (x = 0; x + 16 <= n; x += 16)
+    {
+      __m128i a = _mm_loadu_si128 ((const __m128i *) (add + x));
+      __m128i s = _mm_loadu_si128 ((const __m128i *) (sub + x));
+      __m128i lo = _mm_loadu_si128 ((const __m128i *) (sums + x));
+      __m128i hi = _mm_loadu_si128 ((const __m128i *) (sums + x + 8));
+
+      lo = _mm_sub_epi16 (_mm_add_epi16 (lo, _mm_unpacklo_epi8 (a, zero)), _mm_unpacklo_epi8 (s, zero));
+      hi = _mm_sub_epi16 (_mm_add_epi16 (hi, _mm_unpackhi_epi8 (a, zero)), _mm_unpackhi_epi8 (s, zero));
+      _mm_storeu_si128 ((__m128i *) (sums + x), lo);
+      _mm_storeu_si128 ((__m128i *) (sums + x + 8), hi);
+
+      lo = _mm_srl_epi16 (_mm_mulhi_epu16 (_mm_add_epi16 (lo, half), mul), shift);
+      hi = _mm_srl_epi16 (_mm_mulhi_epu16 (_mm_add_epi16 (hi, half), mul), shift);
+      _mm_storeu_si128 ((__m128i *) (dst + x), _mm_packus_epi16 (lo, hi));
+    }
+
+  for (; x < n; x++)
+    {
+      sums[x] += add[x] - sub[x];
+      dst[x] = divider_apply (div, sums[x]);
+    }
+}
+#elif defined(HAVE_NEON)
+static inline uint16x8_t
+blur_divide_neon (uint16x8_t     sums,
+                  uint16x8_t     half,
+                  uint16x8_t     mul,
+                  int32x4_t      shift)
+{
+  uint16x8_t v = vaddq_u16 (sums, half);
+  uint32x4_t lo = vshlq_u32 (vmull_u16 (vget_low_u16 (v), vget_low_u16 (mul)), shift);
+  uint32x4_t hi = vshlq_u32 (vmull_high_u16 (v, mul), shift);
+
+  return vcombine_u16 (vmovn_u32 (lo), vmovn_u32 (hi));
+}
+
+static void
+blur_column_row_narrow (guchar        *dst,
+                        const guchar  *add,
+                        const guchar  *sub,
+                        gpointer       sums_data,
+                        int            n,
+                        const Divider *div)
+{
+  guint16 *sums = sums_data;
+  const uint16x8_t half = vdupq_n_u16 (div->half);
+  const uint16x8_t mul = vdupq_n_u16 (div->mul);
+  const int32x4_t shift = vdupq_n_s32 (- (int) div->shift);
+  int x;
+
+  for (x = 0; x + 16 <= n; x += 16)
+    {
+      uint8x16_t a = vld1q_u8 (add + x);
+      uint8x16_t s = vld1q_u8 (sub + x);
+      uint16x8_t lo = vld1q_u16 (sums + x);
+      uint16x8_t hi = vld1q_u16 (sums + x + 8);
+
+      lo = vsubw_u8 (vaddw_u8 (lo, vget_low_u8 (a)), vget_low_u8 (s));
+      hi = vsubw_high_u8 (vaddw_high_u8 (hi, a), s);
+      vst1q_u16 (sums + x, lo);
+      vst1q_u16 (sums + x + 8, hi);
+
+      vst1q_u8 (dst + x, vcombine_u8 (vmovn_u16 (blur_divide_neon (lo, half, mul, shift)),
+                                      vmovn_u16 (blur_divide_neon (hi, half, mul, shift))));
+    }
+
+  for (; x < n; x++)
+    {
+      sums[x] += add[x] - sub[x];
+      dst[x] = divider_apply (div, sums[x]);
+    }
+}
+#endif
+
+/* Blurs @n columns of @src into @dst, the equivalent of
+ * blur_xspan() for columns.
+ */
+static void
+blur_columns_pass (guchar       *dst,
+                   const guchar *src,
+                   gpointer      sums,
+                   const guchar *zeros,
+                   int           stride,
+                   int           height,
+                   int           n,
+                   int           d,
+                   int           shift)
+{
+  BlurColumnRowFunc row_func = blur_column_row;
+  Divider div;
+  int offset;
+  int i;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  divider_init (&div, d);
+
+#if defined(HAVE_SSE2) || defined(HAVE_NEON)
+  if (div.narrow)
+    {
+      row_func = blur_column_row_narrow;
+      memset (sums, 0, n * sizeof (guint16));
+    }
+  else
+#endif
+    memset (sums, 0, n * sizeof (guint32));
+
+  /* Fill the window with the rows above the first output row. The
+   * values stored here are overwritten below. */
+  for (i = 0; i < MIN (offset, height); i++)
+    row_func (dst + i * stride, src + i * stride, zeros, sums, n, &div);
+
+  for (i = 0; i < height; i++)
+    {
+      const guchar *add = i + offset < height ? src + (i + offset) * stride : zeros;
+      const guchar *sub = i + offset - d >= 0 ? src + (i + offset - d) * stride : zeros;
+
+      row_func (dst + i * stride, add, sub, sums, n, &div);
+    }
+}
+
+/* Blurs the @n columns starting at @buffer, using the same
+ * columns of @tmp_buffer as scratch space.
+ */
+static void
+blur_columns (guchar *buffer,
+              guchar *tmp_buffer,
+              int     stride,
+              int     height,
+              int     n,
+              int     d)
+{
+  guint32 *sums;
+  guchar *zeros;
+  int i;
+
+  sums = g_new (guint32, n);
+  zeros = g_malloc0 (n);
+
+  /* See blur_rows() */
+  if (d % 2 == 1)
+    {
+      blur_columns_pass (tmp_buffer, buffer, sums, zeros, stride, height, n, d, 0);
+      blur_columns_pass (buffer, tmp_buffer, sums, zeros, stride, height, n, d, 0);
+      blur_columns_pass (tmp_buffer, buffer, sums, zeros, stride, height, n, d, 0);
+    }
+  else
+    {
+      blur_columns_pass (tmp_buffer, buffer, sums, zeros, stride, height, n, d, 1);
+      blur_columns_pass (buffer, tmp_buffer, sums, zeros, stride, height, n, d, -1);
+      blur_columns_pass (tmp_buffer, buffer, sums, zeros, stride, height, n, d + 1, 0);
+    }
+
+  for (i = 0; i < height; i++)
+    memcpy (buffer + i * stride, tmp_buffer + i * stride, n);
+
+  g_free (zeros);
+  g_free (sums);
+}
+
+/* Big surfaces are split into bands of rows for the horizontal blur
+ * and strips of columns for the vertical one, which are blurred in
+ * a thread pool. The bands never overlap, so the result is the same
+ * as doing it all at once.
+ */
+#define MAX_BLUR_THREADS 8
+#define MIN_PIXELS_PER_BLUR_JOB (128 * 1024)
+
+typedef struct _BlurBatch BlurBatch;
+
+typedef struct
+{
+  BlurBatch *batch;
+  guchar *buffer;
+  guchar *tmp_buffer;
+  int stride;
+  int height;
+  int d;
+  /* A band of rows, or a strip of columns */
+  gboolean columns;
+  int start;
+  int end;
+} BlurJob;
+
+struct _BlurBatch
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+};
+
+static int max_blur_threads = 0;
+
+static void
+blur_job_run (BlurJob *job)
+{
+  if (job->columns)
+    blur_columns (job->buffer + job->start,
+                  job->tmp_buffer + job->start,
+                  job->stride, job->height,
+                  job->end - job->start,
+                  job->d);
+  else
+    blur_rows (job->buffer + job->start * job->stride,
+               job->tmp_buffer + job->start * job->stride,
+               job->stride,
+               job->end - job->start,
+               job->d);
+}
+
+static void
+blur_job_thread_func (gpointer data,
+                      gpointer user_data)
+{
+  BlurJob *job = data;
+  BlurBatch *batch = job->batch;
+
+  blur_job_run (job);
+
+  g_mutex_lock (&batch->lock);
+  batch->n_pending--;
+  if (batch->n_pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+static GThreadPool *
+get_blur_pool (void)
+{
+  static GThreadPool *pool;
+
+  /* Blurs can happen on the threads of the cairo renderer, too */
+  if (g_once_init_enter (&pool))
+    g_once_init_leave (&pool, g_thread_pool_new (blur_job_thread_func, NULL,
+                                                 MAX_BLUR_THREADS - 1, FALSE, NULL));
+
+  return pool;
+}
+
+static int
+get_n_blur_jobs (int stride,
+                 int height)
+{
+  int n_threads;
+
+  n_threads = max_blur_threads > 0 ? max_blur_threads : g_get_num_processors ();
+  n_threads = CLAMP (n_threads, 1, MAX_BLUR_THREADS);
+
+  return CLAMP ((int) ((gsize) stride * height / MIN_PIXELS_PER_BLUR_JOB), 1, n_threads);
+}
+
+static void
+blur_parallel (guchar   *buffer,
+               guchar   *tmp_buffer,
+               int       stride,
+               int       height,
+               int       d,
+               gboolean  columns)
+{
+  BlurBatch batch;
+  BlurJob *jobs;
+  int n_jobs, size, per_job;
+  int i;
+
+  n_jobs = get_n_blur_jobs (stride, height);
+  size = columns ? stride : height;
+  per_job = (size + n_jobs - 1) / n_jobs;
+  /* Keep column strips a multiple of the vector width */
+  if (columns)
+    per_job = (per_job + 15) & ~15;
+  n_jobs = (size + per_job - 1) / per_job;
+
+  jobs = g_newa (BlurJob, n_jobs);
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].batch = &batch;
+      jobs[i].buffer = buffer;
+      jobs[i].tmp_buffer = tmp_buffer;
+      jobs[i].stride = stride;
+      jobs[i].height = height;
+      jobs[i].d = d;
+      jobs[i].columns = columns;
+      jobs[i].start = i * per_job;
+      jobs[i].end = MIN (jobs[i].start + per_job, size);
+    }
+
+  if (n_jobs == 1)
+    {
+      blur_job_run (&jobs[0]);
+      return;
+    }
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_jobs - 1;
+
+  /* The first job is done on this thread while the pool does the rest */
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (get_blur_pool (), &jobs[i], NULL);
+
+  blur_job_run (&jobs[0]);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
 }
 
 static void
@@ -192,30 +574,31 @@ _boxblur (guchar      *buffer,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
+  guchar *tmp_buffer;
   int d = get_box_filter_size (radius);
 
-  flipped_buffer = g_malloc (width * height);
+  tmp_buffer = g_malloc (width * height);
 
   if (flags & GSK_BLUR_Y)
-    {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
-
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
-
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
-    }
+    blur_parallel (buffer, tmp_buffer, width, height, d, TRUE);
 
   if (flags & GSK_BLUR_X)
-    {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
-    }
+    blur_parallel (buffer, tmp_buffer, width, height, d, FALSE);
+
+  g_free (tmp_buffer);
+}
 
-  g_free (flipped_buffer);
+/*<private>
+ * gsk_cairo_blur_set_max_threads:
+ * @n_threads: the number of threads to use, or 0 for one per CPU
+ *
+ * Limits the number of threads used to blur big surfaces.
+ * This is meant for benchmarks and tests.
+ */
+void
+gsk_cairo_blur_set_max_threads (int n_threads)
+{
+  max_blur_threads = MAX (n_threads, 0);
 }
 
 /*
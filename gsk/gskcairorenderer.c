@@ -27,6 +27,10 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <pango/pangocairo.h>
+
+#define DEFAULT_TILE_SIZE 256
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark cpu_time;
@@ -40,6 +44,11 @@ struct _GskCairoRenderer
 
   GdkCairoContext *cairo_context;
 
+  /* tiled rendering, see GSK_CAIRO_THREADS */
+  guint n_threads;
+  int tile_size;
+  GThreadPool *tile_pool;
+
 #ifdef G_ENABLE_DEBUG
   ProfileTimers profile_timers;
 #endif
@@ -70,15 +79,275 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
 
   g_clear_object (&self->cairo_context);
+
+  if (self->tile_pool)
+    {
+      g_thread_pool_free (self->tile_pool, FALSE, TRUE);
+      self->tile_pool = NULL;
+    }
+}
+
+/* Checks whether @node can be drawn from several threads at the
+ * same time. Cairo nodes replay recording surfaces, which are not
+ * safe to share between threads, and textures that are not in
+ * memory need their context to be downloaded.
+ *
+ * Fonts set up their cairo scaled font lazily, so that is done
+ * here, in the main thread.
+ */
+static gboolean
+node_can_draw_in_threads (GskRenderNode *node)
+{
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        {
+          if (!node_can_draw_in_threads (gsk_container_node_get_child (node, i)))
+            return FALSE;
+        }
+      return TRUE;
+
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      return GDK_IS_MEMORY_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font = gsk_text_node_get_font (node);
+
+        if (!PANGO_IS_CAIRO_FONT (font))
+          return FALSE;
+
+        return pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)) != NULL;
+      }
+
+    case GSK_TRANSFORM_NODE:
+      return node_can_draw_in_threads (gsk_transform_node_get_child (node));
+
+    case GSK_OPACITY_NODE:
+      return node_can_draw_in_threads (gsk_opacity_node_get_child (node));
+
+    case GSK_COLOR_MATRIX_NODE:
+      return node_can_draw_in_threads (gsk_color_matrix_node_get_child (node));
+
+    case GSK_REPEAT_NODE:
+      return node_can_draw_in_threads (gsk_repeat_node_get_child (node));
+
+    case GSK_CLIP_NODE:
+      return node_can_draw_in_threads (gsk_clip_node_get_child (node));
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return node_can_draw_in_threads (gsk_rounded_clip_node_get_child (node));
+
+    case GSK_SHADOW_NODE:
+      return node_can_draw_in_threads (gsk_shadow_node_get_child (node));
+
+    case GSK_BLUR_NODE:
+      return node_can_draw_in_threads (gsk_blur_node_get_child (node));
+
+    case GSK_DEBUG_NODE:
+      return node_can_draw_in_threads (gsk_debug_node_get_child (node));
+
+    case GSK_BLEND_NODE:
+      return node_can_draw_in_threads (gsk_blend_node_get_bottom_child (node)) &&
+             node_can_draw_in_threads (gsk_blend_node_get_top_child (node));
+
+    case GSK_CROSS_FADE_NODE:
+      return node_can_draw_in_threads (gsk_cross_fade_node_get_start_child (node)) &&
+             node_can_draw_in_threads (gsk_cross_fade_node_get_end_child (node));
+
+    case GSK_CAIRO_NODE:
+    case GSK_GL_SHADER_NODE:
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      return FALSE;
+    }
 }
 
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} TileBatch;
+
+typedef struct {
+  TileBatch *batch;
+  GskRenderNode *root;
+  cairo_rectangle_int_t area;
+  double scale_x, scale_y;
+  cairo_surface_t *surface;
+} Tile;
+
 static void
-gsk_cairo_renderer_do_render (GskRenderer   *renderer,
-                              cairo_t       *cr,
-                              GskRenderNode *root)
+render_tile (gpointer data,
+             gpointer user_data)
+{
+  Tile *tile = data;
+  cairo_t *cr;
+
+  tile->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                              ceil (tile->area.width * tile->scale_x),
+                                              ceil (tile->area.height * tile->scale_y));
+  cairo_surface_set_device_scale (tile->surface, tile->scale_x, tile->scale_y);
+
+  cr = cairo_create (tile->surface);
+  cairo_translate (cr, - tile->area.x, - tile->area.y);
+  cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+  cairo_clip (cr);
+
+  gsk_render_node_draw (tile->root, cr);
+
+  cairo_destroy (cr);
+
+  g_mutex_lock (&tile->batch->lock);
+  tile->batch->n_pending--;
+  if (tile->batch->n_pending == 0)
+    g_cond_signal (&tile->batch->cond);
+  g_mutex_unlock (&tile->batch->lock);
+}
+
+/* Splits @region into tiles on a grid of tile_size, so that
+ * neighbouring rectangles of the region share tile boundaries.
+ */
+static GArray *
+create_tiles (GskCairoRenderer     *self,
+              const cairo_region_t *region)
+{
+  GArray *tiles;
+  int i, n;
+
+  tiles = g_array_new (FALSE, TRUE, sizeof (Tile));
+
+  n = cairo_region_num_rectangles (region);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x, y;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      for (y = rect.y - (rect.y % self->tile_size + self->tile_size) % self->tile_size;
+           y < rect.y + rect.height;
+           y += self->tile_size)
+        {
+          for (x = rect.x - (rect.x % self->tile_size + self->tile_size) % self->tile_size;
+               x < rect.x + rect.width;
+               x += self->tile_size)
+            {
+              Tile tile = { 0, };
+
+              tile.area.x = MAX (x, rect.x);
+              tile.area.y = MAX (y, rect.y);
+              tile.area.width = MIN (x + self->tile_size, rect.x + rect.width) - tile.area.x;
+              tile.area.height = MIN (y + self->tile_size, rect.y + rect.height) - tile.area.y;
+
+              g_array_append_val (tiles, tile);
+            }
+        }
+    }
+
+  return tiles;
+}
+
+/* Draws the parts of @root inside @region in tiles, on a pool
+ * of worker threads, and then puts the tiles together in @cr.
+ * This is only used when the tree can be drawn from several
+ * threads and when there is more than a single tile to draw.
+ */
+static gboolean
+gsk_cairo_renderer_render_tiled (GskCairoRenderer     *self,
+                                 cairo_t              *cr,
+                                 GskRenderNode        *root,
+                                 const cairo_region_t *region)
+{
+  TileBatch batch;
+  GArray *tiles;
+  double scale_x, scale_y;
+  guint i;
+
+  if (self->n_threads < 2 || region == NULL)
+    return FALSE;
+
+  tiles = create_tiles (self, region);
+  if (tiles->len < 2 || !node_can_draw_in_threads (root))
+    {
+      g_array_unref (tiles);
+      return FALSE;
+    }
+
+  if (self->tile_pool == NULL)
+    self->tile_pool = g_thread_pool_new (render_tile, NULL, self->n_threads, FALSE, NULL);
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &scale_x, &scale_y);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = tiles->len;
+
+  for (i = 0; i < tiles->len; i++)
+    {
+      Tile *tile = &g_array_index (tiles, Tile, i);
+
+      tile->batch = &batch;
+      tile->root = root;
+      tile->scale_x = scale_x;
+      tile->scale_y = scale_y;
+
+      g_thread_pool_push (self->tile_pool, tile, NULL);
+    }
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  cairo_save (cr);
+
+  for (i = 0; i < tiles->len; i++)
+    {
+      Tile *tile = &g_array_index (tiles, Tile, i);
+
+      cairo_set_source_surface (cr, tile->surface, tile->area.x, tile->area.y);
+      cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+      cairo_fill (cr);
+
+      cairo_surface_destroy (tile->surface);
+    }
+
+  cairo_restore (cr);
+
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), CAIRO,
+                     g_message ("Rendered %u tiles in %u threads", tiles->len, self->n_threads));
+
+  g_array_unref (tiles);
+
+  return TRUE;
+}
+
+static void
+gsk_cairo_renderer_do_render (GskRenderer          *renderer,
+                              cairo_t              *cr,
+                              GskRenderNode        *root,
+                              const cairo_region_t *region)
 {
-#ifdef G_ENABLE_DEBUG
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+#ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
 #endif
@@ -88,7 +357,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (!gsk_cairo_renderer_render_tiled (self, cr, root, region))
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -112,7 +382,7 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
 
   cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  gsk_cairo_renderer_do_render (renderer, cr, root, NULL);
 
   cairo_destroy (cr);
 
@@ -152,7 +422,8 @@ gsk_cairo_renderer_render (GskRenderer          *renderer,
     }
 #endif
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  gsk_cairo_renderer_do_render (renderer, cr, root,
+                                gdk_draw_context_get_frame_region (GDK_DRAW_CONTEXT (self->cairo_context)));
 
   cairo_destroy (cr);
 
@@ -173,11 +444,31 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 static void
 gsk_cairo_renderer_init (GskCairoRenderer *self)
 {
+  const char *env;
+
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
 #endif
+
+  self->n_threads = 1;
+  self->tile_size = DEFAULT_TILE_SIZE;
+
+  env = g_getenv ("GSK_CAIRO_THREADS");
+  if (env != NULL)
+    {
+      guint64 n_threads = g_ascii_strtoull (env, NULL, 10);
+
+      if (n_threads == 0)
+        n_threads = g_get_num_processors ();
+
+      self->n_threads = MIN (n_threads, 64);
+    }
+
+  env = g_getenv ("GSK_CAIRO_TILE_SIZE");
+  if (env != NULL)
+    self->tile_size = CLAMP (g_ascii_strtoll (env, NULL, 10), 32, 4096);
 }
 
 /**
@@ -467,8 +467,44 @@ gsk_diff (gconstpointer             *elem1,
 {
   gsize ndiags;
   gssize *kvd, *kvdf, *kvdb;
+  gssize off1, lim1, off2, lim2;
   GskDiffResult res;
 
+  /*
+   * Between two frames, usually only a few elements change and all the
+   * others are kept, so strip the common head and tail first. If that
+   * leaves nothing to compare, we don't need the diagonal vectors.
+   */
+  off1 = off2 = 0;
+  lim1 = n1;
+  lim2 = n2;
+
+  for (; off1 < lim1 && off2 < lim2; off1++, off2++)
+    {
+      if (settings->compare_func (elem1[off1], elem2[off2], data) != 0)
+        break;
+
+      settings->keep_func (elem1[off1], elem2[off2], data);
+    }
+
+  for (; off1 < lim1 && off2 < lim2; lim1--, lim2--)
+    {
+      if (settings->compare_func (elem1[lim1 - 1], elem2[lim2 - 1], data) != 0)
+        break;
+
+      settings->keep_func (elem1[lim1 - 1], elem2[lim2 - 1], data);
+    }
+
+  if (off1 == lim1 || off2 == lim2)
+    {
+      for (; off2 < lim2; off2++)
+        settings->insert_func (elem2[off2], off2, data);
+      for (; off1 < lim1; off1++)
+        settings->delete_func (elem1[off1], off1, data);
+
+      return GSK_DIFF_OK;
+    }
+
   ndiags = n1 + n2 + 3;
 
   kvd = g_new (gssize, 2 * ndiags + 2);
@@ -477,8 +513,8 @@ gsk_diff (gconstpointer             *elem1,
   kvdf += n2 + 1;
   kvdb += n2 + 1;
 
-  res = compare (elem1, 0, n1,
-                 elem2, 0, n2,
+  res = compare (elem1, off1, lim1,
+                 elem2, off2, lim2,
                  kvdf, kvdb, FALSE,
                  settings, data);
 
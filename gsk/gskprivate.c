@@ -1,6 +1,12 @@
+#include "config.h"
+
 #include "gskresources.h"
 #include "gskprivate.h"
 
+#include "gskdebugprivate.h"
+
+#include <glib/gstdio.h>
+
 static gpointer
 register_resources (gpointer data)
 {
@@ -35,3 +41,67 @@ pango_glyph_string_num_glyphs (PangoGlyphString *glyphs)
   return count;
 }
 
+/* Compiled shaders are cached in $XDG_CACHE_HOME/gtk-4.0/@kind/,
+ * in files named after a hash of @key and the GTK version. @key
+ * needs to identify both the shader sources and the driver that
+ * compiled them, since the blobs are only valid for that driver.
+ *
+ * Returns: the cache file path, or %NULL if caching is disabled
+ */
+char *
+gsk_shader_cache_get_path (const char *kind,
+                           const char *key)
+{
+  GChecksum *checksum;
+  char *filename;
+  char *path;
+
+  if (g_getenv ("GSK_NO_SHADER_CACHE"))
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) GTK_VERSION, -1);
+  g_checksum_update (checksum, (const guchar *) key, -1);
+  filename = g_strconcat (g_checksum_get_string (checksum), ".bin", NULL);
+  g_checksum_free (checksum);
+
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", kind, filename, NULL);
+  g_free (filename);
+
+  return path;
+}
+
+GBytes *
+gsk_shader_cache_load (const char *path)
+{
+  char *contents;
+  gsize length;
+
+  if (path == NULL ||
+      !g_file_get_contents (path, &contents, &length, NULL))
+    return NULL;
+
+  return g_bytes_new_take (contents, length);
+}
+
+void
+gsk_shader_cache_save (const char    *path,
+                       gconstpointer  data,
+                       gsize          size)
+{
+  GError *error = NULL;
+  char *dir;
+
+  if (path == NULL)
+    return;
+
+  dir = g_path_get_dirname (path);
+  g_mkdir_with_parents (dir, 0700);
+  g_free (dir);
+
+  if (!g_file_set_contents (path, data, size, &error))
+    {
+      GSK_NOTE (SHADERS, g_message ("Failed to write shader cache: %s", error->message));
+      g_error_free (error);
+    }
+}
@@ -10,6 +10,13 @@ void gsk_ensure_resources (void);
 
 int pango_glyph_string_num_glyphs (PangoGlyphString *glyphs);
 
+char *   gsk_shader_cache_get_path (const char    *kind,
+                                    const char    *key);
+GBytes * gsk_shader_cache_load     (const char    *path);
+void     gsk_shader_cache_save     (const char    *path,
+                                    gconstpointer  data,
+                                    gsize          size);
+
 typedef struct _GskVulkanRender GskVulkanRender;
 typedef struct _GskVulkanRenderPass GskVulkanRenderPass;
 
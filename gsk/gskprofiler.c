@@ -324,6 +324,32 @@ gsk_profiler_timer_set (GskProfiler *profiler,
   timer->value = value;
 }
 
+gboolean
+gsk_profiler_has_counter (GskProfiler *profiler,
+                          const char  *counter_name)
+{
+  GQuark id;
+
+  g_return_val_if_fail (GSK_IS_PROFILER (profiler), FALSE);
+
+  id = g_quark_try_string (counter_name);
+
+  return id != 0 && gsk_profiler_get_counter (profiler, id) != NULL;
+}
+
+gboolean
+gsk_profiler_has_timer (GskProfiler *profiler,
+                        const char  *timer_name)
+{
+  GQuark id;
+
+  g_return_val_if_fail (GSK_IS_PROFILER (profiler), FALSE);
+
+  id = g_quark_try_string (timer_name);
+
+  return id != 0 && gsk_profiler_get_timer (profiler, id) != NULL;
+}
+
 gint64
 gsk_profiler_counter_get (GskProfiler *profiler,
                           GQuark       counter_id)
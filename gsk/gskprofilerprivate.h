@@ -36,6 +36,11 @@ void            gsk_profiler_timer_set          (GskProfiler *profiler,
                                                  GQuark       timer_id,
                                                  gint64       value);
 
+gboolean        gsk_profiler_has_counter        (GskProfiler *profiler,
+                                                 const char  *counter_name);
+gboolean        gsk_profiler_has_timer          (GskProfiler *profiler,
+                                                 const char  *timer_name);
+
 gint64          gsk_profiler_counter_get        (GskProfiler *profiler,
                                                  GQuark       counter_id);
 gint64          gsk_profiler_timer_get          (GskProfiler *profiler,
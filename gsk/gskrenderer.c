@@ -42,6 +42,8 @@
 #include "gskprofilerprivate.h"
 #include "gskrendernodeprivate.h"
 
+#include "gdk/gdkframeclockprivate.h"
+
 #include "gskenumtypes.h"
 
 #include <graphene-gobject.h>
@@ -80,6 +82,14 @@ typedef struct
   GskRenderNode *root_node;
 
   GskProfiler *profiler;
+#ifdef G_ENABLE_DEBUG
+  struct {
+    GQuark diffed_nodes;
+  } profile_counters;
+  struct {
+    GQuark diff_time;
+  } profile_timers;
+#endif
 
   GskDebugFlags debug_flags;
 
@@ -210,6 +220,11 @@ gsk_renderer_init (GskRenderer *self)
 
   priv->profiler = gsk_profiler_new ();
   priv->debug_flags = gsk_get_debug_flags ();
+
+#ifdef G_ENABLE_DEBUG
+  priv->profile_counters.diffed_nodes = gsk_profiler_add_counter (priv->profiler, "diffed-nodes", "Nodes visited by diff", FALSE);
+  priv->profile_timers.diff_time = gsk_profiler_add_timer (priv->profiler, "diff-time", "Render node diff time", FALSE, FALSE);
+#endif
 }
 
 /**
@@ -410,7 +425,12 @@ gsk_renderer_render (GskRenderer          *renderer,
                      const cairo_region_t *region)
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  GdkFrameClock *frame_clock;
   cairo_region_t *clip;
+  gint64 render_start;
+#ifdef G_ENABLE_DEBUG
+  gint64 diff_start;
+#endif
 
   g_return_if_fail (GSK_IS_RENDERER (renderer));
   g_return_if_fail (priv->is_realized);
@@ -428,7 +448,17 @@ gsk_renderer_render (GskRenderer          *renderer,
   else
     {
       clip = cairo_region_copy (region);
+
+#ifdef G_ENABLE_DEBUG
+      diff_start = g_get_monotonic_time ();
+#endif
       gsk_render_node_diff (priv->prev_node, root, clip);
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_timer_set (priv->profiler, priv->profile_timers.diff_time,
+                              g_get_monotonic_time () - diff_start);
+      gsk_profiler_counter_set (priv->profiler, priv->profile_counters.diffed_nodes,
+                                gsk_render_node_get_n_diffed (TRUE));
+#endif
 
       if (cairo_region_is_empty (clip))
         {
@@ -439,8 +469,14 @@ gsk_renderer_render (GskRenderer          *renderer,
 
   priv->root_node = gsk_render_node_ref (root);
 
+  render_start = g_get_monotonic_time ();
+
   GSK_RENDERER_GET_CLASS (renderer)->render (renderer, root, clip);
 
+  frame_clock = gdk_surface_get_frame_clock (priv->surface);
+  if (frame_clock)
+    gdk_frame_clock_add_render_duration (frame_clock, g_get_monotonic_time () - render_start);
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
     {
@@ -42,8 +42,11 @@
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodebinaryprivate.h"
 #include "gskrendernodeparserprivate.h"
 
+#include "gdk/gdkmemorytextureprivate.h"
+
 #include <graphene-gobject.h>
 
 #include <math.h>
@@ -142,7 +145,7 @@ value_render_node_lcopy_value (const GValue *value,
 static void
 gsk_render_node_finalize (GskRenderNode *self)
 {
-  g_type_free_instance ((GTypeInstance *) self);
+  g_slice_free1 (GSK_RENDER_NODE_GET_CLASS (self)->instance_size, self);
 }
 
 static void
@@ -239,7 +242,9 @@ gsk_render_node_get_type (void)
 typedef struct
 {
   GskRenderNodeType node_type;
+  gsize instance_size;
 
+  void     (* instance_init) (GskRenderNode   *node);
   void     (* finalize) (GskRenderNode        *node);
   void     (* draw)     (GskRenderNode        *node,
                          cairo_t              *cr);
@@ -259,6 +264,8 @@ gsk_render_node_generic_class_init (gpointer g_class,
 
   /* Mandatory */
   node_class->node_type = node_data->node_type;
+  node_class->instance_size = node_data->instance_size;
+  node_class->instance_init = node_data->instance_init;
 
   /* Optional */
   if (node_data->finalize != NULL)
@@ -308,6 +315,8 @@ gsk_render_node_type_register_static (const char                  *node_name,
    */
   info.class_data = g_new (RenderNodeClassData, 1);
   ((RenderNodeClassData *) info.class_data)->node_type = node_info->node_type;
+  ((RenderNodeClassData *) info.class_data)->instance_size = node_info->instance_size;
+  ((RenderNodeClassData *) info.class_data)->instance_init = node_info->instance_init;
   ((RenderNodeClassData *) info.class_data)->finalize = node_info->finalize;
   ((RenderNodeClassData *) info.class_data)->draw = node_info->draw;
   ((RenderNodeClassData *) info.class_data)->can_diff = node_info->can_diff != NULL
@@ -325,22 +334,118 @@ gsk_render_node_type_register_static (const char                  *node_name,
   return g_type_register_static (GSK_TYPE_RENDER_NODE, node_name, &info, 0);
 }
 
+static GskRenderNodeClass *gsk_render_node_classes[GSK_RENDER_NODE_TYPE_N_TYPES];
+
 /*< private >
  * gsk_render_node_alloc:
  * @node_type: the #GskRenderNodeType to instantiate
  *
  * Instantiates a new #GskRenderNode for the given @node_type.
  *
+ * Nodes are created in large numbers for every frame, so this skips
+ * g_type_create_instance() and takes the memory from the slice
+ * allocator, which keeps a pool of same-sized chunks per node type.
+ * Render nodes have no instance private data and no GType instance
+ * init chain apart from the reference count, which is set up here.
+ *
  * Returns: (transfer full) (type GskRenderNode): the newly created #GskRenderNode
  */
 gpointer
 gsk_render_node_alloc (GskRenderNodeType node_type)
 {
+  GskRenderNodeClass *klass;
+  GskRenderNode *node;
+
   g_return_val_if_fail (node_type > GSK_NOT_A_RENDER_NODE, NULL);
   g_return_val_if_fail (node_type < GSK_RENDER_NODE_TYPE_N_TYPES, NULL);
 
   g_assert (gsk_render_node_types[node_type] != G_TYPE_INVALID);
-  return g_type_create_instance (gsk_render_node_types[node_type]);
+
+  klass = g_atomic_pointer_get (&gsk_render_node_classes[node_type]);
+  if (G_UNLIKELY (klass == NULL))
+    {
+      /* The class is never unreffed, so racing here only leaks a ref */
+      klass = g_type_class_ref (gsk_render_node_types[node_type]);
+      g_atomic_pointer_set (&gsk_render_node_classes[node_type], klass);
+    }
+
+  node = g_slice_alloc0 (klass->instance_size);
+  node->parent_instance.g_class = (GTypeClass *) klass;
+  g_atomic_ref_count_init (&node->ref_count);
+
+  if (klass->instance_init)
+    klass->instance_init (node);
+
+  return node;
+}
+
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+#define FNV_PRIME        1099511628211ull
+
+/*< private >
+ * gsk_render_node_hash_init:
+ * @node: a #GskRenderNode
+ *
+ * Starts computing the structural hash of @node, seeded with its
+ * type and bounds. Node constructors add in the rest of the node's
+ * data with gsk_render_node_hash_data() and gsk_render_node_hash_child()
+ * and store the result with gsk_render_node_set_hash().
+ *
+ * Only data that affects rendering may be hashed, and it must be
+ * hashed completely: nodes with equal hashes are not diffed.
+ *
+ * Returns: the initial hash value
+ */
+guint64
+gsk_render_node_hash_init (const GskRenderNode *node)
+{
+  GskRenderNodeType node_type = GSK_RENDER_NODE_GET_CLASS (node)->node_type;
+  guint64 hash = FNV_OFFSET_BASIS;
+
+  hash = gsk_render_node_hash_data (hash, &node_type, sizeof (node_type));
+  hash = gsk_render_node_hash_data (hash, &node->bounds, sizeof (node->bounds));
+
+  return hash;
+}
+
+guint64
+gsk_render_node_hash_data (guint64       hash,
+                           gconstpointer data,
+                           gsize         size)
+{
+  const guchar *bytes = data;
+  gsize i;
+
+  if (hash == 0)
+    return 0;
+
+  for (i = 0; i < size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= FNV_PRIME;
+    }
+
+  return hash;
+}
+
+/* Returns 0 if @child has no hash, so that its parent won't have
+ * one either.
+ */
+guint64
+gsk_render_node_hash_child (guint64              hash,
+                            const GskRenderNode *child)
+{
+  if (child->hash == 0)
+    return 0;
+
+  return gsk_render_node_hash_data (hash, &child->hash, sizeof (child->hash));
+}
+
+void
+gsk_render_node_set_hash (GskRenderNode *node,
+                          guint64        hash)
+{
+  node->hash = hash;
 }
 
 /**
@@ -523,6 +628,34 @@ gsk_render_node_diff_impossible (GskRenderNode  *node1,
   cairo_region_union_rectangle (region, &rect);
 }
 
+#ifdef G_ENABLE_DEBUG
+static guint n_diffed_nodes;
+#endif
+
+/*< private >
+ * gsk_render_node_get_n_diffed:
+ * @reset: whether to reset the count
+ *
+ * Returns the number of nodes gsk_render_node_diff() visited since the
+ * last reset, for profiling.
+ *
+ * Returns: the number of diffed nodes, or 0 in non-debug builds
+ */
+guint
+gsk_render_node_get_n_diffed (gboolean reset)
+{
+#ifdef G_ENABLE_DEBUG
+  guint n = n_diffed_nodes;
+
+  if (reset)
+    n_diffed_nodes = 0;
+
+  return n;
+#else
+  return 0;
+#endif
+}
+
 /**
  * gsk_render_node_diff:
  * @node1: a #GskRenderNode
@@ -545,15 +678,151 @@ gsk_render_node_diff (GskRenderNode  *node1,
                       GskRenderNode  *node2,
                       cairo_region_t *region)
 {
+#ifdef G_ENABLE_DEBUG
+  n_diffed_nodes++;
+#endif
+
   if (node1 == node2)
     return;
 
+  /* Hashes include the node type and all of the subtree, so equal
+   * hashes mean the subtrees render the same */
+  if (node1->hash != 0 && node1->hash == node2->hash)
+    return;
+
   if (_gsk_render_node_get_node_type (node1) != _gsk_render_node_get_node_type (node2))
     return gsk_render_node_diff_impossible (node1, node2, region);
 
   return GSK_RENDER_NODE_GET_CLASS (node1)->diff (node1, node2, region);
 }
 
+/* The largest rectangle inside @rounded that is not affected by
+ * the rounded corners */
+static gboolean
+rounded_rect_get_interior (const GskRoundedRect *rounded,
+                           graphene_rect_t      *out_interior)
+{
+  float left, right, top, bottom;
+
+  left = MAX (rounded->corner[GSK_CORNER_TOP_LEFT].width, rounded->corner[GSK_CORNER_BOTTOM_LEFT].width);
+  right = MAX (rounded->corner[GSK_CORNER_TOP_RIGHT].width, rounded->corner[GSK_CORNER_BOTTOM_RIGHT].width);
+  top = MAX (rounded->corner[GSK_CORNER_TOP_LEFT].height, rounded->corner[GSK_CORNER_TOP_RIGHT].height);
+  bottom = MAX (rounded->corner[GSK_CORNER_BOTTOM_LEFT].height, rounded->corner[GSK_CORNER_BOTTOM_RIGHT].height);
+
+  if (left + right >= rounded->bounds.size.width ||
+      top + bottom >= rounded->bounds.size.height)
+    return FALSE;
+
+  graphene_rect_init (out_interior,
+                      rounded->bounds.origin.x + left,
+                      rounded->bounds.origin.y + top,
+                      rounded->bounds.size.width - left - right,
+                      rounded->bounds.size.height - top - bottom);
+  return TRUE;
+}
+
+static gboolean
+texture_is_opaque (GdkTexture *texture)
+{
+  if (!GDK_IS_MEMORY_TEXTURE (texture))
+    return FALSE;
+
+  switch (gdk_memory_texture_get_format (GDK_MEMORY_TEXTURE (texture)))
+    {
+    case GDK_MEMORY_R8G8B8:
+    case GDK_MEMORY_B8G8R8:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/*< private >
+ * gsk_render_node_get_opaque_rect:
+ * @node: a #GskRenderNode
+ * @out_opaque: (out): return location for the opaque area
+ *
+ * Computes a conservative estimate of the area in which @node
+ * draws fully opaque pixels, for renderers to skip content that
+ * is hidden behind it.
+ *
+ * Returns: %TRUE if @node is known to be opaque somewhere
+ */
+gboolean
+gsk_render_node_get_opaque_rect (GskRenderNode   *node,
+                                 graphene_rect_t *out_opaque)
+{
+  graphene_rect_t child_opaque, clip;
+
+  switch (_gsk_render_node_get_node_type (node))
+    {
+    case GSK_COLOR_NODE:
+      if (gsk_color_node_get_color (node)->alpha < 1.0)
+        return FALSE;
+      *out_opaque = node->bounds;
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      if (!texture_is_opaque (gsk_texture_node_get_texture (node)))
+        return FALSE;
+      *out_opaque = node->bounds;
+      return TRUE;
+
+    case GSK_CONTAINER_NODE:
+      return gsk_container_node_get_opaque_rect (node, out_opaque);
+
+    case GSK_DEBUG_NODE:
+      return gsk_render_node_get_opaque_rect (gsk_debug_node_get_child (node), out_opaque);
+
+    case GSK_CLIP_NODE:
+      if (!gsk_render_node_get_opaque_rect (gsk_clip_node_get_child (node), &child_opaque))
+        return FALSE;
+      return graphene_rect_intersection (&child_opaque, gsk_clip_node_get_clip (node), out_opaque);
+
+    case GSK_ROUNDED_CLIP_NODE:
+      if (!rounded_rect_get_interior (gsk_rounded_clip_node_get_clip (node), &clip) ||
+          !gsk_render_node_get_opaque_rect (gsk_rounded_clip_node_get_child (node), &child_opaque))
+        return FALSE;
+      return graphene_rect_intersection (&child_opaque, &clip, out_opaque);
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskTransform *transform = gsk_transform_node_get_transform (node);
+
+        /* Anything more complex doesn't map rectangles to rectangles */
+        if (gsk_transform_get_category (transform) < GSK_TRANSFORM_CATEGORY_2D_AFFINE ||
+            !gsk_render_node_get_opaque_rect (gsk_transform_node_get_child (node), &child_opaque))
+          return FALSE;
+
+        gsk_transform_transform_bounds (transform, &child_opaque, out_opaque);
+        return TRUE;
+      }
+
+    case GSK_NOT_A_RENDER_NODE:
+    case GSK_CAIRO_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+    case GSK_CONIC_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+    case GSK_REPEAT_NODE:
+    case GSK_SHADOW_NODE:
+    case GSK_BLEND_NODE:
+    case GSK_CROSS_FADE_NODE:
+    case GSK_TEXT_NODE:
+    case GSK_BLUR_NODE:
+    case GSK_GL_SHADER_NODE:
+    default:
+      return FALSE;
+    }
+}
+
 /**
  * gsk_render_node_write_to_file:
  * @node: a #GskRenderNode
@@ -597,8 +866,9 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  * @error_func: (nullable) (scope call): Callback on parsing errors or %NULL
  * @user_data: (closure error_func): user_data for @error_func
  *
- * Loads data previously created via gsk_render_node_serialize(). For a
- * discussion of the supported format, see that function.
+ * Loads data previously created via gsk_render_node_serialize() or
+ * gsk_render_node_serialize_binary(). For a discussion of the supported
+ * formats, see those functions.
  *
  * Returns: (nullable) (transfer full): a new #GskRenderNode or %NULL on
  *     error.
@@ -610,7 +880,10 @@ gsk_render_node_deserialize (GBytes            *bytes,
 {
   GskRenderNode *node = NULL;
 
-  node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
+  if (gsk_render_node_is_binary (bytes))
+    node = gsk_render_node_deserialize_binary (bytes, error_func, user_data);
+  else
+    node = gsk_render_node_deserialize_from_bytes (bytes, error_func, user_data);
 
   return node;
 }
@@ -0,0 +1,1657 @@
+/* GSK - The GTK Scene Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The binary node format is meant for recording and replaying large
+ * numbers of frames. Unlike the text format, loading it involves no
+ * parsing: all values are stored in native byte order, and textures,
+ * glyph strings and color stops are used in place, so a file loaded
+ * with g_mapped_file_get_bytes() is never copied.
+ *
+ * A file consists of a header, the node table, the texture table and
+ * a data section:
+ *
+ * - The node table is a sequence of records, each starting with the
+ *   node type and the size of the record. Children are referenced by
+ *   their index in the table and always come before their parents, so
+ *   nodes can be created in a single pass. Nodes that appear multiple
+ *   times in the tree are only stored once.
+ *
+ * - The texture table lists the textures used by texture nodes, with
+ *   their pixels in GDK_MEMORY_DEFAULT format. Every texture is stored
+ *   once, no matter how many nodes use it.
+ *
+ * - The data section holds variable-sized data: strings, glyphs, color
+ *   stops, shadows and shader sources and arguments. Identical data is
+ *   stored only once.
+ *
+ * Files are only readable by the same version of GTK on a machine with
+ * the same byte order.
+ */
+
+#include "config.h"
+
+#include "gskrendernodebinaryprivate.h"
+
+#include "gskrendernodeprivate.h"
+#include "gskroundedrectprivate.h"
+#include "gsktransformprivate.h"
+
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdktextureprivate.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+#define BINARY_VERSION 1
+#define BINARY_BYTE_ORDER 0x01020304
+
+#define DATA_ALIGNMENT 16
+
+typedef struct
+{
+  char magic[4];
+  guint32 version;
+  guint32 byte_order;
+  guint32 root;
+  guint32 n_nodes;
+  guint32 n_textures;
+  guint32 nodes_offset;
+  guint32 nodes_size;
+  guint32 textures_offset;
+  guint32 data_offset;
+  guint32 data_size;
+  guint32 reserved;
+} BinaryHeader;
+
+typedef struct
+{
+  guint32 node_type;
+  guint32 size;
+} BinaryNode;
+
+/* Offset and size in the data section */
+typedef struct
+{
+  guint32 offset;
+  guint32 size;
+} BinaryData;
+
+typedef struct
+{
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 format;
+  BinaryData pixels;
+} BinaryTexture;
+
+typedef enum {
+  BINARY_TRANSFORM_IDENTITY,
+  BINARY_TRANSFORM_TRANSLATE,
+  BINARY_TRANSFORM_AFFINE,
+  BINARY_TRANSFORM_MATRIX
+} BinaryTransformType;
+
+static const char binary_magic[4] = { 'G', 'S', 'K', 'B' };
+
+/*** WRITING ***/
+
+typedef struct
+{
+  GByteArray *nodes;
+  GByteArray *data;
+  GArray *textures;
+
+  GHashTable *node_indices;
+  GHashTable *texture_indices;
+  GHashTable *data_offsets;
+
+  guint n_nodes;
+} BinaryWriter;
+
+static void
+writer_init (BinaryWriter *self)
+{
+  self->nodes = g_byte_array_new ();
+  self->data = g_byte_array_new ();
+  self->textures = g_array_new (FALSE, FALSE, sizeof (BinaryTexture));
+  self->node_indices = g_hash_table_new (NULL, NULL);
+  self->texture_indices = g_hash_table_new (NULL, NULL);
+  self->data_offsets = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                                              (GDestroyNotify) g_bytes_unref, NULL);
+  self->n_nodes = 0;
+}
+
+static void
+writer_clear (BinaryWriter *self)
+{
+  g_byte_array_unref (self->nodes);
+  g_byte_array_unref (self->data);
+  g_array_unref (self->textures);
+  g_hash_table_unref (self->node_indices);
+  g_hash_table_unref (self->texture_indices);
+  g_hash_table_unref (self->data_offsets);
+}
+
+static void
+pad_array (GByteArray *array,
+           gsize       alignment)
+{
+  static const guint8 zeroes[DATA_ALIGNMENT] = { 0, };
+
+  g_assert (alignment <= DATA_ALIGNMENT);
+
+  if (array->len % alignment)
+    g_byte_array_append (array, zeroes, alignment - array->len % alignment);
+}
+
+/* Adds @data to the data section, unless it is already there */
+static BinaryData
+writer_add_data (BinaryWriter  *self,
+                 gconstpointer  data,
+                 gsize          size)
+{
+  BinaryData result;
+  GBytes *key;
+  gpointer offset;
+
+  key = g_bytes_new (data, size);
+
+  if (g_hash_table_lookup_extended (self->data_offsets, key, NULL, &offset))
+    {
+      g_bytes_unref (key);
+      result.offset = GPOINTER_TO_UINT (offset);
+    }
+  else
+    {
+      pad_array (self->data, DATA_ALIGNMENT);
+      result.offset = self->data->len;
+      g_byte_array_append (self->data, data, size);
+      g_hash_table_insert (self->data_offsets, key, GUINT_TO_POINTER (result.offset));
+    }
+
+  result.size = size;
+
+  return result;
+}
+
+static void
+writer_put (BinaryWriter  *self,
+            gconstpointer  data,
+            gsize          size)
+{
+  g_byte_array_append (self->nodes, data, size);
+}
+
+static void
+writer_put_u32 (BinaryWriter *self,
+                guint32       value)
+{
+  writer_put (self, &value, sizeof (value));
+}
+
+static void
+writer_put_float (BinaryWriter *self,
+                  float         value)
+{
+  writer_put (self, &value, sizeof (value));
+}
+
+static void
+writer_put_rect (BinaryWriter          *self,
+                 const graphene_rect_t *rect)
+{
+  writer_put (self, (float[4]) { rect->origin.x, rect->origin.y, rect->size.width, rect->size.height }, 4 * sizeof (float));
+}
+
+static void
+writer_put_point (BinaryWriter           *self,
+                  const graphene_point_t *point)
+{
+  writer_put (self, (float[2]) { point->x, point->y }, 2 * sizeof (float));
+}
+
+static void
+writer_put_rgba (BinaryWriter  *self,
+                 const GdkRGBA *rgba)
+{
+  writer_put (self, (float[4]) { rgba->red, rgba->green, rgba->blue, rgba->alpha }, 4 * sizeof (float));
+}
+
+static void
+writer_put_rounded_rect (BinaryWriter         *self,
+                         const GskRoundedRect *rect)
+{
+  guint i;
+
+  writer_put_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    writer_put (self, (float[2]) { rect->corner[i].width, rect->corner[i].height }, 2 * sizeof (float));
+}
+
+static void
+writer_put_data (BinaryWriter  *self,
+                 gconstpointer  data,
+                 gsize          size)
+{
+  BinaryData ref = writer_add_data (self, data, size);
+
+  writer_put (self, &ref, sizeof (ref));
+}
+
+static void
+writer_put_string (BinaryWriter *self,
+                   const char   *string)
+{
+  writer_put_data (self, string, strlen (string) + 1);
+}
+
+static void
+writer_put_color_stops (BinaryWriter       *self,
+                        const GskColorStop *stops,
+                        gsize               n_stops)
+{
+  writer_put_data (self, stops, n_stops * sizeof (GskColorStop));
+}
+
+static guint32
+writer_add_texture (BinaryWriter *self,
+                    GdkTexture   *texture)
+{
+  BinaryTexture entry;
+  gpointer index;
+  guchar *pixels;
+
+  if (g_hash_table_lookup_extended (self->texture_indices, texture, NULL, &index))
+    return GPOINTER_TO_UINT (index);
+
+  entry.width = gdk_texture_get_width (texture);
+  entry.height = gdk_texture_get_height (texture);
+  entry.stride = entry.width * 4;
+  entry.format = GDK_MEMORY_DEFAULT;
+
+  pixels = g_malloc (entry.stride * entry.height);
+  gdk_texture_download (texture, pixels, entry.stride);
+  entry.pixels = writer_add_data (self, pixels, entry.stride * entry.height);
+  g_free (pixels);
+
+  g_array_append_val (self->textures, entry);
+  g_hash_table_insert (self->texture_indices, texture, GUINT_TO_POINTER (self->textures->len - 1));
+
+  return self->textures->len - 1;
+}
+
+static gsize
+writer_begin_node (BinaryWriter      *self,
+                   GskRenderNodeType  node_type)
+{
+  gsize start = self->nodes->len;
+
+  writer_put (self, &(BinaryNode) { node_type, 0 }, sizeof (BinaryNode));
+
+  return start;
+}
+
+static guint32
+writer_end_node (BinaryWriter  *self,
+                 GskRenderNode *node,
+                 gsize          start)
+{
+  BinaryNode *header = (BinaryNode *) (self->nodes->data + start);
+
+  header->size = self->nodes->len - start - sizeof (BinaryNode);
+
+  g_hash_table_insert (self->node_indices, node, GUINT_TO_POINTER (self->n_nodes));
+
+  return self->n_nodes++;
+}
+
+static guint32 writer_add_node (BinaryWriter  *self,
+                                GskRenderNode *node);
+
+static guint32
+writer_add_cairo_node (BinaryWriter  *self,
+                       GskRenderNode *node)
+{
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint32 texture_index;
+  gsize start;
+  int width, height;
+
+  /* Recordings can't be stored without parsing them back, so store the
+   * rendered result. Cairo nodes are fallbacks anyway. */
+  width = MAX (ceilf (node->bounds.size.width), 1);
+  height = MAX (ceilf (node->bounds.size.height), 1);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  cairo_translate (cr, - node->bounds.origin.x, - node->bounds.origin.y);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+
+  texture = gdk_texture_new_for_surface (surface);
+  texture_index = writer_add_texture (self, texture);
+  g_object_unref (texture);
+  cairo_surface_destroy (surface);
+
+  start = writer_begin_node (self, GSK_CAIRO_NODE);
+  writer_put_rect (self, &node->bounds);
+  writer_put_u32 (self, texture_index);
+
+  return writer_end_node (self, node, start);
+}
+
+static void
+writer_put_transform (BinaryWriter *self,
+                      GskTransform *transform)
+{
+  switch (gsk_transform_get_category (transform))
+    {
+    case GSK_TRANSFORM_CATEGORY_IDENTITY:
+      writer_put_u32 (self, BINARY_TRANSFORM_IDENTITY);
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_2D_TRANSLATE:
+      {
+        float dx, dy;
+
+        gsk_transform_to_translate (transform, &dx, &dy);
+        writer_put_u32 (self, BINARY_TRANSFORM_TRANSLATE);
+        writer_put (self, (float[2]) { dx, dy }, 2 * sizeof (float));
+      }
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_2D_AFFINE:
+      {
+        float scale_x, scale_y, dx, dy;
+
+        gsk_transform_to_affine (transform, &scale_x, &scale_y, &dx, &dy);
+        writer_put_u32 (self, BINARY_TRANSFORM_AFFINE);
+        writer_put (self, (float[4]) { scale_x, scale_y, dx, dy }, 4 * sizeof (float));
+      }
+      break;
+
+    case GSK_TRANSFORM_CATEGORY_UNKNOWN:
+    case GSK_TRANSFORM_CATEGORY_ANY:
+    case GSK_TRANSFORM_CATEGORY_3D:
+    case GSK_TRANSFORM_CATEGORY_2D:
+    default:
+      {
+        graphene_matrix_t matrix;
+        float values[16];
+
+        gsk_transform_to_matrix (transform, &matrix);
+        graphene_matrix_to_float (&matrix, values);
+        writer_put_u32 (self, BINARY_TRANSFORM_MATRIX);
+        writer_put (self, values, sizeof (values));
+      }
+      break;
+    }
+}
+
+static guint32
+writer_add_node (BinaryWriter  *self,
+                 GskRenderNode *node)
+{
+  gpointer index;
+  gsize start;
+
+  if (g_hash_table_lookup_extended (self->node_indices, node, NULL, &index))
+    return GPOINTER_TO_UINT (index);
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n = gsk_container_node_get_n_children (node);
+        guint32 *children = g_newa (guint32, MAX (n, 1));
+
+        for (i = 0; i < n; i++)
+          children[i] = writer_add_node (self, gsk_container_node_get_child (node, i));
+
+        start = writer_begin_node (self, GSK_CONTAINER_NODE);
+        writer_put_u32 (self, n);
+        writer_put (self, children, n * sizeof (guint32));
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      return writer_add_cairo_node (self, node);
+
+    case GSK_COLOR_NODE:
+      start = writer_begin_node (self, GSK_COLOR_NODE);
+      writer_put_rect (self, &node->bounds);
+      writer_put_rgba (self, gsk_color_node_get_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        gsize n_stops;
+        const GskColorStop *stops = gsk_linear_gradient_node_get_color_stops (node, &n_stops);
+
+        start = writer_begin_node (self, gsk_render_node_get_node_type (node));
+        writer_put_rect (self, &node->bounds);
+        writer_put_point (self, gsk_linear_gradient_node_get_start (node));
+        writer_put_point (self, gsk_linear_gradient_node_get_end (node));
+        writer_put_color_stops (self, stops, n_stops);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        gsize n_stops;
+        const GskColorStop *stops = gsk_radial_gradient_node_get_color_stops (node, &n_stops);
+
+        start = writer_begin_node (self, gsk_render_node_get_node_type (node));
+        writer_put_rect (self, &node->bounds);
+        writer_put_point (self, gsk_radial_gradient_node_get_center (node));
+        writer_put_float (self, gsk_radial_gradient_node_get_hradius (node));
+        writer_put_float (self, gsk_radial_gradient_node_get_vradius (node));
+        writer_put_float (self, gsk_radial_gradient_node_get_start (node));
+        writer_put_float (self, gsk_radial_gradient_node_get_end (node));
+        writer_put_color_stops (self, stops, n_stops);
+      }
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        gsize n_stops;
+        const GskColorStop *stops = gsk_conic_gradient_node_get_color_stops (node, &n_stops);
+
+        start = writer_begin_node (self, GSK_CONIC_GRADIENT_NODE);
+        writer_put_rect (self, &node->bounds);
+        writer_put_point (self, gsk_conic_gradient_node_get_center (node));
+        writer_put_float (self, gsk_conic_gradient_node_get_rotation (node));
+        writer_put_color_stops (self, stops, n_stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const float *widths = gsk_border_node_get_widths (node);
+        const GdkRGBA *colors = gsk_border_node_get_colors (node);
+        guint i;
+
+        start = writer_begin_node (self, GSK_BORDER_NODE);
+        writer_put_rounded_rect (self, gsk_border_node_get_outline (node));
+        writer_put (self, widths, 4 * sizeof (float));
+        for (i = 0; i < 4; i++)
+          writer_put_rgba (self, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        guint32 texture_index = writer_add_texture (self, gsk_texture_node_get_texture (node));
+
+        start = writer_begin_node (self, GSK_TEXTURE_NODE);
+        writer_put_rect (self, &node->bounds);
+        writer_put_u32 (self, texture_index);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      start = writer_begin_node (self, GSK_INSET_SHADOW_NODE);
+      writer_put_rounded_rect (self, gsk_inset_shadow_node_get_outline (node));
+      writer_put_rgba (self, gsk_inset_shadow_node_get_color (node));
+      writer_put_float (self, gsk_inset_shadow_node_get_dx (node));
+      writer_put_float (self, gsk_inset_shadow_node_get_dy (node));
+      writer_put_float (self, gsk_inset_shadow_node_get_spread (node));
+      writer_put_float (self, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      start = writer_begin_node (self, GSK_OUTSET_SHADOW_NODE);
+      writer_put_rounded_rect (self, gsk_outset_shadow_node_get_outline (node));
+      writer_put_rgba (self, gsk_outset_shadow_node_get_color (node));
+      writer_put_float (self, gsk_outset_shadow_node_get_dx (node));
+      writer_put_float (self, gsk_outset_shadow_node_get_dy (node));
+      writer_put_float (self, gsk_outset_shadow_node_get_spread (node));
+      writer_put_float (self, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_transform_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_TRANSFORM_NODE);
+        writer_put_u32 (self, child);
+        writer_put_transform (self, gsk_transform_node_get_transform (node));
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_opacity_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_OPACITY_NODE);
+        writer_put_u32 (self, child);
+        writer_put_float (self, gsk_opacity_node_get_opacity (node));
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_color_matrix_node_get_child (node));
+        float values[16], offset[4];
+
+        graphene_matrix_to_float (gsk_color_matrix_node_get_color_matrix (node), values);
+        graphene_vec4_to_float (gsk_color_matrix_node_get_color_offset (node), offset);
+
+        start = writer_begin_node (self, GSK_COLOR_MATRIX_NODE);
+        writer_put_u32 (self, child);
+        writer_put (self, values, sizeof (values));
+        writer_put (self, offset, sizeof (offset));
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_repeat_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_REPEAT_NODE);
+        writer_put_u32 (self, child);
+        writer_put_rect (self, &node->bounds);
+        writer_put_rect (self, gsk_repeat_node_get_child_bounds (node));
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_clip_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_CLIP_NODE);
+        writer_put_u32 (self, child);
+        writer_put_rect (self, gsk_clip_node_get_clip (node));
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_rounded_clip_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_ROUNDED_CLIP_NODE);
+        writer_put_u32 (self, child);
+        writer_put_rounded_rect (self, gsk_rounded_clip_node_get_clip (node));
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_shadow_node_get_child (node));
+        gsize i, n = gsk_shadow_node_get_n_shadows (node);
+
+        start = writer_begin_node (self, GSK_SHADOW_NODE);
+        writer_put_u32 (self, child);
+        writer_put_u32 (self, n);
+        for (i = 0; i < n; i++)
+          {
+            const GskShadow *shadow = gsk_shadow_node_get_shadow (node, i);
+
+            writer_put_rgba (self, &shadow->color);
+            writer_put_float (self, shadow->dx);
+            writer_put_float (self, shadow->dy);
+            writer_put_float (self, shadow->radius);
+          }
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        guint32 bottom = writer_add_node (self, gsk_blend_node_get_bottom_child (node));
+        guint32 top = writer_add_node (self, gsk_blend_node_get_top_child (node));
+
+        start = writer_begin_node (self, GSK_BLEND_NODE);
+        writer_put_u32 (self, bottom);
+        writer_put_u32 (self, top);
+        writer_put_u32 (self, gsk_blend_node_get_blend_mode (node));
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        guint32 start_child = writer_add_node (self, gsk_cross_fade_node_get_start_child (node));
+        guint32 end_child = writer_add_node (self, gsk_cross_fade_node_get_end_child (node));
+
+        start = writer_begin_node (self, GSK_CROSS_FADE_NODE);
+        writer_put_u32 (self, start_child);
+        writer_put_u32 (self, end_child);
+        writer_put_float (self, gsk_cross_fade_node_get_progress (node));
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFontDescription *desc;
+        char *font_name;
+        guint n_glyphs = gsk_text_node_get_num_glyphs (node);
+
+        desc = pango_font_describe (gsk_text_node_get_font (node));
+        font_name = pango_font_description_to_string (desc);
+
+        start = writer_begin_node (self, GSK_TEXT_NODE);
+        writer_put_string (self, font_name);
+        writer_put_data (self, gsk_text_node_get_glyphs (node, NULL), n_glyphs * sizeof (PangoGlyphInfo));
+        writer_put_rgba (self, gsk_text_node_get_color (node));
+        writer_put_point (self, gsk_text_node_get_offset (node));
+
+        g_free (font_name);
+        pango_font_description_free (desc);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_blur_node_get_child (node));
+
+        start = writer_begin_node (self, GSK_BLUR_NODE);
+        writer_put_u32 (self, child);
+        writer_put_float (self, gsk_blur_node_get_radius (node));
+      }
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        guint32 child = writer_add_node (self, gsk_debug_node_get_child (node));
+        const char *message = gsk_debug_node_get_message (node);
+
+        start = writer_begin_node (self, GSK_DEBUG_NODE);
+        writer_put_u32 (self, child);
+        writer_put_string (self, message ? message : "");
+      }
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        guint i, n = gsk_gl_shader_node_get_n_children (node);
+        guint32 *children = g_newa (guint32, MAX (n, 1));
+        GBytes *source, *args;
+
+        for (i = 0; i < n; i++)
+          children[i] = writer_add_node (self, gsk_gl_shader_node_get_child (node, i));
+
+        source = gsk_gl_shader_get_source (gsk_gl_shader_node_get_shader (node));
+        args = gsk_gl_shader_node_get_args (node);
+
+        start = writer_begin_node (self, GSK_GL_SHADER_NODE);
+        writer_put_rect (self, &node->bounds);
+        writer_put_data (self, g_bytes_get_data (source, NULL), g_bytes_get_size (source));
+        writer_put_data (self, g_bytes_get_data (args, NULL), g_bytes_get_size (args));
+        writer_put_u32 (self, n);
+        writer_put (self, children, n * sizeof (guint32));
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+
+  return writer_end_node (self, node, start);
+}
+
+/**
+ * gsk_render_node_serialize_binary:
+ * @node: a #GskRenderNode
+ *
+ * Serializes the @node into a compact binary format that can be loaded
+ * by gsk_render_node_deserialize() much faster than the text format created
+ * by gsk_render_node_serialize(). Textures are stored uncompressed and
+ * only once, no matter how often they are used.
+ *
+ * The same restrictions as for gsk_render_node_serialize() apply, and in
+ * addition the data can only be loaded on machines with the same byte order.
+ *
+ * Returns: a #GBytes representing the node.
+ *
+ * Since: 4.2
+ **/
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode *node)
+{
+  BinaryWriter writer;
+  BinaryHeader header = { { 0, }, };
+  GByteArray *result;
+
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), NULL);
+
+  writer_init (&writer);
+
+  memcpy (header.magic, binary_magic, sizeof (binary_magic));
+  header.version = BINARY_VERSION;
+  header.byte_order = BINARY_BYTE_ORDER;
+  header.root = writer_add_node (&writer, node);
+  header.n_nodes = writer.n_nodes;
+  header.n_textures = writer.textures->len;
+
+  result = g_byte_array_new ();
+  g_byte_array_append (result, (guint8 *) &header, sizeof (header));
+
+  header.nodes_offset = result->len;
+  header.nodes_size = writer.nodes->len;
+  g_byte_array_append (result, writer.nodes->data, writer.nodes->len);
+
+  pad_array (result, 8);
+  header.textures_offset = result->len;
+  g_byte_array_append (result, (guint8 *) writer.textures->data, writer.textures->len * sizeof (BinaryTexture));
+
+  pad_array (result, DATA_ALIGNMENT);
+  header.data_offset = result->len;
+  header.data_size = writer.data->len;
+  g_byte_array_append (result, writer.data->data, writer.data->len);
+
+  memcpy (result->data, &header, sizeof (header));
+
+  writer_clear (&writer);
+
+  return g_byte_array_free_to_bytes (result);
+}
+
+/*** READING ***/
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *start;
+  gsize size;
+
+  const BinaryHeader *header;
+  const guchar *data;
+
+  /* Current position in the node table */
+  const guchar *pos;
+  const guchar *end;
+
+  GskRenderNode **nodes;
+  guint n_nodes;
+  GdkTexture **textures;
+
+  PangoFontMap *font_map;
+  PangoContext *context;
+  GHashTable *fonts;
+
+  GskParseErrorFunc error_func;
+  gpointer user_data;
+  gboolean failed;
+} BinaryReader;
+
+static void G_GNUC_PRINTF (3, 4)
+reader_error (BinaryReader *self,
+              int           code,
+              const char   *format,
+              ...)
+{
+  GskParseLocation location = { 0, };
+  GError *error;
+  va_list args;
+
+  if (self->failed)
+    return;
+
+  self->failed = TRUE;
+
+  if (self->error_func == NULL)
+    return;
+
+  va_start (args, format);
+  error = g_error_new_valist (GSK_SERIALIZATION_ERROR, code, format, args);
+  va_end (args);
+
+  location.bytes = self->pos ? self->pos - self->start : 0;
+  location.chars = location.bytes;
+  self->error_func (&location, &location, error, self->user_data);
+
+  g_error_free (error);
+}
+
+static gboolean
+reader_get (BinaryReader *self,
+            gpointer      data,
+            gsize         size)
+{
+  if (self->failed)
+    {
+      memset (data, 0, size);
+      return FALSE;
+    }
+
+  if ((gsize) (self->end - self->pos) < size)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Node record is too short");
+      memset (data, 0, size);
+      return FALSE;
+    }
+
+  memcpy (data, self->pos, size);
+  self->pos += size;
+
+  return TRUE;
+}
+
+static guint32
+reader_get_u32 (BinaryReader *self)
+{
+  guint32 value;
+
+  reader_get (self, &value, sizeof (value));
+
+  return value;
+}
+
+static float
+reader_get_float (BinaryReader *self)
+{
+  float value;
+
+  reader_get (self, &value, sizeof (value));
+
+  return value;
+}
+
+static void
+reader_get_rect (BinaryReader    *self,
+                 graphene_rect_t *rect)
+{
+  float values[4];
+
+  reader_get (self, values, sizeof (values));
+  graphene_rect_init (rect, values[0], values[1], values[2], values[3]);
+}
+
+static void
+reader_get_point (BinaryReader     *self,
+                  graphene_point_t *point)
+{
+  float values[2];
+
+  reader_get (self, values, sizeof (values));
+  graphene_point_init (point, values[0], values[1]);
+}
+
+static void
+reader_get_rgba (BinaryReader *self,
+                 GdkRGBA      *rgba)
+{
+  float values[4];
+
+  reader_get (self, values, sizeof (values));
+  *rgba = (GdkRGBA) { values[0], values[1], values[2], values[3] };
+}
+
+static void
+reader_get_rounded_rect (BinaryReader   *self,
+                         GskRoundedRect *rect)
+{
+  guint i;
+
+  reader_get_rect (self, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      float values[2];
+
+      reader_get (self, values, sizeof (values));
+      graphene_size_init (&rect->corner[i], values[0], values[1]);
+    }
+}
+
+/* Returns a pointer into the data section, without copying */
+static gconstpointer
+reader_get_data (BinaryReader *self,
+                 gsize        *size)
+{
+  BinaryData ref;
+
+  if (!reader_get (self, &ref, sizeof (ref)))
+    {
+      *size = 0;
+      return NULL;
+    }
+
+  if (ref.offset > self->header->data_size ||
+      ref.size > self->header->data_size - ref.offset)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Data reference out of range");
+      *size = 0;
+      return NULL;
+    }
+
+  *size = ref.size;
+  return self->data + ref.offset;
+}
+
+static const char *
+reader_get_string (BinaryReader *self)
+{
+  const char *string;
+  gsize size;
+
+  string = reader_get_data (self, &size);
+  if (string == NULL)
+    return "";
+
+  if (size == 0 || string[size - 1] != '\0')
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "String is not nul-terminated");
+      return "";
+    }
+
+  return string;
+}
+
+static const GskColorStop *
+reader_get_color_stops (BinaryReader *self,
+                        gsize        *n_stops)
+{
+  const GskColorStop *stops;
+  gsize size;
+
+  stops = reader_get_data (self, &size);
+  if (size == 0 || size % sizeof (GskColorStop) != 0)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid color stops");
+      *n_stops = 0;
+      return NULL;
+    }
+
+  *n_stops = size / sizeof (GskColorStop);
+  return stops;
+}
+
+/* Children always precede their parents */
+static GskRenderNode *
+reader_get_child (BinaryReader *self)
+{
+  guint32 index = reader_get_u32 (self);
+
+  if (self->failed)
+    return NULL;
+
+  if (index >= self->n_nodes || self->nodes[index] == NULL)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid child node %u", index);
+      return NULL;
+    }
+
+  return self->nodes[index];
+}
+
+static GdkTexture *
+reader_get_texture (BinaryReader *self)
+{
+  const BinaryTexture *entries;
+  const BinaryTexture *entry;
+  guint32 index;
+  GBytes *pixels;
+
+  index = reader_get_u32 (self);
+  if (self->failed)
+    return NULL;
+
+  if (index >= self->header->n_textures)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid texture %u", index);
+      return NULL;
+    }
+
+  if (self->textures[index])
+    return self->textures[index];
+
+  entries = (const BinaryTexture *) (self->start + self->header->textures_offset);
+  entry = &entries[index];
+
+  if (entry->width == 0 || entry->height == 0 ||
+      entry->format >= GDK_MEMORY_N_FORMATS ||
+      entry->stride < entry->width * gdk_memory_format_bytes_per_pixel (entry->format) ||
+      entry->pixels.offset > self->header->data_size ||
+      entry->pixels.size > self->header->data_size - entry->pixels.offset ||
+      entry->pixels.size < (gsize) entry->stride * (entry->height - 1) + entry->width * gdk_memory_format_bytes_per_pixel (entry->format))
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid texture %u", index);
+      return NULL;
+    }
+
+  pixels = g_bytes_new_from_bytes (self->bytes,
+                                   self->data - self->start + entry->pixels.offset,
+                                   entry->pixels.size);
+  self->textures[index] = gdk_memory_texture_new (entry->width, entry->height,
+                                                  entry->format,
+                                                  pixels,
+                                                  entry->stride);
+  g_bytes_unref (pixels);
+
+  return self->textures[index];
+}
+
+static PangoFont *
+reader_get_font (BinaryReader *self)
+{
+  const char *font_name;
+  PangoFont *font;
+
+  font_name = reader_get_string (self);
+  if (self->failed)
+    return NULL;
+
+  font = g_hash_table_lookup (self->fonts, font_name);
+  if (font == NULL)
+    {
+      PangoFontDescription *desc;
+
+      if (self->context == NULL)
+        {
+          self->font_map = pango_cairo_font_map_get_default ();
+          self->context = pango_font_map_create_context (self->font_map);
+        }
+
+      desc = pango_font_description_from_string (font_name);
+      font = pango_font_map_load_font (self->font_map, self->context, desc);
+      pango_font_description_free (desc);
+
+      if (font == NULL)
+        {
+          reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Failed to load font \"%s\"", font_name);
+          return NULL;
+        }
+
+      g_hash_table_insert (self->fonts, (gpointer) font_name, font);
+    }
+
+  return font;
+}
+
+static GskTransform *
+reader_get_transform (BinaryReader *self)
+{
+  switch (reader_get_u32 (self))
+    {
+    case BINARY_TRANSFORM_IDENTITY:
+      return NULL;
+
+    case BINARY_TRANSFORM_TRANSLATE:
+      {
+        float values[2];
+
+        reader_get (self, values, sizeof (values));
+        return gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (values[0], values[1]));
+      }
+
+    case BINARY_TRANSFORM_AFFINE:
+      {
+        float values[4];
+
+        reader_get (self, values, sizeof (values));
+        return gsk_transform_scale (gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (values[2], values[3])),
+                                    values[0], values[1]);
+      }
+
+    case BINARY_TRANSFORM_MATRIX:
+      {
+        graphene_matrix_t matrix;
+        float values[16];
+
+        reader_get (self, values, sizeof (values));
+        graphene_matrix_init_from_float (&matrix, values);
+        return gsk_transform_matrix (NULL, &matrix);
+      }
+
+    default:
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid transform");
+      return NULL;
+    }
+}
+
+static GskRenderNode *
+reader_read_node (BinaryReader      *self,
+                  GskRenderNodeType  node_type)
+{
+  GskRenderNode *node = NULL;
+
+  switch ((guint) node_type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint32 i, n = reader_get_u32 (self);
+        GskRenderNode **children;
+
+        if (n > (self->end - self->pos) / sizeof (guint32))
+          {
+            reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Too many children");
+            return NULL;
+          }
+
+        children = g_new (GskRenderNode *, MAX (n, 1));
+        for (i = 0; i < n; i++)
+          children[i] = reader_get_child (self);
+        if (!self->failed)
+          node = gsk_container_node_new (children, n);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+
+        reader_get_rect (self, &bounds);
+        texture = reader_get_texture (self);
+        if (texture)
+          {
+            cairo_surface_t *surface;
+            cairo_t *cr;
+
+            node = gsk_cairo_node_new (&bounds);
+            cr = gsk_cairo_node_get_draw_context (node);
+            surface = gdk_texture_download_surface (texture);
+            cairo_set_source_surface (cr, surface, bounds.origin.x, bounds.origin.y);
+            cairo_paint (cr);
+            cairo_surface_destroy (surface);
+            cairo_destroy (cr);
+          }
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkRGBA color;
+
+        reader_get_rect (self, &bounds);
+        reader_get_rgba (self, &color);
+        if (!self->failed)
+          node = gsk_color_node_new (&color, &bounds);
+      }
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t start, end;
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        reader_get_rect (self, &bounds);
+        reader_get_point (self, &start);
+        reader_get_point (self, &end);
+        stops = reader_get_color_stops (self, &n_stops);
+        if (self->failed)
+          break;
+
+        if (node_type == GSK_LINEAR_GRADIENT_NODE)
+          node = gsk_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+        else
+          node = gsk_repeating_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        reader_get_rect (self, &bounds);
+        reader_get_point (self, &center);
+        hradius = reader_get_float (self);
+        vradius = reader_get_float (self);
+        start = reader_get_float (self);
+        end = reader_get_float (self);
+        stops = reader_get_color_stops (self, &n_stops);
+        if (self->failed)
+          break;
+
+        if (node_type == GSK_RADIAL_GRADIENT_NODE)
+          node = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+        else
+          node = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius, start, end, stops, n_stops);
+      }
+      break;
+
+    case GSK_CONIC_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float rotation;
+        const GskColorStop *stops;
+        gsize n_stops;
+
+        reader_get_rect (self, &bounds);
+        reader_get_point (self, &center);
+        rotation = reader_get_float (self);
+        stops = reader_get_color_stops (self, &n_stops);
+        if (!self->failed)
+          node = gsk_conic_gradient_node_new (&bounds, &center, rotation, stops, n_stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+        guint i;
+
+        reader_get_rounded_rect (self, &outline);
+        reader_get (self, widths, sizeof (widths));
+        for (i = 0; i < 4; i++)
+          reader_get_rgba (self, &colors[i]);
+        if (!self->failed)
+          node = gsk_border_node_new (&outline, widths, colors);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+
+        reader_get_rect (self, &bounds);
+        texture = reader_get_texture (self);
+        if (texture)
+          node = gsk_texture_node_new (texture, &bounds);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float values[4];
+
+        reader_get_rounded_rect (self, &outline);
+        reader_get_rgba (self, &color);
+        reader_get (self, values, sizeof (values));
+        if (self->failed)
+          break;
+
+        if (node_type == GSK_INSET_SHADOW_NODE)
+          node = gsk_inset_shadow_node_new (&outline, &color, values[0], values[1], values[2], values[3]);
+        else
+          node = gsk_outset_shadow_node_new (&outline, &color, values[0], values[1], values[2], values[3]);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        GskTransform *transform = reader_get_transform (self);
+
+        if (!self->failed)
+          node = gsk_transform_node_new (child, transform);
+        gsk_transform_unref (transform);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        float opacity = reader_get_float (self);
+
+        if (!self->failed)
+          node = gsk_opacity_node_new (child, opacity);
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        float values[16], offset[4];
+        graphene_matrix_t matrix;
+        graphene_vec4_t vec;
+
+        reader_get (self, values, sizeof (values));
+        reader_get (self, offset, sizeof (offset));
+        if (self->failed)
+          break;
+
+        graphene_matrix_init_from_float (&matrix, values);
+        graphene_vec4_init_from_float (&vec, offset);
+        node = gsk_color_matrix_node_new (child, &matrix, &vec);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        graphene_rect_t bounds, child_bounds;
+
+        reader_get_rect (self, &bounds);
+        reader_get_rect (self, &child_bounds);
+        if (!self->failed)
+          node = gsk_repeat_node_new (&bounds, child, &child_bounds);
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        graphene_rect_t clip;
+
+        reader_get_rect (self, &clip);
+        if (!self->failed)
+          node = gsk_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        GskRoundedRect clip;
+
+        reader_get_rounded_rect (self, &clip);
+        if (!self->failed)
+          node = gsk_rounded_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        guint32 i, n = reader_get_u32 (self);
+        GskShadow *shadows;
+
+        if (n == 0 || n > (self->end - self->pos) / (7 * sizeof (float)))
+          {
+            reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid number of shadows");
+            break;
+          }
+
+        shadows = g_new (GskShadow, n);
+        for (i = 0; i < n; i++)
+          {
+            reader_get_rgba (self, &shadows[i].color);
+            shadows[i].dx = reader_get_float (self);
+            shadows[i].dy = reader_get_float (self);
+            shadows[i].radius = reader_get_float (self);
+          }
+        if (!self->failed)
+          node = gsk_shadow_node_new (child, shadows, n);
+        g_free (shadows);
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        GskRenderNode *bottom = reader_get_child (self);
+        GskRenderNode *top = reader_get_child (self);
+        guint32 blend_mode = reader_get_u32 (self);
+
+        if (blend_mode > GSK_BLEND_MODE_LUMINOSITY)
+          reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid blend mode %u", blend_mode);
+        if (!self->failed)
+          node = gsk_blend_node_new (bottom, top, blend_mode);
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        GskRenderNode *start = reader_get_child (self);
+        GskRenderNode *end = reader_get_child (self);
+        float progress = reader_get_float (self);
+
+        if (!self->failed)
+          node = gsk_cross_fade_node_new (start, end, progress);
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font;
+        const PangoGlyphInfo *glyphs;
+        graphene_point_t offset;
+        GdkRGBA color;
+        gsize size;
+
+        font = reader_get_font (self);
+        glyphs = reader_get_data (self, &size);
+        reader_get_rgba (self, &color);
+        reader_get_point (self, &offset);
+
+        if (size == 0 || size % sizeof (PangoGlyphInfo) != 0)
+          reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid glyphs");
+        if (self->failed)
+          break;
+
+        node = gsk_text_node_new (font,
+                                  &(PangoGlyphString) {
+                                    .num_glyphs = size / sizeof (PangoGlyphInfo),
+                                    .glyphs = (PangoGlyphInfo *) glyphs,
+                                  },
+                                  &color,
+                                  &offset);
+
+        /* The font may have changed its metrics since recording */
+        if (node == NULL)
+          node = gsk_container_node_new (NULL, 0);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        float radius = reader_get_float (self);
+
+        if (!self->failed)
+          node = gsk_blur_node_new (child, radius);
+      }
+      break;
+
+    case GSK_DEBUG_NODE:
+      {
+        GskRenderNode *child = reader_get_child (self);
+        const char *message = reader_get_string (self);
+
+        if (!self->failed)
+          node = gsk_debug_node_new (child, g_strdup (message));
+      }
+      break;
+
+    case GSK_GL_SHADER_NODE:
+      {
+        graphene_rect_t bounds;
+        gconstpointer source_data, args_data;
+        gsize source_size, args_size;
+        GskRenderNode **children;
+        GskGLShader *shader;
+        GBytes *source, *args;
+        guint32 i, n;
+
+        reader_get_rect (self, &bounds);
+        source_data = reader_get_data (self, &source_size);
+        args_data = reader_get_data (self, &args_size);
+        n = reader_get_u32 (self);
+
+        if (self->failed)
+          break;
+
+        if (n > (self->end - self->pos) / sizeof (guint32))
+          {
+            reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Too many children");
+            break;
+          }
+
+        children = g_new (GskRenderNode *, MAX (n, 1));
+        for (i = 0; i < n; i++)
+          children[i] = reader_get_child (self);
+
+        if (!self->failed)
+          {
+            source = g_bytes_new_from_bytes (self->bytes, (const guchar *) source_data - self->start, source_size);
+            args = g_bytes_new_from_bytes (self->bytes, (const guchar *) args_data - self->start, args_size);
+            shader = gsk_gl_shader_new_from_bytes (source);
+
+            if (args_size == gsk_gl_shader_get_args_size (shader))
+              node = gsk_gl_shader_node_new (shader, &bounds, args, children, n);
+            else
+              reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Shader arguments don't match the shader");
+
+            g_object_unref (shader);
+            g_bytes_unref (args);
+            g_bytes_unref (source);
+          }
+
+        g_free (children);
+      }
+      break;
+
+    default:
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Unknown node type %u", node_type);
+      break;
+    }
+
+  return node;
+}
+
+static gboolean
+reader_check_header (BinaryReader *self)
+{
+  const BinaryHeader *header = self->header;
+
+  if (header->version != BINARY_VERSION)
+    {
+      reader_error (self, GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                    "Unsupported binary node format version %u", header->version);
+      return FALSE;
+    }
+
+  if (header->byte_order != BINARY_BYTE_ORDER)
+    {
+      reader_error (self, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                    "Binary node data was created with a different byte order");
+      return FALSE;
+    }
+
+  if (header->nodes_offset < sizeof (BinaryHeader) ||
+      header->nodes_offset > self->size ||
+      header->nodes_size > self->size - header->nodes_offset ||
+      header->textures_offset % 8 != 0 ||
+      header->textures_offset > self->size ||
+      header->n_textures > (self->size - header->textures_offset) / sizeof (BinaryTexture) ||
+      header->data_offset % DATA_ALIGNMENT != 0 ||
+      header->data_offset > self->size ||
+      header->data_size > self->size - header->data_offset ||
+      header->n_nodes == 0 ||
+      header->root >= header->n_nodes)
+    {
+      reader_error (self, GSK_SERIALIZATION_INVALID_DATA, "Invalid binary node header");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+gboolean
+gsk_render_node_is_binary (GBytes *bytes)
+{
+  gsize size;
+  const guchar *data = g_bytes_get_data (bytes, &size);
+
+  return size >= sizeof (BinaryHeader) &&
+         memcmp (data, binary_magic, sizeof (binary_magic)) == 0;
+}
+
+GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes            *bytes,
+                                    GskParseErrorFunc  error_func,
+                                    gpointer           user_data)
+{
+  BinaryReader reader = { NULL, };
+  BinaryHeader header;
+  GskRenderNode *root = NULL;
+  const guchar *nodes_end;
+  guint i;
+
+  g_assert (gsk_render_node_is_binary (bytes));
+
+  reader.bytes = bytes;
+  reader.start = g_bytes_get_data (bytes, &reader.size);
+  reader.error_func = error_func;
+  reader.user_data = user_data;
+
+  /* The data may not be aligned if it doesn't come from a file */
+  memcpy (&header, reader.start, sizeof (header));
+  reader.header = &header;
+
+  if (!reader_check_header (&reader))
+    return NULL;
+
+  if (((gsize) reader.start) % DATA_ALIGNMENT != 0)
+    {
+      GBytes *copy;
+
+      copy = g_bytes_new (reader.start, reader.size);
+      root = gsk_render_node_deserialize_binary (copy, error_func, user_data);
+      g_bytes_unref (copy);
+
+      return root;
+    }
+
+  reader.data = reader.start + header.data_offset;
+  reader.nodes = g_new0 (GskRenderNode *, header.n_nodes);
+  reader.textures = g_new0 (GdkTexture *, MAX (header.n_textures, 1));
+  reader.fonts = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+
+  reader.pos = reader.start + header.nodes_offset;
+  nodes_end = reader.pos + header.nodes_size;
+
+  for (i = 0; i < header.n_nodes && !reader.failed; i++)
+    {
+      BinaryNode record;
+
+      reader.end = nodes_end;
+      if (!reader_get (&reader, &record, sizeof (record)))
+        break;
+
+      if (record.size > (gsize) (nodes_end - reader.pos))
+        {
+          reader_error (&reader, GSK_SERIALIZATION_INVALID_DATA, "Node record is too long");
+          break;
+        }
+
+      reader.end = reader.pos + record.size;
+      reader.nodes[i] = reader_read_node (&reader, record.node_type);
+      reader.n_nodes = i + 1;
+
+      if (reader.nodes[i] == NULL)
+        reader_error (&reader, GSK_SERIALIZATION_INVALID_DATA, "Failed to create node");
+
+      reader.pos = reader.end;
+    }
+
+  if (!reader.failed)
+    root = gsk_render_node_ref (reader.nodes[header.root]);
+
+  for (i = 0; i < header.n_nodes; i++)
+    g_clear_pointer (&reader.nodes[i], gsk_render_node_unref);
+  for (i = 0; i < header.n_textures; i++)
+    g_clear_object (&reader.textures[i]);
+  g_free (reader.nodes);
+  g_free (reader.textures);
+  g_hash_table_unref (reader.fonts);
+  g_clear_object (&reader.context);
+
+  return root;
+}
@@ -134,6 +134,9 @@ gsk_color_node_new (const GdkRGBA         *rgba,
   self->color = *rgba;
   graphene_rect_init_from_rect (&node->bounds, bounds);
 
+  gsk_render_node_set_hash (node, gsk_render_node_hash_data (gsk_render_node_hash_init (node),
+                                                             &self->color, sizeof (self->color)));
+
   return node;
 }
 
@@ -1356,6 +1359,7 @@ gsk_border_node_new (const GskRoundedRect *outline,
 {
   GskBorderNode *self;
   GskRenderNode *node;
+  guint64 hash;
 
   g_return_val_if_fail (outline != NULL, NULL);
   g_return_val_if_fail (border_width != NULL, NULL);
@@ -1381,6 +1385,12 @@ gsk_border_node_new (const GskRoundedRect *outline,
 
   graphene_rect_init_from_rect (&node->bounds, &self->outline.bounds);
 
+  hash = gsk_render_node_hash_init (node);
+  hash = gsk_render_node_hash_data (hash, &self->outline, sizeof (self->outline));
+  hash = gsk_render_node_hash_data (hash, self->border_width, sizeof (self->border_width));
+  hash = gsk_render_node_hash_data (hash, self->border_color, sizeof (self->border_color));
+  gsk_render_node_set_hash (node, hash);
+
   return node;
 }
 
@@ -1504,6 +1514,10 @@ gsk_texture_node_new (GdkTexture            *texture,
   self->texture = g_object_ref (texture);
   graphene_rect_init_from_rect (&node->bounds, bounds);
 
+  /* Textures are immutable, so their identity is enough */
+  gsk_render_node_set_hash (node, gsk_render_node_hash_data (gsk_render_node_hash_init (node),
+                                                             &self->texture, sizeof (self->texture)));
+
   return node;
 }
 
@@ -1944,6 +1958,7 @@ gsk_inset_shadow_node_new (const GskRoundedRect *outline,
 {
   GskInsetShadowNode *self;
   GskRenderNode *node;
+  guint64 hash;
 
   g_return_val_if_fail (outline != NULL, NULL);
   g_return_val_if_fail (color != NULL, NULL);
@@ -1960,6 +1975,12 @@ gsk_inset_shadow_node_new (const GskRoundedRect *outline,
 
   graphene_rect_init_from_rect (&node->bounds, &self->outline.bounds);
 
+  hash = gsk_render_node_hash_init (node);
+  hash = gsk_render_node_hash_data (hash, &self->outline, sizeof (self->outline));
+  hash = gsk_render_node_hash_data (hash, &self->color, sizeof (self->color));
+  hash = gsk_render_node_hash_data (hash, (float[4]) { dx, dy, spread, blur_radius }, 4 * sizeof (float));
+  gsk_render_node_set_hash (node, hash);
+
   return node;
 }
 
@@ -2252,6 +2273,7 @@ gsk_outset_shadow_node_new (const GskRoundedRect *outline,
   GskOutsetShadowNode *self;
   GskRenderNode *node;
   float top, right, bottom, left;
+  guint64 hash;
 
   g_return_val_if_fail (outline != NULL, NULL);
   g_return_val_if_fail (color != NULL, NULL);
@@ -2274,6 +2296,12 @@ gsk_outset_shadow_node_new (const GskRoundedRect *outline,
   node->bounds.size.width += left + right;
   node->bounds.size.height += top + bottom;
 
+  hash = gsk_render_node_hash_init (node);
+  hash = gsk_render_node_hash_data (hash, &self->outline, sizeof (self->outline));
+  hash = gsk_render_node_hash_data (hash, &self->color, sizeof (self->color));
+  hash = gsk_render_node_hash_data (hash, (float[4]) { dx, dy, spread, blur_radius }, 4 * sizeof (float));
+  gsk_render_node_set_hash (node, hash);
+
   return node;
 }
 
@@ -2534,6 +2562,14 @@ struct _GskContainerNode
 
   guint n_children;
   GskRenderNode **children;
+
+  /* Largest opaque area of the children, and which children are
+   * hidden behind opaque later siblings. @occluded is %NULL when
+   * no child is. */
+  graphene_rect_t opaque;
+  gboolean has_opaque;
+  guint n_occluded;
+  guint8 *occluded;
 };
 
 static void
@@ -2546,6 +2582,7 @@ gsk_container_node_finalize (GskRenderNode *node)
     gsk_render_node_unref (container->children[i]);
 
   g_free (container->children);
+  g_free (container->occluded);
 
   parent_class->finalize (node);
 }
@@ -2555,11 +2592,22 @@ gsk_container_node_draw (GskRenderNode *node,
                          cairo_t       *cr)
 {
   GskContainerNode *container = (GskContainerNode *) node;
+  graphene_rect_t clip;
+  double x1, y1, x2, y2;
   guint i;
 
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  graphene_rect_init (&clip, x1, y1, x2 - x1, y2 - y1);
+
   for (i = 0; i < container->n_children; i++)
     {
-      gsk_render_node_draw (container->children[i], cr);
+      GskRenderNode *child = container->children[i];
+
+      /* Skip children outside of the area being drawn */
+      if (!graphene_rect_intersection (&clip, &child->bounds, NULL))
+        continue;
+
+      gsk_render_node_draw (child, cr);
     }
 }
 
@@ -2627,6 +2675,78 @@ gsk_container_node_diff (GskRenderNode  *node1,
   gsk_render_node_diff_impossible (node1, node2, region);
 }
 
+/* Only a few occluders are tracked, as most containers that cover
+ * anything have a single opaque background. */
+#define MAX_OCCLUDERS 4
+
+static float
+rect_area (const graphene_rect_t *rect)
+{
+  return rect->size.width * rect->size.height;
+}
+
+/* Walks the children front to back and marks those that are entirely
+ * covered by the opaque areas of later siblings. */
+static void
+gsk_container_node_compute_occlusion (GskContainerNode *self)
+{
+  graphene_rect_t occluders[MAX_OCCLUDERS];
+  guint n_occluders = 0;
+  guint i, j;
+
+  for (i = self->n_children; i-- > 0; )
+    {
+      GskRenderNode *child = self->children[i];
+      graphene_rect_t opaque;
+
+      for (j = 0; j < n_occluders; j++)
+        {
+          if (graphene_rect_contains_rect (&occluders[j], &child->bounds))
+            break;
+        }
+
+      if (j < n_occluders)
+        {
+          if (self->occluded == NULL)
+            self->occluded = g_new0 (guint8, self->n_children);
+          self->occluded[i] = TRUE;
+          self->n_occluded++;
+          continue;
+        }
+
+      if (!gsk_render_node_get_opaque_rect (child, &opaque) ||
+          rect_area (&opaque) <= 0)
+        continue;
+
+      if (n_occluders < MAX_OCCLUDERS)
+        {
+          occluders[n_occluders++] = opaque;
+        }
+      else
+        {
+          guint smallest = 0;
+
+          for (j = 1; j < n_occluders; j++)
+            {
+              if (rect_area (&occluders[j]) < rect_area (&occluders[smallest]))
+                smallest = j;
+            }
+
+          if (rect_area (&opaque) > rect_area (&occluders[smallest]))
+            occluders[smallest] = opaque;
+        }
+    }
+
+  for (j = 0; j < n_occluders; j++)
+    {
+      if (!self->has_opaque || rect_area (&occluders[j]) > rect_area (&self->opaque))
+        {
+          self->opaque = occluders[j];
+          self->has_opaque = TRUE;
+        }
+    }
+}
+
 /**
  * gsk_container_node_new:
  * @children: (array length=n_children) (transfer none): The children of the node
@@ -2643,6 +2763,7 @@ gsk_container_node_new (GskRenderNode **children,
 {
   GskContainerNode *self;
   GskRenderNode *node;
+  guint64 hash;
 
   self = gsk_render_node_alloc (GSK_CONTAINER_NODE);
   node = (GskRenderNode *) self;
@@ -2671,6 +2792,13 @@ gsk_container_node_new (GskRenderNode **children,
       graphene_rect_init_from_rect (&node->bounds, &bounds);
     }
 
+  hash = gsk_render_node_hash_init (node);
+  for (guint i = 0; i < n_children && hash != 0; i++)
+    hash = gsk_render_node_hash_child (hash, children[i]);
+  gsk_render_node_set_hash (node, hash);
+
+  gsk_container_node_compute_occlusion (self);
+
   return node;
 }
 
@@ -2713,6 +2841,63 @@ gsk_container_node_get_child (GskRenderNode *node,
   return self->children[idx];
 }
 
+/*< private >
+ * gsk_container_node_get_opaque_rect:
+ * @node: a container #GskRenderNode
+ * @out_opaque: (out): return location for the opaque area
+ *
+ * Gets the largest area known to be fully covered by an opaque
+ * child of @node.
+ *
+ * Returns: %TRUE if there is such an area
+ */
+gboolean
+gsk_container_node_get_opaque_rect (GskRenderNode   *node,
+                                    graphene_rect_t *out_opaque)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+
+  if (!self->has_opaque)
+    return FALSE;
+
+  *out_opaque = self->opaque;
+  return TRUE;
+}
+
+/*< private >
+ * gsk_container_node_is_child_occluded:
+ * @node: a container #GskRenderNode
+ * @idx: the position of the child
+ *
+ * Checks whether the @idx'th child of @node is completely hidden
+ * behind opaque children that are drawn after it, so renderers
+ * can skip it.
+ *
+ * Returns: %TRUE if the child is occluded
+ */
+gboolean
+gsk_container_node_is_child_occluded (GskRenderNode *node,
+                                      guint          idx)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+
+  return self->occluded != NULL && self->occluded[idx];
+}
+
+/*< private >
+ * gsk_container_node_get_n_occluded:
+ * @node: a container #GskRenderNode
+ *
+ * Returns: the number of children of @node that are occluded
+ */
+guint
+gsk_container_node_get_n_occluded (GskRenderNode *node)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+
+  return self->n_occluded;
+}
+
 /*** GSK_TRANSFORM_NODE ***/
 
 /**
@@ -2868,6 +3053,7 @@ gsk_transform_node_new (GskRenderNode *child,
 {
   GskTransformNode *self;
   GskRenderNode *node;
+  guint64 hash;
 
   g_return_val_if_fail (GSK_IS_RENDER_NODE (child), NULL);
   g_return_val_if_fail (transform != NULL, NULL);
@@ -2882,6 +3068,18 @@ gsk_transform_node_new (GskRenderNode *child,
                                   &child->bounds,
                                   &node->bounds);
 
+  hash = gsk_render_node_hash_child (gsk_render_node_hash_init (node), child);
+  if (hash != 0)
+    {
+      graphene_matrix_t matrix;
+      float values[16];
+
+      gsk_transform_to_matrix (self->transform, &matrix);
+      graphene_matrix_to_float (&matrix, values);
+      hash = gsk_render_node_hash_data (hash, values, sizeof (values));
+    }
+  gsk_render_node_set_hash (node, hash);
+
   return node;
 }
 
@@ -3010,6 +3208,9 @@ gsk_opacity_node_new (GskRenderNode *child,
 
   graphene_rect_init_from_rect (&node->bounds, &child->bounds);
 
+  gsk_render_node_set_hash (node, gsk_render_node_hash_data (gsk_render_node_hash_child (gsk_render_node_hash_init (node), child),
+                                                             &self->opacity, sizeof (self->opacity)));
+
   return node;
 }
 
@@ -3508,6 +3709,9 @@ gsk_clip_node_new (GskRenderNode         *child,
 
   graphene_rect_intersection (&self->clip, &child->bounds, &node->bounds);
 
+  gsk_render_node_set_hash (node, gsk_render_node_hash_data (gsk_render_node_hash_child (gsk_render_node_hash_init (node), child),
+                                                             &self->clip, sizeof (self->clip)));
+
   return node;
 }
 
@@ -3643,6 +3847,9 @@ gsk_rounded_clip_node_new (GskRenderNode         *child,
 
   graphene_rect_intersection (&self->clip.bounds, &child->bounds, &node->bounds);
 
+  gsk_render_node_set_hash (node, gsk_render_node_hash_data (gsk_render_node_hash_child (gsk_render_node_hash_init (node), child),
+                                                             &self->clip, sizeof (self->clip)));
+
   return node;
 }
 
@@ -4406,6 +4613,7 @@ gsk_text_node_new (PangoFont              *font,
   GskTextNode *self;
   GskRenderNode *node;
   PangoRectangle ink_rect;
+  guint64 hash;
 
   pango_glyph_string_extents (glyphs, font, &ink_rect, NULL);
   pango_extents_to_pixels (&ink_rect, NULL);
@@ -4431,6 +4639,13 @@ gsk_text_node_new (PangoFont              *font,
                       ink_rect.width + 2,
                       ink_rect.height + 2);
 
+  hash = gsk_render_node_hash_init (node);
+  hash = gsk_render_node_hash_data (hash, &self->font, sizeof (self->font));
+  hash = gsk_render_node_hash_data (hash, &self->color, sizeof (self->color));
+  hash = gsk_render_node_hash_data (hash, &self->offset, sizeof (self->offset));
+  hash = gsk_render_node_hash_data (hash, self->glyphs, self->num_glyphs * sizeof (PangoGlyphInfo));
+  gsk_render_node_set_hash (node, hash);
+
   return node;
 }
 
@@ -4951,6 +5166,9 @@ gsk_debug_node_new (GskRenderNode *child,
 
   graphene_rect_init_from_rect (&node->bounds, &child->bounds);
 
+  /* The message is not rendered */
+  gsk_render_node_set_hash (node, gsk_render_node_hash_child (gsk_render_node_hash_init (node), child));
+
   return node;
 }
 
@@ -27,6 +27,10 @@ struct _GskRenderNode
   gatomicrefcount ref_count;
 
   graphene_rect_t bounds;
+
+  /* Structural hash of the node and its children, or 0 if the
+   * node type doesn't compute one */
+  guint64 hash;
 };
 
 struct _GskRenderNodeClass
@@ -35,6 +39,9 @@ struct _GskRenderNodeClass
 
   GskRenderNodeType node_type;
 
+  gsize instance_size;
+
+  void            (* instance_init) (GskRenderNode  *node);
   void            (* finalize)    (GskRenderNode  *node);
   void            (* draw)        (GskRenderNode  *node,
                                    cairo_t        *cr);
@@ -85,6 +92,16 @@ GType           gsk_render_node_type_register_static    (const char
 
 gpointer        gsk_render_node_alloc                   (GskRenderNodeType            node_type);
 
+guint64         gsk_render_node_hash_init               (const GskRenderNode         *node);
+guint64         gsk_render_node_hash_data               (guint64                      hash,
+                                                         gconstpointer                data,
+                                                         gsize                        size);
+guint64         gsk_render_node_hash_child              (guint64                      hash,
+                                                         const GskRenderNode         *child);
+void            gsk_render_node_set_hash                (GskRenderNode               *node,
+                                                         guint64                      hash);
+guint           gsk_render_node_get_n_diffed            (gboolean                     reset);
+
 gboolean        gsk_render_node_can_diff                (const GskRenderNode         *node1,
                                                          const GskRenderNode         *node2) G_GNUC_PURE;
 void            gsk_render_node_diff                    (GskRenderNode               *node1,
@@ -94,6 +111,15 @@ void            gsk_render_node_diff_impossible         (GskRenderNode
                                                          GskRenderNode               *node2,
                                                          cairo_region_t              *region);
 
+gboolean        gsk_render_node_get_opaque_rect         (GskRenderNode               *node,
+                                                         graphene_rect_t             *out_opaque);
+
+gboolean        gsk_container_node_get_opaque_rect      (GskRenderNode               *node,
+                                                         graphene_rect_t             *out_opaque);
+gboolean        gsk_container_node_is_child_occluded    (GskRenderNode               *node,
+                                                         guint                        idx);
+guint           gsk_container_node_get_n_occluded       (GskRenderNode               *node);
+
 bool            gsk_border_node_get_uniform             (GskRenderNode               *self);
 
 void            gsk_text_node_serialize_glyphs          (GskRenderNode               *self,
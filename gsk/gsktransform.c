@@ -45,6 +45,19 @@ struct _GskTransform
 
   GskTransformCategory category;
   GskTransform *next;
+
+  /* The whole chain, flattened on first use. Which member is
+   * valid depends on the category. */
+  gsize flattened;
+  union {
+    struct {
+      float scale_x, scale_y, dx, dy;
+    } affine;                   /* >= GSK_TRANSFORM_CATEGORY_2D_AFFINE */
+    struct {
+      float xx, yx, xy, yy, dx, dy;
+    } two_d;                    /* == GSK_TRANSFORM_CATEGORY_2D */
+    float *matrix;              /* < GSK_TRANSFORM_CATEGORY_2D */
+  } flat;
 };
 
 struct _GskTransformClass
@@ -1344,9 +1357,73 @@ gsk_transform_finalize (GskTransform *self)
 {
   self->transform_class->finalize (self);
 
+  if (self->flattened && self->category < GSK_TRANSFORM_CATEGORY_2D)
+    g_free (self->flat.matrix);
+
   gsk_transform_unref (self->next);
 }
 
+/* Transforms are immutable, but used from multiple threads by
+ * renderers, so the flattened chain is only written once.
+ * Each step uses the flattened result of the rest of the chain,
+ * so a long chain only gets walked the first time.
+ */
+static void
+gsk_transform_ensure_flattened (GskTransform *self)
+{
+  if (!g_once_init_enter (&self->flattened))
+    return;
+
+  if (self->category >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    {
+      float scale_x = 1.0f, scale_y = 1.0f, dx = 0.0f, dy = 0.0f;
+
+      if (self->next)
+        {
+          gsk_transform_ensure_flattened (self->next);
+          scale_x = self->next->flat.affine.scale_x;
+          scale_y = self->next->flat.affine.scale_y;
+          dx = self->next->flat.affine.dx;
+          dy = self->next->flat.affine.dy;
+        }
+
+      self->transform_class->apply_affine (self, &scale_x, &scale_y, &dx, &dy);
+
+      self->flat.affine.scale_x = scale_x;
+      self->flat.affine.scale_y = scale_y;
+      self->flat.affine.dx = dx;
+      self->flat.affine.dy = dy;
+    }
+  else if (self->category == GSK_TRANSFORM_CATEGORY_2D)
+    {
+      float xx, yx, xy, yy, dx, dy;
+
+      gsk_transform_to_2d (self->next, &xx, &yx, &xy, &yy, &dx, &dy);
+
+      self->transform_class->apply_2d (self, &xx, &yx, &xy, &yy, &dx, &dy);
+
+      self->flat.two_d.xx = xx;
+      self->flat.two_d.yx = yx;
+      self->flat.two_d.xy = xy;
+      self->flat.two_d.yy = yy;
+      self->flat.two_d.dx = dx;
+      self->flat.two_d.dy = dy;
+    }
+  else
+    {
+      graphene_matrix_t m, result;
+
+      gsk_transform_to_matrix (self->next, &result);
+      self->transform_class->to_matrix (self, &m);
+      graphene_matrix_multiply (&m, &result, &result);
+
+      self->flat.matrix = g_new (float, 16);
+      graphene_matrix_to_float (&result, self->flat.matrix);
+    }
+
+  g_once_init_leave (&self->flattened, 1);
+}
+
 /**
  * gsk_transform_ref:
  * @self: (allow-none): a #GskTransform
@@ -1447,17 +1524,26 @@ void
 gsk_transform_to_matrix (GskTransform      *self,
                          graphene_matrix_t *out_matrix)
 {
-  graphene_matrix_t m;
-
   if (self == NULL)
     {
       graphene_matrix_init_identity (out_matrix);
       return;
     }
 
-  gsk_transform_to_matrix (self->next, out_matrix);
-  self->transform_class->to_matrix (self, &m);
-  graphene_matrix_multiply (&m, out_matrix, out_matrix);
+  gsk_transform_ensure_flattened (self);
+
+  if (self->category >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    graphene_matrix_init_from_2d (out_matrix,
+                                  self->flat.affine.scale_x, 0.0,
+                                  0.0, self->flat.affine.scale_y,
+                                  self->flat.affine.dx, self->flat.affine.dy);
+  else if (self->category == GSK_TRANSFORM_CATEGORY_2D)
+    graphene_matrix_init_from_2d (out_matrix,
+                                  self->flat.two_d.xx, self->flat.two_d.yx,
+                                  self->flat.two_d.xy, self->flat.two_d.yy,
+                                  self->flat.two_d.dx, self->flat.two_d.dy);
+  else
+    graphene_matrix_init_from_float (out_matrix, self->flat.matrix);
 }
 
 /**
@@ -1515,15 +1601,26 @@ gsk_transform_to_2d (GskTransform *self,
       return;
     }
 
-  gsk_transform_to_2d (self->next,
-                       out_xx, out_yx,
-                       out_xy, out_yy,
-                       out_dx, out_dy);
+  gsk_transform_ensure_flattened (self);
 
-  self->transform_class->apply_2d (self,
-                                   out_xx, out_yx,
-                                   out_xy, out_yy,
-                                   out_dx, out_dy);
+  if (self->category >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    {
+      *out_xx = self->flat.affine.scale_x;
+      *out_yx = 0.0f;
+      *out_xy = 0.0f;
+      *out_yy = self->flat.affine.scale_y;
+      *out_dx = self->flat.affine.dx;
+      *out_dy = self->flat.affine.dy;
+    }
+  else
+    {
+      *out_xx = self->flat.two_d.xx;
+      *out_yx = self->flat.two_d.yx;
+      *out_xy = self->flat.two_d.xy;
+      *out_yy = self->flat.two_d.yy;
+      *out_dx = self->flat.two_d.dx;
+      *out_dy = self->flat.two_d.dy;
+    }
 }
 
 /**
@@ -1573,23 +1670,12 @@ gsk_transform_to_affine (GskTransform *self,
       return;
     }
 
-  if (self->next != NULL)
-    {
-      gsk_transform_to_affine (self->next,
-                               out_scale_x, out_scale_y,
-                               out_dx, out_dy);
-    }
-  else
-    {
-      *out_scale_x = 1.0f;
-      *out_scale_y = 1.0f;
-      *out_dx = 0.0f;
-      *out_dy = 0.0f;
-    }
+  gsk_transform_ensure_flattened (self);
 
-  self->transform_class->apply_affine (self,
-                                       out_scale_x, out_scale_y,
-                                       out_dx, out_dy);
+  *out_scale_x = self->flat.affine.scale_x;
+  *out_scale_y = self->flat.affine.scale_y;
+  *out_dx = self->flat.affine.dx;
+  *out_dy = self->flat.affine.dy;
 }
 
 /**
@@ -1628,19 +1714,10 @@ gsk_transform_to_translate (GskTransform *self,
       return;
     }
 
-  if (self->next != NULL)
-    {
-      gsk_transform_to_translate (self->next,
-                                  out_dx, out_dy);
-    }
-  else
-    {
-      *out_dx = 0.0f;
-      *out_dy = 0.0f;
-    }
+  gsk_transform_ensure_flattened (self);
 
-  self->transform_class->apply_translate (self,
-                                          out_dx, out_dy);
+  *out_dx = self->flat.affine.dx;
+  *out_dy = self->flat.affine.dy;
 }
 
 /**
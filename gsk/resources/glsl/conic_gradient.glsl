@@ -1,15 +1,19 @@
 // VERTEX_SHADER
 uniform vec2 u_center;
 uniform float u_rotation;
+#ifndef GSK_GL3
 uniform float u_color_stops[6 * 5];
 uniform int u_num_color_stops;
+#endif
 
 const float PI = 3.1415926535897932384626433832795;
 
 _OUT_ vec2 center;
 _OUT_ float rotation;
+#ifndef GSK_GL3
 _OUT_ vec4 color_stops[6];
 _OUT_ float color_offsets[6];
+#endif
 
 void main() {
   gl_Position = u_projection * u_modelview * vec4(aPosition, 0.0, 1.0);
@@ -22,6 +26,7 @@ void main() {
 
   center = (u_modelview * vec4(u_center, 0, 1)).xy;
 
+#ifndef GSK_GL3
   for (int i = 0; i < u_num_color_stops; i ++) {
     color_offsets[i] = u_color_stops[(i * 5) + 0];
     color_stops[i] = gsk_premultiply(vec4(u_color_stops[(i * 5) + 1],
@@ -29,6 +34,7 @@ void main() {
                                           u_color_stops[(i * 5) + 3],
                                           u_color_stops[(i * 5) + 4]));
   }
+#endif
 }
 
 // FRAGMENT_SHADER:
@@ -42,8 +48,15 @@ const float PI = 3.1415926535897932384626433832795;
 
 _IN_ vec2 center;
 _IN_ float rotation;
+#ifdef GSK_GL3
+#define color_stop(i) gsk_color_stop_color(i)
+#define color_offset(i) gsk_color_stop_offset(i)
+#else
 _IN_ vec4 color_stops[6];
 _IN_ float color_offsets[6];
+#define color_stop(i) color_stops[i]
+#define color_offset(i) color_offsets[i]
+#endif
 
 void main() {
   // Position relative to center
@@ -57,11 +70,11 @@ void main() {
   // into the current conic
   float offset = fract (angle / 2.0 / PI + 2.0);
 
-  vec4 color = color_stops[0];
+  vec4 color = color_stop(0);
   for (int i = 1; i < u_num_color_stops; i ++) {
-    if (offset >= color_offsets[i - 1])  {
-      float o = (offset - color_offsets[i - 1]) / (color_offsets[i] - color_offsets[i - 1]);
-      color = mix(color_stops[i - 1], color_stops[i], clamp(o, 0.0, 1.0));
+    if (offset >= color_offset(i - 1))  {
+      float o = (offset - color_offset(i - 1)) / (color_offset(i) - color_offset(i - 1));
+      color = mix(color_stop(i - 1), color_stop(i), clamp(o, 0.0, 1.0));
     }
   }
 
@@ -1,16 +1,20 @@
 // VERTEX_SHADER
 uniform vec2 u_start_point;
 uniform vec2 u_end_point;
+#ifndef GSK_GL3
 uniform float u_color_stops[6 * 5];
 uniform int u_num_color_stops;
+#endif
 
 _OUT_ vec2 startPoint;
 _OUT_ vec2 endPoint;
 _OUT_ float maxDist;
 _OUT_ vec2 gradient;
 _OUT_ float gradientLength;
+#ifndef GSK_GL3
 _OUT_ vec4 color_stops[6];
 _OUT_ float color_offsets[6];
+#endif
 
 void main() {
   gl_Position = u_projection * u_modelview * vec4(aPosition, 0.0, 1.0);
@@ -23,6 +27,7 @@ void main() {
   gradient = endPoint - startPoint;
   gradientLength = length(gradient);
 
+#ifndef GSK_GL3
   for (int i = 0; i < u_num_color_stops; i ++) {
     color_offsets[i] = u_color_stops[(i * 5) + 0];
     color_stops[i] = gsk_premultiply(vec4(u_color_stops[(i * 5) + 1],
@@ -30,6 +35,7 @@ void main() {
                                           u_color_stops[(i * 5) + 3],
                                           u_color_stops[(i * 5) + 4]));
   }
+#endif
 }
 
 // FRAGMENT_SHADER:
@@ -44,8 +50,15 @@ _IN_ vec2 endPoint;
 _IN_ float maxDist;
 _IN_ vec2 gradient;
 _IN_ float gradientLength;
+#ifdef GSK_GL3
+#define color_stop(i) gsk_color_stop_color(i)
+#define color_offset(i) gsk_color_stop_offset(i)
+#else
 _IN_ vec4 color_stops[6];
 _IN_ float color_offsets[6];
+#define color_stop(i) color_stops[i]
+#define color_offset(i) color_offsets[i]
+#endif
 
 void main() {
   // Position relative to startPoint
@@ -58,11 +71,11 @@ void main() {
   // Offset of the current pixel
   float offset = length(proj) / maxDist;
 
-  vec4 color = color_stops[0];
+  vec4 color = color_stop(0);
   for (int i = 1; i < u_num_color_stops; i ++) {
-    if (offset >= color_offsets[i - 1])  {
-      float o = (offset - color_offsets[i - 1]) / (color_offsets[i] - color_offsets[i - 1]);
-      color = mix(color_stops[i - 1], color_stops[i], clamp(o, 0.0, 1.0));
+    if (offset >= color_offset(i - 1))  {
+      float o = (offset - color_offset(i - 1)) / (color_offset(i) - color_offset(i - 1));
+      color = mix(color_stop(i - 1), color_stop(i), clamp(o, 0.0, 1.0));
     }
   }
 
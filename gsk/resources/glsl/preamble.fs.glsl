@@ -13,6 +13,26 @@ _OUT_ vec4 outputColor;
 
 _IN_ vec2 vUv;
 
+#ifdef GSK_GL3
+// Keep in sync with GL_MAX_UBO_GRADIENT_STOPS
+#define GSK_MAX_COLOR_STOPS 64
+
+// Gradient color stops, as written by ops_add_color_stops():
+// offset in .x of the first vec4, non-premultiplied color in the second
+layout(std140) uniform GskColorStops
+{
+  vec4 u_color_stop_data[GSK_MAX_COLOR_STOPS * 2];
+};
+
+float gsk_color_stop_offset(int i) {
+  return u_color_stop_data[i * 2].x;
+}
+
+vec4 gsk_color_stop_color(int i) {
+  return gsk_premultiply(u_color_stop_data[(i * 2) + 1]);
+}
+#endif
+
 
 
 GskRoundedRect gsk_decode_rect(_GSK_ROUNDED_RECT_UNIFORM_ r)
@@ -1,14 +1,18 @@
 // VERTEX_SHADER
 uniform float u_start;
 uniform float u_end;
+#ifndef GSK_GL3
 uniform float u_color_stops[6 * 5];
 uniform int u_num_color_stops;
+#endif
 uniform vec2 u_radius;
 uniform vec2 u_center;
 
 _OUT_ vec2 center;
+#ifndef GSK_GL3
 _OUT_ vec4 color_stops[6];
 _OUT_ float color_offsets[6];
+#endif
 _OUT_ float start;
 _OUT_ float end;
 
@@ -19,6 +23,7 @@ void main() {
   start = u_start;
   end = u_end;
 
+#ifndef GSK_GL3
   for (int i = 0; i < u_num_color_stops; i ++) {
     color_offsets[i] = u_color_stops[(i * 5) + 0];
     color_stops[i] = gsk_premultiply(vec4(u_color_stops[(i * 5) + 1],
@@ -26,6 +31,7 @@ void main() {
                                           u_color_stops[(i * 5) + 3],
                                           u_color_stops[(i * 5) + 4]));
   }
+#endif
 }
 
 // FRAGMENT_SHADER:
@@ -39,8 +45,15 @@ uniform vec2 u_radius;
 uniform float u_end;
 
 _IN_ vec2 center;
+#ifdef GSK_GL3
+#define color_stop(i) gsk_color_stop_color(i)
+#define color_offset(i) gsk_color_stop_offset(i)
+#else
 _IN_ vec4 color_stops[6];
 _IN_ float color_offsets[6];
+#define color_stop(i) color_stops[i]
+#define color_offset(i) color_offsets[i]
+#endif
 _IN_ float start;
 _IN_ float end;
 
@@ -55,27 +68,27 @@ void main() {
   vec2 rel = (center - pixel) / (u_radius);
   float d = sqrt(dot(rel, rel));
 
-  if (d < abs_offset (color_offsets[0])) {
-    gskSetOutputColor(color_stops[0] * u_alpha);
+  if (d < abs_offset (color_offset(0))) {
+    gskSetOutputColor(color_stop(0) * u_alpha);
     return;
   }
 
   if (d > end) {
-    gskSetOutputColor(color_stops[u_num_color_stops - 1] * u_alpha);
+    gskSetOutputColor(color_stop(u_num_color_stops - 1) * u_alpha);
     return;
   }
 
   vec4 color = vec4(0, 0, 0, 0);
   for (int i = 1; i < u_num_color_stops; i++) {
-    float last_offset = abs_offset(color_offsets[i - 1]);
-    float this_offset = abs_offset(color_offsets[i]);
+    float last_offset = abs_offset(color_offset(i - 1));
+    float this_offset = abs_offset(color_offset(i));
 
     // We have color_stops[i - 1] at last_offset and color_stops[i] at this_offset.
     // We now need to map `d` between those two offsets and simply mix linearly between them
     if (d >= last_offset && d <= this_offset) {
       float f = (d - last_offset) / (this_offset - last_offset);
 
-      color = mix(color_stops[i - 1], color_stops[i], f);
+      color = mix(color_stop(i - 1), color_stop(i), f);
       break;
     }
   }
@@ -16,9 +16,10 @@ struct _GskVulkanBuffer
 };
 
 static GskVulkanBuffer *
-gsk_vulkan_buffer_new_internal (GdkVulkanContext  *context,
-                                gsize              size,
-                                VkBufferUsageFlags usage)
+gsk_vulkan_buffer_new_internal (GdkVulkanContext    *context,
+                                gsize                size,
+                                VkBufferUsageFlags   usage,
+                                GskVulkanMemoryPool  pool)
 {
   VkMemoryRequirements requirements;
   GskVulkanBuffer *self;
@@ -44,14 +45,14 @@ gsk_vulkan_buffer_new_internal (GdkVulkanContext  *context,
                                  &requirements);
 
   self->memory = gsk_vulkan_memory_new (context,
-                                        requirements.memoryTypeBits,
-                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                        size);
+                                        pool,
+                                        &requirements,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
   GSK_VK_CHECK (vkBindBufferMemory, gdk_vulkan_context_get_device (context),
                                     self->vk_buffer,
                                     gsk_vulkan_memory_get_device_memory (self->memory),
-                                    0);
+                                    gsk_vulkan_memory_get_offset (self->memory));
   return self;
 }
 
@@ -61,21 +62,26 @@ gsk_vulkan_buffer_new (GdkVulkanContext  *context,
 {
   return gsk_vulkan_buffer_new_internal (context, size,
                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
-                                         | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+                                         | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                         GSK_VULKAN_MEMORY_POOL_VERTEX);
 }
 
 GskVulkanBuffer *
 gsk_vulkan_buffer_new_staging (GdkVulkanContext  *context,
                                gsize              size)
 {
-  return gsk_vulkan_buffer_new_internal (context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+  return gsk_vulkan_buffer_new_internal (context, size,
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                         GSK_VULKAN_MEMORY_POOL_STAGING);
 }
 
 GskVulkanBuffer *
 gsk_vulkan_buffer_new_download (GdkVulkanContext  *context,
                                 gsize              size)
 {
-  return gsk_vulkan_buffer_new_internal (context, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+  return gsk_vulkan_buffer_new_internal (context, size,
+                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         GSK_VULKAN_MEMORY_POOL_STAGING);
 }
 void
 gsk_vulkan_buffer_free (GskVulkanBuffer *self)
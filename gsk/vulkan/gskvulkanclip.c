@@ -4,6 +4,8 @@
 
 #include "gskroundedrectprivate.h"
 
+#include <math.h>
+
 void
 gsk_vulkan_clip_init_empty (GskVulkanClip         *clip,
                             const graphene_rect_t *rect)
@@ -20,6 +22,208 @@ gsk_vulkan_clip_init_copy (GskVulkanClip *self,
   gsk_rounded_rect_init_copy (&self->rect, &src->rect);
 }
 
+/* The point of the bounds at the given corner */
+static void
+rounded_rect_get_corner_point (const GskRoundedRect *rect,
+                               GskCorner             corner,
+                               graphene_point_t     *point)
+{
+  const graphene_rect_t *b = &rect->bounds;
+
+  point->x = corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_BOTTOM_LEFT
+             ? b->origin.x : b->origin.x + b->size.width;
+  point->y = corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_TOP_RIGHT
+             ? b->origin.y : b->origin.y + b->size.height;
+}
+
+static void
+rounded_rect_get_corner_box (const GskRoundedRect *rect,
+                             GskCorner             corner,
+                             graphene_rect_t      *box)
+{
+  graphene_point_t p;
+  const graphene_size_t *size = &rect->corner[corner];
+
+  rounded_rect_get_corner_point (rect, corner, &p);
+
+  graphene_rect_init (box,
+                      corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_BOTTOM_LEFT
+                      ? p.x : p.x - size->width,
+                      corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_TOP_RIGHT
+                      ? p.y : p.y - size->height,
+                      size->width,
+                      size->height);
+}
+
+static gboolean
+rounded_rect_owns_corner (const GskRoundedRect *rect,
+                          GskCorner             corner,
+                          const GskRoundedRect *result)
+{
+  graphene_point_t p, q;
+
+  rounded_rect_get_corner_point (rect, corner, &p);
+  rounded_rect_get_corner_point (result, corner, &q);
+
+  return p.x == q.x && p.y == q.y;
+}
+
+/* Checks that the side of @result that starts at corner @start and ends
+ * at the next corner lies on a straight part of the outline of @rect and
+ * inside of @other.
+ */
+static gboolean
+rounded_rect_has_side (const GskRoundedRect *rect,
+                       const GskRoundedRect *other,
+                       GskCorner             start,
+                       const GskRoundedRect *result)
+{
+  GskCorner end = (start + 1) % 4;
+  graphene_point_t p, q, rp, rq;
+  graphene_rect_t segment;
+
+  rounded_rect_get_corner_point (result, start, &p);
+  rounded_rect_get_corner_point (result, end, &q);
+  rounded_rect_get_corner_point (rect, start, &rp);
+  rounded_rect_get_corner_point (rect, end, &rq);
+
+  switch (start)
+    {
+    case GSK_CORNER_TOP_LEFT:
+      if (p.y != rp.y)
+        return FALSE;
+      p.x += result->corner[start].width;
+      q.x -= result->corner[end].width;
+      if (p.x > q.x ||
+          p.x < rp.x + rect->corner[start].width ||
+          q.x > rq.x - rect->corner[end].width)
+        return FALSE;
+      break;
+
+    case GSK_CORNER_TOP_RIGHT:
+      if (p.x != rp.x)
+        return FALSE;
+      p.y += result->corner[start].height;
+      q.y -= result->corner[end].height;
+      if (p.y > q.y ||
+          p.y < rp.y + rect->corner[start].height ||
+          q.y > rq.y - rect->corner[end].height)
+        return FALSE;
+      break;
+
+    case GSK_CORNER_BOTTOM_RIGHT:
+      if (p.y != rp.y)
+        return FALSE;
+      p.x -= result->corner[start].width;
+      q.x += result->corner[end].width;
+      if (q.x > p.x ||
+          p.x > rp.x - rect->corner[start].width ||
+          q.x < rq.x + rect->corner[end].width)
+        return FALSE;
+      break;
+
+    case GSK_CORNER_BOTTOM_LEFT:
+      if (p.x != rp.x)
+        return FALSE;
+      p.y -= result->corner[start].height;
+      q.y += result->corner[end].height;
+      if (q.y > p.y ||
+          p.y > rp.y - rect->corner[start].height ||
+          q.y < rq.y + rect->corner[end].height)
+        return FALSE;
+      break;
+
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+
+  graphene_rect_init (&segment, MIN (p.x, q.x), MIN (p.y, q.y), fabsf (q.x - p.x), fabsf (q.y - p.y));
+
+  return gsk_rounded_rect_contains_rect (other, &segment);
+}
+
+/* Computes the intersection of two rounded rects, if it is a rounded
+ * rect itself. This is the case if every part of the outline of the
+ * result is a part of the outline of one of the rects and inside the
+ * other one.
+ * Either rect may be a plain rectangle with all corners of size 0.
+ */
+static gboolean
+gsk_vulkan_clip_intersect_rounded_rects (GskRoundedRect       *dest,
+                                         const GskRoundedRect *a,
+                                         const GskRoundedRect *b)
+{
+  GskRoundedRect result;
+  GskCorner i;
+
+  if (!graphene_rect_intersection (&a->bounds, &b->bounds, &result.bounds))
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      gboolean a_owns = rounded_rect_owns_corner (a, i, &result);
+      gboolean b_owns = rounded_rect_owns_corner (b, i, &result);
+      graphene_rect_t box;
+
+      if (a_owns && b_owns)
+        {
+          /* the bigger corner cuts off the smaller one */
+          if (a->corner[i].width >= b->corner[i].width &&
+              a->corner[i].height >= b->corner[i].height)
+            result.corner[i] = a->corner[i];
+          else if (b->corner[i].width >= a->corner[i].width &&
+                   b->corner[i].height >= a->corner[i].height)
+            result.corner[i] = b->corner[i];
+          else
+            return FALSE;
+        }
+      else if (a_owns || b_owns)
+        {
+          const GskRoundedRect *rect = a_owns ? a : b;
+          const GskRoundedRect *other = a_owns ? b : a;
+
+          rounded_rect_get_corner_box (rect, i, &box);
+          if (!gsk_rounded_rect_contains_rect (other, &box))
+            return FALSE;
+
+          result.corner[i] = rect->corner[i];
+        }
+      else
+        {
+          /* the sides meet in a square corner, the sides check
+           * that it is inside of both rects
+           */
+          graphene_size_init (&result.corner[i], 0, 0);
+        }
+    }
+
+  for (i = 0; i < 4; i++)
+    {
+      if (!rounded_rect_has_side (a, b, i, &result) &&
+          !rounded_rect_has_side (b, a, i, &result))
+        return FALSE;
+    }
+
+  gsk_rounded_rect_init_copy (dest, &result);
+
+  return TRUE;
+}
+
+static void
+gsk_vulkan_clip_init_rounded (GskVulkanClip        *self,
+                              const GskRoundedRect *rounded)
+{
+  gsk_rounded_rect_init_copy (&self->rect, rounded);
+
+  if (gsk_rounded_rect_is_rectilinear (rounded))
+    self->type = GSK_VULKAN_CLIP_RECT;
+  else if (gsk_rounded_rect_is_circular (rounded))
+    self->type = GSK_VULKAN_CLIP_ROUNDED_CIRCULAR;
+  else
+    self->type = GSK_VULKAN_CLIP_ROUNDED;
+}
+
 gboolean
 gsk_vulkan_clip_intersect_rect (GskVulkanClip         *dest,
                                 const GskVulkanClip   *src,
@@ -67,10 +271,14 @@ gsk_vulkan_clip_intersect_rect (GskVulkanClip         *dest,
         {
           /* some points of rect are inside src's rounded rect,
            * some are outside. */
-          /* XXX: If the 2 rects don't intersect on rounded corners,
-           * we could actually compute a new clip here.
-           */
-          return FALSE;
+          GskRoundedRect result;
+
+          if (!gsk_vulkan_clip_intersect_rounded_rects (&result,
+                                                        &src->rect,
+                                                        &GSK_ROUNDED_RECT_INIT_FROM_RECT (*rect)))
+            return FALSE;
+
+          gsk_vulkan_clip_init_rounded (dest, &result);
         }
       break;
 
@@ -105,28 +313,33 @@ gsk_vulkan_clip_intersect_rounded_rect (GskVulkanClip        *dest,
       break;
 
     case GSK_VULKAN_CLIP_NONE:
-      dest->type = gsk_rounded_rect_is_circular (&dest->rect) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
+      dest->type = gsk_rounded_rect_is_circular (rounded) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
       gsk_rounded_rect_init_copy (&dest->rect, rounded);
       break;
 
     case GSK_VULKAN_CLIP_RECT:
       if (graphene_rect_contains_rect (&src->rect.bounds, &rounded->bounds))
         {
-          dest->type = gsk_rounded_rect_is_circular (&dest->rect) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
+          dest->type = gsk_rounded_rect_is_circular (rounded) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
           gsk_rounded_rect_init_copy (&dest->rect, rounded);
           return TRUE;
         }
-      /* some points of rect are inside src's rounded rect,
-       * some are outside. */
-      /* XXX: If the 2 rects don't intersect on rounded corners,
-       * we could actually compute a new clip here.
-       */
-      return FALSE;
+      G_GNUC_FALLTHROUGH;
 
     case GSK_VULKAN_CLIP_ROUNDED_CIRCULAR:
     case GSK_VULKAN_CLIP_ROUNDED:
-      /* XXX: improve */
-      return FALSE;
+      {
+        GskRoundedRect result;
+
+        /* The rounded rects intersect without one containing the other.
+         * This is fine as long as their corners don't overlap.
+         */
+        if (!gsk_vulkan_clip_intersect_rounded_rects (&result, &src->rect, rounded))
+          return FALSE;
+
+        gsk_vulkan_clip_init_rounded (dest, &result);
+      }
+      break;
 
     default:
       g_assert_not_reached ();
@@ -127,6 +127,7 @@ gsk_vulkan_color_text_pipeline_collect_vertex_data (GskVulkanColorTextPipeline *
           glyph = gsk_vulkan_renderer_get_cached_glyph (renderer,
                                                         font,
                                                         gi->glyph,
+                                                        TRUE,
                                                         x_position + gi->geometry.x_offset,
                                                         gi->geometry.y_offset,
                                                         scale);
@@ -16,11 +16,16 @@
  * count of the pixels of each atlas that are taken up by old glyphs. We check the
  * fraction of old pixels every CHECK_INTERVAL frames, and if it is above MAX_OLD, then
  * we drop the atlas an all the glyphs contained in it from the cache.
+ *
+ * On top of that, we keep at most MAX_ATLASES atlases. When all of them are
+ * full, the one that has gone unused for the longest time is emptied and
+ * reused, unless it was used for the current frame.
  */
 
 #define MAX_AGE 60
 #define CHECK_INTERVAL 10
 #define MAX_OLD 0.333
+#define MAX_ATLASES 8
 
 
 typedef struct {
@@ -30,6 +35,9 @@ typedef struct {
   int num_glyphs;
   GList *dirty_glyphs;
   guint old_pixels;
+  /* color glyphs are kept in BGRA atlases, all others only need a mask */
+  gboolean color;
+  guint64 timestamp;
 } Atlas;
 
 struct _GskVulkanGlyphCache {
@@ -58,7 +66,8 @@ static void     glyph_cache_value_free (gpointer      v);
 static void     dirty_glyph_free       (gpointer      v);
 
 static Atlas *
-create_atlas (GskVulkanGlyphCache *cache)
+create_atlas (GskVulkanGlyphCache *cache,
+              gboolean             color)
 {
   Atlas *atlas;
 
@@ -71,6 +80,8 @@ create_atlas (GskVulkanGlyphCache *cache)
   atlas->image = NULL;
   atlas->num_glyphs = 0;
   atlas->dirty_glyphs = NULL;
+  atlas->color = color;
+  atlas->timestamp = cache->timestamp;
 
   return atlas;
 }
@@ -118,6 +129,7 @@ typedef struct {
   guint xshift;
   guint yshift;
   guint scale; /* times 1024 */
+  gboolean color;
 } GlyphCacheKey;
 
 static gboolean
@@ -130,7 +142,8 @@ glyph_cache_equal (gconstpointer v1, gconstpointer v2)
          key1->glyph == key2->glyph &&
          key1->xshift == key2->xshift &&
          key1->yshift == key2->yshift &&
-         key1->scale == key2->scale;
+         key1->scale == key2->scale &&
+         key1->color == key2->color;
 }
 
 static guint
@@ -138,7 +151,7 @@ glyph_cache_hash (gconstpointer v)
 {
   const GlyphCacheKey *key = v;
 
-  return GPOINTER_TO_UINT (key->font) ^ key->glyph ^ (key->xshift << 24) ^ (key->yshift << 26) ^ key->scale;
+  return GPOINTER_TO_UINT (key->font) ^ key->glyph ^ (key->xshift << 24) ^ (key->yshift << 26) ^ key->scale ^ ((guint) key->color << 31);
 }
 
 static void
@@ -172,6 +185,67 @@ dirty_glyph_free (gpointer v)
   g_free (glyph);
 }
 
+/* Empties the atlas that was used least recently, so that it can
+ * be reused for glyphs of the given kind. Atlases in use for the
+ * current frame are left alone, their texture indices are already
+ * part of the frame's render ops. Returns the index of the atlas,
+ * or -1 if there was none to evict.
+ */
+static int
+evict_atlas (GskVulkanGlyphCache *cache,
+             gboolean             color)
+{
+  GHashTableIter iter;
+  GlyphCacheKey *key;
+  GskVulkanCachedGlyph *value;
+  Atlas *atlas = NULL;
+  int i, lru = -1;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      Atlas *a = g_ptr_array_index (cache->atlases, i);
+
+      if (a->timestamp == cache->timestamp)
+        continue;
+
+      if (atlas == NULL || a->timestamp < atlas->timestamp)
+        {
+          atlas = a;
+          lru = i;
+        }
+    }
+
+  if (atlas == NULL)
+    return -1;
+
+  GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
+            g_message ("Evicting atlas %d (unused for %" G_GUINT64_FORMAT " frames)",
+                       lru, cache->timestamp - atlas->timestamp));
+
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+    {
+      if (value->texture_index == lru && value->tw > 0)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  /* Frames still in flight may hold a reference to the old image,
+   * so we get a new one instead of writing over it.
+   */
+  g_clear_object (&atlas->image);
+  g_list_free_full (atlas->dirty_glyphs, dirty_glyph_free);
+  atlas->dirty_glyphs = NULL;
+  atlas->y0 = 1;
+  atlas->y = 1;
+  atlas->x = 1;
+  atlas->num_glyphs = 0;
+  atlas->old_pixels = 0;
+  atlas->color = color;
+  atlas->timestamp = cache->timestamp;
+
+  return lru;
+}
+
 static void
 add_to_cache (GskVulkanGlyphCache  *cache,
               GlyphCacheKey        *key,
@@ -188,6 +262,9 @@ add_to_cache (GskVulkanGlyphCache  *cache,
       int x, y, y0;
 
       atlas = g_ptr_array_index (cache->atlases, i);
+      if (atlas->color != key->color)
+        continue;
+
       x = atlas->x;
       y = atlas->y;
       y0 = atlas->y0;
@@ -210,10 +287,24 @@ add_to_cache (GskVulkanGlyphCache  *cache,
 
   if (i == cache->atlases->len)
     {
-      atlas = create_atlas (cache);
-      g_ptr_array_add (cache->atlases, atlas);
+      i = -1;
+      if (cache->atlases->len >= MAX_ATLASES)
+        i = evict_atlas (cache, key->color);
+
+      if (i >= 0)
+        {
+          atlas = g_ptr_array_index (cache->atlases, i);
+        }
+      else
+        {
+          i = cache->atlases->len;
+          atlas = create_atlas (cache, key->color);
+          g_ptr_array_add (cache->atlases, atlas);
+        }
     }
 
+  atlas->timestamp = cache->timestamp;
+
   value->tx = (float)atlas->x / atlas->width;
   value->ty = (float)atlas->y0 / atlas->height;
   value->tw = (float)width / atlas->width;
@@ -238,8 +329,8 @@ add_to_cache (GskVulkanGlyphCache  *cache,
       for (i = 0; i < cache->atlases->len; i++)
         {
           atlas = g_ptr_array_index (cache->atlases, i);
-          g_print ("\tAtlas %d (%dx%d): %d glyphs (%d dirty), %.2g%% old pixels, filled to %d, %d / %d\n",
-                   i, atlas->width, atlas->height,
+          g_print ("\tAtlas %d (%dx%d, %s): %d glyphs (%d dirty), %.2g%% old pixels, filled to %d, %d / %d\n",
+                   i, atlas->width, atlas->height, atlas->color ? "color" : "mask",
                    atlas->num_glyphs, g_list_length (atlas->dirty_glyphs),
                    100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height),
                    atlas->x, atlas->y0, atlas->y);
@@ -260,7 +351,7 @@ render_glyph (Atlas          *atlas,
   PangoGlyphString glyphs;
   PangoGlyphInfo gi;
 
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+  surface = cairo_image_surface_create (atlas->color ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_A8,
                                         value->draw_width * key->scale / 1024,
                                         value->draw_height * key->scale / 1024);
   cairo_surface_set_device_scale (surface, key->scale / 1024.0, key->scale / 1024.0);
@@ -293,6 +384,17 @@ render_glyph (Atlas          *atlas,
   region->y = (gsize)(value->ty * atlas->height);
 }
 
+static void
+ensure_atlas_image (GskVulkanGlyphCache *cache,
+                    Atlas               *atlas)
+{
+  if (atlas->image == NULL)
+    atlas->image = gsk_vulkan_image_new_for_atlas (cache->vulkan,
+                                                   atlas->width, atlas->height,
+                                                   atlas->color ? VK_FORMAT_B8G8R8A8_UNORM
+                                                                : VK_FORMAT_R8_UNORM);
+}
+
 static void
 upload_dirty_glyphs (GskVulkanGlyphCache *cache,
                      Atlas               *atlas,
@@ -312,6 +414,8 @@ upload_dirty_glyphs (GskVulkanGlyphCache *cache,
   GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
             g_message ("uploading %d glyphs to cache", num_regions));
 
+  ensure_atlas_image (cache, atlas);
+
   gsk_vulkan_image_upload_regions (atlas->image, uploader, num_regions, regions);
 
   g_list_free_full (atlas->dirty_glyphs, dirty_glyph_free);
@@ -327,7 +431,7 @@ gsk_vulkan_glyph_cache_new (GskRenderer      *renderer,
   cache = GSK_VULKAN_GLYPH_CACHE (g_object_new (GSK_TYPE_VULKAN_GLYPH_CACHE, NULL));
   cache->renderer = renderer;
   cache->vulkan = vulkan;
-  g_ptr_array_add (cache->atlases, create_atlas (cache));
+  g_ptr_array_add (cache->atlases, create_atlas (cache, FALSE));
 
   return cache;
 }
@@ -339,6 +443,7 @@ gsk_vulkan_glyph_cache_lookup (GskVulkanGlyphCache *cache,
                                gboolean             create,
                                PangoFont           *font,
                                PangoGlyph           glyph,
+                               gboolean             color,
                                int                  x,
                                int                  y,
                                float                scale)
@@ -356,11 +461,19 @@ gsk_vulkan_glyph_cache_lookup (GskVulkanGlyphCache *cache,
   lookup_key.xshift = xshift;
   lookup_key.yshift = yshift;
   lookup_key.scale = (guint)(scale * 1024);
+  lookup_key.color = color;
 
   value = g_hash_table_lookup (cache->hash_table, &lookup_key);
 
   if (value)
     {
+      if (value->tw > 0)
+        {
+          Atlas *atlas = g_ptr_array_index (cache->atlases, value->texture_index);
+
+          atlas->timestamp = cache->timestamp;
+        }
+
       if (cache->timestamp - value->timestamp >= MAX_AGE)
         {
           Atlas *atlas = g_ptr_array_index (cache->atlases, value->texture_index);
@@ -392,6 +505,7 @@ gsk_vulkan_glyph_cache_lookup (GskVulkanGlyphCache *cache,
       key->xshift = xshift;
       key->yshift = yshift;
       key->scale = (guint)(scale * 1024);
+      key->color = color;
 
       if (ink_rect.width > 0 && ink_rect.height > 0)
         add_to_cache (cache, key, value);
@@ -402,6 +516,25 @@ gsk_vulkan_glyph_cache_lookup (GskVulkanGlyphCache *cache,
   return value;
 }
 
+/* Uploads the glyphs that were added to the cache since the last
+ * upload. This is done once per frame, before any of the glyphs
+ * are needed, so there is a single copy per atlas that was changed.
+ */
+void
+gsk_vulkan_glyph_cache_upload (GskVulkanGlyphCache *cache,
+                               GskVulkanUploader   *uploader)
+{
+  guint i;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      Atlas *atlas = g_ptr_array_index (cache->atlases, i);
+
+      if (atlas->dirty_glyphs)
+        upload_dirty_glyphs (cache, atlas, uploader);
+    }
+}
+
 GskVulkanImage *
 gsk_vulkan_glyph_cache_get_glyph_image (GskVulkanGlyphCache *cache,
                                         GskVulkanUploader   *uploader,
@@ -413,12 +546,12 @@ gsk_vulkan_glyph_cache_get_glyph_image (GskVulkanGlyphCache *cache,
 
   atlas = g_ptr_array_index (cache->atlases, index);
 
-  if (atlas->image == NULL)
-    atlas->image = gsk_vulkan_image_new_for_atlas (cache->vulkan, atlas->width, atlas->height);
-
+  /* Glyphs of offscreen passes that were added during the upload */
   if (atlas->dirty_glyphs)
     upload_dirty_glyphs (cache, atlas, uploader);
 
+  ensure_atlas_image (cache, atlas);
+
   return atlas->image;
 }
 
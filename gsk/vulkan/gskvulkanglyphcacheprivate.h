@@ -14,6 +14,9 @@ G_DECLARE_FINAL_TYPE(GskVulkanGlyphCache, gsk_vulkan_glyph_cache, GSK, VULKAN_GL
 GskVulkanGlyphCache  *gsk_vulkan_glyph_cache_new            (GskRenderer         *renderer,
                                                              GdkVulkanContext    *vulkan);
 
+void                  gsk_vulkan_glyph_cache_upload         (GskVulkanGlyphCache *cache,
+                                                             GskVulkanUploader   *uploader);
+
 GskVulkanImage *     gsk_vulkan_glyph_cache_get_glyph_image (GskVulkanGlyphCache *cache,
                                                              GskVulkanUploader   *uploader,
                                                              guint                index);
@@ -22,9 +25,9 @@ GskVulkanCachedGlyph *gsk_vulkan_glyph_cache_lookup         (GskVulkanGlyphCache
                                                              gboolean             create,
                                                              PangoFont           *font,
                                                              PangoGlyph           glyph,
+                                                             gboolean             color,
                                                              int                  x,
                                                              int                  y,
-
                                                              float                scale);
 
 void                  gsk_vulkan_glyph_cache_begin_frame    (GskVulkanGlyphCache *cache);
@@ -6,6 +6,9 @@
 #include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 
+#include "gdk/gdktextureprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+
 #include <string.h>
 
 struct _GskVulkanUploader
@@ -32,6 +35,7 @@ struct _GskVulkanImage
 
   gsize width;
   gsize height;
+  VkFormat vk_format;
   VkImageUsageFlags vk_usage;
   VkImage vk_image;
   VkImageView vk_image_view;
@@ -200,6 +204,7 @@ static GskVulkanImage *
 gsk_vulkan_image_new (GdkVulkanContext      *context,
                       gsize                  width,
                       gsize                  height,
+                      VkFormat               format,
                       VkImageTiling          tiling,
                       VkImageUsageFlags      usage,
                       VkImageLayout          layout,
@@ -214,6 +219,7 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
   self->vulkan = g_object_ref (context);
   self->width = width;
   self->height = height;
+  self->vk_format = format;
   self->vk_usage = usage;
   self->vk_image_layout = layout;
   self->vk_access = access;
@@ -223,7 +229,7 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                     .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
                                     .flags = 0,
                                     .imageType = VK_IMAGE_TYPE_2D,
-                                    .format = VK_FORMAT_B8G8R8A8_UNORM,
+                                    .format = format,
                                     .extent = { width, height, 1 },
                                     .mipLevels = 1,
                                     .arrayLayers = 1,
@@ -241,50 +247,73 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                 &requirements);
 
   self->memory = gsk_vulkan_memory_new (context,
-                                        requirements.memoryTypeBits,
-                                        memory,
-                                        requirements.size);
+                                        GSK_VULKAN_MEMORY_POOL_IMAGE,
+                                        &requirements,
+                                        memory);
 
   GSK_VK_CHECK (vkBindImageMemory, gdk_vulkan_context_get_device (context),
                                    self->vk_image,
                                    gsk_vulkan_memory_get_device_memory (self->memory),
-                                   0);
+                                   gsk_vulkan_memory_get_offset (self->memory));
   return self;
 }
 
+/* Copies the data into mapped memory of a VK_FORMAT_B8G8R8A8_UNORM
+ * image or buffer, converting it on the way if it comes in a different
+ * format, so that it doesn't need to be converted beforehand
+ */
 static void
-gsk_vulkan_image_upload_data (GskVulkanImage *self,
-                              guchar         *data,
-                              gsize           width,
-                              gsize           height,
-                              gsize           data_stride)
+gsk_vulkan_copy_data (guchar          *mem,
+                      gsize            mem_stride,
+                      const guchar    *data,
+                      gsize            data_stride,
+                      GdkMemoryFormat  format,
+                      gsize            width,
+                      gsize            height)
+{
+  if (format != GDK_MEMORY_B8G8R8A8_PREMULTIPLIED)
+    {
+      gdk_memory_convert (mem, mem_stride, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED,
+                          data, data_stride, format,
+                          width, height);
+    }
+  else if (mem_stride == width * 4 && data_stride == mem_stride)
+    {
+      memcpy (mem, data, data_stride * height);
+    }
+  else
+    {
+      for (gsize i = 0; i < height; i++)
+        {
+          memcpy (mem + i * mem_stride, data + i * data_stride, width * 4);
+        }
+    }
+}
+
+static void
+gsk_vulkan_image_upload_data (GskVulkanImage  *self,
+                              const guchar    *data,
+                              GdkMemoryFormat  format,
+                              gsize            width,
+                              gsize            height,
+                              gsize            data_stride)
 {
   VkImageSubresource image_res;
   VkSubresourceLayout image_layout;
-  gsize mem_stride;
   guchar *mem;
 
   image_res.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   image_res.mipLevel = 0;
   image_res.arrayLayer = 0;
 
-  mem_stride = width * 4;
   vkGetImageSubresourceLayout (gdk_vulkan_context_get_device (self->vulkan),
                                self->vk_image, &image_res, &image_layout);
 
   mem = gsk_vulkan_memory_map (self->memory) + image_layout.offset;
 
-  if (image_layout.rowPitch == width * 4 && data_stride == mem_stride)
-    {
-      memcpy (mem, data, data_stride * height);
-    }
-  else
-    {
-      for (gsize i = 0; i < height; i++)
-        {
-          memcpy (mem + i * image_layout.rowPitch, data + i * data_stride, width * 4);
-        }
-    }
+  gsk_vulkan_copy_data (mem, image_layout.rowPitch,
+                        data, data_stride, format,
+                        width, height);
 
   gsk_vulkan_memory_unmap (self->memory);
 }
@@ -293,6 +322,17 @@ static void
 gsk_vulkan_image_ensure_view (GskVulkanImage *self,
                               VkFormat        format)
 {
+  /* Single channel images hold a mask. Reading them as premultiplied
+   * white keeps them usable with the shaders written for BGRA images.
+   */
+  VkComponentSwizzle r = VK_COMPONENT_SWIZZLE_R;
+  VkComponentSwizzle g = VK_COMPONENT_SWIZZLE_G;
+  VkComponentSwizzle b = VK_COMPONENT_SWIZZLE_B;
+  VkComponentSwizzle a = VK_COMPONENT_SWIZZLE_A;
+
+  if (format == VK_FORMAT_R8_UNORM)
+    g = b = a = VK_COMPONENT_SWIZZLE_R;
+
   if (self->vk_image_view == VK_NULL_HANDLE)
     GSK_VK_CHECK (vkCreateImageView, gdk_vulkan_context_get_device (self->vulkan),
                                    &(VkImageViewCreateInfo) {
@@ -301,10 +341,10 @@ gsk_vulkan_image_ensure_view (GskVulkanImage *self,
                                        .viewType = VK_IMAGE_VIEW_TYPE_2D,
                                        .format = format,
                                        .components = {
-                                           .r = VK_COMPONENT_SWIZZLE_R,
-                                           .g = VK_COMPONENT_SWIZZLE_G,
-                                           .b = VK_COMPONENT_SWIZZLE_B,
-                                           .a = VK_COMPONENT_SWIZZLE_A,
+                                           .r = r,
+                                           .g = g,
+                                           .b = b,
+                                           .a = a,
                                        },
                                        .subresourceRange = {
                                            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -320,7 +360,8 @@ gsk_vulkan_image_ensure_view (GskVulkanImage *self,
 
 static GskVulkanImage *
 gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
-                                                   guchar            *data,
+                                                   const guchar      *data,
+                                                   GdkMemoryFormat    format,
                                                    gsize              width,
                                                    gsize              height,
                                                    gsize              stride)
@@ -333,17 +374,9 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
   staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, buffer_size);
   mem = gsk_vulkan_buffer_map (staging);
 
-  if (stride == width * 4)
-    {
-      memcpy (mem, data, stride * height);
-    }
-  else
-    {
-      for (gsize i = 0; i < height; i++)
-        {
-          memcpy (mem + i * width * 4, data + i * stride, width * 4);
-        }
-    }
+  gsk_vulkan_copy_data (mem, width * 4,
+                        data, stride, format,
+                        width, height);
 
   gsk_vulkan_buffer_unmap (staging);
 
@@ -363,6 +396,7 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -414,7 +448,8 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
 
 static GskVulkanImage *
 gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
-                                                  guchar            *data,
+                                                  const guchar      *data,
+                                                  GdkMemoryFormat    format,
                                                   gsize              width,
                                                   gsize              height,
                                                   gsize              stride)
@@ -424,6 +459,7 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
   staging = gsk_vulkan_image_new (uploader->vulkan,
                                   width,
                                   height,
+                                  VK_FORMAT_B8G8R8A8_UNORM,
                                   VK_IMAGE_TILING_LINEAR,
                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
@@ -431,11 +467,12 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
                                   VK_ACCESS_TRANSFER_WRITE_BIT,
                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
-  gsk_vulkan_image_upload_data (staging, data, width, height, stride);
+  gsk_vulkan_image_upload_data (staging, data, format, width, height, stride);
 
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -498,7 +535,8 @@ gsk_vulkan_image_new_from_data_via_staging_image (GskVulkanUploader *uploader,
 
 static GskVulkanImage *
 gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
-                                         guchar            *data,
+                                         const guchar      *data,
+                                         GdkMemoryFormat    format,
                                          gsize              width,
                                          gsize              height,
                                          gsize              stride)
@@ -508,13 +546,14 @@ gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_LINEAR,
                                VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_PREINITIALIZED,
                                VK_ACCESS_HOST_WRITE_BIT,
                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 
-  gsk_vulkan_image_upload_data (self, data, width, height, stride);
+  gsk_vulkan_image_upload_data (self, data, format, width, height, stride);
 
   gsk_vulkan_uploader_add_image_barrier (uploader,
                                          TRUE,
@@ -529,17 +568,18 @@ gsk_vulkan_image_new_from_data_directly (GskVulkanUploader *uploader,
 
 GskVulkanImage *
 gsk_vulkan_image_new_from_data (GskVulkanUploader *uploader,
-                                guchar            *data,
+                                const guchar      *data,
+                                GdkMemoryFormat    format,
                                 gsize              width,
                                 gsize              height,
                                 gsize              stride)
 {
   if (GSK_DEBUG_CHECK (VULKAN_STAGING_BUFFER))
-    return gsk_vulkan_image_new_from_data_via_staging_buffer (uploader, data, width, height, stride);
+    return gsk_vulkan_image_new_from_data_via_staging_buffer (uploader, data, format, width, height, stride);
   else if (GSK_DEBUG_CHECK (VULKAN_STAGING_IMAGE))
-    return gsk_vulkan_image_new_from_data_via_staging_image (uploader, data, width, height, stride);
+    return gsk_vulkan_image_new_from_data_via_staging_image (uploader, data, format, width, height, stride);
   else
-    return gsk_vulkan_image_new_from_data_directly (uploader, data, width, height, stride);
+    return gsk_vulkan_image_new_from_data_directly (uploader, data, format, width, height, stride);
 }
 
 GskVulkanImage *
@@ -556,6 +596,7 @@ gsk_vulkan_image_new_for_swapchain (GdkVulkanContext *context,
   self->vulkan = g_object_ref (context);
   self->width = width;
   self->height = height;
+  self->vk_format = VK_FORMAT_B8G8R8A8_UNORM;
   self->vk_image = image;
 
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
@@ -574,6 +615,7 @@ gsk_vulkan_image_new_for_framebuffer (GdkVulkanContext *context,
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -588,20 +630,22 @@ gsk_vulkan_image_new_for_framebuffer (GdkVulkanContext *context,
 GskVulkanImage *
 gsk_vulkan_image_new_for_atlas (GdkVulkanContext *context,
                                 gsize             width,
-                                gsize             height)
+                                gsize             height,
+                                VkFormat          format)
 {
   GskVulkanImage *self;
 
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               format,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                VK_IMAGE_LAYOUT_UNDEFINED,
                                0,
                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-  gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
+  gsk_vulkan_image_ensure_view (self, format);
 
   return self;
 }
@@ -616,6 +660,7 @@ gsk_vulkan_image_new_for_texture (GdkVulkanContext *context,
   self = gsk_vulkan_image_new (context,
                                width,
                                height,
+                               VK_FORMAT_B8G8R8A8_UNORM,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
                                VK_IMAGE_USAGE_SAMPLED_BIT |
@@ -629,27 +674,185 @@ gsk_vulkan_image_new_for_texture (GdkVulkanContext *context,
   return self;
 }
 
-GdkTexture *
-gsk_vulkan_image_download (GskVulkanImage    *self,
-                           GskVulkanUploader *uploader)
+/* The texture returned by gsk_vulkan_image_download(). The copy into
+ * the download buffer runs asynchronously, with its own command pool
+ * and fence, and we only wait for it once somebody actually needs the
+ * pixels. Until then, other work on the queue keeps running and the
+ * caller can go on with other things.
+ */
+#define GSK_TYPE_VULKAN_DOWNLOAD_TEXTURE (gsk_vulkan_download_texture_get_type ())
+
+G_DECLARE_FINAL_TYPE (GskVulkanDownloadTexture, gsk_vulkan_download_texture, GSK, VULKAN_DOWNLOAD_TEXTURE, GdkTexture)
+
+struct _GskVulkanDownloadTexture
 {
+  GdkTexture parent_instance;
+
+  GdkVulkanContext *vulkan;
+
+  /* Until the download is done */
+  GskVulkanImage *image;
+  GskVulkanCommandPool *command_pool;
   GskVulkanBuffer *buffer;
-  GdkTexture *texture;
+  VkFence fence;
+
+  /* Afterwards */
   GBytes *bytes;
+};
+
+G_DEFINE_TYPE (GskVulkanDownloadTexture, gsk_vulkan_download_texture, GDK_TYPE_TEXTURE)
+
+static void
+gsk_vulkan_download_texture_finish (GskVulkanDownloadTexture *self)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  if (self->fence == VK_NULL_HANDLE)
+    return;
+
+  GSK_VK_CHECK (vkWaitForFences, device,
+                                 1,
+                                 &self->fence,
+                                 VK_TRUE,
+                                 INT64_MAX);
+
+  vkDestroyFence (device, self->fence, NULL);
+  self->fence = VK_NULL_HANDLE;
+
+  g_clear_pointer (&self->command_pool, gsk_vulkan_command_pool_free);
+  g_clear_object (&self->image);
+}
+
+static void
+gsk_vulkan_download_texture_ensure_bytes (GskVulkanDownloadTexture *self)
+{
+  GdkTexture *texture = GDK_TEXTURE (self);
   guchar *mem;
 
-  gsk_vulkan_uploader_add_image_barrier (uploader,
-                                         FALSE,
-                                         self,
-                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                         VK_ACCESS_TRANSFER_READ_BIT);
+  if (self->bytes)
+    return;
 
-  buffer = gsk_vulkan_buffer_new_download (self->vulkan, self->width * self->height * 4);
+  gsk_vulkan_download_texture_finish (self);
 
-  vkCmdCopyImageToBuffer (gsk_vulkan_uploader_get_copy_buffer (uploader),
+  mem = gsk_vulkan_buffer_map (self->buffer);
+  self->bytes = g_bytes_new (mem, texture->width * texture->height * 4);
+  gsk_vulkan_buffer_unmap (self->buffer);
+
+  g_clear_pointer (&self->buffer, gsk_vulkan_buffer_free);
+}
+
+static void
+gsk_vulkan_download_texture_download (GdkTexture         *texture,
+                                      const GdkRectangle *area,
+                                      guchar             *data,
+                                      gsize               stride)
+{
+  GskVulkanDownloadTexture *self = GSK_VULKAN_DOWNLOAD_TEXTURE (texture);
+  const gsize src_stride = texture->width * 4;
+  const guchar *src;
+  int y;
+
+  gsk_vulkan_download_texture_ensure_bytes (self);
+
+  src = (const guchar *) g_bytes_get_data (self->bytes, NULL)
+        + area->y * src_stride + area->x * 4;
+
+  for (y = 0; y < area->height; y++)
+    memcpy (data + y * stride, src + y * src_stride, area->width * 4);
+}
+
+static void
+gsk_vulkan_download_texture_dispose (GObject *object)
+{
+  GskVulkanDownloadTexture *self = GSK_VULKAN_DOWNLOAD_TEXTURE (object);
+
+  gsk_vulkan_download_texture_finish (self);
+
+  g_clear_pointer (&self->buffer, gsk_vulkan_buffer_free);
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+  g_clear_object (&self->vulkan);
+
+  G_OBJECT_CLASS (gsk_vulkan_download_texture_parent_class)->dispose (object);
+}
+
+static void
+gsk_vulkan_download_texture_class_init (GskVulkanDownloadTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gsk_vulkan_download_texture_download;
+  gobject_class->dispose = gsk_vulkan_download_texture_dispose;
+}
+
+static void
+gsk_vulkan_download_texture_init (GskVulkanDownloadTexture *self)
+{
+}
+
+/* Returns a texture with the contents of @self, once the GPU is done
+ * with the work submitted so far. This doesn't block; downloading
+ * from the returned texture waits for the copy if necessary.
+ */
+GdkTexture *
+gsk_vulkan_image_download (GskVulkanImage *self)
+{
+  GskVulkanDownloadTexture *texture;
+  VkCommandBuffer command_buffer;
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  texture = g_object_new (GSK_TYPE_VULKAN_DOWNLOAD_TEXTURE,
+                          "width", (int) self->width,
+                          "height", (int) self->height,
+                          NULL);
+
+  texture->vulkan = g_object_ref (self->vulkan);
+  texture->image = g_object_ref (self);
+  texture->command_pool = gsk_vulkan_command_pool_new (self->vulkan);
+  texture->buffer = gsk_vulkan_buffer_new_download (self->vulkan, self->width * self->height * 4);
+
+  GSK_VK_CHECK (vkCreateFence, device,
+                               &(VkFenceCreateInfo) {
+                                   .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                                   .flags = 0
+                               },
+                               NULL,
+                               &texture->fence);
+
+  command_buffer = gsk_vulkan_command_pool_get_buffer (texture->command_pool);
+
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                        | VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        0,
+                        0, NULL,
+                        0, NULL,
+                        1, &(VkImageMemoryBarrier) {
+                            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                            .srcAccessMask = self->vk_access,
+                            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+                            .oldLayout = self->vk_image_layout,
+                            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .image = self->vk_image,
+                            .subresourceRange = {
+                              .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                              .baseMipLevel = 0,
+                              .levelCount = 1,
+                              .baseArrayLayer = 0,
+                              .layerCount = 1
+                            }
+                        });
+
+  self->vk_image_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  self->vk_access = VK_ACCESS_TRANSFER_READ_BIT;
+
+  vkCmdCopyImageToBuffer (command_buffer,
                           self->vk_image,
                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                          gsk_vulkan_buffer_get_buffer (buffer),
+                          gsk_vulkan_buffer_get_buffer (texture->buffer),
                           1,
                           (VkBufferImageCopy[1]) {
                                {
@@ -669,20 +872,29 @@ gsk_vulkan_image_download (GskVulkanImage    *self,
                                }
                           });
 
-  gsk_vulkan_uploader_upload (uploader);
-
-  GSK_VK_CHECK (vkQueueWaitIdle, gdk_vulkan_context_get_queue (self->vulkan));
-
-  mem = gsk_vulkan_buffer_map (buffer);
-  bytes = g_bytes_new (mem, self->width * self->height * 4);
-  texture = gdk_memory_texture_new (self->width, self->height,
-                                    GDK_MEMORY_DEFAULT,
-                                    bytes,
-                                    self->width * 4);
-  gsk_vulkan_buffer_unmap (buffer);
-  gsk_vulkan_buffer_free (buffer);
-
-  return texture;
+  /* Make the copy visible to the host once the fence signals */
+  vkCmdPipelineBarrier (command_buffer,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_HOST_BIT,
+                        0,
+                        0, NULL,
+                        1, &(VkBufferMemoryBarrier) {
+                            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+                            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            .buffer = gsk_vulkan_buffer_get_buffer (texture->buffer),
+                            .offset = 0,
+                            .size = VK_WHOLE_SIZE
+                        },
+                        0, NULL);
+
+  gsk_vulkan_command_pool_submit_buffer (texture->command_pool, command_buffer,
+                                         0, NULL, 0, NULL,
+                                         texture->fence);
+
+  return GDK_TEXTURE (texture);
 }
 
 void
@@ -696,11 +908,14 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
   guchar *m;
   gsize size;
   gsize offset;
+  gsize bpp;
   VkBufferImageCopy *bufferImageCopy;
 
+  bpp = self->vk_format == VK_FORMAT_R8_UNORM ? 1 : 4;
+
   size = 0;
   for (int i = 0; i < num_regions; i++)
-    size += regions[i].width * regions[i].height * 4;
+    size += regions[i].width * regions[i].height * bpp;
 
   staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, size);
   mem = gsk_vulkan_buffer_map (staging);
@@ -712,14 +927,14 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
   for (int i = 0; i < num_regions; i++)
     {
       m = mem + offset;
-      if (regions[i].stride == regions[i].width * 4)
+      if (regions[i].stride == regions[i].width * bpp)
         {
           memcpy (m, regions[i].data, regions[i].stride * regions[i].height);
         }
       else
         {
-          for (gsize r = 0; r < regions[i].height; i++)
-            memcpy (m + r * regions[i].width * 4, regions[i].data + r * regions[i].stride, regions[i].width * 4);
+          for (gsize r = 0; r < regions[i].height; r++)
+            memcpy (m + r * regions[i].width * bpp, regions[i].data + r * regions[i].stride, regions[i].width * bpp);
         }
 
       bufferImageCopy[i].bufferOffset = offset;
@@ -734,7 +949,7 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
       bufferImageCopy[i].imageExtent.height = regions[i].height;
       bufferImageCopy[i].imageExtent.depth = 1;
 
-      offset += regions[i].width * regions[i].height * 4;
+      offset += regions[i].width * regions[i].height * bpp;
     }
 
   gsk_vulkan_buffer_unmap (staging);
@@ -760,7 +975,7 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
 
   uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
 
-  gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
+  gsk_vulkan_image_ensure_view (self, self->vk_format);
 }
 
 static void
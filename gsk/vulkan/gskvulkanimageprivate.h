@@ -26,7 +26,8 @@ GskVulkanImage *        gsk_vulkan_image_new_for_swapchain              (GdkVulk
                                                                          gsize                   width,
                                                                          gsize                   height);
 GskVulkanImage *        gsk_vulkan_image_new_from_data                  (GskVulkanUploader      *uploader,
-                                                                         guchar                 *data,
+                                                                         const guchar           *data,
+                                                                         GdkMemoryFormat         format,
                                                                          gsize                   width,
                                                                          gsize                   height,
                                                                          gsize                   stride);
@@ -49,13 +50,13 @@ GskVulkanImage *        gsk_vulkan_image_new_for_framebuffer            (GdkVulk
                                                                          gsize                   height);
 GskVulkanImage *        gsk_vulkan_image_new_for_atlas                  (GdkVulkanContext       *context,
                                                                          gsize                   width,
-                                                                         gsize                   height);
+                                                                         gsize                   height,
+                                                                         VkFormat                format);
 GskVulkanImage *        gsk_vulkan_image_new_for_texture                (GdkVulkanContext       *context,
                                                                          gsize                   width,
                                                                          gsize                   height);
 
-GdkTexture *            gsk_vulkan_image_download                       (GskVulkanImage         *self,
-                                                                         GskVulkanUploader      *uploader);
+GdkTexture *            gsk_vulkan_image_download                       (GskVulkanImage         *self);
 
 gsize                   gsk_vulkan_image_get_width                      (GskVulkanImage         *self);
 gsize                   gsk_vulkan_image_get_height                     (GskVulkanImage         *self);
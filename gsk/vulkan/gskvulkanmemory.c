@@ -3,93 +3,449 @@
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanmemoryprivate.h"
 
-struct _GskVulkanMemory
+#include "gskdebugprivate.h"
+
+/* Memory is sub-allocated from large blocks of device memory, so we
+ * stay well clear of the driver's allocation count limit and don't pay
+ * for vkAllocateMemory() on every buffer or image.
+ *
+ * Each pool (staging buffers, vertex buffers, images) gets its own
+ * blocks per memory type, so short-lived vertex and staging buffers
+ * don't fragment the blocks holding long-lived images. Blocks keep a
+ * sorted list of free ranges that is coalesced when memory is freed.
+ *
+ * One empty block per pool is kept around, so that freeing and
+ * re-creating a frame's worth of buffers in gsk_vulkan_render_reset()
+ * doesn't cause any Vulkan allocations.
+ */
+
+#define BLOCK_SIZE (32 * 1024 * 1024)
+
+typedef struct
+{
+  VkDeviceSize offset;
+  VkDeviceSize size;
+} Range;
+
+typedef struct
+{
+  VkDeviceMemory vk_memory;
+  VkDeviceSize size;
+
+  /* Persistent mapping, for host visible memory */
+  guchar *map;
+
+  GArray *free_ranges; /* Range, sorted by offset */
+  guint n_allocations;
+} Block;
+
+struct _GskVulkanAllocator
 {
+  int ref_count;
+
   GdkVulkanContext *vulkan;
 
-  gsize size;
+  VkPhysicalDeviceMemoryProperties properties;
+  VkDeviceSize buffer_image_granularity;
+  VkDeviceSize non_coherent_atom_size;
 
-  VkDeviceMemory vk_memory;
+  GPtrArray *blocks[GSK_VULKAN_N_MEMORY_POOLS][VK_MAX_MEMORY_TYPES];
 };
 
-GskVulkanMemory *
-gsk_vulkan_memory_new (GdkVulkanContext      *context,
-                       uint32_t               allowed_types,
-                       VkMemoryPropertyFlags  flags,
-                       gsize                  size)
+struct _GskVulkanMemory
 {
-  VkPhysicalDeviceMemoryProperties properties;
-  GskVulkanMemory *self;
-  uint32_t i;
+  GskVulkanAllocator *allocator;
+  GskVulkanMemoryPool pool;
+  uint32_t memory_type;
 
-  self = g_slice_new0 (GskVulkanMemory);
+  Block *block;
+  VkDeviceSize offset;
+  gsize size;
+};
 
-  self->vulkan = g_object_ref (context);
-  self->size = size;
+static GQuark allocator_quark;
 
-  vkGetPhysicalDeviceMemoryProperties (gdk_vulkan_context_get_physical_device (context),
-                                       &properties);
+static void
+block_free (gpointer data)
+{
+  Block *block = data;
 
-  for (i = 0; i < properties.memoryTypeCount; i++)
-    {
-      if (!(allowed_types & (1 << i)))
-        continue;
+  g_array_unref (block->free_ranges);
+  g_slice_free (Block, block);
+}
 
-      if ((properties.memoryTypes[i].propertyFlags & flags) == flags)
-        break;
-  }
+static Block *
+block_new (GskVulkanAllocator *self,
+           uint32_t            memory_type,
+           VkDeviceSize        size)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  Block *block;
 
-  g_assert (i < properties.memoryTypeCount);
+  block = g_slice_new0 (Block);
+  block->size = size;
+  block->free_ranges = g_array_new (FALSE, FALSE, sizeof (Range));
+  g_array_append_val (block->free_ranges, ((Range) { 0, size }));
 
-  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
+  GSK_VK_CHECK (vkAllocateMemory, device,
                                   &(VkMemoryAllocateInfo) {
                                       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
                                       .allocationSize = size,
-                                      .memoryTypeIndex = i
+                                      .memoryTypeIndex = memory_type
                                   },
                                   NULL,
-                                  &self->vk_memory);
+                                  &block->vk_memory);
+
+  if (self->properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    GSK_VK_CHECK (vkMapMemory, device,
+                               block->vk_memory,
+                               0,
+                               VK_WHOLE_SIZE,
+                               0,
+                               (void **) &block->map);
+
+  GSK_NOTE (VULKAN, g_message ("Allocated %" G_GUINT64_FORMAT " kB block of memory type %u",
+                               (guint64) size / 1024, memory_type));
+
+  return block;
+}
+
+static void
+block_destroy (GskVulkanAllocator *self,
+               Block              *block)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  if (block->map)
+    vkUnmapMemory (device, block->vk_memory);
+
+  vkFreeMemory (device, block->vk_memory, NULL);
+
+  block_free (block);
+}
+
+static gboolean
+block_alloc (Block        *block,
+             VkDeviceSize  size,
+             VkDeviceSize  alignment,
+             VkDeviceSize *out_offset)
+{
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      Range *range = &g_array_index (block->free_ranges, Range, i);
+      VkDeviceSize offset = (range->offset + alignment - 1) / alignment * alignment;
+      VkDeviceSize end = range->offset + range->size;
+
+      if (offset + size > end)
+        continue;
+
+      if (offset + size < end)
+        {
+          /* Keep the tail, and the alignment gap in front if any */
+          Range tail = { offset + size, end - (offset + size) };
+
+          if (offset > range->offset)
+            {
+              range->size = offset - range->offset;
+              g_array_insert_val (block->free_ranges, i + 1, tail);
+            }
+          else
+            *range = tail;
+        }
+      else if (offset > range->offset)
+        range->size = offset - range->offset;
+      else
+        g_array_remove_index (block->free_ranges, i);
+
+      block->n_allocations++;
+      *out_offset = offset;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+block_release (Block        *block,
+               VkDeviceSize  offset,
+               VkDeviceSize  size)
+{
+  Range *prev, *next;
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      if (g_array_index (block->free_ranges, Range, i).offset > offset)
+        break;
+    }
+
+  prev = i > 0 ? &g_array_index (block->free_ranges, Range, i - 1) : NULL;
+  next = i < block->free_ranges->len ? &g_array_index (block->free_ranges, Range, i) : NULL;
+
+  if (prev && prev->offset + prev->size == offset)
+    {
+      prev->size += size;
+
+      if (next && offset + size == next->offset)
+        {
+          prev->size += next->size;
+          g_array_remove_index (block->free_ranges, i);
+        }
+    }
+  else if (next && offset + size == next->offset)
+    {
+      next->offset = offset;
+      next->size += size;
+    }
+  else
+    {
+      g_array_insert_val (block->free_ranges, i, ((Range) { offset, size }));
+    }
+
+  block->n_allocations--;
+}
+
+/* Returns a new reference to the allocator for @context, creating it
+ * if necessary. Renderers hold on to one while they are realized, so
+ * the allocator's blocks survive between frames.
+ */
+GskVulkanAllocator *
+gsk_vulkan_allocator_get (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *self;
+  VkPhysicalDeviceProperties device_properties;
+  VkPhysicalDevice physical_device;
+
+  if (G_UNLIKELY (allocator_quark == 0))
+    allocator_quark = g_quark_from_static_string ("gsk-vulkan-allocator");
+
+  self = g_object_get_qdata (G_OBJECT (context), allocator_quark);
+  if (self)
+    return gsk_vulkan_allocator_ref (self);
+
+  self = g_slice_new0 (GskVulkanAllocator);
+  self->ref_count = 1;
+  self->vulkan = g_object_ref (context);
+
+  physical_device = gdk_vulkan_context_get_physical_device (context);
+  vkGetPhysicalDeviceMemoryProperties (physical_device, &self->properties);
+  vkGetPhysicalDeviceProperties (physical_device, &device_properties);
+  self->buffer_image_granularity = device_properties.limits.bufferImageGranularity;
+  self->non_coherent_atom_size = device_properties.limits.nonCoherentAtomSize;
+
+  /* The context doesn't own the allocator, every memory and
+   * renderer using it does */
+  g_object_set_qdata (G_OBJECT (context), allocator_quark, self);
+
+  return self;
+}
+
+GskVulkanAllocator *
+gsk_vulkan_allocator_ref (GskVulkanAllocator *self)
+{
+  self->ref_count++;
 
   return self;
 }
 
 void
-gsk_vulkan_memory_free (GskVulkanMemory *self)
+gsk_vulkan_allocator_unref (GskVulkanAllocator *self)
 {
-  vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
-                self->vk_memory,
-                NULL);
+  guint i, j, k;
+
+  g_assert (self->ref_count > 0);
 
+  self->ref_count--;
+  if (self->ref_count > 0)
+    return;
+
+  for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+    for (j = 0; j < VK_MAX_MEMORY_TYPES; j++)
+      {
+        GPtrArray *blocks = self->blocks[i][j];
+
+        if (blocks == NULL)
+          continue;
+
+        for (k = 0; k < blocks->len; k++)
+          {
+            Block *block = g_ptr_array_index (blocks, k);
+
+            g_assert (block->n_allocations == 0);
+            block_destroy (self, block);
+          }
+
+        g_ptr_array_unref (blocks);
+      }
+
+  g_object_set_qdata (G_OBJECT (self->vulkan), allocator_quark, NULL);
   g_object_unref (self->vulkan);
 
+  g_slice_free (GskVulkanAllocator, self);
+}
+
+static uint32_t
+find_memory_type (GskVulkanAllocator    *self,
+                  uint32_t               allowed_types,
+                  VkMemoryPropertyFlags  flags)
+{
+  uint32_t i;
+
+  for (i = 0; i < self->properties.memoryTypeCount; i++)
+    {
+      if (!(allowed_types & (1 << i)))
+        continue;
+
+      if ((self->properties.memoryTypes[i].propertyFlags & flags) == flags)
+        break;
+    }
+
+  g_assert (i < self->properties.memoryTypeCount);
+
+  return i;
+}
+
+static VkDeviceSize
+get_block_size (GskVulkanAllocator *self,
+                uint32_t            memory_type,
+                VkDeviceSize        size)
+{
+  const VkMemoryType *type = &self->properties.memoryTypes[memory_type];
+  VkDeviceSize block_size;
+
+  /* Don't grab too much of small heaps, like the host visible
+   * part of device memory that some GPUs have */
+  block_size = MIN (BLOCK_SIZE, self->properties.memoryHeaps[type->heapIndex].size / 8);
+
+  return MAX (block_size, size);
+}
+
+GskVulkanMemory *
+gsk_vulkan_memory_new (GdkVulkanContext           *context,
+                       GskVulkanMemoryPool         pool,
+                       const VkMemoryRequirements *requirements,
+                       VkMemoryPropertyFlags       flags)
+{
+  GskVulkanAllocator *allocator;
+  GskVulkanMemory *self;
+  VkDeviceSize alignment;
+  GPtrArray *blocks;
+  Block *block;
+  guint i;
+
+  allocator = gsk_vulkan_allocator_get (context);
+
+  self = g_slice_new0 (GskVulkanMemory);
+  self->allocator = allocator;
+  self->pool = pool;
+  self->size = requirements->size;
+  self->memory_type = find_memory_type (allocator, requirements->memoryTypeBits, flags);
+
+  /* Images may be linear or optimal, keep them on separate pages */
+  alignment = MAX (requirements->alignment, 1);
+  if (pool == GSK_VULKAN_MEMORY_POOL_IMAGE)
+    alignment = MAX (alignment, allocator->buffer_image_granularity);
+
+  blocks = allocator->blocks[pool][self->memory_type];
+  if (blocks == NULL)
+    blocks = allocator->blocks[pool][self->memory_type] = g_ptr_array_new ();
+
+  for (i = 0; i < blocks->len; i++)
+    {
+      block = g_ptr_array_index (blocks, i);
+
+      if (block_alloc (block, self->size, alignment, &self->offset))
+        {
+          self->block = block;
+          return self;
+        }
+    }
+
+  block = block_new (allocator, self->memory_type,
+                     get_block_size (allocator, self->memory_type, self->size));
+  g_ptr_array_add (blocks, block);
+
+  if (!block_alloc (block, self->size, alignment, &self->offset))
+    g_assert_not_reached ();
+
+  self->block = block;
+
+  return self;
+}
+
+void
+gsk_vulkan_memory_free (GskVulkanMemory *self)
+{
+  GskVulkanAllocator *allocator = self->allocator;
+  Block *block = self->block;
+
+  block_release (block, self->offset, self->size);
+
+  if (block->n_allocations == 0)
+    {
+      GPtrArray *blocks = allocator->blocks[self->pool][self->memory_type];
+      guint i;
+
+      /* Keep one empty block for reuse, free any others */
+      for (i = 0; i < blocks->len; i++)
+        {
+          Block *other = g_ptr_array_index (blocks, i);
+
+          if (other != block && other->n_allocations == 0)
+            {
+              g_ptr_array_remove (blocks, block);
+              block_destroy (allocator, block);
+              break;
+            }
+        }
+    }
+
   g_slice_free (GskVulkanMemory, self);
+
+  gsk_vulkan_allocator_unref (allocator);
 }
 
 VkDeviceMemory
 gsk_vulkan_memory_get_device_memory (GskVulkanMemory *self)
 {
-  return self->vk_memory;
+  return self->block->vk_memory;
+}
+
+VkDeviceSize
+gsk_vulkan_memory_get_offset (GskVulkanMemory *self)
+{
+  return self->offset;
 }
 
 guchar *
 gsk_vulkan_memory_map (GskVulkanMemory *self)
 {
-  void *data;
-
-  GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
-                             self->vk_memory,
-                             0,
-                             self->size,
-                             0,
-                             &data);
+  g_assert (self->block->map != NULL);
 
-  return data;
+  return self->block->map + self->offset;
 }
 
 void
 gsk_vulkan_memory_unmap (GskVulkanMemory *self)
 {
-  vkUnmapMemory (gdk_vulkan_context_get_device (self->vulkan),
-                 self->vk_memory);
-}
+  GskVulkanAllocator *allocator = self->allocator;
+  VkDeviceSize atom_size;
+
+  /* Blocks stay mapped, but writes to non-coherent memory
+   * need to be made visible to the device */
+  if (allocator->properties.memoryTypes[self->memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    return;
 
+  atom_size = MAX (allocator->non_coherent_atom_size, 1);
+
+  GSK_VK_CHECK (vkFlushMappedMemoryRanges, gdk_vulkan_context_get_device (allocator->vulkan),
+                                           1,
+                                           &(VkMappedMemoryRange) {
+                                               .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                                               .memory = self->block->vk_memory,
+                                               .offset = self->offset / atom_size * atom_size,
+                                               .size = VK_WHOLE_SIZE
+                                           });
+}
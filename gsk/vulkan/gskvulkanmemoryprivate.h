@@ -5,15 +5,28 @@
 
 G_BEGIN_DECLS
 
+typedef enum {
+  GSK_VULKAN_MEMORY_POOL_STAGING,
+  GSK_VULKAN_MEMORY_POOL_VERTEX,
+  GSK_VULKAN_MEMORY_POOL_IMAGE,
+  GSK_VULKAN_N_MEMORY_POOLS
+} GskVulkanMemoryPool;
+
+typedef struct _GskVulkanAllocator GskVulkanAllocator;
 typedef struct _GskVulkanMemory GskVulkanMemory;
 
+GskVulkanAllocator *    gsk_vulkan_allocator_get                        (GdkVulkanContext       *context);
+GskVulkanAllocator *    gsk_vulkan_allocator_ref                        (GskVulkanAllocator     *self);
+void                    gsk_vulkan_allocator_unref                      (GskVulkanAllocator     *self);
+
 GskVulkanMemory *       gsk_vulkan_memory_new                           (GdkVulkanContext       *context,
-                                                                         uint32_t                allowed_types,
-                                                                         VkMemoryPropertyFlags   properties,
-                                                                         gsize                   size);
+                                                                         GskVulkanMemoryPool     pool,
+                                                                         const VkMemoryRequirements *requirements,
+                                                                         VkMemoryPropertyFlags   properties);
 void                    gsk_vulkan_memory_free                          (GskVulkanMemory        *memory);
 
 VkDeviceMemory          gsk_vulkan_memory_get_device_memory             (GskVulkanMemory        *self);
+VkDeviceSize            gsk_vulkan_memory_get_offset                    (GskVulkanMemory        *self);
 
 guchar *                gsk_vulkan_memory_map                           (GskVulkanMemory        *self);
 void                    gsk_vulkan_memory_unmap                         (GskVulkanMemory        *self);
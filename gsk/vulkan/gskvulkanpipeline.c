@@ -4,6 +4,7 @@
 
 #include "gskvulkanpushconstantsprivate.h"
 #include "gskvulkanshaderprivate.h"
+#include "gskprivate.h"
 
 #include <graphene.h>
 
@@ -14,6 +15,7 @@ struct _GskVulkanPipelinePrivate
   GObject parent_instance;
 
   GdkVulkanContext *context;
+  GskVulkanPipelineCache *cache;
 
   VkPipeline pipeline;
   VkPipelineLayout layout;
@@ -22,8 +24,143 @@ struct _GskVulkanPipelinePrivate
   GskVulkanShader *fragment_shader;
 };
 
+struct _GskVulkanPipelineCache
+{
+  guint ref_count;
+
+  GdkVulkanContext *vulkan;
+  VkPipelineCache vk_cache;
+  char *path;
+
+  guint dirty : 1;
+};
+
 G_DEFINE_TYPE_WITH_PRIVATE (GskVulkanPipeline, gsk_vulkan_pipeline, G_TYPE_OBJECT)
 
+static GQuark pipeline_cache_quark;
+
+/* Pipeline cache data is only valid for the exact device and driver
+ * that produced it, so all of that goes into the file name.
+ */
+static char *
+get_pipeline_cache_path (GdkVulkanContext *context)
+{
+  VkPhysicalDeviceProperties properties;
+  GString *key;
+  char *path;
+  guint i;
+
+  vkGetPhysicalDeviceProperties (gdk_vulkan_context_get_physical_device (context), &properties);
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key, "%x:%x:%x:",
+                          properties.vendorID,
+                          properties.deviceID,
+                          properties.driverVersion);
+  for (i = 0; i < VK_UUID_SIZE; i++)
+    g_string_append_printf (key, "%02x", properties.pipelineCacheUUID[i]);
+
+  path = gsk_shader_cache_get_path ("vulkan-pipelines", key->str);
+  g_string_free (key, TRUE);
+
+  return path;
+}
+
+/* Returns a new reference to the pipeline cache for @context, creating
+ * it from the on-disk cache if necessary. The cache is written back
+ * when the last reference goes away.
+ */
+GskVulkanPipelineCache *
+gsk_vulkan_pipeline_cache_get (GdkVulkanContext *context)
+{
+  GskVulkanPipelineCache *self;
+  GBytes *bytes = NULL;
+
+  if (G_UNLIKELY (pipeline_cache_quark == 0))
+    pipeline_cache_quark = g_quark_from_static_string ("gsk-vulkan-pipeline-cache");
+
+  self = g_object_get_qdata (G_OBJECT (context), pipeline_cache_quark);
+  if (self)
+    return gsk_vulkan_pipeline_cache_ref (self);
+
+  self = g_slice_new0 (GskVulkanPipelineCache);
+  self->ref_count = 1;
+  self->vulkan = g_object_ref (context);
+  self->path = get_pipeline_cache_path (context);
+
+  if (self->path)
+    bytes = gsk_shader_cache_load (self->path);
+
+  /* The driver validates the header and ignores data it can't use */
+  if (GSK_VK_CHECK (vkCreatePipelineCache, gdk_vulkan_context_get_device (context),
+                                           &(VkPipelineCacheCreateInfo) {
+                                               .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                                               .initialDataSize = bytes ? g_bytes_get_size (bytes) : 0,
+                                               .pInitialData = bytes ? g_bytes_get_data (bytes, NULL) : NULL,
+                                           },
+                                           NULL,
+                                           &self->vk_cache) != VK_SUCCESS)
+    self->vk_cache = VK_NULL_HANDLE;
+
+  g_clear_pointer (&bytes, g_bytes_unref);
+
+  g_object_set_qdata (G_OBJECT (context), pipeline_cache_quark, self);
+
+  return self;
+}
+
+GskVulkanPipelineCache *
+gsk_vulkan_pipeline_cache_ref (GskVulkanPipelineCache *self)
+{
+  self->ref_count++;
+
+  return self;
+}
+
+static void
+gsk_vulkan_pipeline_cache_save (GskVulkanPipelineCache *self)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  gsize size = 0;
+  gpointer data;
+
+  if (GSK_VK_CHECK (vkGetPipelineCacheData, device, self->vk_cache, &size, NULL) != VK_SUCCESS ||
+      size == 0)
+    return;
+
+  data = g_malloc (size);
+  if (GSK_VK_CHECK (vkGetPipelineCacheData, device, self->vk_cache, &size, data) == VK_SUCCESS)
+    gsk_shader_cache_save (self->path, data, size);
+
+  g_free (data);
+}
+
+void
+gsk_vulkan_pipeline_cache_unref (GskVulkanPipelineCache *self)
+{
+  g_assert (self->ref_count > 0);
+
+  self->ref_count--;
+  if (self->ref_count > 0)
+    return;
+
+  if (self->vk_cache != VK_NULL_HANDLE)
+    {
+      if (self->dirty && self->path)
+        gsk_vulkan_pipeline_cache_save (self);
+
+      vkDestroyPipelineCache (gdk_vulkan_context_get_device (self->vulkan),
+                              self->vk_cache,
+                              NULL);
+    }
+
+  g_object_set_qdata (G_OBJECT (self->vulkan), pipeline_cache_quark, NULL);
+  g_object_unref (self->vulkan);
+  g_free (self->path);
+
+  g_slice_free (GskVulkanPipelineCache, self);
+}
+
 static void
 gsk_vulkan_pipeline_finalize (GObject *gobject)
 {
@@ -38,6 +175,7 @@ gsk_vulkan_pipeline_finalize (GObject *gobject)
 
   g_clear_pointer (&priv->fragment_shader, gsk_vulkan_shader_free);
   g_clear_pointer (&priv->vertex_shader, gsk_vulkan_shader_free);
+  g_clear_pointer (&priv->cache, gsk_vulkan_pipeline_cache_unref);
 
   G_OBJECT_CLASS (gsk_vulkan_pipeline_parent_class)->finalize (gobject);
 }
@@ -91,12 +229,13 @@ gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
 
   priv->context = context;
   priv->layout = layout;
+  priv->cache = gsk_vulkan_pipeline_cache_get (context);
 
   priv->vertex_shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_VERTEX, shader_name, NULL);
   priv->fragment_shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_FRAGMENT, shader_name, NULL);
 
   GSK_VK_CHECK (vkCreateGraphicsPipelines, device,
-                                           VK_NULL_HANDLE,
+                                           priv->cache->vk_cache,
                                            1,
                                            &(VkGraphicsPipelineCreateInfo) {
                                                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -169,6 +308,8 @@ gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
                                            NULL,
                                            &priv->pipeline);
 
+  priv->cache->dirty = TRUE;
+
   return self;
 }
 
@@ -11,6 +11,8 @@ G_BEGIN_DECLS
 
 G_DECLARE_DERIVABLE_TYPE (GskVulkanPipeline, gsk_vulkan_pipeline, GSK, VULKAN_PIPELINE, GObject)
 
+typedef struct _GskVulkanPipelineCache GskVulkanPipelineCache;
+
 struct _GskVulkanPipelineClass
 {
   GObjectClass parent_class;
@@ -32,6 +34,10 @@ gsk_vulkan_handle_result (VkResult    res,
 
 #define GSK_VK_CHECK(func, ...) gsk_vulkan_handle_result (func (__VA_ARGS__), G_STRINGIFY (func))
 
+GskVulkanPipelineCache *gsk_vulkan_pipeline_cache_get                   (GdkVulkanContext               *context);
+GskVulkanPipelineCache *gsk_vulkan_pipeline_cache_ref                   (GskVulkanPipelineCache         *self);
+void                    gsk_vulkan_pipeline_cache_unref                 (GskVulkanPipelineCache         *self);
+
 GskVulkanPipeline *     gsk_vulkan_pipeline_new                         (GType                           pipeline_type,
                                                                          GdkVulkanContext               *context,
                                                                          VkPipelineLayout                layout,
@@ -8,6 +8,7 @@
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkancommandpoolprivate.h"
 #include "gskvulkanpipelineprivate.h"
+#include "gskvulkanrendererprivate.h"
 #include "gskvulkanrenderpassprivate.h"
 
 #include "gskvulkanblendmodepipelineprivate.h"
@@ -360,6 +361,9 @@ gsk_vulkan_render_upload (GskVulkanRender *self)
 {
   GList *l;
 
+  /* Upload the glyphs of all text in one go, before the passes need them */
+  gsk_vulkan_renderer_upload_glyphs (GSK_VULKAN_RENDERER (self->renderer), self->uploader);
+
   /* gsk_vulkan_render_pass_upload may call gsk_vulkan_render_add_node_for_texture,
    * prepending new render passes to the list. Therefore, we walk the list from
    * the end.
@@ -646,9 +650,7 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
 GdkTexture *
 gsk_vulkan_render_download_target (GskVulkanRender *self)
 {
-  gsk_vulkan_uploader_reset (self->uploader);
-
-  return gsk_vulkan_image_download (self->target, self->uploader);
+  return gsk_vulkan_image_download (self->target);
 }
 
 static void
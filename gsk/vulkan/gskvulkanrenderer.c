@@ -8,15 +8,20 @@
 #include "gskrendernodeprivate.h"
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderprivate.h"
 #include "gskvulkanglyphcacheprivate.h"
 
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 #include "gdk/gdkprofilerprivate.h"
 
 #include <graphene.h>
 
+#define MAX_FRAMES_IN_FLIGHT 4
+#define DEFAULT_FRAMES_IN_FLIGHT 2
+
 typedef struct _GskVulkanTextureData GskVulkanTextureData;
 
 struct _GskVulkanTextureData {
@@ -31,6 +36,7 @@ typedef struct {
   GQuark render_passes;
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  GQuark culled_nodes;
 } ProfileCounters;
 
 typedef struct {
@@ -47,11 +53,16 @@ struct _GskVulkanRenderer
   GskRenderer parent_instance;
 
   GdkVulkanContext *vulkan;
+  GskVulkanAllocator *allocator;
+  GskVulkanPipelineCache *pipeline_cache;
 
   guint n_targets;
   GskVulkanImage **targets;
 
-  GskVulkanRender *render;
+  /* One per frame in flight, used round-robin */
+  GskVulkanRender *renders[MAX_FRAMES_IN_FLIGHT];
+  guint n_frames_in_flight;
+  guint current_render;
 
   GSList *textures;
 
@@ -68,8 +79,32 @@ struct _GskVulkanRendererClass
   GskRendererClass parent_class;
 };
 
+enum {
+  PROP_0,
+  PROP_FRAMES_IN_FLIGHT,
+
+  N_PROPS
+};
+
+static GParamSpec *gsk_vulkan_renderer_properties[N_PROPS];
+
 G_DEFINE_TYPE (GskVulkanRenderer, gsk_vulkan_renderer, GSK_TYPE_RENDERER)
 
+/* Frees the renders from @first on, waiting for the GPU
+ * to be done with them. */
+static void
+gsk_vulkan_renderer_free_renders (GskVulkanRenderer *self,
+                                  guint              first)
+{
+  guint i;
+
+  for (i = first; i < MAX_FRAMES_IN_FLIGHT; i++)
+    g_clear_pointer (&self->renders[i], gsk_vulkan_render_free);
+
+  if (self->current_render >= first)
+    self->current_render = 0;
+}
+
 static void
 gsk_vulkan_renderer_free_targets (GskVulkanRenderer *self)
 {
@@ -123,14 +158,15 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
   if (self->vulkan == NULL)
     return FALSE;
 
+  self->allocator = gsk_vulkan_allocator_get (self->vulkan);
+  self->pipeline_cache = gsk_vulkan_pipeline_cache_get (self->vulkan);
+
   g_signal_connect (self->vulkan,
                     "images-updated",
                     G_CALLBACK (gsk_vulkan_renderer_update_images_cb),
                     self);
   gsk_vulkan_renderer_update_images_cb (self->vulkan, self);
 
-  self->render = gsk_vulkan_render_new (renderer, self->vulkan);
-
   self->glyph_cache = gsk_vulkan_glyph_cache_new (renderer, self->vulkan);
 
   return TRUE;
@@ -153,13 +189,15 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
     }
   g_clear_pointer (&self->textures, g_slist_free);
 
-  g_clear_pointer (&self->render, gsk_vulkan_render_free);
+  gsk_vulkan_renderer_free_renders (self, 0);
 
   gsk_vulkan_renderer_free_targets (self);
   g_signal_handlers_disconnect_by_func(self->vulkan,
                                        gsk_vulkan_renderer_update_images_cb,
                                        self);
 
+  g_clear_pointer (&self->pipeline_cache, gsk_vulkan_pipeline_cache_unref);
+  g_clear_pointer (&self->allocator, gsk_vulkan_allocator_unref);
   g_clear_object (&self->vulkan);
 }
 
@@ -183,6 +221,7 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   gsk_profiler_counter_set (profiler, self->profile_counters.fallback_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.texture_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.render_passes, 0);
+  gsk_profiler_counter_set (profiler, self->profile_counters.culled_nodes, 0);
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
@@ -194,6 +233,8 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
 
   gsk_vulkan_render_reset (render, image, viewport, NULL);
 
+  gsk_vulkan_glyph_cache_begin_frame (self->glyph_cache);
+
   gsk_vulkan_render_add_node (render, root);
 
   gsk_vulkan_render_upload (render);
@@ -243,15 +284,25 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
   gsk_profiler_counter_set (profiler, self->profile_counters.fallback_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.texture_pixels, 0);
   gsk_profiler_counter_set (profiler, self->profile_counters.render_passes, 0);
+  gsk_profiler_counter_set (profiler, self->profile_counters.culled_nodes, 0);
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
   gdk_draw_context_begin_frame (GDK_DRAW_CONTEXT (self->vulkan), region);
-  render = self->render;
+
+  /* Resetting the render waits for the frame it was used for last,
+   * which is n_frames_in_flight frames ago, so we can prepare this
+   * frame while the GPU is still busy with the ones in between. */
+  if (self->renders[self->current_render] == NULL)
+    self->renders[self->current_render] = gsk_vulkan_render_new (renderer, self->vulkan);
+  render = self->renders[self->current_render];
+  self->current_render = (self->current_render + 1) % self->n_frames_in_flight;
 
   clip = gdk_draw_context_get_frame_region (GDK_DRAW_CONTEXT (self->vulkan));
   gsk_vulkan_render_reset (render, self->targets[gdk_vulkan_context_get_draw_index (self->vulkan)], NULL, clip);
 
+  gsk_vulkan_glyph_cache_begin_frame (self->glyph_cache);
+
   gsk_vulkan_render_add_node (render, root);
 
   gsk_vulkan_render_upload (render);
@@ -261,6 +312,10 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (profiler, self->profile_counters.frames);
 
+  GSK_RENDERER_NOTE (renderer, VULKAN,
+                     g_message ("Culled %" G_GINT64_FORMAT " occluded nodes",
+                                gsk_profiler_counter_get (profiler, self->profile_counters.culled_nodes)));
+
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
@@ -270,15 +325,84 @@ gsk_vulkan_renderer_render (GskRenderer          *renderer,
   gdk_draw_context_end_frame (GDK_DRAW_CONTEXT (self->vulkan));
 }
 
+static void
+gsk_vulkan_renderer_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  GskVulkanRenderer *self = GSK_VULKAN_RENDERER (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_FRAMES_IN_FLIGHT:
+      if (self->n_frames_in_flight != g_value_get_int (value))
+        {
+          self->n_frames_in_flight = g_value_get_int (value);
+          gsk_vulkan_renderer_free_renders (self, self->n_frames_in_flight);
+          g_object_notify_by_pspec (gobject, pspec);
+        }
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gsk_vulkan_renderer_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  GskVulkanRenderer *self = GSK_VULKAN_RENDERER (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_FRAMES_IN_FLIGHT:
+      g_value_set_int (value, self->n_frames_in_flight);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 gsk_vulkan_renderer_class_init (GskVulkanRendererClass *klass)
 {
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = gsk_vulkan_renderer_set_property;
+  gobject_class->get_property = gsk_vulkan_renderer_get_property;
 
   renderer_class->realize = gsk_vulkan_renderer_realize;
   renderer_class->unrealize = gsk_vulkan_renderer_unrealize;
   renderer_class->render = gsk_vulkan_renderer_render;
   renderer_class->render_texture = gsk_vulkan_renderer_render_texture;
+
+  /**
+   * GskVulkanRenderer:frames-in-flight:
+   *
+   * The number of frames the CPU may prepare ahead of the GPU.
+   *
+   * Each frame in flight has its own command pool, descriptor pool
+   * and vertex buffers, so a frame can be built while the previous
+   * ones are still executing. A value of 1 waits for every frame
+   * to finish before starting the next one.
+   */
+  gsk_vulkan_renderer_properties[PROP_FRAMES_IN_FLIGHT] =
+    g_param_spec_int ("frames-in-flight",
+                      "Frames in flight",
+                      "Number of frames prepared ahead of the GPU",
+                      1, MAX_FRAMES_IN_FLIGHT,
+                      DEFAULT_FRAMES_IN_FLIGHT,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, gsk_vulkan_renderer_properties);
 }
 
 static void
@@ -290,11 +414,14 @@ gsk_vulkan_renderer_init (GskVulkanRenderer *self)
 
   gsk_ensure_resources ();
 
+  self->n_frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT;
+
 #ifdef G_ENABLE_DEBUG
   self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
   self->profile_counters.render_passes = gsk_profiler_add_counter (profiler, "render-passes", "Render passes", FALSE);
   self->profile_counters.fallback_pixels = gsk_profiler_add_counter (profiler, "fallback-pixels", "Fallback pixels", TRUE);
   self->profile_counters.texture_pixels = gsk_profiler_add_counter (profiler, "texture-pixels", "Texture pixels", TRUE);
+  self->profile_counters.culled_nodes = gsk_profiler_add_counter (profiler, "culled-nodes", "Occluded nodes skipped", TRUE);
 
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), SYNC))
@@ -328,20 +455,37 @@ gsk_vulkan_renderer_ref_texture_image (GskVulkanRenderer *self,
                                        GskVulkanUploader *uploader)
 {
   GskVulkanTextureData *data;
-  cairo_surface_t *surface;
   GskVulkanImage *image;
 
   data = gdk_texture_get_render_data (texture, self);
   if (data)
     return g_object_ref (data->image);
 
-  surface = gdk_texture_download_surface (texture);
-  image = gsk_vulkan_image_new_from_data (uploader,
-                                          cairo_image_surface_get_data (surface),
-                                          cairo_image_surface_get_width (surface),
-                                          cairo_image_surface_get_height (surface),
-                                          cairo_image_surface_get_stride (surface));
-  cairo_surface_destroy (surface);
+  if (GDK_IS_MEMORY_TEXTURE (texture))
+    {
+      GdkMemoryTexture *memory_texture = GDK_MEMORY_TEXTURE (texture);
+
+      /* Convert straight into the image, without a surface in between */
+      image = gsk_vulkan_image_new_from_data (uploader,
+                                              gdk_memory_texture_get_data (memory_texture),
+                                              gdk_memory_texture_get_format (memory_texture),
+                                              gdk_texture_get_width (texture),
+                                              gdk_texture_get_height (texture),
+                                              gdk_memory_texture_get_stride (memory_texture));
+    }
+  else
+    {
+      cairo_surface_t *surface;
+
+      surface = gdk_texture_download_surface (texture);
+      image = gsk_vulkan_image_new_from_data (uploader,
+                                              cairo_image_surface_get_data (surface),
+                                              GDK_MEMORY_DEFAULT,
+                                              cairo_image_surface_get_width (surface),
+                                              cairo_image_surface_get_height (surface),
+                                              cairo_image_surface_get_stride (surface));
+      cairo_surface_destroy (surface);
+    }
 
   data = g_slice_new0 (GskVulkanTextureData);
   data->image = image;
@@ -361,6 +505,13 @@ gsk_vulkan_renderer_ref_texture_image (GskVulkanRenderer *self,
   return image;
 }
 
+void
+gsk_vulkan_renderer_upload_glyphs (GskVulkanRenderer *self,
+                                   GskVulkanUploader *uploader)
+{
+  gsk_vulkan_glyph_cache_upload (self->glyph_cache, uploader);
+}
+
 GskVulkanImage *
 gsk_vulkan_renderer_ref_glyph_image (GskVulkanRenderer  *self,
                                      GskVulkanUploader  *uploader,
@@ -373,22 +524,24 @@ guint
 gsk_vulkan_renderer_cache_glyph (GskVulkanRenderer *self,
                                  PangoFont         *font,
                                  PangoGlyph         glyph,
+                                 gboolean           color,
                                  int                x,
                                  int                y,
                                  float              scale)
 {
-  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, TRUE, font, glyph, x, y, scale)->texture_index;
+  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, TRUE, font, glyph, color, x, y, scale)->texture_index;
 }
 
 GskVulkanCachedGlyph *
 gsk_vulkan_renderer_get_cached_glyph (GskVulkanRenderer *self,
                                       PangoFont         *font,
                                       PangoGlyph         glyph,
+                                      gboolean           color,
                                       int                x,
                                       int                y,
                                       float              scale)
 {
-  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, FALSE, font, glyph, x, y, scale);
+  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, FALSE, font, glyph, color, x, y, scale);
 }
 
 /**
@@ -30,10 +30,14 @@ typedef struct
 guint                  gsk_vulkan_renderer_cache_glyph      (GskVulkanRenderer *renderer,
                                                              PangoFont         *font,
                                                              PangoGlyph         glyph,
+                                                             gboolean           color,
                                                              int                x,
                                                              int                y,
                                                              float              scale);
 
+void                   gsk_vulkan_renderer_upload_glyphs    (GskVulkanRenderer *self,
+                                                             GskVulkanUploader *uploader);
+
 GskVulkanImage *       gsk_vulkan_renderer_ref_glyph_image  (GskVulkanRenderer *self,
                                                              GskVulkanUploader *uploader,
                                                              guint              index);
@@ -41,6 +45,7 @@ GskVulkanImage *       gsk_vulkan_renderer_ref_glyph_image  (GskVulkanRenderer *
 GskVulkanCachedGlyph * gsk_vulkan_renderer_get_cached_glyph (GskVulkanRenderer *self,
                                                              PangoFont         *font,
                                                              PangoGlyph         glyph,
+                                                             gboolean           color,
                                                              int                x,
                                                              int                y,
                                                              float              scale);
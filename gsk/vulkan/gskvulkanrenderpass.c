@@ -29,6 +29,13 @@
 #define ORTHO_NEAR_PLANE        -10000
 #define ORTHO_FAR_PLANE          10000
 
+/* Below this many ops, threading costs more than it saves */
+#define MIN_PARALLEL_COLLECT_OPS 4096
+#define MIN_OPS_PER_COLLECT_JOB  1024
+#define MAX_COLLECT_THREADS      8
+
+typedef struct _CollectBatch CollectBatch;
+
 typedef union _GskVulkanOp GskVulkanOp;
 typedef struct _GskVulkanOpRender GskVulkanOpRender;
 typedef struct _GskVulkanOpText GskVulkanOpText;
@@ -124,8 +131,11 @@ struct _GskVulkanRenderPass
   GArray *wait_semaphores;
   GskVulkanBuffer *vertex_data;
 
+  gboolean cull_occluded;
+
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  GQuark culled_nodes;
 };
 
 GskVulkanRenderPass *
@@ -203,10 +213,12 @@ gsk_vulkan_render_pass_new (GdkVulkanContext  *context,
   self->signal_semaphore = signal_semaphore;
   self->wait_semaphores = g_array_new (FALSE, FALSE, sizeof (VkSemaphore));
   self->vertex_data = NULL;
+  self->cull_occluded = g_getenv ("GSK_NO_OCCLUSION_CULLING") == NULL;
 
 #ifdef G_ENABLE_DEBUG
   self->fallback_pixels = g_quark_from_static_string ("fallback-pixels");
   self->texture_pixels = g_quark_from_static_string ("texture-pixels");
+  self->culled_nodes = g_quark_from_static_string ("culled-nodes");
 #endif
 
   return self;
@@ -396,6 +408,7 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
             texture_index = gsk_vulkan_renderer_cache_glyph (renderer,
                                                              (PangoFont *)font,
                                                              gi->glyph,
+                                                             has_color_glyphs,
                                                              x_position + gi->geometry.x_offset,
                                                              gi->geometry.y_offset,
                                                              op.text.scale);
@@ -535,6 +548,16 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
 
         for (i = 0; i < gsk_container_node_get_n_children (node); i++)
           {
+            /* Hidden behind an opaque sibling */
+            if (self->cull_occluded && gsk_container_node_is_child_occluded (node, i))
+              {
+#ifdef G_ENABLE_DEBUG
+                gsk_profiler_counter_inc (gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render)),
+                                          self->culled_nodes);
+#endif
+                continue;
+              }
+
             gsk_vulkan_render_pass_add_node (self, render, constants, gsk_container_node_get_child (node, i));
           }
       }
@@ -788,6 +811,7 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
 
   result = gsk_vulkan_image_new_from_data (uploader,
                                            cairo_image_surface_get_data (surface),
+                                           GDK_MEMORY_DEFAULT,
                                            cairo_image_surface_get_width (surface),
                                            cairo_image_surface_get_height (surface),
                                            cairo_image_surface_get_stride (surface));
@@ -863,6 +887,7 @@ gsk_vulkan_render_pass_upload_fallback (GskVulkanRenderPass  *self,
 
   op->source = gsk_vulkan_image_new_from_data (uploader,
                                                cairo_image_surface_get_data (surface),
+                                               GDK_MEMORY_DEFAULT,
                                                cairo_image_surface_get_width (surface),
                                                cairo_image_surface_get_height (surface),
                                                cairo_image_surface_get_stride (surface));
@@ -1146,9 +1171,17 @@ gsk_vulkan_render_pass_count_vertex_data (GskVulkanRenderPass *self)
   return n_bytes;
 }
 
+/* Collects the vertex data for the ops from @first_op up to, but not
+ * including, @last_op, starting at @offset. This may run in a worker
+ * thread, so it must not modify anything but the ops in its range.
+ * Glyph cache lookups are fine, since all glyphs have been added, and
+ * their timestamps updated, by gsk_vulkan_render_pass_add().
+ */
 static gsize
 gsk_vulkan_render_pass_collect_vertex_data (GskVulkanRenderPass *self,
                                             GskVulkanRender     *render,
+                                            guint                first_op,
+                                            guint                last_op,
                                             guchar              *data,
                                             gsize                offset,
                                             gsize                total)
@@ -1158,7 +1191,7 @@ gsk_vulkan_render_pass_collect_vertex_data (GskVulkanRenderPass *self,
   guint i;
 
   n_bytes = 0;
-  for (i = 0; i < self->render_ops->len; i++)
+  for (i = first_op; i < last_op; i++)
     {
       op = &g_array_index (self->render_ops, GskVulkanOp, i);
 
@@ -1382,6 +1415,135 @@ gsk_vulkan_render_pass_collect_vertex_data (GskVulkanRenderPass *self,
   return n_bytes;
 }
 
+static gsize
+gsk_vulkan_op_get_vertex_count (const GskVulkanOp *op)
+{
+  switch (op->type)
+    {
+    case GSK_VULKAN_OP_TEXT:
+    case GSK_VULKAN_OP_COLOR_TEXT:
+      return op->text.vertex_count;
+
+    case GSK_VULKAN_OP_PUSH_VERTEX_CONSTANTS:
+      return 0;
+
+    default:
+      return op->render.vertex_count;
+    }
+}
+
+typedef struct
+{
+  GskVulkanRenderPass *pass;
+  GskVulkanRender *render;
+  guint first_op;
+  guint last_op;
+  guchar *data;
+  gsize offset;
+  gsize total;
+  CollectBatch *batch;
+} CollectJob;
+
+struct _CollectBatch
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+};
+
+static GThreadPool *collect_pool;
+
+static void
+collect_job_run (gpointer data,
+                 gpointer user_data)
+{
+  CollectJob *job = data;
+  CollectBatch *batch = job->batch;
+
+  gsk_vulkan_render_pass_collect_vertex_data (job->pass, job->render,
+                                              job->first_op, job->last_op,
+                                              job->data, job->offset, job->total);
+
+  g_mutex_lock (&batch->lock);
+  batch->n_pending--;
+  if (batch->n_pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Splits vertex collection for big passes into runs of ops that are
+ * handled by a thread pool. The offsets are known up front from
+ * counting, so the runs write to disjoint parts of the buffer and the
+ * result is identical to collecting everything in order.
+ */
+static void
+gsk_vulkan_render_pass_collect_vertex_data_parallel (GskVulkanRenderPass *self,
+                                                     GskVulkanRender     *render,
+                                                     guchar              *data,
+                                                     gsize                total)
+{
+  guint n_ops = self->render_ops->len;
+  guint n_threads, n_jobs, ops_per_job;
+  CollectBatch batch;
+  CollectJob *jobs;
+  gsize offset;
+  guint i, j;
+
+  n_threads = CLAMP (g_get_num_processors (), 1, MAX_COLLECT_THREADS);
+  n_jobs = MIN (n_threads, n_ops / MIN_OPS_PER_COLLECT_JOB);
+
+  if (n_ops < MIN_PARALLEL_COLLECT_OPS || n_jobs < 2)
+    {
+      gsk_vulkan_render_pass_collect_vertex_data (self, render, 0, n_ops, data, 0, total);
+      return;
+    }
+
+  if (G_UNLIKELY (collect_pool == NULL))
+    collect_pool = g_thread_pool_new (collect_job_run, NULL, MAX_COLLECT_THREADS - 1, FALSE, NULL);
+
+  ops_per_job = (n_ops + n_jobs - 1) / n_jobs;
+  jobs = g_newa (CollectJob, n_jobs);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_jobs - 1;
+
+  offset = 0;
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].pass = self;
+      jobs[i].render = render;
+      jobs[i].first_op = i * ops_per_job;
+      jobs[i].last_op = MIN (jobs[i].first_op + ops_per_job, n_ops);
+      jobs[i].data = data;
+      jobs[i].offset = offset;
+      jobs[i].total = total;
+      jobs[i].batch = &batch;
+
+      for (j = jobs[i].first_op; j < jobs[i].last_op; j++)
+        offset += gsk_vulkan_op_get_vertex_count (&g_array_index (self->render_ops, GskVulkanOp, j));
+    }
+
+  /* The first run is done on this thread while the pool handles the rest */
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (collect_pool, &jobs[i], NULL);
+
+  gsk_vulkan_render_pass_collect_vertex_data (self, render,
+                                              jobs[0].first_op, jobs[0].last_op,
+                                              data, 0, total);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  GSK_RENDERER_NOTE (gsk_vulkan_render_get_renderer (render), RENDERER,
+                     g_message ("Collected vertex data for %u ops in %u threads", n_ops, n_jobs));
+}
+
 static GskVulkanBuffer *
 gsk_vulkan_render_pass_get_vertex_data (GskVulkanRenderPass *self,
                                         GskVulkanRender     *render)
@@ -1394,7 +1556,7 @@ gsk_vulkan_render_pass_get_vertex_data (GskVulkanRenderPass *self,
       n_bytes = gsk_vulkan_render_pass_count_vertex_data (self);
       self->vertex_data = gsk_vulkan_buffer_new (self->vulkan, n_bytes);
       data = gsk_vulkan_buffer_map (self->vertex_data);
-      gsk_vulkan_render_pass_collect_vertex_data (self, render, data, 0, n_bytes);
+      gsk_vulkan_render_pass_collect_vertex_data_parallel (self, render, data, n_bytes);
       gsk_vulkan_buffer_unmap (self->vertex_data);
     }
 
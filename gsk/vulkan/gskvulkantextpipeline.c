@@ -135,6 +135,7 @@ gsk_vulkan_text_pipeline_collect_vertex_data (GskVulkanTextPipeline  *pipeline,
           glyph = gsk_vulkan_renderer_get_cached_glyph (renderer,
                                                         font,
                                                         gi->glyph,
+                                                        FALSE,
                                                         x_position + gi->geometry.x_offset,
                                                         gi->geometry.y_offset,
                                                         scale);
@@ -113,8 +113,27 @@ struct _GtkAtSpiContext
 
   guint registration_ids[20];
   guint n_registered_objects;
+
+  /* State, name, description and bounds changes are collected
+   * here and sent out together from an idle, so that a burst of
+   * changes on the same accessible results in one signal each
+   */
+  guint pending_changes_id;
+  GArray *pending_states;
+  guint pending_name : 1;
+  guint pending_description : 1;
+  guint pending_bounds : 1;
+
+  /* The last bounds we sent, to avoid repeating them */
+  guint bounds_emitted : 1;
+  int bounds[4];
 };
 
+typedef struct {
+  const char *name;
+  gboolean enabled;
+} PendingState;
+
 enum
 {
   PROP_BUS_ADDRESS = 1,
@@ -700,6 +719,17 @@ static const GDBusInterfaceVTable accessible_vtable = {
 };
 /* }}} */
 /* {{{ Change notification */
+/* There is nobody to notify if we are not connected, or if
+ * no AT listens to events. ATs that show up later query the
+ * state they are interested in.
+ */
+static gboolean
+should_emit_events (GtkAtSpiContext *self)
+{
+  return self->connection != NULL &&
+         gtk_at_spi_root_has_event_listeners (self->root);
+}
+
 static void
 emit_text_changed (GtkAtSpiContext *self,
                    const char      *kind,
@@ -707,7 +737,7 @@ emit_text_changed (GtkAtSpiContext *self,
                    int              end,
                    const char      *text)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -725,7 +755,7 @@ emit_text_selection_changed (GtkAtSpiContext *self,
                              const char      *kind,
                              int              cursor_position)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   if (strcmp (kind, "text-caret-moved") == 0)
@@ -752,7 +782,7 @@ static void
 emit_selection_changed (GtkAtSpiContext *self,
                         const char      *kind)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -770,7 +800,7 @@ emit_state_changed (GtkAtSpiContext *self,
                     const char      *name,
                     gboolean         enabled)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -786,7 +816,7 @@ emit_state_changed (GtkAtSpiContext *self,
 static void
 emit_defunct (GtkAtSpiContext *self)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -803,7 +833,7 @@ emit_property_changed (GtkAtSpiContext *self,
                        const char      *name,
                        GVariant        *value)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -823,7 +853,7 @@ emit_bounds_changed (GtkAtSpiContext *self,
                      int              width,
                      int              height)
 {
-  if (self->connection == NULL)
+  if (!should_emit_events (self))
     return;
 
   g_dbus_connection_emit_signal (self->connection,
@@ -843,7 +873,7 @@ emit_children_changed (GtkAtSpiContext         *self,
                        GtkAccessibleChildState  state)
 {
   /* If we don't have a connection on either contexts, we cannot emit a signal */
-  if (self->connection == NULL || child_context->connection == NULL)
+  if (!should_emit_events (self) || child_context->connection == NULL)
     return;
 
   GVariant *context_ref = gtk_at_spi_context_to_ref (self);
@@ -857,6 +887,153 @@ emit_children_changed (GtkAtSpiContext         *self,
                                     context_ref);
 }
 
+static void
+emit_pending_bounds (GtkAtSpiContext *self)
+{
+  GtkAccessible *accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
+  GtkWidget *widget;
+  GtkWidget *parent;
+  double x, y;
+  int width, height;
+
+  if (!GTK_IS_WIDGET (accessible))
+    return;
+
+  widget = GTK_WIDGET (accessible);
+
+  /* Nobody can look at the bounds of widgets that are not on
+   * screen, such as list rows that are waiting to be recycled.
+   * We send the bounds again once they get mapped.
+   */
+  if (!gtk_widget_get_mapped (widget))
+    {
+      self->bounds_emitted = FALSE;
+      return;
+    }
+
+  parent = gtk_widget_get_parent (widget);
+
+  if (parent)
+    gtk_widget_translate_coordinates (widget, parent, 0., 0., &x, &y);
+  else
+    x = y = 0.;
+
+  width = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+
+  if (self->bounds_emitted &&
+      self->bounds[0] == (int) x && self->bounds[1] == (int) y &&
+      self->bounds[2] == width && self->bounds[3] == height)
+    return;
+
+  self->bounds_emitted = TRUE;
+  self->bounds[0] = (int) x;
+  self->bounds[1] = (int) y;
+  self->bounds[2] = width;
+  self->bounds[3] = height;
+
+  emit_bounds_changed (self, (int) x, (int) y, width, height);
+}
+
+static void
+clear_pending_changes (GtkAtSpiContext *self)
+{
+  g_clear_handle_id (&self->pending_changes_id, g_source_remove);
+
+  if (self->pending_states != NULL)
+    g_array_set_size (self->pending_states, 0);
+
+  self->pending_name = FALSE;
+  self->pending_description = FALSE;
+  self->pending_bounds = FALSE;
+}
+
+static gboolean
+emit_pending_changes (gpointer data)
+{
+  GtkAtSpiContext *self = data;
+  guint i;
+
+  self->pending_changes_id = 0;
+
+  if (self->pending_states != NULL)
+    {
+      for (i = 0; i < self->pending_states->len; i++)
+        {
+          PendingState *state = &g_array_index (self->pending_states, PendingState, i);
+
+          emit_state_changed (self, state->name, state->enabled);
+        }
+
+      g_array_set_size (self->pending_states, 0);
+    }
+
+  if (self->pending_name)
+    {
+      char *label = gtk_at_context_get_name (GTK_AT_CONTEXT (self));
+      GVariant *v = g_variant_new_take_string (label);
+      emit_property_changed (self, "accessible-name", v);
+    }
+
+  if (self->pending_description)
+    {
+      char *label = gtk_at_context_get_description (GTK_AT_CONTEXT (self));
+      GVariant *v = g_variant_new_take_string (label);
+      emit_property_changed (self, "accessible-description", v);
+    }
+
+  if (self->pending_bounds)
+    emit_pending_bounds (self);
+
+  self->pending_name = FALSE;
+  self->pending_description = FALSE;
+  self->pending_bounds = FALSE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_pending_changes (GtkAtSpiContext *self)
+{
+  if (self->pending_changes_id != 0)
+    return;
+
+  self->pending_changes_id = g_idle_add (emit_pending_changes, self);
+  g_source_set_name_by_id (self->pending_changes_id, "[gtk] ATSPI pending changes");
+}
+
+/* @name must be a static string */
+static void
+queue_state_changed (GtkAtSpiContext *self,
+                     const char      *name,
+                     gboolean         enabled)
+{
+  PendingState state = { name, enabled };
+  guint i;
+
+  if (!should_emit_events (self))
+    return;
+
+  if (self->pending_states == NULL)
+    self->pending_states = g_array_new (FALSE, FALSE, sizeof (PendingState));
+
+  /* Only the last value of a state within a batch matters */
+  for (i = 0; i < self->pending_states->len; i++)
+    {
+      PendingState *pending = &g_array_index (self->pending_states, PendingState, i);
+
+      if (strcmp (pending->name, name) == 0)
+        {
+          g_array_remove_index (self->pending_states, i);
+          break;
+        }
+    }
+
+  g_array_append_val (self->pending_states, state);
+
+  queue_pending_changes (self);
+}
+
 static void
 gtk_at_spi_context_state_change (GtkATContext                *ctx,
                                  GtkAccessibleStateChange     changed_states,
@@ -870,6 +1047,9 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
   GtkAccessibleValue *value;
 
+  if (!should_emit_events (self))
+    return;
+
   if (GTK_IS_WIDGET (accessible) && !gtk_widget_get_realized (GTK_WIDGET (accessible)))
     return;
 
@@ -906,7 +1086,7 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
   if (changed_states & GTK_ACCESSIBLE_STATE_CHANGE_BUSY)
     {
       value = gtk_accessible_attribute_set_get_value (states, GTK_ACCESSIBLE_STATE_BUSY);
-      emit_state_changed (self, "busy", gtk_boolean_accessible_value_get (value));
+      queue_state_changed (self, "busy", gtk_boolean_accessible_value_get (value));
     }
 
   if (changed_states & GTK_ACCESSIBLE_STATE_CHANGE_CHECKED)
@@ -916,16 +1096,16 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       switch (gtk_tristate_accessible_value_get (value))
         {
         case GTK_ACCESSIBLE_TRISTATE_TRUE:
-          emit_state_changed (self, "checked", TRUE);
-          emit_state_changed (self, "indeterminate", FALSE);
+          queue_state_changed (self, "checked", TRUE);
+          queue_state_changed (self, "indeterminate", FALSE);
           break;
         case GTK_ACCESSIBLE_TRISTATE_MIXED:
-          emit_state_changed (self, "checked", FALSE);
-          emit_state_changed (self, "indeterminate", TRUE);
+          queue_state_changed (self, "checked", FALSE);
+          queue_state_changed (self, "indeterminate", TRUE);
           break;
         case GTK_ACCESSIBLE_TRISTATE_FALSE:
-          emit_state_changed (self, "checked", FALSE);
-          emit_state_changed (self, "indeterminate", FALSE);
+          queue_state_changed (self, "checked", FALSE);
+          queue_state_changed (self, "indeterminate", FALSE);
           break;
         default:
           break;
@@ -935,7 +1115,7 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
   if (changed_states & GTK_ACCESSIBLE_STATE_CHANGE_DISABLED)
     {
       value = gtk_accessible_attribute_set_get_value (states, GTK_ACCESSIBLE_STATE_DISABLED);
-      emit_state_changed (self, "sensitive", !gtk_boolean_accessible_value_get (value));
+      queue_state_changed (self, "sensitive", !gtk_boolean_accessible_value_get (value));
     }
 
   if (changed_states & GTK_ACCESSIBLE_STATE_CHANGE_EXPANDED)
@@ -943,11 +1123,11 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       value = gtk_accessible_attribute_set_get_value (states, GTK_ACCESSIBLE_STATE_EXPANDED);
       if (value->value_class->type == GTK_ACCESSIBLE_VALUE_TYPE_BOOLEAN)
         {
-          emit_state_changed (self, "expandable", TRUE);
-          emit_state_changed (self, "expanded",gtk_boolean_accessible_value_get (value));
+          queue_state_changed (self, "expandable", TRUE);
+          queue_state_changed (self, "expanded",gtk_boolean_accessible_value_get (value));
         }
       else
-        emit_state_changed (self, "expandable", FALSE);
+        queue_state_changed (self, "expandable", FALSE);
     }
 
   if (changed_states & GTK_ACCESSIBLE_STATE_CHANGE_INVALID)
@@ -958,10 +1138,10 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
         case GTK_ACCESSIBLE_INVALID_TRUE:
         case GTK_ACCESSIBLE_INVALID_GRAMMAR:
         case GTK_ACCESSIBLE_INVALID_SPELLING:
-          emit_state_changed (self, "invalid", TRUE);
+          queue_state_changed (self, "invalid", TRUE);
           break;
         case GTK_ACCESSIBLE_INVALID_FALSE:
-          emit_state_changed (self, "invalid", FALSE);
+          queue_state_changed (self, "invalid", FALSE);
           break;
         default:
           break;
@@ -974,16 +1154,16 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       switch (gtk_tristate_accessible_value_get (value))
         {
         case GTK_ACCESSIBLE_TRISTATE_TRUE:
-          emit_state_changed (self, "pressed", TRUE);
-          emit_state_changed (self, "indeterminate", FALSE);
+          queue_state_changed (self, "pressed", TRUE);
+          queue_state_changed (self, "indeterminate", FALSE);
           break;
         case GTK_ACCESSIBLE_TRISTATE_MIXED:
-          emit_state_changed (self, "pressed", FALSE);
-          emit_state_changed (self, "indeterminate", TRUE);
+          queue_state_changed (self, "pressed", FALSE);
+          queue_state_changed (self, "indeterminate", TRUE);
           break;
         case GTK_ACCESSIBLE_TRISTATE_FALSE:
-          emit_state_changed (self, "pressed", FALSE);
-          emit_state_changed (self, "indeterminate", FALSE);
+          queue_state_changed (self, "pressed", FALSE);
+          queue_state_changed (self, "indeterminate", FALSE);
           break;
         default:
           break;
@@ -995,11 +1175,11 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       value = gtk_accessible_attribute_set_get_value (states, GTK_ACCESSIBLE_STATE_SELECTED);
       if (value->value_class->type == GTK_ACCESSIBLE_VALUE_TYPE_BOOLEAN)
         {
-          emit_state_changed (self, "selectable", TRUE);
-          emit_state_changed (self, "selected",gtk_boolean_accessible_value_get (value));
+          queue_state_changed (self, "selectable", TRUE);
+          queue_state_changed (self, "selected",gtk_boolean_accessible_value_get (value));
         }
       else
-        emit_state_changed (self, "selectable", FALSE);
+        queue_state_changed (self, "selectable", FALSE);
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_READ_ONLY)
@@ -1009,9 +1189,9 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       value = gtk_accessible_attribute_set_get_value (properties, GTK_ACCESSIBLE_PROPERTY_READ_ONLY);
       readonly = gtk_boolean_accessible_value_get (value);
 
-      emit_state_changed (self, "read-only", readonly);
+      queue_state_changed (self, "read-only", readonly);
       if (ctx->accessible_role == GTK_ACCESSIBLE_ROLE_TEXT_BOX)
-        emit_state_changed (self, "editable", !readonly);
+        queue_state_changed (self, "editable", !readonly);
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_ORIENTATION)
@@ -1019,40 +1199,44 @@ gtk_at_spi_context_state_change (GtkATContext                *ctx,
       value = gtk_accessible_attribute_set_get_value (properties, GTK_ACCESSIBLE_PROPERTY_ORIENTATION);
       if (gtk_orientation_accessible_value_get (value) == GTK_ORIENTATION_HORIZONTAL)
         {
-          emit_state_changed (self, "horizontal", TRUE);
-          emit_state_changed (self, "vertical", FALSE);
+          queue_state_changed (self, "horizontal", TRUE);
+          queue_state_changed (self, "vertical", FALSE);
         }
       else
         {
-          emit_state_changed (self, "horizontal", FALSE);
-          emit_state_changed (self, "vertical", TRUE);
+          queue_state_changed (self, "horizontal", FALSE);
+          queue_state_changed (self, "vertical", TRUE);
         }
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_MODAL)
     {
       value = gtk_accessible_attribute_set_get_value (properties, GTK_ACCESSIBLE_PROPERTY_MODAL);
-      emit_state_changed (self, "modal", gtk_boolean_accessible_value_get (value));
+      queue_state_changed (self, "modal", gtk_boolean_accessible_value_get (value));
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_MULTI_LINE)
     {
       value = gtk_accessible_attribute_set_get_value (properties, GTK_ACCESSIBLE_PROPERTY_MULTI_LINE);
-      emit_state_changed (self, "multi-line", gtk_boolean_accessible_value_get (value));
+      queue_state_changed (self, "multi-line", gtk_boolean_accessible_value_get (value));
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_LABEL)
     {
-      char *label = gtk_at_context_get_name (GTK_AT_CONTEXT (self));
-      GVariant *v = g_variant_new_take_string (label);
-      emit_property_changed (self, "accessible-name", v);
+      if (should_emit_events (self))
+        {
+          self->pending_name = TRUE;
+          queue_pending_changes (self);
+        }
     }
 
   if (changed_properties & GTK_ACCESSIBLE_PROPERTY_CHANGE_DESCRIPTION)
     {
-      char *label = gtk_at_context_get_description (GTK_AT_CONTEXT (self));
-      GVariant *v = g_variant_new_take_string (label);
-      emit_property_changed (self, "accessible-description", v);
+      if (should_emit_events (self))
+        {
+          self->pending_description = TRUE;
+          queue_pending_changes (self);
+        }
     }
 }
 
@@ -1064,6 +1248,9 @@ gtk_at_spi_context_platform_change (GtkATContext                *ctx,
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
   GtkWidget *widget;
 
+  if (!should_emit_events (self))
+    return;
+
   if (!GTK_IS_WIDGET (accessible))
     return;
 
@@ -1075,14 +1262,14 @@ gtk_at_spi_context_platform_change (GtkATContext                *ctx,
     {
       gboolean state = gtk_accessible_get_platform_state (GTK_ACCESSIBLE (widget),
                                                           GTK_ACCESSIBLE_PLATFORM_STATE_FOCUSABLE);
-      emit_state_changed (self, "focusable", state);
+      queue_state_changed (self, "focusable", state);
     }
 
   if (changed_platform & GTK_ACCESSIBLE_PLATFORM_CHANGE_FOCUSED)
     {
       gboolean state = gtk_accessible_get_platform_state (GTK_ACCESSIBLE (widget),
                                                           GTK_ACCESSIBLE_PLATFORM_STATE_FOCUSED);
-      emit_state_changed (self, "focused", state);
+      queue_state_changed (self, "focused", state);
     }
 }
 
@@ -1092,9 +1279,9 @@ gtk_at_spi_context_bounds_change (GtkATContext *ctx)
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
   GtkWidget *widget;
-  GtkWidget *parent;
-  double x, y;
-  int width, height;
+
+  if (!should_emit_events (self))
+    return;
 
   if (!GTK_IS_WIDGET (accessible))
     return;
@@ -1103,17 +1290,11 @@ gtk_at_spi_context_bounds_change (GtkATContext *ctx)
   if (!gtk_widget_get_realized (widget))
     return;
 
-  parent = gtk_widget_get_parent (widget);
-
-  if (parent)
-    gtk_widget_translate_coordinates (widget, parent, 0., 0., &x, &y);
-  else
-    x = y = 0.;
-
-  width = gtk_widget_get_width (widget);
-  height = gtk_widget_get_height (widget);
-
-  emit_bounds_changed (self, (int)x, (int)y, width, height);
+  /* Allocation changes come in bursts, for instance for every row
+   * of a scrolling list, so only look at the final bounds
+   */
+  self->pending_bounds = TRUE;
+  queue_pending_changes (self);
 }
 
 static void
@@ -1123,14 +1304,19 @@ gtk_at_spi_context_child_change (GtkATContext             *ctx,
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
   GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
-  GtkATContext *child_context = gtk_accessible_get_at_context (child);
+  GtkATContext *child_context;
   GtkWidget *parent_widget;
   GtkWidget *child_widget;
   int idx = 0;
 
+  if (!should_emit_events (self))
+    return;
+
   if (!GTK_IS_WIDGET (accessible))
     return;
 
+  child_context = gtk_accessible_get_at_context (child);
+
   if (child_context == NULL)
     return;
 
@@ -1369,6 +1555,9 @@ gtk_at_spi_context_finalize (GObject *gobject)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (gobject);
 
+  clear_pending_changes (self);
+  g_clear_pointer (&self->pending_states, g_array_unref);
+
   gtk_at_spi_context_unregister_object (self);
 
   g_clear_object (&self->root);
@@ -1511,7 +1700,11 @@ gtk_at_spi_context_unrealize (GtkATContext *context)
                              self->context_path,
                              G_OBJECT_TYPE_NAME (accessible)));
 
-  /* Notify ATs that the accessible object is going away */
+  /* Notify ATs that the accessible object is going away; there
+   * is no point in telling them about changes to it anymore
+   */
+  clear_pending_changes (self);
+  self->bounds_emitted = FALSE;
   emit_defunct (self);
   gtk_at_spi_root_unregister (self->root, self);
 
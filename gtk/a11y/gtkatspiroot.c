@@ -44,6 +44,7 @@
 #define ATSPI_PATH_PREFIX       "/org/a11y/atspi"
 #define ATSPI_ROOT_PATH         ATSPI_PATH_PREFIX "/accessible/root"
 #define ATSPI_CACHE_PATH        ATSPI_PATH_PREFIX "/cache"
+#define ATSPI_REGISTRY_PATH     ATSPI_PATH_PREFIX "/registry"
 
 struct _GtkAtSpiRoot
 {
@@ -70,6 +71,14 @@ struct _GtkAtSpiRoot
   GtkAtSpiCache *cache;
 
   GListModel *toplevels;
+
+  /* Number of event listeners registered by ATs; until the
+   * registry tells us, we assume that there are some
+   */
+  int n_event_listeners;
+  gboolean event_listeners_known;
+  guint listener_registered_id;
+  guint listener_deregistered_id;
 };
 
 enum
@@ -103,6 +112,16 @@ gtk_at_spi_root_dispose (GObject *gobject)
 {
   GtkAtSpiRoot *self = GTK_AT_SPI_ROOT (gobject);
 
+  if (self->connection != NULL)
+    {
+      if (self->listener_registered_id != 0)
+        g_dbus_connection_signal_unsubscribe (self->connection, self->listener_registered_id);
+      if (self->listener_deregistered_id != 0)
+        g_dbus_connection_signal_unsubscribe (self->connection, self->listener_deregistered_id);
+    }
+  self->listener_registered_id = 0;
+  self->listener_deregistered_id = 0;
+
   g_clear_object (&self->cache);
   g_clear_object (&self->connection);
 
@@ -473,6 +492,96 @@ gtk_at_spi_root_child_changed (GtkAtSpiRoot             *self,
                                     window_ref);
 }
 
+static void
+on_event_listener_registered (GDBusConnection *connection,
+                              const char      *sender_name,
+                              const char      *object_path,
+                              const char      *interface_name,
+                              const char      *signal_name,
+                              GVariant        *parameters,
+                              gpointer         user_data)
+{
+  GtkAtSpiRoot *self = user_data;
+
+  if (g_strcmp0 (signal_name, "EventListenerRegistered") == 0)
+    self->n_event_listeners += 1;
+  else if (self->n_event_listeners > 0)
+    self->n_event_listeners -= 1;
+
+  GTK_NOTE (A11Y, g_message ("%d event listeners on the a11y bus", self->n_event_listeners));
+}
+
+static void
+on_registered_events_reply (GObject      *gobject,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  GtkAtSpiRoot *self = user_data;
+  GError *error = NULL;
+  GVariant *reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (gobject), result, &error);
+  GVariant *events;
+
+  /* Keep assuming that somebody listens if we can't tell */
+  if (error != NULL)
+    {
+      GTK_NOTE (A11Y, g_message ("Unable to get the registered a11y events: %s", error->message));
+      g_error_free (error);
+      return;
+    }
+
+  events = g_variant_get_child_value (reply, 0);
+  self->n_event_listeners += g_variant_n_children (events);
+  self->event_listeners_known = TRUE;
+  g_variant_unref (events);
+  g_variant_unref (reply);
+
+  GTK_NOTE (A11Y, g_message ("%d event listeners on the a11y bus", self->n_event_listeners));
+}
+
+/* Subscribe to the changes before asking for the current
+ * listeners, so that none gets lost in between. A listener
+ * that registers in between may get counted twice, which
+ * only means we keep emitting events for a bit longer.
+ */
+static void
+track_event_listeners (GtkAtSpiRoot *self)
+{
+  self->listener_registered_id =
+    g_dbus_connection_signal_subscribe (self->connection,
+                                        "org.a11y.atspi.Registry",
+                                        "org.a11y.atspi.Registry",
+                                        "EventListenerRegistered",
+                                        ATSPI_REGISTRY_PATH,
+                                        NULL,
+                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                        on_event_listener_registered,
+                                        self,
+                                        NULL);
+  self->listener_deregistered_id =
+    g_dbus_connection_signal_subscribe (self->connection,
+                                        "org.a11y.atspi.Registry",
+                                        "org.a11y.atspi.Registry",
+                                        "EventListenerDeregistered",
+                                        ATSPI_REGISTRY_PATH,
+                                        NULL,
+                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                        on_event_listener_registered,
+                                        self,
+                                        NULL);
+
+  g_dbus_connection_call (self->connection,
+                          "org.a11y.atspi.Registry",
+                          ATSPI_REGISTRY_PATH,
+                          "org.a11y.atspi.Registry",
+                          "GetRegisteredEvents",
+                          NULL,
+                          G_VARIANT_TYPE ("(a(ss))"),
+                          G_DBUS_CALL_FLAGS_NONE, -1,
+                          NULL,
+                          on_registered_events_reply,
+                          self);
+}
+
 static void
 on_registration_reply (GObject      *gobject,
                        GAsyncResult *result,
@@ -515,6 +624,8 @@ on_registration_reply (GObject      *gobject,
     }
 
   self->toplevels = gtk_window_get_toplevels ();
+
+  track_event_listeners (self);
 }
 
 static gboolean
@@ -778,6 +889,24 @@ gtk_at_spi_root_to_ref (GtkAtSpiRoot *self)
   return g_variant_new ("(so)", self->desktop_name, self->desktop_path);
 }
 
+/*< private >
+ * gtk_at_spi_root_has_event_listeners:
+ * @self: a #GtkAtSpiRoot
+ *
+ * Checks whether any AT listens to events on the accessibility
+ * bus. When nobody does, contexts don't need to emit change
+ * notifications; ATs that show up later query the current state.
+ *
+ * Returns: %TRUE if events may have listeners
+ */
+gboolean
+gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self)
+{
+  g_return_val_if_fail (GTK_IS_AT_SPI_ROOT (self), TRUE);
+
+  return !self->event_listeners_known || self->n_event_listeners > 0;
+}
+
 const char *
 gtk_at_spi_root_get_base_path (GtkAtSpiRoot *self)
 {
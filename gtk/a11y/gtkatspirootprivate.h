@@ -51,6 +51,9 @@ gtk_at_spi_root_get_cache (GtkAtSpiRoot *self);
 const char *
 gtk_at_spi_root_get_base_path (GtkAtSpiRoot *self);
 
+gboolean
+gtk_at_spi_root_has_event_listeners (GtkAtSpiRoot *self);
+
 GVariant *
 gtk_at_spi_root_to_ref (GtkAtSpiRoot *self);
 
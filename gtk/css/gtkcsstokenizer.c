@@ -50,13 +50,15 @@ gtk_css_token_clear (GtkCssToken *token)
     case GTK_CSS_TOKEN_HASH_UNRESTRICTED:
     case GTK_CSS_TOKEN_HASH_ID:
     case GTK_CSS_TOKEN_URL:
-      g_free (token->string.string);
+      if (token->string.len >= GTK_CSS_TOKEN_STRING_SIZE)
+        g_free (token->string.u.string);
       break;
 
     case GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION:
     case GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION:
     case GTK_CSS_TOKEN_DIMENSION:
-      g_free (token->dimension.dimension);
+      if (token->dimension.len >= GTK_CSS_TOKEN_STRING_SIZE)
+        g_free (token->dimension.u.string);
       break;
 
     default:
@@ -95,6 +97,24 @@ gtk_css_token_clear (GtkCssToken *token)
   token->type = GTK_CSS_TOKEN_EOF;
 }
 
+const char *
+gtk_css_token_get_string (const GtkCssToken *token)
+{
+  if (token->string.len < GTK_CSS_TOKEN_STRING_SIZE)
+    return token->string.u.buf;
+  else
+    return token->string.u.string;
+}
+
+const char *
+gtk_css_token_get_dimension (const GtkCssToken *token)
+{
+  if (token->dimension.len < GTK_CSS_TOKEN_STRING_SIZE)
+    return token->dimension.u.buf;
+  else
+    return token->dimension.u.string;
+}
+
 static void
 gtk_css_token_init (GtkCssToken     *token,
                     GtkCssTokenType  type)
@@ -293,7 +313,7 @@ gtk_css_token_is_ident (const GtkCssToken *token,
                         const char        *ident)
 {
   return gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT)
-      && (g_ascii_strcasecmp (token->string.string, ident) == 0);
+      && (g_ascii_strcasecmp (gtk_css_token_get_string (token), ident) == 0);
 }
 
 gboolean
@@ -301,7 +321,7 @@ gtk_css_token_is_function (const GtkCssToken *token,
                            const char        *ident)
 {
   return gtk_css_token_is (token, GTK_CSS_TOKEN_FUNCTION)
-      && (g_ascii_strcasecmp (token->string.string, ident) == 0);
+      && (g_ascii_strcasecmp (gtk_css_token_get_string (token), ident) == 0);
 }
 
 gboolean
@@ -321,33 +341,33 @@ gtk_css_token_print (const GtkCssToken *token,
   switch (token->type)
     {
     case GTK_CSS_TOKEN_STRING:
-      append_string (string, token->string.string);
+      append_string (string, gtk_css_token_get_string (token));
       break;
 
     case GTK_CSS_TOKEN_IDENT:
-      append_ident (string, token->string.string);
+      append_ident (string, gtk_css_token_get_string (token));
       break;
 
     case GTK_CSS_TOKEN_URL:
       g_string_append (string, "url(");
-      append_ident (string, token->string.string);
+      append_ident (string, gtk_css_token_get_string (token));
       g_string_append (string, ")");
       break;
 
     case GTK_CSS_TOKEN_FUNCTION:
-      append_ident (string, token->string.string);
+      append_ident (string, gtk_css_token_get_string (token));
       g_string_append_c (string, '(');
       break;
 
     case GTK_CSS_TOKEN_AT_KEYWORD:
       g_string_append_c (string, '@');
-      append_ident (string, token->string.string);
+      append_ident (string, gtk_css_token_get_string (token));
       break;
 
     case GTK_CSS_TOKEN_HASH_UNRESTRICTED:
     case GTK_CSS_TOKEN_HASH_ID:
       g_string_append_c (string, '#');
-      append_ident (string, token->string.string);
+      append_ident (string, gtk_css_token_get_string (token));
       break;
 
     case GTK_CSS_TOKEN_DELIM:
@@ -379,7 +399,7 @@ gtk_css_token_print (const GtkCssToken *token,
     case GTK_CSS_TOKEN_DIMENSION:
       g_ascii_dtostr (buf, G_ASCII_DTOSTR_BUF_SIZE, token->dimension.value);
       g_string_append (string, buf);
-      append_ident (string, token->dimension.dimension);
+      append_ident (string, gtk_css_token_get_dimension (token));
       break;
 
     case GTK_CSS_TOKEN_EOF:
@@ -485,10 +505,14 @@ gtk_css_token_to_string (const GtkCssToken *token)
   return g_string_free (string, FALSE);
 }
 
+/* Short strings are copied into the token, so that most tokens don't
+ * need an allocation. The string does not need to be nul-terminated.
+ */
 static void
 gtk_css_token_init_string (GtkCssToken     *token,
                            GtkCssTokenType  type,
-                           char            *string)
+                           const char      *string,
+                           gsize            len)
 {
   token->type = type;
 
@@ -501,7 +525,14 @@ gtk_css_token_init_string (GtkCssToken     *token,
     case GTK_CSS_TOKEN_HASH_UNRESTRICTED:
     case GTK_CSS_TOKEN_HASH_ID:
     case GTK_CSS_TOKEN_URL:
-      token->string.string = string;
+      token->string.len = len;
+      if (len < GTK_CSS_TOKEN_STRING_SIZE)
+        {
+          memcpy (token->string.u.buf, string, len);
+          token->string.u.buf[len] = 0;
+        }
+      else
+        token->string.u.string = g_strndup (string, len);
       break;
     default:
       g_assert_not_reached ();
@@ -541,7 +572,8 @@ static void
 gtk_css_token_init_dimension (GtkCssToken     *token,
                               GtkCssTokenType  type,
                               double           value,
-                              char            *dimension)
+                              const char      *dimension,
+                              gsize            len)
 {
   token->type = type;
 
@@ -551,7 +583,14 @@ gtk_css_token_init_dimension (GtkCssToken     *token,
     case GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION:
     case GTK_CSS_TOKEN_DIMENSION:
       token->dimension.value = value;
-      token->dimension.dimension = dimension;
+      token->dimension.len = len;
+      if (len < GTK_CSS_TOKEN_STRING_SIZE)
+        {
+          memcpy (token->dimension.u.buf, dimension, len);
+          token->dimension.u.buf[len] = 0;
+        }
+      else
+        token->dimension.u.string = g_strndup (dimension, len);
       break;
     default:
       g_assert_not_reached ();
@@ -870,10 +909,53 @@ gtk_css_tokenizer_read_escape (GtkCssTokenizer *tokenizer)
   return value;
 }
 
-static char *
-gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer)
+/* Consumes a run of characters that contains no newlines and returns
+ * the number of bytes in it.
+ */
+static gsize
+gtk_css_tokenizer_consume_run (GtkCssTokenizer *tokenizer,
+                               const char      *end)
 {
+  const char *start = tokenizer->data;
+  const char *data;
+  gsize n_chars = 0;
+
+  for (data = start; data < end; data++)
+    {
+      /* count everything but UTF-8 continuation bytes */
+      if ((*data & 0xC0) != 0x80)
+        n_chars++;
+    }
+
+  gtk_css_tokenizer_consume (tokenizer, end - start, n_chars);
+
+  return end - start;
+}
+
+/* Names without escapes are returned as they are in the data, only
+ * names with escapes get built in the name buffer. Either way, the
+ * name is not nul-terminated and only valid until the next token is
+ * read.
+ */
+static const char *
+gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer,
+                             gsize           *len)
+{
+  const char *start = tokenizer->data;
+  const char *data;
+
+  for (data = start; data < tokenizer->end && is_name (*data); data++)
+    ;
+  gtk_css_tokenizer_consume_run (tokenizer, data);
+
+  if (tokenizer->data == tokenizer->end || *tokenizer->data != '\\')
+    {
+      *len = data - start;
+      return start;
+    }
+
   g_string_set_size (tokenizer->name_buffer, 0);
+  g_string_append_len (tokenizer->name_buffer, start, data - start);
 
   do {
       if (*tokenizer->data == '\\')
@@ -907,7 +989,8 @@ gtk_css_tokenizer_read_name (GtkCssTokenizer *tokenizer)
     }
   while (tokenizer->data != tokenizer->end);
 
-  return g_strndup (tokenizer->name_buffer->str, tokenizer->name_buffer->len);
+  *len = tokenizer->name_buffer->len;
+  return tokenizer->name_buffer->str;
 }
 
 static void
@@ -933,7 +1016,9 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
                             GtkCssToken      *token,
                             GError          **error)
 {
-  GString *url = g_string_new (NULL);
+  GString *url = tokenizer->name_buffer;
+
+  g_string_set_size (url, 0);
 
   while (tokenizer->data < tokenizer->end && is_whitespace (*tokenizer->data))
     gtk_css_tokenizer_consume_whitespace (tokenizer);
@@ -970,7 +1055,6 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
       else if (is_non_printable (*tokenizer->data))
         {
           gtk_css_tokenizer_read_bad_url (tokenizer, token);
-          g_string_free (url, TRUE);
           gtk_css_tokenizer_parse_error (error, "Nonprintable character 0x%02X in url", *tokenizer->data);
           return FALSE;
         }
@@ -980,7 +1064,6 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
         {
           gtk_css_tokenizer_read_bad_url (tokenizer, token);
           gtk_css_tokenizer_parse_error (error, "Invalid character %c in url", *tokenizer->data);
-          g_string_free (url, TRUE);
           return FALSE;
         }
       else if (gtk_css_tokenizer_has_valid_escape (tokenizer))
@@ -991,7 +1074,6 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
         {
           gtk_css_tokenizer_read_bad_url (tokenizer, token);
           gtk_css_tokenizer_parse_error (error, "Newline may not follow '\' escape character");
-          g_string_free (url, TRUE);
           return FALSE;
         }
       else
@@ -1000,7 +1082,7 @@ gtk_css_tokenizer_read_url (GtkCssTokenizer  *tokenizer,
         }
     }
 
-  gtk_css_token_init_string (token, GTK_CSS_TOKEN_URL, g_string_free (url, FALSE));
+  gtk_css_token_init_string (token, GTK_CSS_TOKEN_URL, url->str, url->len);
 
   return TRUE;
 }
@@ -1010,12 +1092,15 @@ gtk_css_tokenizer_read_ident_like (GtkCssTokenizer  *tokenizer,
                                    GtkCssToken      *token,
                                    GError          **error)
 {
-  char *name = gtk_css_tokenizer_read_name (tokenizer);
+  const char *name;
+  gsize len;
 
-  if (*tokenizer->data == '(')
+  name = gtk_css_tokenizer_read_name (tokenizer, &len);
+
+  if (tokenizer->data < tokenizer->end && *tokenizer->data == '(')
     {
       gtk_css_tokenizer_consume_ascii (tokenizer);
-      if (g_ascii_strcasecmp (name, "url") == 0)
+      if (len == 3 && g_ascii_strncasecmp (name, "url", 3) == 0)
         {
           const char *data = tokenizer->data;
 
@@ -1023,18 +1108,15 @@ gtk_css_tokenizer_read_ident_like (GtkCssTokenizer  *tokenizer,
             data++;
 
           if (*data != '"' && *data != '\'')
-            {
-              g_free (name);
-              return gtk_css_tokenizer_read_url (tokenizer, token, error);
-            }
+            return gtk_css_tokenizer_read_url (tokenizer, token, error);
         }
 
-      gtk_css_token_init_string (token, GTK_CSS_TOKEN_FUNCTION, name);
+      gtk_css_token_init_string (token, GTK_CSS_TOKEN_FUNCTION, name, len);
       return TRUE;
     }
   else
     {
-      gtk_css_token_init_string (token, GTK_CSS_TOKEN_IDENT, name);
+      gtk_css_token_init_string (token, GTK_CSS_TOKEN_IDENT, name, len);
       return TRUE;
     }
 }
@@ -1118,13 +1200,16 @@ gtk_css_tokenizer_read_numeric (GtkCssTokenizer *tokenizer,
   if (gtk_css_tokenizer_has_identifier (tokenizer))
     {
       GtkCssTokenType type;
+      const char *name;
+      gsize len;
 
       if (is_int)
         type = has_sign ? GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION : GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION;
       else
         type = GTK_CSS_TOKEN_DIMENSION;
 
-      gtk_css_token_init_dimension (token, type, value, gtk_css_tokenizer_read_name (tokenizer));
+      name = gtk_css_tokenizer_read_name (tokenizer, &len);
+      gtk_css_token_init_dimension (token, type, value, name, len);
     }
   else if (gtk_css_tokenizer_remaining (tokenizer) > 0 && *tokenizer->data == '%')
     {
@@ -1191,9 +1276,10 @@ gtk_css_tokenizer_read_string (GtkCssTokenizer  *tokenizer,
                                GtkCssToken      *token,
                                GError          **error)
 {
-  GString *string = g_string_new (NULL);
+  GString *string = tokenizer->name_buffer;
   char end = *tokenizer->data;
 
+  g_string_set_size (string, 0);
   gtk_css_tokenizer_consume_ascii (tokenizer);
 
   while (tokenizer->data < tokenizer->end)
@@ -1222,18 +1308,25 @@ gtk_css_tokenizer_read_string (GtkCssTokenizer  *tokenizer,
         }
       else if (is_newline (*tokenizer->data))
         {
-          g_string_free (string, TRUE);
           gtk_css_token_init (token, GTK_CSS_TOKEN_BAD_STRING);
           gtk_css_tokenizer_parse_error (error, "Newlines inside strings must be escaped");
           return FALSE;
         }
       else
         {
-          gtk_css_tokenizer_consume_char (tokenizer, string);
+          const char *start = tokenizer->data;
+          const char *data;
+
+          for (data = start;
+               data < tokenizer->end && *data != end && *data != '\\' && !is_newline (*data);
+               data++)
+            ;
+
+          g_string_append_len (string, start, gtk_css_tokenizer_consume_run (tokenizer, data));
         }
     }
 
-  gtk_css_token_init_string (token, GTK_CSS_TOKEN_STRING, g_string_free (string, FALSE));
+  gtk_css_token_init_string (token, GTK_CSS_TOKEN_STRING, string->str, string->len);
 
   return TRUE;
 }
@@ -1311,15 +1404,16 @@ gtk_css_tokenizer_read_token (GtkCssTokenizer  *tokenizer,
       if (is_name (*tokenizer->data) || gtk_css_tokenizer_has_valid_escape (tokenizer))
         {
           GtkCssTokenType type;
+          const char *name;
+          gsize len;
 
           if (gtk_css_tokenizer_has_identifier (tokenizer))
             type = GTK_CSS_TOKEN_HASH_ID;
           else
             type = GTK_CSS_TOKEN_HASH_UNRESTRICTED;
 
-          gtk_css_token_init_string (token,
-                                     type,
-                                     gtk_css_tokenizer_read_name (tokenizer));
+          name = gtk_css_tokenizer_read_name (tokenizer, &len);
+          gtk_css_token_init_string (token, type, name, len);
         }
       else
         {
@@ -1399,9 +1493,11 @@ gtk_css_tokenizer_read_token (GtkCssTokenizer  *tokenizer,
       gtk_css_tokenizer_consume_ascii (tokenizer);
       if (gtk_css_tokenizer_has_identifier (tokenizer))
         {
-          gtk_css_token_init_string (token,
-                                     GTK_CSS_TOKEN_AT_KEYWORD,
-                                     gtk_css_tokenizer_read_name (tokenizer));
+          const char *name;
+          gsize len;
+
+          name = gtk_css_tokenizer_read_name (tokenizer, &len);
+          gtk_css_token_init_string (token, GTK_CSS_TOKEN_AT_KEYWORD, name, len);
         }
       else
         {
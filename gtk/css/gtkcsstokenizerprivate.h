@@ -78,9 +78,16 @@ typedef struct _GtkCssDelimToken GtkCssDelimToken;
 typedef struct _GtkCssNumberToken GtkCssNumberToken;
 typedef struct _GtkCssDimensionToken GtkCssDimensionToken;
 
+/* Strings shorter than this are stored in the token itself */
+#define GTK_CSS_TOKEN_STRING_SIZE 16
+
 struct _GtkCssStringToken {
   GtkCssTokenType  type;
-  char            *string;
+  gsize            len;
+  union {
+    char           buf[GTK_CSS_TOKEN_STRING_SIZE];
+    char          *string;
+  } u;
 };
 
 struct _GtkCssDelimToken {
@@ -96,7 +103,11 @@ struct _GtkCssNumberToken {
 struct _GtkCssDimensionToken {
   GtkCssTokenType  type;
   double           value;
-  char            *dimension;
+  gsize            len;
+  union {
+    char           buf[GTK_CSS_TOKEN_STRING_SIZE];
+    char          *string;
+  } u;
 };
 
 union _GtkCssToken {
@@ -109,6 +120,9 @@ union _GtkCssToken {
 
 void                    gtk_css_token_clear                     (GtkCssToken            *token);
 
+const char *            gtk_css_token_get_string                (const GtkCssToken      *token) G_GNUC_PURE;
+const char *            gtk_css_token_get_dimension             (const GtkCssToken      *token) G_GNUC_PURE;
+
 gboolean                gtk_css_token_is_finite                 (const GtkCssToken      *token) G_GNUC_PURE;
 gboolean                gtk_css_token_is_preserved              (const GtkCssToken      *token,
                                                                  GtkCssTokenType        *out_closing) G_GNUC_PURE;
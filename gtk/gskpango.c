@@ -29,6 +29,7 @@
 #include "gtkcsscolorvalueprivate.h"
 
 #include <math.h>
+#include <string.h>
 
 #include <pango/pango.h>
 #include <cairo.h>
@@ -87,6 +88,29 @@ set_color (GskPangoRenderer *crenderer,
   gdk_cairo_set_source_rgba (cr, &rgba);
 }
 
+static void
+flush_glyphs (GskPangoRenderer *crenderer)
+{
+  if (crenderer->pending_font == NULL)
+    return;
+
+  gtk_snapshot_append_text (crenderer->snapshot,
+                            crenderer->pending_font,
+                            crenderer->pending_glyphs,
+                            &crenderer->pending_color,
+                            (float) crenderer->pending_x / PANGO_SCALE,
+                            (float) crenderer->pending_y / PANGO_SCALE);
+
+  g_clear_object (&crenderer->pending_font);
+  pango_glyph_string_set_size (crenderer->pending_glyphs, 0);
+}
+
+/* Runs that only differ in attributes that don't change the font
+ * or the color, for instance the background of a text tag, get
+ * merged into one text node when they follow each other on the
+ * same baseline. Anything else that gets drawn flushes the glyphs,
+ * to keep the order of the nodes.
+ */
 static void
 gsk_pango_renderer_draw_glyph_item (PangoRenderer  *renderer,
                                     const char     *text,
@@ -95,16 +119,36 @@ gsk_pango_renderer_draw_glyph_item (PangoRenderer  *renderer,
                                     int             y)
 {
   GskPangoRenderer *crenderer = (GskPangoRenderer *) (renderer);
+  PangoFont *font = glyph_item->item->analysis.font;
+  PangoGlyphString *glyphs = glyph_item->glyphs;
   GdkRGBA color;
+  int n_pending;
 
   get_color (crenderer, PANGO_RENDER_PART_FOREGROUND, &color);
 
-  gtk_snapshot_append_text (crenderer->snapshot,
-                            glyph_item->item->analysis.font,
-                            glyph_item->glyphs,
-                            &color,
-                            (float) x / PANGO_SCALE,
-                            (float) y / PANGO_SCALE);
+  if (crenderer->pending_font != font ||
+      crenderer->pending_y != y ||
+      crenderer->pending_end_x != x ||
+      !gdk_rgba_equal (&crenderer->pending_color, &color))
+    {
+      flush_glyphs (crenderer);
+
+      if (crenderer->pending_glyphs == NULL)
+        crenderer->pending_glyphs = pango_glyph_string_new ();
+
+      crenderer->pending_font = g_object_ref (font);
+      crenderer->pending_color = color;
+      crenderer->pending_x = x;
+      crenderer->pending_y = y;
+    }
+
+  n_pending = crenderer->pending_glyphs->num_glyphs;
+  pango_glyph_string_set_size (crenderer->pending_glyphs, n_pending + glyphs->num_glyphs);
+  memcpy (crenderer->pending_glyphs->glyphs + n_pending,
+          glyphs->glyphs,
+          glyphs->num_glyphs * sizeof (PangoGlyphInfo));
+
+  crenderer->pending_end_x = x + pango_glyph_string_get_width (glyphs);
 }
 
 static void
@@ -118,6 +162,8 @@ gsk_pango_renderer_draw_rectangle (PangoRenderer     *renderer,
   GskPangoRenderer *crenderer = (GskPangoRenderer *) (renderer);
   GdkRGBA rgba;
 
+  flush_glyphs (crenderer);
+
   get_color (crenderer, part, &rgba);
   gtk_snapshot_append_color (crenderer->snapshot,
                              &rgba,
@@ -143,6 +189,8 @@ gsk_pango_renderer_draw_trapezoid (PangoRenderer   *renderer,
   cairo_t *cr;
   double x, y;
 
+  flush_glyphs (crenderer);
+
   layout = pango_renderer_get_layout (renderer);
   if (!layout)
     return;
@@ -185,6 +233,8 @@ gsk_pango_renderer_draw_error_underline (PangoRenderer *renderer,
 
   GskPangoRenderer *crenderer = (GskPangoRenderer *) (renderer);
 
+  flush_glyphs (crenderer);
+
   xx = (double)x / PANGO_SCALE;
   yy = (double)y / PANGO_SCALE;
   ww = (double)width / PANGO_SCALE;
@@ -249,6 +299,8 @@ gsk_pango_renderer_draw_shape (PangoRenderer  *renderer,
   double base_y = (double)y / PANGO_SCALE;
   gboolean handled = FALSE;
 
+  flush_glyphs (crenderer);
+
   if (crenderer->shape_handler)
     {
       double shape_x = base_x;
@@ -411,6 +463,26 @@ gsk_pango_renderer_prepare_run (PangoRenderer  *renderer,
     text_renderer_set_rgba (crenderer, PANGO_RENDER_PART_UNDERLINE, fg_rgba);
 }
 
+static void
+gsk_pango_renderer_end (PangoRenderer *renderer)
+{
+  flush_glyphs (GSK_PANGO_RENDERER (renderer));
+
+  if (PANGO_RENDERER_CLASS (gsk_pango_renderer_parent_class)->end)
+    PANGO_RENDERER_CLASS (gsk_pango_renderer_parent_class)->end (renderer);
+}
+
+static void
+gsk_pango_renderer_finalize (GObject *object)
+{
+  GskPangoRenderer *crenderer = GSK_PANGO_RENDERER (object);
+
+  g_clear_object (&crenderer->pending_font);
+  g_clear_pointer (&crenderer->pending_glyphs, pango_glyph_string_free);
+
+  G_OBJECT_CLASS (gsk_pango_renderer_parent_class)->finalize (object);
+}
+
 static void
 gsk_pango_renderer_init (GskPangoRenderer *renderer G_GNUC_UNUSED)
 {
@@ -419,14 +491,18 @@ gsk_pango_renderer_init (GskPangoRenderer *renderer G_GNUC_UNUSED)
 static void
 gsk_pango_renderer_class_init (GskPangoRendererClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   PangoRendererClass *renderer_class = PANGO_RENDERER_CLASS (klass);
 
+  object_class->finalize = gsk_pango_renderer_finalize;
+
   renderer_class->draw_glyph_item = gsk_pango_renderer_draw_glyph_item;
   renderer_class->draw_rectangle = gsk_pango_renderer_draw_rectangle;
   renderer_class->draw_trapezoid = gsk_pango_renderer_draw_trapezoid;
   renderer_class->draw_error_underline = gsk_pango_renderer_draw_error_underline;
   renderer_class->draw_shape = gsk_pango_renderer_draw_shape;
   renderer_class->prepare_run = gsk_pango_renderer_prepare_run;
+  renderer_class->end = gsk_pango_renderer_end;
 }
 
 static GskPangoRenderer *cached_renderer = NULL; /* MT-safe */
@@ -68,6 +68,15 @@ struct _GskPangoRenderer
   guint                  is_cached_renderer : 1;
 
   GskPangoShapeHandler   shape_handler;
+
+  /* Glyphs of consecutive runs with the same font and color,
+   * which go into a single text node */
+  PangoGlyphString      *pending_glyphs;
+  PangoFont             *pending_font;
+  GdkRGBA                pending_color;
+  int                    pending_x;
+  int                    pending_y;
+  int                    pending_end_x;
 };
 
 struct _GskPangoRendererClass
@@ -158,6 +158,7 @@
 #include <gtk/gtklabel.h>
 #include <gtk/gtklayoutmanager.h>
 #include <gtk/gtklayoutchild.h>
+#include <gtk/gtklazybin.h>
 #include <gtk/gtklevelbar.h>
 #include <gtk/gtklistbase.h>
 #include <gtk/gtklinkbutton.h>
@@ -233,6 +234,7 @@
 #include <gtk/gtksnapshot.h>
 #include <gtk/gtksorter.h>
 #include <gtk/gtksortlistmodel.h>
+#include <gtk/gtkstreamlistmodel.h>
 #include <gtk/gtkstacksidebar.h>
 #include <gtk/gtksizegroup.h>
 #include <gtk/gtksizerequest.h>
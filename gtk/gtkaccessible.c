@@ -93,6 +93,34 @@ gtk_accessible_get_at_context (GtkAccessible *self)
   return GTK_ACCESSIBLE_GET_IFACE (self)->get_at_context (self);
 }
 
+/*< private >
+ * gtk_accessible_peek_at_context:
+ * @self: a #GtkAccessible
+ *
+ * Retrieves the #GtkATContext for the given #GtkAccessible,
+ * if it has been created already.
+ *
+ * Accessibles create their context the first time it is asked
+ * for. Notifications that only matter to an AT that already
+ * knows the accessible should use this function, so they don't
+ * create contexts that nobody is going to look at.
+ *
+ * Returns: (transfer none) (nullable): the #GtkATContext
+ */
+GtkATContext *
+gtk_accessible_peek_at_context (GtkAccessible *self)
+{
+  GtkAccessibleInterface *iface;
+
+  g_return_val_if_fail (GTK_IS_ACCESSIBLE (self), NULL);
+
+  iface = GTK_ACCESSIBLE_GET_IFACE (self);
+  if (iface->peek_at_context == NULL)
+    return iface->get_at_context (self);
+
+  return iface->peek_at_context (self);
+}
+
 /**
  * gtk_accessible_get_accessible_role:
  * @self: a #GtkAccessible
@@ -108,7 +136,7 @@ gtk_accessible_get_accessible_role (GtkAccessible *self)
 
   g_return_val_if_fail (GTK_IS_ACCESSIBLE (self), GTK_ACCESSIBLE_ROLE_NONE);
 
-  GtkATContext *context = gtk_accessible_get_at_context (self);
+  GtkATContext *context = gtk_accessible_peek_at_context (self);
   if (context != NULL && gtk_at_context_is_realized (context))
     return gtk_at_context_get_accessible_role (context);
 
@@ -680,11 +708,11 @@ gtk_accessible_platform_changed (GtkAccessible               *self,
       gtk_widget_get_root (GTK_WIDGET (self)) == NULL)
     return;
 
-  context = gtk_accessible_get_at_context (self);
+  context = gtk_accessible_peek_at_context (self);
 
   /* propagate changes up from ignored widgets */
   if (gtk_accessible_get_accessible_role (self) == GTK_ACCESSIBLE_ROLE_NONE)
-    context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (gtk_widget_get_parent (GTK_WIDGET (self))));
+    context = gtk_accessible_peek_at_context (GTK_ACCESSIBLE (gtk_widget_get_parent (GTK_WIDGET (self))));
 
   if (context == NULL)
     return;
@@ -735,7 +763,7 @@ gtk_accessible_bounds_changed (GtkAccessible *self)
       gtk_widget_get_root (GTK_WIDGET (self)) == NULL)
     return;
 
-  context = gtk_accessible_get_at_context (self);
+  context = gtk_accessible_peek_at_context (self);
   if (context == NULL)
     return;
 
@@ -770,9 +798,10 @@ gtk_accessible_should_present (GtkAccessible *self)
       role == GTK_ACCESSIBLE_ROLE_PRESENTATION)
     return FALSE;
 
-  context = gtk_accessible_get_at_context (self);
+  /* Without a context, the accessible can't have been hidden */
+  context = gtk_accessible_peek_at_context (self);
   if (context == NULL)
-    return FALSE;
+    return TRUE;
 
   if (gtk_at_context_has_accessible_state (context, GTK_ACCESSIBLE_STATE_HIDDEN))
     {
@@ -797,11 +826,11 @@ gtk_accessible_update_children (GtkAccessible           *self,
       gtk_widget_get_root (GTK_WIDGET (self)) == NULL)
     return;
 
-  context = gtk_accessible_get_at_context (self);
+  context = gtk_accessible_peek_at_context (self);
 
   /* propagate changes up from ignored widgets */
   if (gtk_accessible_get_accessible_role (self) == GTK_ACCESSIBLE_ROLE_NONE)
-    context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (gtk_widget_get_parent (GTK_WIDGET (self))));
+    context = gtk_accessible_peek_at_context (GTK_ACCESSIBLE (gtk_widget_get_parent (GTK_WIDGET (self))));
 
   if (context == NULL)
     return;
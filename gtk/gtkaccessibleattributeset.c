@@ -33,7 +33,12 @@ struct _GtkAccessibleAttributeSet
 
   GtkBitmask *attributes_set;
 
-  char **attribute_names;
+  /* Not copied, the names must be static */
+  const char **attribute_names;
+
+  /* Values are only stored once they get set or looked up,
+   * as most attributes are never touched for most accessibles
+   */
   GtkAccessibleValue **attribute_values;
 };
 
@@ -45,17 +50,10 @@ gtk_accessible_attribute_set_init (GtkAccessibleAttributeSet          *self,
 {
   self->n_attributes = n_attributes;
   self->default_func = default_func;
-  self->attribute_names = g_new (char *, n_attributes);
-  self->attribute_values = g_new (GtkAccessibleValue *, n_attributes);
+  self->attribute_names = attribute_names;
+  self->attribute_values = g_new0 (GtkAccessibleValue *, n_attributes);
   self->attributes_set = _gtk_bitmask_new ();
 
-  /* Initialize all attribute values, so we can always get the full attribute */
-  for (int i = 0; i < self->n_attributes; i++)
-    {
-      self->attribute_names[i] = g_strdup (attribute_names[i]);
-      self->attribute_values[i] = (* self->default_func) (i);
-    }
-
   return self;
 }
 
@@ -84,13 +82,10 @@ gtk_accessible_attribute_set_free (gpointer data)
 
   for (int i = 0; i < self->n_attributes; i++)
     {
-      g_free (self->attribute_names[i]);
-
       if (self->attribute_values[i] != NULL)
         gtk_accessible_value_unref (self->attribute_values[i]);
     }
 
-  g_free (self->attribute_names);
   g_free (self->attribute_values);
 
   _gtk_bitmask_free (self->attributes_set);
@@ -126,7 +121,7 @@ gtk_accessible_attribute_set_add (GtkAccessibleAttributeSet *self,
 
   if (value != NULL)
     {
-      if (gtk_accessible_value_equal (value, self->attribute_values[attribute]))
+      if (gtk_accessible_value_equal (value, gtk_accessible_attribute_set_get_value (self, attribute)))
         return FALSE;
     }
   else
@@ -139,8 +134,6 @@ gtk_accessible_attribute_set_add (GtkAccessibleAttributeSet *self,
 
   if (value != NULL)
     self->attribute_values[attribute] = gtk_accessible_value_ref (value);
-  else
-    self->attribute_values[attribute] = (* self->default_func) (attribute);
 
   self->attributes_set = _gtk_bitmask_set (self->attributes_set, attribute, TRUE);
 
@@ -167,7 +160,6 @@ gtk_accessible_attribute_set_remove (GtkAccessibleAttributeSet *self,
 
   g_clear_pointer (&(self->attribute_values[attribute]), gtk_accessible_value_unref);
 
-  self->attribute_values[attribute] = (* self->default_func) (attribute);
   self->attributes_set = _gtk_bitmask_set (self->attributes_set, attribute, FALSE);
 
   return TRUE;
@@ -197,6 +189,9 @@ gtk_accessible_attribute_set_get_value (GtkAccessibleAttributeSet *self,
 {
   g_return_val_if_fail (attribute >= 0 && attribute < self->n_attributes, NULL);
 
+  if (self->attribute_values[attribute] == NULL)
+    self->attribute_values[attribute] = (* self->default_func) (attribute);
+
   return self->attribute_values[attribute];
 }
 
@@ -250,7 +245,7 @@ gtk_accessible_attribute_set_print (GtkAccessibleAttributeSet *self,
       g_string_append (buffer, self->attribute_names[i]);
       g_string_append (buffer, ": ");
 
-      gtk_accessible_value_print (self->attribute_values[i], buffer);
+      gtk_accessible_value_print (gtk_accessible_attribute_set_get_value (self, i), buffer);
 
       g_string_append (buffer, ",\n");
     }
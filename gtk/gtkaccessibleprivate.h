@@ -30,12 +30,14 @@ struct _GtkAccessibleInterface
   GTypeInterface g_iface;
 
   GtkATContext *        (* get_at_context)      (GtkAccessible *self);
+  GtkATContext *        (* peek_at_context)     (GtkAccessible *self);
 
   gboolean              (* get_platform_state)  (GtkAccessible              *self,
                                                  GtkAccessiblePlatformState  state);
 };
 
 GtkATContext *  gtk_accessible_get_at_context   (GtkAccessible *self);
+GtkATContext *  gtk_accessible_peek_at_context  (GtkAccessible *self);
 
 const char *    gtk_accessible_role_to_name     (GtkAccessibleRole  role,
                                                  const char        *domain);
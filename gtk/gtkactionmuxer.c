@@ -161,6 +161,12 @@ struct _GtkActionMuxer
   GtkAccels primary_accels;
 
   GtkBitmask *widget_actions_disabled;
+
+  /* Maps full action names to the muxer in our parent chain
+   * that provides them, see gtk_action_muxer_resolve().
+   */
+  GHashTable *resolved;
+  guint resolved_serial;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GtkActionMuxer, gtk_action_muxer, G_TYPE_OBJECT,
@@ -192,6 +198,20 @@ typedef struct
   gulong        handler_ids[4];
 } Group;
 
+/* Bumped whenever the set of actions reachable from any muxer may
+ * have changed, which invalidates all resolution caches at once.
+ * Muxers are only used from the main thread.
+ */
+static guint resolution_serial = 1;
+
+#define MAX_RESOLVED_ACTIONS 256
+
+static inline void
+invalidate_resolution (void)
+{
+  resolution_serial++;
+}
+
 static inline guint
 get_action_position (GtkWidgetAction *action)
 {
@@ -273,6 +293,7 @@ gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
                              const char     **action_name)
 {
   const char *dot;
+  char buf[64];
   char *prefix;
   const char *name;
   Group *group;
@@ -287,9 +308,20 @@ gtk_action_muxer_find_group (GtkActionMuxer  *muxer,
 
   name = dot + 1;
 
-  prefix = g_strndup (full_name, dot - full_name);
+  /* Prefixes are short, avoid an allocation for every lookup */
+  if ((gsize) (dot - full_name) < sizeof (buf))
+    {
+      memcpy (buf, full_name, dot - full_name);
+      buf[dot - full_name] = '\0';
+      prefix = buf;
+    }
+  else
+    prefix = g_strndup (full_name, dot - full_name);
+
   group = g_hash_table_lookup (muxer->groups, prefix);
-  g_free (prefix);
+
+  if (prefix != buf)
+    g_free (prefix);
 
   if (action_name)
     *action_name = name;
@@ -328,6 +360,62 @@ gtk_action_muxer_get_group (GtkActionMuxer *muxer,
   return NULL;
 }
 
+static gboolean
+gtk_action_muxer_has_local_action (GtkActionMuxer *muxer,
+                                   const char     *action_name)
+{
+  if (muxer->widget)
+    {
+      GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
+      GtkWidgetClassPrivate *priv = klass->priv;
+      GtkWidgetAction *action;
+
+      for (action = priv->actions; action; action = action->next)
+        {
+          if (strcmp (action->name, action_name) == 0)
+            return TRUE;
+        }
+    }
+
+  return gtk_action_muxer_find_group (muxer, action_name, NULL) != NULL;
+}
+
+/* Returns the muxer in the chain starting at @muxer that
+ * provides @action_name, or %NULL if there is none.
+ *
+ * The answer is cached per muxer, since actionables repeatedly
+ * look up the same names, and every lookup otherwise walks all
+ * the way up the widget hierarchy.
+ */
+static GtkActionMuxer *
+gtk_action_muxer_resolve (GtkActionMuxer *muxer,
+                          const char     *action_name)
+{
+  GtkActionMuxer *owner;
+  gpointer value;
+
+  if (muxer->resolved == NULL)
+    muxer->resolved = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  else if (muxer->resolved_serial != resolution_serial ||
+           g_hash_table_size (muxer->resolved) >= MAX_RESOLVED_ACTIONS)
+    g_hash_table_remove_all (muxer->resolved);
+
+  muxer->resolved_serial = resolution_serial;
+
+  if (g_hash_table_lookup_extended (muxer->resolved, action_name, NULL, &value))
+    return value;
+
+  for (owner = muxer; owner; owner = owner->parent)
+    {
+      if (gtk_action_muxer_has_local_action (owner, action_name))
+        break;
+    }
+
+  g_hash_table_insert (muxer->resolved, g_strdup (action_name), owner);
+
+  return owner;
+}
+
 static inline Action *
 find_observers (GtkActionMuxer *muxer,
                 const char     *action_name)
@@ -524,6 +612,8 @@ gtk_action_muxer_action_added_to_group (GActionGroup *action_group,
   GVariant *state;
   char *fullname;
 
+  invalidate_resolution ();
+
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
 
    if (muxer->parent)
@@ -568,6 +658,8 @@ gtk_action_muxer_action_removed_from_group (GActionGroup *action_group,
   char *fullname;
   Action *action;
 
+  invalidate_resolution ();
+
   fullname = g_strconcat (group->prefix, ".", action_name, NULL);
   gtk_action_muxer_action_removed (muxer, fullname);
   g_free (fullname);
@@ -748,6 +840,13 @@ action_muxer_query_action (GtkActionMuxer      *muxer,
   Group *group;
   const char *unprefixed_name;
 
+  if (recurse)
+    {
+      muxer = gtk_action_muxer_resolve (muxer, action_name);
+      if (muxer == NULL)
+        return FALSE;
+    }
+
   if (muxer->widget)
     {
       GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
@@ -792,11 +891,6 @@ action_muxer_query_action (GtkActionMuxer      *muxer,
     return g_action_group_query_action (group->group, unprefixed_name, enabled,
                                         parameter_type, state_type, state_hint, state);
 
-  if (muxer->parent && recurse)
-    return gtk_action_muxer_query_action (muxer->parent, action_name,
-                                          enabled, parameter_type,
-                                          state_type, state_hint, state);
-
   return FALSE;
 }
 
@@ -832,6 +926,10 @@ gtk_action_muxer_activate_action (GtkActionMuxer *muxer,
   const char *unprefixed_name;
   Group *group;
 
+  muxer = gtk_action_muxer_resolve (muxer, action_name);
+  if (muxer == NULL)
+    return;
+
   if (muxer->widget)
     {
       GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
@@ -861,8 +959,6 @@ gtk_action_muxer_activate_action (GtkActionMuxer *muxer,
 
   if (group)
     g_action_group_activate_action (group->group, unprefixed_name, parameter);
-  else if (muxer->parent)
-    gtk_action_muxer_activate_action (muxer->parent, action_name, parameter);
 }
 
 void
@@ -874,6 +970,10 @@ gtk_action_muxer_change_action_state (GtkActionMuxer *muxer,
   const char *unprefixed_name;
   Group *group;
 
+  muxer = gtk_action_muxer_resolve (muxer, action_name);
+  if (muxer == NULL)
+    return;
+
   if (muxer->widget)
     {
       GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (muxer->widget);
@@ -895,8 +995,6 @@ gtk_action_muxer_change_action_state (GtkActionMuxer *muxer,
 
   if (group)
     g_action_group_change_action_state (group->group, unprefixed_name, state);
-  else if (muxer->parent)
-    gtk_action_muxer_change_action_state (muxer->parent, action_name, state);
 }
 
 static void
@@ -1046,6 +1144,8 @@ gtk_action_muxer_finalize (GObject *object)
     }
   if (muxer->groups)
     g_hash_table_unref (muxer->groups);
+  if (muxer->resolved)
+    g_hash_table_unref (muxer->resolved);
 
   gtk_accels_clear (&muxer->primary_accels);
 
@@ -1064,6 +1164,7 @@ gtk_action_muxer_dispose (GObject *object)
     g_hash_table_remove_all (muxer->observed_actions);
 
   muxer->widget = NULL;
+  invalidate_resolution ();
 
   G_OBJECT_CLASS (gtk_action_muxer_parent_class)->dispose (object);
 }
@@ -1245,9 +1346,7 @@ gtk_action_muxer_insert (GtkActionMuxer *muxer,
                          const char     *prefix,
                          GActionGroup   *action_group)
 {
-  char **actions;
   Group *group;
-  int i;
 
   /* TODO: diff instead of ripout and replace */
   gtk_action_muxer_remove (muxer, prefix);
@@ -1261,11 +1360,39 @@ gtk_action_muxer_insert (GtkActionMuxer *muxer,
   group->prefix = g_strdup (prefix);
 
   g_hash_table_insert (muxer->groups, group->prefix, group);
+  invalidate_resolution ();
+
+  /* Only observed actions need notifying, and there are usually
+   * far fewer of those than actions in the group, so walk them
+   * instead of listing the group's actions.
+   */
+  if (muxer->observed_actions && g_hash_table_size (muxer->observed_actions) > 0)
+    {
+      GHashTableIter iter;
+      const char *fullname;
+      gsize len = strlen (prefix);
+      GPtrArray *names;
+      guint i;
+
+      names = g_ptr_array_new_with_free_func (g_free);
+
+      g_hash_table_iter_init (&iter, muxer->observed_actions);
+      while (g_hash_table_iter_next (&iter, (gpointer *)&fullname, NULL))
+        {
+          if (strncmp (fullname, prefix, len) == 0 &&
+              fullname[len] == '.' &&
+              g_action_group_has_action (group->group, fullname + len + 1))
+            g_ptr_array_add (names, g_strdup (fullname + len + 1));
+        }
 
-  actions = g_action_group_list_actions (group->group);
-  for (i = 0; actions[i]; i++)
-    gtk_action_muxer_action_added_to_group (group->group, actions[i], group);
-  g_strfreev (actions);
+      /* Observers may register or unregister as we notify them,
+       * so don't do that while iterating the table.
+       */
+      for (i = 0; i < names->len; i++)
+        gtk_action_muxer_action_added_to_group (group->group, g_ptr_array_index (names, i), group);
+
+      g_ptr_array_unref (names);
+    }
 
   group->handler_ids[0] = g_signal_connect (group->group, "action-added",
                                             G_CALLBACK (gtk_action_muxer_action_added_to_group), group);
@@ -1304,6 +1431,7 @@ gtk_action_muxer_remove (GtkActionMuxer *muxer,
       int i;
 
       g_hash_table_steal (muxer->groups, prefix);
+      invalidate_resolution ();
 
       actions = g_action_group_list_actions (group->group);
       for (i = 0; actions[i]; i++)
@@ -1366,6 +1494,7 @@ gtk_action_muxer_set_parent (GtkActionMuxer *muxer,
     }
 
   muxer->parent = parent;
+  invalidate_resolution ();
 
   if (muxer->parent != NULL)
     {
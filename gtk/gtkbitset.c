@@ -635,6 +635,203 @@ gtk_bitset_difference (GtkBitset       *self,
   roaring_bitmap_xor_inplace (&self->roaring, &other->roaring);
 }
 
+/* Sets the bits of @container, moved up by @shift, in the 2 containers
+ * the values end up in: @low for values below 65536 and @high for the
+ * rest.
+ */
+static void
+container_or_shifted (const void *container,
+                      uint8_t     typecode,
+                      guint       shift,
+                      uint64_t   *low,
+                      uint64_t   *high)
+{
+  container = container_unwrap_shared (container, &typecode);
+
+  switch (typecode)
+    {
+    case BITSET_CONTAINER_TYPE_CODE:
+      {
+        const uint64_t *words = ((const bitset_container_t *) container)->array;
+        guint word_shift = shift / 64;
+        guint bit_shift = shift % 64;
+        guint i;
+
+        for (i = 0; i < BITSET_CONTAINER_SIZE_IN_WORDS; i++)
+          {
+            guint j = i + word_shift;
+            uint64_t *dest;
+
+            if (words[i] == 0)
+              continue;
+
+            dest = j < BITSET_CONTAINER_SIZE_IN_WORDS ? &low[j] : &high[j - BITSET_CONTAINER_SIZE_IN_WORDS];
+            *dest |= words[i] << bit_shift;
+
+            if (bit_shift == 0)
+              continue;
+
+            j++;
+            dest = j < BITSET_CONTAINER_SIZE_IN_WORDS ? &low[j] : &high[j - BITSET_CONTAINER_SIZE_IN_WORDS];
+            *dest |= words[i] >> (64 - bit_shift);
+          }
+      }
+      break;
+
+    case ARRAY_CONTAINER_TYPE_CODE:
+      {
+        const array_container_t *array = container;
+        int i;
+
+        for (i = 0; i < array->cardinality; i++)
+          {
+            guint value = array->array[i] + shift;
+
+            if (value < 65536)
+              low[value / 64] |= UINT64_C (1) << (value % 64);
+            else
+              high[(value - 65536) / 64] |= UINT64_C (1) << ((value - 65536) % 64);
+          }
+      }
+      break;
+
+    case RUN_CONTAINER_TYPE_CODE:
+      {
+        const run_container_t *run = container;
+        int i;
+
+        for (i = 0; i < run->n_runs; i++)
+          {
+            guint start = run->runs[i].value + shift;
+            guint last = start + run->runs[i].length;
+
+            if (start < 65536)
+              bitset_set_lenrange (low, start, MIN (last, 65535) - start);
+            if (last >= 65536)
+              {
+                start = MAX (start, 65536);
+                bitset_set_lenrange (high, start - 65536, last - start);
+              }
+          }
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* Appends @bitset to @ra as the container for @key, converting it
+ * to an array container if it is small enough. Returns %FALSE if
+ * @bitset was consumed and must be replaced.
+ */
+static gboolean
+ra_append_bitset (roaring_array_t    *ra,
+                  gint64              key,
+                  bitset_container_t *bitset)
+{
+  bitset->cardinality = bitset_container_compute_cardinality (bitset);
+
+  if (bitset->cardinality == 0)
+    return TRUE;
+
+  if (key < 0 || key > G_MAXUINT16)
+    {
+      bitset_container_clear (bitset);
+      return TRUE;
+    }
+
+  if (bitset->cardinality <= DEFAULT_MAX_SIZE)
+    {
+      ra_append (ra, key, array_container_from_bitset (bitset), ARRAY_CONTAINER_TYPE_CODE);
+      bitset_container_clear (bitset);
+      return TRUE;
+    }
+
+  ra_append (ra, key, bitset, BITSET_CONTAINER_TYPE_CODE);
+  return FALSE;
+}
+
+/* Adds @offset to all values in @self, dropping the values that end
+ * up outside the range of a guint.
+ *
+ * This works on whole containers: When @offset is a multiple of 65536,
+ * the containers are only moved to new keys. Otherwise every container
+ * is split in 2, and the halves are merged with those of the containers
+ * next to it.
+ */
+static void
+gtk_bitset_offset (GtkBitset *self,
+                   gint64     offset)
+{
+  roaring_array_t *ra = &self->roaring.high_low_container;
+  roaring_array_t result;
+  bitset_container_t *low, *high, *tmp;
+  gint64 key_offset, key;
+  guint shift;
+  int i;
+
+  key_offset = offset >= 0 ? offset / 65536 : -((-offset + 65535) / 65536);
+  shift = offset - key_offset * 65536;
+
+  ra_init (&result);
+  result.flags = ra->flags;
+
+  if (shift == 0)
+    {
+      for (i = 0; i < ra->size; i++)
+        {
+          key = ra->keys[i] + key_offset;
+
+          if (key >= 0 && key <= G_MAXUINT16)
+            ra_append (&result, key, ra->containers[i], ra->typecodes[i]);
+          else
+            container_free (ra->containers[i], ra->typecodes[i]);
+        }
+    }
+  else
+    {
+      low = bitset_container_create ();
+      high = bitset_container_create ();
+      key = G_MININT64;
+
+      for (i = 0; i < ra->size; i++)
+        {
+          gint64 new_key = ra->keys[i] + key_offset;
+
+          if (new_key == key + 1)
+            {
+              /* the high half of the previous container and the low half
+               * of this one share a key */
+              if (!ra_append_bitset (&result, key, low))
+                low = bitset_container_create ();
+              tmp = low;
+              low = high;
+              high = tmp;
+            }
+          else if (new_key != key)
+            {
+              if (!ra_append_bitset (&result, key, low))
+                low = bitset_container_create ();
+              if (!ra_append_bitset (&result, key + 1, high))
+                high = bitset_container_create ();
+            }
+          key = new_key;
+
+          container_or_shifted (ra->containers[i], ra->typecodes[i], shift, low->array, high->array);
+          container_free (ra->containers[i], ra->typecodes[i]);
+        }
+
+      if (ra_append_bitset (&result, key, low))
+        bitset_container_free (low);
+      if (ra_append_bitset (&result, key + 1, high))
+        bitset_container_free (high);
+    }
+
+  ra_clear_without_containers (ra);
+  *ra = result;
+}
+
 /**
  * gtk_bitset_shift_left:
  * @self: a $GtkBitset
@@ -647,27 +844,12 @@ void
 gtk_bitset_shift_left (GtkBitset *self,
                        guint      amount)
 {
-  GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
-
   g_return_if_fail (self != NULL);
 
   if (amount == 0)
     return;
 
-  original = gtk_bitset_copy (self);
-  gtk_bitset_remove_all (self);
-
-  for (loop = gtk_bitset_iter_init_at (&iter, original, amount, &value);
-       loop;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value - amount);
-    }
-
-  gtk_bitset_unref (original);
+  gtk_bitset_offset (self, - (gint64) amount);
 }
 
 /**
@@ -682,27 +864,12 @@ void
 gtk_bitset_shift_right (GtkBitset *self,
                         guint      amount)
 {
-  GtkBitset *original;
-  GtkBitsetIter iter;
-  guint value;
-  gboolean loop;
-
   g_return_if_fail (self != NULL);
 
   if (amount == 0)
     return;
 
-  original = gtk_bitset_copy (self);
-  gtk_bitset_remove_all (self);
-
-  for (loop = gtk_bitset_iter_init_first (&iter, original, &value);
-       loop && value <= G_MAXUINT - amount;
-       loop = gtk_bitset_iter_next (&iter, &value))
-    {
-      gtk_bitset_add (self, value + amount);
-    }
-
-  gtk_bitset_unref (original);
+  gtk_bitset_offset (self, amount);
 }
 
 /**
@@ -955,3 +1122,166 @@ gtk_bitset_iter_is_valid (const GtkBitsetIter *iter)
 
   return riter->has_value;
 }
+
+/* Returns the last value of the run of consecutive values that
+ * starts at the current value of @riter and ends in its container
+ */
+static guint
+roaring_iterator_get_run_end (const roaring_uint32_iterator_t *riter)
+{
+  switch (riter->typecode)
+    {
+    case BITSET_CONTAINER_TYPE_CODE:
+      {
+        const uint64_t *words = ((const bitset_container_t *) riter->container)->array;
+        guint i = riter->in_container_index / 64;
+        uint64_t word;
+
+        word = ~words[i] & (UINT64_MAX << (riter->in_container_index % 64));
+        while (word == 0 && ++i < BITSET_CONTAINER_SIZE_IN_WORDS)
+          word = ~words[i];
+
+        if (word == 0)
+          return riter->highbits | 0xFFFF;
+
+        return riter->highbits | (i * 64 + __builtin_ctzll (word) - 1);
+      }
+
+    case ARRAY_CONTAINER_TYPE_CODE:
+      {
+        const array_container_t *array = riter->container;
+        int i = riter->in_container_index;
+
+        while (i + 1 < array->cardinality && array->array[i + 1] == array->array[i] + 1)
+          i++;
+
+        return riter->highbits | array->array[i];
+      }
+
+    case RUN_CONTAINER_TYPE_CODE:
+      {
+        const run_container_t *run = riter->container;
+        const rle16_t *rle = &run->runs[riter->run_index];
+
+        return riter->highbits | (rle->value + rle->length);
+      }
+
+    default:
+      g_assert_not_reached ();
+      return riter->current_value;
+    }
+}
+
+/**
+ * gtk_bitset_iter_next_range:
+ * @iter: a pointer to a #GtkBitsetIter
+ * @first: (out) (optional): Set to the first value of the range
+ * @last: (out) (optional): Set to the last value of the range
+ *
+ * Gets the range of consecutive values in the set that starts at the
+ * current value of @iter, and moves @iter to the first value after that
+ * range. If @iter is not valid, %FALSE is returned and @first and @last
+ * are set to 0.
+ *
+ * This allows going over all ranges of a set with a loop like:
+ * |[<!-- language="C" -->
+ *   guint first, last;
+ *
+ *   gtk_bitset_iter_init_first (&iter, set, NULL);
+ *   while (gtk_bitset_iter_next_range (&iter, &first, &last))
+ *     do_something_with_range (first, last);
+ * ]|
+ *
+ * The work done for a range does not depend on the number of
+ * values in it.
+ *
+ * Returns: %TRUE if @iter pointed to a value
+ *
+ * Since: 4.2
+ **/
+gboolean
+gtk_bitset_iter_next_range (GtkBitsetIter *iter,
+                            guint         *first,
+                            guint         *last)
+{
+  roaring_uint32_iterator_t *riter = (roaring_uint32_iterator_t *) iter;
+  guint start, end;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  if (!riter->has_value)
+    {
+      if (first)
+        *first = 0;
+      if (last)
+        *last = 0;
+      return FALSE;
+    }
+
+  start = riter->current_value;
+
+  while (TRUE)
+    {
+      end = roaring_iterator_get_run_end (riter);
+
+      if (end == G_MAXUINT)
+        {
+          /* Nothing can come after the last value */
+          riter->container_index = riter->parent->high_low_container.size;
+          riter->current_value = UINT32_MAX;
+          riter->has_value = FALSE;
+          break;
+        }
+
+      /* Continue in the next container if the range goes on there,
+       * or stop at the first value after the range.
+       */
+      if (!roaring_move_uint32_iterator_equalorlarger (riter, end + 1) ||
+          riter->current_value != end + 1)
+        break;
+    }
+
+  if (first)
+    *first = start;
+  if (last)
+    *last = end;
+
+  return TRUE;
+}
+
+G_STATIC_ASSERT (sizeof (guint) == sizeof (uint32_t));
+
+/**
+ * gtk_bitset_iter_read:
+ * @iter: a pointer to a #GtkBitsetIter
+ * @values: (out caller-allocates) (array length=n_values): array
+ *   to store the values in
+ * @n_values: the maximum number of values to store
+ *
+ * Stores the value @iter points to and the values following it in
+ * @values, until @n_values values have been stored or the end of the
+ * set is reached. @iter is moved to the first value that was not
+ * stored.
+ *
+ * This is a faster way to get many values than calling
+ * gtk_bitset_iter_next() for each of them.
+ *
+ * Returns: the number of values stored in @values
+ *
+ * Since: 4.2
+ **/
+guint
+gtk_bitset_iter_read (GtkBitsetIter *iter,
+                      guint         *values,
+                      guint          n_values)
+{
+  roaring_uint32_iterator_t *riter = (roaring_uint32_iterator_t *) iter;
+
+  g_return_val_if_fail (iter != NULL, 0);
+  g_return_val_if_fail (values != NULL || n_values == 0, 0);
+
+  if (!riter->has_value || n_values == 0)
+    return 0;
+
+  return roaring_read_uint32_iterator (riter, values, n_values);
+}
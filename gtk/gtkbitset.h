@@ -170,6 +170,14 @@ GDK_AVAILABLE_IN_ALL
 guint                   gtk_bitset_iter_get_value               (const GtkBitsetIter    *iter);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_bitset_iter_is_valid                (const GtkBitsetIter    *iter);
+GDK_AVAILABLE_IN_4_2
+gboolean                gtk_bitset_iter_next_range              (GtkBitsetIter          *iter,
+                                                                 guint                  *first,
+                                                                 guint                  *last);
+GDK_AVAILABLE_IN_4_2
+guint                   gtk_bitset_iter_read                    (GtkBitsetIter          *iter,
+                                                                 guint                  *values,
+                                                                 guint                   n_values);
        
 
 
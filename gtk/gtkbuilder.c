@@ -523,6 +523,125 @@ object_properties_get_value (const ObjectProperties *self,
   return &g_array_index (self->values, GValue, idx);
 }
 
+/* Templates, and especially the row templates of list widgets, get
+ * instantiated many times with the same property values. Converting
+ * them from strings can take a noticeable amount of time for enums and
+ * flags, so we keep the converted values of types that don't depend on
+ * the builder around, keyed by the pspec and the string.
+ */
+#define MAX_CACHED_VALUES 4096
+
+typedef struct {
+  GParamSpec *pspec;
+  char *string;
+  GValue value;
+} CachedValue;
+
+G_LOCK_DEFINE_STATIC (value_cache);
+static GHashTable *value_cache;
+
+static guint
+cached_value_hash (gconstpointer v)
+{
+  const CachedValue *cached = v;
+
+  return g_direct_hash (cached->pspec) ^ g_str_hash (cached->string);
+}
+
+static gboolean
+cached_value_equal (gconstpointer v1,
+                    gconstpointer v2)
+{
+  const CachedValue *cached1 = v1;
+  const CachedValue *cached2 = v2;
+
+  return cached1->pspec == cached2->pspec &&
+         strcmp (cached1->string, cached2->string) == 0;
+}
+
+static gboolean
+pspec_is_cacheable (GParamSpec *pspec)
+{
+  if (G_IS_PARAM_SPEC_UNICHAR (pspec) ||
+      G_IS_PARAM_SPEC_VARIANT (pspec))
+    return FALSE;
+
+  switch (G_TYPE_FUNDAMENTAL (G_PARAM_SPEC_VALUE_TYPE (pspec)))
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+gtk_builder_cached_value_from_string (GtkBuilder   *builder,
+                                      GParamSpec   *pspec,
+                                      const char   *string,
+                                      GValue       *value,
+                                      GError      **error)
+{
+  CachedValue key, *cached;
+
+  if (!pspec_is_cacheable (pspec))
+    return gtk_builder_value_from_string (builder, pspec, string, value, error);
+
+  key.pspec = pspec;
+  key.string = (char *) string;
+
+  G_LOCK (value_cache);
+
+  if (value_cache == NULL)
+    value_cache = g_hash_table_new (cached_value_hash, cached_value_equal);
+
+  cached = g_hash_table_lookup (value_cache, &key);
+  if (cached)
+    {
+      g_value_init (value, G_VALUE_TYPE (&cached->value));
+      g_value_copy (&cached->value, value);
+      G_UNLOCK (value_cache);
+      return TRUE;
+    }
+
+  G_UNLOCK (value_cache);
+
+  if (!gtk_builder_value_from_string (builder, pspec, string, value, error))
+    return FALSE;
+
+  G_LOCK (value_cache);
+
+  if (g_hash_table_size (value_cache) < MAX_CACHED_VALUES &&
+      !g_hash_table_contains (value_cache, &key))
+    {
+      /* Cached values are never freed, and pspecs don't go away
+       * as long as their class exists, which is forever */
+      cached = g_new0 (CachedValue, 1);
+      cached->pspec = pspec;
+      cached->string = g_strdup (string);
+      g_value_init (&cached->value, G_VALUE_TYPE (value));
+      g_value_copy (value, &cached->value);
+      g_hash_table_add (value_cache, cached);
+    }
+
+  G_UNLOCK (value_cache);
+
+  return TRUE;
+}
+
 static void
 gtk_builder_get_parameters (GtkBuilder         *builder,
                             GType               object_type,
@@ -598,10 +717,10 @@ gtk_builder_get_parameters (GtkBuilder         *builder,
               continue;
             }
         }
-      else if (!gtk_builder_value_from_string (builder, prop->pspec,
-                                               prop->text->str,
-                                               &property_value,
-                                               &error))
+      else if (!gtk_builder_cached_value_from_string (builder, prop->pspec,
+                                                      prop->text->str,
+                                                      &property_value,
+                                                      &error))
         {
           g_warning ("Failed to set property %s.%s to %s: %s",
                      g_type_name (object_type), prop->pspec->name, prop->text->str,
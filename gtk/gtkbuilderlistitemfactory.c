@@ -76,6 +76,7 @@ enum {
   PROP_BYTES,
   PROP_RESOURCE,
   PROP_SCOPE,
+  PROP_DEFERRED_BIND,
 
   N_PROPS
 };
@@ -141,6 +142,10 @@ gtk_builder_list_item_factory_get_property (GObject    *object,
       g_value_set_object (value, self->scope);
       break;
 
+    case PROP_DEFERRED_BIND:
+      g_value_set_boolean (value, gtk_builder_list_item_factory_get_deferred_bind (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -228,6 +233,10 @@ gtk_builder_list_item_factory_set_property (GObject      *object,
       self->scope = g_value_dup_object (value);
       break;
 
+    case PROP_DEFERRED_BIND:
+      gtk_builder_list_item_factory_set_deferred_bind (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -295,6 +304,23 @@ gtk_builder_list_item_factory_class_init (GtkBuilderListItemFactoryClass *klass)
                          GTK_TYPE_BUILDER_SCOPE,
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkBuilderListItemFactory:deferred-bind:
+   *
+   * Whether binding listitems may be postponed while the list is
+   * scrolled quickly.
+   *
+   * This is useful if the bindings in the UI definition are expensive.
+   *
+   * Since: 4.2
+   */
+  properties[PROP_DEFERRED_BIND] =
+    g_param_spec_boolean ("deferred-bind",
+                          P_("Deferred bind"),
+                          P_("Postpone binding while scrolling fast"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 }
 
@@ -399,3 +425,47 @@ gtk_builder_list_item_factory_get_scope (GtkBuilderListItemFactory *self)
   return self->scope;
 }
 
+/**
+ * gtk_builder_list_item_factory_set_deferred_bind:
+ * @self: a #GtkBuilderListItemFactory
+ * @deferred_bind: %TRUE to allow postponing binds
+ *
+ * Sets whether list widgets may postpone binding listitems while
+ * they are scrolled quickly. Until they are bound, listitems are
+ * shown without an item.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_builder_list_item_factory_set_deferred_bind (GtkBuilderListItemFactory *self,
+                                                 gboolean                   deferred_bind)
+{
+  GtkListItemFactory *factory = GTK_LIST_ITEM_FACTORY (self);
+
+  g_return_if_fail (GTK_IS_BUILDER_LIST_ITEM_FACTORY (self));
+
+  if (factory->deferred_bind == !!deferred_bind)
+    return;
+
+  factory->deferred_bind = !!deferred_bind;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFERRED_BIND]);
+}
+
+/**
+ * gtk_builder_list_item_factory_get_deferred_bind:
+ * @self: a #GtkBuilderListItemFactory
+ *
+ * Returns whether binds may be postponed while scrolling.
+ *
+ * Returns: %TRUE if binds may be postponed
+ *
+ * Since: 4.2
+ **/
+gboolean
+gtk_builder_list_item_factory_get_deferred_bind (GtkBuilderListItemFactory *self)
+{
+  g_return_val_if_fail (GTK_IS_BUILDER_LIST_ITEM_FACTORY (self), FALSE);
+
+  return GTK_LIST_ITEM_FACTORY (self)->deferred_bind;
+}
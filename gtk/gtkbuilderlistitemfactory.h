@@ -55,6 +55,12 @@ const char *            gtk_builder_list_item_factory_get_resource      (GtkBuil
 GDK_AVAILABLE_IN_ALL
 GtkBuilderScope *       gtk_builder_list_item_factory_get_scope         (GtkBuilderListItemFactory      *self) G_GNUC_PURE;
 
+GDK_AVAILABLE_IN_4_2
+void                    gtk_builder_list_item_factory_set_deferred_bind (GtkBuilderListItemFactory      *self,
+                                                                         gboolean                        deferred_bind);
+GDK_AVAILABLE_IN_4_2
+gboolean                gtk_builder_list_item_factory_get_deferred_bind (GtkBuilderListItemFactory      *self);
+
 G_END_DECLS
 
 #endif /* __GTK_BUILDER_LIST_ITEM_FACTORY_H__ */
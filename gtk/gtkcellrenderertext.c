@@ -206,6 +206,17 @@ struct _GtkCellRendererTextPrivate
 
   gulong focus_out_id;
   gulong entry_menu_popdown_timeout;
+
+  /* Sizes of the text from the last measurement, valid as long
+   * as no property affecting the layout changes and the widget's
+   * Pango context stays the same.
+   */
+  PangoContext   *measure_context;
+  guint           measure_serial;
+  PangoRectangle  measure_extents;
+  int             measure_char_width;
+  int             measure_for_width;
+  int             measure_height;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCellRendererText, gtk_cell_renderer_text, GTK_TYPE_CELL_RENDERER)
@@ -660,6 +671,7 @@ gtk_cell_renderer_text_finalize (GObject *object)
     g_object_unref (priv->language);
 
   g_clear_object (&priv->entry);
+  g_clear_object (&priv->measure_context);
 
   G_OBJECT_CLASS (gtk_cell_renderer_text_parent_class)->finalize (object);
 }
@@ -1033,6 +1045,64 @@ set_font_description (GtkCellRendererText  *celltext,
   g_object_thaw_notify (object);
 }
 
+static gboolean
+property_affects_size (guint param_id)
+{
+  switch (param_id)
+    {
+    case PROP_BACKGROUND:
+    case PROP_FOREGROUND:
+    case PROP_BACKGROUND_RGBA:
+    case PROP_FOREGROUND_RGBA:
+    case PROP_STRIKETHROUGH:
+    case PROP_BACKGROUND_SET:
+    case PROP_FOREGROUND_SET:
+    case PROP_STRIKETHROUGH_SET:
+    case PROP_EDITABLE_SET:
+      return FALSE;
+    default:
+      return TRUE;
+    }
+}
+
+/* Tree views and cell areas apply the attributes of every row before
+ * measuring it, so most values are set again to what they already
+ * were. Only drop the cached sizes when a value actually changes.
+ */
+static void
+invalidate_measure_cache (GObject      *object,
+                          guint         param_id,
+                          const GValue *value,
+                          GParamSpec   *pspec)
+{
+  GtkCellRendererText *celltext = GTK_CELL_RENDERER_TEXT (object);
+  GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
+  GValue old_value = G_VALUE_INIT;
+  gboolean changed;
+
+  if (priv->measure_context == NULL || !property_affects_size (param_id))
+    return;
+
+  /* Setting the text drops the attributes of the markup, and boxed
+   * values such as attribute lists can change without being replaced
+   */
+  if ((pspec->flags & G_PARAM_READABLE) &&
+      !(param_id == PROP_TEXT && priv->markup_set) &&
+      !G_IS_PARAM_SPEC_BOXED (pspec) &&
+      !G_IS_PARAM_SPEC_OBJECT (pspec))
+    {
+      g_value_init (&old_value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+      gtk_cell_renderer_text_get_property (object, param_id, &old_value, pspec);
+      changed = g_param_values_cmp (pspec, value, &old_value) != 0;
+      g_value_unset (&old_value);
+    }
+  else
+    changed = TRUE;
+
+  if (changed)
+    g_clear_object (&priv->measure_context);
+}
+
 static void
 gtk_cell_renderer_text_set_property (GObject      *object,
 				     guint         param_id,
@@ -1042,6 +1112,8 @@ gtk_cell_renderer_text_set_property (GObject      *object,
   GtkCellRendererText *celltext = GTK_CELL_RENDERER_TEXT (object);
   GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
 
+  invalidate_measure_cache (object, param_id, value, pspec);
+
   switch (param_id)
     {
     case PROP_TEXT:
@@ -1882,6 +1954,60 @@ gtk_cell_renderer_text_set_fixed_height_from_font (GtkCellRendererText *renderer
     }
 }
 
+static gboolean
+measure_cache_is_valid (GtkCellRendererText *celltext,
+                        GtkWidget           *widget)
+{
+  GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
+  PangoContext *context = gtk_widget_get_pango_context (widget);
+
+  if (priv->measure_context == context &&
+      priv->measure_serial == pango_context_get_serial (context))
+    return TRUE;
+
+  g_set_object (&priv->measure_context, context);
+  priv->measure_serial = pango_context_get_serial (context);
+  priv->measure_char_width = -1;
+  priv->measure_for_width = G_MININT;
+
+  return FALSE;
+}
+
+static void
+get_text_extents (GtkCellRendererText *celltext,
+                  GtkWidget           *widget,
+                  PangoRectangle      *extents,
+                  int                 *char_width)
+{
+  GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
+  PangoLayout *layout;
+  PangoContext *context;
+  PangoFontMetrics *metrics;
+
+  if (!measure_cache_is_valid (celltext, widget) || priv->measure_char_width < 0)
+    {
+      layout = get_layout (celltext, widget, NULL, 0);
+
+      /* Fetch the length of the complete unwrapped text */
+      pango_layout_set_width (layout, -1);
+      pango_layout_get_extents (layout, NULL, &priv->measure_extents);
+
+      /* Fetch the average size of a character */
+      context = pango_layout_get_context (layout);
+      metrics = pango_context_get_metrics (context,
+                                           pango_context_get_font_description (context),
+                                           pango_context_get_language (context));
+
+      priv->measure_char_width = pango_font_metrics_get_approximate_char_width (metrics);
+
+      pango_font_metrics_unref (metrics);
+      g_object_unref (layout);
+    }
+
+  *extents = priv->measure_extents;
+  *char_width = priv->measure_char_width;
+}
+
 static void
 gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
                                             GtkWidget       *widget,
@@ -1890,9 +2016,6 @@ gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
 {
   GtkCellRendererText        *celltext = GTK_CELL_RENDERER_TEXT (cell);
   GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
-  PangoLayout                *layout;
-  PangoContext               *context;
-  PangoFontMetrics           *metrics;
   PangoRectangle              rect;
   int char_width, text_width, ellipsize_chars, xpad;
   int min_width, nat_width;
@@ -1907,24 +2030,9 @@ gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
    */
   gtk_cell_renderer_get_padding (cell, &xpad, NULL);
 
-  layout = get_layout (celltext, widget, NULL, 0);
-
-  /* Fetch the length of the complete unwrapped text */
-  pango_layout_set_width (layout, -1);
-  pango_layout_get_extents (layout, NULL, &rect);
+  get_text_extents (celltext, widget, &rect, &char_width);
   text_width = rect.width;
 
-  /* Fetch the average size of a character */
-  context = pango_layout_get_context (layout);
-  metrics = pango_context_get_metrics (context,
-                                       pango_context_get_font_description (context),
-                                       pango_context_get_language (context));
-
-  char_width = pango_font_metrics_get_approximate_char_width (metrics);
-
-  pango_font_metrics_unref (metrics);
-  g_object_unref (layout);
-
   /* enforce minimum width for ellipsized labels at ~3 chars */
   if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
     ellipsize_chars = 3;
@@ -1972,23 +2080,35 @@ gtk_cell_renderer_text_get_preferred_height_for_width (GtkCellRenderer *cell,
                                                        int             *natural_height)
 {
   GtkCellRendererText *celltext = GTK_CELL_RENDERER_TEXT (cell);
+  GtkCellRendererTextPrivate *priv = gtk_cell_renderer_text_get_instance_private (celltext);
   PangoLayout         *layout;
   int                  text_height, xpad, ypad;
 
   gtk_cell_renderer_get_padding (cell, &xpad, &ypad);
 
-  layout = get_layout (celltext, widget, NULL, 0);
+  if (measure_cache_is_valid (celltext, widget) &&
+      priv->measure_for_width == width - xpad * 2)
+    {
+      text_height = priv->measure_height;
+    }
+  else
+    {
+      layout = get_layout (celltext, widget, NULL, 0);
+
+      pango_layout_set_width (layout, (width - xpad * 2) * PANGO_SCALE);
+      pango_layout_get_pixel_size (layout, NULL, &text_height);
 
-  pango_layout_set_width (layout, (width - xpad * 2) * PANGO_SCALE);
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+      g_object_unref (layout);
+
+      priv->measure_for_width = width - xpad * 2;
+      priv->measure_height = text_height;
+    }
 
   if (minimum_height)
     *minimum_height = text_height + ypad * 2;
 
   if (natural_height)
     *natural_height = text_height + ypad * 2;
-
-  g_object_unref (layout);
 }
 
 static void
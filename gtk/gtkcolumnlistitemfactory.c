@@ -22,6 +22,7 @@
 #include "gtkcolumnlistitemfactoryprivate.h"
 
 #include "gtkboxlayout.h"
+#include "gtkcolumnviewcellprivate.h"
 #include "gtkcolumnviewcolumnprivate.h"
 #include "gtkcolumnviewlayoutprivate.h"
 #include "gtklistitemfactoryprivate.h"
@@ -102,7 +103,12 @@ gtk_column_list_item_factory_update (GtkListItemFactory *factory,
        child;
        child = gtk_widget_get_next_sibling (child))
     {
-      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (child), position, item, selected);
+      GtkColumnViewColumn *column = gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child));
+
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (child),
+                                   position,
+                                   gtk_column_view_column_get_in_view (column) ? item : NULL,
+                                   selected);
     }
 }
 
@@ -145,6 +151,6 @@ gtk_column_list_item_factory_add_column (GtkColumnListItemFactory *factory,
   gtk_list_item_widget_add_child (GTK_LIST_ITEM_WIDGET (list_item), GTK_WIDGET (cell));
   gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (cell),
                                gtk_list_item_widget_get_position (list_item),
-                               gtk_list_item_widget_get_item (list_item),
+                               gtk_column_view_column_get_in_view (column) ? gtk_list_item_widget_get_item (list_item) : NULL,
                                gtk_list_item_widget_get_selected (list_item));
 }
@@ -38,6 +38,10 @@ struct _GtkColumnViewCell
   /* This list isn't sorted - next/prev refer to list elements, not rows in the list */
   GtkColumnViewCell *next_cell;
   GtkColumnViewCell *prev_cell;
+
+  /* cached horizontal size, -1 if it needs to be measured */
+  int minimum_width;
+  int natural_width;
 };
 
 struct _GtkColumnViewCellClass
@@ -212,8 +216,11 @@ gtk_column_view_cell_resize_func (GtkWidget *widget)
 {
   GtkColumnViewCell *self = GTK_COLUMN_VIEW_CELL (widget);
 
+  self->minimum_width = -1;
+  self->natural_width = -1;
+
   if (self->column)
-    gtk_column_view_column_queue_resize (self->column);
+    gtk_column_view_column_queue_relayout (self->column);
 }
 
 static void
@@ -221,6 +228,9 @@ gtk_column_view_cell_init (GtkColumnViewCell *self)
 {
   GtkWidget *widget = GTK_WIDGET (self);
 
+  self->minimum_width = -1;
+  self->natural_width = -1;
+
   gtk_widget_set_focusable (widget, FALSE);
   gtk_widget_set_overflow (widget, GTK_OVERFLOW_HIDDEN);
   /* FIXME: Figure out if setting the manager class to INVALID should work */
@@ -268,3 +278,19 @@ gtk_column_view_cell_get_column (GtkColumnViewCell *self)
 {
   return self->column;
 }
+
+void
+gtk_column_view_cell_measure_width (GtkColumnViewCell *self,
+                                    int               *minimum,
+                                    int               *natural)
+{
+  if (self->minimum_width < 0)
+    gtk_widget_measure (GTK_WIDGET (self),
+                        GTK_ORIENTATION_HORIZONTAL,
+                        -1,
+                        &self->minimum_width, &self->natural_width,
+                        NULL, NULL);
+
+  *minimum = self->minimum_width;
+  *natural = self->natural_width;
+}
@@ -44,6 +44,10 @@ GtkColumnViewCell *     gtk_column_view_cell_get_next           (GtkColumnViewCe
 GtkColumnViewCell *     gtk_column_view_cell_get_prev           (GtkColumnViewCell      *self);
 GtkColumnViewColumn *   gtk_column_view_cell_get_column         (GtkColumnViewCell      *self);
 
+void                    gtk_column_view_cell_measure_width      (GtkColumnViewCell      *self,
+                                                                 int                    *minimum,
+                                                                 int                    *natural);
+
 G_END_DECLS
 
 #endif  /* __GTK_COLUMN_VIEW_CELL_PRIVATE_H__ */
@@ -70,9 +70,14 @@ struct _GtkColumnViewColumn
 
   int fixed_width;
 
+  /* widest cell the last time the column was in view */
+  int cells_minimum;
+  int cells_natural;
+
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint in_view     : 1;
 
   GMenuModel *menu;
 
@@ -350,6 +355,7 @@ gtk_column_view_column_init (GtkColumnViewColumn *self)
   self->visible = TRUE;
   self->resizable = FALSE;
   self->expand = FALSE;
+  self->in_view = TRUE;
   self->fixed_width = -1;
 }
 
@@ -403,7 +409,7 @@ gtk_column_view_column_add_cell (GtkColumnViewColumn *self,
   self->first_cell = cell;
 
   gtk_widget_set_visible (GTK_WIDGET (cell), self->visible);
-  gtk_column_view_column_queue_resize (self);
+  gtk_column_view_column_queue_relayout (self);
 }
 
 void
@@ -413,7 +419,7 @@ gtk_column_view_column_remove_cell (GtkColumnViewColumn *self,
   if (cell == self->first_cell)
     self->first_cell = gtk_column_view_cell_get_next (cell);
 
-  gtk_column_view_column_queue_resize (self);
+  gtk_column_view_column_queue_relayout (self);
   gtk_widget_queue_resize (GTK_WIDGET (cell));
 }
 
@@ -437,6 +443,33 @@ gtk_column_view_column_queue_resize (GtkColumnViewColumn *self)
     }
 }
 
+/* Like gtk_column_view_column_queue_resize(), but for when only
+ * some cells changed their size. The other cells keep their cached
+ * sizes, only the rows are relayouted.
+ */
+void
+gtk_column_view_column_queue_relayout (GtkColumnViewColumn *self)
+{
+  GtkColumnViewCell *cell;
+
+  if (self->minimum_size_request < 0)
+    return;
+
+  self->minimum_size_request = -1;
+  self->natural_size_request = -1;
+
+  if (self->header && gtk_widget_get_parent (self->header))
+    gtk_widget_queue_resize (gtk_widget_get_parent (self->header));
+
+  for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+    {
+      GtkWidget *row = gtk_widget_get_parent (GTK_WIDGET (cell));
+
+      if (row)
+        gtk_widget_queue_resize (row);
+    }
+}
+
 void
 gtk_column_view_column_measure (GtkColumnViewColumn *self,
                                 int                 *minimum,
@@ -463,18 +496,31 @@ gtk_column_view_column_measure (GtkColumnViewColumn *self,
           nat = 0;
         }
 
-      for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+      /* Cells of columns that are scrolled out of view are not bound,
+       * so keep the width they had when they were last visible. */
+      if (self->in_view)
         {
-          gtk_widget_measure (GTK_WIDGET (cell),
-                              GTK_ORIENTATION_HORIZONTAL,
-                              -1,
-                              &cell_min, &cell_nat,
-                              NULL, NULL);
-
-          min = MAX (min, cell_min);
-          nat = MAX (nat, cell_nat);
+          self->cells_minimum = 0;
+          self->cells_natural = 0;
+
+          for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+            {
+              GtkWidget *row = gtk_widget_get_parent (GTK_WIDGET (cell));
+
+              /* skip cells in rows that are not in use */
+              if (row && !gtk_widget_get_visible (row))
+                continue;
+
+              gtk_column_view_cell_measure_width (cell, &cell_min, &cell_nat);
+
+              self->cells_minimum = MAX (self->cells_minimum, cell_min);
+              self->cells_natural = MAX (self->cells_natural, cell_nat);
+            }
         }
 
+      min = MAX (min, self->cells_minimum);
+      nat = MAX (nat, self->cells_natural);
+
       self->minimum_size_request = min;
       self->natural_size_request = nat;
     }
@@ -504,6 +550,45 @@ gtk_column_view_column_get_allocation (GtkColumnViewColumn *self,
     *size = self->allocation_size;
 }
 
+/* Columns that are scrolled out of view don't bind their cells.
+ * When a column comes into view, its cells get bound here, when it
+ * leaves the view, they are unbound once their row changes.
+ */
+void
+gtk_column_view_column_set_in_view (GtkColumnViewColumn *self,
+                                    gboolean             in_view)
+{
+  GtkColumnViewCell *cell;
+
+  if (self->in_view == in_view)
+    return;
+
+  self->in_view = in_view;
+
+  if (!in_view)
+    return;
+
+  for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+    {
+      GtkListItemWidget *list_item = GTK_LIST_ITEM_WIDGET (gtk_widget_get_parent (GTK_WIDGET (cell)));
+      gpointer item = gtk_list_item_widget_get_item (list_item);
+
+      if (gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (cell)) == item)
+        continue;
+
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (cell),
+                                   gtk_list_item_widget_get_position (list_item),
+                                   item,
+                                   gtk_list_item_widget_get_selected (list_item));
+    }
+}
+
+gboolean
+gtk_column_view_column_get_in_view (GtkColumnViewColumn *self)
+{
+  return self->in_view;
+}
+
 static void
 gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
 {
@@ -529,7 +614,7 @@ gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
       gtk_list_item_widget_add_child (list_item, cell);
       gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (cell),
                                    gtk_list_item_widget_get_position (list_item),
-                                   gtk_list_item_widget_get_item (list_item),
+                                   self->in_view ? gtk_list_item_widget_get_item (list_item) : NULL,
                                    gtk_list_item_widget_get_selected (list_item));
     }
 }
@@ -38,7 +38,12 @@ void                    gtk_column_view_column_remove_cell              (GtkColu
 GtkColumnViewCell *     gtk_column_view_column_get_first_cell           (GtkColumnViewColumn    *self);
 GtkWidget *             gtk_column_view_column_get_header               (GtkColumnViewColumn    *self);
 
+void                    gtk_column_view_column_set_in_view              (GtkColumnViewColumn    *self,
+                                                                         gboolean                in_view);
+gboolean                gtk_column_view_column_get_in_view              (GtkColumnViewColumn    *self);
+
 void                    gtk_column_view_column_queue_resize             (GtkColumnViewColumn    *self);
+void                    gtk_column_view_column_queue_relayout           (GtkColumnViewColumn    *self);
 void                    gtk_column_view_column_measure                  (GtkColumnViewColumn    *self,
                                                                          int                    *minimum,
                                                                          int                    *natural);
@@ -155,7 +155,42 @@ gtk_column_view_sorter_new (void)
 static void
 gtk_column_view_sorter_changed_cb (GtkSorter *sorter, int change, gpointer data)
 {
-  gtk_sorter_changed (GTK_SORTER (data), GTK_SORTER_CHANGE_DIFFERENT);
+  GtkColumnViewSorter *self = data;
+  GSequenceIter *iter, *last;
+
+  /* A change of the last sorter only affects items that all other
+   * sorters consider equal, so it applies to the whole chain. An
+   * inversion also needs it to be the only sorter.
+   */
+  last = g_sequence_iter_prev (g_sequence_get_end_iter (self->sorters));
+
+  switch (change)
+    {
+    case GTK_SORTER_CHANGE_INVERTED:
+      if (g_sequence_get_length (self->sorters) > 1)
+        change = GTK_SORTER_CHANGE_DIFFERENT;
+      break;
+
+    case GTK_SORTER_CHANGE_LESS_STRICT:
+    case GTK_SORTER_CHANGE_MORE_STRICT:
+      for (iter = g_sequence_get_begin_iter (self->sorters);
+           iter != last;
+           iter = g_sequence_iter_next (iter))
+        {
+          Sorter *s = g_sequence_get (iter);
+
+          if (s->sorter == sorter)
+            change = GTK_SORTER_CHANGE_DIFFERENT;
+        }
+      break;
+
+    case GTK_SORTER_CHANGE_DIFFERENT:
+    default:
+      change = GTK_SORTER_CHANGE_DIFFERENT;
+      break;
+    }
+
+  gtk_sorter_changed (GTK_SORTER (self), change);
 }
 
 static gboolean
@@ -186,6 +221,7 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
 {
   GSequenceIter *iter;
   GtkSorter *sorter;
+  GtkSorterChange change;
   Sorter *s, *first;
 
   g_return_val_if_fail (GTK_IS_COLUMN_VIEW_SORTER (self), FALSE);
@@ -202,6 +238,13 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
       if (first->column == column)
         {
           first->inverted = !first->inverted;
+          /* Only the primary sort order changes, which inverts the
+           * whole order if there are no ties to break
+           */
+          if (g_sequence_get_length (self->sorters) == 1)
+            change = GTK_SORTER_CHANGE_INVERTED;
+          else
+            change = GTK_SORTER_CHANGE_DIFFERENT;
           goto out;
         }
     }
@@ -222,8 +265,10 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
   if (first)
     gtk_column_view_column_notify_sort (first->column);
 
+  change = GTK_SORTER_CHANGE_DIFFERENT;
+
 out:
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_sorter_changed (GTK_SORTER (self), change);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -234,12 +279,25 @@ gboolean
 gtk_column_view_sorter_remove_column (GtkColumnViewSorter *self,
                                       GtkColumnViewColumn *column)
 {
+  GtkSorterChange change;
+  Sorter *last;
+
   g_return_val_if_fail (GTK_IS_COLUMN_VIEW_SORTER (self), FALSE);
   g_return_val_if_fail (GTK_IS_COLUMN_VIEW_COLUMN (column), FALSE);
 
+  if (g_sequence_is_empty (self->sorters))
+    return FALSE;
+
+  /* Dropping the last of several sorters only makes more items equal */
+  last = g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter (self->sorters)));
+  if (last->column == column && g_sequence_get_length (self->sorters) > 1)
+    change = GTK_SORTER_CHANGE_LESS_STRICT;
+  else
+    change = GTK_SORTER_CHANGE_DIFFERENT;
+
   if (remove_column (self, column))
     {
-      gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+      gtk_sorter_changed (GTK_SORTER (self), change);
       gtk_column_view_column_notify_sort (column);
       return TRUE;
     }
@@ -27,10 +27,24 @@
 #include "gtkimcontextsimple.h"
 
 #include "gtkimcontextsimpleprivate.h"
+#include "gtkprivate.h"
 
 
 #define GTK_COMPOSE_TABLE_MAGIC "GtkComposeTable"
-#define GTK_COMPOSE_TABLE_VERSION (1)
+#define GTK_COMPOSE_TABLE_VERSION (2)
+
+/* The cache is a header followed by the table data, in the byte
+ * order of the machine that wrote it, so that it can be mapped and
+ * used in place. Caches from a machine with a different byte order
+ * are rebuilt.
+ */
+typedef struct {
+  char    magic[16];
+  guint16 version;
+  guint16 byte_order;
+  guint16 max_seq_len;
+  guint16 n_seqs;
+} GtkComposeTableHeader;
 
 typedef struct {
   gunichar     *sequence;
@@ -538,59 +552,31 @@ static char *
 gtk_compose_table_serialize (GtkComposeTable *compose_table,
                              gsize           *count)
 {
-  char *p, *contents;
-  gsize length, total_length;
-  guint16 bytes;
-  const char *header = GTK_COMPOSE_TABLE_MAGIC;
-  const guint16 version = GTK_COMPOSE_TABLE_VERSION;
-  guint16 max_seq_len = compose_table->max_seq_len;
-  guint16 index_stride = max_seq_len + 2;
-  guint16 n_seqs = compose_table->n_seqs;
-  guint32 i;
+  GtkComposeTableHeader header = { GTK_COMPOSE_TABLE_MAGIC, };
+  gsize data_length;
+  char *contents;
 
   g_return_val_if_fail (compose_table != NULL, NULL);
-  g_return_val_if_fail (max_seq_len > 0, NULL);
-  g_return_val_if_fail (index_stride > 0, NULL);
-
-  length = strlen (header);
-  total_length = length + sizeof (guint16) * (3 +  index_stride * n_seqs);
-  if (count)
-    *count = total_length;
-
-  p = contents = g_slice_alloc (total_length);
-
-  memcpy (p, header, length);
-  p += length;
-
-  /* Copy by byte for endian */
-#define BYTE_COPY_FROM_BUF(element)                                           \
-  bytes = GUINT16_TO_BE ((element));                                          \
-  memcpy (p, &bytes, length);                                                 \
-  p += length;                                                                \
-  if (p - contents > total_length)                                            \
-    {                                                                         \
-      g_warning ("data size %lld is bigger than %" G_GSIZE_FORMAT,            \
-                 (long long) (p - contents), total_length);                   \
-      g_free (contents);                                                      \
-      if (count)                                                              \
-        {                                                                     \
-          *count = 0;                                                         \
-        }                                                                     \
-      return NULL;                                                            \
+  g_return_val_if_fail (compose_table->max_seq_len > 0, NULL);
+
+  if (compose_table->n_seqs > G_MAXUINT16)
+    {
+      g_warning ("Too many sequences for a cache: %d", compose_table->n_seqs);
+      return NULL;
     }
 
-  length = sizeof (guint16);
+  header.version = GTK_COMPOSE_TABLE_VERSION;
+  header.byte_order = G_BYTE_ORDER;
+  header.max_seq_len = compose_table->max_seq_len;
+  header.n_seqs = compose_table->n_seqs;
 
-  BYTE_COPY_FROM_BUF (version);
-  BYTE_COPY_FROM_BUF (max_seq_len);
-  BYTE_COPY_FROM_BUF (n_seqs);
+  data_length = sizeof (guint16) * (compose_table->max_seq_len + 2) * compose_table->n_seqs;
 
-  for (i = 0; i < (guint32) index_stride * n_seqs; i++)
-    {
-      BYTE_COPY_FROM_BUF (compose_table->data[i]);
-    }
+  contents = g_malloc (sizeof (header) + data_length);
+  memcpy (contents, &header, sizeof (header));
+  memcpy (contents + sizeof (header), compose_table->data, data_length);
 
-#undef BYTE_COPY_FROM_BUF
+  *count = sizeof (header) + data_length;
 
   return contents;
 }
@@ -605,113 +591,101 @@ gtk_compose_table_find (gconstpointer data1,
 }
 
 static GtkComposeTable *
-gtk_compose_table_load_cache (const char *compose_file)
+gtk_compose_table_load_cache_file (const char *path,
+                                   const char *compose_file,
+                                   guint32     hash)
 {
-  guint32 hash;
-  char *path = NULL;
-  char *contents = NULL;
-  char *p;
   GStatBuf original_buf;
   GStatBuf cache_buf;
-  gsize total_length;
-  gsize length;
-  GError *error = NULL;
-  guint16 bytes;
-  guint16 version;
-  guint16 max_seq_len;
-  guint16 index_stride;
-  guint16 n_seqs;
-  guint32 i;
-  guint16 *gtk_compose_seqs = NULL;
+  GMappedFile *mapped;
+  const GtkComposeTableHeader *header;
   GtkComposeTable *retval;
+  GError *error = NULL;
+  gsize length;
 
-  hash = g_str_hash (compose_file);
-  if ((path = gtk_compose_hash_get_cache_path (hash)) == NULL)
+  if (g_stat (path, &cache_buf) != 0)
     return NULL;
-  if (!g_file_test (path, G_FILE_TEST_EXISTS))
-    goto out_load_cache;
 
-  g_stat (compose_file, &original_buf);
-  g_stat (path, &cache_buf);
-  if (original_buf.st_mtime > cache_buf.st_mtime)
-    goto out_load_cache;
-  if (!g_file_get_contents (path, &contents, &total_length, &error))
+  if (g_stat (compose_file, &original_buf) == 0 &&
+      original_buf.st_mtime > cache_buf.st_mtime)
+    return NULL;
+
+  mapped = g_mapped_file_new (path, FALSE, &error);
+  if (mapped == NULL)
     {
-      g_warning ("Failed to get cache content %s: %s", path, error->message);
+      g_warning ("Failed to map cache %s: %s", path, error->message);
       g_error_free (error);
-      goto out_load_cache;
+      return NULL;
     }
 
-  /* Copy by byte for endian */
-#define BYTE_COPY_TO_BUF(element)                                       \
-  memcpy (&bytes, p, length);                                           \
-  element = GUINT16_FROM_BE (bytes);                                    \
-  p += length;                                                          \
-  if (p - contents > total_length)                                      \
-    {                                                                   \
-      g_warning ("Broken cache content %s in %s", path, #element);      \
-      goto out_load_cache;                                              \
-    }
+  length = g_mapped_file_get_length (mapped);
+  header = (const GtkComposeTableHeader *) g_mapped_file_get_contents (mapped);
 
-  p = contents;
-  if (g_ascii_strncasecmp (p, GTK_COMPOSE_TABLE_MAGIC,
-                           strlen (GTK_COMPOSE_TABLE_MAGIC)) != 0)
+  if (length < sizeof (GtkComposeTableHeader) ||
+      strncmp (header->magic, GTK_COMPOSE_TABLE_MAGIC, sizeof (header->magic)) != 0)
     {
       g_warning ("The file is not a GtkComposeTable cache file %s", path);
       goto out_load_cache;
     }
-  p += strlen (GTK_COMPOSE_TABLE_MAGIC);
-  if (p - contents > total_length)
-    {
-      g_warning ("Broken cache content %s at head", path);
-      goto out_load_cache;
-    }
 
-  length = sizeof (guint16);
+  /* Caches from older versions or from other machines get rebuilt */
+  if (header->version != GTK_COMPOSE_TABLE_VERSION ||
+      header->byte_order != G_BYTE_ORDER)
+    goto out_load_cache;
 
-  BYTE_COPY_TO_BUF (version);
-  if (version != GTK_COMPOSE_TABLE_VERSION)
+  if (header->max_seq_len == 0 ||
+      header->max_seq_len > GTK_MAX_COMPOSE_LEN ||
+      header->n_seqs == 0 ||
+      length != sizeof (GtkComposeTableHeader) +
+                sizeof (guint16) * (header->max_seq_len + 2) * header->n_seqs)
     {
-      g_warning ("cache version is different %u != %u",
-                 version, GTK_COMPOSE_TABLE_VERSION);
+      g_warning ("Broken cache content %s", path);
       goto out_load_cache;
     }
 
-  BYTE_COPY_TO_BUF (max_seq_len);
-  BYTE_COPY_TO_BUF (n_seqs);
+  retval = g_new0 (GtkComposeTable, 1);
+  retval->data = (const guint16 *) (header + 1);
+  retval->max_seq_len = header->max_seq_len;
+  retval->n_seqs = header->n_seqs;
+  retval->id = hash;
+  retval->mapped = mapped;
 
-  if (max_seq_len == 0 || n_seqs == 0)
-    {
-      g_warning ("cache size is not correct %d %d", max_seq_len, n_seqs);
-      goto out_load_cache;
-    }
+  return retval;
 
-  index_stride = max_seq_len + 2;
-  gtk_compose_seqs = g_new0 (guint16, n_seqs * index_stride);
+out_load_cache:
+  g_mapped_file_unref (mapped);
+  return NULL;
+}
+
+static GtkComposeTable *
+gtk_compose_table_load_cache (const char *compose_file)
+{
+  GtkComposeTable *retval;
+  guint32 hash;
+  char *basename;
+  char *path;
 
-  for (i = 0; i < (guint32) index_stride * n_seqs; i++)
+  hash = g_str_hash (compose_file);
+
+  path = gtk_compose_hash_get_cache_path (hash);
+  if (path != NULL)
     {
-      BYTE_COPY_TO_BUF (gtk_compose_seqs[i]);
+      retval = gtk_compose_table_load_cache_file (path, compose_file, hash);
+      g_free (path);
+      if (retval != NULL)
+        return retval;
     }
 
-  retval = g_new0 (GtkComposeTable, 1);
-  retval->data = gtk_compose_seqs;
-  retval->max_seq_len = max_seq_len;
-  retval->n_seqs = n_seqs;
-  retval->id = hash;
-
-  g_free (contents);
+  /* Caches for the system compose files can be installed along
+   * with GTK, so that users don't need to build their own
+   */
+  basename = g_strdup_printf ("%08x.cache", hash);
+  path = g_build_filename (_gtk_get_datadir (), "gtk-4.0", "compose", basename, NULL);
+  retval = gtk_compose_table_load_cache_file (path, compose_file, hash);
   g_free (path);
+  g_free (basename);
 
   return retval;
-
-#undef BYTE_COPY_TO_BUF
-
-out_load_cache:
-  g_free (gtk_compose_seqs);
-  g_free (contents);
-  g_free (path);
-  return NULL;
 }
 
 static void
@@ -739,7 +713,7 @@ gtk_compose_table_save_cache (GtkComposeTable *compose_table)
     }
 
 out_save_cache:
-  g_slice_free1 (length, contents);
+  g_free (contents);
   g_free (path);
 }
 
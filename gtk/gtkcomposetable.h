@@ -28,10 +28,12 @@ typedef struct _GtkComposeTableCompact GtkComposeTableCompact;
 
 struct _GtkComposeTable
 {
-  guint16 *data;
+  const guint16 *data;
   int max_seq_len;
   int n_seqs;
   guint32 id;
+  /* if the data is in a mapped cache file */
+  GMappedFile *mapped;
 };
 
 struct _GtkComposeTableCompact
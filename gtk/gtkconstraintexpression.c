@@ -371,8 +371,12 @@ gtk_constraint_variable_is_dummy (const GtkConstraintVariable *variable)
  * A set of variables.
  */
 struct _GtkConstraintVariableSet {
-  /* List<Variable>, owns a reference */
-  GSequence *set;
+  /* Vec<Variable>, sorted by id; owns a reference
+   *
+   * Sets are small, and the solver iterates over them far more
+   * often than it changes them, so a flat array beats a tree
+   */
+  GPtrArray *set;
 
   /* Age of the set, to guard against mutations while iterating */
   gint64 age;
@@ -389,7 +393,7 @@ gtk_constraint_variable_set_free (GtkConstraintVariableSet *set)
 {
   g_return_if_fail (set != NULL);
 
-  g_sequence_free (set->set);
+  g_ptr_array_unref (set->set);
 
   g_free (set);
 }
@@ -406,24 +410,43 @@ gtk_constraint_variable_set_new (void)
 {
   GtkConstraintVariableSet *res = g_new (GtkConstraintVariableSet, 1);
 
-  res->set = g_sequence_new ((GDestroyNotify) gtk_constraint_variable_unref);
+  res->set = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_constraint_variable_unref);
 
   res->age = 0;
 
   return res;
 }
 
-static int
-sort_by_variable_id (gconstpointer a,
-                     gconstpointer b,
-                     gpointer      data)
+/* Returns the position of @variable in @set, or the position
+ * where it should be inserted if it is not in @set
+ */
+static guint
+variable_set_search (GtkConstraintVariableSet *set,
+                     GtkConstraintVariable    *variable,
+                     gboolean                 *found)
 {
-  const GtkConstraintVariable *va = a, *vb = b;
+  guint lo = 0, hi = set->set->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      GtkConstraintVariable *v = g_ptr_array_index (set->set, mid);
 
-  if (va == vb)
-    return 0;
+      if (v->_id == variable->_id)
+        {
+          *found = TRUE;
+          return mid;
+        }
 
-  return va->_id - vb->_id;
+      if (v->_id < variable->_id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  *found = FALSE;
+
+  return lo;
 }
 
 /*< private >
@@ -444,17 +467,14 @@ gboolean
 gtk_constraint_variable_set_add (GtkConstraintVariableSet *set,
                                  GtkConstraintVariable *variable)
 {
-  GSequenceIter *iter;
+  gboolean found;
+  guint pos;
 
-  iter = g_sequence_search (set->set, variable, sort_by_variable_id, NULL);
-  if (!g_sequence_iter_is_end (iter))
-    {
-      GtkConstraintVariable *v = g_sequence_get (iter);
-      if (v->_id == variable->_id)
-        return FALSE;
-    }
+  pos = variable_set_search (set, variable, &found);
+  if (found)
+    return FALSE;
 
-  g_sequence_insert_before (iter, gtk_constraint_variable_ref (variable));
+  g_ptr_array_insert (set->set, pos, gtk_constraint_variable_ref (variable));
 
   set->age += 1;
 
@@ -477,12 +497,13 @@ gboolean
 gtk_constraint_variable_set_remove (GtkConstraintVariableSet *set,
                                     GtkConstraintVariable *variable)
 {
-  GSequenceIter *iter;
+  gboolean found;
+  guint pos;
 
-  iter = g_sequence_lookup (set->set, variable, sort_by_variable_id, NULL);
-  if (iter != NULL)
+  pos = variable_set_search (set, variable, &found);
+  if (found)
     {
-      g_sequence_remove (iter);
+      g_ptr_array_remove_index (set->set, pos);
       set->age += 1;
 
       return TRUE;
@@ -502,19 +523,19 @@ gtk_constraint_variable_set_remove (GtkConstraintVariableSet *set,
 int
 gtk_constraint_variable_set_size (GtkConstraintVariableSet *set)
 {
-  return g_sequence_get_length (set->set);
+  return set->set->len;
 }
 
 gboolean
 gtk_constraint_variable_set_is_empty (GtkConstraintVariableSet *set)
 {
-  return g_sequence_is_empty (set->set);
+  return set->set->len == 0;
 }
 
 gboolean
 gtk_constraint_variable_set_is_singleton (GtkConstraintVariableSet *set)
 {
-  return g_sequence_iter_next (g_sequence_get_begin_iter (set->set)) == g_sequence_get_end_iter (set->set);
+  return set->set->len == 1;
 }
 
 /*< private >
@@ -525,7 +546,7 @@ gtk_constraint_variable_set_is_singleton (GtkConstraintVariableSet *set)
 /* Keep in sync with GtkConstraintVariableSetIter */
 typedef struct {
   GtkConstraintVariableSet *set;
-  GSequenceIter *iter;
+  gsize index;
   gint64 age;
 } RealVariableSetIter;
 
@@ -548,7 +569,7 @@ gtk_constraint_variable_set_iter_init (GtkConstraintVariableSetIter *iter,
   g_return_if_fail (set != NULL);
 
   riter->set = set;
-  riter->iter = g_sequence_get_begin_iter (set->set);
+  riter->index = 0;
   riter->age = set->age;
 }
 
@@ -572,11 +593,11 @@ gtk_constraint_variable_set_iter_next (GtkConstraintVariableSetIter *iter,
 
   g_assert (riter->age == riter->set->age);
 
-  if (g_sequence_iter_is_end (riter->iter))
+  if (riter->index >= riter->set->set->len)
     return FALSE;
 
-  *variable_p = g_sequence_get (riter->iter);
-  riter->iter = g_sequence_iter_next (riter->iter);
+  *variable_p = g_ptr_array_index (riter->set->set, riter->index);
+  riter->index += 1;
 
   return TRUE;
 }
@@ -850,7 +850,10 @@ layout_add_constraint (GtkConstraintLayout *self,
                                           gtk_constraint_get_strength (constraint));
 }
 
-static void
+/* Returns TRUE if a new value needs to be suggested to the solver
+ * for the edit variable of @index
+ */
+static gboolean
 update_child_constraint (GtkConstraintLayout       *self,
                          GtkConstraintLayoutChild  *child_info,
                          GtkWidget                 *child,
@@ -872,6 +875,35 @@ update_child_constraint (GtkConstraintLayout       *self,
     GTK_CONSTRAINT_RELATION_EQ
   };
 
+  if (relation[index] == GTK_CONSTRAINT_RELATION_EQ)
+    {
+      /* The natural size is an edit variable that stays in the solver
+       * across layout passes; changing it only needs a new suggested
+       * value, instead of removing and adding a constraint
+       */
+      var = get_child_attribute (self, child, attr[index]);
+
+      if (child_info->constraints[index] == NULL ||
+          !gtk_constraint_solver_has_edit_variable (self->solver, var))
+        {
+          child_info->values[index] = value;
+
+          gtk_constraint_variable_set_value (var, value);
+          child_info->constraints[index] =
+            gtk_constraint_solver_add_edit_variable (self->solver,
+                                                     var,
+                                                     GTK_CONSTRAINT_STRENGTH_MEDIUM);
+          return FALSE;
+        }
+
+      if (child_info->values[index] == value)
+        return FALSE;
+
+      child_info->values[index] = value;
+
+      return TRUE;
+    }
+
   if (child_info->values[index] != value)
     {
       child_info->values[index] = value;
@@ -882,24 +914,15 @@ update_child_constraint (GtkConstraintLayout       *self,
 
       var = get_child_attribute (self, child, attr[index]);
 
-      if (relation[index] == GTK_CONSTRAINT_RELATION_EQ)
-        {
-          gtk_constraint_variable_set_value (var, value);
-          child_info->constraints[index] =
-            gtk_constraint_solver_add_stay_variable (self->solver,
-                                                     var,
-                                                     GTK_CONSTRAINT_STRENGTH_MEDIUM);
-        }
-      else
-        {
-          child_info->constraints[index] =
-            gtk_constraint_solver_add_constraint (self->solver,
-                                                  var,
-                                                  relation[index],
-                                                  gtk_constraint_expression_new (value),
-                                                  GTK_CONSTRAINT_STRENGTH_REQUIRED);
-        }
+      child_info->constraints[index] =
+        gtk_constraint_solver_add_constraint (self->solver,
+                                              var,
+                                              relation[index],
+                                              gtk_constraint_expression_new (value),
+                                              GTK_CONSTRAINT_STRENGTH_REQUIRED);
     }
+
+  return FALSE;
 }
 
 static void
@@ -916,6 +939,7 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
   GtkConstraintVariable *size, *opposite_size;
   GtkConstraintSolver *solver;
   GtkWidget *child;
+  gboolean needs_suggestions = FALSE;
   int min_value;
   int nat_value;
 
@@ -945,12 +969,41 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
 
       update_child_constraint (self, info, child, MIN_WIDTH, min_req.width);
       update_child_constraint (self, info, child, MIN_HEIGHT, min_req.height);
-      update_child_constraint (self, info, child, NAT_WIDTH, nat_req.width);
-      update_child_constraint (self, info, child, NAT_HEIGHT, nat_req.height);
+      needs_suggestions |= update_child_constraint (self, info, child, NAT_WIDTH, nat_req.width);
+      needs_suggestions |= update_child_constraint (self, info, child, NAT_HEIGHT, nat_req.height);
     }
 
   gtk_constraint_solver_thaw (solver);
 
+  /* Suggest the natural sizes that changed in a single edit phase;
+   * the solver skips the ones that are the same as before
+   */
+  if (needs_suggestions)
+    {
+      gtk_constraint_solver_begin_edit (solver);
+
+      for (child = _gtk_widget_get_first_child (widget);
+           child != NULL;
+           child = _gtk_widget_get_next_sibling (child))
+        {
+          GtkConstraintLayoutChild *info;
+
+          if (!gtk_widget_should_layout (child))
+            continue;
+
+          info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+
+          gtk_constraint_solver_suggest_value (solver,
+                                               get_child_attribute (self, child, GTK_CONSTRAINT_ATTRIBUTE_WIDTH),
+                                               info->values[NAT_WIDTH]);
+          gtk_constraint_solver_suggest_value (solver,
+                                               get_child_attribute (self, child, GTK_CONSTRAINT_ATTRIBUTE_HEIGHT),
+                                               info->values[NAT_HEIGHT]);
+        }
+
+      gtk_constraint_solver_end_edit (solver);
+    }
+
   switch (orientation)
     {
     case GTK_ORIENTATION_HORIZONTAL:
@@ -1025,13 +1078,16 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
     return;
 
   /* We add required stay constraints to ensure that the layout remains
-   * within the bounds of the allocation
+   * within the bounds of the allocation; the solver is frozen so that
+   * it only solves the system once, after all of them are in place
    */
   layout_top = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_TOP);
   layout_left = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_LEFT);
   layout_width = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_WIDTH);
   layout_height = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_HEIGHT);
 
+  gtk_constraint_solver_freeze (solver);
+
   gtk_constraint_variable_set_value (layout_top, 0.0);
   stay_t = gtk_constraint_solver_add_stay_variable (solver,
                                                     layout_top,
@@ -1048,6 +1104,9 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   stay_h = gtk_constraint_solver_add_stay_variable (solver,
                                                     layout_height,
                                                     GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  gtk_constraint_solver_thaw (solver);
+
   GTK_NOTE (LAYOUT,
             g_print ("Layout [%p]: { .x: %g, .y: %g, .w: %g, .h: %g }\n",
                      self,
@@ -1122,10 +1181,12 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
 #endif
 
   /* The allocation stay constraints are not needed any more */
+  gtk_constraint_solver_freeze (solver);
   gtk_constraint_solver_remove_constraint (solver, stay_w);
   gtk_constraint_solver_remove_constraint (solver, stay_h);
   gtk_constraint_solver_remove_constraint (solver, stay_t);
   gtk_constraint_solver_remove_constraint (solver, stay_l);
+  gtk_constraint_solver_thaw (solver);
 }
 
 static void
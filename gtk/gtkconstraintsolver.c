@@ -1403,7 +1403,8 @@ gtk_constraint_solver_freeze (GtkConstraintSolver *solver)
  * gtk_constraint_solver_thaw:
  * @solver: a #GtkConstraintSolver
  *
- * Thaws a frozen #GtkConstraintSolver.
+ * Thaws a frozen #GtkConstraintSolver, and solves the constraints
+ * that changed while it was frozen, if any.
  */
 void
 gtk_constraint_solver_thaw (GtkConstraintSolver *solver)
@@ -1416,6 +1417,12 @@ gtk_constraint_solver_thaw (GtkConstraintSolver *solver)
   if (solver->freeze_count == 0)
     {
       solver->auto_solve = TRUE;
+
+      /* Nothing was added, removed or edited while frozen */
+      if (!solver->needs_solving)
+        return;
+
+      gtk_constraint_solver_optimize (solver, solver->objective);
       gtk_constraint_solver_resolve (solver);
     }
 }
@@ -1990,9 +1997,14 @@ gtk_constraint_solver_suggest_value (GtkConstraintSolver *self,
     }
 
   delta = value - ei->prev_constant;
+  if (delta == 0.0)
+    return;
+
   ei->prev_constant = value;
 
   gtk_constraint_solver_delta_edit_constant (self, delta, ei->eplus, ei->eminus);
+
+  self->needs_solving = TRUE;
 }
 
 /*< private >
@@ -2047,8 +2059,12 @@ gtk_constraint_solver_has_edit_variable (GtkConstraintSolver   *solver,
  * gtk_constraint_solver_resolve() to solve the system, and get the value
  * of the various variables that you're interested in.
  *
- * Once you completed the edit phase, call gtk_constraint_solver_end_edit()
- * to remove all the edit variables.
+ * Once you completed the edit phase, call gtk_constraint_solver_end_edit().
+ *
+ * Edit variables remain in the solver after the edit phase ends, until
+ * they are removed with gtk_constraint_solver_remove_edit_variable(); a
+ * later edit phase can suggest new values for them without adding them
+ * to the tableau again.
  */
 void
 gtk_constraint_solver_begin_edit (GtkConstraintSolver *solver)
@@ -2077,8 +2093,8 @@ edit_info_free (gpointer data)
  * gtk_constraint_solver_end_edit:
  * @solver: a #GtkConstraintSolver
  *
- * Ends the edit phase for a constraint system, and clears
- * all the edit variables introduced.
+ * Ends the edit phase for a constraint system, and solves
+ * the system for the suggested values.
  */
 void
 gtk_constraint_solver_end_edit (GtkConstraintSolver *solver)
@@ -2086,8 +2102,6 @@ gtk_constraint_solver_end_edit (GtkConstraintSolver *solver)
   solver->in_edit_phase = FALSE;
 
   gtk_constraint_solver_resolve (solver);
-
-  g_hash_table_remove_all (solver->edit_var_map);
 }
 
 void
@@ -923,8 +923,7 @@ gtk_css_animated_style_new_advance (GtkCssAnimatedStyle *source,
 {
   GtkCssAnimatedStyle *result;
   GtkCssStyle *style;
-  GPtrArray *animations;
-  guint i;
+  guint i, n_animations;
 
   gtk_internal_return_val_if_fail (GTK_IS_CSS_ANIMATED_STYLE (source), NULL);
   gtk_internal_return_val_if_fail (GTK_IS_CSS_STYLE (base_style), NULL);
@@ -934,30 +933,34 @@ gtk_css_animated_style_new_advance (GtkCssAnimatedStyle *source,
 
   gtk_internal_return_val_if_fail (timestamp > source->current_time, NULL);
 
-  animations = NULL;
+  /* This runs for every animated node on every frame, so size the
+   * array up front instead of growing a GPtrArray */
+  n_animations = 0;
   for (i = 0; i < source->n_animations; i ++)
     {
-      GtkStyleAnimation *animation = source->animations[i];
-
-      if (_gtk_style_animation_is_finished (animation))
-        continue;
-
-      if (!animations)
-        animations = g_ptr_array_sized_new (16);
-
-      animation = _gtk_style_animation_advance (animation, timestamp);
-      g_ptr_array_add (animations, animation);
+      if (!_gtk_style_animation_is_finished (source->animations[i]))
+        n_animations++;
     }
 
-  if (animations == NULL)
+  if (n_animations == 0)
     return g_object_ref (source->style);
 
   result = g_object_new (GTK_TYPE_CSS_ANIMATED_STYLE, NULL);
 
   result->style = g_object_ref (base_style);
   result->current_time = timestamp;
-  result->n_animations = animations->len;
-  result->animations = g_ptr_array_free (animations, FALSE);
+  result->n_animations = 0;
+  result->animations = g_new (GtkStyleAnimation *, n_animations);
+
+  for (i = 0; i < source->n_animations; i ++)
+    {
+      GtkStyleAnimation *animation = source->animations[i];
+
+      if (_gtk_style_animation_is_finished (animation))
+        continue;
+
+      result->animations[result->n_animations++] = _gtk_style_animation_advance (animation, timestamp);
+    }
 
   style = (GtkCssStyle *)result;
   style->core = (GtkCssCoreValues *)gtk_css_values_ref ((GtkCssValues *)base_style->core);
@@ -100,13 +100,13 @@ gtk_css_dimension_value_parse (GtkCssParser           *parser,
       for (i = 0; i < G_N_ELEMENTS (units); i++)
         {
           if (flags & units[i].required_flags &&
-              g_ascii_strcasecmp (token->dimension.dimension, units[i].name) == 0)
+              g_ascii_strcasecmp (gtk_css_token_get_dimension (token), units[i].name) == 0)
             break;
         }
 
       if (i >= G_N_ELEMENTS (units))
         {
-          gtk_css_parser_error_syntax (parser, "'%s' is not a valid unit.", token->dimension.dimension);
+          gtk_css_parser_error_syntax (parser, "'%s' is not a valid unit.", gtk_css_token_get_dimension (token));
           return NULL;
         }
 
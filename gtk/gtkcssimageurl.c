@@ -31,34 +31,125 @@
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
 
-static GtkCssImage *
-gtk_css_image_url_load_image (GtkCssImageUrl  *url,
-                              GError         **error)
+/* Textures loaded for url() images, so that an image used by several
+ * selectors, style providers or reloads of a theme is only loaded once
+ * and the renderers see the same texture. The cache does not keep the
+ * textures alive, and files are checked for changes with their etag.
+ */
+typedef struct
 {
+  char *uri;
+  char *etag;
   GdkTexture *texture;
-  GError *local_error = NULL;
+} CachedTexture;
 
-  if (url->loaded_image)
-    return url->loaded_image;
+static GHashTable *texture_cache;
+
+static void
+cached_texture_free (gpointer data)
+{
+  CachedTexture *cached = data;
+
+  if (cached->texture)
+    g_object_weak_unref (G_OBJECT (cached->texture), cached_texture_finalized, cached);
+  g_free (cached->uri);
+  g_free (cached->etag);
+  g_slice_free (CachedTexture, cached);
+}
+
+static void
+cached_texture_finalized (gpointer  data,
+                          GObject  *texture)
+{
+  CachedTexture *cached = data;
+
+  cached->texture = NULL;
+  g_hash_table_remove (texture_cache, cached->uri);
+}
+
+static GdkTexture *
+gtk_css_image_url_load_texture (GFile   *file,
+                                GError **error)
+{
+  CachedTexture *cached;
+  GdkTexture *texture;
+  char *uri, *etag;
+  gboolean is_resource;
+
+  if (texture_cache == NULL)
+    texture_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cached_texture_free);
+
+  uri = g_file_get_uri (file);
+  is_resource = g_file_has_uri_scheme (file, "resource");
+
+  etag = NULL;
+  if (!is_resource)
+    {
+      GFileInfo *info;
+
+      info = g_file_query_info (file, G_FILE_ATTRIBUTE_ETAG_VALUE, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+      if (info)
+        {
+          etag = g_strdup (g_file_info_get_etag (info));
+          g_object_unref (info);
+        }
+    }
+
+  cached = g_hash_table_lookup (texture_cache, uri);
+  if (cached && g_strcmp0 (cached->etag, etag) == 0)
+    {
+      g_free (uri);
+      g_free (etag);
+      return g_object_ref (cached->texture);
+    }
 
   /* We special case resources here so we can use
      gdk_pixbuf_new_from_resource, which in turn has some special casing
      for GdkPixdata files to avoid duplicating the memory for the pixbufs */
-  if (g_file_has_uri_scheme (url->file, "resource"))
+  if (is_resource)
     {
-      char *uri = g_file_get_uri (url->file);
       char *resource_path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
 
       texture = gdk_texture_new_from_resource (resource_path);
 
       g_free (resource_path);
-      g_free (uri);
     }
   else
     {
-      texture = gdk_texture_new_from_file (url->file, &local_error);
+      texture = gdk_texture_new_from_file (file, error);
+    }
+
+  if (texture && (is_resource || etag))
+    {
+      cached = g_slice_new (CachedTexture);
+      cached->uri = uri;
+      cached->etag = etag;
+      cached->texture = texture;
+      g_object_weak_ref (G_OBJECT (texture), cached_texture_finalized, cached);
+
+      g_hash_table_replace (texture_cache, cached->uri, cached);
+    }
+  else
+    {
+      g_free (uri);
+      g_free (etag);
     }
 
+  return texture;
+}
+
+static GtkCssImage *
+gtk_css_image_url_load_image (GtkCssImageUrl  *url,
+                              GError         **error)
+{
+  GdkTexture *texture;
+  GError *local_error = NULL;
+
+  if (url->loaded_image)
+    return url->loaded_image;
+
+  texture = gtk_css_image_url_load_texture (url->file, &local_error);
+
   if (texture == NULL)
     {
       if (error)
@@ -24,18 +24,48 @@
 #include "gtkprivatetypebuiltins.h"
 #include "gtkprivate.h"
 
+#include <string.h>
+
 void
 _gtk_css_lookup_init (GtkCssLookup     *lookup)
 {
-  memset (lookup, 0, sizeof (*lookup));
-
   lookup->set_values = _gtk_bitmask_new ();
+  lookup->n_values = 0;
+  lookup->n_allocated = GTK_CSS_LOOKUP_PREALLOCATED_VALUES;
+  lookup->values = lookup->preallocated;
 }
 
 void
 _gtk_css_lookup_destroy (GtkCssLookup *lookup)
 {
   _gtk_bitmask_free (lookup->set_values);
+
+  if (lookup->values != lookup->preallocated)
+    g_free (lookup->values);
+}
+
+/* Returns the position of @id in the values, or where it would
+ * have to be inserted */
+static guint
+gtk_css_lookup_find (const GtkCssLookup *lookup,
+                     guint               id)
+{
+  guint min, max, mid;
+
+  min = 0;
+  max = lookup->n_values;
+
+  while (min < max)
+    {
+      mid = (min + max) / 2;
+
+      if (lookup->values[mid].id < id)
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+  return min;
 }
 
 gboolean
@@ -66,11 +96,66 @@ _gtk_css_lookup_set (GtkCssLookup  *lookup,
                      GtkCssSection *section,
                      GtkCssValue   *value)
 {
+  guint pos;
+
   gtk_internal_return_if_fail (lookup != NULL);
   gtk_internal_return_if_fail (value != NULL);
-  gtk_internal_return_if_fail (lookup->values[id].value == NULL);
+  gtk_internal_return_if_fail (_gtk_css_lookup_is_missing (lookup, id));
+
+  if (lookup->n_values == lookup->n_allocated)
+    {
+      lookup->n_allocated = MIN (2 * lookup->n_allocated, GTK_CSS_PROPERTY_N_PROPERTIES);
+
+      if (lookup->values == lookup->preallocated)
+        {
+          lookup->values = g_new (GtkCssLookupValue, lookup->n_allocated);
+          memcpy (lookup->values, lookup->preallocated, sizeof (GtkCssLookupValue) * lookup->n_values);
+        }
+      else
+        lookup->values = g_renew (GtkCssLookupValue, lookup->values, lookup->n_allocated);
+    }
 
-  lookup->values[id].value = value;
-  lookup->values[id].section = section;
+  /* Providers are queried by priority, not by id, but the last
+   * property set is usually the one with the highest id so far */
+  if (lookup->n_values == 0 || lookup->values[lookup->n_values - 1].id < id)
+    pos = lookup->n_values;
+  else
+    {
+      pos = gtk_css_lookup_find (lookup, id);
+      memmove (&lookup->values[pos + 1],
+               &lookup->values[pos],
+               sizeof (GtkCssLookupValue) * (lookup->n_values - pos));
+    }
+
+  lookup->values[pos].id = id;
+  lookup->values[pos].value = value;
+  lookup->values[pos].section = section;
+  lookup->n_values++;
   lookup->set_values = _gtk_bitmask_set (lookup->set_values, id, TRUE);
 }
+
+/**
+ * _gtk_css_lookup_get:
+ * @lookup: the lookup
+ * @id: id of the property
+ *
+ * Gets the value that was set for @id with _gtk_css_lookup_set().
+ *
+ * Returns: (nullable): the value or %NULL if none was set
+ **/
+const GtkCssLookupValue *
+_gtk_css_lookup_get (const GtkCssLookup *lookup,
+                     guint               id)
+{
+  guint pos;
+
+  gtk_internal_return_val_if_fail (lookup != NULL, NULL);
+
+  if (_gtk_css_lookup_is_missing (lookup, id))
+    return NULL;
+
+  pos = gtk_css_lookup_find (lookup, id);
+  g_assert (pos < lookup->n_values && lookup->values[pos].id == id);
+
+  return &lookup->values[pos];
+}
@@ -31,13 +31,24 @@ G_BEGIN_DECLS
 typedef struct _GtkCssLookup GtkCssLookup;
 
 typedef struct {
+  guint              id;
   GtkCssSection     *section;
   GtkCssValue       *value;
 } GtkCssLookupValue;
 
+/* Most nodes only set a few properties, so values are kept in a
+ * vector sorted by id instead of an array of all properties.
+ * The vector starts out in @preallocated, so a lookup must not be
+ * moved after _gtk_css_lookup_init().
+ */
+#define GTK_CSS_LOOKUP_PREALLOCATED_VALUES 32
+
 struct _GtkCssLookup {
   GtkBitmask *set_values;
-  GtkCssLookupValue  values[GTK_CSS_PROPERTY_N_PROPERTIES];
+  guint n_values;
+  guint n_allocated;
+  GtkCssLookupValue *values;
+  GtkCssLookupValue preallocated[GTK_CSS_LOOKUP_PREALLOCATED_VALUES];
 };
 
 void                    _gtk_css_lookup_init                    (GtkCssLookup               *lookup);
@@ -48,6 +59,9 @@ void                    _gtk_css_lookup_set                     (GtkCssLookup
                                                                  guint                       id,
                                                                  GtkCssSection              *section,
                                                                  GtkCssValue                *value);
+const GtkCssLookupValue *
+                        _gtk_css_lookup_get                     (const GtkCssLookup         *lookup,
+                                                                 guint                       id);
 
 static inline const GtkBitmask *
 _gtk_css_lookup_get_set_values (const GtkCssLookup *lookup)
@@ -55,6 +69,19 @@ _gtk_css_lookup_get_set_values (const GtkCssLookup *lookup)
   return lookup->set_values;
 }
 
+static inline guint
+_gtk_css_lookup_get_n_values (const GtkCssLookup *lookup)
+{
+  return lookup->n_values;
+}
+
+/* Values are sorted by id */
+static inline const GtkCssLookupValue *
+_gtk_css_lookup_get_values (const GtkCssLookup *lookup)
+{
+  return lookup->values;
+}
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_LOOKUP_PRIVATE_H__ */
@@ -21,10 +21,12 @@
 
 #include "gtkcssstaticstyleprivate.h"
 #include "gtkcssanimatedstyleprivate.h"
+#include "gtkcsslookupprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 #include "gtksettingsprivate.h"
+#include "gtkstyleproviderprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
 #include "gdkprofilerprivate.h"
@@ -355,12 +357,57 @@ store_in_global_parent_cache (GtkCssNode                  *node,
                                                  style);
 }
 
+/* Selector matching results computed ahead of time by
+ * gtk_css_node_validate(), see gtk_css_node_prefetch_lookups().
+ * Only set while a validation is running.
+ */
+typedef struct {
+  GtkStyleProvider *provider;
+  GtkCssChange change;
+  GtkCssLookup lookup;
+} PrefetchedLookup;
+
+static GHashTable *prefetched_lookups;
+
+/* Matching depends on the declarations and positions of nodes, so
+ * the results are useless once anything changes those while the
+ * styles are being computed. */
+static void
+gtk_css_node_discard_prefetched_lookups (void)
+{
+  if (G_LIKELY (prefetched_lookups == NULL))
+    return;
+
+  g_hash_table_remove_all (prefetched_lookups);
+}
+
+static PrefetchedLookup *
+gtk_css_node_take_prefetched_lookup (GtkCssNode *cssnode)
+{
+  PrefetchedLookup *prefetched;
+
+  if (G_LIKELY (prefetched_lookups == NULL))
+    return NULL;
+
+  prefetched = g_hash_table_lookup (prefetched_lookups, cssnode);
+  if (prefetched == NULL)
+    return NULL;
+
+  g_hash_table_remove (prefetched_lookups, cssnode);
+
+  if (prefetched->provider != gtk_css_node_get_style_provider (cssnode))
+    return NULL;
+
+  return prefetched;
+}
+
 static GtkCssStyle *
 gtk_css_node_create_style (GtkCssNode                   *cssnode,
                            const GtkCountingBloomFilter *filter,
                            GtkCssChange                  change)
 {
   const GtkCssNodeDeclaration *decl;
+  PrefetchedLookup *prefetched;
   GtkCssStyle *style;
   GtkCssChange style_change;
 
@@ -382,10 +429,17 @@ gtk_css_node_create_style (GtkCssNode                   *cssnode,
       style_change = gtk_css_static_style_get_change (gtk_css_style_get_static_style (cssnode->style));
     }
 
-  style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
-                                            filter,
-                                            cssnode,
-                                            style_change);
+  prefetched = gtk_css_node_take_prefetched_lookup (cssnode);
+  if (prefetched)
+    style = gtk_css_static_style_new_from_lookup (prefetched->provider,
+                                                  &prefetched->lookup,
+                                                  cssnode,
+                                                  style_change ? style_change : prefetched->change);
+  else
+    style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
+                                              filter,
+                                              cssnode,
+                                              style_change);
 
   store_in_global_parent_cache (cssnode, decl, style);
 
@@ -721,6 +775,8 @@ gtk_css_node_reposition (GtkCssNode *node,
   /* Take a reference here so the whole function has a reference */
   g_object_ref (node);
 
+  gtk_css_node_discard_prefetched_lookups ();
+
   if (node->visible)
     {
       if (node->next_sibling)
@@ -1036,6 +1092,8 @@ gtk_css_node_set_visible (GtkCssNode *cssnode,
   cssnode->visible = visible;
   g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_VISIBLE]);
 
+  gtk_css_node_discard_prefetched_lookups ();
+
   if (cssnode->invalid)
     {
       if (cssnode->visible)
@@ -1097,6 +1155,7 @@ gtk_css_node_set_name (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_set_name (&cssnode->decl, name))
     {
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_NAME);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_NAME]);
     }
@@ -1114,6 +1173,7 @@ gtk_css_node_set_id (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_set_id (&cssnode->decl, id))
     {
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_ID);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_ID]);
     }
@@ -1152,6 +1212,7 @@ gtk_css_node_set_state (GtkCssNode    *cssnode,
                      GTK_STATE_FLAG_SELECTED))
         change |= GTK_CSS_CHANGE_STATE;
 
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, change);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_STATE]);
     }
@@ -1168,6 +1229,7 @@ gtk_css_node_clear_classes (GtkCssNode *cssnode)
 {
   if (gtk_css_node_declaration_clear_classes (&cssnode->decl))
     {
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1219,6 +1281,7 @@ gtk_css_node_add_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_add_class (&cssnode->decl, style_class))
     {
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1230,6 +1293,7 @@ gtk_css_node_remove_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_remove_class (&cssnode->decl, style_class))
     {
+      gtk_css_node_discard_prefetched_lookups ();
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1260,6 +1324,7 @@ gtk_css_node_invalidate_style_provider (GtkCssNode *cssnode)
 {
   GtkCssNode *child;
 
+  gtk_css_node_discard_prefetched_lookups ();
   gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
 
   for (child = cssnode->first_child;
@@ -1359,10 +1424,279 @@ gtk_css_node_validate_internal (GtkCssNode             *cssnode,
     gtk_css_node_declaration_remove_bloom_hashes (cssnode->decl, filter);
 }
 
+/* Below this many nodes, matching in parallel costs more than it saves */
+#define MIN_PARALLEL_LOOKUP_NODES 256
+#define MIN_NODES_PER_LOOKUP_JOB 64
+#define MAX_LOOKUP_THREADS 8
+
+typedef struct _LookupBatch LookupBatch;
+
+typedef struct {
+  GtkCssNode **nodes;
+  PrefetchedLookup *lookups;
+  guint first;
+  guint last;
+  LookupBatch *batch;
+} LookupJob;
+
+struct _LookupBatch
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+};
+
+static GThreadPool *lookup_pool;
+
+/* Collects the nodes that validation will most likely create a new
+ * style for, in the order it visits them. This follows how pending
+ * changes are propagated to children, but ignores siblings and the
+ * parent cache, so it can be wrong in both directions. */
+static void
+gtk_css_node_collect_lookup_nodes (GtkCssNode   *cssnode,
+                                   GtkCssChange  parent_change,
+                                   GPtrArray    *nodes)
+{
+  GtkCssNode *child;
+  GtkCssChange change;
+
+  if (!cssnode->invalid)
+    return;
+
+  change = cssnode->pending_changes | parent_change;
+
+  if (cssnode->style_is_invalid &&
+      gtk_css_style_needs_recreation (GTK_CSS_STYLE (gtk_css_style_get_static_style (cssnode->style)), change))
+    {
+      g_ptr_array_add (nodes, cssnode);
+      change = _gtk_css_change_for_child (change) | GTK_CSS_CHANGE_PARENT_STYLE;
+    }
+  else
+    {
+      change = _gtk_css_change_for_child (change);
+    }
+
+  for (child = gtk_css_node_get_first_child (cssnode);
+       child;
+       child = gtk_css_node_get_next_sibling (child))
+    {
+      if (child->visible)
+        gtk_css_node_collect_lookup_nodes (child, change, nodes);
+    }
+}
+
+/* Makes @filter contain the hashes of all ancestors of @node, like
+ * gtk_css_node_validate_internal() does. @ancestors holds the nodes
+ * whose hashes are in @filter, outermost first. */
+static void
+update_ancestor_filter (GtkCountingBloomFilter *filter,
+                        GPtrArray              *ancestors,
+                        GtkCssNode             *node)
+{
+  GtkCssNode *parent, *top;
+  guint i, n;
+
+  while (ancestors->len > 0)
+    {
+      top = g_ptr_array_index (ancestors, ancestors->len - 1);
+
+      for (parent = node->parent; parent; parent = parent->parent)
+        {
+          if (parent == top)
+            break;
+        }
+
+      if (parent)
+        break;
+
+      gtk_css_node_declaration_remove_bloom_hashes (top->decl, filter);
+      g_ptr_array_set_size (ancestors, ancestors->len - 1);
+    }
+
+  top = ancestors->len > 0 ? g_ptr_array_index (ancestors, ancestors->len - 1) : NULL;
+  n = ancestors->len;
+
+  for (parent = node->parent; parent != top; parent = parent->parent)
+    g_ptr_array_add (ancestors, parent);
+
+  for (i = 0; i < (ancestors->len - n) / 2; i++)
+    {
+      gpointer tmp = ancestors->pdata[n + i];
+      ancestors->pdata[n + i] = ancestors->pdata[ancestors->len - 1 - i];
+      ancestors->pdata[ancestors->len - 1 - i] = tmp;
+    }
+
+  for (i = n; i < ancestors->len; i++)
+    {
+      GtkCssNode *ancestor = g_ptr_array_index (ancestors, i);
+
+      gtk_css_node_declaration_add_bloom_hashes (ancestor->decl, filter);
+    }
+}
+
+/* Only reads the node tree and the style providers, so it can run
+ * in any thread as long as the main thread leaves both alone. */
+static void
+gtk_css_node_prefetch_range (GtkCssNode       **nodes,
+                             PrefetchedLookup  *lookups,
+                             guint              first,
+                             guint              last)
+{
+  GtkCountingBloomFilter filter = GTK_COUNTING_BLOOM_FILTER_INIT;
+  GPtrArray *ancestors;
+  guint i;
+
+  ancestors = g_ptr_array_new ();
+
+  for (i = first; i < last; i++)
+    {
+      update_ancestor_filter (&filter, ancestors, nodes[i]);
+
+      gtk_style_provider_lookup (lookups[i].provider,
+                                 &filter,
+                                 nodes[i],
+                                 &lookups[i].lookup,
+                                 &lookups[i].change);
+    }
+
+  g_ptr_array_unref (ancestors);
+}
+
+static void
+lookup_job_run (gpointer data,
+                gpointer user_data)
+{
+  LookupJob *job = data;
+  LookupBatch *batch = job->batch;
+
+  gtk_css_node_prefetch_range (job->nodes, job->lookups, job->first, job->last);
+
+  g_mutex_lock (&batch->lock);
+  batch->n_pending--;
+  if (batch->n_pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Selector matching is the expensive part of creating styles, and
+ * unlike computing values it doesn't touch any shared state. So when
+ * a lot of nodes need new styles, like after a theme change, it is
+ * done up front by a thread pool, with the calling thread taking the
+ * first share. The styles themselves are still created by the normal
+ * validation walk, which picks up the results.
+ *
+ * Returns: (transfer full) (nullable): the lookups, to be freed with
+ *   gtk_css_node_clear_prefetched_lookups()
+ */
+static PrefetchedLookup *
+gtk_css_node_prefetch_lookups (GtkCssNode *cssnode,
+                               guint      *n_lookups)
+{
+  static int enabled = -1;
+  PrefetchedLookup *lookups;
+  GtkCssNode **nodes;
+  GPtrArray *array;
+  guint n_nodes, n_threads, n_jobs, nodes_per_job;
+  LookupBatch batch;
+  LookupJob *jobs;
+  guint i;
+
+  if (G_UNLIKELY (enabled == -1))
+    enabled = g_getenv ("GTK_NO_PARALLEL_CSS") == NULL && g_get_num_processors () > 1;
+
+  *n_lookups = 0;
+
+  /* We might get here again from a style-changed handler */
+  if (!enabled || prefetched_lookups != NULL || !cssnode->invalid)
+    return NULL;
+
+  array = g_ptr_array_new ();
+  gtk_css_node_collect_lookup_nodes (cssnode, 0, array);
+
+  n_nodes = array->len;
+  n_threads = CLAMP (g_get_num_processors (), 1, MAX_LOOKUP_THREADS);
+  n_jobs = MIN (n_threads, n_nodes / MIN_NODES_PER_LOOKUP_JOB);
+
+  if (n_nodes < MIN_PARALLEL_LOOKUP_NODES || n_jobs < 2)
+    {
+      g_ptr_array_unref (array);
+      return NULL;
+    }
+
+  nodes = (GtkCssNode **) array->pdata;
+  lookups = g_new (PrefetchedLookup, n_nodes);
+  prefetched_lookups = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      lookups[i].provider = gtk_css_node_get_style_provider (nodes[i]);
+      lookups[i].change = 0;
+      _gtk_css_lookup_init (&lookups[i].lookup);
+    }
+
+  if (G_UNLIKELY (lookup_pool == NULL))
+    lookup_pool = g_thread_pool_new (lookup_job_run, NULL, MAX_LOOKUP_THREADS - 1, FALSE, NULL);
+
+  nodes_per_job = (n_nodes + n_jobs - 1) / n_jobs;
+  jobs = g_newa (LookupJob, n_jobs);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_jobs - 1;
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].nodes = nodes;
+      jobs[i].lookups = lookups;
+      jobs[i].first = i * nodes_per_job;
+      jobs[i].last = MIN (jobs[i].first + nodes_per_job, n_nodes);
+      jobs[i].batch = &batch;
+    }
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (lookup_pool, &jobs[i], NULL);
+
+  gtk_css_node_prefetch_range (nodes, lookups, jobs[0].first, jobs[0].last);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  for (i = 0; i < n_nodes; i++)
+    g_hash_table_insert (prefetched_lookups, nodes[i], &lookups[i]);
+
+  g_ptr_array_unref (array);
+
+  *n_lookups = n_nodes;
+  return lookups;
+}
+
+static void
+gtk_css_node_clear_prefetched_lookups (PrefetchedLookup *lookups,
+                                       guint             n_lookups)
+{
+  guint i;
+
+  if (lookups == NULL)
+    return;
+
+  for (i = 0; i < n_lookups; i++)
+    _gtk_css_lookup_destroy (&lookups[i].lookup);
+  g_free (lookups);
+
+  g_clear_pointer (&prefetched_lookups, g_hash_table_unref);
+}
+
 void
 gtk_css_node_validate (GtkCssNode *cssnode)
 {
   GtkCountingBloomFilter filter = GTK_COUNTING_BLOOM_FILTER_INIT;
+  PrefetchedLookup *lookups;
+  guint n_lookups;
   gint64 timestamp;
   gint64 before G_GNUC_UNUSED;
 
@@ -1372,8 +1706,12 @@ gtk_css_node_validate (GtkCssNode *cssnode)
 
   timestamp = gtk_css_node_get_timestamp (cssnode);
 
+  lookups = gtk_css_node_prefetch_lookups (cssnode, &n_lookups);
+
   gtk_css_node_validate_internal (cssnode, &filter, timestamp);
 
+  gtk_css_node_clear_prefetched_lookups (lookups, n_lookups);
+
   if (GDK_PROFILER_IS_RUNNING)
     {
       gdk_profiler_end_mark (before,  "css validation", "");
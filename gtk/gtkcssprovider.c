@@ -131,6 +131,10 @@ struct _GtkCssProviderPrivate
   GtkCssSelectorTree *tree;
   GResource *resource;
   char *path;
+
+  /* uris and checksums of imported files, while compiling */
+  GPtrArray *dependencies;
+  gboolean had_errors;
 };
 
 enum {
@@ -153,6 +157,11 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 GtkCssScanner  *scanner,
                                 GFile          *file,
                                 GBytes         *bytes);
+static GBytes * gtk_css_provider_compile (GtkCssProvider *css_provider,
+                                          GFile          *file);
+static gboolean gtk_css_provider_load_from_compiled (GtkCssProvider *css_provider,
+                                                     GFile          *file,
+                                                     GBytes         *compiled);
 
 G_DEFINE_TYPE_EXTENDED (GtkCssProvider, gtk_css_provider, G_TYPE_OBJECT, 0,
                         G_ADD_PRIVATE (GtkCssProvider)
@@ -321,6 +330,10 @@ gtk_css_style_provider_emit_error (GtkStyleProvider *provider,
                                    GtkCssSection    *section,
                                    const GError     *error)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (GTK_CSS_PROVIDER (provider));
+
+  priv->had_errors = TRUE;
+
   g_signal_emit (provider, css_provider_signals[PARSING_ERROR], 0, section, error);
 }
 
@@ -540,6 +553,7 @@ gtk_css_provider_finalize (GObject *object)
     }
 
   g_free (priv->path);
+  g_clear_pointer (&priv->dependencies, g_ptr_array_unref);
 
   G_OBJECT_CLASS (gtk_css_provider_parent_class)->finalize (object);
 }
@@ -604,6 +618,7 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
 
   g_hash_table_remove_all (priv->symbolic_colors);
   g_hash_table_remove_all (priv->keyframes);
+  priv->had_errors = FALSE;
 
   for (i = 0; i < priv->rulesets->len; i++)
     gtk_css_ruleset_clear (&g_array_index (priv->rulesets, GtkCssRuleset, i));
@@ -1012,12 +1027,76 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
   gdk_profiler_end_mark (before, "create selector tree", NULL);
 }
 
+/* Compiled stylesheets are cached for files loaded with
+ * gtk_css_provider_load_from_file(), which includes the built-in
+ * themes. The key covers the contents of the file, and the cache
+ * records checksums of the files it imports.
+ */
+static char *
+get_compiled_cache_path (GFile  *file,
+                         GBytes *bytes)
+{
+  GChecksum *checksum;
+  char *uri, *filename, *path;
+
+  if (g_getenv ("GTK_NO_CSS_CACHE") != NULL)
+    return NULL;
+
+  uri = g_file_get_uri (file);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) GTK_VERSION, -1);
+  g_checksum_update (checksum, (const guchar *) uri, strlen (uri) + 1);
+  g_checksum_update (checksum, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+
+  filename = g_strconcat (g_checksum_get_string (checksum), ".bin", NULL);
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "css", filename, NULL);
+
+  g_free (filename);
+  g_checksum_free (checksum);
+  g_free (uri);
+
+  return path;
+}
+
+static GBytes *
+load_compiled_cache (const char *path)
+{
+  GMappedFile *mapped;
+  GBytes *bytes;
+
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  if (mapped == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  return bytes;
+}
+
+static void
+save_compiled_cache (const char *path,
+                     GBytes     *compiled)
+{
+  char *dir;
+
+  dir = g_path_get_dirname (path);
+  if (g_mkdir_with_parents (dir, 0700) == 0)
+    g_file_set_contents (path,
+                         g_bytes_get_data (compiled, NULL),
+                         g_bytes_get_size (compiled),
+                         NULL);
+  g_free (dir);
+}
+
 static void
 gtk_css_provider_load_internal (GtkCssProvider *self,
                                 GtkCssScanner  *parent,
                                 GFile          *file,
                                 GBytes         *bytes)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (self);
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -1050,10 +1129,60 @@ gtk_css_provider_load_internal (GtkCssProvider *self,
         }
     }
 
+  if (bytes && parent == NULL && file != NULL && !gtk_keep_css_sections)
+    {
+      char *cache_path = get_compiled_cache_path (file, bytes);
+
+      if (cache_path)
+        {
+          GBytes *compiled = load_compiled_cache (cache_path);
+
+          if (compiled && gtk_css_provider_load_from_compiled (self, file, compiled))
+            {
+              g_clear_pointer (&bytes, g_bytes_unref);
+            }
+          else
+            {
+              GtkCssScanner *scanner;
+
+              priv->dependencies = g_ptr_array_new_with_free_func (g_free);
+
+              scanner = gtk_css_scanner_new (self, parent, file, bytes);
+              parse_stylesheet (scanner);
+              gtk_css_scanner_destroy (scanner);
+
+              gtk_css_provider_postprocess (self);
+
+              if (!priv->had_errors)
+                {
+                  GBytes *result = gtk_css_provider_compile (self, file);
+
+                  if (result)
+                    {
+                      save_compiled_cache (cache_path, result);
+                      g_bytes_unref (result);
+                    }
+                }
+
+              g_clear_pointer (&priv->dependencies, g_ptr_array_unref);
+              g_clear_pointer (&bytes, g_bytes_unref);
+            }
+
+          g_clear_pointer (&compiled, g_bytes_unref);
+          g_free (cache_path);
+        }
+    }
+
   if (bytes)
     {
       GtkCssScanner *scanner;
 
+      if (parent != NULL && priv->dependencies != NULL)
+        {
+          g_ptr_array_add (priv->dependencies, g_file_get_uri (file));
+          g_ptr_array_add (priv->dependencies, g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes));
+        }
+
       scanner = gtk_css_scanner_new (self,
                                      parent,
                                      file,
@@ -1489,6 +1618,477 @@ gtk_css_provider_print_keyframes (GHashTable *keyframes,
   g_list_free (keys);
 }
 
+/* The compiled form of a provider is a GVariant holding:
+ * - the format version and the number of style properties
+ * - uris and checksums of imported files
+ * - @define-color and @keyframes rules, as CSS
+ * - the unique property values, as property id and CSS text.
+ *   Every value is only parsed once when loading.
+ * - groups of values shared by rulesets, as value indexes
+ * - the group of every ruleset, in sorted order
+ * - the names used by the selector tree
+ * - the flattened selector tree
+ */
+#define COMPILED_FORMAT_VERSION 1
+#define COMPILED_TYPE "(uua(ss)sa(us)aauauasay)"
+
+typedef struct {
+  GHashTable *values;
+  GPtrArray *value_texts;
+  GArray *value_ids;
+} CompileData;
+
+static guint
+ruleset_to_index (gpointer match,
+                  gpointer user_data)
+{
+  GtkCssProviderPrivate *priv = user_data;
+
+  return (GtkCssRuleset *) match - (GtkCssRuleset *) priv->rulesets->data;
+}
+
+static void
+compiled_value_parse_error (GtkCssParser         *parser,
+                            const GtkCssLocation *start,
+                            const GtkCssLocation *end,
+                            const GError         *error,
+                            gpointer              user_data)
+{
+  gboolean *failed = user_data;
+
+  *failed = TRUE;
+}
+
+static GtkCssValue *
+parse_compiled_value (GtkCssStyleProperty *property,
+                      GFile               *file,
+                      const char          *text)
+{
+  GtkCssParser *parser;
+  GtkCssValue *value;
+  GBytes *bytes;
+  gboolean failed = FALSE;
+
+  bytes = g_bytes_new_static (text, strlen (text));
+  parser = gtk_css_parser_new_for_bytes (bytes, file, NULL, compiled_value_parse_error, &failed, NULL);
+
+  value = _gtk_style_property_parse_value (GTK_STYLE_PROPERTY (property), parser);
+  if (value && (failed || !gtk_css_parser_has_token (parser, GTK_CSS_TOKEN_EOF)))
+    g_clear_pointer (&value, _gtk_css_value_unref);
+
+  gtk_css_parser_unref (parser);
+  g_bytes_unref (bytes);
+
+  return value;
+}
+
+/* Returns the index of the value, or -1 if it doesn't survive
+ * being printed and parsed again. Not all images implement equal(),
+ * so values that print the same after reparsing are accepted, too. */
+static int
+compile_value (CompileData         *data,
+               GtkCssStyleProperty *property,
+               GFile               *file,
+               GtkCssValue         *value)
+{
+  guint id = _gtk_css_style_property_get_id (property);
+  GtkCssValue *parsed;
+  gpointer index;
+  GString *key;
+  char *text;
+
+  text = _gtk_css_value_to_string (value);
+  key = g_string_new (NULL);
+  g_string_printf (key, "%u:%s", id, text);
+
+  if (g_hash_table_lookup_extended (data->values, key->str, NULL, &index))
+    {
+      g_string_free (key, TRUE);
+      g_free (text);
+      return GPOINTER_TO_INT (index);
+    }
+
+  parsed = parse_compiled_value (property, file, text);
+  if (parsed != NULL && !_gtk_css_value_equal (parsed, value))
+    {
+      char *reprinted = _gtk_css_value_to_string (parsed);
+
+      if (!g_str_equal (reprinted, text))
+        g_clear_pointer (&parsed, _gtk_css_value_unref);
+      g_free (reprinted);
+    }
+  if (parsed == NULL)
+    {
+      g_clear_pointer (&parsed, _gtk_css_value_unref);
+      g_string_free (key, TRUE);
+      g_free (text);
+      return -1;
+    }
+  _gtk_css_value_unref (parsed);
+
+  index = GINT_TO_POINTER (data->value_texts->len);
+  g_hash_table_insert (data->values, g_string_free (key, FALSE), index);
+  g_ptr_array_add (data->value_texts, text);
+  g_array_append_val (data->value_ids, id);
+
+  return GPOINTER_TO_INT (index);
+}
+
+/*
+ * gtk_css_provider_compile:
+ * @css_provider: a #GtkCssProvider that has been loaded
+ * @file: the file @css_provider was loaded from
+ *
+ * Creates a compiled representation of @css_provider that can be
+ * loaded with gtk_css_provider_load_from_compiled() without
+ * parsing the style sheet and building the selector tree again.
+ *
+ * Returns: the compiled data, or %NULL if @css_provider can't
+ *   be compiled.
+ */
+static GBytes *
+gtk_css_provider_compile (GtkCssProvider *css_provider,
+                          GFile          *file)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GVariantBuilder dependencies, values, groups, rulesets;
+  GHashTable *group_indexes;
+  CompileData data;
+  GPtrArray *strings;
+  GBytes *tree, *result = NULL;
+  GVariant *variant;
+  GString *at_rules;
+  guint i, j, n_groups = 0;
+
+  if (priv->dependencies == NULL)
+    return NULL;
+
+  data.values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data.value_texts = g_ptr_array_new_with_free_func (g_free);
+  data.value_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  group_indexes = g_hash_table_new (NULL, NULL);
+
+  g_variant_builder_init (&groups, G_VARIANT_TYPE ("aau"));
+  g_variant_builder_init (&rulesets, G_VARIANT_TYPE ("au"));
+
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      gpointer group;
+
+      if (!g_hash_table_lookup_extended (group_indexes, ruleset->styles, NULL, &group))
+        {
+          g_variant_builder_open (&groups, G_VARIANT_TYPE ("au"));
+
+          for (j = 0; j < ruleset->n_styles; j++)
+            {
+              int index = compile_value (&data,
+                                         ruleset->styles[j].property,
+                                         file,
+                                         ruleset->styles[j].value);
+              if (index < 0)
+                {
+                  g_variant_builder_close (&groups);
+                  g_variant_builder_clear (&groups);
+                  g_variant_builder_clear (&rulesets);
+                  goto out;
+                }
+
+              g_variant_builder_add (&groups, "u", (guint32) index);
+            }
+
+          g_variant_builder_close (&groups);
+
+          group = GUINT_TO_POINTER (n_groups++);
+          g_hash_table_insert (group_indexes, ruleset->styles, group);
+        }
+
+      g_variant_builder_add (&rulesets, "u", GPOINTER_TO_UINT (group));
+    }
+
+  g_variant_builder_init (&values, G_VARIANT_TYPE ("a(us)"));
+  for (i = 0; i < data.value_texts->len; i++)
+    g_variant_builder_add (&values, "(us)",
+                           g_array_index (data.value_ids, guint, i),
+                           g_ptr_array_index (data.value_texts, i));
+
+  g_variant_builder_init (&dependencies, G_VARIANT_TYPE ("a(ss)"));
+  for (i = 0; i + 1 < priv->dependencies->len; i += 2)
+    g_variant_builder_add (&dependencies, "(ss)",
+                           g_ptr_array_index (priv->dependencies, i),
+                           g_ptr_array_index (priv->dependencies, i + 1));
+
+  at_rules = g_string_new ("");
+  gtk_css_provider_print_colors (priv->symbolic_colors, at_rules);
+  gtk_css_provider_print_keyframes (priv->keyframes, at_rules);
+
+  strings = g_ptr_array_new ();
+  tree = _gtk_css_selector_tree_serialize (priv->tree, strings, ruleset_to_index, priv);
+  g_ptr_array_add (strings, NULL);
+
+  variant = g_variant_new ("(uua(ss)sa(us)aauau^as@ay)",
+                           COMPILED_FORMAT_VERSION,
+                           _gtk_css_style_property_get_n_properties (),
+                           &dependencies,
+                           at_rules->str,
+                           &values,
+                           &groups,
+                           &rulesets,
+                           (const char * const *) strings->pdata,
+                           g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, tree, TRUE));
+  result = g_variant_get_data_as_bytes (g_variant_ref_sink (variant));
+  g_variant_unref (variant);
+
+  g_bytes_unref (tree);
+  g_ptr_array_unref (strings);
+  g_string_free (at_rules, TRUE);
+
+out:
+  g_hash_table_unref (group_indexes);
+  g_hash_table_unref (data.values);
+  g_ptr_array_unref (data.value_texts);
+  g_array_unref (data.value_ids);
+
+  return result;
+}
+
+static gboolean
+check_compiled_dependencies (GVariant *dependencies)
+{
+  GVariantIter iter;
+  const char *uri, *checksum;
+
+  g_variant_iter_init (&iter, dependencies);
+  while (g_variant_iter_loop (&iter, "(&s&s)", &uri, &checksum))
+    {
+      GFile *file = g_file_new_for_uri (uri);
+      GBytes *bytes = g_file_load_bytes (file, NULL, NULL, NULL);
+      char *actual = NULL;
+
+      if (bytes)
+        {
+          actual = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+          g_bytes_unref (bytes);
+        }
+      g_object_unref (file);
+
+      if (g_strcmp0 (actual, checksum) != 0)
+        {
+          g_free (actual);
+          return FALSE;
+        }
+
+      g_free (actual);
+    }
+
+  return TRUE;
+}
+
+/*
+ * gtk_css_provider_load_from_compiled:
+ * @css_provider: a #GtkCssProvider that has been reset
+ * @file: the file the data was compiled from
+ * @compiled: data created by gtk_css_provider_compile()
+ *
+ * Loads compiled data into @css_provider. The data is validated,
+ * and if it is out of date or invalid, @css_provider is left empty.
+ *
+ * Returns: %TRUE if the data was loaded
+ */
+static gboolean
+gtk_css_provider_load_from_compiled (GtkCssProvider *css_provider,
+                                     GFile          *file,
+                                     GBytes         *compiled)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
+  GVariant *variant, *dependencies, *values_variant, *groups_variant, *rulesets_variant, *tree_variant;
+  guint32 version, n_properties;
+  const char *at_rules;
+  const guint32 *ruleset_groups;
+  const char **strings;
+  gsize n_rulesets, n_values, n_groups, tree_size;
+  GtkCssStyleProperty **properties = NULL;
+  GtkCssValue **values = NULL;
+  PropertyValue **groups = NULL;
+  guint *group_sizes = NULL;
+  gboolean *group_owned = NULL;
+  gpointer *matches = NULL;
+  GtkCssSelectorTree **selector_matches = NULL;
+  const guint8 *tree_data;
+  gboolean result = FALSE;
+  gint64 before G_GNUC_UNUSED;
+  gsize i, j;
+
+  before = GDK_PROFILER_CURRENT_TIME;
+
+  variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (COMPILED_TYPE), compiled, FALSE));
+
+  g_variant_get_child (variant, 0, "u", &version);
+  g_variant_get_child (variant, 1, "u", &n_properties);
+  if (version != COMPILED_FORMAT_VERSION ||
+      n_properties != _gtk_css_style_property_get_n_properties ())
+    {
+      g_variant_unref (variant);
+      return FALSE;
+    }
+
+  dependencies = g_variant_get_child_value (variant, 2);
+  g_variant_get_child (variant, 3, "&s", &at_rules);
+  values_variant = g_variant_get_child_value (variant, 4);
+  groups_variant = g_variant_get_child_value (variant, 5);
+  rulesets_variant = g_variant_get_child_value (variant, 6);
+  ruleset_groups = g_variant_get_fixed_array (rulesets_variant, &n_rulesets, sizeof (guint32));
+  g_variant_get_child (variant, 7, "^a&s", &strings);
+  tree_variant = g_variant_get_child_value (variant, 8);
+  tree_data = g_variant_get_fixed_array (tree_variant, &tree_size, 1);
+
+  n_values = g_variant_n_children (values_variant);
+  n_groups = g_variant_n_children (groups_variant);
+
+  if (!check_compiled_dependencies (dependencies))
+    goto out;
+
+  /* @define-color and @keyframes */
+  if (*at_rules)
+    {
+      GtkCssScanner *scanner;
+      GBytes *bytes;
+
+      bytes = g_bytes_new_static (at_rules, strlen (at_rules));
+      scanner = gtk_css_scanner_new (css_provider, NULL, file, bytes);
+      parse_stylesheet (scanner);
+      gtk_css_scanner_destroy (scanner);
+      g_bytes_unref (bytes);
+
+      if (priv->had_errors)
+        goto out;
+    }
+
+  properties = g_new0 (GtkCssStyleProperty *, MAX (n_values, 1));
+  values = g_new0 (GtkCssValue *, MAX (n_values, 1));
+  for (i = 0; i < n_values; i++)
+    {
+      const char *text;
+      guint32 id;
+
+      g_variant_get_child (values_variant, i, "(u&s)", &id, &text);
+      if (id >= n_properties)
+        goto out;
+
+      properties[i] = _gtk_css_style_property_lookup_by_id (id);
+      values[i] = parse_compiled_value (properties[i], file, text);
+      if (values[i] == NULL)
+        goto out;
+    }
+
+  groups = g_new0 (PropertyValue *, MAX (n_groups, 1));
+  group_sizes = g_new0 (guint, MAX (n_groups, 1));
+  group_owned = g_new0 (gboolean, MAX (n_groups, 1));
+  for (i = 0; i < n_groups; i++)
+    {
+      GVariant *group = g_variant_get_child_value (groups_variant, i);
+      const guint32 *indexes;
+      gsize n_indexes;
+
+      indexes = g_variant_get_fixed_array (group, &n_indexes, sizeof (guint32));
+      groups[i] = g_new0 (PropertyValue, MAX (n_indexes, 1));
+      group_sizes[i] = n_indexes;
+
+      for (j = 0; j < n_indexes; j++)
+        {
+          if (indexes[j] >= n_values)
+            break;
+
+          groups[i][j].property = properties[indexes[j]];
+          groups[i][j].value = _gtk_css_value_ref (values[indexes[j]]);
+        }
+
+      g_variant_unref (group);
+
+      if (j < n_indexes)
+        {
+          group_sizes[i] = j;
+          goto out;
+        }
+    }
+
+  for (i = 0; i < n_rulesets; i++)
+    {
+      if (ruleset_groups[i] >= n_groups)
+        goto out;
+    }
+
+  /* Rulesets are already sorted, and must not move once the tree
+   * points to them. */
+  g_array_set_size (priv->rulesets, n_rulesets);
+  matches = g_new (gpointer, MAX (n_rulesets, 1));
+  selector_matches = g_new (GtkCssSelectorTree *, MAX (n_rulesets, 1));
+  for (i = 0; i < n_rulesets; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      guint group = ruleset_groups[i];
+
+      ruleset->selector = NULL;
+      ruleset->selector_match = NULL;
+      ruleset->styles = groups[group];
+      ruleset->n_styles = group_sizes[group];
+      ruleset->owns_styles = !group_owned[group];
+      group_owned[group] = TRUE;
+
+      matches[i] = ruleset;
+    }
+
+  priv->tree = _gtk_css_selector_tree_deserialize (tree_data, tree_size,
+                                                   strings, g_strv_length ((char **) strings),
+                                                   matches, selector_matches, n_rulesets);
+  if (priv->tree == NULL && (tree_size > 0 || n_rulesets > 0))
+    goto out;
+
+  for (i = 0; i < n_rulesets; i++)
+    g_array_index (priv->rulesets, GtkCssRuleset, i).selector_match = selector_matches[i];
+
+  result = TRUE;
+
+out:
+  if (!result)
+    {
+      /* Groups that made it into rulesets are freed with them */
+      for (i = 0; i < n_groups && groups; i++)
+        {
+          if (group_owned[i])
+            continue;
+
+          for (j = 0; j < group_sizes[i]; j++)
+            g_clear_pointer (&groups[i][j].value, _gtk_css_value_unref);
+          g_free (groups[i]);
+        }
+
+      gtk_css_provider_reset (css_provider);
+    }
+
+  for (i = 0; i < n_values && values; i++)
+    g_clear_pointer (&values[i], _gtk_css_value_unref);
+
+  g_free (properties);
+  g_free (values);
+  g_free (groups);
+  g_free (group_sizes);
+  g_free (group_owned);
+  g_free (matches);
+  g_free (selector_matches);
+  g_free (strings);
+  g_variant_unref (tree_variant);
+  g_variant_unref (rulesets_variant);
+  g_variant_unref (groups_variant);
+  g_variant_unref (values_variant);
+  g_variant_unref (dependencies);
+  g_variant_unref (variant);
+
+  gdk_profiler_end_mark (before, "load compiled theme", NULL);
+
+  return result;
+}
+
 /**
  * gtk_css_provider_to_string:
  * @provider: the provider to write to a string
@@ -947,7 +947,7 @@ gtk_css_selector_parse_selector_class (GtkCssParser   *parser,
       selector = gtk_css_selector_new (negate ? &GTK_CSS_SELECTOR_NOT_CLASS
                                               : &GTK_CSS_SELECTOR_CLASS,
                                        selector);
-      selector->style_class.style_class = g_quark_from_string (token->string.string);
+      selector->style_class.style_class = g_quark_from_string (gtk_css_token_get_string (token));
       gtk_css_parser_consume_token (parser);
       return selector;
     }
@@ -1060,7 +1060,7 @@ parse_n_plus_b (GtkCssParser *parser,
       return parse_plus_b (parser, TRUE, b);
     }
   else if (gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT) &&
-           string_has_number (token->string.string, "n-", b))
+           string_has_number (gtk_css_token_get_string (token), "n-", b))
     {
       *a = before;
       *b = -*b;
@@ -1122,7 +1122,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
     }
   else if (((!seen_sign && gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION)) ||
             gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION)) &&
-           g_ascii_strcasecmp (token->dimension.dimension, "n") == 0)
+           g_ascii_strcasecmp (gtk_css_token_get_dimension (token), "n") == 0)
     {
       *a = token->dimension.value * (seen_sign ? seen_sign : 1);
       gtk_css_parser_consume_token (parser);
@@ -1130,7 +1130,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
     }
   else if (((!seen_sign && gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION)) ||
             gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION)) &&
-           g_ascii_strcasecmp (token->dimension.dimension, "n-") == 0)
+           g_ascii_strcasecmp (gtk_css_token_get_dimension (token), "n-") == 0)
     {
       *a = token->dimension.value * (seen_sign ? seen_sign : 1);
       gtk_css_parser_consume_token (parser);
@@ -1138,7 +1138,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
     }
   else if (((!seen_sign && gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNED_INTEGER_DIMENSION)) ||
             gtk_css_token_is (token, GTK_CSS_TOKEN_SIGNLESS_INTEGER_DIMENSION)) &&
-           string_has_number (token->dimension.dimension, "n-", b))
+           string_has_number (gtk_css_token_get_dimension (token), "n-", b))
     {
       *a = token->dimension.value * (seen_sign ? seen_sign : 1);
       *b = -*b;
@@ -1159,7 +1159,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
     }
   else if (!seen_sign &&
            gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT) &&
-           string_has_number (token->string.string, "-n-", b))
+           string_has_number (gtk_css_token_get_string (token), "-n-", b))
     {
       *a = -1;
       *b = -*b;
@@ -1172,7 +1172,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
       return parse_n_plus_b (parser, seen_sign ? seen_sign : 1, a, b);
     }
   else if (gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT) &&
-           string_has_number (token->string.string, "n-", b))
+           string_has_number (gtk_css_token_get_string (token), "n-", b))
     {
       *a = seen_sign ? seen_sign : 1;
       *b = -*b;
@@ -1180,7 +1180,7 @@ parse_a_n_plus_b (GtkCssParser *parser,
       return TRUE;
     }
   else if (!seen_sign && gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT) &&
-           string_has_number (token->string.string, "-n-", b))
+           string_has_number (gtk_css_token_get_string (token), "-n-", b))
     {
       *a = -1;
       *b = -*b;
@@ -1291,7 +1291,7 @@ gtk_css_selector_parse_selector_pseudo_class (GtkCssParser   *parser,
 
       for (i = 0; i < G_N_ELEMENTS (pseudo_classes); i++)
         {
-          if (g_ascii_strcasecmp (pseudo_classes[i].name, token->string.string) == 0)
+          if (g_ascii_strcasecmp (pseudo_classes[i].name, gtk_css_token_get_string (token)) == 0)
             {
               if (pseudo_classes[i].state_flag)
                 {
@@ -1383,13 +1383,13 @@ gtk_css_selector_parse_selector_pseudo_class (GtkCssParser   *parser,
               else if (gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT))
                 {
                   selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_NOT_NAME, selector);
-                  selector->name.name = g_quark_from_string (token->string.string);
+                  selector->name.name = g_quark_from_string (gtk_css_token_get_string (token));
                   gtk_css_parser_consume_token (parser);
                 }
               else if (gtk_css_token_is (token, GTK_CSS_TOKEN_HASH_ID))
                 {
                   selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_NOT_ID, selector);
-                  selector->id.name = g_quark_from_string (token->string.string);
+                  selector->id.name = g_quark_from_string (gtk_css_token_get_string (token));
                   gtk_css_parser_consume_token (parser);
                 }
               else if (gtk_css_token_is_delim (token, '.'))
@@ -1502,13 +1502,13 @@ gtk_css_selector_parse_simple_selector (GtkCssParser   *parser,
       else if (!parsed_something && gtk_css_token_is (token, GTK_CSS_TOKEN_IDENT))
         {
           selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_NAME, selector);
-          selector->name.name = g_quark_from_string (token->string.string);
+          selector->name.name = g_quark_from_string (gtk_css_token_get_string (token));
           gtk_css_parser_consume_token (parser);
         }
       else if (gtk_css_token_is (token, GTK_CSS_TOKEN_HASH_ID))
         {
           selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_ID, selector);
-          selector->id.name = g_quark_from_string (token->string.string);
+          selector->id.name = g_quark_from_string (gtk_css_token_get_string (token));
           gtk_css_parser_consume_token (parser);
         }
       else if (gtk_css_token_is_delim (token, '.'))
@@ -1927,20 +1927,154 @@ gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
   return TRUE;
 }
 
+/* INDEX */
+
+/* Every tree is allocated with an index of its roots in front of it.
+ * Roots that require a name, id or class can only match nodes that
+ * have it, so they are looked up by it instead of being tried one
+ * after the other. That's most of them with real themes.
+ */
+typedef struct {
+  GHashTable *names;    /* GQuark => GPtrArray of roots */
+  GHashTable *ids;
+  GHashTable *classes;
+  GPtrArray *others;    /* roots that need to be tried for every node */
+} GtkCssSelectorTreeIndex;
+
+G_STATIC_ASSERT (sizeof (GtkCssSelectorTreeIndex) % sizeof (gpointer) == 0);
+
+static inline GtkCssSelectorTreeIndex *
+gtk_css_selector_tree_get_index (const GtkCssSelectorTree *tree)
+{
+  return (GtkCssSelectorTreeIndex *) ((guint8 *) tree - sizeof (GtkCssSelectorTreeIndex));
+}
+
+/* Allocates room for a tree of @size bytes, with an empty index */
+static GtkCssSelectorTree *
+gtk_css_selector_tree_alloc (gsize size)
+{
+  GtkCssSelectorTreeIndex *index;
+
+  index = g_malloc0 (sizeof (GtkCssSelectorTreeIndex) + size);
+
+  return (GtkCssSelectorTree *) (index + 1);
+}
+
+static void
+gtk_css_selector_tree_index_add (GHashTable               *table,
+                                 GQuark                    quark,
+                                 const GtkCssSelectorTree *root)
+{
+  GPtrArray *roots;
+
+  roots = g_hash_table_lookup (table, GUINT_TO_POINTER (quark));
+  if (roots == NULL)
+    {
+      roots = g_ptr_array_new ();
+      g_hash_table_insert (table, GUINT_TO_POINTER (quark), roots);
+    }
+
+  g_ptr_array_add (roots, (gpointer) root);
+}
+
+static void
+gtk_css_selector_tree_build_index (GtkCssSelectorTree *tree)
+{
+  GtkCssSelectorTreeIndex *index = gtk_css_selector_tree_get_index (tree);
+  const GtkCssSelectorTree *root;
+
+  index->names = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+  index->ids = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+  index->classes = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+  index->others = g_ptr_array_new ();
+
+  for (root = tree; root != NULL; root = gtk_css_selector_tree_get_sibling (root))
+    {
+      if (root->selector.class == &GTK_CSS_SELECTOR_NAME)
+        gtk_css_selector_tree_index_add (index->names, root->selector.name.name, root);
+      else if (root->selector.class == &GTK_CSS_SELECTOR_ID)
+        gtk_css_selector_tree_index_add (index->ids, root->selector.id.name, root);
+      else if (root->selector.class == &GTK_CSS_SELECTOR_CLASS)
+        gtk_css_selector_tree_index_add (index->classes, root->selector.style_class.style_class, root);
+      else
+        g_ptr_array_add (index->others, (gpointer) root);
+    }
+}
+
+typedef void (* GtkCssSelectorTreeRootFunc) (const GtkCssSelectorTree *root,
+                                             gpointer                  data);
+
+static inline void
+gtk_css_selector_tree_roots_foreach (GPtrArray                  *roots,
+                                     GtkCssSelectorTreeRootFunc  func,
+                                     gpointer                    data)
+{
+  guint i;
+
+  if (roots == NULL)
+    return;
+
+  for (i = 0; i < roots->len; i++)
+    func (g_ptr_array_index (roots, i), data);
+}
+
+/* Calls @func for all roots of @tree that @node may match */
+static void
+gtk_css_selector_tree_foreach_candidate (const GtkCssSelectorTree   *tree,
+                                         GtkCssNode                 *node,
+                                         GtkCssSelectorTreeRootFunc  func,
+                                         gpointer                    data)
+{
+  GtkCssSelectorTreeIndex *index = gtk_css_selector_tree_get_index (tree);
+  const GQuark *classes;
+  GQuark id;
+  guint i, n_classes;
+
+  gtk_css_selector_tree_roots_foreach (index->others, func, data);
+
+  gtk_css_selector_tree_roots_foreach (g_hash_table_lookup (index->names,
+                                                            GUINT_TO_POINTER (gtk_css_node_get_name (node))),
+                                       func, data);
+
+  id = gtk_css_node_get_id (node);
+  if (id)
+    gtk_css_selector_tree_roots_foreach (g_hash_table_lookup (index->ids, GUINT_TO_POINTER (id)),
+                                         func, data);
+
+  classes = gtk_css_node_declaration_get_classes (gtk_css_node_get_declaration (node), &n_classes);
+  for (i = 0; i < n_classes; i++)
+    gtk_css_selector_tree_roots_foreach (g_hash_table_lookup (index->classes, GUINT_TO_POINTER (classes[i])),
+                                         func, data);
+}
+
+typedef struct {
+  const GtkCountingBloomFilter *filter;
+  GtkCssNode *node;
+  GtkCssSelectorMatches *results;
+  GtkCssChange change;
+} MatchAllData;
+
+static void
+match_root (const GtkCssSelectorTree *root,
+            gpointer                  data)
+{
+  MatchAllData *match = data;
+
+  gtk_css_selector_tree_match (root, match->filter, FALSE, match->node, match->results);
+}
+
 void
 _gtk_css_selector_tree_match_all (const GtkCssSelectorTree     *tree,
                                   const GtkCountingBloomFilter *filter,
                                   GtkCssNode                   *node,
                                   GtkCssSelectorMatches        *out_tree_rules)
 {
-  const GtkCssSelectorTree *iter;
+  MatchAllData data = { filter, node, out_tree_rules, 0 };
 
-  for (iter = tree;
-       iter != NULL;
-       iter = gtk_css_selector_tree_get_sibling (iter))
-    {
-      gtk_css_selector_tree_match (iter, filter, FALSE, node, out_tree_rules);
-    }
+  if (tree == NULL)
+    return;
+
+  gtk_css_selector_tree_foreach_candidate (tree, node, match_root, &data);
 }
 
 gboolean
@@ -1949,19 +2083,31 @@ _gtk_css_selector_tree_is_empty (const GtkCssSelectorTree *tree)
   return tree == NULL;
 }
 
+static void
+change_root (const GtkCssSelectorTree *root,
+             gpointer                  data)
+{
+  MatchAllData *match = data;
+
+  match->change |= gtk_css_selector_tree_get_change (root, match->filter, match->node, FALSE);
+}
+
 GtkCssChange
 gtk_css_selector_tree_get_change_all (const GtkCssSelectorTree     *tree,
                                       const GtkCountingBloomFilter *filter,
 				      GtkCssNode                   *node)
 {
-  GtkCssChange change = 0;
+  MatchAllData data = { filter, node, NULL, 0 };
 
-  for (; tree != NULL;
-       tree = gtk_css_selector_tree_get_sibling (tree))
-    change |= gtk_css_selector_tree_get_change (tree, filter, node, FALSE);
+  if (tree == NULL)
+    return 0;
+
+  /* Roots with a name, id or class the node doesn't have can't
+   * contribute any change */
+  gtk_css_selector_tree_foreach_candidate (tree, node, change_root, &data);
 
   /* Never return reserved bit set */
-  return change & ~GTK_CSS_CHANGE_RESERVED_BIT;
+  return data.change & ~GTK_CSS_CHANGE_RESERVED_BIT;
 }
 
 #ifdef PRINT_TREE
@@ -2070,10 +2216,19 @@ _gtk_css_selector_tree_match_print (const GtkCssSelectorTree *tree,
 void
 _gtk_css_selector_tree_free (GtkCssSelectorTree *tree)
 {
+  GtkCssSelectorTreeIndex *index;
+
   if (tree == NULL)
     return;
 
-  g_free (tree);
+  index = gtk_css_selector_tree_get_index (tree);
+
+  g_clear_pointer (&index->names, g_hash_table_unref);
+  g_clear_pointer (&index->ids, g_hash_table_unref);
+  g_clear_pointer (&index->classes, g_hash_table_unref);
+  g_clear_pointer (&index->others, g_ptr_array_unref);
+
+  g_free (index);
 }
 
 
@@ -2288,12 +2443,16 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
   subdivide_infos (array, infos_array, builder->infos->len, GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET);
 
   len = array->len;
-  data = g_byte_array_free (array, FALSE);
-
-  /* shrink to final size */
-  data = g_realloc (data, len);
+  if (len == 0)
+    {
+      g_byte_array_unref (array);
+      return NULL;
+    }
 
-  tree = (GtkCssSelectorTree *)data;
+  tree = gtk_css_selector_tree_alloc (len);
+  data = (guint8 *) tree;
+  memcpy (data, array->data, len);
+  g_byte_array_unref (array);
 
   fixup_offsets (tree, data);
 
@@ -2307,6 +2466,8 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
     }
 
 
+  gtk_css_selector_tree_build_index (tree);
+
 #ifdef PRINT_TREE
   {
     GString *s = g_string_new ("");
@@ -2318,3 +2479,326 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
 
   return tree;
 }
+
+/* SERIALIZATION */
+
+static const GtkCssSelectorClass *selector_classes[] = {
+  &GTK_CSS_SELECTOR_DESCENDANT,
+  &GTK_CSS_SELECTOR_CHILD,
+  &GTK_CSS_SELECTOR_SIBLING,
+  &GTK_CSS_SELECTOR_ADJACENT,
+  &GTK_CSS_SELECTOR_ANY,
+  &GTK_CSS_SELECTOR_NOT_ANY,
+  &GTK_CSS_SELECTOR_NAME,
+  &GTK_CSS_SELECTOR_NOT_NAME,
+  &GTK_CSS_SELECTOR_CLASS,
+  &GTK_CSS_SELECTOR_NOT_CLASS,
+  &GTK_CSS_SELECTOR_ID,
+  &GTK_CSS_SELECTOR_NOT_ID,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_STATE,
+  &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_STATE,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_POSITION,
+  &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_POSITION,
+};
+
+/* name, style_class and id selectors all store a quark in the same place */
+static gboolean
+gtk_css_selector_class_has_quark (const GtkCssSelectorClass *class)
+{
+  return class == &GTK_CSS_SELECTOR_NAME ||
+         class == &GTK_CSS_SELECTOR_NOT_NAME ||
+         class == &GTK_CSS_SELECTOR_CLASS ||
+         class == &GTK_CSS_SELECTOR_NOT_CLASS ||
+         class == &GTK_CSS_SELECTOR_ID ||
+         class == &GTK_CSS_SELECTOR_NOT_ID;
+}
+
+static guint
+gtk_css_selector_class_get_index (const GtkCssSelectorClass *class)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (selector_classes); i++)
+    {
+      if (selector_classes[i] == class)
+        return i;
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+static gsize
+gtk_css_selector_tree_get_extent (const GtkCssSelectorTree *tree,
+                                  const guint8             *data)
+{
+  gsize extent = 0;
+
+  for (; tree != NULL; tree = gtk_css_selector_tree_get_sibling (tree))
+    {
+      gpointer *matches = gtk_css_selector_tree_get_matches (tree);
+
+      extent = MAX (extent, (const guint8 *) (tree + 1) - data);
+
+      if (matches)
+        {
+          while (*matches)
+            matches++;
+          extent = MAX (extent, (const guint8 *) (matches + 1) - data);
+        }
+
+      extent = MAX (extent, gtk_css_selector_tree_get_extent (gtk_css_selector_tree_get_previous (tree), data));
+    }
+
+  return extent;
+}
+
+/* Replaces pointers and quarks in the copy at @data by indexes */
+static void
+gtk_css_selector_tree_serialize_node (const GtkCssSelectorTree  *tree,
+                                      const guint8              *tree_data,
+                                      guint8                    *data,
+                                      GHashTable                *string_indexes,
+                                      GPtrArray                 *strings,
+                                      guint                    (*match_to_index) (gpointer match,
+                                                                                  gpointer user_data),
+                                      gpointer                   user_data)
+{
+  for (; tree != NULL; tree = gtk_css_selector_tree_get_sibling (tree))
+    {
+      GtkCssSelectorTree *copy = (GtkCssSelectorTree *) (data + ((const guint8 *) tree - tree_data));
+      gpointer *matches = gtk_css_selector_tree_get_matches (tree);
+
+      copy->selector.class = GUINT_TO_POINTER (gtk_css_selector_class_get_index (tree->selector.class));
+
+      if (gtk_css_selector_class_has_quark (tree->selector.class))
+        {
+          const char *string = g_quark_to_string (tree->selector.name.name);
+          gpointer index;
+
+          if (!g_hash_table_lookup_extended (string_indexes, string, NULL, &index))
+            {
+              index = GUINT_TO_POINTER (strings->len);
+              g_ptr_array_add (strings, (gpointer) string);
+              g_hash_table_insert (string_indexes, (gpointer) string, index);
+            }
+
+          copy->selector.name.name = GPOINTER_TO_UINT (index);
+        }
+
+      if (matches)
+        {
+          gpointer *matches_copy = gtk_css_selector_tree_get_matches (copy);
+
+          for (; *matches; matches++, matches_copy++)
+            *matches_copy = GUINT_TO_POINTER (match_to_index (*matches, user_data) + 1);
+        }
+
+      gtk_css_selector_tree_serialize_node (gtk_css_selector_tree_get_previous (tree),
+                                            tree_data, data,
+                                            string_indexes, strings,
+                                            match_to_index, user_data);
+    }
+}
+
+/*
+ * _gtk_css_selector_tree_serialize:
+ * @tree: the tree to serialize
+ * @strings: array to append the names used by the tree to
+ * @match_to_index: function mapping the tree's matches to indexes
+ * @user_data: data for @match_to_index
+ *
+ * Serializes @tree so that it can be restored with
+ * _gtk_css_selector_tree_deserialize() in the same process
+ * or another process of the same build of GTK.
+ *
+ * Returns: the serialized tree
+ */
+GBytes *
+_gtk_css_selector_tree_serialize (const GtkCssSelectorTree  *tree,
+                                  GPtrArray                 *strings,
+                                  guint                    (*match_to_index) (gpointer match,
+                                                                              gpointer user_data),
+                                  gpointer                   user_data)
+{
+  GHashTable *string_indexes;
+  guint8 *data;
+  gsize size;
+
+  if (tree == NULL)
+    return g_bytes_new (NULL, 0);
+
+  size = gtk_css_selector_tree_get_extent (tree, (const guint8 *) tree);
+  data = g_memdup (tree, size);
+
+  string_indexes = g_hash_table_new (g_str_hash, g_str_equal);
+  gtk_css_selector_tree_serialize_node (tree, (const guint8 *) tree, data,
+                                        string_indexes, strings,
+                                        match_to_index, user_data);
+  g_hash_table_unref (string_indexes);
+
+  return g_bytes_new_take (data, size);
+}
+
+static gboolean
+gtk_css_selector_tree_check_offset (const guint8 *data,
+                                    gsize         size,
+                                    gsize         offset,
+                                    gsize         required)
+{
+  return offset % sizeof (gpointer) == 0 &&
+         offset <= size &&
+         required <= size - offset;
+}
+
+/* Children and siblings always come after the node in the data, and
+ * matches after their node, so checking that offsets increase rules
+ * out cycles.
+ */
+static gboolean
+gtk_css_selector_tree_deserialize_node (guint8              *data,
+                                        gsize                size,
+                                        gsize                offset,
+                                        gsize                parent,
+                                        const char * const  *strings,
+                                        guint                n_strings,
+                                        gpointer            *matches,
+                                        GtkCssSelectorTree **selector_matches,
+                                        guint                n_matches)
+{
+  while (TRUE)
+    {
+      GtkCssSelectorTree *tree;
+      guint class_index;
+
+      if (!gtk_css_selector_tree_check_offset (data, size, offset, sizeof (GtkCssSelectorTree)))
+        return FALSE;
+
+      tree = (GtkCssSelectorTree *) (data + offset);
+
+      if (parent == GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+        {
+          if (tree->parent_offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+            return FALSE;
+        }
+      else if (tree->parent_offset != (gssize) parent - (gssize) offset)
+        return FALSE;
+
+      class_index = GPOINTER_TO_UINT (tree->selector.class);
+      if (class_index >= G_N_ELEMENTS (selector_classes))
+        return FALSE;
+      tree->selector.class = selector_classes[class_index];
+
+      if (gtk_css_selector_class_has_quark (tree->selector.class))
+        {
+          if (tree->selector.name.name >= n_strings)
+            return FALSE;
+          tree->selector.name.name = g_quark_from_string (strings[tree->selector.name.name]);
+        }
+
+      if (tree->matches_offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+        {
+          gsize match_offset;
+          gpointer *m;
+
+          if (tree->matches_offset <= 0)
+            return FALSE;
+
+          for (match_offset = offset + tree->matches_offset; ; match_offset += sizeof (gpointer))
+            {
+              guint index;
+
+              if (!gtk_css_selector_tree_check_offset (data, size, match_offset, sizeof (gpointer)))
+                return FALSE;
+
+              m = (gpointer *) (data + match_offset);
+              index = GPOINTER_TO_UINT (*m);
+              if (index == 0)
+                break;
+              if (index > n_matches)
+                return FALSE;
+
+              *m = matches[index - 1];
+              selector_matches[index - 1] = tree;
+            }
+        }
+
+      if (tree->previous_offset != GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+        {
+          if (tree->previous_offset <= 0 ||
+              !gtk_css_selector_tree_deserialize_node (data, size,
+                                                       offset + tree->previous_offset,
+                                                       offset,
+                                                       strings, n_strings,
+                                                       matches, selector_matches, n_matches))
+            return FALSE;
+        }
+
+      if (tree->sibling_offset == GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+        return TRUE;
+
+      if (tree->sibling_offset <= 0)
+        return FALSE;
+
+      offset += tree->sibling_offset;
+    }
+}
+
+/*
+ * _gtk_css_selector_tree_deserialize:
+ * @data: data created by _gtk_css_selector_tree_serialize()
+ * @size: size of @data
+ * @strings: the strings that were collected during serialization
+ * @n_strings: number of @strings
+ * @matches: the matches, in the order of their indexes
+ * @selector_matches: (out): return location for the tree nodes
+ *   matching each of the @matches
+ * @n_matches: number of @matches
+ *
+ * Restores a selector tree. The data is checked for consistency,
+ * so it is safe to load it from a cache file.
+ *
+ * Returns: the tree, or %NULL if @data is invalid. An empty tree
+ *   is also represented as %NULL, so check @size.
+ */
+GtkCssSelectorTree *
+_gtk_css_selector_tree_deserialize (const guint8         *data,
+                                    gsize                 size,
+                                    const char * const   *strings,
+                                    guint                 n_strings,
+                                    gpointer             *matches,
+                                    GtkCssSelectorTree  **selector_matches,
+                                    guint                 n_matches)
+{
+  guint8 *copy;
+  guint i;
+
+  if (size == 0)
+    return NULL;
+
+  copy = (guint8 *) gtk_css_selector_tree_alloc (size);
+  memcpy (copy, data, size);
+  memset (selector_matches, 0, n_matches * sizeof (GtkCssSelectorTree *));
+
+  if (!gtk_css_selector_tree_deserialize_node (copy, size, 0,
+                                               GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET,
+                                               strings, n_strings,
+                                               matches, selector_matches, n_matches))
+    {
+      _gtk_css_selector_tree_free ((GtkCssSelectorTree *) copy);
+      return NULL;
+    }
+
+  for (i = 0; i < n_matches; i++)
+    {
+      if (selector_matches[i] == NULL)
+        {
+          _gtk_css_selector_tree_free ((GtkCssSelectorTree *) copy);
+          return NULL;
+        }
+    }
+
+  gtk_css_selector_tree_build_index ((GtkCssSelectorTree *) copy);
+
+  return (GtkCssSelectorTree *) copy;
+}
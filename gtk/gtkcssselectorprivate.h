@@ -71,6 +71,19 @@ void                       _gtk_css_selector_tree_builder_add   (GtkCssSelectorT
 GtkCssSelectorTree *       _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder);
 void                       _gtk_css_selector_tree_builder_free  (GtkCssSelectorTreeBuilder *builder);
 
+GBytes *             _gtk_css_selector_tree_serialize   (const GtkCssSelectorTree  *tree,
+                                                         GPtrArray                 *strings,
+                                                         guint                    (*match_to_index) (gpointer match,
+                                                                                                     gpointer user_data),
+                                                         gpointer                   user_data);
+GtkCssSelectorTree * _gtk_css_selector_tree_deserialize (const guint8              *data,
+                                                         gsize                      size,
+                                                         const char * const        *strings,
+                                                         guint                      n_strings,
+                                                         gpointer                  *matches,
+                                                         GtkCssSelectorTree       **selector_matches,
+                                                         guint                      n_matches);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_SELECTOR_PRIVATE_H__ */
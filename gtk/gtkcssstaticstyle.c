@@ -31,6 +31,7 @@
 #include "gtkcssstringvalueprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsstransitionprivate.h"
+#include "gtkdebug.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
 #include "gtksettings.h"
@@ -39,6 +40,8 @@
 #include "gtkstyleproviderprivate.h"
 #include "gtkcssdimensionvalueprivate.h"
 
+#include <string.h>
+
 static void gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
                                                 GtkStyleProvider  *provider,
                                                 GtkCssStyle       *parent_style,
@@ -207,12 +210,13 @@ gtk_css_ ## NAME ## _values_new_compute (GtkCssStaticStyle *sstyle, \
   for (i = 0; i < G_N_ELEMENTS (NAME ## _props); i++) \
     { \
       guint id = NAME ## _props[i]; \
+      const GtkCssLookupValue *v = _gtk_css_lookup_get (lookup, id); \
       gtk_css_static_style_compute_value (sstyle, \
                                           provider, \
                                           parent_style, \
                                           id, \
-                                          lookup->values[id].value, \
-                                          lookup->values[id].section); \
+                                          v ? v->value : NULL, \
+                                          v ? v->section : NULL); \
     } \
 } \
 static GtkBitmask * gtk_css_ ## NAME ## _values_mask; \
@@ -239,6 +243,25 @@ gtk_css_ ## NAME ## _values_unset (const GtkCssLookup *lookup) \
 { \
   const GtkBitmask *set_values = _gtk_css_lookup_get_set_values (lookup); \
   return !_gtk_bitmask_intersects (set_values, gtk_css_ ## NAME ## _values_mask); \
+} \
+\
+/* Only meaningful for groups of inherited properties: TRUE if every \
+ * property of the group that is set is set to “inherit”, so the group \
+ * computes to exactly the parent's values. \
+ */ \
+static inline gboolean \
+gtk_css_ ## NAME ## _values_inherit (const GtkCssLookup *lookup) \
+{ \
+  int i; \
+\
+  for (i = 0; i < G_N_ELEMENTS (NAME ## _props); i++) \
+    { \
+      const GtkCssLookupValue *v = _gtk_css_lookup_get (lookup, NAME ## _props[i]); \
+      if (v && (v->value != _gtk_css_inherit_value_get () || v->section != NULL)) \
+        return FALSE; \
+    } \
+\
+  return TRUE; \
 }
 
 DEFINE_VALUES (CORE, Core, core)
@@ -310,11 +333,172 @@ gtk_css_static_style_get_section (GtkCssStyle *style,
   return g_ptr_array_index (sstyle->sections, id);
 }
 
+/* SHARING
+ *
+ * The node style cache only shares styles between siblings. Styles
+ * are fully determined by the winning declarations of their lookup,
+ * the parent style and the provider, so identical nodes in different
+ * places, like rows in different lists, can share them, too. The
+ * table doesn't keep the styles alive, they remove themselves when
+ * they are disposed.
+ */
+
+/* No padding, so keys can be compared with memcmp() */
+typedef struct {
+  gsize id;
+  GtkCssValue *value;
+} InternValue;
+
+typedef struct {
+  GtkStyleProvider *provider;
+  GtkCssStyle *parent_style;
+  GtkCssChange change;
+  guint hash;
+  guint n_values;
+  InternValue *values;
+} InternKey;
+
+static GHashTable *interned_styles;
+static guint intern_hits;
+static guint intern_lookups;
+
+static guint
+intern_key_hash (gconstpointer data)
+{
+  const InternKey *key = data;
+
+  return key->hash;
+}
+
+static gboolean
+intern_key_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const InternKey *ka = a;
+  const InternKey *kb = b;
+
+  return ka->hash == kb->hash &&
+         ka->provider == kb->provider &&
+         ka->parent_style == kb->parent_style &&
+         ka->change == kb->change &&
+         ka->n_values == kb->n_values &&
+         memcmp (ka->values, kb->values, ka->n_values * sizeof (InternValue)) == 0;
+}
+
+static void
+intern_key_free (gpointer data)
+{
+  InternKey *key = data;
+  guint i;
+
+  for (i = 0; i < key->n_values; i++)
+    _gtk_css_value_unref (key->values[i].value);
+  g_free (key->values);
+  g_clear_object (&key->parent_style);
+  g_object_unref (key->provider);
+  g_free (key);
+}
+
+/* Fills in @key from @lookup, with @values providing the storage.
+ *
+ * Returns: %FALSE if styles from @lookup can't be shared
+ */
+static gboolean
+intern_key_init (InternKey        *key,
+                 InternValue      *values,
+                 GtkStyleProvider *provider,
+                 GtkCssLookup     *lookup,
+                 GtkCssStyle      *parent_style,
+                 GtkCssChange      change)
+{
+  const GtkCssLookupValue *lookup_values;
+  guint i, n, hash;
+
+  key->provider = provider;
+  key->parent_style = parent_style;
+  key->change = change;
+  key->n_values = 0;
+  key->values = values;
+
+  hash = g_direct_hash (provider) ^ g_direct_hash (parent_style);
+  hash = hash * 33 + (guint) (change ^ (change >> 32));
+
+  lookup_values = _gtk_css_lookup_get_values (lookup);
+  n = _gtk_css_lookup_get_n_values (lookup);
+
+  for (i = 0; i < n; i++)
+    {
+      /* Styles that remember sections must not be shared */
+      if (lookup_values[i].section != NULL)
+        return FALSE;
+
+      values[i].id = lookup_values[i].id;
+      values[i].value = lookup_values[i].value;
+
+      hash = hash * 33 + lookup_values[i].id;
+      hash = hash * 33 + g_direct_hash (lookup_values[i].value);
+    }
+
+  key->n_values = n;
+
+  key->hash = hash;
+
+  return TRUE;
+}
+
+static void
+intern_style (GtkCssStaticStyle *style,
+              const InternKey   *key)
+{
+  InternKey *copy;
+  guint i;
+
+  copy = g_new (InternKey, 1);
+  *copy = *key;
+  copy->values = g_memdup (key->values, key->n_values * sizeof (InternValue));
+  for (i = 0; i < copy->n_values; i++)
+    _gtk_css_value_ref (copy->values[i].value);
+  g_object_ref (copy->provider);
+  if (copy->parent_style)
+    g_object_ref (copy->parent_style);
+
+  style->intern_key = copy;
+  g_hash_table_insert (interned_styles, copy, style);
+}
+
+/*
+ * gtk_css_static_style_get_sharing_stats:
+ * @n_shared: (out): return location for the number of styles
+ *   available for sharing
+ * @n_hits: (out): return location for the number of times a
+ *   style was shared
+ * @n_lookups: (out): return location for the number of times
+ *   a style was looked up for sharing
+ *
+ * Gets statistics about sharing styles between nodes that are
+ * not siblings, for the inspector.
+ */
+void
+gtk_css_static_style_get_sharing_stats (guint *n_shared,
+                                        guint *n_hits,
+                                        guint *n_lookups)
+{
+  *n_shared = interned_styles ? g_hash_table_size (interned_styles) : 0;
+  *n_hits = intern_hits;
+  *n_lookups = intern_lookups;
+}
+
 static void
 gtk_css_static_style_dispose (GObject *object)
 {
   GtkCssStaticStyle *style = GTK_CSS_STATIC_STYLE (object);
 
+  if (style->intern_key)
+    {
+      g_hash_table_remove (interned_styles, style->intern_key);
+      style->intern_key = NULL;
+    }
+
   if (style->sections)
     {
       g_ptr_array_unref (style->sections);
@@ -931,7 +1115,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
       return;
     }
 
-  if (parent_style && gtk_css_core_values_unset (lookup))
+  if (parent_style && gtk_css_core_values_inherit (lookup))
     style->core = (GtkCssCoreValues *)gtk_css_values_ref ((GtkCssValues *)parent_style->core);
   else
     gtk_css_core_values_new_compute (sstyle, provider, parent_style, lookup);
@@ -946,7 +1130,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   else
     gtk_css_border_values_new_compute (sstyle, provider, parent_style, lookup);
 
-  if (parent_style && gtk_css_icon_values_unset (lookup))
+  if (parent_style && gtk_css_icon_values_inherit (lookup))
     style->icon = (GtkCssIconValues *)gtk_css_values_ref ((GtkCssValues *)parent_style->icon);
   else
     gtk_css_icon_values_new_compute (sstyle, provider, parent_style, lookup);
@@ -956,7 +1140,7 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   else
     gtk_css_outline_values_new_compute (sstyle, provider, parent_style, lookup);
 
-  if (parent_style && gtk_css_font_values_unset (lookup))
+  if (parent_style && gtk_css_font_values_inherit (lookup))
     style->font = (GtkCssFontValues *)gtk_css_values_ref ((GtkCssValues *)parent_style->font);
   else
     gtk_css_font_values_new_compute (sstyle, provider, parent_style, lookup);
@@ -993,9 +1177,8 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                   GtkCssNode                   *node,
                                   GtkCssChange                  change)
 {
-  GtkCssStaticStyle *result;
+  GtkCssStyle *result;
   GtkCssLookup lookup;
-  GtkCssNode *parent;
 
   _gtk_css_lookup_init (&lookup);
 
@@ -1006,21 +1189,75 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                &lookup,
                                change == 0 ? &change : NULL);
 
-  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
+  result = gtk_css_static_style_new_from_lookup (provider, &lookup, node, change);
 
-  result->change = change;
+  _gtk_css_lookup_destroy (&lookup);
+
+  return result;
+}
+
+/*
+ * gtk_css_static_style_new_from_lookup:
+ * @provider: the provider @lookup was done with
+ * @lookup: the result of looking up @node in @provider
+ * @node: (nullable): the node to compute the style for
+ * @change: the change flags for @lookup
+ *
+ * Like gtk_css_static_style_new_compute(), but with the lookup
+ * already done, so it can happen ahead of time.
+ *
+ * Returns: the new style
+ */
+GtkCssStyle *
+gtk_css_static_style_new_from_lookup (GtkStyleProvider *provider,
+                                      GtkCssLookup     *lookup,
+                                      GtkCssNode       *node,
+                                      GtkCssChange      change)
+{
+  InternValue values[GTK_CSS_PROPERTY_N_PROPERTIES];
+  GtkCssStaticStyle *result;
+  GtkCssStyle *parent_style;
+  GtkCssNode *parent;
+  InternKey key;
+  gboolean can_share;
 
   if (node)
     parent = gtk_css_node_get_parent (node);
   else
     parent = NULL;
 
-  gtk_css_lookup_resolve (&lookup,
+  parent_style = parent ? gtk_css_node_get_style (parent) : NULL;
+
+  can_share = node != NULL &&
+              !GTK_DEBUG_CHECK (NO_CSS_CACHE) &&
+              intern_key_init (&key, values, provider, lookup, parent_style, change);
+
+  if (can_share)
+    {
+      if (G_UNLIKELY (interned_styles == NULL))
+        interned_styles = g_hash_table_new_full (intern_key_hash, intern_key_equal, intern_key_free, NULL);
+
+      intern_lookups++;
+
+      result = g_hash_table_lookup (interned_styles, &key);
+      if (result)
+        {
+          intern_hits++;
+          return g_object_ref (GTK_CSS_STYLE (result));
+        }
+    }
+
+  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
+
+  result->change = change;
+
+  gtk_css_lookup_resolve (lookup,
                           provider,
                           result,
-                          parent ? gtk_css_node_get_style (parent) : NULL);
+                          parent_style);
 
-  _gtk_css_lookup_destroy (&lookup);
+  if (can_share)
+    intern_style (result, &key);
 
   return GTK_CSS_STYLE (result);
 }
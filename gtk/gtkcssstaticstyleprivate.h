@@ -43,6 +43,8 @@ struct _GtkCssStaticStyle
   GPtrArray             *sections;             /* sections the values are defined in */
 
   GtkCssChange           change;               /* change as returned by value lookup */
+
+  gpointer               intern_key;           /* key in the table of shared styles or %NULL */
 };
 
 struct _GtkCssStaticStyleClass
@@ -57,8 +59,16 @@ GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvide
                                                                  const GtkCountingBloomFilter   *filter,
                                                                  GtkCssNode                     *node,
                                                                  GtkCssChange                    change);
+GtkCssStyle *           gtk_css_static_style_new_from_lookup    (GtkStyleProvider               *provider,
+                                                                 struct _GtkCssLookup           *lookup,
+                                                                 GtkCssNode                     *node,
+                                                                 GtkCssChange                    change);
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle              *style);
 
+void                    gtk_css_static_style_get_sharing_stats  (guint                          *n_shared,
+                                                                 guint                          *n_hits,
+                                                                 guint                          *n_lookups);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_STATIC_STYLE_PRIVATE_H__ */
@@ -50,17 +50,31 @@
  * This means you do not need access to the #GtkDirectoryList but can access
  * the #GFile directly from the #GFileInfo when operating with a #GtkListView
  * or similar.
+ *
+ * Attributes that are expensive to query, like thumbnails or sniffed content
+ * types, can be set as #GtkDirectoryList:lazy-attributes. They are only
+ * queried for files that are requested from the model, which for a
+ * #GtkListView are the ones that are visible.
  */
 
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* Files that arrive while loading are added at most this often,
+ * so large directories don't emit items-changed for every query.
+ */
+#define ADD_FILES_INTERVAL_MS 16
+
+/* How many lazy attribute queries run at the same time */
+#define MAX_LAZY_QUERIES 4
+
 enum {
   PROP_0,
   PROP_ATTRIBUTES,
   PROP_ERROR,
   PROP_FILE,
   PROP_IO_PRIORITY,
+  PROP_LAZY_ATTRIBUTES,
   PROP_LOADING,
   PROP_MONITORED,
   NUM_PROPERTIES
@@ -79,8 +93,22 @@ struct _GtkDirectoryList
   GCancellable *cancellable;
   GError *error; /* Error while loading */
   GSequence *items; /* Use GPtrArray or GListStore here? */
+  GPtrArray *new_items; /* loaded, but not yet in items */
+  guint add_files_id;
+
+  char *lazy_attributes;
+  GCancellable *lazy_cancellable;
+  GHashTable *lazy_items; /* GFileInfo => GSequenceIter for queued and running queries */
+  GQueue lazy_queue; /* GFileInfos whose query didn't start yet */
+  guint n_lazy_queries;
 };
 
+typedef struct
+{
+  GtkDirectoryList *self; /* invalid if cancelled */
+  GFileInfo *info;
+} LazyQuery;
+
 struct _GtkDirectoryListClass
 {
   GObjectClass parent_class;
@@ -102,6 +130,9 @@ gtk_directory_list_get_n_items (GListModel *list)
   return g_sequence_get_length (self->items);
 }
 
+static void gtk_directory_list_queue_lazy_query (GtkDirectoryList *self,
+                                                 GSequenceIter    *iter);
+
 static gpointer
 gtk_directory_list_get_item (GListModel *list,
                              guint       position)
@@ -113,8 +144,11 @@ gtk_directory_list_get_item (GListModel *list,
 
   if (g_sequence_iter_is_end (iter))
     return NULL;
-  else
-    return g_object_ref (g_sequence_get (iter));
+
+  if (self->lazy_attributes)
+    gtk_directory_list_queue_lazy_query (self, iter);
+
+  return g_object_ref (g_sequence_get (iter));
 }
 
 static void
@@ -150,6 +184,10 @@ gtk_directory_list_set_property (GObject      *object,
       gtk_directory_list_set_io_priority (self, g_value_get_int (value));
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      gtk_directory_list_set_lazy_attributes (self, g_value_get_string (value));
+      break;
+
     case PROP_MONITORED:
       gtk_directory_list_set_monitored (self, g_value_get_boolean (value));
       break;
@@ -186,6 +224,10 @@ gtk_directory_list_get_property (GObject     *object,
       g_value_set_int (value, self->io_priority);
       break;
 
+    case PROP_LAZY_ATTRIBUTES:
+      g_value_set_string (value, self->lazy_attributes);
+      break;
+
     case PROP_LOADING:
       g_value_set_boolean (value, gtk_directory_list_is_loading (self));
       break;
@@ -200,6 +242,82 @@ gtk_directory_list_get_property (GObject     *object,
     }
 }
 
+static gboolean
+gtk_directory_list_add_files_cb (gpointer data);
+
+/* Moves loaded files into the list */
+static void
+gtk_directory_list_add_new_items (GtkDirectoryList *self)
+{
+  guint i, n;
+
+  n = self->new_items->len;
+  if (n == 0)
+    return;
+
+  for (i = 0; i < n; i++)
+    g_sequence_append (self->items, g_ptr_array_index (self->new_items, i));
+  g_ptr_array_set_size (self->new_items, 0);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
+}
+
+static gboolean
+gtk_directory_list_add_files_cb (gpointer data)
+{
+  GtkDirectoryList *self = data;
+
+  if (self->new_items->len == 0)
+    {
+      self->add_files_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  gtk_directory_list_add_new_items (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* The first files are added right away, the ones arriving
+ * in the next interval together.
+ */
+static void
+gtk_directory_list_schedule_add_files (GtkDirectoryList *self)
+{
+  if (self->add_files_id != 0)
+    return;
+
+  gtk_directory_list_add_new_items (self);
+
+  self->add_files_id = g_timeout_add (ADD_FILES_INTERVAL_MS, gtk_directory_list_add_files_cb, self);
+  g_source_set_name_by_id (self->add_files_id, "[gtk] gtk_directory_list_add_files_cb");
+}
+
+static void
+gtk_directory_list_stop_lazy_queries (GtkDirectoryList *self)
+{
+  if (self->lazy_cancellable)
+    {
+      g_cancellable_cancel (self->lazy_cancellable);
+      g_clear_object (&self->lazy_cancellable);
+    }
+
+  g_hash_table_remove_all (self->lazy_items);
+  g_queue_clear (&self->lazy_queue);
+  self->n_lazy_queries = 0;
+}
+
+/* Must be called before removing iter from items */
+static void
+gtk_directory_list_forget_lazy_query (GtkDirectoryList *self,
+                                      GSequenceIter    *iter)
+{
+  GFileInfo *info = g_sequence_get (iter);
+
+  if (g_hash_table_remove (self->lazy_items, info))
+    g_queue_remove (&self->lazy_queue, info);
+}
+
 static gboolean
 gtk_directory_list_stop_loading (GtkDirectoryList *self)
 {
@@ -233,11 +351,22 @@ gtk_directory_list_dispose (GObject *object)
   gtk_directory_list_stop_loading (self);
   gtk_directory_list_stop_monitoring (self);
 
+  if (self->lazy_cancellable)
+    {
+      g_cancellable_cancel (self->lazy_cancellable);
+      g_clear_object (&self->lazy_cancellable);
+    }
+  g_queue_clear (&self->lazy_queue);
+  g_clear_handle_id (&self->add_files_id, g_source_remove);
+
   g_clear_object (&self->file);
   g_clear_pointer (&self->attributes, g_free);
+  g_clear_pointer (&self->lazy_attributes, g_free);
 
   g_clear_error (&self->error);
   g_clear_pointer (&self->items, g_sequence_free);
+  g_clear_pointer (&self->new_items, g_ptr_array_unref);
+  g_clear_pointer (&self->lazy_items, g_hash_table_unref);
 
   G_OBJECT_CLASS (gtk_directory_list_parent_class)->dispose (object);
 }
@@ -299,6 +428,20 @@ gtk_directory_list_class_init (GtkDirectoryListClass *class)
                         -G_MAXINT, G_MAXINT, G_PRIORITY_DEFAULT,
                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDirectoryList:lazy-attributes:
+   *
+   * The attributes to query only for files that are requested
+   *
+   * Since: 4.2
+   */
+  properties[PROP_LAZY_ATTRIBUTES] =
+      g_param_spec_string ("lazy-attributes",
+                           P_("Lazy attributes"),
+                           P_("Attributes to query only for requested files"),
+                           NULL,
+                           GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkDirectoryList:loading:
    *
@@ -330,6 +473,8 @@ static void
 gtk_directory_list_init (GtkDirectoryList *self)
 {
   self->items = g_sequence_new (g_object_unref);
+  self->new_items = g_ptr_array_new_with_free_func (g_object_unref);
+  self->lazy_items = g_hash_table_new (NULL, NULL);
   self->io_priority = G_PRIORITY_DEFAULT;
   self->monitored = TRUE;
 }
@@ -361,6 +506,10 @@ gtk_directory_list_clear_items (GtkDirectoryList *self)
 {
   guint n_items;
 
+  gtk_directory_list_stop_lazy_queries (self);
+  g_clear_handle_id (&self->add_files_id, g_source_remove);
+  g_ptr_array_set_size (self->new_items, 0);
+
   n_items = g_sequence_get_length (self->items);
   if (n_items > 0)
     {
@@ -394,7 +543,6 @@ gtk_directory_list_got_files_cb (GObject      *source,
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source);
   GError *error = NULL;
   GList *l, *files;
-  guint n;
 
   files = g_file_enumerator_next_files_finish (enumerator, res, &error);
 
@@ -412,6 +560,9 @@ gtk_directory_list_got_files_cb (GObject      *source,
                                      gtk_directory_list_enumerator_closed_cb,
                                      NULL);
 
+      g_clear_handle_id (&self->add_files_id, g_source_remove);
+      gtk_directory_list_add_new_items (self);
+
       g_object_freeze_notify (G_OBJECT (self));
 
       g_clear_object (&self->cancellable);
@@ -427,7 +578,6 @@ gtk_directory_list_got_files_cb (GObject      *source,
       return;
     }
 
-  n = 0;
   for (l = files; l; l = l->next)
     {
       GFileInfo *info;
@@ -437,8 +587,7 @@ gtk_directory_list_got_files_cb (GObject      *source,
       file = g_file_enumerator_get_child (enumerator, info);
       g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
       g_object_unref (file);
-      g_sequence_append (self->items, info);
-      n++;
+      g_ptr_array_add (self->new_items, info);
     }
   g_list_free (files);
 
@@ -449,8 +598,7 @@ gtk_directory_list_got_files_cb (GObject      *source,
                                       gtk_directory_list_got_files_cb,
                                       self);
 
-  if (n > 0)
-    g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_get_length (self->items) - n, 0, n);
+  gtk_directory_list_schedule_add_files (self);
 }
 
 static void
@@ -518,6 +666,122 @@ gtk_directory_list_start_loading (GtkDirectoryList *self)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
 }
 
+static GQuark
+gtk_directory_list_lazy_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gtk-directory-list-lazy");
+
+  return quark;
+}
+
+static void gtk_directory_list_start_lazy_queries (GtkDirectoryList *self);
+
+static void
+gtk_directory_list_got_lazy_info_cb (GObject      *source,
+                                     GAsyncResult *res,
+                                     gpointer      data)
+{
+  LazyQuery *query = data;
+  GtkDirectoryList *self = query->self;
+  GFile *file = G_FILE (source);
+  GSequenceIter *iter;
+  GError *error = NULL;
+  GFileInfo *info;
+
+  info = g_file_query_info_finish (file, res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_clear_error (&error);
+      goto out;
+    }
+  g_clear_error (&error);
+
+  self->n_lazy_queries--;
+
+  iter = g_hash_table_lookup (self->lazy_items, query->info);
+  if (iter)
+    {
+      g_hash_table_remove (self->lazy_items, query->info);
+
+      if (info)
+        {
+          /* Update the item itself, the view may hold on to it */
+          g_file_info_copy_into (info, query->info);
+          g_file_info_set_attribute_object (query->info, "standard::file", G_OBJECT (file));
+          g_list_model_items_changed (G_LIST_MODEL (self), g_sequence_iter_get_position (iter), 1, 1);
+        }
+    }
+
+  gtk_directory_list_start_lazy_queries (self);
+
+out:
+  g_clear_object (&info);
+  g_object_unref (query->info);
+  g_slice_free (LazyQuery, query);
+}
+
+static void
+gtk_directory_list_start_lazy_queries (GtkDirectoryList *self)
+{
+  char *attributes;
+
+  if (self->lazy_queue.length == 0 ||
+      self->n_lazy_queries >= MAX_LAZY_QUERIES)
+    return;
+
+  /* The info gets replaced, so query everything */
+  if (self->attributes)
+    attributes = g_strconcat (self->attributes, ",", self->lazy_attributes, NULL);
+  else
+    attributes = g_strdup (self->lazy_attributes);
+
+  if (self->lazy_cancellable == NULL)
+    self->lazy_cancellable = g_cancellable_new ();
+
+  while (self->lazy_queue.length > 0 &&
+         self->n_lazy_queries < MAX_LAZY_QUERIES)
+    {
+      LazyQuery *query;
+      GFile *file;
+
+      query = g_slice_new (LazyQuery);
+      query->self = self;
+      query->info = g_object_ref (g_queue_pop_head (&self->lazy_queue));
+      file = G_FILE (g_file_info_get_attribute_object (query->info, "standard::file"));
+
+      self->n_lazy_queries++;
+      g_file_query_info_async (file,
+                               attributes,
+                               G_FILE_QUERY_INFO_NONE,
+                               self->io_priority,
+                               self->lazy_cancellable,
+                               gtk_directory_list_got_lazy_info_cb,
+                               query);
+    }
+
+  g_free (attributes);
+}
+
+/* Queries the lazy attributes of the item at iter once */
+static void
+gtk_directory_list_queue_lazy_query (GtkDirectoryList *self,
+                                     GSequenceIter    *iter)
+{
+  GFileInfo *info = g_sequence_get (iter);
+
+  if (g_object_get_qdata (G_OBJECT (info), gtk_directory_list_lazy_quark ()))
+    return;
+
+  g_object_set_qdata (G_OBJECT (info), gtk_directory_list_lazy_quark (), GINT_TO_POINTER (TRUE));
+  g_hash_table_insert (self->lazy_items, info, iter);
+  g_queue_push_tail (&self->lazy_queue, info);
+
+  gtk_directory_list_start_lazy_queries (self);
+}
+
 static void
 got_new_file_info_cb (GObject      *source,
                       GAsyncResult *res,
@@ -533,6 +797,7 @@ got_new_file_info_cb (GObject      *source,
     return;
 
   g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
+  gtk_directory_list_add_new_items (self);
   position = g_sequence_get_length (self->items);
   g_sequence_append (self->items, info);
   g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
@@ -553,6 +818,7 @@ got_existing_file_info_cb (GObject      *source,
     return;
 
   g_file_info_set_attribute_object (info, "standard::file", G_OBJECT (file));
+  gtk_directory_list_add_new_items (self);
 
   for (iter = g_sequence_get_begin_iter (self->items);
        !g_sequence_iter_is_end (iter);
@@ -563,6 +829,7 @@ got_existing_file_info_cb (GObject      *source,
       if (g_file_equal (f, file))
         {
           guint position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_forget_lazy_query (self, iter);
           g_sequence_set (iter, g_object_ref (info));
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 1);
           break;
@@ -576,6 +843,8 @@ gtk_directory_list_remove_file (GtkDirectoryList *self,
 {
   GSequenceIter *iter;
 
+  gtk_directory_list_add_new_items (self);
+
   for (iter = g_sequence_get_begin_iter (self->items);
        !g_sequence_iter_is_end (iter);
        iter = g_sequence_iter_next (iter))
@@ -585,6 +854,7 @@ gtk_directory_list_remove_file (GtkDirectoryList *self,
       if (g_file_equal (f, file))
         {
           guint position = g_sequence_iter_get_position (iter);
+          gtk_directory_list_forget_lazy_query (self, iter);
           g_sequence_remove (iter);
           g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
           break;
@@ -750,6 +1020,63 @@ gtk_directory_list_get_attributes (GtkDirectoryList *self)
   return self->attributes;
 }
 
+/**
+ * gtk_directory_list_set_lazy_attributes:
+ * @self: a #GtkDirectoryList
+ * @attributes: (allow-none): the attributes to query lazily
+ *
+ * Sets attributes that are only queried once a file is requested
+ * from @self via g_list_model_get_item() and starts the enumeration
+ * again.
+ *
+ * Use this for attributes that are expensive to query, like
+ * %G_FILE_ATTRIBUTE_THUMBNAIL_PATH or
+ * %G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE. Once they are available,
+ * the attributes are set on the #GFileInfo of the file and
+ * #GListModel::items-changed is emitted for it. This replaces any
+ * attributes that were set on the #GFileInfo by other code.
+ *
+ * Since: 4.2
+ */
+void
+gtk_directory_list_set_lazy_attributes (GtkDirectoryList *self,
+                                        const char       *attributes)
+{
+  g_return_if_fail (GTK_IS_DIRECTORY_LIST (self));
+
+  if (g_strcmp0 (self->lazy_attributes, attributes) == 0)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  g_free (self->lazy_attributes);
+  self->lazy_attributes = g_strdup (attributes);
+
+  gtk_directory_list_start_loading (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LAZY_ATTRIBUTES]);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gtk_directory_list_get_lazy_attributes:
+ * @self: a #GtkDirectoryList
+ *
+ * Gets the attributes that are only queried for requested files.
+ *
+ * Returns: (nullable) (transfer none): The lazily queried attributes
+ *
+ * Since: 4.2
+ */
+const char *
+gtk_directory_list_get_lazy_attributes (GtkDirectoryList *self)
+{
+  g_return_val_if_fail (GTK_IS_DIRECTORY_LIST (self), NULL);
+
+  return self->lazy_attributes;
+}
+
 /**
  * gtk_directory_list_set_io_priority:
  * @self: a #GtkDirectoryList
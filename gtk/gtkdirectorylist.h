@@ -51,6 +51,11 @@ void                    gtk_directory_list_set_attributes       (GtkDirectoryLis
                                                                  const char             *attributes);
 GDK_AVAILABLE_IN_ALL
 const char *            gtk_directory_list_get_attributes       (GtkDirectoryList       *self);
+GDK_AVAILABLE_IN_4_2
+void                    gtk_directory_list_set_lazy_attributes  (GtkDirectoryList       *self,
+                                                                 const char             *attributes);
+GDK_AVAILABLE_IN_4_2
+const char *            gtk_directory_list_get_lazy_attributes  (GtkDirectoryList       *self);
 GDK_AVAILABLE_IN_ALL
 void                    gtk_directory_list_set_io_priority      (GtkDirectoryList       *self,
                                                                  int                     io_priority);
@@ -23,7 +23,7 @@
  */
 
 #include "config.h"
-#include "gtkdrawingarea.h"
+#include "gtkdrawingareaprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
@@ -39,6 +39,12 @@ struct _GtkDrawingAreaPrivate {
   GtkDrawingAreaDrawFunc draw_func;
   gpointer draw_func_target;
   GDestroyNotify draw_func_target_destroy_notify;
+
+  /* The result of the last call to draw_func, kept until the
+   * contents are invalidated or the size changes */
+  GskRenderNode *content_node;
+  int content_node_width;
+  int content_node_height;
 };
 
 enum {
@@ -129,6 +135,13 @@ static guint signals[LAST_SIGNAL] = { 0, };
  * drawing area’s window using gtk_widget_queue_draw().
  * This will cause the drawing area to call the draw function again.
  *
+ * The result of the draw function is kept until gtk_widget_queue_draw()
+ * is called on the drawing area, its size or style changes, or a new
+ * draw function is set. In particular, the draw function is not called
+ * again when the drawing area is hidden and shown or when other parts
+ * of the window are redrawn, so renderers can also keep the texture
+ * they made from it.
+ *
  * The available routines for drawing are documented on the
  * [GDK Drawing Primitives][gdk4-Cairo-Interaction] page
  * and the cairo documentation.
@@ -204,6 +217,8 @@ gtk_drawing_area_dispose (GObject *object)
   priv->draw_func_target = NULL;
   priv->draw_func_target_destroy_notify = NULL;
 
+  g_clear_pointer (&priv->content_node, gsk_render_node_unref);
+
   G_OBJECT_CLASS (gtk_drawing_area_parent_class)->dispose (object);
 }
 
@@ -253,17 +268,42 @@ gtk_drawing_area_snapshot (GtkWidget   *widget,
   width = gtk_widget_get_width (widget);
   height = gtk_widget_get_height (widget);
 
+  if (priv->content_node &&
+      (priv->content_node_width != width || priv->content_node_height != height))
+    g_clear_pointer (&priv->content_node, gsk_render_node_unref);
+
+  if (priv->content_node == NULL)
+    {
+      priv->content_node = gsk_cairo_node_new (&GRAPHENE_RECT_INIT (0, 0, width, height));
+      priv->content_node_width = width;
+      priv->content_node_height = height;
+
+      cr = gsk_cairo_node_get_draw_context (priv->content_node);
+      priv->draw_func (self,
+                       cr,
+                       width, height,
+                       priv->draw_func_target);
+      cairo_destroy (cr);
+    }
+
+  gtk_snapshot_append_node (snapshot, priv->content_node);
+}
+
+/*< private >
+ * gtk_drawing_area_invalidate_content:
+ * @self: a #GtkDrawingArea
+ *
+ * Drops the contents kept from the last call to the draw
+ * function, so that it is called again on the next snapshot.
+ *
+ * This is called by gtk_widget_queue_draw().
+ */
+void
+gtk_drawing_area_invalidate_content (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
 
-  cr = gtk_snapshot_append_cairo (snapshot,
-                                  &GRAPHENE_RECT_INIT (
-                                      0, 0,
-                                      width, height
-                                  ));
-  priv->draw_func (self,
-                   cr,
-                   width, height,
-                   priv->draw_func_target);
-  cairo_destroy (cr);
+  g_clear_pointer (&priv->content_node, gsk_render_node_unref);
 }
 
 static void
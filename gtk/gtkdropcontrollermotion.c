@@ -208,6 +208,7 @@ gtk_drop_controller_motion_class_init (GtkDropControllerMotionClass *klass)
   object_class->get_property = gtk_drop_controller_motion_get_property;
 
   controller_class->handle_event = gtk_drop_controller_motion_handle_event;
+  controller_class->event_mask = GTK_EVENT_TYPE_MASK (GDK_DRAG_MOTION);
   controller_class->handle_crossing = gtk_drop_controller_motion_handle_crossing;
 
   /**
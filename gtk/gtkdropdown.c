@@ -133,7 +133,17 @@ button_toggled (GtkWidget *widget,
   GtkDropDown *self = data;
 
   if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget)))
-    gtk_popover_popup (GTK_POPOVER (self->popup));
+    {
+      guint selected;
+
+      gtk_popover_popup (GTK_POPOVER (self->popup));
+
+      /* The list is kept around between popups, so only its
+       * scroll position needs to change */
+      selected = gtk_drop_down_get_selected (self);
+      if (selected != GTK_INVALID_LIST_POSITION)
+        gtk_widget_activate_action (self->popup_list, "list.scroll-to-item", "u", selected);
+    }
   else
     gtk_popover_popdown (GTK_POPOVER (self->popup));
 }
@@ -162,7 +172,7 @@ row_activated (GtkListView *listview,
   /* reset the filter so positions are 1-1 */
   filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
   if (GTK_IS_STRING_FILTER (filter))
-    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "");
+    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), NULL);
   gtk_drop_down_set_selected (self, gtk_single_selection_get_selected (GTK_SINGLE_SELECTION (self->popup_selection)));
 }
 
@@ -192,7 +202,7 @@ selection_changed (GtkSingleSelection *selection,
   /* reset the filter so positions are 1-1 */
   filter = gtk_filter_list_model_get_filter (GTK_FILTER_LIST_MODEL (self->filter_model));
   if (GTK_IS_STRING_FILTER (filter))
-    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "");
+    gtk_string_filter_set_search (GTK_STRING_FILTER (filter), NULL);
   gtk_single_selection_set_selected (GTK_SINGLE_SELECTION (self->popup_selection), selected);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SELECTED]);
@@ -381,8 +391,8 @@ gtk_drop_down_size_allocate (GtkWidget *widget,
 
   gtk_widget_size_allocate (self->button, &(GtkAllocation) { 0, 0, width, height }, baseline);
 
+  /* This queues a resize of the popup if the width changed */
   gtk_widget_set_size_request (self->popup, width, -1);
-  gtk_widget_queue_resize (self->popup);
 
   gtk_popover_present (GTK_POPOVER (self->popup));
 }
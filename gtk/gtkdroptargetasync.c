@@ -375,6 +375,10 @@ gtk_drop_target_async_class_init (GtkDropTargetAsyncClass *class)
 
   controller_class->handle_event = gtk_drop_target_async_handle_event;
   controller_class->filter_event = gtk_drop_target_async_filter_event;
+  controller_class->event_mask = GTK_EVENT_TYPE_MASK (GDK_DRAG_ENTER) |
+                                GTK_EVENT_TYPE_MASK (GDK_DRAG_LEAVE) |
+                                GTK_EVENT_TYPE_MASK (GDK_DRAG_MOTION) |
+                                GTK_EVENT_TYPE_MASK (GDK_DROP_START);
   controller_class->handle_crossing = gtk_drop_target_async_handle_crossing;
 
   class->accept = gtk_drop_target_async_accept;
@@ -23,13 +23,21 @@
 #include "gtkbox.h"
 #include "gtkbutton.h"
 #include "gtkcssprovider.h"
+#include "gtkcustomfilter.h"
 #include "gtkentry.h"
-#include "gtkflowboxprivate.h"
+#include "gtkfilterlistmodel.h"
+#include "gtkflattenlistmodel.h"
+#include "gtkflowbox.h"
+#include "gtkgridview.h"
 #include "gtkstack.h"
 #include "gtklabel.h"
+#include "gtklistbaseprivate.h"
+#include "gtklistitem.h"
 #include "gtkgesturelongpress.h"
+#include "gtknoselection.h"
 #include "gtkpopover.h"
 #include "gtkscrolledwindow.h"
+#include "gtksignallistitemfactory.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
 #include "gtksearchentryprivate.h"
@@ -56,6 +64,10 @@
  * popover
  * ├── box.emoji-searchbar
  * │   ╰── entry.search
+ * ├── gridview.emoji-grid
+ * │   ├── child
+ * │   │   ╰── emoji
+ * │   ┊
  * ╰── box.emoji-toolbar
  *     ├── button.image-button.emoji-section
  *     ├── ...
@@ -67,14 +79,224 @@
  * and supposed to inherit general styles.
  * The top searchbar used to search emoji and gets the .emoji-searchbar
  * style class itself.
+ * The emoji are shown in a grid view with the .emoji-grid style class,
+ * with a node named emoji for each of them.
  * The bottom toolbar used to switch between different emoji categories
  * consists of buttons with the .emoji-section style class and gets the
  * .emoji-toolbar style class itself.
  *
  */
 
-#define BOX_SPACE 6
+#define MAX_RECENT (7*3)
+
+typedef enum {
+  EMOJI_UNCHECKED,
+  EMOJI_RENDERABLE,
+  EMOJI_UNRENDERABLE
+} EmojiRenderable;
+
+/* One emoji, with the data from the emoji GVariant and what we
+ * compute from it lazily. The items of the emoji data are created
+ * on demand and kept around, so the checks done when filtering
+ * only happen once per emoji.
+ */
+GType gtk_emoji_item_get_type (void);
+
+#define GTK_TYPE_EMOJI_ITEM (gtk_emoji_item_get_type ())
+
+typedef struct
+{
+  GObject parent;
+
+  GVariant *data;
+  gunichar modifier;
+  int group;
+  char text[64];
+
+  char **name_tokens;
+  guint renderable : 2;
+} GtkEmojiItem;
+
+typedef struct
+{
+  GObjectClass parent_class;
+} GtkEmojiItemClass;
+
+G_DEFINE_TYPE (GtkEmojiItem, gtk_emoji_item, G_TYPE_OBJECT)
+
+static void
+gtk_emoji_item_init (GtkEmojiItem *item)
+{
+}
+
+static void
+gtk_emoji_item_finalize (GObject *object)
+{
+  GtkEmojiItem *item = (GtkEmojiItem *)object;
+
+  g_variant_unref (item->data);
+  g_strfreev (item->name_tokens);
+
+  G_OBJECT_CLASS (gtk_emoji_item_parent_class)->finalize (object);
+}
+
+static void
+gtk_emoji_item_class_init (GtkEmojiItemClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->finalize = gtk_emoji_item_finalize;
+}
+
+static void
+get_emoji_text (GVariant *data,
+                gunichar  modifier,
+                char      text[64])
+{
+  GVariant *codes;
+  char *p = text;
+  int i;
+
+  codes = g_variant_get_child_value (data, 0);
+  for (i = 0; i < g_variant_n_children (codes); i++)
+    {
+      gunichar code;
+
+      g_variant_get_child (codes, i, "u", &code);
+      if (code == 0)
+        code = modifier;
+      if (code != 0)
+        p += g_unichar_to_utf8 (code, p);
+    }
+  g_variant_unref (codes);
+  p += g_unichar_to_utf8 (0xFE0F, p); /* U+FE0F is the Emoji variation selector */
+  p[0] = 0;
+}
+
+static GtkEmojiItem *
+gtk_emoji_item_new (GVariant *data,
+                    gunichar  modifier,
+                    int       group)
+{
+  GtkEmojiItem *item;
+
+  item = g_object_new (GTK_TYPE_EMOJI_ITEM, NULL);
+  item->data = g_variant_ref (data);
+  item->modifier = modifier;
+  item->group = group;
+  get_emoji_text (data, modifier, item->text);
 
+  return item;
+}
+
+/* A list model over the emoji data */
+GType gtk_emoji_list_get_type (void);
+
+#define GTK_TYPE_EMOJI_LIST (gtk_emoji_list_get_type ())
+
+typedef struct
+{
+  GObject parent;
+
+  GVariant *data;
+  guint n_items;
+  GtkEmojiItem **items;
+} GtkEmojiList;
+
+typedef struct
+{
+  GObjectClass parent_class;
+} GtkEmojiListClass;
+
+static GType
+gtk_emoji_list_get_item_type (GListModel *list)
+{
+  return GTK_TYPE_EMOJI_ITEM;
+}
+
+static guint
+gtk_emoji_list_get_n_items (GListModel *list)
+{
+  GtkEmojiList *self = (GtkEmojiList *)list;
+
+  return self->n_items;
+}
+
+static gpointer
+gtk_emoji_list_get_item (GListModel *list,
+                         guint       position)
+{
+  GtkEmojiList *self = (GtkEmojiList *)list;
+
+  if (position >= self->n_items)
+    return NULL;
+
+  if (self->items[position] == NULL)
+    {
+      GVariant *data;
+      guint group;
+
+      data = g_variant_get_child_value (self->data, position);
+      g_variant_get_child (data, 3, "u", &group);
+      self->items[position] = gtk_emoji_item_new (data, 0, group);
+      g_variant_unref (data);
+    }
+
+  return g_object_ref (self->items[position]);
+}
+
+static void
+gtk_emoji_list_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = gtk_emoji_list_get_item_type;
+  iface->get_n_items = gtk_emoji_list_get_n_items;
+  iface->get_item = gtk_emoji_list_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE (GtkEmojiList, gtk_emoji_list, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_emoji_list_model_init))
+
+static void
+gtk_emoji_list_init (GtkEmojiList *self)
+{
+}
+
+static void
+gtk_emoji_list_finalize (GObject *object)
+{
+  GtkEmojiList *self = (GtkEmojiList *)object;
+  guint i;
+
+  for (i = 0; i < self->n_items; i++)
+    g_clear_object (&self->items[i]);
+  g_free (self->items);
+  g_variant_unref (self->data);
+
+  G_OBJECT_CLASS (gtk_emoji_list_parent_class)->finalize (object);
+}
+
+static void
+gtk_emoji_list_class_init (GtkEmojiListClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->finalize = gtk_emoji_list_finalize;
+}
+
+static GListModel *
+gtk_emoji_list_new (GVariant *data)
+{
+  GtkEmojiList *self;
+
+  self = g_object_new (GTK_TYPE_EMOJI_LIST, NULL);
+  self->data = g_variant_ref (data);
+  self->n_items = g_variant_n_children (data);
+  self->items = g_new0 (GtkEmojiItem *, self->n_items);
+
+  return G_LIST_MODEL (self);
+}
+
+/* The children of the flow box in the variations popover */
 GType gtk_emoji_chooser_child_get_type (void);
 
 #define GTK_TYPE_EMOJI_CHOOSER_CHILD (gtk_emoji_chooser_child_get_type ())
@@ -82,7 +304,6 @@ GType gtk_emoji_chooser_child_get_type (void);
 typedef struct
 {
   GtkFlowBoxChild parent;
-  GtkWidget *variations;
 } GtkEmojiChooserChild;
 
 typedef struct
@@ -98,102 +319,123 @@ gtk_emoji_chooser_child_init (GtkEmojiChooserChild *child)
 }
 
 static void
-gtk_emoji_chooser_child_dispose (GObject *object)
+gtk_emoji_chooser_child_class_init (GtkEmojiChooserChildClass *class)
 {
-  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)object;
-
-  g_clear_pointer (&child->variations, gtk_widget_unparent);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (class);
 
-  G_OBJECT_CLASS (gtk_emoji_chooser_child_parent_class)->dispose (object);
+  gtk_widget_class_set_css_name (widget_class, "emoji");
 }
 
+/* The cells of the grid view */
+GType gtk_emoji_cell_get_type (void);
+
+#define GTK_TYPE_EMOJI_CELL (gtk_emoji_cell_get_type ())
+#define GTK_IS_EMOJI_CELL(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_EMOJI_CELL))
+
+typedef struct
+{
+  GtkWidget parent;
+
+  GtkWidget *label;
+  GtkWidget *variations;
+  GtkEmojiItem *item;
+} GtkEmojiCell;
+
+typedef struct
+{
+  GtkWidgetClass parent_class;
+} GtkEmojiCellClass;
+
+G_DEFINE_TYPE (GtkEmojiCell, gtk_emoji_cell, GTK_TYPE_WIDGET)
+
 static void
-gtk_emoji_chooser_child_size_allocate (GtkWidget *widget,
-                                       int        width,
-                                       int        height,
-                                       int        baseline)
+gtk_emoji_cell_init (GtkEmojiCell *cell)
 {
-  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)widget;
+  PangoAttrList *attrs;
 
-  GTK_WIDGET_CLASS (gtk_emoji_chooser_child_parent_class)->size_allocate (widget, width, height, baseline);
-  if (child->variations)
-    gtk_popover_present (GTK_POPOVER (child->variations));
+  cell->label = gtk_label_new (NULL);
+  attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
+  gtk_label_set_attributes (GTK_LABEL (cell->label), attrs);
+  pango_attr_list_unref (attrs);
+  gtk_widget_set_parent (cell->label, GTK_WIDGET (cell));
 }
 
-static gboolean
-gtk_emoji_chooser_child_focus (GtkWidget        *widget,
-                               GtkDirectionType  direction)
+static void
+gtk_emoji_cell_dispose (GObject *object)
 {
-  GtkEmojiChooserChild *child = (GtkEmojiChooserChild *)widget;
+  GtkEmojiCell *cell = (GtkEmojiCell *)object;
 
-  if (child->variations && gtk_widget_is_visible (child->variations))
-    {
-      if (gtk_widget_child_focus (child->variations, direction))
-        return TRUE;
-    }
+  g_clear_pointer (&cell->variations, gtk_widget_unparent);
+  g_clear_pointer (&cell->label, gtk_widget_unparent);
+  g_clear_object (&cell->item);
 
-  return GTK_WIDGET_CLASS (gtk_emoji_chooser_child_parent_class)->focus (widget, direction);
+  G_OBJECT_CLASS (gtk_emoji_cell_parent_class)->dispose (object);
 }
 
-static void scroll_to_child (GtkWidget *child);
-
-static gboolean
-gtk_emoji_chooser_child_grab_focus (GtkWidget *widget)
+static void
+gtk_emoji_cell_measure (GtkWidget      *widget,
+                        GtkOrientation  orientation,
+                        int             for_size,
+                        int            *minimum,
+                        int            *natural,
+                        int            *minimum_baseline,
+                        int            *natural_baseline)
 {
-  gtk_widget_grab_focus_self (widget);
-  scroll_to_child (widget);
-  return TRUE;
-}
+  GtkEmojiCell *cell = (GtkEmojiCell *)widget;
 
-static void show_variations (GtkEmojiChooser *chooser,
-                             GtkWidget       *child);
+  gtk_widget_measure (cell->label, orientation, for_size,
+                      minimum, natural,
+                      minimum_baseline, natural_baseline);
+}
 
 static void
-gtk_emoji_chooser_child_popup_menu (GtkWidget  *widget,
-                                    const char *action_name,
-                                    GVariant   *parameters)
+gtk_emoji_cell_size_allocate (GtkWidget *widget,
+                              int        width,
+                              int        height,
+                              int        baseline)
 {
-  GtkWidget *chooser;
+  GtkEmojiCell *cell = (GtkEmojiCell *)widget;
 
-  chooser = gtk_widget_get_ancestor (widget, GTK_TYPE_EMOJI_CHOOSER);
-
-  show_variations (GTK_EMOJI_CHOOSER (chooser), widget);
+  gtk_widget_size_allocate (cell->label,
+                            &(GtkAllocation) { 0, 0, width, height },
+                            baseline);
+  if (cell->variations)
+    gtk_popover_present (GTK_POPOVER (cell->variations));
 }
 
 static void
-gtk_emoji_chooser_child_class_init (GtkEmojiChooserChildClass *class)
+gtk_emoji_cell_class_init (GtkEmojiCellClass *class)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (class);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (class);
 
-  object_class->dispose = gtk_emoji_chooser_child_dispose;
-  widget_class->size_allocate = gtk_emoji_chooser_child_size_allocate;
-  widget_class->focus = gtk_emoji_chooser_child_focus;
-  widget_class->grab_focus = gtk_emoji_chooser_child_grab_focus;
+  object_class->dispose = gtk_emoji_cell_dispose;
+  widget_class->measure = gtk_emoji_cell_measure;
+  widget_class->size_allocate = gtk_emoji_cell_size_allocate;
 
-  gtk_widget_class_install_action (widget_class, "menu.popup", NULL, gtk_emoji_chooser_child_popup_menu);
+  gtk_widget_class_set_css_name (widget_class, "emoji");
+}
 
-  gtk_widget_class_add_binding_action (widget_class,
-                                       GDK_KEY_F10, GDK_SHIFT_MASK,
-                                       "menu.popup",
-                                       NULL);
-  gtk_widget_class_add_binding_action (widget_class,
-                                       GDK_KEY_Menu, 0,
-                                       "menu.popup",
-                                       NULL);
+static void
+gtk_emoji_cell_set_item (GtkEmojiCell *cell,
+                         GtkEmojiItem *item)
+{
+  g_clear_pointer (&cell->variations, gtk_widget_unparent);
 
-  gtk_widget_class_set_css_name (widget_class, "emoji");
+  if (!g_set_object (&cell->item, item))
+    return;
+
+  gtk_label_set_label (GTK_LABEL (cell->label), item ? item->text : "");
 }
 
 typedef struct {
-  GtkWidget *box;
-  GtkWidget *heading;
   GtkWidget *button;
   int group;
-  gunichar label;
-  gboolean empty;
 } EmojiSection;
 
+#define N_SECTIONS 10
+
 struct _GtkEmojiChooser
 {
   GtkPopover parent_instance;
@@ -201,8 +443,10 @@ struct _GtkEmojiChooser
   GtkWidget *search_entry;
   GtkWidget *stack;
   GtkWidget *scrolled_window;
+  GtkWidget *grid;
 
   int emoji_max_width;
+  PangoLayout *layout;
 
   EmojiSection recent;
   EmojiSection people;
@@ -215,10 +459,15 @@ struct _GtkEmojiChooser
   EmojiSection symbols;
   EmojiSection flags;
 
-  GVariant *data;
-  GtkWidget *box;
-  GVariantIter *iter;
-  guint populate_idle;
+  /* in display order */
+  EmojiSection *sections[N_SECTIONS];
+
+  GListStore *recent_items;
+  GtkFilter *filter;
+  GtkFilterListModel *filter_model;
+
+  char *search_text;
+  char **search_tokens;
 
   GSettings *settings;
 };
@@ -241,65 +490,121 @@ gtk_emoji_chooser_finalize (GObject *object)
 {
   GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (object);
 
-  if (chooser->populate_idle)
-    g_source_remove (chooser->populate_idle);
-
-  g_clear_pointer (&chooser->data, g_variant_unref);
+  g_clear_object (&chooser->filter_model);
+  g_clear_object (&chooser->recent_items);
+  g_clear_object (&chooser->layout);
+  g_clear_pointer (&chooser->search_text, g_free);
+  g_clear_pointer (&chooser->search_tokens, g_strfreev);
   g_clear_object (&chooser->settings);
 
   G_OBJECT_CLASS (gtk_emoji_chooser_parent_class)->finalize (object);
 }
 
-static void
-scroll_to_section (EmojiSection *section)
+static EmojiSection *
+get_section_for_item (GtkEmojiChooser *chooser,
+                      GtkEmojiItem    *item)
 {
-  GtkEmojiChooser *chooser;
-  GtkAdjustment *adj;
-  GtkAllocation alloc = { 0, 0, 0, 0 };
+  int i;
 
-  chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (section->box, GTK_TYPE_EMOJI_CHOOSER));
+  /* Groups without a section of their own, like the skin tone
+   * components, belong to the section before them
+   */
+  for (i = N_SECTIONS - 1; i > 0; i--)
+    {
+      if (chooser->sections[i]->group <= item->group)
+        break;
+    }
 
-  adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
-  if (section->heading)
-    gtk_widget_get_allocation (section->heading, &alloc);
-  gtk_adjustment_animate_to_value (adj, alloc.y - BOX_SPACE);
+  return chooser->sections[i];
 }
 
-static void
-scroll_to_child (GtkWidget *child)
+static guint
+get_section_position (GtkEmojiChooser *chooser,
+                      EmojiSection    *section)
 {
-  GtkEmojiChooser *chooser;
-  GtkAdjustment *adj;
-  GtkAllocation alloc;
-  double pos;
-  double value;
-  double page_size;
+  GListModel *model = G_LIST_MODEL (chooser->filter_model);
+  guint i, n_items;
 
-  chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (child, GTK_TYPE_EMOJI_CHOOSER));
+  n_items = g_list_model_get_n_items (model);
+  for (i = 0; i < n_items; i++)
+    {
+      GtkEmojiItem *item = g_list_model_get_item (model, i);
+      EmojiSection *item_section = get_section_for_item (chooser, item);
+
+      g_object_unref (item);
+
+      if (item_section == section)
+        return i;
+    }
+
+  return GTK_INVALID_LIST_POSITION;
+}
+
+static EmojiSection *
+get_current_section (GtkEmojiChooser *chooser)
+{
+  GtkAdjustment *adj;
+  GtkEmojiItem *item;
+  EmojiSection *section;
+  guint pos;
 
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
 
-  gtk_widget_get_allocation (child, &alloc);
+  if (!GTK_LIST_BASE_GET_CLASS (chooser->grid)->get_position_from_allocation (GTK_LIST_BASE (chooser->grid),
+                                                                               0,
+                                                                               gtk_adjustment_get_value (adj),
+                                                                               &pos,
+                                                                               NULL))
+    return NULL;
 
-  value = gtk_adjustment_get_value (adj);
-  page_size = gtk_adjustment_get_page_size (adj);
+  item = g_list_model_get_item (G_LIST_MODEL (chooser->filter_model), pos);
+  if (item == NULL)
+    return NULL;
 
-  gtk_widget_translate_coordinates (child, gtk_widget_get_parent (chooser->recent.box), 0, 0, NULL, &pos);
+  section = get_section_for_item (chooser, item);
+  g_object_unref (item);
 
-  if (pos < value)
-    gtk_adjustment_animate_to_value (adj, pos);
-  else if (pos + alloc.height >= value + page_size)
-    gtk_adjustment_animate_to_value (adj, value + ((pos + alloc.height) - (value + page_size)));
+  return section;
+}
+
+static gboolean
+scroll_to_section (GtkEmojiChooser *chooser,
+                   EmojiSection    *section,
+                   gboolean         grab_focus)
+{
+  guint pos;
+
+  pos = get_section_position (chooser, section);
+  if (pos == GTK_INVALID_LIST_POSITION)
+    return FALSE;
+
+  gtk_list_base_set_anchor (GTK_LIST_BASE (chooser->grid),
+                            pos,
+                            0.0, GTK_PACK_START,
+                            0.0, GTK_PACK_START);
+
+  if (grab_focus)
+    gtk_list_base_grab_focus_on_item (GTK_LIST_BASE (chooser->grid), pos, FALSE, FALSE, FALSE);
+
+  return TRUE;
 }
 
 static void
-add_emoji (GtkWidget    *box,
-           gboolean      prepend,
-           GVariant     *item,
-           gunichar      modifier,
-           GtkEmojiChooser *chooser);
+section_clicked (GtkButton *button,
+                 gpointer   data)
+{
+  GtkEmojiChooser *chooser = data;
+  int i;
 
-#define MAX_RECENT (7*3)
+  for (i = 0; i < N_SECTIONS; i++)
+    {
+      if (chooser->sections[i]->button == GTK_WIDGET (button))
+        {
+          scroll_to_section (chooser, chooser->sections[i], FALSE);
+          break;
+        }
+    }
+}
 
 static void
 populate_recent_section (GtkEmojiChooser *chooser)
@@ -307,7 +612,6 @@ populate_recent_section (GtkEmojiChooser *chooser)
   GVariant *variant;
   GVariant *item;
   GVariantIter iter;
-  gboolean empty = FALSE;
 
   variant = g_settings_get_value (chooser->settings, "recent-emoji");
   g_variant_iter_init (&iter, variant);
@@ -315,17 +619,19 @@ populate_recent_section (GtkEmojiChooser *chooser)
     {
       GVariant *emoji_data;
       gunichar modifier;
+      GtkEmojiItem *recent;
 
       emoji_data = g_variant_get_child_value (item, 0);
       g_variant_get_child (item, 1, "u", &modifier);
-      add_emoji (chooser->recent.box, FALSE, emoji_data, modifier, chooser);
+      recent = gtk_emoji_item_new (emoji_data, modifier, chooser->recent.group);
+      g_list_store_append (chooser->recent_items, recent);
+      g_object_unref (recent);
       g_variant_unref (emoji_data);
       g_variant_unref (item);
-      empty = FALSE;
     }
 
-  gtk_widget_set_visible (chooser->recent.box, !empty);
-  gtk_widget_set_sensitive (chooser->recent.button, !empty);
+  gtk_widget_set_sensitive (chooser->recent.button,
+                            g_list_model_get_n_items (G_LIST_MODEL (chooser->recent_items)) > 0);
 
   g_variant_unref (variant);
 }
@@ -335,47 +641,40 @@ add_recent_item (GtkEmojiChooser *chooser,
                  GVariant        *item,
                  gunichar         modifier)
 {
-  GList *children, *l;
-  int i;
+  GListModel *recent = G_LIST_MODEL (chooser->recent_items);
+  GtkEmojiItem *items[MAX_RECENT];
   GVariantBuilder builder;
-  GtkWidget *child;
+  guint i, n, n_items;
 
   g_variant_ref (item);
 
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("a((ausasu)u)"));
   g_variant_builder_add (&builder, "(@(ausasu)u)", item, modifier);
 
-  children = NULL;
-  for (child = gtk_widget_get_last_child (chooser->recent.box);
-       child != NULL;
-       child = gtk_widget_get_prev_sibling (child))
-    children = g_list_prepend (children, child);
+  items[0] = gtk_emoji_item_new (item, modifier, chooser->recent.group);
+  n = 1;
 
-  for (l = children, i = 1; l; l = l->next, i++)
+  n_items = g_list_model_get_n_items (recent);
+  for (i = 0; i < n_items && n < MAX_RECENT; i++)
     {
-      GVariant *item2 = g_object_get_data (G_OBJECT (l->data), "emoji-data");
-      gunichar modifier2 = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (l->data), "modifier"));
+      GtkEmojiItem *item2 = g_list_model_get_item (recent, i);
 
-      if (modifier == modifier2 && g_variant_equal (item, item2))
+      if (modifier == item2->modifier && g_variant_equal (item, item2->data))
         {
-          gtk_flow_box_remove (GTK_FLOW_BOX (chooser->recent.box), l->data);
-          i--;
-          continue;
-        }
-      if (i >= MAX_RECENT)
-        {
-          gtk_flow_box_remove (GTK_FLOW_BOX (chooser->recent.box), l->data);
+          g_object_unref (item2);
           continue;
         }
 
-      g_variant_builder_add (&builder, "(@(ausasu)u)", item2, modifier2);
+      g_variant_builder_add (&builder, "(@(ausasu)u)", item2->data, item2->modifier);
+      items[n++] = item2;
     }
-  g_list_free (children);
 
-  add_emoji (chooser->recent.box, TRUE, item, modifier, chooser);
+  g_list_store_splice (chooser->recent_items, 0, n_items, (gpointer *) items, n);
+
+  for (i = 0; i < n; i++)
+    g_object_unref (items[i]);
 
   /* Enable recent */
-  gtk_widget_show (chooser->recent.box);
   gtk_widget_set_sensitive (chooser->recent.button, TRUE);
 
   g_settings_set_value (chooser->settings, "recent-emoji", g_variant_builder_end (&builder));
@@ -399,6 +698,27 @@ should_close (GtkEmojiChooser *chooser)
   return (state & GDK_CONTROL_MASK) == 0;
 }
 
+static void
+emoji_grid_activated (GtkGridView *grid,
+                      guint        position,
+                      gpointer     data)
+{
+  GtkEmojiChooser *chooser = data;
+  GtkEmojiItem *item;
+
+  item = g_list_model_get_item (G_LIST_MODEL (chooser->filter_model), position);
+  if (item == NULL)
+    return;
+
+  if (should_close (chooser))
+    gtk_popover_popdown (GTK_POPOVER (chooser));
+
+  add_recent_item (chooser, item->data, item->modifier);
+
+  g_signal_emit (chooser, signals[EMOJI_PICKED], 0, item->text);
+  g_object_unref (item);
+}
+
 static void
 emoji_activated (GtkFlowBox      *box,
                  GtkFlowBoxChild *child,
@@ -456,33 +776,71 @@ has_variations (GVariant *emoji_data)
   return has_variations;
 }
 
+static void
+add_emoji (GtkWidget       *box,
+           GVariant        *item,
+           gunichar         modifier,
+           GtkEmojiChooser *chooser)
+{
+  GtkWidget *child;
+  GtkWidget *label;
+  PangoAttrList *attrs;
+  char text[64];
+  PangoLayout *layout;
+  PangoRectangle rect;
+
+  get_emoji_text (item, modifier, text);
+
+  label = gtk_label_new (text);
+  attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
+  gtk_label_set_attributes (GTK_LABEL (label), attrs);
+  pango_attr_list_unref (attrs);
+
+  layout = gtk_label_get_layout (GTK_LABEL (label));
+  pango_layout_get_extents (layout, &rect, NULL);
+
+  /* Check for fallback rendering that generates too wide items */
+  if (pango_layout_get_unknown_glyphs_count (layout) > 0 ||
+      rect.width >= 1.5 * chooser->emoji_max_width)
+    {
+      g_object_ref_sink (label);
+      g_object_unref (label);
+      return;
+    }
+
+  child = g_object_new (GTK_TYPE_EMOJI_CHOOSER_CHILD, NULL);
+  g_object_set_data_full (G_OBJECT (child), "emoji-data",
+                          g_variant_ref (item),
+                          (GDestroyNotify)g_variant_unref);
+  if (modifier != 0)
+    g_object_set_data (G_OBJECT (child), "modifier", GUINT_TO_POINTER (modifier));
+
+  gtk_flow_box_child_set_child (GTK_FLOW_BOX_CHILD (child), label);
+  gtk_flow_box_insert (GTK_FLOW_BOX (box), child, -1);
+}
+
 static void
 show_variations (GtkEmojiChooser *chooser,
-                 GtkWidget       *child)
+                 GtkEmojiCell    *cell)
 {
   GtkWidget *popover;
   GtkWidget *view;
   GtkWidget *box;
   GVariant *emoji_data;
-  GtkWidget *parent_popover;
   gunichar modifier;
-  GtkEmojiChooserChild *ch = (GtkEmojiChooserChild *)child;
-
-  if (!child)
-    return;
 
-  emoji_data = (GVariant*) g_object_get_data (G_OBJECT (child), "emoji-data");
-  if (!emoji_data)
+  if (!cell || !cell->item)
     return;
 
+  emoji_data = cell->item->data;
   if (!has_variations (emoji_data))
     return;
 
-  parent_popover = gtk_widget_get_ancestor (child, GTK_TYPE_POPOVER);
-  g_clear_pointer (&ch->variations, gtk_widget_unparent);
-  popover = ch->variations = gtk_popover_new ();
+  g_clear_pointer (&cell->variations, gtk_widget_unparent);
+  popover = cell->variations = gtk_popover_new ();
   gtk_popover_set_autohide (GTK_POPOVER (popover), TRUE);
-  gtk_widget_set_parent (popover, child);
+  gtk_widget_set_parent (popover, GTK_WIDGET (cell));
   view = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
   gtk_widget_add_css_class (view, "view");
   box = gtk_flow_box_new ();
@@ -495,15 +853,32 @@ show_variations (GtkEmojiChooser *chooser,
   gtk_popover_set_child (GTK_POPOVER (popover), view);
   gtk_box_append (GTK_BOX (view), box);
 
-  g_signal_connect (box, "child-activated", G_CALLBACK (emoji_activated), parent_popover);
+  g_signal_connect (box, "child-activated", G_CALLBACK (emoji_activated), chooser);
 
-  add_emoji (box, FALSE, emoji_data, 0, chooser);
+  add_emoji (box, emoji_data, 0, chooser);
   for (modifier = 0x1f3fb; modifier <= 0x1f3ff; modifier++)
-    add_emoji (box, FALSE, emoji_data, modifier, chooser);
+    add_emoji (box, emoji_data, modifier, chooser);
 
   gtk_popover_popup (GTK_POPOVER (popover));
 }
 
+static GtkEmojiCell *
+get_cell_at (GtkWidget *grid,
+             double     x,
+             double     y)
+{
+  GtkWidget *picked;
+
+  picked = gtk_widget_pick (grid, x, y, GTK_PICK_DEFAULT);
+  if (picked == NULL)
+    return NULL;
+
+  if (GTK_IS_EMOJI_CELL (picked))
+    return (GtkEmojiCell *) picked;
+
+  return (GtkEmojiCell *) gtk_widget_get_ancestor (picked, GTK_TYPE_EMOJI_CELL);
+}
+
 static void
 long_pressed_cb (GtkGesture *gesture,
                  double      x,
@@ -511,12 +886,8 @@ long_pressed_cb (GtkGesture *gesture,
                  gpointer    data)
 {
   GtkEmojiChooser *chooser = data;
-  GtkWidget *box;
-  GtkWidget *child;
 
-  box = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture));
-  child = GTK_WIDGET (gtk_flow_box_get_child_at_pos (GTK_FLOW_BOX (box), x, y));
-  show_variations (chooser, child);
+  show_variations (chooser, get_cell_at (chooser->grid, x, y));
 }
 
 static void
@@ -527,73 +898,36 @@ pressed_cb (GtkGesture *gesture,
             gpointer    data)
 {
   GtkEmojiChooser *chooser = data;
-  GtkWidget *box;
-  GtkWidget *child;
 
-  box = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (gesture));
-  child = GTK_WIDGET (gtk_flow_box_get_child_at_pos (GTK_FLOW_BOX (box), x, y));
-  show_variations (chooser, child);
+  show_variations (chooser, get_cell_at (chooser->grid, x, y));
 }
 
 static void
-add_emoji (GtkWidget    *box,
-           gboolean      prepend,
-           GVariant     *item,
-           gunichar      modifier,
-           GtkEmojiChooser *chooser)
+setup_emoji_cell (GtkSignalListItemFactory *factory,
+                  GtkListItem              *list_item,
+                  gpointer                  data)
 {
-  GtkWidget *child;
-  GtkWidget *label;
-  PangoAttrList *attrs;
-  GVariant *codes;
-  char text[64];
-  char *p = text;
-  int i;
-  PangoLayout *layout;
-  PangoRectangle rect;
-
-  codes = g_variant_get_child_value (item, 0);
-  for (i = 0; i < g_variant_n_children (codes); i++)
-    {
-      gunichar code;
-
-      g_variant_get_child (codes, i, "u", &code);
-      if (code == 0)
-        code = modifier;
-      if (code != 0)
-        p += g_unichar_to_utf8 (code, p);
-    }
-  g_variant_unref (codes);
-  p += g_unichar_to_utf8 (0xFE0F, p); /* U+FE0F is the Emoji variation selector */
-  p[0] = 0;
-
-  label = gtk_label_new (text);
-  attrs = pango_attr_list_new ();
-  pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
-  gtk_label_set_attributes (GTK_LABEL (label), attrs);
-  pango_attr_list_unref (attrs);
+  gtk_list_item_set_child (list_item, g_object_new (GTK_TYPE_EMOJI_CELL, NULL));
+}
 
-  layout = gtk_label_get_layout (GTK_LABEL (label));
-  pango_layout_get_extents (layout, &rect, NULL);
+static void
+bind_emoji_cell (GtkSignalListItemFactory *factory,
+                 GtkListItem              *list_item,
+                 gpointer                  data)
+{
+  GtkEmojiCell *cell = (GtkEmojiCell *) gtk_list_item_get_child (list_item);
 
-  /* Check for fallback rendering that generates too wide items */
-  if (pango_layout_get_unknown_glyphs_count (layout) > 0 ||
-      rect.width >= 1.5 * chooser->emoji_max_width)
-    {
-      g_object_ref_sink (label);
-      g_object_unref (label);
-      return;
-    }
+  gtk_emoji_cell_set_item (cell, gtk_list_item_get_item (list_item));
+}
 
-  child = g_object_new (GTK_TYPE_EMOJI_CHOOSER_CHILD, NULL);
-  g_object_set_data_full (G_OBJECT (child), "emoji-data",
-                          g_variant_ref (item),
-                          (GDestroyNotify)g_variant_unref);
-  if (modifier != 0)
-    g_object_set_data (G_OBJECT (child), "modifier", GUINT_TO_POINTER (modifier));
+static void
+unbind_emoji_cell (GtkSignalListItemFactory *factory,
+                   GtkListItem              *list_item,
+                   gpointer                  data)
+{
+  GtkEmojiCell *cell = (GtkEmojiCell *) gtk_list_item_get_child (list_item);
 
-  gtk_flow_box_child_set_child (GTK_FLOW_BOX_CHILD (child), label);
-  gtk_flow_box_insert (GTK_FLOW_BOX (box), child, prepend ? 0 : -1);
+  gtk_emoji_cell_set_item (cell, NULL);
 }
 
 GBytes *
@@ -669,122 +1003,23 @@ get_emoji_data (void)
   return g_resources_lookup_data ("/org/gtk/libgtk/emoji/en.data", 0, NULL);
 }
 
-static gboolean
-populate_emoji_chooser (gpointer data)
-{
-  GtkEmojiChooser *chooser = data;
-  GVariant *item;
-  gint64 start, now;
-
-  start = g_get_monotonic_time ();
-
-  if (!chooser->data)
-    {
-      GBytes *bytes;
-
-      bytes = get_emoji_data ();
-
-      chooser->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(ausasu)"), bytes, TRUE));
-      g_bytes_unref (bytes);
-    }
-
-  if (!chooser->iter)
-    {
-      chooser->iter = g_variant_iter_new (chooser->data);
-      chooser->box = chooser->people.box;
-    }
-
-  while ((item = g_variant_iter_next_value (chooser->iter)))
-    {
-      guint group;
-
-      g_variant_get_child (item, 3, "u", &group);
-
-      if (group == chooser->people.group)
-        chooser->box = chooser->people.box;
-      else if (group == chooser->body.group)
-        chooser->box = chooser->body.box;
-      else if (group == chooser->nature.group)
-        chooser->box = chooser->nature.box;
-      else if (group == chooser->food.group)
-        chooser->box = chooser->food.box;
-      else if (group == chooser->travel.group)
-        chooser->box = chooser->travel.box;
-      else if (group == chooser->activities.group)
-        chooser->box = chooser->activities.box;
-      else if (group == chooser->objects.group)
-        chooser->box = chooser->objects.box;
-      else if (group == chooser->symbols.group)
-        chooser->box = chooser->symbols.box;
-      else if (group == chooser->flags.group)
-        chooser->box = chooser->flags.box;
-
-      add_emoji (chooser->box, FALSE, item, 0, chooser);
-      g_variant_unref (item);
-
-      now = g_get_monotonic_time ();
-      if (now > start + 200) /* 2 ms */
-        {
-          gdk_profiler_add_mark (start * 1000, (now - start) * 1000, "emojichooser", "populate");
-          return G_SOURCE_CONTINUE;
-        }
-    }
-
-  g_variant_iter_free (chooser->iter);
-  chooser->iter = NULL;
-  chooser->box = NULL;
-  chooser->populate_idle = 0;
-
-  gdk_profiler_end_mark (start, "emojichooser", "populate (finish)");
-
-  return G_SOURCE_REMOVE;
-}
-
 static void
 adj_value_changed (GtkAdjustment *adj,
                    gpointer       data)
 {
   GtkEmojiChooser *chooser = data;
-  double value = gtk_adjustment_get_value (adj);
-  EmojiSection const *sections[] = {
-    &chooser->recent,
-    &chooser->people,
-    &chooser->body,
-    &chooser->nature,
-    &chooser->food,
-    &chooser->travel,
-    &chooser->activities,
-    &chooser->objects,
-    &chooser->symbols,
-    &chooser->flags,
-  };
-  EmojiSection const *select_section = sections[0];
-  gsize i;
+  EmojiSection *select_section;
+  int i;
 
   /* Figure out which section the current scroll position is within */
-  for (i = 0; i < G_N_ELEMENTS (sections); ++i)
-    {
-      EmojiSection const *section = sections[i];
-      GtkAllocation alloc;
-
-      if (!gtk_widget_get_visible (section->box))
-        continue;
-
-      if (section->heading)
-        gtk_widget_get_allocation (section->heading, &alloc);
-      else
-        gtk_widget_get_allocation (section->box, &alloc);
-
-      if (value < alloc.y - BOX_SPACE)
-        break;
-
-      select_section = section;
-    }
+  select_section = get_current_section (chooser);
+  if (select_section == NULL)
+    select_section = chooser->sections[0];
 
   /* Un/Check the section buttons accordingly */
-  for (i = 0; i < G_N_ELEMENTS (sections); ++i)
+  for (i = 0; i < N_SECTIONS; i++)
     {
-      EmojiSection const *section = sections[i];
+      EmojiSection *section = chooser->sections[i];
 
       if (section == select_section)
         gtk_widget_set_state_flags (section->button, GTK_STATE_FLAG_CHECKED, FALSE);
@@ -819,84 +1054,65 @@ one_matched:
 }
 
 static gboolean
-filter_func (GtkFlowBoxChild *child,
-             gpointer         data)
+is_renderable (GtkEmojiChooser *chooser,
+               GtkEmojiItem    *item)
 {
-  EmojiSection *section = data;
-  GtkEmojiChooser *chooser;
-  GVariant *emoji_data;
-  const char *text;
-  const char *name;
+  if (item->renderable == EMOJI_UNCHECKED)
+    {
+      PangoRectangle rect;
+
+      pango_layout_set_text (chooser->layout, item->text, -1);
+      pango_layout_get_extents (chooser->layout, &rect, NULL);
+
+      /* Check for fallback rendering that generates too wide items */
+      if (pango_layout_get_unknown_glyphs_count (chooser->layout) > 0 ||
+          rect.width >= 1.5 * chooser->emoji_max_width)
+        item->renderable = EMOJI_UNRENDERABLE;
+      else
+        item->renderable = EMOJI_RENDERABLE;
+    }
+
+  return item->renderable == EMOJI_RENDERABLE;
+}
+
+static gboolean
+filter_func (gpointer item_,
+             gpointer data)
+{
+  GtkEmojiChooser *chooser = data;
+  GtkEmojiItem *item = item_;
   const char **keywords;
-  char **term_tokens;
-  char **name_tokens;
   gboolean res;
 
-  res = TRUE;
-
-  chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (GTK_WIDGET (child), GTK_TYPE_EMOJI_CHOOSER));
-  text = gtk_editable_get_text (GTK_EDITABLE (chooser->search_entry));
-  emoji_data = (GVariant *) g_object_get_data (G_OBJECT (child), "emoji-data");
+  if (!is_renderable (chooser, item))
+    return FALSE;
 
-  if (text[0] == 0)
-    goto out;
+  if (chooser->search_tokens == NULL)
+    return TRUE;
 
-  if (!emoji_data)
-    goto out;
+  if (item->name_tokens == NULL)
+    {
+      const char *name;
 
-  term_tokens = g_str_tokenize_and_fold (text, "en", NULL);
-  
-  g_variant_get_child (emoji_data, 1, "&s", &name);
-  name_tokens = g_str_tokenize_and_fold (name, "en", NULL);
-  g_variant_get_child (emoji_data, 2, "^a&s", &keywords);
+      g_variant_get_child (item->data, 1, "&s", &name);
+      item->name_tokens = g_str_tokenize_and_fold (name, "en", NULL);
+    }
 
-  res = match_tokens ((const char **)term_tokens, (const char **)name_tokens) ||
-        match_tokens ((const char **)term_tokens, keywords);
+  g_variant_get_child (item->data, 2, "^a&s", &keywords);
 
-  g_strfreev (term_tokens);
-  g_strfreev (name_tokens);
+  res = match_tokens ((const char **)chooser->search_tokens, (const char **)item->name_tokens) ||
+        match_tokens ((const char **)chooser->search_tokens, keywords);
 
-out:
-  if (res)
-    section->empty = FALSE;
+  g_free (keywords);
 
   return res;
 }
 
 static void
-invalidate_section (EmojiSection *section)
+update_empty (GtkEmojiChooser *chooser)
 {
-  section->empty = TRUE;
-  gtk_flow_box_invalidate_filter (GTK_FLOW_BOX (section->box));
-}
-
-static void
-update_headings (GtkEmojiChooser *chooser)
-{
-  gtk_widget_set_visible (chooser->people.heading, !chooser->people.empty);
-  gtk_widget_set_visible (chooser->people.box, !chooser->people.empty);
-  gtk_widget_set_visible (chooser->body.heading, !chooser->body.empty);
-  gtk_widget_set_visible (chooser->body.box, !chooser->body.empty);
-  gtk_widget_set_visible (chooser->nature.heading, !chooser->nature.empty);
-  gtk_widget_set_visible (chooser->nature.box, !chooser->nature.empty);
-  gtk_widget_set_visible (chooser->food.heading, !chooser->food.empty);
-  gtk_widget_set_visible (chooser->food.box, !chooser->food.empty);
-  gtk_widget_set_visible (chooser->travel.heading, !chooser->travel.empty);
-  gtk_widget_set_visible (chooser->travel.box, !chooser->travel.empty);
-  gtk_widget_set_visible (chooser->activities.heading, !chooser->activities.empty);
-  gtk_widget_set_visible (chooser->activities.box, !chooser->activities.empty);
-  gtk_widget_set_visible (chooser->objects.heading, !chooser->objects.empty);
-  gtk_widget_set_visible (chooser->objects.box, !chooser->objects.empty);
-  gtk_widget_set_visible (chooser->symbols.heading, !chooser->symbols.empty);
-  gtk_widget_set_visible (chooser->symbols.box, !chooser->symbols.empty);
-  gtk_widget_set_visible (chooser->flags.heading, !chooser->flags.empty);
-  gtk_widget_set_visible (chooser->flags.box, !chooser->flags.empty);
-
-  if (chooser->recent.empty && chooser->people.empty &&
-      chooser->body.empty && chooser->nature.empty &&
-      chooser->food.empty && chooser->travel.empty &&
-      chooser->activities.empty && chooser->objects.empty &&
-      chooser->symbols.empty && chooser->flags.empty)
+  if (g_list_model_get_n_items (G_LIST_MODEL (chooser->filter_model)) == 0 &&
+      gtk_filter_list_model_get_pending (chooser->filter_model) == 0)
     gtk_stack_set_visible_child_name (GTK_STACK (chooser->stack), "empty");
   else
     gtk_stack_set_visible_child_name (GTK_STACK (chooser->stack), "list");
@@ -907,19 +1123,36 @@ search_changed (GtkEntry *entry,
                 gpointer  data)
 {
   GtkEmojiChooser *chooser = data;
+  const char *text;
+  GtkFilterChange change;
+
+  text = gtk_editable_get_text (GTK_EDITABLE (entry));
+  if (text[0] == 0)
+    text = NULL;
 
-  invalidate_section (&chooser->recent);
-  invalidate_section (&chooser->people);
-  invalidate_section (&chooser->body);
-  invalidate_section (&chooser->nature);
-  invalidate_section (&chooser->food);
-  invalidate_section (&chooser->travel);
-  invalidate_section (&chooser->activities);
-  invalidate_section (&chooser->objects);
-  invalidate_section (&chooser->symbols);
-  invalidate_section (&chooser->flags);
-
-  update_headings (chooser);
+  if (g_strcmp0 (text, chooser->search_text) == 0)
+    return;
+
+  /* Extending the search only ever removes matches, and
+   * shortening it only ever adds some
+   */
+  if (chooser->search_text == NULL ||
+      (text != NULL && g_str_has_prefix (text, chooser->search_text)))
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (text == NULL || g_str_has_prefix (chooser->search_text, text))
+    change = GTK_FILTER_CHANGE_LESS_STRICT;
+  else
+    change = GTK_FILTER_CHANGE_DIFFERENT;
+
+  g_clear_pointer (&chooser->search_tokens, g_strfreev);
+  g_free (chooser->search_text);
+
+  chooser->search_text = g_strdup (text);
+  if (text)
+    chooser->search_tokens = g_str_tokenize_and_fold (text, "en", NULL);
+
+  gtk_filter_changed (chooser->filter, change);
+  update_empty (chooser);
 }
 
 static void
@@ -935,20 +1168,33 @@ setup_section (GtkEmojiChooser *chooser,
                int              group,
                const char      *icon)
 {
+  int i;
+
   section->group = group;
 
+  for (i = 0; chooser->sections[i] != NULL; i++)
+    g_assert (i + 1 < N_SECTIONS);
+  chooser->sections[i] = section;
+
   gtk_button_set_icon_name (GTK_BUTTON (section->button), icon);
 
-  gtk_flow_box_disable_move_cursor (GTK_FLOW_BOX (section->box));
-  gtk_flow_box_set_filter_func (GTK_FLOW_BOX (section->box), filter_func, section, NULL);
-  g_signal_connect_swapped (section->button, "clicked", G_CALLBACK (scroll_to_section), section);
+  g_signal_connect (section->button, "clicked", G_CALLBACK (section_clicked), chooser);
 }
 
 static void
 gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
 {
+  GtkListItemFactory *factory;
+  GListStore *models;
+  GListModel *emoji_list;
+  GtkSelectionModel *selection;
   GtkAdjustment *adj;
   GtkText *text;
+  GBytes *bytes;
+  GVariant *data;
+  gint64 start;
+
+  start = GDK_PROFILER_CURRENT_TIME;
 
   chooser->settings = g_settings_new ("org.gtk.gtk4.Settings.EmojiChooser");
 
@@ -963,19 +1209,18 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
    * as multiply glyphs.
    */
   {
-    PangoLayout *layout = gtk_widget_create_pango_layout (GTK_WIDGET (chooser), "🙂");
     PangoAttrList *attrs;
     PangoRectangle rect;
 
+    chooser->layout = gtk_widget_create_pango_layout (GTK_WIDGET (chooser), "🙂");
+
     attrs = pango_attr_list_new ();
     pango_attr_list_insert (attrs, pango_attr_scale_new (PANGO_SCALE_X_LARGE));
-    pango_layout_set_attributes (layout, attrs);
+    pango_layout_set_attributes (chooser->layout, attrs);
     pango_attr_list_unref (attrs);
 
-    pango_layout_get_extents (layout, &rect, NULL);
+    pango_layout_get_extents (chooser->layout, &rect, NULL);
     chooser->emoji_max_width = rect.width;
-
-    g_object_unref (layout);
   }
 
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
@@ -992,10 +1237,43 @@ gtk_emoji_chooser_init (GtkEmojiChooser *chooser)
   setup_section (chooser, &chooser->symbols, 8, "emoji-symbols-symbolic");
   setup_section (chooser, &chooser->flags, 9, "emoji-flags-symbolic");
 
+  chooser->recent_items = g_list_store_new (GTK_TYPE_EMOJI_ITEM);
   populate_recent_section (chooser);
 
-  chooser->populate_idle = g_idle_add (populate_emoji_chooser, chooser);
-  g_source_set_name_by_id (chooser->populate_idle, "[gtk] populate_emoji_chooser");
+  /* The emoji data is mapped from a resource, so this is cheap.
+   * Only the rows that are on screen get widgets, and the filter
+   * model works through the rest of the emoji in idle chunks.
+   */
+  bytes = get_emoji_data ();
+  data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(ausasu)"), bytes, TRUE));
+  emoji_list = gtk_emoji_list_new (data);
+  g_variant_unref (data);
+  g_bytes_unref (bytes);
+
+  models = g_list_store_new (G_TYPE_LIST_MODEL);
+  g_list_store_append (models, chooser->recent_items);
+  g_list_store_append (models, emoji_list);
+  g_object_unref (emoji_list);
+
+  chooser->filter = GTK_FILTER (gtk_custom_filter_new (filter_func, chooser, NULL));
+  chooser->filter_model = gtk_filter_list_model_new (G_LIST_MODEL (gtk_flatten_list_model_new (G_LIST_MODEL (models))),
+                                                     chooser->filter);
+  gtk_filter_list_model_set_incremental (chooser->filter_model, TRUE);
+  g_signal_connect_swapped (chooser->filter_model, "items-changed", G_CALLBACK (update_empty), chooser);
+  g_signal_connect_swapped (chooser->filter_model, "notify::pending", G_CALLBACK (update_empty), chooser);
+
+  selection = GTK_SELECTION_MODEL (gtk_no_selection_new (g_object_ref (G_LIST_MODEL (chooser->filter_model))));
+  gtk_grid_view_set_model (GTK_GRID_VIEW (chooser->grid), selection);
+  g_object_unref (selection);
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_emoji_cell), chooser);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_emoji_cell), chooser);
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_emoji_cell), chooser);
+  gtk_grid_view_set_factory (GTK_GRID_VIEW (chooser->grid), factory);
+  g_object_unref (factory);
+
+  gdk_profiler_end_mark (start, "emojichooser", "init");
 }
 
 static void
@@ -1013,135 +1291,52 @@ gtk_emoji_chooser_show (GtkWidget *widget)
   gtk_editable_set_text (GTK_EDITABLE (chooser->search_entry), "");
 }
 
-static EmojiSection *
-find_next_section (GtkEmojiChooser *chooser,
-                   GtkWidget       *box,
-                   gboolean         down)
-{
-  EmojiSection *next;
-
-  if (box == chooser->recent.box)
-    next = down ? &chooser->people : NULL;
-  else if (box == chooser->people.box)
-    next = down ? &chooser->body : &chooser->recent;
-  else if (box == chooser->body.box)
-    next = down ? &chooser->nature : &chooser->people;
-  else if (box == chooser->nature.box)
-    next = down ? &chooser->food : &chooser->body;
-  else if (box == chooser->food.box)
-    next = down ? &chooser->travel : &chooser->nature;
-  else if (box == chooser->travel.box)
-    next = down ? &chooser->activities : &chooser->food;
-  else if (box == chooser->activities.box)
-    next = down ? &chooser->objects : &chooser->travel;
-  else if (box == chooser->objects.box)
-    next = down ? &chooser->symbols : &chooser->activities;
-  else if (box == chooser->symbols.box)
-    next = down ? &chooser->flags : &chooser->objects;
-  else if (box == chooser->flags.box)
-    next = down ? NULL : &chooser->symbols;
-  else
-    next = NULL;
-
-  return next;
-}
-
 static void
 gtk_emoji_chooser_scroll_section (GtkWidget  *widget,
                                   const char *action_name,
                                   GVariant   *parameter)
 {
   GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
-  int direction = g_variant_get_int32 (parameter);
-  GtkWidget *focus;
-  GtkWidget *box;
-  EmojiSection *next;
+  int direction = g_variant_get_int32 (parameter) > 0 ? 1 : -1;
+  EmojiSection *current;
+  int i;
 
-  focus = gtk_root_get_focus (gtk_widget_get_root (widget));
-  if (focus == NULL)
-    return;
+  current = get_current_section (chooser);
 
-  if (gtk_widget_is_ancestor (focus, chooser->search_entry))
-    box = chooser->recent.box;
-  else
-    box = gtk_widget_get_ancestor (focus, GTK_TYPE_FLOW_BOX);
+  for (i = 0; i < N_SECTIONS; i++)
+    {
+      if (chooser->sections[i] == current)
+        break;
+    }
 
-  next = find_next_section (chooser, box, direction > 0);
+  if (i == N_SECTIONS)
+    i = direction > 0 ? -1 : N_SECTIONS;
 
-  if (next)
+  /* Skip the sections that have nothing in them */
+  for (i += direction; i >= 0 && i < N_SECTIONS; i += direction)
     {
-      gtk_widget_child_focus (next->box, GTK_DIR_TAB_FORWARD);
-      scroll_to_section (next);
+      if (scroll_to_section (chooser, chooser->sections[i], TRUE))
+        break;
     }
 }
 
-static gboolean
-keynav_failed (GtkWidget        *box,
-               GtkDirectionType  direction,
-               GtkEmojiChooser  *chooser)
+static void
+gtk_emoji_chooser_popup_menu (GtkWidget  *widget,
+                              const char *action_name,
+                              GVariant   *parameters)
 {
-  EmojiSection *next;
-  GtkWidget *focus; 
-  GtkWidget *child;
-  GtkWidget *sibling;
-  int i;
-  int column;
-
-  focus = gtk_root_get_focus (gtk_widget_get_root (box));
-  if (focus == NULL)
-    return FALSE;
-
-  child = gtk_widget_get_ancestor (focus, GTK_TYPE_EMOJI_CHOOSER_CHILD);
-
-  i = 0;
-  for (sibling = gtk_widget_get_first_child (box);
-       sibling != child;
-       sibling = gtk_widget_get_next_sibling (sibling))
-    i++;
-
-  column = i % 7;
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
+  GtkWidget *focus;
+  GtkWidget *cell;
 
-  if (direction == GTK_DIR_DOWN)
-    {
-      next = find_next_section (chooser, box, TRUE);
-      if (next == NULL)
-        return FALSE;
-
-      i = 0;
-      for (sibling = gtk_widget_get_first_child (next->box);
-           sibling;
-           sibling = gtk_widget_get_next_sibling (sibling), i++)
-        {
-          if (i == column)
-            {
-              gtk_widget_grab_focus (sibling);
-              return TRUE;
-            }
-        }
-    }
-  else if (direction == GTK_DIR_UP)
-    {
-      next = find_next_section (chooser, box, FALSE);
-      if (next == NULL)
-        return FALSE;
-
-      i = 0;
-      child = NULL;
-      for (sibling = gtk_widget_get_first_child (next->box);
-           sibling;
-           sibling = gtk_widget_get_next_sibling (sibling), i++)
-        {
-          if ((i % 7) == column)
-            child = sibling;
-        }
-      if (child)
-        {
-          gtk_widget_grab_focus (child);
-          return TRUE;
-        }
-    }
+  focus = gtk_root_get_focus (gtk_widget_get_root (widget));
+  if (focus == NULL || !gtk_widget_is_ancestor (focus, chooser->grid))
+    return;
 
-  return FALSE;
+  /* The focus is on the list item widget holding the cell */
+  cell = gtk_widget_get_first_child (focus);
+  if (cell && GTK_IS_EMOJI_CELL (cell))
+    show_variations (chooser, (GtkEmojiCell *) cell);
 }
 
 static void
@@ -1185,52 +1380,24 @@ gtk_emoji_chooser_class_init (GtkEmojiChooserClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, search_entry);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, stack);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, scrolled_window);
+  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, grid);
 
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, recent.box);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, recent.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, people.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, people.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, people.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, body.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, body.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, body.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, nature.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, nature.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, nature.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, food.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, food.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, food.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, travel.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, travel.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, travel.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, activities.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, activities.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, activities.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, objects.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, objects.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, objects.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, symbols.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, symbols.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, symbols.button);
-
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, flags.box);
-  gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, flags.heading);
   gtk_widget_class_bind_template_child (widget_class, GtkEmojiChooser, flags.button);
 
-  gtk_widget_class_bind_template_callback (widget_class, emoji_activated);
+  gtk_widget_class_bind_template_callback (widget_class, emoji_grid_activated);
   gtk_widget_class_bind_template_callback (widget_class, search_changed);
   gtk_widget_class_bind_template_callback (widget_class, stop_search);
   gtk_widget_class_bind_template_callback (widget_class, pressed_cb);
   gtk_widget_class_bind_template_callback (widget_class, long_pressed_cb);
-  gtk_widget_class_bind_template_callback (widget_class, keynav_failed);
 
   /**
    * GtkEmojiChooser|scroll.section:
@@ -1245,6 +1412,18 @@ gtk_emoji_chooser_class_init (GtkEmojiChooserClass *klass)
                                        "scroll.section", "i", 1);
   gtk_widget_class_add_binding_action (widget_class, GDK_KEY_p, GDK_CONTROL_MASK,
                                        "scroll.section", "i", -1);
+
+  gtk_widget_class_install_action (widget_class, "menu.popup", NULL,
+                                   gtk_emoji_chooser_popup_menu);
+
+  gtk_widget_class_add_binding_action (widget_class,
+                                       GDK_KEY_F10, GDK_SHIFT_MASK,
+                                       "menu.popup",
+                                       NULL);
+  gtk_widget_class_add_binding_action (widget_class,
+                                       GDK_KEY_Menu, 0,
+                                       "menu.popup",
+                                       NULL);
 }
 
 /**
@@ -361,6 +361,7 @@ gtk_entry_accessible_interface_init (GtkAccessibleInterface *iface)
 {
   GtkAccessibleInterface *parent_iface = g_type_interface_peek_parent (iface);
   iface->get_at_context = parent_iface->get_at_context;
+  iface->peek_at_context = parent_iface->peek_at_context;
   iface->get_platform_state = gtk_entry_accessible_get_platform_state;
 }
 
@@ -663,6 +663,7 @@ gtk_entry_completion_finalize (GObject *object)
 
   g_free (completion->case_normalized_key);
   g_free (completion->completion_prefix);
+  g_clear_pointer (&completion->case_normalized_items, g_hash_table_unref);
 
   if (completion->match_notify)
     (* completion->match_notify) (completion->match_data);
@@ -708,6 +709,7 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
   char *item = NULL;
   char *normalized_string;
   char *case_normalized_string;
+  gpointer cached;
 
   gboolean ret = FALSE;
 
@@ -722,22 +724,37 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
                       completion->text_column, &item,
                       -1);
 
-  if (item != NULL)
+  if (item == NULL)
+    return FALSE;
+
+  /* Normalizing is expensive and the same rows get matched against
+   * every key that is typed, so keep the result around. Entries are
+   * keyed by the text of the row, so changed rows never use stale ones.
+   */
+  if (completion->case_normalized_items == NULL)
+    completion->case_normalized_items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  if (g_hash_table_lookup_extended (completion->case_normalized_items, item, NULL, &cached))
+    {
+      case_normalized_string = cached;
+      g_free (item);
+    }
+  else
     {
       normalized_string = g_utf8_normalize (item, -1, G_NORMALIZE_ALL);
 
       if (normalized_string != NULL)
-        {
-          case_normalized_string = g_utf8_casefold (normalized_string, -1);
-
-          if (!strncmp (key, case_normalized_string, strlen (key)))
-            ret = TRUE;
-
-          g_free (case_normalized_string);
-        }
+        case_normalized_string = g_utf8_casefold (normalized_string, -1);
+      else
+        case_normalized_string = NULL;
       g_free (normalized_string);
+
+      g_hash_table_insert (completion->case_normalized_items, item, case_normalized_string);
     }
-  g_free (item);
+
+  if (case_normalized_string != NULL &&
+      !strncmp (key, case_normalized_string, completion->case_normalized_key_len))
+    ret = TRUE;
 
   return ret;
 }
@@ -880,6 +897,8 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
   g_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
 
+  g_clear_pointer (&completion->case_normalized_items, g_hash_table_unref);
+
   if (!model)
     {
       gtk_tree_view_set_model (GTK_TREE_VIEW (completion->tree_view),
@@ -1022,6 +1041,7 @@ gtk_entry_completion_complete (GtkEntryCompletion *completion)
   tmp = g_utf8_normalize (gtk_editable_get_text (GTK_EDITABLE (completion->entry)),
                           -1, G_NORMALIZE_ALL);
   completion->case_normalized_key = g_utf8_casefold (tmp, -1);
+  completion->case_normalized_key_len = strlen (completion->case_normalized_key);
   g_free (tmp);
 
   gtk_tree_model_filter_refilter (completion->filter_model);
@@ -51,6 +51,9 @@ struct _GtkEntryCompletion
   int text_column;
 
   char *case_normalized_key;
+  gsize case_normalized_key_len;
+  /* text of a row -> its case normalized version, for the default match */
+  GHashTable *case_normalized_items;
 
   GtkEventController *entry_key_controller;
   GtkEventController *entry_focus_controller;
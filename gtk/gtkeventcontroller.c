@@ -183,6 +183,9 @@ gtk_event_controller_class_init (GtkEventControllerClass *klass)
   klass->filter_event = gtk_event_controller_filter_event_default;
   klass->handle_event = gtk_event_controller_handle_event_default;
   klass->handle_crossing = gtk_event_controller_handle_crossing_default;
+  /* event_mask has a bit for every event type */
+  G_STATIC_ASSERT (GDK_EVENT_LAST <= 32);
+  klass->event_mask = GTK_ALL_EVENT_TYPES_MASK;
 
   object_class->finalize = gtk_event_controller_finalize;
   object_class->set_property = gtk_event_controller_set_property;
@@ -491,6 +494,9 @@ gtk_event_controller_set_propagation_phase (GtkEventController  *controller,
   if (phase == GTK_PHASE_NONE)
     gtk_event_controller_reset (controller);
 
+  if (priv->widget)
+    gtk_widget_controllers_changed (priv->widget);
+
   g_object_notify_by_pspec (G_OBJECT (controller), properties[PROP_PROPAGATION_PHASE]);
 }
 
@@ -181,6 +181,8 @@ gtk_event_controller_focus_class_init (GtkEventControllerFocusClass *klass)
   object_class->finalize = gtk_event_controller_focus_finalize;
   object_class->get_property = gtk_event_controller_focus_get_property;
   controller_class->handle_crossing = gtk_event_controller_focus_handle_crossing;
+  /* Focus changes only arrive as crossings */
+  controller_class->event_mask = 0;
 
   /**
    * GtkEventControllerFocus:is-focus:
@@ -114,9 +114,18 @@ struct _GtkEventControllerClass
   gboolean (* filter_event) (GtkEventController *controller,
                              GdkEvent           *event);
 
+  /* The event types that handle_event may do anything with,
+   * see GTK_EVENT_TYPE_MASK(). Widgets don't run controllers
+   * for other event types.
+   */
+  guint event_mask;
+
   gpointer padding[10];
 };
 
+#define GTK_EVENT_TYPE_MASK(type) (1u << (type))
+#define GTK_ALL_EVENT_TYPES_MASK ((1u << GDK_EVENT_LAST) - 1)
+
 GtkWidget * gtk_event_controller_get_target (GtkEventController *controller);
 
 
@@ -362,6 +362,7 @@ gtk_event_controller_scroll_class_init (GtkEventControllerScrollClass *klass)
   object_class->get_property = gtk_event_controller_scroll_get_property;
 
   controller_class->handle_event = gtk_event_controller_scroll_handle_event;
+  controller_class->event_mask = GTK_EVENT_TYPE_MASK (GDK_SCROLL);
 
   /**
    * GtkEventControllerScroll:flags:
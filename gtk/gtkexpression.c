@@ -20,7 +20,7 @@
 
 #include "config.h"
 
-#include "gtkexpression.h"
+#include "gtkexpressionprivate.h"
 
 #include <gobject/gvaluecollector.h>
 
@@ -226,6 +226,7 @@ struct _GtkExpressionWatch
   GDestroyNotify         user_destroy;
   GtkExpressionNotify    notify;
   gpointer               user_data;
+  guint                  queued : 1;
   guchar                 sub[0];
 };
 
@@ -1820,6 +1821,12 @@ gtk_expression_watch_this_cb (gpointer data,
   gtk_expression_watch_unwatch (watch);
 }
 
+/* Watches that changed while watches were frozen, in the order they
+ * changed first
+ */
+static guint watch_freeze_count;
+static GPtrArray *queued_watches;
+
 static void
 gtk_expression_watch_cb (gpointer data)
 {
@@ -1828,9 +1835,71 @@ gtk_expression_watch_cb (gpointer data)
   if (!gtk_expression_watch_is_watching (watch))
     return;
 
+  if (watch_freeze_count > 0)
+    {
+      if (!watch->queued)
+        {
+          watch->queued = TRUE;
+          if (queued_watches == NULL)
+            queued_watches = g_ptr_array_new ();
+          g_ptr_array_add (queued_watches, gtk_expression_watch_ref (watch));
+        }
+      return;
+    }
+
   watch->notify (watch->user_data);
 }
 
+/*< private >
+ * gtk_expression_watch_freeze:
+ *
+ * Holds back the notifications of all watches until
+ * gtk_expression_watch_thaw() is called.
+ *
+ * This is useful when many objects change in one go. A watch
+ * whose expression changes several times is only notified once,
+ * so it only needs to evaluate its expression once.
+ */
+void
+gtk_expression_watch_freeze (void)
+{
+  watch_freeze_count++;
+}
+
+/*< private >
+ * gtk_expression_watch_thaw:
+ *
+ * Reverts the effect of a previous call to gtk_expression_watch_freeze()
+ * and notifies the watches whose expression changed in the meantime.
+ */
+void
+gtk_expression_watch_thaw (void)
+{
+  GPtrArray *watches;
+  guint i;
+
+  g_return_if_fail (watch_freeze_count > 0);
+
+  watch_freeze_count--;
+  if (watch_freeze_count > 0 || queued_watches == NULL)
+    return;
+
+  watches = queued_watches;
+  queued_watches = NULL;
+
+  for (i = 0; i < watches->len; i++)
+    {
+      GtkExpressionWatch *watch = g_ptr_array_index (watches, i);
+
+      watch->queued = FALSE;
+      if (gtk_expression_watch_is_watching (watch))
+        watch->notify (watch->user_data);
+      gtk_expression_watch_unref (watch);
+    }
+
+  g_ptr_array_unref (watches);
+}
+
 /**
  * gtk_expression_watch:
  * @self: a #GtkExpression
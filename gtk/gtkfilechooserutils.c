@@ -22,6 +22,7 @@
 #include "gtkfilechooser.h"
 #include "gtktypebuiltins.h"
 #include "gtkintl.h"
+#include "gtkthumbnailloaderprivate.h"
 
 
 static gboolean       delegate_set_current_folder     (GtkFileChooser    *chooser,
@@ -457,11 +458,12 @@ _gtk_file_info_get_icon (GFileInfo *info,
 
   thumbnail_path = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
 
+  /* Thumbnails are only used once they have been loaded,
+   * see gtk_thumbnail_loader_load_async()
+   */
   if (thumbnail_path)
     {
-      pixbuf = gdk_pixbuf_new_from_file_at_size (thumbnail_path,
-                                                 icon_size*scale, icon_size*scale,
-                                                 NULL);
+      pixbuf = gtk_thumbnail_loader_lookup (thumbnail_path, icon_size * scale);
 
       if (pixbuf != NULL)
         return G_ICON (pixbuf);
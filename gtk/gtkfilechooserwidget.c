@@ -88,6 +88,7 @@
 #include "gtkshortcutaction.h"
 #include "gtkshortcut.h"
 #include "gtkstringlist.h"
+#include "gtkthumbnailloaderprivate.h"
 
 #include <cairo-gobject.h>
 
@@ -4297,6 +4298,77 @@ file_system_model_got_thumbnail (GObject      *object,
   g_object_unref (queried);
 }
 
+typedef struct {
+  GtkFileSystemModel *model; /* might be unreffed if operation was cancelled */
+  GFile *file;
+} ThumbnailRequest;
+
+static void
+file_system_model_loaded_thumbnail (GObject      *object,
+                                    GAsyncResult *res,
+                                    gpointer      data)
+{
+  ThumbnailRequest *request = data;
+  GdkPixbuf *pixbuf;
+  GFileInfo *info;
+  GtkTreeIter iter;
+
+  pixbuf = gtk_thumbnail_loader_load_finish (res, NULL);
+
+  /* now we know model is valid, and that the thumbnail is cached */
+  if (pixbuf != NULL &&
+      _gtk_file_system_model_get_iter_for_file (request->model, &iter, request->file))
+    {
+      /* Updating the file drops the cached icon, so the row
+       * picks up the thumbnail the next time it is drawn
+       */
+      info = g_file_info_dup (_gtk_file_system_model_get_info (request->model, &iter));
+      _gtk_file_system_model_update_file (request->model, request->file, info);
+      g_object_unref (info);
+    }
+
+  g_clear_object (&pixbuf);
+  g_object_unref (request->file);
+  g_slice_free (ThumbnailRequest, request);
+}
+
+static GIcon *
+file_system_model_get_icon (GtkFileChooserWidget *impl,
+                            GtkFileSystemModel   *model,
+                            GFile                *file,
+                            GFileInfo            *info)
+{
+  int scale = gtk_widget_get_scale_factor (GTK_WIDGET (impl));
+  const char *thumbnail_path;
+  ThumbnailRequest *request;
+  GIcon *icon;
+
+  icon = _gtk_file_info_get_icon (info, ICON_SIZE, scale);
+
+  /* A pixbuf means we got the thumbnail already. Otherwise
+   * show the regular icon until the thumbnail is loaded.
+   */
+  thumbnail_path = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
+  if (thumbnail_path == NULL ||
+      GDK_IS_PIXBUF (icon) ||
+      g_file_info_get_attribute_boolean (info, "filechooser::thumbnail-requested"))
+    return icon;
+
+  g_file_info_set_attribute_boolean (info, "filechooser::thumbnail-requested", TRUE);
+
+  request = g_slice_new (ThumbnailRequest);
+  request->model = model;
+  request->file = g_object_ref (file);
+
+  gtk_thumbnail_loader_load_async (thumbnail_path,
+                                   ICON_SIZE * scale,
+                                   _gtk_file_system_model_get_cancellable (model),
+                                   file_system_model_loaded_thumbnail,
+                                   request);
+
+  return icon;
+}
+
 /* Copied from src/nautilus_file.c:get_description() */
 struct {
   const char *icon_name;
@@ -4451,7 +4523,7 @@ file_system_model_set (GtkFileSystemModel *model,
         {
           if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
             {
-              g_value_take_object (value, _gtk_file_info_get_icon (info, ICON_SIZE, gtk_widget_get_scale_factor (GTK_WIDGET (impl))));
+              g_value_take_object (value, file_system_model_get_icon (impl, model, file, info));
             }
           else
             {
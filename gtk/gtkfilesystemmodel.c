@@ -160,6 +160,7 @@ struct _GtkFileSystemModel
   GArray *              files;          /* array of FileModelNode containing all our files */
   gsize                 node_size;	/* Size of a FileModelNode structure once its ->values field has n_columns */
   guint                 n_nodes_valid;  /* count of valid nodes (i.e. those whose node->row is accurate) */
+  guint                 n_nodes_sorted; /* count of leading nodes known to be in sort order, including the editable row */
   GHashTable *          file_lookup;    /* mapping of GFile => array index in model->files
 					 * This hash table doesn't always have the same number of entries as the files array;
 					 * it can get cleared completely when we resort.
@@ -718,6 +719,48 @@ compare_array_element (gconstpointer a, gconstpointer b, gpointer user_data)
   return data->func (GTK_TREE_MODEL (data->model), &itera, &iterb, data->data) * data->order;
 }
 
+/* Merges the sorted runs [1, mid) and [mid, len) of the files array.
+ * Elements are compared in place, as the sort functions look them up
+ * by their index in the array.
+ */
+static void
+merge_sorted_nodes (GtkFileSystemModel *model,
+                    SortData           *data,
+                    guint               mid)
+{
+  gsize size = model->node_size;
+  char *a = (char *) get_node (model, 1);
+  char *a_end = (char *) get_node (model, mid);
+  char *b = a_end;
+  char *b_end = (char *) get_node (model, model->files->len);
+  char *tmp, *out;
+
+  tmp = out = g_malloc (b_end - a);
+
+  while (a < a_end && b < b_end)
+    {
+      if (compare_array_element (a, b, data) <= 0)
+        {
+          memcpy (out, a, size);
+          a += size;
+        }
+      else
+        {
+          memcpy (out, b, size);
+          b += size;
+        }
+      out += size;
+    }
+
+  memcpy (out, a, a_end - a);
+  out += a_end - a;
+  memcpy (out, b, b_end - b);
+  out += b_end - b;
+
+  memcpy (get_node (model, 1), tmp, out - tmp);
+  g_free (tmp);
+}
+
 static void
 gtk_file_system_model_sort (GtkFileSystemModel *model)
 {
@@ -729,21 +772,37 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
       return;
     }
 
+  /* Nothing was added or changed since we last sorted */
+  if (model->n_nodes_sorted >= model->files->len)
+    {
+      model->sort_on_thaw = FALSE;
+      return;
+    }
+
   if (sort_data_init (&data, model))
     {
       GtkTreePath *path;
       guint i;
       guint r, n_visible_rows;
+      guint n_sorted;
 
       node_validate_rows (model, G_MAXUINT, G_MAXUINT);
       n_visible_rows = node_get_tree_row (model, model->files->len - 1) + 1;
       model->n_nodes_valid = 0;
       g_hash_table_remove_all (model->file_lookup);
-      g_qsort_with_data (get_node (model, 1), /* start at index 1; don't sort the editable row */
-                         model->files->len - 1,
+
+      /* While loading a folder, files get appended in batches. Only
+       * sort the new ones and merge them into the already sorted
+       * ones, instead of sorting everything again for each batch.
+       */
+      n_sorted = MAX (model->n_nodes_sorted, 1); /* don't sort the editable row */
+      g_qsort_with_data (get_node (model, n_sorted),
+                         model->files->len - n_sorted,
                          model->node_size,
                          compare_array_element,
                          &data);
+      if (n_sorted > 1)
+        merge_sorted_nodes (model, &data, n_sorted);
       g_assert (model->n_nodes_valid == 0);
       g_assert (g_hash_table_size (model->file_lookup) == 0);
       if (n_visible_rows)
@@ -775,13 +834,24 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
         }
     }
 
+  model->n_nodes_sorted = model->files->len;
   model->sort_on_thaw = FALSE;
 }
 
+static void
+gtk_file_system_model_resort (GtkFileSystemModel *model)
+{
+  model->n_nodes_sorted = 0;
+  gtk_file_system_model_sort (model);
+}
+
 static void
 gtk_file_system_model_sort_node (GtkFileSystemModel *model, guint node)
 {
-  /* FIXME: improve */
+  /* A node that was already sorted may have changed its sort key */
+  if (node < model->n_nodes_sorted)
+    model->n_nodes_sorted = 0;
+
   gtk_file_system_model_sort (model);
 }
 
@@ -842,7 +912,7 @@ gtk_file_system_model_set_sort_column_id (GtkTreeSortable  *sortable,
 
   gtk_tree_sortable_sort_column_changed (sortable);
 
-  gtk_file_system_model_sort (model);
+  gtk_file_system_model_resort (model);
 }
 
 static void
@@ -859,7 +929,7 @@ gtk_file_system_model_set_sort_func (GtkTreeSortable        *sortable,
                                                      func, data, destroy);
 
   if (model->sort_column_id == sort_column_id)
-    gtk_file_system_model_sort (model);
+    gtk_file_system_model_resort (model);
 }
 
 static void
@@ -883,7 +953,7 @@ gtk_file_system_model_set_default_sort_func (GtkTreeSortable        *sortable,
   model->default_sort_destroy = destroy;
 
   if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
-    gtk_file_system_model_sort (model);
+    gtk_file_system_model_resort (model);
 }
 
 static gboolean
@@ -1860,6 +1930,8 @@ remove_file (GtkFileSystemModel *model,
     g_object_unref (node->info);
 
   g_array_remove_index (model->files, id);
+  if (id < model->n_nodes_sorted)
+    model->n_nodes_sorted--;
 
   /* We don't need to resort, as removing a row doesn't change the sorting order of the other rows */
 
@@ -1910,6 +1982,10 @@ _gtk_file_system_model_update_file (GtkFileSystemModel *model,
         g_value_unset (&node->values[i]);
     }
 
+  /* The new info may sort differently */
+  if (id < model->n_nodes_sorted)
+    model->n_nodes_sorted = 0;
+
   if (node->visible)
     emit_row_changed_for_node (model, id);
 }
@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkfilter.h"
+#include "gtkfilterprivate.h"
 
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
@@ -180,3 +180,92 @@ gtk_filter_changed (GtkFilter       *self,
   g_signal_emit (self, signals[CHANGED], 0, change);
 }
 
+
+static GQuark
+gtk_filter_prepared_match_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gtk-filter-prepared-match");
+
+  return quark;
+}
+
+/*<private>
+ * gtk_filter_class_set_prepared_match:
+ * @filter_class: a #GtkFilterClass
+ * @prepared_match: (transfer none): static functions to match items in
+ *     two steps
+ *
+ * Declares that filters of exactly this type can be matched via
+ * @prepared_match, see #GtkFilterPreparedMatch. Subclasses need
+ * to set their own.
+ */
+void
+gtk_filter_class_set_prepared_match (GtkFilterClass               *filter_class,
+                                     const GtkFilterPreparedMatch *prepared_match)
+{
+  g_type_set_qdata (G_TYPE_FROM_CLASS (filter_class),
+                    gtk_filter_prepared_match_quark (),
+                    (gpointer) prepared_match);
+}
+
+const GtkFilterPreparedMatch *
+gtk_filter_get_prepared_match (GtkFilter *self)
+{
+  g_return_val_if_fail (GTK_IS_FILTER (self), NULL);
+
+  return g_type_get_qdata (G_OBJECT_TYPE (self), gtk_filter_prepared_match_quark ());
+}
+
+static GQuark
+gtk_filter_state_func_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gtk-filter-state-func");
+
+  return quark;
+}
+
+/*<private>
+ * gtk_filter_class_set_state_func:
+ * @filter_class: a #GtkFilterClass
+ * @state_func: function to describe the state of the filter
+ *
+ * Declares that filters of exactly this type can describe what
+ * they match with a string, see #GtkFilterStateFunc.
+ */
+void
+gtk_filter_class_set_state_func (GtkFilterClass     *filter_class,
+                                 GtkFilterStateFunc  state_func)
+{
+  g_type_set_qdata (G_TYPE_FROM_CLASS (filter_class),
+                    gtk_filter_state_func_quark (),
+                    state_func);
+}
+
+/*<private>
+ * gtk_filter_get_state:
+ * @self: a #GtkFilter
+ *
+ * Gets a string describing what @self currently matches.
+ *
+ * Returns: (transfer full) (nullable): the state or %NULL if
+ *     the filter can't describe it
+ */
+char *
+gtk_filter_get_state (GtkFilter *self)
+{
+  GtkFilterStateFunc state_func;
+
+  g_return_val_if_fail (GTK_IS_FILTER (self), NULL);
+
+  state_func = g_type_get_qdata (G_OBJECT_TYPE (self), gtk_filter_state_func_quark ());
+  if (state_func == NULL)
+    return NULL;
+
+  return state_func (self);
+}
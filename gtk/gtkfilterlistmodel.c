@@ -22,6 +22,8 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
+#include "gtkidleschedulerprivate.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
 
@@ -62,8 +64,23 @@ struct _GtkFilterListModel
   GtkBitset *matches; /* NULL if strictness != GTK_FILTER_MATCH_SOME */
   GtkBitset *pending; /* not yet filtered items or NULL if all filtered */
   guint pending_cb; /* idle callback handle */
+
+  char *state; /* gtk_filter_get_state() for matches or NULL */
+  GQueue history; /* of MatchesHistory, most recent first */
 };
 
+/* When the filter can describe its state, the matches for the last
+ * few states are kept, so that going back to one of them - like
+ * deleting the last character of a search - doesn't need to filter
+ * again. The history is dropped when the items change.
+ */
+#define MAX_MATCHES_HISTORY 8
+
+typedef struct {
+  char *state;
+  GtkBitset *matches;
+} MatchesHistory;
+
 struct _GtkFilterListModelClass
 {
   GObjectClass parent_class;
@@ -156,10 +173,167 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+/* Filters with a GtkFilterPreparedMatch are matched in chunks on a thread
+ * pool, after the items have been prepared in the main thread. Every job
+ * collects its matches in its own bitset.
+ *
+ * Set GTK_NO_PARALLEL_FILTER to disable this.
+ */
+#define FILTER_STEP_SIZE 512
+#define PARALLEL_FILTER_STEP_SIZE 8192
+#define MIN_PARALLEL_FILTER_ITEMS 1024
+#define MIN_ITEMS_PER_FILTER_JOB 256
+#define MAX_FILTER_THREADS 16
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} FilterBatch;
+
+typedef struct {
+  GtkFilter *filter;
+  const GtkFilterPreparedMatch *funcs;
+  guint *positions;
+  gpointer *prepared;
+  guint first;
+  guint last;
+  GtkBitset *matches;
+  FilterBatch *batch;
+} FilterJob;
+
+static GThreadPool *filter_pool;
+
+static void
+filter_job_match (FilterJob *job)
+{
+  guint i;
+
+  for (i = job->first; i < job->last; i++)
+    {
+      if (job->funcs->match_prepared (job->filter, job->prepared[i]))
+        gtk_bitset_add (job->matches, job->positions[i]);
+    }
+}
+
+static void
+filter_job_run (gpointer data,
+                gpointer user_data)
+{
+  FilterJob *job = data;
+
+  filter_job_match (job);
+
+  g_mutex_lock (&job->batch->lock);
+  job->batch->n_pending--;
+  g_cond_signal (&job->batch->cond);
+  g_mutex_unlock (&job->batch->lock);
+}
+
+static const GtkFilterPreparedMatch *
+gtk_filter_list_model_get_prepared_match (GtkFilterListModel *self)
+{
+  static int enabled = -1;
+
+  if (G_UNLIKELY (enabled == -1))
+    enabled = g_getenv ("GTK_NO_PARALLEL_FILTER") == NULL && g_get_num_processors () > 1;
+
+  if (!enabled ||
+      self->pending == NULL ||
+      gtk_bitset_get_size (self->pending) < MIN_PARALLEL_FILTER_ITEMS)
+    return NULL;
+
+  return gtk_filter_get_prepared_match (self->filter);
+}
+
+/* Returns the last position that was filtered */
+static guint
+gtk_filter_list_model_run_filter_parallel (GtkFilterListModel           *self,
+                                           const GtkFilterPreparedMatch *funcs,
+                                           guint                         n_steps,
+                                           gboolean                     *more)
+{
+  GtkBitsetIter iter;
+  FilterBatch batch;
+  FilterJob *jobs;
+  guint *positions;
+  gpointer *prepared;
+  guint i, n, pos, n_jobs, per_job;
+
+  n = MIN (n_steps, gtk_bitset_get_size (self->pending));
+  positions = g_new (guint, n);
+  prepared = g_new (gpointer, n);
+
+  gtk_bitset_iter_init_first (&iter, self->pending, NULL);
+  n = gtk_bitset_iter_read (&iter, positions, n);
+  *more = gtk_bitset_iter_is_valid (&iter);
+  pos = gtk_bitset_iter_get_value (&iter);
+
+  for (i = 0; i < n; i++)
+    {
+      gpointer item = g_list_model_get_item (self->model, positions[i]);
+      prepared[i] = funcs->prepare (self->filter, item);
+      g_object_unref (item);
+    }
+
+  n_jobs = MIN (CLAMP (g_get_num_processors (), 1, MAX_FILTER_THREADS),
+                MAX (n / MIN_ITEMS_PER_FILTER_JOB, 1));
+  per_job = (n + n_jobs - 1) / n_jobs;
+
+  if (G_UNLIKELY (filter_pool == NULL))
+    filter_pool = g_thread_pool_new (filter_job_run, NULL, MAX_FILTER_THREADS - 1, FALSE, NULL);
+
+  jobs = g_newa (FilterJob, n_jobs);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_jobs - 1;
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].filter = self->filter;
+      jobs[i].funcs = funcs;
+      jobs[i].positions = positions;
+      jobs[i].prepared = prepared;
+      jobs[i].first = MIN (i * per_job, n);
+      jobs[i].last = MIN (jobs[i].first + per_job, n);
+      jobs[i].matches = i == 0 ? self->matches : gtk_bitset_new_empty ();
+      jobs[i].batch = &batch;
+    }
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (filter_pool, &jobs[i], NULL);
+
+  filter_job_match (&jobs[0]);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  for (i = 1; i < n_jobs; i++)
+    {
+      gtk_bitset_union (self->matches, jobs[i].matches);
+      gtk_bitset_unref (jobs[i].matches);
+    }
+
+  for (i = 0; i < n; i++)
+    funcs->finish_prepared (self->filter, prepared[i]);
+
+  g_free (prepared);
+  g_free (positions);
+
+  return pos;
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
 {
+  const GtkFilterPreparedMatch *funcs;
   GtkBitsetIter iter;
   guint i, pos;
   gboolean more;
@@ -169,12 +343,20 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
-  for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
-       i < n_steps && more;
-       i++, more = gtk_bitset_iter_next (&iter, &pos))
+  funcs = gtk_filter_list_model_get_prepared_match (self);
+  if (funcs != NULL)
+    {
+      pos = gtk_filter_list_model_run_filter_parallel (self, funcs, n_steps, &more);
+    }
+  else
     {
-      if (gtk_filter_list_model_run_filter_on_item (self, pos))
-        gtk_bitset_add (self->matches, pos);
+      for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
+           i < n_steps && more;
+           i++, more = gtk_bitset_iter_next (&iter, &pos))
+        {
+          if (gtk_filter_list_model_run_filter_on_item (self, pos))
+            gtk_bitset_add (self->matches, pos);
+        }
     }
 
   if (more)
@@ -192,7 +374,7 @@ gtk_filter_list_model_stop_filtering (GtkFilterListModel *self)
   gboolean notify_pending = self->pending != NULL;
 
   g_clear_pointer (&self->pending, gtk_bitset_unref);
-  g_clear_handle_id (&self->pending_cb, g_source_remove);
+  g_clear_handle_id (&self->pending_cb, gtk_idle_scheduler_remove);
 
   if (notify_pending)
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
@@ -222,13 +404,21 @@ gtk_filter_list_model_emit_items_changed_for_changes (GtkFilterListModel *self,
 }
 
 static gboolean
-gtk_filter_list_model_run_filter_cb (gpointer data)
+gtk_filter_list_model_run_filter_cb (gpointer data,
+                                     gint64   deadline)
 {
   GtkFilterListModel *self = data;
   GtkBitset *old;
 
   old = gtk_bitset_copy (self->matches);
-  gtk_filter_list_model_run_filter (self, 512);
+  do
+    {
+      gtk_filter_list_model_run_filter (self,
+                                        gtk_filter_list_model_get_prepared_match (self)
+                                        ? PARALLEL_FILTER_STEP_SIZE
+                                        : FILTER_STEP_SIZE);
+    }
+  while (self->pending != NULL && g_get_monotonic_time () < deadline);
 
   if (self->pending == NULL)
     gtk_filter_list_model_stop_filtering (self);
@@ -268,8 +458,95 @@ gtk_filter_list_model_start_filtering (GtkFilterListModel *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
   g_assert (self->pending_cb == 0);
-  self->pending_cb = g_idle_add (gtk_filter_list_model_run_filter_cb, self);
-  g_source_set_name_by_id (self->pending_cb, "[gtk] gtk_filter_list_model_run_filter_cb");
+  self->pending_cb = gtk_idle_scheduler_add (G_PRIORITY_DEFAULT_IDLE,
+                                             gtk_filter_list_model_run_filter_cb,
+                                             self, NULL);
+}
+
+static void
+matches_history_free (gpointer data)
+{
+  MatchesHistory *history = data;
+
+  g_free (history->state);
+  gtk_bitset_unref (history->matches);
+  g_slice_free (MatchesHistory, history);
+}
+
+static void
+gtk_filter_list_model_clear_history (GtkFilterListModel *self)
+{
+  g_queue_clear_full (&self->history, matches_history_free);
+}
+
+static GList *
+gtk_filter_list_model_find_history (GtkFilterListModel *self,
+                                    const char         *state)
+{
+  GList *l;
+
+  for (l = self->history.head; l; l = l->next)
+    {
+      MatchesHistory *history = l->data;
+
+      if (g_str_equal (history->state, state))
+        return l;
+    }
+
+  return NULL;
+}
+
+/* Remembers the current matches if they are complete */
+static void
+gtk_filter_list_model_push_history (GtkFilterListModel *self)
+{
+  MatchesHistory *history;
+  GList *l;
+
+  if (self->state == NULL ||
+      self->strictness != GTK_FILTER_MATCH_SOME ||
+      self->pending != NULL)
+    return;
+
+  l = gtk_filter_list_model_find_history (self, self->state);
+  if (l)
+    {
+      matches_history_free (l->data);
+      g_queue_delete_link (&self->history, l);
+    }
+  else if (self->history.length >= MAX_MATCHES_HISTORY)
+    {
+      matches_history_free (g_queue_pop_tail (&self->history));
+    }
+
+  history = g_slice_new (MatchesHistory);
+  history->state = g_strdup (self->state);
+  history->matches = gtk_bitset_copy (self->matches);
+  g_queue_push_head (&self->history, history);
+}
+
+/* Returns the matches for state if it is in the history */
+static GtkBitset *
+gtk_filter_list_model_pop_history (GtkFilterListModel *self,
+                                   const char         *state)
+{
+  MatchesHistory *history;
+  GtkBitset *matches;
+  GList *l;
+
+  if (state == NULL)
+    return NULL;
+
+  l = gtk_filter_list_model_find_history (self, state);
+  if (l == NULL)
+    return NULL;
+
+  history = l->data;
+  matches = gtk_bitset_ref (history->matches);
+  matches_history_free (history);
+  g_queue_delete_link (&self->history, l);
+
+  return matches;
 }
 
 static void
@@ -281,6 +558,8 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
 {
   guint filter_removed, filter_added;
 
+  gtk_filter_list_model_clear_history (self);
+
   switch (self->strictness)
     {
     case GTK_FILTER_MATCH_NONE:
@@ -391,6 +670,8 @@ gtk_filter_list_model_clear_model (GtkFilterListModel *self)
   g_clear_object (&self->model);
   if (self->matches)
     gtk_bitset_remove_all (self->matches);
+  g_clear_pointer (&self->state, g_free);
+  gtk_filter_list_model_clear_history (self);
 }
 
 static void
@@ -406,6 +687,12 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
   else
     new_strictness = gtk_filter_get_strictness (self->filter);
 
+  if (change == GTK_FILTER_CHANGE_DIFFERENT)
+    gtk_filter_list_model_clear_history (self);
+  else
+    gtk_filter_list_model_push_history (self);
+  g_clear_pointer (&self->state, g_free);
+
   /* don't set self->strictness yet so get_n_items() and friends return old values */
 
   switch (new_strictness)
@@ -476,8 +763,11 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
 
     case GTK_FILTER_MATCH_SOME:
       {
-        GtkBitset *old, *pending;
-      
+        GtkBitset *old, *pending, *restored;
+
+        if (self->filter)
+          self->state = gtk_filter_get_state (self->filter);
+
         if (self->matches == NULL)
           {
             if (self->strictness == GTK_FILTER_MATCH_ALL)
@@ -490,6 +780,16 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
             old = self->matches;
           }
         self->strictness = new_strictness;
+
+        restored = gtk_filter_list_model_pop_history (self, self->state);
+        if (restored)
+          {
+            gtk_filter_list_model_stop_filtering (self);
+            self->matches = restored;
+            gtk_filter_list_model_emit_items_changed_for_changes (self, old);
+            break;
+          }
+
         switch (change)
           {
           default:
@@ -532,6 +832,8 @@ gtk_filter_list_model_clear_filter (GtkFilterListModel *self)
 
   g_signal_handlers_disconnect_by_func (self->filter, gtk_filter_list_model_filter_changed_cb, self);
   g_clear_object (&self->filter);
+  g_clear_pointer (&self->state, g_free);
+  gtk_filter_list_model_clear_history (self);
 }
 
 static void
@@ -542,6 +844,8 @@ gtk_filter_list_model_dispose (GObject *object)
   gtk_filter_list_model_clear_model (self);
   gtk_filter_list_model_clear_filter (self);
   g_clear_pointer (&self->matches, gtk_bitset_unref);
+  g_clear_pointer (&self->state, g_free);
+  gtk_filter_list_model_clear_history (self);
 
   G_OBJECT_CLASS (gtk_filter_list_model_parent_class)->dispose (object);
 }
@@ -734,6 +1038,7 @@ gtk_filter_list_model_set_model (GtkFilterListModel *self,
         }
       else if (self->matches)
         {
+          self->state = gtk_filter_get_state (self->filter);
           gtk_filter_list_model_start_filtering (self, gtk_bitset_new_range (0, g_list_model_get_n_items (model)));
           added = gtk_bitset_get_size (self->matches);
         }
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2019 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_FILTER_PRIVATE_H__
+#define __GTK_FILTER_PRIVATE_H__
+
+#include <gtk/gtkfilter.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkFilterPreparedMatch GtkFilterPreparedMatch;
+
+/* Filters that can split gtk_filter_match() into extracting what they
+ * need from the item, which has to happen in the main thread, and matching
+ * that, which must not look at the item or change the filter and may
+ * happen in worker threads. finish_prepared() is called in the main thread
+ * once all items are matched and frees prepared.
+ */
+struct _GtkFilterPreparedMatch
+{
+  gpointer              (* prepare)                             (GtkFilter              *self,
+                                                                 gpointer                item);
+  gboolean              (* match_prepared)                      (GtkFilter              *self,
+                                                                 gpointer                prepared);
+  void                  (* finish_prepared)                     (GtkFilter              *self,
+                                                                 gpointer                prepared);
+};
+
+/* Returns a string that identifies which items the filter currently
+ * matches, so that models can reuse results they computed for the same
+ * state before. Filters must emit GTK_FILTER_CHANGE_DIFFERENT when
+ * something that is not part of the state changes.
+ */
+typedef char *          (* GtkFilterStateFunc)                  (GtkFilter              *self);
+
+void                    gtk_filter_class_set_prepared_match     (GtkFilterClass                 *filter_class,
+                                                                 const GtkFilterPreparedMatch   *prepared_match);
+const GtkFilterPreparedMatch *
+                        gtk_filter_get_prepared_match           (GtkFilter                      *self);
+
+void                    gtk_filter_class_set_state_func         (GtkFilterClass                 *filter_class,
+                                                                 GtkFilterStateFunc              state_func);
+char *                  gtk_filter_get_state                    (GtkFilter                      *self);
+
+G_END_DECLS
+
+#endif /* __GTK_FILTER_PRIVATE_H__ */
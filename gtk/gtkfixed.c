@@ -196,6 +196,8 @@ gtk_fixed_init (GtkFixed *self)
   GtkFixedPrivate *priv = gtk_fixed_get_instance_private (self);
 
   gtk_widget_set_overflow (GTK_WIDGET (self), GTK_OVERFLOW_HIDDEN);
+  /* Fixed layouts are often used for canvases with lots of children */
+  gtk_widget_set_use_pick_index (GTK_WIDGET (self), TRUE);
 
   priv->layout = gtk_widget_get_layout_manager (GTK_WIDGET (self));
 }
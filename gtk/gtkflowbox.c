@@ -809,6 +809,8 @@ struct _GtkFlowBoxPrivate {
   GtkFlowBoxCreateWidgetFunc  create_widget_func;
   gpointer                    create_widget_func_data;
   GDestroyNotify              create_widget_func_data_destroy;
+  guint                       n_created; /* items of bound_model that have a child */
+  guint                       populate_id;
 
   gboolean           disable_move_cursor;
 };
@@ -3535,6 +3537,7 @@ gtk_flow_box_dispose (GObject *obj)
       g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, obj);
       g_clear_object (&priv->bound_model);
     }
+  gtk_flow_box_stop_populate (GTK_FLOW_BOX (obj));
 
   G_OBJECT_CLASS (gtk_flow_box_parent_class)->dispose (obj);
 }
@@ -3951,6 +3954,118 @@ gtk_flow_box_init (GtkFlowBox *box)
   gtk_widget_add_controller (GTK_WIDGET (box), controller);
 }
 
+/* Children for a bound model are created in chunks, so that
+ * binding a big model doesn't block the main loop.
+ */
+#define GTK_FLOW_BOX_PRIORITY_POPULATE (GDK_PRIORITY_REDRAW + 5)
+#define POPULATE_TIME_MS 10
+#define POPULATE_MIN_CHILDREN 100
+
+static void
+gtk_flow_box_create_bound_child (GtkFlowBox *box,
+                                 guint       position)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GObject *item;
+  GtkWidget *widget;
+
+  item = g_list_model_get_item (priv->bound_model, position);
+  widget = priv->create_widget_func (item, priv->create_widget_func_data);
+
+  /* We need to sink the floating reference here, so that we can accept
+   * both instances created with a floating reference (e.g. C functions
+   * that just return the result of g_object_new()) and without (e.g.
+   * from language bindings which will automatically sink the floating
+   * reference).
+   *
+   * See the similar code in gtklistbox.c:gtk_list_box_bound_model_changed.
+   */
+  if (g_object_is_floating (widget))
+    g_object_ref_sink (widget);
+
+  gtk_widget_show (widget);
+  gtk_flow_box_insert (box, widget, position);
+
+  g_object_unref (widget);
+  g_object_unref (item);
+}
+
+/* Creates the children for the first @n_items items */
+static void
+gtk_flow_box_populate_to (GtkFlowBox *box,
+                          guint       n_items)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  n_items = MIN (n_items, g_list_model_get_n_items (priv->bound_model));
+
+  while (priv->n_created < n_items)
+    {
+      gtk_flow_box_create_bound_child (box, priv->n_created);
+      priv->n_created++;
+    }
+}
+
+/* Returns TRUE if items without children remain */
+static gboolean
+gtk_flow_box_populate_chunk (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint64 end_time;
+  guint n_items, n;
+
+  end_time = g_get_monotonic_time () + POPULATE_TIME_MS * 1000;
+  n_items = g_list_model_get_n_items (priv->bound_model);
+
+  for (n = 0; priv->n_created < n_items; n++)
+    {
+      if (n >= POPULATE_MIN_CHILDREN && g_get_monotonic_time () >= end_time)
+        return TRUE;
+
+      gtk_flow_box_create_bound_child (box, priv->n_created);
+      priv->n_created++;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+gtk_flow_box_populate_cb (gpointer data)
+{
+  GtkFlowBox *box = data;
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (gtk_flow_box_populate_chunk (box))
+    return G_SOURCE_CONTINUE;
+
+  priv->populate_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_flow_box_populate (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (!gtk_flow_box_populate_chunk (box) || priv->populate_id != 0)
+    return;
+
+  priv->populate_id = g_idle_add_full (GTK_FLOW_BOX_PRIORITY_POPULATE,
+                                       gtk_flow_box_populate_cb,
+                                       box,
+                                       NULL);
+  g_source_set_name_by_id (priv->populate_id, "[gtk] gtk_flow_box_populate_cb");
+}
+
+static void
+gtk_flow_box_stop_populate (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  g_clear_handle_id (&priv->populate_id, g_source_remove);
+  priv->n_created = 0;
+}
+
 static void
 gtk_flow_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3960,41 +4075,31 @@ gtk_flow_box_bound_model_changed (GListModel *list,
 {
   GtkFlowBox *box = user_data;
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
-  int i;
+  guint i;
 
-  while (removed--)
+  /* Items without children only need to be created later */
+  if (position < priv->n_created)
     {
-      GtkFlowBoxChild *child;
-
-      child = gtk_flow_box_get_child_at_index (box, position);
-      gtk_flow_box_remove (box, GTK_WIDGET (child));
-    }
+      removed = MIN (removed, priv->n_created - position);
+      priv->n_created -= removed;
 
-  for (i = 0; i < added; i++)
-    {
-      GObject *item;
-      GtkWidget *widget;
-
-      item = g_list_model_get_item (list, position + i);
-      widget = priv->create_widget_func (item, priv->create_widget_func_data);
-
-      /* We need to sink the floating reference here, so that we can accept
-       * both instances created with a floating reference (e.g. C functions
-       * that just return the result of g_object_new()) and without (e.g.
-       * from language bindings which will automatically sink the floating
-       * reference).
-       *
-       * See the similar code in gtklistbox.c:gtk_list_box_bound_model_changed.
-       */
-      if (g_object_is_floating (widget))
-        g_object_ref_sink (widget);
+      while (removed--)
+        {
+          GSequenceIter *iter;
 
-      gtk_widget_show (widget);
-      gtk_flow_box_insert (box, widget, position + i);
+          iter = g_sequence_get_iter_at_pos (priv->children, position);
+          gtk_flow_box_remove (box, g_sequence_get (iter));
+        }
 
-      g_object_unref (widget);
-      g_object_unref (item);
+      if (position < priv->n_created)
+        {
+          for (i = 0; i < added; i++)
+            gtk_flow_box_create_bound_child (box, position + i);
+          priv->n_created += added;
+        }
     }
+
+  gtk_flow_box_populate (box);
 }
 
 /* Buildable implementation {{{3 */
@@ -4127,6 +4232,10 @@ gtk_flow_box_get_child_at_index (GtkFlowBox *box,
 
   g_return_val_if_fail (GTK_IS_FLOW_BOX (box), NULL);
 
+  /* Don't make callers wait for the child to be created */
+  if (BOX_PRIV (box)->bound_model && idx >= 0)
+    gtk_flow_box_populate_to (box, idx + 1);
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, idx);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -4255,6 +4364,10 @@ gtk_flow_box_check_model_compat (GtkFlowBox *box)
  * represent items from @model. @box is updated whenever @model changes.
  * If @model is %NULL, @box is left empty.
  *
+ * For big models, the widgets are created in chunks while the main loop
+ * is idle. gtk_flow_box_get_child_at_index() creates the widgets up to the
+ * requested index right away.
+ *
  * It is undefined to add or remove widgets directly (for example, with
  * gtk_flow_box_insert()) while @box is bound to a
  * model.
@@ -4285,6 +4398,7 @@ gtk_flow_box_bind_model (GtkFlowBox                 *box,
       g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
       g_clear_object (&priv->bound_model);
     }
+  gtk_flow_box_stop_populate (box);
 
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (box))))
     gtk_flow_box_remove (box, child);
@@ -34,6 +34,7 @@
 #include "gtkfilter.h"
 #include "gtkframe.h"
 #include "gtkgrid.h"
+#include "gtkidleschedulerprivate.h"
 #include "gtkfontchooser.h"
 #include "gtkfontchooserutils.h"
 #include "gtkintl.h"
@@ -153,6 +154,16 @@ struct _GtkFontChooserWidget
 
   GtkFontChooserLevel level;
 
+  /* key => FontPreview */
+  GHashTable   *previews;
+  /* FontPreview, most recently used first */
+  GQueue        preview_lru;
+  /* key => GPtrArray of labels waiting for the font */
+  GHashTable   *pending_previews;
+  GCancellable *preview_cancellable;
+  GtkSliceListModel *font_slice;
+  guint add_fonts_id;
+
   GHashTable *axes;
   gboolean updating_variations;
 
@@ -725,34 +736,318 @@ get_font_name (GObject  *ignore,
     }
 }
 
+/* Showing each font name in its own font means loading the font
+ * from disk, and the list can have thousands of them. The fonts
+ * are loaded in a worker thread first, and the rows show their
+ * name in the default font until that is done.
+ *
+ * Pango font maps can't be shared between threads, so the worker
+ * loads the font into a font map of its own. That pulls the font
+ * file into memory and primes fontconfig, which is what makes the
+ * first use of a font slow, so the main thread can shape with it
+ * quickly afterwards. The attributes for the fonts that are ready
+ * are kept in a cache that drops the least recently used ones.
+ */
+
+#define MAX_CACHED_PREVIEWS 256
+
+typedef struct
+{
+  char *key;
+  PangoAttrList *attrs;
+  GList link;
+} FontPreview;
+
+static void
+font_preview_free (gpointer data)
+{
+  FontPreview *preview = data;
+
+  pango_attr_list_unref (preview->attrs);
+  g_free (preview->key);
+  g_slice_free (FontPreview, preview);
+}
+
+static PangoFontFace *
+get_font_face (gpointer item)
+{
+  if (PANGO_IS_FONT_FAMILY (item))
+    return pango_font_family_get_face (item, NULL);
+  else
+    return item;
+}
+
 static PangoAttrList *
-get_font_attributes (GObject  *ignore,
-                     gpointer  item)
+get_font_attributes (PangoFontDescription *font_desc)
 {
-  PangoAttribute *attribute;
   PangoAttrList *attrs;
 
   attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_font_desc_new (font_desc));
 
-  if (item)
+  return attrs;
+}
+
+static PangoAttrList *
+lookup_font_preview (GtkFontChooserWidget *self,
+                     const char           *key)
+{
+  FontPreview *preview;
+
+  preview = g_hash_table_lookup (self->previews, key);
+  if (preview == NULL)
+    return NULL;
+
+  g_queue_unlink (&self->preview_lru, &preview->link);
+  g_queue_push_head_link (&self->preview_lru, &preview->link);
+
+  return preview->attrs;
+}
+
+static void
+add_font_preview (GtkFontChooserWidget *self,
+                  const char           *key,
+                  PangoAttrList        *attrs)
+{
+  FontPreview *preview;
+
+  if (g_hash_table_contains (self->previews, key))
+    return;
+
+  preview = g_slice_new0 (FontPreview);
+  preview->key = g_strdup (key);
+  preview->attrs = pango_attr_list_ref (attrs);
+  preview->link.data = preview;
+
+  g_hash_table_insert (self->previews, preview->key, preview);
+  g_queue_push_head_link (&self->preview_lru, &preview->link);
+
+  while (self->preview_lru.length > MAX_CACHED_PREVIEWS)
     {
-      PangoFontFace *face;
-      PangoFontDescription *font_desc;
+      FontPreview *oldest = g_queue_peek_tail (&self->preview_lru);
 
-      if (PANGO_IS_FONT_FAMILY (item))
-        face = pango_font_family_get_face (item, NULL);
-      else
-        face = item;
-      if (face)
-        {
-          font_desc = pango_font_face_describe (face);
-          attribute = pango_attr_font_desc_new (font_desc);
-          pango_attr_list_insert (attrs, attribute);
-          pango_font_description_free (font_desc);
-        }
+      g_queue_unlink (&self->preview_lru, &oldest->link);
+      g_hash_table_remove (self->previews, oldest->key);
     }
+}
 
-  return attrs;
+static void
+clear_font_previews (GtkFontChooserWidget *self)
+{
+  if (self->preview_cancellable)
+    {
+      g_cancellable_cancel (self->preview_cancellable);
+      g_clear_object (&self->preview_cancellable);
+    }
+
+  g_hash_table_remove_all (self->pending_previews);
+
+  /* The links are part of the previews, so this frees them */
+  g_hash_table_remove_all (self->previews);
+  g_queue_init (&self->preview_lru);
+}
+
+static void
+load_font_thread (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  PangoFontDescription *font_desc = task_data;
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoFont *font;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  font = pango_font_map_load_font (fontmap, context, font_desc);
+  if (font)
+    {
+      /* Creating the face is what reads the font file */
+      hb_face_get_glyph_count (hb_font_get_face (pango_font_get_hb_font (font)));
+      g_object_unref (font);
+    }
+
+  g_object_unref (context);
+  g_object_unref (fontmap);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+font_loaded (GObject      *source,
+             GAsyncResult *result,
+             gpointer      data)
+{
+  GtkFontChooserWidget *self = GTK_FONT_CHOOSER_WIDGET (source);
+  PangoFontDescription *font_desc = g_task_get_task_data (G_TASK (result));
+  GPtrArray *labels = NULL;
+  char *pending_key = NULL;
+  PangoAttrList *attrs;
+  char *key;
+  guint i;
+
+  if (!g_task_propagate_boolean (G_TASK (result), NULL))
+    return;
+
+  key = pango_font_description_to_string (font_desc);
+  attrs = get_font_attributes (font_desc);
+  add_font_preview (self, key, attrs);
+
+  g_hash_table_steal_extended (self->pending_previews, key,
+                               (gpointer *) &pending_key, (gpointer *) &labels);
+
+  for (i = 0; labels && i < labels->len; i++)
+    {
+      GtkWidget *label = g_ptr_array_index (labels, i);
+
+      gtk_label_set_attributes (GTK_LABEL (label), attrs);
+      g_object_set_data (G_OBJECT (label), "font-preview", NULL);
+    }
+
+  g_clear_pointer (&labels, g_ptr_array_unref);
+  g_free (pending_key);
+  pango_attr_list_unref (attrs);
+  g_free (key);
+}
+
+static void
+request_font_preview (GtkFontChooserWidget *self,
+                      GtkWidget            *label,
+                      gpointer              item)
+{
+  PangoFontFace *face;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  GPtrArray *labels;
+  GTask *task;
+  char *key;
+
+  face = get_font_face (item);
+  if (face == NULL)
+    {
+      gtk_label_set_attributes (GTK_LABEL (label), NULL);
+      return;
+    }
+
+  font_desc = pango_font_face_describe (face);
+
+  /* The worker can only load fonts from the default font map */
+  if (self->font_map)
+    {
+      attrs = get_font_attributes (font_desc);
+      gtk_label_set_attributes (GTK_LABEL (label), attrs);
+      pango_attr_list_unref (attrs);
+      pango_font_description_free (font_desc);
+      return;
+    }
+
+  key = pango_font_description_to_string (font_desc);
+
+  attrs = lookup_font_preview (self, key);
+  if (attrs)
+    {
+      gtk_label_set_attributes (GTK_LABEL (label), attrs);
+      pango_font_description_free (font_desc);
+      g_free (key);
+      return;
+    }
+
+  gtk_label_set_attributes (GTK_LABEL (label), NULL);
+  g_object_set_data_full (G_OBJECT (label), "font-preview", g_strdup (key), g_free);
+
+  labels = g_hash_table_lookup (self->pending_previews, key);
+  if (labels)
+    {
+      /* Already being loaded, wait for that */
+      g_ptr_array_add (labels, label);
+      pango_font_description_free (font_desc);
+      g_free (key);
+      return;
+    }
+
+  labels = g_ptr_array_new ();
+  g_ptr_array_add (labels, label);
+  g_hash_table_insert (self->pending_previews, key, labels);
+
+  if (self->preview_cancellable == NULL)
+    self->preview_cancellable = g_cancellable_new ();
+
+  task = g_task_new (self, self->preview_cancellable, font_loaded, NULL);
+  g_task_set_source_tag (task, request_font_preview);
+  g_task_set_task_data (task, font_desc, (GDestroyNotify) pango_font_description_free);
+  g_task_run_in_thread (task, load_font_thread);
+  g_object_unref (task);
+}
+
+static void
+cancel_font_preview (GtkFontChooserWidget *self,
+                     GtkWidget            *label)
+{
+  const char *key;
+  GPtrArray *labels;
+
+  key = g_object_get_data (G_OBJECT (label), "font-preview");
+  if (key == NULL)
+    return;
+
+  /* The load goes on, so the font is ready if the row comes back */
+  labels = g_hash_table_lookup (self->pending_previews, key);
+  if (labels)
+    g_ptr_array_remove_fast (labels, label);
+
+  g_object_set_data (G_OBJECT (label), "font-preview", NULL);
+}
+
+static void
+setup_font_item (GtkSignalListItemFactory *factory,
+                 GtkListItem              *item,
+                 gpointer                  data)
+{
+  GtkWidget *label;
+
+  label = gtk_label_new (NULL);
+  gtk_widget_set_margin_start (label, 20);
+  gtk_widget_set_margin_end (label, 20);
+  gtk_widget_set_margin_top (label, 10);
+  gtk_widget_set_margin_bottom (label, 10);
+  gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+  gtk_label_set_xalign (GTK_LABEL (label), 0);
+  gtk_list_item_set_child (item, label);
+}
+
+static void
+bind_font_item (GtkSignalListItemFactory *factory,
+                GtkListItem              *item,
+                gpointer                  data)
+{
+  GtkFontChooserWidget *self = data;
+  GtkWidget *label;
+  gpointer font;
+  char *name;
+
+  label = gtk_list_item_get_child (item);
+  font = gtk_list_item_get_item (item);
+
+  name = get_font_name (NULL, font);
+  gtk_label_set_label (GTK_LABEL (label), name);
+  g_free (name);
+
+  request_font_preview (self, label, font);
+}
+
+static void
+unbind_font_item (GtkSignalListItemFactory *factory,
+                  GtkListItem              *item,
+                  gpointer                  data)
+{
+  GtkFontChooserWidget *self = data;
+
+  cancel_font_preview (self, gtk_list_item_get_child (item));
 }
 
 static void
@@ -870,6 +1165,9 @@ gtk_font_chooser_widget_dispose (GObject *object)
   self->filter_func = NULL;
   g_clear_pointer (&self->filter_data, self->filter_data_destroy);
 
+  clear_font_previews (self);
+  g_clear_handle_id (&self->add_fonts_id, gtk_idle_scheduler_remove);
+
   g_clear_pointer (&self->stack, gtk_widget_unparent);
   g_clear_pointer (&self->language_table, g_hash_table_unref);
 
@@ -939,8 +1237,6 @@ gtk_font_chooser_widget_class_init (GtkFontChooserWidgetClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkFontChooserWidget, language_button);
   gtk_widget_class_bind_template_child (widget_class, GtkFontChooserWidget, language_frame);
   gtk_widget_class_bind_template_child (widget_class, GtkFontChooserWidget, language_list);
-  gtk_widget_class_bind_template_callback (widget_class, get_font_name);
-  gtk_widget_class_bind_template_callback (widget_class, get_font_attributes);
   gtk_widget_class_bind_template_callback (widget_class, stop_search_cb);
   gtk_widget_class_bind_template_callback (widget_class, row_activated_cb);
   gtk_widget_class_bind_template_callback (widget_class, rows_changed_cb);
@@ -1102,45 +1398,52 @@ add_languages_from_font (GtkFontChooserWidget *self,
 /* We incrementally populate our fontlist to prevent blocking
  * the font chooser for a long time with expensive FcFontSort
  * calls in pango for every row in the list).
+ *
+ * The slice is over the families, so the faces of a family
+ * are only listed once the family gets added to the list.
  */
 static gboolean
-add_to_fontlist (GtkWidget     *widget,
-                 GdkFrameClock *clock,
-                 gpointer       user_data)
+add_to_fontlist (gpointer user_data,
+                 gint64   deadline)
 {
-  GtkFontChooserWidget *self = GTK_FONT_CHOOSER_WIDGET (widget);
-  GtkSliceListModel *model = user_data;
+  GtkFontChooserWidget *self = user_data;
+  GtkSliceListModel *model = self->font_slice;
   GListModel *child_model;
   guint i G_GNUC_UNUSED;
-  guint n G_GNUC_UNUSED;
-
-  if (gtk_filter_list_model_get_model (self->filter_model) != G_LIST_MODEL (model))
-    return G_SOURCE_REMOVE;
+  guint n, n_items;
 
   child_model = gtk_slice_list_model_get_model (model);
+  n_items = g_list_model_get_n_items (child_model);
 
   n = gtk_slice_list_model_get_size (model);
 
-#ifdef HAVE_PANGOFT
-  for (i = n; i < n + 10; i++)
+  do
     {
-      gpointer item = g_list_model_get_item (child_model, i);
-      if (!item)
-        break;
-      add_languages_from_font (self, item);
-      g_object_unref (item);
-    }
+#ifdef HAVE_PANGOFT
+      for (i = n; i < n + 10; i++)
+        {
+          gpointer item = g_list_model_get_item (child_model, i);
+          if (!item)
+            break;
+          add_languages_from_font (self, item);
+          g_object_unref (item);
+        }
 #endif
 
-  n += 10;
+      n += 10;
+    }
+  while (n < n_items && g_get_monotonic_time () < deadline);
 
-  if (n >= g_list_model_get_n_items (child_model))
+  if (n >= n_items)
     n = G_MAXUINT;
 
   gtk_slice_list_model_set_size (model, n);
 
   if (n == G_MAXUINT)
-    return G_SOURCE_REMOVE;
+    {
+      self->add_fonts_id = 0;
+      return G_SOURCE_REMOVE;
+    }
   else
     return G_SOURCE_CONTINUE;
 }
@@ -1155,13 +1458,17 @@ update_fontlist (GtkFontChooserWidget *self)
   if (!fontmap)
     fontmap = pango_cairo_font_map_get_default ();
 
+  /* Loaded fonts from a different font map are no use */
+  clear_font_previews (self);
+
+  self->font_slice = gtk_slice_list_model_new (g_object_ref (G_LIST_MODEL (fontmap)), 0, 20);
+  g_clear_handle_id (&self->add_fonts_id, gtk_idle_scheduler_remove);
+  self->add_fonts_id = gtk_idle_scheduler_add (G_PRIORITY_DEFAULT_IDLE, add_to_fontlist, self, NULL);
+
   if ((self->level & GTK_FONT_CHOOSER_LEVEL_STYLE) == 0)
-    model = g_object_ref (G_LIST_MODEL (fontmap));
+    model = G_LIST_MODEL (self->font_slice);
   else
-    model = G_LIST_MODEL (gtk_flatten_list_model_new (G_LIST_MODEL (g_object_ref (fontmap))));
-
-  model = G_LIST_MODEL (gtk_slice_list_model_new (model, 0, 20));
-  gtk_widget_add_tick_callback (GTK_WIDGET (self), add_to_fontlist, g_object_ref (model), g_object_unref);
+    model = G_LIST_MODEL (gtk_flatten_list_model_new (G_LIST_MODEL (self->font_slice)));
 
   gtk_filter_list_model_set_model (self->filter_model, model);
   g_object_unref (model);
@@ -1262,9 +1569,13 @@ setup_language_list (GtkFontChooserWidget *self)
 static void
 gtk_font_chooser_widget_init (GtkFontChooserWidget *self)
 {
+  GtkListItemFactory *factory;
+
   gtk_widget_init_template (GTK_WIDGET (self));
 
   self->axes = g_hash_table_new_full (axis_hash, axis_equal, NULL, axis_free);
+  self->previews = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, font_preview_free);
+  self->pending_previews = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
 
   /* Default preview string  */
   self->preview_text = g_strdup (pango_language_get_sample_string (NULL));
@@ -1289,6 +1600,13 @@ gtk_font_chooser_widget_init (GtkFontChooserWidget *self)
   self->tweak_action = G_ACTION (g_simple_action_new_stateful ("tweak", NULL, g_variant_new_boolean (FALSE)));
   g_signal_connect (self->tweak_action, "change-state", G_CALLBACK (change_tweak), self);
 
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_font_item), self);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_font_item), self);
+  g_signal_connect (factory, "unbind", G_CALLBACK (unbind_font_item), self);
+  gtk_list_view_set_factory (GTK_LIST_VIEW (self->family_face_list), factory);
+  g_object_unref (factory);
+
   update_fontlist (self);
 
   /* Load data and set initial style-dependent parameters */
@@ -1339,6 +1657,8 @@ gtk_font_chooser_widget_finalize (GObject *object)
   g_list_free_full (fontchooser->feature_items, g_free);
 
   g_hash_table_unref (fontchooser->axes);
+  g_hash_table_unref (fontchooser->previews);
+  g_hash_table_unref (fontchooser->pending_previews);
 
   g_free (fontchooser->font_features);
 
@@ -31,6 +31,8 @@
 #include "gtknative.h"
 #include "gtkwidgetprivate.h"
 
+#include <gsk/gl/gskglrenderer.h>
+
 #include <epoxy/gl.h>
 
 /**
@@ -142,8 +144,27 @@
  *
  * If you need to change the options for creating the #GdkGLContext
  * you should use the #GtkGLArea::create-context signal.
+ *
+ * ## Rendering outside of the frame ##
+ *
+ * By default, the #GtkGLArea::render signal is emitted while GTK
+ * draws the window, so the application's GL work adds to the time
+ * it takes to produce every frame. Alternatively, an application
+ * can render whenever it likes, for example from a thread of its
+ * own, into the textures of a small swapchain owned by the area.
+ *
+ * To do so, create a context with gtk_gl_area_create_render_context()
+ * and make it current in the thread that renders. For every frame,
+ * get a texture with gtk_gl_area_acquire_texture(), attach it to a
+ * framebuffer of your own, render, and hand it back with
+ * gtk_gl_area_present_texture(). When drawing, the area shows the
+ * newest presented texture that the GPU has finished rendering and
+ * never waits for one. Once a render context has been created, the
+ * #GtkGLArea::render signal is no longer emitted.
  */
 
+#define SWAPCHAIN_LENGTH 3
+
 typedef struct {
   guint id;
   int width;
@@ -151,6 +172,29 @@ typedef struct {
   GdkTexture *holder;
 } Texture;
 
+/* A read back of a rendered frame into a pixel pack buffer, for
+ * renderers that can't use our texture directly
+ */
+typedef struct {
+  guint buffer;
+  GLsync fence;
+  int width;
+  int height;
+} Readback;
+
+/* A texture of the swapchain used with gtk_gl_area_acquire_texture() */
+typedef struct {
+  GtkGLArea *area;
+  guint id;
+  int width;
+  int height;
+  GLsync fence;
+  guint64 serial;
+  guint acquired : 1; /* being rendered to */
+  guint ready    : 1; /* presented, but not shown yet */
+  GdkTexture *holder; /* while shown */
+} SwapchainTexture;
+
 typedef struct {
   GdkGLContext *context;
   GError *error;
@@ -164,6 +208,24 @@ typedef struct {
   Texture *texture;
   GList *textures;
 
+  Readback readbacks[2];
+  guint next_readback;
+  GdkTexture *readback_texture;
+  guint readback_tick_id;
+
+  /* Protects the swapchain, which is used from render threads */
+  GMutex swapchain_lock;
+  GCond swapchain_cond;
+  SwapchainTexture *swapchain;
+  guint64 swapchain_serial;
+  int swapchain_width;
+  int swapchain_height;
+  gboolean swapchain_use_es;
+  gboolean swapchain_closed;
+  gboolean swapchain_draw_queued;
+  GdkTexture *swapchain_texture;
+  guint swapchain_tick_id;
+
   gboolean has_depth_buffer;
   gboolean has_stencil_buffer;
 
@@ -198,6 +260,7 @@ enum {
 
 static void gtk_gl_area_allocate_buffers (GtkGLArea *area);
 static void gtk_gl_area_allocate_texture (GtkGLArea *area);
+static void gtk_gl_area_update_swapchain_size (GtkGLArea *area);
 
 static guint area_signals[LAST_SIGNAL] = { 0, };
 
@@ -300,6 +363,9 @@ gtk_gl_area_notify (GObject    *object,
       GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
 
       priv->needs_resize = TRUE;
+
+      if (priv->swapchain)
+        gtk_gl_area_update_swapchain_size (area);
     }
 
   if (G_OBJECT_CLASS (gtk_gl_area_parent_class)->notify)
@@ -608,6 +674,33 @@ gtk_gl_area_delete_textures (GtkGLArea *area)
   priv->textures = NULL;
 }
 
+static void
+gtk_gl_area_delete_readbacks (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (priv->readbacks); i++)
+    {
+      Readback *readback = &priv->readbacks[i];
+
+      if (readback->fence)
+        glDeleteSync (readback->fence);
+      if (readback->buffer)
+        glDeleteBuffers (1, &readback->buffer);
+
+      memset (readback, 0, sizeof (Readback));
+    }
+
+  g_clear_object (&priv->readback_texture);
+
+  if (priv->readback_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (area), priv->readback_tick_id);
+      priv->readback_tick_id = 0;
+    }
+}
+
 static void
 gtk_gl_area_unrealize (GtkWidget *widget)
 {
@@ -619,6 +712,8 @@ gtk_gl_area_unrealize (GtkWidget *widget)
       gtk_gl_area_make_current (area);
       gtk_gl_area_delete_buffers (area);
       gtk_gl_area_delete_textures (area);
+      gtk_gl_area_delete_readbacks (area);
+      gtk_gl_area_close_swapchain (area);
 
       /* Make sure to unset the context if current */
       if (priv->context == gdk_gl_context_get_current ())
@@ -644,6 +739,9 @@ gtk_gl_area_size_allocate (GtkWidget *widget,
 
   if (gtk_widget_get_realized (widget))
     priv->needs_resize = TRUE;
+
+  if (priv->swapchain)
+    gtk_gl_area_update_swapchain_size (area);
 }
 
 static void
@@ -677,6 +775,379 @@ release_texture (gpointer data)
   texture->holder = NULL;
 }
 
+/* Renderers other than the GL renderer have to download our texture
+ * to draw it, and a synchronous glReadPixels() stalls on the GPU
+ * every frame. Where possible, we read the frame back into a pixel
+ * pack buffer instead and only map it in the next frame, when the
+ * GPU is done with it.
+ */
+static gboolean
+gtk_gl_area_use_readback (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkNative *native;
+  int major, minor;
+
+  native = gtk_widget_get_native (GTK_WIDGET (area));
+  if (native == NULL || GSK_IS_GL_RENDERER (gtk_native_get_renderer (native)))
+    return FALSE;
+
+  /* For pixel pack buffers and fences */
+  gdk_gl_context_get_version (priv->context, &major, &minor);
+  if (gdk_gl_context_get_use_es (priv->context))
+    return major >= 3;
+  else
+    return major > 3 || (major == 3 && minor >= 2);
+}
+
+/* Reads back the frame buffer, which must be bound */
+static void
+gtk_gl_area_start_readback (GtkGLArea *area,
+                            int        width,
+                            int        height)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  Readback *readback = &priv->readbacks[priv->next_readback];
+
+  g_assert (readback->fence == NULL);
+
+  if (readback->buffer == 0)
+    glGenBuffers (1, &readback->buffer);
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, readback->buffer);
+  if (readback->width != width || readback->height != height)
+    {
+      glBufferData (GL_PIXEL_PACK_BUFFER, (gsize) width * height * 4, NULL, GL_STREAM_READ);
+      readback->width = width;
+      readback->height = height;
+    }
+
+  glPixelStorei (GL_PACK_ALIGNMENT, 4);
+  if (gdk_gl_context_get_use_es (priv->context))
+    glReadPixels (0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  else
+    glReadPixels (0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+
+  readback->fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush ();
+
+  priv->next_readback = (priv->next_readback + 1) % G_N_ELEMENTS (priv->readbacks);
+}
+
+/* Waits for a read back to arrive and puts it into readback_texture */
+static void
+gtk_gl_area_finish_readback (GtkGLArea *area,
+                             Readback  *readback)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  gsize size = (gsize) readback->width * readback->height * 4;
+  GBytes *bytes;
+  gpointer data;
+
+  glClientWaitSync (readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  glDeleteSync (readback->fence);
+  readback->fence = NULL;
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, readback->buffer);
+  data = glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (data)
+    {
+      bytes = g_bytes_new (data, size);
+      glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+
+      g_clear_object (&priv->readback_texture);
+      priv->readback_texture = gdk_memory_texture_new (readback->width,
+                                                       readback->height,
+                                                       gdk_gl_context_get_use_es (priv->context)
+                                                       ? GDK_MEMORY_R8G8B8A8_PREMULTIPLIED
+                                                       : GDK_MEMORY_B8G8R8A8_PREMULTIPLIED,
+                                                       bytes,
+                                                       readback->width * 4);
+      g_bytes_unref (bytes);
+    }
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+}
+
+static Readback *
+gtk_gl_area_get_pending_readback (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (priv->readbacks); i++)
+    {
+      if (priv->readbacks[i].fence)
+        return &priv->readbacks[i];
+    }
+
+  return NULL;
+}
+
+static gboolean
+readback_tick (GtkWidget     *widget,
+               GdkFrameClock *frame_clock,
+               gpointer       user_data)
+{
+  GtkGLArea *area = GTK_GL_AREA (widget);
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  /* Make sure the last frame we read back gets shown */
+  priv->readback_tick_id = 0;
+  gtk_widget_queue_draw (widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Returns the texture to draw for a frame that was just rendered
+ * to the frame buffer, or %NULL if there was nothing rendered.
+ */
+static GdkTexture *
+gtk_gl_area_read_back (GtkGLArea *area,
+                       gboolean   rendered,
+                       int        width,
+                       int        height)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  Readback *pending;
+
+  pending = gtk_gl_area_get_pending_readback (area);
+
+  if (rendered)
+    {
+      glBindFramebuffer (GL_FRAMEBUFFER, priv->frame_buffer);
+      gtk_gl_area_start_readback (area, width, height);
+
+      /* Show the previous frame now and this one next time. Only
+       * wait for this one if we have nothing of the right size.
+       */
+      if (pending && (pending->width != width || pending->height != height))
+        {
+          glDeleteSync (pending->fence);
+          pending->fence = NULL;
+          pending = NULL;
+        }
+
+      if (pending)
+        gtk_gl_area_finish_readback (area, pending);
+      else if (priv->readback_texture == NULL ||
+               gdk_texture_get_width (priv->readback_texture) != width ||
+               gdk_texture_get_height (priv->readback_texture) != height)
+        gtk_gl_area_finish_readback (area, gtk_gl_area_get_pending_readback (area));
+    }
+  else if (pending)
+    {
+      gtk_gl_area_finish_readback (area, pending);
+    }
+
+  if (gtk_gl_area_get_pending_readback (area) && priv->readback_tick_id == 0)
+    priv->readback_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (area),
+                                                           readback_tick,
+                                                           NULL, NULL);
+
+  if (priv->readback_texture == NULL ||
+      gdk_texture_get_width (priv->readback_texture) != width ||
+      gdk_texture_get_height (priv->readback_texture) != height)
+    return NULL;
+
+  return g_object_ref (priv->readback_texture);
+}
+
+static void
+gtk_gl_area_update_swapchain_size (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkWidget *widget = GTK_WIDGET (area);
+  int scale;
+
+  scale = gtk_widget_get_scale_factor (widget);
+
+  g_mutex_lock (&priv->swapchain_lock);
+  priv->swapchain_width = gtk_widget_get_width (widget) * scale;
+  priv->swapchain_height = gtk_widget_get_height (widget) * scale;
+  g_mutex_unlock (&priv->swapchain_lock);
+}
+
+static void
+swapchain_texture_release (gpointer data)
+{
+  SwapchainTexture *texture = data;
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (texture->area);
+
+  g_mutex_lock (&priv->swapchain_lock);
+  texture->holder = NULL;
+  g_cond_broadcast (&priv->swapchain_cond);
+  g_mutex_unlock (&priv->swapchain_lock);
+}
+
+static void
+swapchain_texture_drop (SwapchainTexture *texture)
+{
+  glDeleteSync (texture->fence);
+  texture->fence = NULL;
+  texture->ready = FALSE;
+}
+
+static void
+gtk_gl_area_close_swapchain (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  guint i;
+
+  if (priv->swapchain == NULL)
+    return;
+
+  /* Takes the swapchain lock */
+  for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+    {
+      if (priv->swapchain[i].holder)
+        gdk_gl_texture_release (GDK_GL_TEXTURE (priv->swapchain[i].holder));
+    }
+  g_clear_object (&priv->swapchain_texture);
+
+  if (priv->swapchain_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (area), priv->swapchain_tick_id);
+      priv->swapchain_tick_id = 0;
+    }
+
+  g_mutex_lock (&priv->swapchain_lock);
+
+  priv->swapchain_closed = TRUE;
+
+  /* Textures that are being rendered to get deleted when presented */
+  for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+    {
+      SwapchainTexture *texture = &priv->swapchain[i];
+
+      if (texture->acquired)
+        continue;
+
+      if (texture->ready)
+        swapchain_texture_drop (texture);
+
+      if (texture->id)
+        {
+          glDeleteTextures (1, &texture->id);
+          texture->id = 0;
+          texture->width = 0;
+          texture->height = 0;
+        }
+    }
+
+  g_cond_broadcast (&priv->swapchain_cond);
+  g_mutex_unlock (&priv->swapchain_lock);
+}
+
+static gboolean
+swapchain_tick (GtkWidget     *widget,
+                GdkFrameClock *frame_clock,
+                gpointer       user_data)
+{
+  GtkGLArea *area = GTK_GL_AREA (widget);
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  /* Check again for a texture that wasn't done last time */
+  priv->swapchain_tick_id = 0;
+  gtk_widget_queue_draw (widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Returns the newest presented texture that the GPU is done with,
+ * without waiting for any
+ */
+static GdkTexture *
+gtk_gl_area_get_swapchain_texture (GtkGLArea *area)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  SwapchainTexture *newest = NULL;
+  GdkTexture *previous = NULL;
+  gboolean pending = FALSE;
+  guint i;
+
+  g_mutex_lock (&priv->swapchain_lock);
+
+  for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+    {
+      SwapchainTexture *texture = &priv->swapchain[i];
+      GLenum status;
+
+      if (!texture->ready)
+        continue;
+
+      if (newest && texture->serial < newest->serial)
+        continue;
+
+      status = glClientWaitSync (texture->fence, 0, 0);
+      if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+        newest = texture;
+    }
+
+  if (newest)
+    {
+      /* Anything older than it is never going to be shown */
+      for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+        {
+          SwapchainTexture *texture = &priv->swapchain[i];
+
+          if (texture->ready && texture->serial <= newest->serial)
+            swapchain_texture_drop (texture);
+        }
+
+      newest->holder = gdk_gl_texture_new (priv->context,
+                                           newest->id,
+                                           newest->width,
+                                           newest->height,
+                                           swapchain_texture_release, newest);
+      previous = priv->swapchain_texture;
+      priv->swapchain_texture = newest->holder;
+
+      g_cond_broadcast (&priv->swapchain_cond);
+    }
+
+  for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+    pending |= priv->swapchain[i].ready;
+
+  g_mutex_unlock (&priv->swapchain_lock);
+
+  /* Takes the swapchain lock when releasing */
+  g_clear_object (&previous);
+
+  if (pending && priv->swapchain_tick_id == 0)
+    priv->swapchain_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (area),
+                                                            swapchain_tick,
+                                                            NULL, NULL);
+
+  if (priv->swapchain_texture == NULL)
+    return NULL;
+
+  return g_object_ref (priv->swapchain_texture);
+}
+
+static void
+gtk_gl_area_append_texture (GtkGLArea   *area,
+                            GtkSnapshot *snapshot,
+                            GdkTexture  *texture)
+{
+  GtkWidget *widget = GTK_WIDGET (area);
+
+  /* Our texture is rendered by OpenGL, so it is upside down,
+   * compared to what GSK expects, so flip it back.
+   */
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (0, gtk_widget_get_height (widget)));
+  gtk_snapshot_scale (snapshot, 1, -1);
+  gtk_snapshot_append_texture (snapshot,
+                               texture,
+                               &GRAPHENE_RECT_INIT (0, 0,
+                                                    gtk_widget_get_width (widget),
+                                                    gtk_widget_get_height (widget)));
+  gtk_snapshot_restore (snapshot);
+}
+
 static void
 gtk_gl_area_snapshot (GtkWidget   *widget,
                       GtkSnapshot *snapshot)
@@ -708,6 +1179,19 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
 
   gtk_gl_area_make_current (area);
 
+  if (priv->swapchain)
+    {
+      GdkTexture *texture = gtk_gl_area_get_swapchain_texture (area);
+
+      if (texture)
+        {
+          gtk_gl_area_append_texture (area, snapshot, texture);
+          g_object_unref (texture);
+        }
+
+      return;
+    }
+
   gtk_gl_area_attach_buffers (area);
 
  if (priv->has_depth_buffer)
@@ -719,6 +1203,8 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
   if (status == GL_FRAMEBUFFER_COMPLETE)
     {
       Texture *texture;
+      GdkTexture *holder = NULL;
+      gboolean rendered = FALSE;
 
       if (priv->needs_render || priv->auto_render)
         {
@@ -729,34 +1215,33 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
             }
 
           g_signal_emit (area, area_signals[RENDER], 0, priv->context, &unused);
+          rendered = TRUE;
         }
 
       priv->needs_render = FALSE;
 
-      texture = priv->texture;
-      priv->texture = NULL;
-      priv->textures = g_list_prepend (priv->textures, texture);
+      if (gtk_gl_area_use_readback (area))
+        holder = gtk_gl_area_read_back (area, rendered, priv->texture->width, priv->texture->height);
+      else if (priv->readback_texture)
+        gtk_gl_area_delete_readbacks (area);
 
-      texture->holder = gdk_gl_texture_new (priv->context,
-                                            texture->id,
-                                            texture->width,
-                                            texture->height,
-                                            release_texture, texture);
+      if (holder == NULL)
+        {
+          texture = priv->texture;
+          priv->texture = NULL;
+          priv->textures = g_list_prepend (priv->textures, texture);
+
+          texture->holder = gdk_gl_texture_new (priv->context,
+                                                texture->id,
+                                                texture->width,
+                                                texture->height,
+                                                release_texture, texture);
+          holder = texture->holder;
+        }
 
-      /* Our texture is rendered by OpenGL, so it is upside down,
-       * compared to what GSK expects, so flip it back.
-       */
-      gtk_snapshot_save (snapshot);
-      gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (0, gtk_widget_get_height (widget)));
-      gtk_snapshot_scale (snapshot, 1, -1);
-      gtk_snapshot_append_texture (snapshot,
-                                   texture->holder,
-                                   &GRAPHENE_RECT_INIT (0, 0,
-                                                        gtk_widget_get_width (widget),
-                                                        gtk_widget_get_height (widget)));
-      gtk_snapshot_restore (snapshot);
-
-      g_object_unref (texture->holder);
+      gtk_gl_area_append_texture (area, snapshot, holder);
+
+      g_object_unref (holder);
     }
   else
     {
@@ -764,6 +1249,19 @@ gtk_gl_area_snapshot (GtkWidget   *widget,
     }
 }
 
+static void
+gtk_gl_area_finalize (GObject *object)
+{
+  GtkGLArea *area = GTK_GL_AREA (object);
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_free (priv->swapchain);
+  g_mutex_clear (&priv->swapchain_lock);
+  g_cond_clear (&priv->swapchain_cond);
+
+  G_OBJECT_CLASS (gtk_gl_area_parent_class)->finalize (object);
+}
+
 static gboolean
 create_context_accumulator (GSignalInvocationHint *ihint,
                             GValue *return_accu,
@@ -879,6 +1377,7 @@ gtk_gl_area_class_init (GtkGLAreaClass *klass)
   gobject_class->set_property = gtk_gl_area_set_property;
   gobject_class->get_property = gtk_gl_area_get_property;
   gobject_class->notify = gtk_gl_area_notify;
+  gobject_class->finalize = gtk_gl_area_finalize;
 
   g_object_class_install_properties (gobject_class, LAST_PROP, obj_props);
 
@@ -976,6 +1475,9 @@ gtk_gl_area_init (GtkGLArea *area)
   priv->auto_render = TRUE;
   priv->needs_render = TRUE;
   priv->required_gl_version = 0;
+
+  g_mutex_init (&priv->swapchain_lock);
+  g_cond_init (&priv->swapchain_cond);
 }
 
 /**
@@ -1340,3 +1842,294 @@ gtk_gl_area_make_current (GtkGLArea *area)
   if (priv->context != NULL)
     gdk_gl_context_make_current (priv->context);
 }
+
+/**
+ * gtk_gl_area_create_render_context:
+ * @area: a #GtkGLArea
+ * @error: return location for an error
+ *
+ * Creates a new #GdkGLContext that shares resources with the
+ * context of @area, for rendering into the textures returned
+ * by gtk_gl_area_acquire_texture().
+ *
+ * The context is realized with the same settings as the one
+ * of @area, and may be made current in a different thread.
+ *
+ * After this has been called, @area shows the textures passed
+ * to gtk_gl_area_present_texture() and no longer emits
+ * #GtkGLArea::render.
+ *
+ * Returns: (transfer full) (nullable): a new #GdkGLContext,
+ *   or %NULL on error
+ *
+ * Since: 4.2
+ */
+GdkGLContext *
+gtk_gl_area_create_render_context (GtkGLArea  *area,
+                                   GError    **error)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  GtkWidget *widget = GTK_WIDGET (area);
+  GdkGLContext *context;
+  int major, minor;
+  guint i;
+
+  g_return_val_if_fail (GTK_IS_GL_AREA (area), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  gtk_widget_realize (widget);
+
+  if (priv->error)
+    {
+      g_propagate_error (error, g_error_copy (priv->error));
+      return NULL;
+    }
+
+  if (priv->context == NULL)
+    {
+      g_set_error_literal (error, GDK_GL_ERROR,
+                           GDK_GL_ERROR_NOT_AVAILABLE,
+                           _("OpenGL context creation failed"));
+      return NULL;
+    }
+
+  context = gdk_surface_create_gl_context (gtk_native_get_surface (gtk_widget_get_native (widget)), error);
+  if (context == NULL)
+    return NULL;
+
+  gdk_gl_context_get_required_version (priv->context, &major, &minor);
+  gdk_gl_context_set_use_es (context, gdk_gl_context_get_use_es (priv->context));
+  gdk_gl_context_set_required_version (context, major, minor);
+
+  if (!gdk_gl_context_realize (context, error))
+    {
+      g_object_unref (context);
+      return NULL;
+    }
+
+  g_mutex_lock (&priv->swapchain_lock);
+
+  if (priv->swapchain == NULL)
+    {
+      priv->swapchain = g_new0 (SwapchainTexture, SWAPCHAIN_LENGTH);
+      for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+        priv->swapchain[i].area = area;
+    }
+
+  priv->swapchain_closed = FALSE;
+  priv->swapchain_use_es = gdk_gl_context_get_use_es (priv->context);
+
+  g_mutex_unlock (&priv->swapchain_lock);
+
+  gtk_gl_area_update_swapchain_size (area);
+
+  return context;
+}
+
+/**
+ * gtk_gl_area_acquire_texture:
+ * @area: a #GtkGLArea
+ * @width: (out): return location for the width of the texture
+ * @height: (out): return location for the height of the texture
+ *
+ * Gets a texture to render the next frame of @area into.
+ *
+ * The context returned by gtk_gl_area_create_render_context()
+ * must be current. The texture is sized for the current
+ * allocation of @area, taking the scale factor into account.
+ * It is meant to be attached as color buffer to a framebuffer
+ * owned by the caller, and stays valid until it is passed to
+ * gtk_gl_area_present_texture().
+ *
+ * This function is thread-safe. If all textures are in use, it
+ * waits for one to become available, unless it is called from
+ * the main thread, where it returns 0 instead.
+ *
+ * Returns: the ID of a GL texture, or 0 if none is available
+ *
+ * Since: 4.2
+ */
+guint
+gtk_gl_area_acquire_texture (GtkGLArea *area,
+                             int       *width,
+                             int       *height)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  SwapchainTexture *texture;
+  gboolean use_es;
+  guint i;
+
+  g_return_val_if_fail (GTK_IS_GL_AREA (area), 0);
+  g_return_val_if_fail (priv->swapchain != NULL, 0);
+  g_return_val_if_fail (width != NULL, 0);
+  g_return_val_if_fail (height != NULL, 0);
+
+  g_mutex_lock (&priv->swapchain_lock);
+
+  while (TRUE)
+    {
+      SwapchainTexture *oldest_ready = NULL;
+
+      texture = NULL;
+
+      if (priv->swapchain_closed)
+        break;
+
+      for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+        {
+          SwapchainTexture *t = &priv->swapchain[i];
+
+          if (t->acquired || t->holder)
+            continue;
+
+          if (!t->ready)
+            {
+              texture = t;
+              break;
+            }
+
+          if (oldest_ready == NULL || t->serial < oldest_ready->serial)
+            oldest_ready = t;
+        }
+
+      /* A frame that wasn't shown yet gets replaced by a newer one */
+      if (texture == NULL && oldest_ready != NULL)
+        {
+          swapchain_texture_drop (oldest_ready);
+          texture = oldest_ready;
+        }
+
+      if (texture != NULL || g_main_context_is_owner (NULL))
+        break;
+
+      g_cond_wait (&priv->swapchain_cond, &priv->swapchain_lock);
+    }
+
+  if (texture == NULL)
+    {
+      g_mutex_unlock (&priv->swapchain_lock);
+      return 0;
+    }
+
+  texture->acquired = TRUE;
+  *width = priv->swapchain_width;
+  *height = priv->swapchain_height;
+  use_es = priv->swapchain_use_es;
+
+  g_mutex_unlock (&priv->swapchain_lock);
+
+  if (texture->id == 0)
+    glGenTextures (1, &texture->id);
+
+  if (texture->width != *width || texture->height != *height)
+    {
+      glBindTexture (GL_TEXTURE_2D, texture->id);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+      if (use_es)
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, *width, *height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+      else
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, *width, *height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+
+      texture->width = *width;
+      texture->height = *height;
+    }
+
+  return texture->id;
+}
+
+static gboolean
+swapchain_queue_draw_invoke (gpointer data)
+{
+  GtkGLArea *area = data;
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+
+  g_mutex_lock (&priv->swapchain_lock);
+  priv->swapchain_draw_queued = FALSE;
+  g_mutex_unlock (&priv->swapchain_lock);
+
+  gtk_widget_queue_draw (GTK_WIDGET (area));
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gtk_gl_area_present_texture:
+ * @area: a #GtkGLArea
+ * @texture_id: a texture returned by gtk_gl_area_acquire_texture()
+ *
+ * Hands a texture that a frame has been rendered into back
+ * to @area, to be shown once the GPU has finished rendering it.
+ *
+ * This must be called with the same context current that
+ * the texture was acquired with. It is thread-safe.
+ *
+ * Since: 4.2
+ */
+void
+gtk_gl_area_present_texture (GtkGLArea *area,
+                             guint      texture_id)
+{
+  GtkGLAreaPrivate *priv = gtk_gl_area_get_instance_private (area);
+  SwapchainTexture *texture = NULL;
+  gboolean queue_draw = FALSE;
+  GLsync fence;
+  guint i;
+
+  g_return_if_fail (GTK_IS_GL_AREA (area));
+  g_return_if_fail (priv->swapchain != NULL);
+
+  fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush ();
+
+  g_mutex_lock (&priv->swapchain_lock);
+
+  for (i = 0; i < SWAPCHAIN_LENGTH; i++)
+    {
+      if (priv->swapchain[i].acquired && priv->swapchain[i].id == texture_id)
+        {
+          texture = &priv->swapchain[i];
+          break;
+        }
+    }
+
+  if (texture == NULL)
+    {
+      g_mutex_unlock (&priv->swapchain_lock);
+      glDeleteSync (fence);
+      g_return_if_fail (texture != NULL);
+      return;
+    }
+
+  texture->acquired = FALSE;
+
+  if (priv->swapchain_closed)
+    {
+      glDeleteSync (fence);
+      glDeleteTextures (1, &texture->id);
+      texture->id = 0;
+      texture->width = 0;
+      texture->height = 0;
+    }
+  else
+    {
+      texture->fence = fence;
+      texture->serial = ++priv->swapchain_serial;
+      texture->ready = TRUE;
+
+      queue_draw = !priv->swapchain_draw_queued;
+      priv->swapchain_draw_queued = TRUE;
+    }
+
+  g_mutex_unlock (&priv->swapchain_lock);
+
+  if (queue_draw)
+    g_main_context_invoke_full (NULL,
+                                G_PRIORITY_DEFAULT,
+                                swapchain_queue_draw_invoke,
+                                g_object_ref (area),
+                                g_object_unref);
+}
@@ -121,6 +121,17 @@ void            gtk_gl_area_make_current                (GtkGLArea    *area);
 GDK_AVAILABLE_IN_ALL
 void            gtk_gl_area_attach_buffers              (GtkGLArea    *area);
 
+GDK_AVAILABLE_IN_4_2
+GdkGLContext *  gtk_gl_area_create_render_context       (GtkGLArea    *area,
+                                                         GError      **error);
+GDK_AVAILABLE_IN_4_2
+guint           gtk_gl_area_acquire_texture             (GtkGLArea    *area,
+                                                         int          *width,
+                                                         int          *height);
+GDK_AVAILABLE_IN_4_2
+void            gtk_gl_area_present_texture             (GtkGLArea    *area,
+                                                         guint         texture_id);
+
 GDK_AVAILABLE_IN_ALL
 void            gtk_gl_area_set_error                   (GtkGLArea    *area,
                                                          const GError *error);
@@ -96,8 +96,6 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
 
   icon_theme = gtk_icon_theme_get_for_display (gtk_widget_get_display (self->owner));
   flags = get_icon_lookup_flags (self, style);
-  if (preload)
-    flags |= GTK_ICON_LOOKUP_PRELOAD;
 
   width = height = gtk_icon_helper_get_size (self);
 
@@ -107,6 +105,12 @@ ensure_paintable_for_gicon (GtkIconHelper    *self,
                                          dir,
                                          scale, flags);
 
+  /* Icons of mapped widgets are needed for the next frame */
+  if (preload)
+    gtk_icon_paintable_queue_load (icon, gtk_widget_get_mapped (self->owner)
+                                         ? G_PRIORITY_HIGH
+                                         : G_PRIORITY_DEFAULT);
+
   *symbolic = gtk_icon_paintable_is_symbolic (icon);
   return GDK_PAINTABLE (icon);
 }
@@ -373,6 +377,27 @@ gtk_icon_helper_invalidate_for_change (GtkIconHelper     *self,
   gtk_icon_helper_ensure_paintable (self, TRUE);
 }
 
+/**
+ * gtk_icon_helper_set_mapped:
+ * @self: a #GtkIconHelper
+ * @mapped: whether the owner of @self is mapped
+ *
+ * Raises the priority of a pending threaded load of the icon
+ * when the owner gets mapped, and cancels it when it gets unmapped.
+ */
+void
+gtk_icon_helper_set_mapped (GtkIconHelper *self,
+                            gboolean       mapped)
+{
+  if (!GTK_IS_ICON_PAINTABLE (self->paintable))
+    return;
+
+  if (mapped)
+    gtk_icon_paintable_queue_load (GTK_ICON_PAINTABLE (self->paintable), G_PRIORITY_HIGH);
+  else
+    gtk_icon_paintable_cancel_load (GTK_ICON_PAINTABLE (self->paintable));
+}
+
 static void
 gtk_icon_helper_take_definition (GtkIconHelper      *self,
                                  GtkImageDefinition *def)
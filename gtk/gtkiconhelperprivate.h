@@ -69,6 +69,8 @@ int gtk_icon_helper_get_size (GtkIconHelper *self);
 void      gtk_icon_helper_invalidate (GtkIconHelper *self);
 void      gtk_icon_helper_invalidate_for_change (GtkIconHelper     *self,
                                                  GtkCssStyleChange *change);
+void      gtk_icon_helper_set_mapped (GtkIconHelper *self,
+                                      gboolean       mapped);
 
 void      gtk_icon_size_set_style_classes (GtkCssNode  *cssnode,
                                            GtkIconSize  icon_size);
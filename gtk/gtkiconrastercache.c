@@ -0,0 +1,191 @@
+/* gtkiconrastercache.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkiconrastercacheprivate.h"
+
+#include "gtkversion.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* The raster cache keeps the pixels of rasterized SVG icons in the
+ * user's cache directory, one file per icon, size and scale. Other
+ * processes that need the same icon map the file instead of running
+ * the SVG loader again.
+ *
+ * A cache file consists of a RasterCacheHeader, followed by the key
+ * it was created for and the pixel data, which starts at a 16 byte
+ * aligned offset. Files are written atomically, so readers never see
+ * partial data.
+ */
+
+#define RASTER_CACHE_MAGIC "GTKIRC01"
+
+typedef struct {
+  char magic[8];
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 format;
+  guint32 key_length;
+  guint32 data_offset;
+} RasterCacheHeader;
+
+char *
+gtk_icon_raster_cache_get_key (const char *filename,
+                               gboolean    is_resource,
+                               gboolean    is_symbolic,
+                               int         size,
+                               int         scale)
+{
+  gint64 mtime;
+
+  if (is_resource)
+    {
+      /* Resources change when GTK itself does */
+      mtime = GTK_MAJOR_VERSION * 10000 + GTK_MINOR_VERSION * 100 + GTK_MICRO_VERSION;
+    }
+  else
+    {
+      GStatBuf buf;
+
+      if (g_stat (filename, &buf) != 0)
+        return NULL;
+
+      mtime = buf.st_mtime;
+    }
+
+  return g_strdup_printf ("%s%s\n%d\n%d\n%d\n%" G_GINT64_FORMAT,
+                          is_resource ? "resource://" : "",
+                          filename,
+                          is_symbolic,
+                          size,
+                          scale,
+                          mtime);
+}
+
+static char *
+get_cache_path (const char *key)
+{
+  char *checksum;
+  char *path;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  path = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "icon-raster-cache", checksum, NULL);
+  g_free (checksum);
+
+  return path;
+}
+
+GdkTexture *
+gtk_icon_raster_cache_lookup (const char *key)
+{
+  const RasterCacheHeader *header;
+  GMappedFile *file;
+  GBytes *bytes, *pixels;
+  GdkTexture *texture;
+  const char *data;
+  gsize size;
+  char *path;
+
+  path = get_cache_path (key);
+  file = g_mapped_file_new (path, FALSE, NULL);
+  g_free (path);
+
+  if (file == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  data = g_bytes_get_data (bytes, &size);
+  header = (const RasterCacheHeader *) data;
+
+  if (size < sizeof (RasterCacheHeader) ||
+      memcmp (header->magic, RASTER_CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->width == 0 || header->height == 0 ||
+      (header->format != GDK_MEMORY_R8G8B8A8 && header->format != GDK_MEMORY_R8G8B8) ||
+      header->stride < header->width * (header->format == GDK_MEMORY_R8G8B8A8 ? 4 : 3) ||
+      header->key_length != strlen (key) ||
+      header->data_offset < sizeof (RasterCacheHeader) + header->key_length ||
+      header->data_offset > size ||
+      (size - header->data_offset) / header->stride < header->height ||
+      memcmp (data + sizeof (RasterCacheHeader), key, header->key_length) != 0)
+    {
+      g_bytes_unref (bytes);
+      return NULL;
+    }
+
+  pixels = g_bytes_new_from_bytes (bytes,
+                                   header->data_offset,
+                                   (gsize) header->stride * header->height);
+  texture = gdk_memory_texture_new (header->width,
+                                    header->height,
+                                    header->format,
+                                    pixels,
+                                    header->stride);
+  g_bytes_unref (pixels);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+void
+gtk_icon_raster_cache_store (const char *key,
+                             GdkPixbuf  *pixbuf)
+{
+  RasterCacheHeader header;
+  GByteArray *contents;
+  char *path, *dir;
+  int height, stride;
+
+  if (gdk_pixbuf_get_bits_per_sample (pixbuf) != 8 ||
+      gdk_pixbuf_get_n_channels (pixbuf) != (gdk_pixbuf_get_has_alpha (pixbuf) ? 4 : 3))
+    return;
+
+  height = gdk_pixbuf_get_height (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic));
+  header.width = gdk_pixbuf_get_width (pixbuf);
+  header.height = height;
+  header.stride = stride;
+  header.format = gdk_pixbuf_get_has_alpha (pixbuf) ? GDK_MEMORY_R8G8B8A8 : GDK_MEMORY_R8G8B8;
+  header.key_length = strlen (key);
+  header.data_offset = (sizeof (header) + header.key_length + 15) & ~15;
+
+  contents = g_byte_array_sized_new (header.data_offset + (gsize) stride * height);
+  g_byte_array_append (contents, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (contents, (const guint8 *) key, header.key_length);
+  g_byte_array_set_size (contents, header.data_offset);
+  g_byte_array_append (contents, gdk_pixbuf_read_pixels (pixbuf), gdk_pixbuf_get_byte_length (pixbuf));
+  /* The last row of a pixbuf may be shorter than the stride */
+  g_byte_array_set_size (contents, header.data_offset + (gsize) stride * height);
+
+  path = get_cache_path (key);
+  dir = g_path_get_dirname (path);
+
+  /* Failing to write the cache is not an error, we just rasterize again next time */
+  if (g_mkdir_with_parents (dir, 0700) == 0)
+    g_file_set_contents (path, (const char *) contents->data, contents->len, NULL);
+
+  g_free (dir);
+  g_free (path);
+  g_byte_array_unref (contents);
+}
@@ -43,6 +43,7 @@
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkdebug.h"
 #include "gtkiconcacheprivate.h"
+#include "gtkiconrastercacheprivate.h"
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "gtksettingsprivate.h"
@@ -404,6 +405,13 @@ struct _GtkIconPaintable
   GMutex texture_lock;
 
   GdkTexture *texture;
+
+  /* State of a pending threaded load, these are accessed atomically.
+   * load_priority is the best priority the icon is queued with, or
+   * G_MAXINT if it is not queued.
+   */
+  int load_priority;
+  int load_cancelled;
 };
 
 typedef struct
@@ -2413,18 +2421,135 @@ choose_icon (GtkIconTheme      *self,
   return icon;
 }
 
+/* Icons are loaded by a small, shared pool of threads. Requests are
+ * sorted by priority, so icons that are visible on screen get loaded
+ * before the ones that are merely preloaded.
+ */
+#define MAX_LOAD_THREADS 4
+
+typedef struct
+{
+  GtkIconPaintable *icon;
+  int priority;
+} IconLoadRequest;
+
+static int
+compare_load_requests (gconstpointer a,
+                       gconstpointer b,
+                       gpointer      user_data)
+{
+  const IconLoadRequest *request_a = a;
+  const IconLoadRequest *request_b = b;
+
+  if (request_a->priority < request_b->priority)
+    return -1;
+  else if (request_a->priority > request_b->priority)
+    return 1;
+
+  return 0;
+}
+
 static void
-load_icon_thread (GTask        *task,
-                  gpointer      source_object,
-                  gpointer      task_data,
-                  GCancellable *cancellable)
+load_icon_func (gpointer data,
+                gpointer user_data)
 {
-  GtkIconPaintable *self = GTK_ICON_PAINTABLE (source_object);
+  IconLoadRequest *request = data;
+  GtkIconPaintable *self = request->icon;
 
-  g_mutex_lock (&self->texture_lock);
-  icon_ensure_texture__locked (self, TRUE);
+  g_atomic_int_set (&self->load_priority, G_MAXINT);
+
+  /* Nobody wants the icon anymore, it will be loaded on demand
+   * if that changes */
+  if (!g_atomic_int_get (&self->load_cancelled))
+    {
+      g_mutex_lock (&self->texture_lock);
+      icon_ensure_texture__locked (self, TRUE);
+      g_mutex_unlock (&self->texture_lock);
+    }
+
+  g_object_unref (self);
+  g_free (request);
+}
+
+static GThreadPool *
+get_load_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (load_icon_func,
+                                    NULL,
+                                    MIN (g_get_num_processors (), MAX_LOAD_THREADS),
+                                    FALSE,
+                                    NULL);
+      g_thread_pool_set_sort_function (new_pool, compare_load_requests, NULL);
+
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/*< private >
+ * gtk_icon_paintable_queue_load:
+ * @self: a #GtkIconPaintable
+ * @priority: the priority of the load, lower values are loaded first
+ *
+ * Queues loading the texture of @self in a thread, if it isn't
+ * loaded yet. Queueing an icon again with a higher priority makes
+ * it jump ahead of other queued icons.
+ */
+void
+gtk_icon_paintable_queue_load (GtkIconPaintable *self,
+                               int               priority)
+{
+  IconLoadRequest *request;
+  gboolean has_texture;
+  int old_priority;
+
+  g_atomic_int_set (&self->load_cancelled, FALSE);
+
+  /* If we fail to get the lock it is because some other thread is
+     currently loading the icon, so we need to do nothing */
+  if (!g_mutex_trylock (&self->texture_lock))
+    return;
+
+  has_texture = self->texture != NULL;
   g_mutex_unlock (&self->texture_lock);
-  g_task_return_pointer (task, NULL, NULL);
+
+  if (has_texture)
+    return;
+
+  do
+    {
+      old_priority = g_atomic_int_get (&self->load_priority);
+      if (old_priority <= priority)
+        return;
+    }
+  while (!g_atomic_int_compare_and_exchange (&self->load_priority, old_priority, priority));
+
+  request = g_new (IconLoadRequest, 1);
+  request->icon = g_object_ref (self);
+  request->priority = priority;
+
+  g_thread_pool_push (get_load_pool (), request, NULL);
+}
+
+/*< private >
+ * gtk_icon_paintable_cancel_load:
+ * @self: a #GtkIconPaintable
+ *
+ * Tells GTK that a threaded load of @self queued with
+ * gtk_icon_paintable_queue_load() is not needed anymore.
+ * Loads that have already started are not interrupted.
+ */
+void
+gtk_icon_paintable_cancel_load (GtkIconPaintable *self)
+{
+  g_atomic_int_set (&self->load_cancelled, TRUE);
 }
 
 /**
@@ -2501,24 +2626,7 @@ gtk_icon_theme_lookup_icon (GtkIconTheme       *self,
   gtk_icon_theme_unlock (self);
 
   if (flags & GTK_ICON_LOOKUP_PRELOAD)
-    {
-      gboolean has_texture = FALSE;
-
-      /* If we fail to get the lock it is because some other thread is
-         currently loading the icon, so we need to do nothing */
-      if (g_mutex_trylock (&icon->texture_lock))
-        {
-          has_texture = icon->texture != NULL;
-          g_mutex_unlock (&icon->texture_lock);
-
-          if (!has_texture)
-            {
-              GTask *task = g_task_new (icon, NULL, NULL, NULL);
-              g_task_run_in_thread (task, load_icon_thread);
-              g_object_unref (task);
-            }
-        }
-    }
+    gtk_icon_paintable_queue_load (icon, G_PRIORITY_DEFAULT);
 
   return icon;
 }
@@ -3441,6 +3549,7 @@ static void
 gtk_icon_paintable_init (GtkIconPaintable *icon)
 {
   g_mutex_init (&icon->texture_lock);
+  icon->load_priority = G_MAXINT;
 }
 
 static GtkIconPaintable *
@@ -3720,6 +3829,7 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
   gint64 before;
   int pixel_size;
   GError *load_error = NULL;
+  char *raster_cache_key = NULL;
 
   icon_cache_mark_used_if_cached (icon);
 
@@ -3733,6 +3843,27 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
    */
   pixel_size = icon->desired_size * icon->desired_scale;
 
+  /* Rasterizing svgs is expensive, so see if this or another process
+   * did it before
+   */
+  if (icon->is_svg && icon->filename)
+    {
+      raster_cache_key = gtk_icon_raster_cache_get_key (icon->filename,
+                                                        icon->is_resource,
+                                                        gtk_icon_paintable_is_symbolic (icon),
+                                                        pixel_size,
+                                                        icon->desired_scale);
+      if (raster_cache_key)
+        {
+          icon->texture = gtk_icon_raster_cache_lookup (raster_cache_key);
+          if (icon->texture)
+            {
+              g_free (raster_cache_key);
+              goto out;
+            }
+        }
+    }
+
   /* At this point, we need to actually get the icon; either from the
    * builtin image or by loading the file
    */
@@ -3815,6 +3946,10 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
         }
     }
 
+  if (source_pixbuf && raster_cache_key)
+    gtk_icon_raster_cache_store (raster_cache_key, source_pixbuf);
+  g_free (raster_cache_key);
+
   if (!source_pixbuf)
     {
       source_pixbuf = _gdk_pixbuf_new_from_resource (IMAGE_MISSING_RESOURCE_PATH, "png", NULL);
@@ -3827,6 +3962,7 @@ icon_ensure_texture__locked (GtkIconPaintable *icon,
   icon->texture = gdk_texture_new_for_pixbuf (source_pixbuf);
   g_object_unref (source_pixbuf);
 
+out:
   g_assert (icon->texture != NULL);
 
   if (GDK_PROFILER_IS_RUNNING)
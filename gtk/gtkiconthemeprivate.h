@@ -43,4 +43,8 @@ void gtk_icon_paintable_snapshot_with_colors (GtkIconPaintable *icon,
 
 int gtk_icon_theme_get_serial (GtkIconTheme *self);
 
+void gtk_icon_paintable_queue_load  (GtkIconPaintable *self,
+                                     int               priority);
+void gtk_icon_paintable_cancel_load (GtkIconPaintable *self);
+
 #endif /* __GTK_ICON_THEME_PRIVATE_H__ */
@@ -0,0 +1,277 @@
+/*
+ * Copyright © 2021 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkidleschedulerprivate.h"
+
+/* A single idle that runs the incremental work of sort and filter
+ * models, text validation and the like, so that they share one time
+ * budget instead of each taking its own slice of the main loop.
+ *
+ * Tasks run in order of priority, like idles would. Tasks of the same
+ * priority take turns and split the time of a dispatch between them,
+ * while tasks of a lower priority wait until no task of a higher one
+ * is left.
+ *
+ * The time of a dispatch is taken from the gap between the last frame
+ * that was drawn and the next one its frame clock expects, so the work
+ * fits in between frames while something is animating. Without frames
+ * to go by, every dispatch gets a fixed amount of time.
+ */
+
+/* The time a dispatch gets when no frame is expected */
+#define DEFAULT_SLICE_US 1000
+/* Bounds for the time a dispatch gets between frames */
+#define MIN_SLICE_US 250
+#define MAX_SLICE_US 4000
+/* Time left before the next frame for the rest of the main loop */
+#define FRAME_MARGIN_US 2000
+
+typedef struct _GtkIdleTask GtkIdleTask;
+
+struct _GtkIdleTask
+{
+  guint id;
+  int priority;
+  GtkIdleTaskFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+  guint removed : 1;
+};
+
+/* sorted by priority, tasks of the same priority in the order they run */
+static GList *tasks;
+static GtkIdleTask *running_task;
+static guint next_task_id = 1;
+
+static guint source_id;
+static int source_priority;
+
+static gint64 next_frame_time;
+
+static void
+gtk_idle_task_free (GtkIdleTask *task)
+{
+  if (task->notify)
+    task->notify (task->user_data);
+
+  g_slice_free (GtkIdleTask, task);
+}
+
+/* Puts the task after the tasks of the same priority */
+static void
+gtk_idle_scheduler_insert (GtkIdleTask *task)
+{
+  GList *l, *last = NULL;
+
+  for (l = tasks; l; l = l->next)
+    {
+      GtkIdleTask *other = l->data;
+
+      if (other->priority > task->priority)
+        break;
+
+      last = l;
+    }
+
+  if (last)
+    tasks = g_list_insert_before (tasks, last->next, task);
+  else
+    tasks = g_list_prepend (tasks, task);
+}
+
+static gint64
+gtk_idle_scheduler_get_deadline (gint64 now)
+{
+  gint64 slice;
+
+  if (next_frame_time <= now)
+    return now + DEFAULT_SLICE_US;
+
+  slice = next_frame_time - FRAME_MARGIN_US - now;
+
+  return now + CLAMP (slice, MIN_SLICE_US, MAX_SLICE_US);
+}
+
+static gboolean gtk_idle_scheduler_dispatch (gpointer data);
+
+static void
+gtk_idle_scheduler_update_source (void)
+{
+  GtkIdleTask *first;
+
+  if (tasks == NULL)
+    {
+      g_clear_handle_id (&source_id, g_source_remove);
+      return;
+    }
+
+  first = tasks->data;
+  if (source_id != 0 && source_priority == first->priority)
+    return;
+
+  g_clear_handle_id (&source_id, g_source_remove);
+  source_id = g_idle_add_full (first->priority, gtk_idle_scheduler_dispatch, NULL, NULL);
+  g_source_set_name_by_id (source_id, "[gtk] gtk_idle_scheduler_dispatch");
+  source_priority = first->priority;
+}
+
+static gboolean
+gtk_idle_scheduler_dispatch (gpointer data)
+{
+  guint dispatch_source_id = source_id;
+  gint64 now, deadline;
+  guint i, n_tasks;
+  GList *l;
+  int priority;
+
+  g_assert (tasks != NULL);
+
+  priority = ((GtkIdleTask *) tasks->data)->priority;
+  n_tasks = 0;
+  for (l = tasks; l && ((GtkIdleTask *) l->data)->priority == priority; l = l->next)
+    n_tasks++;
+
+  now = g_get_monotonic_time ();
+  deadline = gtk_idle_scheduler_get_deadline (now);
+
+  for (i = 0; i < n_tasks && tasks != NULL; i++)
+    {
+      GtkIdleTask *task = tasks->data;
+      gboolean result;
+
+      /* A task of a higher priority was added by one of the tasks */
+      if (task->priority != priority)
+        break;
+
+      if (i > 0)
+        now = g_get_monotonic_time ();
+
+      running_task = task;
+      result = task->func (task->user_data,
+                           now + MAX (deadline - now, 0) / (n_tasks - i));
+      running_task = NULL;
+
+      tasks = g_list_remove (tasks, task);
+
+      if (task->removed || result == G_SOURCE_REMOVE)
+        gtk_idle_task_free (task);
+      else
+        gtk_idle_scheduler_insert (task);
+    }
+
+  gtk_idle_scheduler_update_source ();
+
+  return source_id == dispatch_source_id ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+/*< private >
+ * gtk_idle_scheduler_add:
+ * @priority: the priority of the task, like the priority of an idle
+ * @func: the function doing the work
+ * @user_data: data to pass to @func
+ * @notify: (nullable): function to call on @user_data when the task is done
+ *
+ * Adds a task to run incrementally in the idle time of the main loop.
+ * The task is called until it returns %G_SOURCE_REMOVE or is removed
+ * with gtk_idle_scheduler_remove().
+ *
+ * Returns: the ID of the task, greater than 0
+ */
+guint
+gtk_idle_scheduler_add (int             priority,
+                        GtkIdleTaskFunc func,
+                        gpointer        user_data,
+                        GDestroyNotify  notify)
+{
+  GtkIdleTask *task;
+
+  g_return_val_if_fail (func != NULL, 0);
+
+  task = g_slice_new0 (GtkIdleTask);
+  task->id = next_task_id++;
+  task->priority = priority;
+  task->func = func;
+  task->user_data = user_data;
+  task->notify = notify;
+
+  gtk_idle_scheduler_insert (task);
+  gtk_idle_scheduler_update_source ();
+
+  return task->id;
+}
+
+/*< private >
+ * gtk_idle_scheduler_remove:
+ * @id: the ID of a task returned by gtk_idle_scheduler_add()
+ *
+ * Removes a task. This may be called from inside of the task.
+ */
+void
+gtk_idle_scheduler_remove (guint id)
+{
+  GList *l;
+
+  g_return_if_fail (id > 0);
+
+  if (running_task && running_task->id == id)
+    {
+      /* gtk_idle_scheduler_dispatch() frees it when it returns */
+      running_task->removed = TRUE;
+      return;
+    }
+
+  for (l = tasks; l; l = l->next)
+    {
+      GtkIdleTask *task = l->data;
+
+      if (task->id == id)
+        {
+          tasks = g_list_delete_link (tasks, l);
+          gtk_idle_task_free (task);
+          gtk_idle_scheduler_update_source ();
+          return;
+        }
+    }
+
+  g_critical ("Idle task %u not found", id);
+}
+
+/*< private >
+ * gtk_idle_scheduler_frame_finished:
+ * @clock: a #GdkFrameClock
+ *
+ * Tells the scheduler that @clock finished drawing a frame, so it can
+ * keep the work it does away from the next frame.
+ */
+void
+gtk_idle_scheduler_frame_finished (GdkFrameClock *clock)
+{
+  gint64 frame_time, refresh_interval, next;
+
+  frame_time = gdk_frame_clock_get_frame_time (clock);
+  gdk_frame_clock_get_refresh_info (clock, frame_time, &refresh_interval, NULL);
+  if (refresh_interval == 0)
+    return;
+
+  next = frame_time + refresh_interval;
+
+  /* With several clocks, the frame that comes first wins */
+  if (next_frame_time <= g_get_monotonic_time () || next < next_frame_time)
+    next_frame_time = next;
+}
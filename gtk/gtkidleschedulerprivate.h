@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2021 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_IDLE_SCHEDULER_PRIVATE_H__
+#define __GTK_IDLE_SCHEDULER_PRIVATE_H__
+
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+/*< private >
+ * GtkIdleTaskFunc:
+ * @user_data: the data passed to gtk_idle_scheduler_add()
+ * @deadline: monotonic time in microseconds at which the task
+ *   should return
+ *
+ * Does a step of incremental work. The function should do at least
+ * a minimal amount of work, even if @deadline has already passed.
+ *
+ * Returns: %G_SOURCE_CONTINUE if there is more work to do,
+ *   %G_SOURCE_REMOVE if the task is done
+ */
+typedef gboolean (* GtkIdleTaskFunc) (gpointer user_data,
+                                      gint64   deadline);
+
+guint           gtk_idle_scheduler_add                  (int              priority,
+                                                         GtkIdleTaskFunc  func,
+                                                         gpointer         user_data,
+                                                         GDestroyNotify   notify);
+void            gtk_idle_scheduler_remove               (guint            id);
+
+void            gtk_idle_scheduler_frame_finished       (GdkFrameClock   *clock);
+
+G_END_DECLS
+
+#endif /* __GTK_IDLE_SCHEDULER_PRIVATE_H__ */
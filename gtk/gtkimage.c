@@ -106,6 +106,8 @@ struct _GtkImageClass
 static void gtk_image_snapshot             (GtkWidget    *widget,
                                             GtkSnapshot  *snapshot);
 static void gtk_image_unrealize            (GtkWidget    *widget);
+static void gtk_image_map                  (GtkWidget    *widget);
+static void gtk_image_unmap                (GtkWidget    *widget);
 static void gtk_image_measure (GtkWidget      *widget,
                                GtkOrientation  orientation,
                                int            for_size,
@@ -164,6 +166,8 @@ gtk_image_class_init (GtkImageClass *class)
   widget_class->snapshot = gtk_image_snapshot;
   widget_class->measure = gtk_image_measure;
   widget_class->unrealize = gtk_image_unrealize;
+  widget_class->map = gtk_image_map;
+  widget_class->unmap = gtk_image_unmap;
   widget_class->css_changed = gtk_image_css_changed;
   widget_class->system_setting_changed = gtk_image_system_setting_changed;
 
@@ -1056,6 +1060,26 @@ gtk_image_unrealize (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_image_parent_class)->unrealize (widget);
 }
 
+static void
+gtk_image_map (GtkWidget *widget)
+{
+  GtkImage *image = GTK_IMAGE (widget);
+
+  GTK_WIDGET_CLASS (gtk_image_parent_class)->map (widget);
+
+  gtk_icon_helper_set_mapped (image->icon_helper, TRUE);
+}
+
+static void
+gtk_image_unmap (GtkWidget *widget)
+{
+  GtkImage *image = GTK_IMAGE (widget);
+
+  gtk_icon_helper_set_mapped (image->icon_helper, FALSE);
+
+  GTK_WIDGET_CLASS (gtk_image_parent_class)->unmap (widget);
+}
+
 static float
 gtk_image_get_baseline_align (GtkImage *image)
 {
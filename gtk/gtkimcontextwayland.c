@@ -47,6 +47,20 @@ struct _GtkIMContextWaylandGlobal
   gboolean focused;
 
   guint serial;
+
+  /* The state the compositor got last, so that requests which would
+   * not change anything can be skipped. Enabling the text input resets
+   * the state on the compositor side, so this is cleared along. */
+  struct {
+    char *text;
+    int cursor_idx;
+    int anchor_idx;
+    cairo_rectangle_int_t cursor_rect;
+    GtkInputHints hints;
+    GtkInputPurpose purpose;
+    guint has_cursor_rect : 1;
+    guint has_content_type : 1;
+  } sent;
 };
 
 struct _GtkIMContextWaylandClass
@@ -124,6 +138,14 @@ gtk_im_context_wayland_get_global (GtkIMContextWayland *self)
   return global;
 }
 
+static void
+forget_sent_state (GtkIMContextWaylandGlobal *global)
+{
+  g_clear_pointer (&global->sent.text, g_free);
+  global->sent.has_cursor_rect = FALSE;
+  global->sent.has_content_type = FALSE;
+}
+
 static void
 notify_external_change (GtkIMContextWayland *context)
 {
@@ -273,24 +295,25 @@ text_input_done (void                     *data,
   text_input_preedit_apply(global);
 }
 
-static void
+static gboolean
 notify_surrounding_text (GtkIMContextWayland *context)
 {
 #define MAX_LEN 4000
   GtkIMContextWaylandGlobal *global;
   const char *start, *end;
   int len, cursor, anchor;
-  char *str = NULL;
 
   if (!context->surrounding.text)
-    return;
+    return FALSE;
   global = gtk_im_context_wayland_get_global (context);
   if (global == NULL)
-    return;
+    return FALSE;
 
   len = strlen (context->surrounding.text);
   cursor = context->surrounding.cursor_idx;
   anchor = context->surrounding.anchor_idx;
+  start = context->surrounding.text;
+  end = &context->surrounding.text[len];
 
   /* The protocol specifies a maximum length of 4KiB on transfers,
    * mangle the surrounding text if it's bigger than that, and relocate
@@ -319,7 +342,7 @@ notify_surrounding_text (GtkIMContextWayland *context)
           if (cursor_len > MAX_LEN)
             {
               g_warn_if_reached ();
-              return;
+              return FALSE;
             }
 
           mid = MIN (context->surrounding.cursor_idx,
@@ -338,20 +361,31 @@ notify_surrounding_text (GtkIMContextWayland *context)
 
       cursor -= start - context->surrounding.text;
       anchor -= start - context->surrounding.text;
-
-      str = g_strndup (start, end - start);
     }
 
+  /* Moving around in a large text often keeps the same part of it */
+  if (global->sent.text &&
+      global->sent.cursor_idx == cursor &&
+      global->sent.anchor_idx == anchor &&
+      strlen (global->sent.text) == (gsize) (end - start) &&
+      memcmp (global->sent.text, start, end - start) == 0)
+    return FALSE;
+
+  g_free (global->sent.text);
+  global->sent.text = g_strndup (start, end - start);
+  global->sent.cursor_idx = cursor;
+  global->sent.anchor_idx = anchor;
+
   zwp_text_input_v3_set_surrounding_text (global->text_input,
-                                          str ? str : context->surrounding.text,
+                                          global->sent.text,
                                           cursor, anchor);
   zwp_text_input_v3_set_text_change_cause (global->text_input,
                                            context->surrounding_change);
-  g_free (str);
+  return TRUE;
 #undef MAX_LEN
 }
 
-static void
+static gboolean
 notify_cursor_location (GtkIMContextWayland *context)
 {
   GtkIMContextWaylandGlobal *global;
@@ -360,7 +394,7 @@ notify_cursor_location (GtkIMContextWayland *context)
 
   global = gtk_im_context_wayland_get_global (context);
   if (global == NULL)
-    return;
+    return FALSE;
 
   rect = context->cursor_rect;
   gtk_widget_translate_coordinates (context->widget,
@@ -370,9 +404,21 @@ notify_cursor_location (GtkIMContextWayland *context)
 
   rect.x = x;
   rect.y = y;
+
+  if (global->sent.has_cursor_rect &&
+      global->sent.cursor_rect.x == rect.x &&
+      global->sent.cursor_rect.y == rect.y &&
+      global->sent.cursor_rect.width == rect.width &&
+      global->sent.cursor_rect.height == rect.height)
+    return FALSE;
+
+  global->sent.cursor_rect = rect;
+  global->sent.has_cursor_rect = TRUE;
+
   zwp_text_input_v3_set_cursor_rectangle (global->text_input,
                                           rect.x, rect.y,
                                           rect.width, rect.height);
+  return TRUE;
 }
 
 static uint32_t
@@ -438,7 +484,7 @@ translate_purpose (GtkInputPurpose purpose)
   return ZWP_TEXT_INPUT_V3_CONTENT_PURPOSE_NORMAL;
 }
 
-static void
+static gboolean
 notify_content_type (GtkIMContextWayland *context)
 {
   GtkIMContextWaylandGlobal *global;
@@ -447,16 +493,26 @@ notify_content_type (GtkIMContextWayland *context)
 
   global = gtk_im_context_wayland_get_global (context);
   if (global == NULL)
-    return;
+    return FALSE;
 
   g_object_get (context,
                 "input-hints", &hints,
                 "input-purpose", &purpose,
                 NULL);
 
+  if (global->sent.has_content_type &&
+      global->sent.hints == hints &&
+      global->sent.purpose == purpose)
+    return FALSE;
+
+  global->sent.hints = hints;
+  global->sent.purpose = purpose;
+  global->sent.has_content_type = TRUE;
+
   zwp_text_input_v3_set_content_type (global->text_input,
                                       translate_hints (hints, purpose),
                                       translate_purpose (purpose));
+  return TRUE;
 }
 
 static void
@@ -530,7 +586,10 @@ released_cb (GtkGestureClick     *gesture,
                                  x, y))
     {
       zwp_text_input_v3_enable (global->text_input);
+      forget_sent_state (global);
       g_signal_emit_by_name (global->current, "retrieve-surrounding", &result);
+      notify_content_type (context);
+      notify_cursor_location (context);
       commit_state (context);
     }
 }
@@ -635,6 +694,7 @@ enable (GtkIMContextWayland       *context_wayland,
 {
   gboolean result;
   zwp_text_input_v3_enable (global->text_input);
+  forget_sent_state (global);
   g_signal_emit_by_name (global->current, "retrieve-surrounding", &result);
   notify_content_type (context_wayland);
   notify_cursor_location (context_wayland);
@@ -729,6 +789,7 @@ registry_handle_global_remove (void               *data,
 
   g_clear_pointer (&global->text_input, zwp_text_input_v3_destroy);
   g_clear_pointer (&global->text_input_manager, zwp_text_input_manager_v3_destroy);
+  forget_sent_state (global);
 }
 
 static const struct wl_registry_listener registry_listener = {
@@ -741,6 +802,7 @@ gtk_im_context_wayland_global_free (gpointer data)
 {
   GtkIMContextWaylandGlobal *global = data;
 
+  g_free (global->sent.text);
   g_free (global);
 }
 
@@ -844,8 +906,8 @@ gtk_im_context_wayland_set_cursor_location (GtkIMContext *context,
     gtk_event_controller_reset (GTK_EVENT_CONTROLLER (context_wayland->gesture));
 
   context_wayland->cursor_rect = *rect;
-  notify_cursor_location (context_wayland);
-  commit_state (context_wayland);
+  if (notify_cursor_location (context_wayland))
+    commit_state (context_wayland);
 }
 
 static void
@@ -867,16 +929,26 @@ gtk_im_context_wayland_set_surrounding (GtkIMContext *context,
 
   context_wayland = GTK_IM_CONTEXT_WAYLAND (context);
 
-  g_free (context_wayland->surrounding.text);
-  context_wayland->surrounding.text = g_strndup (text, len);
+  if (len < 0)
+    len = strlen (text);
+
+  /* Widgets hand out the same text again on every retrieve-surrounding */
+  if (context_wayland->surrounding.text == NULL ||
+      strlen (context_wayland->surrounding.text) != (gsize) len ||
+      memcmp (context_wayland->surrounding.text, text, len) != 0)
+    {
+      g_free (context_wayland->surrounding.text);
+      context_wayland->surrounding.text = g_strndup (text, len);
+    }
+
   context_wayland->surrounding.cursor_idx = cursor_index;
   /* Anchor is not exposed via the set_surrounding interface, emulating. */
   context_wayland->surrounding.anchor_idx = cursor_index;
 
-  notify_surrounding_text (context_wayland);
   /* State changes coming from reset don't have any other opportunity to get
    * committed. */
-  if (context_wayland->surrounding_change !=
+  if (notify_surrounding_text (context_wayland) &&
+      context_wayland->surrounding_change !=
       ZWP_TEXT_INPUT_V3_CHANGE_CAUSE_INPUT_METHOD)
     commit_state (context_wayland);
 }
@@ -921,8 +993,8 @@ gtk_im_context_wayland_class_init (GtkIMContextWaylandClass *klass)
 static void
 on_content_type_changed (GtkIMContextWayland *context)
 {
-  notify_content_type (context);
-  commit_state (context);
+  if (notify_content_type (context))
+    commit_state (context);
 }
 
 static void
@@ -91,6 +91,8 @@ _gtk_im_module_create (const char *context_id)
   if (strcmp (context_id, NONE_ID) == 0)
     return NULL;
 
+  _gtk_io_modules_ensure (GTK_IM_MODULE_EXTENSION_POINT_NAME);
+
   ep = g_io_extension_point_lookup (GTK_IM_MODULE_EXTENSION_POINT_NAME);
   ext = g_io_extension_point_get_extension_by_name (ep, context_id);
   if (ext)
@@ -190,6 +192,8 @@ _gtk_im_module_get_default_context_id (GdkDisplay *display)
   GList *l;
   char *tmp;
 
+  _gtk_io_modules_ensure (GTK_IM_MODULE_EXTENSION_POINT_NAME);
+
   envvar = g_getenv ("GTK_IM_MODULE");
   if (envvar)
     {
@@ -254,10 +258,6 @@ gtk_im_module_ensure_extension_point (void)
 void
 gtk_im_modules_init (void)
 {
-  GIOModuleScope *scope;
-  char **paths;
-  int i;
-
   gtk_im_module_ensure_extension_point ();
 
   g_type_ensure (gtk_im_context_simple_get_type ());
@@ -274,32 +274,5 @@ gtk_im_modules_init (void)
   g_type_ensure (gtk_im_context_quartz_get_type ());
 #endif
 
-  scope = g_io_module_scope_new (G_IO_MODULE_SCOPE_BLOCK_DUPLICATES);
-
-  paths = _gtk_get_module_path ("immodules");
-  for (i = 0; paths[i]; i++)
-    {
-      GTK_NOTE (MODULES,
-                g_print ("Scanning io modules in %s\n", paths[i]));
-      g_io_modules_scan_all_in_directory_with_scope (paths[i], scope);
-    }
-  g_strfreev (paths);
-
-  g_io_module_scope_free (scope);
-
-  if (GTK_DEBUG_CHECK (MODULES))
-    {
-      GIOExtensionPoint *ep;
-      GList *list, *l;
-
-      ep = g_io_extension_point_lookup (GTK_IM_MODULE_EXTENSION_POINT_NAME);
-      list = g_io_extension_point_get_extensions (ep);
-      for (l = list; l; l = l->next)
-        {
-          GIOExtension *ext = l->data;
-          g_print ("extension: %s: type %s\n",
-                   g_io_extension_get_name (ext),
-                   g_type_name (g_io_extension_get_type (ext)));
-        }
-    }
+  _gtk_io_modules_scan_async ("immodules", GTK_IM_MODULE_EXTENSION_POINT_NAME);
 }
@@ -41,6 +41,7 @@
 #include "gtknotebook.h"
 #include "gtkpango.h"
 #include "gtkprivate.h"
+#include "gtkshapingcacheprivate.h"
 #include "gtkshortcut.h"
 #include "gtkshortcutcontroller.h"
 #include "gtkshortcuttrigger.h"
@@ -262,6 +263,7 @@ struct _GtkLabel
   PangoAttrList *attrs;
   PangoAttrList *markup_attrs;
   PangoLayout   *layout;
+  GArray        *wrap_bands; /* GtkLabelWrapBand, see get_height_for_width() */
 
   GtkWidget *popup_menu;
   GMenuModel *extra_menu;
@@ -417,6 +419,7 @@ static void gtk_label_do_popup                   (GtkLabel      *self,
 static void gtk_label_ensure_select_info  (GtkLabel *self);
 static void gtk_label_clear_select_info   (GtkLabel *self);
 static void gtk_label_clear_layout        (GtkLabel *self);
+static void gtk_label_clear_wrap_bands    (GtkLabel *self);
 static void gtk_label_ensure_layout       (GtkLabel *self);
 static void gtk_label_select_region_index (GtkLabel *self,
                                            int       anchor_index,
@@ -847,6 +850,9 @@ gtk_label_css_changed (GtkWidget         *widget,
 
   GTK_WIDGET_CLASS (gtk_label_parent_class)->css_changed (widget, change);
 
+  if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_SIZE))
+    gtk_label_clear_wrap_bands (self);
+
   if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_ATTRS))
     {
       new_attrs = gtk_css_style_get_pango_attributes (gtk_css_style_change_get_new_style (change));
@@ -858,6 +864,7 @@ gtk_label_css_changed (GtkWidget         *widget,
 
   if (change == NULL || attrs_affected  || (self->select_info && self->select_info->links))
     {
+      gtk_label_clear_wrap_bands (self);
       gtk_label_update_layout_attributes (self, new_attrs);
 
       if (attrs_affected)
@@ -1012,6 +1019,90 @@ gtk_label_get_measuring_layout (GtkLabel    *self,
   return copy;
 }
 
+/* Pango breaks lines greedily, so a layout that was wrapped at
+ * max_width and whose widest line is min_width is wrapped the same
+ * at any width in between. Wrap bands remember these ranges for
+ * the widths a label was measured at, so measuring its height for
+ * another width in the range doesn't lay out the text again.
+ */
+#define MAX_WRAP_BANDS 8
+
+typedef struct {
+  int min_width;  /* in Pango units */
+  int max_width;
+  int height;     /* in pixels */
+  int baseline;
+} GtkLabelWrapBand;
+
+static void
+gtk_label_clear_wrap_bands (GtkLabel *self)
+{
+  if (self->wrap_bands)
+    g_array_set_size (self->wrap_bands, 0);
+}
+
+static gboolean
+gtk_label_can_use_wrap_bands (GtkLabel *self)
+{
+  /* Ellipsizing depends on the exact width */
+  return self->wrap && self->ellipsize == PANGO_ELLIPSIZE_NONE;
+}
+
+static gboolean
+gtk_label_lookup_wrap_band (GtkLabel *self,
+                            int       width,
+                            int      *height,
+                            int      *baseline)
+{
+  guint i;
+
+  if (self->wrap_bands == NULL || !gtk_label_can_use_wrap_bands (self))
+    return FALSE;
+
+  for (i = 0; i < self->wrap_bands->len; i++)
+    {
+      const GtkLabelWrapBand *band = &g_array_index (self->wrap_bands, GtkLabelWrapBand, i);
+
+      if (band->min_width <= width && width <= band->max_width)
+        {
+          *height = band->height;
+          *baseline = band->baseline;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_label_add_wrap_band (GtkLabel             *self,
+                         const PangoRectangle *logical_rect,
+                         int                   max_width,
+                         int                   baseline)
+{
+  GtkLabelWrapBand band;
+  PangoRectangle rect = *logical_rect;
+  int height, band_baseline;
+
+  if (!gtk_label_can_use_wrap_bands (self) || rect.width > max_width ||
+      gtk_label_lookup_wrap_band (self, max_width, &height, &band_baseline))
+    return;
+
+  pango_extents_to_pixels (&rect, NULL);
+
+  band.min_width = logical_rect->width;
+  band.max_width = max_width;
+  band.height = rect.height;
+  band.baseline = baseline / PANGO_SCALE;
+
+  if (self->wrap_bands == NULL)
+    self->wrap_bands = g_array_sized_new (FALSE, FALSE, sizeof (GtkLabelWrapBand), MAX_WRAP_BANDS);
+  else if (self->wrap_bands->len == MAX_WRAP_BANDS)
+    g_array_remove_index (self->wrap_bands, 0);
+
+  g_array_append_val (self->wrap_bands, band);
+}
+
 static void
 get_height_for_width (GtkLabel *self,
                       int       width,
@@ -1021,20 +1112,27 @@ get_height_for_width (GtkLabel *self,
                       int      *natural_baseline)
 {
   PangoLayout *layout;
+  PangoRectangle rect;
   int text_height, baseline;
 
-  layout = gtk_label_get_measuring_layout (self, NULL, width * PANGO_SCALE);
+  if (!gtk_label_lookup_wrap_band (self, width * PANGO_SCALE, &text_height, &baseline))
+    {
+      layout = gtk_label_get_measuring_layout (self, NULL, width * PANGO_SCALE);
 
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+      gtk_shaping_cache_get_extents (layout, &rect, &baseline);
+      gtk_label_add_wrap_band (self, &rect, width * PANGO_SCALE, baseline);
+      pango_extents_to_pixels (&rect, NULL);
+      text_height = rect.height;
+      baseline = baseline / PANGO_SCALE;
+
+      g_object_unref (layout);
+    }
 
   *minimum_height = text_height;
   *natural_height = text_height;
 
-  baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
   *minimum_baseline = baseline;
   *natural_baseline = baseline;
-
-  g_object_unref (layout);
 }
 
 static int
@@ -1090,10 +1188,12 @@ gtk_label_get_preferred_layout_size (GtkLabel *self,
   else
     char_pixels = 0;
 
-  pango_layout_get_extents (layout, NULL, widest);
+  gtk_shaping_cache_get_extents (layout, widest, widest_baseline);
+  /* The unwrapped layout is what any width that fits it gets */
+  gtk_label_add_wrap_band (self, widest, G_MAXINT, *widest_baseline);
   widest->width = MAX (widest->width, char_pixels * self->width_chars);
   widest->x = widest->y = 0;
-  *widest_baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+  *widest_baseline /= PANGO_SCALE;
 
   if (self->ellipsize || self->wrap)
     {
@@ -1103,22 +1203,22 @@ gtk_label_get_preferred_layout_size (GtkLabel *self,
                                                self->width_chars > -1 ? char_pixels * self->width_chars
                                                                       : 0);
 
-      pango_layout_get_extents (layout, NULL, smallest);
+      gtk_shaping_cache_get_extents (layout, smallest, smallest_baseline);
       smallest->width = MAX (smallest->width, char_pixels * self->width_chars);
       smallest->x = smallest->y = 0;
 
-      *smallest_baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+      *smallest_baseline /= PANGO_SCALE;
 
       if (self->max_width_chars > -1 && widest->width > char_pixels * self->max_width_chars)
         {
           layout = gtk_label_get_measuring_layout (self,
                                                    layout,
                                                    MAX (smallest->width, char_pixels * self->max_width_chars));
-          pango_layout_get_extents (layout, NULL, widest);
+          gtk_shaping_cache_get_extents (layout, widest, widest_baseline);
           widest->width = MAX (widest->width, char_pixels * self->width_chars);
           widest->x = widest->y = 0;
 
-          *widest_baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+          *widest_baseline /= PANGO_SCALE;
         }
 
       if (widest->width < smallest->width)
@@ -1199,7 +1299,8 @@ gtk_label_measure (GtkWidget      *widget,
 
   if (orientation == GTK_ORIENTATION_VERTICAL && for_size != -1 && self->wrap)
     {
-      gtk_label_clear_layout (self);
+      /* Nothing about the text changed, so keep the wrap bands */
+      g_clear_object (&self->layout);
 
       get_height_for_width (self, for_size, minimum, natural, minimum_baseline, natural_baseline);
     }
@@ -1445,6 +1546,7 @@ gtk_label_finalize (GObject *object)
   g_free (self->text);
 
   g_clear_object (&self->layout);
+  g_clear_pointer (&self->wrap_bands, g_array_unref);
   g_clear_pointer (&self->attrs, pango_attr_list_unref);
   g_clear_pointer (&self->markup_attrs, pango_attr_list_unref);
 
@@ -3898,6 +4000,7 @@ static void
 gtk_label_clear_layout (GtkLabel *self)
 {
   g_clear_object (&self->layout);
+  gtk_label_clear_wrap_bands (self);
 }
 
 static void
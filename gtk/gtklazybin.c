@@ -0,0 +1,569 @@
+/* gtklazybin.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtklazybin.h"
+
+#include "gtkbinlayout.h"
+#include "gtkbuildable.h"
+#include "gtkbuilder.h"
+#include "gtkbuilderprivate.h"
+#include "gtkintl.h"
+#include "gtkprivate.h"
+#include "gtkwidgetprivate.h"
+
+/**
+ * SECTION:gtklazybin
+ * @Title: GtkLazyBin
+ * @Short_description: A widget that builds its child on demand
+ * @See_also: #GtkStack, #GtkNotebook, #GtkBuilderListItemFactory
+ *
+ * #GtkLazyBin is a single-child widget that creates its child from a
+ * #GtkBuilder UI template the first time it is mapped.
+ *
+ * This is useful for containers that only show some of their children
+ * at a time, like the pages of a #GtkStack, #GtkNotebook or #GtkAssistant.
+ * Pages that are wrapped in a #GtkLazyBin don't cost anything until they
+ * are shown for the first time.
+ *
+ * The template must be extending #GtkLazyBin and set its
+ * #GtkLazyBin:child property:
+ * |[
+ *   <interface>
+ *     <template class="GtkLazyBin">
+ *       <property name="child">
+ *         <object class="GtkBox">
+ *           ...
+ *         </object>
+ *       </property>
+ *     </template>
+ *   </interface>
+ * ]|
+ *
+ * Note that a #GtkLazyBin has no size until its child is created, so
+ * containers that size all of their children alike, like a homogeneous
+ * #GtkStack, will not take the size of unbuilt pages into account.
+ * Use gtk_lazy_bin_ensure_child() to create the child early.
+ *
+ * # CSS nodes
+ *
+ * GtkLazyBin has a single CSS node with the name lazybin.
+ *
+ * # Accessibility
+ *
+ * GtkLazyBin uses the #GTK_ACCESSIBLE_ROLE_GROUP role.
+ */
+
+struct _GtkLazyBin
+{
+  GtkWidget parent_instance;
+
+  GtkWidget *child;
+
+  GtkBuilderScope *scope;
+  GBytes *bytes;
+  GBytes *data;
+  char *resource;
+};
+
+enum {
+  PROP_0,
+  PROP_BYTES,
+  PROP_RESOURCE,
+  PROP_SCOPE,
+  PROP_CHILD,
+
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS] = { NULL, };
+
+static void gtk_lazy_bin_buildable_iface_init (GtkBuildableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GtkLazyBin, gtk_lazy_bin, GTK_TYPE_WIDGET,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE, gtk_lazy_bin_buildable_iface_init))
+
+static GtkBuildableIface *parent_buildable_iface;
+
+static void
+gtk_lazy_bin_buildable_add_child (GtkBuildable *buildable,
+                                  GtkBuilder   *builder,
+                                  GObject      *child,
+                                  const char   *type)
+{
+  if (GTK_IS_WIDGET (child))
+    gtk_lazy_bin_set_child (GTK_LAZY_BIN (buildable), GTK_WIDGET (child));
+  else
+    parent_buildable_iface->add_child (buildable, builder, child, type);
+}
+
+static void
+gtk_lazy_bin_buildable_iface_init (GtkBuildableIface *iface)
+{
+  parent_buildable_iface = g_type_interface_peek_parent (iface);
+
+  iface->add_child = gtk_lazy_bin_buildable_add_child;
+}
+
+static gboolean
+gtk_lazy_bin_set_bytes (GtkLazyBin *self,
+                        GBytes     *bytes)
+{
+  if (bytes == NULL)
+    return FALSE;
+
+  if (self->bytes)
+    {
+      g_critical ("Data for GtkLazyBin has already been set.");
+      return FALSE;
+    }
+
+  self->bytes = g_bytes_ref (bytes);
+
+  if (!_gtk_buildable_parser_is_precompiled (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes)))
+    {
+      GError *error = NULL;
+      GBytes *data;
+
+      data = _gtk_buildable_parser_precompile (g_bytes_get_data (bytes, NULL),
+                                               g_bytes_get_size (bytes),
+                                               &error);
+      if (data == NULL)
+        {
+          g_warning ("Failed to precompile template for GtkLazyBin: %s", error->message);
+          g_error_free (error);
+          self->data = g_bytes_ref (bytes);
+        }
+      else
+        {
+          self->data = data;
+        }
+    }
+  else
+    {
+      self->data = g_bytes_ref (bytes);
+    }
+
+  return TRUE;
+}
+
+static void
+gtk_lazy_bin_map (GtkWidget *widget)
+{
+  GtkLazyBin *self = GTK_LAZY_BIN (widget);
+
+  /* Create the child before chaining up, so it gets mapped with us */
+  gtk_lazy_bin_ensure_child (self);
+
+  GTK_WIDGET_CLASS (gtk_lazy_bin_parent_class)->map (widget);
+}
+
+static void
+gtk_lazy_bin_dispose (GObject *object)
+{
+  GtkLazyBin *self = GTK_LAZY_BIN (object);
+
+  g_clear_pointer (&self->child, gtk_widget_unparent);
+
+  G_OBJECT_CLASS (gtk_lazy_bin_parent_class)->dispose (object);
+}
+
+static void
+gtk_lazy_bin_finalize (GObject *object)
+{
+  GtkLazyBin *self = GTK_LAZY_BIN (object);
+
+  g_clear_object (&self->scope);
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+  g_clear_pointer (&self->data, g_bytes_unref);
+  g_free (self->resource);
+
+  G_OBJECT_CLASS (gtk_lazy_bin_parent_class)->finalize (object);
+}
+
+static void
+gtk_lazy_bin_get_property (GObject    *object,
+                           guint       property_id,
+                           GValue     *value,
+                           GParamSpec *pspec)
+{
+  GtkLazyBin *self = GTK_LAZY_BIN (object);
+
+  switch (property_id)
+    {
+    case PROP_BYTES:
+      g_value_set_boxed (value, self->bytes);
+      break;
+
+    case PROP_RESOURCE:
+      g_value_set_string (value, self->resource);
+      break;
+
+    case PROP_SCOPE:
+      g_value_set_object (value, self->scope);
+      break;
+
+    case PROP_CHILD:
+      g_value_set_object (value, self->child);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_lazy_bin_set_property (GObject      *object,
+                           guint         property_id,
+                           const GValue *value,
+                           GParamSpec   *pspec)
+{
+  GtkLazyBin *self = GTK_LAZY_BIN (object);
+
+  switch (property_id)
+    {
+    case PROP_BYTES:
+      gtk_lazy_bin_set_bytes (self, g_value_get_boxed (value));
+      break;
+
+    case PROP_RESOURCE:
+      {
+        GError *error = NULL;
+        GBytes *bytes;
+        const char *resource;
+
+        resource = g_value_get_string (value);
+        if (resource == NULL)
+          break;
+
+        bytes = g_resources_lookup_data (resource, 0, &error);
+        if (bytes)
+          {
+            if (gtk_lazy_bin_set_bytes (self, bytes))
+              self->resource = g_strdup (resource);
+            g_bytes_unref (bytes);
+          }
+        else
+          {
+            g_critical ("Unable to load resource for GtkLazyBin: %s", error->message);
+            g_error_free (error);
+          }
+      }
+      break;
+
+    case PROP_SCOPE:
+      self->scope = g_value_dup_object (value);
+      break;
+
+    case PROP_CHILD:
+      gtk_lazy_bin_set_child (self, g_value_get_object (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_lazy_bin_class_init (GtkLazyBinClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = gtk_lazy_bin_dispose;
+  object_class->finalize = gtk_lazy_bin_finalize;
+  object_class->get_property = gtk_lazy_bin_get_property;
+  object_class->set_property = gtk_lazy_bin_set_property;
+
+  widget_class->map = gtk_lazy_bin_map;
+
+  /**
+   * GtkLazyBin:bytes:
+   *
+   * bytes containing the UI definition of the child
+   *
+   * Since: 4.2
+   */
+  properties[PROP_BYTES] =
+    g_param_spec_boxed ("bytes",
+                        P_("Bytes"),
+                        P_("bytes containing the UI definition"),
+                        G_TYPE_BYTES,
+                        GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GtkLazyBin:resource:
+   *
+   * resource containing the UI definition of the child
+   *
+   * Since: 4.2
+   */
+  properties[PROP_RESOURCE] =
+    g_param_spec_string ("resource",
+                         P_("Resource"),
+                         P_("resource containing the UI definition"),
+                         NULL,
+                         GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GtkLazyBin:scope:
+   *
+   * scope to use when creating the child
+   *
+   * Since: 4.2
+   */
+  properties[PROP_SCOPE] =
+    g_param_spec_object ("scope",
+                         P_("Scope"),
+                         P_("scope to use when creating the child"),
+                         GTK_TYPE_BUILDER_SCOPE,
+                         GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GtkLazyBin:child:
+   *
+   * The child widget, or %NULL if it has not been created yet
+   *
+   * Since: 4.2
+   */
+  properties[PROP_CHILD] =
+    g_param_spec_object ("child",
+                         P_("Child"),
+                         P_("The child widget"),
+                         GTK_TYPE_WIDGET,
+                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
+  gtk_widget_class_set_css_name (widget_class, I_("lazybin"));
+  gtk_widget_class_set_accessible_role (widget_class, GTK_ACCESSIBLE_ROLE_GROUP);
+}
+
+static void
+gtk_lazy_bin_init (GtkLazyBin *self)
+{
+}
+
+/**
+ * gtk_lazy_bin_new_from_bytes:
+ * @scope: (nullable) (transfer none): A scope to use when creating the child
+ * @bytes: the bytes containing the ui file to instantiate
+ *
+ * Creates a new #GtkLazyBin that creates its child using @bytes
+ * as the data to pass to #GtkBuilder.
+ *
+ * Returns: a new #GtkLazyBin
+ *
+ * Since: 4.2
+ **/
+GtkWidget *
+gtk_lazy_bin_new_from_bytes (GtkBuilderScope *scope,
+                             GBytes          *bytes)
+{
+  g_return_val_if_fail (scope == NULL || GTK_IS_BUILDER_SCOPE (scope), NULL);
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  return g_object_new (GTK_TYPE_LAZY_BIN,
+                       "bytes", bytes,
+                       "scope", scope,
+                       NULL);
+}
+
+/**
+ * gtk_lazy_bin_new_from_resource:
+ * @scope: (nullable) (transfer none): A scope to use when creating the child
+ * @resource_path: valid path to a resource that contains the data
+ *
+ * Creates a new #GtkLazyBin that creates its child using data read
+ * from the given @resource_path to pass to #GtkBuilder.
+ *
+ * Returns: a new #GtkLazyBin
+ *
+ * Since: 4.2
+ **/
+GtkWidget *
+gtk_lazy_bin_new_from_resource (GtkBuilderScope *scope,
+                                const char      *resource_path)
+{
+  g_return_val_if_fail (scope == NULL || GTK_IS_BUILDER_SCOPE (scope), NULL);
+  g_return_val_if_fail (resource_path != NULL, NULL);
+
+  return g_object_new (GTK_TYPE_LAZY_BIN,
+                       "resource", resource_path,
+                       "scope", scope,
+                       NULL);
+}
+
+/**
+ * gtk_lazy_bin_get_bytes:
+ * @self: a #GtkLazyBin
+ *
+ * Gets the data used as the #GtkBuilder UI template for creating
+ * the child.
+ *
+ * Returns: (transfer none) (nullable): The GtkBuilder data
+ *
+ * Since: 4.2
+ **/
+GBytes *
+gtk_lazy_bin_get_bytes (GtkLazyBin *self)
+{
+  g_return_val_if_fail (GTK_IS_LAZY_BIN (self), NULL);
+
+  return self->bytes;
+}
+
+/**
+ * gtk_lazy_bin_get_resource:
+ * @self: a #GtkLazyBin
+ *
+ * If the data references a resource, gets the path of that resource.
+ *
+ * Returns: (transfer none) (nullable): The path to the resource or %NULL
+ *     if none
+ *
+ * Since: 4.2
+ **/
+const char *
+gtk_lazy_bin_get_resource (GtkLazyBin *self)
+{
+  g_return_val_if_fail (GTK_IS_LAZY_BIN (self), NULL);
+
+  return self->resource;
+}
+
+/**
+ * gtk_lazy_bin_get_scope:
+ * @self: a #GtkLazyBin
+ *
+ * Gets the scope used when creating the child.
+ *
+ * Returns: (transfer none) (nullable): The scope used when creating the child
+ *
+ * Since: 4.2
+ **/
+GtkBuilderScope *
+gtk_lazy_bin_get_scope (GtkLazyBin *self)
+{
+  g_return_val_if_fail (GTK_IS_LAZY_BIN (self), NULL);
+
+  return self->scope;
+}
+
+/**
+ * gtk_lazy_bin_get_child:
+ * @self: a #GtkLazyBin
+ *
+ * Gets the child widget of @self.
+ *
+ * The child only exists after @self has been mapped or
+ * gtk_lazy_bin_ensure_child() has been called.
+ *
+ * Returns: (nullable) (transfer none): the child widget of @self
+ *
+ * Since: 4.2
+ */
+GtkWidget *
+gtk_lazy_bin_get_child (GtkLazyBin *self)
+{
+  g_return_val_if_fail (GTK_IS_LAZY_BIN (self), NULL);
+
+  return self->child;
+}
+
+/**
+ * gtk_lazy_bin_set_child:
+ * @self: a #GtkLazyBin
+ * @child: (allow-none): the child widget
+ *
+ * Sets the child widget of @self.
+ *
+ * Setting a child prevents @self from creating one from its
+ * UI template.
+ *
+ * Since: 4.2
+ */
+void
+gtk_lazy_bin_set_child (GtkLazyBin *self,
+                        GtkWidget  *child)
+{
+  g_return_if_fail (GTK_IS_LAZY_BIN (self));
+  g_return_if_fail (child == NULL || GTK_IS_WIDGET (child));
+
+  if (self->child == child)
+    return;
+
+  g_clear_pointer (&self->child, gtk_widget_unparent);
+
+  self->child = child;
+
+  if (child)
+    gtk_widget_set_parent (child, GTK_WIDGET (self));
+
+  /* Once a child was set, the template is not needed anymore */
+  g_clear_pointer (&self->data, g_bytes_unref);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CHILD]);
+}
+
+/**
+ * gtk_lazy_bin_ensure_child:
+ * @self: a #GtkLazyBin
+ *
+ * Creates the child of @self from its UI template, if that
+ * has not happened yet.
+ *
+ * This is done automatically when @self is mapped.
+ *
+ * Since: 4.2
+ */
+void
+gtk_lazy_bin_ensure_child (GtkLazyBin *self)
+{
+  GtkBuilder *builder;
+  GError *error = NULL;
+  GBytes *data;
+
+  g_return_if_fail (GTK_IS_LAZY_BIN (self));
+
+  if (self->data == NULL)
+    return;
+
+  /* Building sets the child, which drops the template */
+  data = g_steal_pointer (&self->data);
+
+  builder = gtk_builder_new ();
+
+  gtk_builder_set_current_object (builder, G_OBJECT (self));
+  if (self->scope)
+    gtk_builder_set_scope (builder, self->scope);
+
+  if (!gtk_builder_extend_with_template (builder, G_OBJECT (self), G_OBJECT_TYPE (self),
+                                         (const char *)g_bytes_get_data (data, NULL),
+                                         g_bytes_get_size (data),
+                                         &error))
+    {
+      g_critical ("Error building template for GtkLazyBin: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_object_unref (builder);
+  g_bytes_unref (data);
+}
@@ -0,0 +1,59 @@
+/* gtklazybin.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_LAZY_BIN_H__
+#define __GTK_LAZY_BIN_H__
+
+#if !defined (__GTK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gtk/gtk.h> can be included directly."
+#endif
+
+#include <gtk/gtkbuilderscope.h>
+#include <gtk/gtkwidget.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_LAZY_BIN (gtk_lazy_bin_get_type ())
+
+GDK_AVAILABLE_IN_4_2
+G_DECLARE_FINAL_TYPE (GtkLazyBin, gtk_lazy_bin, GTK, LAZY_BIN, GtkWidget)
+
+GDK_AVAILABLE_IN_4_2
+GtkWidget *             gtk_lazy_bin_new_from_bytes             (GtkBuilderScope        *scope,
+                                                                 GBytes                 *bytes);
+GDK_AVAILABLE_IN_4_2
+GtkWidget *             gtk_lazy_bin_new_from_resource          (GtkBuilderScope        *scope,
+                                                                 const char             *resource_path);
+
+GDK_AVAILABLE_IN_4_2
+GBytes *                gtk_lazy_bin_get_bytes                  (GtkLazyBin             *self);
+GDK_AVAILABLE_IN_4_2
+const char *            gtk_lazy_bin_get_resource               (GtkLazyBin             *self);
+GDK_AVAILABLE_IN_4_2
+GtkBuilderScope *       gtk_lazy_bin_get_scope                  (GtkLazyBin             *self);
+
+GDK_AVAILABLE_IN_4_2
+GtkWidget *             gtk_lazy_bin_get_child                  (GtkLazyBin             *self);
+GDK_AVAILABLE_IN_4_2
+void                    gtk_lazy_bin_set_child                  (GtkLazyBin             *self,
+                                                                 GtkWidget              *child);
+
+GDK_AVAILABLE_IN_4_2
+void                    gtk_lazy_bin_ensure_child               (GtkLazyBin             *self);
+
+G_END_DECLS
+
+#endif /* __GTK_LAZY_BIN_H__ */
@@ -80,8 +80,20 @@ struct _GtkListBasePrivate
   guint autoscroll_id;
   double autoscroll_delta_x;
   double autoscroll_delta_y;
+
+  /* for deferring binds while scrolling fast */
+  guint deferred_bind_id;
+  double scroll_value;
+  gint64 scroll_time;
 };
 
+/* Scroll speed in pixels per second above which binds are deferred */
+#define DEFER_BIND_VELOCITY 3000
+/* Time without scrolling after which deferred binds are run */
+#define DEFER_BIND_IDLE_US (50 * 1000)
+/* Time per frame spent on running deferred binds */
+#define DEFER_BIND_BUDGET_US (4 * 1000)
+
 enum
 {
   PROP_0,
@@ -169,6 +181,53 @@ gtk_list_base_get_adjustment_values (GtkListBase    *self,
     *page_size = ps;
 }
 
+static gboolean
+deferred_bind_cb (GtkWidget     *widget,
+                  GdkFrameClock *frame_clock,
+                  gpointer       data)
+{
+  GtkListBase *self = data;
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+
+  if (gtk_list_item_manager_get_defer_binds (priv->item_manager))
+    {
+      if (g_get_monotonic_time () - priv->scroll_time < DEFER_BIND_IDLE_US)
+        return G_SOURCE_CONTINUE;
+
+      gtk_list_item_manager_set_defer_binds (priv->item_manager, FALSE);
+    }
+
+  if (gtk_list_item_manager_run_deferred_binds (priv->item_manager, DEFER_BIND_BUDGET_US))
+    return G_SOURCE_CONTINUE;
+
+  priv->deferred_bind_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_list_base_update_scroll_velocity (GtkListBase *self)
+{
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  gint64 now;
+  double value, velocity;
+
+  now = g_get_monotonic_time ();
+  value = gtk_adjustment_get_value (priv->adjustment[priv->orientation]);
+
+  if (priv->scroll_time != 0)
+    velocity = fabs (value - priv->scroll_value) * G_USEC_PER_SEC / MAX (1, now - priv->scroll_time);
+  else
+    velocity = 0;
+
+  priv->scroll_value = value;
+  priv->scroll_time = now;
+
+  gtk_list_item_manager_set_defer_binds (priv->item_manager, velocity > DEFER_BIND_VELOCITY);
+
+  if (velocity > DEFER_BIND_VELOCITY && priv->deferred_bind_id == 0)
+    priv->deferred_bind_id = gtk_widget_add_tick_callback (GTK_WIDGET (self), deferred_bind_cb, self, NULL);
+}
+
 static void
 gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
                                            GtkListBase   *self)
@@ -180,6 +239,9 @@ gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
   GtkPackType side_across, side_along;
   guint pos;
 
+  if (adjustment == priv->adjustment[priv->orientation])
+    gtk_list_base_update_scroll_velocity (self);
+
   gtk_list_base_get_adjustment_values (self, OPPOSITE_ORIENTATION (priv->orientation), &area.x, &total_size, &area.width);
   if (total_size == area.width)
     align_across = 0.5;
@@ -571,6 +633,12 @@ gtk_list_base_dispose (GObject *object)
   GtkListBase *self = GTK_LIST_BASE (object);
   GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
 
+  if (priv->deferred_bind_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->deferred_bind_id);
+      priv->deferred_bind_id = 0;
+    }
+
   gtk_list_base_clear_adjustment (self, GTK_ORIENTATION_HORIZONTAL);
   gtk_list_base_clear_adjustment (self, GTK_ORIENTATION_VERTICAL);
 
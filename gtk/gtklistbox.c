@@ -138,6 +138,10 @@ struct _GtkListBox
   GtkListBoxCreateWidgetFunc create_widget_func;
   gpointer create_widget_func_data;
   GDestroyNotify create_widget_func_data_destroy;
+
+  /* rows queued with gtk_list_box_row_queue_changed() */
+  GHashTable *changed_rows;
+  guint changed_rows_id;
 };
 
 struct _GtkListBoxClass
@@ -425,10 +429,18 @@ gtk_list_box_set_property (GObject      *obj,
 static void
 gtk_list_box_dispose (GObject *object)
 {
+  GtkListBox *box = GTK_LIST_BOX (object);
   GtkWidget *child;
 
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (object))))
-    gtk_list_box_remove (GTK_LIST_BOX (object), child);
+    gtk_list_box_remove (box, child);
+
+  if (box->changed_rows_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (box), box->changed_rows_id);
+      box->changed_rows_id = 0;
+    }
+  g_clear_pointer (&box->changed_rows, g_hash_table_unref);
 
   G_OBJECT_CLASS (gtk_list_box_parent_class)->dispose (object);
 }
@@ -1399,6 +1411,107 @@ gtk_list_box_got_row_changed (GtkListBox    *box,
     }
 }
 
+/* Applies the changes of all rows queued with gtk_list_box_row_queue_changed().
+ * The changed rows are taken out of the sequence first, so that each of them
+ * can be put back in place with a binary search among correctly sorted rows.
+ */
+static void
+gtk_list_box_apply_changed_rows (GtkListBox *box)
+{
+  GHashTableIter hash_iter;
+  GSequence *changed;
+  GSequenceIter *iter;
+  GPtrArray *rows, *old_next;
+  gpointer row;
+  guint i;
+
+  rows = g_ptr_array_sized_new (g_hash_table_size (box->changed_rows));
+  g_hash_table_iter_init (&hash_iter, box->changed_rows);
+  while (g_hash_table_iter_next (&hash_iter, &row, NULL))
+    g_ptr_array_add (rows, row);
+  g_hash_table_remove_all (box->changed_rows);
+
+  changed = g_sequence_new (NULL);
+  old_next = g_ptr_array_new ();
+
+  for (i = 0; i < rows->len; i++)
+    {
+      iter = ROW_PRIV (g_ptr_array_index (rows, i))->iter;
+      g_ptr_array_add (old_next, gtk_list_box_get_next_visible (box, iter));
+      if (box->sort_func != NULL)
+        g_sequence_move (iter, g_sequence_get_end_iter (changed));
+    }
+
+  for (i = 0; i < rows->len; i++)
+    {
+      row = g_ptr_array_index (rows, i);
+      iter = ROW_PRIV (row)->iter;
+
+      if (box->sort_func != NULL)
+        {
+          GSequenceIter *next_iter;
+
+          next_iter = g_sequence_search (box->children, row, (GCompareDataFunc)do_sort, box);
+          g_sequence_move (iter, next_iter);
+
+          if (!g_sequence_iter_is_begin (iter))
+            gtk_widget_insert_after (GTK_WIDGET (row), GTK_WIDGET (box),
+                                     g_sequence_get (g_sequence_iter_prev (iter)));
+          else if (!g_sequence_iter_is_end (next_iter))
+            gtk_widget_insert_before (GTK_WIDGET (row), GTK_WIDGET (box),
+                                      g_sequence_get (next_iter));
+        }
+
+      gtk_list_box_apply_filter (box, row);
+    }
+
+  if (gtk_widget_get_visible (GTK_WIDGET (box)))
+    {
+      /* Only the headers of rows whose previous row changed need updating */
+      for (i = 0; i < rows->len; i++)
+        {
+          iter = ROW_PRIV (g_ptr_array_index (rows, i))->iter;
+          gtk_list_box_update_header (box, iter);
+          gtk_list_box_update_header (box, gtk_list_box_get_next_visible (box, iter));
+          gtk_list_box_update_header (box, g_ptr_array_index (old_next, i));
+        }
+    }
+
+  g_ptr_array_unref (old_next);
+  g_ptr_array_unref (rows);
+  g_sequence_free (changed);
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+}
+
+static gboolean
+gtk_list_box_changed_rows_cb (GtkWidget     *widget,
+                              GdkFrameClock *frame_clock,
+                              gpointer       data)
+{
+  GtkListBox *box = GTK_LIST_BOX (widget);
+
+  box->changed_rows_id = 0;
+  gtk_list_box_apply_changed_rows (box);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_list_box_queue_row_changed (GtkListBox    *box,
+                                GtkListBoxRow *row)
+{
+  if (box->changed_rows == NULL)
+    box->changed_rows = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_add (box->changed_rows, row);
+
+  if (box->changed_rows_id == 0)
+    box->changed_rows_id = gtk_widget_add_tick_callback (GTK_WIDGET (box),
+                                                         gtk_list_box_changed_rows_cb,
+                                                         NULL, NULL);
+}
+
 /**
  * gtk_list_box_set_activate_on_single_click:
  * @box: a #GtkListBox
@@ -2352,6 +2465,9 @@ gtk_list_box_remove (GtkListBox *box,
   if (row == box->drag_highlighted_row)
     gtk_list_box_drag_unhighlight_row (box);
 
+  if (box->changed_rows)
+    g_hash_table_remove (box->changed_rows, row);
+
   next = gtk_list_box_get_next_visible (box, iter);
   gtk_widget_unparent (child);
   g_sequence_remove (iter);
@@ -3071,6 +3187,33 @@ gtk_list_box_row_changed (GtkListBoxRow *row)
     gtk_list_box_got_row_changed (box, row);
 }
 
+/**
+ * gtk_list_box_row_queue_changed:
+ * @row: a #GtkListBoxRow
+ *
+ * Like gtk_list_box_row_changed(), but the sorting, filtering
+ * and headers are only updated before the next frame is drawn.
+ *
+ * All rows that were marked as changed until then are updated
+ * together. Each of them is put into place with a binary search,
+ * and only the headers of the rows next to them are updated.
+ * This is much cheaper than calling gtk_list_box_invalidate_sort()
+ * when many rows change often.
+ *
+ * Since: 4.2
+ */
+void
+gtk_list_box_row_queue_changed (GtkListBoxRow *row)
+{
+  GtkListBox *box;
+
+  g_return_if_fail (GTK_IS_LIST_BOX_ROW (row));
+
+  box = gtk_list_box_row_get_box (row);
+  if (box)
+    gtk_list_box_queue_row_changed (box, row);
+}
+
 /**
  * gtk_list_box_row_get_header:
  * @row: a #GtkListBoxRow
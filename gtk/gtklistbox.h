@@ -145,6 +145,8 @@ GDK_AVAILABLE_IN_ALL
 int        gtk_list_box_row_get_index     (GtkListBoxRow *row);
 GDK_AVAILABLE_IN_ALL
 void       gtk_list_box_row_changed       (GtkListBoxRow *row);
+GDK_AVAILABLE_IN_4_2
+void       gtk_list_box_row_queue_changed (GtkListBoxRow *row);
 
 GDK_AVAILABLE_IN_ALL
 gboolean   gtk_list_box_row_is_selected   (GtkListBoxRow *row);
@@ -126,6 +126,8 @@ gtk_list_item_factory_setup (GtkListItemFactory *self,
   list_item = gtk_list_item_new ();
 
   GTK_LIST_ITEM_FACTORY_GET_CLASS (self)->setup (self, widget, list_item);
+
+  self->n_setups++;
 }
 
 void
@@ -141,6 +143,8 @@ gtk_list_item_factory_teardown (GtkListItemFactory *self,
   GTK_LIST_ITEM_FACTORY_GET_CLASS (self)->teardown (self, widget, list_item);
 
   g_object_unref (list_item);
+
+  self->n_teardowns++;
 }
 
 void
@@ -164,3 +168,24 @@ gtk_list_item_factory_update (GtkListItemFactory *self,
   g_object_thaw_notify (G_OBJECT (list_item));
 }
 
+/* Called when a widget is reused without being set up again */
+void
+gtk_list_item_factory_count_recycled (GtkListItemFactory *self)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+
+  self->n_recycled++;
+}
+
+void
+gtk_list_item_factory_get_stats (GtkListItemFactory *self,
+                                 guint              *n_setups,
+                                 guint              *n_teardowns,
+                                 guint              *n_recycled)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_FACTORY (self));
+
+  *n_setups = self->n_setups;
+  *n_teardowns = self->n_teardowns;
+  *n_recycled = self->n_recycled;
+}
@@ -29,6 +29,14 @@ G_BEGIN_DECLS
 struct _GtkListItemFactory
 {
   GObject parent_instance;
+
+  /* bind may be postponed while scrolling fast */
+  guint deferred_bind : 1;
+
+  /* statistics for the inspector */
+  guint n_setups;
+  guint n_teardowns;
+  guint n_recycled;
 };
 
 struct _GtkListItemFactoryClass
@@ -65,6 +73,12 @@ void                    gtk_list_item_factory_update            (GtkListItemFact
                                                                  gpointer                item,
                                                                  gboolean                selected);
 
+void                    gtk_list_item_factory_count_recycled    (GtkListItemFactory     *self);
+void                    gtk_list_item_factory_get_stats         (GtkListItemFactory     *self,
+                                                                 guint                  *n_setups,
+                                                                 guint                  *n_teardowns,
+                                                                 guint                  *n_recycled);
+
 
 G_END_DECLS
 
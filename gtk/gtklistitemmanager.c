@@ -20,7 +20,9 @@
 #include "config.h"
 
 #include "gtklistitemmanagerprivate.h"
+#include "gtkexpressionprivate.h"
 
+#include "gtklistitemfactoryprivate.h"
 #include "gtklistitemwidgetprivate.h"
 #include "gtkwidgetprivate.h"
 
@@ -39,6 +41,17 @@ struct _GtkListItemManager
 
   GtkRbTree *items;
   GSList *trackers;
+
+  /* Hidden widgets that are set up, but not bound to an item */
+  GQueue pool;
+
+  /* Widgets shown without their item while binds are deferred */
+  GHashTable *deferred;
+  gboolean defer_binds;
+
+  guint batch_depth;
+  /* GtkListItems with frozen notifications, or NULL */
+  GPtrArray *batch_items;
 };
 
 struct _GtkListItemManagerClass
@@ -54,6 +67,12 @@ struct _GtkListItemTracker
   guint n_after;
 };
 
+/* Keeping widgets around instead of destroying them avoids
+ * setting them up again, which is expensive for template based
+ * factories.
+ */
+#define DEFAULT_POOL_SIZE 32
+
 static GtkWidget *      gtk_list_item_manager_acquire_list_item (GtkListItemManager     *self,
                                                                  guint                   position,
                                                                  GtkWidget              *prev_sibling);
@@ -419,6 +438,51 @@ gtk_list_item_manager_merge_list_items (GtkListItemManager     *self,
   return TRUE;
 }
 
+static guint
+gtk_list_item_manager_get_max_pool_size (void)
+{
+  static guint max_pool_size = G_MAXUINT;
+
+  if (G_UNLIKELY (max_pool_size == G_MAXUINT))
+    {
+      const char *env = g_getenv ("GTK_LIST_ITEM_POOL_SIZE");
+
+      if (env)
+        max_pool_size = MIN (g_ascii_strtoull (env, NULL, 10), G_MAXUINT - 1);
+      else
+        max_pool_size = DEFAULT_POOL_SIZE;
+    }
+
+  return max_pool_size;
+}
+
+static void
+gtk_list_item_manager_clear_pool (GtkListItemManager *self)
+{
+  GtkWidget *widget;
+
+  while ((widget = g_queue_pop_head (&self->pool)))
+    gtk_widget_unparent (widget);
+}
+
+/* Releases the widgets that were not reacquired */
+static void
+gtk_list_item_manager_release_change (GtkListItemManager *self,
+                                      GHashTable         *change)
+{
+  GHashTableIter iter;
+  gpointer widget;
+
+  g_hash_table_iter_init (&iter, change);
+  while (g_hash_table_iter_next (&iter, NULL, &widget))
+    {
+      g_hash_table_iter_steal (&iter);
+      gtk_list_item_manager_release_list_item (self, NULL, widget);
+    }
+
+  g_hash_table_unref (change);
+}
+
 static void
 gtk_list_item_manager_release_items (GtkListItemManager *self,
                                      GQueue             *released)
@@ -474,6 +538,65 @@ gtk_list_item_manager_release_items (GtkListItemManager *self,
     }
 }
 
+/* Rows are rebound in batches, like when scrolling or when the
+ * model changes. During a batch, the notifications of the list items
+ * are held back and the expressions watching them aren't evaluated,
+ * so that a row that gets rebound more than once in a batch only
+ * notifies once, and each expression is evaluated once at the end.
+ */
+static void
+gtk_list_item_manager_begin_batch (GtkListItemManager *self)
+{
+  if (self->batch_depth++ == 0)
+    gtk_expression_watch_freeze ();
+}
+
+static void
+gtk_list_item_manager_end_batch (GtkListItemManager *self)
+{
+  guint i;
+
+  g_assert (self->batch_depth > 0);
+
+  if (--self->batch_depth > 0)
+    return;
+
+  if (self->batch_items)
+    {
+      for (i = 0; i < self->batch_items->len; i++)
+        g_object_thaw_notify (g_ptr_array_index (self->batch_items, i));
+      g_clear_pointer (&self->batch_items, g_ptr_array_unref);
+    }
+
+  gtk_expression_watch_thaw ();
+}
+
+static void
+gtk_list_item_manager_update_widget (GtkListItemManager *self,
+                                     GtkWidget          *widget,
+                                     guint               position,
+                                     gpointer            item,
+                                     gboolean            selected)
+{
+  GtkListItem *list_item;
+
+  list_item = gtk_list_item_widget_get_list_item (GTK_LIST_ITEM_WIDGET (widget));
+
+  if (self->batch_depth > 0 && list_item != NULL)
+    {
+      if (self->batch_items == NULL)
+        self->batch_items = g_ptr_array_new_with_free_func (g_object_unref);
+
+      if (!g_ptr_array_find (self->batch_items, list_item, NULL))
+        {
+          g_object_freeze_notify (G_OBJECT (list_item));
+          g_ptr_array_add (self->batch_items, g_object_ref (list_item));
+        }
+    }
+
+  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (widget), position, item, selected);
+}
+
 static void
 gtk_list_item_manager_ensure_items (GtkListItemManager *self,
                                     GHashTable         *change,
@@ -488,6 +611,8 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
   if (self->model == NULL)
     return;
 
+  gtk_list_item_manager_begin_batch (self);
+
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
   position = 0;
 
@@ -570,6 +695,8 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 
   while ((widget = g_queue_pop_head (&released)))
     gtk_list_item_manager_release_list_item (self, NULL, widget);
+
+  gtk_list_item_manager_end_batch (self);
 }
 
 static void
@@ -584,7 +711,9 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
   guint n_items;
 
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
-  change = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify )gtk_widget_unparent);
+  change = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  gtk_list_item_manager_begin_batch (self);
 
   gtk_list_item_manager_remove_items (self, change, position, removed);
   gtk_list_item_manager_add_items (self, position, added);
@@ -728,7 +857,9 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
       tracker->widget = GTK_LIST_ITEM_WIDGET (item->widget);
     }
 
-  g_hash_table_unref (change);
+  gtk_list_item_manager_release_change (self, change);
+
+  gtk_list_item_manager_end_batch (self);
 
   gtk_widget_queue_resize (self->widget);
 }
@@ -754,14 +885,25 @@ gtk_list_item_manager_model_selection_changed_cb (GListModel         *model,
       item = gtk_rb_tree_node_get_next (item);
     }
 
+  /* Selection changes are often reported for far larger ranges than
+   * what actually changed, like when select_all() or a range selection
+   * replaces the previous selection. Only touch the rows whose state
+   * differs, so that the others keep their styles and render nodes.
+   */
+  gtk_list_item_manager_begin_batch (self);
+
   while (n_items > 0)
     {
-      if (item->widget)
+      if (item->widget &&
+          gtk_list_item_widget_get_selected (GTK_LIST_ITEM_WIDGET (item->widget)) !=
+          gtk_selection_model_is_selected (self->model, position))
         gtk_list_item_manager_update_list_item (self, item->widget, position);
       position += item->n_items;
       n_items -= MIN (n_items, item->n_items);
       item = gtk_rb_tree_node_get_next (item);
     }
+
+  gtk_list_item_manager_end_batch (self);
 }
 
 static void
@@ -793,6 +935,8 @@ gtk_list_item_manager_dispose (GObject *object)
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
 
   gtk_list_item_manager_clear_model (self);
+  gtk_list_item_manager_clear_pool (self);
+  g_clear_pointer (&self->deferred, g_hash_table_unref);
 
   g_clear_object (&self->factory);
 
@@ -812,6 +956,7 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
 static void
 gtk_list_item_manager_init (GtkListItemManager *self)
 {
+  self->deferred = g_hash_table_new (NULL, NULL);
 }
 
 void
@@ -829,6 +974,8 @@ gtk_list_item_manager_set_factory (GtkListItemManager *self,
 
   n_items = self->model ? g_list_model_get_n_items (G_LIST_MODEL (self->model)) : 0;
   gtk_list_item_manager_remove_items (self, NULL, 0, n_items);
+  /* The pooled widgets were set up by the old factory */
+  gtk_list_item_manager_clear_pool (self);
 
   g_set_object (&self->factory, factory);
 
@@ -895,6 +1042,32 @@ gtk_list_item_manager_get_model (GtkListItemManager *self)
   return self->model;
 }
 
+/* Binds @widget to the row at @position, or only moves it there
+ * if binds are currently deferred.
+ */
+static void
+gtk_list_item_manager_bind_list_item (GtkListItemManager *self,
+                                      GtkWidget          *widget,
+                                      guint               position)
+{
+  gpointer item;
+  gboolean selected;
+
+  selected = gtk_selection_model_is_selected (self->model, position);
+
+  if (self->defer_binds && self->factory && self->factory->deferred_bind)
+    {
+      gtk_list_item_manager_update_widget (self, widget, position, NULL, selected);
+      g_hash_table_add (self->deferred, widget);
+      return;
+    }
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+  gtk_list_item_manager_update_widget (self, widget, position, item, selected);
+  g_hash_table_remove (self->deferred, widget);
+  g_object_unref (item);
+}
+
 /*
  * gtk_list_item_manager_acquire_list_item:
  * @self: a #GtkListItemManager
@@ -919,22 +1092,26 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
                                          GtkWidget          *prev_sibling)
 {
   GtkWidget *result;
-  gpointer item;
-  gboolean selected;
 
   g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), NULL);
   g_return_val_if_fail (prev_sibling == NULL || GTK_IS_WIDGET (prev_sibling), NULL);
 
-  result = gtk_list_item_widget_new (self->factory,
-                                     self->item_css_name,
-                                     self->item_role);
+  result = g_queue_pop_head (&self->pool);
+  if (result)
+    {
+      gtk_list_item_factory_count_recycled (self->factory);
+      gtk_widget_show (result);
+    }
+  else
+    {
+      result = gtk_list_item_widget_new (self->factory,
+                                         self->item_css_name,
+                                         self->item_role);
+    }
 
   gtk_list_item_widget_set_single_click_activate (GTK_LIST_ITEM_WIDGET (result), self->single_click_activate);
 
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (result), position, item, selected);
-  g_object_unref (item);
+  gtk_list_item_manager_bind_list_item (self, result, position);
   gtk_widget_insert_after (result, self->widget, prev_sibling);
 
   return GTK_WIDGET (result);
@@ -972,10 +1149,11 @@ gtk_list_item_manager_try_reacquire_list_item (GtkListItemManager *self,
   if (g_hash_table_steal_extended (change, item, NULL, (gpointer *) &result))
     {
       GtkListItemWidget *list_item = GTK_LIST_ITEM_WIDGET (result);
-      gtk_list_item_widget_update (list_item,
-                                   position,
-                                   gtk_list_item_widget_get_item (list_item),
-                                   gtk_selection_model_is_selected (self->model, position));
+      gtk_list_item_manager_update_widget (self,
+                                           result,
+                                           position,
+                                           gtk_list_item_widget_get_item (list_item),
+                                           gtk_selection_model_is_selected (self->model, position));
       gtk_widget_insert_after (result, self->widget, prev_sibling);
       /* XXX: Should we let the listview do this? */
       gtk_widget_queue_resize (result);
@@ -1008,17 +1186,8 @@ gtk_list_item_manager_move_list_item (GtkListItemManager     *self,
                                       guint                   position,
                                       GtkWidget              *prev_sibling)
 {
-  gpointer item;
-  gboolean selected;
-
-  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
-  selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (list_item),
-                               position,
-                               item,
-                               selected);
+  gtk_list_item_manager_bind_list_item (self, list_item, position);
   gtk_widget_insert_after (list_item, _gtk_widget_get_parent (list_item), prev_sibling);
-  g_object_unref (item);
 }
 
 /**
@@ -1042,10 +1211,11 @@ gtk_list_item_manager_update_list_item (GtkListItemManager *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (item));
 
   selected = gtk_selection_model_is_selected (self->model, position);
-  gtk_list_item_widget_update (list_item,
-                               position,
-                               gtk_list_item_widget_get_item (list_item),
-                               selected);
+  gtk_list_item_manager_update_widget (self,
+                                       item,
+                                       position,
+                                       gtk_list_item_widget_get_item (list_item),
+                                       selected);
 }
 
 /*
@@ -1067,6 +1237,12 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
   g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
   g_return_if_fail (GTK_IS_LIST_ITEM_WIDGET (item));
 
+  /* Widgets without their item can't be found again by item,
+   * so they go straight to the pool.
+   */
+  if (self->deferred && g_hash_table_remove (self->deferred, item))
+    change = NULL;
+
   if (change != NULL)
     {
       if (!g_hash_table_replace (change, gtk_list_item_widget_get_item (GTK_LIST_ITEM_WIDGET (item)), item))
@@ -1077,6 +1253,15 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
       return;
     }
 
+  if (self->pool.length < gtk_list_item_manager_get_max_pool_size ())
+    {
+      /* Hidden widgets stay rooted, so they aren't torn down */
+      gtk_list_item_manager_update_widget (self, item, GTK_INVALID_LIST_POSITION, NULL, FALSE);
+      gtk_widget_hide (item);
+      g_queue_push_tail (&self->pool, item);
+      return;
+    }
+
   gtk_widget_unparent (item);
 }
 
@@ -1107,6 +1292,90 @@ gtk_list_item_manager_get_single_click_activate (GtkListItemManager   *self)
   return self->single_click_activate;
 }
 
+/*
+ * gtk_list_item_manager_set_defer_binds:
+ * @self: a #GtkListItemManager
+ * @defer_binds: %TRUE to defer binds
+ *
+ * While binds are deferred, list items that are acquired or moved
+ * to a new row are not bound to their item if the factory supports
+ * #GtkSignalListItemFactory:deferred-bind. They are bound later by
+ * gtk_list_item_manager_run_deferred_binds().
+ **/
+void
+gtk_list_item_manager_set_defer_binds (GtkListItemManager *self,
+                                       gboolean            defer_binds)
+{
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+
+  self->defer_binds = defer_binds;
+}
+
+gboolean
+gtk_list_item_manager_get_defer_binds (GtkListItemManager *self)
+{
+  g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), FALSE);
+
+  return self->defer_binds;
+}
+
+/*
+ * gtk_list_item_manager_run_deferred_binds:
+ * @self: a #GtkListItemManager
+ * @budget_us: time in microseconds that may be spent binding
+ *
+ * Binds list items whose bind was deferred until @budget_us
+ * is used up.
+ *
+ * Returns: %TRUE if deferred list items remain
+ **/
+gboolean
+gtk_list_item_manager_run_deferred_binds (GtkListItemManager *self,
+                                          gint64              budget_us)
+{
+  GHashTableIter iter;
+  gpointer widget;
+  gint64 end;
+
+  g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), FALSE);
+
+  if (self->model == NULL)
+    {
+      g_hash_table_remove_all (self->deferred);
+      return FALSE;
+    }
+
+  end = g_get_monotonic_time () + budget_us;
+
+  gtk_list_item_manager_begin_batch (self);
+
+  g_hash_table_iter_init (&iter, self->deferred);
+  while (g_hash_table_iter_next (&iter, &widget, NULL))
+    {
+      GtkListItemWidget *list_item = widget;
+      guint position = gtk_list_item_widget_get_position (list_item);
+      gpointer item;
+
+      g_hash_table_iter_remove (&iter);
+
+      item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+      gtk_list_item_manager_update_widget (self,
+                                           widget,
+                                           position,
+                                           item,
+                                           gtk_selection_model_is_selected (self->model, position));
+      g_object_unref (item);
+      gtk_widget_queue_resize (widget);
+
+      if (g_get_monotonic_time () >= end)
+        break;
+    }
+
+  gtk_list_item_manager_end_batch (self);
+
+  return g_hash_table_size (self->deferred) > 0;
+}
+
 GtkListItemTracker *
 gtk_list_item_tracker_new (GtkListItemManager *self)
 {
@@ -95,6 +95,12 @@ void                    gtk_list_item_manager_set_single_click_activate
 gboolean                gtk_list_item_manager_get_single_click_activate
                                                                 (GtkListItemManager     *self);
 
+void                    gtk_list_item_manager_set_defer_binds   (GtkListItemManager     *self,
+                                                                 gboolean                defer_binds);
+gboolean                gtk_list_item_manager_get_defer_binds   (GtkListItemManager     *self);
+gboolean                gtk_list_item_manager_run_deferred_binds(GtkListItemManager     *self,
+                                                                 gint64                  budget_us);
+
 GtkListItemTracker *    gtk_list_item_tracker_new               (GtkListItemManager     *self);
 void                    gtk_list_item_tracker_free              (GtkListItemManager     *self,
                                                                  GtkListItemTracker     *tracker);
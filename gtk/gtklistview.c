@@ -40,6 +40,11 @@
 /* Extra items to keep above + below every tracker */
 #define GTK_LIST_VIEW_EXTRA_ITEMS 2
 
+/* Number of measured rows after which older measurements start
+ * to count less for the height estimate of unknown rows.
+ */
+#define GTK_LIST_VIEW_MAX_ROW_SAMPLES 1000
+
 /**
  * SECTION:gtklistview
  * @title: GtkListView
@@ -149,6 +154,7 @@ struct _ListRow
 {
   GtkListItemManagerItem parent;
   guint height; /* per row */
+  guint measured : 1; /* height is measured, not estimated */
 };
 
 struct _ListRowAugment
@@ -459,6 +465,35 @@ compare_ints (gconstpointer first,
   return *(int *) first - *(int *) second;
 }
 
+static void
+gtk_list_view_reset_row_heights (GtkListView *self)
+{
+  self->row_height_sum = 0;
+  self->n_row_heights = 0;
+}
+
+static void
+gtk_list_view_add_row_height (GtkListView *self,
+                              ListRow     *row,
+                              int          row_height)
+{
+  if (row->measured)
+    {
+      self->row_height_sum += row_height - (int) row->height;
+      return;
+    }
+
+  if (self->n_row_heights >= GTK_LIST_VIEW_MAX_ROW_SAMPLES)
+    {
+      self->row_height_sum -= self->row_height_sum / 2;
+      self->n_row_heights -= self->n_row_heights / 2;
+    }
+
+  self->row_height_sum += row_height;
+  self->n_row_heights++;
+  row->measured = TRUE;
+}
+
 static guint
 gtk_list_view_get_unknown_row_height (GtkListView *self,
                                       GArray      *heights)
@@ -625,6 +660,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         row_height = min;
       else
         row_height = nat;
+      gtk_list_view_add_row_height (self, row, row_height);
       if (row->height != row_height)
         {
           row->height = row_height;
@@ -633,8 +669,14 @@ gtk_list_view_size_allocate (GtkWidget *widget,
       g_array_append_val (heights, row_height);
     }
 
-  /* step 3: determine height of unknown items */
-  row_height = gtk_list_view_get_unknown_row_height (self, heights);
+  /* step 3: determine height of unknown items
+   * Use the average of all rows measured so far, so the estimate
+   * doesn't jump around depending on which rows are currently
+   * instantiated. */
+  if (self->n_row_heights > 0)
+    row_height = (self->row_height_sum + self->n_row_heights / 2) / self->n_row_heights;
+  else
+    row_height = gtk_list_view_get_unknown_row_height (self, heights);
   g_array_free (heights, TRUE);
 
   for (row = gtk_list_item_manager_get_first (self->item_manager);
@@ -644,6 +686,7 @@ gtk_list_view_size_allocate (GtkWidget *widget,
       if (row->parent.widget)
         continue;
 
+      row->measured = FALSE;
       if (row->height != row_height)
         {
           row->height = row_height;
@@ -994,6 +1037,8 @@ gtk_list_view_set_model (GtkListView       *self,
   if (!gtk_list_base_set_model (GTK_LIST_BASE (self), model))
     return;
 
+  gtk_list_view_reset_row_heights (self);
+
   gtk_accessible_update_property (GTK_ACCESSIBLE (self),
                                   GTK_ACCESSIBLE_PROPERTY_MULTI_SELECTABLE, GTK_IS_MULTI_SELECTION (model),
                                   -1);
@@ -1035,6 +1080,7 @@ gtk_list_view_set_factory (GtkListView        *self,
     return;
 
   gtk_list_item_manager_set_factory (self->item_manager, factory);
+  gtk_list_view_reset_row_heights (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
@@ -33,6 +33,10 @@ struct _GtkListView
   gboolean show_separators;
 
   int list_width;
+
+  /* running statistics of measured row heights */
+  gint64 row_height_sum;
+  guint n_row_heights;
 };
 
 struct _GtkListViewClass
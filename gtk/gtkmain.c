@@ -936,6 +936,8 @@ rewrite_event_for_surface (GdkEvent  *event,
   GdkEventType type;
   double x, y;
   double dx, dy;
+  double *axes = NULL;
+  guint n_axes;
 
   type = gdk_event_get_event_type (event);
 
@@ -952,6 +954,7 @@ rewrite_event_for_surface (GdkEvent  *event,
     case GDK_TOUCHPAD_PINCH:
       gdk_event_get_position (event, &x, &y);
       gdk_surface_translate_coordinates (gdk_event_get_surface (event), new_surface, &x, &y);
+      gdk_event_get_axes (event, &axes, &n_axes);
       break;
     default:
       x = y = 0;
@@ -970,7 +973,7 @@ rewrite_event_for_surface (GdkEvent  *event,
                                    gdk_event_get_modifier_state (event),
                                    gdk_button_event_get_button (event),
                                    x, y,
-                                   gdk_event_dup_axes (event));
+                                   axes);
     case GDK_MOTION_NOTIFY:
       return gdk_motion_event_new (new_surface,
                                    gdk_event_get_device (event),
@@ -978,7 +981,7 @@ rewrite_event_for_surface (GdkEvent  *event,
                                    gdk_event_get_time (event),
                                    gdk_event_get_modifier_state (event),
                                    x, y,
-                                   gdk_event_dup_axes (event));
+                                   axes);
     case GDK_TOUCH_BEGIN:
     case GDK_TOUCH_UPDATE:
     case GDK_TOUCH_END:
@@ -990,7 +993,7 @@ rewrite_event_for_surface (GdkEvent  *event,
                                   gdk_event_get_time (event),
                                   gdk_event_get_modifier_state (event),
                                   x, y,
-                                  gdk_event_dup_axes (event),
+                                  axes,
                                   gdk_touch_event_get_emulating_pointer (event));
     case GDK_TOUCHPAD_SWIPE:
       gdk_touchpad_event_get_deltas (event, &dx, &dy);
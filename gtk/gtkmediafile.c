@@ -192,6 +192,8 @@ gtk_media_file_get_extension (void)
 
   GTK_NOTE (MODULES, g_print ("Looking up MediaFile extension\n"));
 
+  _gtk_io_modules_ensure (GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
+
   ep = g_io_extension_point_lookup (GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
   e = NULL;
 
@@ -601,9 +603,6 @@ void
 gtk_media_file_extension_init (void)
 {
   GIOExtensionPoint *ep;
-  GIOModuleScope *scope;
-  char **paths;
-  int i;
 
   GTK_NOTE (MODULES,
             g_print ("Registering extension point %s\n", GTK_MEDIA_FILE_EXTENSION_POINT_NAME));
@@ -613,30 +612,5 @@ gtk_media_file_extension_init (void)
 
   g_type_ensure (GTK_TYPE_NO_MEDIA_FILE);
 
-  scope = g_io_module_scope_new (G_IO_MODULE_SCOPE_BLOCK_DUPLICATES);
-
-  paths = _gtk_get_module_path ("media");
-  for (i = 0; paths[i]; i++)
-    {
-      GTK_NOTE (MODULES,
-                g_print ("Scanning io modules in %s\n", paths[i]));
-      g_io_modules_scan_all_in_directory_with_scope (paths[i], scope);
-    }
-  g_strfreev (paths);
-
-  g_io_module_scope_free (scope);
-
-  if (GTK_DEBUG_CHECK (MODULES))
-    {
-      GList *list, *l;
-
-      list = g_io_extension_point_get_extensions (ep);
-      for (l = list; l; l = l->next)
-        {
-          GIOExtension *ext = l->data;
-          g_print ("extension: %s: type %s\n",
-                   g_io_extension_get_name (ext),
-                   g_type_name (g_io_extension_get_type (ext)));
-        }
-    }
+  _gtk_io_modules_scan_async ("media", GTK_MEDIA_FILE_EXTENSION_POINT_NAME);
 }
@@ -184,3 +184,157 @@ _gtk_get_module_path (const char *type)
 
   return result;
 }
+
+/* The IO modules of an extension point are scanned in a thread that
+ * is started when the main loop first goes idle, so that neither
+ * gtk_init() nor the first use of a media file or print dialog has to
+ * wait for the disk. Users of the extension point call
+ * _gtk_io_modules_ensure() before looking at its extensions, which
+ * waits for a scan that is still running, or does it right away if it
+ * did not start yet.
+ *
+ * With a giomodule.cache in the directory, the scan does not load any
+ * module, GIO loads it when the type of an extension is first asked for.
+ */
+
+typedef struct {
+  char *extension_point;
+  char **paths;
+  guint idle_id;
+  guint started : 1;
+  guint done : 1;
+} IOModuleScan;
+
+static GMutex io_module_scan_lock;
+static GCond io_module_scan_cond;
+static GHashTable *io_module_scans;
+
+static void
+io_module_scan_run (IOModuleScan *scan)
+{
+  GIOModuleScope *scope;
+  int i;
+
+  scope = g_io_module_scope_new (G_IO_MODULE_SCOPE_BLOCK_DUPLICATES);
+
+  for (i = 0; scan->paths[i]; i++)
+    {
+      GTK_NOTE (MODULES,
+                g_print ("Scanning io modules in %s\n", scan->paths[i]));
+      g_io_modules_scan_all_in_directory_with_scope (scan->paths[i], scope);
+    }
+
+  g_io_module_scope_free (scope);
+
+  if (GTK_DEBUG_CHECK (MODULES))
+    {
+      GIOExtensionPoint *ep;
+      GList *list, *l;
+
+      ep = g_io_extension_point_lookup (scan->extension_point);
+      list = g_io_extension_point_get_extensions (ep);
+      for (l = list; l; l = l->next)
+        {
+          GIOExtension *ext = l->data;
+          g_print ("extension: %s: type %s\n",
+                   g_io_extension_get_name (ext),
+                   g_type_name (g_io_extension_get_type (ext)));
+        }
+    }
+}
+
+static gpointer
+io_module_scan_thread (gpointer data)
+{
+  IOModuleScan *scan = data;
+
+  io_module_scan_run (scan);
+
+  g_mutex_lock (&io_module_scan_lock);
+  scan->done = TRUE;
+  g_cond_broadcast (&io_module_scan_cond);
+  g_mutex_unlock (&io_module_scan_lock);
+
+  return NULL;
+}
+
+static gboolean
+io_module_scan_start (gpointer data)
+{
+  IOModuleScan *scan = data;
+
+  g_mutex_lock (&io_module_scan_lock);
+  scan->idle_id = 0;
+  scan->started = TRUE;
+  g_thread_unref (g_thread_new ("[gtk] io module scan", io_module_scan_thread, scan));
+  g_mutex_unlock (&io_module_scan_lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * _gtk_io_modules_scan_async:
+ * @type: the type of the modules, as for _gtk_get_module_path()
+ * @extension_point: the name of the extension point they implement
+ *
+ * Scans the IO modules for @extension_point in a thread once the main
+ * loop is idle. The extension point must be registered already.
+ **/
+void
+_gtk_io_modules_scan_async (const char *type,
+                            const char *extension_point)
+{
+  IOModuleScan *scan;
+
+  g_mutex_lock (&io_module_scan_lock);
+
+  if (io_module_scans == NULL)
+    io_module_scans = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if (g_hash_table_contains (io_module_scans, extension_point))
+    {
+      g_mutex_unlock (&io_module_scan_lock);
+      return;
+    }
+
+  scan = g_new0 (IOModuleScan, 1);
+  scan->extension_point = g_strdup (extension_point);
+  /* Determined here, get_module_path() is not thread-safe */
+  scan->paths = _gtk_get_module_path (type);
+  scan->idle_id = g_idle_add_full (G_PRIORITY_LOW, io_module_scan_start, scan, NULL);
+  g_source_set_name_by_id (scan->idle_id, "[gtk] io_module_scan_start");
+
+  g_hash_table_insert (io_module_scans, scan->extension_point, scan);
+
+  g_mutex_unlock (&io_module_scan_lock);
+}
+
+/**
+ * _gtk_io_modules_ensure:
+ * @extension_point: the name of an extension point
+ *
+ * Makes sure that the scan started with _gtk_io_modules_scan_async()
+ * for @extension_point is done, so that its extensions can be used.
+ **/
+void
+_gtk_io_modules_ensure (const char *extension_point)
+{
+  IOModuleScan *scan;
+
+  g_mutex_lock (&io_module_scan_lock);
+
+  scan = io_module_scans ? g_hash_table_lookup (io_module_scans, extension_point) : NULL;
+
+  if (scan != NULL && !scan->started)
+    {
+      g_clear_handle_id (&scan->idle_id, g_source_remove);
+      scan->started = TRUE;
+      io_module_scan_run (scan);
+      scan->done = TRUE;
+    }
+
+  while (scan != NULL && !scan->done)
+    g_cond_wait (&io_module_scan_cond, &io_module_scan_lock);
+
+  g_mutex_unlock (&io_module_scan_lock);
+}
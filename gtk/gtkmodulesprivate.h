@@ -29,6 +29,10 @@ G_BEGIN_DECLS
 
 char ** _gtk_get_module_path          (const char   *type);
 
+void    _gtk_io_modules_scan_async    (const char   *type,
+                                       const char   *extension_point);
+void    _gtk_io_modules_ensure        (const char   *extension_point);
+
 G_END_DECLS
 
 #endif /* __GTK_MODULES_PRIVATE_H__ */
@@ -62,6 +62,7 @@ struct _GtkMultiSortKeys
 {
   GtkSortKeys parent_keys;
 
+  gsize max_key_size;
   guint n_keys;
   GtkMultiSortKey keys[];
 };
@@ -155,11 +156,84 @@ static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
   gtk_multi_sort_keys_clear_key,
 };
 
+/* Used when all keys are threadsafe, see gtk_sort_keys_is_threadsafe() */
+static void
+gtk_multi_sort_keys_prepare_key (GtkSortKeys *keys,
+                                 gpointer     item,
+                                 gpointer     key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  char *key = (char *) key_memory;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    gtk_sort_keys_prepare_key (self->keys[i].keys, item, key + self->keys[i].offset);
+}
+
+static void
+gtk_multi_sort_keys_finish_key (GtkSortKeys *keys,
+                                gpointer     key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  char *key = (char *) key_memory;
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    gtk_sort_keys_finish_key (self->keys[i].keys, key + self->keys[i].offset);
+}
+
+static const GtkSortKeysClass GTK_THREADSAFE_MULTI_SORT_KEYS_CLASS =
+{
+  gtk_multi_sort_keys_free,
+  gtk_multi_sort_keys_compare,
+  gtk_multi_sort_keys_is_compatible,
+  gtk_multi_sort_keys_prepare_key,
+  gtk_multi_sort_keys_clear_key,
+  gtk_multi_sort_keys_finish_key,
+};
+
+/* Used when no key is opaque: the encoded keys are concatenated into
+ * one key that can be compared with memcmp() */
+static void
+gtk_multi_sort_keys_encode_key (GtkSortKeys *keys,
+                                gpointer     item,
+                                gpointer     key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  guchar *key = (guchar *) key_memory;
+  gpointer tmp = g_alloca (self->max_key_size);
+  gsize i;
+
+  for (i = 0; i < self->n_keys; i++)
+    {
+      gtk_sort_keys_init_key (self->keys[i].keys, item, tmp);
+      gtk_sort_keys_encode_key (self->keys[i].keys, tmp, key + self->keys[i].offset);
+    }
+}
+
+static void
+gtk_multi_sort_keys_encode_finish_key (GtkSortKeys *keys,
+                                       gpointer     key_memory)
+{
+}
+
+static const GtkSortKeysClass GTK_MEMCMP_MULTI_SORT_KEYS_CLASS =
+{
+  gtk_multi_sort_keys_free,
+  gtk_sort_keys_compare_memcmp,
+  gtk_multi_sort_keys_is_compatible,
+  gtk_multi_sort_keys_encode_key,
+  NULL,
+  gtk_multi_sort_keys_encode_finish_key,
+};
+
 static GtkSortKeys *
 gtk_multi_sort_keys_new (GtkMultiSorter *self)
 {
   GtkMultiSortKeys *result;
   GtkSortKeys *keys;
+  gboolean threadsafe = TRUE;
+  gboolean encodable = TRUE;
   gsize i;
 
   if (gtk_sorters_get_size (&self->sorters) == 0)
@@ -179,7 +253,27 @@ gtk_multi_sort_keys_new (GtkMultiSorter *self)
       result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
       keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
       keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
+      threadsafe &= gtk_sort_keys_is_threadsafe (result->keys[i].keys);
+      encodable &= gtk_sort_keys_get_format (result->keys[i].keys) != GTK_SORT_KEYS_OPAQUE;
+      result->max_key_size = MAX (result->max_key_size, gtk_sort_keys_get_key_size (result->keys[i].keys));
+    }
+
+  if (encodable)
+    {
+      /* Encoded keys need no alignment and no padding between them */
+      keys->key_size = 0;
+      keys->key_align = 1;
+      for (i = 0; i < result->n_keys; i++)
+        {
+          result->keys[i].offset = keys->key_size;
+          keys->key_size += gtk_sort_keys_get_key_size (result->keys[i].keys);
+        }
+
+      keys->klass = &GTK_MEMCMP_MULTI_SORT_KEYS_CLASS;
+      gtk_sort_keys_set_format (keys, GTK_SORT_KEYS_MEMCMP, FALSE);
     }
+  else if (threadsafe)
+    keys->klass = &GTK_THREADSAFE_MULTI_SORT_KEYS_CLASS;
 
   return keys;
 }
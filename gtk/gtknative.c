@@ -25,12 +25,26 @@
 #include "gtkprivate.h"
 #include "gtkintl.h"
 #include "gtkcssnodeprivate.h"
+#include "gtkidleschedulerprivate.h"
+
+/* The number of unused popup surfaces kept around per native */
+#define MAX_POOLED_POPUPS 2
+
+typedef struct _PooledPopup
+{
+  GdkSurface *surface;
+  GskRenderer *renderer;
+} PooledPopup;
 
 typedef struct _GtkNativePrivate
 {
   gulong update_handler_id;
+  gulong after_paint_handler_id;
   gulong layout_handler_id;
   gulong scale_changed_handler_id;
+
+  /* popup surfaces on our surface that are not in use */
+  GSList *popup_pool;
 } GtkNativePrivate;
 
 static GQuark quark_gtk_native_private;
@@ -89,6 +103,13 @@ frame_clock_update_cb (GdkFrameClock *clock,
     gtk_css_node_validate (gtk_widget_get_css_node (GTK_WIDGET (native)));
 }
 
+static void
+frame_clock_after_paint_cb (GdkFrameClock *clock,
+                            GtkNative     *native)
+{
+  gtk_idle_scheduler_frame_finished (clock);
+}
+
 static void
 gtk_native_layout (GtkNative *self,
                    int        width,
@@ -123,12 +144,24 @@ verify_priv_unrealized (gpointer user_data)
   GtkNativePrivate *priv = user_data;
 
   g_warn_if_fail (priv->update_handler_id == 0);
+  g_warn_if_fail (priv->after_paint_handler_id == 0);
   g_warn_if_fail (priv->layout_handler_id == 0);
   g_warn_if_fail (priv->scale_changed_handler_id == 0);
+  g_warn_if_fail (priv->popup_pool == NULL);
 
   g_free (priv);
 }
 
+static void
+destroy_popup (GdkSurface  *surface,
+               GskRenderer *renderer)
+{
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+  gdk_surface_destroy (surface);
+  g_object_unref (surface);
+}
+
 /**
  * gtk_native_realize:
  * @self: a #GtkNative
@@ -153,6 +186,9 @@ gtk_native_realize (GtkNative *self)
   priv->update_handler_id = g_signal_connect_after (clock, "update",
                                               G_CALLBACK (frame_clock_update_cb),
                                               self);
+  priv->after_paint_handler_id = g_signal_connect (clock, "after-paint",
+                                                   G_CALLBACK (frame_clock_after_paint_cb),
+                                                   self);
   priv->layout_handler_id = g_signal_connect (surface, "layout",
                                               G_CALLBACK (surface_layout_cb),
                                               self);
@@ -188,12 +224,112 @@ gtk_native_unrealize (GtkNative *self)
   g_return_if_fail (clock != NULL);
 
   g_clear_signal_handler (&priv->update_handler_id, clock);
+  g_clear_signal_handler (&priv->after_paint_handler_id, clock);
   g_clear_signal_handler (&priv->layout_handler_id, surface);
   g_clear_signal_handler (&priv->scale_changed_handler_id, surface);
 
+  /* Popups must go before the surface they are attached to */
+  while (priv->popup_pool)
+    {
+      PooledPopup *popup = priv->popup_pool->data;
+
+      priv->popup_pool = g_slist_delete_link (priv->popup_pool, priv->popup_pool);
+      destroy_popup (popup->surface, popup->renderer);
+      g_free (popup);
+    }
+
   g_object_set_qdata (G_OBJECT (self), quark_gtk_native_private, NULL);
 }
 
+/*< private >
+ * gtk_native_lease_popup:
+ * @self: a realized #GtkNative
+ * @autohide: whether the popup should hide on outside clicks
+ * @renderer: (out) (transfer full): return location for the renderer
+ *   of the popup
+ *
+ * Gets a popup surface attached to the surface of @self, together with
+ * a realized renderer for it. Popups that were given back with
+ * gtk_native_return_popup() are reused, so that widgets that are
+ * realized over and over, like tooltips, don't pay for setting up a
+ * surface and a renderer every time.
+ *
+ * Returns: (transfer full): a popup #GdkSurface
+ */
+GdkSurface *
+gtk_native_lease_popup (GtkNative    *self,
+                        gboolean      autohide,
+                        GskRenderer **renderer)
+{
+  GtkNativePrivate *priv;
+  GdkSurface *surface;
+  GSList *l;
+
+  priv = g_object_get_qdata (G_OBJECT (self), quark_gtk_native_private);
+  g_return_val_if_fail (priv != NULL, NULL);
+
+  for (l = priv->popup_pool; l; l = l->next)
+    {
+      PooledPopup *popup = l->data;
+
+      if (gdk_popup_get_autohide (GDK_POPUP (popup->surface)) == autohide)
+        {
+          surface = popup->surface;
+          *renderer = popup->renderer;
+          priv->popup_pool = g_slist_delete_link (priv->popup_pool, l);
+          g_free (popup);
+
+          return surface;
+        }
+    }
+
+  surface = gdk_surface_new_popup (gtk_native_get_surface (self), autohide);
+  *renderer = gsk_renderer_new_for_surface (surface);
+
+  return surface;
+}
+
+/*< private >
+ * gtk_native_return_popup:
+ * @self: (nullable): the #GtkNative that the popup was leased from
+ * @surface: (transfer full): a popup surface from gtk_native_lease_popup()
+ * @renderer: (transfer full): the renderer of @surface
+ *
+ * Gives back a popup that is no longer used. The popup must be hidden
+ * and disconnected from its widget. It is kept for reuse if @self is
+ * still realized, and destroyed otherwise.
+ */
+void
+gtk_native_return_popup (GtkNative   *self,
+                         GdkSurface  *surface,
+                         GskRenderer *renderer)
+{
+  GtkNativePrivate *priv;
+  PooledPopup *popup;
+
+  if (self)
+    priv = g_object_get_qdata (G_OBJECT (self), quark_gtk_native_private);
+  else
+    priv = NULL;
+
+  if (priv == NULL ||
+      g_slist_length (priv->popup_pool) >= MAX_POOLED_POPUPS ||
+      gdk_surface_is_destroyed (surface))
+    {
+      destroy_popup (surface, renderer);
+      return;
+    }
+
+  /* Don't let the next user inherit the regions of the last one */
+  gdk_surface_set_input_region (surface, NULL);
+  gdk_surface_set_opaque_region (surface, NULL);
+
+  popup = g_new (PooledPopup, 1);
+  popup->surface = surface;
+  popup->renderer = renderer;
+  priv->popup_pool = g_slist_prepend (priv->popup_pool, popup);
+}
+
 /**
  * gtk_native_get_surface:
  * @self: a #GtkNative
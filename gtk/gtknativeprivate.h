@@ -30,6 +30,13 @@ struct _GtkNativeInterface
 
 void    gtk_native_queue_relayout         (GtkNative    *native);
 
+GdkSurface *    gtk_native_lease_popup          (GtkNative    *self,
+                                                 gboolean      autohide,
+                                                 GskRenderer **renderer);
+void            gtk_native_return_popup         (GtkNative    *self,
+                                                 GdkSurface   *surface,
+                                                 GskRenderer  *renderer);
+
 G_END_DECLS
 
 #endif /* __GTK_NATIVE_PRIVATE_H__ */
@@ -372,8 +372,10 @@ struct _GtkNotebookPage
   guint fill         : 1;
   guint reorderable  : 1;
   guint detachable   : 1;
+  guint tab_size_valid : 1;
 
   GtkRequisition requisition;
+  GtkRequisition tab_size;      /* size of tab_widget when it was last measured */
 
   gulong mnemonic_activate_signal;
   gulong notify_visible_handler;
@@ -2109,16 +2111,25 @@ gtk_notebook_get_preferred_tabs_size (GtkNotebook    *notebook,
           if (!gtk_widget_get_visible (page->tab_label))
             gtk_widget_show (page->tab_label);
 
-          gtk_widget_measure (page->tab_widget,
-                              GTK_ORIENTATION_HORIZONTAL,
-                              -1,
-                              &page->requisition.width, NULL,
-                              NULL, NULL);
-          gtk_widget_measure (page->tab_widget,
-                              GTK_ORIENTATION_VERTICAL,
-                              page->requisition.width,
-                              &page->requisition.height, NULL,
-                              NULL, NULL);
+          /* Only measure the tabs that changed, with many tabs
+           * even looking up the cached sizes of all of them adds up */
+          if (!page->tab_size_valid ||
+              _gtk_widget_get_resize_needed (page->tab_widget))
+            {
+              gtk_widget_measure (page->tab_widget,
+                                  GTK_ORIENTATION_HORIZONTAL,
+                                  -1,
+                                  &page->tab_size.width, NULL,
+                                  NULL, NULL);
+              gtk_widget_measure (page->tab_widget,
+                                  GTK_ORIENTATION_VERTICAL,
+                                  page->tab_size.width,
+                                  &page->tab_size.height, NULL,
+                                  NULL, NULL);
+              page->tab_size_valid = TRUE;
+            }
+
+          page->requisition = page->tab_size;
 
           switch (notebook->tab_pos)
             {
@@ -144,6 +144,14 @@ COMPARE_FUNCS(gulong)
 COMPARE_FUNCS(gint64)
 COMPARE_FUNCS(guint64)
 
+/* Numbers need no work after being read from the item, this
+ * only marks the keys as threadsafe for GtkSortListModel */
+static void
+gtk_numeric_sort_keys_finish_key (GtkSortKeys *keys,
+                                  gpointer     key_memory)
+{
+}
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 #define NUMERIC_SORT_KEYS(TYPE, key_type, type, default_value) \
@@ -174,7 +182,8 @@ static const GtkSortKeysClass GTK_ASCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_ascending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_numeric_sort_keys_finish_key \
 }; \
 \
 static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
@@ -183,7 +192,8 @@ static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_descending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  gtk_numeric_sort_keys_finish_key \
 }; \
 \
 static gboolean \
@@ -218,6 +228,7 @@ static GtkSortKeys *
 gtk_numeric_sort_keys_new (GtkNumericSorter *self)
 {
   GtkNumericSortKeys *result;
+  GtkSortKeysFormat format;
 
   if (self->expression == NULL)
     return gtk_sort_keys_new_equal ();
@@ -330,6 +341,31 @@ gtk_numeric_sort_keys_new (GtkNumericSorter *self)
 
   result->expression = gtk_expression_ref (self->expression);
 
+  switch (gtk_expression_get_value_type (self->expression))
+    {
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      format = GTK_SORT_KEYS_FLOAT;
+      break;
+
+    case G_TYPE_CHAR:
+      /* The keys are compared as char */
+      format = ((char) -1) < 0 ? GTK_SORT_KEYS_SIGNED : GTK_SORT_KEYS_UNSIGNED;
+      break;
+
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+      format = GTK_SORT_KEYS_SIGNED;
+      break;
+
+    default:
+      format = GTK_SORT_KEYS_UNSIGNED;
+      break;
+    }
+
+  gtk_sort_keys_set_format ((GtkSortKeys *) result, format, self->sort_order == GTK_SORT_DESCENDING);
+
   return (GtkSortKeys *) result;
 }
 
@@ -37,6 +37,7 @@
 #include "gtkorientable.h"
 #include "gtkprivate.h"
 #include "gtkrendericonprivate.h"
+#include "gtksnapshot.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
@@ -146,6 +147,13 @@ struct _GtkPaned
   int           min_position;
   int           original_position;
 
+  /* The layout of the children while the handle is not dragged,
+   * kept for defer-resize */
+  GtkAllocation start_child_allocation;
+  GtkAllocation end_child_allocation;
+  int           allocated_width;
+  int           allocated_height;
+
   guint         in_recursion  : 1;
   guint         resize_start_child : 1;
   guint         shrink_start_child : 1;
@@ -153,6 +161,8 @@ struct _GtkPaned
   guint         shrink_end_child : 1;
   guint         position_set  : 1;
   guint         panning       : 1;
+  guint         defer_resize  : 1;
+  guint         resize_deferred : 1;
 };
 
 struct _GtkPanedClass
@@ -183,6 +193,7 @@ enum {
   PROP_SHRINK_END_CHILD,
   PROP_START_CHILD,
   PROP_END_CHILD,
+  PROP_DEFER_RESIZE,
   LAST_PROP,
 
   /* GtkOrientable */
@@ -219,6 +230,8 @@ static void     gtk_paned_size_allocate         (GtkWidget           *widget,
                                                  int                  width,
                                                  int                  height,
                                                  int                  baseline);
+static void     gtk_paned_snapshot              (GtkWidget           *widget,
+                                                 GtkSnapshot         *snapshot);
 static void     gtk_paned_unrealize             (GtkWidget           *widget);
 static void     gtk_paned_css_changed           (GtkWidget           *widget,
                                                  GtkCssStyleChange   *change);
@@ -427,6 +440,7 @@ gtk_paned_class_init (GtkPanedClass *class)
 
   widget_class->measure = gtk_paned_measure;
   widget_class->size_allocate = gtk_paned_size_allocate;
+  widget_class->snapshot = gtk_paned_snapshot;
   widget_class->unrealize = gtk_paned_unrealize;
   widget_class->focus = gtk_widget_focus_child;
   widget_class->set_focus_child = gtk_paned_set_focus_child;
@@ -563,6 +577,25 @@ gtk_paned_class_init (GtkPanedClass *class)
                           GTK_TYPE_WIDGET,
                           GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkPaned:defer-resize:
+   *
+   * Whether the children keep their size while the handle is dragged.
+   *
+   * When this is %TRUE, only the handle follows the pointer during a
+   * drag, and the children are clipped to their new areas. They get
+   * their new size once the drag ends. This keeps dragging smooth
+   * when the children are expensive to lay out.
+   *
+   * Since: 4.2
+   */
+  paned_props[PROP_DEFER_RESIZE] =
+    g_param_spec_boolean ("defer-resize",
+                          P_("Defer resize"),
+                          P_("Whether the children keep their size while the handle is dragged"),
+                          FALSE,
+                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, paned_props);
   g_object_class_override_property (object_class, PROP_ORIENTATION, "orientation");
 
@@ -931,6 +964,10 @@ gesture_drag_end_cb (GtkGestureDrag *gesture,
     gtk_gesture_set_state (GTK_GESTURE (gesture), GTK_EVENT_SEQUENCE_DENIED);
 
   paned->panning = FALSE;
+
+  /* The children get their new size now */
+  if (paned->resize_deferred)
+    gtk_widget_queue_allocate (GTK_WIDGET (paned));
 }
 
 static void
@@ -960,6 +997,9 @@ gtk_paned_set_property (GObject        *object,
     case PROP_WIDE_HANDLE:
       gtk_paned_set_wide_handle (paned, g_value_get_boolean (value));
       break;
+    case PROP_DEFER_RESIZE:
+      gtk_paned_set_defer_resize (paned, g_value_get_boolean (value));
+      break;
     case PROP_RESIZE_START_CHILD:
       gtk_paned_set_resize_start_child (paned, g_value_get_boolean (value));
       break;
@@ -1012,6 +1052,9 @@ gtk_paned_get_property (GObject        *object,
     case PROP_WIDE_HANDLE:
       g_value_set_boolean (value, gtk_paned_get_wide_handle (paned));
       break;
+    case PROP_DEFER_RESIZE:
+      g_value_set_boolean (value, paned->defer_resize);
+      break;
     case PROP_RESIZE_START_CHILD:
       g_value_set_boolean (value, paned->resize_start_child);
       break;
@@ -1358,6 +1401,28 @@ gtk_paned_size_allocate (GtkWidget *widget,
             end_child_allocation.height = end_child_height;
         }
 
+      /* Only move the handle while it is dragged, and leave the
+       * children as they were, unless the paned itself got resized */
+      if (paned->defer_resize && paned->panning &&
+          width == paned->allocated_width && height == paned->allocated_height)
+        {
+          start_child_allocation = paned->start_child_allocation;
+          end_child_allocation = paned->end_child_allocation;
+          paned->resize_deferred = TRUE;
+
+          /* The children are clipped to the position of the handle */
+          gtk_widget_queue_draw (widget);
+        }
+      else
+        {
+          paned->start_child_allocation = start_child_allocation;
+          paned->end_child_allocation = end_child_allocation;
+          paned->resize_deferred = FALSE;
+        }
+
+      paned->allocated_width = width;
+      paned->allocated_height = height;
+
       gtk_widget_set_child_visible (paned->handle_widget, TRUE);
 
       gtk_widget_size_allocate (paned->handle_widget, &handle_allocation, -1);
@@ -1383,6 +1448,8 @@ gtk_paned_size_allocate (GtkWidget *widget,
         }
 
       gtk_widget_set_child_visible (paned->handle_widget, FALSE);
+      paned->resize_deferred = FALSE;
+      paned->allocated_width = paned->allocated_height = 0;
     }
 
   gtk_accessible_update_property (GTK_ACCESSIBLE (paned),
@@ -1395,6 +1462,66 @@ gtk_paned_size_allocate (GtkWidget *widget,
 }
 
 
+/* The area of the start or end child next to the handle */
+static void
+get_child_area (GtkPaned        *paned,
+                gboolean         start,
+                graphene_rect_t *area)
+{
+  GtkWidget *widget = GTK_WIDGET (paned);
+  int width = gtk_widget_get_width (widget);
+  int height = gtk_widget_get_height (widget);
+  graphene_rect_t handle;
+
+  if (!gtk_widget_compute_bounds (paned->handle_widget, widget, &handle))
+    graphene_rect_init (&handle, 0, 0, 0, 0);
+
+  if (paned->orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      float handle_end = handle.origin.x + handle.size.width;
+
+      if (start == (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_LTR))
+        graphene_rect_init (area, 0, 0, handle.origin.x, height);
+      else
+        graphene_rect_init (area, handle_end, 0, width - handle_end, height);
+    }
+  else
+    {
+      float handle_end = handle.origin.y + handle.size.height;
+
+      if (start)
+        graphene_rect_init (area, 0, 0, width, handle.origin.y);
+      else
+        graphene_rect_init (area, 0, handle_end, width, height - handle_end);
+    }
+}
+
+static void
+gtk_paned_snapshot (GtkWidget   *widget,
+                    GtkSnapshot *snapshot)
+{
+  GtkPaned *paned = GTK_PANED (widget);
+  graphene_rect_t area;
+
+  if (!paned->resize_deferred)
+    {
+      GTK_WIDGET_CLASS (gtk_paned_parent_class)->snapshot (widget, snapshot);
+      return;
+    }
+
+  get_child_area (paned, TRUE, &area);
+  gtk_snapshot_push_clip (snapshot, &area);
+  gtk_widget_snapshot_child (widget, paned->start_child, snapshot);
+  gtk_snapshot_pop (snapshot);
+
+  get_child_area (paned, FALSE, &area);
+  gtk_snapshot_push_clip (snapshot, &area);
+  gtk_widget_snapshot_child (widget, paned->end_child, snapshot);
+  gtk_snapshot_pop (snapshot);
+
+  gtk_widget_snapshot_child (widget, paned->handle_widget, snapshot);
+}
+
 static void
 gtk_paned_unrealize (GtkWidget *widget)
 {
@@ -2528,3 +2655,51 @@ gtk_paned_get_wide_handle (GtkPaned *paned)
 
   return gtk_widget_has_css_class (paned->handle_widget, "wide");
 }
+
+/**
+ * gtk_paned_set_defer_resize:
+ * @paned: a #GtkPaned
+ * @defer_resize: %TRUE to keep the size of the children while dragging
+ *
+ * Sets whether the children keep their size while the handle
+ * is dragged. See #GtkPaned:defer-resize.
+ *
+ * Since: 4.2
+ */
+void
+gtk_paned_set_defer_resize (GtkPaned *paned,
+                            gboolean  defer_resize)
+{
+  g_return_if_fail (GTK_IS_PANED (paned));
+
+  defer_resize = !!defer_resize;
+
+  if (paned->defer_resize == defer_resize)
+    return;
+
+  paned->defer_resize = defer_resize;
+
+  if (paned->resize_deferred)
+    gtk_widget_queue_allocate (GTK_WIDGET (paned));
+
+  g_object_notify_by_pspec (G_OBJECT (paned), paned_props[PROP_DEFER_RESIZE]);
+}
+
+/**
+ * gtk_paned_get_defer_resize:
+ * @paned: a #GtkPaned
+ *
+ * Gets whether the children keep their size while the handle
+ * is dragged.
+ *
+ * Returns: %TRUE if resizing the children is deferred
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_paned_get_defer_resize (GtkPaned *paned)
+{
+  g_return_val_if_fail (GTK_IS_PANED (paned), FALSE);
+
+  return paned->defer_resize;
+}
@@ -90,6 +90,12 @@ void        gtk_paned_set_wide_handle (GtkPaned    *paned,
 GDK_AVAILABLE_IN_ALL
 gboolean    gtk_paned_get_wide_handle (GtkPaned    *paned);
 
+GDK_AVAILABLE_IN_4_2
+void        gtk_paned_set_defer_resize (GtkPaned   *paned,
+                                        gboolean    defer_resize);
+GDK_AVAILABLE_IN_4_2
+gboolean    gtk_paned_get_defer_resize (GtkPaned   *paned);
+
 
 G_END_DECLS
 
@@ -525,6 +525,7 @@ gtk_password_entry_accessible_init (GtkAccessibleInterface *iface)
 {
   GtkAccessibleInterface *parent_iface = g_type_interface_peek_parent (iface);
   iface->get_at_context = parent_iface->get_at_context;
+  iface->peek_at_context = parent_iface->peek_at_context;
   iface->get_platform_state = gtk_password_entry_accessible_get_platform_state;
 }
 
@@ -0,0 +1,324 @@
+/*
+ * Copyright © 2021 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkpickindexprivate.h"
+
+#include "gtknative.h"
+#include "gtkwidgetprivate.h"
+
+#include <math.h>
+
+/* A uniform grid over the pick bounds of the children of a widget,
+ * so that gtk_widget_pick() only needs to look at the children that
+ * can possibly contain a point.
+ *
+ * Each cell stores the positions of the children overlapping it in
+ * sibling order, so the cells can be walked backwards to visit the
+ * children topmost first, just like the linear walk does. Children
+ * whose pick area can't be bounded, because of a 3D transform or a
+ * custom contains() somewhere in their subtree, are kept in a
+ * separate list that is merged into every lookup.
+ *
+ * The index is built lazily on the first pick after it was
+ * invalidated, and gtkwidget.c invalidates it whenever a child
+ * is added, removed, reordered or reallocated.
+ */
+
+/* Below this, walking the children is as fast as building the index */
+#define MIN_INDEXED_CHILDREN 32
+#define MAX_GRID_SIZE 64
+
+struct _GtkPickIndex
+{
+  guint valid   : 1;
+  guint indexed : 1;
+
+  /* GtkWidget, in sibling order */
+  GPtrArray *children;
+  /* positions in children, ascending */
+  GArray *unbounded;
+
+  graphene_rect_t bounds;
+  guint n_columns;
+  guint n_rows;
+
+  /* cell i has the positions cell_entries[cell_start[i]..cell_start[i + 1]] */
+  guint *cell_start;
+  guint *cell_entries;
+};
+
+GtkPickIndex *
+gtk_pick_index_new (void)
+{
+  GtkPickIndex *self;
+
+  self = g_slice_new0 (GtkPickIndex);
+  self->children = g_ptr_array_new ();
+  self->unbounded = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  return self;
+}
+
+static void
+gtk_pick_index_clear (GtkPickIndex *self)
+{
+  g_ptr_array_set_size (self->children, 0);
+  g_array_set_size (self->unbounded, 0);
+  g_clear_pointer (&self->cell_start, g_free);
+  g_clear_pointer (&self->cell_entries, g_free);
+  self->n_columns = 0;
+  self->n_rows = 0;
+  self->indexed = FALSE;
+}
+
+void
+gtk_pick_index_free (GtkPickIndex *self)
+{
+  gtk_pick_index_clear (self);
+  g_ptr_array_unref (self->children);
+  g_array_unref (self->unbounded);
+  g_slice_free (GtkPickIndex, self);
+}
+
+void
+gtk_pick_index_invalidate (GtkPickIndex *self)
+{
+  if (!self->valid)
+    return;
+
+  /* Don't keep pointers to children that may go away */
+  gtk_pick_index_clear (self);
+  self->valid = FALSE;
+}
+
+static inline guint
+get_column (GtkPickIndex *self,
+            double        x)
+{
+  int column;
+
+  if (self->n_columns == 1)
+    return 0;
+
+  column = floor ((x - self->bounds.origin.x) * self->n_columns / self->bounds.size.width);
+
+  return CLAMP (column, 0, (int) self->n_columns - 1);
+}
+
+static inline guint
+get_row (GtkPickIndex *self,
+         double        y)
+{
+  int row;
+
+  if (self->n_rows == 1)
+    return 0;
+
+  row = floor ((y - self->bounds.origin.y) * self->n_rows / self->bounds.size.height);
+
+  return CLAMP (row, 0, (int) self->n_rows - 1);
+}
+
+/*< private >
+ * gtk_pick_index_ensure:
+ * @self: a #GtkPickIndex
+ * @widget: the widget owning @self
+ *
+ * Makes sure the index is up to date with the children of @widget.
+ *
+ * Returns: %TRUE if the index can be used. If %FALSE, there are too
+ *   few children for the index to be worth it and they should be
+ *   walked instead.
+ */
+gboolean
+gtk_pick_index_ensure (GtkPickIndex *self,
+                       GtkWidget    *widget)
+{
+  graphene_rect_t *child_bounds;
+  gboolean *bounded;
+  GtkWidget *child;
+  guint n_bounded, n_cells, n_entries, size;
+  guint i, row, column;
+
+  if (self->valid)
+    return self->indexed;
+
+  self->valid = TRUE;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    g_ptr_array_add (self->children, child);
+
+  if (self->children->len < MIN_INDEXED_CHILDREN)
+    {
+      g_ptr_array_set_size (self->children, 0);
+      return FALSE;
+    }
+
+  child_bounds = g_new (graphene_rect_t, self->children->len);
+  bounded = g_new0 (gboolean, self->children->len);
+  n_bounded = 0;
+  self->bounds = GRAPHENE_RECT_INIT (0, 0, 0, 0);
+
+  for (i = 0; i < self->children->len; i++)
+    {
+      child = g_ptr_array_index (self->children, i);
+
+      /* Natives are never picked */
+      if (GTK_IS_NATIVE (child))
+        continue;
+
+      if (!gtk_widget_get_child_pick_bounds (child, &child_bounds[i]))
+        {
+          g_array_append_val (self->unbounded, i);
+          continue;
+        }
+
+      if (n_bounded == 0)
+        self->bounds = child_bounds[i];
+      else
+        graphene_rect_union (&self->bounds, &child_bounds[i], &self->bounds);
+
+      bounded[i] = TRUE;
+      n_bounded++;
+    }
+
+  size = CLAMP ((guint) ceil (sqrt (n_bounded)), 1, MAX_GRID_SIZE);
+  self->n_columns = self->bounds.size.width > 0 ? size : 1;
+  self->n_rows = self->bounds.size.height > 0 ? size : 1;
+  n_cells = self->n_columns * self->n_rows;
+
+  /* Count the entries of each cell, then turn the counts into offsets
+   * and fill in the entries
+   */
+  self->cell_start = g_new0 (guint, n_cells + 1);
+
+  for (i = 0; i < self->children->len; i++)
+    {
+      const graphene_rect_t *r = &child_bounds[i];
+
+      if (!bounded[i])
+        continue;
+
+      for (row = get_row (self, r->origin.y); row <= get_row (self, r->origin.y + r->size.height); row++)
+        for (column = get_column (self, r->origin.x); column <= get_column (self, r->origin.x + r->size.width); column++)
+          self->cell_start[row * self->n_columns + column + 1]++;
+    }
+
+  for (i = 0; i < n_cells; i++)
+    self->cell_start[i + 1] += self->cell_start[i];
+
+  n_entries = self->cell_start[n_cells];
+  self->cell_entries = g_new (guint, MAX (n_entries, 1));
+
+  for (i = 0; i < self->children->len; i++)
+    {
+      const graphene_rect_t *r = &child_bounds[i];
+
+      if (!bounded[i])
+        continue;
+
+      for (row = get_row (self, r->origin.y); row <= get_row (self, r->origin.y + r->size.height); row++)
+        for (column = get_column (self, r->origin.x); column <= get_column (self, r->origin.x + r->size.width); column++)
+          self->cell_entries[self->cell_start[row * self->n_columns + column]++] = i;
+    }
+
+  /* Filling in moved every offset to the start of the next cell */
+  for (i = n_cells; i > 0; i--)
+    self->cell_start[i] = self->cell_start[i - 1];
+  self->cell_start[0] = 0;
+
+  g_free (child_bounds);
+  g_free (bounded);
+
+  self->indexed = TRUE;
+
+  return TRUE;
+}
+
+/*< private >
+ * gtk_pick_index_iter_init:
+ * @iter: an uninitialized #GtkPickIndexIter
+ * @self: a #GtkPickIndex that gtk_pick_index_ensure() returned %TRUE for
+ * @x: X coordinate, relative to the widget owning @self
+ * @y: Y coordinate, relative to the widget owning @self
+ *
+ * Initializes @iter to go through all children that may contain
+ * the point (@x, @y), starting with the last one.
+ */
+void
+gtk_pick_index_iter_init (GtkPickIndexIter *iter,
+                          GtkPickIndex     *self,
+                          double            x,
+                          double            y)
+{
+  g_assert (self->valid && self->indexed);
+
+  iter->index = self;
+  iter->unbounded = (const guint *) self->unbounded->data;
+  iter->n_unbounded = self->unbounded->len;
+
+  if (self->cell_start[self->n_columns * self->n_rows] > 0 &&
+      x >= self->bounds.origin.x &&
+      y >= self->bounds.origin.y &&
+      x <= self->bounds.origin.x + self->bounds.size.width &&
+      y <= self->bounds.origin.y + self->bounds.size.height)
+    {
+      guint cell = get_row (self, y) * self->n_columns + get_column (self, x);
+
+      iter->cell = self->cell_entries + self->cell_start[cell];
+      iter->n_cell = self->cell_start[cell + 1] - self->cell_start[cell];
+    }
+  else
+    {
+      iter->cell = NULL;
+      iter->n_cell = 0;
+    }
+}
+
+/*< private >
+ * gtk_pick_index_iter_next:
+ * @iter: a #GtkPickIndexIter
+ *
+ * Returns: (nullable) (transfer none): the next child, or %NULL
+ *   when there are no more children
+ */
+GtkWidget *
+gtk_pick_index_iter_next (GtkPickIndexIter *iter)
+{
+  guint pos;
+
+  if (iter->n_cell > 0 &&
+      (iter->n_unbounded == 0 ||
+       iter->cell[iter->n_cell - 1] > iter->unbounded[iter->n_unbounded - 1]))
+    {
+      iter->n_cell--;
+      pos = iter->cell[iter->n_cell];
+    }
+  else if (iter->n_unbounded > 0)
+    {
+      iter->n_unbounded--;
+      pos = iter->unbounded[iter->n_unbounded];
+    }
+  else
+    return NULL;
+
+  return g_ptr_array_index (iter->index->children, pos);
+}
@@ -59,6 +59,11 @@
  * GtkPicture displays an image at its natural size. See #GtkImage if you want
  * to display a fixed-size image, such as an icon.
  *
+ * Loading a file blocks until the image is decoded. When many pictures
+ * are loaded while the user interacts with the application, like in a
+ * scrolling grid of photos, set #GtkPicture:load-async to load files in
+ * a thread instead. The picture stays empty until the image is loaded.
+ *
  * # Sizing the paintable
  *
  * You can influence how the paintable is displayed inside the #GtkPicture.
@@ -88,6 +93,7 @@ enum
   PROP_ALTERNATIVE_TEXT,
   PROP_KEEP_ASPECT_RATIO,
   PROP_CAN_SHRINK,
+  PROP_LOAD_ASYNC,
   NUM_PROPERTIES
 };
 
@@ -97,10 +103,12 @@ struct _GtkPicture
 
   GdkPaintable *paintable;
   GFile *file;
+  GCancellable *load_cancellable;
 
   char *alternative_text;
   guint keep_aspect_ratio : 1;
   guint can_shrink : 1;
+  guint load_async : 1;
 };
 
 struct _GtkPictureClass
@@ -251,6 +259,10 @@ gtk_picture_set_property (GObject      *object,
       gtk_picture_set_can_shrink (self, g_value_get_boolean (value));
       break;
 
+    case PROP_LOAD_ASYNC:
+      gtk_picture_set_load_async (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -287,6 +299,10 @@ gtk_picture_get_property (GObject     *object,
       g_value_set_boolean (value, self->can_shrink);
       break;
 
+    case PROP_LOAD_ASYNC:
+      g_value_set_boolean (value, self->load_async);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -381,6 +397,21 @@ gtk_picture_class_init (GtkPictureClass *class)
                             TRUE,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkPicture:load-async:
+   *
+   * Whether files are loaded in a thread, instead of blocking until
+   * they are loaded.
+   *
+   * Since: 4.2
+   */
+  properties[PROP_LOAD_ASYNC] =
+      g_param_spec_boolean ("load-async",
+                            P_("Load async"),
+                            P_("Whether to load files in a thread"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 
   gtk_widget_class_set_css_name (widget_class, I_("picture"));
@@ -584,8 +615,9 @@ on_loader_size_prepared (GdkPixbufLoader *loader,
 }
 
 static GdkPaintable *
-load_scalable_with_loader (GFile *file,
-                           int    scale_factor)
+load_scalable_with_loader (GFile        *file,
+                           int           scale_factor,
+                           GCancellable *cancellable)
 {
   GdkPixbufLoader *loader;
   GBytes *bytes;
@@ -600,7 +632,7 @@ load_scalable_with_loader (GFile *file,
 
   g_signal_connect (loader, "size-prepared", G_CALLBACK (on_loader_size_prepared), &loader_data);
 
-  bytes = g_file_load_bytes (file, NULL, NULL, NULL);
+  bytes = g_file_load_bytes (file, cancellable, NULL, NULL);
   if (bytes == NULL)
     goto out1;
 
@@ -628,6 +660,61 @@ out1:
   return result;
 }
 
+typedef struct {
+  GFile *file;
+  int scale_factor;
+} LoadData;
+
+static void
+load_data_free (LoadData *data)
+{
+  g_object_unref (data->file);
+  g_free (data);
+}
+
+static void
+load_file_thread (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  LoadData *data = task_data;
+  GdkPaintable *paintable;
+
+  paintable = load_scalable_with_loader (data->file, data->scale_factor, cancellable);
+
+  g_task_return_pointer (task, paintable, (GDestroyNotify) g_object_unref);
+}
+
+static void
+load_file_done (GObject      *source,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  GtkPicture *self = GTK_PICTURE (source);
+  GdkPaintable *paintable;
+
+  /* A newer file or paintable replaced the one we loaded */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  g_clear_object (&self->load_cancellable);
+
+  paintable = g_task_propagate_pointer (G_TASK (result), NULL);
+  gtk_picture_set_paintable (self, paintable);
+  g_clear_object (&paintable);
+}
+
+static void
+gtk_picture_cancel_load (GtkPicture *self)
+{
+  if (self->load_cancellable == NULL)
+    return;
+
+  g_cancellable_cancel (self->load_cancellable);
+  g_clear_object (&self->load_cancellable);
+}
+
 /**
  * gtk_picture_set_file:
  * @self: a #GtkPicture
@@ -654,9 +741,30 @@ gtk_picture_set_file (GtkPicture *self,
   g_set_object (&self->file, file);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FILE]);
 
-  paintable = load_scalable_with_loader (file, gtk_widget_get_scale_factor (GTK_WIDGET (self)));
-  gtk_picture_set_paintable (self, paintable);
-  g_clear_object (&paintable);
+  if (self->load_async && file != NULL)
+    {
+      LoadData *data;
+      GTask *task;
+
+      gtk_picture_set_paintable (self, NULL);
+
+      data = g_new (LoadData, 1);
+      data->file = g_object_ref (file);
+      data->scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+      self->load_cancellable = g_cancellable_new ();
+      task = g_task_new (self, self->load_cancellable, load_file_done, NULL);
+      g_task_set_source_tag (task, gtk_picture_set_file);
+      g_task_set_task_data (task, data, (GDestroyNotify) load_data_free);
+      g_task_run_in_thread (task, load_file_thread);
+      g_object_unref (task);
+    }
+  else
+    {
+      paintable = load_scalable_with_loader (file, gtk_widget_get_scale_factor (GTK_WIDGET (self)), NULL);
+      gtk_picture_set_paintable (self, paintable);
+      g_clear_object (&paintable);
+    }
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -808,6 +916,8 @@ gtk_picture_set_paintable (GtkPicture   *self,
   g_return_if_fail (GTK_IS_PICTURE (self));
   g_return_if_fail (paintable == NULL || GDK_IS_PAINTABLE (paintable));
 
+  gtk_picture_cancel_load (self);
+
   if (self->paintable == paintable)
     return;
 
@@ -961,6 +1071,53 @@ gtk_picture_get_can_shrink (GtkPicture *self)
   return self->can_shrink;
 }
 
+/**
+ * gtk_picture_set_load_async:
+ * @self: a #GtkPicture
+ * @load_async: whether to load files in a thread
+ *
+ * If set to %TRUE, files given to @self, with gtk_picture_set_file()
+ * or the functions calling it, are loaded in a thread. Until the file
+ * is loaded, @self displays nothing.
+ *
+ * This only affects files set after this call.
+ *
+ * Since: 4.2
+ */
+void
+gtk_picture_set_load_async (GtkPicture *self,
+                            gboolean    load_async)
+{
+  g_return_if_fail (GTK_IS_PICTURE (self));
+
+  load_async = !!load_async;
+
+  if (self->load_async == load_async)
+    return;
+
+  self->load_async = load_async;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOAD_ASYNC]);
+}
+
+/**
+ * gtk_picture_get_load_async:
+ * @self: a #GtkPicture
+ *
+ * Gets the value set via gtk_picture_set_load_async().
+ *
+ * Returns: %TRUE if files are loaded in a thread
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_picture_get_load_async (GtkPicture *self)
+{
+  g_return_val_if_fail (GTK_IS_PICTURE (self), FALSE);
+
+  return self->load_async;
+}
+
 /**
  * gtk_picture_set_alternative_text:
  * @self: a #GtkPicture
@@ -915,12 +915,12 @@ gtk_popover_realize (GtkWidget *widget)
 {
   GtkPopover *popover = GTK_POPOVER (widget);
   GtkPopoverPrivate *priv = gtk_popover_get_instance_private (popover);
-  GdkSurface *parent_surface;
   GtkWidget *parent;
 
   parent = gtk_widget_get_parent (widget);
-  parent_surface = gtk_native_get_surface (gtk_widget_get_native (parent));
-  priv->surface = gdk_surface_new_popup (parent_surface, priv->autohide);
+  priv->surface = gtk_native_lease_popup (gtk_widget_get_native (parent),
+                                          priv->autohide,
+                                          &priv->renderer);
 
   gdk_surface_set_widget (priv->surface, widget);
 
@@ -930,8 +930,6 @@ gtk_popover_realize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_popover_parent_class)->realize (widget);
 
-  priv->renderer = gsk_renderer_new_for_surface (priv->surface);
-
   gtk_native_realize (GTK_NATIVE (popover));
 }
 
@@ -940,20 +938,21 @@ gtk_popover_unrealize (GtkWidget *widget)
 {
   GtkPopover *popover = GTK_POPOVER (widget);
   GtkPopoverPrivate *priv = gtk_popover_get_instance_private (popover);
+  GtkWidget *parent;
 
   gtk_native_unrealize (GTK_NATIVE (popover));
 
   GTK_WIDGET_CLASS (gtk_popover_parent_class)->unrealize (widget);
 
-  gsk_renderer_unrealize (priv->renderer);
-  g_clear_object (&priv->renderer);
-
   g_signal_handlers_disconnect_by_func (priv->surface, surface_mapped_changed, widget);
   g_signal_handlers_disconnect_by_func (priv->surface, surface_render, widget);
   g_signal_handlers_disconnect_by_func (priv->surface, surface_event, widget);
   gdk_surface_set_widget (priv->surface, NULL);
-  gdk_surface_destroy (priv->surface);
-  g_clear_object (&priv->surface);
+
+  parent = gtk_widget_get_parent (widget);
+  gtk_native_return_popup (parent ? gtk_widget_get_native (parent) : NULL,
+                           g_steal_pointer (&priv->surface),
+                           g_steal_pointer (&priv->renderer));
 }
 
 static void
@@ -84,9 +84,6 @@ void
 gtk_print_backends_init (void)
 {
   GIOExtensionPoint *ep;
-  GIOModuleScope *scope;
-  char **paths;
-  int i;
 
   GTK_NOTE (MODULES,
             g_print ("Registering extension point %s\n", GTK_PRINT_BACKEND_EXTENSION_POINT_NAME));
@@ -94,32 +91,7 @@ gtk_print_backends_init (void)
   ep = g_io_extension_point_register (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
   g_io_extension_point_set_required_type (ep, GTK_TYPE_PRINT_BACKEND);
 
-  scope = g_io_module_scope_new (G_IO_MODULE_SCOPE_BLOCK_DUPLICATES);
-
-  paths = _gtk_get_module_path ("printbackends");
-  for (i = 0; paths[i]; i++)
-    {
-      GTK_NOTE (MODULES,
-                g_print ("Scanning io modules in %s\n", paths[i]));
-      g_io_modules_scan_all_in_directory_with_scope (paths[i], scope);
-    }
-  g_strfreev (paths);
-
-  g_io_module_scope_free (scope);
-
-  if (GTK_DEBUG_CHECK (MODULES))
-    {
-      GList *list, *l;
-
-      list = g_io_extension_point_get_extensions (ep);
-      for (l = list; l; l = l->next)
-        {
-          GIOExtension *ext = l->data;
-          g_print ("extension: %s: type %s\n",
-                   g_io_extension_get_name (ext),
-                   g_type_name (g_io_extension_get_type (ext)));
-        }
-    }
+  _gtk_io_modules_scan_async ("printbackends", GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 }
 
 /**
@@ -140,6 +112,8 @@ gtk_print_backend_load_modules (void)
 
   result = NULL;
 
+  _gtk_io_modules_ensure (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
+
   ep = g_io_extension_point_lookup (GTK_PRINT_BACKEND_EXTENSION_POINT_NAME);
 
   settings = gtk_settings_get_default ();
@@ -141,7 +141,8 @@ enum
   PROP_EMBED_PAGE_SETUP,
   PROP_HAS_SELECTION,
   PROP_SUPPORT_SELECTION,
-  PROP_N_PAGES_TO_PRINT
+  PROP_N_PAGES_TO_PRINT,
+  PROP_THREADED_DRAWING
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -155,6 +156,7 @@ static void          common_render_page      (GtkPrintOperation             *op,
 static void          increment_page_sequence (PrintPagesData *data);
 static void          prepare_data            (PrintPagesData *data);
 static void          clamp_page_ranges       (PrintPagesData *data);
+static void          start_print_pages_idle  (PrintPagesData *data);
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkPrintOperation, gtk_print_operation, G_TYPE_OBJECT,
@@ -239,6 +241,7 @@ gtk_print_operation_init (GtkPrintOperation *operation)
   priv->support_selection = FALSE;
   priv->has_selection = FALSE;
   priv->embed_page_setup = FALSE;
+  priv->threaded_drawing = FALSE;
 
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 
@@ -420,6 +423,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_SUPPORT_SELECTION:
       gtk_print_operation_set_support_selection (op, g_value_get_boolean (value));
       break;
+    case PROP_THREADED_DRAWING:
+      gtk_print_operation_set_threaded_drawing (op, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -491,6 +497,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_N_PAGES_TO_PRINT:
       g_value_set_int (value, priv->nr_of_pages_to_print);
       break;
+    case PROP_THREADED_DRAWING:
+      g_value_set_boolean (value, priv->threaded_drawing);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -520,6 +529,11 @@ struct _PrintPagesData
   gboolean initialized;
   gboolean is_preview;
   gboolean done;
+
+  /* pages being drawn in worker threads, in page order */
+  GQueue render_jobs;
+  int n_rendered;
+  gboolean suspended;
 };
 
 typedef struct
@@ -1382,6 +1396,25 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 						     G_MAXINT,
 						     -1,
 						     GTK_PARAM_READABLE|G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GtkPrintOperation:threaded-drawing:
+   *
+   * If %TRUE, the #GtkPrintOperation::draw-page handlers may be called
+   * from worker threads, for several pages at the same time, when
+   * exporting to a file.
+   *
+   * See gtk_print_operation_set_threaded_drawing().
+   *
+   * Since: 4.2
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_THREADED_DRAWING,
+				   g_param_spec_boolean ("threaded-drawing",
+							 P_("Threaded Drawing"),
+							 P_("TRUE if pages may be drawn in worker threads when exporting"),
+							 FALSE,
+							 GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 }
 
 /**
@@ -2194,6 +2227,10 @@ print_pages_idle_done (gpointer user_data)
 
   priv->print_pages_idle_id = 0;
 
+  /* waiting for worker threads, we'll be back */
+  if (data->suspended)
+    return;
+
   if (priv->show_progress_timeout_id > 0)
     {
       g_source_remove (priv->show_progress_timeout_id);
@@ -2313,6 +2350,64 @@ gtk_print_operation_get_embed_page_setup (GtkPrintOperation *op)
   return priv->embed_page_setup;
 }
 
+/**
+ * gtk_print_operation_set_threaded_drawing:
+ * @op: a #GtkPrintOperation
+ * @threaded_drawing: %TRUE to allow drawing pages in worker threads
+ *
+ * Declares that the #GtkPrintOperation::draw-page handlers of @op
+ * can safely run in worker threads.
+ *
+ * When exporting to a file with %GTK_PRINT_OPERATION_ACTION_EXPORT,
+ * pages are then drawn concurrently, each into a #GtkPrintContext of
+ * its own, and written to the file in order as they complete. The
+ * other signals are still emitted in the main thread, and the
+ * progress can be followed with the #GtkPrintOperation::status-changed
+ * signal.
+ *
+ * The handlers must only use the context they are given, must not
+ * touch any widgets, and must not call
+ * gtk_print_operation_set_defer_drawing(). Other actions are not
+ * affected by this setting.
+ *
+ * Since: 4.2
+ */
+void
+gtk_print_operation_set_threaded_drawing (GtkPrintOperation *op,
+                                          gboolean           threaded_drawing)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  threaded_drawing = threaded_drawing != FALSE;
+  if (priv->threaded_drawing != threaded_drawing)
+    {
+      priv->threaded_drawing = threaded_drawing;
+      g_object_notify (G_OBJECT (op), "threaded-drawing");
+    }
+}
+
+/**
+ * gtk_print_operation_get_threaded_drawing:
+ * @op: a #GtkPrintOperation
+ *
+ * Gets the value of #GtkPrintOperation:threaded-drawing property.
+ *
+ * Returns: whether pages may be drawn in worker threads
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_print_operation_get_threaded_drawing (GtkPrintOperation *op)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+
+  g_return_val_if_fail (GTK_IS_PRINT_OPERATION (op), FALSE);
+
+  return priv->threaded_drawing;
+}
+
 /**
  * gtk_print_operation_draw_page_finish:
  * @op: a #GtkPrintOperation
@@ -2347,6 +2442,29 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 }
 
+/* Sets up the cairo context of @print_context for drawing
+ * a page that covers a whole sheet.
+ */
+static void
+transform_single_page (GtkPrintOperation *op,
+                       GtkPrintContext   *print_context)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+  cairo_t *cr = gtk_print_context_get_cairo_context (print_context);
+
+  if (priv->manual_orientation)
+    _gtk_print_context_rotate_according_to_orientation (print_context);
+  else
+    _gtk_print_context_reverse_according_to_orientation (print_context);
+
+  if (!priv->use_full_page)
+    _gtk_print_context_translate_into_margin (print_context);
+  if (priv->manual_scale != 1.0)
+    cairo_scale (cr,
+                 priv->manual_scale,
+                 priv->manual_scale);
+}
+
 static void
 common_render_page (GtkPrintOperation *op,
 		    int                page_nr)
@@ -2371,20 +2489,8 @@ common_render_page (GtkPrintOperation *op,
   
   cairo_save (cr);
   
-  if (priv->manual_orientation)
-    _gtk_print_context_rotate_according_to_orientation (print_context);
-  else
-    _gtk_print_context_reverse_according_to_orientation (print_context);
-
   if (priv->manual_number_up <= 1)
-    {
-      if (!priv->use_full_page)
-        _gtk_print_context_translate_into_margin (print_context);
-      if (priv->manual_scale != 1.0)
-        cairo_scale (cr,
-                     priv->manual_scale,
-                     priv->manual_scale);
-    }
+    transform_single_page (op, print_context);
   else
     {
       GtkPageOrientation  orientation;
@@ -2397,6 +2503,11 @@ common_render_page (GtkPrintOperation *op,
       double              horizontal_offset = 0.0, vertical_offset = 0.0;
       int                 columns, rows, x, y, tmp_length;
 
+      if (priv->manual_orientation)
+        _gtk_print_context_rotate_according_to_orientation (print_context);
+      else
+        _gtk_print_context_reverse_according_to_orientation (print_context);
+
       page_setup = gtk_print_context_get_page_setup (print_context);
       orientation = gtk_page_setup_get_orientation (page_setup);
 
@@ -2741,6 +2852,169 @@ prepare_data (PrintPagesData *data)
                                    NULL);
 }
 
+typedef struct
+{
+  PrintPagesData *data;
+  int page_nr;
+  GtkPageSetup *page_setup;
+  GtkPrintContext *print_context;
+  cairo_surface_t *surface;
+  gboolean rendered;
+} RenderJob;
+
+static void
+render_job_free (RenderJob *job)
+{
+  g_object_unref (job->print_context);
+  g_object_unref (job->page_setup);
+  cairo_surface_destroy (job->surface);
+  g_slice_free (RenderJob, job);
+}
+
+static void
+render_job_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  RenderJob *job = task_data;
+
+  g_signal_emit (source_object, signals[DRAW_PAGE], 0,
+                 job->print_context, job->page_nr);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+render_job_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  RenderJob *job = g_task_get_task_data (G_TASK (result));
+  PrintPagesData *data = job->data;
+
+  job->rendered = TRUE;
+
+  if (data->suspended)
+    {
+      data->suspended = FALSE;
+      start_print_pages_idle (data);
+    }
+}
+
+/* Each page gets a print context of its own, which records
+ * the drawing so that it can be replayed into the real one
+ * once the preceding pages are done.
+ */
+static void
+queue_render_job (PrintPagesData *data,
+                  int             page_nr)
+{
+  GtkPrintOperation *op = data->op;
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+  RenderJob *job;
+  GTask *task;
+  cairo_t *cr;
+
+  job = g_slice_new0 (RenderJob);
+  job->data = data;
+  job->page_nr = page_nr;
+  job->page_setup = create_page_setup (op);
+
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0,
+                 priv->print_context, page_nr, job->page_setup);
+
+  job->surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  job->print_context = _gtk_print_context_new (op);
+  _gtk_print_context_set_page_setup (job->print_context, job->page_setup);
+
+  cr = cairo_create (job->surface);
+  gtk_print_context_set_cairo_context (job->print_context, cr, 72, 72);
+  cairo_destroy (cr);
+
+  transform_single_page (op, job->print_context);
+
+  g_queue_push_tail (&data->render_jobs, job);
+
+  task = g_task_new (op, NULL, render_job_done, NULL);
+  g_task_set_source_tag (task, queue_render_job);
+  g_task_set_task_data (task, job, NULL);
+  g_task_run_in_thread (task, render_job_thread);
+  g_object_unref (task);
+}
+
+static void
+replay_rendered_page (PrintPagesData *data,
+                      RenderJob      *job)
+{
+  GtkPrintOperation *op = data->op;
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (op);
+  cairo_t *cr;
+  char *text;
+
+  _gtk_print_context_set_page_setup (priv->print_context, job->page_setup);
+  priv->start_page (op, priv->print_context, job->page_setup);
+
+  cr = gtk_print_context_get_cairo_context (priv->print_context);
+  cairo_save (cr);
+  cairo_set_source_surface (cr, job->surface, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  priv->end_page (op, priv->print_context);
+
+  data->n_rendered++;
+
+  text = g_strdup_printf (_("Rendered page %d of %d"),
+                          data->n_rendered, priv->nr_of_pages_to_print);
+  _gtk_print_operation_set_status (op, GTK_PRINT_STATUS_GENERATING_DATA, text);
+  g_free (text);
+}
+
+/* Draws pages in worker threads when exporting, for applications
+ * that declared their draw-page handlers thread-safe. Returns
+ * %TRUE when all pages have been written out.
+ */
+static gboolean
+render_pages_in_threads (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (data->op);
+  guint max_jobs = 2 * g_get_num_processors ();
+
+  while (!g_queue_is_empty (&data->render_jobs))
+    {
+      RenderJob *job = g_queue_peek_head (&data->render_jobs);
+
+      if (!job->rendered)
+        break;
+
+      g_queue_pop_head (&data->render_jobs);
+
+      if (!priv->cancelled)
+        replay_rendered_page (data, job);
+
+      render_job_free (job);
+    }
+
+  /* bounded, so that we don't keep too many recordings around */
+  while (!priv->cancelled && !data->done &&
+         data->render_jobs.length < max_jobs)
+    {
+      increment_page_sequence (data);
+
+      if (!data->done)
+        queue_render_job (data, data->page);
+    }
+
+  if (g_queue_is_empty (&data->render_jobs))
+    return data->done || priv->cancelled;
+
+  /* nothing to do until the next page comes in */
+  data->suspended = TRUE;
+
+  return FALSE;
+}
+
 static gboolean
 print_pages_idle (gpointer user_data)
 {
@@ -2764,6 +3038,14 @@ print_pages_idle (gpointer user_data)
           goto out;
         }
 
+      if (priv->threaded_drawing &&
+          priv->action == GTK_PRINT_OPERATION_ACTION_EXPORT &&
+          priv->manual_number_up <= 1)
+        {
+          done = render_pages_in_threads (data);
+          goto out;
+        }
+
       increment_page_sequence (data);
 
       if (!data->done)
@@ -2773,7 +3055,8 @@ print_pages_idle (gpointer user_data)
 
  out:
 
-      if (priv->cancelled)
+      /* pages still being drawn have to be waited for */
+      if (priv->cancelled && g_queue_is_empty (&data->render_jobs))
         {
           _gtk_print_operation_set_status (data->op, GTK_PRINT_STATUS_FINISHED_ABORTED, NULL);
 
@@ -2790,7 +3073,19 @@ print_pages_idle (gpointer user_data)
       update_progress (data);
     }
 
-  return !done;
+  return !done && !data->suspended;
+}
+
+static void
+start_print_pages_idle (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = gtk_print_operation_get_instance_private (data->op);
+
+  priv->print_pages_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 10,
+                                               print_pages_idle,
+                                               data,
+                                               print_pages_idle_done);
+  g_source_set_name_by_id (priv->print_pages_idle_id, "[gtk] print_pages_idle");
 }
   
 static void
@@ -2927,11 +3222,7 @@ print_pages (GtkPrintOperation       *op,
       priv->manual_number_up_layout = gtk_print_settings_get_number_up_layout (priv->print_settings);
     }
   
-  priv->print_pages_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 10,
-                                               print_pages_idle,
-                                               data,
-                                               print_pages_idle_done);
-  g_source_set_name_by_id (priv->print_pages_idle_id, "[gtk] print_pages_idle");
+  start_print_pages_idle (data);
   
   /* Recursive main loop to make sure we don't exit  on sync operations  */
   if (priv->is_sync)
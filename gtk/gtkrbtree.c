@@ -21,6 +21,8 @@
 
 #include "gtkdebug.h"
 
+#include <string.h>
+
 /* Define the following to print adds and removals to stdout.
  * The format of the printout will be suitable for addition as a new test to
  * testsuite/gtk/rbtree-crash.c
@@ -30,7 +32,17 @@
  */
 #undef DUMP_MODIFICATION
 
+/* Nodes are allocated from chunks owned by the tree, so that a tree
+ * of many items takes few allocations and keeps its nodes close to
+ * each other. Chunks grow in size up to MAX_CHUNK_NODES nodes. Removed
+ * nodes go to a free list for reuse, and all chunks are released once
+ * the tree is empty.
+ */
+#define MIN_CHUNK_NODES 16
+#define MAX_CHUNK_NODES 1024
+
 typedef struct _GtkRbNode GtkRbNode;
+typedef struct _GtkRbChunk GtkRbChunk;
 
 struct _GtkRbTree
 {
@@ -43,8 +55,24 @@ struct _GtkRbTree
   GDestroyNotify clear_augment_func;
 
   GtkRbNode *root;
+
+  GtkRbChunk *chunks;
+  guchar *chunk_next;
+  guchar *chunk_end;
+  GtkRbNode *free_nodes;
+};
+
+struct _GtkRbChunk
+{
+  GtkRbChunk *next;
+  gsize n_nodes;
 };
 
+/* Keeps nodes aligned like g_slice_alloc() does */
+#define NODE_ALIGNMENT (2 * sizeof (gpointer))
+#define ALIGN_NODE_SIZE(size) (((size) + NODE_ALIGNMENT - 1) & ~(NODE_ALIGNMENT - 1))
+#define CHUNK_HEADER_SIZE ALIGN_NODE_SIZE (sizeof (GtkRbChunk))
+
 struct _GtkRbNode
 {
   guint red :1;
@@ -109,7 +137,62 @@ set_parent (GtkRbTree *tree,
 static inline gsize
 gtk_rb_node_get_size (GtkRbTree *tree)
 {
-  return sizeof (GtkRbNode) + tree->element_size + tree->augment_size;
+  return ALIGN_NODE_SIZE (sizeof (GtkRbNode) + tree->element_size + tree->augment_size);
+}
+
+static GtkRbNode *
+gtk_rb_tree_alloc_node (GtkRbTree *tree)
+{
+  gsize node_size = gtk_rb_node_get_size (tree);
+  GtkRbChunk *chunk;
+  GtkRbNode *result;
+  gsize n_nodes;
+
+  if (tree->free_nodes)
+    {
+      result = tree->free_nodes;
+      tree->free_nodes = result->left;
+      return result;
+    }
+
+  if (tree->chunk_next == tree->chunk_end)
+    {
+      if (tree->chunks)
+        n_nodes = MIN (tree->chunks->n_nodes * 2, MAX_CHUNK_NODES);
+      else
+        n_nodes = MIN_CHUNK_NODES;
+
+      chunk = g_malloc (CHUNK_HEADER_SIZE + n_nodes * node_size);
+      chunk->next = tree->chunks;
+      chunk->n_nodes = n_nodes;
+      tree->chunks = chunk;
+
+      tree->chunk_next = (guchar *) chunk + CHUNK_HEADER_SIZE;
+      tree->chunk_end = tree->chunk_next + n_nodes * node_size;
+    }
+
+  result = (GtkRbNode *) tree->chunk_next;
+  tree->chunk_next += node_size;
+
+  return result;
+}
+
+/* Frees the memory of all nodes, which must have been cleared */
+static void
+gtk_rb_tree_release_nodes (GtkRbTree *tree)
+{
+  GtkRbChunk *chunk, *next;
+
+  for (chunk = tree->chunks; chunk; chunk = next)
+    {
+      next = chunk->next;
+      g_free (chunk);
+    }
+
+  tree->chunks = NULL;
+  tree->chunk_next = NULL;
+  tree->chunk_end = NULL;
+  tree->free_nodes = NULL;
 }
 
 static GtkRbNode *
@@ -117,7 +200,8 @@ gtk_rb_node_new (GtkRbTree *tree)
 {
   GtkRbNode *result;
 
-  result = g_slice_alloc0 (gtk_rb_node_get_size (tree));
+  result = gtk_rb_tree_alloc_node (tree);
+  memset (result, 0, gtk_rb_node_get_size (tree));
 
   result->red = TRUE;
   result->dirty = TRUE;
@@ -126,30 +210,44 @@ gtk_rb_node_new (GtkRbTree *tree)
 }
 
 static void
-gtk_rb_node_free (GtkRbTree *tree,
-                  GtkRbNode *node)
+gtk_rb_node_clear (GtkRbTree *tree,
+                   GtkRbNode *node)
 {
   if (tree->clear_func)
     tree->clear_func (NODE_TO_POINTER (node));
   if (tree->clear_augment_func)
     tree->clear_augment_func (NODE_TO_AUG_POINTER (tree, node));
+}
+
+static void
+gtk_rb_node_free (GtkRbTree *tree,
+                  GtkRbNode *node)
+{
+  gtk_rb_node_clear (tree, node);
 
-  g_slice_free1 (gtk_rb_node_get_size (tree), node);
+  if (tree->root == NULL)
+    {
+      gtk_rb_tree_release_nodes (tree);
+      return;
+    }
+
+  node->left = tree->free_nodes;
+  tree->free_nodes = node;
 }
 
 static void
-gtk_rb_node_free_deep (GtkRbTree *tree,
-                       GtkRbNode *node)
+gtk_rb_node_clear_deep (GtkRbTree *tree,
+                        GtkRbNode *node)
 {
   GtkRbNode *right = node->right;
 
   if (node->left)
-    gtk_rb_node_free_deep (tree, node->left);
+    gtk_rb_node_clear_deep (tree, node->left);
 
-  gtk_rb_node_free (tree, node);
+  gtk_rb_node_clear (tree, node);
 
   if (right)
-    gtk_rb_node_free_deep (tree, right);
+    gtk_rb_node_clear_deep (tree, right);
 }
 
 static void
@@ -539,8 +637,9 @@ gtk_rb_tree_unref (GtkRbTree *tree)
     return;
 
   if (tree->root)
-    gtk_rb_node_free_deep (tree, tree->root);
-    
+    gtk_rb_node_clear_deep (tree, tree->root);
+  gtk_rb_tree_release_nodes (tree);
+
   g_slice_free (GtkRbTree, tree);
 }
 
@@ -793,8 +892,9 @@ gtk_rb_tree_remove_all (GtkRbTree *tree)
 #endif /* DUMP_MODIFICATION */
 
   if (tree->root)
-    gtk_rb_node_free_deep (tree, tree->root);
+    gtk_rb_node_clear_deep (tree, tree->root);
 
   tree->root = NULL;
+  gtk_rb_tree_release_nodes (tree);
 }
 
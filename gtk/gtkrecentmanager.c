@@ -160,11 +160,35 @@ struct _GtkRecentInfo
   int ref_count;
 };
 
+/* State shared with the threads that read and write the recently
+ * used resources file. It is reference counted so that a thread that
+ * is still running when the manager goes away can finish safely.
+ */
+typedef struct
+{
+  int ref_count;
+
+  /* main thread only; cleared when the manager is disposed */
+  GtkRecentManager *manager;
+
+  /* serializes writes, and protects the fields below */
+  GMutex lock;
+
+  /* serial and contents of the last snapshot we wrote */
+  guint64 written_serial;
+  GBytes *written_data;
+} RecentStore;
+
 struct _GtkRecentManagerPrivate
 {
   char *filename;
 
   guint is_dirty : 1;
+  guint is_saving : 1;
+  guint save_again : 1;
+  guint save_sync : 1;
+  guint is_loading : 1;
+  guint load_again : 1;
 
   int size;
 
@@ -172,8 +196,13 @@ struct _GtkRecentManagerPrivate
 
   GFileMonitor *monitor;
 
+  RecentStore *store;
+  guint64 save_serial;
+
   guint changed_timeout;
   guint changed_age;
+
+  guint reload_timeout;
 };
 
 enum
@@ -216,6 +245,11 @@ static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manag
 
 
 static void     build_recent_items_list                (GtkRecentManager  *manager);
+static void     set_recent_items                       (GtkRecentManager  *manager,
+                                                        GBookmarkFile     *items,
+                                                        const GError      *error);
+static void     save_recent_items                      (GtkRecentManager  *manager);
+static void     reload_recent_items                    (GtkRecentManager  *manager);
 static void     purge_recent_items_list                (GtkRecentManager  *manager,
                                                         GError           **error);
 
@@ -257,6 +291,25 @@ gtk_recent_manager_error_quark (void)
   return g_quark_from_static_string ("gtk-recent-manager-error-quark");
 }
 
+static RecentStore *
+recent_store_ref (RecentStore *store)
+{
+  g_atomic_int_inc (&store->ref_count);
+
+  return store;
+}
+
+static void
+recent_store_unref (RecentStore *store)
+{
+  if (!g_atomic_int_dec_and_test (&store->ref_count))
+    return;
+
+  g_clear_pointer (&store->written_data, g_bytes_unref);
+  g_mutex_clear (&store->lock);
+  g_slice_free (RecentStore, store);
+}
+
 static void
 gtk_recent_manager_class_init (GtkRecentManagerClass *klass)
 {
@@ -326,6 +379,11 @@ gtk_recent_manager_init (GtkRecentManager *manager)
   priv->size = 0;
   priv->filename = NULL;
 
+  priv->store = g_slice_new0 (RecentStore);
+  priv->store->ref_count = 1;
+  priv->store->manager = manager;
+  g_mutex_init (&priv->store->lock);
+
   settings = gtk_settings_get_default ();
   if (settings)
     g_signal_connect_swapped (settings, "notify::gtk-recent-files-enabled",
@@ -384,6 +442,8 @@ gtk_recent_manager_finalize (GObject *object)
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
 
+  recent_store_unref (priv->store);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->finalize (object);
 }
 
@@ -409,13 +469,26 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->changed_age = 0;
     }
 
-  if (priv->is_dirty)
+  g_clear_handle_id (&priv->reload_timeout, g_source_remove);
+
+  /* a save that is still in flight may not have our latest
+   * changes, so we write them out ourselves before going away
+   */
+  if (priv->is_dirty || priv->is_saving)
     {
+      priv->is_dirty = TRUE;
+      priv->save_sync = TRUE;
+
       g_object_ref (manager);
       g_signal_emit (manager, signal_changed, 0);
       g_object_unref (manager);
+
+      priv->is_saving = FALSE;
     }
 
+  /* let the threads still running know that nobody is waiting */
+  priv->store->manager = NULL;
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
@@ -435,8 +508,6 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
   if (priv->is_dirty)
     {
-      GError *write_error;
-
       /* we are marked as dirty, so we dump the content of our
        * recently used items list
        */
@@ -482,29 +553,7 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
             }
         }
 
-      if (priv->filename != NULL)
-        {
-          write_error = NULL;
-          g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-          if (write_error)
-            {
-              char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to store changes into '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         write_error->message);
-              g_free (utf8);
-              g_error_free (write_error);
-            }
-
-          if (g_chmod (priv->filename, 0600) < 0)
-            {
-              char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to set the permissions of '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         g_strerror (errno));
-              g_free (utf8);
-            }
-        }
+      save_recent_items (manager);
 
       /* mark us as clean */
       priv->is_dirty = FALSE;
@@ -513,9 +562,9 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
     {
       /* we are not marked as dirty, so we have been called
        * because the recently used resources file has been
-       * changed (and not from us).
+       * changed (and not from us); load_done() has already
+       * replaced the list by the time we get here.
        */
-      build_recent_items_list (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -535,7 +584,7 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
-      gtk_recent_manager_changed (manager);
+      reload_recent_items (manager);
       break;
 
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
@@ -645,6 +694,54 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
   build_recent_items_list (manager);
 }
 
+/* replaces the items list with one that was read from the recently
+ * used resources file, or drops it if reading failed.
+ */
+static void
+set_recent_items (GtkRecentManager *manager,
+                  GBookmarkFile    *items,
+                  const GError     *error)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  int size;
+
+  if (error)
+    {
+      /* if the file does not exist we just wait for the first write
+       * operation on this recent manager instance, to avoid creating
+       * empty files and leading to spurious file system events (Sabayon
+       * will not be happy about those)
+       */
+      if (error->domain == G_FILE_ERROR &&
+          error->code != G_FILE_ERROR_NOENT)
+        {
+          char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+          g_warning ("Attempting to read the recently used resources "
+                     "file at '%s', but the parser failed: %s.",
+                     utf8 ? utf8 : "(invalid filename)",
+                     error->message);
+          g_free (utf8);
+        }
+
+      g_clear_pointer (&priv->recent_items, g_bookmark_file_free);
+
+      return;
+    }
+
+  if (priv->recent_items)
+    g_bookmark_file_free (priv->recent_items);
+
+  priv->recent_items = items;
+
+  size = g_bookmark_file_get_size (priv->recent_items);
+  if (priv->size != size)
+    {
+      priv->size = size;
+
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+}
+
 /* reads the recently used resources file and builds the items list.
  * we keep the items list inside the parser object, and build the
  * RecentInfo object only on user’s demand to avoid useless replication.
@@ -654,8 +751,6 @@ static void
 build_recent_items_list (GtkRecentManager *manager)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
-  GError *read_error;
-  int size;
 
   if (!priv->recent_items)
     {
@@ -665,50 +760,359 @@ build_recent_items_list (GtkRecentManager *manager)
 
   if (priv->filename != NULL)
     {
+      GBookmarkFile *items;
+      GError *read_error = NULL;
+
       /* the file exists, and it's valid (we hope); if not, destroy the container
        * object and hope for a better result when the next "changed" signal is
        * fired.
        */
-      read_error = NULL;
-      g_bookmark_file_load_from_file (priv->recent_items, priv->filename, &read_error);
-      if (read_error)
-        {
-          /* if the file does not exist we just wait for the first write
-           * operation on this recent manager instance, to avoid creating
-           * empty files and leading to spurious file system events (Sabayon
-           * will not be happy about those)
-           */
-          if (read_error->domain == G_FILE_ERROR &&
-              read_error->code != G_FILE_ERROR_NOENT)
-            {
-              char *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to read the recently used resources "
-                         "file at '%s', but the parser failed: %s.",
-                         utf8 ? utf8 : "(invalid filename)",
-                         read_error->message);
-              g_free (utf8);
-            }
+      items = g_bookmark_file_new ();
+      if (!g_bookmark_file_load_from_file (items, priv->filename, &read_error))
+        g_clear_pointer (&items, g_bookmark_file_free);
 
-          g_bookmark_file_free (priv->recent_items);
-          priv->recent_items = NULL;
+      set_recent_items (manager, items, read_error);
 
-          g_error_free (read_error);
-        }
-      else
+      g_clear_error (&read_error);
+    }
+
+  priv->is_dirty = FALSE;
+}
+
+typedef struct
+{
+  RecentStore *store;
+  char *filename;
+  GBytes *data;
+  guint64 serial;
+} SaveData;
+
+static void
+save_data_free (gpointer data)
+{
+  SaveData *save = data;
+
+  recent_store_unref (save->store);
+  g_free (save->filename);
+  g_bytes_unref (save->data);
+  g_slice_free (SaveData, save);
+}
+
+/* Writes a snapshot of the list, unless a newer one has already
+ * been written. The file is replaced atomically and only readable
+ * by the user, as it may contain private information.
+ */
+static gboolean
+recent_store_write (RecentStore  *store,
+                    const char   *filename,
+                    GBytes       *data,
+                    guint64       serial,
+                    GError      **error)
+{
+  gboolean retval = TRUE;
+
+  g_mutex_lock (&store->lock);
+
+  if (serial > store->written_serial)
+    {
+      retval = g_file_set_contents_full (filename,
+                                         g_bytes_get_data (data, NULL),
+                                         g_bytes_get_size (data),
+                                         G_FILE_SET_CONTENTS_CONSISTENT,
+                                         0600,
+                                         error);
+      if (retval)
         {
-          size = g_bookmark_file_get_size (priv->recent_items);
-          if (priv->size != size)
-            {
-              priv->size = size;
+          store->written_serial = serial;
+          g_clear_pointer (&store->written_data, g_bytes_unref);
+          store->written_data = g_bytes_ref (data);
+        }
+    }
 
-              g_object_notify (G_OBJECT (manager), "size");
-            }
+  g_mutex_unlock (&store->lock);
+
+  return retval;
+}
+
+static void
+save_thread (GTask        *task,
+             gpointer      source_object,
+             gpointer      task_data,
+             GCancellable *cancellable)
+{
+  SaveData *save = task_data;
+  GError *error = NULL;
+
+  if (recent_store_write (save->store, save->filename, save->data, save->serial, &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+warn_save_failed (const char   *filename,
+                  const GError *error)
+{
+  char *utf8 = g_filename_to_utf8 (filename, -1, NULL, NULL, NULL);
+
+  g_warning ("Attempting to store changes into '%s', but failed: %s",
+             utf8 ? utf8 : "(invalid filename)",
+             error->message);
+  g_free (utf8);
+}
+
+static void
+save_done (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  SaveData *save = g_task_get_task_data (G_TASK (result));
+  GtkRecentManager *manager = save->store->manager;
+  GError *error = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      warn_save_failed (save->filename, error);
+      g_error_free (error);
+    }
+
+  if (manager == NULL)
+    return;
+
+  manager->priv->is_saving = FALSE;
+
+  if (manager->priv->save_again)
+    {
+      manager->priv->save_again = FALSE;
+      save_recent_items (manager);
+    }
+}
+
+/* Stores the list in the recently used resources file.
+ *
+ * The list is serialized right away, and written out in a thread.
+ * Saves requested while a write is in flight are coalesced into a
+ * single one that runs when it is done.
+ */
+static void
+save_recent_items (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  SaveData *save;
+  GTask *task;
+  char *contents;
+  gsize length;
+  GError *error = NULL;
+
+  if (priv->filename == NULL)
+    return;
+
+  if (priv->is_saving && !priv->save_sync)
+    {
+      priv->save_again = TRUE;
+      return;
+    }
+
+  contents = g_bookmark_file_to_data (priv->recent_items, &length, &error);
+  if (contents == NULL)
+    {
+      warn_save_failed (priv->filename, error);
+      g_error_free (error);
+      return;
+    }
+
+  save = g_slice_new (SaveData);
+  save->store = recent_store_ref (priv->store);
+  save->filename = g_strdup (priv->filename);
+  save->data = g_bytes_new_take (contents, length);
+  save->serial = ++priv->save_serial;
+
+  if (priv->save_sync)
+    {
+      if (!recent_store_write (save->store, save->filename, save->data, save->serial, &error))
+        {
+          warn_save_failed (save->filename, error);
+          g_error_free (error);
         }
+
+      save_data_free (save);
+      return;
     }
 
-  priv->is_dirty = FALSE;
+  priv->is_saving = TRUE;
+
+  task = g_task_new (NULL, NULL, save_done, NULL);
+  g_task_set_source_tag (task, save_recent_items);
+  g_task_set_task_data (task, save, save_data_free);
+  g_task_run_in_thread (task, save_thread);
+  g_object_unref (task);
+}
+
+typedef struct
+{
+  RecentStore *store;
+  char *filename;
+} LoadData;
+
+static void
+load_data_free (gpointer data)
+{
+  LoadData *load = data;
+
+  recent_store_unref (load->store);
+  g_free (load->filename);
+  g_slice_free (LoadData, load);
+}
+
+static void
+load_thread (GTask        *task,
+             gpointer      source_object,
+             gpointer      task_data,
+             GCancellable *cancellable)
+{
+  LoadData *load = task_data;
+  GBookmarkFile *items;
+  GBytes *data;
+  char *contents;
+  gsize length;
+  gboolean unchanged;
+  GError *error = NULL;
+
+  if (!g_file_get_contents (load->filename, &contents, &length, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  data = g_bytes_new_take (contents, length);
+
+  /* most changes to the file are our own writes coming back to us,
+   * and there is no need to parse those again
+   */
+  g_mutex_lock (&load->store->lock);
+  unchanged = load->store->written_data != NULL &&
+              g_bytes_equal (data, load->store->written_data);
+  g_mutex_unlock (&load->store->lock);
+
+  if (unchanged)
+    {
+      g_bytes_unref (data);
+      g_task_return_pointer (task, NULL, NULL);
+      return;
+    }
+
+  items = g_bookmark_file_new ();
+  if (!g_bookmark_file_load_from_data (items,
+                                       g_bytes_get_data (data, NULL),
+                                       g_bytes_get_size (data),
+                                       &error))
+    {
+      g_bookmark_file_free (items);
+      g_bytes_unref (data);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_bytes_unref (data);
+  g_task_return_pointer (task, items, (GDestroyNotify) g_bookmark_file_free);
+}
+
+static void
+load_done (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  LoadData *load = g_task_get_task_data (G_TASK (result));
+  GtkRecentManager *manager = load->store->manager;
+  GtkRecentManagerPrivate *priv;
+  GBookmarkFile *items;
+  GError *error = NULL;
+
+  items = g_task_propagate_pointer (G_TASK (result), &error);
+
+  if (manager == NULL)
+    goto out;
+
+  priv = manager->priv;
+  priv->is_loading = FALSE;
+
+  /* the file changed again while we were reading it */
+  if (priv->load_again)
+    {
+      priv->load_again = FALSE;
+      reload_recent_items (manager);
+      goto out;
+    }
+
+  /* our own changes are going to overwrite the file anyway */
+  if (priv->is_dirty || priv->is_saving)
+    goto out;
+
+  /* we wrote this ourselves */
+  if (items == NULL && error == NULL)
+    goto out;
+
+  set_recent_items (manager, items, error);
+  items = NULL;
+
+  g_signal_emit (manager, signal_changed, 0);
+
+out:
+  if (items)
+    g_bookmark_file_free (items);
+  g_clear_error (&error);
+}
+
+static gboolean
+reload_recent_items_timeout (gpointer data)
+{
+  GtkRecentManager *manager = data;
+  GtkRecentManagerPrivate *priv = manager->priv;
+  LoadData *load;
+  GTask *task;
+
+  priv->reload_timeout = 0;
+
+  if (priv->filename == NULL)
+    return G_SOURCE_REMOVE;
+
+  if (priv->is_loading)
+    {
+      priv->load_again = TRUE;
+      return G_SOURCE_REMOVE;
+    }
+
+  priv->is_loading = TRUE;
+
+  load = g_slice_new (LoadData);
+  load->store = recent_store_ref (priv->store);
+  load->filename = g_strdup (priv->filename);
+
+  task = g_task_new (NULL, NULL, load_done, NULL);
+  g_task_set_source_tag (task, reload_recent_items);
+  g_task_set_task_data (task, load, load_data_free);
+  g_task_run_in_thread (task, load_thread);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
 }
 
+/* Reloads the list after the recently used resources file has been
+ * changed. Bursts of file monitor events are coalesced, and the file
+ * is read and parsed in a thread; the “changed” signal is emitted
+ * once the new list is in place.
+ */
+static void
+reload_recent_items (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+
+  if (priv->reload_timeout != 0)
+    return;
+
+  priv->reload_timeout = g_timeout_add (250, reload_recent_items_timeout, manager);
+  g_source_set_name_by_id (priv->reload_timeout, "[gtk] reload_recent_items");
+}
 
 /********************
  * GtkRecentManager *
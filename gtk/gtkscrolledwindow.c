@@ -3205,6 +3205,27 @@ _gtk_scrolled_window_set_adjustment_value (GtkScrolledWindow *scrolled_window,
   g_signal_emit (scrolled_window, signals[EDGE_OVERSHOT], 0, edge_pos);
 }
 
+/* Kinetic scrolling positions are computed for the time the frame is
+ * predicted to be presented, not for the time the frame is started, so
+ * that the content is where it should be when it reaches the screen.
+ */
+static gint64
+gtk_scrolled_window_get_deceleration_time (GtkScrolledWindow *scrolled_window,
+                                           GdkFrameClock     *frame_clock)
+{
+  GtkScrolledWindowPrivate *priv = gtk_scrolled_window_get_instance_private (scrolled_window);
+  gint64 frame_time, presentation_time;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time, NULL, &presentation_time);
+
+  if (presentation_time < frame_time)
+    presentation_time = frame_time;
+
+  /* Predictions can be off, but time must never go backwards */
+  return MAX (presentation_time, priv->last_deceleration_time);
+}
+
 static gboolean
 scrolled_window_deceleration_cb (GtkWidget         *widget,
                                  GdkFrameClock     *frame_clock,
@@ -3216,7 +3237,7 @@ scrolled_window_deceleration_cb (GtkWidget         *widget,
   gint64 current_time;
   double position, elapsed;
 
-  current_time = gdk_frame_clock_get_frame_time (frame_clock);
+  current_time = gtk_scrolled_window_get_deceleration_time (scrolled_window, frame_clock);
   elapsed = (current_time - priv->last_deceleration_time) / (double)G_TIME_SPAN_SECOND;
   priv->last_deceleration_time = current_time;
 
@@ -3305,7 +3326,7 @@ gtk_scrolled_window_start_deceleration (GtkScrolledWindow *scrolled_window)
 
   frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (scrolled_window));
 
-  current_time = gdk_frame_clock_get_frame_time (frame_clock);
+  current_time = gtk_scrolled_window_get_deceleration_time (scrolled_window, frame_clock);
   elapsed = (current_time - priv->last_deceleration_time) / (double)G_TIME_SPAN_SECOND;
   priv->last_deceleration_time = current_time;
 
@@ -0,0 +1,479 @@
+/* gtksearchenginesimple.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "gtksearchenginesimple.h"
+#include "gtkprivate.h"
+
+#include <string.h>
+
+/* A search engine that walks the file system itself, for when no
+ * indexer is available.
+ *
+ * Directories are put on a shared queue and picked up by a few
+ * worker threads. Each worker enumerates its directory, matches the
+ * names against the query and sends the hits to the main thread in
+ * batches. When the queue is full, workers descend into directories
+ * themselves instead of queueing them, so the queue stays small no
+ * matter how wide the tree is.
+ */
+
+#define MAX_WORKERS 4
+#define MAX_QUEUED_DIRECTORIES 256
+#define HITS_PER_BATCH 100
+
+/* What we need to walk the tree and match names */
+#define ENUMERATE_ATTRIBUTES "standard::name,standard::display-name,standard::type," \
+                             "standard::is-hidden,standard::is-backup"
+
+/* What the file chooser shows for a hit */
+#define HIT_ATTRIBUTES "standard::name,standard::type,standard::display-name," \
+                       "standard::is-hidden,standard::is-backup,standard::size," \
+                       "standard::content-type,standard::fast-content-type,time::modified,time::access," \
+                       "access::can-rename,access::can-delete,access::can-trash," \
+                       "standard::target-uri"
+
+typedef struct _SearchJob SearchJob;
+
+struct _GtkSearchEngineSimple
+{
+  GtkSearchEngine parent;
+
+  GtkQuery *query;
+
+  SearchJob *job;
+};
+
+struct _GtkSearchEngineSimpleClass
+{
+  GtkSearchEngineClass parent_class;
+};
+
+G_DEFINE_TYPE (GtkSearchEngineSimple, _gtk_search_engine_simple, GTK_TYPE_SEARCH_ENGINE)
+
+struct _SearchJob
+{
+  gint ref_count;
+
+  /* Only accessed from the main thread; cleared when
+   * the job is stopped
+   */
+  GtkSearchEngineSimple *engine;
+
+  GCancellable *cancellable;
+
+  /* Prepared like gtk_query_matches_string() does,
+   * read-only once the workers are running
+   */
+  char **words;
+
+  GMutex lock;
+  GCond cond;
+  GQueue directories;
+  guint n_busy;
+  guint n_workers;
+
+  gint got_results;
+};
+
+typedef struct
+{
+  SearchJob *job;
+  GList *hits;
+} HitsBatch;
+
+static SearchJob *
+search_job_ref (SearchJob *job)
+{
+  g_atomic_int_inc (&job->ref_count);
+
+  return job;
+}
+
+static void
+search_job_unref (SearchJob *job)
+{
+  if (!g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+
+  g_queue_clear_full (&job->directories, g_object_unref);
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->cond);
+  g_object_unref (job->cancellable);
+  g_strfreev (job->words);
+
+  g_slice_free (SearchJob, job);
+}
+
+static char *
+prepare_string_for_compare (const char *string)
+{
+  char *normalized, *res;
+
+  normalized = g_utf8_normalize (string, -1, G_NORMALIZE_NFD);
+  res = g_utf8_strdown (normalized, -1);
+  g_free (normalized);
+
+  return res;
+}
+
+static gboolean
+search_job_matches (SearchJob  *job,
+                    const char *name)
+{
+  char buf[256];
+  char *prepared;
+  gboolean found;
+  gsize i;
+  int w;
+
+  /* Most names are short and ASCII, and lowercasing those gives
+   * the same result as normalizing and casefolding. Doing it on
+   * the stack leaves the scanning to strstr(), which the C library
+   * vectorizes.
+   */
+  for (i = 0; name[i] != '\0' && i < sizeof (buf) - 1; i++)
+    {
+      if (name[i] & 0x80)
+        break;
+      buf[i] = g_ascii_tolower (name[i]);
+    }
+
+  if (name[i] == '\0')
+    {
+      buf[i] = '\0';
+      prepared = buf;
+    }
+  else
+    prepared = prepare_string_for_compare (name);
+
+  found = TRUE;
+  for (w = 0; job->words[w]; w++)
+    {
+      if (strstr (prepared, job->words[w]) == NULL)
+        {
+          found = FALSE;
+          break;
+        }
+    }
+
+  if (prepared != buf)
+    g_free (prepared);
+
+  return found;
+}
+
+static gboolean
+emit_hits (gpointer data)
+{
+  HitsBatch *batch = data;
+  SearchJob *job = batch->job;
+
+  if (job->engine != NULL && !g_cancellable_is_cancelled (job->cancellable))
+    _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (job->engine), batch->hits);
+
+  g_list_free_full (batch->hits, (GDestroyNotify) _gtk_search_hit_free);
+  search_job_unref (job);
+  g_slice_free (HitsBatch, batch);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+send_hits (SearchJob  *job,
+           GList     **hits)
+{
+  HitsBatch *batch;
+
+  if (*hits == NULL)
+    return;
+
+  batch = g_slice_new (HitsBatch);
+  batch->job = search_job_ref (job);
+  batch->hits = *hits;
+  *hits = NULL;
+
+  g_idle_add_full (G_PRIORITY_DEFAULT, emit_hits, batch, NULL);
+}
+
+static gboolean
+emit_finished (gpointer data)
+{
+  SearchJob *job = data;
+  GtkSearchEngineSimple *engine = job->engine;
+
+  if (engine != NULL && engine->job == job)
+    {
+      job->engine = NULL;
+      engine->job = NULL;
+      _gtk_search_engine_finished (GTK_SEARCH_ENGINE (engine),
+                                   g_atomic_int_get (&job->got_results));
+      search_job_unref (job);
+    }
+
+  search_job_unref (job);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+search_directory (SearchJob  *job,
+                  GFile      *dir,
+                  GList     **hits,
+                  guint      *n_hits)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+
+  enumerator = g_file_enumerate_children (dir,
+                                          ENUMERATE_ATTRIBUTES,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          job->cancellable,
+                                          NULL);
+  if (enumerator == NULL)
+    return;
+
+  while ((info = g_file_enumerator_next_file (enumerator, job->cancellable, NULL)) != NULL)
+    {
+      const char *display_name;
+      GFile *child;
+
+      if (g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info))
+        {
+          g_object_unref (info);
+          continue;
+        }
+
+      child = g_file_get_child (dir, g_file_info_get_name (info));
+      display_name = g_file_info_get_display_name (info);
+
+      if (display_name != NULL && search_job_matches (job, display_name))
+        {
+          GtkSearchHit *hit;
+
+          hit = g_new (GtkSearchHit, 1);
+          hit->file = g_object_ref (child);
+          hit->info = g_file_query_info (child, HIT_ATTRIBUTES, 0, job->cancellable, NULL);
+
+          *hits = g_list_prepend (*hits, hit);
+          if (++(*n_hits) >= HITS_PER_BATCH)
+            {
+              send_hits (job, hits);
+              *n_hits = 0;
+            }
+
+          g_atomic_int_set (&job->got_results, TRUE);
+        }
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        {
+          gboolean queued = FALSE;
+
+          g_mutex_lock (&job->lock);
+          if (job->directories.length < MAX_QUEUED_DIRECTORIES)
+            {
+              g_queue_push_tail (&job->directories, g_object_ref (child));
+              g_cond_signal (&job->cond);
+              queued = TRUE;
+            }
+          g_mutex_unlock (&job->lock);
+
+          if (!queued)
+            search_directory (job, child, hits, n_hits);
+        }
+
+      g_object_unref (child);
+      g_object_unref (info);
+
+      if (g_cancellable_is_cancelled (job->cancellable))
+        break;
+    }
+
+  g_object_unref (enumerator);
+}
+
+static gpointer
+search_worker (gpointer data)
+{
+  SearchJob *job = data;
+  GList *hits = NULL;
+  guint n_hits = 0;
+  gboolean last;
+
+  g_mutex_lock (&job->lock);
+
+  while (!g_cancellable_is_cancelled (job->cancellable))
+    {
+      GFile *dir;
+
+      dir = g_queue_pop_head (&job->directories);
+      if (dir != NULL)
+        {
+          job->n_busy++;
+          g_mutex_unlock (&job->lock);
+
+          search_directory (job, dir, &hits, &n_hits);
+          g_object_unref (dir);
+
+          /* Don't sit on hits while other workers are still busy */
+          send_hits (job, &hits);
+          n_hits = 0;
+
+          g_mutex_lock (&job->lock);
+          job->n_busy--;
+          continue;
+        }
+
+      /* Nothing queued and nobody left who could queue more */
+      if (job->n_busy == 0)
+        break;
+
+      g_cond_wait (&job->cond, &job->lock);
+    }
+
+  job->n_workers--;
+  last = job->n_workers == 0;
+  g_cond_broadcast (&job->cond);
+  g_mutex_unlock (&job->lock);
+
+  send_hits (job, &hits);
+
+  if (last)
+    g_idle_add_full (G_PRIORITY_DEFAULT, emit_finished, search_job_ref (job), NULL);
+
+  search_job_unref (job);
+
+  return NULL;
+}
+
+static void
+gtk_search_engine_simple_stop (GtkSearchEngine *engine)
+{
+  GtkSearchEngineSimple *simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
+  SearchJob *job = simple->job;
+
+  if (job == NULL)
+    return;
+
+  simple->job = NULL;
+  job->engine = NULL;
+
+  g_cancellable_cancel (job->cancellable);
+
+  /* Wake up idle workers so they notice */
+  g_mutex_lock (&job->lock);
+  g_cond_broadcast (&job->cond);
+  g_mutex_unlock (&job->lock);
+
+  search_job_unref (job);
+}
+
+static void
+gtk_search_engine_simple_start (GtkSearchEngine *engine)
+{
+  GtkSearchEngineSimple *simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
+  SearchJob *job;
+  const char *text;
+  char *prepared;
+  GFile *location;
+  guint i;
+
+  gtk_search_engine_simple_stop (engine);
+
+  if (simple->query == NULL)
+    return;
+
+  job = g_slice_new0 (SearchJob);
+  job->ref_count = 1;
+  job->engine = simple;
+  job->cancellable = g_cancellable_new ();
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+  g_queue_init (&job->directories);
+
+  simple->job = job;
+
+  text = gtk_query_get_text (simple->query);
+  if (text == NULL || text[0] == '\0')
+    {
+      /* Nothing can match; still report that we're done */
+      g_idle_add_full (G_PRIORITY_DEFAULT, emit_finished, search_job_ref (job), NULL);
+      return;
+    }
+
+  prepared = prepare_string_for_compare (text);
+  job->words = g_strsplit (prepared, " ", -1);
+  g_free (prepared);
+
+  location = gtk_query_get_location (simple->query);
+  if (location)
+    g_queue_push_tail (&job->directories, g_object_ref (location));
+  else
+    g_queue_push_tail (&job->directories, g_file_new_for_path (g_get_home_dir ()));
+
+  job->n_workers = CLAMP (g_get_num_processors (), 1, MAX_WORKERS);
+  for (i = 0; i < job->n_workers; i++)
+    g_thread_unref (g_thread_new ("[gtk] file search", search_worker, search_job_ref (job)));
+}
+
+static void
+gtk_search_engine_simple_set_query (GtkSearchEngine *engine,
+                                    GtkQuery        *query)
+{
+  GtkSearchEngineSimple *simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
+
+  g_set_object (&simple->query, query);
+}
+
+static void
+gtk_search_engine_simple_dispose (GObject *object)
+{
+  GtkSearchEngineSimple *simple = GTK_SEARCH_ENGINE_SIMPLE (object);
+
+  gtk_search_engine_simple_stop (GTK_SEARCH_ENGINE (simple));
+  g_clear_object (&simple->query);
+
+  G_OBJECT_CLASS (_gtk_search_engine_simple_parent_class)->dispose (object);
+}
+
+static void
+_gtk_search_engine_simple_class_init (GtkSearchEngineSimpleClass *class)
+{
+  GObjectClass *gobject_class;
+  GtkSearchEngineClass *engine_class;
+
+  gobject_class = G_OBJECT_CLASS (class);
+  gobject_class->dispose = gtk_search_engine_simple_dispose;
+
+  engine_class = GTK_SEARCH_ENGINE_CLASS (class);
+  engine_class->set_query = gtk_search_engine_simple_set_query;
+  engine_class->start = gtk_search_engine_simple_start;
+  engine_class->stop = gtk_search_engine_simple_stop;
+}
+
+static void
+_gtk_search_engine_simple_init (GtkSearchEngineSimple *engine)
+{
+}
+
+GtkSearchEngine *
+_gtk_search_engine_simple_new (void)
+{
+  return GTK_SEARCH_ENGINE (g_object_new (GTK_TYPE_SEARCH_ENGINE_SIMPLE, NULL));
+}
@@ -142,7 +142,52 @@ gtk_selection_filter_model_selection_changed_cb (GListModel              *model,
                                                  guint                    n_items,
                                                  GtkSelectionFilterModel *self)
 {
-  selection_filter_model_items_changed (self, position, n_items, n_items);
+  GtkBitset *selection, *changes, *range;
+  guint first, last;
+  guint sel_position, sel_removed, sel_added;
+
+  if (n_items == 0)
+    return;
+
+  /* Only the selection inside the range changed, so don't
+   * query the whole model.
+   */
+  range = gtk_bitset_new_range (position, n_items);
+  selection = gtk_selection_model_get_selection_in_range (self->model, position, n_items);
+  gtk_bitset_intersect (selection, range);
+
+  changes = gtk_bitset_copy (self->selection);
+  gtk_bitset_intersect (changes, range);
+  gtk_bitset_difference (changes, selection);
+  gtk_bitset_unref (range);
+
+  if (gtk_bitset_is_empty (changes))
+    {
+      gtk_bitset_unref (changes);
+      gtk_bitset_unref (selection);
+      return;
+    }
+
+  /* Models are free to report larger ranges than what actually
+   * changed, only announce the items between the first and last
+   * actual change.
+   */
+  first = gtk_bitset_get_minimum (changes);
+  last = gtk_bitset_get_maximum (changes);
+  gtk_bitset_unref (changes);
+
+  if (first > 0)
+    sel_position = gtk_bitset_get_size_in_range (self->selection, 0, first - 1);
+  else
+    sel_position = 0;
+  sel_removed = gtk_bitset_get_size_in_range (self->selection, first, last);
+  sel_added = gtk_bitset_get_size_in_range (selection, first, last);
+
+  gtk_bitset_remove_range (self->selection, position, n_items);
+  gtk_bitset_union (self->selection, selection);
+  gtk_bitset_unref (selection);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), sel_position, sel_removed, sel_added);
 }
 
 static void
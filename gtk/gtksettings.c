@@ -112,6 +112,8 @@ struct _GtkSettings
   gboolean font_size_absolute;
   char *font_family;
   cairo_font_options_t *font_options;
+  gboolean initializing;
+  gboolean theme_needs_update;
 };
 
 struct _GtkSettingsClass
@@ -129,6 +131,8 @@ struct _GtkSettingsPropertyValue
 {
   GValue value;
   GtkSettingsSource source;
+  /* the display did not provide a value the last time we asked */
+  guint display_checked : 1;
 };
 
 enum {
@@ -1099,13 +1103,28 @@ gtk_settings_create_for_display (GdkDisplay *display)
 
   g_ptr_array_add (display_settings, settings);
 
-  settings_init_style (settings);
+  /* Take all the values the display provides in one go before
+   * anything looks at them, so that the theme is loaded once and
+   * the derived state is computed from the final values, instead
+   * of reacting to every setting that changes on the way.
+   */
+  settings->initializing = TRUE;
+
   settings_update_xsettings (settings);
+  settings_init_style (settings);
+
+  /* the theme's settings.ini asked for another theme */
+  if (settings->theme_needs_update)
+    settings_update_theme (settings);
+
   settings_update_double_click (settings);
   settings_update_cursor_theme (settings);
   settings_update_font_options (settings);
   settings_update_font_values (settings);
 
+  settings->initializing = FALSE;
+  settings->theme_needs_update = FALSE;
+
   return settings;
 }
 
@@ -1224,6 +1243,15 @@ gtk_settings_notify (GObject    *object,
   if (settings->display == NULL) /* initialization */
     return;
 
+  /* everything is brought up to date at the end */
+  if (settings->initializing)
+    {
+      if (property_id == PROP_THEME_NAME ||
+          property_id == PROP_APPLICATION_PREFER_DARK_THEME)
+        settings->theme_needs_update = TRUE;
+      return;
+    }
+
   switch (property_id)
     {
     case PROP_DOUBLE_CLICK_TIME:
@@ -1372,6 +1400,7 @@ settings_install_property_parser (GtkSettingsClass   *class,
       g_value_init (&settings->property_values[class_n_properties - 1].value, G_PARAM_SPEC_VALUE_TYPE (pspec));
       g_param_value_set_default (pspec, &settings->property_values[class_n_properties - 1].value);
       settings->property_values[class_n_properties - 1].source = GTK_SETTINGS_SOURCE_DEFAULT;
+      settings->property_values[class_n_properties - 1].display_checked = FALSE;
       g_object_notify_by_pspec (G_OBJECT (settings), pspec);
 
       qvalue = g_datalist_id_dup_data (&settings->queued_settings, g_param_spec_get_name_quark (pspec), NULL, NULL);
@@ -1863,6 +1892,10 @@ settings_update_xsetting (GtkSettings *settings,
   if (settings->property_values[pspec->param_id - 1].source == GTK_SETTINGS_SOURCE_XSETTING && !force)
     return FALSE;
 
+  /* the display emits ::setting-changed when it gets a value */
+  if (settings->property_values[pspec->param_id - 1].display_checked && !force)
+    return FALSE;
+
   value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
   fundamental_type = G_TYPE_FUNDAMENTAL (value_type);
 
@@ -1876,11 +1909,15 @@ settings_update_xsetting (GtkSettings *settings,
       g_value_init (&val, value_type);
 
       if (!gdk_display_get_setting (settings->display, pspec->name, &val))
-        return FALSE;
+        {
+          settings->property_values[pspec->param_id - 1].display_checked = TRUE;
+          return FALSE;
+        }
 
       g_param_value_validate (pspec, &val);
       g_value_copy (&val, &settings->property_values[pspec->param_id - 1].value);
       settings->property_values[pspec->param_id - 1].source = GTK_SETTINGS_SOURCE_XSETTING;
+      settings->property_values[pspec->param_id - 1].display_checked = FALSE;
 
       g_value_unset (&val);
 
@@ -1963,6 +2000,7 @@ gtk_settings_reset_property (GtkSettings *settings,
     g_param_value_set_default (pspec, &settings->property_values[pspec->param_id - 1].value);
 
   settings->property_values[pspec->param_id - 1].source = GTK_SETTINGS_SOURCE_DEFAULT;
+  settings->property_values[pspec->param_id - 1].display_checked = FALSE;
   g_object_notify_by_pspec (G_OBJECT (settings), pspec);
 }
 
@@ -0,0 +1,326 @@
+/* gtkshapingcache.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkshapingcacheprivate.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+/* The shaping cache remembers the extents and baseline of layouts,
+ * so that measuring a label whose text was measured before with the
+ * same fonts, attributes and constraints doesn't shape the text again.
+ * Lists and column views show the same strings in many rows, and
+ * measure them again every time a row is rebound.
+ *
+ * The cache is shared by the whole process and must only be used in
+ * the main thread. Entries are evicted in least recently used order
+ * once the cache grows over MAX_CACHE_BYTES.
+ */
+
+#define MAX_CACHE_BYTES (512 * 1024)
+
+/* Everything about a layout and its context except for the text,
+ * attributes and fonts, which get compared separately */
+typedef struct {
+  PangoFontMap *font_map;
+  guint font_map_serial;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  PangoGravity base_gravity;
+  PangoGravityHint gravity_hint;
+  PangoMatrix matrix;
+  double resolution;
+  gboolean round_glyph_positions;
+
+  int width;
+  int height;
+  int indent;
+  int spacing;
+  float line_spacing;
+  PangoWrapMode wrap;
+  PangoEllipsizeMode ellipsize;
+  PangoAlignment alignment;
+  gboolean justify;
+  gboolean auto_dir;
+  gboolean single_paragraph;
+} ShapingParams;
+
+typedef struct {
+  guint hash;
+  const char *text;
+  PangoAttrList *attrs;
+  const PangoFontDescription *context_font;
+  const PangoFontDescription *layout_font;
+  const cairo_font_options_t *font_options;
+  ShapingParams params;
+} ShapingKey;
+
+typedef struct {
+  ShapingKey key;
+  GList link;
+  gsize size;
+
+  PangoRectangle logical_rect;
+  int baseline;
+} ShapingEntry;
+
+static GHashTable *entries; /* ShapingKey => ShapingEntry */
+static GQueue lru = G_QUEUE_INIT; /* most recently used first */
+static gsize cache_bytes;
+static guint64 n_hits;
+static guint64 n_misses;
+
+static guint
+shaping_key_hash (gconstpointer data)
+{
+  const ShapingKey *key = data;
+
+  return key->hash;
+}
+
+static gboolean
+font_description_equal (const PangoFontDescription *a,
+                        const PangoFontDescription *b)
+{
+  if (a == NULL || b == NULL)
+    return a == b;
+
+  return pango_font_description_equal (a, b);
+}
+
+static gboolean
+shaping_key_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const ShapingKey *ka = a;
+  const ShapingKey *kb = b;
+
+  if (ka->hash != kb->hash ||
+      memcmp (&ka->params, &kb->params, sizeof (ShapingParams)) != 0 ||
+      strcmp (ka->text, kb->text) != 0 ||
+      !font_description_equal (ka->context_font, kb->context_font) ||
+      !font_description_equal (ka->layout_font, kb->layout_font))
+    return FALSE;
+
+  if (ka->font_options == NULL || kb->font_options == NULL)
+    {
+      if (ka->font_options != kb->font_options)
+        return FALSE;
+    }
+  else if (!cairo_font_options_equal (ka->font_options, kb->font_options))
+    return FALSE;
+
+  if (ka->attrs == NULL || kb->attrs == NULL)
+    return ka->attrs == kb->attrs;
+
+  return pango_attr_list_equal (ka->attrs, kb->attrs);
+}
+
+static void
+shaping_entry_free (gpointer data)
+{
+  ShapingEntry *entry = data;
+
+  g_free ((char *) entry->key.text);
+  g_clear_pointer (&entry->key.attrs, pango_attr_list_unref);
+  if (entry->key.context_font)
+    pango_font_description_free ((PangoFontDescription *) entry->key.context_font);
+  if (entry->key.layout_font)
+    pango_font_description_free ((PangoFontDescription *) entry->key.layout_font);
+  if (entry->key.font_options)
+    cairo_font_options_destroy ((cairo_font_options_t *) entry->key.font_options);
+  g_object_unref (entry->key.params.font_map);
+
+  g_slice_free (ShapingEntry, entry);
+}
+
+/* Returns FALSE if the layout can't be cached */
+static gboolean
+shaping_key_init (ShapingKey  *key,
+                  PangoLayout *layout)
+{
+  PangoContext *context = pango_layout_get_context (layout);
+  ShapingParams *params = &key->params;
+  const PangoMatrix *matrix;
+  PangoTabArray *tabs;
+
+  tabs = pango_layout_get_tabs (layout);
+  if (tabs)
+    {
+      pango_tab_array_free (tabs);
+      return FALSE;
+    }
+
+  /* Zero the padding too, params are compared with memcmp() */
+  memset (params, 0, sizeof (ShapingParams));
+
+  params->font_map = pango_context_get_font_map (context);
+  if (params->font_map == NULL)
+    return FALSE;
+
+  params->font_map_serial = pango_font_map_get_serial (params->font_map);
+  params->language = pango_context_get_language (context);
+  params->base_dir = pango_context_get_base_dir (context);
+  params->base_gravity = pango_context_get_base_gravity (context);
+  params->gravity_hint = pango_context_get_gravity_hint (context);
+  matrix = pango_context_get_matrix (context);
+  params->matrix = matrix ? *matrix : (PangoMatrix) PANGO_MATRIX_INIT;
+  params->resolution = pango_cairo_context_get_resolution (context);
+  params->round_glyph_positions = pango_context_get_round_glyph_positions (context);
+
+  params->width = pango_layout_get_width (layout);
+  params->height = pango_layout_get_height (layout);
+  params->indent = pango_layout_get_indent (layout);
+  params->spacing = pango_layout_get_spacing (layout);
+  params->line_spacing = pango_layout_get_line_spacing (layout);
+  params->wrap = pango_layout_get_wrap (layout);
+  params->ellipsize = pango_layout_get_ellipsize (layout);
+  params->alignment = pango_layout_get_alignment (layout);
+  params->justify = pango_layout_get_justify (layout);
+  params->auto_dir = pango_layout_get_auto_dir (layout);
+  params->single_paragraph = pango_layout_get_single_paragraph_mode (layout);
+
+  key->text = pango_layout_get_text (layout);
+  key->attrs = pango_layout_get_attributes (layout);
+  key->context_font = pango_context_get_font_description (context);
+  key->layout_font = pango_layout_get_font_description (layout);
+  key->font_options = pango_cairo_context_get_font_options (context);
+
+  key->hash = g_str_hash (key->text);
+  if (key->context_font)
+    key->hash ^= pango_font_description_hash (key->context_font) << 1;
+  if (key->layout_font)
+    key->hash ^= pango_font_description_hash (key->layout_font) << 2;
+  key->hash ^= (guint) params->width * 31;
+  key->hash ^= params->wrap << 3 | params->ellipsize << 5 | params->alignment << 8;
+
+  return TRUE;
+}
+
+static ShapingEntry *
+shaping_entry_new (const ShapingKey *key)
+{
+  ShapingEntry *entry;
+  PangoAttrIterator *iter;
+  gsize n_ranges = 0;
+
+  entry = g_slice_new0 (ShapingEntry);
+  entry->key = *key;
+  entry->key.text = g_strdup (key->text);
+  entry->key.attrs = key->attrs ? pango_attr_list_copy (key->attrs) : NULL;
+  entry->key.context_font = key->context_font ? pango_font_description_copy (key->context_font) : NULL;
+  entry->key.layout_font = key->layout_font ? pango_font_description_copy (key->layout_font) : NULL;
+  entry->key.font_options = key->font_options ? cairo_font_options_copy (key->font_options) : NULL;
+  g_object_ref (entry->key.params.font_map);
+  entry->link.data = entry;
+
+  if (entry->key.attrs)
+    {
+      iter = pango_attr_list_get_iterator (entry->key.attrs);
+      do
+        n_ranges++;
+      while (pango_attr_iterator_next (iter));
+      pango_attr_iterator_destroy (iter);
+    }
+
+  /* A rough estimate is good enough for the budget */
+  entry->size = sizeof (ShapingEntry) + strlen (entry->key.text) + 1 + n_ranges * 48 + 128;
+
+  return entry;
+}
+
+static void
+shaping_cache_trim (void)
+{
+  while (cache_bytes > MAX_CACHE_BYTES && lru.tail)
+    {
+      ShapingEntry *entry = lru.tail->data;
+
+      g_queue_unlink (&lru, &entry->link);
+      cache_bytes -= entry->size;
+      g_hash_table_remove (entries, &entry->key);
+    }
+}
+
+/*< private >
+ * gtk_shaping_cache_get_extents:
+ * @layout: a #PangoLayout
+ * @logical_rect: (out): return location for the logical extents
+ * @baseline: (out) (optional): return location for the baseline
+ *
+ * Gets the same values as pango_layout_get_extents() and
+ * pango_layout_get_baseline(), but avoids laying out @layout
+ * if a layout with equal contents was measured before.
+ *
+ * On a cache hit, @layout is not laid out, so the first draw
+ * of it still does the shaping.
+ */
+void
+gtk_shaping_cache_get_extents (PangoLayout    *layout,
+                               PangoRectangle *logical_rect,
+                               int            *baseline)
+{
+  ShapingKey key;
+  ShapingEntry *entry;
+
+  if (!shaping_key_init (&key, layout))
+    {
+      pango_layout_get_extents (layout, NULL, logical_rect);
+      if (baseline)
+        *baseline = pango_layout_get_baseline (layout);
+      return;
+    }
+
+  if (entries == NULL)
+    entries = g_hash_table_new_full (shaping_key_hash, shaping_key_equal, NULL, shaping_entry_free);
+
+  entry = g_hash_table_lookup (entries, &key);
+  if (entry)
+    {
+      n_hits++;
+      g_queue_unlink (&lru, &entry->link);
+      g_queue_push_head_link (&lru, &entry->link);
+    }
+  else
+    {
+      n_misses++;
+      entry = shaping_entry_new (&key);
+      pango_layout_get_extents (layout, NULL, &entry->logical_rect);
+      entry->baseline = pango_layout_get_baseline (layout);
+
+      g_hash_table_insert (entries, &entry->key, entry);
+      g_queue_push_head_link (&lru, &entry->link);
+      cache_bytes += entry->size;
+    }
+
+  *logical_rect = entry->logical_rect;
+  if (baseline)
+    *baseline = entry->baseline;
+
+  shaping_cache_trim ();
+}
+
+void
+gtk_shaping_cache_get_stats (guint64 *hits,
+                             guint64 *misses,
+                             gsize   *bytes)
+{
+  *hits = n_hits;
+  *misses = n_misses;
+  *bytes = cache_bytes;
+}
@@ -0,0 +1,34 @@
+/* gtkshapingcacheprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_SHAPING_CACHE_PRIVATE_H__
+#define __GTK_SHAPING_CACHE_PRIVATE_H__
+
+#include <pango/pango.h>
+
+G_BEGIN_DECLS
+
+void            gtk_shaping_cache_get_extents   (PangoLayout    *layout,
+                                                 PangoRectangle *logical_rect,
+                                                 int            *baseline);
+
+void            gtk_shaping_cache_get_stats     (guint64        *hits,
+                                                 guint64        *misses,
+                                                 gsize          *bytes);
+
+G_END_DECLS
+
+#endif /* __GTK_SHAPING_CACHE_PRIVATE_H__ */
@@ -95,6 +95,16 @@ struct _GtkShortcutController
   guint custom_shortcuts : 1;
 
   guint last_activated;
+
+  /* The items of the model, kept in sync on items-changed, with
+   * NULL for items that aren't shortcuts */
+  GPtrArray *items;
+
+  /* Positions of the shortcuts by the keyvals of their triggers,
+   * rebuilt from items when NULL. Shortcuts with triggers that
+   * can't be indexed are in unindexed. */
+  GHashTable *keyval_index;
+  GArray *unindexed;
 };
 
 struct _GtkShortcutControllerClass
@@ -176,6 +186,245 @@ G_DEFINE_TYPE_WITH_CODE (GtkShortcutController, gtk_shortcut_controller,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_shortcut_controller_list_model_init)
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE, gtk_shortcut_controller_buildable_init))
 
+static void
+gtk_shortcut_controller_invalidate_index (GtkShortcutController *self)
+{
+  g_clear_pointer (&self->keyval_index, g_hash_table_unref);
+  g_clear_pointer (&self->unindexed, g_array_unref);
+}
+
+static void
+shortcut_trigger_changed (GtkShortcut           *shortcut,
+                          GParamSpec            *pspec,
+                          GtkShortcutController *self)
+{
+  gtk_shortcut_controller_invalidate_index (self);
+}
+
+static void
+gtk_shortcut_controller_unref_item (gpointer data,
+                                    gpointer user_data)
+{
+  GtkShortcut *shortcut = data;
+
+  if (shortcut == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (shortcut, shortcut_trigger_changed, user_data);
+  g_object_unref (shortcut);
+}
+
+static void
+gtk_shortcut_controller_items_changed (GtkShortcutController *self,
+                                       guint                  position,
+                                       guint                  removed,
+                                       guint                  added,
+                                       GListModel            *model)
+{
+  guint i;
+
+  for (i = 0; i < removed; i++)
+    gtk_shortcut_controller_unref_item (g_ptr_array_index (self->items, position + i), self);
+  g_ptr_array_remove_range (self->items, position, removed);
+
+  for (i = 0; i < added; i++)
+    {
+      gpointer item = g_list_model_get_item (model, position + i);
+
+      if (GTK_IS_SHORTCUT (item))
+        {
+          g_signal_connect (item, "notify::trigger",
+                            G_CALLBACK (shortcut_trigger_changed), self);
+        }
+      else
+        {
+          g_clear_object (&item);
+        }
+
+      g_ptr_array_insert (self->items, position + i, item);
+    }
+
+  gtk_shortcut_controller_invalidate_index (self);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+static guint
+normalize_keyval (guint keyval)
+{
+  /* gdk_key_event_matches() applies Shift to the trigger keyval */
+  if (keyval == GDK_KEY_ISO_Left_Tab)
+    return GDK_KEY_Tab;
+
+  return gdk_keyval_to_lower (keyval);
+}
+
+static gboolean
+collect_trigger_keyvals (GtkShortcutTrigger *trigger,
+                         GArray             *keyvals)
+{
+  guint keyval;
+
+  if (GTK_IS_KEYVAL_TRIGGER (trigger))
+    {
+      keyval = normalize_keyval (gtk_keyval_trigger_get_keyval (GTK_KEYVAL_TRIGGER (trigger)));
+      g_array_append_val (keyvals, keyval);
+      return TRUE;
+    }
+  else if (GTK_IS_NEVER_TRIGGER (trigger))
+    {
+      return TRUE;
+    }
+  else if (GTK_IS_ALTERNATIVE_TRIGGER (trigger))
+    {
+      GtkAlternativeTrigger *alternative = GTK_ALTERNATIVE_TRIGGER (trigger);
+
+      return collect_trigger_keyvals (gtk_alternative_trigger_get_first (alternative), keyvals) &&
+             collect_trigger_keyvals (gtk_alternative_trigger_get_second (alternative), keyvals);
+    }
+
+  /* Mnemonics depend on the mnemonic modifiers, and other triggers
+   * may match anything, so they are always checked. */
+  return FALSE;
+}
+
+static void
+gtk_shortcut_controller_ensure_index (GtkShortcutController *self)
+{
+  GArray *keyvals;
+  guint i, j;
+
+  if (self->keyval_index)
+    return;
+
+  self->keyval_index = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+  self->unindexed = g_array_new (FALSE, FALSE, sizeof (guint));
+  keyvals = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < self->items->len; i++)
+    {
+      GtkShortcut *shortcut = g_ptr_array_index (self->items, i);
+
+      if (shortcut == NULL)
+        continue;
+
+      g_array_set_size (keyvals, 0);
+      if (!collect_trigger_keyvals (gtk_shortcut_get_trigger (shortcut), keyvals))
+        {
+          g_array_append_val (self->unindexed, i);
+          continue;
+        }
+
+      for (j = 0; j < keyvals->len; j++)
+        {
+          gpointer key = GUINT_TO_POINTER (g_array_index (keyvals, guint, j));
+          GArray *positions = g_hash_table_lookup (self->keyval_index, key);
+
+          if (positions == NULL)
+            {
+              positions = g_array_new (FALSE, FALSE, sizeof (guint));
+              g_hash_table_insert (self->keyval_index, key, positions);
+            }
+
+          /* An alternative may list the same keyval twice */
+          if (positions->len == 0 ||
+              g_array_index (positions, guint, positions->len - 1) != i)
+            g_array_append_val (positions, i);
+        }
+    }
+
+  g_array_unref (keyvals);
+}
+
+static void
+add_candidates (GArray *candidates,
+                GArray *positions)
+{
+  if (positions)
+    g_array_append_vals (candidates, positions->data, positions->len);
+}
+
+static int
+compare_positions (gconstpointer a,
+                   gconstpointer b)
+{
+  guint pa = *(const guint *) a;
+  guint pb = *(const guint *) b;
+
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+/* Returns the positions of all shortcuts that may be triggered by
+ * @event, in the order that they must be checked in.
+ */
+static GArray *
+gtk_shortcut_controller_get_candidates (GtkShortcutController *self,
+                                        GdkEvent              *event)
+{
+  GArray *candidates;
+  guint n_items = self->items->len;
+  guint i, j;
+
+  gtk_shortcut_controller_ensure_index (self);
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+  add_candidates (candidates, self->unindexed);
+
+  if (gdk_event_get_event_type (event) == GDK_KEY_PRESS)
+    {
+      GdkKeymapKey *keys;
+      guint *keyvals;
+      int n_entries;
+
+      add_candidates (candidates,
+                      g_hash_table_lookup (self->keyval_index,
+                                           GUINT_TO_POINTER (normalize_keyval (gdk_key_event_get_keyval (event)))));
+
+      /* Keyval triggers also match the other keyvals of the key
+       * that was pressed, in other layouts. */
+      if (gdk_display_map_keycode (gdk_event_get_display (event),
+                                   gdk_key_event_get_keycode (event),
+                                   &keys, &keyvals, &n_entries))
+        {
+          for (i = 0; i < n_entries; i++)
+            add_candidates (candidates,
+                            g_hash_table_lookup (self->keyval_index,
+                                                 GUINT_TO_POINTER (normalize_keyval (keyvals[i]))));
+
+          g_free (keys);
+          g_free (keyvals);
+        }
+    }
+
+  if (candidates->len == 0)
+    return candidates;
+
+  /* Put the positions into the round-robin order starting after
+   * the last activated shortcut, and drop duplicates. */
+  for (i = 0; i < candidates->len; i++)
+    {
+      guint *pos = &g_array_index (candidates, guint, i);
+      *pos = (*pos + n_items - (self->last_activated + 1) % n_items) % n_items;
+    }
+
+  g_array_sort (candidates, compare_positions);
+
+  for (i = 1, j = 1; i < candidates->len; i++)
+    {
+      if (g_array_index (candidates, guint, i) != g_array_index (candidates, guint, j - 1))
+        g_array_index (candidates, guint, j++) = g_array_index (candidates, guint, i);
+    }
+  g_array_set_size (candidates, j);
+
+  for (i = 0; i < candidates->len; i++)
+    {
+      guint *pos = &g_array_index (candidates, guint, i);
+      *pos = (self->last_activated + 1 + *pos) % n_items;
+    }
+
+  return candidates;
+}
+
 static gboolean
 gtk_shortcut_controller_is_rooted (GtkShortcutController *self)
 {
@@ -215,9 +464,12 @@ gtk_shortcut_controller_set_property (GObject      *object,
             self->custom_shortcuts = FALSE;
           }
 
+        gtk_shortcut_controller_items_changed (self, 0, 0,
+                                               g_list_model_get_n_items (self->shortcuts),
+                                               self->shortcuts);
         self->shortcuts_changed_id =  g_signal_connect_swapped (self->shortcuts,
                                                                 "items-changed",
-                                                                G_CALLBACK (g_list_model_items_changed),
+                                                                G_CALLBACK (gtk_shortcut_controller_items_changed),
                                                                 self);
       }
       break;
@@ -273,6 +525,10 @@ gtk_shortcut_controller_finalize (GObject *object)
   g_clear_signal_handler (&self->shortcuts_changed_id, self->shortcuts);
   g_clear_object (&self->shortcuts);
 
+  g_ptr_array_foreach (self->items, gtk_shortcut_controller_unref_item, self);
+  g_ptr_array_unref (self->items);
+  gtk_shortcut_controller_invalidate_index (self);
+
   G_OBJECT_CLASS (gtk_shortcut_controller_parent_class)->finalize (object);
 }
 
@@ -299,11 +555,14 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
 {
   GtkShortcutController *self = GTK_SHORTCUT_CONTROLLER (controller);
   int i, p;
+  GArray *candidates;
   GArray *shortcuts = NULL;
   gboolean has_exact = FALSE;
   gboolean retval = FALSE;
 
-  for (i = 0, p = g_list_model_get_n_items (self->shortcuts); i < p; i++)
+  candidates = gtk_shortcut_controller_get_candidates (self, event);
+
+  for (i = 0; i < candidates->len; i++)
     {
       GtkShortcut *shortcut;
       ShortcutData *data;
@@ -311,13 +570,8 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
       GtkWidget *widget;
       GtkNative *native;
 
-      index = (self->last_activated + 1 + i) % g_list_model_get_n_items (self->shortcuts);
-      shortcut = g_list_model_get_item (self->shortcuts, index);
-      if (!GTK_IS_SHORTCUT (shortcut))
-        {
-          g_object_unref (shortcut);
-          continue;
-        }
+      index = g_array_index (candidates, guint, i);
+      shortcut = g_object_ref (g_ptr_array_index (self->items, index));
 
       switch (gtk_shortcut_trigger_trigger (gtk_shortcut_get_trigger (shortcut), event, enable_mnemonics))
         {
@@ -380,6 +634,8 @@ gtk_shortcut_controller_run_controllers (GtkEventController *controller,
       data->widget = widget;
     }
 
+  g_array_unref (candidates);
+
 #ifdef G_ENABLE_DEBUG
   if (GTK_DEBUG_CHECK (KEYBINDINGS))
     {
@@ -539,6 +795,8 @@ gtk_shortcut_controller_class_init (GtkShortcutControllerClass *klass)
   object_class->get_property = gtk_shortcut_controller_get_property;
 
   controller_class->handle_event = gtk_shortcut_controller_handle_event;
+  controller_class->event_mask = GTK_EVENT_TYPE_MASK (GDK_KEY_PRESS) |
+                                GTK_EVENT_TYPE_MASK (GDK_KEY_RELEASE);
   controller_class->set_widget = gtk_shortcut_controller_set_widget;
   controller_class->unset_widget = gtk_shortcut_controller_unset_widget;
 
@@ -587,6 +845,7 @@ static void
 gtk_shortcut_controller_init (GtkShortcutController *self)
 {
   self->mnemonics_modifiers = GDK_ALT_MASK;
+  self->items = g_ptr_array_new ();
 }
 
 void
@@ -784,19 +1043,8 @@ gtk_shortcut_controller_remove_shortcut (GtkShortcutController  *self,
       update_accel (shortcut, muxer, FALSE);
     }
 
-  for (i = 0; i < g_list_model_get_n_items (self->shortcuts); i++)
-    {
-      GtkShortcut *item = g_list_model_get_item (self->shortcuts, i);
-
-      if (item == shortcut)
-        {
-          g_object_unref (item);
-          g_list_store_remove (G_LIST_STORE (self->shortcuts), i);
-          return;
-        }
-
-      g_object_unref (item);
-    }
+  if (g_ptr_array_find (self->items, shortcut, &i))
+    g_list_store_remove (G_LIST_STORE (self->shortcuts), i);
 }
 
 /**
@@ -70,6 +70,10 @@
  * #GtkListItem::notify signal is recommended. The signal can be connected
  * in the #GtkSignalListItemFactory::setup signal and removed again during
  * #GtkSignalListItemFactory::teardown.
+ *
+ * If #GtkSignalListItemFactory:deferred-bind is set, list widgets may
+ * postpone #GtkSignalListItemFactory::bind while they are scrolled quickly
+ * and show the listitem without an item in the meantime.
  */
 
 struct _GtkSignalListItemFactory
@@ -91,6 +95,13 @@ struct _GtkSignalListItemFactoryClass
                                                                  GtkListItem              *list_item);
 };
 
+enum {
+  PROP_0,
+  PROP_DEFERRED_BIND,
+
+  N_PROPS
+};
+
 enum {
   SETUP,
   BIND,
@@ -101,6 +112,7 @@ enum {
 };
 
 G_DEFINE_TYPE (GtkSignalListItemFactory, gtk_signal_list_item_factory, GTK_TYPE_LIST_ITEM_FACTORY)
+static GParamSpec *properties[N_PROPS] = { NULL, };
 static guint signals[LAST_SIGNAL] = { 0 };
 
 static void
@@ -146,15 +158,80 @@ gtk_signal_list_item_factory_teardown (GtkListItemFactory *factory,
   g_signal_emit (factory, signals[TEARDOWN], 0, list_item);
 }
 
+static void
+gtk_signal_list_item_factory_get_property (GObject    *object,
+                                           guint       property_id,
+                                           GValue     *value,
+                                           GParamSpec *pspec)
+{
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (object);
+
+  switch (property_id)
+    {
+    case PROP_DEFERRED_BIND:
+      g_value_set_boolean (value, gtk_signal_list_item_factory_get_deferred_bind (self));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_signal_list_item_factory_set_property (GObject      *object,
+                                           guint         property_id,
+                                           const GValue *value,
+                                           GParamSpec   *pspec)
+{
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (object);
+
+  switch (property_id)
+    {
+    case PROP_DEFERRED_BIND:
+      gtk_signal_list_item_factory_set_deferred_bind (self, g_value_get_boolean (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+    }
+}
+
 static void
 gtk_signal_list_item_factory_class_init (GtkSignalListItemFactoryClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GtkListItemFactoryClass *factory_class = GTK_LIST_ITEM_FACTORY_CLASS (klass);
 
+  gobject_class->get_property = gtk_signal_list_item_factory_get_property;
+  gobject_class->set_property = gtk_signal_list_item_factory_set_property;
+
   factory_class->setup = gtk_signal_list_item_factory_setup;
   factory_class->teardown = gtk_signal_list_item_factory_teardown;
   factory_class->update = gtk_signal_list_item_factory_update;
 
+  /**
+   * GtkSignalListItemFactory:deferred-bind:
+   *
+   * Whether binding listitems may be postponed while the list is
+   * scrolled quickly.
+   *
+   * Set this if #GtkSignalListItemFactory::bind is expensive, for example
+   * because it loads thumbnails. Listitems are then shown without an item
+   * until scrolling slows down.
+   *
+   * Since: 4.2
+   */
+  properties[PROP_DEFERRED_BIND] =
+    g_param_spec_boolean ("deferred-bind",
+                          P_("Deferred bind"),
+                          P_("Postpone binding while scrolling fast"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPS, properties);
+
   /**
    * GtkSignalListItemFactory::setup:
    * @self: The #GtkSignalListItemFactory
@@ -274,3 +351,48 @@ gtk_signal_list_item_factory_new (void)
   return g_object_new (GTK_TYPE_SIGNAL_LIST_ITEM_FACTORY, NULL);
 }
 
+/**
+ * gtk_signal_list_item_factory_set_deferred_bind:
+ * @self: a #GtkSignalListItemFactory
+ * @deferred_bind: %TRUE to allow postponing binds
+ *
+ * Sets whether list widgets may postpone binding listitems while
+ * they are scrolled quickly. See
+ * #GtkSignalListItemFactory:deferred-bind for details.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_signal_list_item_factory_set_deferred_bind (GtkSignalListItemFactory *self,
+                                                gboolean                  deferred_bind)
+{
+  GtkListItemFactory *factory = GTK_LIST_ITEM_FACTORY (self);
+
+  g_return_if_fail (GTK_IS_SIGNAL_LIST_ITEM_FACTORY (self));
+
+  if (factory->deferred_bind == !!deferred_bind)
+    return;
+
+  factory->deferred_bind = !!deferred_bind;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFERRED_BIND]);
+}
+
+/**
+ * gtk_signal_list_item_factory_get_deferred_bind:
+ * @self: a #GtkSignalListItemFactory
+ *
+ * Returns whether binds may be postponed while scrolling.
+ *
+ * Returns: %TRUE if binds may be postponed
+ *
+ * Since: 4.2
+ **/
+gboolean
+gtk_signal_list_item_factory_get_deferred_bind (GtkSignalListItemFactory *self)
+{
+  g_return_val_if_fail (GTK_IS_SIGNAL_LIST_ITEM_FACTORY (self), FALSE);
+
+  return GTK_LIST_ITEM_FACTORY (self)->deferred_bind;
+}
+
@@ -50,6 +50,14 @@ GType                   gtk_signal_list_item_factory_get_type   (void) G_GNUC_CO
 GDK_AVAILABLE_IN_ALL
 GtkListItemFactory *    gtk_signal_list_item_factory_new        (void);
 
+GDK_AVAILABLE_IN_4_2
+void                    gtk_signal_list_item_factory_set_deferred_bind
+                                                                (GtkSignalListItemFactory *self,
+                                                                 gboolean                  deferred_bind);
+GDK_AVAILABLE_IN_4_2
+gboolean                gtk_signal_list_item_factory_get_deferred_bind
+                                                                (GtkSignalListItemFactory *self);
+
 
 G_END_DECLS
 
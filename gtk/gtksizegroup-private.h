@@ -26,6 +26,18 @@ G_BEGIN_DECLS
 GHashTable * _gtk_size_group_get_widget_peers (GtkWidget           *for_widget,
                                                GtkOrientation       orientation);
 
+gboolean     _gtk_size_group_lookup_size       (GtkWidget           *for_widget,
+                                               GtkOrientation       orientation,
+                                               int                  for_size,
+                                               int                 *minimum,
+                                               int                 *natural);
+void         _gtk_size_group_store_size        (GtkWidget           *for_widget,
+                                               GtkOrientation       orientation,
+                                               int                  for_size,
+                                               int                  minimum,
+                                               int                  natural);
+void         _gtk_size_group_invalidate_sizes  (void);
+
 G_END_DECLS
 
 #endif /* __GTK_SIZE_GROUP_PRIVATE_H__ */
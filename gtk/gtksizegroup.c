@@ -109,11 +109,20 @@ struct _GtkSizeGroupClass
   GObjectClass parent_class;
 };
 
+typedef struct {
+  guint           generation;
+  int             for_size;
+  int             minimum;
+  int             natural;
+} GtkSizeGroupCachedSize;
+
 struct _GtkSizeGroupPrivate
 {
   GSList         *widgets;
 
   guint8          mode;
+
+  GtkSizeGroupCachedSize cached_sizes[2];
 };
 
 enum {
@@ -148,6 +157,13 @@ G_STATIC_ASSERT (GTK_SIZE_GROUP_HORIZONTAL == (1 << GTK_ORIENTATION_HORIZONTAL))
 G_STATIC_ASSERT (GTK_SIZE_GROUP_VERTICAL == (1 << GTK_ORIENTATION_VERTICAL));
 G_STATIC_ASSERT (GTK_SIZE_GROUP_BOTH == (GTK_SIZE_GROUP_HORIZONTAL | GTK_SIZE_GROUP_VERTICAL));
 
+/* The sizes that groups cache are valid for this generation only. It is
+ * bumped whenever a widget in any size group has its size invalidated, or
+ * the members of a group change, so the caches never outlive the sizes of
+ * the widgets they were computed from.
+ */
+static guint cached_sizes_generation = 1;
+
 G_DEFINE_TYPE_WITH_CODE (GtkSizeGroup, gtk_size_group, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (GtkSizeGroup)
 			 G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
@@ -200,12 +216,83 @@ _gtk_size_group_get_widget_peers (GtkWidget      *for_widget,
   return widgets;
 }
 
+void
+_gtk_size_group_invalidate_sizes (void)
+{
+  cached_sizes_generation++;
+  if (cached_sizes_generation == 0)
+    cached_sizes_generation = 1;
+}
+
+/* All widgets that can be reached from @widget share the size computed
+ * for it, so it is enough to cache that size on the first group of
+ * @widget that applies to @orientation.
+ */
+static GtkSizeGroupCachedSize *
+get_cached_size (GtkWidget      *widget,
+                 GtkOrientation  orientation)
+{
+  GSList *l;
+
+  for (l = _gtk_widget_get_sizegroups (widget); l; l = l->next)
+    {
+      GtkSizeGroupPrivate *priv = gtk_size_group_get_instance_private (l->data);
+
+      if (priv->mode & (1 << orientation))
+        return &priv->cached_sizes[orientation];
+    }
+
+  return NULL;
+}
+
+gboolean
+_gtk_size_group_lookup_size (GtkWidget      *for_widget,
+                             GtkOrientation  orientation,
+                             int             for_size,
+                             int            *minimum,
+                             int            *natural)
+{
+  GtkSizeGroupCachedSize *cached;
+
+  cached = get_cached_size (for_widget, orientation);
+  if (cached == NULL ||
+      cached->generation != cached_sizes_generation ||
+      cached->for_size != for_size)
+    return FALSE;
+
+  *minimum = cached->minimum;
+  *natural = cached->natural;
+
+  return TRUE;
+}
+
+void
+_gtk_size_group_store_size (GtkWidget      *for_widget,
+                            GtkOrientation  orientation,
+                            int             for_size,
+                            int             minimum,
+                            int             natural)
+{
+  GtkSizeGroupCachedSize *cached;
+
+  cached = get_cached_size (for_widget, orientation);
+  if (cached == NULL)
+    return;
+
+  cached->generation = cached_sizes_generation;
+  cached->for_size = for_size;
+  cached->minimum = minimum;
+  cached->natural = natural;
+}
+
 static void
 queue_resize_on_group (GtkSizeGroup *size_group)
 {
   GtkSizeGroupPrivate *priv = gtk_size_group_get_instance_private (size_group);
   GSList *list;
 
+  _gtk_size_group_invalidate_sizes ();
+
   for (list = priv->widgets; list; list = list->next)
     {
       gtk_widget_queue_resize (list->data);
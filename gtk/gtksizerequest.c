@@ -71,6 +71,83 @@ pop_recursion_check (GtkWidget       *widget,
 #define pop_recursion_check(widget, orientation)
 #endif /* G_ENABLE_CONSISTENCY_CHECKS */
 
+#ifdef G_ENABLE_DEBUG
+/* Print the hit rates after this many lookups */
+#define CACHE_STATS_INTERVAL 10000
+
+typedef struct {
+  GType type;
+  guint64 lookups;
+  guint64 hits;
+} CacheStats;
+
+static int
+compare_cache_stats (gconstpointer a,
+                     gconstpointer b)
+{
+  const CacheStats *sa = *(const CacheStats **) a;
+  const CacheStats *sb = *(const CacheStats **) b;
+
+  return sa->lookups < sb->lookups ? 1 : (sa->lookups > sb->lookups ? -1 : 0);
+}
+
+static void
+record_cache_stats (GtkWidget *widget,
+                    gboolean   hit)
+{
+  static GHashTable *stats; /* GType => CacheStats */
+  static guint n_lookups;
+  CacheStats *type_stats;
+  GType type = G_OBJECT_TYPE (widget);
+
+  if (stats == NULL)
+    stats = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  type_stats = g_hash_table_lookup (stats, GSIZE_TO_POINTER (type));
+  if (type_stats == NULL)
+    {
+      type_stats = g_new0 (CacheStats, 1);
+      type_stats->type = type;
+      g_hash_table_insert (stats, GSIZE_TO_POINTER (type), type_stats);
+    }
+
+  type_stats->lookups++;
+  if (hit)
+    type_stats->hits++;
+
+  if (++n_lookups % CACHE_STATS_INTERVAL == 0)
+    {
+      GPtrArray *sorted;
+      GHashTableIter iter;
+      gpointer value;
+      GString *s;
+      guint i;
+
+      sorted = g_ptr_array_sized_new (g_hash_table_size (stats));
+      g_hash_table_iter_init (&iter, stats);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        g_ptr_array_add (sorted, value);
+
+      g_ptr_array_sort (sorted, compare_cache_stats);
+
+      s = g_string_new ("Size request cache hit rates:\n");
+      for (i = 0; i < sorted->len; i++)
+        {
+          const CacheStats *cur = g_ptr_array_index (sorted, i);
+
+          g_string_append_printf (s, "  %-32s %3u%% of %" G_GUINT64_FORMAT "\n",
+                                  g_type_name (cur->type),
+                                  (guint) (100 * cur->hits / cur->lookups),
+                                  cur->lookups);
+        }
+      g_message ("%s", s->str);
+
+      g_string_free (s, TRUE);
+      g_ptr_array_unref (sorted);
+    }
+}
+#endif
+
 static GtkSizeRequestMode
 fetch_request_mode (GtkWidget *widget)
 {
@@ -441,6 +518,8 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 		                    found_in_cache ? "yes" : "no");
             g_message ("%s", s->str);
             g_string_free (s, TRUE);
+
+            record_cache_stats (widget, found_in_cache);
 	    });
 }
 
@@ -511,22 +590,30 @@ gtk_widget_measure (GtkWidget        *widget,
       gpointer key;
       int min_result = 0, nat_result = 0;
 
-      widgets = _gtk_size_group_get_widget_peers (widget, orientation);
-
-      g_hash_table_iter_init (&iter, widgets);
-      while (g_hash_table_iter_next (&iter, &key, NULL))
+      /* Every widget in a size group asks for the size of all of them,
+       * so without the cache measuring n grouped widgets is quadratic.
+       */
+      if (!_gtk_size_group_lookup_size (widget, orientation, for_size, &min_result, &nat_result))
         {
-          GtkWidget *tmp_widget = key;
-          int min_dimension, nat_dimension;
+          widgets = _gtk_size_group_get_widget_peers (widget, orientation);
 
-          gtk_widget_query_size_for_orientation (tmp_widget, orientation, for_size,
-                                                 &min_dimension, &nat_dimension, NULL, NULL);
+          g_hash_table_iter_init (&iter, widgets);
+          while (g_hash_table_iter_next (&iter, &key, NULL))
+            {
+              GtkWidget *tmp_widget = key;
+              int min_dimension, nat_dimension;
 
-          min_result = MAX (min_result, min_dimension);
-          nat_result = MAX (nat_result, nat_dimension);
-        }
+              gtk_widget_query_size_for_orientation (tmp_widget, orientation, for_size,
+                                                     &min_dimension, &nat_dimension, NULL, NULL);
 
-      g_hash_table_destroy (widgets);
+              min_result = MAX (min_result, min_dimension);
+              nat_result = MAX (nat_result, nat_dimension);
+            }
+
+          g_hash_table_destroy (widgets);
+
+          _gtk_size_group_store_size (widget, orientation, for_size, min_result, nat_result);
+        }
 
       /* Baselines make no sense with sizegroups really */
       if (minimum_baseline)
@@ -31,42 +31,72 @@ _gtk_size_request_cache_init (SizeRequestCache *cache)
   memset (cache, 0, sizeof (SizeRequestCache));
 }
 
-static void
-free_sizes_x (SizeRequestX **sizes)
+void
+_gtk_size_request_cache_free (SizeRequestCache *cache)
 {
-  int i;
-
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestX, sizes[i]);
-
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_free (cache->requests_x);
+  g_free (cache->requests_y);
 }
 
-static void
-free_sizes_y (SizeRequestY **sizes)
+void
+_gtk_size_request_cache_clear (SizeRequestCache *cache)
 {
   int i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestY, sizes[i]);
+  /* Keep the requests and how many of them the widget needed, it
+   * will most likely be measured for as many sizes again */
+  for (i = 0; i < 2; i++)
+    {
+      cache->flags[i].n_cached_requests = 0;
+      cache->flags[i].last_cached_request = 0;
+      cache->flags[i].cached_size_valid = FALSE;
+    }
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  cache->request_mode_valid = FALSE;
 }
 
-void
-_gtk_size_request_cache_free (SizeRequestCache *cache)
+/* Returns the index of the request to use for a new result,
+ * growing the requests if the cache is full */
+static guint
+get_free_request (SizeRequestCache *cache,
+                  GtkOrientation    orientation,
+                  gsize             request_size)
 {
-  if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
-  if (cache->requests_y)
-    free_sizes_y (cache->requests_y);
-}
+  gpointer *requests;
+  guint n_sizes, capacity;
 
-void
-_gtk_size_request_cache_clear (SizeRequestCache *cache)
-{
-  _gtk_size_request_cache_free (cache);
-  _gtk_size_request_cache_init (cache);
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    requests = (gpointer *) &cache->requests_x;
+  else
+    requests = (gpointer *) &cache->requests_y;
+
+  n_sizes = cache->flags[orientation].n_cached_requests;
+  capacity = cache->flags[orientation].capacity;
+
+  if (n_sizes == capacity && capacity < GTK_SIZE_REQUEST_MAX_CACHED_SIZES)
+    {
+      if (capacity == 0)
+        capacity = GTK_SIZE_REQUEST_CACHED_SIZES;
+      else
+        capacity = MIN (capacity * 2, GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+
+      *requests = g_realloc (*requests, request_size * capacity);
+      cache->flags[orientation].capacity = capacity;
+    }
+
+  /* If the cache is full, replace the sizes in round robin order */
+  if (n_sizes < capacity)
+    {
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else
+    {
+      if (++cache->flags[orientation].last_cached_request == capacity)
+        cache->flags[orientation].last_cached_request = 0;
+    }
+
+  return cache->flags[orientation].last_cached_request;
 }
 
 void
@@ -112,44 +142,26 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
    */
   n_sizes = cache->flags[orientation].n_cached_requests;
 
-
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
-      SizeRequestX **cached_sizes = cache->requests_x;
-      SizeRequestX  *cached_size;
+      SizeRequestX *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size)
+          cached_size = &cache->requests_x[i];
+
+	  if (cached_size->cached_size.minimum_size == minimum_size &&
+	      cached_size->cached_size.natural_size == natural_size)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_size->lower_for_size = MIN (cached_size->lower_for_size, for_size);
+	      cached_size->upper_for_size = MAX (cached_size->upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+      i = get_free_request (cache, orientation, sizeof (SizeRequestX));
 
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
-
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_x[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -157,43 +169,26 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
     }
   else
     {
-      SizeRequestY **cached_sizes = cache->requests_y;
-      SizeRequestY  *cached_size;
+      SizeRequestY *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size &&
-	      cached_sizes[i]->cached_size.minimum_baseline == minimum_baseline &&
-	      cached_sizes[i]->cached_size.natural_baseline == natural_baseline)
+          cached_size = &cache->requests_y[i];
+
+	  if (cached_size->cached_size.minimum_size == minimum_size &&
+	      cached_size->cached_size.natural_size == natural_size &&
+	      cached_size->cached_size.minimum_baseline == minimum_baseline &&
+	      cached_size->cached_size.natural_baseline == natural_baseline)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_size->lower_for_size = MIN (cached_size->lower_for_size, for_size);
+	      cached_size->upper_for_size = MAX (cached_size->upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
+      i = get_free_request (cache, orientation, sizeof (SizeRequestY));
 
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_y[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -239,7 +234,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestX *cur = cache->requests_x[i];
+              const SizeRequestX *cur = &cache->requests_x[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -278,7 +273,7 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
 	  /* Search for an already cached size */
           for (i = 0, p = cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i < p; i++)
             {
-              const SizeRequestY *cur = cache->requests_y[i];
+              const SizeRequestY *cur = &cache->requests_y[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -35,8 +35,15 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * Widgets start out with room for
+ * GTK_SIZE_REQUEST_CACHED_SIZES ranges, and
+ * widgets that are measured for more sizes
+ * than that get more room, up to
+ * GTK_SIZE_REQUEST_MAX_CACHED_SIZES.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
+#define GTK_SIZE_REQUEST_CACHED_SIZES     (5)
+#define GTK_SIZE_REQUEST_MAX_CACHED_SIZES (32)
 
 typedef struct {
   int minimum_size;
@@ -65,8 +72,8 @@ typedef struct
 } SizeRequestY;
 
 typedef struct {
-  SizeRequestX **requests_x;
-  SizeRequestY **requests_y;
+  SizeRequestX *requests_x;
+  SizeRequestY *requests_y;
 
   CachedSizeX  cached_size_x;
   CachedSizeY  cached_size_y;
@@ -74,8 +81,9 @@ typedef struct {
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
+    guint       n_cached_requests   : 6;
+    guint       last_cached_request : 6;
+    guint       capacity            : 6; /* kept when clearing */
     guint       cached_size_valid   : 1;
   }           flags[2];
 } SizeRequestCache;
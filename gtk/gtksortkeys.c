@@ -22,6 +22,9 @@
 #include "gtkcssstyleprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include <math.h>
+#include <string.h>
+
 GtkSortKeys *
 gtk_sort_keys_alloc (const GtkSortKeysClass *klass,
                      gsize                   size,
@@ -95,6 +98,136 @@ gtk_sort_keys_needs_clear_key (GtkSortKeys *self)
   return self->klass->clear_key != NULL;
 }
 
+void
+gtk_sort_keys_set_format (GtkSortKeys       *self,
+                          GtkSortKeysFormat  format,
+                          gboolean           descending)
+{
+  g_assert (format == GTK_SORT_KEYS_OPAQUE || self->klass->clear_key == NULL);
+  g_assert (format != GTK_SORT_KEYS_FLOAT || self->key_size == sizeof (float) || self->key_size == sizeof (double));
+  g_assert ((format != GTK_SORT_KEYS_UNSIGNED && format != GTK_SORT_KEYS_SIGNED) || self->key_size <= sizeof (guint64));
+
+  self->format = format;
+  self->descending = descending;
+}
+
+GtkSortKeysFormat
+gtk_sort_keys_get_format (GtkSortKeys *self)
+{
+  return self->format;
+}
+
+static guint64
+read_unsigned (gconstpointer key,
+               gsize         size)
+{
+  switch (size)
+    {
+    case 1:
+      return *(const guint8 *) key;
+    case 2:
+      return *(const guint16 *) key;
+    case 4:
+      return *(const guint32 *) key;
+    case 8:
+      return *(const guint64 *) key;
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
+/*<private>
+ * gtk_sort_keys_encode_key:
+ * @self: sort keys that are not %GTK_SORT_KEYS_OPAQUE
+ * @key_memory: a key initialized by @self
+ * @encoded: (out caller-allocates): key_size bytes
+ *
+ * Stores a big-endian version of the key in @encoded that sorts
+ * the same as the key when compared with memcmp().
+ */
+void
+gtk_sort_keys_encode_key (GtkSortKeys   *self,
+                          gconstpointer  key_memory,
+                          guchar        *encoded)
+{
+  gsize i, size = self->key_size;
+  guint64 value, sign = G_GUINT64_CONSTANT (1) << (size * 8 - 1);
+
+  switch (self->format)
+    {
+    case GTK_SORT_KEYS_MEMCMP:
+      memcpy (encoded, key_memory, size);
+      return;
+
+    case GTK_SORT_KEYS_UNSIGNED:
+      value = read_unsigned (key_memory, size);
+      break;
+
+    case GTK_SORT_KEYS_SIGNED:
+      value = read_unsigned (key_memory, size) ^ sign;
+      break;
+
+    case GTK_SORT_KEYS_FLOAT:
+      if (size == sizeof (float))
+        {
+          float f = *(const float *) key_memory;
+          guint32 bits;
+
+          /* Match the compare functions: NaNs are equal and last, zeros are equal */
+          if (isnan (f))
+            f = NAN;
+          else if (f == 0)
+            f = 0;
+          memcpy (&bits, &f, sizeof (bits));
+          value = bits;
+        }
+      else
+        {
+          double d = *(const double *) key_memory;
+          guint64 bits;
+
+          if (isnan (d))
+            d = NAN;
+          else if (d == 0)
+            d = 0;
+          memcpy (&bits, &d, sizeof (bits));
+          value = bits;
+        }
+      if (value & sign)
+        value = ~value;
+      else
+        value |= sign;
+      break;
+
+    case GTK_SORT_KEYS_OPAQUE:
+    default:
+      g_assert_not_reached ();
+      return;
+    }
+
+  if (self->descending)
+    value = ~value;
+
+  for (i = 0; i < size; i++)
+    encoded[i] = value >> (8 * (size - 1 - i));
+}
+
+int
+gtk_sort_keys_compare_memcmp (gconstpointer a,
+                              gconstpointer b,
+                              gpointer      keys)
+{
+  int result = memcmp (a, b, ((GtkSortKeys *) keys)->key_size);
+
+  if (result < 0)
+    return GTK_ORDERING_SMALLER;
+  else if (result > 0)
+    return GTK_ORDERING_LARGER;
+  else
+    return GTK_ORDERING_EQUAL;
+}
+
 static void
 gtk_equal_sort_keys_free (GtkSortKeys *keys)
 {
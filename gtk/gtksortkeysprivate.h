@@ -25,6 +25,19 @@
 typedef struct _GtkSortKeys GtkSortKeys;
 typedef struct _GtkSortKeysClass GtkSortKeysClass;
 
+/* How the key memory is laid out. Keys with a format other than
+ * GTK_SORT_KEYS_OPAQUE can be turned into byte strings with
+ * gtk_sort_keys_encode_key() that sort the same with memcmp(),
+ * which allows radix sorting. Their key_compare() must agree
+ * with that and they must not need clear_key(). */
+typedef enum {
+  GTK_SORT_KEYS_OPAQUE,   /* only key_compare() knows */
+  GTK_SORT_KEYS_UNSIGNED, /* native unsigned integer of key_size bytes */
+  GTK_SORT_KEYS_SIGNED,   /* native signed integer of key_size bytes */
+  GTK_SORT_KEYS_FLOAT,    /* float or double, NaN sorts last */
+  GTK_SORT_KEYS_MEMCMP    /* key_size bytes that sort with memcmp() */
+} GtkSortKeysFormat;
+
 struct _GtkSortKeys
 {
   const GtkSortKeysClass *klass;
@@ -32,6 +45,9 @@ struct _GtkSortKeys
 
   gsize key_size;
   gsize key_align; /* must be power of 2 */
+
+  GtkSortKeysFormat format;
+  gboolean descending; /* for numeric formats */
 };
 
 struct _GtkSortKeysClass
@@ -48,6 +64,12 @@ struct _GtkSortKeysClass
                                                                  gpointer                key_memory);
   void                  (* clear_key)                           (GtkSortKeys            *self,
                                                                  gpointer                key_memory);
+  /* Optional. If set, init_key() only extracts what it needs from the item
+   * and finish_key() computes the actual key from that. finish_key() must
+   * not access the item and keys must be comparable without it, so both
+   * may be called from worker threads. */
+  void                  (* finish_key)                          (GtkSortKeys            *self,
+                                                                 gpointer                key_memory);
 };
 
 GtkSortKeys *           gtk_sort_keys_alloc                     (const GtkSortKeysClass *klass,
@@ -68,6 +90,17 @@ gboolean                gtk_sort_keys_is_compatible             (GtkSortKeys
                                                                  GtkSortKeys            *other);
 gboolean                gtk_sort_keys_needs_clear_key           (GtkSortKeys            *self);
 
+void                    gtk_sort_keys_set_format                (GtkSortKeys            *self,
+                                                                 GtkSortKeysFormat       format,
+                                                                 gboolean                descending);
+GtkSortKeysFormat       gtk_sort_keys_get_format                (GtkSortKeys            *self);
+void                    gtk_sort_keys_encode_key                (GtkSortKeys            *self,
+                                                                 gconstpointer           key_memory,
+                                                                 guchar                 *encoded);
+int                     gtk_sort_keys_compare_memcmp            (gconstpointer           a,
+                                                                 gconstpointer           b,
+                                                                 gpointer                keys);
+
 #define GTK_SORT_KEYS_ALIGN(_size,_align) (((_size) + (_align) - 1) & ~((_align) - 1))
 static inline int
 gtk_sort_keys_compare (GtkSortKeys *self,
@@ -83,6 +116,29 @@ gtk_sort_keys_init_key (GtkSortKeys *self,
                         gpointer       key_memory)
 {
   self->klass->init_key (self, item, key_memory);
+  if (self->klass->finish_key)
+    self->klass->finish_key (self, key_memory);
+}
+
+static inline gboolean
+gtk_sort_keys_is_threadsafe (GtkSortKeys *self)
+{
+  return self->klass->finish_key != NULL;
+}
+
+static inline void
+gtk_sort_keys_prepare_key (GtkSortKeys *self,
+                           gpointer       item,
+                           gpointer       key_memory)
+{
+  self->klass->init_key (self, item, key_memory);
+}
+
+static inline void
+gtk_sort_keys_finish_key (GtkSortKeys *self,
+                          gpointer       key_memory)
+{
+  self->klass->finish_key (self, key_memory);
 }
 
 static inline void
@@ -22,11 +22,14 @@
 #include "gtksortlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkidleschedulerprivate.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
 #include "gtksorterprivate.h"
 #include "timsort/gtktimsortprivate.h"
 
+#include <string.h>
+
 /* The maximum amount of items to merge for a single merge step
  *
  * Making this smaller will result in more steps, which has more overhead and slows
@@ -42,15 +45,22 @@
  */
 #define GTK_SORT_MAX_MERGE_SIZE (1024)
 
-/* Time we spend in the sort callback before returning to the main loop
+/* Sort keys that can be finished without their item (see
+ * gtk_sort_keys_is_threadsafe()) are finished on a thread pool, and for
+ * non-incremental sorts the array is split into runs that are sorted in
+ * parallel before GtkTimSort merges them.
  *
- * Increasing this number will make the callback take longer and potentially
- * reduce responsiveness of an application, but will increase the amount of
- * work done per step. And we emit an ::items-changed() signal after every
- * step, so if we can avoid that, we recuce the overhead in the list widget
- * and in turn reduce the total sort time.
+ * Set GTK_NO_PARALLEL_SORT to disable this.
+ */
+/* Keys that can be encoded as byte strings (see GtkSortKeysFormat)
+ * are radix sorted instead when not sorting incrementally.
  */
-#define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
+#define MIN_RADIX_SORT_ITEMS (256)
+#define MAX_RADIX_SORT_KEY_SIZE (32)
+
+#define MIN_PARALLEL_SORT_ITEMS (4096)
+#define MIN_ITEMS_PER_SORT_JOB (1024)
+#define MAX_SORT_THREADS (8)
 
 /**
  * SECTION:gtksortlistmodel
@@ -172,6 +182,109 @@ gtk_sort_list_model_model_init (GListModelInterface *iface)
 G_DEFINE_TYPE_WITH_CODE (GtkSortListModel, gtk_sort_list_model, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_sort_list_model_model_init))
 
+typedef void (* SortJobFunc) (GtkSortListModel *self,
+                              gpointer          data,
+                              guint             start,
+                              guint             end);
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} SortBatch;
+
+typedef struct {
+  GtkSortListModel *self;
+  SortJobFunc func;
+  gpointer data;
+  guint start;
+  guint end;
+  SortBatch *batch;
+} SortJob;
+
+static GThreadPool *sort_pool;
+
+static void
+sort_job_run (gpointer data,
+              gpointer user_data)
+{
+  SortJob *job = data;
+
+  job->func (job->self, job->data, job->start, job->end);
+
+  g_mutex_lock (&job->batch->lock);
+  job->batch->n_pending--;
+  g_cond_signal (&job->batch->cond);
+  g_mutex_unlock (&job->batch->lock);
+}
+
+static guint
+gtk_sort_list_model_get_n_jobs (GtkSortListModel *self,
+                                guint             n_items)
+{
+  static int enabled = -1;
+
+  if (G_UNLIKELY (enabled == -1))
+    enabled = g_getenv ("GTK_NO_PARALLEL_SORT") == NULL && g_get_num_processors () > 1;
+
+  if (!enabled ||
+      n_items < MIN_PARALLEL_SORT_ITEMS ||
+      !gtk_sort_keys_is_threadsafe (self->sort_keys))
+    return 1;
+
+  return MIN (CLAMP (g_get_num_processors (), 1, MAX_SORT_THREADS),
+              n_items / MIN_ITEMS_PER_SORT_JOB);
+}
+
+/* Splits [0, n_items) into n_jobs ranges of items_per_job items and
+ * runs func on them, the first one in the calling thread. */
+static void
+gtk_sort_list_model_run_parallel (GtkSortListModel *self,
+                                  SortJobFunc       func,
+                                  gpointer          data,
+                                  guint             n_items,
+                                  guint             n_jobs,
+                                  guint             items_per_job)
+{
+  SortBatch batch;
+  SortJob *jobs;
+  guint i;
+
+  g_assert (n_jobs > 1);
+
+  if (G_UNLIKELY (sort_pool == NULL))
+    sort_pool = g_thread_pool_new (sort_job_run, NULL, MAX_SORT_THREADS - 1, FALSE, NULL);
+
+  jobs = g_newa (SortJob, n_jobs);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_jobs - 1;
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].self = self;
+      jobs[i].func = func;
+      jobs[i].data = data;
+      jobs[i].start = MIN (i * items_per_job, n_items);
+      jobs[i].end = MIN (jobs[i].start + items_per_job, n_items);
+      jobs[i].batch = &batch;
+    }
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_pool_push (sort_pool, &jobs[i], NULL);
+
+  func (self, data, jobs[0].start, jobs[0].end);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+}
+
 static gboolean
 gtk_sort_list_model_is_sorting (GtkSortListModel *self)
 {
@@ -195,25 +308,215 @@ gtk_sort_list_model_stop_sorting (GtkSortListModel *self,
   if (runs)
     gtk_tim_sort_get_runs (&self->sort, runs);
   gtk_tim_sort_finish (&self->sort);
-  g_clear_handle_id (&self->sort_cb, g_source_remove);
+  g_clear_handle_id (&self->sort_cb, gtk_idle_scheduler_remove);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
 }
 
+static int sort_func (gconstpointer a,
+                      gconstpointer b,
+                      gpointer      data);
+
+static void
+finish_keys_func (GtkSortListModel *self,
+                  gpointer          data,
+                  guint             start,
+                  guint             end)
+{
+  guint *pos = data;
+  guint i;
+
+  for (i = start; i < end; i++)
+    gtk_sort_keys_finish_key (self->sort_keys, key_from_pos (self, pos[i]));
+}
+
+/* Returns FALSE if it ran out of time before all keys were created */
+static gboolean
+gtk_sort_list_model_init_keys_parallel (GtkSortListModel *self,
+                                        gboolean          finish,
+                                        gint64            end_time)
+{
+  GtkBitsetIter iter;
+  guint *positions;
+  guint pos, n, n_jobs;
+  gboolean done = TRUE;
+
+  /* Leave half of the time to collate what we fetched */
+  end_time -= (end_time - g_get_monotonic_time ()) / 2;
+
+  positions = g_new (guint, gtk_bitset_get_size (self->missing_keys));
+  n = 0;
+
+  /* Getting the items and evaluating expressions has to happen here */
+  for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gpointer item = g_list_model_get_item (self->model, pos);
+      gtk_sort_keys_prepare_key (self->sort_keys, item, key_from_pos (self, pos));
+      g_object_unref (item);
+
+      positions[n++] = pos;
+
+      if (g_get_monotonic_time () >= end_time && !finish)
+        {
+          done = FALSE;
+          break;
+        }
+    }
+
+  n_jobs = gtk_sort_list_model_get_n_jobs (self, n);
+  if (n_jobs > 1)
+    gtk_sort_list_model_run_parallel (self, finish_keys_func, positions,
+                                      n, n_jobs, (n + n_jobs - 1) / n_jobs);
+  else
+    finish_keys_func (self, positions, 0, n);
+
+  if (done)
+    gtk_bitset_remove_all (self->missing_keys);
+  else
+    gtk_bitset_remove_range_closed (self->missing_keys, 0, pos);
+
+  g_free (positions);
+
+  return done;
+}
+
+static void
+sort_run_func (GtkSortListModel *self,
+               gpointer          data,
+               guint             start,
+               guint             end)
+{
+  gtk_tim_sort (self->positions + start,
+                end - start,
+                sizeof (gpointer),
+                sort_func,
+                self->sort_keys);
+}
+
+/* A stable LSD radix sort over the encoded keys. Starting from the
+ * unsorted order makes ties sort by position, just like sort_func().
+ */
+static void
+gtk_sort_list_model_radix_sort (GtkSortListModel *self)
+{
+  gsize key_size = self->key_size;
+  guchar *encoded;
+  guint *order, *tmp, *swap;
+  guint counts[256];
+  guint i, n = self->n_items;
+  gsize byte;
+
+  encoded = g_malloc_n (n, key_size);
+  order = g_new (guint, n);
+  tmp = g_new (guint, n);
+
+  for (i = 0; i < n; i++)
+    {
+      gtk_sort_keys_encode_key (self->sort_keys, key_from_pos (self, i), encoded + i * key_size);
+      order[i] = i;
+    }
+
+  for (byte = key_size; byte-- > 0; )
+    {
+      guint sum, bucket;
+
+      memset (counts, 0, sizeof (counts));
+      for (i = 0; i < n; i++)
+        counts[encoded[i * key_size + byte]]++;
+
+      /* All keys have the same byte here, nothing to do */
+      if (counts[encoded[byte]] == n)
+        continue;
+
+      for (bucket = 0, sum = 0; bucket < 256; bucket++)
+        {
+          guint count = counts[bucket];
+          counts[bucket] = sum;
+          sum += count;
+        }
+
+      for (i = 0; i < n; i++)
+        tmp[counts[encoded[order[i] * key_size + byte]]++] = order[i];
+
+      swap = order;
+      order = tmp;
+      tmp = swap;
+    }
+
+  for (i = 0; i < n; i++)
+    self->positions[i] = key_from_pos (self, order[i]);
+
+  g_free (tmp);
+  g_free (order);
+  g_free (encoded);
+}
+
+/* Sorts runs of a fresh sort in parallel, so that only merges are left */
+static gboolean
+gtk_sort_list_model_presort_runs (GtkSortListModel *self)
+{
+  gsize runs[MAX_SORT_THREADS + 1];
+  guint i, n_jobs, items_per_job;
+
+  if (self->sort.pending_runs != 0 ||
+      self->sort.base != (gpointer) self->positions)
+    return FALSE;
+
+  if (gtk_sort_keys_get_format (self->sort_keys) != GTK_SORT_KEYS_OPAQUE &&
+      self->n_items >= MIN_RADIX_SORT_ITEMS &&
+      self->key_size <= MAX_RADIX_SORT_KEY_SIZE)
+    {
+      gtk_sort_list_model_radix_sort (self);
+
+      runs[0] = self->n_items;
+      runs[1] = 0;
+      gtk_tim_sort_set_runs (&self->sort, runs);
+
+      return TRUE;
+    }
+
+  n_jobs = gtk_sort_list_model_get_n_jobs (self, self->n_items);
+  if (n_jobs <= 1)
+    return FALSE;
+
+  items_per_job = (self->n_items + n_jobs - 1) / n_jobs;
+  gtk_sort_list_model_run_parallel (self, sort_run_func, NULL,
+                                    self->n_items, n_jobs, items_per_job);
+
+  for (i = 0; i < n_jobs; i++)
+    runs[i] = MIN (items_per_job, self->n_items - MIN (i * items_per_job, self->n_items));
+  runs[n_jobs] = 0;
+
+  gtk_tim_sort_set_runs (&self->sort, runs);
+
+  return TRUE;
+}
+
 static gboolean
 gtk_sort_list_model_sort_step (GtkSortListModel *self,
                                gboolean          finish,
+                               gint64            end_time,
                                guint            *out_position,
                                guint            *out_n_items)
 {
-  gint64 end_time = g_get_monotonic_time ();
   gboolean result = FALSE;
   GtkTimSortRun change;
   gpointer *start_change, *end_change;
 
-  end_time += GTK_SORT_STEP_TIME_US;
-
-  if (!gtk_bitset_is_empty (self->missing_keys))
+  if (!gtk_bitset_is_empty (self->missing_keys) &&
+      gtk_sort_list_model_get_n_jobs (self, gtk_bitset_get_size (self->missing_keys)) > 1)
+    {
+      if (!gtk_sort_list_model_init_keys_parallel (self, finish, end_time))
+        {
+          *out_position = 0;
+          *out_n_items = 0;
+          return TRUE;
+        }
+      result = TRUE;
+    }
+  else if (!gtk_bitset_is_empty (self->missing_keys))
     {
       GtkBitsetIter iter;
       guint pos;
@@ -241,6 +544,14 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
   end_change = self->positions;
   start_change = self->positions + self->n_items;
 
+  if ((finish || !self->incremental) &&
+      gtk_sort_list_model_presort_runs (self))
+    {
+      result = TRUE;
+      start_change = self->positions;
+      end_change = self->positions + self->n_items;
+    }
+
   while (gtk_tim_sort_step (&self->sort, &change))
     {
       result = TRUE;
@@ -269,12 +580,13 @@ gtk_sort_list_model_sort_step (GtkSortListModel *self,
 }
 
 static gboolean
-gtk_sort_list_model_sort_cb (gpointer data)
+gtk_sort_list_model_sort_cb (gpointer data,
+                             gint64   deadline)
 {
   GtkSortListModel *self = data;
   guint pos, n_items;
 
-  if (gtk_sort_list_model_sort_step (self, FALSE, &pos, &n_items))
+  if (gtk_sort_list_model_sort_step (self, FALSE, deadline, &pos, &n_items))
     {
       if (n_items)
         g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
@@ -322,7 +634,9 @@ gtk_sort_list_model_start_sorting (GtkSortListModel *self,
   if (!self->incremental)
     return FALSE;
 
-  self->sort_cb = g_idle_add (gtk_sort_list_model_sort_cb, self);
+  self->sort_cb = gtk_idle_scheduler_add (G_PRIORITY_DEFAULT_IDLE,
+                                          gtk_sort_list_model_sort_cb,
+                                          self, NULL);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
   return TRUE;
 }
@@ -334,7 +648,7 @@ gtk_sort_list_model_finish_sorting (GtkSortListModel *self,
 {
   gtk_tim_sort_set_max_merge_size (&self->sort, 0);
 
-  gtk_sort_list_model_sort_step (self, TRUE, pos, n_items);
+  gtk_sort_list_model_sort_step (self, TRUE, G_MAXINT64, pos, n_items);
   gtk_tim_sort_finish (&self->sort);
 
   gtk_sort_list_model_stop_sorting (self, NULL);
@@ -678,6 +992,57 @@ gtk_sort_list_model_get_property (GObject     *object,
     }
 }
 
+/* Sorts the items for a sorter that was inverted, when they are sorted
+ * for the sorter before the change. Reversing the items gets them into
+ * the new order, except for runs of items that compare equal, which must
+ * stay in the order of the model.
+ */
+static void
+gtk_sort_list_model_reverse (GtkSortListModel *self,
+                             guint            *pos,
+                             guint            *n_items)
+{
+  gpointer *positions;
+  guint i, j, start, end;
+
+  positions = g_new (gpointer, self->n_items);
+  for (i = 0; i < self->n_items; i++)
+    positions[i] = self->positions[self->n_items - 1 - i];
+
+  for (i = 0; i < self->n_items; i = j)
+    {
+      for (j = i + 1; j < self->n_items; j++)
+        {
+          if (gtk_sort_keys_compare (self->sort_keys, positions[j - 1], positions[j]) != GTK_ORDERING_EQUAL)
+            break;
+        }
+
+      for (start = i, end = j - 1; start < end; start++, end--)
+        {
+          gpointer tmp = positions[start];
+          positions[start] = positions[end];
+          positions[end] = tmp;
+        }
+    }
+
+  for (start = 0; start < self->n_items; start++)
+    {
+      if (positions[start] != self->positions[start])
+        break;
+    }
+  for (end = self->n_items; end > start; end--)
+    {
+      if (positions[end - 1] != self->positions[end - 1])
+        break;
+    }
+
+  g_free (self->positions);
+  self->positions = positions;
+
+  *n_items = end - start;
+  *pos = *n_items > 0 ? start : 0;
+}
+
 static void
 gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
                                        int               change,
@@ -687,6 +1052,10 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
 
   if (gtk_sort_list_model_should_sort (self))
     {
+      gboolean was_sorted = self->sort_keys != NULL &&
+                            !gtk_sort_list_model_is_sorting (self) &&
+                            gtk_bitset_is_empty (self->missing_keys);
+
       gtk_sort_list_model_stop_sorting (self, NULL);
 
       if (self->sort_keys == NULL)
@@ -715,6 +1084,15 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
             {
               gtk_sort_keys_unref (self->sort_keys);
               self->sort_keys = new_keys;
+
+              /* Column view headers switch between ascending and
+               * descending all the time, so avoid a full sort for it
+               */
+              if (change == GTK_SORTER_CHANGE_INVERTED && was_sorted)
+                {
+                  gtk_sort_list_model_reverse (self, &pos, &n_items);
+                  goto out;
+                }
             }
         }
 
@@ -728,6 +1106,7 @@ gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
       gtk_sort_list_model_clear_items (self, &pos, &n_items);
     }
 
+out:
   if (n_items > 0)
     g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
 }
@@ -144,6 +144,7 @@ typedef struct {
   guint transition_duration;
 
   GtkStackPage *last_visible_child;
+  GskRenderNode *last_visible_node;
   guint tick_id;
   GtkProgressTracker tracker;
   gboolean first_frame_skipped;
@@ -670,6 +671,8 @@ gtk_stack_finalize (GObject *obj)
 
   gtk_stack_unschedule_ticks (stack);
 
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+
   G_OBJECT_CLASS (gtk_stack_parent_class)->finalize (obj);
 }
 
@@ -1013,6 +1016,7 @@ gtk_stack_progress_updated (GtkStack *stack)
     {
       gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
       priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
     }
 }
 
@@ -1227,6 +1231,7 @@ set_visible_child (GtkStack               *stack,
   if (priv->last_visible_child)
     gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
   priv->last_visible_child = NULL;
+  g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
 
   if (priv->visible_child && priv->visible_child->widget)
     {
@@ -1323,6 +1328,7 @@ update_child_visible (GtkStack     *stack,
     {
       gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
       priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
     }
 
   gtk_accessible_update_state (GTK_ACCESSIBLE (child_info),
@@ -1501,7 +1507,10 @@ stack_remove (GtkStack  *stack,
     priv->visible_child = NULL;
 
   if (priv->last_visible_child == child_info)
-    priv->last_visible_child = NULL;
+    {
+      priv->last_visible_child = NULL;
+      g_clear_pointer (&priv->last_visible_node, gsk_render_node_unref);
+    }
 
   gtk_widget_unparent (child);
 
@@ -2094,6 +2103,29 @@ gtk_stack_get_request_mode (GtkWidget *widget)
         GTK_SIZE_REQUEST_HEIGHT_FOR_WIDTH;
 }
 
+/* The child that is going away does not change during the transition,
+ * so it is only snapshot once and its node reused for every frame.
+ */
+static void
+gtk_stack_snapshot_last_visible_child (GtkWidget   *widget,
+                                       GtkSnapshot *snapshot)
+{
+  GtkStack *stack = GTK_STACK (widget);
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+
+  if (priv->last_visible_node == NULL)
+    {
+      GtkSnapshot *child_snapshot;
+
+      child_snapshot = gtk_snapshot_new ();
+      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, child_snapshot);
+      priv->last_visible_node = gtk_snapshot_free_to_node (child_snapshot);
+    }
+
+  if (priv->last_visible_node)
+    gtk_snapshot_append_node (snapshot, priv->last_visible_node);
+}
+
 static void
 gtk_stack_snapshot_crossfade (GtkWidget   *widget,
                               GtkSnapshot *snapshot)
@@ -2106,9 +2138,7 @@ gtk_stack_snapshot_crossfade (GtkWidget   *widget,
 
   if (priv->last_visible_child)
     {
-      gtk_widget_snapshot_child (widget,
-                                 priv->last_visible_child->widget,
-                                 snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
     }
   gtk_snapshot_pop (snapshot);
 
@@ -2172,7 +2202,7 @@ gtk_stack_snapshot_under (GtkWidget   *widget,
     {
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (pos_x, pos_y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
     }
 }
@@ -2208,7 +2238,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_visible_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2232,7 +2262,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
   if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
     gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
   else
-    gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+    gtk_stack_snapshot_last_visible_child (widget, snapshot);
   gtk_snapshot_restore (snapshot);
 
   if (priv->last_visible_child && progress <= 0.5)
@@ -2252,7 +2282,7 @@ gtk_stack_snapshot_cube (GtkWidget   *widget,
                                  - gtk_widget_get_height (widget) / 2.f,
                                  gtk_widget_get_width (widget) / 2.f));
       if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_ROTATE_LEFT)
-        gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+        gtk_stack_snapshot_last_visible_child (widget, snapshot);
       else
         gtk_widget_snapshot_child (widget, priv->visible_child->widget, snapshot);
       gtk_snapshot_restore (snapshot);
@@ -2315,7 +2345,7 @@ gtk_stack_snapshot_slide (GtkWidget   *widget,
 
       gtk_snapshot_save (snapshot);
       gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (x, y));
-      gtk_widget_snapshot_child (widget, priv->last_visible_child->widget, snapshot);
+      gtk_stack_snapshot_last_visible_child (widget, snapshot);
       gtk_snapshot_restore (snapshot);
      }
 
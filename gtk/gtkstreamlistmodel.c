@@ -0,0 +1,477 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkstreamlistmodel.h"
+
+#include "gtkintl.h"
+#include "gtkprivate.h"
+
+/**
+ * SECTION:gtkstreamlistmodel
+ * @title: GtkStreamListModel
+ * @short_description: A list model that other threads can append to
+ * @see_also: #GListModel, #GListStore
+ *
+ * #GtkStreamListModel is a list model for data that arrives quickly,
+ * like log messages or measurements.
+ *
+ * Items can be appended from any thread with gtk_stream_list_model_append().
+ * They are added to the model in batches in the main context that was the
+ * thread-default context when the model was created, so that
+ * #GListModel::items-changed is emitted at most once per frame.
+ *
+ * With #GtkStreamListModel:max-items, the model keeps only the newest items
+ * and drops the oldest ones.
+ *
+ * Everything apart from appending items must happen in the thread that
+ * runs the main context, like with every other list model.
+ */
+
+/* about once per frame */
+#define FLUSH_INTERVAL_MS 16
+
+/* how many dropped items are kept around before they are
+ * removed from the start of the items array
+ */
+#define MIN_COMPACT_OFFSET 1024
+
+enum {
+  PROP_0,
+  PROP_ITEM_TYPE,
+  PROP_MAX_ITEMS,
+  NUM_PROPERTIES
+};
+
+typedef struct _PendingItem PendingItem;
+
+struct _PendingItem
+{
+  PendingItem *next;
+  gpointer item;
+};
+
+struct _GtkStreamListModel
+{
+  GObject parent_instance;
+
+  GType item_type;
+  guint max_items;
+  GMainContext *context;
+
+  /* owned by the main context */
+  GPtrArray *items;
+  guint offset; /* items before offset have been dropped */
+
+  /* shared with producers, accessed atomically */
+  PendingItem *pending; /* newest first */
+  int flush_scheduled;
+};
+
+struct _GtkStreamListModelClass
+{
+  GObjectClass parent_class;
+};
+
+static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
+
+static GType
+gtk_stream_list_model_get_item_type (GListModel *list)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (list);
+
+  return self->item_type;
+}
+
+static guint
+gtk_stream_list_model_get_n_items (GListModel *list)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (list);
+
+  return self->items->len - self->offset;
+}
+
+static gpointer
+gtk_stream_list_model_get_item (GListModel *list,
+                                guint       position)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (list);
+
+  if (position >= self->items->len - self->offset)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (self->items, self->offset + position));
+}
+
+static void
+gtk_stream_list_model_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = gtk_stream_list_model_get_item_type;
+  iface->get_n_items = gtk_stream_list_model_get_n_items;
+  iface->get_item = gtk_stream_list_model_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE (GtkStreamListModel, gtk_stream_list_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_stream_list_model_model_init))
+
+/* Takes all pending items, in the order they were appended */
+static PendingItem *
+gtk_stream_list_model_steal_pending (GtkStreamListModel *self)
+{
+  PendingItem *list, *reversed;
+
+  do
+    list = g_atomic_pointer_get (&self->pending);
+  while (!g_atomic_pointer_compare_and_exchange (&self->pending, list, NULL));
+
+  reversed = NULL;
+  while (list)
+    {
+      PendingItem *next = list->next;
+
+      list->next = reversed;
+      reversed = list;
+      list = next;
+    }
+
+  return reversed;
+}
+
+static void
+gtk_stream_list_model_drop_items (GtkStreamListModel *self,
+                                  guint               n_items)
+{
+  guint i;
+
+  for (i = 0; i < n_items; i++)
+    g_object_unref (g_ptr_array_index (self->items, self->offset + i));
+
+  self->offset += n_items;
+
+  /* Only move the remaining items occasionally, so dropping
+   * items stays cheap.
+   */
+  if (self->offset >= MIN_COMPACT_OFFSET &&
+      self->offset > self->items->len / 2)
+    {
+      g_ptr_array_remove_range (self->items, 0, self->offset);
+      self->offset = 0;
+    }
+}
+
+static void
+gtk_stream_list_model_emit (GtkStreamListModel *self,
+                            guint               n_before,
+                            guint               removed,
+                            guint               added)
+{
+  if (removed == n_before)
+    {
+      if (removed > 0 || added > 0)
+        g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, added);
+      return;
+    }
+
+  if (removed > 0)
+    g_list_model_items_changed (G_LIST_MODEL (self), 0, removed, 0);
+  if (added > 0)
+    g_list_model_items_changed (G_LIST_MODEL (self), n_before - removed, 0, added);
+}
+
+static gboolean
+gtk_stream_list_model_flush_cb (gpointer data)
+{
+  GtkStreamListModel *self = data;
+  PendingItem *list;
+  guint n_before, added, skipped, removed;
+
+  /* Reset first, so items appended from now on schedule another flush */
+  g_atomic_int_set (&self->flush_scheduled, 0);
+
+  list = gtk_stream_list_model_steal_pending (self);
+  if (list == NULL)
+    return G_SOURCE_REMOVE;
+
+  n_before = self->items->len - self->offset;
+  added = 0;
+  while (list)
+    {
+      PendingItem *next = list->next;
+
+      g_ptr_array_add (self->items, list->item);
+      g_slice_free (PendingItem, list);
+      list = next;
+      added++;
+    }
+
+  removed = 0;
+  skipped = 0;
+  if (self->max_items > 0 && n_before + added > self->max_items)
+    {
+      guint excess = n_before + added - self->max_items;
+
+      removed = MIN (excess, n_before);
+      /* Items that would be dropped right away are never announced */
+      skipped = excess - removed;
+    }
+
+  gtk_stream_list_model_drop_items (self, removed + skipped);
+  gtk_stream_list_model_emit (self, n_before, removed, added - skipped);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_stream_list_model_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (object);
+
+  switch (prop_id)
+    {
+    case PROP_ITEM_TYPE:
+      self->item_type = g_value_get_gtype (value);
+      break;
+
+    case PROP_MAX_ITEMS:
+      gtk_stream_list_model_set_max_items (self, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_stream_list_model_get_property (GObject     *object,
+                                    guint        prop_id,
+                                    GValue      *value,
+                                    GParamSpec  *pspec)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (object);
+
+  switch (prop_id)
+    {
+    case PROP_ITEM_TYPE:
+      g_value_set_gtype (value, self->item_type);
+      break;
+
+    case PROP_MAX_ITEMS:
+      g_value_set_uint (value, self->max_items);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_stream_list_model_finalize (GObject *object)
+{
+  GtkStreamListModel *self = GTK_STREAM_LIST_MODEL (object);
+  PendingItem *list;
+  guint i;
+
+  list = gtk_stream_list_model_steal_pending (self);
+  while (list)
+    {
+      PendingItem *next = list->next;
+
+      g_object_unref (list->item);
+      g_slice_free (PendingItem, list);
+      list = next;
+    }
+
+  for (i = self->offset; i < self->items->len; i++)
+    g_object_unref (g_ptr_array_index (self->items, i));
+  g_ptr_array_unref (self->items);
+
+  g_main_context_unref (self->context);
+
+  G_OBJECT_CLASS (gtk_stream_list_model_parent_class)->finalize (object);
+}
+
+static void
+gtk_stream_list_model_class_init (GtkStreamListModelClass *class)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (class);
+
+  gobject_class->set_property = gtk_stream_list_model_set_property;
+  gobject_class->get_property = gtk_stream_list_model_get_property;
+  gobject_class->finalize = gtk_stream_list_model_finalize;
+
+  /**
+   * GtkStreamListModel:item-type:
+   *
+   * The type of items
+   *
+   * Since: 4.2
+   */
+  properties[PROP_ITEM_TYPE] =
+      g_param_spec_gtype ("item-type",
+                          P_("Item type"),
+                          P_("The type of items"),
+                          G_TYPE_OBJECT,
+                          GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GtkStreamListModel:max-items:
+   *
+   * Maximum number of items to keep or 0 for no limit
+   *
+   * Since: 4.2
+   */
+  properties[PROP_MAX_ITEMS] =
+      g_param_spec_uint ("max-items",
+                         P_("Maximum items"),
+                         P_("Maximum number of items to keep"),
+                         0, G_MAXUINT, 0,
+                         GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
+}
+
+static void
+gtk_stream_list_model_init (GtkStreamListModel *self)
+{
+  self->item_type = G_TYPE_OBJECT;
+  self->items = g_ptr_array_new ();
+  self->context = g_main_context_ref_thread_default ();
+}
+
+/**
+ * gtk_stream_list_model_new:
+ * @item_type: the #GType of items in the list
+ *
+ * Creates a new empty #GtkStreamListModel.
+ *
+ * The items will be added in the current thread-default main context.
+ *
+ * Returns: A new #GtkStreamListModel
+ *
+ * Since: 4.2
+ **/
+GtkStreamListModel *
+gtk_stream_list_model_new (GType item_type)
+{
+  g_return_val_if_fail (g_type_is_a (item_type, G_TYPE_OBJECT), NULL);
+
+  return g_object_new (GTK_TYPE_STREAM_LIST_MODEL,
+                       "item-type", item_type,
+                       NULL);
+}
+
+/**
+ * gtk_stream_list_model_append:
+ * @self: a #GtkStreamListModel
+ * @item: (type GObject): the item to append
+ *
+ * Appends @item to @self.
+ *
+ * This function can be called from any thread and does not block.
+ * The item does not show up in @self immediately: appended items
+ * are added together by the main context of @self, about once per
+ * frame.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_stream_list_model_append (GtkStreamListModel *self,
+                              gpointer            item)
+{
+  PendingItem *pending;
+
+  g_return_if_fail (GTK_IS_STREAM_LIST_MODEL (self));
+  g_return_if_fail (g_type_is_a (G_OBJECT_TYPE (item), self->item_type));
+
+  pending = g_slice_new (PendingItem);
+  pending->item = g_object_ref (item);
+
+  do
+    pending->next = g_atomic_pointer_get (&self->pending);
+  while (!g_atomic_pointer_compare_and_exchange (&self->pending, pending->next, pending));
+
+  if (g_atomic_int_compare_and_exchange (&self->flush_scheduled, 0, 1))
+    {
+      GSource *source;
+
+      source = g_timeout_source_new (FLUSH_INTERVAL_MS);
+      g_source_set_callback (source,
+                             gtk_stream_list_model_flush_cb,
+                             g_object_ref (self),
+                             g_object_unref);
+      g_source_set_name (source, "[gtk] gtk_stream_list_model_flush_cb");
+      g_source_attach (source, self->context);
+      g_source_unref (source);
+    }
+}
+
+/**
+ * gtk_stream_list_model_set_max_items:
+ * @self: a #GtkStreamListModel
+ * @max_items: the maximum number of items or 0 for no limit
+ *
+ * Sets the maximum number of items to keep in @self. Once there
+ * are more items, the oldest ones are removed.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_stream_list_model_set_max_items (GtkStreamListModel *self,
+                                     guint               max_items)
+{
+  guint n_items;
+
+  g_return_if_fail (GTK_IS_STREAM_LIST_MODEL (self));
+
+  if (self->max_items == max_items)
+    return;
+
+  self->max_items = max_items;
+
+  n_items = self->items->len - self->offset;
+  if (max_items > 0 && n_items > max_items)
+    {
+      gtk_stream_list_model_drop_items (self, n_items - max_items);
+      g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items - max_items, 0);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_ITEMS]);
+}
+
+/**
+ * gtk_stream_list_model_get_max_items:
+ * @self: a #GtkStreamListModel
+ *
+ * Gets the maximum number of items kept in @self.
+ *
+ * Returns: The maximum number of items or 0 if there is no limit
+ *
+ * Since: 4.2
+ **/
+guint
+gtk_stream_list_model_get_max_items (GtkStreamListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_STREAM_LIST_MODEL (self), 0);
+
+  return self->max_items;
+}
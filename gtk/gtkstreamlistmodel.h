@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_STREAM_LIST_MODEL_H__
+#define __GTK_STREAM_LIST_MODEL_H__
+
+
+#if !defined (__GTK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gtk/gtk.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gtk/gtkwidget.h>
+
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_STREAM_LIST_MODEL (gtk_stream_list_model_get_type ())
+
+GDK_AVAILABLE_IN_4_2
+G_DECLARE_FINAL_TYPE (GtkStreamListModel, gtk_stream_list_model, GTK, STREAM_LIST_MODEL, GObject)
+
+GDK_AVAILABLE_IN_4_2
+GtkStreamListModel *    gtk_stream_list_model_new               (GType                   item_type);
+
+GDK_AVAILABLE_IN_4_2
+void                    gtk_stream_list_model_append            (GtkStreamListModel     *self,
+                                                                 gpointer                item);
+
+GDK_AVAILABLE_IN_4_2
+void                    gtk_stream_list_model_set_max_items     (GtkStreamListModel     *self,
+                                                                 guint                   max_items);
+GDK_AVAILABLE_IN_4_2
+guint                   gtk_stream_list_model_get_max_items     (GtkStreamListModel     *self);
+
+G_END_DECLS
+
+#endif /* __GTK_STREAM_LIST_MODEL_H__ */
@@ -21,7 +21,9 @@
 
 #include "gtkstringfilter.h"
 
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
+#include "gtkstringkeycacheprivate.h"
 #include "gtktypebuiltins.h"
 
 /**
@@ -48,6 +50,7 @@ struct _GtkStringFilter
   GtkStringFilterMatchMode match_mode;
 
   GtkExpression *expression;
+  GtkStringKeyCache *cache; /* NULL if expression is NULL */
 };
 
 enum {
@@ -93,52 +96,116 @@ gtk_string_filter_has_search (GtkStringFilter *self)
   return self->search_prepared != NULL;
 }
 
-static gboolean
-gtk_string_filter_match (GtkFilter *filter,
-                         gpointer   item)
+static GtkStringKeyKind
+gtk_string_filter_get_key_kind (GtkStringFilter *self)
 {
-  GtkStringFilter *self = GTK_STRING_FILTER (filter);
-  GValue value = G_VALUE_INIT;
-  char *prepared;
-  const char *s;
-  gboolean result;
+  return self->ignore_case ? GTK_STRING_KEY_NORMALIZED_CASEFOLD : GTK_STRING_KEY_NORMALIZED;
+}
 
-  if (!gtk_string_filter_has_search (self))
-    return TRUE;
+static gboolean
+gtk_string_filter_match_key (GtkStringFilter *self,
+                             GtkStringKey    *key)
+{
+  const char *prepared;
 
-  if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
-    return FALSE;
-  s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
+  prepared = gtk_string_key_get (key, gtk_string_filter_get_key_kind (self));
   if (prepared == NULL)
     return FALSE;
 
   switch (self->match_mode)
     {
     case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-      result = strcmp (prepared, self->search_prepared) == 0;
-      break;
+      return strcmp (prepared, self->search_prepared) == 0;
     case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-      result = strstr (prepared, self->search_prepared) != NULL;
-      break;
+      return strstr (prepared, self->search_prepared) != NULL;
     case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-      result = g_str_has_prefix (prepared, self->search_prepared);
-      break;
+      return g_str_has_prefix (prepared, self->search_prepared);
     default:
       g_assert_not_reached ();
+      return FALSE;
     }
+}
 
-#if 0
-  g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
-#endif
+/* The normalized strings are kept in a GtkStringKeyCache, so refining
+ * the search only needs to compare strings.
+ */
+static gboolean
+gtk_string_filter_match (GtkFilter *filter,
+                         gpointer   item)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+  GtkStringKey *key;
+  gboolean result;
 
-  g_free (prepared);
-  g_value_unset (&value);
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (self->cache == NULL)
+    return FALSE;
+
+  key = gtk_string_key_cache_lookup (self->cache, item);
+  result = gtk_string_filter_match_key (self, key);
+  gtk_string_key_unref (key);
 
   return result;
 }
 
+/* Only looking up the key needs to happen in the main thread,
+ * normalizing and matching the string doesn't. The string filter
+ * strictness is SOME only when there is a search.
+ */
+static gpointer
+gtk_string_filter_prepare_item (GtkFilter *filter,
+                                gpointer   item)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+
+  if (self->cache == NULL)
+    return NULL;
+
+  return gtk_string_key_cache_lookup (self->cache, item);
+}
+
+static gboolean
+gtk_string_filter_match_prepared (GtkFilter *filter,
+                                  gpointer   prepared)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (prepared == NULL)
+    return FALSE;
+
+  return gtk_string_filter_match_key (self, prepared);
+}
+
+static void
+gtk_string_filter_finish_prepared (GtkFilter *filter,
+                                   gpointer   prepared)
+{
+  if (prepared)
+    gtk_string_key_unref (prepared);
+}
+
+static const GtkFilterPreparedMatch gtk_string_filter_prepared_match = {
+  gtk_string_filter_prepare_item,
+  gtk_string_filter_match_prepared,
+  gtk_string_filter_finish_prepared
+};
+
+static char *
+gtk_string_filter_get_state (GtkFilter *filter)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+
+  return g_strdup_printf ("%d %d %s",
+                          self->ignore_case,
+                          self->match_mode,
+                          self->search ? self->search : "");
+}
+
 static GtkFilterMatch
 gtk_string_filter_get_strictness (GtkFilter *filter)
 {
@@ -225,6 +292,7 @@ gtk_string_filter_dispose (GObject *object)
   g_clear_pointer (&self->search, g_free);
   g_clear_pointer (&self->search_prepared, g_free);
   g_clear_pointer (&self->expression, gtk_expression_unref);
+  g_clear_pointer (&self->cache, gtk_string_key_cache_unref);
 
   G_OBJECT_CLASS (gtk_string_filter_parent_class)->dispose (object);
 }
@@ -237,6 +305,8 @@ gtk_string_filter_class_init (GtkStringFilterClass *class)
 
   filter_class->match = gtk_string_filter_match;
   filter_class->get_strictness = gtk_string_filter_get_strictness;
+  gtk_filter_class_set_prepared_match (filter_class, &gtk_string_filter_prepared_match);
+  gtk_filter_class_set_state_func (filter_class, gtk_string_filter_get_state);
 
   object_class->get_property = gtk_string_filter_get_property;
   object_class->set_property = gtk_string_filter_set_property;
@@ -421,7 +491,12 @@ gtk_string_filter_set_expression (GtkStringFilter *self,
     return;
 
   g_clear_pointer (&self->expression, gtk_expression_unref);
-  self->expression = gtk_expression_ref (expression);
+  g_clear_pointer (&self->cache, gtk_string_key_cache_unref);
+  if (expression)
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_string_key_cache_get (expression);
+    }
 
   if (gtk_string_filter_has_search (self))
     gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
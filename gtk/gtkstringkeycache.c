@@ -0,0 +1,311 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkstringkeycacheprivate.h"
+
+/* GtkStringKeyCache remembers the string an expression evaluates to for
+ * an item, together with the normalized, casefolded and collated versions
+ * of it that string sorters and filters need. Sorters and filters using
+ * equal expressions share a cache, so sorting again or changing the
+ * search doesn't evaluate expressions or process strings again.
+ *
+ * Every cached item is watched via gtk_expression_watch(), so keys are
+ * dropped when the item goes away or its string may have changed.
+ *
+ * Caches and lookups must only be used in the main thread, while
+ * gtk_string_key_get() can be called from any thread.
+ */
+
+/* The most items a cache will keep keys for */
+#define MAX_CACHED_KEYS (1 << 20)
+
+struct _GtkStringKeyCache
+{
+  int ref_count;
+
+  GtkExpression *expression;
+  GHashTable *keys; /* item => GtkStringKey */
+};
+
+struct _GtkStringKey
+{
+  int ref_count;
+
+  GtkStringKeyCache *cache; /* NULL if not cached */
+  gpointer item;
+  GtkExpressionWatch *watch;
+
+  char *string;
+  char *keys[GTK_STRING_KEY_N_KINDS]; /* computed on demand */
+};
+
+static GHashTable *caches; /* expression => GtkStringKeyCache */
+
+/* Property expressions are created for every sorter and filter,
+ * so compare them by the properties they look up.
+ */
+static guint
+expression_hash (gconstpointer data)
+{
+  GtkExpression *expression = (GtkExpression *) data;
+  GtkExpression *sub;
+  guint hash;
+
+  if (!G_TYPE_CHECK_INSTANCE_TYPE (expression, GTK_TYPE_PROPERTY_EXPRESSION))
+    return g_direct_hash (expression);
+
+  hash = g_direct_hash (gtk_property_expression_get_pspec (expression));
+  sub = gtk_property_expression_get_expression (expression);
+  if (sub)
+    hash ^= expression_hash (sub) << 5;
+
+  return hash;
+}
+
+static gboolean
+expression_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  GtkExpression *ea = (GtkExpression *) a;
+  GtkExpression *eb = (GtkExpression *) b;
+  GtkExpression *suba, *subb;
+
+  if (ea == eb)
+    return TRUE;
+
+  if (!G_TYPE_CHECK_INSTANCE_TYPE (ea, GTK_TYPE_PROPERTY_EXPRESSION) ||
+      !G_TYPE_CHECK_INSTANCE_TYPE (eb, GTK_TYPE_PROPERTY_EXPRESSION) ||
+      gtk_property_expression_get_pspec (ea) != gtk_property_expression_get_pspec (eb))
+    return FALSE;
+
+  suba = gtk_property_expression_get_expression (ea);
+  subb = gtk_property_expression_get_expression (eb);
+  if (suba == NULL || subb == NULL)
+    return suba == subb;
+
+  return expression_equal (suba, subb);
+}
+
+static void
+gtk_string_key_uncache (gpointer data)
+{
+  GtkStringKey *self = data;
+
+  self->cache = NULL;
+  if (self->watch)
+    {
+      gtk_expression_watch_unwatch (self->watch);
+      g_clear_pointer (&self->watch, gtk_expression_watch_unref);
+    }
+
+  gtk_string_key_unref (self);
+}
+
+static void
+gtk_string_key_changed_cb (gpointer data)
+{
+  GtkStringKey *self = data;
+
+  if (self->cache)
+    g_hash_table_remove (self->cache->keys, self->item);
+}
+
+/**
+ * gtk_string_key_cache_get:
+ * @expression: the expression to evaluate
+ *
+ * Gets the cache for strings that @expression evaluates to.
+ *
+ * Returns: (transfer full): the cache
+ */
+GtkStringKeyCache *
+gtk_string_key_cache_get (GtkExpression *expression)
+{
+  GtkStringKeyCache *self;
+
+  g_return_val_if_fail (GTK_IS_EXPRESSION (expression), NULL);
+  g_return_val_if_fail (gtk_expression_get_value_type (expression) == G_TYPE_STRING, NULL);
+
+  if (caches == NULL)
+    caches = g_hash_table_new (expression_hash, expression_equal);
+
+  self = g_hash_table_lookup (caches, expression);
+  if (self)
+    return gtk_string_key_cache_ref (self);
+
+  self = g_slice_new (GtkStringKeyCache);
+  self->ref_count = 1;
+  self->expression = gtk_expression_ref (expression);
+  self->keys = g_hash_table_new_full (NULL, NULL, NULL, gtk_string_key_uncache);
+
+  g_hash_table_insert (caches, self->expression, self);
+
+  return self;
+}
+
+GtkStringKeyCache *
+gtk_string_key_cache_ref (GtkStringKeyCache *self)
+{
+  self->ref_count++;
+
+  return self;
+}
+
+void
+gtk_string_key_cache_unref (GtkStringKeyCache *self)
+{
+  self->ref_count--;
+  if (self->ref_count > 0)
+    return;
+
+  g_hash_table_remove (caches, self->expression);
+  g_hash_table_unref (self->keys);
+  gtk_expression_unref (self->expression);
+  g_slice_free (GtkStringKeyCache, self);
+}
+
+/**
+ * gtk_string_key_cache_lookup:
+ * @self: a #GtkStringKeyCache
+ * @item: (type GObject): the item to evaluate the expression for
+ *
+ * Gets the key for @item, evaluating the expression if it isn't cached.
+ *
+ * Returns: (transfer full): the key for @item
+ */
+GtkStringKey *
+gtk_string_key_cache_lookup (GtkStringKeyCache *self,
+                             gpointer           item)
+{
+  GValue value = G_VALUE_INIT;
+  GtkStringKey *key;
+
+  key = g_hash_table_lookup (self->keys, item);
+  if (key)
+    return gtk_string_key_ref (key);
+
+  key = g_slice_new0 (GtkStringKey);
+  key->ref_count = 1;
+
+  if (gtk_expression_evaluate (self->expression, item, &value))
+    {
+      key->string = g_value_dup_string (&value);
+      g_value_unset (&value);
+    }
+
+  if (g_hash_table_size (self->keys) < MAX_CACHED_KEYS)
+    {
+      key->cache = self;
+      key->item = item;
+      key->watch = gtk_expression_watch (self->expression, item, gtk_string_key_changed_cb, key, NULL);
+      /* the watch unwatches itself when the item is finalized */
+      gtk_expression_watch_ref (key->watch);
+      g_hash_table_insert (self->keys, item, gtk_string_key_ref (key));
+    }
+
+  return key;
+}
+
+GtkStringKey *
+gtk_string_key_ref (GtkStringKey *self)
+{
+  self->ref_count++;
+
+  return self;
+}
+
+void
+gtk_string_key_unref (GtkStringKey *self)
+{
+  guint i;
+
+  self->ref_count--;
+  if (self->ref_count > 0)
+    return;
+
+  g_assert (self->cache == NULL);
+
+  for (i = 0; i < GTK_STRING_KEY_N_KINDS; i++)
+    g_free (self->keys[i]);
+  g_free (self->string);
+  g_slice_free (GtkStringKey, self);
+}
+
+static char *
+gtk_string_key_compute (GtkStringKey     *self,
+                        GtkStringKeyKind  kind)
+{
+  char *tmp, *result;
+
+  switch (kind)
+    {
+    case GTK_STRING_KEY_NORMALIZED:
+      return g_utf8_normalize (self->string, -1, G_NORMALIZE_ALL);
+
+    case GTK_STRING_KEY_NORMALIZED_CASEFOLD:
+      tmp = (char *) gtk_string_key_get (self, GTK_STRING_KEY_NORMALIZED);
+      return tmp ? g_utf8_casefold (tmp, -1) : NULL;
+
+    case GTK_STRING_KEY_COLLATE:
+      return g_utf8_collate_key (self->string, -1);
+
+    case GTK_STRING_KEY_COLLATE_CASEFOLD:
+      tmp = g_utf8_casefold (self->string, -1);
+      result = g_utf8_collate_key (tmp, -1);
+      g_free (tmp);
+      return result;
+
+    case GTK_STRING_KEY_N_KINDS:
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
+
+/**
+ * gtk_string_key_get:
+ * @self: a #GtkStringKey
+ * @kind: the kind of key to get
+ *
+ * Gets the string processed according to @kind, computing it
+ * if needed. This function is threadsafe.
+ *
+ * Returns: (transfer none) (nullable): the key or %NULL if the
+ *     expression didn't evaluate to a string
+ */
+const char *
+gtk_string_key_get (GtkStringKey     *self,
+                    GtkStringKeyKind  kind)
+{
+  char *result;
+
+  result = g_atomic_pointer_get (&self->keys[kind]);
+  if (result != NULL || self->string == NULL)
+    return result;
+
+  result = gtk_string_key_compute (self, kind);
+  if (!g_atomic_pointer_compare_and_exchange (&self->keys[kind], NULL, result))
+    {
+      /* another thread was faster */
+      g_free (result);
+      result = g_atomic_pointer_get (&self->keys[kind]);
+    }
+
+  return result;
+}
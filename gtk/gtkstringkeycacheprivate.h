@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2020 Benjamin Otte
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_STRING_KEY_CACHE_PRIVATE_H__
+#define __GTK_STRING_KEY_CACHE_PRIVATE_H__
+
+#include <gtk/gtkexpression.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkStringKeyCache GtkStringKeyCache;
+typedef struct _GtkStringKey GtkStringKey;
+
+/* The different ways GtkStringSorter and GtkStringFilter process
+ * the string an expression evaluates to.
+ */
+typedef enum {
+  GTK_STRING_KEY_NORMALIZED,          /* g_utf8_normalize() */
+  GTK_STRING_KEY_NORMALIZED_CASEFOLD, /* g_utf8_casefold() of the above */
+  GTK_STRING_KEY_COLLATE,             /* g_utf8_collate_key() */
+  GTK_STRING_KEY_COLLATE_CASEFOLD,    /* g_utf8_collate_key() of g_utf8_casefold() */
+  GTK_STRING_KEY_N_KINDS
+} GtkStringKeyKind;
+
+GtkStringKeyCache *     gtk_string_key_cache_get                (GtkExpression          *expression);
+GtkStringKeyCache *     gtk_string_key_cache_ref                (GtkStringKeyCache      *self);
+void                    gtk_string_key_cache_unref              (GtkStringKeyCache      *self);
+
+GtkStringKey *          gtk_string_key_cache_lookup             (GtkStringKeyCache      *self,
+                                                                 gpointer                item);
+
+GtkStringKey *          gtk_string_key_ref                      (GtkStringKey           *self);
+void                    gtk_string_key_unref                    (GtkStringKey           *self);
+const char *            gtk_string_key_get                      (GtkStringKey           *self,
+                                                                 GtkStringKeyKind        kind);
+
+G_END_DECLS
+
+#endif /* __GTK_STRING_KEY_CACHE_PRIVATE_H__ */
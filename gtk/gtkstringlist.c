@@ -60,12 +60,38 @@
 
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
+/* Strings are kept in chunks of memory owned by the list until
+ * g_list_model_get_item() is called for them. Then they are wrapped
+ * in a GtkStringObject, which the list keeps.
+ * Strings in chunks start at even addresses, so items can tell
+ * them apart from objects.
+ */
+#define IS_STRING(item) (((gsize) (item)) & 0x1)
+#define TO_STRING(item) ((const char *) (((gsize) (item)) & ~(gsize) 0x1))
+#define FROM_STRING(str) ((gpointer) (((gsize) (str)) | 0x1))
+
+static void
+free_item (gpointer item)
+{
+  if (!IS_STRING (item))
+    g_object_unref (item);
+}
+
+#define GDK_ARRAY_ELEMENT_TYPE gpointer
+#define GDK_ARRAY_NAME items
+#define GDK_ARRAY_TYPE_NAME Items
+#define GDK_ARRAY_FREE_FUNC free_item
 #include "gdk/gdkarrayimpl.c"
 
+#define MIN_CHUNK_SIZE 4096
+
+typedef struct
+{
+  gsize size;
+  gsize used;
+  char data[0];
+} Chunk;
+
 struct _GtkStringObject
 {
   GObject parent_instance;
@@ -177,7 +203,11 @@ struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Items items;
+
+  GPtrArray *chunks; /* the last one is filled next */
+  gsize n_used_bytes; /* bytes handed out from chunks */
+  gsize n_dead_bytes; /* of those, bytes no item uses anymore */
 };
 
 struct _GtkStringListClass
@@ -196,7 +226,108 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return items_get_size (&self->items);
+}
+
+/* Strings are padded so the next one starts at an even address */
+static inline gsize
+string_size (gsize len)
+{
+  return (len + 2) & ~(gsize) 1;
+}
+
+static Chunk *
+gtk_string_list_add_chunk (GtkStringList *self,
+                           gsize          size)
+{
+  Chunk *chunk;
+
+  /* chunk->data is at an even offset */
+  chunk = g_malloc (sizeof (Chunk) + size);
+  chunk->size = size;
+  chunk->used = 0;
+  g_ptr_array_add (self->chunks, chunk);
+
+  return chunk;
+}
+
+static char *
+gtk_string_list_alloc_string (GtkStringList *self,
+                              gsize          size)
+{
+  Chunk *chunk;
+  char *result;
+
+  if (self->chunks->len > 0)
+    chunk = g_ptr_array_index (self->chunks, self->chunks->len - 1);
+  else
+    chunk = NULL;
+
+  if (chunk == NULL || chunk->size - chunk->used < size)
+    chunk = gtk_string_list_add_chunk (self, MAX (size, MAX (MIN_CHUNK_SIZE, self->n_used_bytes / 4)));
+
+  result = chunk->data + chunk->used;
+  chunk->used += size;
+  self->n_used_bytes += size;
+
+  return result;
+}
+
+/* Copies all strings into a single chunk once most chunk memory isn't
+ * used anymore.
+ */
+static void
+gtk_string_list_maybe_compact (GtkStringList *self)
+{
+  GPtrArray *old_chunks;
+  gsize i, n_bytes;
+
+  if (self->n_dead_bytes < MIN_CHUNK_SIZE ||
+      self->n_dead_bytes < self->n_used_bytes - self->n_dead_bytes)
+    return;
+
+  n_bytes = self->n_used_bytes - self->n_dead_bytes;
+  old_chunks = self->chunks;
+  self->chunks = g_ptr_array_new_with_free_func (g_free);
+  self->n_used_bytes = 0;
+  self->n_dead_bytes = 0;
+  if (n_bytes > 0)
+    gtk_string_list_add_chunk (self, n_bytes);
+
+  for (i = 0; i < items_get_size (&self->items); i++)
+    {
+      gpointer *item = items_index (&self->items, i);
+      const char *string;
+      gsize size;
+      char *copy;
+
+      if (!IS_STRING (*item))
+        continue;
+
+      string = TO_STRING (*item);
+      size = string_size (strlen (string));
+      copy = gtk_string_list_alloc_string (self, size);
+      memcpy (copy, string, size);
+      *item = FROM_STRING (copy);
+    }
+
+  g_ptr_array_unref (old_chunks);
+}
+
+static void
+gtk_string_list_release_string (GtkStringList *self,
+                                const char    *string)
+{
+  self->n_dead_bytes += string_size (strlen (string));
+}
+
+static const char *
+item_get_string (gpointer item)
+{
+  if (IS_STRING (item))
+    return TO_STRING (item);
+
+  return ((GtkStringObject *) item)->string;
 }
 
 static gpointer
@@ -204,11 +335,21 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  gpointer *item;
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  item = items_index (&self->items, position);
+  if (IS_STRING (*item))
+    {
+      const char *string = TO_STRING (*item);
+
+      *item = gtk_string_object_new (string);
+      gtk_string_list_release_string (self, string);
+    }
+
+  return g_object_ref (*item);
 }
 
 static void
@@ -395,23 +536,38 @@ gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
 
-  objects_clear (&self->items);
+  items_clear (&self->items);
+  g_ptr_array_set_size (self->chunks, 0);
+  self->n_used_bytes = 0;
+  self->n_dead_bytes = 0;
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_string_list_finalize (GObject *object)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  g_ptr_array_unref (self->chunks);
+
+  G_OBJECT_CLASS (gtk_string_list_parent_class)->finalize (object);
+}
+
 static void
 gtk_string_list_class_init (GtkStringListClass *class)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
 
   gobject_class->dispose = gtk_string_list_dispose;
+  gobject_class->finalize = gtk_string_list_finalize;
 }
 
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  items_init (&self->items);
+  self->chunks = g_ptr_array_new_with_free_func (g_free);
 }
 
 /**
@@ -448,7 +604,9 @@ gtk_string_list_new (const char * const *strings)
  * gtk_string_list_remove(), because it only emits
  * #GListModel::items-changed once for the change.
  *
- * This function copies the strings in @additions.
+ * This function copies the strings in @additions. The copies are
+ * kept in a single allocation and only wrapped in #GtkStringObjects
+ * once they are requested.
  *
  * The parameters @position and @n_removals must be correct (ie:
  * @position + @n_removals must be less than or equal to the length
@@ -461,23 +619,55 @@ gtk_string_list_splice (GtkStringList      *self,
                         const char * const *additions)
 {
   guint i, n_additions;
+  gsize *sizes, n_bytes;
+  char *strings;
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
+
+  for (i = position; i < position + n_removals; i++)
+    {
+      gpointer item = items_get (&self->items, i);
+
+      if (IS_STRING (item))
+        gtk_string_list_release_string (self, TO_STRING (item));
+    }
 
   if (additions)
     n_additions = g_strv_length ((char **) additions);
   else
     n_additions = 0;
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+  items_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
 
-  for (i = 0; i < n_additions; i++)
+  if (n_additions > 0)
     {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
+      sizes = g_newa (gsize, MIN (n_additions, 1024));
+      for (i = 0; i < n_additions; i += 1024)
+        {
+          guint j, n = MIN (n_additions - i, 1024);
+
+          n_bytes = 0;
+          for (j = 0; j < n; j++)
+            {
+              sizes[j] = string_size (strlen (additions[i + j]));
+              n_bytes += sizes[j];
+            }
+
+          strings = gtk_string_list_alloc_string (self, n_bytes);
+          for (j = 0; j < n; j++)
+            {
+              memcpy (strings, additions[i + j], sizes[j] - 1);
+              strings[sizes[j] - 1] = '\0';
+              *items_index (&self->items, position + i + j) = FROM_STRING (strings);
+              strings += sizes[j];
+            }
+        }
     }
 
+  gtk_string_list_maybe_compact (self);
+
   if (n_removals || n_additions)
     g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
 }
@@ -496,11 +686,18 @@ void
 gtk_string_list_append (GtkStringList *self,
                         const char    *string)
 {
+  gsize size;
+  char *copy;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  size = string_size (strlen (string));
+  copy = gtk_string_list_alloc_string (self, size);
+  memcpy (copy, string, size - 1);
+  copy[size - 1] = '\0';
+  items_append (&self->items, FROM_STRING (copy));
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -524,9 +721,9 @@ gtk_string_list_take (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  items_append (&self->items, gtk_string_object_new_take (string));
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -557,6 +754,8 @@ gtk_string_list_remove (GtkStringList *self,
  * This function returns the const char *. To get the
  * object wrapping it, use g_list_model_get_item().
  *
+ * The string is only valid until @self is changed.
+ *
  * Returns: (nullable): the string at the given position
  */
 const char *
@@ -565,8 +764,8 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return item_get_string (items_get (&self->items, position));
 }
@@ -23,6 +23,7 @@
 
 #include "gtkintl.h"
 #include "gtksorterprivate.h"
+#include "gtkstringkeycacheprivate.h"
 #include "gtktypebuiltins.h"
 
 /**
@@ -46,6 +47,7 @@ struct _GtkStringSorter
   gboolean ignore_case;
 
   GtkExpression *expression;
+  GtkStringKeyCache *cache; /* NULL if expression is NULL */
 };
 
 enum {
@@ -59,37 +61,10 @@ G_DEFINE_TYPE (GtkStringSorter, gtk_string_sorter, GTK_TYPE_SORTER)
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
-static char *
-gtk_string_sorter_get_key (GtkExpression *expression,
-                           gboolean       ignore_case,
-                           gpointer       item1)
+static GtkStringKeyKind
+gtk_string_sorter_get_key_kind (gboolean ignore_case)
 {
-  GValue value = G_VALUE_INIT;
-  char *s;
-
-  if (expression == NULL)
-    return NULL;
-
-  if (!gtk_expression_evaluate (expression, item1, &value))
-    return NULL;
-
-  /* If strings are NULL, order them before "". */
-  if (ignore_case)
-    {
-      char *t;
-
-      t = g_utf8_casefold (g_value_get_string (&value), -1);
-      s = g_utf8_collate_key (t, -1);
-      g_free (t);
-    }
-  else
-    {
-      s = g_utf8_collate_key (g_value_get_string (&value), -1);
-    }
-
-  g_value_unset (&value);
-
-  return s;
+  return ignore_case ? GTK_STRING_KEY_COLLATE_CASEFOLD : GTK_STRING_KEY_COLLATE;
 }
 
 static GtkOrdering
@@ -98,19 +73,23 @@ gtk_string_sorter_compare (GtkSorter *sorter,
                            gpointer   item2)
 {
   GtkStringSorter *self = GTK_STRING_SORTER (sorter);
-  char *s1, *s2;
+  GtkStringKeyKind kind;
+  GtkStringKey *k1, *k2;
   GtkOrdering result;
 
-  if (self->expression == NULL)
+  if (self->cache == NULL)
     return GTK_ORDERING_EQUAL;
 
-  s1 = gtk_string_sorter_get_key (self->expression, self->ignore_case, item1);
-  s2 = gtk_string_sorter_get_key (self->expression, self->ignore_case, item2);
+  kind = gtk_string_sorter_get_key_kind (self->ignore_case);
+  k1 = gtk_string_key_cache_lookup (self->cache, item1);
+  k2 = gtk_string_key_cache_lookup (self->cache, item2);
 
-  result = gtk_ordering_from_cmpfunc (g_strcmp0 (s1, s2));
+  /* If strings are NULL, order them before "". */
+  result = gtk_ordering_from_cmpfunc (g_strcmp0 (gtk_string_key_get (k1, kind),
+                                                 gtk_string_key_get (k2, kind)));
 
-  g_free (s1);
-  g_free (s2);
+  gtk_string_key_unref (k1);
+  gtk_string_key_unref (k2);
 
   return result;
 }
@@ -131,16 +110,24 @@ struct _GtkStringSortKeys
 {
   GtkSortKeys keys;
 
-  GtkExpression *expression;
-  gboolean ignore_case;
+  GtkStringKeyCache *cache;
+  GtkStringKeyKind kind;
 };
 
+/* The collated string is kept next to the key it belongs to,
+ * so comparing doesn't need to look at the key.
+ */
+typedef struct {
+  GtkStringKey *key;
+  const char *collated;
+} GtkStringSortKey;
+
 static void
 gtk_string_sort_keys_free (GtkSortKeys *keys)
 {
   GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
 
-  gtk_expression_unref (self->expression);
+  gtk_string_key_cache_unref (self->cache);
   g_slice_free (GtkStringSortKeys, self);
 }
 
@@ -149,8 +136,8 @@ gtk_string_sort_keys_compare (gconstpointer a,
                               gconstpointer b,
                               gpointer      unused)
 {
-  const char *sa = *(const char **) a;
-  const char *sb = *(const char **) b;
+  const char *sa = ((const GtkStringSortKey *) a)->collated;
+  const char *sb = ((const GtkStringSortKey *) b)->collated;
 
   if (sa == NULL)
     return sb == NULL ? GTK_ORDERING_EQUAL : GTK_ORDERING_LARGER;
@@ -164,27 +151,50 @@ static gboolean
 gtk_string_sort_keys_is_compatible (GtkSortKeys *keys,
                                     GtkSortKeys *other)
 {
-  return FALSE;
+  GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
+  GtkStringSortKeys *compare = (GtkStringSortKeys *) other;
+
+  if (keys->klass != other->klass)
+    return FALSE;
+
+  return self->cache == compare->cache &&
+         self->kind == compare->kind;
 }
 
+/* Looking up the key has to happen in the main thread, the
+ * collation in finish_key(), which is where most of the time
+ * is spent, doesn't. Keys that were collated before are shared
+ * with other string sorters and don't need to be collated again.
+ */
 static void
 gtk_string_sort_keys_init_key (GtkSortKeys *keys,
                                gpointer     item,
                                gpointer     key_memory)
 {
   GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
-  char **key = (char **) key_memory;
+  GtkStringSortKey *key = key_memory;
 
-  *key = gtk_string_sorter_get_key (self->expression, self->ignore_case, item);
+  key->key = gtk_string_key_cache_lookup (self->cache, item);
+  key->collated = NULL;
+}
+
+static void
+gtk_string_sort_keys_finish_key (GtkSortKeys *keys,
+                                 gpointer     key_memory)
+{
+  GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
+  GtkStringSortKey *key = key_memory;
+
+  key->collated = gtk_string_key_get (key->key, self->kind);
 }
 
 static void
 gtk_string_sort_keys_clear_key (GtkSortKeys *keys,
                                 gpointer     key_memory)
 {
-  char **key = (char **) key_memory;
+  GtkStringSortKey *key = key_memory;
 
-  g_free (*key);
+  gtk_string_key_unref (key->key);
 }
 
 static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
@@ -194,6 +204,7 @@ static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
   gtk_string_sort_keys_is_compatible,
   gtk_string_sort_keys_init_key,
   gtk_string_sort_keys_clear_key,
+  gtk_string_sort_keys_finish_key,
 };
 
 static GtkSortKeys *
@@ -201,16 +212,16 @@ gtk_string_sort_keys_new (GtkStringSorter *self)
 {
   GtkStringSortKeys *result;
 
-  if (self->expression == NULL)
+  if (self->cache == NULL)
     return gtk_sort_keys_new_equal ();
 
   result = gtk_sort_keys_new (GtkStringSortKeys,
                               &GTK_STRING_SORT_KEYS_CLASS,
-                              sizeof (char *),
-                              sizeof (char *));
+                              sizeof (GtkStringSortKey),
+                              sizeof (gpointer));
 
-  result->expression = gtk_expression_ref (self->expression);
-  result->ignore_case = self->ignore_case;
+  result->cache = gtk_string_key_cache_ref (self->cache);
+  result->kind = gtk_string_sorter_get_key_kind (self->ignore_case);
 
   return (GtkSortKeys *) result;
 }
@@ -269,6 +280,7 @@ gtk_string_sorter_dispose (GObject *object)
   GtkStringSorter *self = GTK_STRING_SORTER (object);
 
   g_clear_pointer (&self->expression, gtk_expression_unref);
+  g_clear_pointer (&self->cache, gtk_string_key_cache_unref);
 
   G_OBJECT_CLASS (gtk_string_sorter_parent_class)->dispose (object);
 }
@@ -385,8 +397,12 @@ gtk_string_sorter_set_expression (GtkStringSorter *self,
     return;
 
   g_clear_pointer (&self->expression, gtk_expression_unref);
+  g_clear_pointer (&self->cache, gtk_string_key_cache_unref);
   if (expression)
-    self->expression = gtk_expression_ref (expression);
+    {
+      self->expression = gtk_expression_ref (expression);
+      self->cache = gtk_string_key_cache_get (expression);
+    }
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_DIFFERENT,
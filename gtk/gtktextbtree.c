@@ -67,6 +67,7 @@
 #include "gtktextmarkprivate.h"
 #include "gtktextsegment.h"
 #include "gtkpango.h"
+#include "gtkbitmaskprivate.h"
 #include "gdk-private.h"
 
 /*
@@ -143,6 +144,8 @@ struct _GtkTextBTreeNode {
   Summary *summary;             /* First in malloc-ed list of info
                                  * about tags in this subtree (NULL if
                                  * no tag info in the subtree). */
+  GtkBitmask *tag_mask;         /* Bit info->index is set for each tag
+                                 * that has a Summary in the list above. */
   int level;                            /* Level of this node in the B-tree.
                                          * 0 refers to the bottom of the tree
                                          * (children are lines, not nodes). */
@@ -170,6 +173,14 @@ struct _BTreeView {
   GtkTextLayout *layout;
   BTreeView *next;
   BTreeView *prev;
+
+  /* Model for the height of lines that were never validated,
+   * learned from the lines that were, for this screen width.
+   */
+  int estimate_width;
+  int row_height;
+  guint64 wrapped_height;
+  guint64 wrapped_chars;
 };
 
 /*
@@ -186,6 +197,8 @@ struct _GtkTextBTree {
   GtkTextBuffer *buffer;
   BTreeView *views;
   GSList *tag_infos;
+  GHashTable *tag_info_table;   /* GtkTextTag -> GtkTextTagInfo */
+  GtkBitmask *tag_indices;      /* GtkTextTagInfo indices in use */
   gulong tag_changed_handler;
 
   /* Incremented when a segment with a byte size > 0
@@ -263,7 +276,7 @@ static void              gtk_text_btree_node_adjust_toggle_count (GtkTextBTreeNo
                                                                   GtkTextTagInfo   *info,
                                                                   int               adjust);
 static gboolean          gtk_text_btree_node_has_tag             (GtkTextBTreeNode *node,
-                                                                  GtkTextTag       *tag);
+                                                                  GtkTextTagInfo   *info);
 
 static void             segments_changed                (GtkTextBTree     *tree);
 static void             chars_changed                   (GtkTextBTree     *tree);
@@ -295,6 +308,12 @@ static NodeData *            gtk_text_btree_node_check_valid_downward (GtkTextBT
                                                                        gpointer          view_id);
 static void                  gtk_text_btree_node_check_valid_upward   (GtkTextBTreeNode *node,
                                                                        gpointer          view_id);
+static void                  gtk_text_btree_estimate_lines            (GtkTextBTree     *tree,
+                                                                       GtkTextLine      *first,
+                                                                       GtkTextLine      *last);
+static void                  gtk_text_btree_view_learn_height         (BTreeView        *view,
+                                                                       GtkTextLine      *line,
+                                                                       GtkTextLineData  *ld);
 
 static void                  gtk_text_btree_node_remove_view         (BTreeView        *view,
                                                                       GtkTextBTreeNode *node,
@@ -325,7 +344,11 @@ static void inc_count             (GtkTextTag       *tag,
                                    int               inc,
                                    TagInfo          *tagInfoPtr);
 
-static void summary_destroy       (Summary          *summary);
+static Summary *summary_new       (GtkTextBTreeNode *node,
+                                   GtkTextTagInfo   *info,
+                                   int               toggle_count);
+static void summary_destroy       (GtkTextBTreeNode *node,
+                                   Summary          *summary);
 
 static void gtk_text_btree_link_segment   (GtkTextLineSegment *seg,
                                            const GtkTextIter  *iter);
@@ -439,6 +462,9 @@ _gtk_text_btree_new (GtkTextTagTable *table,
 
   tree->mark_table = g_hash_table_new (g_str_hash, g_str_equal);
   tree->child_anchor_table = NULL;
+
+  tree->tag_info_table = g_hash_table_new (NULL, NULL);
+  tree->tag_indices = _gtk_bitmask_new ();
   
   /* We don't ref the buffer, since the buffer owns us;
    * we'd have some circularity issues. The buffer always
@@ -516,6 +542,11 @@ _gtk_text_btree_unref (GtkTextBTree *tree)
       g_assert (g_hash_table_size (tree->mark_table) == 0);
       g_hash_table_destroy (tree->mark_table);
       tree->mark_table = NULL;
+
+      g_hash_table_destroy (tree->tag_info_table);
+      tree->tag_info_table = NULL;
+      _gtk_bitmask_free (tree->tag_indices);
+      tree->tag_indices = NULL;
       if (tree->child_anchor_table != NULL) 
 	{
 	  g_hash_table_destroy (tree->child_anchor_table);
@@ -1227,8 +1258,23 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       cleanup_line (line);
     }
 
+  if (line != start_line)
+    gtk_text_btree_estimate_lines (tree, start_line->next, line->next);
+
   post_insert_fixup (tree, line, line_count_delta, char_count_delta);
 
+  if (line != start_line)
+    {
+      BTreeView *view;
+
+      for (view = tree->views; view; view = view->next)
+        {
+          gtk_text_btree_node_check_valid_upward (start_line->parent, view->view_id);
+          if (line->parent != start_line->parent)
+            gtk_text_btree_node_check_valid_upward (line->parent, view->view_id);
+        }
+    }
+
   /* Invalidate our region, and reset the iterator the user
      passed in to point to the end of the inserted text. */
   {
@@ -1559,6 +1605,10 @@ _gtk_text_btree_add_view (GtkTextBTree *tree,
 
   view->view_id = layout;
   view->layout = layout;
+  view->estimate_width = layout->screen_width;
+  view->row_height = 0;
+  view->wrapped_height = 0;
+  view->wrapped_chars = 0;
 
   view->next = tree->views;
   view->prev = NULL;
@@ -1764,12 +1814,14 @@ queue_tag_redisplay (GtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
-void
-_gtk_text_btree_tag (const GtkTextIter *start_orig,
-                     const GtkTextIter *end_orig,
-                     GtkTextTag        *tag,
-                     gboolean           add)
+static void
+tag_range (GtkTextBTree      *tree,
+           GtkTextTagInfo    *info,
+           const GtkTextIter *range_start,
+           const GtkTextIter *range_end,
+           gboolean           add)
 {
+  GtkTextTag *tag = info->tag;
   GtkTextLineSegment *seg, *prev;
   GtkTextLine *cleanupline;
   gboolean toggled_on;
@@ -1777,38 +1829,10 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
   GtkTextLine *end_line;
   GtkTextIter iter;
   GtkTextIter start, end;
-  GtkTextBTree *tree;
   IterStack *stack;
-  GtkTextTagInfo *info;
-
-  g_return_if_fail (start_orig != NULL);
-  g_return_if_fail (end_orig != NULL);
-  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
-  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
-                    _gtk_text_iter_get_btree (end_orig));
-  g_return_if_fail (tag->priv->table == _gtk_text_iter_get_btree (start_orig)->table);
-  
-#if 0
-  printf ("%s tag %s from %d to %d\n",
-          add ? "Adding" : "Removing",
-          tag->name,
-          gtk_text_buffer_get_offset (start_orig),
-          gtk_text_buffer_get_offset (end_orig));
-#endif
 
-  if (gtk_text_iter_equal (start_orig, end_orig))
-    return;
-
-  start = *start_orig;
-  end = *end_orig;
-
-  gtk_text_iter_order (&start, &end);
-
-  tree = _gtk_text_iter_get_btree (&start);
-
-  queue_tag_redisplay (tree, tag, &start, &end);
-
-  info = gtk_text_btree_get_tag_info (tree, tag);
+  start = *range_start;
+  end = *range_end;
 
   start_line = _gtk_text_iter_get_text_line (&start);
   end_line = _gtk_text_iter_get_text_line (&end);
@@ -2014,6 +2038,48 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
     }
 
   segments_changed (tree);
+}
+
+void
+_gtk_text_btree_tag (const GtkTextIter *start_orig,
+                     const GtkTextIter *end_orig,
+                     GtkTextTag        *tag,
+                     gboolean           add)
+{
+  GtkTextIter start, end;
+  GtkTextBTree *tree;
+  GtkTextTagInfo *info;
+
+  g_return_if_fail (start_orig != NULL);
+  g_return_if_fail (end_orig != NULL);
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
+                    _gtk_text_iter_get_btree (end_orig));
+  g_return_if_fail (tag->priv->table == _gtk_text_iter_get_btree (start_orig)->table);
+  
+#if 0
+  printf ("%s tag %s from %d to %d\n",
+          add ? "Adding" : "Removing",
+          tag->name,
+          gtk_text_buffer_get_offset (start_orig),
+          gtk_text_buffer_get_offset (end_orig));
+#endif
+
+  if (gtk_text_iter_equal (start_orig, end_orig))
+    return;
+
+  start = *start_orig;
+  end = *end_orig;
+
+  gtk_text_iter_order (&start, &end);
+
+  tree = _gtk_text_iter_get_btree (&start);
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  tag_range (tree, info, &start, &end, add);
 
   queue_tag_redisplay (tree, tag, &start, &end);
 
@@ -2023,6 +2089,114 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
 #endif
 }
 
+static int
+compare_ranges (gconstpointer a,
+                gconstpointer b)
+{
+  const int *ra = a;
+  const int *rb = b;
+
+  if (ra[0] != rb[0])
+    return ra[0] < rb[0] ? -1 : 1;
+
+  return 0;
+}
+
+/* Adds or removes @tag on @n_ranges ranges of character offsets,
+ * given as start and end pairs in @ranges. The ranges are sorted
+ * and merged, then tagged in one forward walk over the buffer, and
+ * the views are invalidated once for the whole span.
+ */
+void
+_gtk_text_btree_tag_ranges (GtkTextBTree *tree,
+                            GtkTextTag   *tag,
+                            const int    *ranges,
+                            guint         n_ranges,
+                            gboolean      add)
+{
+  GtkTextTagInfo *info;
+  GtkTextIter first, start, end;
+  int *sorted;
+  guint i, n;
+  int char_count;
+  int offset;
+
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (tag->priv->table == tree->table);
+
+  char_count = _gtk_text_btree_char_count (tree);
+
+  sorted = g_new (int, 2 * n_ranges);
+  n = 0;
+  for (i = 0; i < n_ranges; i++)
+    {
+      int s = CLAMP (ranges[2 * i], 0, char_count);
+      int e = CLAMP (ranges[2 * i + 1], 0, char_count);
+
+      if (s == e)
+        continue;
+
+      sorted[2 * n] = MIN (s, e);
+      sorted[2 * n + 1] = MAX (s, e);
+      n++;
+    }
+
+  if (n == 0)
+    {
+      g_free (sorted);
+      return;
+    }
+
+  qsort (sorted, n, 2 * sizeof (int), compare_ranges);
+
+  /* Merge overlapping and adjacent ranges */
+  n_ranges = n;
+  n = 1;
+  for (i = 1; i < n_ranges; i++)
+    {
+      if (sorted[2 * i] <= sorted[2 * (n - 1) + 1])
+        {
+          sorted[2 * (n - 1) + 1] = MAX (sorted[2 * (n - 1) + 1], sorted[2 * i + 1]);
+        }
+      else
+        {
+          sorted[2 * n] = sorted[2 * i];
+          sorted[2 * n + 1] = sorted[2 * i + 1];
+          n++;
+        }
+    }
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  /* Tagging doesn't change character offsets, so the iterator can
+   * keep moving forward from the end of the previous range instead
+   * of being looked up from the root each time.
+   */
+  _gtk_text_btree_get_iter_at_char (tree, &first, sorted[0]);
+  end = first;
+  offset = sorted[0];
+  for (i = 0; i < n; i++)
+    {
+      start = end;
+      gtk_text_iter_forward_chars (&start, sorted[2 * i] - offset);
+      end = start;
+      gtk_text_iter_forward_chars (&end, sorted[2 * i + 1] - sorted[2 * i]);
+      offset = sorted[2 * i + 1];
+
+      tag_range (tree, info, &start, &end, add);
+    }
+
+  queue_tag_redisplay (tree, tag, &first, &end);
+
+  g_free (sorted);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TEXT))
+    _gtk_text_btree_check (tree);
+#endif
+}
+
 
 /*
  * "Getters"
@@ -2921,7 +3095,14 @@ _gtk_text_btree_select_range (GtkTextBTree      *tree,
   if (!gtk_text_iter_equal (&old_ins, ins) ||
       !gtk_text_iter_equal (&old_bound, bound))
     {
-      redisplay_region (tree, &old_ins, &old_bound, TRUE);
+      GtkTextIter old_start, old_end, new_start, new_end;
+
+      old_start = old_ins;
+      old_end = old_bound;
+      gtk_text_iter_order (&old_start, &old_end);
+      new_start = *ins;
+      new_end = *bound;
+      gtk_text_iter_order (&new_start, &new_end);
 
       /* Move insert AND selection_bound before we redisplay */
       real_set_mark (tree, tree->insert_mark,
@@ -2929,7 +3110,13 @@ _gtk_text_btree_select_range (GtkTextBTree      *tree,
       real_set_mark (tree, tree->selection_bound_mark,
 		     "selection_bound", FALSE, bound, TRUE, FALSE);
 
-      redisplay_region (tree, ins, bound, TRUE);
+      /* Only the lines between the old and the new ends of the
+       * selection change, so that extending a large selection
+       * doesn't redraw all of it. This includes both positions
+       * of the cursor, as it sits on one of the ends.
+       */
+      redisplay_region (tree, &old_start, &new_start, TRUE);
+      redisplay_region (tree, &old_end, &new_end, TRUE);
     }
 }
 
@@ -3094,7 +3281,7 @@ _gtk_text_btree_first_could_contain_tag (GtkTextBTree *tree,
           node = node->children.node;
           while (node != NULL)
             {
-              if (gtk_text_btree_node_has_tag (node, tag))
+              if (gtk_text_btree_node_has_tag (node, info))
                 goto continue_outer_loop;
 
               node = node->next;
@@ -3147,7 +3334,7 @@ _gtk_text_btree_last_could_contain_tag (GtkTextBTree *tree,
           node = node->children.node;
           while (node != NULL)
             {
-              if (gtk_text_btree_node_has_tag (node, tag))
+              if (gtk_text_btree_node_has_tag (node, info))
                 last_node = node;
               node = node->next;
             }
@@ -3341,11 +3528,16 @@ find_toggle_outside_current_line (GtkTextLine *line,
         {
           Summary *summary;
 
-          summary = sibling_node->summary;
+          summary = NULL;
+          if (gtk_text_btree_node_has_tag (sibling_node, info))
+            summary = sibling_node->summary;
           while (summary != NULL)
             {
               if (summary->info == info)
-                toggles += summary->toggle_count;
+                {
+                  toggles += summary->toggle_count;
+                  break;
+                }
 
               summary = summary->next;
             }
@@ -4425,7 +4617,7 @@ _gtk_text_line_next_could_contain_tag (GtkTextLine  *line,
             {
               node = node->next;
 
-              if (gtk_text_btree_node_has_tag (node, tag))
+              if (gtk_text_btree_node_has_tag (node, info))
                 goto found;
             }
         }
@@ -4467,7 +4659,7 @@ _gtk_text_line_next_could_contain_tag (GtkTextLine  *line,
       node = node->children.node;
       while (node != NULL)
         {
-          if (gtk_text_btree_node_has_tag (node, tag))
+          if (gtk_text_btree_node_has_tag (node, info))
             break;
           node = node->next;
         }
@@ -4608,7 +4800,7 @@ _gtk_text_line_previous_could_contain_tag (GtkTextLine  *line,
 
               g_assert (this_node != line_ancestor);
 
-              if (gtk_text_btree_node_has_tag (this_node, tag))
+              if (gtk_text_btree_node_has_tag (this_node, info))
                 {
                   found_node = this_node;
                   g_slist_free (child_nodes);
@@ -4683,7 +4875,7 @@ _gtk_text_line_previous_could_contain_tag (GtkTextLine  *line,
       iter = child_nodes;
       while (iter != NULL)
         {
-          if (gtk_text_btree_node_has_tag (iter->data, tag))
+          if (gtk_text_btree_node_has_tag (iter->data, info))
             {
               /* recurse into this node. */
               node = iter->data;
@@ -4881,9 +5073,31 @@ node_data_find (NodeData *nd,
   return nd;
 }
 
+static Summary *
+summary_new (GtkTextBTreeNode *node,
+             GtkTextTagInfo   *info,
+             int               toggle_count)
+{
+  Summary *summary;
+
+  summary = g_slice_new (Summary);
+  summary->info = info;
+  summary->toggle_count = toggle_count;
+  summary->next = node->summary;
+  node->summary = summary;
+
+  node->tag_mask = _gtk_bitmask_set (node->tag_mask, info->index, TRUE);
+
+  return summary;
+}
+
+/* The caller must unlink @summary from the list of @node */
 static void
-summary_destroy (Summary *summary)
+summary_destroy (GtkTextBTreeNode *node,
+                 Summary          *summary)
 {
+  node->tag_mask = _gtk_bitmask_set (node->tag_mask, summary->info->index, FALSE);
+
   /* Fill with error-triggering garbage */
   summary->info = (void*)0x1;
   summary->toggle_count = 567;
@@ -4899,6 +5113,7 @@ gtk_text_btree_node_new (void)
   node = g_slice_new (GtkTextBTreeNode);
 
   node->node_data = NULL;
+  node->tag_mask = _gtk_bitmask_new ();
 
   return node;
 }
@@ -4910,49 +5125,35 @@ gtk_text_btree_node_adjust_toggle_count (GtkTextBTreeNode  *node,
 {
   Summary *summary;
 
-  summary = node->summary;
-  while (summary != NULL)
+  if (gtk_text_btree_node_has_tag (node, info))
     {
-      if (summary->info == info)
+      for (summary = node->summary; summary != NULL; summary = summary->next)
         {
-          summary->toggle_count += adjust;
-          break;
+          if (summary->info == info)
+            {
+              summary->toggle_count += adjust;
+              return;
+            }
         }
 
-      summary = summary->next;
+      g_assert_not_reached ();
     }
 
-  if (summary == NULL)
-    {
-      /* didn't find a summary for our tag. */
-      g_return_if_fail (adjust > 0);
-      summary = g_slice_new (Summary);
-      summary->info = info;
-      summary->toggle_count = adjust;
-      summary->next = node->summary;
-      node->summary = summary;
-    }
+  /* didn't find a summary for our tag. */
+  g_return_if_fail (adjust > 0);
+  summary_new (node, info, adjust);
 }
 
 /* Note that the tag root and above do not have summaries
    for the tag; only nodes below the tag root have
-   the summaries. */
+   the summaries. A NULL @info matches any tag. */
 static gboolean
-gtk_text_btree_node_has_tag (GtkTextBTreeNode *node, GtkTextTag *tag)
+gtk_text_btree_node_has_tag (GtkTextBTreeNode *node, GtkTextTagInfo *info)
 {
-  Summary *summary;
-
-  summary = node->summary;
-  while (summary != NULL)
-    {
-      if (tag == NULL ||
-          summary->info->tag == tag)
-        return TRUE;
-
-      summary = summary->next;
-    }
+  if (info == NULL)
+    return node->summary != NULL;
 
-  return FALSE;
+  return _gtk_bitmask_get (node->tag_mask, info->index);
 }
 
 /* Add node and all children to the damage region. */
@@ -5059,6 +5260,103 @@ gtk_text_btree_node_invalidate_upward (GtkTextBTreeNode *node, gpointer view_id)
  *
  * Returns: %TRUE if the entire #GtkTextBTree is valid
  **/
+/* Until a line is validated, we don't know its height. Lines that
+ * never had any get an estimate from the lines of the view that were
+ * validated, so that the totals in the node data, and with them the
+ * scrollbars, are about right before the whole buffer is validated.
+ *
+ * A line is assumed to be at least one row high, and to grow with its
+ * length like the lines that wrapped did.
+ */
+static void
+gtk_text_btree_view_check_estimate_width (BTreeView *view)
+{
+  if (view->estimate_width == view->layout->screen_width)
+    return;
+
+  view->estimate_width = view->layout->screen_width;
+  view->row_height = 0;
+  view->wrapped_height = 0;
+  view->wrapped_chars = 0;
+}
+
+static void
+gtk_text_btree_view_learn_height (BTreeView       *view,
+                                  GtkTextLine     *line,
+                                  GtkTextLineData *ld)
+{
+  int char_count;
+
+  if (ld->height <= 0)
+    return;
+
+  gtk_text_btree_view_check_estimate_width (view);
+
+  if (view->row_height == 0 || ld->height < view->row_height)
+    {
+      view->row_height = ld->height;
+    }
+  else if (ld->height > view->row_height)
+    {
+      char_count = _gtk_text_line_char_count (line);
+      if (char_count > 0)
+        {
+          view->wrapped_height += ld->height;
+          view->wrapped_chars += char_count;
+        }
+    }
+}
+
+static int
+gtk_text_btree_view_estimate_height (BTreeView   *view,
+                                     GtkTextLine *line)
+{
+  int height;
+
+  gtk_text_btree_view_check_estimate_width (view);
+
+  height = view->row_height;
+
+  if (height > 0 && view->wrapped_chars > 0)
+    {
+      guint64 wrapped = _gtk_text_line_char_count (line) * view->wrapped_height / view->wrapped_chars;
+
+      height = MAX (height, (int) MIN (wrapped, G_MAXINT / 2));
+    }
+
+  return height;
+}
+
+/* Gives lines from @first up to @last that have no data for a view
+ * estimated, invalid data. The node data still needs updating.
+ */
+static void
+gtk_text_btree_estimate_lines (GtkTextBTree *tree,
+                               GtkTextLine  *first,
+                               GtkTextLine  *last)
+{
+  BTreeView *view;
+  GtkTextLine *line;
+
+  for (view = tree->views; view; view = view->next)
+    {
+      if (view->row_height == 0)
+        continue;
+
+      for (line = first; line != last; line = line->next)
+        {
+          GtkTextLineData *ld;
+
+          if (_gtk_text_line_get_data (line, view->view_id))
+            continue;
+
+          ld = _gtk_text_line_data_new (view->layout, line);
+          ld->height = gtk_text_btree_view_estimate_height (view, line);
+          _gtk_text_line_add_data (line, ld);
+        }
+    }
+}
+
 gboolean
 _gtk_text_btree_is_valid (GtkTextBTree *tree,
                          gpointer      view_id)
@@ -5135,6 +5433,7 @@ gtk_text_btree_node_validate (BTreeView         *view,
               if (ld)
                 state->old_height += ld->height;
               ld = gtk_text_layout_wrap (view->layout, line, ld);
+              gtk_text_btree_view_learn_height (view, line, ld);
               state->new_height += ld->height;
 
               node_width = MAX (ld->width, node_width);
@@ -5460,11 +5759,65 @@ _gtk_text_btree_validate_line (GtkTextBTree     *tree,
   if (!ld || !ld->valid)
     {
       ld = gtk_text_layout_wrap (view->layout, line, ld);
-      
+      gtk_text_btree_view_learn_height (view, line, ld);
+
       gtk_text_btree_node_check_valid_upward (line->parent, view_id);
     }
 }
 
+/**
+ * _gtk_text_btree_get_first_invalid_line:
+ * @tree: a #GtkTextBTree
+ * @view_id: view ID for the view
+ *
+ * Finds the line that _gtk_text_btree_validate() would validate first.
+ *
+ * Returns: (nullable): the first line that is not valid for the view,
+ *   or %NULL if the entire tree is valid
+ **/
+GtkTextLine *
+_gtk_text_btree_get_first_invalid_line (GtkTextBTree *tree,
+                                        gpointer      view_id)
+{
+  GtkTextBTreeNode *node;
+  GtkTextLine *line;
+  GtkTextLineData *ld;
+
+  g_return_val_if_fail (tree != NULL, NULL);
+
+  if (_gtk_text_btree_is_valid (tree, view_id))
+    return NULL;
+
+  node = tree->root_node;
+  while (node->level > 0)
+    {
+      GtkTextBTreeNode *child;
+
+      for (child = node->children.node; child; child = child->next)
+        {
+          NodeData *nd = node_data_find (child->node_data, view_id);
+
+          if (!nd || !nd->valid)
+            break;
+        }
+
+      if (child == NULL)
+        return NULL;
+
+      node = child;
+    }
+
+  for (line = node->children.line; line; line = line->next)
+    {
+      ld = _gtk_text_line_get_data (line, view_id);
+
+      if (!ld || !ld->valid)
+        return line;
+    }
+
+  return NULL;
+}
+
 static void
 gtk_text_btree_node_remove_view (BTreeView *view, GtkTextBTreeNode *node, gpointer view_id)
 {
@@ -5548,6 +5901,7 @@ gtk_text_btree_node_free_empty (GtkTextBTree *tree,
                     (node->level == 0 && node->children.line == NULL));
 
   summary_list_destroy (node->summary);
+  _gtk_bitmask_free (node->tag_mask);
   node_data_list_destroy (node->node_data);
   g_slice_free (GtkTextBTreeNode, node);
 }
@@ -6019,21 +6373,7 @@ static GtkTextTagInfo*
 gtk_text_btree_get_existing_tag_info (GtkTextBTree *tree,
                                       GtkTextTag   *tag)
 {
-  GtkTextTagInfo *info;
-  GSList *list;
-
-
-  list = tree->tag_infos;
-  while (list != NULL)
-    {
-      info = list->data;
-      if (info->tag == tag)
-        return info;
-
-      list = list->next;
-    }
-
-  return NULL;
+  return g_hash_table_lookup (tree->tag_info_table, tag);
 }
 
 static GtkTextTagInfo*
@@ -6055,7 +6395,14 @@ gtk_text_btree_get_tag_info (GtkTextBTree *tree,
       info->tag_root = NULL;
       info->toggle_count = 0;
 
+      /* Reuse the lowest free index, to keep the node masks small */
+      info->index = 0;
+      while (_gtk_bitmask_get (tree->tag_indices, info->index))
+        info->index++;
+      tree->tag_indices = _gtk_bitmask_set (tree->tag_indices, info->index, TRUE);
+
       tree->tag_infos = g_slist_prepend (tree->tag_infos, info);
+      g_hash_table_insert (tree->tag_info_table, tag, info);
     }
 
   return info;
@@ -6087,6 +6434,9 @@ gtk_text_btree_remove_tag_info (GtkTextBTree *tree,
           list->next = NULL;
           g_slist_free (list);
 
+          g_hash_table_remove (tree->tag_info_table, tag);
+          tree->tag_indices = _gtk_bitmask_set (tree->tag_indices, info->index, FALSE);
+
           g_object_unref (info->tag);
 
           g_slice_free (GtkTextTagInfo, info);
@@ -6276,13 +6626,13 @@ recompute_node_counts (GtkTextBTree *tree, GtkTextBTreeNode *node)
       if (summary2 != NULL)
         {
           summary2->next = summary->next;
-          summary_destroy (summary);
+          summary_destroy (node, summary);
           summary = summary2->next;
         }
       else
         {
           node->summary = summary->next;
-          summary_destroy (summary);
+          summary_destroy (node, summary);
           summary = node->summary;
         }
     }
@@ -6325,13 +6675,18 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
        * perhaps all we have to do is adjust its count.
        */
 
-      for (prevPtr = NULL, summary = node->summary;
-           summary != NULL;
-           prevPtr = summary, summary = summary->next)
+      prevPtr = NULL;
+      summary = NULL;
+      if (gtk_text_btree_node_has_tag (node, info))
         {
-          if (summary->info == info)
+          for (summary = node->summary;
+               summary != NULL;
+               prevPtr = summary, summary = summary->next)
             {
-              break;
+              if (summary->info == info)
+                {
+                  break;
+                }
             }
         }
       if (summary != NULL)
@@ -6366,7 +6721,7 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
             {
               prevPtr->next = summary->next;
             }
-          summary_destroy (summary);
+          summary_destroy (node, summary);
         }
       else
         {
@@ -6389,20 +6744,12 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
                */
 
               GtkTextBTreeNode *rootnode = info->tag_root;
-              summary = g_slice_new (Summary);
-              summary->info = info;
-              summary->toggle_count = info->toggle_count - delta;
-              summary->next = rootnode->summary;
-              rootnode->summary = summary;
+              summary_new (rootnode, info, info->toggle_count - delta);
               rootnode = rootnode->parent;
               rootLevel = rootnode->level;
               info->tag_root = rootnode;
             }
-          summary = g_slice_new (Summary);
-          summary->info = info;
-          summary->toggle_count = delta;
-          summary->next = node->summary;
-          node->summary = summary;
+          summary_new (node, info, delta);
         }
     }
 
@@ -6432,6 +6779,9 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
            node2Ptr != (GtkTextBTreeNode *)NULL ;
            node2Ptr = node2Ptr->next)
         {
+          if (!gtk_text_btree_node_has_tag (node2Ptr, info))
+            continue;
+
           for (prevPtr = NULL, summary = node2Ptr->summary;
                summary != NULL;
                prevPtr = summary, summary = summary->next)
@@ -6466,7 +6816,7 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
             {
               prevPtr->next = summary->next;
             }
-          summary_destroy (summary);
+          summary_destroy (node2Ptr, summary);
           info->tag_root = node2Ptr;
           break;
         }
@@ -6858,6 +7208,18 @@ gtk_text_btree_node_check_consistency (GtkTextBTree     *tree,
                num_chars, node->num_chars);
     }
 
+  {
+    GtkBitmask *mask = _gtk_bitmask_new ();
+
+    for (summary = node->summary; summary != NULL; summary = summary->next)
+      mask = _gtk_bitmask_set (mask, summary->info->index, TRUE);
+
+    if (!_gtk_bitmask_equals (mask, node->tag_mask))
+      g_error ("gtk_text_btree_node_check_consistency: tag mask doesn't match summaries");
+
+    _gtk_bitmask_free (mask);
+  }
+
   for (summary = node->summary; summary != NULL;
        summary = summary->next)
     {
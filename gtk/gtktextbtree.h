@@ -107,6 +107,8 @@ gboolean     _gtk_text_btree_validate          (GtkTextBTree      *tree,
 void         _gtk_text_btree_validate_line     (GtkTextBTree      *tree,
                                                 GtkTextLine       *line,
                                                 gpointer           view_id);
+GtkTextLine *_gtk_text_btree_get_first_invalid_line (GtkTextBTree *tree,
+                                                    gpointer      view_id);
 
 /* Tag */
 
@@ -114,6 +116,11 @@ void _gtk_text_btree_tag (const GtkTextIter *start,
                           const GtkTextIter *end,
                           GtkTextTag        *tag,
                           gboolean           apply);
+void _gtk_text_btree_tag_ranges (GtkTextBTree *tree,
+                                 GtkTextTag   *tag,
+                                 const int    *ranges,
+                                 guint         n_ranges,
+                                 gboolean      apply);
 
 /* "Getters" */
 
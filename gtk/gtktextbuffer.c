@@ -68,6 +68,8 @@ struct _GtkTextBufferPrivate
 
   guint user_action_count;
 
+  guint loading : 1;
+
   /* Whether the buffer has been modified since last save */
   guint modified : 1;
   guint has_selection : 1;
@@ -1178,6 +1180,274 @@ gtk_text_buffer_set_text (GtkTextBuffer *buffer,
   gtk_text_history_end_irreversible_action (buffer->priv->history);
 }
 
+/*
+ * Loading from a stream
+ */
+
+#define LOAD_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+  GInputStream *stream;
+  int io_priority;
+
+  /* An incomplete UTF-8 sequence or a trailing \r from the
+   * previous chunk. The \r is held back so that a \r\n split
+   * across two chunks ends up in one paragraph delimiter.
+   */
+  char pending[4];
+  gsize n_pending;
+
+  guint inserted : 1;
+} LoadData;
+
+static void
+load_data_free (gpointer data)
+{
+  LoadData *load = data;
+
+  g_object_unref (load->stream);
+  g_slice_free (LoadData, load);
+}
+
+static void
+load_finish (GTask  *task,
+             GError *error)
+{
+  GtkTextBuffer *buffer = g_task_get_source_object (task);
+  LoadData *load = g_task_get_task_data (task);
+  GtkTextIter start;
+
+  buffer->priv->loading = FALSE;
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_place_cursor (buffer, &start);
+
+  gtk_text_history_end_irreversible_action (buffer->priv->history);
+
+  if (load->inserted)
+    {
+      g_signal_emit (buffer, signals[CHANGED], 0);
+      g_object_notify_by_pspec (G_OBJECT (buffer), text_buffer_props[PROP_CURSOR_POSITION]);
+    }
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+
+  g_object_unref (task);
+}
+
+static void
+load_insert (GtkTextBuffer *buffer,
+             LoadData      *load,
+             const char    *text,
+             gsize          len)
+{
+  GtkTextIter iter;
+
+  if (len == 0)
+    return;
+
+  /* This bypasses ::insert-text and the undo history, and
+   * ::changed is emitted once when the load is done.
+   */
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  _gtk_text_btree_insert (&iter, text, len);
+  load->inserted = TRUE;
+}
+
+static void load_read_next (GTask *task);
+
+static void
+load_read_cb (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  GTask *task = user_data;
+  GtkTextBuffer *buffer = g_task_get_source_object (task);
+  LoadData *load = g_task_get_task_data (task);
+  GError *error = NULL;
+  GBytes *bytes;
+  const char *data;
+  const char *valid_end;
+  char *text;
+  gsize size, len, valid;
+
+  bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (source), result, &error);
+  if (bytes == NULL)
+    {
+      load_finish (task, error);
+      return;
+    }
+
+  data = g_bytes_get_data (bytes, &size);
+
+  if (size == 0)
+    {
+      g_bytes_unref (bytes);
+
+      if (load->n_pending > 0 && load->pending[0] != '\r')
+        {
+          load_finish (task, g_error_new (G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                                          "Stream ends with an incomplete UTF-8 sequence"));
+          return;
+        }
+
+      load_insert (buffer, load, load->pending, load->n_pending);
+      load_finish (task, NULL);
+      return;
+    }
+
+  if (load->n_pending > 0)
+    {
+      len = load->n_pending + size;
+      text = g_malloc (len);
+      memcpy (text, load->pending, load->n_pending);
+      memcpy (text + load->n_pending, data, size);
+    }
+  else
+    {
+      len = size;
+      text = (char *) data;
+    }
+
+  g_utf8_validate (text, len, &valid_end);
+  valid = valid_end - text;
+
+  /* Only an incomplete sequence at the very end may be carried
+   * over to the next chunk, anything else is invalid.
+   */
+  if (len - valid >= G_N_ELEMENTS (load->pending))
+    {
+      if (text != data)
+        g_free (text);
+      g_bytes_unref (bytes);
+      load_finish (task, g_error_new (G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                                      "Invalid UTF-8 at offset %" G_GSIZE_FORMAT,
+                                      valid));
+      return;
+    }
+
+  if (valid == len && valid > 0 && text[valid - 1] == '\r')
+    valid--;
+
+  load_insert (buffer, load, text, valid);
+
+  load->n_pending = len - valid;
+  memcpy (load->pending, text + valid, load->n_pending);
+
+  if (text != data)
+    g_free (text);
+  g_bytes_unref (bytes);
+
+  load_read_next (task);
+}
+
+static void
+load_read_next (GTask *task)
+{
+  LoadData *load = g_task_get_task_data (task);
+
+  g_input_stream_read_bytes_async (load->stream,
+                                   LOAD_CHUNK_SIZE,
+                                   load->io_priority,
+                                   g_task_get_cancellable (task),
+                                   load_read_cb,
+                                   task);
+}
+
+/**
+ * gtk_text_buffer_load_stream_async:
+ * @buffer: a #GtkTextBuffer
+ * @stream: a #GInputStream to read UTF-8 text from
+ * @io_priority: the I/O priority of the reads
+ * @cancellable: (nullable): optional #GCancellable object
+ * @callback: (scope async): callback to call when the load is done
+ * @user_data: the data to pass to @callback
+ *
+ * Replaces the contents of @buffer with the text read from @stream.
+ *
+ * This is meant for loading large files. The text is read in chunks
+ * and each chunk is added to the buffer as a whole, so the main loop
+ * keeps running during the load. The undo history is cleared and
+ * does not record the load. The #GtkTextBuffer::insert-text signal
+ * is not emitted for the loaded text, and #GtkTextBuffer::changed
+ * is only emitted once, when the load is done.
+ *
+ * The buffer should not be modified until the load is done. If the
+ * load fails or is cancelled, the text read so far stays in the buffer.
+ * In either case, the cursor is placed at the start of the buffer.
+ *
+ * Like any other change, loading sets the modified flag. Call
+ * gtk_text_buffer_set_modified() afterwards if that is not wanted.
+ *
+ * Since: 4.2
+ */
+void
+gtk_text_buffer_load_stream_async (GtkTextBuffer       *buffer,
+                                   GInputStream        *stream,
+                                   int                  io_priority,
+                                   GCancellable        *cancellable,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  GtkTextIter start, end;
+  LoadData *load;
+  GTask *task;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (!buffer->priv->loading);
+
+  load = g_slice_new0 (LoadData);
+  load->stream = g_object_ref (stream);
+  load->io_priority = io_priority;
+
+  task = g_task_new (buffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_text_buffer_load_stream_async);
+  g_task_set_task_data (task, load, load_data_free);
+
+  buffer->priv->loading = TRUE;
+
+  gtk_text_history_begin_irreversible_action (buffer->priv->history);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  gtk_text_buffer_delete (buffer, &start, &end);
+
+  load_read_next (task);
+}
+
+/**
+ * gtk_text_buffer_load_stream_finish:
+ * @buffer: a #GtkTextBuffer
+ * @result: a #GAsyncResult
+ * @error: Return location for an error
+ *
+ * Finishes a load started with gtk_text_buffer_load_stream_async().
+ *
+ * If @stream did not contain valid UTF-8, the error is
+ * %G_IO_ERROR_INVALID_DATA.
+ *
+ * Returns: %TRUE if the whole stream was loaded
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_text_buffer_load_stream_finish (GtkTextBuffer  *buffer,
+                                    GAsyncResult   *result,
+                                    GError        **error)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, buffer), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_text_buffer_load_stream_async, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
  
 
 /*
@@ -2980,6 +3250,66 @@ gtk_text_buffer_remove_tag (GtkTextBuffer     *buffer,
   gtk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+/**
+ * gtk_text_buffer_apply_tag_ranges:
+ * @buffer: a #GtkTextBuffer
+ * @tag: a #GtkTextTag
+ * @ranges: (array length=n_ranges): pairs of start and end character offsets
+ * @n_ranges: the number of ranges, which is half the length of @ranges
+ *
+ * Applies @tag to many ranges of @buffer at once.
+ *
+ * The ranges don't have to be sorted, and may overlap. Offsets
+ * outside of the buffer are clamped. This is much faster than
+ * calling gtk_text_buffer_apply_tag() for each range, for example
+ * when highlighting the syntax of a large file.
+ *
+ * The #GtkTextBuffer::apply-tag signal is not emitted.
+ *
+ * Since: 4.2
+ */
+void
+gtk_text_buffer_apply_tag_ranges (GtkTextBuffer *buffer,
+                                  GtkTextTag    *tag,
+                                  const int     *ranges,
+                                  guint          n_ranges)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+  g_return_if_fail (tag->priv->table == buffer->priv->tag_table);
+
+  _gtk_text_btree_tag_ranges (get_btree (buffer), tag, ranges, n_ranges, TRUE);
+}
+
+/**
+ * gtk_text_buffer_remove_tag_ranges:
+ * @buffer: a #GtkTextBuffer
+ * @tag: a #GtkTextTag
+ * @ranges: (array length=n_ranges): pairs of start and end character offsets
+ * @n_ranges: the number of ranges, which is half the length of @ranges
+ *
+ * Removes @tag from many ranges of @buffer at once.
+ *
+ * See gtk_text_buffer_apply_tag_ranges() for details. The
+ * #GtkTextBuffer::remove-tag signal is not emitted.
+ *
+ * Since: 4.2
+ */
+void
+gtk_text_buffer_remove_tag_ranges (GtkTextBuffer *buffer,
+                                   GtkTextTag    *tag,
+                                   const int     *ranges,
+                                   guint          n_ranges)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+  g_return_if_fail (tag->priv->table == buffer->priv->tag_table);
+
+  _gtk_text_btree_tag_ranges (get_btree (buffer), tag, ranges, n_ranges, FALSE);
+}
+
 /**
  * gtk_text_buffer_apply_tag_by_name:
  * @buffer: a #GtkTextBuffer
@@ -165,6 +165,18 @@ void gtk_text_buffer_set_text          (GtkTextBuffer *buffer,
                                         const char    *text,
                                         int            len);
 
+GDK_AVAILABLE_IN_4_2
+void     gtk_text_buffer_load_stream_async  (GtkTextBuffer       *buffer,
+                                             GInputStream        *stream,
+                                             int                  io_priority,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             user_data);
+GDK_AVAILABLE_IN_4_2
+gboolean gtk_text_buffer_load_stream_finish (GtkTextBuffer       *buffer,
+                                             GAsyncResult        *result,
+                                             GError             **error);
+
 /* Insert into the buffer */
 GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_insert            (GtkTextBuffer *buffer,
@@ -324,6 +336,16 @@ void gtk_text_buffer_remove_tag            (GtkTextBuffer     *buffer,
                                             GtkTextTag        *tag,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
+GDK_AVAILABLE_IN_4_2
+void gtk_text_buffer_apply_tag_ranges      (GtkTextBuffer     *buffer,
+                                            GtkTextTag        *tag,
+                                            const int         *ranges,
+                                            guint              n_ranges);
+GDK_AVAILABLE_IN_4_2
+void gtk_text_buffer_remove_tag_ranges     (GtkTextBuffer     *buffer,
+                                            GtkTextTag        *tag,
+                                            const int         *ranges,
+                                            guint              n_ranges);
 GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_apply_tag_by_name     (GtkTextBuffer     *buffer,
                                             const char        *name,
@@ -218,11 +218,18 @@ action_chain (Action   *action,
        *
        * But we don't care if this is a barrier since we will always
        * apply things as a group anyway.
+       *
+       * Items that continue the last item of the group are joined to
+       * it, so that large programmatic edits, like inserting a file
+       * line by line, don't keep an action for every single change.
        */
+      Action *last = g_queue_peek_tail (&action->u.group.actions);
 
       if (other->kind == ACTION_KIND_BARRIER)
         action_free (other);
-      else
+      else if (last == NULL ||
+               last->kind == ACTION_KIND_GROUP ||
+               !action_chain (last, other, in_user_action))
         g_queue_push_tail_link (&action->u.group.actions, &other->link);
 
       return TRUE;
@@ -283,11 +290,30 @@ action_chain (Action   *action,
     }
 
     case ACTION_KIND_DELETE_PROGRAMMATIC:
-      /* We can't tell if this should be chained because we don't
-       * have a group to coalesce. But unless each action deletes
-       * a single character, the overhead isn't too bad as we embed
-       * the strings in the action.
+      /* Outside of a user action we can't tell if this should be
+       * chained because we don't have a group to coalesce. But unless
+       * each action deletes a single character, the overhead isn't too
+       * bad as we embed the strings in the action.
        */
+      if (!in_user_action)
+        return FALSE;
+
+      if (other->u.delete.end == action->u.delete.begin)
+        {
+          istring_prepend (&action->u.delete.istr,
+                           &other->u.delete.istr);
+          action->u.delete.begin = other->u.delete.begin;
+          action_free (other);
+          return TRUE;
+        }
+      else if (other->u.delete.begin == action->u.delete.begin)
+        {
+          istring_append (&action->u.delete.istr, &other->u.delete.istr);
+          action->u.delete.end += other->u.delete.istr.n_chars;
+          action_free (other);
+          return TRUE;
+        }
+
       return FALSE;
 
     case ACTION_KIND_DELETE_SELECTION:
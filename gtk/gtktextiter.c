@@ -4842,6 +4842,165 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* Most searches are for a single line of text, and when ignoring case
+ * for ASCII text in mostly ASCII buffers. For those we copy the text of
+ * each line straight from its segments and run a Horspool search over it,
+ * instead of extracting, casefolding and normalizing every line.
+ */
+typedef struct {
+  const guchar *needle;
+  gsize len;
+  gsize n_chars;
+  gboolean fold;
+  gsize skip[256];
+} SearchPattern;
+
+typedef enum {
+  SEARCH_LINE_NO_MATCH,
+  SEARCH_LINE_MATCH,
+  SEARCH_LINE_FALLBACK
+} SearchLineResult;
+
+static gboolean
+search_pattern_init (SearchPattern *pattern,
+                     const char    *needle,
+                     gboolean       case_insensitive)
+{
+  gsize i;
+
+  pattern->needle = (const guchar *) needle;
+  pattern->len = strlen (needle);
+  pattern->n_chars = g_utf8_strlen (needle, -1);
+  pattern->fold = case_insensitive;
+
+  if (pattern->len == 0)
+    return FALSE;
+
+  /* The needle has been casefolded already */
+  if (case_insensitive)
+    {
+      for (i = 0; i < pattern->len; i++)
+        {
+          if (pattern->needle[i] & 0x80)
+            return FALSE;
+        }
+    }
+
+  for (i = 0; i < 256; i++)
+    pattern->skip[i] = pattern->len;
+
+  for (i = 0; i + 1 < pattern->len; i++)
+    pattern->skip[pattern->needle[i]] = pattern->len - 1 - i;
+
+  return TRUE;
+}
+
+static inline guchar
+search_pattern_fold (const SearchPattern *pattern,
+                     guchar               c)
+{
+  return pattern->fold ? g_ascii_tolower (c) : c;
+}
+
+static gssize
+search_pattern_find (const SearchPattern *pattern,
+                     const guchar        *haystack,
+                     gsize                haystack_len)
+{
+  gsize i, j;
+
+  if (haystack_len < pattern->len)
+    return -1;
+
+  i = 0;
+  while (i <= haystack_len - pattern->len)
+    {
+      j = pattern->len - 1;
+      while (search_pattern_fold (pattern, haystack[i + j]) == pattern->needle[j])
+        {
+          if (j == 0)
+            return i;
+          j--;
+        }
+
+      i += pattern->skip[search_pattern_fold (pattern, haystack[i + pattern->len - 1])];
+    }
+
+  return -1;
+}
+
+/* Equivalent to lines_match() for a single line needle, or
+ * %SEARCH_LINE_FALLBACK if the line needs casefolding.
+ */
+static SearchLineResult
+search_line_fast (const SearchPattern *pattern,
+                  const GtkTextIter   *start,
+                  gboolean             slice,
+                  GString             *text,
+                  GtkTextIter         *match_start,
+                  GtkTextIter         *match_end)
+{
+  GtkTextLine *line;
+  GtkTextLineSegment *seg;
+  GtkTextIter next;
+  int skip;
+  gssize pos;
+  gsize i;
+
+  line = _gtk_text_iter_get_text_line (start);
+  skip = gtk_text_iter_get_line_index (start);
+
+  g_string_truncate (text, 0);
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      const char *chars;
+
+      if (seg->type == &gtk_text_char_type)
+        chars = seg->body.chars;
+      else if (seg->type == &gtk_text_paintable_type ||
+               seg->type == &gtk_text_child_type)
+        chars = slice ? _gtk_text_unknown_char_utf8 : NULL;
+      else
+        continue;
+
+      if (skip >= seg->byte_count)
+        {
+          skip -= seg->byte_count;
+          continue;
+        }
+
+      if (chars)
+        g_string_append_len (text, chars + skip, seg->byte_count - skip);
+
+      skip = 0;
+    }
+
+  if (pattern->fold)
+    {
+      for (i = 0; i < text->len; i++)
+        {
+          if (((guchar) text->str[i]) & 0x80)
+            return SEARCH_LINE_FALLBACK;
+        }
+    }
+
+  pos = search_pattern_find (pattern, (const guchar *) text->str, text->len);
+  if (pos < 0)
+    return SEARCH_LINE_NO_MATCH;
+
+  next = *start;
+  forward_chars_with_skipping (&next, g_utf8_strlen (text->str, pos),
+                               FALSE, !slice, FALSE);
+  *match_start = next;
+
+  forward_chars_with_skipping (&next, pattern->n_chars,
+                               FALSE, !slice, pattern->fold);
+  *match_end = next;
+
+  return SEARCH_LINE_MATCH;
+}
+
 /**
  * gtk_text_iter_forward_search:
  * @iter: start of search
@@ -4878,6 +5037,8 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
   gboolean visible_only;
   gboolean slice;
   gboolean case_insensitive;
+  SearchPattern pattern;
+  GString *text = NULL;
 
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (str != NULL, FALSE);
@@ -4915,6 +5076,11 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
 
   lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
 
+  /* Invisible text needs the tags, so that is left to lines_match() */
+  if (!visible_only && lines[0] != NULL && lines[1] == NULL &&
+      search_pattern_init (&pattern, lines[0], case_insensitive))
+    text = g_string_new (NULL);
+
   search = *iter;
 
   do
@@ -4924,13 +5090,34 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
        * a single line.
        */
       GtkTextIter end;
+      gboolean found;
 
       if (limit &&
           gtk_text_iter_compare (&search, limit) >= 0)
         break;
-      
-      if (lines_match (&search, (const char **)lines,
-                       visible_only, slice, case_insensitive, &match, &end))
+
+      if (text != NULL)
+        {
+          switch (search_line_fast (&pattern, &search, slice, text, &match, &end))
+            {
+            case SEARCH_LINE_MATCH:
+              found = TRUE;
+              break;
+            case SEARCH_LINE_NO_MATCH:
+              found = FALSE;
+              break;
+            case SEARCH_LINE_FALLBACK:
+            default:
+              found = lines_match (&search, (const char **)lines,
+                                   visible_only, slice, case_insensitive, &match, &end);
+              break;
+            }
+        }
+      else
+        found = lines_match (&search, (const char **)lines,
+                             visible_only, slice, case_insensitive, &match, &end);
+
+      if (found)
         {
           if (limit == NULL ||
               (limit &&
@@ -4950,6 +5137,8 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
     }
   while (gtk_text_iter_forward_line (&search));
 
+  if (text != NULL)
+    g_string_free (text, TRUE);
   g_strfreev ((char **)lines);
 
   return retval;
@@ -109,6 +109,25 @@ struct _GtkTextLayoutPrivate
 
   /* Cache for GtkTextLineDisplay to reduce overhead creating layouts */
   GtkTextLineDisplayCache *cache;
+
+  /* Lines measured ahead of time by gtk_text_layout_validate(),
+   * only set while a validation is running */
+  GHashTable *prefetched_lines;
+
+  /* Displays for lines just outside the viewport are created in an
+   * idle after a snapshot, in the direction we are scrolling in */
+  guint n_visible_lines;
+  int last_snapshot_y;
+  int cache_prefetch_y;
+  guint cache_prefetch_source;
+  guint cache_prefetch_down : 1;
+
+  /* Metrics of the default font for measuring plain ASCII lines
+   * without shaping them, see set_fixed_extents() */
+  guint monospace : 1;
+  guint fixed_metrics_valid : 1;
+  int fixed_char_width;
+  int fixed_line_height;
 };
 
 static void gtk_text_layout_invalidated     (GtkTextLayout     *layout);
@@ -127,6 +146,18 @@ static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
 
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
+static gboolean totally_invisible_line (GtkTextLayout *layout,
+                                        GtkTextLine   *line,
+                                        GtkTextIter   *iter);
+static void gtk_text_layout_measure_display (GtkTextLayout      *layout,
+                                             GtkTextLineDisplay *display);
+static GtkTextLineDisplay *gtk_text_layout_create_display_internal (GtkTextLayout *layout,
+                                                                    GtkTextLine   *line,
+                                                                    gboolean       size_only,
+                                                                    PangoContext  *ltr_context,
+                                                                    PangoContext  *rtl_context,
+                                                                    gboolean       measure);
+
 static void gtk_text_layout_after_mark_set_handler     (GtkTextBuffer     *buffer,
                                                         const GtkTextIter *location,
                                                         GtkTextMark       *mark,
@@ -193,6 +224,7 @@ gtk_text_layout_dispose (GObject *object)
   GtkTextLayout *layout = GTK_TEXT_LAYOUT (object);
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
 
+  g_clear_handle_id (&priv->cache_prefetch_source, g_source_remove);
   g_clear_pointer (&priv->cache, gtk_text_line_display_cache_free);
 
   gtk_text_layout_set_buffer (layout, NULL);
@@ -374,8 +406,12 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
 void
 gtk_text_layout_default_style_changed (GtkTextLayout *layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
 
+  priv->fixed_metrics_valid = FALSE;
+
   DV (g_print ("invalidating all due to default style change (%s)\n", G_STRLOC));
   gtk_text_layout_invalidate_all (layout);
 }
@@ -405,8 +441,12 @@ gtk_text_layout_set_contexts (GtkTextLayout *layout,
                               PangoContext  *ltr_context,
                               PangoContext  *rtl_context)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
 
+  priv->fixed_metrics_valid = FALSE;
+
   if (layout->ltr_context != ltr_context)
     {
       if (layout->ltr_context)
@@ -429,6 +469,25 @@ gtk_text_layout_set_contexts (GtkTextLayout *layout,
   gtk_text_layout_invalidate_all (layout);
 }
 
+/**
+ * gtk_text_layout_set_monospace:
+ * @layout: a #GtkTextLayout
+ * @monospace: whether the text is expected to use a monospace font
+ *
+ * Enables measuring lines of plain ASCII text from the advance
+ * of the default font, when that font turns out to be monospace.
+ */
+void
+gtk_text_layout_set_monospace (GtkTextLayout *layout,
+                               gboolean       monospace)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  priv->monospace = monospace != FALSE;
+}
+
 /**
  * gtk_text_layout_set_overwrite_mode:
  * @layout: a #GtkTextLayout
@@ -1067,6 +1126,298 @@ gtk_text_layout_validate_yrange (GtkTextLayout *layout,
     }
 }
 
+/* Laying out lines with Pango is by far the most expensive part of
+ * validating, and does not depend on anything but the line itself once
+ * the text and attributes are collected. So when there are many lines
+ * to validate, we collect them on the main thread and lay them out
+ * in parallel before handing the sizes to the btree.
+ *
+ * Pango contexts aren't thread-safe, so every job gets its own copies
+ * of ours. Font maps are.
+ */
+#define MIN_PARALLEL_WRAP_LINES 64
+#define MIN_LINES_PER_WRAP_JOB 16
+#define MAX_WRAP_THREADS 8
+
+typedef struct {
+  GtkTextLineDisplay *display;
+  int top_ink;
+  int bottom_ink;
+} PrefetchedLine;
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+} WrapBatch;
+
+typedef struct {
+  GtkTextLayout *layout;
+  PrefetchedLine *lines;
+  guint first;
+  guint last;
+  WrapBatch *batch;
+} WrapJob;
+
+static GThreadPool *wrap_pool;
+
+static void
+gtk_text_layout_measure_range (GtkTextLayout  *layout,
+                               PrefetchedLine *lines,
+                               guint           first,
+                               guint           last)
+{
+  PangoRectangle ink_rect, logical_rect;
+  guint i;
+
+  for (i = first; i < last; i++)
+    {
+      gtk_text_layout_measure_display (layout, lines[i].display);
+
+      pango_layout_get_pixel_extents (lines[i].display->layout, &ink_rect, &logical_rect);
+      lines[i].top_ink = MAX (0, logical_rect.x - ink_rect.x);
+      lines[i].bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
+    }
+}
+
+static void
+wrap_job_run (gpointer data,
+              gpointer user_data)
+{
+  WrapJob *job = data;
+
+  gtk_text_layout_measure_range (job->layout, job->lines, job->first, job->last);
+
+  g_mutex_lock (&job->batch->lock);
+  job->batch->n_pending--;
+  g_cond_signal (&job->batch->cond);
+  g_mutex_unlock (&job->batch->lock);
+}
+
+static PangoContext *
+copy_pango_context (PangoContext *context)
+{
+  PangoContext *copy;
+  const cairo_font_options_t *options;
+
+  copy = pango_font_map_create_context (pango_context_get_font_map (context));
+
+  pango_context_set_font_description (copy, pango_context_get_font_description (context));
+  pango_context_set_language (copy, pango_context_get_language (context));
+  pango_context_set_base_dir (copy, pango_context_get_base_dir (context));
+  pango_context_set_base_gravity (copy, pango_context_get_base_gravity (context));
+  pango_context_set_gravity_hint (copy, pango_context_get_gravity_hint (context));
+  pango_context_set_matrix (copy, pango_context_get_matrix (context));
+  pango_context_set_round_glyph_positions (copy, pango_context_get_round_glyph_positions (context));
+  pango_cairo_context_set_resolution (copy, pango_cairo_context_get_resolution (context));
+
+  options = pango_cairo_context_get_font_options (context);
+  if (options)
+    pango_cairo_context_set_font_options (copy, options);
+
+  return copy;
+}
+
+/* Lines whose displays depend on more than the line itself */
+static gboolean
+can_prefetch_line (GtkTextLayout *layout,
+                   GtkTextLine   *line,
+                   GtkTextLine   *insert_line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineSegment *seg;
+  GtkTextIter iter;
+
+  /* Preedit, block cursors and the keyboard direction */
+  if (line == insert_line || line == priv->cursor_line)
+    return FALSE;
+
+  /* Child widgets get allocated from the layout */
+  for (seg = line->segments; seg; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_child_type)
+        return FALSE;
+    }
+
+  /* Those aren't laid out at all */
+  if (totally_invisible_line (layout, line, &iter))
+    return FALSE;
+
+  return TRUE;
+}
+
+static PrefetchedLine *
+gtk_text_layout_prefetch_lines (GtkTextLayout *layout,
+                                int            max_pixels,
+                                guint         *n_lines)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  static int enabled = -1;
+  PangoFontMetrics *metrics;
+  PangoContext **contexts;
+  PrefetchedLine *lines;
+  GtkTextLine *line, *insert_line;
+  GtkTextIter insert;
+  WrapBatch batch;
+  WrapJob *jobs;
+  int line_height;
+  guint i, n, max_lines, n_jobs, lines_per_job;
+
+  if (G_UNLIKELY (enabled == -1))
+    enabled = g_getenv ("GTK_NO_PARALLEL_TEXT_LAYOUT") == NULL && g_get_num_processors () > 1;
+
+  *n_lines = 0;
+
+  if (!enabled || layout->ltr_context == NULL || layout->rtl_context == NULL)
+    return NULL;
+
+  line = _gtk_text_btree_get_first_invalid_line (_gtk_text_buffer_get_btree (layout->buffer), layout);
+  if (line == NULL)
+    return NULL;
+
+  /* Only take as many lines as the btree is going to validate */
+  metrics = pango_context_get_metrics (layout->ltr_context, NULL, NULL);
+  line_height = PANGO_PIXELS (pango_font_metrics_get_height (metrics));
+  pango_font_metrics_unref (metrics);
+
+  max_lines = max_pixels / MAX (line_height, 1) + 1;
+  if (max_lines < MIN_PARALLEL_WRAP_LINES)
+    return NULL;
+
+  n_jobs = MIN (CLAMP (g_get_num_processors (), 1, MAX_WRAP_THREADS),
+                max_lines / MIN_LINES_PER_WRAP_JOB);
+  lines_per_job = (max_lines + n_jobs - 1) / n_jobs;
+
+  contexts = g_newa (PangoContext *, 2 * n_jobs);
+  for (i = 0; i < n_jobs; i++)
+    {
+      contexts[2 * i] = copy_pango_context (layout->ltr_context);
+      contexts[2 * i + 1] = copy_pango_context (layout->rtl_context);
+    }
+
+  gtk_text_buffer_get_iter_at_mark (layout->buffer, &insert,
+                                    gtk_text_buffer_get_insert (layout->buffer));
+  insert_line = _gtk_text_iter_get_text_line (&insert);
+
+  lines = g_new (PrefetchedLine, max_lines);
+  priv->prefetched_lines = g_hash_table_new (NULL, NULL);
+
+  /* Collecting the text and attributes has to happen here */
+  for (n = 0; line != NULL && n < max_lines; line = _gtk_text_line_next_excluding_last (line))
+    {
+      GtkTextLineData *ld = _gtk_text_line_get_data (line, layout);
+      guint job = n / lines_per_job;
+
+      if (ld && ld->valid)
+        break;
+
+      if (!can_prefetch_line (layout, line, insert_line))
+        continue;
+
+      lines[n].display = gtk_text_layout_create_display_internal (layout, line, TRUE,
+                                                                   contexts[2 * job],
+                                                                   contexts[2 * job + 1],
+                                                                   FALSE);
+      g_hash_table_insert (priv->prefetched_lines, line, &lines[n]);
+      n++;
+    }
+
+  /* The displays keep their contexts alive */
+  for (i = 0; i < 2 * n_jobs; i++)
+    g_object_unref (contexts[i]);
+
+  n_jobs = (n + lines_per_job - 1) / lines_per_job;
+
+  if (n_jobs > 1)
+    {
+      if (G_UNLIKELY (wrap_pool == NULL))
+        wrap_pool = g_thread_pool_new (wrap_job_run, NULL, MAX_WRAP_THREADS - 1, FALSE, NULL);
+
+      jobs = g_newa (WrapJob, n_jobs);
+
+      g_mutex_init (&batch.lock);
+      g_cond_init (&batch.cond);
+      batch.n_pending = n_jobs - 1;
+
+      for (i = 0; i < n_jobs; i++)
+        {
+          jobs[i].layout = layout;
+          jobs[i].lines = lines;
+          jobs[i].first = i * lines_per_job;
+          jobs[i].last = MIN (jobs[i].first + lines_per_job, n);
+          jobs[i].batch = &batch;
+        }
+
+      for (i = 1; i < n_jobs; i++)
+        g_thread_pool_push (wrap_pool, &jobs[i], NULL);
+
+      gtk_text_layout_measure_range (layout, lines, jobs[0].first, jobs[0].last);
+
+      g_mutex_lock (&batch.lock);
+      while (batch.n_pending > 0)
+        g_cond_wait (&batch.cond, &batch.lock);
+      g_mutex_unlock (&batch.lock);
+
+      g_mutex_clear (&batch.lock);
+      g_cond_clear (&batch.cond);
+    }
+  else
+    {
+      gtk_text_layout_measure_range (layout, lines, 0, n);
+    }
+
+  *n_lines = n;
+  return lines;
+}
+
+static void
+gtk_text_layout_clear_prefetched_lines (GtkTextLayout  *layout,
+                                        PrefetchedLine *lines,
+                                        guint           n_lines)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  guint i;
+
+  if (lines == NULL)
+    return;
+
+  for (i = 0; i < n_lines; i++)
+    g_clear_pointer (&lines[i].display, gtk_text_line_display_unref);
+  g_free (lines);
+
+  g_clear_pointer (&priv->prefetched_lines, g_hash_table_unref);
+}
+
+/* Fills in @line_data from a line measured by
+ * gtk_text_layout_prefetch_lines(), if there is one */
+static gboolean
+gtk_text_layout_take_prefetched_line (GtkTextLayout   *layout,
+                                      GtkTextLine     *line,
+                                      GtkTextLineData *line_data)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  PrefetchedLine *prefetched;
+
+  if (G_LIKELY (priv->prefetched_lines == NULL))
+    return FALSE;
+
+  prefetched = g_hash_table_lookup (priv->prefetched_lines, line);
+  if (prefetched == NULL)
+    return FALSE;
+
+  g_hash_table_remove (priv->prefetched_lines, line);
+
+  line_data->width = prefetched->display->width;
+  line_data->height = prefetched->display->height;
+  line_data->valid = TRUE;
+  line_data->top_ink = prefetched->top_ink;
+  line_data->bottom_ink = prefetched->bottom_ink;
+
+  g_clear_pointer (&prefetched->display, gtk_text_line_display_unref);
+
+  return TRUE;
+}
+
 /**
  * gtk_text_layout_validate:
  * @tree: a #GtkTextLayout
@@ -1081,14 +1432,23 @@ gtk_text_layout_validate (GtkTextLayout *layout,
                           int            max_pixels)
 {
   int y, old_height, new_height;
+  PrefetchedLine *lines;
+  guint n_lines;
+  gboolean validated;
 
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
 
-  while (max_pixels > 0 &&
-         _gtk_text_btree_validate (_gtk_text_buffer_get_btree (layout->buffer),
-                                   layout,  max_pixels,
-                                   &y, &old_height, &new_height))
+  while (max_pixels > 0)
     {
+      lines = gtk_text_layout_prefetch_lines (layout, max_pixels, &n_lines);
+      validated = _gtk_text_btree_validate (_gtk_text_buffer_get_btree (layout->buffer),
+                                            layout,  max_pixels,
+                                            &y, &old_height, &new_height);
+      gtk_text_layout_clear_prefetched_lines (layout, lines, n_lines);
+
+      if (!validated)
+        break;
+
       max_pixels -= new_height;
 
       update_layout_size (layout);
@@ -1114,6 +1474,9 @@ gtk_text_layout_wrap (GtkTextLayout   *layout,
       _gtk_text_line_add_data (line, line_data);
     }
 
+  if (gtk_text_layout_take_prefetched_line (layout, line, line_data))
+    return line_data;
+
   display = gtk_text_layout_get_line_display (layout, line, TRUE);
   line_data->width = display->width;
   line_data->height = display->height;
@@ -1260,6 +1623,8 @@ totally_invisible_line (GtkTextLayout *layout,
 
 static void
 set_para_values (GtkTextLayout      *layout,
+                 PangoContext       *ltr_context,
+                 PangoContext       *rtl_context,
                  PangoDirection      base_dir,
                  GtkTextAttributes  *style,
                  GtkTextLineDisplay *display)
@@ -1296,9 +1661,9 @@ set_para_values (GtkTextLayout      *layout,
     }
   
   if (display->direction == GTK_TEXT_DIR_RTL)
-    display->layout = pango_layout_new (layout->rtl_context);
+    display->layout = pango_layout_new (rtl_context);
   else
-    display->layout = pango_layout_new (layout->ltr_context);
+    display->layout = pango_layout_new (ltr_context);
 
   switch (style->justification)
     {
@@ -2315,10 +2680,160 @@ tags_array_toggle_tag (GPtrArray  *array,
   return array;
 }
 
-GtkTextLineDisplay *
-gtk_text_layout_create_display (GtkTextLayout *layout,
-                                GtkTextLine   *line,
-                                gboolean       size_only)
+/* Lays out the text of @display and computes its size. This only
+ * touches @display and its PangoLayout, so it can run on any thread.
+ */
+static void
+gtk_text_layout_measure_display (GtkTextLayout      *layout,
+                                 GtkTextLineDisplay *display)
+{
+  PangoRectangle extents;
+  int text_pixel_width;
+  int h_margin;
+  int h_padding;
+
+  if (display->has_fixed_extents)
+    {
+      extents.x = 0;
+      extents.y = 0;
+      extents.width = display->fixed_width;
+      extents.height = display->fixed_height;
+    }
+  else
+    pango_layout_get_extents (display->layout, NULL, &extents);
+
+  text_pixel_width = PIXEL_BOUND (extents.width);
+
+  h_margin = display->left_margin + display->right_margin;
+  h_padding = layout->left_padding + layout->right_padding;
+
+  display->width = text_pixel_width + h_margin + h_padding;
+  display->height += PANGO_PIXELS (extents.height);
+
+  /* If we aren't wrapping, we need to do the alignment of each
+   * paragraph ourselves.
+   */
+  if (pango_layout_get_width (display->layout) < 0)
+    {
+      int excess = display->total_width - text_pixel_width;
+
+      switch (pango_layout_get_alignment (display->layout))
+        {
+        case PANGO_ALIGN_LEFT:
+        default:
+          break;
+        case PANGO_ALIGN_CENTER:
+          display->x_offset += excess / 2;
+          break;
+        case PANGO_ALIGN_RIGHT:
+          display->x_offset += excess;
+          break;
+        }
+    }
+}
+
+static gboolean
+gtk_text_layout_ensure_fixed_metrics (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  PangoLayout *pango_layout;
+  PangoRectangle extents;
+  char ascii[0x7f - 0x20];
+  int char_width;
+  guint i;
+
+  if (priv->fixed_metrics_valid)
+    return priv->fixed_char_width > 0;
+
+  for (i = 0; i < G_N_ELEMENTS (ascii); i++)
+    ascii[i] = 0x20 + i;
+
+  pango_layout = pango_layout_new (layout->ltr_context);
+  pango_layout_set_font_description (pango_layout, layout->default_style->font);
+
+  pango_layout_set_text (pango_layout, "M", 1);
+  pango_layout_get_extents (pango_layout, NULL, &extents);
+  char_width = extents.width;
+  priv->fixed_line_height = extents.height;
+
+  /* Only use the metrics if all of printable ASCII has the same
+   * advance, and nothing kerns or changes the line height.
+   */
+  pango_layout_set_text (pango_layout, ascii, G_N_ELEMENTS (ascii));
+  pango_layout_get_extents (pango_layout, NULL, &extents);
+  if (extents.width == (int) G_N_ELEMENTS (ascii) * char_width &&
+      extents.height == priv->fixed_line_height)
+    priv->fixed_char_width = char_width;
+  else
+    priv->fixed_char_width = 0;
+
+  g_object_unref (pango_layout);
+
+  priv->fixed_metrics_valid = TRUE;
+
+  return priv->fixed_char_width > 0;
+}
+
+/* In monospace mode, a line of printable ASCII in the default style
+ * is as wide as its number of characters times the advance of the
+ * font, and one font line high. Size-only displays of such lines are
+ * measured from that instead of being itemized and shaped. The text
+ * is still set on the PangoLayout, so anything that looks at it gets
+ * the same result from Pango.
+ */
+static void
+set_fixed_extents (GtkTextLayout      *layout,
+                   GtkTextLineDisplay *display,
+                   const char         *text,
+                   int                 len)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextAttributes *style = layout->default_style;
+  int wrap_width;
+  int width;
+  int i;
+
+  if (style->font_features != NULL ||
+      style->letter_spacing != 0 ||
+      style->font_scale != 1.0 ||
+      style->appearance.rise != 0 ||
+      style->show_spaces != 0 ||
+      style->invisible)
+    return;
+
+  if (pango_layout_get_indent (display->layout) != 0)
+    return;
+
+  for (i = 0; i < len; i++)
+    {
+      if ((guchar) text[i] < 0x20 || (guchar) text[i] > 0x7e)
+        return;
+    }
+
+  if (!gtk_text_layout_ensure_fixed_metrics (layout))
+    return;
+
+  width = len * priv->fixed_char_width;
+  wrap_width = pango_layout_get_width (display->layout);
+  if (wrap_width >= 0 && width > wrap_width)
+    return;
+
+  display->has_fixed_extents = TRUE;
+  display->fixed_width = width;
+  display->fixed_height = priv->fixed_line_height;
+}
+
+/* With @measure == %FALSE the text is not laid out, which is left to
+ * gtk_text_layout_measure_display(). That is only valid for lines
+ * without child widgets.
+ */
+static GtkTextLineDisplay *
+gtk_text_layout_create_display_internal (GtkTextLayout *layout,
+                                         GtkTextLine   *line,
+                                         gboolean       size_only,
+                                         PangoContext  *ltr_context,
+                                         PangoContext  *rtl_context,
+                                         gboolean       measure)
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
@@ -2326,10 +2841,8 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   GtkTextIter iter;
   GtkTextAttributes *style;
   char *text;
-  int text_pixel_width;
   PangoAttrList *attrs;
   int text_allocated, layout_byte_offset, buffer_byte_offset;
-  PangoRectangle extents;
   gboolean para_values_set = FALSE;
   GSList *cursor_byte_offsets = NULL;
   GSList *cursor_segs = NULL;
@@ -2338,11 +2851,10 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   PangoDirection base_dir;
   GPtrArray *tags;
   gboolean initial_toggle_segments;
-  int h_margin;
-  int h_padding;
   PangoAttribute *last_font_attr = NULL;
   PangoAttribute *last_scale_attr = NULL;
   PangoAttribute *last_fallback_attr = NULL;
+  gboolean plain_text;
 
   g_return_val_if_fail (line != NULL, NULL);
 
@@ -2359,7 +2871,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
    */
   if (totally_invisible_line (layout, line, &iter))
     {
-      display->layout = pango_layout_new (layout->ltr_context);
+      display->layout = pango_layout_new (ltr_context);
       return g_steal_pointer (&display);
     }
 
@@ -2388,6 +2900,8 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   seg = _gtk_text_iter_get_any_segment (&iter);
   tags = get_tags_array_at_iter (&iter);
   initial_toggle_segments = TRUE;
+  /* No tags, paintables, widgets or preedit */
+  plain_text = size_only && priv->monospace && tags == NULL;
   while (seg != NULL)
     {
       /* Displayable segments */
@@ -2405,7 +2919,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
            */
           if (!para_values_set)
             {
-              set_para_values (layout, base_dir, style, display);
+              set_para_values (layout, ltr_context, rtl_context, base_dir, style, display);
               para_values_set = TRUE;
             }
 
@@ -2478,6 +2992,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
                 }
               else if (seg->type == &gtk_text_paintable_type)
                 {
+                  plain_text = FALSE;
                   add_generic_attrs (layout,
                                      &style->appearance,
                                      seg->byte_count,
@@ -2493,7 +3008,8 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
               else if (seg->type == &gtk_text_child_type)
                 {
                   saw_widget = TRUE;
-                  
+                  plain_text = FALSE;
+
                   add_generic_attrs (layout, &style->appearance,
                                      seg->byte_count,
                                      attrs, layout_byte_offset,
@@ -2528,6 +3044,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
           /* Style may have changed, drop our
              current cached style */
           invalidate_cached_style (layout);
+          plain_text = FALSE;
           /* Add the tag only after we have seen some non-toggle non-mark segment,
            * otherwise the tag is already accounted for by _gtk_text_btree_get_tags(). */
           if (!initial_toggle_segments)
@@ -2549,6 +3066,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
               
               if (layout->preedit_len > 0)
                 {
+                  plain_text = FALSE;
                   text_allocated += layout->preedit_len;
                   text = g_realloc (text, text_allocated);
 
@@ -2584,7 +3102,7 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   if (!para_values_set)
     {
       style = get_style (layout, tags);
-      set_para_values (layout, base_dir, style, display);
+      set_para_values (layout, ltr_context, rtl_context, base_dir, style, display);
       release_style (layout, style);
     }
   
@@ -2617,6 +3135,9 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   pango_layout_set_text (display->layout, text, layout_byte_offset);
   pango_layout_set_attributes (display->layout, attrs);
 
+  if (plain_text)
+    set_fixed_extents (layout, display, text, layout_byte_offset);
+
   tmp_list1 = cursor_byte_offsets;
   tmp_list2 = cursor_segs;
   while (tmp_list1)
@@ -2629,38 +3150,9 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   g_slist_free (cursor_byte_offsets);
   g_slist_free (cursor_segs);
 
-  pango_layout_get_extents (display->layout, NULL, &extents);
-
-  text_pixel_width = PIXEL_BOUND (extents.width);
-  display->width = text_pixel_width + display->left_margin + display->right_margin;
-
-  h_margin = display->left_margin + display->right_margin;
-  h_padding = layout->left_padding + layout->right_padding;
-
-  display->width = text_pixel_width + h_margin + h_padding;
-  display->height += PANGO_PIXELS (extents.height);
-
-  /* If we aren't wrapping, we need to do the alignment of each
-   * paragraph ourselves.
-   */
-  if (pango_layout_get_width (display->layout) < 0)
-    {
-      int excess = display->total_width - text_pixel_width;
+  if (measure)
+    gtk_text_layout_measure_display (layout, display);
 
-      switch (pango_layout_get_alignment (display->layout))
-        {
-        case PANGO_ALIGN_LEFT:
-        default:
-          break;
-        case PANGO_ALIGN_CENTER:
-          display->x_offset += excess / 2;
-          break;
-        case PANGO_ALIGN_RIGHT:
-          display->x_offset += excess;
-          break;
-        }
-    }
-  
   /* Free this if we aren't in a loop */
   if (layout->wrap_loop_count == 0)
     invalidate_cached_style (layout);
@@ -2673,11 +3165,25 @@ gtk_text_layout_create_display (GtkTextLayout *layout,
   display->has_children = saw_widget;
 
   if (saw_widget)
-    allocate_child_widgets (layout, display);
-  
+    {
+      g_assert (measure);
+      allocate_child_widgets (layout, display);
+    }
+
   return g_steal_pointer (&display);
 }
 
+GtkTextLineDisplay *
+gtk_text_layout_create_display (GtkTextLayout *layout,
+                                GtkTextLine   *line,
+                                gboolean       size_only)
+{
+  return gtk_text_layout_create_display_internal (layout, line, size_only,
+                                                  layout->ltr_context,
+                                                  layout->rtl_context,
+                                                  TRUE);
+}
+
 GtkTextLineDisplay *
 gtk_text_layout_get_line_display (GtkTextLayout *layout,
                                   GtkTextLine   *line,
@@ -2700,6 +3206,7 @@ gtk_text_line_display_finalize (GtkTextLineDisplay *display)
   g_clear_object (&display->layout);
   g_clear_pointer (&display->cursors, g_array_unref);
   g_clear_pointer (&display->node, gsk_render_node_unref);
+  g_clear_pointer (&display->selection_node, gsk_render_node_unref);
 }
 
 GtkTextLineDisplay *
@@ -3904,12 +4411,89 @@ gtk_text_layout_after_buffer_delete_range (GtkTextBuffer *textbuffer,
   gtk_text_layout_update_cursor_line (layout);
 }
 
+/* The paragraph background and the text, which don't depend on the
+ * selection or the cursors, so the node can be kept until the text
+ * or its attributes change
+ */
 static void
 render_para (GskPangoRenderer   *crenderer,
-             GtkTextLineDisplay *line_display,
-             int                 selection_start_index,
-             int                 selection_end_index,
-             float               cursor_alpha)
+             GtkTextLineDisplay *line_display)
+{
+  PangoLayout *layout = line_display->layout;
+  PangoLayoutIter *iter;
+  int screen_width;
+  gboolean first = TRUE;
+
+  g_return_if_fail (GTK_IS_TEXT_VIEW (crenderer->widget));
+
+  iter = pango_layout_get_iter (layout);
+  screen_width = line_display->total_width;
+
+  gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_NORMAL);
+
+  do
+    {
+      PangoLayoutLine *line = pango_layout_iter_get_line_readonly (iter);
+      int first_y, last_y;
+      PangoRectangle line_rect;
+      int baseline;
+
+      pango_layout_iter_get_line_extents (iter, NULL, &line_rect);
+      baseline = pango_layout_iter_get_baseline (iter);
+      pango_layout_iter_get_line_yrange (iter, &first_y, &last_y);
+
+      line_rect.x += line_display->x_offset * PANGO_SCALE;
+      baseline += line_display->top_margin * PANGO_SCALE;
+
+      if (line_display->pg_bg_rgba_set)
+        {
+          int bg_y, bg_height;
+
+          bg_y = PANGO_PIXELS (first_y) + line_display->top_margin;
+          bg_height = PANGO_PIXELS (last_y) - PANGO_PIXELS (first_y);
+
+          if (first)
+            {
+              bg_y -= line_display->top_margin;
+              bg_height += line_display->top_margin;
+            }
+
+          if (pango_layout_iter_at_last_line (iter))
+            bg_height += line_display->bottom_margin;
+
+          gtk_snapshot_append_color (crenderer->snapshot,
+                                     &line_display->pg_bg_rgba,
+                                     &GRAPHENE_RECT_INIT (line_display->left_margin,
+                                                          bg_y,
+                                                          screen_width,
+                                                          bg_height));
+        }
+
+      first = FALSE;
+
+      pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
+                                       line,
+                                       line_rect.x,
+                                       baseline);
+    }
+  while (pango_layout_iter_next_line (iter));
+
+  pango_layout_iter_free (iter);
+}
+
+/* The selection and the block cursor, drawn on top of the text of the
+ * paragraph. The selection is kept in its own node, while the block
+ * cursor blinks and is drawn again for every frame. Like the selection,
+ * it hides the text under it; it is not drawn on selected lines.
+ */
+static void
+render_para_overlay (GskPangoRenderer   *crenderer,
+                     GtkTextLineDisplay *line_display,
+                     int                 selection_start_index,
+                     int                 selection_end_index,
+                     gboolean            draw_selection,
+                     gboolean            draw_block_cursor,
+                     float               cursor_alpha)
 {
   GtkStyleContext *context;
   PangoLayout *layout = line_display->layout;
@@ -3925,7 +4509,8 @@ render_para (GskPangoRenderer   *crenderer,
   screen_width = line_display->total_width;
 
   context = _gtk_widget_get_style_context (crenderer->widget);
-  if (selection_start_index != -1 || selection_end_index != -1)
+  if (draw_selection &&
+      (selection_start_index != -1 || selection_end_index != -1))
     {
       GtkCssNode *selection_node = gtk_text_view_get_selection_node ((GtkTextView*)crenderer->widget);
       gtk_style_context_save_to_node (context, selection_node);
@@ -3975,6 +4560,9 @@ render_para (GskPangoRenderer   *crenderer,
       if (selection_start_index < byte_offset &&
           selection_end_index > line->length + byte_offset) /* All selected */
         {
+          if (!draw_selection)
+            goto next_line;
+
           gtk_snapshot_append_color (crenderer->snapshot,
                                      selection,
                                      &GRAPHENE_RECT_INIT (line_display->left_margin,
@@ -3987,121 +4575,109 @@ render_para (GskPangoRenderer   *crenderer,
                                            line_rect.x,
                                            baseline);
         }
-      else
+      /* Check if some part of the line is selected; the newline
+       * that is after line->length for the last line of the
+       * paragraph counts as part of the line for this
+       */
+      else if ((selection_start_index < byte_offset + line->length ||
+                (selection_start_index == byte_offset + line->length && pango_layout_iter_at_last_line (iter))) &&
+               selection_end_index > byte_offset)
         {
-          if (line_display->pg_bg_rgba_set)
-            gtk_snapshot_append_color (crenderer->snapshot,
-                                       &line_display->pg_bg_rgba,
-                                       &GRAPHENE_RECT_INIT (line_display->left_margin,
-                                                            selection_y,
-                                                            screen_width,
-                                                            selection_height));
+          int *ranges = NULL;
+          int n_ranges, i;
 
-          gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_NORMAL);
-          pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
-                                           line,
-                                           line_rect.x,
-                                           baseline);
+          if (!draw_selection)
+            goto next_line;
 
-          /* Check if some part of the line is selected; the newline
-           * that is after line->length for the last line of the
-           * paragraph counts as part of the line for this
-           */
-          if ((selection_start_index < byte_offset + line->length ||
-               (selection_start_index == byte_offset + line->length && pango_layout_iter_at_last_line (iter))) &&
-              selection_end_index > byte_offset)
-            {
-              int *ranges = NULL;
-              int n_ranges, i;
+          pango_layout_line_get_x_ranges (line, selection_start_index, selection_end_index, &ranges, &n_ranges);
+
+          gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_SELECTED);
 
-              pango_layout_line_get_x_ranges (line, selection_start_index, selection_end_index, &ranges, &n_ranges);
+          for (i = 0; i < n_ranges; i++)
+            {
+              graphene_rect_t bounds;
+
+              bounds.origin.x = line_display->x_offset + PANGO_PIXELS (ranges[2*i]);
+              bounds.origin.y = selection_y;
+              bounds.size.width = PANGO_PIXELS (ranges[2*i + 1]) - PANGO_PIXELS (ranges[2*i]);
+              bounds.size.height = selection_height;
+
+              gtk_snapshot_append_color (crenderer->snapshot, selection, &bounds);
+              gtk_snapshot_push_clip (crenderer->snapshot, &bounds);
+              pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
+                                               line,
+                                               line_rect.x,
+                                               baseline);
+              gtk_snapshot_pop (crenderer->snapshot);
+            }
 
-              gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_SELECTED);
+          g_free (ranges);
 
-              for (i = 0; i < n_ranges; i++)
-                {
-                  graphene_rect_t bounds;
-
-                  bounds.origin.x = line_display->x_offset + PANGO_PIXELS (ranges[2*i]);
-                  bounds.origin.y = selection_y;
-                  bounds.size.width = PANGO_PIXELS (ranges[2*i + 1]) - PANGO_PIXELS (ranges[2*i]);
-                  bounds.size.height = selection_height;
-
-                  gtk_snapshot_append_color (crenderer->snapshot, selection, &bounds);
-                  gtk_snapshot_push_clip (crenderer->snapshot, &bounds);
-                  pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
-                                                   line,
-                                                   line_rect.x,
-                                                   baseline);
-                  gtk_snapshot_pop (crenderer->snapshot);
-                }
+          /* Paint in the ends of the line */
+          if (line_rect.x > line_display->left_margin * PANGO_SCALE &&
+              ((line_display->direction == GTK_TEXT_DIR_LTR && selection_start_index < byte_offset) ||
+               (line_display->direction == GTK_TEXT_DIR_RTL && selection_end_index > byte_offset + line->length)))
+            gtk_snapshot_append_color (crenderer->snapshot,
+                                       selection,
+                                       &GRAPHENE_RECT_INIT (line_display->left_margin,
+                                                            selection_y,
+                                                            PANGO_PIXELS (line_rect.x) - line_display->left_margin,
+                                                            selection_height));
 
-              g_free (ranges);
-
-              /* Paint in the ends of the line */
-              if (line_rect.x > line_display->left_margin * PANGO_SCALE &&
-                  ((line_display->direction == GTK_TEXT_DIR_LTR && selection_start_index < byte_offset) ||
-                   (line_display->direction == GTK_TEXT_DIR_RTL && selection_end_index > byte_offset + line->length)))
-                gtk_snapshot_append_color (crenderer->snapshot,
-                                           selection,
-                                           &GRAPHENE_RECT_INIT (line_display->left_margin,
-                                                                selection_y,
-                                                                PANGO_PIXELS (line_rect.x) - line_display->left_margin,
-                                                                selection_height));
-
-              if (line_rect.x + line_rect.width <
-                  (screen_width + line_display->left_margin) * PANGO_SCALE &&
-                  ((line_display->direction == GTK_TEXT_DIR_LTR && selection_end_index > byte_offset + line->length) ||
-                   (line_display->direction == GTK_TEXT_DIR_RTL && selection_start_index < byte_offset)))
-                {
-                  int nonlayout_width = line_display->left_margin
-                                      + screen_width
-                                      - PANGO_PIXELS (line_rect.x)
-                                      - PANGO_PIXELS (line_rect.width);
-                  gtk_snapshot_append_color (crenderer->snapshot,
-                                             selection,
-                                             &GRAPHENE_RECT_INIT (PANGO_PIXELS (line_rect.x) + PANGO_PIXELS (line_rect.width),
-                                                                  selection_y,
-                                                                  nonlayout_width,
-                                                                  selection_height));
-                }
+          if (line_rect.x + line_rect.width <
+              (screen_width + line_display->left_margin) * PANGO_SCALE &&
+              ((line_display->direction == GTK_TEXT_DIR_LTR && selection_end_index > byte_offset + line->length) ||
+               (line_display->direction == GTK_TEXT_DIR_RTL && selection_start_index < byte_offset)))
+            {
+              int nonlayout_width = line_display->left_margin
+                                  + screen_width
+                                  - PANGO_PIXELS (line_rect.x)
+                                  - PANGO_PIXELS (line_rect.width);
+              gtk_snapshot_append_color (crenderer->snapshot,
+                                         selection,
+                                         &GRAPHENE_RECT_INIT (PANGO_PIXELS (line_rect.x) + PANGO_PIXELS (line_rect.width),
+                                                              selection_y,
+                                                              nonlayout_width,
+                                                              selection_height));
             }
-          else if (line_display->has_block_cursor &&
-                   gtk_widget_has_focus (crenderer->widget) &&
-                   byte_offset <= line_display->insert_index &&
-                   (line_display->insert_index < byte_offset + line->length ||
-                    (at_last_line && line_display->insert_index == byte_offset + line->length)))
+        }
+      else if (draw_block_cursor &&
+               line_display->has_block_cursor &&
+               gtk_widget_has_focus (crenderer->widget) &&
+               byte_offset <= line_display->insert_index &&
+               (line_display->insert_index < byte_offset + line->length ||
+                (at_last_line && line_display->insert_index == byte_offset + line->length)))
+        {
+          GdkRGBA cursor_color;
+          graphene_rect_t bounds = {
+            .origin.x = line_display->x_offset + line_display->block_cursor.x,
+            .origin.y = line_display->block_cursor.y + line_display->top_margin,
+            .size.width = line_display->block_cursor.width,
+            .size.height = line_display->block_cursor.height,
+          };
+
+          /* we draw text using base color on filled cursor rectangle of cursor color
+           * (normally white on black) */
+          _gtk_style_context_get_cursor_color (context, &cursor_color, NULL);
+
+          gtk_snapshot_push_opacity (crenderer->snapshot, cursor_alpha);
+          gtk_snapshot_append_color (crenderer->snapshot, &cursor_color, &bounds);
+
+          /* draw text under the cursor if any */
+          if (!line_display->cursor_at_line_end)
             {
-              GdkRGBA cursor_color;
-              graphene_rect_t bounds = {
-                .origin.x = line_display->x_offset + line_display->block_cursor.x,
-                .origin.y = line_display->block_cursor.y + line_display->top_margin,
-                .size.width = line_display->block_cursor.width,
-                .size.height = line_display->block_cursor.height,
-              };
-
-              /* we draw text using base color on filled cursor rectangle of cursor color
-               * (normally white on black) */
-              _gtk_style_context_get_cursor_color (context, &cursor_color, NULL);
-
-              gtk_snapshot_push_opacity (crenderer->snapshot, cursor_alpha);
-              gtk_snapshot_append_color (crenderer->snapshot, &cursor_color, &bounds);
-
-              /* draw text under the cursor if any */
-              if (!line_display->cursor_at_line_end)
-                {
-                  gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_CURSOR);
-                  gtk_snapshot_push_clip (crenderer->snapshot, &bounds);
-                  pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
-                                                   line,
-                                                   line_rect.x,
-                                                   baseline);
-                  gtk_snapshot_pop (crenderer->snapshot);
-                }
+              gsk_pango_renderer_set_state (crenderer, GSK_PANGO_RENDERER_CURSOR);
+              gtk_snapshot_push_clip (crenderer->snapshot, &bounds);
+              pango_renderer_draw_layout_line (PANGO_RENDERER (crenderer),
+                                               line,
+                                               line_rect.x,
+                                               baseline);
               gtk_snapshot_pop (crenderer->snapshot);
             }
+          gtk_snapshot_pop (crenderer->snapshot);
         }
 
+next_line:
       byte_offset += line->length;
     }
   while (pango_layout_iter_next_line (iter));
@@ -4124,6 +4700,47 @@ snapshot_shape (PangoAttrShape         *attr,
   return FALSE;
 }
 
+/* Lays out lines just past the edge of the viewport, so that they
+ * are in the display cache when they are scrolled into view.
+ */
+static gboolean
+gtk_text_layout_prefetch_displays_cb (gpointer data)
+{
+  GtkTextLayout *layout = data;
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLine *line;
+  guint i, n_lines;
+
+  priv->cache_prefetch_source = 0;
+
+  if (layout->buffer == NULL || priv->cache_prefetch_y < 0)
+    return G_SOURCE_REMOVE;
+
+  line = _gtk_text_btree_find_line_by_y (_gtk_text_buffer_get_btree (layout->buffer),
+                                         layout, priv->cache_prefetch_y, NULL);
+  if (line == NULL)
+    return G_SOURCE_REMOVE;
+
+  n_lines = MAX (priv->n_visible_lines / 2, 1);
+
+  gtk_text_layout_wrap_loop_start (layout);
+
+  for (i = 0; i < n_lines && line != NULL; i++)
+    {
+      if (gtk_text_line_display_cache_note_prefetch (priv->cache, line))
+        gtk_text_line_display_unref (gtk_text_line_display_cache_get (priv->cache, layout, line, FALSE));
+
+      if (priv->cache_prefetch_down)
+        line = _gtk_text_line_next_excluding_last (line);
+      else
+        line = _gtk_text_line_previous (line);
+    }
+
+  gtk_text_layout_wrap_loop_end (layout);
+
+  return G_SOURCE_REMOVE;
+}
+
 void
 gtk_text_layout_snapshot (GtkTextLayout      *layout,
                           GtkWidget          *widget,
@@ -4235,22 +4852,41 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
           if (line_display->node == NULL)
             {
               gtk_snapshot_push_collect (snapshot);
-              render_para (crenderer, line_display,
-                           selection_start_index, selection_end_index,
-                           cursor_alpha);
-
+              render_para (crenderer, line_display);
               line_display->node = gtk_snapshot_pop_collect (snapshot);
             }
 
-          if (line_display->node != NULL)
+          /* The selection is cached separately from the text, so that
+           * selecting or moving the cursor doesn't lay out the glyphs again
+           */
+          if (selection_start_index == -1 && selection_end_index == -1)
+            g_clear_pointer (&line_display->selection_node, gsk_render_node_unref);
+          else if (line_display->selection_node == NULL)
             {
-              gtk_snapshot_save (crenderer->snapshot);
-              gtk_snapshot_translate (crenderer->snapshot,
-                                      &GRAPHENE_POINT_INIT (0, offset_y));
-              gtk_snapshot_append_node (crenderer->snapshot, line_display->node);
-              gtk_snapshot_restore (crenderer->snapshot);
+              gtk_snapshot_push_collect (snapshot);
+              render_para_overlay (crenderer, line_display,
+                                   selection_start_index, selection_end_index,
+                                   TRUE, FALSE, cursor_alpha);
+              line_display->selection_node = gtk_snapshot_pop_collect (snapshot);
             }
 
+          gtk_snapshot_save (crenderer->snapshot);
+          gtk_snapshot_translate (crenderer->snapshot,
+                                  &GRAPHENE_POINT_INIT (0, offset_y));
+
+          if (line_display->node != NULL)
+            gtk_snapshot_append_node (crenderer->snapshot, line_display->node);
+
+          if (line_display->selection_node != NULL)
+            gtk_snapshot_append_node (crenderer->snapshot, line_display->selection_node);
+
+          if (line_display->has_block_cursor)
+            render_para_overlay (crenderer, line_display,
+                                 selection_start_index, selection_end_index,
+                                 FALSE, TRUE, cursor_alpha);
+
+          gtk_snapshot_restore (crenderer->snapshot);
+
           /* We paint the cursors last, because they overlap another chunk
            * and need to appear on top.
            */
@@ -4294,6 +4930,22 @@ gtk_text_layout_snapshot (GtkTextLayout      *layout,
   g_slist_free (line_list);
 
   gsk_pango_renderer_release (crenderer);
+
+  if (clip->y != priv->last_snapshot_y)
+    {
+      priv->cache_prefetch_down = clip->y > priv->last_snapshot_y;
+      priv->cache_prefetch_y = priv->cache_prefetch_down ? clip->y + clip->height : clip->y - 1;
+      priv->last_snapshot_y = clip->y;
+
+      if (priv->cache_prefetch_source == 0 && priv->n_visible_lines > 0)
+        {
+          priv->cache_prefetch_source = g_idle_add_full (G_PRIORITY_LOW,
+                                                         gtk_text_layout_prefetch_displays_cb,
+                                                         layout, NULL);
+          g_source_set_name_by_id (priv->cache_prefetch_source,
+                                   "[gtk] gtk_text_layout_prefetch_displays_cb");
+        }
+    }
 }
 
 int
@@ -4316,10 +4968,20 @@ gtk_text_line_display_compare (const GtkTextLineDisplay *display1,
 }
 
 void
-gtk_text_layout_set_mru_size (GtkTextLayout *layout,
-                              guint          mru_size)
+gtk_text_layout_set_visible_lines (GtkTextLayout *layout,
+                                   guint          n_visible_lines)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  priv->n_visible_lines = n_visible_lines;
+  gtk_text_line_display_cache_set_visible_lines (priv->cache, n_visible_lines);
+}
+
+void
+gtk_text_layout_get_cache_stats (GtkTextLayout                *layout,
+                                 GtkTextLineDisplayCacheStats *stats)
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
 
-  gtk_text_line_display_cache_set_mru_size (priv->cache, mru_size);
+  gtk_text_line_display_cache_get_stats (priv->cache, stats);
 }
@@ -187,6 +187,7 @@ struct _GtkTextLineDisplay
   PangoLayout *layout;
 
   GskRenderNode *node;
+  GskRenderNode *selection_node;
 
   GArray *cursors;      /* indexes of cursors in the PangoLayout, and mark names */
 
@@ -196,6 +197,9 @@ struct _GtkTextLineDisplay
   /* GQueue link for use in MRU to help cull cache */
   GList          mru_link;
 
+  /* Estimated memory use, accounted by the cache */
+  gsize          n_bytes;
+
   GtkTextDirection direction;
 
   int width;                   /* Width of layout */
@@ -221,6 +225,11 @@ struct _GtkTextLineDisplay
   guint size_only : 1;
   guint pg_bg_rgba_set : 1;
   guint has_children : 1;
+  guint has_fixed_extents : 1;
+
+  /* Text extents in Pango units, if has_fixed_extents is set */
+  int fixed_width;
+  int fixed_height;
 
   GdkRGBA pg_bg_rgba;
 };
@@ -244,6 +253,8 @@ void               gtk_text_layout_set_cursor_direction  (GtkTextLayout     *lay
                                                           GtkTextDirection   direction);
 void		   gtk_text_layout_set_overwrite_mode	 (GtkTextLayout     *layout,
 							  gboolean           overwrite);
+void               gtk_text_layout_set_monospace         (GtkTextLayout     *layout,
+                                                          gboolean           monospace);
 void               gtk_text_layout_set_keyboard_direction (GtkTextLayout     *layout,
 							   GtkTextDirection keyboard_dir);
 void               gtk_text_layout_default_style_changed (GtkTextLayout     *layout);
@@ -390,8 +401,8 @@ void gtk_text_layout_snapshot (GtkTextLayout        *layout,
                                const GdkRectangle   *clip,
                                float                 cursor_alpha);
 
-void gtk_text_layout_set_mru_size (GtkTextLayout *layout,
-                                   guint          mru_size);
+void gtk_text_layout_set_visible_lines (GtkTextLayout *layout,
+                                        guint          n_visible_lines);
 
 G_END_DECLS
 
@@ -24,10 +24,26 @@
 #include "gtktextiterprivate.h"
 #include "gtktextlinedisplaycacheprivate.h"
 
+/* The cache keeps MRU_VISIBLE_FACTOR times the number of lines that
+ * fit into the viewport, so that scrolling back and forth by a couple
+ * of pages does not recreate layouts. The byte budget bounds this for
+ * very long lines. After being idle for TRIM_CACHE_TIMEOUT_SEC the cache
+ * is trimmed down to what is needed to redraw the viewport.
+ */
 #define DEFAULT_MRU_SIZE         250
-#define BLOW_CACHE_TIMEOUT_SEC   20
+#define MIN_MRU_SIZE             32
+#define MRU_VISIBLE_FACTOR       5
+#define DEFAULT_MAX_BYTES        (8 * 1024 * 1024)
+#define TRIM_CACHE_TIMEOUT_SEC   20
 #define DEBUG_LINE_DISPLAY_CACHE 0
 
+/* Rough cost of a PangoLayout: a fixed overhead, glyph info, log
+ * clusters and log attrs per character, plus the UTF-8 text itself.
+ */
+#define BYTES_PER_LAYOUT         256
+#define BYTES_PER_CHAR           (sizeof (PangoGlyphInfo) + sizeof (int) + sizeof (PangoLogAttr) + 1)
+#define BYTES_PER_LINE           (sizeof (PangoLayoutLine) + sizeof (PangoGlyphItem) + sizeof (PangoGlyphString) + sizeof (PangoItem))
+
 struct _GtkTextLineDisplayCache
 {
   GSequence   *sorted_by_line;
@@ -36,40 +52,58 @@ struct _GtkTextLineDisplayCache
   GQueue       mru;
   GSource     *evict_source;
   guint        mru_size;
+  guint        min_size;
+  gsize        n_bytes;
+  gsize        max_bytes;
 
-#if DEBUG_LINE_DISPLAY_CACHE
-  guint       log_source;
-  int         hits;
-  int         misses;
-  int         inval;
-  int         inval_cursors;
-  int         inval_by_line;
-  int         inval_by_range;
-  int         inval_by_y_range;
-#endif
+  GtkTextLineDisplayCacheStats stats;
 };
 
-#if DEBUG_LINE_DISPLAY_CACHE
-# define STAT_ADD(val,n) ((val) += n)
-# define STAT_INC(val)   STAT_ADD(val,1)
-static gboolean
-dump_stats (gpointer data)
+#define STAT_ADD(val,n) ((val) += n)
+#define STAT_INC(val)   STAT_ADD(val,1)
+
+static gsize
+gtk_text_line_display_get_n_bytes (GtkTextLineDisplay *display)
 {
-  GtkTextLineDisplayCache *cache = data;
-  g_printerr ("%p: size=%u hits=%d misses=%d inval_total=%d "
-              "inval_cursors=%d inval_by_line=%d "
-              "inval_by_range=%d inval_by_y_range=%d\n",
-              cache, g_hash_table_size (cache->line_to_display),
-              cache->hits, cache->misses,
-              cache->inval, cache->inval_cursors,
-              cache->inval_by_line, cache->inval_by_range,
-              cache->inval_by_y_range);
-  return G_SOURCE_CONTINUE;
+  gsize n_bytes = sizeof (GtkTextLineDisplay);
+
+  if (display->layout != NULL)
+    {
+      PangoAttrList *attrs;
+
+      n_bytes += BYTES_PER_LAYOUT;
+      n_bytes += pango_layout_get_character_count (display->layout) * BYTES_PER_CHAR;
+      n_bytes += pango_layout_get_line_count (display->layout) * BYTES_PER_LINE;
+
+      attrs = pango_layout_get_attributes (display->layout);
+      if (attrs != NULL)
+        {
+          PangoAttrIterator *iter = pango_attr_list_get_iterator (attrs);
+
+          do
+            n_bytes += sizeof (PangoAttribute) * 2;
+          while (pango_attr_iterator_next (iter));
+
+          pango_attr_iterator_destroy (iter);
+        }
+    }
+
+  return n_bytes;
+}
+
+static void
+gtk_text_line_display_cache_cull (GtkTextLineDisplayCache *cache,
+                                  guint                    mru_size)
+{
+  while (cache->mru.length > mru_size ||
+         (cache->n_bytes > cache->max_bytes && cache->mru.length > cache->min_size))
+    {
+      GtkTextLineDisplay *display = g_queue_peek_tail (&cache->mru);
+
+      gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
+      STAT_INC (cache->stats.evicted);
+    }
 }
-#else
-# define STAT_ADD(val,n)
-# define STAT_INC(val)
-#endif
 
 GtkTextLineDisplayCache *
 gtk_text_line_display_cache_new (void)
@@ -80,10 +114,8 @@ gtk_text_line_display_cache_new (void)
   ret->sorted_by_line = g_sequence_new ((GDestroyNotify)gtk_text_line_display_unref);
   ret->line_to_display = g_hash_table_new (NULL, NULL);
   ret->mru_size = DEFAULT_MRU_SIZE;
-
-#if DEBUG_LINE_DISPLAY_CACHE
-  ret->log_source = g_timeout_add_seconds (1, dump_stats, ret);
-#endif
+  ret->min_size = MIN_MRU_SIZE;
+  ret->max_bytes = DEFAULT_MAX_BYTES;
 
   return g_steal_pointer (&ret);
 }
@@ -91,10 +123,6 @@ gtk_text_line_display_cache_new (void)
 void
 gtk_text_line_display_cache_free (GtkTextLineDisplayCache *cache)
 {
-#if DEBUG_LINE_DISPLAY_CACHE
-  g_clear_handle_id (&cache->log_source, g_source_remove);
-#endif
-
   gtk_text_line_display_cache_invalidate (cache);
 
   g_clear_pointer (&cache->evict_source, g_source_destroy);
@@ -104,19 +132,18 @@ gtk_text_line_display_cache_free (GtkTextLineDisplayCache *cache)
 }
 
 static gboolean
-gtk_text_line_display_cache_blow_cb (gpointer data)
+gtk_text_line_display_cache_trim_cb (gpointer data)
 {
   GtkTextLineDisplayCache *cache = data;
 
   g_assert (cache != NULL);
 
-#if DEBUG_LINE_DISPLAY_CACHE
-  g_printerr ("Evicting GtkTextLineDisplayCache\n");
-#endif
-
   cache->evict_source = NULL;
 
-  gtk_text_line_display_cache_invalidate (cache);
+  /* Keep what is needed to redraw the viewport, the least recently
+   * used displays are the ones that scrolled out of view.
+   */
+  gtk_text_line_display_cache_cull (cache, cache->min_size);
 
   return G_SOURCE_REMOVE;
 }
@@ -130,18 +157,18 @@ gtk_text_line_display_cache_delay_eviction (GtkTextLineDisplayCache *cache)
     {
       gint64 deadline;
 
-      deadline = g_get_monotonic_time () + (BLOW_CACHE_TIMEOUT_SEC * G_USEC_PER_SEC);
+      deadline = g_get_monotonic_time () + (TRIM_CACHE_TIMEOUT_SEC * G_USEC_PER_SEC);
       g_source_set_ready_time (cache->evict_source, deadline);
     }
   else
     {
       guint tag;
 
-      tag = g_timeout_add_seconds (BLOW_CACHE_TIMEOUT_SEC,
-                                   gtk_text_line_display_cache_blow_cb,
+      tag = g_timeout_add_seconds (TRIM_CACHE_TIMEOUT_SEC,
+                                   gtk_text_line_display_cache_trim_cb,
                                    cache);
       cache->evict_source = g_main_context_find_source_by_id (NULL, tag);
-      g_source_set_name (cache->evict_source, "[gtk+] gtk_text_line_display_cache_blow_cb");
+      g_source_set_name (cache->evict_source, "[gtk+] gtk_text_line_display_cache_trim_cb");
     }
 }
 
@@ -201,13 +228,11 @@ gtk_text_line_display_cache_take_display (GtkTextLineDisplayCache *cache,
   g_hash_table_insert (cache->line_to_display, display->line, display);
   g_queue_push_head_link (&cache->mru, &display->mru_link);
 
-  /* Cull the cache if we're at capacity */
-  while (cache->mru.length > cache->mru_size)
-    {
-      display = g_queue_peek_tail (&cache->mru);
+  display->n_bytes = gtk_text_line_display_get_n_bytes (display);
+  cache->n_bytes += display->n_bytes;
 
-      gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
-    }
+  /* Cull the cache if we're at capacity */
+  gtk_text_line_display_cache_cull (cache, cache->mru_size);
 }
 
 /*
@@ -234,7 +259,7 @@ gtk_text_line_display_cache_invalidate_display (GtkTextLineDisplayCache *cache,
   if (cursors_only)
     {
       g_clear_pointer (&display->cursors, g_array_unref);
-      g_clear_pointer (&display->node, gsk_render_node_unref);
+      g_clear_pointer (&display->selection_node, gsk_render_node_unref);
       display->cursors_invalid = TRUE;
       display->has_block_cursor = FALSE;
     }
@@ -248,11 +273,14 @@ gtk_text_line_display_cache_invalidate_display (GtkTextLineDisplayCache *cache,
       g_hash_table_remove (cache->line_to_display, display->line);
       g_queue_unlink (&cache->mru, &display->mru_link);
 
+      g_assert (cache->n_bytes >= display->n_bytes);
+      cache->n_bytes -= display->n_bytes;
+
       if (iter != NULL)
         g_sequence_remove (iter);
     }
 
-  STAT_INC (cache->inval);
+  STAT_INC (cache->stats.inval);
 }
 
 /*
@@ -289,7 +317,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
     {
       if (size_only || !display->size_only)
         {
-          STAT_INC (cache->hits);
+          STAT_INC (cache->stats.hits);
 
           if (!size_only && display->line == cache->cursor_line)
             gtk_text_layout_update_display_cursors (layout, display->line, display);
@@ -311,7 +339,7 @@ gtk_text_line_display_cache_get (GtkTextLineDisplayCache *cache,
       gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
     }
 
-  STAT_INC (cache->misses);
+  STAT_INC (cache->stats.misses);
 
   g_assert (!g_hash_table_lookup (cache->line_to_display, line));
 
@@ -343,7 +371,7 @@ gtk_text_line_display_cache_invalidate (GtkTextLineDisplayCache *cache)
   g_assert (cache->sorted_by_line != NULL);
   g_assert (cache->line_to_display != NULL);
 
-  STAT_ADD (cache->inval, g_hash_table_size (cache->line_to_display));
+  STAT_ADD (cache->stats.inval, g_hash_table_size (cache->line_to_display));
 
   cache->cursor_line = NULL;
 
@@ -368,7 +396,7 @@ gtk_text_line_display_cache_invalidate_cursors (GtkTextLineDisplayCache *cache,
   g_assert (cache != NULL);
   g_assert (line != NULL);
 
-  STAT_INC (cache->inval_cursors);
+  STAT_INC (cache->stats.inval_cursors);
 
   display = g_hash_table_lookup (cache->line_to_display, line);
 
@@ -400,7 +428,7 @@ gtk_text_line_display_cache_invalidate_line (GtkTextLineDisplayCache *cache,
   if (display != NULL)
     gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
 
-  STAT_INC (cache->inval_by_line);
+  STAT_INC (cache->stats.inval_by_line);
 }
 
 static GSequenceIter *
@@ -501,7 +529,7 @@ gtk_text_line_display_cache_invalidate_range (GtkTextLineDisplayCache *cache,
   g_assert (begin != NULL);
   g_assert (end != NULL);
 
-  STAT_INC (cache->inval_by_range);
+  STAT_INC (cache->stats.inval_by_range);
 
   /* Short-circuit, is_empty() is O(1) */
   if (g_sequence_is_empty (cache->sorted_by_line))
@@ -511,8 +539,8 @@ gtk_text_line_display_cache_invalidate_range (GtkTextLineDisplayCache *cache,
   if (gtk_text_iter_compare (begin, end) > 0)
     {
       const GtkTextIter *tmp = begin;
-      end = begin;
-      begin = tmp;
+      begin = end;
+      end = tmp;
     }
 
   /* Common case, begin/end on same line. Just try to find the line by
@@ -669,7 +697,7 @@ gtk_text_line_display_cache_invalidate_y_range (GtkTextLineDisplayCache *cache,
   g_assert (cache != NULL);
   g_assert (layout != NULL);
 
-  STAT_INC (cache->inval_by_y_range);
+  STAT_INC (cache->stats.inval_by_y_range);
 
   /* A common pattern is to invalidate the whole buffer using y==0 and
    * old_height==new_height. So special case that instead of walking through
@@ -738,26 +766,73 @@ gtk_text_line_display_cache_set_cursor_line (GtkTextLineDisplayCache *cache,
     gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
 }
 
+/*
+ * gtk_text_line_display_cache_set_visible_lines:
+ * @cache: a GtkTextLineDisplayCache
+ * @n_visible_lines: the number of lines that fit into the viewport,
+ *   or 0 to use the default size
+ *
+ * Sizes the cache so that a few pages around the viewport stay cached.
+ */
 void
-gtk_text_line_display_cache_set_mru_size (GtkTextLineDisplayCache *cache,
-                                          guint                    mru_size)
+gtk_text_line_display_cache_set_visible_lines (GtkTextLineDisplayCache *cache,
+                                               guint                    n_visible_lines)
 {
-  GtkTextLineDisplay *display;
+  guint mru_size;
 
   g_assert (cache != NULL);
 
-  if (mru_size == 0)
-    mru_size = DEFAULT_MRU_SIZE;
+  if (n_visible_lines == 0)
+    {
+      cache->min_size = MIN_MRU_SIZE;
+      mru_size = DEFAULT_MRU_SIZE;
+    }
+  else
+    {
+      cache->min_size = MAX (n_visible_lines, MIN_MRU_SIZE);
+      mru_size = MAX (n_visible_lines * MRU_VISIBLE_FACTOR, MIN_MRU_SIZE);
+    }
 
   if (mru_size != cache->mru_size)
     {
       cache->mru_size = mru_size;
+      gtk_text_line_display_cache_cull (cache, cache->mru_size);
+    }
+}
 
-      while (cache->mru.length > cache->mru_size)
-        {
-          display = g_queue_peek_tail (&cache->mru);
+/*
+ * gtk_text_line_display_cache_note_prefetch:
+ * @cache: a GtkTextLineDisplayCache
+ * @line: a GtkTextLine
+ *
+ * Returns %TRUE if @line still needs to be laid out, and accounts it
+ * as a prefetch in the statistics.
+ */
+gboolean
+gtk_text_line_display_cache_note_prefetch (GtkTextLineDisplayCache *cache,
+                                           GtkTextLine             *line)
+{
+  g_assert (cache != NULL);
+  g_assert (line != NULL);
 
-          gtk_text_line_display_cache_invalidate_display (cache, display, FALSE);
-        }
-    }
+  if (g_hash_table_contains (cache->line_to_display, line))
+    return FALSE;
+
+  STAT_INC (cache->stats.prefetched);
+
+  return TRUE;
+}
+
+void
+gtk_text_line_display_cache_get_stats (GtkTextLineDisplayCache      *cache,
+                                       GtkTextLineDisplayCacheStats *stats)
+{
+  g_assert (cache != NULL);
+  g_assert (stats != NULL);
+
+  *stats = cache->stats;
+  stats->n_displays = cache->mru.length;
+  stats->mru_size = cache->mru_size;
+  stats->n_bytes = cache->n_bytes;
+  stats->max_bytes = cache->max_bytes;
 }
@@ -26,6 +26,23 @@ G_BEGIN_DECLS
 
 typedef struct _GtkTextLineDisplayCache GtkTextLineDisplayCache;
 
+typedef struct
+{
+  guint n_displays;
+  guint mru_size;
+  gsize n_bytes;
+  gsize max_bytes;
+  guint hits;
+  guint misses;
+  guint prefetched;
+  guint evicted;
+  guint inval;
+  guint inval_cursors;
+  guint inval_by_line;
+  guint inval_by_range;
+  guint inval_by_y_range;
+} GtkTextLineDisplayCacheStats;
+
 GtkTextLineDisplayCache *gtk_text_line_display_cache_new                (void);
 void                     gtk_text_line_display_cache_free               (GtkTextLineDisplayCache *cache);
 GtkTextLineDisplay      *gtk_text_line_display_cache_get                (GtkTextLineDisplayCache *cache,
@@ -54,8 +71,15 @@ void                     gtk_text_line_display_cache_invalidate_y_range (GtkText
                                                                          int                      old_height,
                                                                          int                      new_height,
                                                                          gboolean                 cursors_only);
-void                     gtk_text_line_display_cache_set_mru_size       (GtkTextLineDisplayCache *cache,
-                                                                         guint                    mru_size);
+void                     gtk_text_line_display_cache_set_visible_lines  (GtkTextLineDisplayCache *cache,
+                                                                         guint                    n_visible_lines);
+gboolean                 gtk_text_line_display_cache_note_prefetch      (GtkTextLineDisplayCache *cache,
+                                                                         GtkTextLine             *line);
+void                     gtk_text_line_display_cache_get_stats          (GtkTextLineDisplayCache *cache,
+                                                                         GtkTextLineDisplayCacheStats *stats);
+
+void                     gtk_text_layout_get_cache_stats                (GtkTextLayout                *layout,
+                                                                         GtkTextLineDisplayCacheStats *stats);
 
 G_END_DECLS
 
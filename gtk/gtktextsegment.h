@@ -49,6 +49,7 @@ struct _GtkTextTagInfo {
   GtkTextTag *tag;
   GtkTextBTreeNode *tag_root; /* highest-level node containing the tag */
   int toggle_count;      /* total toggles of this tag below tag_root */
+  guint index;           /* bit of this tag in the node tag masks */
 };
 
 /* Body of a segment that toggles a tag on or off */
@@ -40,6 +40,7 @@
 #include "gtksettings.h"
 #include "gtktextiterprivate.h"
 #include "gtkimmulticontext.h"
+#include "gtkidleschedulerprivate.h"
 #include "gtkprivate.h"
 #include "gtktextutil.h"
 #include "gtkwidgetprivate.h"
@@ -1960,6 +1961,12 @@ gtk_text_view_get_selection_node (GtkTextView *text_view)
   return text_view->priv->selection_node;
 }
 
+GtkTextLayout *
+gtk_text_view_get_layout (GtkTextView *text_view)
+{
+  return text_view->priv->layout;
+}
+
 static void
 _gtk_text_view_ensure_magnifier (GtkTextView *text_view)
 {
@@ -3758,7 +3765,7 @@ gtk_text_view_remove_validate_idles (GtkTextView *text_view)
 
   if (priv->incremental_validate_idle != 0)
     {
-      g_source_remove (priv->incremental_validate_idle);
+      gtk_idle_scheduler_remove (priv->incremental_validate_idle);
       priv->incremental_validate_idle = 0;
     }
 }
@@ -4425,7 +4432,7 @@ gtk_text_view_size_allocate (GtkWidget *widget,
   GdkRectangle bottom_rect;
   GtkWidget *chooser;
   PangoLayout *layout;
-  guint mru_size;
+  guint n_visible_lines;
   
   text_view = GTK_TEXT_VIEW (widget);
   priv = text_view->priv;
@@ -4515,8 +4522,8 @@ gtk_text_view_size_allocate (GtkWidget *widget,
   pango_layout_get_pixel_size (layout, &width, &height);
   if (height > 0)
     {
-      mru_size = SCREEN_HEIGHT (widget) / height * 3;
-      gtk_text_layout_set_mru_size (priv->layout, mru_size);
+      n_visible_lines = SCREEN_HEIGHT (widget) / height + 1;
+      gtk_text_layout_set_visible_lines (priv->layout, n_visible_lines);
     }
   g_object_unref (layout);
 
@@ -4658,14 +4665,18 @@ first_validate_callback (gpointer data)
 }
 
 static gboolean
-incremental_validate_callback (gpointer data)
+incremental_validate_callback (gpointer data,
+                               gint64   deadline)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
 
   DV(g_print(G_STRLOC"\n"));
   
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+  do
+    gtk_text_layout_validate (text_view->priv->layout, 2000);
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < deadline);
 
   gtk_text_view_update_adjustments (text_view);
   
@@ -4702,8 +4713,7 @@ gtk_text_view_invalidate (GtkTextView *text_view)
       
   if (!priv->incremental_validate_idle)
     {
-      priv->incremental_validate_idle = g_idle_add_full (GTK_TEXT_VIEW_PRIORITY_VALIDATE, incremental_validate_callback, text_view, NULL);
-      g_source_set_name_by_id (priv->incremental_validate_idle, "[gtk] incremental_validate_callback");
+      priv->incremental_validate_idle = gtk_idle_scheduler_add (GTK_TEXT_VIEW_PRIORITY_VALIDATE, incremental_validate_callback, text_view, NULL);
       DV (g_print (G_STRLOC": adding incremental validate idle %d\n",
                    priv->incremental_validate_idle));
     }
@@ -7601,6 +7611,8 @@ gtk_text_view_ensure_layout (GtkTextView *text_view)
 
       gtk_text_layout_set_overwrite_mode (priv->layout,
 					  priv->overwrite_mode && priv->editable);
+      gtk_text_layout_set_monospace (priv->layout,
+                                     gtk_text_view_get_monospace (text_view));
 
       ltr_context = gtk_widget_create_pango_context (GTK_WIDGET (text_view));
       pango_context_set_base_dir (ltr_context, PANGO_DIRECTION_LTR);
@@ -9592,6 +9604,9 @@ gtk_text_view_set_monospace (GtkTextView *text_view,
       else
         gtk_widget_remove_css_class (GTK_WIDGET (text_view), "monospace");
 
+      if (text_view->priv->layout)
+        gtk_text_layout_set_monospace (text_view->priv->layout, monospace);
+
       g_object_notify (G_OBJECT (text_view), "monospace");
     }
 }
@@ -22,11 +22,13 @@
 #include "gtktextview.h"
 #include "gtktextattributes.h"
 #include "gtkcssnodeprivate.h"
+#include "gtktextlayoutprivate.h"
 
 G_BEGIN_DECLS
 
 GtkCssNode *    gtk_text_view_get_text_node             (GtkTextView *text_view);
 GtkCssNode *    gtk_text_view_get_selection_node        (GtkTextView *text_view);
+GtkTextLayout * gtk_text_view_get_layout                (GtkTextView *text_view);
 
 GtkTextAttributes * gtk_text_view_get_default_attributes (GtkTextView *text_view);
 
@@ -0,0 +1,347 @@
+/* gtkthumbnailloader.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkthumbnailloaderprivate.h"
+
+/* Loads thumbnail files, such as the ones in the freedesktop
+ * thumbnail cache, off the main thread.
+ *
+ * Files are mapped and decoded at the requested size in a worker
+ * thread. Requests for the same file and size share a single load,
+ * and a load that nobody wants anymore by the time it gets to run
+ * is skipped. The results are kept in a process-wide cache that
+ * drops the least recently used thumbnails first.
+ *
+ * All functions must be called from the main thread.
+ */
+
+#define MAX_CACHED_THUMBNAILS 256
+
+typedef struct
+{
+  char *key;
+  GdkPixbuf *pixbuf;
+  GList link;
+} CacheEntry;
+
+typedef struct
+{
+  char *path;
+  char *key;
+  int size;
+} LoadData;
+
+/* key => CacheEntry */
+static GHashTable *cache;
+/* CacheEntry, most recently used first */
+static GQueue lru = G_QUEUE_INIT;
+
+/* key => GPtrArray of GTasks waiting for the load.
+ * Worker threads look at this too, so it is protected by a lock.
+ */
+static GHashTable *pending;
+G_LOCK_DEFINE_STATIC (pending);
+
+static char *
+make_key (const char *path,
+          int         size)
+{
+  return g_strdup_printf ("%d:%s", size, path);
+}
+
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_queue_unlink (&lru, &entry->link);
+  g_object_unref (entry->pixbuf);
+  g_free (entry->key);
+  g_slice_free (CacheEntry, entry);
+}
+
+static void
+cache_insert (const char *key,
+              GdkPixbuf  *pixbuf)
+{
+  CacheEntry *entry;
+
+  if (cache == NULL)
+    cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cache_entry_free);
+
+  entry = g_slice_new0 (CacheEntry);
+  entry->key = g_strdup (key);
+  entry->pixbuf = g_object_ref (pixbuf);
+  entry->link.data = entry;
+
+  g_hash_table_replace (cache, entry->key, entry);
+  g_queue_push_head_link (&lru, &entry->link);
+
+  while (lru.length > MAX_CACHED_THUMBNAILS)
+    {
+      CacheEntry *oldest = g_queue_peek_tail (&lru);
+
+      g_hash_table_remove (cache, oldest->key);
+    }
+}
+
+/*< private >
+ * gtk_thumbnail_loader_lookup:
+ * @path: the path of the thumbnail file
+ * @size: the size the thumbnail was loaded at
+ *
+ * Looks up a thumbnail that has already been loaded.
+ *
+ * Returns: (transfer full) (nullable): the thumbnail, or %NULL
+ *   if it has not been loaded
+ */
+GdkPixbuf *
+gtk_thumbnail_loader_lookup (const char *path,
+                             int         size)
+{
+  CacheEntry *entry;
+  char *key;
+
+  if (cache == NULL)
+    return NULL;
+
+  key = make_key (path, size);
+  entry = g_hash_table_lookup (cache, key);
+  g_free (key);
+
+  if (entry == NULL)
+    return NULL;
+
+  g_queue_unlink (&lru, &entry->link);
+  g_queue_push_head_link (&lru, &entry->link);
+
+  return g_object_ref (entry->pixbuf);
+}
+
+static void
+load_data_free (gpointer data)
+{
+  LoadData *load = data;
+
+  g_free (load->path);
+  g_free (load->key);
+  g_slice_free (LoadData, load);
+}
+
+static gboolean
+load_is_wanted (const char *key)
+{
+  GPtrArray *waiters;
+  gboolean wanted = FALSE;
+  guint i;
+
+  G_LOCK (pending);
+
+  waiters = g_hash_table_lookup (pending, key);
+  for (i = 0; waiters && i < waiters->len; i++)
+    {
+      GCancellable *cancellable = g_task_get_cancellable (g_ptr_array_index (waiters, i));
+
+      if (cancellable == NULL || !g_cancellable_is_cancelled (cancellable))
+        {
+          wanted = TRUE;
+          break;
+        }
+    }
+
+  G_UNLOCK (pending);
+
+  return wanted;
+}
+
+static void
+load_thread (GTask        *task,
+             gpointer      source_object,
+             gpointer      task_data,
+             GCancellable *cancellable)
+{
+  LoadData *load = task_data;
+  GMappedFile *mapped;
+  GBytes *bytes;
+  GInputStream *stream;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  /* The rows that asked for it may have scrolled away while
+   * we were waiting for a thread
+   */
+  if (!load_is_wanted (load->key))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                               "Thumbnail no longer needed");
+      return;
+    }
+
+  mapped = g_mapped_file_new (load->path, FALSE, &error);
+  if (mapped == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  stream = g_memory_input_stream_new_from_bytes (bytes);
+  g_bytes_unref (bytes);
+
+  pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
+                                                load->size, load->size,
+                                                TRUE,
+                                                NULL,
+                                                &error);
+  g_object_unref (stream);
+
+  if (pixbuf == NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, pixbuf, g_object_unref);
+}
+
+static void
+load_done (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  LoadData *load = g_task_get_task_data (G_TASK (result));
+  GPtrArray *waiters = NULL;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+  guint i;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (result), &error);
+
+  if (pixbuf)
+    cache_insert (load->key, pixbuf);
+
+  G_LOCK (pending);
+  g_hash_table_steal_extended (pending, load->key, NULL, (gpointer *) &waiters);
+  G_UNLOCK (pending);
+
+  for (i = 0; waiters && i < waiters->len; i++)
+    {
+      GTask *task = g_ptr_array_index (waiters, i);
+
+      if (pixbuf)
+        g_task_return_pointer (task, g_object_ref (pixbuf), g_object_unref);
+      else
+        g_task_return_error (task, g_error_copy (error));
+    }
+
+  g_clear_pointer (&waiters, g_ptr_array_unref);
+  g_clear_object (&pixbuf);
+  g_clear_error (&error);
+}
+
+/*< private >
+ * gtk_thumbnail_loader_load_async:
+ * @path: the path of the thumbnail file
+ * @size: the size to load the thumbnail at
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called when the thumbnail is loaded
+ * @user_data: data for @callback
+ *
+ * Loads the thumbnail at @path, scaled to fit into @size
+ * pixels, in a worker thread.
+ */
+void
+gtk_thumbnail_loader_load_async (const char          *path,
+                                 int                  size,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GTask *task;
+  GTask *worker;
+  GdkPixbuf *pixbuf;
+  GPtrArray *waiters;
+  LoadData *load;
+  char *key;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_thumbnail_loader_load_async);
+
+  pixbuf = gtk_thumbnail_loader_lookup (path, size);
+  if (pixbuf)
+    {
+      g_task_return_pointer (task, pixbuf, g_object_unref);
+      g_object_unref (task);
+      return;
+    }
+
+  key = make_key (path, size);
+
+  G_LOCK (pending);
+
+  if (pending == NULL)
+    pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  waiters = g_hash_table_lookup (pending, key);
+  if (waiters)
+    {
+      /* Already being loaded, wait for that */
+      g_ptr_array_add (waiters, task);
+      G_UNLOCK (pending);
+      g_free (key);
+      return;
+    }
+
+  waiters = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (waiters, task);
+  g_hash_table_insert (pending, g_strdup (key), waiters);
+
+  G_UNLOCK (pending);
+
+  load = g_slice_new (LoadData);
+  load->path = g_strdup (path);
+  load->key = key;
+  load->size = size;
+
+  /* The shared load is not tied to any single request; it checks
+   * whether anyone still wants it before doing the work
+   */
+  worker = g_task_new (NULL, NULL, load_done, NULL);
+  g_task_set_source_tag (worker, gtk_thumbnail_loader_load_async);
+  g_task_set_task_data (worker, load, load_data_free);
+  g_task_run_in_thread (worker, load_thread);
+  g_object_unref (worker);
+}
+
+/*< private >
+ * gtk_thumbnail_loader_load_finish:
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for an error
+ *
+ * Finishes loading a thumbnail.
+ *
+ * Returns: (transfer full) (nullable): the thumbnail, or %NULL
+ *   on error
+ */
+GdkPixbuf *
+gtk_thumbnail_loader_load_finish (GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
@@ -0,0 +1,38 @@
+/* gtkthumbnailloaderprivate.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_THUMBNAIL_LOADER_PRIVATE_H__
+#define __GTK_THUMBNAIL_LOADER_PRIVATE_H__
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+GdkPixbuf *     gtk_thumbnail_loader_lookup             (const char          *path,
+                                                         int                  size);
+
+void            gtk_thumbnail_loader_load_async         (const char          *path,
+                                                         int                  size,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             user_data);
+GdkPixbuf *     gtk_thumbnail_loader_load_finish        (GAsyncResult        *result,
+                                                         GError             **error);
+
+G_END_DECLS
+
+#endif /* __GTK_THUMBNAIL_LOADER_PRIVATE_H__ */
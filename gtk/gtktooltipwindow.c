@@ -207,10 +207,10 @@ static void
 gtk_tooltip_window_realize (GtkWidget *widget)
 {
   GtkTooltipWindow *window = GTK_TOOLTIP_WINDOW (widget);
-  GdkSurface *parent;
 
-  parent = gtk_native_get_surface (gtk_widget_get_native (window->relative_to));
-  window->surface = gdk_surface_new_popup (parent, FALSE);
+  window->surface = gtk_native_lease_popup (gtk_widget_get_native (window->relative_to),
+                                            FALSE,
+                                            &window->renderer);
 
   gdk_surface_set_widget (window->surface, widget);
 
@@ -220,8 +220,6 @@ gtk_tooltip_window_realize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_tooltip_window_parent_class)->realize (widget);
 
-  window->renderer = gsk_renderer_new_for_surface (window->surface);
-
   gtk_native_realize (GTK_NATIVE (window));
 }
 
@@ -234,15 +232,14 @@ gtk_tooltip_window_unrealize (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_tooltip_window_parent_class)->unrealize (widget);
 
-  gsk_renderer_unrealize (window->renderer);
-  g_clear_object (&window->renderer);
-
   g_signal_handlers_disconnect_by_func (window->surface, mapped_changed, widget);
   g_signal_handlers_disconnect_by_func (window->surface, surface_render, widget);
   g_signal_handlers_disconnect_by_func (window->surface, surface_event, widget);
   gdk_surface_set_widget (window->surface, NULL);
-  gdk_surface_destroy (window->surface);
-  g_clear_object (&window->surface);
+
+  gtk_native_return_popup (gtk_widget_get_native (window->relative_to),
+                           g_steal_pointer (&window->surface),
+                           g_steal_pointer (&window->renderer));
 }
 
 
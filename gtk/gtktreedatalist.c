@@ -22,30 +22,33 @@
 #include "gtktreedatalist.h"
 #include <string.h>
 
-/* node allocation
+/* row allocation
+ *
+ * All the cells of a row are allocated together, so a row costs a
+ * single allocation no matter how many columns there are. Cells that
+ * have never been set are zeroed, which is the default value of every
+ * supported type.
  */
 GtkTreeDataList *
-_gtk_tree_data_list_alloc (void)
+_gtk_tree_data_list_alloc (int n_columns)
 {
-  GtkTreeDataList *list;
-
-  list = g_slice_new0 (GtkTreeDataList);
-
-  return list;
+  return g_new0 (GtkTreeDataList, n_columns);
 }
 
 void
 _gtk_tree_data_list_free (GtkTreeDataList *list,
+			  int              n_columns,
 			  GType           *column_headers)
 {
-  GtkTreeDataList *tmp, *next;
-  int i = 0;
+  int i;
 
-  tmp = list;
+  if (list == NULL)
+    return;
 
-  while (tmp)
+  for (i = 0; i < n_columns; i++)
     {
-      next = tmp->next;
+      GtkTreeDataList *tmp = &list[i];
+
       if (g_type_is_a (column_headers [i], G_TYPE_STRING))
 	g_free ((char *) tmp->data.v_pointer);
       else if (g_type_is_a (column_headers [i], G_TYPE_OBJECT) && tmp->data.v_pointer != NULL)
@@ -54,11 +57,9 @@ _gtk_tree_data_list_free (GtkTreeDataList *list,
 	g_boxed_free (column_headers [i], (gpointer) tmp->data.v_pointer);
       else if (g_type_is_a (column_headers [i], G_TYPE_VARIANT) && tmp->data.v_pointer != NULL)
 	g_variant_unref ((gpointer) tmp->data.v_pointer);
-
-      g_slice_free (GtkTreeDataList, tmp);
-      i++;
-      tmp = next;
     }
+
+  g_free (list);
 }
 
 gboolean
@@ -258,17 +259,11 @@ _gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
     }
 }
 
-GtkTreeDataList *
+static void
 _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
+                               GtkTreeDataList *new_list,
                                GType            type)
 {
-  GtkTreeDataList *new_list;
-
-  g_return_val_if_fail (list != NULL, NULL);
-  
-  new_list = _gtk_tree_data_list_alloc ();
-  new_list->next = NULL;
-
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
@@ -312,6 +307,23 @@ _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
       g_warning ("Unsupported node type (%s) copied.", g_type_name (type));
       break;
     }
+}
+
+GtkTreeDataList *
+_gtk_tree_data_list_copy (GtkTreeDataList *list,
+                          int              n_columns,
+                          GType           *column_headers)
+{
+  GtkTreeDataList *new_list;
+  int i;
+
+  if (list == NULL)
+    return NULL;
+
+  new_list = _gtk_tree_data_list_alloc (n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    _gtk_tree_data_list_node_copy (&list[i], &new_list[i], column_headers[i]);
 
   return new_list;
 }
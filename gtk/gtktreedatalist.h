@@ -21,11 +21,10 @@
 #include <gtk/gtktreemodel.h>
 #include <gtk/gtktreesortable.h>
 
+/* A row is stored as one array with a GtkTreeDataList for each column */
 typedef struct _GtkTreeDataList GtkTreeDataList;
 struct _GtkTreeDataList
 {
-  GtkTreeDataList *next;
-
   union {
     int 	   v_int;
     gint8          v_char;
@@ -49,8 +48,12 @@ typedef struct _GtkTreeDataSortHeader
   GDestroyNotify destroy;
 } GtkTreeDataSortHeader;
 
-GtkTreeDataList *_gtk_tree_data_list_alloc          (void);
+GtkTreeDataList *_gtk_tree_data_list_alloc          (int              n_columns);
 void             _gtk_tree_data_list_free           (GtkTreeDataList *list,
+						     int              n_columns,
+						     GType           *column_headers);
+GtkTreeDataList *_gtk_tree_data_list_copy           (GtkTreeDataList *list,
+						     int              n_columns,
 						     GType           *column_headers);
 gboolean         _gtk_tree_data_list_check_type     (GType            type);
 void             _gtk_tree_data_list_node_to_value  (GtkTreeDataList *list,
@@ -59,9 +62,6 @@ void             _gtk_tree_data_list_node_to_value  (GtkTreeDataList *list,
 void             _gtk_tree_data_list_value_to_node  (GtkTreeDataList *list,
 						     GValue          *value);
 
-GtkTreeDataList *_gtk_tree_data_list_node_copy      (GtkTreeDataList *list,
-                                                     GType            type);
-
 /* Header code */
 int                    _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 							 GtkTreeIter  *a,
@@ -43,6 +43,21 @@ enum {
   NUM_PROPERTIES
 };
 
+enum {
+  ROW_PROP_0,
+  ROW_PROP_CHILDREN,
+  ROW_PROP_DEPTH,
+  ROW_PROP_EXPANDABLE,
+  ROW_PROP_EXPANDED,
+  ROW_PROP_ITEM,
+  NUM_ROW_PROPERTIES
+};
+
+/* How far the position cache is walked instead of looking up
+ * a position from the top.
+ */
+#define MAX_CURSOR_DISTANCE 64
+
 typedef struct _TreeNode TreeNode;
 typedef struct _TreeAugment TreeAugment;
 
@@ -76,6 +91,12 @@ struct _GtkTreeListModel
   gpointer user_data;
   GDestroyNotify user_destroy;
 
+  /* Last looked up position, so that neighbouring lookups are cheap.
+   * Cleared whenever the tree changes.
+   */
+  TreeNode *cursor;
+  guint cursor_position;
+
   guint autoexpand : 1;
   guint passthrough : 1;
 };
@@ -98,6 +119,7 @@ struct _GtkTreeListRowClass
 };
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
+static GParamSpec *row_properties[NUM_ROW_PROPERTIES] = { NULL, };
 
 static GtkTreeListModel *
 tree_node_get_tree_list_model (TreeNode *node)
@@ -264,20 +286,58 @@ tree_node_mark_dirty (TreeNode *node)
     {
       gtk_rb_tree_node_mark_dirty (node);
     }
+
+  node->list->cursor = NULL;
 }
 
+/* The row following @node in the flattened list */
 static TreeNode *
-gtk_tree_list_model_get_nth (GtkTreeListModel *self,
-                             guint             position)
+tree_node_get_next_row (TreeNode *node)
+{
+  TreeNode *next;
+
+  if (node->children)
+    {
+      next = gtk_rb_tree_get_first (node->children);
+      if (next)
+        return next;
+    }
+
+  for (; !node->is_root; node = node->parent)
+    {
+      next = gtk_rb_tree_node_get_next (node);
+      if (next)
+        return next;
+    }
+
+  return NULL;
+}
+
+/* The row preceding @node in the flattened list */
+static TreeNode *
+tree_node_get_previous_row (TreeNode *node)
+{
+  TreeNode *prev, *last;
+
+  prev = gtk_rb_tree_node_get_previous (node);
+  if (prev == NULL)
+    return node->parent->is_root ? NULL : node->parent;
+
+  while (prev->children &&
+         (last = gtk_rb_tree_get_last (prev->children)))
+    prev = last;
+
+  return prev;
+}
+
+static TreeNode *
+gtk_tree_list_model_lookup_nth (GtkTreeListModel *self,
+                                guint             position)
 {
   GtkRbTree *tree;
   TreeNode *node, *tmp;
   guint n_children;
 
-  n_children = tree_node_get_n_children (&self->root_node);
-  if (n_children <= position)
-    return NULL;
-
   tree = self->root_node.children;
   node = gtk_rb_tree_get_root (tree);
 
@@ -315,6 +375,48 @@ gtk_tree_list_model_get_nth (GtkTreeListModel *self,
   g_return_val_if_reached (NULL);
 }
 
+static TreeNode *
+gtk_tree_list_model_get_nth (GtkTreeListModel *self,
+                             guint             position)
+{
+  TreeNode *node;
+  guint n_children;
+
+  n_children = tree_node_get_n_children (&self->root_node);
+  if (n_children <= position)
+    return NULL;
+
+  /* List views ask for neighbouring rows all the time, walking
+   * there is cheaper than going through all levels of the tree.
+   */
+  node = self->cursor;
+  if (node && position >= self->cursor_position &&
+      position - self->cursor_position <= MAX_CURSOR_DISTANCE)
+    {
+      guint i;
+
+      for (i = self->cursor_position; i < position; i++)
+        node = tree_node_get_next_row (node);
+    }
+  else if (node && position < self->cursor_position &&
+           self->cursor_position - position <= MAX_CURSOR_DISTANCE)
+    {
+      guint i;
+
+      for (i = self->cursor_position; i > position; i--)
+        node = tree_node_get_previous_row (node);
+    }
+  else
+    {
+      node = gtk_tree_list_model_lookup_nth (self, position);
+    }
+
+  self->cursor = node;
+  self->cursor_position = position;
+
+  return node;
+}
+
 static GListModel *
 tree_node_create_model (GtkTreeListModel *self,
                         TreeNode         *node)
@@ -375,6 +477,7 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
   guint i, tree_position, tree_removed, tree_added, n_local;
 
   self = tree_node_get_tree_list_model (node);
+  self->cursor = NULL;
   n_local = g_list_model_get_n_items (model) - added + removed;
 
   if (position < n_local)
@@ -528,6 +631,7 @@ gtk_tree_list_model_expand_node (GtkTreeListModel *self,
   if (node->model != NULL)
     return 0;
 
+  self->cursor = NULL;
   model = tree_node_create_model (self, node);
 
   if (model == NULL)
@@ -549,6 +653,7 @@ gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
   if (node->model == NULL)
     return 0;
 
+  self->cursor = NULL;
   n_items = tree_node_get_n_children (node);
 
   g_clear_pointer (&node->children, gtk_rb_tree_unref);
@@ -853,6 +958,149 @@ gtk_tree_list_model_get_autoexpand (GtkTreeListModel *self)
   return self->autoexpand;
 }
 
+/* Expands @node and all rows below it. Only marks the nodes
+ * dirty in their own tree, the caller needs to take care of
+ * the ancestors.
+ */
+static void
+gtk_tree_list_model_expand_subtree (GtkTreeListModel *self,
+                                    TreeNode         *node,
+                                    GPtrArray        *rows)
+{
+  TreeNode *child;
+
+  if (node->model == NULL && !node->empty)
+    {
+      GListModel *model = tree_node_create_model (self, node);
+
+      if (model)
+        {
+          gtk_tree_list_model_init_node (self, node, model);
+          if (node->row)
+            g_ptr_array_add (rows, g_object_ref (node->row));
+        }
+    }
+
+  if (node->children == NULL)
+    return;
+
+  for (child = gtk_rb_tree_get_first (node->children);
+       child;
+       child = gtk_rb_tree_node_get_next (child))
+    {
+      gtk_tree_list_model_expand_subtree (self, child, rows);
+    }
+
+  gtk_rb_tree_node_mark_dirty (node);
+}
+
+static void
+gtk_tree_list_model_set_all_expanded (GtkTreeListModel *self,
+                                      gboolean          expanded)
+{
+  GPtrArray *rows;
+  TreeNode *node;
+  guint old_pos, new_pos, start, old_end, new_end;
+  gboolean changed;
+  guint i;
+
+  self->cursor = NULL;
+  rows = g_ptr_array_new_with_free_func (g_object_unref);
+  old_pos = new_pos = 0;
+  start = old_end = new_end = 0;
+  changed = FALSE;
+
+  for (node = gtk_rb_tree_get_first (self->root_node.children);
+       node;
+       node = gtk_rb_tree_node_get_next (node))
+    {
+      guint before, after;
+
+      before = tree_node_get_n_children (node);
+
+      if (expanded)
+        {
+          gtk_tree_list_model_expand_subtree (self, node, rows);
+        }
+      else if (node->model)
+        {
+          g_clear_pointer (&node->children, gtk_rb_tree_unref);
+          g_clear_object (&node->model);
+          gtk_rb_tree_node_mark_dirty (node);
+          if (node->row)
+            g_ptr_array_add (rows, g_object_ref (node->row));
+        }
+
+      after = tree_node_get_n_children (node);
+
+      if (before != after)
+        {
+          if (!changed)
+            {
+              start = old_pos + 1;
+              changed = TRUE;
+            }
+          old_end = old_pos + 1 + before;
+          new_end = new_pos + 1 + after;
+        }
+
+      old_pos += 1 + before;
+      new_pos += 1 + after;
+    }
+
+  if (changed)
+    g_list_model_items_changed (G_LIST_MODEL (self), start, old_end - start, new_end - start);
+
+  for (i = 0; i < rows->len; i++)
+    {
+      GtkTreeListRow *row = g_ptr_array_index (rows, i);
+
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_EXPANDED]);
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_CHILDREN]);
+    }
+
+  g_ptr_array_unref (rows);
+}
+
+/**
+ * gtk_tree_list_model_expand_all:
+ * @self: a #GtkTreeListModel
+ *
+ * Expands all rows of @self, including the ones that appear
+ * by expanding other rows.
+ *
+ * This is a lot faster than calling gtk_tree_list_row_set_expanded()
+ * for every row and emits #GListModel::items-changed only once.
+ *
+ * Do not use this function for trees that can grow infinitely deep.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_tree_list_model_expand_all (GtkTreeListModel *self)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  gtk_tree_list_model_set_all_expanded (self, TRUE);
+}
+
+/**
+ * gtk_tree_list_model_collapse_all:
+ * @self: a #GtkTreeListModel
+ *
+ * Collapses all rows of @self, so that only the items of the
+ * root model remain.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_tree_list_model_collapse_all (GtkTreeListModel *self)
+{
+  g_return_if_fail (GTK_IS_TREE_LIST_MODEL (self));
+
+  gtk_tree_list_model_set_all_expanded (self, FALSE);
+}
+
 /**
  * gtk_tree_list_model_get_row:
  * @self: a #GtkTreeListModel
@@ -939,18 +1187,6 @@ gtk_tree_list_model_get_child_row (GtkTreeListModel *self,
  * it possible to sort trees properly.
  */
 
-enum {
-  ROW_PROP_0,
-  ROW_PROP_CHILDREN,
-  ROW_PROP_DEPTH,
-  ROW_PROP_EXPANDABLE,
-  ROW_PROP_EXPANDED,
-  ROW_PROP_ITEM,
-  NUM_ROW_PROPERTIES
-};
-
-static GParamSpec *row_properties[NUM_ROW_PROPERTIES] = { NULL, };
-
 G_DEFINE_TYPE (GtkTreeListRow, gtk_tree_list_row, G_TYPE_OBJECT)
 
 static void
@@ -74,6 +74,10 @@ void                    gtk_tree_list_model_set_autoexpand      (GtkTreeListMode
                                                                  gboolean                autoexpand);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_model_get_autoexpand      (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_4_2
+void                    gtk_tree_list_model_expand_all          (GtkTreeListModel       *self);
+GDK_AVAILABLE_IN_4_2
+void                    gtk_tree_list_model_collapse_all        (GtkTreeListModel       *self);
 
 GDK_AVAILABLE_IN_ALL
 GtkTreeListRow *        gtk_tree_list_model_get_child_row       (GtkTreeListModel       *self,
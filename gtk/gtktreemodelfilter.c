@@ -4236,6 +4236,9 @@ gtk_tree_model_filter_refilter_helper (GtkTreeModel *model,
  *
  * Emits ::row_changed for each row in the child model, which causes
  * the filter to re-evaluate whether a row is visible or not.
+ *
+ * See gtk_tree_model_filter_refilter_path() to only re-evaluate a
+ * part of the model.
  */
 void
 gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
@@ -4248,6 +4251,79 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
                           filter);
 }
 
+static void
+gtk_tree_model_filter_refilter_children (GtkTreeModelFilter *filter,
+                                         GtkTreeIter        *parent,
+                                         GtkTreePath        *path)
+{
+  GtkTreeModel *child_model = filter->priv->child_model;
+  gboolean iters_persist;
+  GtkTreeIter iter;
+
+  if (!gtk_tree_model_iter_children (child_model, &iter, parent))
+    return;
+
+  iters_persist = gtk_tree_model_get_flags (child_model) & GTK_TREE_MODEL_ITERS_PERSIST;
+
+  gtk_tree_path_down (path);
+
+  do
+    {
+      gtk_tree_model_filter_row_changed (child_model, path, &iter, filter);
+
+      if (!iters_persist &&
+          !gtk_tree_model_get_iter (child_model, &iter, path))
+        break;
+
+      gtk_tree_model_filter_refilter_children (filter, &iter, path);
+
+      gtk_tree_path_next (path);
+    }
+  while (gtk_tree_model_iter_next (child_model, &iter));
+
+  gtk_tree_path_up (path);
+}
+
+/**
+ * gtk_tree_model_filter_refilter_path:
+ * @filter: A #GtkTreeModelFilter.
+ * @child_path: A #GtkTreePath in the child model
+ *
+ * Re-evaluates whether the row at @child_path and all of its
+ * descendants in the child model are visible, like
+ * gtk_tree_model_filter_refilter() does for the whole model.
+ *
+ * Use this instead of gtk_tree_model_filter_refilter() when the
+ * visibility of only a part of a large tree may have changed.
+ *
+ * Since: 4.2
+ */
+void
+gtk_tree_model_filter_refilter_path (GtkTreeModelFilter *filter,
+                                     GtkTreePath        *child_path)
+{
+  GtkTreeModel *child_model;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+  g_return_if_fail (child_path != NULL);
+
+  child_model = filter->priv->child_model;
+  if (!gtk_tree_model_get_iter (child_model, &iter, child_path))
+    return;
+
+  path = gtk_tree_path_copy (child_path);
+
+  gtk_tree_model_filter_row_changed (child_model, path, &iter, filter);
+
+  if ((gtk_tree_model_get_flags (child_model) & GTK_TREE_MODEL_ITERS_PERSIST) ||
+      gtk_tree_model_get_iter (child_model, &iter, path))
+    gtk_tree_model_filter_refilter_children (filter, &iter, path);
+
+  gtk_tree_path_free (path);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -730,6 +730,29 @@ lookup_elt_with_offset (GtkTreeModelSort *tree_model_sort,
   return GET_ELT (siter);
 }
 
+/* Whether g_sequence_sort_changed() would leave @elt where it is */
+static gboolean
+elt_is_in_order (SortElt  *elt,
+                 SortData *sort_data)
+{
+  GSequenceIter *siter;
+
+  if (!g_sequence_iter_is_begin (elt->siter))
+    {
+      siter = g_sequence_iter_prev (elt->siter);
+      if (gtk_tree_model_sort_compare_func (g_sequence_get (siter), elt, sort_data) > 0)
+        return FALSE;
+    }
+
+  siter = g_sequence_iter_next (elt->siter);
+  if (!g_sequence_iter_is_end (siter))
+    {
+      if (gtk_tree_model_sort_compare_func (elt, g_sequence_get (siter), sort_data) >= 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
 
 static void
 gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
@@ -741,7 +764,6 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
   GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GtkTreeIter tmpiter;
 
   SortElt *elt;
   SortLevel *level;
@@ -790,15 +812,30 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
       return;
     }
 
-  if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
-    tmpiter = elt->iter;
-  else
-    gtk_tree_model_get_iter (priv->child_model,
-                             &tmpiter, start_s_path);
+  fill_sort_data (&sort_data, tree_model_sort, level);
+
+  /* When a lot of rows change, most of them usually stay where they
+   * are, so check the neighbours before searching for a new position.
+   * The row is kept in place if it would be inserted at the same spot,
+   * which is after all the rows it compares equal to.
+   */
+  if (elt_is_in_order (elt, &sort_data))
+    {
+      free_sort_data (&sort_data);
+
+      if (free_s_path)
+	gtk_tree_path_free (start_s_path);
+
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (data), path, &iter);
+      gtk_tree_model_sort_unref_node (GTK_TREE_MODEL (data), &iter);
+
+      gtk_tree_path_free (path);
+
+      return;
+    }
 
   old_index = g_sequence_iter_get_position (elt->siter);
 
-  fill_sort_data (&sort_data, tree_model_sort, level);
   g_sequence_sort_changed (elt->siter,
                            gtk_tree_model_sort_compare_func,
                            &sort_data);
@@ -816,34 +853,31 @@ gtk_tree_model_sort_row_changed (GtkTreeModel *s_model,
   if (old_index != index)
     {
       int *new_order;
-      int j;
+      int j, length;
 
       GtkTreePath *tmppath;
 
-      new_order = g_new (int, g_sequence_get_length (level->seq));
+      length = g_sequence_get_length (level->seq);
+      new_order = g_new (int, length);
 
-      for (j = 0; j < g_sequence_get_length (level->seq); j++)
+      for (j = 0; j < MIN (index, old_index); j++)
+        new_order[j] = j;
+
+      new_order[index] = old_index;
+
+      if (index > old_index)
         {
-	  if (index > old_index)
-	    {
-	      if (j == index)
-		new_order[j] = old_index;
-	      else if (j >= old_index && j < index)
-		new_order[j] = j + 1;
-	      else
-		new_order[j] = j;
-	    }
-	  else if (index < old_index)
-	    {
-	      if (j == index)
-		new_order[j] = old_index;
-	      else if (j > index && j <= old_index)
-		new_order[j] = j - 1;
-	      else
-		new_order[j] = j;
-	    }
-	  /* else? shouldn't really happen */
-	}
+          for (j = old_index; j < index; j++)
+            new_order[j] = j + 1;
+        }
+      else
+        {
+          for (j = index + 1; j <= old_index; j++)
+            new_order[j] = j - 1;
+        }
+
+      for (j = MAX (index, old_index) + 1; j < length; j++)
+        new_order[j] = j;
 
       if (level->parent_elt)
         {
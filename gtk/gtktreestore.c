@@ -465,8 +465,10 @@ gtk_tree_store_set_column_type (GtkTreeStore *tree_store,
 static gboolean
 node_free (GNode *node, gpointer data)
 {
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE (data)->priv;
+
   if (node->data)
-    _gtk_tree_data_list_free (node->data, (GType*)data);
+    _gtk_tree_data_list_free (node->data, priv->n_columns, priv->column_headers);
   node->data = NULL;
 
   return FALSE;
@@ -479,7 +481,7 @@ gtk_tree_store_finalize (GObject *object)
   GtkTreeStorePrivate *priv = tree_store->priv;
 
   g_node_traverse (priv->root, G_POST_ORDER, G_TRAVERSE_ALL, -1,
-		   node_free, priv->column_headers);
+		   node_free, tree_store);
   g_node_destroy (priv->root);
   _gtk_tree_data_list_header_free (priv->sort_list);
   g_free (priv->column_headers);
@@ -649,19 +651,15 @@ gtk_tree_store_get_value (GtkTreeModel *tree_model,
   GtkTreeStore *tree_store = (GtkTreeStore *) tree_model;
   GtkTreeStorePrivate *priv = tree_store->priv;
   GtkTreeDataList *list;
-  int tmp_column = column;
 
   g_return_if_fail (column < priv->n_columns);
   g_return_if_fail (VALID_ITER (iter, tree_store));
 
   list = G_NODE (iter->user_data)->data;
 
-  while (tmp_column-- > 0 && list)
-    list = list->next;
-
   if (list)
     {
-      _gtk_tree_data_list_node_to_value (list,
+      _gtk_tree_data_list_node_to_value (&list[column],
 					 priv->column_headers[column],
 					 value);
     }
@@ -844,8 +842,6 @@ gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
   GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  int old_column = column;
   GValue real_value = G_VALUE_INIT;
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -874,59 +870,22 @@ gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
       converted = TRUE;
     }
 
-  prev = list = G_NODE (iter->user_data)->data;
-
-  while (list != NULL)
-    {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-          if (sort && GTK_TREE_STORE_IS_SORTED (tree_store))
-            gtk_tree_store_sort_iter_changed (tree_store, iter, old_column, TRUE);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
-    }
-
-  if (G_NODE (iter->user_data)->data == NULL)
-    {
-      G_NODE (iter->user_data)->data = list = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
+  list = G_NODE (iter->user_data)->data;
 
-  while (column != 0)
-    {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
-    }
+  if (list == NULL)
+    G_NODE (iter->user_data)->data = list = _gtk_tree_data_list_alloc (priv->n_columns);
 
   if (converted)
-    _gtk_tree_data_list_value_to_node (list, &real_value);
+    _gtk_tree_data_list_value_to_node (&list[column], &real_value);
   else
-    _gtk_tree_data_list_value_to_node (list, value);
+    _gtk_tree_data_list_value_to_node (&list[column], value);
   
   retval = TRUE;
   if (converted)
     g_value_unset (&real_value);
 
   if (sort && GTK_TREE_STORE_IS_SORTED (tree_store))
-    gtk_tree_store_sort_iter_changed (tree_store, iter, old_column, TRUE);
+    gtk_tree_store_sort_iter_changed (tree_store, iter, column, TRUE);
 
   return retval;
 }
@@ -1220,7 +1179,7 @@ gtk_tree_store_remove (GtkTreeStore *tree_store,
 
   if (G_NODE (iter->user_data)->data)
     g_node_traverse (G_NODE (iter->user_data), G_POST_ORDER, G_TRAVERSE_ALL,
-		     -1, node_free, priv->column_headers);
+		     -1, node_free, tree_store);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
   g_node_destroy (G_NODE (iter->user_data));
@@ -1973,31 +1932,13 @@ copy_node_data (GtkTreeStore *tree_store,
                 GtkTreeIter  *src_iter,
                 GtkTreeIter  *dest_iter)
 {
+  GtkTreeStorePrivate *priv = tree_store->priv;
   GtkTreeDataList *dl = G_NODE (src_iter->user_data)->data;
-  GtkTreeDataList *copy_head = NULL;
-  GtkTreeDataList *copy_prev = NULL;
-  GtkTreeDataList *copy_iter = NULL;
   GtkTreePath *path;
-  int col;
-
-  col = 0;
-  while (dl)
-    {
-      copy_iter = _gtk_tree_data_list_node_copy (dl, tree_store->priv->column_headers[col]);
-
-      if (copy_head == NULL)
-        copy_head = copy_iter;
-
-      if (copy_prev)
-        copy_prev->next = copy_iter;
-
-      copy_prev = copy_iter;
-
-      dl = dl->next;
-      ++col;
-    }
 
-  G_NODE (dest_iter->user_data)->data = copy_head;
+  G_NODE (dest_iter->user_data)->data = _gtk_tree_data_list_copy (dl,
+                                                                  priv->n_columns,
+                                                                  priv->column_headers);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), dest_iter);
   gtk_tree_model_row_changed (GTK_TREE_MODEL (tree_store), path, dest_iter);
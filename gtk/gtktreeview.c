@@ -267,6 +267,10 @@ typedef enum {
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
 /* 3/5 of gdkframeclockidle.c's FRAME_INTERVAL (16667 microsecs) */
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 10
+/* Trees with at least this many rows whose sampled rows all have the
+ * same height are assumed to have uniform row heights */
+#define GTK_TREE_VIEW_GUESS_HEIGHT_MIN_ROWS 10000
+#define GTK_TREE_VIEW_GUESS_HEIGHT_MIN_SAMPLES 16
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
 #define AUTO_EXPAND_TIMEOUT 500
@@ -430,6 +434,7 @@ typedef struct
 
   /* fixed height */
   int fixed_height;
+  int guessed_height;
 
   GtkTreeRBNode *rubber_band_start_node;
   GtkTreeRBTree *rubber_band_start_tree;
@@ -489,6 +494,7 @@ typedef struct
 
   guint fixed_height_mode : 1;
   guint fixed_height_check : 1;
+  guint fixed_height_guess : 1;
 
   guint activate_on_single_click : 1;
   guint reorderable : 1;
@@ -5696,6 +5702,14 @@ validate_row (GtkTreeView   *tree_view,
     }
   gtk_tree_rbtree_node_mark_valid (tree, node);
 
+  /* A shown row proved the guess of uniform heights wrong,
+   * so validate all rows again. */
+  if (priv->fixed_height_guess && height != priv->guessed_height)
+    {
+      priv->fixed_height_guess = 0;
+      install_presize_handler (tree_view);
+    }
+
   return retval;
 }
 
@@ -6102,6 +6116,22 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
                                  priv->fixed_height, TRUE);
 }
 
+/* Time to spend validating rows per idle, 3/5 of the frame interval */
+static gint64
+gtk_tree_view_get_validate_budget (GtkTreeView *tree_view)
+{
+  GdkFrameClock *frame_clock;
+  gint64 refresh_interval;
+
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (tree_view));
+  if (frame_clock == NULL)
+    return GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000;
+
+  gdk_frame_clock_get_refresh_info (frame_clock, 0, &refresh_interval, NULL);
+
+  return refresh_interval * 3 / 5;
+}
+
 /* Our strategy for finding nodes to validate is a little convoluted.  We find
  * the left-most uninvalidated node.  We then try walking right, validating
  * nodes.  Once we find a valid node, we repeat the previous process of finding
@@ -6120,7 +6150,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   int retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
+  gint64 end_time;
   int i = 0;
 
   int y = -1;
@@ -6144,8 +6174,12 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  /* Rows are assumed to have the guessed height, only the rows
+   * that are shown get validated */
+  if (priv->fixed_height_guess)
+    return FALSE;
+
+  end_time = g_get_monotonic_time () + gtk_tree_view_get_validate_budget (tree_view);
 
   do
     {
@@ -6234,12 +6268,21 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () < end_time);
 
   if (!priv->fixed_height_check)
    {
      if (fixed_height)
-       gtk_tree_rbtree_set_fixed_height (priv->tree, prev_height, FALSE);
+       {
+         gtk_tree_rbtree_set_fixed_height (priv->tree, prev_height, FALSE);
+
+         if (i >= GTK_TREE_VIEW_GUESS_HEIGHT_MIN_SAMPLES &&
+             priv->tree->root->total_count >= GTK_TREE_VIEW_GUESS_HEIGHT_MIN_ROWS)
+           {
+             priv->fixed_height_guess = 1;
+             priv->guessed_height = prev_height;
+           }
+       }
 
      priv->fixed_height_check = 1;
    }
@@ -6293,7 +6336,6 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
 
   if (!retval && gtk_widget_get_mapped (GTK_WIDGET (tree_view)))
     update_prelight (tree_view,
@@ -10311,6 +10353,7 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
 
       priv->search_column = -1;
       priv->fixed_height_check = 0;
+      priv->fixed_height_guess = 0;
       priv->fixed_height = -1;
       priv->dy = priv->top_row_dy = 0;
     }
@@ -29,6 +29,7 @@
 #include "gtkadjustmentprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
+#include "gtknative.h"
 #include "gtkprivate.h"
 #include "gtkscrollable.h"
 #include "gtktypebuiltins.h"
@@ -36,6 +37,8 @@
 #include "gtkbuildable.h"
 #include "gtktext.h"
 
+#include <math.h>
+
 
 /**
  * SECTION:gtkviewport
@@ -77,8 +80,16 @@ struct _GtkViewport
   guint hscroll_policy : 1;
   guint vscroll_policy : 1;
   guint scroll_to_focus : 1;
+  guint scroll_cache : 1;
 
   gulong focus_handler;
+
+  /* The scroll cache: cache_texture holds the child's cache_node
+   * rendered at cache_scale, covering cache_area in child coordinates */
+  GskRenderNode *cache_node;
+  GdkTexture *cache_texture;
+  graphene_rect_t cache_area;
+  int cache_scale;
 };
 
 struct _GtkViewportClass
@@ -93,9 +104,15 @@ enum {
   PROP_HSCROLL_POLICY,
   PROP_VSCROLL_POLICY,
   PROP_SCROLL_TO_FOCUS,
+  PROP_SCROLL_CACHE,
   PROP_CHILD
 };
 
+/* How much content to keep rendered around the visible area
+ * in the scroll cache, as a fraction of the viewport size */
+#define SCROLL_CACHE_MARGIN 0.5
+
+
 
 static void gtk_viewport_set_property             (GObject         *object,
                                                    guint            prop_id,
@@ -302,6 +319,13 @@ viewport_disconnect_adjustment (GtkViewport    *viewport,
     }
 }
 
+static void
+gtk_viewport_clear_scroll_cache (GtkViewport *viewport)
+{
+  g_clear_pointer (&viewport->cache_node, gsk_render_node_unref);
+  g_clear_object (&viewport->cache_texture);
+}
+
 static void
 gtk_viewport_dispose (GObject *object)
 {
@@ -311,6 +335,7 @@ gtk_viewport_dispose (GObject *object)
   viewport_disconnect_adjustment (viewport, GTK_ORIENTATION_VERTICAL);
 
   clear_focus_change_handler (viewport);
+  gtk_viewport_clear_scroll_cache (viewport);
 
   g_clear_pointer (&viewport->child, gtk_widget_unparent);
 
@@ -340,6 +365,185 @@ gtk_viewport_unroot (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_viewport_parent_class)->unroot (widget);
 }
 
+static void
+gtk_viewport_unmap (GtkWidget *widget)
+{
+  GtkViewport *viewport = GTK_VIEWPORT (widget);
+
+  /* The cached texture belongs to the renderer of our native */
+  gtk_viewport_clear_scroll_cache (viewport);
+
+  GTK_WIDGET_CLASS (gtk_viewport_parent_class)->unmap (widget);
+}
+
+/* Appends @node, clipped to @rect, unless @rect is empty */
+static void
+append_clipped_node (GskRenderNode         **nodes,
+                     guint                  *n_nodes,
+                     GskRenderNode          *node,
+                     const graphene_rect_t  *rect)
+{
+  if (rect->size.width <= 0 || rect->size.height <= 0)
+    return;
+
+  nodes[(*n_nodes)++] = gsk_clip_node_new (node, rect);
+}
+
+static void
+gtk_viewport_update_scroll_cache (GtkViewport           *viewport,
+                                  GskRenderNode         *node,
+                                  const graphene_rect_t *area,
+                                  int                    scale)
+{
+  GtkNative *native;
+  GskRenderer *renderer;
+  GskRenderNode *nodes[5];
+  GskRenderNode *container, *scaled;
+  graphene_rect_t reused;
+  guint i, n_nodes = 0;
+
+  native = gtk_widget_get_native (GTK_WIDGET (viewport));
+  renderer = native ? gtk_native_get_renderer (native) : NULL;
+  if (renderer == NULL)
+    {
+      gtk_viewport_clear_scroll_cache (viewport);
+      return;
+    }
+
+  /* When the content didn't change and we only scrolled, keep the part
+   * of the old texture that is still in the cached area and only render
+   * the newly exposed strips of content.
+   */
+  if (viewport->cache_texture &&
+      viewport->cache_node == node &&
+      viewport->cache_scale == scale &&
+      graphene_rect_intersection (&viewport->cache_area, area, &reused))
+    {
+      float top = reused.origin.y;
+      float bottom = reused.origin.y + reused.size.height;
+
+      nodes[n_nodes++] = gsk_texture_node_new (viewport->cache_texture, &viewport->cache_area);
+      append_clipped_node (nodes, &n_nodes, node,
+                           &GRAPHENE_RECT_INIT (area->origin.x, area->origin.y,
+                                                area->size.width, top - area->origin.y));
+      append_clipped_node (nodes, &n_nodes, node,
+                           &GRAPHENE_RECT_INIT (area->origin.x, bottom,
+                                                area->size.width, area->origin.y + area->size.height - bottom));
+      append_clipped_node (nodes, &n_nodes, node,
+                           &GRAPHENE_RECT_INIT (area->origin.x, top,
+                                                reused.origin.x - area->origin.x, reused.size.height));
+      append_clipped_node (nodes, &n_nodes, node,
+                           &GRAPHENE_RECT_INIT (reused.origin.x + reused.size.width, top,
+                                                area->origin.x + area->size.width - reused.origin.x - reused.size.width,
+                                                reused.size.height));
+    }
+  else
+    {
+      nodes[n_nodes++] = gsk_render_node_ref (node);
+    }
+
+  container = gsk_container_node_new (nodes, n_nodes);
+  for (i = 0; i < n_nodes; i++)
+    gsk_render_node_unref (nodes[i]);
+
+  scaled = gsk_transform_node_new (container,
+                                   gsk_transform_scale (NULL, scale, scale));
+  gsk_render_node_unref (container);
+
+  g_clear_object (&viewport->cache_texture);
+  viewport->cache_texture = gsk_renderer_render_texture (renderer,
+                                                         scaled,
+                                                         &GRAPHENE_RECT_INIT (area->origin.x * scale,
+                                                                              area->origin.y * scale,
+                                                                              area->size.width * scale,
+                                                                              area->size.height * scale));
+  gsk_render_node_unref (scaled);
+
+  if (viewport->cache_node != node)
+    {
+      g_clear_pointer (&viewport->cache_node, gsk_render_node_unref);
+      viewport->cache_node = gsk_render_node_ref (node);
+    }
+  viewport->cache_area = *area;
+  viewport->cache_scale = scale;
+}
+
+static void
+gtk_viewport_snapshot (GtkWidget   *widget,
+                       GtkSnapshot *snapshot)
+{
+  GtkViewport *viewport = GTK_VIEWPORT (widget);
+  GtkSnapshot *child_snapshot;
+  GskRenderNode *node;
+  graphene_matrix_t transform;
+  graphene_rect_t visible, bounds, area;
+  float dx, dy;
+  int width, height, scale;
+
+  if (!viewport->scroll_cache ||
+      viewport->child == NULL ||
+      !gtk_widget_get_mapped (viewport->child) ||
+      !gtk_widget_compute_transform (viewport->child, widget, &transform) ||
+      !graphene_matrix_is_2d (&transform) ||
+      graphene_matrix_get_value (&transform, 0, 0) != 1.f ||
+      graphene_matrix_get_value (&transform, 0, 1) != 0.f ||
+      graphene_matrix_get_value (&transform, 1, 0) != 0.f ||
+      graphene_matrix_get_value (&transform, 1, 1) != 1.f)
+    {
+      gtk_viewport_clear_scroll_cache (viewport);
+      GTK_WIDGET_CLASS (gtk_viewport_parent_class)->snapshot (widget, snapshot);
+      return;
+    }
+
+  /* The child keeps its render node as long as nothing in it queued
+   * a redraw, so comparing nodes tells us if the cache is still valid.
+   */
+  child_snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot (viewport->child, child_snapshot);
+  node = gtk_snapshot_free_to_node (child_snapshot);
+  if (node == NULL)
+    {
+      gtk_viewport_clear_scroll_cache (viewport);
+      return;
+    }
+
+  dx = graphene_matrix_get_x_translation (&transform);
+  dy = graphene_matrix_get_y_translation (&transform);
+  width = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+  scale = gtk_widget_get_scale_factor (widget);
+
+  gsk_render_node_get_bounds (node, &bounds);
+  graphene_rect_init (&visible, - dx, - dy, width, height);
+  graphene_rect_intersection (&visible, &bounds, &visible);
+
+  if (viewport->cache_texture == NULL ||
+      viewport->cache_node != node ||
+      viewport->cache_scale != scale ||
+      !graphene_rect_contains_rect (&viewport->cache_area, &visible))
+    {
+      graphene_rect_inset_r (&visible,
+                             - ceil (width * SCROLL_CACHE_MARGIN),
+                             - ceil (height * SCROLL_CACHE_MARGIN),
+                             &area);
+      graphene_rect_round_extents (&area, &area);
+      if (graphene_rect_intersection (&area, &bounds, &area))
+        gtk_viewport_update_scroll_cache (viewport, node, &area, scale);
+      else
+        gtk_viewport_clear_scroll_cache (viewport);
+    }
+
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (dx, dy));
+  if (viewport->cache_texture)
+    gtk_snapshot_append_texture (snapshot, viewport->cache_texture, &viewport->cache_area);
+  else
+    gtk_snapshot_append_node (snapshot, node);
+  gtk_snapshot_restore (snapshot);
+
+  gsk_render_node_unref (node);
+}
+
 static void
 gtk_viewport_class_init (GtkViewportClass *class)
 {
@@ -354,6 +558,8 @@ gtk_viewport_class_init (GtkViewportClass *class)
   gobject_class->get_property = gtk_viewport_get_property;
 
   widget_class->size_allocate = gtk_viewport_size_allocate;
+  widget_class->snapshot = gtk_viewport_snapshot;
+  widget_class->unmap = gtk_viewport_unmap;
   widget_class->measure = gtk_viewport_measure;
   widget_class->root = gtk_viewport_root;
   widget_class->unroot = gtk_viewport_unroot;
@@ -374,6 +580,22 @@ gtk_viewport_class_init (GtkViewportClass *class)
                                                          FALSE,
                                                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 
+  /**
+   * GtkViewport:scroll-cache:
+   *
+   * Whether to keep the rendered content in a texture while scrolling.
+   *
+   * See gtk_viewport_set_scroll_cache().
+   *
+   * Since: 4.2
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_SCROLL_CACHE,
+                                   g_param_spec_boolean ("scroll-cache",
+                                                         P_("Scroll cache"),
+                                                         P_("Whether to cache the rendered content while scrolling"),
+                                                         FALSE,
+                                                         GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 
   g_object_class_install_property (gobject_class,
                                    PROP_CHILD,
@@ -422,6 +644,9 @@ gtk_viewport_set_property (GObject         *object,
     case PROP_SCROLL_TO_FOCUS:
       gtk_viewport_set_scroll_to_focus (viewport, g_value_get_boolean (value));
       break;
+    case PROP_SCROLL_CACHE:
+      gtk_viewport_set_scroll_cache (viewport, g_value_get_boolean (value));
+      break;
     case PROP_CHILD:
       gtk_viewport_set_child (viewport, g_value_get_object (value));
       break;
@@ -456,6 +681,9 @@ gtk_viewport_get_property (GObject         *object,
     case PROP_SCROLL_TO_FOCUS:
       g_value_set_boolean (value, viewport->scroll_to_focus);
       break;
+    case PROP_SCROLL_CACHE:
+      g_value_set_boolean (value, viewport->scroll_cache);
+      break;
     case PROP_CHILD:
       g_value_set_object (value, gtk_viewport_get_child (viewport));
       break;
@@ -616,6 +844,62 @@ gtk_viewport_set_scroll_to_focus (GtkViewport *viewport,
   g_object_notify (G_OBJECT (viewport), "scroll-to-focus");
 }
 
+/**
+ * gtk_viewport_get_scroll_cache:
+ * @viewport: a #GtkViewport
+ *
+ * Gets whether the viewport caches its rendered content while
+ * scrolling. See gtk_viewport_set_scroll_cache().
+ *
+ * Returns: %TRUE if the viewport uses a scroll cache
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_viewport_get_scroll_cache (GtkViewport *viewport)
+{
+  g_return_val_if_fail (GTK_IS_VIEWPORT (viewport), FALSE);
+
+  return viewport->scroll_cache;
+}
+
+/**
+ * gtk_viewport_set_scroll_cache:
+ * @viewport: a #GtkViewport
+ * @scroll_cache: whether to cache the rendered content
+ *
+ * Sets whether the viewport should keep its rendered content in a
+ * texture that is slightly larger than the visible area.
+ *
+ * When the content doesn't change, scrolling then only draws the
+ * texture at a new offset, and only the newly exposed parts of the
+ * content are rendered. This helps with large, mostly static content
+ * like text on slow GPUs or with the cairo renderer, at the cost of
+ * the memory for the texture.
+ *
+ * Any redraw of the child or its descendants invalidates the cache.
+ * The cache is not used when the child is transformed by more than a
+ * translation.
+ *
+ * Since: 4.2
+ */
+void
+gtk_viewport_set_scroll_cache (GtkViewport *viewport,
+                               gboolean     scroll_cache)
+{
+  g_return_if_fail (GTK_IS_VIEWPORT (viewport));
+
+  if (viewport->scroll_cache == scroll_cache)
+    return;
+
+  viewport->scroll_cache = scroll_cache;
+
+  gtk_viewport_clear_scroll_cache (viewport);
+  gtk_widget_queue_draw (GTK_WIDGET (viewport));
+
+  g_object_notify (G_OBJECT (viewport), "scroll-cache");
+}
+
 static void
 scroll_to_view (GtkAdjustment *adj,
                 double         pos,
@@ -56,6 +56,12 @@ GDK_AVAILABLE_IN_ALL
 void           gtk_viewport_set_scroll_to_focus (GtkViewport *viewport,
                                                  gboolean     scroll_to_focus);
 
+GDK_AVAILABLE_IN_4_2
+gboolean       gtk_viewport_get_scroll_cache    (GtkViewport *viewport);
+GDK_AVAILABLE_IN_4_2
+void           gtk_viewport_set_scroll_cache    (GtkViewport *viewport,
+                                                 gboolean     scroll_cache);
+
 GDK_AVAILABLE_IN_ALL
 void           gtk_viewport_set_child           (GtkViewport *viewport,
                                                  GtkWidget   *child);
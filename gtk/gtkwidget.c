@@ -42,6 +42,7 @@
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsswidgetnodeprivate.h"
 #include "gtkdebug.h"
+#include "gtkdrawingareaprivate.h"
 #include "gtkgesturedrag.h"
 #include "gtkgestureprivate.h"
 #include "gtkgesturesingle.h"
@@ -603,6 +604,9 @@ static void             gtk_widget_set_usize_internal           (GtkWidget
 static void     remove_parent_surface_transform_changed_listener (GtkWidget *widget);
 static void     add_parent_surface_transform_changed_listener    (GtkWidget *widget);
 static void     gtk_widget_queue_compute_expand                  (GtkWidget *widget);
+static void     gtk_widget_queue_redraw                          (GtkWidget *widget);
+static void     gtk_widget_invalidate_pick_indexes               (GtkWidget *widget);
+static void     gtk_widget_invalidate_top_transforms             (void);
 
 
 
@@ -901,7 +905,7 @@ static GtkAccessibleRole
 gtk_widget_get_accessible_role (GtkWidget *self)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (self);
-  GtkATContext *context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (self));
+  GtkATContext *context = priv->at_context;
   GtkWidgetClassPrivate *class_priv;
 
   if (context != NULL && gtk_at_context_is_realized (context))
@@ -2283,13 +2287,44 @@ gtk_widget_class_get_visible_by_default (GtkWidgetClass *widget_class)
   return !g_type_is_a (G_TYPE_FROM_CLASS (widget_class), GTK_TYPE_NATIVE);
 }
 
+/* Widgets only get events once they are rooted, so the controller
+ * for the class shortcuts is not created until then. Most widgets
+ * that are created in bulk, like list rows that get recycled or
+ * templates that are thrown away, never need it.
+ */
+static void
+gtk_widget_ensure_class_shortcuts (GtkWidget      *widget,
+                                   GtkWidgetClass *widget_class)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GListModel *shortcuts = G_LIST_MODEL (widget_class->priv->shortcuts);
+  GtkEventController *controller;
+
+  if (priv->class_shortcuts_added)
+    return;
+
+  priv->class_shortcuts_added = TRUE;
+
+  if (g_list_model_get_n_items (shortcuts) == 0)
+    return;
+
+  controller = gtk_shortcut_controller_new_for_model (shortcuts);
+  gtk_event_controller_set_name (controller, "gtk-widget-class-shortcuts");
+  GTK_EVENT_CONTROLLER_GET_CLASS (controller)->set_widget (controller, widget);
+
+  /* Put it behind all other controllers, where it would be
+   * if it had been added when the widget was created
+   */
+  priv->event_controllers = g_list_append (priv->event_controllers, controller);
+  gtk_widget_controllers_changed (widget);
+}
+
 static void
 gtk_widget_init (GTypeInstance *instance, gpointer g_class)
 {
   GtkWidget *widget = GTK_WIDGET (instance);
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GType layout_manager_type;
-  GtkEventController *controller;
 
   widget->priv = priv;
 
@@ -2365,25 +2400,46 @@ gtk_widget_init (GTypeInstance *instance, gpointer g_class)
   if (layout_manager_type != G_TYPE_INVALID)
     gtk_widget_set_layout_manager (widget, g_object_new (layout_manager_type, NULL));
 
-  if (g_list_model_get_n_items (G_LIST_MODEL (GTK_WIDGET_CLASS (g_class)->priv->shortcuts)) > 0)
-    {
-      controller = gtk_shortcut_controller_new_for_model (G_LIST_MODEL (GTK_WIDGET_CLASS (g_class)->priv->shortcuts));
-      gtk_event_controller_set_name (controller, "gtk-widget-class-shortcuts");
-      gtk_widget_add_controller (widget, controller);
-    }
+  /* Roots don't get rooted, so they need their shortcuts right away */
+  if (priv->root == (GtkRoot *) widget)
+    gtk_widget_ensure_class_shortcuts (widget, GTK_WIDGET_CLASS (g_class));
+}
 
-  priv->at_context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (widget));
+/*< private >
+ * gtk_widget_ensure_rare_data:
+ * @widget: a #GtkWidget
+ *
+ * Returns the rarely used state of @widget, creating it
+ * if it doesn't exist yet.
+ *
+ * Returns: (transfer none): the rare data of @widget
+ */
+GtkWidgetRareData *
+gtk_widget_ensure_rare_data (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (priv->rare_data == NULL)
+    priv->rare_data = g_slice_new0 (GtkWidgetRareData);
+
+  return priv->rare_data;
 }
 
 void
 gtk_widget_realize_at_context (GtkWidget *self)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (self);
-  GtkAccessibleRole role = priv->accessible_role;
+  GtkAccessibleRole role;
 
-  if (priv->at_context == NULL || gtk_at_context_is_realized (priv->at_context))
+  /* Roots get their context when they are mapped, so that
+   * ATs can find the application
+   */
+  if (gtk_accessible_get_at_context (GTK_ACCESSIBLE (self)) == NULL ||
+      gtk_at_context_is_realized (priv->at_context))
     return;
 
+  role = priv->accessible_role;
+
   /* Reset the accessible role to its current value */
   if (role == GTK_ACCESSIBLE_ROLE_WIDGET)
     {
@@ -2426,6 +2482,8 @@ gtk_widget_root (GtkWidget *widget)
       priv->root = priv->parent->priv->root;
     }
 
+  gtk_widget_ensure_class_shortcuts (widget, GTK_WIDGET_GET_CLASS (widget));
+
   if (priv->context)
     gtk_style_context_set_display (priv->context, gtk_root_get_display (priv->root));
 
@@ -2555,8 +2613,11 @@ gtk_widget_unparent (GtkWidget *widget)
       if (priv->next_sibling)
         priv->next_sibling->priv->prev_sibling = priv->prev_sibling;
     }
+  gtk_widget_invalidate_pick_indexes (old_parent);
+
   old_prev_sibling = priv->prev_sibling;
   priv->parent = NULL;
+  gtk_widget_invalidate_top_transforms ();
   priv->prev_sibling = NULL;
   priv->next_sibling = NULL;
 
@@ -2578,8 +2639,8 @@ gtk_widget_unparent (GtkWidget *widget)
 
   _gtk_widget_update_parent_muxer (widget);
 
-  if (old_parent->priv->children_observer)
-    gtk_list_list_model_item_removed (old_parent->priv->children_observer, old_prev_sibling);
+  if (old_parent->priv->rare_data && old_parent->priv->rare_data->children_observer)
+    gtk_list_list_model_item_removed (old_parent->priv->rare_data->children_observer, old_prev_sibling);
 
   if (old_parent->priv->layout_manager)
     gtk_layout_manager_remove_layout_child (old_parent->priv->layout_manager, widget);
@@ -2597,7 +2658,10 @@ gtk_widget_update_paintables (GtkWidget *widget)
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GSList *l;
 
-  for (l = priv->paintables; l; l = l->next)
+  if (priv->rare_data == NULL)
+    return;
+
+  for (l = priv->rare_data->paintables; l; l = l->next)
     gtk_widget_paintable_update_image (l->data);
 }
 
@@ -2607,7 +2671,10 @@ gtk_widget_push_paintables (GtkWidget *widget)
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GSList *l;
 
-  for (l = priv->paintables; l; l = l->next)
+  if (priv->rare_data == NULL)
+    return;
+
+  for (l = priv->rare_data->paintables; l; l = l->next)
     gtk_widget_paintable_push_snapshot_count (l->data);
 }
 
@@ -2617,7 +2684,10 @@ gtk_widget_pop_paintables (GtkWidget *widget)
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GSList *l;
 
-  for (l = priv->paintables; l; l = l->next)
+  if (priv->rare_data == NULL)
+    return;
+
+  for (l = priv->rare_data->paintables; l; l = l->next)
     gtk_widget_paintable_pop_snapshot_count (l->data);
 }
 
@@ -2760,9 +2830,12 @@ gtk_widget_real_hide (GtkWidget *widget)
     gtk_widget_unmap (widget);
 
   g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
+  priv->transform_needed = TRUE;
   priv->allocated_width = 0;
   priv->allocated_height = 0;
   priv->allocated_size_baseline = 0;
+  if (priv->transform)
+    gtk_widget_invalidate_top_transforms ();
   g_clear_pointer (&priv->transform, gsk_transform_unref);
   priv->width = 0;
   priv->height = 0;
@@ -2804,7 +2877,7 @@ gtk_widget_map (GtkWidget *widget)
 
       update_cursor_on_state_change (widget);
 
-      gtk_widget_queue_draw (widget);
+      gtk_widget_queue_redraw (widget);
 
       gtk_widget_pop_verify_invariants (widget);
     }
@@ -2827,7 +2900,7 @@ gtk_widget_unmap (GtkWidget *widget)
       g_object_ref (widget);
       gtk_widget_push_verify_invariants (widget);
 
-      gtk_widget_queue_draw (widget);
+      gtk_widget_queue_redraw (widget);
       _gtk_tooltip_hide (widget);
 
       g_signal_emit (widget, widget_signals[UNMAP], 0);
@@ -3463,6 +3536,20 @@ gtk_widget_queue_draw (GtkWidget *widget)
 {
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  /* Drawing areas keep what they drew until told otherwise,
+   * even while they aren't mapped */
+  if (GTK_IS_DRAWING_AREA (widget))
+    gtk_drawing_area_invalidate_content (GTK_DRAWING_AREA (widget));
+
+  gtk_widget_queue_redraw (widget);
+}
+
+/* Like gtk_widget_queue_draw(), for changes that don't affect what
+ * the widget itself draws, like it being mapped or its opacity.
+ */
+static void
+gtk_widget_queue_redraw (GtkWidget *widget)
+{
   /* Just return if the widget isn't mapped */
   if (!_gtk_widget_get_mapped (widget))
     return;
@@ -3537,9 +3624,14 @@ gtk_widget_queue_resize_internal (GtkWidget *widget)
     priv->resize_func (widget);
 
   groups = _gtk_widget_get_sizegroups (widget);
+  if (groups)
+    _gtk_size_group_invalidate_sizes ();
 
   for (l = groups; l; l = l->next)
     {
+      if (gtk_size_group_get_mode (l->data) == GTK_SIZE_GROUP_NONE)
+        continue;
+
       for (widgets = gtk_size_group_get_widgets (l->data); widgets; widgets = widgets->next)
         gtk_widget_queue_resize_internal (widgets->data);
     }
@@ -3812,6 +3904,34 @@ gtk_widget_adjust_size_allocation (GtkWidget     *widget,
                     &allocation->height);
 }
 
+#ifdef G_ENABLE_DEBUG
+typedef enum {
+  ALLOCATION_DONE,
+  ALLOCATION_SKIPPED,   /* new transform, same size */
+  ALLOCATION_MEMOIZED,  /* same inputs as the last allocation */
+  N_ALLOCATION_RESULTS
+} AllocationResult;
+
+#define ALLOCATION_STATS_INTERVAL 10000
+
+static void
+record_allocation (AllocationResult result)
+{
+  static guint counts[N_ALLOCATION_RESULTS];
+  static guint n_allocations;
+
+  counts[result]++;
+
+  if (++n_allocations % ALLOCATION_STATS_INTERVAL == 0)
+    {
+      g_message ("Allocations: %u, size_allocate skipped: %u, memoized: %u",
+                 n_allocations,
+                 counts[ALLOCATION_SKIPPED],
+                 counts[ALLOCATION_MEMOIZED]);
+    }
+}
+#endif
+
 /**
  * gtk_widget_allocate:
  * @widget: A #GtkWidget
@@ -3888,9 +4008,29 @@ gtk_widget_allocate (GtkWidget    *widget,
     }
 #endif /* G_ENABLE_DEBUG */
 
+  /* If nothing changed since the last allocation, the transform, size
+   * and baseline computed from it are still valid, and so are the
+   * allocations of the children
+   */
+  if (!priv->alloc_needed &&
+      !priv->transform_needed &&
+      width == priv->allocated_width &&
+      height == priv->allocated_height &&
+      baseline == priv->allocated_size_baseline &&
+      gsk_transform_equal (priv->allocated_transform, transform))
+    {
+      gsk_transform_unref (transform);
+      GTK_NOTE (LAYOUT, record_allocation (ALLOCATION_MEMOIZED));
+      goto out;
+    }
+
+  /* Our pick bounds change, so the parent's index can't be used anymore */
+  gtk_widget_invalidate_pick_indexes (priv->parent);
+
   alloc_needed = priv->alloc_needed;
   /* Preserve request/allocate ordering */
   priv->alloc_needed = FALSE;
+  priv->transform_needed = FALSE;
 
   baseline_changed = priv->allocated_size_baseline != baseline;
   transform_changed = !gsk_transform_equal (priv->allocated_transform, transform);
@@ -3961,6 +4101,9 @@ gtk_widget_allocate (GtkWidget    *widget,
   if (adjusted.x || adjusted.y)
     transform = gsk_transform_translate (transform, &GRAPHENE_POINT_INIT (adjusted.x, adjusted.y));
 
+  if (!gsk_transform_equal (priv->transform, transform))
+    gtk_widget_invalidate_top_transforms ();
+
   gsk_transform_unref (priv->transform);
   priv->transform = transform;
 
@@ -3976,7 +4119,12 @@ gtk_widget_allocate (GtkWidget    *widget,
   size_changed = (priv->width != adjusted.width) || (priv->height != adjusted.height);
 
   if (!alloc_needed && !size_changed && !baseline_changed)
-    goto skip_allocate;
+    {
+      GTK_NOTE (LAYOUT, record_allocation (ALLOCATION_SKIPPED));
+      goto skip_allocate;
+    }
+
+  GTK_NOTE (LAYOUT, record_allocation (ALLOCATION_DONE));
 
   priv->width = adjusted.width;
   priv->height = adjusted.height;
@@ -4410,6 +4558,94 @@ gtk_widget_real_mnemonic_activate (GtkWidget *widget,
 #define WIDGET_REALIZED_FOR_EVENT(widget, event) \
      (gdk_event_get_event_type (event) == GDK_FOCUS_CHANGE || _gtk_widget_get_realized (widget))
 
+/* The controllers of a widget that handle events in each
+ * propagation phase, and the event types they may handle.
+ */
+struct _GtkWidgetControllerTable
+{
+  GPtrArray *controllers[GTK_PHASE_TARGET + 1];
+  guint event_mask[GTK_PHASE_TARGET + 1];
+};
+
+static void
+gtk_widget_controller_table_free (GtkWidgetControllerTable *table)
+{
+  int phase;
+
+  for (phase = GTK_PHASE_CAPTURE; phase <= GTK_PHASE_TARGET; phase++)
+    g_ptr_array_unref (table->controllers[phase]);
+
+  g_slice_free (GtkWidgetControllerTable, table);
+}
+
+static GtkWidgetControllerTable *
+gtk_widget_get_controller_table (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetControllerTable *table;
+  int phase;
+  GList *l;
+
+  if (priv->controller_table)
+    return priv->controller_table;
+
+  table = g_slice_new0 (GtkWidgetControllerTable);
+  for (phase = GTK_PHASE_CAPTURE; phase <= GTK_PHASE_TARGET; phase++)
+    table->controllers[phase] = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (l = priv->event_controllers; l; l = l->next)
+    {
+      GtkEventController *controller = l->data;
+
+      if (controller == NULL)
+        continue;
+
+      phase = gtk_event_controller_get_propagation_phase (controller);
+      if (phase == GTK_PHASE_NONE)
+        continue;
+
+      /* The table keeps controllers alive while they run, in case
+       * they get removed from the widget while handling an event
+       */
+      g_ptr_array_add (table->controllers[phase], g_object_ref (controller));
+      table->event_mask[phase] |= GTK_EVENT_CONTROLLER_GET_CLASS (controller)->event_mask;
+    }
+
+  priv->controller_table = table;
+
+  return table;
+}
+
+/*< private >
+ * gtk_widget_controllers_changed:
+ * @widget: a #GtkWidget
+ *
+ * Must be called when a controller is added to or removed from
+ * @widget, or when one of its controllers changes its propagation
+ * phase.
+ */
+void
+gtk_widget_controllers_changed (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  g_clear_pointer (&priv->controller_table, gtk_widget_controller_table_free);
+}
+
+static inline gboolean
+gtk_widget_has_controllers_for_event (GtkWidget           *widget,
+                                      GdkEvent            *event,
+                                      GtkPropagationPhase  phase)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (priv->event_controllers == NULL)
+    return FALSE;
+
+  return (gtk_widget_get_controller_table (widget)->event_mask[phase] &
+          GTK_EVENT_TYPE_MASK (gdk_event_get_event_type (event))) != 0;
+}
+
 gboolean
 gtk_widget_run_controllers (GtkWidget           *widget,
                             GdkEvent            *event,
@@ -4418,71 +4654,70 @@ gtk_widget_run_controllers (GtkWidget           *widget,
                             double               y,
                             GtkPropagationPhase  phase)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkEventController *controller;
+  GPtrArray *controllers;
   gboolean handled = FALSE;
-  GList *l;
+  guint event_type_mask;
+  guint i;
+
+  if (!gtk_widget_has_controllers_for_event (widget, event, phase))
+    return FALSE;
 
   g_object_ref (widget);
 
-  l = priv->event_controllers;
-  while (l != NULL)
+  event_type_mask = GTK_EVENT_TYPE_MASK (gdk_event_get_event_type (event));
+
+  /* Controllers may change the table while we go through it */
+  controllers = g_ptr_array_ref (gtk_widget_get_controller_table (widget)->controllers[phase]);
+
+  for (i = 0; i < controllers->len; i++)
     {
-      GList *next = l->next;
+      gboolean this_handled;
 
       if (!WIDGET_REALIZED_FOR_EVENT (widget, event))
         break;
 
-      controller = l->data;
+      controller = g_ptr_array_index (controllers, i);
 
-      if (controller == NULL)
-        {
-          priv->event_controllers = g_list_delete_link (priv->event_controllers, l);
-        }
-      else
-        {
-          GtkPropagationPhase controller_phase;
-
-          controller_phase = gtk_event_controller_get_propagation_phase (controller);
+      /* Skip controllers that got removed or changed their phase
+       * while we were running the ones before them
+       */
+      if (gtk_event_controller_get_widget (controller) != widget ||
+          gtk_event_controller_get_propagation_phase (controller) != phase)
+        continue;
 
-          if (controller_phase == phase)
-            {
-              gboolean this_handled;
-              gboolean is_gesture;
+      if ((GTK_EVENT_CONTROLLER_GET_CLASS (controller)->event_mask & event_type_mask) == 0)
+        continue;
 
-              is_gesture = GTK_IS_GESTURE (controller);
-              this_handled = gtk_event_controller_handle_event (controller, event, target, x, y);
+      this_handled = gtk_event_controller_handle_event (controller, event, target, x, y);
 
 #ifdef G_ENABLE_DEBUG
-              if (GTK_DEBUG_CHECK (KEYBINDINGS))
-                {
-                  GdkEventType type = gdk_event_get_event_type (event);
-                  if (this_handled &&
-                      (type == GDK_KEY_PRESS || type == GDK_KEY_RELEASE))
-                    {
-                      g_message ("key %s (keyval %d) handled at widget %s by controller %s",
-                                 type == GDK_KEY_PRESS ? "press" : "release",
-                                 gdk_key_event_get_keyval (event),
-                                 G_OBJECT_TYPE_NAME (widget),
-                                 gtk_event_controller_get_name (controller));
-                    }
-                }
-#endif
-
-              handled |= this_handled;
-
-              /* Non-gesture controllers are basically unique entities not meant
-               * to collaborate with anything else. Break early if any such event
-               * controller handled the event.
-               */
-              if (this_handled && !is_gesture)
-                break;
+      if (GTK_DEBUG_CHECK (KEYBINDINGS))
+        {
+          GdkEventType type = gdk_event_get_event_type (event);
+          if (this_handled &&
+              (type == GDK_KEY_PRESS || type == GDK_KEY_RELEASE))
+            {
+              g_message ("key %s (keyval %d) handled at widget %s by controller %s",
+                         type == GDK_KEY_PRESS ? "press" : "release",
+                         gdk_key_event_get_keyval (event),
+                         G_OBJECT_TYPE_NAME (widget),
+                         gtk_event_controller_get_name (controller));
             }
         }
+#endif
 
-      l = next;
+      handled |= this_handled;
+
+      /* Non-gesture controllers are basically unique entities not meant
+       * to collaborate with anything else. Break early if any such event
+       * controller handled the event.
+       */
+      if (this_handled && !GTK_IS_GESTURE (controller))
+        break;
     }
 
+  g_ptr_array_unref (controllers);
   g_object_unref (widget);
 
   return handled;
@@ -4612,6 +4847,12 @@ _gtk_widget_captured_event (GtkWidget *widget,
   if (!event_surface_is_still_viewable (event))
     return TRUE;
 
+  /* Don't bother translating coordinates for widgets that
+   * can't do anything with the event
+   */
+  if (!gtk_widget_has_controllers_for_event (widget, event, GTK_PHASE_CAPTURE))
+    return FALSE;
+
   translate_event_coordinates (event, &x, &y, widget);
 
   return_val = gtk_widget_run_controllers (widget, event, target, x, y, GTK_PHASE_CAPTURE);
@@ -4639,6 +4880,11 @@ gtk_widget_event (GtkWidget *widget,
   if (!_gtk_widget_get_mapped (widget))
     return FALSE;
 
+  if (!gtk_widget_has_controllers_for_event (widget, event, GTK_PHASE_BUBBLE) &&
+      (widget != target ||
+       !gtk_widget_has_controllers_for_event (widget, event, GTK_PHASE_TARGET)))
+    return FALSE;
+
   translate_event_coordinates (event, &x, &y, widget);
 
   if (widget == target)
@@ -4838,6 +5084,34 @@ gtk_widget_query_tooltip (GtkWidget  *widget,
   return retval;
 }
 
+/* The CSS transform is applied on top of the allocation the parent
+ * handed out, so for a widget whose allocation is otherwise current,
+ * as with transform animations, we can apply a new one by repeating
+ * that allocation instead of allocating the parent again.
+ */
+static gboolean
+gtk_widget_update_css_transform (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (priv->parent == NULL ||
+      !_gtk_widget_get_mapped (widget) ||
+      priv->resize_needed ||
+      priv->alloc_needed)
+    return FALSE;
+
+  gtk_widget_allocate (widget,
+                       priv->allocated_width,
+                       priv->allocated_height,
+                       priv->allocated_size_baseline,
+                       gsk_transform_ref (priv->allocated_transform));
+
+  /* The transform node is part of the parent's render node */
+  gtk_widget_queue_draw (priv->parent);
+
+  return TRUE;
+}
+
 static void
 gtk_widget_real_css_changed (GtkWidget         *widget,
                              GtkCssStyleChange *change)
@@ -4860,7 +5134,9 @@ gtk_widget_real_css_changed (GtkWidget         *widget,
             }
           else if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TRANSFORM))
             {
-              gtk_widget_queue_allocate (priv->parent);
+              priv->transform_needed = TRUE;
+              if (!gtk_widget_update_css_transform (widget))
+                gtk_widget_queue_allocate (priv->parent);
             }
 
           if (gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_REDRAW) ||
@@ -5587,9 +5863,12 @@ _gtk_widget_set_visible_flag (GtkWidget *widget,
   if (!visible)
     {
       g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
+      priv->transform_needed = TRUE;
       priv->allocated_width = 0;
       priv->allocated_height = 0;
       priv->allocated_size_baseline = 0;
+      if (priv->transform)
+        gtk_widget_invalidate_top_transforms ();
       g_clear_pointer (&priv->transform, gsk_transform_unref);
       priv->width = 0;
       priv->height = 0;
@@ -5842,6 +6121,7 @@ gtk_widget_reposition_after (GtkWidget *widget,
   gtk_widget_push_verify_invariants (widget);
 
   priv->parent = parent;
+  gtk_widget_invalidate_top_transforms ();
 
   if (previous_sibling)
     {
@@ -5908,17 +6188,19 @@ gtk_widget_reposition_after (GtkWidget *widget,
                              priv->cssnode,
                              previous_sibling ? previous_sibling->priv->cssnode : NULL);
 
+  gtk_widget_invalidate_pick_indexes (parent);
+
   _gtk_widget_update_parent_muxer (widget);
 
   if (parent->priv->root && priv->root == NULL)
     gtk_widget_root (widget);
 
-  if (parent->priv->children_observer)
+  if (parent->priv->rare_data && parent->priv->rare_data->children_observer)
     {
       if (prev_previous)
-        gtk_list_list_model_item_moved (parent->priv->children_observer, widget, prev_previous);
+        gtk_list_list_model_item_moved (parent->priv->rare_data->children_observer, widget, prev_previous);
       else
-        gtk_list_list_model_item_added (parent->priv->children_observer, widget);
+        gtk_list_list_model_item_added (parent->priv->rare_data->children_observer, widget);
     }
 
   if (prev_parent == NULL)
@@ -7190,10 +7472,13 @@ gtk_widget_dispose (GObject *object)
   if (muxer != NULL)
     g_object_run_dispose (G_OBJECT (muxer));
 
-  if (priv->children_observer)
-    gtk_list_list_model_clear (priv->children_observer);
-  if (priv->controller_observer)
-    gtk_list_list_model_clear (priv->controller_observer);
+  if (priv->rare_data)
+    {
+      if (priv->rare_data->children_observer)
+        gtk_list_list_model_clear (priv->rare_data->children_observer);
+      if (priv->rare_data->controller_observer)
+        gtk_list_list_model_clear (priv->rare_data->controller_observer);
+    }
 
   if (priv->parent)
     {
@@ -7202,10 +7487,11 @@ gtk_widget_dispose (GObject *object)
                   G_OBJECT_TYPE_NAME (widget), widget,
                   G_OBJECT_TYPE_NAME (priv->parent), priv->parent);
       priv->parent = NULL;
+      gtk_widget_invalidate_top_transforms ();
     }
 
-  while (priv->paintables)
-    gtk_widget_paintable_set_widget (priv->paintables->data, NULL);
+  while (priv->rare_data && priv->rare_data->paintables)
+    gtk_widget_paintable_set_widget (priv->rare_data->paintables->data, NULL);
 
   if (priv->layout_manager != NULL)
     gtk_layout_manager_set_widget (priv->layout_manager, NULL);
@@ -7215,7 +7501,8 @@ gtk_widget_dispose (GObject *object)
   if (_gtk_widget_get_realized (widget))
     gtk_widget_unrealize (widget);
 
-  g_clear_object (&priv->cursor);
+  if (priv->rare_data)
+    g_clear_object (&priv->rare_data->cursor);
 
   if (!priv->in_destruction)
     {
@@ -7235,7 +7522,7 @@ gtk_widget_dispose (GObject *object)
       gtk_size_group_remove_widget (size_group, widget);
     }
 
-  at_context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (widget));
+  at_context = gtk_accessible_peek_at_context (GTK_ACCESSIBLE (widget));
   if (at_context != NULL)
     gtk_at_context_unrealize (at_context);
 
@@ -7390,11 +7677,18 @@ gtk_widget_finalize (GObject *object)
   gtk_grab_remove (widget);
 
   g_free (priv->name);
-  g_free (priv->tooltip_markup);
-  g_free (priv->tooltip_text);
+
+  if (priv->rare_data)
+    {
+      g_free (priv->rare_data->tooltip_markup);
+      g_free (priv->rare_data->tooltip_text);
+      g_clear_pointer (&priv->rare_data->top_transform, graphene_matrix_free);
+      g_slice_free (GtkWidgetRareData, priv->rare_data);
+    }
 
   g_clear_pointer (&priv->transform, gsk_transform_unref);
   g_clear_pointer (&priv->allocated_transform, gsk_transform_unref);
+  gtk_widget_set_use_pick_index (widget, FALSE);
 
   gtk_css_widget_node_widget_destroyed (GTK_CSS_WIDGET_NODE (priv->cssnode));
   g_object_unref (priv->cssnode);
@@ -8303,6 +8597,18 @@ gtk_widget_accessible_get_at_context (GtkAccessible *accessible)
   return priv->at_context;
 }
 
+static GtkATContext *
+gtk_widget_accessible_peek_at_context (GtkAccessible *accessible)
+{
+  GtkWidget *self = GTK_WIDGET (accessible);
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (self);
+
+  if (priv->in_destruction)
+    return NULL;
+
+  return priv->at_context;
+}
+
 static gboolean
 gtk_widget_accessible_get_platform_state (GtkAccessible              *self,
                                           GtkAccessiblePlatformState  state)
@@ -8322,6 +8628,7 @@ static void
 gtk_widget_accessible_interface_init (GtkAccessibleInterface *iface)
 {
   iface->get_at_context = gtk_widget_accessible_get_at_context;
+  iface->peek_at_context = gtk_widget_accessible_peek_at_context;
   iface->get_platform_state = gtk_widget_accessible_get_platform_state;
 }
 
@@ -9592,17 +9899,22 @@ gtk_widget_set_tooltip_text (GtkWidget  *widget,
       tooltip_markup = text != NULL ? g_markup_escape_text (text, -1) : NULL;
     }
 
-  g_clear_pointer (&priv->tooltip_markup, g_free);
-  g_clear_pointer (&priv->tooltip_text, g_free);
+  if (tooltip_text != NULL || priv->rare_data != NULL)
+    {
+      GtkWidgetRareData *rare_data = gtk_widget_ensure_rare_data (widget);
+
+      g_clear_pointer (&rare_data->tooltip_markup, g_free);
+      g_clear_pointer (&rare_data->tooltip_text, g_free);
 
-  priv->tooltip_text = tooltip_text;
-  priv->tooltip_markup = tooltip_markup;
+      rare_data->tooltip_text = tooltip_text;
+      rare_data->tooltip_markup = tooltip_markup;
+    }
 
   gtk_accessible_update_property (GTK_ACCESSIBLE (widget),
-                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, priv->tooltip_text,
+                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, tooltip_text,
                                   -1);
 
-  gtk_widget_set_has_tooltip (widget, priv->tooltip_text != NULL);
+  gtk_widget_set_has_tooltip (widget, tooltip_text != NULL);
   if (_gtk_widget_get_visible (widget))
     gtk_widget_trigger_tooltip_query (widget);
 
@@ -9631,7 +9943,7 @@ gtk_widget_get_tooltip_text (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->tooltip_text;
+  return priv->rare_data ? priv->rare_data->tooltip_text : NULL;
 }
 
 /**
@@ -9654,7 +9966,7 @@ gtk_widget_set_tooltip_markup (GtkWidget  *widget,
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GObject *object = G_OBJECT (widget);
-  char *tooltip_markup;
+  char *tooltip_markup, *tooltip_text = NULL;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
@@ -9668,24 +9980,30 @@ gtk_widget_set_tooltip_markup (GtkWidget  *widget,
   else
     tooltip_markup = g_strdup (markup);
 
-  g_clear_pointer (&priv->tooltip_text, g_free);
-  g_clear_pointer (&priv->tooltip_markup, g_free);
-
-  priv->tooltip_markup = tooltip_markup;
-
   /* Store the tooltip without markup, as we might end up using
    * it for widget descriptions in the accessibility layer
    */
-  if (priv->tooltip_markup != NULL)
+  if (tooltip_markup != NULL)
     {
-      pango_parse_markup (priv->tooltip_markup, -1, 0, NULL,
-                          &priv->tooltip_text,
+      pango_parse_markup (tooltip_markup, -1, 0, NULL,
+                          &tooltip_text,
                           NULL,
                           NULL);
     }
 
+  if (tooltip_markup != NULL || priv->rare_data != NULL)
+    {
+      GtkWidgetRareData *rare_data = gtk_widget_ensure_rare_data (widget);
+
+      g_clear_pointer (&rare_data->tooltip_text, g_free);
+      g_clear_pointer (&rare_data->tooltip_markup, g_free);
+
+      rare_data->tooltip_markup = tooltip_markup;
+      rare_data->tooltip_text = tooltip_text;
+    }
+
   gtk_accessible_update_property (GTK_ACCESSIBLE (widget),
-                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, priv->tooltip_text,
+                                  GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, tooltip_text,
                                   -1);
 
   gtk_widget_set_has_tooltip (widget, tooltip_markup != NULL);
@@ -9715,7 +10033,7 @@ gtk_widget_get_tooltip_markup (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->tooltip_markup;
+  return priv->rare_data ? priv->rare_data->tooltip_markup : NULL;
 }
 
 /**
@@ -9855,6 +10173,68 @@ gtk_widget_can_be_picked (GtkWidget    *widget,
   return TRUE;
 }
 
+static GtkWidget *gtk_widget_do_pick (GtkWidget    *widget,
+                                      double        x,
+                                      double        y,
+                                      GtkPickFlags  flags);
+
+static GtkWidget *
+gtk_widget_do_pick_child (GtkWidget    *child,
+                          double        x,
+                          double        y,
+                          GtkPickFlags  flags)
+{
+  GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
+  graphene_point3d_t res;
+
+  if (!gtk_widget_can_be_picked (child, flags))
+    return NULL;
+
+  if (GTK_IS_NATIVE (child))
+    return NULL;
+
+  if (child_priv->transform)
+    {
+      if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+        {
+          graphene_point_t transformed_p;
+
+          gsk_transform_transform_point (child_priv->transform,
+                                         &(graphene_point_t) { 0, 0 },
+                                         &transformed_p);
+
+          graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
+        }
+      else
+        {
+          GskTransform *transform;
+          graphene_matrix_t inv;
+          graphene_point3d_t p0, p1;
+
+          transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
+          if (transform == NULL)
+            return NULL;
+
+          gsk_transform_to_matrix (transform, &inv);
+          gsk_transform_unref (transform);
+          graphene_point3d_init (&p0, x, y, 0);
+          graphene_point3d_init (&p1, x, y, 1);
+          graphene_matrix_transform_point3d (&inv, &p0, &p0);
+          graphene_matrix_transform_point3d (&inv, &p1, &p1);
+          if (fabs (p0.z - p1.z) < 1.f / 4096)
+            return NULL;
+
+          graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
+        }
+    }
+  else
+    {
+      graphene_point3d_init (&res, x, y, 0);
+    }
+
+  return gtk_widget_do_pick (child, res.x, res.y, flags);
+}
+
 static GtkWidget *
 gtk_widget_do_pick (GtkWidget    *widget,
                     double        x,
@@ -9863,6 +10243,7 @@ gtk_widget_do_pick (GtkWidget    *widget,
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GtkWidget *child;
+  GtkWidget *picked;
 
   if (priv->overflow == GTK_OVERFLOW_HIDDEN)
     {
@@ -9875,68 +10256,172 @@ gtk_widget_do_pick (GtkWidget    *widget,
         return NULL;
     }
 
-  for (child = _gtk_widget_get_last_child (widget);
-       child;
-       child = _gtk_widget_get_prev_sibling (child))
+  if (priv->pick_index && gtk_pick_index_ensure (priv->pick_index, widget))
     {
-      GtkWidgetPrivate *child_priv = gtk_widget_get_instance_private (child);
-      GtkWidget *picked;
-      graphene_point3d_t res;
+      GtkPickIndexIter iter;
 
-      if (!gtk_widget_can_be_picked (child, flags))
-        continue;
+      gtk_pick_index_iter_init (&iter, priv->pick_index, x, y);
+      while ((child = gtk_pick_index_iter_next (&iter)))
+        {
+          picked = gtk_widget_do_pick_child (child, x, y, flags);
+          if (picked)
+            return picked;
+        }
+    }
+  else
+    {
+      for (child = _gtk_widget_get_last_child (widget);
+           child;
+           child = _gtk_widget_get_prev_sibling (child))
+        {
+          picked = gtk_widget_do_pick_child (child, x, y, flags);
+          if (picked)
+            return picked;
+        }
+    }
+
+  if (!GTK_WIDGET_GET_CLASS (widget)->contains (widget, x, y))
+    return NULL;
+
+  return widget;
+}
+
+/* Computes an area in @widget's coordinates outside of which
+ * gtk_widget_do_pick() can't find anything.
+ * Returns FALSE if there is no such area.
+ */
+static gboolean
+gtk_widget_get_pick_bounds (GtkWidget       *widget,
+                            graphene_rect_t *bounds)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkCssBoxes boxes;
+  GtkWidget *child;
+
+  /* Custom contains() implementations may reach outside the border box */
+  if (GTK_WIDGET_GET_CLASS (widget)->contains != gtk_widget_real_contains)
+    return FALSE;
+
+  gtk_css_boxes_init (&boxes, widget);
+  *bounds = gtk_css_boxes_get_border_box (&boxes)->bounds;
+
+  /* Children are clipped to the padding box */
+  if (priv->overflow == GTK_OVERFLOW_HIDDEN)
+    return TRUE;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      graphene_rect_t child_bounds;
 
       if (GTK_IS_NATIVE (child))
         continue;
 
-      if (child_priv->transform)
-        {
-          if (gsk_transform_get_category (child_priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
-            {
-              graphene_point_t transformed_p;
+      if (!gtk_widget_get_child_pick_bounds (child, &child_bounds))
+        return FALSE;
 
-              gsk_transform_transform_point (child_priv->transform,
-                                             &(graphene_point_t) { 0, 0 },
-                                             &transformed_p);
+      graphene_rect_union (bounds, &child_bounds, bounds);
+    }
 
-              graphene_point3d_init (&res, x - transformed_p.x, y - transformed_p.y, 0.);
-            }
-          else
-            {
-              GskTransform *transform;
-              graphene_matrix_t inv;
-              graphene_point3d_t p0, p1;
+  return TRUE;
+}
 
-              transform = gsk_transform_invert (gsk_transform_ref (child_priv->transform));
-              if (transform == NULL)
-                continue;
+/*< private >
+ * gtk_widget_get_child_pick_bounds:
+ * @child: a #GtkWidget with a parent
+ * @bounds: (out caller-allocates): return location for the bounds
+ *
+ * Computes the area, in the coordinates of the parent of @child,
+ * outside of which picking @child and its descendants can't find
+ * anything. This is used by #GtkPickIndex.
+ *
+ * Returns: %FALSE if there is no such area, for example because
+ *   of a 3D transform
+ */
+gboolean
+gtk_widget_get_child_pick_bounds (GtkWidget       *child,
+                                  graphene_rect_t *bounds)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (child);
 
-              gsk_transform_to_matrix (transform, &inv);
-              gsk_transform_unref (transform);
-              graphene_point3d_init (&p0, x, y, 0);
-              graphene_point3d_init (&p1, x, y, 1);
-              graphene_matrix_transform_point3d (&inv, &p0, &p0);
-              graphene_matrix_transform_point3d (&inv, &p1, &p1);
-              if (fabs (p0.z - p1.z) < 1.f / 4096)
-                continue;
+  if (!gtk_widget_get_pick_bounds (child, bounds))
+    return FALSE;
 
-              graphene_point3d_interpolate (&p0, &p1, p0.z / (p0.z - p1.z), &res);
-            }
-        }
-      else
-        {
-          graphene_point3d_init (&res, x, y, 0);
-        }
+  if (priv->transform == NULL)
+    return TRUE;
 
-      picked = gtk_widget_do_pick (child, res.x, res.y, flags);
-      if (picked)
-        return picked;
+  /* This must match the way gtk_widget_do_pick_child() maps points */
+  if (gsk_transform_get_category (priv->transform) >= GSK_TRANSFORM_CATEGORY_2D_AFFINE)
+    {
+      graphene_point_t origin;
+
+      gsk_transform_transform_point (priv->transform,
+                                     &(graphene_point_t) { 0, 0 },
+                                     &origin);
+      graphene_rect_offset (bounds, origin.x, origin.y);
+    }
+  else if (gsk_transform_get_category (priv->transform) >= GSK_TRANSFORM_CATEGORY_2D)
+    {
+      gsk_transform_transform_bounds (priv->transform, bounds, bounds);
+    }
+  else
+    {
+      return FALSE;
     }
 
-  if (!GTK_WIDGET_GET_CLASS (widget)->contains (widget, x, y))
-    return NULL;
+  return TRUE;
+}
 
-  return widget;
+/* Number of widgets with a pick index, to avoid walking up the
+ * tree on every allocation when nobody uses them
+ */
+static guint n_pick_indexes;
+
+/* Invalidates the pick indexes that may contain @widget's children */
+static void
+gtk_widget_invalidate_pick_indexes (GtkWidget *widget)
+{
+  if (n_pick_indexes == 0)
+    return;
+
+  for (; widget; widget = widget->priv->parent)
+    {
+      if (widget->priv->pick_index)
+        gtk_pick_index_invalidate (widget->priv->pick_index);
+    }
+}
+
+/*< private >
+ * gtk_widget_set_use_pick_index:
+ * @widget: a #GtkWidget
+ * @use_pick_index: whether to use a pick index
+ *
+ * Makes gtk_widget_pick() look up the children of @widget in a
+ * spatial index instead of walking all of them.
+ *
+ * This is meant for containers that can have a large number of
+ * children. For widgets with few children, the index is not used.
+ */
+void
+gtk_widget_set_use_pick_index (GtkWidget *widget,
+                               gboolean   use_pick_index)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  if (use_pick_index == (priv->pick_index != NULL))
+    return;
+
+  if (use_pick_index)
+    {
+      priv->pick_index = gtk_pick_index_new ();
+      n_pick_indexes++;
+    }
+  else
+    {
+      g_clear_pointer (&priv->pick_index, gtk_pick_index_free);
+      n_pick_indexes--;
+    }
 }
 
 /**
@@ -9976,6 +10461,49 @@ gtk_widget_pick (GtkWidget    *widget,
   return gtk_widget_do_pick (widget, x, y, flags);
 }
 
+/* The transforms of widgets to their topmost ancestor are cached until
+ * the transform of any widget changes or a widget gets a new parent.
+ * This happens rarely outside of size allocation, while the transforms
+ * are needed for every event.
+ */
+static guint top_transform_generation = 1;
+
+static void
+gtk_widget_invalidate_top_transforms (void)
+{
+  top_transform_generation++;
+  if (top_transform_generation == 0)
+    top_transform_generation = 1;
+}
+
+static const graphene_matrix_t *
+gtk_widget_get_top_transform (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data = gtk_widget_ensure_rare_data (widget);
+
+  if (rare_data->top_transform == NULL)
+    rare_data->top_transform = graphene_matrix_alloc ();
+  else if (rare_data->top_transform_generation == top_transform_generation)
+    return rare_data->top_transform;
+
+  if (priv->parent != NULL)
+    {
+      graphene_matrix_t transform;
+
+      gsk_transform_to_matrix (priv->transform, &transform);
+      graphene_matrix_multiply (&transform,
+                                gtk_widget_get_top_transform (priv->parent),
+                                rare_data->top_transform);
+    }
+  else
+    graphene_matrix_init_identity (rare_data->top_transform);
+
+  rare_data->top_transform_generation = top_transform_generation;
+
+  return rare_data->top_transform;
+}
+
 /**
  * gtk_widget_compute_transform:
  * @widget: a #GtkWidget
@@ -9998,6 +10526,7 @@ gtk_widget_compute_transform (GtkWidget         *widget,
 {
   GtkWidget *ancestor, *iter;
   graphene_matrix_t transform, inverse, tmp;
+  const graphene_matrix_t *widget_transform;
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
   g_return_val_if_fail (GTK_IS_WIDGET (target), FALSE);
@@ -10013,6 +10542,19 @@ gtk_widget_compute_transform (GtkWidget         *widget,
       return TRUE;
     }
 
+  /* Widgets in the same root have it as a common ancestor, so we can go
+   * through it with the cached transforms instead of walking up the tree
+   */
+  if (widget->priv->root != NULL)
+    {
+      widget_transform = gtk_widget_get_top_transform (widget);
+      if (graphene_matrix_inverse (gtk_widget_get_top_transform (target), &inverse))
+        {
+          graphene_matrix_multiply (widget_transform, &inverse, out_transform);
+          return TRUE;
+        }
+    }
+
   ancestor = gtk_widget_common_ancestor (widget, target);
   if (ancestor == NULL)
     {
@@ -10215,7 +10757,7 @@ gtk_widget_set_opacity (GtkWidget *widget,
 
   priv->user_alpha = alpha;
 
-  gtk_widget_queue_draw (widget);
+  gtk_widget_queue_redraw (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OPACITY]);
 }
@@ -10265,7 +10807,8 @@ gtk_widget_set_overflow (GtkWidget   *widget,
 
   priv->overflow = overflow;
 
-  gtk_widget_queue_draw (widget);
+  gtk_widget_invalidate_pick_indexes (priv->parent);
+  gtk_widget_queue_redraw (widget);
 
   g_object_notify_by_pspec (G_OBJECT (widget), widget_props[PROP_OVERFLOW]);
 }
@@ -11248,9 +11791,10 @@ gtk_widget_add_controller (GtkWidget          *widget,
   GTK_EVENT_CONTROLLER_GET_CLASS (controller)->set_widget (controller, widget);
 
   priv->event_controllers = g_list_prepend (priv->event_controllers, controller);
+  gtk_widget_controllers_changed (widget);
 
-  if (priv->controller_observer)
-    gtk_list_list_model_item_added_at (priv->controller_observer, 0);
+  if (priv->rare_data && priv->rare_data->controller_observer)
+    gtk_list_list_model_item_added_at (priv->rare_data->controller_observer, 0);
 }
 
 /**
@@ -11280,10 +11824,11 @@ gtk_widget_remove_controller (GtkWidget          *widget,
   list = g_list_find (priv->event_controllers, controller);
   before = list->prev;
   priv->event_controllers = g_list_delete_link (priv->event_controllers, list);
+  gtk_widget_controllers_changed (widget);
   g_object_unref (controller);
 
-  if (priv->controller_observer)
-    gtk_list_list_model_item_removed (priv->controller_observer, before);
+  if (priv->rare_data && priv->rare_data->controller_observer)
+    gtk_list_list_model_item_removed (priv->rare_data->controller_observer, before);
 }
 
 gboolean
@@ -11521,7 +12066,7 @@ gtk_widget_child_observer_destroyed (gpointer widget)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-  priv->children_observer = NULL;
+  priv->rare_data->children_observer = NULL;
 }
 
 /**
@@ -11543,22 +12088,24 @@ gtk_widget_child_observer_destroyed (gpointer widget)
 GListModel *
 gtk_widget_observe_children (GtkWidget *widget)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data;
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  if (priv->children_observer)
-    return g_object_ref (G_LIST_MODEL (priv->children_observer));
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
+  if (rare_data->children_observer)
+    return g_object_ref (G_LIST_MODEL (rare_data->children_observer));
 
-  priv->children_observer = gtk_list_list_model_new ((gpointer) gtk_widget_get_first_child,
-                                                     (gpointer) gtk_widget_get_next_sibling,
-                                                     (gpointer) gtk_widget_get_prev_sibling,
-                                                     (gpointer) gtk_widget_get_last_child,
-                                                     (gpointer) g_object_ref,
-                                                     widget,
-                                                     gtk_widget_child_observer_destroyed);
+  rare_data->children_observer = gtk_list_list_model_new ((gpointer) gtk_widget_get_first_child,
+                                                          (gpointer) gtk_widget_get_next_sibling,
+                                                          (gpointer) gtk_widget_get_prev_sibling,
+                                                          (gpointer) gtk_widget_get_last_child,
+                                                          (gpointer) g_object_ref,
+                                                          widget,
+                                                          gtk_widget_child_observer_destroyed);
 
-  return G_LIST_MODEL (priv->children_observer);
+  return G_LIST_MODEL (rare_data->children_observer);
 }
 
 static void
@@ -11566,7 +12113,7 @@ gtk_widget_controller_observer_destroyed (gpointer widget)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
 
-  priv->controller_observer = NULL;
+  priv->rare_data->controller_observer = NULL;
 }
 
 static gpointer
@@ -11615,22 +12162,27 @@ gtk_widget_controller_list_get_item (gpointer item,
 GListModel *
 gtk_widget_observe_controllers (GtkWidget *widget)
 {
-  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidgetRareData *rare_data;
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  if (priv->controller_observer)
-    return g_object_ref (G_LIST_MODEL (priv->controller_observer));
+  /* Make the list complete before anyone looks at it */
+  gtk_widget_ensure_class_shortcuts (widget, GTK_WIDGET_GET_CLASS (widget));
+
+  rare_data = gtk_widget_ensure_rare_data (widget);
+
+  if (rare_data->controller_observer)
+    return g_object_ref (G_LIST_MODEL (rare_data->controller_observer));
 
-  priv->controller_observer = gtk_list_list_model_new (gtk_widget_controller_list_get_first,
-                                                       gtk_widget_controller_list_get_next,
-                                                       gtk_widget_controller_list_get_prev,
-                                                       NULL,
-                                                       gtk_widget_controller_list_get_item,
-                                                       widget,
-                                                       gtk_widget_controller_observer_destroyed);
+  rare_data->controller_observer = gtk_list_list_model_new (gtk_widget_controller_list_get_first,
+                                                            gtk_widget_controller_list_get_next,
+                                                            gtk_widget_controller_list_get_prev,
+                                                            NULL,
+                                                            gtk_widget_controller_list_get_item,
+                                                            widget,
+                                                            gtk_widget_controller_observer_destroyed);
 
-  return G_LIST_MODEL (priv->controller_observer);
+  return G_LIST_MODEL (rare_data->controller_observer);
 }
 
 /**
@@ -11948,7 +12500,10 @@ gtk_widget_set_cursor (GtkWidget *widget,
   g_return_if_fail (GTK_IS_WIDGET (widget));
   g_return_if_fail (cursor == NULL || GDK_IS_CURSOR (cursor));
 
-  if (!g_set_object (&priv->cursor, cursor))
+  if (cursor == NULL && priv->rare_data == NULL)
+    return;
+
+  if (!g_set_object (&gtk_widget_ensure_rare_data (widget)->cursor, cursor))
     return;
 
   root = _gtk_widget_get_root (widget);
@@ -12010,7 +12565,7 @@ gtk_widget_get_cursor (GtkWidget *widget)
 
   g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
 
-  return priv->cursor;
+  return priv->rare_data ? priv->rare_data->cursor : NULL;
 }
 
 /**
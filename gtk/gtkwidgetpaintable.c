@@ -197,8 +197,8 @@ gtk_widget_paintable_unset_widget (GtkWidgetPaintable *self)
   if (self->widget == NULL)
     return;
 
-  self->widget->priv->paintables = g_slist_remove (self->widget->priv->paintables,
-                                                   self);
+  self->widget->priv->rare_data->paintables = g_slist_remove (self->widget->priv->rare_data->paintables,
+                                                              self);
 
   self->widget = NULL;
 
@@ -339,7 +339,11 @@ gtk_widget_paintable_set_widget (GtkWidgetPaintable *self,
   self->widget = widget;
 
   if (widget)
-    widget->priv->paintables = g_slist_prepend (widget->priv->paintables, self);
+    {
+      GtkWidgetRareData *rare_data = gtk_widget_ensure_rare_data (widget);
+
+      rare_data->paintables = g_slist_prepend (rare_data->paintables, self);
+    }
 
   g_object_unref (self->current_image);
   self->current_image = gtk_widget_paintable_snapshot_widget (self);
@@ -32,6 +32,7 @@
 #include "gtkcsstypesprivate.h"
 #include "gtkeventcontrollerprivate.h"
 #include "gtklistlistmodelprivate.h"
+#include "gtkpickindexprivate.h"
 #include "gtkrootprivate.h"
 #include "gtksizerequestcacheprivate.h"
 #include "gtkwindowprivate.h"
@@ -58,6 +59,31 @@ typedef struct _GtkWidgetSurfaceTransformData
   GList *callbacks;
 } GtkWidgetSurfaceTransformData;
 
+typedef struct _GtkWidgetControllerTable GtkWidgetControllerTable;
+
+/* State that most widgets never use. It is kept out of
+ * GtkWidgetPrivate and only allocated when first needed.
+ */
+typedef struct _GtkWidgetRareData
+{
+  /* Pointer cursor */
+  GdkCursor *cursor;
+
+  /* Tooltip */
+  char *tooltip_markup;
+  char *tooltip_text;
+
+  /* GtkWidgetPaintables tracking this widget */
+  GSList *paintables;
+
+  GtkListListModel *children_observer;
+  GtkListListModel *controller_observer;
+
+  /* Transform to the topmost ancestor, see gtk_widget_compute_transform() */
+  graphene_matrix_t *top_transform;
+  guint top_transform_generation;
+} GtkWidgetRareData;
+
 struct _GtkWidgetPrivate
 {
   /* The state of the widget. Needs to be able to hold all GtkStateFlags bits
@@ -86,6 +112,7 @@ struct _GtkWidgetPrivate
   guint resize_needed         : 1; /* queue_resize() has been called but no get_preferred_size() yet */
   guint alloc_needed          : 1; /* this widget needs a size_allocate() call */
   guint alloc_needed_on_child : 1; /* 0 or more children - or this widget - need a size_allocate() call */
+  guint transform_needed      : 1; /* the CSS transform changed, the allocation inputs didn't */
 
   /* Queue-draw related flags */
   guint draw_needed           : 1;
@@ -102,6 +129,9 @@ struct _GtkWidgetPrivate
   /* SizeGroup related flags */
   guint have_size_groups      : 1;
 
+  /* The class shortcuts controller is only added once rooted */
+  guint class_shortcuts_added : 1;
+
   /* Alignment */
   guint   halign              : 4;
   guint   valign              : 4;
@@ -171,9 +201,9 @@ struct _GtkWidgetPrivate
   /* The layout manager, or %NULL */
   GtkLayoutManager *layout_manager;
 
-  GSList *paintables;
-
   GList *event_controllers;
+  /* only created on-demand */
+  GtkWidgetControllerTable *controller_table;
 
   /* Widget tree */
   GtkWidget *parent;
@@ -182,18 +212,13 @@ struct _GtkWidgetPrivate
   GtkWidget *first_child;
   GtkWidget *last_child;
 
-  /* only created on-demand */
-  GtkListListModel *children_observer;
-  GtkListListModel *controller_observer;
+  /* only created if the widget opts into it */
+  GtkPickIndex *pick_index;
 
   GtkWidget *focus_child;
 
-  /* Pointer cursor */
-  GdkCursor *cursor;
-
-  /* Tooltip */
-  char *tooltip_markup;
-  char *tooltip_text;
+  /* only created on-demand */
+  GtkWidgetRareData *rare_data;
 
   /* Accessibility */
   GtkAccessibleRole accessible_role;
@@ -221,6 +246,8 @@ struct _GtkWidgetClassPrivate
 void          gtk_widget_root               (GtkWidget *widget);
 void          gtk_widget_unroot             (GtkWidget *widget);
 GtkCssNode *  gtk_widget_get_css_node       (GtkWidget *widget);
+GtkWidgetRareData *
+              gtk_widget_ensure_rare_data   (GtkWidget *widget);
 void         _gtk_widget_set_visible_flag   (GtkWidget *widget,
                                              gboolean   visible);
 gboolean     _gtk_widget_get_alloc_needed   (GtkWidget *widget);
@@ -231,6 +258,13 @@ void          _gtk_widget_scale_changed     (GtkWidget *widget);
 
 GdkSurface * gtk_widget_get_surface         (GtkWidget *widget);
 
+void         gtk_widget_controllers_changed (GtkWidget       *widget);
+
+void         gtk_widget_set_use_pick_index  (GtkWidget       *widget,
+                                             gboolean         use_pick_index);
+gboolean     gtk_widget_get_child_pick_bounds (GtkWidget       *child,
+                                               graphene_rect_t *bounds);
+
 void         gtk_widget_render              (GtkWidget            *widget,
                                              GdkSurface           *surface,
                                              const cairo_region_t *region);
@@ -408,6 +442,12 @@ _gtk_widget_get_realized (GtkWidget *widget)
   return widget->priv->realized;
 }
 
+static inline gboolean
+_gtk_widget_get_resize_needed (GtkWidget *widget)
+{
+  return widget->priv->resize_needed;
+}
+
 static inline GtkStateFlags
 _gtk_widget_get_state_flags (GtkWidget *widget)
 {
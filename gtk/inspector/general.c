@@ -33,6 +33,8 @@
 #include "gtkbox.h"
 #include "gtkbinlayout.h"
 #include "gtkmediafileprivate.h"
+#include "gtkcssstaticstyleprivate.h"
+#include "gtkshapingcacheprivate.h"
 
 
 #ifdef GDK_WINDOWING_X11
@@ -74,6 +76,7 @@ struct _GtkInspectorGeneral
   GtkWidget *gl_box;
   GtkWidget *vulkan_box;
   GtkWidget *device_box;
+  GtkWidget *css_box;
   GtkWidget *gtk_version;
   GtkWidget *gdk_backend;
   GtkWidget *gsk_renderer;
@@ -859,6 +862,52 @@ init_device (GtkInspectorGeneral *gen)
   populate_seats (gen);
 }
 
+static void
+populate_css (GtkInspectorGeneral *gen)
+{
+  GtkWidget *child;
+  guint n_shared, n_hits, n_lookups;
+  guint64 n_shaping_hits, n_shaping_misses;
+  gsize shaping_bytes;
+  char *value;
+
+  while ((child = gtk_widget_get_first_child (gen->css_box)))
+    gtk_list_box_remove (GTK_LIST_BOX (gen->css_box), child);
+
+  gtk_css_static_style_get_sharing_stats (&n_shared, &n_hits, &n_lookups);
+
+  value = g_strdup_printf ("%u", n_shared);
+  add_label_row (gen, GTK_LIST_BOX (gen->css_box), "Shared styles", value, 0);
+  g_free (value);
+
+  value = g_strdup_printf ("%u of %u (%u%%)",
+                           n_hits, n_lookups,
+                           n_lookups ? (guint) (100 * (guint64) n_hits / n_lookups) : 0);
+  add_label_row (gen, GTK_LIST_BOX (gen->css_box), "Style sharing hits", value, 0);
+  g_free (value);
+
+  gtk_shaping_cache_get_stats (&n_shaping_hits, &n_shaping_misses, &shaping_bytes);
+
+  value = g_strdup_printf ("%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " (%u%%)",
+                           n_shaping_hits, n_shaping_hits + n_shaping_misses,
+                           n_shaping_hits + n_shaping_misses ? (guint) (100 * n_shaping_hits / (n_shaping_hits + n_shaping_misses)) : 0);
+  add_label_row (gen, GTK_LIST_BOX (gen->css_box), "Text shaping cache hits", value, 0);
+  g_free (value);
+
+  value = g_format_size (shaping_bytes);
+  add_label_row (gen, GTK_LIST_BOX (gen->css_box), "Text shaping cache size", value, 0);
+  g_free (value);
+}
+
+static void
+init_css (GtkInspectorGeneral *gen)
+{
+  /* The numbers change all the time, so update them when shown */
+  g_signal_connect_swapped (gen, "map", G_CALLBACK (populate_css), gen);
+
+  populate_css (gen);
+}
+
 static void
 gtk_inspector_general_init (GtkInspectorGeneral *gen)
 {
@@ -882,6 +931,10 @@ keynav_failed (GtkWidget *widget, GtkDirectionType direction, GtkInspectorGenera
     next = gen->vulkan_box;
   else if (direction == GTK_DIR_DOWN && widget == gen->vulkan_box)
     next = gen->device_box;
+  else if (direction == GTK_DIR_DOWN && widget == gen->device_box)
+    next = gen->css_box;
+  else if (direction == GTK_DIR_UP && widget == gen->css_box)
+    next = gen->device_box;
   else if (direction == GTK_DIR_UP && widget == gen->device_box)
     next = gen->vulkan_box;
   else if (direction == GTK_DIR_UP && widget == gen->vulkan_box)
@@ -920,6 +973,7 @@ gtk_inspector_general_constructed (GObject *object)
    g_signal_connect (gen->gl_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->vulkan_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->device_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
+   g_signal_connect (gen->css_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
 }
 
 static void
@@ -959,6 +1013,7 @@ gtk_inspector_general_class_init (GtkInspectorGeneralClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, monitor_box);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, gl_box);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, vulkan_box);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, css_box);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, gtk_version);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, gdk_backend);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorGeneral, gsk_renderer);
@@ -999,6 +1054,7 @@ gtk_inspector_general_set_display (GtkInspectorGeneral *gen,
   init_gl (gen);
   init_vulkan (gen);
   init_device (gen);
+  init_css (gen);
 }
 
 // vim: set et sw=2 ts=2:
@@ -31,6 +31,12 @@
 #include "gtkmenubutton.h"
 #include "gtkwidgetprivate.h"
 #include "gtkbinlayout.h"
+#include "gtktextviewprivate.h"
+#include "gtktextlinedisplaycacheprivate.h"
+#include "gtklistitemfactoryprivate.h"
+#include "gtkswitch.h"
+
+#include "gdk/gdk-private.h"
 
 
 struct _GtkInspectorMiscInfo
@@ -72,6 +78,13 @@ struct _GtkInspectorMiscInfo
   GtkWidget *framerate;
   GtkWidget *framecount_row;
   GtkWidget *framecount;
+  GtkWidget *late_latching_row;
+  GtkWidget *late_latching;
+  GtkWidget *paint_cost;
+  GtkWidget *text_cache_row;
+  GtkWidget *text_cache;
+  GtkWidget *list_item_factory_row;
+  GtkWidget *list_item_factory;
   GtkWidget *mapped_row;
   GtkWidget *mapped;
   GtkWidget *realized_row;
@@ -224,6 +237,18 @@ show_frame_clock (GtkWidget *button, GtkInspectorMiscInfo *sl)
     gtk_inspector_window_push_object (iw, clock, CHILD_KIND_OTHER, 0);
 }
 
+static void
+toggle_late_latching (GtkSwitch            *sw,
+                      GParamSpec           *pspec,
+                      GtkInspectorMiscInfo *sl)
+{
+  if (!GDK_IS_FRAME_CLOCK (sl->object))
+    return;
+
+  gdk_frame_clock_set_late_latching (GDK_FRAME_CLOCK (sl->object),
+                                     gtk_switch_get_active (sw));
+}
+
 static void
 update_surface (GtkInspectorMiscInfo *sl)
 {
@@ -356,6 +381,42 @@ update_info (gpointer data)
                           gtk_buildable_get_buildable_id (GTK_BUILDABLE (sl->object)));
     }
 
+  if (GTK_IS_TEXT_VIEW (sl->object))
+    {
+      GtkTextLayout *layout = gtk_text_view_get_layout (GTK_TEXT_VIEW (sl->object));
+
+      if (layout != NULL)
+        {
+          GtkTextLineDisplayCacheStats stats;
+
+          gtk_text_layout_get_cache_stats (layout, &stats);
+          tmp = g_strdup_printf ("%u ⁄ %u lines, %" G_GSIZE_FORMAT " ⁄ %" G_GSIZE_FORMAT " kB\n"
+                                 "%u hits, %u misses, %u prefetched, %u evicted",
+                                 stats.n_displays, stats.mru_size,
+                                 stats.n_bytes / 1024, stats.max_bytes / 1024,
+                                 stats.hits, stats.misses,
+                                 stats.prefetched, stats.evicted);
+          gtk_label_set_label (GTK_LABEL (sl->text_cache), tmp);
+          g_free (tmp);
+        }
+      else
+        {
+          gtk_label_set_label (GTK_LABEL (sl->text_cache), "—");
+        }
+    }
+
+  if (GTK_IS_LIST_ITEM_FACTORY (sl->object))
+    {
+      guint n_setups, n_teardowns, n_recycled;
+
+      gtk_list_item_factory_get_stats (GTK_LIST_ITEM_FACTORY (sl->object),
+                                       &n_setups, &n_teardowns, &n_recycled);
+      tmp = g_strdup_printf ("%u set up, %u torn down, %u recycled",
+                             n_setups, n_teardowns, n_recycled);
+      gtk_label_set_label (GTK_LABEL (sl->list_item_factory), tmp);
+      g_free (tmp);
+    }
+
   if (GDK_IS_FRAME_CLOCK (sl->object))
     {
       GdkFrameClock *clock;
@@ -391,6 +452,10 @@ update_info (gpointer data)
         }
 
       sl->last_frame = frame;
+
+      tmp = g_strdup_printf ("%.1f ms", gdk_frame_clock_get_predicted_paint_cost (clock) / 1000.);
+      gtk_label_set_label (GTK_LABEL (sl->paint_cost), tmp);
+      g_free (tmp);
     }
 
   return G_SOURCE_CONTINUE;
@@ -458,15 +523,29 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
       gtk_widget_hide (sl->buildable_id_row);
     }
 
+  if (GTK_IS_TEXT_VIEW (object))
+    gtk_widget_show (sl->text_cache_row);
+  else
+    gtk_widget_hide (sl->text_cache_row);
+
+  if (GTK_IS_LIST_ITEM_FACTORY (object))
+    gtk_widget_show (sl->list_item_factory_row);
+  else
+    gtk_widget_hide (sl->list_item_factory_row);
+
   if (GDK_IS_FRAME_CLOCK (object))
     {
       gtk_widget_show (sl->framecount_row);
       gtk_widget_show (sl->framerate_row);
+      gtk_widget_show (sl->late_latching_row);
+      gtk_switch_set_active (GTK_SWITCH (sl->late_latching),
+                             gdk_frame_clock_get_late_latching (GDK_FRAME_CLOCK (object)));
     }
   else
     {
       gtk_widget_hide (sl->framecount_row);
       gtk_widget_hide (sl->framerate_row);
+      gtk_widget_hide (sl->late_latching_row);
     }
 
   update_info (sl);
@@ -559,6 +638,13 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framecount);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, framerate);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, late_latching_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, late_latching);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, paint_cost);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, text_cache_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, text_cache);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, list_item_factory_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, list_item_factory);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mapped);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, realized_row);
@@ -571,6 +657,7 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, show_surface);
   gtk_widget_class_bind_template_callback (widget_class, show_renderer);
   gtk_widget_class_bind_template_callback (widget_class, show_frame_clock);
+  gtk_widget_class_bind_template_callback (widget_class, toggle_late_latching);
 
   gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
 }
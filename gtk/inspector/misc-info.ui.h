@@ -12,6 +12,7 @@ N_("Clip area");
 N_("Tick callback");
 N_("Frame count");
 N_("Frame rate");
+N_("Text Line Cache");
 N_("Accessible role");
 N_("Accessible name");
 N_("Accessible description");
@@ -92,6 +92,10 @@ static GParamSpec *props[LAST_PROP] = { NULL, };
 
 G_DEFINE_TYPE (GtkInspectorRecorder, gtk_inspector_recorder, GTK_TYPE_WIDGET)
 
+/* The oldest recordings get dropped when there are more than this,
+ * so that leaving the recorder running does not use up all memory */
+#define MAX_RECORDINGS 500
+
 static GListModel *
 create_render_node_list_model (GskRenderNode **nodes,
                                guint           n_nodes)
@@ -1512,6 +1516,9 @@ gtk_inspector_recorder_add_recording (GtkInspectorRecorder  *recorder,
                                       GtkInspectorRecording *recording)
 {
   g_list_store_append (G_LIST_STORE (recorder->recordings), recording);
+
+  if (g_list_model_get_n_items (recorder->recordings) > MAX_RECORDINGS)
+    g_list_store_remove (G_LIST_STORE (recorder->recordings), 0);
 }
 
 void
@@ -149,14 +149,19 @@ update_type_counts (gpointer data)
   return TRUE;
 }
 
+/* Only count while the page is shown, walking all types is expensive */
 static void
-toggle_record (GtkToggleButton        *button,
-               GtkInspectorStatistics *sl)
+update_recording (GtkInspectorStatistics *sl)
 {
-  if (gtk_toggle_button_get_active (button) == (sl->priv->update_source_id != 0))
+  gboolean record;
+
+  record = gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (sl->priv->button)) &&
+           gtk_widget_get_mapped (GTK_WIDGET (sl));
+
+  if (record == (sl->priv->update_source_id != 0))
     return;
 
-  if (gtk_toggle_button_get_active (button))
+  if (record)
     {
       sl->priv->update_source_id = g_timeout_add_seconds (1, update_type_counts, sl);
       update_type_counts (sl);
@@ -168,6 +173,13 @@ toggle_record (GtkToggleButton        *button,
     }
 }
 
+static void
+toggle_record (GtkToggleButton        *button,
+               GtkInspectorStatistics *sl)
+{
+  update_recording (sl);
+}
+
 static gboolean
 has_instance_counts (void)
 {
@@ -357,6 +369,29 @@ unroot (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_inspector_statistics_parent_class)->unroot (widget);
 }
 
+static void
+map (GtkWidget *widget)
+{
+  GtkInspectorStatistics *sl = GTK_INSPECTOR_STATISTICS (widget);
+
+  GTK_WIDGET_CLASS (gtk_inspector_statistics_parent_class)->map (widget);
+
+  if (g_hash_table_size (sl->priv->counts) == 0 && has_instance_counts ())
+    update_type_counts (sl);
+
+  update_recording (sl);
+}
+
+static void
+unmap (GtkWidget *widget)
+{
+  GtkInspectorStatistics *sl = GTK_INSPECTOR_STATISTICS (widget);
+
+  GTK_WIDGET_CLASS (gtk_inspector_statistics_parent_class)->unmap (widget);
+
+  update_recording (sl);
+}
+
 static void
 gtk_inspector_statistics_init (GtkInspectorStatistics *sl)
 {
@@ -392,9 +427,7 @@ constructed (GObject *object)
   g_signal_connect (sl->priv->button, "toggled",
                     G_CALLBACK (toggle_record), sl);
 
-  if (has_instance_counts ())
-    update_type_counts (sl);
-  else
+  if (!has_instance_counts ())
     {
       if (instance_counts_enabled ())
         gtk_label_set_text (GTK_LABEL (sl->priv->excuse), _("GLib must be configured with -Dbuildtype=debug"));
@@ -469,6 +502,8 @@ gtk_inspector_statistics_class_init (GtkInspectorStatisticsClass *klass)
 
   widget_class->root = root;
   widget_class->unroot = unroot;
+  widget_class->map = map;
+  widget_class->unmap = unmap;
 
   g_object_class_install_property (object_class, PROP_BUTTON,
       g_param_spec_object ("button", NULL, NULL,
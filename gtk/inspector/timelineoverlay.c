@@ -0,0 +1,247 @@
+/* timelineoverlay.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "timelineoverlay.h"
+
+#include "gtkintl.h"
+#include "gtkwidget.h"
+#include "gtkwindow.h"
+#include "gtknative.h"
+
+#include "gdk/gdkframeclockprivate.h"
+
+/* The timeline shows one stacked bar per frame, with the time
+ * spent in each phase of the frame.
+ */
+#define N_FRAMES 60
+#define BAR_WIDTH 3
+#define PIXELS_PER_MS 2
+#define TIMELINE_HEIGHT (40 * PIXELS_PER_MS)
+
+enum {
+  PHASE_UPDATE,
+  PHASE_LAYOUT,
+  PHASE_SNAPSHOT,
+  PHASE_RENDER,
+  N_PHASES
+};
+
+static const GdkRGBA phase_colors[N_PHASES] = {
+  { 0.2, 0.4, 1.0, 1.0 }, /* update */
+  { 0.2, 0.8, 0.2, 1.0 }, /* layout */
+  { 1.0, 0.6, 0.0, 1.0 }, /* snapshot */
+  { 0.9, 0.1, 0.1, 1.0 }, /* render */
+};
+
+typedef struct {
+  gint64 durations[N_PHASES];
+} GtkFrameSample;
+
+typedef struct _GtkTimelineInfo {
+  gint64 last_frame_counter;
+  gint64 refresh_interval;
+  GtkFrameSample samples[N_FRAMES];
+  guint first;
+  guint n_samples;
+} GtkTimelineInfo;
+
+struct _GtkTimelineOverlay
+{
+  GtkInspectorOverlay parent_instance;
+
+  GHashTable *infos; /* GtkWidget => GtkTimelineInfo */
+};
+
+struct _GtkTimelineOverlayClass
+{
+  GtkInspectorOverlayClass parent_class;
+};
+
+G_DEFINE_TYPE (GtkTimelineOverlay, gtk_timeline_overlay, GTK_TYPE_INSPECTOR_OVERLAY)
+
+static void
+gtk_timeline_info_free (gpointer data)
+{
+  g_slice_free (GtkTimelineInfo, data);
+}
+
+static void
+gtk_timeline_info_add_frame (GtkTimelineInfo *info,
+                             GdkFrameTimings *timings)
+{
+  GtkFrameSample *sample;
+
+  if (info->n_samples < N_FRAMES)
+    {
+      sample = &info->samples[(info->first + info->n_samples) % N_FRAMES];
+      info->n_samples++;
+    }
+  else
+    {
+      sample = &info->samples[info->first];
+      info->first = (info->first + 1) % N_FRAMES;
+    }
+
+  sample->durations[PHASE_UPDATE] = timings->update_duration;
+  sample->durations[PHASE_LAYOUT] = timings->layout_duration;
+  sample->durations[PHASE_SNAPSHOT] = MAX (0, timings->paint_duration - timings->render_duration);
+  sample->durations[PHASE_RENDER] = timings->render_duration;
+
+  if (timings->refresh_interval != 0)
+    info->refresh_interval = timings->refresh_interval;
+}
+
+static gboolean
+gtk_timeline_overlay_force_redraw (GtkWidget     *widget,
+                                   GdkFrameClock *clock,
+                                   gpointer       unused)
+{
+  gdk_surface_queue_render (gtk_native_get_surface (gtk_widget_get_native (widget)));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_timeline_overlay_snapshot (GtkInspectorOverlay *overlay,
+                               GtkSnapshot         *snapshot,
+                               GskRenderNode       *node,
+                               GtkWidget           *widget)
+{
+  GtkTimelineOverlay *self = GTK_TIMELINE_OVERLAY (overlay);
+  GtkTimelineInfo *info;
+  GdkFrameClock *frame_clock;
+  GdkFrameTimings *timings;
+  graphene_rect_t bounds;
+  gint64 frame_counter;
+  float target;
+  guint i, j;
+
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  if (frame_clock == NULL)
+    return;
+
+  if (!gtk_widget_compute_bounds (widget, widget, &bounds))
+    return;
+
+  info = g_hash_table_lookup (self->infos, widget);
+  if (info == NULL)
+    {
+      info = g_slice_new0 (GtkTimelineInfo);
+      g_hash_table_insert (self->infos, widget, info);
+    }
+
+  /* We are drawing the current frame, so the previous one is
+   * the newest frame with complete phase durations */
+  frame_counter = gdk_frame_clock_get_frame_counter (frame_clock) - 1;
+  if (frame_counter > info->last_frame_counter)
+    {
+      timings = gdk_frame_clock_get_timings (frame_clock, frame_counter);
+      if (timings)
+        gtk_timeline_info_add_frame (info, timings);
+      info->last_frame_counter = frame_counter;
+    }
+
+  gtk_snapshot_save (snapshot);
+  gtk_snapshot_translate (snapshot,
+                          &GRAPHENE_POINT_INIT (bounds.origin.x,
+                                                bounds.origin.y + bounds.size.height - TIMELINE_HEIGHT));
+
+  gtk_snapshot_append_color (snapshot,
+                             &(GdkRGBA) { 0, 0, 0, 0.5 },
+                             &GRAPHENE_RECT_INIT (0, 0, N_FRAMES * BAR_WIDTH, TIMELINE_HEIGHT));
+
+  for (i = 0; i < info->n_samples; i++)
+    {
+      const GtkFrameSample *sample = &info->samples[(info->first + i) % N_FRAMES];
+      float y = TIMELINE_HEIGHT;
+
+      for (j = 0; j < N_PHASES && y > 0; j++)
+        {
+          float height = MIN (y, sample->durations[j] * PIXELS_PER_MS / 1000.f);
+
+          if (height <= 0)
+            continue;
+
+          y -= height;
+          gtk_snapshot_append_color (snapshot,
+                                     &phase_colors[j],
+                                     &GRAPHENE_RECT_INIT (i * BAR_WIDTH, y, BAR_WIDTH - 1, height));
+        }
+    }
+
+  /* Frames that reach this line miss the refresh */
+  target = (info->refresh_interval ? info->refresh_interval : 16667) * PIXELS_PER_MS / 1000.f;
+  if (target < TIMELINE_HEIGHT)
+    gtk_snapshot_append_color (snapshot,
+                               &(GdkRGBA) { 1, 1, 1, 0.8 },
+                               &GRAPHENE_RECT_INIT (0, TIMELINE_HEIGHT - target, N_FRAMES * BAR_WIDTH, 1));
+
+  gtk_snapshot_restore (snapshot);
+
+  gtk_widget_add_tick_callback (widget, gtk_timeline_overlay_force_redraw, NULL, NULL);
+}
+
+static void
+gtk_timeline_overlay_queue_draw (GtkInspectorOverlay *overlay)
+{
+  GtkTimelineOverlay *self = GTK_TIMELINE_OVERLAY (overlay);
+  GHashTableIter iter;
+  gpointer widget;
+
+  g_hash_table_iter_init (&iter, self->infos);
+  while (g_hash_table_iter_next (&iter, &widget, NULL))
+    gdk_surface_queue_render (gtk_native_get_surface (gtk_widget_get_native (widget)));
+}
+
+static void
+gtk_timeline_overlay_dispose (GObject *object)
+{
+  GtkTimelineOverlay *self = GTK_TIMELINE_OVERLAY (object);
+
+  g_hash_table_unref (self->infos);
+
+  G_OBJECT_CLASS (gtk_timeline_overlay_parent_class)->dispose (object);
+}
+
+static void
+gtk_timeline_overlay_class_init (GtkTimelineOverlayClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GtkInspectorOverlayClass *overlay_class = GTK_INSPECTOR_OVERLAY_CLASS (klass);
+
+  overlay_class->snapshot = gtk_timeline_overlay_snapshot;
+  overlay_class->queue_draw = gtk_timeline_overlay_queue_draw;
+
+  gobject_class->dispose = gtk_timeline_overlay_dispose;
+}
+
+static void
+gtk_timeline_overlay_init (GtkTimelineOverlay *self)
+{
+  self->infos = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, gtk_timeline_info_free);
+}
+
+GtkInspectorOverlay *
+gtk_timeline_overlay_new (void)
+{
+  GtkTimelineOverlay *self;
+
+  self = g_object_new (GTK_TYPE_TIMELINE_OVERLAY, NULL);
+
+  return GTK_INSPECTOR_OVERLAY (self);
+}
@@ -21,6 +21,7 @@
 #include "visual.h"
 
 #include "fpsoverlay.h"
+#include "timelineoverlay.h"
 #include "updatesoverlay.h"
 #include "layoutoverlay.h"
 #include "focusoverlay.h"
@@ -85,6 +86,7 @@ struct _GtkInspectorVisual
 
   GtkWidget *debug_box;
   GtkWidget *fps_switch;
+  GtkWidget *timeline_switch;
   GtkWidget *updates_switch;
   GtkWidget *fallback_switch;
   GtkWidget *baselines_switch;
@@ -96,6 +98,7 @@ struct _GtkInspectorVisual
   GtkWidget *software_gl_switch;
 
   GtkInspectorOverlay *fps_overlay;
+  GtkInspectorOverlay *timeline_overlay;
   GtkInspectorOverlay *updates_overlay;
   GtkInspectorOverlay *layout_overlay;
   GtkInspectorOverlay *focus_overlay;
@@ -279,6 +282,40 @@ fps_activate (GtkSwitch          *sw,
   redraw_everything ();
 }
 
+static void
+timeline_activate (GtkSwitch          *sw,
+                   GParamSpec         *pspec,
+                   GtkInspectorVisual *vis)
+{
+  GtkInspectorWindow *iw;
+  gboolean timeline;
+
+  timeline = gtk_switch_get_active (sw);
+  iw = GTK_INSPECTOR_WINDOW (gtk_widget_get_root (GTK_WIDGET (vis)));
+  if (iw == NULL)
+    return;
+
+  if (timeline)
+    {
+      if (vis->timeline_overlay == NULL)
+        {
+          vis->timeline_overlay = gtk_timeline_overlay_new ();
+          gtk_inspector_window_add_overlay (iw, vis->timeline_overlay);
+          g_object_unref (vis->timeline_overlay);
+        }
+    }
+  else
+    {
+      if (vis->timeline_overlay != NULL)
+        {
+          gtk_inspector_window_remove_overlay (iw, vis->timeline_overlay);
+          vis->timeline_overlay = NULL;
+        }
+    }
+
+  redraw_everything ();
+}
+
 static void
 updates_activate (GtkSwitch          *sw,
                   GParamSpec         *pspec,
@@ -968,6 +1005,11 @@ row_activated (GtkListBox         *box,
       GtkSwitch *sw = GTK_SWITCH (vis->fps_switch);
       gtk_switch_set_active (sw, !gtk_switch_get_active (sw));
     }
+  else if (gtk_widget_is_ancestor (vis->timeline_switch, GTK_WIDGET (row)))
+    {
+      GtkSwitch *sw = GTK_SWITCH (vis->timeline_switch);
+      gtk_switch_set_active (sw, !gtk_switch_get_active (sw));
+    }
   else if (gtk_widget_is_ancestor (vis->updates_switch, GTK_WIDGET (row)))
     {
       GtkSwitch *sw = GTK_SWITCH (vis->updates_switch);
@@ -1087,6 +1129,11 @@ gtk_inspector_visual_unroot (GtkWidget *widget)
       gtk_inspector_window_remove_overlay (iw, vis->fps_overlay);
       vis->fps_overlay = NULL;
     }
+  if (vis->timeline_overlay)
+    {
+      gtk_inspector_window_remove_overlay (iw, vis->timeline_overlay);
+      vis->timeline_overlay = NULL;
+    }
   if (vis->focus_overlay)
     {
       gtk_inspector_window_remove_overlay (iw, vis->focus_overlay);
@@ -1141,6 +1188,7 @@ gtk_inspector_visual_class_init (GtkInspectorVisualClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, font_scale_entry);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, font_scale_adjustment);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, fps_switch);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, timeline_switch);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, updates_switch);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, fallback_switch);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, baselines_switch);
@@ -1148,6 +1196,7 @@ gtk_inspector_visual_class_init (GtkInspectorVisualClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorVisual, focus_switch);
 
   gtk_widget_class_bind_template_callback (widget_class, fps_activate);
+  gtk_widget_class_bind_template_callback (widget_class, timeline_activate);
   gtk_widget_class_bind_template_callback (widget_class, updates_activate);
   gtk_widget_class_bind_template_callback (widget_class, fallback_activate);
   gtk_widget_class_bind_template_callback (widget_class, direction_changed);
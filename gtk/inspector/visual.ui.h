@@ -13,6 +13,7 @@ N_("Rendering Mode");
 N_("Similar");
 N_("Image");
 N_("Recording");
+N_("Show Frame Timeline");
 N_("Show Graphic Updates");
 N_("Show Baselines");
 N_("Show Pixel Cache");
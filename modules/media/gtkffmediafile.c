@@ -31,6 +31,21 @@
 #include <libswscale/swscale.h>
 
 typedef struct _GtkVideoFrameFFMpeg GtkVideoFrameFFMpeg;
+typedef struct _FramePool FramePool;
+typedef struct _PooledBuffer PooledBuffer;
+
+/* Frames are decoded in a thread, which keeps up to this many of
+ * them queued up for the main thread */
+#define MAX_QUEUED_FRAMES 4
+
+/* Decoded frames that were released are kept for reuse, up to this many */
+#define MAX_POOLED_BUFFERS 4
+
+typedef enum {
+  FRAME_READY,
+  FRAME_PENDING,
+  FRAME_END
+} FrameStatus;
 
 struct _GtkVideoFrameFFMpeg
 {
@@ -57,6 +72,28 @@ struct _GtkFfMediaFile
 
   gint64 start_time; /* monotonic time when we displayed the last frame */
   guint next_frame_cb; /* Source ID of next frame callback */
+
+  /* Once realized, frames are shown on the frame clock of the surface */
+  GdkFrameClock *frame_clock;
+  guint frame_clock_updating : 1;
+  guint frame_queued : 1; /* next_frame is shown once it is due */
+
+  /* First error of the read callback, which can't report it directly
+   * when it runs in the decoding thread */
+  GError *read_error;
+
+  FramePool *frame_pool;
+
+  GThread *decode_thread;
+  /* protects the fields below */
+  GMutex decode_lock;
+  GCond decode_cond;
+  GQueue decoded_frames; /* GtkVideoFrameFFMpeg, oldest first */
+  GError *decode_error;
+  guint decode_stop : 1;
+  guint decode_done : 1; /* no more frames will be queued */
+  guint waiting_for_frame : 1;
+  guint frame_ready_cb; /* Source ID of the callback for a late frame */
 };
 
 struct _GtkFfMediaFileClass
@@ -95,6 +132,132 @@ gtk_video_frame_ffmpeg_move (GtkVideoFrameFFMpeg *dest,
   src->timestamp = 0;
 }
 
+/* The buffers that frames are converted into are big, so instead of
+ * allocating one for every frame, they are returned here once the
+ * texture using them is gone. The pool is shared with the textures,
+ * which can outlive the media file.
+ */
+struct _FramePool
+{
+  gatomicrefcount ref_count;
+  GMutex lock;
+  gsize size;
+  GSList *buffers;
+  guint n_buffers;
+};
+
+struct _PooledBuffer
+{
+  FramePool *pool;
+  gsize size;
+  guchar *data;
+};
+
+static void
+pooled_buffer_free (PooledBuffer *buffer)
+{
+  g_free (buffer->data);
+  g_slice_free (PooledBuffer, buffer);
+}
+
+static FramePool *
+frame_pool_new (void)
+{
+  FramePool *pool;
+
+  pool = g_slice_new0 (FramePool);
+  g_atomic_ref_count_init (&pool->ref_count);
+  g_mutex_init (&pool->lock);
+
+  return pool;
+}
+
+static FramePool *
+frame_pool_ref (FramePool *pool)
+{
+  g_atomic_ref_count_inc (&pool->ref_count);
+
+  return pool;
+}
+
+static void
+frame_pool_unref (FramePool *pool)
+{
+  if (!g_atomic_ref_count_dec (&pool->ref_count))
+    return;
+
+  g_slist_free_full (pool->buffers, (GDestroyNotify) pooled_buffer_free);
+  g_mutex_clear (&pool->lock);
+  g_slice_free (FramePool, pool);
+}
+
+static PooledBuffer *
+frame_pool_acquire (FramePool *pool,
+                    gsize      size)
+{
+  PooledBuffer *buffer = NULL;
+
+  g_mutex_lock (&pool->lock);
+
+  if (pool->size != size)
+    {
+      g_slist_free_full (pool->buffers, (GDestroyNotify) pooled_buffer_free);
+      pool->buffers = NULL;
+      pool->n_buffers = 0;
+      pool->size = size;
+    }
+
+  if (pool->buffers)
+    {
+      buffer = pool->buffers->data;
+      pool->buffers = g_slist_delete_link (pool->buffers, pool->buffers);
+      pool->n_buffers--;
+    }
+
+  g_mutex_unlock (&pool->lock);
+
+  if (buffer == NULL)
+    {
+      guchar *data = g_try_malloc (size);
+
+      if (data == NULL)
+        return NULL;
+
+      buffer = g_slice_new (PooledBuffer);
+      buffer->size = size;
+      buffer->data = data;
+    }
+
+  buffer->pool = frame_pool_ref (pool);
+
+  return buffer;
+}
+
+static void
+frame_pool_release (gpointer data)
+{
+  PooledBuffer *buffer = data;
+  FramePool *pool = buffer->pool;
+
+  buffer->pool = NULL;
+
+  g_mutex_lock (&pool->lock);
+
+  if (buffer->size == pool->size && pool->n_buffers < MAX_POOLED_BUFFERS)
+    {
+      pool->buffers = g_slist_prepend (pool->buffers, buffer);
+      pool->n_buffers++;
+      buffer = NULL;
+    }
+
+  g_mutex_unlock (&pool->lock);
+
+  if (buffer)
+    pooled_buffer_free (buffer);
+
+  frame_pool_unref (pool);
+}
+
 static void
 gtk_ff_media_file_paintable_snapshot (GdkPaintable *paintable,
                                       GdkSnapshot  *snapshot,
@@ -207,23 +370,37 @@ g_io_module_query (void)
   return g_strdupv (eps);
 }
 
-static void
-gtk_ff_media_file_set_ffmpeg_error (GtkFfMediaFile *video,
-                                    int           av_errnum)
+static GError *
+gtk_ff_media_file_ffmpeg_error (GtkFfMediaFile *video,
+                                int             av_errnum)
 {
   char s[AV_ERROR_MAX_STRING_SIZE];
 
-  if (gtk_media_stream_get_error (GTK_MEDIA_STREAM (video)))
-    return;
+  /* A failed read is the more useful error */
+  if (video->read_error)
+    return g_steal_pointer (&video->read_error);
 
   if (av_strerror (av_errnum, s, sizeof (s) != 0))
     g_snprintf (s, sizeof (s), _("Unspecified error decoding video"));
 
-  gtk_media_stream_error (GTK_MEDIA_STREAM (video),
-                          G_IO_ERROR,
-                          G_IO_ERROR_FAILED,
-                          "%s",
-                          s);
+  return g_error_new_literal (G_IO_ERROR, G_IO_ERROR_FAILED, s);
+}
+
+static void
+gtk_ff_media_file_set_ffmpeg_error (GtkFfMediaFile *video,
+                                    int           av_errnum)
+{
+  GError *error;
+
+  error = gtk_ff_media_file_ffmpeg_error (video, av_errnum);
+
+  if (gtk_media_stream_get_error (GTK_MEDIA_STREAM (video)))
+    {
+      g_error_free (error);
+      return;
+    }
+
+  gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
 }
 
 static int
@@ -242,7 +419,12 @@ gtk_ff_media_file_read_packet_cb (void    *data,
                                 &error);
   if (n_read < 0)
     {
-      gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+      /* This may run in the decoding thread, so the error is reported
+       * by whoever gets the failure from ffmpeg */
+      if (video->read_error == NULL)
+        video->read_error = error;
+      else
+        g_error_free (error);
     }
   else if (n_read == 0)
     {
@@ -267,59 +449,66 @@ memory_format_from_pix_fmt (enum AVPixelFormat pix_fmt)
     }
 }
 
+/* Decodes the next frame. This is called from the decoding thread
+ * while it runs, and from the main thread otherwise.
+ *
+ * Returns %FALSE at the end of the stream, with @error set if it
+ * was because of an error.
+ */
 static gboolean
-gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
-                                GtkVideoFrameFFMpeg *result)
+gtk_ff_media_file_decode_frame (GtkFfMediaFile       *video,
+                                GtkVideoFrameFFMpeg  *result,
+                                GError              **error)
 {
   GdkTexture *texture;
   AVPacket packet;
   AVFrame *frame;
   int errnum;
   GBytes *bytes;
-  guchar *data;
+  PooledBuffer *buffer;
+  gsize size;
 
   frame = av_frame_alloc ();
 
-  for (errnum = av_read_frame (video->format_ctx, &packet);
-       errnum >= 0;
-       errnum = av_read_frame (video->format_ctx, &packet))
+  /* With frame threading, the decoder takes a few packets before
+   * the first frame comes out, and keeps a few frames at the end */
+  for (errnum = avcodec_receive_frame (video->codec_ctx, frame);
+       errnum == AVERROR (EAGAIN);
+       errnum = avcodec_receive_frame (video->codec_ctx, frame))
     {
-      if (packet.stream_index == video->stream_id)
+      errnum = av_read_frame (video->format_ctx, &packet);
+      if (errnum == AVERROR_EOF)
+        {
+          /* Flush the frames still in the decoder */
+          errnum = avcodec_send_packet (video->codec_ctx, NULL);
+        }
+      else if (errnum >= 0)
         {
-          errnum = avcodec_send_packet (video->codec_ctx, &packet);
-              if (errnum < 0)
-                G_BREAKPOINT();
-          if (errnum >= 0)
-            {
-              errnum = avcodec_receive_frame (video->codec_ctx, frame);
-              if (errnum < 0)
-                G_BREAKPOINT();
-              if (errnum >= 0)
-                {
-                  av_packet_unref (&packet);
-                  break;
-                }
-            }
+          if (packet.stream_index == video->stream_id)
+            errnum = avcodec_send_packet (video->codec_ctx, &packet);
+          av_packet_unref (&packet);
         }
 
-      av_packet_unref (&packet);
+      if (errnum < 0)
+        break;
     }
 
   if (errnum < 0)
     {
       if (errnum != AVERROR_EOF)
-        gtk_ff_media_file_set_ffmpeg_error (video, errnum);
+        g_propagate_error (error, gtk_ff_media_file_ffmpeg_error (video, errnum));
       av_frame_free (&frame);
       return FALSE;
     }
 
-  data = g_try_malloc0 (video->codec_ctx->width * video->codec_ctx->height * 4);
-  if (data == NULL)
+  size = video->codec_ctx->width * video->codec_ctx->height * 4;
+  buffer = frame_pool_acquire (video->frame_pool, size);
+  if (buffer == NULL)
     {
-      gtk_media_stream_error (GTK_MEDIA_STREAM (video),
-                              G_IO_ERROR,
-                              G_IO_ERROR_FAILED,
-                              _("Not enough memory"));
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_FAILED,
+                           _("Not enough memory"));
       av_frame_free (&frame);
       return FALSE;
     }
@@ -356,9 +545,9 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
   sws_scale(video->sws_ctx,
             (const uint8_t * const *) frame->data, frame->linesize,
             0, video->codec_ctx->height,
-            (uint8_t *[1]) { data }, (int[1]) { video->codec_ctx->width * 4 });
+            (uint8_t *[1]) { buffer->data }, (int[1]) { video->codec_ctx->width * 4 });
 
-  bytes = g_bytes_new_take (data, video->codec_ctx->width * video->codec_ctx->height * 4);
+  bytes = g_bytes_new_with_free_func (buffer->data, size, frame_pool_release, buffer);
   texture = gdk_memory_texture_new (video->codec_ctx->width,
                                     video->codec_ctx->height,
                                     video->memory_format,
@@ -378,6 +567,155 @@ gtk_ff_media_file_decode_frame (GtkFfMediaFile      *video,
   return TRUE;
 }
 
+static gboolean
+gtk_ff_media_file_frame_ready_cb (gpointer data);
+
+static gpointer
+gtk_ff_media_file_decode_thread (gpointer data)
+{
+  GtkFfMediaFile *video = data;
+
+  g_mutex_lock (&video->decode_lock);
+
+  while (!video->decode_stop)
+    {
+      GtkVideoFrameFFMpeg *frame;
+      GError *error = NULL;
+      gboolean success;
+
+      if (video->decoded_frames.length >= MAX_QUEUED_FRAMES)
+        {
+          g_cond_wait (&video->decode_cond, &video->decode_lock);
+          continue;
+        }
+
+      g_mutex_unlock (&video->decode_lock);
+
+      frame = g_slice_new0 (GtkVideoFrameFFMpeg);
+      success = gtk_ff_media_file_decode_frame (video, frame, &error);
+
+      g_mutex_lock (&video->decode_lock);
+
+      if (success)
+        {
+          g_queue_push_tail (&video->decoded_frames, frame);
+        }
+      else
+        {
+          g_slice_free (GtkVideoFrameFFMpeg, frame);
+          video->decode_error = error;
+          video->decode_done = TRUE;
+        }
+
+      if (video->waiting_for_frame)
+        {
+          video->waiting_for_frame = FALSE;
+          video->frame_ready_cb = g_idle_add (gtk_ff_media_file_frame_ready_cb, video);
+          g_source_set_name_by_id (video->frame_ready_cb, "[gtk] gtk_ff_media_file_frame_ready_cb");
+        }
+
+      g_cond_broadcast (&video->decode_cond);
+
+      if (!success)
+        break;
+    }
+
+  g_mutex_unlock (&video->decode_lock);
+
+  return NULL;
+}
+
+static void
+gtk_ff_media_file_start_decoding (GtkFfMediaFile *video)
+{
+  if (video->decode_thread)
+    return;
+
+  video->decode_thread = g_thread_new ("gtk-ffmpeg-decode",
+                                       gtk_ff_media_file_decode_thread,
+                                       video);
+}
+
+/* Stops the decoding thread and drops the frames it decoded, so
+ * that the ffmpeg state can be used from the main thread again */
+static void
+gtk_ff_media_file_stop_decoding (GtkFfMediaFile *video)
+{
+  GtkVideoFrameFFMpeg *frame;
+
+  if (video->decode_thread == NULL)
+    return;
+
+  g_mutex_lock (&video->decode_lock);
+  video->decode_stop = TRUE;
+  g_cond_broadcast (&video->decode_cond);
+  g_mutex_unlock (&video->decode_lock);
+
+  g_thread_join (video->decode_thread);
+  video->decode_thread = NULL;
+
+  while ((frame = g_queue_pop_head (&video->decoded_frames)))
+    {
+      gtk_video_frame_ffmpeg_clear (frame);
+      g_slice_free (GtkVideoFrameFFMpeg, frame);
+    }
+
+  g_clear_error (&video->decode_error);
+  g_clear_error (&video->read_error);
+  video->decode_stop = FALSE;
+  video->decode_done = FALSE;
+  video->waiting_for_frame = FALSE;
+  g_clear_handle_id (&video->frame_ready_cb, g_source_remove);
+}
+
+/* Takes the next frame from the decoding thread. If @wait is %FALSE
+ * and no frame is ready yet, this returns %FRAME_PENDING and
+ * gtk_ff_media_file_frame_ready_cb() is called once there is one.
+ */
+static FrameStatus
+gtk_ff_media_file_take_frame (GtkFfMediaFile      *video,
+                              GtkVideoFrameFFMpeg *result,
+                              gboolean             wait)
+{
+  GtkVideoFrameFFMpeg *frame;
+  GError *error = NULL;
+  FrameStatus status;
+
+  gtk_ff_media_file_start_decoding (video);
+
+  g_mutex_lock (&video->decode_lock);
+
+  while (wait && g_queue_is_empty (&video->decoded_frames) && !video->decode_done)
+    g_cond_wait (&video->decode_cond, &video->decode_lock);
+
+  frame = g_queue_pop_head (&video->decoded_frames);
+  if (frame)
+    {
+      gtk_video_frame_ffmpeg_move (result, frame);
+      g_slice_free (GtkVideoFrameFFMpeg, frame);
+      /* There is room in the queue again */
+      g_cond_broadcast (&video->decode_cond);
+      status = FRAME_READY;
+    }
+  else if (video->decode_done)
+    {
+      error = g_steal_pointer (&video->decode_error);
+      status = FRAME_END;
+    }
+  else
+    {
+      video->waiting_for_frame = TRUE;
+      status = FRAME_PENDING;
+    }
+
+  g_mutex_unlock (&video->decode_lock);
+
+  if (error)
+    gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+
+  return status;
+}
+
 static int64_t
 gtk_ff_media_file_seek_cb (void    *data,
                            int64_t  offset,
@@ -484,6 +822,7 @@ gtk_ff_media_file_open (GtkMediaFile *file)
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (file);
   AVStream *stream;
   AVCodec *codec;
+  GError *error = NULL;
   int errnum;
 
   video->format_ctx = avformat_alloc_context ();
@@ -546,6 +885,10 @@ gtk_ff_media_file_open (GtkMediaFile *file)
       gtk_ff_media_file_set_ffmpeg_error (video, errnum);
       return;
     }
+  /* Let ffmpeg decode several frames at once, on as many threads
+   * as it thinks is best */
+  video->codec_ctx->thread_count = 0;
+  video->codec_ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
   errnum = avcodec_open2 (video->codec_ctx, codec, &stream->metadata);
   if (errnum < 0)
     {
@@ -563,8 +906,10 @@ gtk_ff_media_file_open (GtkMediaFile *file)
 
   gdk_paintable_invalidate_size (GDK_PAINTABLE (video));
 
-  if (gtk_ff_media_file_decode_frame (video, &video->current_frame))
+  if (gtk_ff_media_file_decode_frame (video, &video->current_frame, &error))
     gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
+  else if (error)
+    gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
 
   if (gtk_media_stream_get_playing (GTK_MEDIA_STREAM (video)))
     gtk_ff_media_file_play (GTK_MEDIA_STREAM (video));
@@ -575,6 +920,9 @@ gtk_ff_media_file_close (GtkMediaFile *file)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (file);
 
+  gtk_ff_media_file_stop_decoding (video);
+  g_clear_error (&video->read_error);
+
   g_clear_object (&video->input_stream);
 
   g_clear_pointer (&video->sws_ctx, sws_freeContext);
@@ -596,6 +944,18 @@ gtk_ff_media_file_queue_frame (GtkFfMediaFile *video)
   gint64 time, frame_time;
   guint delay;
 
+  if (video->frame_clock)
+    {
+      /* gtk_ff_media_file_update_cb() shows it in the right frame */
+      video->frame_queued = TRUE;
+      if (!video->frame_clock_updating)
+        {
+          video->frame_clock_updating = TRUE;
+          gdk_frame_clock_begin_updating (video->frame_clock);
+        }
+      return;
+    }
+
   time = g_get_monotonic_time ();
   frame_time = video->start_time + video->next_frame.timestamp;
   delay = time > frame_time ? 0 : (frame_time - time) / 1000;
@@ -606,6 +966,10 @@ gtk_ff_media_file_queue_frame (GtkFfMediaFile *video)
 static gboolean
 gtk_ff_media_file_restart (GtkFfMediaFile *video)
 {
+  GError *error = NULL;
+
+  gtk_ff_media_file_stop_decoding (video);
+
   if (av_seek_frame (video->format_ctx,
                      video->stream_id,
                      av_rescale_q (0,
@@ -614,12 +978,59 @@ gtk_ff_media_file_restart (GtkFfMediaFile *video)
                      AVSEEK_FLAG_BACKWARD) < 0)
     return FALSE;
 
-  if (!gtk_ff_media_file_decode_frame (video, &video->next_frame))
-    return FALSE;
+  avcodec_flush_buffers (video->codec_ctx);
+
+  if (!gtk_ff_media_file_decode_frame (video, &video->next_frame, &error))
+    {
+      if (error)
+        gtk_media_stream_gerror (GTK_MEDIA_STREAM (video), error);
+      return FALSE;
+    }
 
   return TRUE;
 }
 
+/* Gets the frame after the current one from the decoding thread and
+ * schedules showing it */
+static void
+gtk_ff_media_file_fetch_next_frame (GtkFfMediaFile *video)
+{
+  switch (gtk_ff_media_file_take_frame (video, &video->next_frame, FALSE))
+    {
+    case FRAME_PENDING:
+      /* The decoder is behind, gtk_ff_media_file_frame_ready_cb()
+       * picks it up when it is done */
+      break;
+
+    case FRAME_END:
+      /* We'll handle the empty frame case in the callback */
+      if (gtk_media_stream_get_error (GTK_MEDIA_STREAM (video)) == NULL)
+        gtk_ff_media_file_queue_frame (video);
+      break;
+
+    case FRAME_READY:
+      gtk_ff_media_file_queue_frame (video);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+gtk_ff_media_file_frame_ready_cb (gpointer data)
+{
+  GtkFfMediaFile *video = data;
+
+  g_mutex_lock (&video->decode_lock);
+  video->frame_ready_cb = 0;
+  g_mutex_unlock (&video->decode_lock);
+
+  gtk_ff_media_file_fetch_next_frame (video);
+
+  return G_SOURCE_REMOVE;
+}
+
 static gboolean
 gtk_ff_media_file_next_frame_cb (gpointer data)
 {
@@ -647,14 +1058,41 @@ gtk_ff_media_file_next_frame_cb (gpointer data)
                            video->current_frame.timestamp);
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
 
-  /* ignore failure here, we'll handle the empty frame case above
-   * the next time we're called. */
-  gtk_ff_media_file_decode_frame (video, &video->next_frame);
-  gtk_ff_media_file_queue_frame (video);
+  gtk_ff_media_file_fetch_next_frame (video);
 
   return G_SOURCE_REMOVE;
 }
 
+static void
+gtk_ff_media_file_update_cb (GdkFrameClock  *clock,
+                             GtkFfMediaFile *video)
+{
+  GdkFrameTimings *timings;
+  gint64 presentation_time = 0;
+
+  timings = gdk_frame_clock_get_current_timings (clock);
+  if (timings)
+    presentation_time = gdk_frame_timings_get_predicted_presentation_time (timings);
+  if (presentation_time == 0)
+    presentation_time = gdk_frame_clock_get_frame_time (clock);
+
+  /* Show the last frame that is due when this frame reaches the
+   * screen, the ones before it would never be seen */
+  while (video->frame_queued &&
+         (gtk_video_frame_ffmpeg_is_empty (&video->next_frame) ||
+          video->start_time + video->next_frame.timestamp <= presentation_time))
+    {
+      video->frame_queued = FALSE;
+      gtk_ff_media_file_next_frame_cb (video);
+    }
+
+  if (!video->frame_queued && video->frame_clock_updating)
+    {
+      video->frame_clock_updating = FALSE;
+      gdk_frame_clock_end_updating (clock);
+    }
+}
+
 static gboolean
 gtk_ff_media_file_play (GtkMediaStream *stream)
 {
@@ -667,7 +1105,7 @@ gtk_ff_media_file_play (GtkMediaStream *stream)
     return TRUE;
 
   if (gtk_video_frame_ffmpeg_is_empty (&video->next_frame) &&
-      !gtk_ff_media_file_decode_frame (video, &video->next_frame))
+      gtk_ff_media_file_take_frame (video, &video->next_frame, TRUE) != FRAME_READY)
     {
       if (gtk_ff_media_file_restart (video))
         {
@@ -699,6 +1137,20 @@ gtk_ff_media_file_pause (GtkMediaStream *stream)
       video->next_frame_cb = 0;
     }
 
+  video->frame_queued = FALSE;
+  if (video->frame_clock_updating)
+    {
+      video->frame_clock_updating = FALSE;
+      gdk_frame_clock_end_updating (video->frame_clock);
+    }
+
+  /* The decoding thread keeps going until the queue is full,
+   * but we don't want to hear about late frames anymore */
+  g_mutex_lock (&video->decode_lock);
+  video->waiting_for_frame = FALSE;
+  g_clear_handle_id (&video->frame_ready_cb, g_source_remove);
+  g_mutex_unlock (&video->decode_lock);
+
   video->start_time = 0;
 }
 
@@ -707,8 +1159,11 @@ gtk_ff_media_file_seek (GtkMediaStream *stream,
                         gint64          timestamp)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
+  GError *error = NULL;
   int errnum;
 
+  gtk_ff_media_file_stop_decoding (video);
+
   errnum = av_seek_frame (video->format_ctx,
                           video->stream_id,
                           av_rescale_q (timestamp,
@@ -721,12 +1176,16 @@ gtk_ff_media_file_seek (GtkMediaStream *stream,
       return;
     }
 
+  avcodec_flush_buffers (video->codec_ctx);
+
   gtk_media_stream_seek_success (stream);
 
   gtk_video_frame_ffmpeg_clear (&video->next_frame);
   gtk_video_frame_ffmpeg_clear (&video->current_frame);
-  if (gtk_ff_media_file_decode_frame (video, &video->current_frame))
+  if (gtk_ff_media_file_decode_frame (video, &video->current_frame, &error))
     gtk_media_stream_update (stream, video->current_frame.timestamp);
+  else if (error)
+    gtk_media_stream_gerror (stream, error);
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (video));
 
   if (gtk_media_stream_get_playing (stream))
@@ -737,17 +1196,89 @@ gtk_ff_media_file_seek (GtkMediaStream *stream,
     }
 }
 
+static void
+gtk_ff_media_file_realize (GtkMediaStream *stream,
+                           GdkSurface     *surface)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
+
+  /* We only follow the first surface we're shown on */
+  if (video->frame_clock)
+    return;
+
+  video->frame_clock = g_object_ref (gdk_surface_get_frame_clock (surface));
+  g_signal_connect (video->frame_clock, "update",
+                    G_CALLBACK (gtk_ff_media_file_update_cb), video);
+
+  if (video->next_frame_cb)
+    {
+      g_source_remove (video->next_frame_cb);
+      video->next_frame_cb = 0;
+      gtk_ff_media_file_queue_frame (video);
+    }
+}
+
+static void
+gtk_ff_media_file_clear_frame_clock (GtkFfMediaFile *video)
+{
+  if (video->frame_clock_updating)
+    {
+      video->frame_clock_updating = FALSE;
+      gdk_frame_clock_end_updating (video->frame_clock);
+    }
+
+  g_signal_handlers_disconnect_by_func (video->frame_clock,
+                                        gtk_ff_media_file_update_cb,
+                                        video);
+  g_clear_object (&video->frame_clock);
+}
+
+static void
+gtk_ff_media_file_unrealize (GtkMediaStream *stream,
+                             GdkSurface     *surface)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (stream);
+  gboolean frame_queued;
+
+  if (video->frame_clock == NULL ||
+      video->frame_clock != gdk_surface_get_frame_clock (surface))
+    return;
+
+  frame_queued = video->frame_queued;
+  video->frame_queued = FALSE;
+
+  gtk_ff_media_file_clear_frame_clock (video);
+
+  /* Go back to timeouts */
+  if (frame_queued)
+    gtk_ff_media_file_queue_frame (video);
+}
+
 static void
 gtk_ff_media_file_dispose (GObject *object)
 {
   GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (object);
 
   gtk_ff_media_file_pause (GTK_MEDIA_STREAM (video));
+  if (video->frame_clock)
+    gtk_ff_media_file_clear_frame_clock (video);
   gtk_ff_media_file_close (GTK_MEDIA_FILE (video));
 
   G_OBJECT_CLASS (gtk_ff_media_file_parent_class)->dispose (object);
 }
 
+static void
+gtk_ff_media_file_finalize (GObject *object)
+{
+  GtkFfMediaFile *video = GTK_FF_MEDIA_FILE (object);
+
+  frame_pool_unref (video->frame_pool);
+  g_mutex_clear (&video->decode_lock);
+  g_cond_clear (&video->decode_cond);
+
+  G_OBJECT_CLASS (gtk_ff_media_file_parent_class)->finalize (object);
+}
+
 static void
 gtk_ff_media_file_class_init (GtkFfMediaFileClass *klass)
 {
@@ -760,14 +1291,21 @@ gtk_ff_media_file_class_init (GtkFfMediaFileClass *klass)
   stream_class->play = gtk_ff_media_file_play;
   stream_class->pause = gtk_ff_media_file_pause;
   stream_class->seek = gtk_ff_media_file_seek;
+  stream_class->realize = gtk_ff_media_file_realize;
+  stream_class->unrealize = gtk_ff_media_file_unrealize;
 
   gobject_class->dispose = gtk_ff_media_file_dispose;
+  gobject_class->finalize = gtk_ff_media_file_finalize;
 }
 
 static void
 gtk_ff_media_file_init (GtkFfMediaFile *video)
 {
   video->stream_id = -1;
+  video->frame_pool = frame_pool_new ();
+  g_mutex_init (&video->decode_lock);
+  g_cond_init (&video->decode_cond);
+  g_queue_init (&video->decoded_frames);
 }
 
 
@@ -36,6 +36,15 @@ struct _GtkGstPaintable
   double pixel_aspect_ratio;
 
   GdkGLContext *context;
+  GdkFrameClock *frame_clock;
+
+  /* The newest frame from the sink, shown on the next frame clock
+   * update. Older frames that weren't shown yet are dropped.
+   */
+  GMutex lock;
+  GdkTexture *pending_texture;
+  double pending_pixel_aspect_ratio;
+  gboolean update_scheduled;
 };
 
 struct _GtkGstPaintableClass
@@ -158,27 +167,53 @@ G_DEFINE_TYPE_WITH_CODE (GtkGstPaintable, gtk_gst_paintable, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GST_TYPE_PLAYER_VIDEO_RENDERER,
                                                 gtk_gst_paintable_video_renderer_init));
 
+static void gtk_gst_paintable_latch_texture (GtkGstPaintable *self);
+
+static void
+gtk_gst_paintable_clear_frame_clock (GtkGstPaintable *self)
+{
+  g_signal_handlers_disconnect_by_func (self->frame_clock,
+                                        gtk_gst_paintable_latch_texture,
+                                        self);
+  g_clear_object (&self->frame_clock);
+}
+
 static void
 gtk_gst_paintable_dispose (GObject *object)
 {
   GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
   
+  if (self->frame_clock)
+    gtk_gst_paintable_clear_frame_clock (self);
+  g_clear_object (&self->pending_texture);
   g_clear_object (&self->image);
 
   G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->dispose (object);
 }
 
+static void
+gtk_gst_paintable_finalize (GObject *object)
+{
+  GtkGstPaintable *self = GTK_GST_PAINTABLE (object);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gtk_gst_paintable_parent_class)->finalize (object);
+}
+
 static void
 gtk_gst_paintable_class_init (GtkGstPaintableClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_gst_paintable_dispose;
+  object_class->finalize = gtk_gst_paintable_finalize;
 }
 
 static void
 gtk_gst_paintable_init (GtkGstPaintable *self)
 {
+  g_mutex_init (&self->lock);
 }
 
 GdkPaintable *
@@ -195,6 +230,13 @@ gtk_gst_paintable_realize (GtkGstPaintable *self,
   GtkNative *native;
   GskRenderer *renderer;
 
+  if (self->frame_clock == NULL)
+    {
+      self->frame_clock = g_object_ref (gdk_surface_get_frame_clock (surface));
+      g_signal_connect_swapped (self->frame_clock, "update",
+                                G_CALLBACK (gtk_gst_paintable_latch_texture), self);
+    }
+
   if (self->context)
     return;
 
@@ -231,6 +273,14 @@ gtk_gst_paintable_unrealize (GtkGstPaintable *self,
    * - track how often we were realized with that surface
    * - track alternate surfaces
    */
+  if (self->frame_clock &&
+      self->frame_clock == gdk_surface_get_frame_clock (surface))
+    {
+      gtk_gst_paintable_clear_frame_clock (self);
+      /* Don't leave a frame waiting for a clock we don't listen to */
+      gtk_gst_paintable_latch_texture (self);
+    }
+
   if (self->context == NULL)
     return;
 
@@ -266,51 +316,61 @@ gtk_gst_paintable_set_paintable (GtkGstPaintable *self,
   gdk_paintable_invalidate_contents (GDK_PAINTABLE (self));
 }
 
-typedef struct _SetTextureInvocation SetTextureInvocation;
-
-struct _SetTextureInvocation {
-  GtkGstPaintable *paintable;
-  GdkTexture      *texture;
-  double           pixel_aspect_ratio;
-};
-
 static void
-set_texture_invocation_free (SetTextureInvocation *invoke)
+gtk_gst_paintable_latch_texture (GtkGstPaintable *self)
 {
-  g_object_unref (invoke->paintable);
-  g_object_unref (invoke->texture);
+  GdkTexture *texture;
+  double pixel_aspect_ratio;
 
-  g_slice_free (SetTextureInvocation, invoke);
+  g_mutex_lock (&self->lock);
+  texture = g_steal_pointer (&self->pending_texture);
+  pixel_aspect_ratio = self->pending_pixel_aspect_ratio;
+  self->update_scheduled = FALSE;
+  g_mutex_unlock (&self->lock);
+
+  if (texture == NULL)
+    return;
+
+  gtk_gst_paintable_set_paintable (self,
+                                   GDK_PAINTABLE (texture),
+                                   pixel_aspect_ratio);
+  g_object_unref (texture);
 }
 
 static gboolean
-gtk_gst_paintable_set_texture_invoke (gpointer data)
+gtk_gst_paintable_schedule_update_invoke (gpointer data)
 {
-  SetTextureInvocation *invoke = data;
+  GtkGstPaintable *self = data;
 
-  gtk_gst_paintable_set_paintable (invoke->paintable,
-                                   GDK_PAINTABLE (invoke->texture),
-                                   invoke->pixel_aspect_ratio);
+  if (self->frame_clock)
+    gdk_frame_clock_request_phase (self->frame_clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+  else
+    gtk_gst_paintable_latch_texture (self);
 
   return G_SOURCE_REMOVE;
 }
 
+/* Called from the streaming thread */
 void
 gtk_gst_paintable_queue_set_texture (GtkGstPaintable *self,
                                      GdkTexture      *texture,
                                      double           pixel_aspect_ratio)
 {
-  SetTextureInvocation *invoke;
+  gboolean schedule_update;
 
-  invoke = g_slice_new0 (SetTextureInvocation);
-  invoke->paintable = g_object_ref (self);
-  invoke->texture = g_object_ref (texture);
-  invoke->pixel_aspect_ratio = pixel_aspect_ratio;
+  g_mutex_lock (&self->lock);
+  g_set_object (&self->pending_texture, texture);
+  self->pending_pixel_aspect_ratio = pixel_aspect_ratio;
+  schedule_update = !self->update_scheduled;
+  self->update_scheduled = TRUE;
+  g_mutex_unlock (&self->lock);
+
+  if (!schedule_update)
+    return;
 
   g_main_context_invoke_full (NULL,
                               G_PRIORITY_DEFAULT,
-                              gtk_gst_paintable_set_texture_invoke,
-                              invoke,
-                              (GDestroyNotify) set_texture_invocation_free);
+                              gtk_gst_paintable_schedule_update_invoke,
+                              g_object_ref (self),
+                              g_object_unref);
 }
-
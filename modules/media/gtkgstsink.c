@@ -25,6 +25,8 @@
 #include "gtkgstpaintableprivate.h"
 #include "gtkintl.h"
 
+#include <gst/allocators/gstdmabuf.h>
+
 #if GST_GL_HAVE_WINDOW_X11 && GST_GL_HAVE_PLATFORM_GLX && defined (GDK_WINDOWING_X11)
 #include <gdk/x11/gdkx.h>
 #include <gst/gl/x11/gstgldisplay_x11.h>
@@ -50,6 +52,16 @@ GST_DEBUG_CATEGORY (gtk_debug_gst_sink);
 
 #define NOGL_CAPS GST_VIDEO_CAPS_MAKE (FORMATS)
 
+/* Formats that GdkDmabufTexture can take without conversion */
+#define DMABUF_FORMATS "{ BGRA, BGRx, RGBA, RGBx, RGB, BGR }"
+
+#define DMABUF_CAPS GST_VIDEO_CAPS_MAKE_WITH_FEATURES (GST_CAPS_FEATURE_MEMORY_DMABUF, DMABUF_FORMATS)
+
+/* The DRM fourccs matching DMABUF_FORMATS, see drm_fourcc.h */
+#define DRM_FOURCC(a, b, c, d) ((guint32) (a) | ((guint32) (b) << 8) | \
+                                ((guint32) (c) << 16) | ((guint32) (d) << 24))
+#define DRM_FORMAT_MOD_INVALID ((G_GUINT64_CONSTANT (1) << 56) - 1)
+
 static GstStaticPadTemplate gtk_gst_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -60,6 +72,7 @@ GST_STATIC_PAD_TEMPLATE ("sink",
                      "height = " GST_VIDEO_SIZE_RANGE ", "
                      "framerate = " GST_VIDEO_FPS_RANGE ", "
                      "texture-target = (string) 2D"
+                     "; " DMABUF_CAPS
                      "; " NOGL_CAPS)
     );
 
@@ -113,7 +126,7 @@ gtk_gst_sink_get_caps (GstBaseSink *bsink,
     }
   else
     {
-      tmp = gst_caps_from_string (NOGL_CAPS);
+      tmp = gst_caps_from_string (DMABUF_CAPS "; " NOGL_CAPS);
     }
   GST_DEBUG_OBJECT (self, "advertising own caps %" GST_PTR_FORMAT, tmp);
 
@@ -168,13 +181,12 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
 {
   GtkGstSink *self = GTK_GST_SINK (bsink);
   GstBufferPool *pool = NULL;
+  GstCapsFeatures *features;
   GstStructure *config;
   GstCaps *caps;
   guint size;
   gboolean need_pool;
-
-  if (!self->gst_context)
-    return FALSE;
+  gboolean gl_memory;
 
   gst_query_parse_allocation (query, &caps, &need_pool);
 
@@ -184,8 +196,19 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
       return FALSE;
     }
 
-  if (!gst_caps_features_contains (gst_caps_get_features (caps, 0), GST_CAPS_FEATURE_MEMORY_GL_MEMORY))
-    return FALSE;
+  features = gst_caps_get_features (caps, 0);
+  gl_memory = gst_caps_features_contains (features, GST_CAPS_FEATURE_MEMORY_GL_MEMORY);
+
+  if (gl_memory)
+    {
+      if (!self->gst_context)
+        return FALSE;
+    }
+  else if (!gst_caps_features_is_equal (features, GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))
+    {
+      /* dmabufs come from upstream's own allocator */
+      return FALSE;
+    }
 
   if (need_pool)
     {
@@ -198,7 +221,10 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
         }
 
       GST_DEBUG_OBJECT (self, "create new pool");
-      pool = gst_gl_buffer_pool_new (self->gst_context);
+      if (gl_memory)
+        pool = gst_gl_buffer_pool_new (self->gst_context);
+      else
+        pool = gst_video_buffer_pool_new ();
 
       /* the normal size of a frame */
       size = info.size;
@@ -206,6 +232,21 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
       config = gst_buffer_pool_get_config (pool);
       gst_buffer_pool_config_set_params (config, caps, size, 0, 0);
 
+      if (!gl_memory)
+        {
+          GstVideoAlignment align;
+
+          /* System memory frames are wrapped into memory textures
+           * without a copy, so have the rows start on cache lines
+           * to keep the texture upload fast.
+           */
+          gst_video_alignment_reset (&align);
+          align.stride_align[0] = 63;
+          gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+          gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+          gst_buffer_pool_config_set_video_alignment (config, &align);
+        }
+
       if (!gst_buffer_pool_set_config (pool, config))
         {
           GST_DEBUG_OBJECT (bsink, "failed setting config");
@@ -213,8 +254,16 @@ gtk_gst_sink_propose_allocation (GstBaseSink *bsink,
           return FALSE;
         }
 
-      /* we need at least 2 buffer because we hold on to the last one */
-      gst_query_add_allocation_pool (query, pool, size, 2, 0);
+      /* The config may have grown the frame to fit the alignment */
+      config = gst_buffer_pool_get_config (pool);
+      gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL);
+      gst_structure_free (config);
+
+      /* we need at least 3 buffers: the paintable holds on to the
+       * frame it shows and the one waiting for the next frame clock
+       * tick while upstream fills the next one
+       */
+      gst_query_add_allocation_pool (query, pool, size, 3, 0);
       gst_object_unref (pool);
     }
 
@@ -247,6 +296,90 @@ gtk_gst_memory_format_from_video (GstVideoFormat format)
   }
 }
 
+static guint32
+gtk_gst_drm_fourcc_from_video (GstVideoFormat format)
+{
+  switch ((guint) format)
+  {
+    case GST_VIDEO_FORMAT_BGRA:
+      return DRM_FOURCC ('A', 'R', '2', '4');
+    case GST_VIDEO_FORMAT_BGRx:
+      return DRM_FOURCC ('X', 'R', '2', '4');
+    case GST_VIDEO_FORMAT_RGBA:
+      return DRM_FOURCC ('A', 'B', '2', '4');
+    case GST_VIDEO_FORMAT_RGBx:
+      return DRM_FOURCC ('X', 'B', '2', '4');
+    case GST_VIDEO_FORMAT_RGB:
+      return DRM_FOURCC ('B', 'G', '2', '4');
+    case GST_VIDEO_FORMAT_BGR:
+      return DRM_FOURCC ('R', 'G', '2', '4');
+    default:
+      return 0;
+  }
+}
+
+static GdkTexture *
+gtk_gst_sink_texture_from_dmabuf (GtkGstSink *self,
+                                  GstBuffer  *buffer)
+{
+  GstVideoMeta *meta;
+  GstMemory *memory;
+  GdkTexture *texture;
+  GError *error = NULL;
+  guint32 fourcc;
+  guint idx, length;
+  gsize offset, skip;
+  guint stride, plane_offset;
+  int fd;
+
+  fourcc = gtk_gst_drm_fourcc_from_video (GST_VIDEO_INFO_FORMAT (&self->v_info));
+  if (fourcc == 0)
+    return NULL;
+
+  meta = gst_buffer_get_video_meta (buffer);
+  if (meta)
+    {
+      offset = meta->offset[0];
+      stride = meta->stride[0];
+    }
+  else
+    {
+      offset = GST_VIDEO_INFO_PLANE_OFFSET (&self->v_info, 0);
+      stride = GST_VIDEO_INFO_PLANE_STRIDE (&self->v_info, 0);
+    }
+
+  if (!gst_buffer_find_memory (buffer, offset, 1, &idx, &length, &skip))
+    return NULL;
+
+  memory = gst_buffer_peek_memory (buffer, idx);
+  if (!gst_is_dmabuf_memory (memory))
+    return NULL;
+
+  fd = gst_dmabuf_memory_get_fd (memory);
+  plane_offset = memory->offset + skip;
+
+  texture = gdk_dmabuf_texture_new (GST_VIDEO_INFO_WIDTH (&self->v_info),
+                                    GST_VIDEO_INFO_HEIGHT (&self->v_info),
+                                    fourcc,
+                                    DRM_FORMAT_MOD_INVALID,
+                                    1,
+                                    &fd,
+                                    &stride,
+                                    &plane_offset,
+                                    (GDestroyNotify) gst_buffer_unref,
+                                    gst_buffer_ref (buffer),
+                                    &error);
+  if (texture == NULL)
+    {
+      GST_DEBUG_OBJECT (self, "Could not wrap dmabuf: %s", error->message);
+      g_error_free (error);
+      /* The destroy notify is only called for textures we created */
+      gst_buffer_unref (buffer);
+    }
+
+  return texture;
+}
+
 static void
 video_frame_free (GstVideoFrame *frame)
 {
@@ -262,7 +395,13 @@ gtk_gst_sink_texture_from_buffer (GtkGstSink *self,
   GstVideoFrame frame;
   GdkTexture *texture;
 
-  if (self->gdk_context &&
+  if (gst_is_dmabuf_memory (gst_buffer_peek_memory (buffer, 0)) &&
+      (texture = gtk_gst_sink_texture_from_dmabuf (self, buffer)) != NULL)
+    {
+      *pixel_aspect_ratio = ((double) GST_VIDEO_INFO_PAR_N (&self->v_info)) /
+                            ((double) GST_VIDEO_INFO_PAR_D (&self->v_info));
+    }
+  else if (self->gdk_context &&
       gst_video_frame_map (&frame, &self->v_info, buffer, GST_MAP_READ | GST_MAP_GL))
     {
       texture = gdk_gl_texture_new (self->gdk_context,
@@ -16,13 +16,25 @@ init_surface (cairo_t *cr)
   cairo_fill (cr);
 }
 
+static double
+time_blur (cairo_t *cr,
+           GTimer  *timer,
+           int      radius)
+{
+  init_surface (cr);
+  g_timer_start (timer);
+  gsk_cairo_blur_surface (cairo_get_target (cr), radius, GSK_BLUR_X | GSK_BLUR_Y);
+
+  return g_timer_elapsed (timer, NULL) * 1000;
+}
+
 int
 main (int argc, char **argv)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
   GTimer *timer;
-  double msec;
+  double msec, threaded_msec;
   int i, j;
   int size;
 
@@ -39,12 +51,16 @@ main (int argc, char **argv)
     {
       for (i = 1; i < 16; i++)
 	{
-	  init_surface (cr);
-	  g_timer_start (timer);
-	  gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
-	  msec = g_timer_elapsed (timer, NULL) * 1000;
+	  gsk_cairo_blur_set_max_threads (1);
+	  msec = time_blur (cr, timer, i);
+	  gsk_cairo_blur_set_max_threads (0);
+	  threaded_msec = time_blur (cr, timer, i);
 	  if (j == 1)
-	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec:\n", i, msec, size*size/(msec*1000));
+	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec, threaded: %.2f msec, %.2f kpixels/msec, %.2fx\n",
+                     i,
+                     msec, size*size/(msec*1000),
+                     threaded_msec, size*size/(threaded_msec*1000),
+                     msec / threaded_msec);
 	}
     }
 
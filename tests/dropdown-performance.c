@@ -0,0 +1,157 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#define N_ITEMS 100000
+#define N_RUNS 5
+
+static GListModel *
+create_model (void)
+{
+  GtkStringList *list;
+  char buffer[64];
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      g_snprintf (buffer, sizeof (buffer), "Item %u", g_random_int ());
+      gtk_string_list_append (list, buffer);
+    }
+
+  return G_LIST_MODEL (list);
+}
+
+static void
+wait_for_idle (void)
+{
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static GtkWidget *
+get_child_of_type (GtkWidget *dropdown,
+                   GType      type)
+{
+  GtkWidget *child;
+
+  for (child = gtk_widget_get_first_child (dropdown);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (G_TYPE_CHECK_INSTANCE_TYPE (child, type))
+        return child;
+    }
+
+  return NULL;
+}
+
+/* Opens the popup with the selection somewhere in the middle of
+ * the list, so scrolling to it is part of the measurement
+ */
+static double
+time_popup (GtkWidget *dropdown,
+            GTimer    *timer)
+{
+  GtkWidget *button;
+  double elapsed;
+
+  button = get_child_of_type (dropdown, GTK_TYPE_TOGGLE_BUTTON);
+
+  gtk_drop_down_set_selected (GTK_DROP_DOWN (dropdown), g_random_int_range (0, N_ITEMS));
+
+  g_timer_start (timer);
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
+  wait_for_idle ();
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), FALSE);
+  wait_for_idle ();
+
+  return elapsed;
+}
+
+/* Types a search term one character at a time, like a user would,
+ * into the same kind of filter that the popup uses
+ */
+static double
+time_search (GtkWidget *dropdown,
+             GTimer    *timer)
+{
+  const char *keys = "Item 12";
+  GtkStringFilter *filter;
+  GtkExpression *expression;
+  GListModel *model;
+  double elapsed;
+  guint i;
+
+  expression = gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string");
+  filter = gtk_string_filter_new (expression);
+  gtk_string_filter_set_match_mode (filter, GTK_STRING_FILTER_MATCH_MODE_PREFIX);
+  model = G_LIST_MODEL (gtk_filter_list_model_new (g_object_ref (gtk_drop_down_get_model (GTK_DROP_DOWN (dropdown))),
+                                                   GTK_FILTER (filter)));
+
+  g_timer_start (timer);
+
+  for (i = 1; i <= strlen (keys); i++)
+    {
+      char *search = g_strndup (keys, i);
+      gtk_string_filter_set_search (filter, search);
+      g_list_model_get_n_items (model);
+      g_free (search);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_object_unref (model);
+
+  return elapsed;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *dropdown;
+  GListModel *model;
+  GTimer *timer;
+  double popup_time, search_time;
+  guint i;
+
+  gtk_init ();
+
+  timer = g_timer_new ();
+
+  model = create_model ();
+  dropdown = gtk_drop_down_new (model,
+                                gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  gtk_drop_down_set_enable_search (GTK_DROP_DOWN (dropdown), TRUE);
+
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), dropdown);
+  gtk_widget_show (window);
+  wait_for_idle ();
+
+  /* The first popup creates the list items */
+  popup_time = time_popup (dropdown, timer);
+  g_print ("first popup: %8.3f ms\n", popup_time * 1000);
+
+  popup_time = 0;
+  search_time = 0;
+  for (i = 0; i < N_RUNS; i++)
+    {
+      popup_time += time_popup (dropdown, timer);
+      search_time += time_search (dropdown, timer);
+    }
+
+  g_print ("popup:       %8.3f ms\n", popup_time * 1000 / N_RUNS);
+  g_print ("search:      %8.3f ms\n", search_time * 1000 / N_RUNS);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_timer_destroy (timer);
+
+  return 0;
+}
@@ -520,6 +520,53 @@ box_shadows (guint n)
   return container;
 }
 
+static guint
+count_nodes (GskRenderNode *node)
+{
+  guint i, n;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      n = 1;
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        n += count_nodes (gsk_container_node_get_child (node, i));
+      return n;
+
+    case GSK_CLIP_NODE:
+      return 1 + count_nodes (gsk_clip_node_get_child (node));
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return 1 + count_nodes (gsk_rounded_clip_node_get_child (node));
+
+    default:
+      return 1;
+    }
+}
+
+/* Measures node creation and destruction, including the random
+ * parameter generation, so only compare numbers for the same test. */
+static void
+benchmark (const char *name,
+           GskRenderNode * (* func) (guint n),
+           guint       n)
+{
+  GskRenderNode *node;
+  gint64 start, end;
+  guint n_nodes;
+
+  start = g_get_monotonic_time ();
+  node = func (n);
+  n_nodes = count_nodes (node);
+  gsk_render_node_unref (node);
+  end = g_get_monotonic_time ();
+
+  g_print ("%-28s %8u nodes in %7.3fs, %10.0f nodes/sec\n",
+           name, n_nodes,
+           (end - start) / (double) G_USEC_PER_SEC,
+           n_nodes * (double) G_USEC_PER_SEC / MAX (end - start, 1));
+}
+
 int
 main (int argc, char **argv)
 {
@@ -541,6 +588,7 @@ main (int argc, char **argv)
   GskRenderNode *node;
   GPatternSpec *matcher;
   const char *pattern;
+  gboolean benchmark_mode = FALSE;
   guint i, n;
 
   gtk_init ();
@@ -548,6 +596,13 @@ main (int argc, char **argv)
   n = 100000;
   pattern = "*";
 
+  if (argc > 1 && g_str_equal (argv[1], "--benchmark"))
+    {
+      benchmark_mode = TRUE;
+      argc--;
+      argv++;
+    }
+
   if (argc > 1)
     {
       if (argc > 2)
@@ -562,6 +617,12 @@ main (int argc, char **argv)
       if (!g_pattern_match_string (matcher, functions[i].name))
         continue;
 
+      if (benchmark_mode)
+        {
+          benchmark (functions[i].name, functions[i].func, n);
+          continue;
+        }
+
       node = functions[i].func (n);
       if (!gsk_render_node_write_to_file (node, functions[i].name, &error))
         {
@@ -1,10 +1,12 @@
 #include <gtk/gtk.h>
 
 static char *write_to_filename = NULL;
+static char *write_binary_filename = NULL;
 static gboolean compare_node;
 
 static GOptionEntry options[] = {
   { "write", 'o', 0, G_OPTION_ARG_STRING, &write_to_filename, "Write PNG file", NULL },
+  { "binary", 'b', 0, G_OPTION_ARG_STRING, &write_binary_filename, "Write binary node file", NULL },
   { "compare", 'c', 0, G_OPTION_ARG_NONE, &compare_node, "Compare render to render_texture", NULL },
   { NULL }
 };
@@ -193,6 +195,22 @@ main (int argc, char **argv)
       return -1;
     }
 
+  if (write_binary_filename != NULL)
+    {
+      GBytes *binary = gsk_render_node_serialize_binary (GTK_NODE_VIEW (nodeview)->node);
+
+      if (!g_file_set_contents (write_binary_filename,
+                                g_bytes_get_data (binary, NULL),
+                                g_bytes_get_size (binary),
+                                &error))
+        {
+          g_warning ("%s", error->message);
+          g_clear_error (&error);
+        }
+
+      g_bytes_unref (binary);
+    }
+
   if (write_to_filename != NULL)
     {
       GdkSurface *surface = gdk_surface_new_toplevel (gdk_display_get_default());
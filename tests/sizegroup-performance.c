@@ -0,0 +1,122 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#define N_ROWS 500
+#define N_FRAMES 50
+
+static gboolean frame_done;
+
+static void
+after_paint (GdkFrameClock *clock,
+             gpointer       data)
+{
+  frame_done = TRUE;
+}
+
+static void
+wait_for_frame (void)
+{
+  frame_done = FALSE;
+  while (!frame_done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+/* A form like grid with a label and a value in every row, where the
+ * labels and the values each share a size group, as is common in
+ * preference dialogs
+ */
+static GtkWidget *
+create_grid (GtkWidget **labels)
+{
+  GtkSizeGroup *name_group, *value_group;
+  GtkWidget *grid;
+  char buffer[32];
+  int i;
+
+  grid = gtk_grid_new ();
+  name_group = gtk_size_group_new (GTK_SIZE_GROUP_HORIZONTAL);
+  value_group = gtk_size_group_new (GTK_SIZE_GROUP_BOTH);
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      GtkWidget *name;
+
+      g_snprintf (buffer, sizeof (buffer), "Row %d", i);
+      name = gtk_label_new (buffer);
+      gtk_size_group_add_widget (name_group, name);
+      gtk_grid_attach (GTK_GRID (grid), name, 0, i, 1, 1);
+      labels[2 * i] = name;
+
+      labels[2 * i + 1] = gtk_label_new ("0");
+      gtk_size_group_add_widget (value_group, labels[2 * i + 1]);
+      gtk_grid_attach (GTK_GRID (grid), labels[2 * i + 1], 1, i, 1, 1);
+    }
+
+  g_object_unref (name_group);
+  g_object_unref (value_group);
+
+  return grid;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *labels[2 * N_ROWS];
+  GtkWidget *window, *sw;
+  GdkFrameClock *clock;
+  GTimer *timer;
+  double elapsed, best;
+  char buffer[32];
+  int i, j;
+
+  gtk_init ();
+
+  timer = g_timer_new ();
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 600);
+  sw = gtk_scrolled_window_new ();
+  gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (sw), create_grid (labels));
+  gtk_window_set_child (GTK_WINDOW (window), sw);
+  gtk_widget_show (window);
+
+  clock = gtk_widget_get_frame_clock (window);
+  g_signal_connect (clock, "after-paint", G_CALLBACK (after_paint), NULL);
+  wait_for_frame ();
+
+  /* Every frame changes the text of all the labels, so all of them
+   * get measured again
+   */
+  elapsed = 0;
+  best = G_MAXDOUBLE;
+  for (i = 0; i < N_FRAMES; i++)
+    {
+      double frame;
+
+      g_timer_start (timer);
+
+      for (j = 0; j < 2 * N_ROWS; j++)
+        {
+          g_snprintf (buffer, sizeof (buffer), "%d", g_random_int_range (0, 1000000));
+          gtk_label_set_label (GTK_LABEL (labels[j]), buffer);
+        }
+
+      gtk_widget_queue_draw (window);
+      wait_for_frame ();
+
+      frame = g_timer_elapsed (timer, NULL);
+      elapsed += frame;
+      best = MIN (best, frame);
+    }
+
+  g_print ("%d labels in size groups\n", 2 * N_ROWS);
+  g_print ("average frame: %8.3f ms\n", elapsed * 1000 / N_FRAMES);
+  g_print ("best frame:    %8.3f ms\n", best * 1000);
+
+  g_signal_handlers_disconnect_by_func (clock, after_paint, NULL);
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_timer_destroy (timer);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#define N_WIDGETS 10000
+
+typedef struct {
+  const char *name;
+  GtkWidget * (* create) (void);
+} WidgetType;
+
+static GtkWidget *
+create_label (void)
+{
+  return gtk_label_new ("Label");
+}
+
+static GtkWidget *
+create_button (void)
+{
+  return gtk_button_new_with_label ("Button");
+}
+
+static GtkWidget *
+create_check_button (void)
+{
+  return gtk_check_button_new_with_label ("Check");
+}
+
+static GtkWidget *
+create_box (void)
+{
+  return gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+}
+
+static GtkWidget *
+create_image (void)
+{
+  return gtk_image_new_from_icon_name ("document-open");
+}
+
+static GtkWidget *
+create_entry (void)
+{
+  return gtk_entry_new ();
+}
+
+static GtkWidget *
+create_row (void)
+{
+  GtkWidget *row, *box;
+
+  row = gtk_list_box_row_new ();
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+  gtk_box_append (GTK_BOX (box), gtk_image_new_from_icon_name ("folder"));
+  gtk_box_append (GTK_BOX (box), gtk_label_new ("Row"));
+  gtk_box_append (GTK_BOX (box), gtk_button_new_from_icon_name ("edit-delete"));
+  gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
+
+  return row;
+}
+
+static const WidgetType types[] = {
+  { "GtkLabel", create_label },
+  { "GtkButton", create_button },
+  { "GtkCheckButton", create_check_button },
+  { "GtkBox", create_box },
+  { "GtkImage", create_image },
+  { "GtkEntry", create_entry },
+  { "GtkListBoxRow (4 widgets)", create_row },
+};
+
+/* Creates and destroys the widgets without ever showing them */
+static double
+time_create (const WidgetType *type,
+             GTimer           *timer)
+{
+  GtkWidget **widgets;
+  double elapsed;
+  int i;
+
+  widgets = g_new (GtkWidget *, N_WIDGETS);
+
+  g_timer_start (timer);
+
+  for (i = 0; i < N_WIDGETS; i++)
+    widgets[i] = g_object_ref_sink (type->create ());
+  for (i = 0; i < N_WIDGETS; i++)
+    g_object_unref (widgets[i]);
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_free (widgets);
+
+  return elapsed;
+}
+
+/* Creates the widgets in a window, so that the work that is
+ * deferred until a widget is rooted gets counted too
+ */
+static double
+time_create_rooted (const WidgetType *type,
+                    GtkWidget        *window,
+                    GTimer           *timer)
+{
+  GtkWidget *box;
+  double elapsed;
+  int i;
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+
+  g_timer_start (timer);
+
+  for (i = 0; i < N_WIDGETS; i++)
+    gtk_box_append (GTK_BOX (box), type->create ());
+  gtk_window_set_child (GTK_WINDOW (window), NULL);
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  return elapsed;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window;
+  GTimer *timer;
+  double elapsed, rooted_elapsed;
+  guint i, j;
+
+  gtk_init ();
+
+  timer = g_timer_new ();
+  window = gtk_window_new ();
+
+  /* We do everything twice, first as warmup */
+  for (j = 0; j < 2; j++)
+    {
+      for (i = 0; i < G_N_ELEMENTS (types); i++)
+        {
+          elapsed = time_create (&types[i], timer);
+          rooted_elapsed = time_create_rooted (&types[i], window, timer);
+          if (j == 1)
+            g_print ("%-26s %8.0f widgets/sec, rooted: %8.0f widgets/sec\n",
+                     types[i].name,
+                     N_WIDGETS / elapsed,
+                     N_WIDGETS / rooted_elapsed);
+        }
+    }
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_timer_destroy (timer);
+
+  return 0;
+}
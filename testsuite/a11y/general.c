@@ -77,6 +77,27 @@ test_labelled_by (void)
   g_object_unref (label);
 }
 
+static void
+test_description (void)
+{
+  GtkWidget *widget;
+
+  widget = gtk_button_new ();
+  g_object_ref_sink (widget);
+
+  g_assert_false (gtk_test_accessible_has_property (GTK_ACCESSIBLE (widget), GTK_ACCESSIBLE_PROPERTY_DESCRIPTION));
+
+  gtk_widget_set_tooltip_text (widget, "Tooltip");
+
+  gtk_test_accessible_assert_property (widget, GTK_ACCESSIBLE_PROPERTY_DESCRIPTION, "Tooltip");
+
+  gtk_accessible_reset_property (GTK_ACCESSIBLE (widget), GTK_ACCESSIBLE_PROPERTY_DESCRIPTION);
+
+  g_assert_false (gtk_test_accessible_has_property (GTK_ACCESSIBLE (widget), GTK_ACCESSIBLE_PROPERTY_DESCRIPTION));
+
+  g_object_unref (widget);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -86,6 +107,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/a11y/general/disabled", test_disabled);
   g_test_add_func ("/a11y/general/orientation", test_orientation);
   g_test_add_func ("/a11y/general/labelled-by", test_labelled_by);
+  g_test_add_func ("/a11y/general/description", test_description);
 
   return g_test_run ();
 }
@@ -0,0 +1,195 @@
+#include <gtk/gtk.h>
+
+#include "../../gtk/gtkcssnodeprivate.h"
+#include "../../gtk/gtkcsslookupprivate.h"
+#include "../../gtk/gtkstyleproviderprivate.h"
+
+/* A synthetic widget tree resembling a window with a header bar,
+ * a sidebar, a notebook and a long list, using names and classes
+ * that the Adwaita theme has rules for.
+ */
+static GtkCssNode *
+add_node (GtkCssNode *parent,
+          const char *name,
+          const char *classes)
+{
+  GtkCssNode *node;
+
+  node = gtk_css_node_new ();
+  gtk_css_node_set_name (node, g_quark_from_static_string (name));
+
+  if (classes)
+    {
+      char **split = g_strsplit (classes, " ", -1);
+      guint i;
+
+      for (i = 0; split[i]; i++)
+        gtk_css_node_add_class (node, g_quark_from_string (split[i]));
+
+      g_strfreev (split);
+    }
+
+  if (parent)
+    {
+      gtk_css_node_set_parent (node, parent);
+      g_object_unref (node);
+    }
+
+  return node;
+}
+
+static void
+add_button (GtkCssNode *parent,
+            const char *classes,
+            gboolean    with_label)
+{
+  GtkCssNode *button = add_node (parent, "button", classes);
+
+  if (with_label)
+    add_node (button, "label", NULL);
+  else
+    add_node (button, "image", NULL);
+}
+
+static void
+add_row (GtkCssNode *list,
+         guint       i)
+{
+  GtkCssNode *row, *box, *check;
+
+  row = add_node (list, "row", i % 2 ? "activatable" : "activatable expander");
+  box = add_node (row, "box", "horizontal");
+  add_node (box, "image", "dim-label");
+  add_node (box, "label", i % 3 ? NULL : "title");
+  add_node (box, "label", "dim-label subtitle");
+  check = add_node (box, "checkbutton", NULL);
+  add_node (check, "check", NULL);
+  add_node (check, "label", NULL);
+  add_button (box, "flat circular", FALSE);
+  add_node (box, "switch", NULL);
+}
+
+static GtkCssNode *
+create_window (guint n_rows)
+{
+  GtkCssNode *window, *headerbar, *box, *paned, *sidebar, *stack, *notebook, *list, *scrolled;
+  guint i;
+
+  window = add_node (NULL, "window", "background csd");
+  add_node (window, "decoration", NULL);
+
+  headerbar = add_node (window, "headerbar", "titlebar");
+  box = add_node (headerbar, "box", "start");
+  add_button (box, "image-button", FALSE);
+  add_button (box, "text-button suggested-action", TRUE);
+  box = add_node (headerbar, "box", "end");
+  add_button (box, "image-button toggle", FALSE);
+  add_node (add_node (box, "windowcontrols", "end"), "button", "close");
+  add_node (headerbar, "label", "title");
+
+  paned = add_node (window, "paned", "horizontal");
+
+  sidebar = add_node (add_node (paned, "scrolledwindow", "sidebar"), "list", "navigation-sidebar");
+  for (i = 0; i < 20; i++)
+    add_node (add_node (sidebar, "row", "activatable"), "label", NULL);
+
+  stack = add_node (paned, "stack", NULL);
+  notebook = add_node (stack, "notebook", "frame");
+  box = add_node (add_node (notebook, "header", "top"), "tabs", NULL);
+  for (i = 0; i < 8; i++)
+    add_node (add_node (box, "tab", i == 0 ? "reorderable-page" : NULL), "label", NULL);
+
+  scrolled = add_node (add_node (notebook, "stack", NULL), "scrolledwindow", "frame");
+  add_node (scrolled, "scrollbar", "vertical");
+  list = add_node (scrolled, "list", "rich-list");
+  for (i = 0; i < n_rows; i++)
+    add_row (list, i);
+
+  box = add_node (add_node (window, "actionbar", NULL), "revealer", NULL);
+  add_node (box, "entry", NULL);
+  add_node (box, "spinbutton", "horizontal");
+  add_node (box, "progressbar", "horizontal");
+  add_node (box, "scale", "horizontal marks-after");
+
+  return window;
+}
+
+static guint
+lookup_nodes (GtkStyleProvider       *provider,
+              GtkCountingBloomFilter *filter,
+              GtkCssNode             *node,
+              guint                  *n_matched)
+{
+  GtkCssLookup lookup;
+  GtkCssChange change;
+  GtkCssNode *child;
+  guint n_nodes = 1;
+
+  _gtk_css_lookup_init (&lookup);
+  gtk_style_provider_lookup (provider, filter, node, &lookup, &change);
+  if (!_gtk_bitmask_is_empty (_gtk_css_lookup_get_set_values (&lookup)))
+    (*n_matched)++;
+  _gtk_css_lookup_destroy (&lookup);
+
+  if (gtk_css_node_get_first_child (node) == NULL)
+    return n_nodes;
+
+  gtk_css_node_declaration_add_bloom_hashes (gtk_css_node_get_declaration (node), filter);
+
+  for (child = gtk_css_node_get_first_child (node);
+       child;
+       child = gtk_css_node_get_next_sibling (child))
+    n_nodes += lookup_nodes (provider, filter, child, n_matched);
+
+  gtk_css_node_declaration_remove_bloom_hashes (gtk_css_node_get_declaration (node), filter);
+
+  return n_nodes;
+}
+
+static void
+test_match_adwaita (void)
+{
+  GtkCountingBloomFilter filter = GTK_COUNTING_BLOOM_FILTER_INIT;
+  GtkCssProvider *provider;
+  GtkCssNode *window;
+  guint i, n_runs, n_nodes, n_matched;
+  gint64 start, end;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_named (provider, "Adwaita", NULL);
+
+  window = create_window (500);
+  n_runs = g_test_perf () ? 100 : 3;
+
+  n_nodes = 0;
+  n_matched = 0;
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_runs; i++)
+    n_nodes += lookup_nodes (GTK_STYLE_PROVIDER (provider), &filter, window, &n_matched);
+  end = g_get_monotonic_time ();
+
+  /* Most nodes in the tree have rules in Adwaita */
+  g_assert_cmpuint (n_matched, >, n_nodes / 2);
+
+  if (g_test_perf ())
+    g_test_maximized_result (n_nodes * (double) G_USEC_PER_SEC / MAX (1, end - start),
+                             "%u nodes matched in %.1fms", n_nodes, (end - start) / 1000.);
+  else
+    g_test_message ("%u nodes matched in %.1fms (%.0f matches/s)",
+                    n_nodes,
+                    (end - start) / 1000.,
+                    n_nodes * (double) G_USEC_PER_SEC / MAX (1, end - start));
+
+  g_object_unref (window);
+  g_object_unref (provider);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/css/match/adwaita", test_match_adwaita);
+
+  return g_test_run ();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+/* Parses the builtin themes from memory, so that neither file IO nor
+ * the compiled style sheet cache get in the way. Run with -m perf to
+ * get a useful number.
+ */
+
+static void
+parsing_error (GtkCssProvider *provider,
+               GtkCssSection  *section,
+               const GError   *error,
+               gpointer        user_data)
+{
+  char *s = gtk_css_section_to_string (section);
+
+  g_test_message ("%s: %s", s, error->message);
+  g_free (s);
+  g_test_fail ();
+}
+
+static void
+test_parse (gconstpointer data)
+{
+  const char *resource_path = data;
+  GtkCssProvider *provider;
+  GBytes *bytes;
+  GTimer *timer;
+  double best = G_MAXDOUBLE;
+  guint i, n_runs;
+
+  bytes = g_resources_lookup_data (resource_path, 0, NULL);
+  g_assert_nonnull (bytes);
+
+  provider = gtk_css_provider_new ();
+  g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error), NULL);
+
+  timer = g_timer_new ();
+  n_runs = g_test_perf () ? 50 : 1;
+
+  for (i = 0; i < n_runs; i++)
+    {
+      g_timer_start (timer);
+      gtk_css_provider_load_from_data (provider,
+                                       g_bytes_get_data (bytes, NULL),
+                                       g_bytes_get_size (bytes));
+      best = MIN (best, g_timer_elapsed (timer, NULL));
+    }
+
+  g_test_minimized_result (best, "%s: %.2f ms per parse", resource_path, best * 1000);
+
+  g_timer_destroy (timer);
+  g_object_unref (provider);
+  g_bytes_unref (bytes);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_data_func ("/css/parse/adwaita",
+                        "/org/gtk/libgtk/theme/Adwaita/Adwaita.css",
+                        test_parse);
+  g_test_add_data_func ("/css/parse/adwaita-dark",
+                        "/org/gtk/libgtk/theme/Adwaita/Adwaita-dark.css",
+                        test_parse);
+  g_test_add_data_func ("/css/parse/highcontrast",
+                        "/org/gtk/libgtk/theme/HighContrast/HighContrast.css",
+                        test_parse);
+
+  return g_test_run ();
+}
@@ -70,6 +70,54 @@ test_clipboard_basic (void)
   g_value_unset (&value);
 }
 
+/* Large formats use hash tables for lookups, so check that they
+ * behave the same as small ones.
+ */
+static void
+test_formats_many (void)
+{
+  GdkContentFormatsBuilder *builder;
+  GdkContentFormats *formats, *other;
+  const char * const *mime_types;
+  gsize i, n_mime_types;
+
+  builder = gdk_content_formats_builder_new ();
+  for (i = 0; i < 32; i++)
+    {
+      char *mime_type = g_strdup_printf ("application/x-test-%" G_GSIZE_FORMAT, i);
+
+      gdk_content_formats_builder_add_mime_type (builder, mime_type);
+      /* duplicates are ignored */
+      gdk_content_formats_builder_add_mime_type (builder, mime_type);
+      g_free (mime_type);
+    }
+  gdk_content_formats_builder_add_gtype (builder, G_TYPE_STRING);
+  formats = gdk_content_formats_builder_free_to_formats (builder);
+
+  mime_types = gdk_content_formats_get_mime_types (formats, &n_mime_types);
+  g_assert_cmpuint (n_mime_types, ==, 32);
+  g_assert_cmpstr (mime_types[0], ==, "application/x-test-0");
+  g_assert_cmpstr (mime_types[31], ==, "application/x-test-31");
+
+  g_assert_true (gdk_content_formats_contain_mime_type (formats, "application/x-test-0"));
+  g_assert_true (gdk_content_formats_contain_mime_type (formats, "application/x-test-31"));
+  g_assert_false (gdk_content_formats_contain_mime_type (formats, "application/x-test-32"));
+  g_assert_true (gdk_content_formats_contain_gtype (formats, G_TYPE_STRING));
+  g_assert_false (gdk_content_formats_contain_gtype (formats, G_TYPE_INT));
+
+  other = gdk_content_formats_new ((const char *[]) { "text/plain", "application/x-test-17" }, 2);
+  g_assert_cmpstr (gdk_content_formats_match_mime_type (other, formats), ==, "application/x-test-17");
+  g_assert_cmpstr (gdk_content_formats_match_mime_type (formats, other), ==, "application/x-test-17");
+  g_assert_true (gdk_content_formats_match (formats, other));
+  gdk_content_formats_unref (other);
+
+  other = gdk_content_formats_new ((const char *[]) { "text/plain" }, 1);
+  g_assert_false (gdk_content_formats_match (formats, other));
+  gdk_content_formats_unref (other);
+
+  gdk_content_formats_unref (formats);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -78,6 +126,7 @@ main (int argc, char *argv[])
   gtk_init ();
 
   g_test_add_func ("/clipboard/basic", test_clipboard_basic);
+  g_test_add_func ("/clipboard/formats-many", test_formats_many);
 
   return g_test_run ();
 }
@@ -173,6 +173,23 @@ test_download_4x4_with_stride (gconstpointer data)
   g_object_unref (test);
 }
 
+/* Wide enough to go through the vectorized conversions,
+ * with some pixels left over at the end of each row */
+static void
+test_download_37x3 (gconstpointer data)
+{
+  const TestData *test_data = data;
+  GdkTexture *expected, *test;
+
+  expected = create_texture (GDK_MEMORY_DEFAULT, test_data->color, 37, 3, 37 * 4);
+  test = create_texture (test_data->format, test_data->color, 37, 3, 37 * tests[test_data->format].bytes_per_pixel);
+
+  compare_textures (expected, test, tests[test_data->format].opaque);
+
+  g_object_unref (expected);
+  g_object_unref (test);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -223,6 +240,15 @@ main (int argc, char *argv[])
           test_data->color = color;
           g_test_add_data_func_full (test_name, test_data, test_download_4x4_with_stride, g_free);
           g_free (test_name);
+
+          test_data = g_new (TestData, 1);
+          test_name = g_strdup_printf ("/memorytexture/download_37x3/%s/%s",
+                                       g_enum_get_value (enum_class, format)->value_nick,
+                                       color_names[color]);
+          test_data->format = format;
+          test_data->color = color;
+          g_test_add_data_func_full (test_name, test_data, test_download_37x3, g_free);
+          g_free (test_name);
         }
     }
 
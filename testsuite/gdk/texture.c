@@ -106,6 +106,62 @@ test_texture_save_to_png (void)
   g_object_unref (texture2);
 }
 
+static void
+test_texture_from_file_at_size (void)
+{
+  GdkTexture *texture;
+  GError *error = NULL;
+  GFile *file;
+
+  file = g_file_new_for_uri ("resource:///org/gtk/libgtk/icons/16x16/places/user-trash.png");
+
+  texture = gdk_texture_new_from_file_at_size (file, 8, -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 8);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 8);
+  g_object_unref (texture);
+
+  /* Images are never scaled up */
+  texture = gdk_texture_new_from_file_at_size (file, 32, 32, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 16);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 16);
+  g_object_unref (texture);
+
+  g_object_unref (file);
+}
+
+static void
+texture_loaded (GObject      *source,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  GdkTexture **texture = data;
+  GError *error = NULL;
+
+  *texture = gdk_texture_new_from_file_at_size_finish (result, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_texture_from_file_at_size_async (void)
+{
+  GdkTexture *texture = NULL;
+  GFile *file;
+
+  file = g_file_new_for_uri ("resource:///org/gtk/libgtk/icons/16x16/places/user-trash.png");
+
+  gdk_texture_new_from_file_at_size_async (file, -1, 4, NULL, texture_loaded, &texture);
+  while (texture == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (gdk_texture_get_width (texture), ==, 4);
+  g_assert_cmpint (gdk_texture_get_height (texture), ==, 4);
+
+  g_object_unref (texture);
+  g_object_unref (file);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -115,6 +171,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/texture/from-pixbuf", test_texture_from_pixbuf);
   g_test_add_func ("/texture/from-resource", test_texture_from_resource);
   g_test_add_func ("/texture/save-to-png", test_texture_save_to_png);
+  g_test_add_func ("/texture/from-file-at-size", test_texture_from_file_at_size);
+  g_test_add_func ("/texture/from-file-at-size-async", test_texture_from_file_at_size_async);
 
   return g_test_run ();
 }
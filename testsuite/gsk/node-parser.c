@@ -156,6 +156,43 @@ deserialize_error_func (const GskParseLocation *start,
   g_string_append_c (errors, '\n');
 }
 
+/* Checks that the binary format round-trips to the same text.
+ * Cairo nodes are stored rasterized, so they can't be compared.
+ */
+static gboolean
+check_binary_roundtrip (GskRenderNode *node,
+                        GBytes        *text)
+{
+  GskRenderNode *loaded;
+  GBytes *binary, *loaded_text;
+  gboolean result;
+
+  if (strstr (g_bytes_get_data (text, NULL), "cairo {"))
+    return TRUE;
+
+  binary = gsk_render_node_serialize_binary (node);
+  loaded = gsk_render_node_deserialize (binary, NULL, NULL);
+  g_bytes_unref (binary);
+
+  if (loaded == NULL)
+    {
+      g_print ("Failed to load binary data\n");
+      return FALSE;
+    }
+
+  loaded_text = gsk_render_node_serialize (loaded);
+  gsk_render_node_unref (loaded);
+
+  result = g_bytes_equal (text, loaded_text);
+  if (!result)
+    g_print ("Binary round-trip doesn't match:\n%s\n",
+             (const char *) g_bytes_get_data (loaded_text, NULL));
+
+  g_bytes_unref (loaded_text);
+
+  return result;
+}
+
 static gboolean
 parse_node_file (GFile *file, gboolean generate)
 {
@@ -180,6 +217,10 @@ parse_node_file (GFile *file, gboolean generate)
   node = gsk_render_node_deserialize (bytes, deserialize_error_func, errors);
   g_bytes_unref (bytes);
   bytes = gsk_render_node_serialize (node);
+
+  if (!generate && !check_binary_roundtrip (node, bytes))
+    result = FALSE;
+
   gsk_render_node_unref (node);
 
   if (generate)
@@ -522,6 +522,78 @@ test_axis_aligned (void)
   gsk_transform_unref (transform);
 }
 
+/* Zoomable canvases nest lots of translations and scales, and
+ * renderers ask for the result of every step of the chain.
+ */
+static void
+test_nested (void)
+{
+  guint n_steps = g_test_perf () ? 1000 : 50;
+  guint n_runs = g_test_perf () ? 1000 : 1;
+  GskTransform **steps;
+  graphene_matrix_t expected, m, step;
+  graphene_rect_t bounds, expected_bounds;
+  graphene_rect_t r = GRAPHENE_RECT_INIT (-10, 10, 100, 50);
+  double elapsed;
+  guint i, j;
+
+  steps = g_new (GskTransform *, n_steps);
+  graphene_matrix_init_identity (&expected);
+
+  for (i = 0; i < n_steps; i++)
+    {
+      GskTransform *t = i > 0 ? gsk_transform_ref (steps[i - 1]) : NULL;
+
+      t = gsk_transform_translate (t, &GRAPHENE_POINT_INIT (1, -2));
+      t = gsk_transform_scale (t, i % 2 ? 1.25 : 0.8, i % 2 ? 0.8 : 1.25);
+      steps[i] = t;
+    }
+
+  for (i = 0; i < n_steps; i++)
+    {
+      g_assert_cmpint (gsk_transform_get_category (steps[i]), ==, GSK_TRANSFORM_CATEGORY_2D_AFFINE);
+
+      graphene_matrix_init_translate (&step, &GRAPHENE_POINT3D_INIT (1, -2, 0));
+      graphene_matrix_multiply (&step, &expected, &expected);
+      graphene_matrix_init_scale (&step, i % 2 ? 1.25 : 0.8, i % 2 ? 0.8 : 1.25, 1);
+      graphene_matrix_multiply (&step, &expected, &expected);
+
+      /* Twice, to check the flattened result too */
+      for (j = 0; j < 2; j++)
+        {
+          gsk_transform_to_matrix (steps[i], &m);
+          graphene_assert_fuzzy_matrix_equal (&m, &expected, 0.01);
+
+          gsk_transform_transform_bounds (steps[i], &r, &bounds);
+          graphene_matrix_transform_bounds (&expected, &r, &expected_bounds);
+          g_assert_true (graphene_fuzzy_equals (bounds.origin.x, expected_bounds.origin.x, 0.01));
+          g_assert_true (graphene_fuzzy_equals (bounds.origin.y, expected_bounds.origin.y, 0.01));
+          g_assert_true (graphene_fuzzy_equals (bounds.size.width, expected_bounds.size.width, 0.01));
+          g_assert_true (graphene_fuzzy_equals (bounds.size.height, expected_bounds.size.height, 0.01));
+        }
+    }
+
+  g_test_timer_start ();
+
+  for (j = 0; j < n_runs; j++)
+    {
+      for (i = 0; i < n_steps; i++)
+        {
+          gsk_transform_transform_bounds (steps[i], &r, &bounds);
+          gsk_transform_to_matrix (steps[i], &m);
+        }
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "querying %u nested transforms %u times: %gsec",
+                             n_steps, n_runs, elapsed);
+
+  for (i = 0; i < n_steps; i++)
+    gsk_transform_unref (steps[i]);
+  g_free (steps);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -535,6 +607,7 @@ main (int   argc,
   g_test_add_func ("/transform/invert", test_invert);
   g_test_add_func ("/transform/print-parse", test_print_parse);
   g_test_add_func ("/transform/check-axis-aligneness", test_axis_aligned);
+  g_test_add_func ("/transform/nested", test_nested);
 
   return g_test_run ();
 }
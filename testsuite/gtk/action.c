@@ -391,6 +391,76 @@ test_inheritance4 (void)
   g_object_unref (box_actions);
 }
 
+/* Check that repeated lookups of the same action notice
+ * when groups are inserted, removed or changed, and when
+ * the widget hierarchy changes.
+ */
+static void
+test_lookup_changes (void)
+{
+  GtkWidget *window;
+  GtkWidget *box;
+  GtkWidget *button;
+  GSimpleActionGroup *actions;
+  GActionEntry entries[] = {
+    { "action", activate, NULL, NULL, NULL },
+  };
+  GActionEntry more_entries[] = {
+    { "other", activate, NULL, NULL, NULL },
+  };
+  int activated = 0;
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  button = gtk_button_new ();
+
+  gtk_window_set_child (GTK_WINDOW (window), box);
+  gtk_box_append (GTK_BOX (box), button);
+
+  /* give the button a muxer of its own */
+  gtk_actionable_set_action_name (GTK_ACTIONABLE (button), "win.action");
+
+  actions = g_simple_action_group_new ();
+  g_action_map_add_action_entries (G_ACTION_MAP (actions),
+                                   entries, G_N_ELEMENTS (entries),
+                                   &activated);
+
+  g_assert_false (gtk_widget_activate_action (button, "win.action", NULL));
+
+  gtk_widget_insert_action_group (window, "win", G_ACTION_GROUP (actions));
+
+  g_assert_true (gtk_widget_activate_action (button, "win.action", NULL));
+  g_assert_true (gtk_widget_activate_action (button, "win.action", NULL));
+  g_assert_cmpint (activated, ==, 2);
+
+  g_assert_false (gtk_widget_activate_action (button, "win.other", NULL));
+  g_action_map_add_action_entries (G_ACTION_MAP (actions),
+                                   more_entries, G_N_ELEMENTS (more_entries),
+                                   &activated);
+  g_assert_true (gtk_widget_activate_action (button, "win.other", NULL));
+  g_assert_cmpint (activated, ==, 3);
+
+  g_action_map_remove_action (G_ACTION_MAP (actions), "other");
+  g_assert_false (gtk_widget_activate_action (button, "win.other", NULL));
+
+  g_object_ref (button);
+  gtk_box_remove (GTK_BOX (box), button);
+  g_assert_false (gtk_widget_activate_action (button, "win.action", NULL));
+
+  gtk_box_append (GTK_BOX (box), button);
+  g_object_unref (button);
+  g_assert_true (gtk_widget_activate_action (button, "win.action", NULL));
+  g_assert_cmpint (activated, ==, 4);
+
+  gtk_widget_insert_action_group (window, "win", NULL);
+  g_assert_false (gtk_widget_activate_action (button, "win.action", NULL));
+  g_assert_cmpint (activated, ==, 4);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+
+  g_object_unref (actions);
+}
+
 static int cut_activated;
 static int copy_activated;
 static int paste_activated;
@@ -727,6 +797,7 @@ main (int   argc,
   g_test_add_func ("/action/inheritance2", test_inheritance2);
   g_test_add_func ("/action/inheritance3", test_inheritance3);
   g_test_add_func ("/action/inheritance4", test_inheritance4);
+  g_test_add_func ("/action/lookup-changes", test_lookup_changes);
   g_test_add_func ("/action/text", test_text);
   g_test_add_func ("/action/overlap", test_overlap);
   g_test_add_func ("/action/overlap2", test_overlap2);
@@ -0,0 +1,124 @@
+/* Allocation tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define GTK_TYPE_GIZMO                 (gtk_gizmo_get_type ())
+#define GTK_GIZMO(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_GIZMO, GtkGizmo))
+
+typedef struct _GtkGizmo GtkGizmo;
+
+struct _GtkGizmo {
+  GtkWidget parent;
+
+  int n_allocations;
+};
+
+typedef GtkWidgetClass GtkGizmoClass;
+
+G_DEFINE_TYPE (GtkGizmo, gtk_gizmo, GTK_TYPE_WIDGET);
+
+static void
+gtk_gizmo_measure (GtkWidget      *widget,
+                   GtkOrientation  orientation,
+                   int             for_size,
+                   int            *minimum,
+                   int            *natural,
+                   int            *minimum_baseline,
+                   int            *natural_baseline)
+{
+  *minimum = 10;
+  *natural = 10;
+}
+
+static void
+gtk_gizmo_size_allocate (GtkWidget *widget,
+                         int        width,
+                         int        height,
+                         int        baseline)
+{
+  GtkGizmo *self = GTK_GIZMO (widget);
+
+  self->n_allocations++;
+}
+
+static void
+gtk_gizmo_class_init (GtkGizmoClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  widget_class->measure = gtk_gizmo_measure;
+  widget_class->size_allocate = gtk_gizmo_size_allocate;
+}
+
+static void
+gtk_gizmo_init (GtkGizmo *self)
+{
+}
+
+static void
+allocate (GtkWidget    *widget,
+          int           size,
+          GskTransform *transform)
+{
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_measure (widget, GTK_ORIENTATION_VERTICAL, -1, NULL, NULL, NULL, NULL);
+  gtk_widget_allocate (widget, size, size, -1, transform);
+}
+
+static void
+test_same_inputs (void)
+{
+  GtkGizmo *gizmo;
+
+  gizmo = g_object_new (GTK_TYPE_GIZMO, NULL);
+  g_object_ref_sink (gizmo);
+
+  allocate (GTK_WIDGET (gizmo), 20, NULL);
+  g_assert_cmpint (gizmo->n_allocations, ==, 1);
+
+  /* Same size and transform */
+  allocate (GTK_WIDGET (gizmo), 20, NULL);
+  g_assert_cmpint (gizmo->n_allocations, ==, 1);
+
+  /* Only the transform changes */
+  allocate (GTK_WIDGET (gizmo), 20,
+            gsk_transform_translate (NULL, &GRAPHENE_POINT_INIT (5, 5)));
+  g_assert_cmpint (gizmo->n_allocations, ==, 1);
+  g_assert_cmpint (gtk_widget_get_width (GTK_WIDGET (gizmo)), ==, 20);
+
+  /* The size changes */
+  allocate (GTK_WIDGET (gizmo), 30, NULL);
+  g_assert_cmpint (gizmo->n_allocations, ==, 2);
+  g_assert_cmpint (gtk_widget_get_width (GTK_WIDGET (gizmo)), ==, 30);
+
+  /* The widget asks for a new allocation */
+  gtk_widget_queue_allocate (GTK_WIDGET (gizmo));
+  allocate (GTK_WIDGET (gizmo), 30, NULL);
+  g_assert_cmpint (gizmo->n_allocations, ==, 3);
+
+  g_object_unref (gizmo);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/allocation/same-inputs", test_same_inputs);
+
+  return g_test_run ();
+}
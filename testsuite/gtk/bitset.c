@@ -555,6 +555,126 @@ test_splice_overflow (void)
   g_assert_true (gtk_bitset_equals (set, compare));
 }
 
+static void
+test_shift_bounds (void)
+{
+  GtkBitset *set, *compare;
+
+  /* values crossing container boundaries */
+  set = gtk_bitset_new_range (65530, 10);
+  gtk_bitset_add (set, 200000);
+  gtk_bitset_shift_right (set, 100);
+
+  compare = gtk_bitset_new_range (65630, 10);
+  gtk_bitset_add (compare, 200100);
+  g_assert_true (gtk_bitset_equals (set, compare));
+  gtk_bitset_unref (compare);
+
+  /* values shifted below 0 are dropped */
+  gtk_bitset_shift_left (set, 65635);
+
+  compare = gtk_bitset_new_range (0, 5);
+  gtk_bitset_add (compare, 200100 - 65635);
+  g_assert_true (gtk_bitset_equals (set, compare));
+  gtk_bitset_unref (compare);
+  gtk_bitset_unref (set);
+
+  /* values shifted above G_MAXUINT are dropped */
+  set = gtk_bitset_new_range (G_MAXUINT - 9, 10);
+  gtk_bitset_add (set, 3);
+  gtk_bitset_shift_right (set, 5);
+
+  compare = gtk_bitset_new_range (G_MAXUINT - 4, 5);
+  gtk_bitset_add (compare, 8);
+  g_assert_true (gtk_bitset_equals (set, compare));
+  gtk_bitset_unref (compare);
+  gtk_bitset_unref (set);
+}
+
+static void
+test_iter_ranges (void)
+{
+  GtkBitset *set;
+  GtkBitsetIter iter, single;
+  guint first, last, value;
+  guint values[8];
+  guint i, j, n;
+  gboolean valid;
+
+  set = gtk_bitset_new_empty ();
+
+  gtk_bitset_iter_init_first (&iter, set, NULL);
+  g_assert_false (gtk_bitset_iter_next_range (&iter, &first, &last));
+  g_assert_cmpuint (gtk_bitset_iter_read (&iter, values, G_N_ELEMENTS (values)), ==, 0);
+
+  /* a run crossing a container boundary, single values and a
+   * range reaching the end
+   */
+  gtk_bitset_add_range_closed (set, 65530, 65545);
+  gtk_bitset_add (set, 100000);
+  gtk_bitset_add (set, 100002);
+  gtk_bitset_add_range_closed (set, G_MAXUINT - 2, G_MAXUINT);
+
+  gtk_bitset_iter_init_first (&iter, set, NULL);
+  g_assert_true (gtk_bitset_iter_next_range (&iter, &first, &last));
+  g_assert_cmpuint (first, ==, 65530);
+  g_assert_cmpuint (last, ==, 65545);
+  g_assert_cmpuint (gtk_bitset_iter_get_value (&iter), ==, 100000);
+  g_assert_true (gtk_bitset_iter_next_range (&iter, &first, &last));
+  g_assert_cmpuint (first, ==, 100000);
+  g_assert_cmpuint (last, ==, 100000);
+  g_assert_true (gtk_bitset_iter_next_range (&iter, &first, &last));
+  g_assert_cmpuint (first, ==, 100002);
+  g_assert_cmpuint (last, ==, 100002);
+  g_assert_true (gtk_bitset_iter_next_range (&iter, &first, &last));
+  g_assert_cmpuint (first, ==, G_MAXUINT - 2);
+  g_assert_cmpuint (last, ==, G_MAXUINT);
+  g_assert_false (gtk_bitset_iter_is_valid (&iter));
+  g_assert_false (gtk_bitset_iter_next_range (&iter, &first, &last));
+
+  /* bulk reads continue where the iter is */
+  gtk_bitset_iter_init_at (&iter, set, 65540, NULL);
+  n = gtk_bitset_iter_read (&iter, values, G_N_ELEMENTS (values));
+  g_assert_cmpuint (n, ==, G_N_ELEMENTS (values));
+  for (i = 0; i < 6; i++)
+    g_assert_cmpuint (values[i], ==, 65540 + i);
+  g_assert_cmpuint (values[6], ==, 100000);
+  g_assert_cmpuint (values[7], ==, 100002);
+
+  n = gtk_bitset_iter_read (&iter, values, G_N_ELEMENTS (values));
+  g_assert_cmpuint (n, ==, 3);
+  g_assert_cmpuint (values[0], ==, G_MAXUINT - 2);
+  g_assert_cmpuint (values[2], ==, G_MAXUINT);
+  g_assert_false (gtk_bitset_iter_is_valid (&iter));
+
+  gtk_bitset_unref (set);
+
+  /* ranges cover the same values as single steps, for every kind of container */
+  set = gtk_bitset_new_empty ();
+  for (i = 0; i < 10000; i++)
+    gtk_bitset_add (set, g_test_rand_int_range (0, 1000000));
+  gtk_bitset_add_range (set, 300000, 200000);
+  for (i = 0; i < 65536; i += 2)
+    gtk_bitset_add (set, 700000 + i);
+
+  gtk_bitset_iter_init_first (&iter, set, NULL);
+  valid = gtk_bitset_iter_init_first (&single, set, &value);
+  while (gtk_bitset_iter_next_range (&iter, &first, &last))
+    {
+      g_assert_true (first == 0 || !gtk_bitset_contains (set, first - 1));
+      g_assert_false (gtk_bitset_contains (set, last + 1));
+      for (j = first; j <= last; j++)
+        {
+          g_assert_true (valid);
+          g_assert_cmpuint (value, ==, j);
+          valid = gtk_bitset_iter_next (&single, &value);
+        }
+    }
+  g_assert_false (valid);
+
+  gtk_bitset_unref (set);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -571,9 +691,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/bitset/subtract", test_subtract);
   g_test_add_func ("/bitset/shift-left", test_shift_left);
   g_test_add_func ("/bitset/shift-right", test_shift_right);
+  g_test_add_func ("/bitset/shift-bounds", test_shift_bounds);
   g_test_add_func ("/bitset/slice", test_slice);
   g_test_add_func ("/bitset/rectangle", test_rectangle);
   g_test_add_func ("/bitset/iter", test_iter);
+  g_test_add_func ("/bitset/iter-ranges", test_iter_ranges);
   g_test_add_func ("/bitset/splice-overflow", test_splice_overflow);
 
   return g_test_run ();
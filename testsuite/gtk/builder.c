@@ -2505,6 +2505,51 @@ test_expressions (void)
     }
 }
 
+static void
+test_lazy_bin (void)
+{
+  GtkBuilder *builder;
+  GObject *lazy, *label;
+  const char buffer[] =
+    "<interface>"
+    "  <object class=\"GtkStack\" id=\"stack\">"
+    "    <child>"
+    "      <object class=\"GtkLazyBin\" id=\"lazy\">"
+    "        <property name=\"bytes\"><![CDATA["
+    "<interface>"
+    "  <template class=\"GtkLazyBin\">"
+    "    <property name=\"child\">"
+    "      <object class=\"GtkLabel\" id=\"label\">"
+    "        <property name=\"label\">Lazy</property>"
+    "      </object>"
+    "    </property>"
+    "  </template>"
+    "</interface>"
+    "]]></property>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+
+  builder = builder_new_from_string (buffer, -1, NULL);
+  lazy = gtk_builder_get_object (builder, "lazy");
+  g_assert_true (GTK_IS_LAZY_BIN (lazy));
+
+  /* Nothing is created before the page is needed */
+  g_assert_null (gtk_lazy_bin_get_child (GTK_LAZY_BIN (lazy)));
+
+  gtk_lazy_bin_ensure_child (GTK_LAZY_BIN (lazy));
+  label = G_OBJECT (gtk_lazy_bin_get_child (GTK_LAZY_BIN (lazy)));
+  g_assert_true (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "Lazy");
+
+  /* Creating the child is only done once */
+  gtk_lazy_bin_ensure_child (GTK_LAZY_BIN (lazy));
+  g_assert_true (G_OBJECT (gtk_lazy_bin_get_child (GTK_LAZY_BIN (lazy))) == label);
+
+  g_object_unref (builder);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2552,6 +2597,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Shortcuts", test_shortcuts);
   g_test_add_func ("/Builder/Transforms", test_transforms);
   g_test_add_func ("/Builder/Expressions", test_expressions);
+  g_test_add_func ("/Builder/LazyBin", test_lazy_bin);
 
   return g_test_run();
 }
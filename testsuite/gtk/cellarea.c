@@ -302,6 +302,48 @@ test_completion_object_new (void)
   g_object_unref (c);
 }
 
+/* test that the sizes of a text renderer follow its text */
+static void
+test_text_renderer_measure (void)
+{
+  GtkCellRenderer *cell;
+  GtkWidget *widget;
+  int short_width, long_width, width;
+
+  cell = gtk_cell_renderer_text_new ();
+  g_object_ref_sink (cell);
+  widget = gtk_label_new (NULL);
+  g_object_ref_sink (widget);
+
+  g_object_set (cell, "text", "Short", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &short_width);
+
+  g_object_set (cell, "text", "A much longer text", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &long_width);
+  g_assert_cmpint (long_width, >, short_width);
+
+  /* Setting a value that doesn't change the size */
+  g_object_set (cell, "foreground", "red", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &width);
+  g_assert_cmpint (width, ==, long_width);
+
+  g_object_set (cell, "text", "Short", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &width);
+  g_assert_cmpint (width, ==, short_width);
+
+  /* Markup attributes go away with the markup */
+  g_object_set (cell, "markup", "<big><big>Short</big></big>", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &width);
+  g_assert_cmpint (width, >, short_width);
+
+  g_object_set (cell, "text", "Short", NULL);
+  gtk_cell_renderer_get_preferred_width (cell, widget, NULL, &width);
+  g_assert_cmpint (width, ==, short_width);
+
+  g_object_unref (widget);
+  g_object_unref (cell);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -328,5 +370,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/tests/completion-new-with-area", test_completion_new_with_area);
   g_test_add_func ("/tests/completion-object-new", test_completion_object_new);
 
+  g_test_add_func ("/tests/text-renderer-measure", test_text_renderer_measure);
+
   return g_test_run();
 }
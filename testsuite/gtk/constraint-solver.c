@@ -282,6 +282,47 @@ constraint_solver_edit_var_suggest (void)
   g_object_unref (solver);
 }
 
+static void
+constraint_solver_edit_var_persistent (void)
+{
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+
+  GtkConstraintVariable *a = gtk_constraint_solver_create_variable (solver, NULL, "a", 0.0);
+  GtkConstraintVariable *b = gtk_constraint_solver_create_variable (solver, NULL, "b", 0.0);
+
+  GtkConstraintExpression *e = gtk_constraint_expression_new_from_variable (b);
+  gtk_constraint_solver_add_constraint (solver,
+                                        a, GTK_CONSTRAINT_RELATION_EQ, e,
+                                        GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  gtk_constraint_solver_add_edit_variable (solver, a, GTK_CONSTRAINT_STRENGTH_MEDIUM);
+
+  gtk_constraint_solver_begin_edit (solver);
+  gtk_constraint_solver_suggest_value (solver, a, 5.0);
+  gtk_constraint_solver_end_edit (solver);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (a), 5.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (b), 5.0, 0.001);
+
+  /* The edit variable survives the end of the edit phase */
+  g_assert_true (gtk_constraint_solver_has_edit_variable (solver, a));
+
+  gtk_constraint_solver_begin_edit (solver);
+  gtk_constraint_solver_suggest_value (solver, a, 8.0);
+  gtk_constraint_solver_end_edit (solver);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (a), 8.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (b), 8.0, 0.001);
+
+  gtk_constraint_solver_remove_edit_variable (solver, a);
+  g_assert_false (gtk_constraint_solver_has_edit_variable (solver, a));
+
+  gtk_constraint_variable_unref (a);
+  gtk_constraint_variable_unref (b);
+
+  g_object_unref (solver);
+}
+
 static void
 constraint_solver_paper (void)
 {
@@ -376,6 +417,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/constraint-solver/cassowary", constraint_solver_cassowary);
   g_test_add_func ("/constraint-solver/edit/required", constraint_solver_edit_var_required);
   g_test_add_func ("/constraint-solver/edit/suggest", constraint_solver_edit_var_suggest);
+  g_test_add_func ("/constraint-solver/edit/persistent", constraint_solver_edit_var_persistent);
 
   return g_test_run ();
 }
@@ -376,6 +376,142 @@ test_incremental (void)
   g_object_unref (filter);
 }
 
+/* Enough items for the string filter to be matched in multiple threads */
+static void
+test_string_filter (gconstpointer data)
+{
+  gboolean incremental = GPOINTER_TO_INT (data);
+  GtkFilterListModel *filter;
+  GtkStringFilter *string_filter;
+  GtkStringList *list;
+  const guint n_items = 20000;
+  guint i, n_expected;
+  char *s;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      s = g_strdup_printf ("%s %u", i % 3 ? "Ünïcode" : "ascii", i);
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  string_filter = gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  gtk_string_filter_set_search (string_filter, "ÜNÏ");
+  filter = gtk_filter_list_model_new (G_LIST_MODEL (list), GTK_FILTER (string_filter));
+  gtk_filter_list_model_set_incremental (filter, incremental);
+
+  while (gtk_filter_list_model_get_pending (filter) != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  n_expected = n_items - (n_items + 2) / 3;
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      GtkStringObject *object = g_list_model_get_item (G_LIST_MODEL (filter), i);
+      g_assert_true (g_str_has_prefix (gtk_string_object_get_string (object), "Ünïcode"));
+      g_object_unref (object);
+    }
+
+  g_object_unref (filter);
+}
+
+static guint n_evaluations;
+
+static char *
+count_evaluations (GtkStringObject *object)
+{
+  n_evaluations++;
+
+  return g_strdup (gtk_string_object_get_string (object));
+}
+
+static guint
+count_containing (GListModel *model,
+                  const char *search)
+{
+  guint i, n;
+
+  n = 0;
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    {
+      GtkStringObject *object = g_list_model_get_item (model, i);
+      if (g_strstr_len (gtk_string_object_get_string (object), -1, search))
+        n++;
+      g_object_unref (object);
+    }
+
+  return n;
+}
+
+static void
+test_string_filter_refine (void)
+{
+  GtkFilterListModel *filter;
+  GtkStringFilter *string_filter;
+  GtkStringList *list;
+  GtkExpression *expression;
+  GtkStringSorter *sorter;
+  GtkSortListModel *sort;
+  const guint n_items = 3000;
+  guint i;
+  char *s;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      s = g_strdup_printf ("item %u", i);
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  expression = gtk_cclosure_expression_new (G_TYPE_STRING, NULL,
+                                            0, NULL,
+                                            G_CALLBACK (count_evaluations),
+                                            NULL, NULL);
+  string_filter = gtk_string_filter_new (expression);
+  filter = gtk_filter_list_model_new (G_LIST_MODEL (list), GTK_FILTER (string_filter));
+
+  n_evaluations = 0;
+  gtk_string_filter_set_search (string_filter, "1");
+  g_assert_cmpuint (n_evaluations, ==, n_items);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, count_containing (G_LIST_MODEL (list), "1"));
+
+  /* refining compares the cached strings of the current matches */
+  gtk_string_filter_set_search (string_filter, "12");
+  gtk_string_filter_set_search (string_filter, "123");
+  g_assert_cmpuint (n_evaluations, ==, n_items);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, count_containing (G_LIST_MODEL (list), "123"));
+
+  /* going back restores previous results */
+  gtk_string_filter_set_search (string_filter, "12");
+  g_assert_cmpuint (n_evaluations, ==, n_items);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, count_containing (G_LIST_MODEL (list), "12"));
+
+  /* changing the items drops the results, but not the strings */
+  gtk_string_list_append (list, "item 12345");
+  gtk_string_filter_set_search (string_filter, "1");
+  g_assert_cmpuint (n_evaluations, ==, n_items + 1);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, count_containing (G_LIST_MODEL (list), "1"));
+
+  /* the strings are kept for new searches */
+  gtk_string_filter_set_search (string_filter, NULL);
+  gtk_string_filter_set_search (string_filter, "2");
+  g_assert_cmpuint (n_evaluations, ==, n_items + 1);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, count_containing (G_LIST_MODEL (list), "2"));
+
+  /* and shared with sorters using the same expression */
+  sorter = gtk_string_sorter_new (gtk_expression_ref (expression));
+  sort = gtk_sort_list_model_new (G_LIST_MODEL (g_object_ref (list)), GTK_SORTER (sorter));
+  g_assert_cmpuint (n_evaluations, ==, n_items + 1);
+  gtk_string_sorter_set_ignore_case (sorter, FALSE);
+  g_assert_cmpuint (n_evaluations, ==, n_items + 1);
+
+  g_object_unref (sort);
+  g_object_unref (filter);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -389,6 +525,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/empty_set_filter", test_empty_set_filter);
   g_test_add_func ("/filterlistmodel/change_filter", test_change_filter);
   g_test_add_func ("/filterlistmodel/incremental", test_incremental);
+  g_test_add_data_func ("/filterlistmodel/string-filter", GINT_TO_POINTER (FALSE), test_string_filter);
+  g_test_add_data_func ("/filterlistmodel/incremental/string-filter", GINT_TO_POINTER (TRUE), test_string_filter);
+  g_test_add_func ("/filterlistmodel/string-filter/refine", test_string_filter_refine);
 
   return g_test_run ();
 }
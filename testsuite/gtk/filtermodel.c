@@ -5549,6 +5549,70 @@ specific_list_store_clear (void)
   gtk_list_store_clear (list);
 }
 
+static int refilter_path_hidden_value;
+
+static gboolean
+specific_refilter_path_visible_func (GtkTreeModel *model,
+                                     GtkTreeIter  *iter,
+                                     gpointer      data)
+{
+  int value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value != refilter_path_hidden_value;
+}
+
+static void
+specific_refilter_path (void)
+{
+  GtkTreeIter iter, child;
+  GtkTreeStore *tree;
+  GtkTreeModel *filter;
+  GtkTreePath *path;
+  GtkWidget *view G_GNUC_UNUSED;
+  int i;
+
+  tree = gtk_tree_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 3; i++)
+    {
+      gtk_tree_store_insert_with_values (tree, &iter, NULL, i, 0, i, -1);
+      gtk_tree_store_insert_with_values (tree, &child, &iter, 0, 0, 10, -1);
+      gtk_tree_store_insert_with_values (tree, &child, &iter, 1, 0, 20, -1);
+    }
+
+  refilter_path_hidden_value = -1;
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (tree), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          specific_refilter_path_visible_func,
+                                          NULL, NULL);
+  view = gtk_tree_view_new_with_model (filter);
+  gtk_tree_view_expand_all (GTK_TREE_VIEW (view));
+
+  /* Only the rows below the given path are re-evaluated */
+  refilter_path_hidden_value = 10;
+  path = gtk_tree_path_new_from_indices (1, -1);
+  gtk_tree_model_filter_refilter_path (GTK_TREE_MODEL_FILTER (filter), path);
+  gtk_tree_path_free (path);
+
+  for (i = 0; i < 3; i++)
+    {
+      gtk_tree_model_iter_nth_child (filter, &iter, NULL, i);
+      g_assert_cmpint (gtk_tree_model_iter_n_children (filter, &iter), ==, i == 1 ? 1 : 2);
+    }
+
+  /* The row itself is re-evaluated too */
+  refilter_path_hidden_value = 1;
+  path = gtk_tree_path_new_from_indices (1, -1);
+  gtk_tree_model_filter_refilter_path (GTK_TREE_MODEL_FILTER (filter), path);
+  gtk_tree_path_free (path);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 2);
+
+  g_object_unref (filter);
+  g_object_unref (tree);
+}
+
 static void
 specific_sort_ref_leaf_and_remove_ancestor (void)
 {
@@ -7149,6 +7213,8 @@ register_filter_model_tests (void)
                    specific_filter_add_child);
   g_test_add_func ("/TreeModelFilter/specific/list-store-clear",
                    specific_list_store_clear);
+  g_test_add_func ("/TreeModelFilter/specific/refilter-path",
+                   specific_refilter_path);
   g_test_add_func ("/TreeModelFilter/specific/sort-ref-leaf-and-remove-ancestor",
                    specific_sort_ref_leaf_and_remove_ancestor);
   g_test_add_func ("/TreeModelFilter/specific/ref-leaf-and-remove-ancestor",
@@ -48,12 +48,78 @@ test_measure_crash (void)
   gtk_window_destroy (GTK_WINDOW (window));
 }
 
+static GtkWidget *
+create_label (gpointer item,
+              gpointer user_data)
+{
+  return gtk_label_new (g_object_get_data (item, "name"));
+}
+
+static guint
+count_children (GtkWidget *widget)
+{
+  GtkWidget *child;
+  guint n = 0;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    n++;
+
+  return n;
+}
+
+static void
+test_bind_model (void)
+{
+  GtkWidget *box;
+  GListStore *store;
+  GtkFlowBoxChild *child;
+  guint i;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  for (i = 0; i < 20000; i++)
+    {
+      GObject *item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_object_set_data_full (item, "name", g_strdup_printf ("%u", i), g_free);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  box = gtk_flow_box_new ();
+  g_object_ref_sink (box);
+  gtk_flow_box_bind_model (GTK_FLOW_BOX (box), G_LIST_MODEL (store), create_label, NULL, NULL);
+  g_assert_cmpuint (count_children (box), >, 0);
+
+  /* asking for a child creates it right away */
+  child = gtk_flow_box_get_child_at_index (GTK_FLOW_BOX (box), 10000);
+  g_assert_nonnull (child);
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (gtk_flow_box_child_get_child (child))), ==, "10000");
+
+  /* changes to items with and without children */
+  g_list_store_remove (store, 15000);
+  g_list_store_remove (store, 5000);
+
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpuint (count_children (box), ==, 19998);
+
+  child = gtk_flow_box_get_child_at_index (GTK_FLOW_BOX (box), 15000);
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (gtk_flow_box_child_get_child (child))), ==, "15002");
+
+  gtk_flow_box_bind_model (GTK_FLOW_BOX (box), NULL, NULL, NULL, NULL);
+  g_assert_cmpuint (count_children (box), ==, 0);
+
+  g_object_unref (box);
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/flowbox/measure-crash", test_measure_crash);
+  g_test_add_func ("/flowbox/bind-model", test_bind_model);
 
   return g_test_run ();
 }
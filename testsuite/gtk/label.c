@@ -0,0 +1,109 @@
+/* GtkLabel tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define TEXT "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do " \
+             "eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim " \
+             "ad minim veniam, quis nostrud exercitation ullamco laboris."
+
+static GtkWidget *
+create_label (void)
+{
+  GtkWidget *label;
+
+  label = gtk_label_new (TEXT);
+  gtk_label_set_wrap (GTK_LABEL (label), TRUE);
+  g_object_ref_sink (label);
+
+  return label;
+}
+
+static int
+measure_height (GtkWidget *label,
+                int        width)
+{
+  int height;
+
+  gtk_widget_measure (label, GTK_ORIENTATION_VERTICAL, width, &height, NULL, NULL, NULL);
+
+  return height;
+}
+
+/* Measuring a label at many widths must give the same heights
+ * as measuring a fresh label at each of them */
+static void
+test_height_for_width (void)
+{
+  GtkWidget *label;
+  int width, natural;
+
+  label = create_label ();
+  gtk_widget_measure (label, GTK_ORIENTATION_HORIZONTAL, -1, NULL, &natural, NULL, NULL);
+
+  for (width = natural + 50; width > 20; width -= 7)
+    {
+      GtkWidget *fresh = create_label ();
+
+      g_assert_cmpint (measure_height (label, width), ==, measure_height (fresh, width));
+
+      g_object_unref (fresh);
+    }
+
+  /* And again in the other direction */
+  for (width = 20; width < natural + 50; width += 11)
+    {
+      GtkWidget *fresh = create_label ();
+
+      g_assert_cmpint (measure_height (label, width), ==, measure_height (fresh, width));
+
+      g_object_unref (fresh);
+    }
+
+  g_object_unref (label);
+}
+
+static void
+test_height_for_width_text_change (void)
+{
+  GtkWidget *label, *fresh;
+  int height;
+
+  label = create_label ();
+  height = measure_height (label, 200);
+
+  gtk_label_set_text (GTK_LABEL (label), "Short");
+  fresh = gtk_label_new ("Short");
+  gtk_label_set_wrap (GTK_LABEL (fresh), TRUE);
+  g_object_ref_sink (fresh);
+
+  g_assert_cmpint (measure_height (label, 200), ==, measure_height (fresh, 200));
+  g_assert_cmpint (measure_height (label, 200), <, height);
+
+  g_object_unref (fresh);
+  g_object_unref (label);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/label/height-for-width", test_height_for_width);
+  g_test_add_func ("/label/height-for-width-text-change", test_height_for_width_text_change);
+
+  return g_test_run ();
+}
@@ -89,6 +89,74 @@ test_sort (void)
   g_object_unref (list);
 }
 
+static gboolean
+is_sorted (GtkListBox *list)
+{
+  GtkListBoxRow *row;
+  int i, value, last = G_MININT;
+
+  for (i = 0; (row = gtk_list_box_get_row_at_index (list, i)); i++)
+    {
+      value = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (gtk_list_box_row_get_child (row)), "data"));
+      if (value < last)
+        return FALSE;
+      last = value;
+    }
+
+  return TRUE;
+}
+
+static void
+test_queue_changed (void)
+{
+  GtkWidget *window;
+  GtkListBox *list;
+  GtkListBoxRow *row;
+  GtkWidget *label;
+  gint64 end;
+  int i, count;
+
+  window = gtk_window_new ();
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  gtk_window_set_child (GTK_WINDOW (window), GTK_WIDGET (list));
+
+  for (i = 0; i < 100; i++)
+    {
+      label = gtk_label_new ("");
+      g_object_set_data (G_OBJECT (label), "data", GINT_TO_POINTER (i));
+      gtk_list_box_insert (list, label, -1);
+    }
+
+  count = 0;
+  gtk_list_box_set_sort_func (list, sort_list, &count, NULL);
+  gtk_widget_show (window);
+
+  /* reverse the order of some rows */
+  for (i = 0; i < 10; i++)
+    {
+      row = gtk_list_box_get_row_at_index (list, i * 10);
+      g_object_set_data (G_OBJECT (gtk_list_box_row_get_child (row)), "data", GINT_TO_POINTER (1000 - i));
+      gtk_list_box_row_queue_changed (row);
+      gtk_list_box_row_queue_changed (row);
+    }
+
+  /* nothing happens until the next frame */
+  count = 0;
+  g_assert_false (is_sorted (list));
+
+  end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+  while (!is_sorted (list))
+    {
+      g_assert_cmpint (g_get_monotonic_time (), <, end);
+      g_main_context_iteration (NULL, TRUE);
+    }
+
+  g_assert_cmpint (count, >, 0);
+  check_sorted (list);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
 static GtkListBoxRow *callback_row;
 
 static void
@@ -448,6 +516,7 @@ main (int argc, char *argv[])
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/listbox/sort", test_sort);
+  g_test_add_func ("/listbox/queue-changed", test_queue_changed);
   g_test_add_func ("/listbox/selection", test_selection);
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
@@ -0,0 +1,220 @@
+/*
+ * Copyright © 2021 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#include "../../gtk/gtkwidgetprivate.h"
+
+#define SIZE 1000
+
+static GtkWidget *
+create_window (GtkWidget *fixed)
+{
+  GtkWidget *window;
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), SIZE, SIZE);
+  gtk_window_set_child (GTK_WINDOW (window), fixed);
+  gtk_widget_set_size_request (fixed, SIZE, SIZE);
+  gtk_window_present (GTK_WINDOW (window));
+
+  while (!gtk_widget_get_mapped (fixed) ||
+         gtk_widget_get_width (fixed) < SIZE)
+    g_main_context_iteration (NULL, TRUE);
+
+  return window;
+}
+
+static void
+add_children (GtkWidget *fixed,
+              guint      n_children)
+{
+  guint i;
+
+  for (i = 0; i < n_children; i++)
+    {
+      GtkWidget *child = gtk_label_new (NULL);
+
+      gtk_widget_set_size_request (child,
+                                   g_test_rand_int_range (1, 50),
+                                   g_test_rand_int_range (1, 50));
+      gtk_fixed_put (GTK_FIXED (fixed), child,
+                     g_test_rand_int_range (0, SIZE - 50),
+                     g_test_rand_int_range (0, SIZE - 50));
+    }
+}
+
+static void
+update_layout (GtkWidget *widget)
+{
+  while (gtk_widget_needs_allocate (widget))
+    g_main_context_iteration (NULL, TRUE);
+}
+
+/* Pick everywhere with and without the index and check
+ * that both find the same widgets
+ */
+static void
+assert_picks_match (GtkWidget *fixed)
+{
+  GtkWidget *expected[SIZE / 7 + 1][SIZE / 7 + 1];
+  int x, y;
+
+  gtk_widget_set_use_pick_index (fixed, FALSE);
+
+  for (y = 0; y < SIZE; y += 7)
+    for (x = 0; x < SIZE; x += 7)
+      expected[y / 7][x / 7] = gtk_widget_pick (fixed, x + 0.5, y + 0.5, GTK_PICK_DEFAULT);
+
+  gtk_widget_set_use_pick_index (fixed, TRUE);
+
+  for (y = 0; y < SIZE; y += 7)
+    for (x = 0; x < SIZE; x += 7)
+      g_assert_true (gtk_widget_pick (fixed, x + 0.5, y + 0.5, GTK_PICK_DEFAULT) == expected[y / 7][x / 7]);
+}
+
+static void
+test_pick_matches (void)
+{
+  GtkWidget *window, *fixed;
+
+  fixed = gtk_fixed_new ();
+  add_children (fixed, 500);
+  window = create_window (fixed);
+
+  assert_picks_match (fixed);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+test_pick_relayout (void)
+{
+  GtkWidget *window, *fixed, *child;
+  guint i;
+
+  fixed = gtk_fixed_new ();
+  add_children (fixed, 200);
+  window = create_window (fixed);
+
+  /* Build the index */
+  gtk_widget_pick (fixed, 1, 1, GTK_PICK_DEFAULT);
+
+  for (i = 0; i < 10; i++)
+    {
+      child = gtk_widget_get_first_child (fixed);
+      gtk_fixed_move (GTK_FIXED (fixed), child,
+                      g_test_rand_int_range (0, SIZE - 50),
+                      g_test_rand_int_range (0, SIZE - 50));
+
+      child = gtk_widget_get_last_child (fixed);
+      gtk_widget_insert_after (child, fixed, NULL);
+
+      child = gtk_widget_get_first_child (fixed);
+      gtk_fixed_remove (GTK_FIXED (fixed), child);
+
+      add_children (fixed, 1);
+
+      update_layout (fixed);
+      assert_picks_match (fixed);
+    }
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+test_pick_overflow (void)
+{
+  GtkWidget *window, *fixed, *inner, *child;
+
+  fixed = gtk_fixed_new ();
+  add_children (fixed, 100);
+
+  /* A child that picks outside of its allocation */
+  inner = gtk_fixed_new ();
+  gtk_widget_set_overflow (inner, GTK_OVERFLOW_VISIBLE);
+  gtk_fixed_put (GTK_FIXED (fixed), inner, 300, 300);
+  child = gtk_label_new (NULL);
+  gtk_widget_set_size_request (child, 20, 20);
+  gtk_fixed_put (GTK_FIXED (inner), child, -200, -200);
+
+  window = create_window (fixed);
+
+  g_assert_true (gtk_widget_pick (fixed, 110, 110, GTK_PICK_DEFAULT) == child);
+  assert_picks_match (fixed);
+
+  /* and one that gets moved around by a 3D transform */
+  child = gtk_widget_get_first_child (fixed);
+  gtk_fixed_set_child_transform (GTK_FIXED (fixed), child,
+                                 gsk_transform_perspective (gsk_transform_rotate_3d (NULL, 30, graphene_vec3_y_axis ()), 500));
+  update_layout (fixed);
+  assert_picks_match (fixed);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static void
+test_pick_performance (void)
+{
+  GtkWidget *window, *fixed;
+  guint n_children = g_test_perf () ? 5000 : 100;
+  guint n_picks = g_test_perf () ? 100000 : 1000;
+  double elapsed, indexed_elapsed;
+  guint i;
+
+  fixed = gtk_fixed_new ();
+  add_children (fixed, n_children);
+  window = create_window (fixed);
+
+  gtk_widget_set_use_pick_index (fixed, FALSE);
+
+  g_test_timer_start ();
+  for (i = 0; i < n_picks; i++)
+    gtk_widget_pick (fixed, i % SIZE, (i * 7) % SIZE, GTK_PICK_DEFAULT);
+  elapsed = g_test_timer_elapsed ();
+
+  gtk_widget_set_use_pick_index (fixed, TRUE);
+
+  g_test_timer_start ();
+  for (i = 0; i < n_picks; i++)
+    gtk_widget_pick (fixed, i % SIZE, (i * 7) % SIZE, GTK_PICK_DEFAULT);
+  indexed_elapsed = g_test_timer_elapsed ();
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (elapsed, "%u picks in %u children: %gsec",
+                               n_picks, n_children, elapsed);
+      g_test_minimized_result (indexed_elapsed, "%u indexed picks in %u children: %gsec",
+                               n_picks, n_children, indexed_elapsed);
+    }
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/pick/matches", test_pick_matches);
+  g_test_add_func ("/pick/relayout", test_pick_relayout);
+  g_test_add_func ("/pick/overflow", test_pick_overflow);
+  g_test_add_func ("/pick/performance", test_pick_performance);
+
+  return g_test_run ();
+}
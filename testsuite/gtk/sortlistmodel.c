@@ -18,6 +18,7 @@
  */
 
 #include <locale.h>
+#include <math.h>
 
 #include <gtk/gtk.h>
 
@@ -517,6 +518,181 @@ test_incremental_remove (void)
   g_object_unref (removed);
 }
 
+static GListStore *
+new_shuffled_string_store (guint size)
+{
+  GListStore *store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  guint i;
+
+  for (i = 0; i < size; i++)
+    {
+      GtkStringObject *object;
+      char *string;
+
+      string = g_strdup_printf ("item %08u", i + 1);
+      object = gtk_string_object_new (string);
+      g_object_set_qdata (G_OBJECT (object), number_quark, GUINT_TO_POINTER (i + 1));
+      g_list_store_insert (store, g_random_int_range (0, i + 1), object);
+      g_object_unref (object);
+      g_free (string);
+    }
+
+  return store;
+}
+
+/* Large enough to have sort keys created and sorted in multiple threads */
+static void
+test_string_sorter (gconstpointer data)
+{
+  gboolean incremental = GPOINTER_TO_INT (data);
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  const guint n_items = 50000;
+  guint i;
+
+  store = new_shuffled_string_store (n_items);
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  model = gtk_sort_list_model_new (NULL, sorter);
+  gtk_sort_list_model_set_incremental (model, incremental);
+  gtk_sort_list_model_set_model (model, G_LIST_MODEL (store));
+
+  while (gtk_sort_list_model_get_pending (model) != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items);
+
+  for (i = 0; i < n_items; i++)
+    g_assert_cmpuint (i + 1, ==, get (G_LIST_MODEL (model), i));
+
+  g_object_unref (store);
+  g_object_unref (model);
+}
+
+static int
+get_bucket (GObject *object)
+{
+  return (int) (GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)) % 7) - 3;
+}
+
+static double
+get_fraction (GObject *object)
+{
+  guint number = GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
+
+  if (number % 100 == 0)
+    return NAN;
+
+  return number % 2 ? number / 2.0 : - (double) number;
+}
+
+static int
+compare_numeric (guint n1,
+                 guint n2)
+{
+  int b1 = (int) (n1 % 7) - 3, b2 = (int) (n2 % 7) - 3;
+  double f1 = n1 % 100 == 0 ? NAN : n1 % 2 ? n1 / 2.0 : - (double) n1;
+  double f2 = n2 % 100 == 0 ? NAN : n2 % 2 ? n2 / 2.0 : - (double) n2;
+
+  /* bucket descending, fraction ascending with NaN last */
+  if (b1 != b2)
+    return b1 > b2 ? -1 : 1;
+  if (isnan (f1) || isnan (f2))
+    return (isnan (f1) ? 1 : 0) - (isnan (f2) ? 1 : 0);
+  return f1 < f2 ? -1 : f1 > f2 ? 1 : 0;
+}
+
+/* Numeric keys get combined into one memcmp()-able key and radix sorted */
+static void
+test_numeric_sorter (void)
+{
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkMultiSorter *sorter;
+  GtkSorter *numeric;
+  const guint n_items = 20000;
+  guint i;
+
+  store = new_shuffled_store (n_items);
+
+  sorter = gtk_multi_sorter_new ();
+  numeric = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_INT, NULL, 0, NULL,
+                                                                             G_CALLBACK (get_bucket),
+                                                                             NULL, NULL)));
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (numeric), GTK_SORT_DESCENDING);
+  gtk_multi_sorter_append (sorter, numeric);
+  numeric = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_DOUBLE, NULL, 0, NULL,
+                                                                             G_CALLBACK (get_fraction),
+                                                                             NULL, NULL)));
+  gtk_multi_sorter_append (sorter, numeric);
+
+  model = gtk_sort_list_model_new (G_LIST_MODEL (store), GTK_SORTER (sorter));
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items);
+
+  for (i = 1; i < n_items; i++)
+    {
+      guint n1 = get (G_LIST_MODEL (model), i - 1);
+      guint n2 = get (G_LIST_MODEL (model), i);
+      int result = compare_numeric (n1, n2);
+
+      /* ties are stable */
+      g_assert_cmpint (result, <=, 0);
+    }
+
+  g_object_unref (model);
+}
+
+/* Inverting the sorter reverses the items, but items that compare
+ * equal keep the order of the model
+ */
+static void
+test_invert_sorter (void)
+{
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  const guint n_items = 1000;
+  guint i, j;
+
+  store = new_empty_store ();
+  for (i = 1; i <= n_items; i++)
+    add (store, i);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_INT, NULL, 0, NULL,
+                                                                            G_CALLBACK (get_bucket),
+                                                                            NULL, NULL)));
+  model = gtk_sort_list_model_new (G_LIST_MODEL (store), g_object_ref (sorter));
+
+  for (j = 0; j < 3; j++)
+    {
+      gboolean descending = j % 2 == 0;
+
+      gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter),
+                                         descending ? GTK_SORT_DESCENDING : GTK_SORT_ASCENDING);
+
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items);
+
+      for (i = 1; i < n_items; i++)
+        {
+          guint n1 = get (G_LIST_MODEL (model), i - 1);
+          guint n2 = get (G_LIST_MODEL (model), i);
+          int b1 = (int) (n1 % 7) - 3;
+          int b2 = (int) (n2 % 7) - 3;
+
+          if (b1 == b2)
+            g_assert_cmpuint (n1, <, n2);
+          else if (descending)
+            g_assert_cmpint (b1, >, b2);
+          else
+            g_assert_cmpint (b1, <, b2);
+        }
+    }
+
+  g_object_unref (sorter);
+  g_object_unref (model);
+}
+
 static void
 test_out_of_bounds_access (void)
 {
@@ -554,6 +730,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/sortlistmodel/stability", test_stability);
   g_test_add_func ("/sortlistmodel/incremental/remove", test_incremental_remove);
   g_test_add_func ("/sortlistmodel/oob-access", test_out_of_bounds_access);
+  g_test_add_func ("/sortlistmodel/numeric-sorter", test_numeric_sorter);
+  g_test_add_func ("/sortlistmodel/invert-sorter", test_invert_sorter);
+  g_test_add_data_func ("/sortlistmodel/string-sorter", GINT_TO_POINTER (FALSE), test_string_sorter);
+  g_test_add_data_func ("/sortlistmodel/incremental/string-sorter", GINT_TO_POINTER (TRUE), test_string_sorter);
 
   return g_test_run ();
 }
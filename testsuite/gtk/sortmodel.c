@@ -1029,6 +1029,58 @@ sorted_insert (void)
   g_object_unref (ref_model);
 }
 
+static void
+sorted_change (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter1, iter2, iter3, iter4;
+  SignalMonitor *monitor;
+  GtkTreePath *path;
+  int order0[] = { 1, 2, 0, 3 };
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_list_store_insert_with_values (store, &iter1, -1, 0, 10, -1);
+  gtk_list_store_insert_with_values (store, &iter2, -1, 0, 20, -1);
+  gtk_list_store_insert_with_values (store, &iter3, -1, 0, 30, -1);
+  gtk_list_store_insert_with_values (store, &iter4, -1, 0, 40, -1);
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  check_sort_order (sort_model, GTK_SORT_ASCENDING, NULL);
+
+  monitor = signal_monitor_new (sort_model);
+
+  /* A change that keeps the order does not reorder */
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "1");
+  gtk_list_store_set (store, &iter2, 0, 25, -1);
+  signal_monitor_assert_is_empty (monitor);
+  check_sort_order (sort_model, GTK_SORT_ASCENDING, NULL);
+
+  /* Neither does a change to a value equal to the previous row */
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "1");
+  gtk_list_store_set (store, &iter2, 0, 10, -1);
+  signal_monitor_assert_is_empty (monitor);
+  check_sort_order (sort_model, GTK_SORT_ASCENDING, NULL);
+
+  /* A value equal to the next row moves the row after it */
+  path = gtk_tree_path_new ();
+  signal_monitor_append_signal_reordered (monitor,
+                                          ROWS_REORDERED,
+                                          path, order0, 4);
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "2");
+  gtk_list_store_set (store, &iter1, 0, 30, -1);
+  signal_monitor_assert_is_empty (monitor);
+  check_sort_order (sort_model, GTK_SORT_ASCENDING, NULL);
+
+  gtk_tree_path_free (path);
+  signal_monitor_free (monitor);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 
 static void
 specific_bug_300089 (void)
@@ -1317,6 +1369,8 @@ register_sort_model_tests (void)
                    rows_reordered_two_levels);
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
+  g_test_add_func ("/TreeModelSort/sorted-change",
+                   sorted_change);
 
   g_test_add_func ("/TreeModelSort/specific/bug-300089",
                    specific_bug_300089);
@@ -0,0 +1,191 @@
+/* GtkStreamListModel tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_THREADS 4
+#define N_PER_THREAD 10000
+
+static GQuark number_quark;
+
+static guint
+get (GListModel *model,
+     guint       position)
+{
+  GObject *object = g_list_model_get_item (model, position);
+  guint number;
+
+  g_assert_nonnull (object);
+  number = GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
+  g_object_unref (object);
+
+  return number;
+}
+
+static void
+append (GtkStreamListModel *model,
+        guint               number)
+{
+  GObject *object = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (number));
+  gtk_stream_list_model_append (model, object);
+  g_object_unref (object);
+}
+
+static void
+count_changes (GListModel *model,
+               guint       position,
+               guint       removed,
+               guint       added,
+               guint      *counter)
+{
+  (*counter)++;
+}
+
+static void
+wait_for_items (GtkStreamListModel *model,
+                guint               n_items)
+{
+  gint64 end = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+  while (g_list_model_get_n_items (G_LIST_MODEL (model)) < n_items)
+    {
+      g_assert_cmpint (g_get_monotonic_time (), <, end);
+      g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+static void
+test_batched (void)
+{
+  GtkStreamListModel *model;
+  guint i, counter = 0;
+
+  model = gtk_stream_list_model_new (G_TYPE_OBJECT);
+  g_signal_connect (model, "items-changed", G_CALLBACK (count_changes), &counter);
+
+  for (i = 1; i <= 1000; i++)
+    append (model, i);
+
+  /* Nothing shows up before the main context runs */
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, 0);
+
+  wait_for_items (model, 1000);
+  g_assert_cmpuint (counter, ==, 1);
+
+  for (i = 0; i < 1000; i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (model), i), ==, i + 1);
+
+  g_object_unref (model);
+}
+
+static gpointer
+produce (gpointer data)
+{
+  GtkStreamListModel *model = data;
+  guint i;
+
+  for (i = 0; i < N_PER_THREAD; i++)
+    append (model, i + 1);
+
+  return NULL;
+}
+
+static void
+test_threads (void)
+{
+  GtkStreamListModel *model;
+  GThread *threads[N_THREADS];
+  guint last[N_THREADS] = { 0, };
+  guint i, n;
+
+  model = gtk_stream_list_model_new (G_TYPE_OBJECT);
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("producer", produce, model);
+
+  wait_for_items (model, N_THREADS * N_PER_THREAD);
+
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* Each producer's items arrive in the order it appended them */
+  n = g_list_model_get_n_items (G_LIST_MODEL (model));
+  g_assert_cmpuint (n, ==, N_THREADS * N_PER_THREAD);
+  for (i = 0; i < n; i++)
+    {
+      guint number = get (G_LIST_MODEL (model), i);
+      guint j;
+
+      for (j = 0; j < N_THREADS; j++)
+        {
+          if (last[j] + 1 == number)
+            {
+              last[j] = number;
+              break;
+            }
+        }
+      g_assert_cmpuint (j, <, N_THREADS);
+    }
+
+  g_object_unref (model);
+}
+
+static void
+test_max_items (void)
+{
+  GtkStreamListModel *model;
+  guint i;
+
+  model = gtk_stream_list_model_new (G_TYPE_OBJECT);
+  gtk_stream_list_model_set_max_items (model, 100);
+  g_assert_cmpuint (gtk_stream_list_model_get_max_items (model), ==, 100);
+
+  for (i = 1; i <= 50; i++)
+    append (model, i);
+  wait_for_items (model, 50);
+
+  for (i = 51; i <= 5000; i++)
+    append (model, i);
+  while (get (G_LIST_MODEL (model), g_list_model_get_n_items (G_LIST_MODEL (model)) - 1) != 5000)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Only the newest items are kept */
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, 100);
+  for (i = 0; i < 100; i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (model), i), ==, 4901 + i);
+
+  gtk_stream_list_model_set_max_items (model, 10);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, 10);
+  g_assert_cmpuint (get (G_LIST_MODEL (model), 0), ==, 4991);
+
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  number_quark = g_quark_from_static_string ("Like a stream that meanders");
+
+  g_test_add_func ("/streamlistmodel/batched", test_batched);
+  g_test_add_func ("/streamlistmodel/threads", test_threads);
+  g_test_add_func ("/streamlistmodel/max-items", test_max_items);
+
+  return g_test_run ();
+}
@@ -242,6 +242,48 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_many (void)
+{
+  GtkStringList *list;
+  GPtrArray *strings;
+  GObject *item, *item2;
+  guint i;
+
+  strings = g_ptr_array_new_with_free_func (g_free);
+  for (i = 0; i < 10000; i++)
+    g_ptr_array_add (strings, g_strnfill (i % 23, 'a' + i % 26));
+  g_ptr_array_add (strings, NULL);
+
+  list = gtk_string_list_new ((const char * const *) strings->pdata);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 10000);
+
+  /* items are created on demand and kept */
+  item = g_list_model_get_item (G_LIST_MODEL (list), 5000);
+  item2 = g_list_model_get_item (G_LIST_MODEL (list), 5000);
+  g_assert_true (item == item2);
+  g_object_unref (item2);
+
+  /* removing most strings moves the others */
+  gtk_string_list_splice (list, 0, 5000, NULL);
+  gtk_string_list_splice (list, 1, 4000, NULL);
+  gtk_string_list_append (list, "x");
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 1001);
+
+  item2 = g_list_model_get_item (G_LIST_MODEL (list), 0);
+  g_assert_true (item == item2);
+  g_object_unref (item2);
+  g_object_unref (item);
+
+  g_assert_cmpstr (gtk_string_list_get_string (list, 0), ==, g_ptr_array_index (strings, 5000));
+  for (i = 1; i < 1000; i++)
+    g_assert_cmpstr (gtk_string_list_get_string (list, i), ==, g_ptr_array_index (strings, 9000 + i));
+  g_assert_cmpstr (gtk_string_list_get_string (list, 1000), ==, "x");
+
+  g_object_unref (list);
+  g_ptr_array_unref (strings);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -257,6 +299,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/many", test_many);
 
   return g_test_run ();
 }
@@ -1581,6 +1581,248 @@ test_get_iter (void)
   g_object_unref (buffer);
 }
 
+typedef struct {
+  gboolean done;
+  GError *error;
+} LoadStreamResult;
+
+static void
+load_stream_done (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  LoadStreamResult *res = data;
+
+  gtk_text_buffer_load_stream_finish (GTK_TEXT_BUFFER (source), result, &res->error);
+  res->done = TRUE;
+}
+
+static GError *
+load_stream (GtkTextBuffer *buffer,
+             const char    *text,
+             gsize          len)
+{
+  LoadStreamResult res = { FALSE, NULL };
+  GInputStream *stream;
+
+  stream = g_memory_input_stream_new_from_data (text, len, NULL);
+  gtk_text_buffer_load_stream_async (buffer, stream, G_PRIORITY_DEFAULT, NULL,
+                                     load_stream_done, &res);
+  g_object_unref (stream);
+
+  while (!res.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  return res.error;
+}
+
+static void
+test_load_stream (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GString *s;
+  GError *error;
+  char *text;
+
+  /* Reads come in 64k chunks. Put a two-byte character across the
+   * first chunk boundary and a \r\n across the second one.
+   */
+  s = g_string_new (NULL);
+  while (s->len < 65535 - 10)
+    g_string_append (s, "some text\n");
+  while (s->len < 65535)
+    g_string_append_c (s, 'x');
+  g_string_append (s, "\303\251");
+  while (s->len < 131071)
+    g_string_append_c (s, 'y');
+  g_string_append (s, "\r\nlast line");
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "previous contents", -1);
+  gtk_text_buffer_set_modified (buffer, FALSE);
+
+  error = load_stream (buffer, s->str, s->len);
+  g_assert_no_error (error);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, s->str);
+  g_free (text);
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 6553 + 2);
+  g_assert_true (gtk_text_buffer_get_modified (buffer));
+  g_assert_false (gtk_text_buffer_get_can_undo (buffer));
+
+  gtk_text_buffer_get_iter_at_mark (buffer, &start, gtk_text_buffer_get_insert (buffer));
+  g_assert_true (gtk_text_iter_is_start (&start));
+
+  /* Invalid UTF-8 */
+  gtk_text_buffer_set_modified (buffer, FALSE);
+  error = load_stream (buffer, "abc\377def", 7);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+
+  g_string_free (s, TRUE);
+  g_object_unref (buffer);
+}
+
+/* Large programmatic edits in a user action undo in one step */
+static void
+test_undo_large_edit (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GString *s;
+  char *text;
+  int i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "original\n", -1);
+  g_assert_false (gtk_text_buffer_get_can_undo (buffer));
+
+  s = g_string_new ("original\n");
+
+  gtk_text_buffer_begin_user_action (buffer);
+  for (i = 0; i < 1000; i++)
+    {
+      char line[32];
+
+      g_snprintf (line, sizeof line, "line %d\n", i);
+      gtk_text_buffer_get_end_iter (buffer, &end);
+      gtk_text_buffer_insert (buffer, &end, line, -1);
+      g_string_append (s, line);
+    }
+  /* Deletes going backwards and forwards from the same spot */
+  for (i = 0; i < 100; i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &start, 499 - i);
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, 500 - i);
+      gtk_text_buffer_delete (buffer, &start, &end);
+    }
+  for (i = 0; i < 100; i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &start, 400);
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, 401);
+      gtk_text_buffer_delete (buffer, &start, &end);
+    }
+  gtk_text_buffer_end_user_action (buffer);
+
+  g_string_erase (s, 400, 200);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, s->str);
+  g_free (text);
+
+  gtk_text_buffer_undo (buffer);
+  g_assert_false (gtk_text_buffer_get_can_undo (buffer));
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "original\n");
+  g_free (text);
+
+  gtk_text_buffer_redo (buffer);
+  g_assert_false (gtk_text_buffer_get_can_redo (buffer));
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, s->str);
+  g_free (text);
+
+  g_string_free (s, TRUE);
+  g_object_unref (buffer);
+}
+
+static GArray *
+get_tag_toggles (GtkTextBuffer *buffer,
+                 GtkTextTag    *tag)
+{
+  GArray *toggles;
+  GtkTextIter iter;
+  int offset;
+
+  toggles = g_array_new (FALSE, FALSE, sizeof (int));
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  if (gtk_text_iter_starts_tag (&iter, tag))
+    {
+      offset = 0;
+      g_array_append_val (toggles, offset);
+    }
+  while (gtk_text_iter_forward_to_tag_toggle (&iter, tag))
+    {
+      offset = gtk_text_iter_get_offset (&iter);
+      g_array_append_val (toggles, offset);
+    }
+
+  return toggles;
+}
+
+static void
+test_tag_ranges (void)
+{
+  GtkTextBuffer *buffer, *buffer2;
+  GtkTextTag *tags[100], *tags2[100];
+  GtkTextIter start, end;
+  GString *s;
+  int ranges[2 * 50];
+  guint i, j;
+
+  s = g_string_new (NULL);
+  for (i = 0; i < 500; i++)
+    g_string_append (s, "int foo = bar (baz);\n");
+
+  buffer = gtk_text_buffer_new (NULL);
+  buffer2 = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, s->str, s->len);
+  gtk_text_buffer_set_text (buffer2, s->str, s->len);
+
+  for (i = 0; i < G_N_ELEMENTS (tags); i++)
+    {
+      tags[i] = gtk_text_buffer_create_tag (buffer, NULL, NULL);
+      tags2[i] = gtk_text_buffer_create_tag (buffer2, NULL, NULL);
+
+      /* Unsorted, overlapping and out of bounds ranges */
+      for (j = 0; j < G_N_ELEMENTS (ranges) / 2; j++)
+        {
+          ranges[2 * j] = g_test_rand_int_range (-10, (int) s->len + 10);
+          ranges[2 * j + 1] = ranges[2 * j] + g_test_rand_int_range (-50, 50);
+        }
+
+      gtk_text_buffer_apply_tag_ranges (buffer, tags[i], ranges, G_N_ELEMENTS (ranges) / 2);
+      for (j = 0; j < G_N_ELEMENTS (ranges) / 2; j++)
+        {
+          gtk_text_buffer_get_iter_at_offset (buffer2, &start, MAX (ranges[2 * j], 0));
+          gtk_text_buffer_get_iter_at_offset (buffer2, &end, MAX (ranges[2 * j + 1], 0));
+          gtk_text_buffer_apply_tag (buffer2, tags2[i], &start, &end);
+        }
+
+      if (i % 3 == 0)
+        {
+          ranges[0] = g_test_rand_int_range (0, (int) s->len);
+          ranges[1] = ranges[0] + 200;
+          gtk_text_buffer_remove_tag_ranges (buffer, tags[i], ranges, 1);
+          gtk_text_buffer_get_iter_at_offset (buffer2, &start, ranges[0]);
+          gtk_text_buffer_get_iter_at_offset (buffer2, &end, ranges[1]);
+          gtk_text_buffer_remove_tag (buffer2, tags2[i], &start, &end);
+        }
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (tags); i++)
+    {
+      GArray *toggles = get_tag_toggles (buffer, tags[i]);
+      GArray *toggles2 = get_tag_toggles (buffer2, tags2[i]);
+
+      g_assert_cmpmem (toggles->data, toggles->len * sizeof (int),
+                       toggles2->data, toggles2->len * sizeof (int));
+
+      g_array_unref (toggles);
+      g_array_unref (toggles2);
+    }
+
+  g_string_free (s, TRUE);
+  g_object_unref (buffer);
+  g_object_unref (buffer2);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1600,6 +1842,9 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Tag", test_tag);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);
+  g_test_add_func ("/TextBuffer/Load stream", test_load_stream);
+  g_test_add_func ("/TextBuffer/Undo large edit", test_undo_large_edit);
+  g_test_add_func ("/TextBuffer/Tag ranges", test_tag_ranges);
 
   return g_test_run();
 }
@@ -279,6 +279,53 @@ test_search_caseless (void)
   check_found_backward ("aa \303\200", "aa", flags, 0, 2, "aa");
 }
 
+static void
+test_search_segments (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter i, s, e;
+  GdkPaintable *paintable;
+  gboolean res;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "xx foo bar\nFoo bar", -1);
+
+  /* marks split the text into several segments */
+  gtk_text_buffer_get_iter_at_offset (buffer, &i, 4);
+  gtk_text_buffer_create_mark (buffer, NULL, &i, FALSE);
+
+  gtk_text_buffer_get_start_iter (buffer, &i);
+  res = gtk_text_iter_forward_search (&i, "foo", 0, &s, &e, NULL);
+  g_assert_true (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 3);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 6);
+
+  /* starting in the middle of a line */
+  gtk_text_buffer_get_iter_at_offset (buffer, &i, 4);
+  res = gtk_text_iter_forward_search (&i, "FOO BAR", GTK_TEXT_SEARCH_CASE_INSENSITIVE, &s, &e, NULL);
+  g_assert_true (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 11);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 18);
+
+  paintable = gdk_paintable_new_empty (1, 1);
+  gtk_text_buffer_get_start_iter (buffer, &i);
+  gtk_text_buffer_insert_paintable (buffer, &i, paintable);
+  g_object_unref (paintable);
+
+  gtk_text_buffer_get_start_iter (buffer, &i);
+  res = gtk_text_iter_forward_search (&i, "xx foo", GTK_TEXT_SEARCH_TEXT_ONLY, &s, &e, NULL);
+  g_assert_true (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 1);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 7);
+
+  res = gtk_text_iter_forward_search (&i, "\357\277\274xx", 0, &s, &e, NULL);
+  g_assert_true (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 0);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 3);
+
+  g_object_unref (buffer);
+}
+
 static void
 test_forward_to_tag_toggle (void)
 {
@@ -789,6 +836,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search Segments", test_search_segments);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
@@ -252,6 +252,48 @@ test_remove_some (void)
   g_object_unref (tree);
 }
 
+static void
+test_expand_all (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  guint i, n, *numbers;
+  char *expanded;
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "1+110");
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_changes (tree, "");
+
+  /* Lookups relative to the previous position must agree with
+   * lookups from the top */
+  expanded = model_to_string (G_LIST_MODEL (tree));
+  n = g_list_model_get_n_items (G_LIST_MODEL (tree));
+  numbers = g_new (guint, n);
+  for (i = 0; i < n; i++)
+    numbers[i] = get (G_LIST_MODEL (tree), i);
+  for (i = n; i > 0; i--)
+    g_assert_cmpuint (get (G_LIST_MODEL (tree), i - 1), ==, numbers[i - 1]);
+  for (i = 0; i < 1000; i++)
+    {
+      guint pos = g_test_rand_int_range (0, n);
+      g_assert_cmpuint (get (G_LIST_MODEL (tree), pos), ==, numbers[pos]);
+    }
+  g_free (numbers);
+
+  gtk_tree_list_model_collapse_all (tree);
+  assert_model (tree, "100");
+  assert_changes (tree, "1-110");
+
+  gtk_tree_list_model_expand_all (tree);
+  assert_model (tree, expanded);
+  assert_changes (tree, "1+110");
+
+  g_free (expanded);
+  g_object_unref (tree);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -263,6 +305,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/treelistmodel/expand", test_expand);
   g_test_add_func ("/treelistmodel/remove_some", test_remove_some);
+  g_test_add_func ("/treelistmodel/expand-all", test_expand_all);
 
   return g_test_run ();
 }
@@ -0,0 +1,423 @@
+/* render-benchmark.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Renders a corpus of .node files, such as the ones in
+ * testsuite/gsk/compare or recordings saved from the inspector,
+ * offscreen with each renderer and reports per-frame statistics.
+ *
+ * The timers and counters of the renderers are only available
+ * when GTK is built with debugging enabled. Without them, only
+ * the wall clock time of each frame is reported.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+#include <gtk/gtk.h>
+
+#include "gsk/gskrendererprivate.h"
+#include "gsk/gskprofilerprivate.h"
+#include "gsk/gl/gskglrenderer.h"
+#ifdef GDK_RENDERING_VULKAN
+#include "gsk/vulkan/gskvulkanrenderer.h"
+#endif
+#ifdef GDK_WINDOWING_BROADWAY
+#include "gsk/broadway/gskbroadwayrenderer.h"
+#endif
+
+static const struct {
+  const char *name;
+  GskRenderer * (* create) (void);
+} renderers[] = {
+  { "cairo", gsk_cairo_renderer_new },
+  { "gl", gsk_gl_renderer_new },
+#ifdef GDK_RENDERING_VULKAN
+  { "vulkan", gsk_vulkan_renderer_new },
+#endif
+#ifdef GDK_WINDOWING_BROADWAY
+  { "broadway", gsk_broadway_renderer_new },
+#endif
+};
+
+/* The profiler timers (in µs) and counters that are reported,
+ * if the renderer has them */
+static const char *timers[] = { "build-time", "cpu-time", "gpu-time" };
+static const char *counters[] = { "draws", "merged-draws", "texture-uploads" };
+
+#define N_METRICS (1 + G_N_ELEMENTS (timers) + G_N_ELEMENTS (counters))
+
+typedef struct {
+  const char *name;
+  gboolean present;
+  gint64 sum;
+  gint64 min;
+  gint64 max;
+} Metric;
+
+static int opt_runs = 20;
+static int opt_warmup = 3;
+static char **opt_renderers;
+static char *opt_output;
+static char **opt_files;
+
+static GOptionEntry options[] = {
+  { "renderer", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING_ARRAY, &opt_renderers, "Renderer to benchmark, can be repeated", "NAME" },
+  { "runs", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_runs, "Number of measured frames per file", "COUNT" },
+  { "warmup", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_warmup, "Number of frames to render before measuring", "COUNT" },
+  { "output", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_output, "Write results as JSON to FILE", "FILE" },
+  { G_OPTION_REMAINING, 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME_ARRAY, &opt_files, NULL, "FILE…" },
+  { NULL, }
+};
+
+static void
+metric_add (Metric *metric,
+            gint64  value)
+{
+  if (!metric->present)
+    {
+      metric->present = TRUE;
+      metric->sum = value;
+      metric->min = value;
+      metric->max = value;
+    }
+  else
+    {
+      metric->sum += value;
+      metric->min = MIN (metric->min, value);
+      metric->max = MAX (metric->max, value);
+    }
+}
+
+static int
+compare_paths (gconstpointer a,
+               gconstpointer b)
+{
+  return strcmp (*(const char **) a, *(const char **) b);
+}
+
+static void
+collect_files (const char *path,
+               GPtrArray  *files)
+{
+  GPtrArray *names;
+  const char *name;
+  GDir *dir;
+  guint i;
+
+  if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+    {
+      g_ptr_array_add (files, g_strdup (path));
+      return;
+    }
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  names = g_ptr_array_new ();
+  while ((name = g_dir_read_name (dir)))
+    {
+      if (g_str_has_suffix (name, ".node"))
+        g_ptr_array_add (names, g_build_filename (path, name, NULL));
+    }
+  g_dir_close (dir);
+
+  /* Keep the order stable, so results can be compared between runs */
+  g_ptr_array_sort (names, compare_paths);
+  for (i = 0; i < names->len; i++)
+    g_ptr_array_add (files, g_ptr_array_index (names, i));
+  g_ptr_array_free (names, TRUE);
+}
+
+static GskRenderNode *
+load_node (const char *filename)
+{
+  GskRenderNode *node;
+  GError *error = NULL;
+  char *contents;
+  gsize length;
+  GBytes *bytes;
+
+  if (!g_file_get_contents (filename, &contents, &length, &error))
+    {
+      g_printerr ("Could not open %s: %s\n", filename, error->message);
+      g_error_free (error);
+      return NULL;
+    }
+
+  bytes = g_bytes_new_take (contents, length);
+  node = gsk_render_node_deserialize (bytes, NULL, NULL);
+  g_bytes_unref (bytes);
+
+  if (node == NULL)
+    g_printerr ("Could not parse %s\n", filename);
+
+  return node;
+}
+
+static void
+append_result (GString       *json,
+               const char    *filename,
+               const char    *renderer_name,
+               GskRenderNode *node,
+               const Metric  *metrics,
+               int            runs)
+{
+  graphene_rect_t bounds;
+  gboolean first = TRUE;
+  char *escaped;
+  guint i;
+
+  gsk_render_node_get_bounds (node, &bounds);
+
+  if (json->len > 0)
+    g_string_append (json, ",\n");
+
+  escaped = g_strescape (filename, NULL);
+  g_string_append_printf (json,
+                          "    {\n"
+                          "      \"file\": \"%s\",\n"
+                          "      \"renderer\": \"%s\",\n"
+                          "      \"width\": %d,\n"
+                          "      \"height\": %d,\n"
+                          "      \"metrics\": {",
+                          escaped,
+                          renderer_name,
+                          (int) ceilf (bounds.size.width),
+                          (int) ceilf (bounds.size.height));
+  g_free (escaped);
+
+  for (i = 0; i < N_METRICS; i++)
+    {
+      char buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+      if (!metrics[i].present)
+        continue;
+
+      g_string_append_printf (json,
+                              "%s\n        \"%s\": { \"mean\": %s, \"min\": %" G_GINT64_FORMAT ", \"max\": %" G_GINT64_FORMAT " }",
+                              first ? "" : ",",
+                              metrics[i].name,
+                              g_ascii_dtostr (buffer, sizeof (buffer), (double) metrics[i].sum / runs),
+                              metrics[i].min,
+                              metrics[i].max);
+      first = FALSE;
+    }
+
+  g_string_append (json, "\n      }\n    }");
+}
+
+static void
+print_result (const char   *filename,
+              const char   *renderer_name,
+              const Metric *metrics,
+              int           runs)
+{
+  char *basename;
+  guint i;
+
+  basename = g_path_get_basename (filename);
+  g_print ("%-40s %-8s", basename, renderer_name);
+  g_free (basename);
+
+  for (i = 0; i < N_METRICS; i++)
+    {
+      if (metrics[i].present)
+        g_print (" %s=%.1f", metrics[i].name, (double) metrics[i].sum / runs);
+    }
+
+  g_print ("\n");
+}
+
+static gboolean
+benchmark_node (GskRenderer   *renderer,
+                const char    *renderer_name,
+                const char    *filename,
+                GskRenderNode *node,
+                GString       *json)
+{
+  GskProfiler *profiler;
+  Metric metrics[N_METRICS] = { { NULL, }, };
+  int run;
+  guint i;
+
+  profiler = gsk_renderer_get_profiler (renderer);
+
+  metrics[0].name = "wall-time";
+  for (i = 0; i < G_N_ELEMENTS (timers); i++)
+    metrics[1 + i].name = timers[i];
+  for (i = 0; i < G_N_ELEMENTS (counters); i++)
+    metrics[1 + G_N_ELEMENTS (timers) + i].name = counters[i];
+
+  for (run = 0; run < opt_warmup + opt_runs; run++)
+    {
+      GdkTexture *texture;
+      gint64 start, end;
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      end = g_get_monotonic_time ();
+
+      if (texture == NULL)
+        return FALSE;
+
+      g_object_unref (texture);
+
+      /* Caches are warm and the GPU timer results of earlier
+       * frames are available after the warmup */
+      if (run < opt_warmup)
+        continue;
+
+      metric_add (&metrics[0], end - start);
+
+      for (i = 0; i < G_N_ELEMENTS (timers); i++)
+        {
+          if (gsk_profiler_has_timer (profiler, timers[i]))
+            metric_add (&metrics[1 + i],
+                        gsk_profiler_timer_get (profiler, g_quark_from_string (timers[i])));
+        }
+
+      for (i = 0; i < G_N_ELEMENTS (counters); i++)
+        {
+          if (gsk_profiler_has_counter (profiler, counters[i]))
+            metric_add (&metrics[1 + G_N_ELEMENTS (timers) + i],
+                        gsk_profiler_counter_get (profiler, g_quark_from_string (counters[i])));
+        }
+    }
+
+  print_result (filename, renderer_name, metrics, opt_runs);
+  append_result (json, filename, renderer_name, node, metrics, opt_runs);
+
+  return TRUE;
+}
+
+static gboolean
+renderer_is_selected (const char *name)
+{
+  return opt_renderers == NULL || g_strv_contains ((const char * const *) opt_renderers, name);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GPtrArray *files;
+  GString *json;
+  GdkSurface *surface;
+  gboolean success = TRUE;
+  guint i, j;
+
+  context = g_option_context_new ("- benchmark the GSK renderers");
+  g_option_context_set_summary (context,
+                                "Render .node files offscreen with each renderer and report\n"
+                                "per-frame timings and counters. Directories are scanned\n"
+                                "for .node files.");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (opt_files == NULL || opt_runs <= 0 || opt_warmup < 0)
+    {
+      g_printerr ("Usage: render-benchmark [OPTIONS…] FILE…\n");
+      return 1;
+    }
+
+  gtk_init ();
+
+  files = g_ptr_array_new_with_free_func (g_free);
+  for (i = 0; opt_files[i]; i++)
+    collect_files (opt_files[i], files);
+
+  surface = gdk_surface_new_toplevel (gdk_display_get_default ());
+  json = g_string_new (NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      GskRenderer *renderer;
+
+      if (!renderer_is_selected (renderers[i].name))
+        continue;
+
+      renderer = renderers[i].create ();
+      if (!gsk_renderer_realize (renderer, surface, &error))
+        {
+          g_print ("Skipping %s renderer: %s\n", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_object_unref (renderer);
+          continue;
+        }
+
+      for (j = 0; j < files->len; j++)
+        {
+          const char *filename = g_ptr_array_index (files, j);
+          GskRenderNode *node;
+
+          node = load_node (filename);
+          if (node == NULL)
+            {
+              success = FALSE;
+              continue;
+            }
+
+          if (!benchmark_node (renderer, renderers[i].name, filename, node, json))
+            {
+              g_printerr ("Could not render %s with the %s renderer\n", filename, renderers[i].name);
+              success = FALSE;
+            }
+
+          gsk_render_node_unref (node);
+        }
+
+      gsk_renderer_unrealize (renderer);
+      g_object_unref (renderer);
+    }
+
+  if (opt_output)
+    {
+      char *contents;
+
+      contents = g_strdup_printf ("{\n"
+                                  "  \"warmup\": %d,\n"
+                                  "  \"runs\": %d,\n"
+                                  "  \"results\": [\n"
+                                  "%s\n"
+                                  "  ]\n"
+                                  "}\n",
+                                  opt_warmup, opt_runs, json->str);
+
+      if (!g_file_set_contents (opt_output, contents, -1, &error))
+        {
+          g_printerr ("Could not write %s: %s\n", opt_output, error->message);
+          g_clear_error (&error);
+          success = FALSE;
+        }
+
+      g_free (contents);
+    }
+
+  g_string_free (json, TRUE);
+  g_ptr_array_unref (files);
+  g_object_unref (surface);
+
+  return success ? 0 : 1;
+}
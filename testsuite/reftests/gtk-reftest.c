@@ -27,6 +27,7 @@
 #ifndef G_OS_WIN32
 #include <execinfo.h>
 #endif
+#include <stdio.h>
 #include <string.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
@@ -47,6 +48,8 @@ static char *arg_output_dir = NULL;
 static char *arg_base_dir = NULL;
 static char *arg_direction = NULL;
 static char *arg_compare_dir = NULL;
+static char *arg_cache_dir = NULL;
+static char *arg_shard = NULL;
 
 static const GOptionEntry test_args[] = {
   { "output",         'o', 0, G_OPTION_ARG_FILENAME, &arg_output_dir,
@@ -57,10 +60,16 @@ static const GOptionEntry test_args[] = {
     "Set text direction", "ltr|rtl" },
   { "compare-with",    0, 0, G_OPTION_ARG_FILENAME, &arg_compare_dir,
     "Directory to compare with", "DIR" },
+  { "cache",           0, 0, G_OPTION_ARG_FILENAME, &arg_cache_dir,
+    "Directory to cache reference images in", "DIR" },
+  { "shard",           0, 0, G_OPTION_ARG_STRING, &arg_shard,
+    "Only run the tests of one of COUNT shards", "INDEX/COUNT" },
   { NULL }
 };
 
 static gboolean using_tap;
+static guint shard_index = 0;
+static guint shard_count = 1;
 
 static gboolean
 parse_command_line (int *argc, char ***argv)
@@ -95,6 +104,16 @@ parse_command_line (int *argc, char ***argv)
   else if (arg_direction != NULL)
     g_printerr ("Invalid argument passed to --direction argument. Valid arguments are 'ltr' and 'rtl'\n");
 
+  if (arg_shard != NULL)
+    {
+      if (sscanf (arg_shard, "%u/%u", &shard_index, &shard_count) != 2 ||
+          shard_count == 0 || shard_index >= shard_count)
+        {
+          g_printerr ("Invalid argument passed to --shard argument. Valid arguments are INDEX/COUNT with INDEX < COUNT\n");
+          return FALSE;
+        }
+    }
+
   return TRUE;
 }
 
@@ -268,6 +287,56 @@ remove_extra_css (GtkStyleProvider *provider)
                                                  provider);
 }
 
+/* The reference image only depends on the reference file, the css
+ * and the GTK that renders it, so it can be reused by later runs as
+ * long as none of those change.
+ */
+static char *
+get_cached_reference_file (const char *ui_file,
+                           const char *reference_file)
+{
+  GChecksum *checksum;
+  char *contents;
+  gsize length;
+  char *css_file;
+  char *base, *result;
+
+  if (arg_cache_dir == NULL)
+    return NULL;
+
+  if (!g_file_get_contents (reference_file, &contents, &length, NULL))
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) contents, length);
+  g_free (contents);
+
+  css_file = get_test_file (ui_file, ".css", TRUE);
+  if (css_file && g_file_get_contents (css_file, &contents, &length, NULL))
+    {
+      g_checksum_update (checksum, (const guchar *) contents, length);
+      g_free (contents);
+    }
+  g_free (css_file);
+
+  contents = g_strdup_printf ("%u.%u.%u %s %s %s",
+                              gtk_get_major_version (),
+                              gtk_get_minor_version (),
+                              gtk_get_micro_version (),
+                              g_getenv ("GDK_RENDERING"),
+                              g_getenv ("GSK_RENDERER") ? g_getenv ("GSK_RENDERER") : "",
+                              arg_direction ? arg_direction : "");
+  g_checksum_update (checksum, (const guchar *) contents, -1);
+  g_free (contents);
+
+  get_components_of_test_file (ui_file, NULL, &base);
+  result = g_strconcat (arg_cache_dir, G_DIR_SEPARATOR_S, base, "-", g_checksum_get_string (checksum), ".ref.png", NULL);
+  g_free (base);
+  g_checksum_free (checksum);
+
+  return result;
+}
+
 static void
 save_image (cairo_surface_t *surface,
             const char      *test_name,
@@ -290,23 +359,60 @@ save_image (cairo_surface_t *surface,
   g_free (filename);
 }
 
+static cairo_surface_t *
+snapshot_reference_file (const char *ui_file,
+                         const char *reference_file)
+{
+  cairo_surface_t *reference_image;
+  char *cached_file;
+
+  cached_file = get_cached_reference_file (ui_file, reference_file);
+  if (cached_file && g_file_test (cached_file, G_FILE_TEST_EXISTS))
+    {
+      reference_image = cairo_image_surface_create_from_png (cached_file);
+      if (cairo_surface_status (reference_image) == CAIRO_STATUS_SUCCESS)
+        {
+          g_test_message ("Using cached reference image %s", cached_file);
+          g_free (cached_file);
+          return reference_image;
+        }
+      cairo_surface_destroy (reference_image);
+    }
+
+  reference_image = reftest_snapshot_ui_file (reference_file);
+
+  if (cached_file)
+    {
+      if (g_mkdir_with_parents (arg_cache_dir, 0755) != 0 ||
+          cairo_surface_write_to_png (reference_image, cached_file) != CAIRO_STATUS_SUCCESS)
+        g_test_message ("Not caching reference image at %s", cached_file);
+      g_free (cached_file);
+    }
+
+  return reference_image;
+}
+
 static void
 test_ui_file (GFile *file)
 {
   char *ui_file, *reference_file;
   cairo_surface_t *ui_image, *reference_image, *diff_image;
   GtkStyleProvider *provider;
+  gint64 start, ui_time, reference_time;
 
   ui_file = g_file_get_path (file);
 
   provider = add_extra_css (ui_file, ".css");
 
+  start = g_get_monotonic_time ();
   ui_image = reftest_snapshot_ui_file (ui_file);
+  ui_time = g_get_monotonic_time () - start;
 
+  start = g_get_monotonic_time ();
   if ((reference_file = get_reference_image (ui_file)) != NULL)
     reference_image = cairo_image_surface_create_from_png (reference_file);
   else if ((reference_file = get_test_file (ui_file, ".ref.ui", TRUE)) != NULL)
-    reference_image = reftest_snapshot_ui_file (reference_file);
+    reference_image = snapshot_reference_file (ui_file, reference_file);
   else
     {
       reference_image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
@@ -314,6 +420,10 @@ test_ui_file (GFile *file)
       g_test_fail ();
     }
   g_free (reference_file);
+  reference_time = g_get_monotonic_time () - start;
+
+  g_test_message ("Render time: %.3f ms, reference: %.3f ms",
+                  ui_time / 1000.0, reference_time / 1000.0);
 
   diff_image = reftest_compare_surfaces (ui_image, reference_image);
 
@@ -352,6 +462,7 @@ compare_files (gconstpointer a, gconstpointer b)
 static void
 add_test_for_file (GFile *file)
 {
+  static guint n_tests = 0;
   GFileEnumerator *enumerator;
   GFileInfo *info;
   GList *files;
@@ -360,6 +471,9 @@ add_test_for_file (GFile *file)
 
   if (g_file_query_file_type (file, 0, NULL) != G_FILE_TYPE_DIRECTORY)
     {
+      if (n_tests++ % shard_count != shard_index)
+        return;
+
       g_test_add_vtable (g_file_peek_path (file),
                          0,
                          g_object_ref (file),